@@ -265,6 +265,13 @@ int elf_is_rom(struct image *image, Elf32_Shdr *section)
 	return 1;
 }
 
+/* code overlays share SRAM addresses and are stored apart from segments */
+int elf_is_overlay(struct module *module, Elf32_Shdr *section)
+{
+	return !strncmp(module->strings + section->name, SOF_MAN_OVERLAY_PREFIX,
+			strlen(SOF_MAN_OVERLAY_PREFIX));
+}
+
 static void elf_module_size(struct image *image, struct module *module,
 			    Elf32_Shdr *section, int index)
 {
@@ -380,6 +387,9 @@ static void elf_module_limits(struct image *image, struct module *module)
 
 			if (elf_is_rom(image, section))
 				continue;
+
+			if (elf_is_overlay(module, section))
+				continue;
 		}
 
 		fprintf(stdout, "\t%d\t0x%8.8x\t0x%8.8x\t0x%x", i,
@@ -426,6 +436,9 @@ int elf_validate_section(struct image *image, struct module *module,
 			if (s->size == 0)
 				continue;
 
+			if (elf_is_overlay(m, s))
+				continue;
+
 			/* is section start non overlapping ? */
 			if (section->vaddr >= s->vaddr &&
 			    section->vaddr <
@@ -480,6 +493,10 @@ int elf_validate_modules(struct image *image)
 			if (section->size == 0)
 				continue;
 
+			/* overlays are linked at the same address */
+			if (elf_is_overlay(module, section))
+				continue;
+
 			/* is section non overlapping ? */
 			ret = elf_validate_section(image, module, section, j);
 			if (ret < 0)
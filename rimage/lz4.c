@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Greedy LZ4 block compressor for segments unpacked by the boot loader */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "lz4.h"
+
+#define LZ4_MIN_MATCH		4
+#define LZ4_LAST_LITERALS	5	/* block ends with literals */
+#define LZ4_MF_LIMIT		12	/* no match starts closer to the end */
+#define LZ4_MAX_OFFSET		65535
+#define LZ4_RUN_MASK		15
+#define LZ4_HASH_BITS		16
+
+static uint32_t lz4_hash(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return (v * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+static int lz4_put_length(uint8_t **op, uint8_t *oend, uint32_t len)
+{
+	for (; len >= 255; len -= 255) {
+		if (*op >= oend)
+			return -1;
+		*(*op)++ = 255;
+	}
+
+	if (*op >= oend)
+		return -1;
+	*(*op)++ = len;
+
+	return 0;
+}
+
+/* literals followed by a match, the last sequence has no match */
+static int lz4_put_sequence(uint8_t **op, uint8_t *oend,
+			    const uint8_t *literals, uint32_t literal_len,
+			    uint32_t offset, uint32_t match_len)
+{
+	uint8_t *token = *op;
+
+	if (*op >= oend)
+		return -1;
+	(*op)++;
+
+	*token = (literal_len < LZ4_RUN_MASK ? literal_len : LZ4_RUN_MASK) << 4;
+	if (literal_len >= LZ4_RUN_MASK &&
+	    lz4_put_length(op, oend, literal_len - LZ4_RUN_MASK) < 0)
+		return -1;
+
+	if (oend - *op < literal_len)
+		return -1;
+	memcpy(*op, literals, literal_len);
+	*op += literal_len;
+
+	if (!match_len)
+		return 0;
+
+	if (oend - *op < 2)
+		return -1;
+	*(*op)++ = offset & 0xff;
+	*(*op)++ = offset >> 8;
+
+	match_len -= LZ4_MIN_MATCH;
+	*token |= match_len < LZ4_RUN_MASK ? match_len : LZ4_RUN_MASK;
+	if (match_len >= LZ4_RUN_MASK &&
+	    lz4_put_length(op, oend, match_len - LZ4_RUN_MASK) < 0)
+		return -1;
+
+	return 0;
+}
+
+int lz4_compress(const uint8_t *src, uint32_t size, uint8_t *dst,
+		 uint32_t capacity)
+{
+	const uint8_t *end = src + size;
+	const uint8_t *anchor = src;
+	const uint8_t *ip = src;
+	const uint8_t *ref;
+	uint8_t *op = dst;
+	uint8_t *oend = dst + capacity;
+	uint32_t *table;
+	uint32_t len;
+	uint32_t h;
+	int ret = -1;
+
+	/* positions + 1 of the last 4 bytes with each hash */
+	table = calloc(1 << LZ4_HASH_BITS, sizeof(*table));
+	if (!table)
+		return -1;
+
+	while (size > LZ4_MF_LIMIT && ip < end - LZ4_MF_LIMIT) {
+		h = lz4_hash(ip);
+		ref = table[h] ? src + table[h] - 1 : NULL;
+		table[h] = ip - src + 1;
+
+		if (!ref || ip - ref > LZ4_MAX_OFFSET ||
+		    memcmp(ref, ip, LZ4_MIN_MATCH)) {
+			ip++;
+			continue;
+		}
+
+		len = LZ4_MIN_MATCH;
+		while (ip + len < end - LZ4_LAST_LITERALS && ref[len] == ip[len])
+			len++;
+
+		if (lz4_put_sequence(&op, oend, anchor, ip - anchor, ip - ref,
+				     len) < 0)
+			goto out;
+
+		ip += len;
+		anchor = ip;
+	}
+
+	if (lz4_put_sequence(&op, oend, anchor, end - anchor, 0, 0) < 0)
+		goto out;
+
+	ret = op - dst;
+out:
+	free(table);
+	return ret;
+}
@@ -0,0 +1,19 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __LZ4_H__
+#define __LZ4_H__
+
+#include <stdint.h>
+
+/*
+ * Compresses size bytes of src into an LZ4 block of at most capacity bytes
+ * at dst. Returns the block size or -1 if it doesn't fit. The block has no
+ * end marker, decompression stops once the original size is produced.
+ */
+int lz4_compress(const uint8_t *src, uint32_t size, uint8_t *dst,
+		 uint32_t capacity);
+
+#endif
@@ -22,6 +22,7 @@
 #include "cse.h"
 #include "plat_auth.h"
 #include "manifest.h"
+#include "lz4.h"
 
 static int man_open_rom_file(struct image *image)
 {
@@ -353,6 +354,150 @@ err:
 	return -EINVAL;
 }
 
+/* packs text and data segments back to back from module start */
+static int man_module_compress(struct image *image, struct module *module,
+			       struct sof_man_module *man_module)
+{
+	int types[] = {SOF_MAN_SEGMENT_TEXT, SOF_MAN_SEGMENT_RODATA};
+	struct sof_man_segment_desc *segment;
+	uint8_t *data[ARRAY_SIZE(types)] = {NULL};
+	int size[ARRAY_SIZE(types)];
+	uint32_t offset = module->foffset;
+	uint32_t raw = 0;
+	int packed = 0;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(types); i++) {
+		segment = &man_module->segment[types[i]];
+		size[i] = segment->flags.r.length * MAN_PAGE_SIZE;
+		raw += size[i];
+
+		data[i] = malloc(size[i]);
+		if (!data[i]) {
+			ret = -ENOMEM;
+			goto out;
+		}
+
+		/* keep segment raw when compression doesn't pay off */
+		ret = lz4_compress(image->fw_image + segment->file_offset,
+				   size[i], data[i], size[i]);
+		if (ret < 0) {
+			memcpy(data[i], image->fw_image + segment->file_offset,
+			       size[i]);
+			ret = 0;
+			continue;
+		}
+
+		size[i] = ret;
+		segment->flags.r.compressed = 1;
+		packed++;
+	}
+
+	if (!packed)
+		goto out;
+
+	memset(image->fw_image + module->foffset, 0,
+	       image->image_end - module->foffset);
+
+	for (i = 0; i < ARRAY_SIZE(types); i++) {
+		segment = &man_module->segment[types[i]];
+		segment->file_offset = offset;
+		memcpy(image->fw_image + offset, data[i], size[i]);
+		offset += size[i];
+		offset = (offset + 3) & ~3;
+	}
+
+	image->image_end = offset;
+
+	fprintf(stdout, " compressed text and data 0x%x to 0x%x bytes\n",
+		raw, offset - module->foffset);
+
+out:
+	for (i = 0; i < ARRAY_SIZE(types); i++)
+		free(data[i]);
+	return ret;
+}
+
+static Elf32_Shdr *man_find_section(struct module *module, const char *name)
+{
+	int i;
+
+	for (i = 0; i < module->hdr.shnum; i++)
+		if (!strcmp(module->strings + module->section[i].name, name))
+			return &module->section[i];
+
+	return NULL;
+}
+
+/* stores code overlays after the module and fills in their descriptors */
+static int man_module_overlays(struct image *image, struct module *module,
+			       struct sof_man_module *man_module)
+{
+	char name[sizeof(SOF_MAN_OVERLAY_PREFIX) + SOF_MAN_OVERLAY_NAME_LEN];
+	struct sof_man_overlay *overlay;
+	Elf32_Shdr *section;
+	Elf32_Shdr *table;
+	uint32_t offset;
+	size_t count;
+	int i;
+
+	table = man_find_section(module, ".overlay_table");
+	if (!table || !table->size)
+		return 0;
+
+	/* descriptors would be packed before their offsets are known */
+	if (module->compress) {
+		fprintf(stderr, "error: overlays can't be compressed\n");
+		return -EINVAL;
+	}
+
+	overlay = (struct sof_man_overlay *)(image->fw_image +
+		elf_to_file_offset(image, module, man_module, table));
+	offset = (image->image_end + 3) & ~3;
+
+	for (i = 0; i < table->size / sizeof(*overlay); i++, overlay++) {
+		snprintf(name, sizeof(name), "%s%.*s", SOF_MAN_OVERLAY_PREFIX,
+			 SOF_MAN_OVERLAY_NAME_LEN, (char *)overlay->name);
+
+		/* overlay without any code linked in */
+		section = man_find_section(module, name);
+		if (!section || !section->size)
+			continue;
+
+		if (offset + section->size > image->adsp->image_size) {
+			fprintf(stderr, "error: no room for overlay %s\n",
+				name);
+			return -ENOSPC;
+		}
+
+		if (fseek(module->fd, section->off, SEEK_SET) < 0) {
+			fprintf(stderr, "error: can't seek to overlay %s\n",
+				name);
+			return -errno;
+		}
+
+		count = fread(image->fw_image + offset, 1, section->size,
+			      module->fd);
+		if (count != section->size) {
+			fprintf(stderr, "error: can't read overlay %s\n", name);
+			return -errno;
+		}
+
+		overlay->vma = section->vaddr;
+		overlay->size = section->size;
+		overlay->file_offset = offset;
+
+		fprintf(stdout, " overlay %s\t0x%x\t0x%x\t\t0x%x\n", name,
+			section->vaddr, section->size, offset);
+
+		offset = (offset + section->size + 3) & ~3;
+		image->image_end = offset;
+	}
+
+	return 0;
+}
+
 static int man_module_create(struct image *image, struct module *module,
 			     struct sof_man_module *man_module)
 {
@@ -450,6 +595,10 @@ static int man_module_create(struct image *image, struct module *module,
 		if (section->size == 0)
 			continue;
 
+		/* overlays are stored after the module */
+		if (elf_is_overlay(module, section))
+			continue;
+
 		/* text or data section */
 		if (!elf_is_rom(image, section))
 			err = man_copy_elf_section(image, section, module,
@@ -469,6 +618,20 @@ static int man_module_create(struct image *image, struct module *module,
 		goto out;
 	}
 
+	err = man_module_overlays(image, module, man_module);
+	if (err < 0) {
+		fprintf(stderr, "error: failed to write overlays\n");
+		return err;
+	}
+
+	if (module->compress) {
+		err = man_module_compress(image, module, man_module);
+		if (err < 0) {
+			fprintf(stderr, "error: failed to compress module\n");
+			return err;
+		}
+	}
+
 	/* round module end upto nearest page */
 	if (image->image_end % MAN_PAGE_SIZE) {
 		image->image_end = (image->image_end / MAN_PAGE_SIZE) + 1;
@@ -663,6 +826,9 @@ static int man_create_modules(struct image *image, struct sof_man_fw_desc *desc,
 		else
 			module->foffset = image->image_end;
 
+		/* modules after the first one are loaded by the boot loader */
+		module->compress = image->compress && i > 0;
+
 		if (image->reloc)
 			err = man_module_create_reloc(image, module,
 						      man_module);
@@ -41,6 +41,7 @@ static void usage(char *name)
 	fprintf(stdout, "\t -p log dictionary outfile\n");
 	fprintf(stdout, "\t -i set IMR type\n");
 	fprintf(stdout, "\t -x set xcc module offset\n");
+	fprintf(stdout, "\t -z compress modules loaded by boot loader\n");
 	exit(0);
 }
 
@@ -55,7 +56,7 @@ int main(int argc, char *argv[])
 
 	image.xcc_mod_offset = DEFAULT_XCC_MOD_OFFSET;
 
-	while ((opt = getopt(argc, argv, "ho:p:m:vba:s:k:l:ri:x:")) != -1) {
+	while ((opt = getopt(argc, argv, "ho:p:m:vba:s:k:l:ri:x:z")) != -1) {
 		switch (opt) {
 		case 'o':
 			image.out_file = optarg;
@@ -87,6 +88,9 @@ int main(int argc, char *argv[])
 		case 'x':
 			image.xcc_mod_offset = atoi(optarg);
 			break;
+		case 'z':
+			image.compress = 1;
+			break;
 		case 'h':
 			usage(argv[0]);
 			break;
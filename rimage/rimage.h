@@ -87,6 +87,9 @@ struct module {
 
 	/* executable header module */
 	int exec_header;
+
+	/* segments are LZ4 compressed for the boot loader */
+	int compress;
 };
 
 /*
@@ -104,6 +107,7 @@ struct image {
 	int abi;
 	int verbose;
 	int reloc;	/* ELF data is relocatable */
+	int compress;	/* compress modules loaded by boot loader */
 	int num_modules;
 	struct module module[MAX_MODULES];
 	uint32_t image_end;/* module end, equal to output image size */
@@ -175,6 +179,7 @@ int pkcs_v1_5_sign_man_v1_8(struct image *image,
 int elf_parse_module(struct image *image, int module_index, const char *name);
 void elf_free_module(struct image *image, int module_index);
 int elf_is_rom(struct image *image, Elf32_Shdr *section);
+int elf_is_overlay(struct module *module, Elf32_Shdr *section);
 int elf_validate_modules(struct image *image);
 int elf_find_section(struct image *image, struct module *module,
 		const char *name);
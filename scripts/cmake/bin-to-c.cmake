@@ -0,0 +1,30 @@
+# SPDX-License-Identifier: BSD-3-Clause
+
+# Converts a binary file to a C array linked into the firmware.
+# Usage: cmake -DIN=<file> -DOUT=<file.c> -DNAME=<symbol> -P bin-to-c.cmake
+# Defines uint8_t <NAME>[] and uint32_t <NAME>_size.
+
+file(READ "${IN}" data HEX)
+string(LENGTH "${data}" size)
+math(EXPR size "${size} / 2")
+
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1, " data "${data}")
+
+# twelve bytes per line, regex has no repetition count
+set(line "")
+foreach(i RANGE 1 12)
+	set(line "${line}0x[0-9a-f][0-9a-f], ")
+endforeach()
+string(REGEX REPLACE "(${line})" "\\1\n\t" data "${data}")
+string(REPLACE " \n" "\n" data "${data}")
+string(REGEX REPLACE "[ \n\t]+$" "" data "${data}")
+
+file(WRITE "${OUT}"
+"/* SPDX-License-Identifier: BSD-3-Clause */\n"
+"/* Generated from ${IN}, do not edit. */\n\n"
+"#include <stdint.h>\n\n"
+"uint8_t ${NAME}[] __attribute__((aligned(4))) = {\n"
+"\t${data}\n"
+"};\n\n"
+"const uint32_t ${NAME}_size = ${size};\n"
+)
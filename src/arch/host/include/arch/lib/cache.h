@@ -17,6 +17,8 @@ static inline void dcache_invalidate_region(void *addr, size_t size) {}
 static inline void icache_invalidate_region(void *addr, size_t size) {}
 static inline void dcache_writeback_invalidate_region(void *addr,
 	size_t size) {}
+static inline void dcache_writeback_all(void) {}
+static inline void dcache_writeback_invalidate_all(void) {}
 
 #endif /* __ARCH_LIB_CACHE_H__ */
 
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __ARCH_LIB_PMU_H__
+#define __ARCH_LIB_PMU_H__
+
+#include <stdint.h>
+
+#define ARCH_PMU_COUNTERS	0
+
+static inline uint32_t arch_pmu_read(int counter) { return 0; }
+
+static inline void arch_pmu_init(void) {}
+
+#endif /* __ARCH_LIB_PMU_H__ */
@@ -77,6 +77,60 @@ static inline void bbzero(void *dest, size_t bytes)
 	dcache_writeback_region(dest, bytes);
 }
 
+#if CONFIG_BOOT_LOADER_COMPRESS
+/* LZ4 length extension, added while the bytes are 255 */
+static inline uint32_t blz4_length(const uint8_t **ip)
+{
+	uint32_t len = 0;
+	uint8_t b;
+
+	do {
+		b = *(*ip)++;
+		len += b;
+	} while (b == 255);
+
+	return len;
+}
+
+/* unpacks LZ4 block until bytes are produced, rimage adds no end mark */
+static void blz4_decompress(void *dest, void *src, size_t bytes)
+{
+	const uint8_t *ip = src;
+	const uint8_t *ref;
+	uint8_t *op = dest;
+	uint8_t *oend = op + bytes;
+	uint32_t len;
+	uint8_t token;
+
+	while (op < oend) {
+		token = *ip++;
+
+		/* literals */
+		len = token >> 4;
+		if (len == 15)
+			len += blz4_length(&ip);
+		while (len--)
+			*op++ = *ip++;
+
+		/* last sequence has no match */
+		if (op >= oend)
+			break;
+
+		/* match, may overlap its own output */
+		ref = op - (ip[0] | (ip[1] << 8));
+		ip += 2;
+		len = token & 0xf;
+		if (len == 15)
+			len += blz4_length(&ip);
+		len += 4;
+		while (len--)
+			*op++ = *ref++;
+	}
+
+	dcache_writeback_region(dest, bytes);
+}
+#endif
+
 static void parse_module(struct sof_man_fw_header *hdr,
 	struct sof_man_module *mod)
 {
@@ -93,6 +147,15 @@ static void parse_module(struct sof_man_fw_header *hdr,
 			bias = (mod->segment[i].file_offset -
 				SOF_MAN_ELF_TEXT_OFFSET);
 
+#if CONFIG_BOOT_LOADER_COMPRESS
+			if (mod->segment[i].flags.r.compressed) {
+				blz4_decompress((void *)mod->segment[i].v_base_addr,
+						(void *)((int)hdr + bias),
+						mod->segment[i].flags.r.length *
+						HOST_PAGE_SIZE);
+				break;
+			}
+#endif
 			/* copy from IMR to SRAM */
 			bmemcpy((void *)mod->segment[i].v_base_addr,
 				(void *)((int)hdr + bias),
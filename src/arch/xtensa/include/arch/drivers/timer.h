@@ -12,6 +12,7 @@
 
 #include <sof/drivers/interrupt.h>
 #include <sof/lib/memory.h>
+#include <xtensa/hal.h>
 #include <stdint.h>
 
 #define ARCH_TIMER_COUNT	3
@@ -34,6 +35,12 @@ int timer64_register(struct timer *timer, void (*handler)(void *arg),
 		     void *arg);
 void timer_64_handler(void *arg);
 
+/* free running core clock cycles from reset, usable before timers are set */
+static inline uint32_t arch_timer_get_cycles(void)
+{
+	return xthal_get_ccount();
+}
+
 static inline int arch_timer_register(struct timer *timer,
 	void (*handler)(void *arg), void *arg)
 {
@@ -42,7 +49,7 @@ static inline int arch_timer_register(struct timer *timer,
 
 	flags = arch_interrupt_global_disable();
 	timer64_register(timer, handler, arg);
-	ret = arch_interrupt_register(timer->irq, timer_64_handler, timer);
+	ret = interrupt_register(timer->irq, timer_64_handler, timer);
 	arch_interrupt_global_enable(flags);
 
 	platform_shared_commit(timer, sizeof(*timer));
@@ -25,6 +25,18 @@ void arch_cpu_disable_core(int id);
 
 int arch_cpu_is_core_enabled(int id);
 
+int arch_cpu_enabled_cores(void);
+
+#if CONFIG_CORE_IDLE_GATING
+void cpu_gate_idle_core(void);
+
+void cpu_wake_core(int id);
+#else
+static inline void cpu_gate_idle_core(void) { }
+
+static inline void cpu_wake_core(int id) { }
+#endif
+
 #else
 
 static inline int arch_cpu_enable_core(int id) { return 0; }
@@ -33,6 +45,11 @@ static inline void arch_cpu_disable_core(int id) { }
 
 static inline int arch_cpu_is_core_enabled(int id) { return 1; }
 
+static inline int arch_cpu_enabled_cores(void)
+{
+	return 1 << PLATFORM_MASTER_CORE_ID;
+}
+
 #endif
 
 static inline int arch_cpu_get_id(void)
@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file arch/xtensa/include/arch/lib/pmu.h
+ * \brief Xtensa performance monitor header file
+ */
+
+#ifndef __ARCH_LIB_PMU_H__
+#define __ARCH_LIB_PMU_H__
+
+#include <xtensa/config/core-isa.h>
+#include <xtensa/xdm-regs.h>
+#include <config.h>
+#include <stdint.h>
+
+#if CONFIG_PERFORMANCE_COUNTERS_PMU && XCHAL_NUM_PERF_COUNTERS
+
+/** \brief Number of events counted at once, one per hardware counter. */
+#define ARCH_PMU_COUNTERS	XCHAL_NUM_PERF_COUNTERS
+
+/** \brief Reads counter of the current core through the ERI bus. */
+static inline uint32_t arch_pmu_read(int counter)
+{
+	uint32_t value;
+
+	__asm__ __volatile__("rer %0, %1"
+			     : "=a" (value)
+			     : "a" (XDM_PERF_PM(counter)));
+
+	return value;
+}
+
+/** \brief Programs and starts counters of the current core. */
+void arch_pmu_init(void);
+
+#else
+
+#define ARCH_PMU_COUNTERS	0
+
+static inline uint32_t arch_pmu_read(int counter) { return 0; }
+
+static inline void arch_pmu_init(void) {}
+
+#endif
+
+#endif /* __ARCH_LIB_PMU_H__ */
@@ -54,6 +54,14 @@ int task_context_alloc(void **task_ctx);
 int task_context_init(void *task_ctx, void *entry, void *arg0, void *arg1,
 		      int task_core, void *stack, int stack_size);
 
+/**
+ * \brief Returns high water mark of task's stack.
+ * \param[in] task_ctx Task context.
+ * \param[out] size Size of the stack.
+ * \return Bytes of the stack used since the context was initialized.
+ */
+uint32_t task_context_stack_used(void *task_ctx, uint32_t *size);
+
 /**
  * \brief Frees task context.
  * \param[in,out] task_ctx Task with context to be freed.
@@ -13,11 +13,17 @@
 #include <config.h>
 #include <stdint.h>
 
+struct sof_ipc_dbg_lock_elem;
+
 typedef struct {
 	volatile uint32_t lock;
 #if CONFIG_DEBUG_LOCKS
 	uint32_t user;
 #endif
+#if CONFIG_DEBUG_LOCK_STATS
+	struct sof_ipc_dbg_lock_elem *stats;	/* set for named locks */
+	uint32_t hold_start;	/* cycles when acquired */
+#endif
 } spinlock_t;
 
 static inline void arch_spinlock_init(spinlock_t *lock)
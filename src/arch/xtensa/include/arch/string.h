@@ -16,8 +16,14 @@
 #include <stddef.h>
 #include <string.h>
 
+/* HiFi3 copies aligned data with 64-bit loads and stores */
+#if __XCC__ && XCHAL_HAVE_HIFI3 && !CONFIG_LIBRARY
+#define arch_memcpy(dest, src, size) \
+	__vec_memcpy(dest, src, size)
+#else
 #define arch_memcpy(dest, src, size) \
 	xthal_memcpy(dest, src, size)
+#endif
 
 #if __XCC__ && !defined(UNIT_TEST)
 #define arch_bzero(ptr, size)	\
@@ -14,6 +14,7 @@
 #include <sof/common.h>
 #include <sof/init.h>
 #include <sof/lib/cpu.h>
+#include <sof/lib/pmu.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
 #include <config.h>
@@ -104,6 +105,7 @@ int arch_init(void)
 {
 	initialize_pointers_per_core();
 	register_exceptions();
+	arch_pmu_init();
 	return 0;
 }
 
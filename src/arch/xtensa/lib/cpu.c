@@ -20,12 +20,18 @@
 #include <sof/lib/mm_heap.h>
 #include <sof/lib/notifier.h>
 #include <sof/lib/pm_runtime.h>
+#include <sof/lib/uuid.h>
 #include <sof/lib/wait.h>
+#include <sof/schedule/edf_schedule.h>
+#include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
 #include <sof/sof.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
+#include <config.h>
 #include <xtos-structs.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* cpu tracing */
@@ -56,6 +62,10 @@ int arch_cpu_enable_core(int id)
 		/* enable IDC interrupt for the the slave core */
 		idc_enable_interrupts(id, cpu_get_id());
 
+		/* writebacks for other cores are skipped while we run alone */
+		if (!cpu_is_multicore_active())
+			dcache_writeback_all();
+
 		/* send IDC power up message */
 		ret = idc_send_msg(&power_up, IDC_POWER_UP);
 		if (ret < 0)
@@ -85,6 +95,13 @@ int arch_cpu_is_core_enabled(int id)
 		active_cores_mask & (1 << id);
 }
 
+int arch_cpu_enabled_cores(void)
+{
+	/* slave may see a stale mask, but it's running for sure */
+	return active_cores_mask | 1 << PLATFORM_MASTER_CORE_ID |
+		1 << cpu_get_id();
+}
+
 void cpu_alloc_core_context(int core)
 {
 	struct core_context *core_ctx;
@@ -109,6 +126,154 @@ void cpu_alloc_core_context(int core)
 	dcache_writeback_region(sof_get(), sizeof(*sof_get()));
 }
 
+#if CONFIG_CORE_IDLE_GATING
+
+/* 76a94566-10ac-4d96-b2c0-09dec6bd3a8d */
+DECLARE_SOF_UUID("core-gate", core_gate_uuid, 0x76a94566, 0x10ac, 0x4d96,
+		 0xb2, 0xc0, 0x09, 0xde, 0xc6, 0xbd, 0x3a, 0x8d);
+
+/* idle gating data of one core */
+struct core_gate {
+	struct task task;	/* idle timeout task */
+	bool armed;		/* timeout task is scheduled */
+	bool timeout;		/* core has been idle for the whole timeout */
+};
+
+/* set by the gated core, cleared by the core waking it up */
+static SHARED_DATA uint32_t core_gated[PLATFORM_CORE_COUNT];
+
+static uint32_t *cpu_gated_get(int core)
+{
+	return platform_shared_get(&core_gated[core], sizeof(core_gated[core]));
+}
+
+static enum task_state cpu_gate_timeout(void *data)
+{
+	struct core_gate *gate = data;
+
+	/* gating itself is done by the main task, not in LL tick */
+	gate->armed = false;
+	gate->timeout = true;
+
+	return SOF_TASK_STATE_COMPLETED;
+}
+
+static struct core_gate *cpu_gate_get(void)
+{
+	struct core_context *ctx = (struct core_context *)cpu_read_threadptr();
+	int ret;
+
+	if (ctx->gate)
+		return ctx->gate;
+
+	ctx->gate = rzalloc(SOF_MEM_ZONE_SYS, 0, SOF_MEM_CAPS_RAM,
+			    sizeof(*ctx->gate));
+	if (!ctx->gate)
+		return NULL;
+
+	ret = schedule_task_init_ll(&ctx->gate->task, SOF_UUID(core_gate_uuid),
+				    SOF_SCHEDULE_LL_TIMER, SOF_TASK_PRI_LOW,
+				    cpu_gate_timeout, ctx->gate, cpu_get_id(),
+				    0);
+	if (ret < 0) {
+		rfree(ctx->gate);
+		ctx->gate = NULL;
+	}
+
+	return ctx->gate;
+}
+
+/* no task other than the timeout task and the main task is scheduled */
+static bool cpu_core_is_idle(struct core_gate *gate)
+{
+	uint32_t ll_tasks = schedule_ll_num_tasks(SOF_SCHEDULE_LL_TIMER) +
+		schedule_ll_num_tasks(SOF_SCHEDULE_LL_DMA);
+
+	if (gate->armed && ll_tasks)
+		ll_tasks--;
+
+	return !ll_tasks && !schedule_edf_num_tasks();
+}
+
+static void cpu_gate_core(struct core_gate *gate)
+{
+	int core = cpu_get_id();
+	uint32_t *gated = cpu_gated_get(core);
+	uint32_t flags;
+
+	trace_cpu("cpu_gate_core()");
+
+	irq_local_disable(flags);
+
+	*gated = 1;
+
+	/* other cores may change shared data while this one is gated */
+	dcache_writeback_invalidate_all();
+
+	pm_runtime_put(PM_RUNTIME_DSP, core);
+
+	/* Pending IDC is taken by the first waiti. Message sent before
+	 * the gated flag was set doesn't clear it, but may schedule
+	 * a task, which ends the gating too.
+	 */
+	while (*gated && cpu_core_is_idle(gate))
+		arch_wait_for_interrupt(0);
+
+	if (*gated) {
+		*gated = 0;
+		pm_runtime_get(PM_RUNTIME_DSP, core);
+	}
+
+	irq_local_enable(flags);
+
+	trace_cpu("cpu_gate_core() resumed");
+}
+
+/* Called by the main task of a secondary core after every wake up. Idle
+ * core schedules a timeout task and is gated once the timeout expires
+ * with the core still idle. Any new task cancels the timeout.
+ */
+void cpu_gate_idle_core(void)
+{
+	struct core_gate *gate = cpu_gate_get();
+
+	if (!gate)
+		return;
+
+	if (!cpu_core_is_idle(gate)) {
+		gate->timeout = false;
+		if (gate->armed) {
+			gate->armed = false;
+			schedule_task_cancel(&gate->task);
+		}
+		return;
+	}
+
+	if (gate->timeout) {
+		gate->timeout = false;
+		cpu_gate_core(gate);
+	} else if (!gate->armed) {
+		gate->armed = true;
+		schedule_task(&gate->task,
+			      CONFIG_CORE_IDLE_GATING_TIMEOUT_MS * 1000,
+			      CONFIG_CORE_IDLE_GATING_TIMEOUT_MS * 1000);
+	}
+}
+
+/* wakes up gated core, IDC sent afterwards ends its waiti */
+void cpu_wake_core(int id)
+{
+	uint32_t *gated = cpu_gated_get(id);
+
+	if (!*gated)
+		return;
+
+	*gated = 0;
+	pm_runtime_get(PM_RUNTIME_DSP, id);
+}
+
+#endif /* CONFIG_CORE_IDLE_GATING */
+
 void cpu_power_down_core(void)
 {
 	arch_interrupt_global_disable();
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file arch/xtensa/lib/pmu.c
+ * \brief Xtensa performance monitor driver
+ */
+
+#include <sof/bit.h>
+#include <sof/lib/pmu.h>
+#include <sof/math/numbers.h>
+#include <xtensa/config/core-isa.h>
+#include <xtensa/xdm-regs.h>
+#include <stdint.h>
+
+#if XCHAL_NUM_PERF_COUNTERS
+
+/* PMG register */
+#define PMU_PMG_PMEN		BIT(0)
+
+/* PMCTRL registers */
+#define PMU_PMCTRL_KRNLCNT	BIT(3)
+#define PMU_PMCTRL_TRACELEVEL	(0xf << 4)	/* count at all levels */
+#define PMU_PMCTRL_SELECT_SHIFT	8
+#define PMU_PMCTRL_MASK_SHIFT	16
+
+#define PMU_PMCTRL(select, mask) \
+	(((select) << PMU_PMCTRL_SELECT_SHIFT) | \
+	 ((mask) << PMU_PMCTRL_MASK_SHIFT) | \
+	 PMU_PMCTRL_TRACELEVEL | PMU_PMCTRL_KRNLCNT)
+
+/* event selection of each pmu_event */
+static const uint32_t pmu_event_ctrl[PMU_EVENTS] = {
+	[PMU_EVENT_STALL_DATA]	= PMU_PMCTRL(3, 0x1ff),
+	[PMU_EVENT_STALL_INSTR]	= PMU_PMCTRL(4, 0x1ff),
+	[PMU_EVENT_DCACHE_MISS]	= PMU_PMCTRL(12, 0x1),
+	[PMU_EVENT_ICACHE_MISS]	= PMU_PMCTRL(8, 0x2),
+};
+
+static inline void pmu_write(uint32_t reg, uint32_t value)
+{
+	__asm__ __volatile__("wer %0, %1"
+			     : : "a" (value), "a" (reg) : "memory");
+}
+
+void arch_pmu_init(void)
+{
+	int i;
+
+	pmu_write(XDM_PERF_PMG, 0);
+
+	for (i = 0; i < MIN(ARCH_PMU_COUNTERS, PMU_EVENTS); i++) {
+		pmu_write(XDM_PERF_PMCTRL(i), pmu_event_ctrl[i]);
+		pmu_write(XDM_PERF_PM(i), 0);
+		/* overflow is write-one-to-clear, counters just wrap */
+		pmu_write(XDM_PERF_PMSTAT(i), 0xffffffff);
+	}
+
+	pmu_write(XDM_PERF_PMG, PMU_PMG_PMEN);
+}
+
+#endif /* XCHAL_NUM_PERF_COUNTERS */
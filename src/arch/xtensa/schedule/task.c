@@ -20,6 +20,7 @@
 #include <sof/schedule/edf_schedule.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
+#include <sof/string.h>
 #include <ipc/topology.h>
 #include <config.h>
 #include <xtensa/corebits.h>
@@ -29,6 +30,15 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/* unused stack keeps this pattern, so its high water mark can be found */
+#define TASK_STACK_PAINT	0xa5
+
+#if CONFIG_TASK_STACK_SIZE
+#define TASK_STACK_SIZE		CONFIG_TASK_STACK_SIZE
+#else
+#define TASK_STACK_SIZE		PLATFORM_TASK_DEFAULT_STACK_SIZE
+#endif
+
 enum task_state task_main_slave_core(void *data)
 {
 #if CONFIG_SMP
@@ -36,6 +46,9 @@ enum task_state task_main_slave_core(void *data)
 	while (1) {
 		/* sleep until next IDC or DMA */
 		wait_for_interrupt(0);
+
+		/* gate the core once it's idle for long enough */
+		cpu_gate_idle_core();
 	}
 #endif
 
@@ -84,13 +97,13 @@ int task_context_init(void *task_ctx, void *entry, void *arg0, void *arg1,
 		ctx->stack_size = stack_size;
 	} else {
 		ctx->stack_base = rballoc(0, SOF_MEM_CAPS_RAM,
-					  PLATFORM_TASK_DEFAULT_STACK_SIZE);
+					  TASK_STACK_SIZE);
 		if (!ctx->stack_base)
 			return -ENOMEM;
-		ctx->stack_size = PLATFORM_TASK_DEFAULT_STACK_SIZE;
+		ctx->stack_size = TASK_STACK_SIZE;
 		ctx->flags |= XTOS_TASK_CONTEXT_OWN_STACK;
 	}
-	bzero(ctx->stack_base, ctx->stack_size);
+	memset(ctx->stack_base, TASK_STACK_PAINT, ctx->stack_size);
 
 	/* set initial stack pointer */
 	sp = (UserFrame *)((char *)ctx->stack_base + ctx->stack_size -
@@ -116,6 +129,21 @@ int task_context_init(void *task_ctx, void *entry, void *arg0, void *arg1,
 	return 0;
 }
 
+uint32_t task_context_stack_used(void *task_ctx, uint32_t *size)
+{
+	xtos_task_context *ctx = task_ctx;
+	const uint8_t *end = (uint8_t *)ctx->stack_base + ctx->stack_size;
+	const uint8_t *p = ctx->stack_base;
+
+	/* stack grows down, so the paint is left at its base */
+	while (p < end && *p == TASK_STACK_PAINT)
+		p++;
+
+	*size = ctx->stack_size;
+
+	return end - p;
+}
+
 void task_context_free(void *task_ctx)
 {
 	xtos_task_context *ctx = task_ctx;
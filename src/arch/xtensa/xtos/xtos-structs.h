@@ -15,6 +15,7 @@
 #include <xtensa/xtruntime-frames.h>
 #include <stdint.h>
 
+struct core_gate;
 struct idc;
 struct notify;
 struct schedulers;
@@ -55,6 +56,7 @@ struct core_context {
 	struct schedulers *schedulers;
 	struct notify *notify;
 	struct idc *idc;
+	struct core_gate *gate;
 };
 
 #endif /* __XTOS_XTOS_STRUCTS_H__ */
@@ -2,6 +2,7 @@
 //
 // Copyright(c) 2019 Intel Corporation. All rights reserved.
 
+#include <sof/audio/asrc/asrc_config.h>
 #include <sof/audio/asrc/asrc_farrow.h>
 #include <sof/audio/buffer.h>
 #include <sof/audio/component.h>
@@ -11,6 +12,7 @@
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/memory.h>
+#include <sof/lib/overlay.h>
 #include <sof/lib/uuid.h>
 #include <sof/math/numbers.h>
 #include <sof/trace/trace.h>
@@ -26,6 +28,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#if ASRC_HIFI3
+#include <xtensa/tie/xt_hifi3.h>
+#endif
+
 /* Simple count value to prevent first delta timestamp
  * from being input to low-pass filter.
  */
@@ -38,6 +44,27 @@
 #define COEF_C1		Q_CONVERT_FLOAT(0.01, 30)
 #define COEF_C2		Q_CONVERT_FLOAT(0.99, 30)
 
+/* Drift estimate of a DAI clock domain. It is shared by all ASRCs that
+ * track the same DAI at the same rate. The first of them to run in a
+ * period reads the DAI timestamp and updates the estimate, the others
+ * pick up the result. All fields are accessed from the DAI core only.
+ */
+struct asrc_drift {
+	struct list_item list;
+	struct comp_dev *dai_dev;	/* Tracked DAI component */
+	int32_t fs;		/* DAI side sample rate in Hz */
+	uint32_t seq;		/* Count of periods handled */
+	int refs;		/* Count of ASRCs tracking the domain */
+	int32_t ts_prev;
+	int32_t sample_prev;
+	int32_t skew;		/* Rate factor in Q2.30 */
+	int32_t f_ck_fs;	/* Wall clock per sample rate in Q1.31 */
+	uint32_t walclk_rate;	/* Wall clock rate for f_ck_fs */
+	uint32_t ds_recip;	/* Reciprocal of ds_recip_n in Q1.31 */
+	int32_t ds_recip_n;	/* Delta samples for ds_recip */
+	int ts_count;
+};
+
 typedef void (*asrc_proc_func)(struct comp_dev *dev,
 			       const struct audio_stream *source,
 			       struct audio_stream *sink,
@@ -46,6 +73,9 @@ typedef void (*asrc_proc_func)(struct comp_dev *dev,
 
 static const struct comp_driver comp_asrc;
 
+/* DAI clock domains tracked by ASRCs */
+static SHARED_DATA struct list_item asrc_drift_list;
+
 /* c8ec72f6-8526-4faf-9d39-a23d0b541de2 */
 DECLARE_SOF_UUID("asrc", asrc_uuid, 0xc8ec72f6, 0x8526, 0x4faf,
 		 0x9d, 0x39, 0xa2, 0x3d, 0x0b, 0x54, 0x1d, 0xe2);
@@ -54,6 +84,8 @@ DECLARE_SOF_UUID("asrc", asrc_uuid, 0xc8ec72f6, 0x8526, 0x4faf,
 struct comp_data {
 	struct asrc_farrow *asrc_obj;	/* ASRC core data */
 	struct comp_dev *dai_dev;	/* Associated DAI component */
+	struct asrc_drift *drift;	/* Drift estimate of DAI domain */
+	uint32_t drift_seq;		/* Drift period last picked up */
 	enum asrc_operation_mode mode;  /* Control for push or pull mode */
 	uint64_t ts;
 	uint32_t sink_rate;	/* Sample rate in Hz */
@@ -61,10 +93,7 @@ struct comp_data {
 	uint32_t sink_format;	/* For used PCM sample format */
 	uint32_t source_format;	/* For used PCM sample format */
 	uint32_t copy_count;	/* Count copy() operations  */
-	int32_t ts_prev;
-	int32_t sample_prev;
 	int32_t skew;		/* Rate factor in Q2.30 */
-	int ts_count;
 	int asrc_size;		/* ASRC object size */
 	int buf_size;		/* Samples buffer size */
 	int frames;		/* IO buffer length */
@@ -82,34 +111,129 @@ struct comp_data {
 
 /* In-line functions */
 
-static inline void src_inc_wrap(int32_t **ptr, int32_t *end, size_t size)
+static inline void src_inc_wrap_s16(int16_t **ptr, int16_t *end, size_t size)
 {
 	if (*ptr >= end)
-		*ptr = (int32_t *)((uint8_t *)*ptr - size);
+		*ptr = (int16_t *)((uint8_t *)*ptr - size);
 }
 
-static inline void src_inc_wrap_s16(int16_t **ptr, int16_t *end, size_t size)
+#if ASRC_HIFI3
+
+/* Reads samples from circular source to linear buffer with a left shift,
+ * the source wrap is handled by HiFi3 circular addressing.
+ */
+static void __overlay_text(asrc)
+asrc_read_s32(const struct audio_stream *source, int32_t *buf,
+	      int samples, int shift)
 {
-	if (*ptr >= end)
-		*ptr = (int16_t *)((uint8_t *)*ptr - size);
+	ae_int32x2 d = AE_ZERO32();
+	ae_int32 *src = (ae_int32 *)source->r_ptr;
+	ae_int32 *dst = (ae_int32 *)buf;
+	int i;
+
+	AE_SETCBEGIN0(source->addr);
+	AE_SETCEND0(source->end_addr);
+	for (i = 0; i < samples; i++) {
+		AE_L32_XC(d, src, sizeof(ae_int32));
+		d = AE_SLAA32(d, shift);
+		AE_S32_L_IP(d, dst, sizeof(ae_int32));
+	}
 }
 
-/* A fast copy function for same in and out rate */
-static void src_copy_s32(struct comp_dev *dev,
-			 const struct audio_stream *source,
-			 struct audio_stream *sink,
-			 int *n_read, int *n_written)
+/* Writes samples from linear buffer to circular sink with a right shift */
+static void __overlay_text(asrc) asrc_write_s32(struct audio_stream *sink,
+						const int32_t *buf, int samples,
+						int shift)
+{
+	ae_int32x2 d = AE_ZERO32();
+	ae_int32 *src = (ae_int32 *)buf;
+	ae_int32 *snk = (ae_int32 *)sink->w_ptr;
+	int i;
+
+	AE_SETCBEGIN0(sink->addr);
+	AE_SETCEND0(sink->end_addr);
+	for (i = 0; i < samples; i++) {
+		AE_L32_IP(d, src, sizeof(ae_int32));
+		d = AE_SRAA32(d, shift);
+		AE_S32_L_XC(d, snk, sizeof(ae_int32));
+	}
+}
+
+#else
+
+/* Reads samples from circular source to linear buffer with a left shift,
+ * in blocks up to the source wrap.
+ */
+static void __overlay_text(asrc)
+asrc_read_s32(const struct audio_stream *source, int32_t *buf,
+	      int samples, int shift)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *buf;
 	int32_t *src = (int32_t *)source->r_ptr;
+	int n_copy;
+	int ret;
+	int i;
+
+	while (samples > 0) {
+		n_copy = MIN(samples,
+			     (int)audio_stream_samples_without_wrap_s32(source,
+									src));
+		if (shift) {
+			for (i = 0; i < n_copy; i++)
+				buf[i] = src[i] << shift;
+		} else {
+			ret = memcpy_s(buf, n_copy * sizeof(int32_t), src,
+				       n_copy * sizeof(int32_t));
+			assert(!ret);
+		}
+
+		samples -= n_copy;
+		buf += n_copy;
+		src = audio_stream_wrap(source, src + n_copy);
+	}
+}
+
+/* Writes samples from linear buffer to circular sink with a right shift,
+ * in blocks up to the sink wrap.
+ */
+static void __overlay_text(asrc) asrc_write_s32(struct audio_stream *sink,
+						const int32_t *buf, int samples,
+						int shift)
+{
 	int32_t *snk = (int32_t *)sink->w_ptr;
-	int n_wrap_src;
-	int n_wrap_snk;
 	int n_copy;
-	int n;
 	int ret;
 	int i;
+
+	while (samples > 0) {
+		n_copy = MIN(samples,
+			     (int)audio_stream_samples_without_wrap_s32(sink,
+									snk));
+		if (shift) {
+			for (i = 0; i < n_copy; i++)
+				snk[i] = buf[i] >> shift;
+		} else {
+			ret = memcpy_s(snk, n_copy * sizeof(int32_t), buf,
+				       n_copy * sizeof(int32_t));
+			assert(!ret);
+		}
+
+		samples -= n_copy;
+		buf += n_copy;
+		snk = audio_stream_wrap(sink, snk + n_copy);
+	}
+}
+
+#endif /* ASRC_HIFI3 */
+
+/* A fast copy function for same in and out rate */
+static void __overlay_text(asrc) src_copy_s32(struct comp_dev *dev,
+					      const struct audio_stream *source,
+					      struct audio_stream *sink,
+					      int *n_read, int *n_written)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int n;
+	int ret;
 	int frames = 0;
 	int idx = 0;
 
@@ -117,18 +241,8 @@ static void src_copy_s32(struct comp_dev *dev,
 	/* TODO: S24_4LE handling */
 
 	/* Copy input data from source */
-	buf = (int32_t *)cd->ibuf[0];
-	n = cd->source_frames * source->channels;
-	while (n > 0) {
-		n_wrap_src = (int32_t *)source->end_addr - src;
-		n_copy = (n < n_wrap_src) ? n : n_wrap_src;
-		for (i = 0; i < n_copy; i++)
-			*buf++ = (*src++) << cd->data_shift;
-
-		/* Update and check both source and destination for wrap */
-		n -= n_copy;
-		src_inc_wrap(&src, source->end_addr, source->size);
-	}
+	asrc_read_s32(source, (int32_t *)cd->ibuf[0],
+		      cd->source_frames * source->channels, cd->data_shift);
 
 	/* Run ASRC */
 	if (cd->mode == ASRC_OM_PUSH) {
@@ -150,17 +264,7 @@ static void src_copy_s32(struct comp_dev *dev,
 	if (ret)
 		comp_err(dev, "src_copy_s32(), error %d", ret);
 
-	buf = (int32_t *)cd->obuf[0];
-	while (n > 0) {
-		n_wrap_snk = (int32_t *)sink->end_addr - snk;
-		n_copy = (n < n_wrap_snk) ? n : n_wrap_snk;
-		for (i = 0; i < n_copy; i++)
-			*snk++ = (*buf++) >> cd->data_shift;
-
-		/* Update and check both source and destination for wrap */
-		n -= n_copy;
-		src_inc_wrap(&snk, sink->end_addr, sink->size);
-	}
+	asrc_write_s32(sink, (int32_t *)cd->obuf[0], n, cd->data_shift);
 
 	if (cd->mode == ASRC_OM_PUSH) {
 		*n_read = cd->source_frames;
@@ -171,10 +275,10 @@ static void src_copy_s32(struct comp_dev *dev,
 	}
 }
 
-static void src_copy_s16(struct comp_dev *dev,
-			 const struct audio_stream *source,
-			 struct audio_stream *sink,
-			 int *n_read, int *n_written)
+static void __overlay_text(asrc) src_copy_s16(struct comp_dev *dev,
+					      const struct audio_stream *source,
+					      struct audio_stream *sink,
+					      int *n_read, int *n_written)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int16_t *src = (int16_t *)source->r_ptr;
@@ -311,12 +415,98 @@ static struct comp_dev *asrc_new(const struct comp_driver *drv,
 	return dev;
 }
 
+static int asrc_dai_configure_timestamp(struct asrc_drift *drift)
+{
+	return drift->dai_dev->drv->ops.dai_ts_config(drift->dai_dev);
+}
+
+static int asrc_dai_start_timestamp(struct asrc_drift *drift)
+{
+	return drift->dai_dev->drv->ops.dai_ts_start(drift->dai_dev);
+}
+
+static int asrc_dai_stop_timestamp(struct asrc_drift *drift)
+{
+	return drift->dai_dev->drv->ops.dai_ts_stop(drift->dai_dev);
+}
+
+static int asrc_dai_get_timestamp(struct asrc_drift *drift,
+				  struct timestamp_data *tsd)
+{
+	return drift->dai_dev->drv->ops.dai_ts_get(drift->dai_dev, tsd);
+}
+
+static struct list_item *asrc_drift_list_get(void)
+{
+	return platform_shared_get(&asrc_drift_list, sizeof(asrc_drift_list));
+}
+
+/* Unsubscribes the ASRC, the last one stops the DAI timestamping */
+static void asrc_drift_put(struct comp_data *cd)
+{
+	struct asrc_drift *drift = cd->drift;
+
+	cd->drift = NULL;
+	if (!drift || --drift->refs > 0)
+		return;
+
+	asrc_dai_stop_timestamp(drift);
+	list_item_del(&drift->list);
+	rfree(drift);
+}
+
+/* Subscribes the ASRC to the drift estimate of its DAI, the estimate is
+ * created with timestamping configured for the first subscriber.
+ */
+static int asrc_drift_get(struct comp_dev *dev, struct comp_data *cd)
+{
+	struct asrc_drift *drift;
+	struct list_item *dlist;
+	int fs = cd->asrc_obj->fs_sec;
+	int ret;
+
+	/* prepare() without reset() in between */
+	asrc_drift_put(cd);
+
+	list_for_item(dlist, asrc_drift_list_get()) {
+		drift = container_of(dlist, struct asrc_drift, list);
+		if (drift->dai_dev == cd->dai_dev && drift->fs == fs) {
+			comp_info(dev, "asrc_drift_get(), shared with %d",
+				  drift->refs);
+			goto out;
+		}
+	}
+
+	drift = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			sizeof(*drift));
+	if (!drift)
+		return -ENOMEM;
+
+	drift->dai_dev = cd->dai_dev;
+	drift->fs = fs;
+	drift->skew = cd->skew;
+	ret = asrc_dai_configure_timestamp(drift);
+	if (ret) {
+		rfree(drift);
+		return ret;
+	}
+
+	list_item_prepend(&drift->list, asrc_drift_list_get());
+
+out:
+	drift->refs++;
+	cd->drift = drift;
+	cd->drift_seq = drift->seq;
+	return 0;
+}
+
 static void asrc_free(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 
 	comp_info(dev, "asrc_free()");
 
+	asrc_drift_put(cd);
 	rfree(cd->buf);
 	rfree(cd->asrc_obj);
 	rfree(cd);
@@ -492,49 +682,82 @@ static int asrc_dai_find(struct comp_dev *dev,
 	return 0;
 }
 
-static int asrc_dai_configure_timestamp(struct comp_data *cd)
+/* Reads the DAI timestamp and updates the filtered skew estimate */
+static int __overlay_text(asrc) asrc_drift_update(struct asrc_drift *drift)
 {
-	int ret;
-
-	if (cd->dai_dev)
-		ret = cd->dai_dev->drv->ops.dai_ts_config(cd->dai_dev);
-	else
-		return -EINVAL;
+	struct timestamp_data tsd;
+	int64_t tmp;
+	int32_t delta_sample;
+	int32_t delta_ts;
+	int32_t sample;
+	int32_t ts;
+	int32_t skew;
+	int32_t f_ds_dt;
+	int32_t f_ck_fs;
+	int ts_ret;
 
-	return ret;
-}
+	drift->seq++;
 
-static int asrc_dai_start_timestamp(struct comp_data *cd)
-{
-	int ret;
+	if (!drift->ts_count) {
+		drift->ts_count++;
+		asrc_dai_start_timestamp(drift);
+		return 0;
+	}
 
-	if (cd->dai_dev)
-		ret = cd->dai_dev->drv->ops.dai_ts_start(cd->dai_dev);
-	else
-		return -EINVAL;
+	/* the DAI takes and re-arms the timestamp in each copy */
+	ts_ret = asrc_dai_get_timestamp(drift, &tsd);
+	if (ts_ret)
+		return ts_ret;
 
-	return ret;
-}
+	ts = (int32_t)(tsd.walclk); /* Let it wrap, diff unwraps */
+	sample = (int32_t)(tsd.sample); /* Let it wrap, diff unwraps */
+	delta_ts = ts - drift->ts_prev;
+	delta_sample = sample - drift->sample_prev;
+	drift->ts_prev = ts;
+	drift->sample_prev = sample;
 
-static int asrc_dai_stop_timestamp(struct comp_data *cd)
-{
-	int ret;
+	/* Avoid first delta timestamp(s) those can be off and
+	 * confuse the filter.
+	 */
+	if (drift->ts_count < TS_STABLE_DIFF_COUNT) {
+		drift->ts_count++;
+		return 0;
+	}
 
-	if (cd->dai_dev)
-		ret = cd->dai_dev->drv->ops.dai_ts_stop(cd->dai_dev);
-	else
+	/* Prevent divide by zero */
+	if (delta_sample <= 0 || tsd.walclk_rate == 0) {
+		comp_cl_err(&comp_asrc, "asrc_drift_update(), DAI timestamp failed");
 		return -EINVAL;
+	}
 
-	return ret;
-}
+	/* The samples count per period changes rarely and the wall clock
+	 * rate not at all, so the divides are done only on change.
+	 * Reciprocal ds_recip is Q1.31 in unsigned to fit 1.0.
+	 */
+	if (delta_sample != drift->ds_recip_n) {
+		drift->ds_recip = (1u << 31) / delta_sample;
+		drift->ds_recip_n = delta_sample;
+	}
 
-static int asrc_dai_get_timestamp(struct comp_data *cd,
-				  struct timestamp_data *tsd)
-{
-	if (!cd->dai_dev)
-		return -EINVAL;
+	if (tsd.walclk_rate != drift->walclk_rate) {
+		drift->f_ck_fs = ((int64_t)drift->fs << 31) / tsd.walclk_rate;
+		drift->walclk_rate = tsd.walclk_rate;
+	}
+
+	/* fraction f_ds_dt is Q20.12, from Q32.31 product
+	 * fraction f_cd_fs is Q1.31
+	 * drift needs to be Q2.30
+	 */
+	f_ds_dt = ((int64_t)delta_ts * drift->ds_recip) >> 19;
+	f_ck_fs = drift->f_ck_fs;
+	skew = q_multsr_sat_32x32(f_ds_dt, f_ck_fs, 13);
 
-	return cd->dai_dev->drv->ops.dai_ts_get(cd->dai_dev, tsd);
+	/* tmp is Q4.60, shift and round to Q2.30 */
+	tmp = ((int64_t)COEF_C1) * skew + ((int64_t)COEF_C2) * drift->skew;
+	drift->skew = sat_int32(Q_SHIFT_RND(tmp, 60, 30));
+	comp_cl_dbg(&comp_asrc, "skew %d %d %d %d", delta_sample, delta_ts,
+		    skew, drift->skew);
+	return 0;
 }
 
 static int asrc_prepare(struct comp_dev *dev)
@@ -682,6 +905,12 @@ static int asrc_prepare(struct comp_dev *dev)
 		goto err_free_asrc;
 	}
 
+#if CONFIG_PIPELINE_LATENCY
+	/* half of the filter at the source rate, in sink frames */
+	dev->delay_frames = cd->asrc_obj->filter_length * cd->sink_rate /
+		(2 * cd->source_rate);
+#endif
+
 	/* Prefer previous skew factor. If the component has not yet been
 	 * run the skew is zero from new(). In that case use factor 1.0
 	 * to start with.
@@ -705,8 +934,7 @@ static int asrc_prepare(struct comp_dev *dev)
 			goto err_free_asrc;
 		}
 
-		cd->ts_count = 0;
-		ret = asrc_dai_configure_timestamp(cd);
+		ret = asrc_drift_get(dev, cd);
 		if (ret) {
 			comp_err(dev, "No timestamp capability in DAI");
 			cd->track_drift = false;
@@ -729,73 +957,36 @@ err:
 	return ret;
 }
 
-static int asrc_control_loop(struct comp_dev *dev, struct comp_data *cd)
+static int __overlay_text(asrc) asrc_control_loop(struct comp_dev *dev,
+						  struct comp_data *cd)
 {
-	struct timestamp_data tsd;
-	int64_t tmp;
-	int32_t delta_sample;
-	int32_t delta_ts;
-	int32_t sample;
-	int32_t ts;
-	int32_t skew;
-	int32_t f_ds_dt;
-	int32_t f_ck_fs;
-	int ts_ret;
+	struct asrc_drift *drift = cd->drift;
+	int ret;
 
 	if (!cd->track_drift)
 		return 0;
 
-	if (!cd->ts_count) {
-		cd->ts_count++;
-		asrc_dai_start_timestamp(cd);
-		return 0;
-	}
-
-	ts_ret = asrc_dai_get_timestamp(cd, &tsd);
-	asrc_dai_start_timestamp(cd);
-	if (ts_ret)
-		return ts_ret;
-
-	ts = (int32_t)(tsd.walclk); /* Let it wrap, diff unwraps */
-	sample = (int32_t)(tsd.sample); /* Let it wrap, diff unwraps */
-	delta_ts = ts - cd->ts_prev;
-	delta_sample = sample - cd->sample_prev;
-	cd->ts_prev = ts;
-	cd->sample_prev = sample;
-
-	/* Avoid first delta timestamp(s) those can be off and
-	 * confuse the filter.
+	/* The domain estimate is updated once per period, by the ASRC
+	 * that has already picked up the previous update.
 	 */
-	if (cd->ts_count < TS_STABLE_DIFF_COUNT) {
-		cd->ts_count++;
-		return 0;
+	if (cd->drift_seq == drift->seq) {
+		ret = asrc_drift_update(drift);
+		if (ret)
+			return ret;
 	}
 
-	/* Prevent divide by zero */
-	if (delta_sample == 0 || tsd.walclk_rate == 0) {
-		comp_cl_err(&comp_asrc, "asrc_control_loop(), DAI timestamp failed");
-		return -EINVAL;
+	cd->drift_seq = drift->seq;
+	if (drift->skew != cd->skew) {
+		cd->skew = drift->skew;
+		asrc_update_drift(dev, cd->asrc_obj, cd->skew);
 	}
 
-	/* fraction f_ds_dt is Q20.12
-	 * fraction f_cd_fs is Q1.31
-	 * drift needs to be Q2.30
-	 */
-	f_ds_dt = (delta_ts << 12) / delta_sample;
-	f_ck_fs = ((int64_t)cd->asrc_obj->fs_sec << 31) / tsd.walclk_rate;
-	skew = q_multsr_sat_32x32(f_ds_dt, f_ck_fs, 13);
-
-	/* tmp is Q4.60, shift and round to Q2.30 */
-	tmp = ((int64_t)COEF_C1) * skew + ((int64_t)COEF_C2) * cd->skew;
-	cd->skew = sat_int32(Q_SHIFT_RND(tmp, 60, 30));
-	asrc_update_drift(dev, cd->asrc_obj, cd->skew);
-	comp_cl_dbg(&comp_asrc, "skew %d %d %d %d", delta_sample, delta_ts,
-		    skew, cd->skew);
 	return 0;
 }
 
-static void asrc_process(struct comp_dev *dev, struct comp_buffer *source,
-			 struct comp_buffer *sink)
+static void __overlay_text(asrc) asrc_process(struct comp_dev *dev,
+					      struct comp_buffer *source,
+					      struct comp_buffer *sink)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int consumed = 0;
@@ -818,7 +1009,7 @@ static void asrc_process(struct comp_dev *dev, struct comp_buffer *source,
 }
 
 /* copy and process stream data from source to sink buffers */
-static int asrc_copy(struct comp_dev *dev)
+static int __overlay_text(asrc) asrc_copy(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *source;
@@ -888,7 +1079,7 @@ static int asrc_reset(struct comp_dev *dev)
 
 	/* If any resources feasible to stop */
 	if (cd->track_drift)
-		asrc_dai_stop_timestamp(cd);
+		asrc_drift_put(cd);
 
 	/* Free the allocations those were done in prepare() */
 	rfree(cd->asrc_obj);
@@ -903,6 +1094,7 @@ static int asrc_reset(struct comp_dev *dev)
 static const struct comp_driver comp_asrc = {
 	.type = SOF_COMP_ASRC,
 	.uid = SOF_UUID(asrc_uuid),
+	.overlay = OVERLAY(asrc),
 	.ops = {
 		.create = asrc_new,
 		.free = asrc_free,
@@ -921,6 +1113,7 @@ static SHARED_DATA struct comp_driver_info comp_asrc_info = {
 
 static void sys_comp_asrc_init(void)
 {
+	list_init(asrc_drift_list_get());
 	comp_register(platform_shared_get(&comp_asrc_info,
 					  sizeof(comp_asrc_info)));
 }
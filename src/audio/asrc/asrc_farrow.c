@@ -6,6 +6,7 @@
 
 #include <sof/common.h>
 #include <sof/debug/panic.h>
+#include <sof/lib/overlay.h>
 #include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <sof/string.h>
@@ -888,8 +889,9 @@ enum asrc_error_code asrc_update_fs_ratio(struct comp_dev *dev,
 	return ASRC_EC_OK;
 }
 
-void asrc_write_to_ring_buffer16(struct asrc_farrow  *src_obj,
-				 int16_t **input_buffers, int index_input_frame)
+void __overlay_text(asrc)
+asrc_write_to_ring_buffer16(struct asrc_farrow  *src_obj,
+			    int16_t **input_buffers, int index_input_frame)
 {
 	int ch;
 	int j;
@@ -930,8 +932,9 @@ void asrc_write_to_ring_buffer16(struct asrc_farrow  *src_obj,
 	}
 }
 
-void asrc_write_to_ring_buffer32(struct asrc_farrow  *src_obj,
-				 int32_t **input_buffers, int index_input_frame)
+void __overlay_text(asrc)
+asrc_write_to_ring_buffer32(struct asrc_farrow  *src_obj,
+			    int32_t **input_buffers, int index_input_frame)
 {
 	int ch;
 	int j;
@@ -972,14 +975,15 @@ void asrc_write_to_ring_buffer32(struct asrc_farrow  *src_obj,
 	}
 }
 
-enum asrc_error_code asrc_process_push16(struct comp_dev *dev,
-					 struct asrc_farrow *src_obj,
-					 int16_t **__restrict input_buffers,
-					 int input_num_frames,
-					 int16_t **__restrict output_buffers,
-					 int *output_num_frames,
-					 int *write_index,
-					 int read_index)
+enum asrc_error_code __overlay_text(asrc)
+asrc_process_push16(struct comp_dev *dev,
+		    struct asrc_farrow *src_obj,
+		    int16_t **__restrict input_buffers,
+		    int input_num_frames,
+		    int16_t **__restrict output_buffers,
+		    int *output_num_frames,
+		    int *write_index,
+		    int read_index)
 {
 	int index_input_frame;
 	int max_num_free_frames;
@@ -1085,14 +1089,15 @@ enum asrc_error_code asrc_process_push16(struct comp_dev *dev,
 	return ASRC_EC_OK;
 }
 
-enum asrc_error_code asrc_process_push32(struct comp_dev *dev,
-					 struct asrc_farrow *src_obj,
-					 int32_t **__restrict input_buffers,
-					 int input_num_frames,
-					 int32_t **__restrict output_buffers,
-					 int *output_num_frames,
-					 int *write_index,
-					 int read_index)
+enum asrc_error_code __overlay_text(asrc)
+asrc_process_push32(struct comp_dev *dev,
+		    struct asrc_farrow *src_obj,
+		    int32_t **__restrict input_buffers,
+		    int input_num_frames,
+		    int32_t **__restrict output_buffers,
+		    int *output_num_frames,
+		    int *write_index,
+		    int read_index)
 {
 	/* See 'process_push16' for a more detailed description of the
 	 * algorithm
@@ -1199,14 +1204,15 @@ enum asrc_error_code asrc_process_push32(struct comp_dev *dev,
 	return ASRC_EC_OK;
 }
 
-enum asrc_error_code asrc_process_pull16(struct comp_dev *dev,
-					 struct asrc_farrow *src_obj,
-					 int16_t **__restrict input_buffers,
-					 int *input_num_frames,
-					 int16_t **__restrict output_buffers,
-					 int output_num_frames,
-					 int write_index,
-					 int *read_index)
+enum asrc_error_code __overlay_text(asrc)
+asrc_process_pull16(struct comp_dev *dev,
+		    struct asrc_farrow *src_obj,
+		    int16_t **__restrict input_buffers,
+		    int *input_num_frames,
+		    int16_t **__restrict output_buffers,
+		    int output_num_frames,
+		    int write_index,
+		    int *read_index)
 {
 	int index_output_frame = 0;
 
@@ -1301,14 +1307,15 @@ enum asrc_error_code asrc_process_pull16(struct comp_dev *dev,
 	return ASRC_EC_OK;
 }
 
-enum asrc_error_code asrc_process_pull32(struct comp_dev *dev,
-					 struct asrc_farrow *src_obj,
-					 int32_t **__restrict input_buffers,
-					 int *input_num_frames,
-					 int32_t **__restrict output_buffers,
-					 int output_num_frames,
-					 int write_index,
-					 int *read_index)
+enum asrc_error_code __overlay_text(asrc)
+asrc_process_pull32(struct comp_dev *dev,
+		    struct asrc_farrow *src_obj,
+		    int32_t **__restrict input_buffers,
+		    int *input_num_frames,
+		    int32_t **__restrict output_buffers,
+		    int output_num_frames,
+		    int write_index,
+		    int *read_index)
 {
 	int index_output_frame = 0;
 
@@ -8,9 +8,11 @@
 
 #include <sof/audio/asrc/asrc_farrow.h>
 #include <sof/audio/format.h>
+#include <sof/lib/overlay.h>
 
-void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
-		       int index_output_frame)
+void __overlay_text(asrc)
+asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
+		  int index_output_frame)
 {
 	int64_t prod;
 	int32_t prod32;
@@ -58,8 +60,9 @@ void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 	}
 }
 
-void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
-		       int index_output_frame)
+void __overlay_text(asrc)
+asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
+		  int index_output_frame)
 {
 	int64_t prod;
 	int32_t prod32;
@@ -7,10 +7,12 @@
 
 #if ASRC_HIFI3 == 1
 
+#include <sof/lib/overlay.h>
 #include <xtensa/tie/xt_hifi3.h>
 
-void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
-		       int index_output_frame)
+void __overlay_text(asrc)
+asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
+		  int index_output_frame)
 {
 	ae_f32x2 prod;
 	ae_f32x2 filter01 = AE_ZERO32(); /* Note: Init is not needed */
@@ -95,8 +97,9 @@ void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 	}
 }
 
-void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
-		       int index_output_frame)
+void __overlay_text(asrc)
+asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
+		  int index_output_frame)
 {
 	ae_f32x2 prod;
 	ae_f32x2 buffer01 = AE_ZERO32(); /* Note: Init is not needed */
@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/asrc/asrc_config.h>
+
+#if ASRC_X86 == 1
+
+#include <sof/audio/asrc/asrc_farrow.h>
+#include <sof/audio/format.h>
+#include <sof/lib/overlay.h>
+#include <immintrin.h>
+#include <stdint.h>
+
+/* SSE4.2 and AVX2 version for host builds. The products are calculated
+ * with 64 bit lanes and the roundings and saturations are done as in the
+ * generic version, so the output is bit exact with it.
+ */
+
+#if defined(__AVX2__)
+
+/* Number of 32 bit words in a vector */
+#define ASRC_LANES 8
+
+#define asrc_vec __m256i
+
+/* Loads ASRC_LANES samples in reversed order, ptr is the newest one */
+static inline asrc_vec asrc_load_rev_s32(const int32_t *ptr)
+{
+	const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+	return _mm256_permutevar8x32_epi32
+		(_mm256_loadu_si256((const __m256i *)(ptr - 7)), rev);
+}
+
+static inline asrc_vec asrc_load_rev_s16(const int16_t *ptr)
+{
+	const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+	__m128i x = _mm_loadu_si128((const __m128i *)(ptr - 7));
+
+	return _mm256_permutevar8x32_epi32(_mm256_cvtepi16_epi32(x), rev);
+}
+
+static inline asrc_vec asrc_load_s32(const int32_t *ptr)
+{
+	return _mm256_loadu_si256((const __m256i *)ptr);
+}
+
+static inline void asrc_store_s32(int32_t *ptr, asrc_vec x)
+{
+	_mm256_storeu_si256((__m256i *)ptr, x);
+}
+
+/* Loads the coefficient pairs of ASRC_LANES / 2 impulse response
+ * iterations, consecutive ones are step words apart.
+ */
+static inline asrc_vec asrc_load_pairs(const int32_t *ptr, int step)
+{
+	__m128i lo = _mm_unpacklo_epi64
+		(_mm_loadl_epi64((const __m128i *)ptr),
+		 _mm_loadl_epi64((const __m128i *)(ptr + step)));
+	__m128i hi = _mm_unpacklo_epi64
+		(_mm_loadl_epi64((const __m128i *)(ptr + 2 * step)),
+		 _mm_loadl_epi64((const __m128i *)(ptr + 3 * step)));
+
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+static inline int64_t asrc_sum_s64(asrc_vec x)
+{
+	__m128i y = _mm_add_epi64(_mm256_castsi256_si128(x),
+				  _mm256_extracti128_si256(x, 1));
+
+	return _mm_cvtsi128_si64(y) + _mm_extract_epi64(y, 1);
+}
+
+#define asrc_setzero		_mm256_setzero_si256
+#define asrc_set1_epi32		_mm256_set1_epi32
+#define asrc_set1_epi64		_mm256_set1_epi64x
+#define asrc_add_epi32		_mm256_add_epi32
+#define asrc_add_epi64		_mm256_add_epi64
+#define asrc_mul_epi32		_mm256_mul_epi32
+#define asrc_srli_epi64		_mm256_srli_epi64
+#define asrc_slli_epi64		_mm256_slli_epi64
+#define asrc_srai_epi32		_mm256_srai_epi32
+#define asrc_cmpeq_epi32	_mm256_cmpeq_epi32
+#define asrc_blend_epi16	_mm256_blend_epi16
+
+#else
+
+/* Number of 32 bit words in a vector */
+#define ASRC_LANES 4
+
+#define asrc_vec __m128i
+
+/* Loads ASRC_LANES samples in reversed order, ptr is the newest one */
+static inline asrc_vec asrc_load_rev_s32(const int32_t *ptr)
+{
+	return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(ptr - 3)),
+				 _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+static inline asrc_vec asrc_load_rev_s16(const int16_t *ptr)
+{
+	__m128i x = _mm_loadl_epi64((const __m128i *)(ptr - 3));
+
+	return _mm_shuffle_epi32(_mm_cvtepi16_epi32(x),
+				 _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+static inline asrc_vec asrc_load_s32(const int32_t *ptr)
+{
+	return _mm_loadu_si128((const __m128i *)ptr);
+}
+
+static inline void asrc_store_s32(int32_t *ptr, asrc_vec x)
+{
+	_mm_storeu_si128((__m128i *)ptr, x);
+}
+
+/* Loads the coefficient pairs of ASRC_LANES / 2 impulse response
+ * iterations, consecutive ones are step words apart.
+ */
+static inline asrc_vec asrc_load_pairs(const int32_t *ptr, int step)
+{
+	return _mm_unpacklo_epi64
+		(_mm_loadl_epi64((const __m128i *)ptr),
+		 _mm_loadl_epi64((const __m128i *)(ptr + step)));
+}
+
+static inline int64_t asrc_sum_s64(asrc_vec x)
+{
+	return _mm_cvtsi128_si64(x) + _mm_extract_epi64(x, 1);
+}
+
+#define asrc_setzero		_mm_setzero_si128
+#define asrc_set1_epi32		_mm_set1_epi32
+#define asrc_set1_epi64		_mm_set1_epi64x
+#define asrc_add_epi32		_mm_add_epi32
+#define asrc_add_epi64		_mm_add_epi64
+#define asrc_mul_epi32		_mm_mul_epi32
+#define asrc_srli_epi64		_mm_srli_epi64
+#define asrc_slli_epi64		_mm_slli_epi64
+#define asrc_srai_epi32		_mm_srai_epi32
+#define asrc_cmpeq_epi32	_mm_cmpeq_epi32
+#define asrc_blend_epi16	_mm_blend_epi16
+
+#endif
+
+/* Sum of products of the even and the odd words with 64 bit results */
+static inline asrc_vec asrc_mac(asrc_vec acc, asrc_vec x, asrc_vec y)
+{
+	acc = asrc_add_epi64(acc, asrc_mul_epi32(x, y));
+	return asrc_add_epi64(acc, asrc_mul_epi32(asrc_srli_epi64(x, 32),
+						  asrc_srli_epi64(y, 32)));
+}
+
+void __overlay_text(asrc)
+asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
+		  int index_output_frame)
+{
+	asrc_vec acc;
+	int64_t prod;
+	int32_t prod32;
+	int16_t prod16;
+	int32_t *filter_p;
+	int16_t *buffer_p;
+	int ch;
+	int n;
+	int i;
+
+	if (src_obj->output_format == ASRC_IOF_INTERLEAVED)
+		i = src_obj->num_channels * index_output_frame;
+	else
+		i = index_output_frame;
+
+	/* Iterate over each channel */
+	for (ch = 0; ch < src_obj->num_channels; ch++) {
+		filter_p = &src_obj->impulse_response[0];
+		buffer_p = &src_obj->ring_buffers16[ch]
+			[src_obj->buffer_write_position];
+
+		/* Data is Q1.15, coefficients are Q1.30. Prod will be
+		 * Qx.45.
+		 */
+		acc = asrc_setzero();
+		for (n = 0; n + ASRC_LANES <= src_obj->filter_length;
+		     n += ASRC_LANES) {
+			acc = asrc_mac(acc, asrc_load_rev_s16(buffer_p),
+				       asrc_load_s32(filter_p));
+			buffer_p -= ASRC_LANES;
+			filter_p += ASRC_LANES;
+		}
+
+		prod = asrc_sum_s64(acc);
+		for (; n < src_obj->filter_length; n++)
+			prod += (int64_t)(*buffer_p--) * (*filter_p++);
+
+		prod32 = sat_int32(Q_SHIFT(prod, 45, 31));
+		prod16 = sat_int16(Q_SHIFT_RND(prod32, 31, 15));
+		output_buffers[ch][i] = prod16;
+	}
+}
+
+void __overlay_text(asrc)
+asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
+		  int index_output_frame)
+{
+	asrc_vec acc;
+	int64_t prod;
+	int32_t prod32;
+	const int32_t *filter_p;
+	int32_t *buffer_p;
+	int ch;
+	int n;
+	int i;
+
+	if (src_obj->output_format == ASRC_IOF_INTERLEAVED)
+		i = src_obj->num_channels * index_output_frame;
+	else
+		i = index_output_frame;
+
+	/* Iterate over each channel */
+	for (ch = 0; ch < src_obj->num_channels; ch++) {
+		filter_p = &src_obj->impulse_response[0];
+		buffer_p = &src_obj->ring_buffers32[ch]
+			[src_obj->buffer_write_position];
+
+		/* Data is Q1.31, coefficients are Q1.22 after the shift
+		 * by 8. The product is Qx.54, see the generic version.
+		 */
+		acc = asrc_setzero();
+		for (n = 0; n + ASRC_LANES <= src_obj->filter_length;
+		     n += ASRC_LANES) {
+			acc = asrc_mac(acc, asrc_load_rev_s32(buffer_p),
+				       asrc_srai_epi32(asrc_load_s32(filter_p),
+						       8));
+			buffer_p -= ASRC_LANES;
+			filter_p += ASRC_LANES;
+		}
+
+		prod = asrc_sum_s64(acc);
+		for (; n < src_obj->filter_length; n++)
+			prod += (int64_t)(*buffer_p--) * (*filter_p++ >> 8);
+
+		prod32 = sat_int32(Q_SHIFT(prod, 53, 31));
+		output_buffers[ch][i] = prod32;
+	}
+}
+
+/* + ALGORITHM SPECIFIC FUNCTIONS */
+
+/* Vector version of q_multsr_sat_32x32(x, time, 62 - 31). The rounded
+ * product is taken from bits 31..62 of the 64 bit sums. The only result
+ * that does not fit is INT32_MIN x INT32_MIN, which wraps to INT32_MIN
+ * and is saturated to INT32_MAX. No product rounds to INT32_MIN.
+ */
+static inline asrc_vec asrc_mult_time(asrc_vec x, asrc_vec time)
+{
+	const asrc_vec rnd = asrc_set1_epi64(1LL << 30);
+	const asrc_vec min = asrc_set1_epi32(INT32_MIN);
+	asrc_vec even;
+	asrc_vec odd;
+
+	even = asrc_add_epi64(asrc_mul_epi32(x, time), rnd);
+	odd = asrc_add_epi64(asrc_mul_epi32(asrc_srli_epi64(x, 32), time),
+			     rnd);
+	x = asrc_blend_epi16(asrc_srli_epi64(even, 31),
+			     asrc_slli_epi64(odd, 1), 0xcc);
+	return asrc_add_epi32(x, asrc_cmpeq_epi32(x, min));
+}
+
+/* Evaluates the Farrow polynomials of num_filters polyphase filters with
+ * the Horner's method for ASRC_LANES / 2 iterations at a time, see
+ * asrc_calc_impulse_response_n4() in the generic version for the storage
+ * order.
+ */
+static inline void asrc_calc_impulse_response(struct asrc_farrow *src_obj,
+					      const int num_filters)
+{
+	asrc_vec time_v;
+	asrc_vec acc_v;
+	int32_t time;
+	int32_t accl;
+	int32_t acch;
+	const int32_t *filter_P;
+	int32_t *result_P;
+	const int step = 2 * num_filters;
+	int index_filter;
+	int index_limit;
+	int m;
+
+	filter_P = &src_obj->polyphase_filters[0];
+	result_P = &src_obj->impulse_response[0];
+	time = sat_int32(((int64_t)src_obj->time_value) << 4);
+	time_v = asrc_set1_epi32(time);
+
+	index_limit = src_obj->filter_length >> 1;
+	for (index_filter = 0; index_filter + ASRC_LANES / 2 <= index_limit;
+	     index_filter += ASRC_LANES / 2) {
+		acc_v = asrc_load_pairs(filter_P, step);
+		for (m = 1; m < num_filters; m++)
+			acc_v = asrc_add_epi32(asrc_load_pairs(filter_P + 2 * m,
+							       step),
+					       asrc_mult_time(acc_v, time_v));
+
+		asrc_store_s32(result_P, acc_v);
+		filter_P += step * ASRC_LANES / 2;
+		result_P += ASRC_LANES;
+	}
+
+	for (; index_filter < index_limit; index_filter++) {
+		accl = *filter_P++;
+		acch = *filter_P++;
+		for (m = 1; m < num_filters; m++) {
+			accl = *filter_P++ +
+				q_multsr_sat_32x32(accl, time, 62 - 31);
+			acch = *filter_P++ +
+				q_multsr_sat_32x32(acch, time, 62 - 31);
+		}
+
+		*result_P++ = accl;
+		*result_P++ = acch;
+	}
+}
+
+void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
+{
+	asrc_calc_impulse_response(src_obj, 4);
+}
+
+void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj)
+{
+	asrc_calc_impulse_response(src_obj, 5);
+}
+
+void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj)
+{
+	asrc_calc_impulse_response(src_obj, 6);
+}
+
+void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj)
+{
+	asrc_calc_impulse_response(src_obj, 7);
+}
+
+#endif /* ASRC_X86 */
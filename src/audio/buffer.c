@@ -8,18 +8,177 @@
 #include <sof/audio/buffer.h>
 #include <sof/audio/component.h>
 #include <sof/drivers/interrupt.h>
+#include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
+#include <sof/lib/cpu.h>
 #include <sof/lib/memory.h>
+#include <sof/lib/mm_heap.h>
 #include <sof/lib/notifier.h>
 #include <sof/list.h>
 #include <sof/spinlock.h>
+#include <sof/string.h>
 #include <ipc/topology.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-struct comp_buffer *buffer_alloc(uint32_t size, uint32_t caps, uint32_t align)
+/* buffers are created and freed on every stream setup */
+static struct mem_cache buffer_cache =
+	MEM_CACHE_INIT(struct comp_buffer, SOF_MEM_ZONE_RUNTIME, 0,
+		       SOF_MEM_CAPS_RAM, 4);
+
+/*
+ * Memory of buffers allocated only while their pipeline is set up. Buffers
+ * in pipelines never running together may be put in one group declared by
+ * topology, then they all use the same memory area one at a time.
+ */
+struct buffer_group {
+	struct list_item list;		/* in buffer_group_list if id != 0 */
+	uint32_t id;
+	uint32_t size;			/* size of the largest member */
+	uint32_t caps;			/* caps required by all members */
+	uint32_t refs;			/* number of member buffers */
+	struct comp_buffer *user;	/* member the memory is given to */
+	void *addr;
+};
+
+static SHARED_DATA struct list_item buffer_group_list;
+
+static struct list_item *buffer_group_list_get(void)
+{
+	struct list_item *list = platform_shared_get(&buffer_group_list,
+						     sizeof(buffer_group_list));
+
+	/* zero until the first group is created */
+	if (!list->next)
+		list_init(list);
+
+	return list;
+}
+
+/* takes buffer memory from heap, uncached if the buffer asks for it */
+static void *buffer_mem_alloc(void *old, uint32_t caps, uint32_t size,
+			      uint32_t align)
+{
+	void *addr;
+
+	if (old)
+		addr = rbrealloc_align(old, 0, caps & ~BUFFER_CAPS_UNCACHED,
+				       size, align);
+	else
+		addr = rballoc_align(0, caps & ~BUFFER_CAPS_UNCACHED, size,
+				     align);
+
+	if (!addr || !(caps & BUFFER_CAPS_UNCACHED))
+		return addr;
+
+	/* data copied by realloc goes to memory, as do lines left by the
+	 * previous user before they could be written back over the buffer
+	 */
+	dcache_writeback_invalidate_region(addr, size);
+
+	return cache_to_uncache(addr);
+}
+
+static int buffer_group_join(struct comp_buffer *buffer, uint32_t id)
+{
+	struct buffer_group *group = NULL;
+	struct list_item *glist;
+
+	if (id) {
+		list_for_item(glist, buffer_group_list_get()) {
+			group = container_of(glist, struct buffer_group, list);
+			if (group->id == id)
+				goto out;
+		}
+	}
+
+	group = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+			SOF_MEM_CAPS_RAM, sizeof(*group));
+	if (!group) {
+		trace_buffer_error("buffer_group_join(): could not alloc group %u",
+				   id);
+		return -ENOMEM;
+	}
+
+	group->id = id;
+	list_init(&group->list);
+	if (id)
+		list_item_prepend(&group->list, buffer_group_list_get());
+
+out:
+	group->size = MAX(group->size, buffer->stream.size);
+	group->caps |= buffer->caps;
+	group->refs++;
+	buffer->group = group;
+
+	return 0;
+}
+
+static void buffer_group_leave(struct comp_buffer *buffer)
+{
+	struct buffer_group *group = buffer->group;
+
+	buffer_group_detach(buffer);
+	buffer->group = NULL;
+
+	if (--group->refs)
+		return;
+
+	list_item_del(&group->list);
+	rfree(group);
+}
+
+int buffer_group_attach(struct comp_buffer *buffer)
+{
+	struct buffer_group *group = buffer->group;
+	uint32_t owner;
+
+	if (!group || group->user == buffer)
+		return 0;
+
+	if (group->user) {
+		trace_buffer_error_with_ids(buffer, "buffer_group_attach(): group %u is used by buffer %u",
+					    group->id, group->user->id);
+		return -EBUSY;
+	}
+
+	owner = alloc_owner_set(ALLOC_OWNER(buffer->id));
+	group->addr = buffer_mem_alloc(NULL, group->caps, group->size,
+				       PLATFORM_DCACHE_ALIGN);
+	alloc_owner_set(owner);
+	if (!group->addr) {
+		trace_buffer_error_with_ids(buffer, "buffer_group_attach(): could not alloc size = %u bytes of type = %u",
+					    group->size, group->caps);
+		return -ENOMEM;
+	}
+
+	group->user = buffer;
+	buffer->stream.addr = group->addr;
+	buffer_init(buffer, buffer->stream.size, buffer->caps);
+
+	return 0;
+}
+
+void buffer_group_detach(struct comp_buffer *buffer)
+{
+	struct buffer_group *group = buffer->group;
+
+	if (!group || group->user != buffer)
+		return;
+
+	rfree(group->addr);
+	group->addr = NULL;
+	group->user = NULL;
+
+	buffer->stream.addr = NULL;
+	buffer_init(buffer, buffer->stream.size, buffer->caps);
+}
+
+static struct comp_buffer *buffer_create(uint32_t size, uint32_t caps,
+					 uint32_t align, bool alloc_mem)
 {
 	struct comp_buffer *buffer;
 
@@ -33,53 +192,88 @@ struct comp_buffer *buffer_alloc(uint32_t size, uint32_t caps, uint32_t align)
 	}
 
 	/* allocate new buffer */
-	buffer = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-			 sizeof(*buffer));
+	buffer = mem_cache_zalloc(&buffer_cache);
 	if (!buffer) {
 		trace_buffer_error("buffer_alloc(): could not alloc structure");
 		return NULL;
 	}
 
-	buffer->lock = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
-			       SOF_MEM_CAPS_RAM, sizeof(*buffer->lock));
-	if (!buffer->lock) {
-		rfree(buffer);
-		trace_buffer_error("buffer_alloc(): could not alloc lock");
-		return NULL;
-	}
-
-	buffer->stream.addr = rballoc_align(0, caps, size, align);
-	if (!buffer->stream.addr) {
-		rfree(buffer);
-		trace_buffer_error("buffer_alloc(): could not alloc size = %u bytes of type = %u",
-				   size, caps);
-		return NULL;
+	if (alloc_mem) {
+		buffer->stream.addr = buffer_mem_alloc(NULL, caps, size,
+						       align);
+		if (!buffer->stream.addr) {
+			mem_cache_free(&buffer_cache, buffer);
+			trace_buffer_error("buffer_alloc(): could not alloc size = %u bytes of type = %u",
+					   size, caps);
+			return NULL;
+		}
 	}
 
 	buffer_init(buffer, size, caps);
 
 	list_init(&buffer->source_list);
 	list_init(&buffer->sink_list);
-	spinlock_init(buffer->lock);
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+	list_init(&buffer->notify_list);
+#endif
+#if CONFIG_BUFFER_TAP
+	list_init(&buffer->tap_list);
+#endif
+#if CONFIG_BUFFER_BROADCAST
+	list_init(&buffer->broadcast_list);
+#endif
 
 	return buffer;
 }
 
+struct comp_buffer *buffer_alloc(uint32_t size, uint32_t caps, uint32_t align)
+{
+	return buffer_create(size, caps, align, true);
+}
+
 /* create a new component in the pipeline */
 struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 {
 	struct comp_buffer *buffer;
+	bool lazy = desc->group || desc->flags & SOF_BUF_LAZY_ALLOC;
+	uint32_t owner;
 
 	trace_buffer("buffer_new()");
 
-	/* allocate buffer */
-	buffer = buffer_alloc(desc->size, desc->caps, PLATFORM_DCACHE_ALIGN);
+#if CONFIG_BUFFER_BROADCAST
+	/* readers take memory of their writer */
+	if (lazy && desc->flags & SOF_BUF_BROADCAST) {
+		trace_buffer_error("buffer_new(): broadcast buffer %u can't be lazy",
+				   desc->comp.id);
+		return NULL;
+	}
+#endif
+
+	/* allocate buffer, memory of lazy buffers comes from their group */
+	owner = alloc_owner_set(ALLOC_OWNER(desc->comp.id));
+	buffer = buffer_create(desc->size, desc->caps, PLATFORM_DCACHE_ALIGN,
+			       !lazy);
+	alloc_owner_set(owner);
 	if (buffer) {
 		buffer->id = desc->comp.id;
 		buffer->pipeline_id = desc->comp.pipeline_id;
 		buffer->core = desc->comp.core;
+#if CONFIG_BUFFER_RESIZE
+		buffer->tplg_size = desc->size;
+#endif
+#if CONFIG_BUFFER_BROADCAST
+		buffer->broadcast_reader = desc->flags & SOF_BUF_BROADCAST;
+#endif
+
+		if (lazy && buffer_group_join(buffer, desc->group) < 0) {
+			buffer_free(buffer);
+			return NULL;
+		}
 
-		dcache_writeback_invalidate_region(buffer, sizeof(*buffer));
+		/* may be connected to a component of another core later */
+		if (cpu_is_multicore_active())
+			dcache_writeback_invalidate_region(buffer,
+							   sizeof(*buffer));
 	}
 
 	return buffer;
@@ -88,6 +282,7 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc)
 int buffer_set_size(struct comp_buffer *buffer, uint32_t size)
 {
 	void *new_ptr = NULL;
+	uint32_t owner;
 
 	/* validate request */
 	if (size == 0 || size > HEAP_BUFFER_SIZE) {
@@ -99,7 +294,20 @@ int buffer_set_size(struct comp_buffer *buffer, uint32_t size)
 	if (size == buffer->stream.size)
 		return 0;
 
-	new_ptr = rbrealloc(buffer->stream.addr, 0, buffer->caps, size);
+	if (buffer->inplace_source || buffer->inplace_sink) {
+		trace_buffer_error_with_ids(buffer, "resize of buffer shared in-place");
+		return -EBUSY;
+	}
+
+	if (buffer_broadcast_member(buffer)) {
+		trace_buffer_error_with_ids(buffer, "resize of buffer shared by broadcast");
+		return -EBUSY;
+	}
+
+	owner = alloc_owner_set(ALLOC_OWNER(buffer->id));
+	new_ptr = buffer_mem_alloc(buffer->stream.addr, buffer->caps, size,
+				   PLATFORM_DCACHE_ALIGN);
+	alloc_owner_set(owner);
 
 	/* we couldn't allocate bigger chunk */
 	if (!new_ptr && size > buffer->stream.size) {
@@ -109,14 +317,321 @@ int buffer_set_size(struct comp_buffer *buffer, uint32_t size)
 	}
 
 	/* use bigger chunk, else just use the old chunk but set smaller */
-	if (new_ptr)
+	if (new_ptr) {
 		buffer->stream.addr = new_ptr;
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+		buffer->parked = false;
+#endif
+	}
 
 	buffer_init(buffer, size, buffer->caps);
+	buffer_tap_reset(buffer);
+	buffer_marker_reset(buffer);
+
+	return 0;
+}
+
+#if CONFIG_BUFFER_TAP
+int buffer_tap_attach(struct buffer_tap *tap, struct comp_buffer *buffer,
+		      struct comp_dev *dev)
+{
+	/* data is read in place through the cache of the producer core */
+	if (buffer->inter_core || buffer->core != dev->comp.core) {
+		trace_buffer_error_with_ids(buffer, "buffer_tap_attach(): buffer not on core %u",
+					    dev->comp.core);
+		return -EINVAL;
+	}
+
+	if (dev->tap) {
+		trace_buffer_error_with_ids(buffer, "buffer_tap_attach(): component %u has a tap",
+					    dev_comp_id(dev));
+		return -EBUSY;
+	}
+
+	tap->buffer = buffer;
+	tap->dev = dev;
+	tap->avail = 0;
+	list_item_append(&tap->list, &buffer->tap_list);
+
+	/* pipeline order follows the tap */
+	dev->tap = tap;
 
 	return 0;
 }
 
+void buffer_tap_detach(struct buffer_tap *tap)
+{
+	if (!tap->buffer)
+		return;
+
+	list_item_del(&tap->list);
+	tap->dev->tap = NULL;
+	tap->buffer = NULL;
+}
+
+static void buffer_taps_detach(struct comp_buffer *buffer)
+{
+	struct list_item *tlist;
+	struct list_item *tmp;
+
+	list_for_item_safe(tlist, tmp, &buffer->tap_list)
+		buffer_tap_detach(container_of(tlist, struct buffer_tap,
+					       list));
+}
+
+static void buffer_taps_produce(struct comp_buffer *buffer, uint32_t bytes)
+{
+	struct buffer_tap *tap;
+	struct list_item *tlist;
+
+	/* the producer writes over the oldest data */
+	list_for_item(tlist, &buffer->tap_list) {
+		tap = container_of(tlist, struct buffer_tap, list);
+		tap->avail = MIN(tap->avail + bytes, buffer->stream.size);
+	}
+}
+#endif
+
+#if CONFIG_BUFFER_BROADCAST
+/* data a member holds back, readers not running don't stop the writer */
+static uint32_t buffer_broadcast_used(const struct comp_buffer *buffer)
+{
+	return buffer->sink && buffer->sink->state == COMP_STATE_ACTIVE ?
+		buffer->stream.avail : 0;
+}
+
+/* free space of every member is what the slowest running one leaves */
+static void buffer_broadcast_sync(struct comp_buffer *writer)
+{
+	struct comp_buffer *reader;
+	struct list_item *blist;
+	uint32_t used = buffer_broadcast_used(writer);
+	uint32_t free;
+
+	list_for_item(blist, &writer->broadcast_list) {
+		reader = container_of(blist, struct comp_buffer,
+				      broadcast_list);
+		used = MAX(used, buffer_broadcast_used(reader));
+	}
+
+	free = writer->stream.size - used;
+	writer->stream.free = free;
+
+	list_for_item(blist, &writer->broadcast_list)
+		container_of(blist, struct comp_buffer,
+			     broadcast_list)->stream.free = free;
+}
+
+/* data produced into the writer is produced into every reader */
+static void buffer_broadcast_produce(struct comp_buffer *writer,
+				     uint32_t bytes)
+{
+	struct comp_buffer *reader;
+	struct list_item *blist;
+
+	/* overwriting is judged by data of each member alone */
+	writer->stream.free = writer->stream.size - writer->stream.avail;
+	audio_stream_produce(&writer->stream, bytes);
+
+	list_for_item(blist, &writer->broadcast_list) {
+		reader = container_of(blist, struct comp_buffer,
+				      broadcast_list);
+		reader->stream.free = reader->stream.size -
+			reader->stream.avail;
+		audio_stream_produce(&reader->stream, bytes);
+
+		if (writer->silence_next)
+			reader->silence = MIN(reader->silence + bytes,
+					      reader->stream.avail);
+		else
+			reader->silence = 0;
+	}
+
+	buffer_broadcast_sync(writer);
+}
+
+/* first sink buffer of the source component, readers are put behind it */
+static struct comp_buffer *buffer_broadcast_writer(struct comp_buffer *reader)
+{
+	struct comp_buffer *writer;
+
+	if (!reader->source || list_is_empty(&reader->source->bsink_list))
+		return NULL;
+
+	writer = list_first_item(&reader->source->bsink_list,
+				 struct comp_buffer, source_list);
+
+	return writer->broadcast_reader ? NULL : writer;
+}
+
+int buffer_broadcast_join(struct comp_buffer *reader)
+{
+	struct comp_buffer *writer;
+
+	if (!reader->broadcast_reader || reader->broadcast)
+		return 0;
+
+	writer = buffer_broadcast_writer(reader);
+	if (!writer) {
+		trace_buffer_error_with_ids(reader, "buffer_broadcast_join(): no writer");
+		return -EINVAL;
+	}
+
+	/* data is read in place as written, on the core of the producer */
+	if (writer->inter_core || reader->inter_core || writer->group ||
+	    writer->inplace_source || writer->inplace_sink ||
+	    reader->inplace_sink || !writer->stream.addr) {
+		trace_buffer_error_with_ids(reader, "buffer_broadcast_join(): writer %u memory can't be shared",
+					    writer->id);
+		return -EINVAL;
+	}
+
+	if (writer->stream.frame_fmt != reader->stream.frame_fmt ||
+	    writer->stream.channels != reader->stream.channels ||
+	    writer->stream.rate != reader->stream.rate) {
+		trace_buffer_error_with_ids(reader, "buffer_broadcast_join(): format differs from writer %u",
+					    writer->id);
+		return -EINVAL;
+	}
+
+	trace_buffer_with_ids(reader, "buffer_broadcast_join(), writer->id = %u",
+			      writer->id);
+
+	rfree(reader->stream.addr);
+	reader->stream.addr = writer->stream.addr;
+	buffer_init(reader, writer->stream.size, reader->caps);
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+	reader->parked = false;
+#endif
+
+	reader->broadcast = writer;
+	list_item_append(&reader->broadcast_list, &writer->broadcast_list);
+
+	buffer_broadcast_reset(reader);
+
+	return 0;
+}
+
+int buffer_broadcast_leave(struct comp_buffer *reader)
+{
+	struct comp_buffer *writer = reader->broadcast;
+	void *addr;
+
+	if (!writer)
+		return 0;
+
+	addr = buffer_mem_alloc(NULL, reader->caps, reader->stream.size,
+				PLATFORM_DCACHE_ALIGN);
+	if (!addr) {
+		trace_buffer_error_with_ids(reader, "buffer_broadcast_leave(): could not alloc size = %u bytes of type = %u",
+					    reader->stream.size, reader->caps);
+		return -ENOMEM;
+	}
+
+	list_item_del(&reader->broadcast_list);
+	reader->broadcast = NULL;
+	buffer_broadcast_sync(writer);
+
+	reader->stream.addr = addr;
+	buffer_init(reader, reader->stream.size, reader->caps);
+
+	return 0;
+}
+
+void buffer_broadcast_reset(struct comp_buffer *buffer)
+{
+	struct comp_buffer *writer = buffer->broadcast ? buffer->broadcast :
+		buffer;
+	struct comp_buffer *reader;
+	struct list_item *blist;
+
+	list_for_item(blist, &writer->broadcast_list) {
+		reader = container_of(blist, struct comp_buffer,
+				      broadcast_list);
+		if (reader != buffer && writer != buffer)
+			continue;
+
+		reader->stream.w_ptr = writer->stream.w_ptr;
+		reader->stream.r_ptr = writer->stream.w_ptr;
+		reader->stream.avail = 0;
+		reader->silence = 0;
+	}
+
+	buffer_broadcast_sync(writer);
+}
+
+/* readers of a freed writer get memory of their own, a reader leaves */
+static void buffer_broadcast_free(struct comp_buffer *buffer)
+{
+	struct comp_buffer *reader;
+	struct list_item *blist;
+	struct list_item *tmp;
+
+	if (buffer->broadcast) {
+		list_item_del(&buffer->broadcast_list);
+		buffer_broadcast_sync(buffer->broadcast);
+		return;
+	}
+
+	list_for_item_safe(blist, tmp, &buffer->broadcast_list) {
+		reader = container_of(blist, struct comp_buffer,
+				      broadcast_list);
+		if (buffer_broadcast_leave(reader) < 0) {
+			/* no memory left to point at */
+			list_item_del(&reader->broadcast_list);
+			reader->broadcast = NULL;
+			reader->stream.addr = NULL;
+			buffer_init(reader, reader->stream.size, reader->caps);
+		}
+	}
+}
+#endif
+
+#if CONFIG_PIPELINE_LATENCY
+/*
+ * Places the frame marked in the source component at the end of the data
+ * produced now, behind the frames the component still delays. Markers don't
+ * cross cores, the sink component is only written on the buffer core.
+ */
+static void buffer_marker_produce(struct comp_buffer *buffer)
+{
+	struct comp_dev *source = buffer->source;
+	uint32_t delay;
+
+	if (!source->marker_pending || buffer->inter_core)
+		return;
+
+	delay = source->delay_frames *
+		audio_stream_frame_bytes(&buffer->stream);
+
+	buffer->marker.seq = source->marker_seq;
+	buffer->marker.stamp = source->marker_stamp;
+	buffer->marker.offset = MIN(buffer->stream.avail + delay,
+				    buffer->stream.size);
+	source->marker_pending = false;
+}
+
+/* hands the marked frame to the sink component once it has been consumed */
+static void buffer_marker_consume(struct comp_buffer *buffer, uint32_t bytes)
+{
+	struct comp_dev *sink = buffer->sink;
+
+	if (!buffer->marker.seq)
+		return;
+
+	if (bytes <= buffer->marker.offset) {
+		buffer->marker.offset -= bytes;
+		return;
+	}
+
+	sink->marker_seq = buffer->marker.seq;
+	sink->marker_stamp = buffer->marker.stamp;
+	sink->marker_arrival = platform_timer_get(timer_get());
+	sink->marker_pending = true;
+	buffer->marker.seq = 0;
+}
+#endif
+
 /* free component in the pipeline */
 void buffer_free(struct comp_buffer *buffer)
 {
@@ -134,12 +649,417 @@ void buffer_free(struct comp_buffer *buffer)
 
 	list_item_del(&buffer->source_list);
 	list_item_del(&buffer->sink_list);
-	rfree(buffer->stream.addr);
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+	list_item_del(&buffer->notify_list);
+#endif
+#if CONFIG_BUFFER_TAP
+	buffer_taps_detach(buffer);
+#endif
+#if CONFIG_BUFFER_BROADCAST
+	buffer_broadcast_free(buffer);
+#endif
+
+	/* memory shared in-place stays with the rest of the chain */
+	if (buffer->inplace_sink)
+		buffer->inplace_sink->inplace_source = buffer->inplace_source;
+	if (buffer->inplace_source)
+		buffer->inplace_source->inplace_sink = buffer->inplace_sink;
+
+	if (buffer->group)
+		buffer_group_leave(buffer);
+	else if (!buffer->inplace_source && !buffer->inplace_sink &&
+		 !buffer_broadcast_joined(buffer))
+		rfree(buffer->stream.addr);
+
+	rfree(buffer->ring);
 	rfree(buffer->lock);
-	rfree(buffer);
+	mem_cache_free(&buffer_cache, buffer);
+
+	heap_gate_free_banks();
+}
+
+/* point buffer and all buffers using its memory to new memory */
+static void buffer_inplace_set_addr(struct comp_buffer *buffer, void *addr)
+{
+	for (; buffer; buffer = buffer->inplace_sink) {
+		buffer->stream.addr = addr;
+		buffer_init(buffer, buffer->stream.size, buffer->caps);
+	}
+}
+
+int buffer_share_inplace(struct comp_buffer *source, struct comp_buffer *sink)
+{
+	if (source->inplace_sink || sink->inplace_source ||
+	    source->stream.size != sink->stream.size)
+		return -EINVAL;
+
+	trace_buffer_with_ids(sink, "buffer_share_inplace(), source->id = %u",
+			      source->id);
+
+	rfree(sink->stream.addr);
+	buffer_inplace_set_addr(sink, source->stream.addr);
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+	sink->parked = false;
+#endif
+
+	source->inplace_sink = sink;
+	sink->inplace_source = source;
+
+	return 0;
 }
 
-void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
+int buffer_unshare_inplace(struct comp_buffer *buffer)
+{
+	void *addr;
+
+	if (!buffer->inplace_source)
+		return 0;
+
+	addr = rballoc_align(0, buffer->caps, buffer->stream.size,
+			     PLATFORM_DCACHE_ALIGN);
+	if (!addr) {
+		trace_buffer_error_with_ids(buffer, "buffer_unshare_inplace(): could not alloc size = %u bytes of type = %u",
+					    buffer->stream.size, buffer->caps);
+		return -ENOMEM;
+	}
+
+	buffer->inplace_source->inplace_sink = NULL;
+	buffer->inplace_source = NULL;
+	buffer_inplace_set_addr(buffer, addr);
+
+	return 0;
+}
+
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY || CONFIG_BUFFER_COMPACTION
+/* points the buffer and the buffers using it in-place to the copy of their
+ * data at addr, positions are kept
+ */
+static void buffer_rebase(struct comp_buffer *buffer, char *old, char *addr)
+{
+	for (; buffer; buffer = buffer->inplace_sink) {
+		buffer->stream.w_ptr = addr +
+			((char *)buffer->stream.w_ptr - old);
+		buffer->stream.r_ptr = addr +
+			((char *)buffer->stream.r_ptr - old);
+		buffer->stream.addr = addr;
+		buffer->stream.end_addr = addr + buffer->stream.size;
+		buffer_tap_reset(buffer);
+		buffer_marker_reset(buffer);
+	}
+}
+#endif
+
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+/* Moves memory of the buffer and of the buffers using it in-place to heap
+ * with given caps. Data is copied and positions kept, so a paused stream
+ * continues where it stopped. Interrupts are disabled, so no component
+ * or DMA callback of the core sees the buffer half moved.
+ */
+static int buffer_move(struct comp_buffer *buffer, uint32_t caps)
+{
+	char *old = buffer->stream.addr;
+	char *addr;
+	uint32_t owner;
+	uint32_t flags;
+
+	irq_local_disable(flags);
+
+	owner = alloc_owner_set(ALLOC_OWNER(buffer->id));
+	addr = buffer_mem_alloc(old, caps, buffer->stream.size,
+				PLATFORM_DCACHE_ALIGN);
+	alloc_owner_set(owner);
+	if (!addr) {
+		irq_local_enable(flags);
+		return -ENOMEM;
+	}
+
+	buffer_rebase(buffer, old, addr);
+
+	irq_local_enable(flags);
+
+	return 0;
+}
+
+int buffer_park(struct comp_buffer *buffer)
+{
+	int ret;
+
+	/* group memory is given back at reset, in-place users follow the
+	 * buffer owning their memory and buffers shared with other cores
+	 * may still be read by them
+	 */
+	if (buffer->parked || buffer->group || buffer->inplace_source ||
+	    buffer->inter_core || !buffer->stream.addr ||
+	    buffer->caps & SOF_MEM_CAPS_LP || buffer_broadcast_member(buffer))
+		return 0;
+
+	ret = buffer_move(buffer, SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_LP |
+			  (buffer->caps & BUFFER_CAPS_UNCACHED));
+	if (ret < 0)
+		return ret;
+
+	tracev_buffer_with_ids(buffer, "buffer_park()");
+
+	buffer->parked = true;
+
+	return 0;
+}
+
+int buffer_unpark(struct comp_buffer *buffer)
+{
+	int ret;
+
+	if (!buffer->parked)
+		return 0;
+
+	ret = buffer_move(buffer, buffer->caps);
+	if (ret < 0) {
+		trace_buffer_error_with_ids(buffer, "buffer_unpark(): could not alloc size = %u bytes of type = %u",
+					    buffer->stream.size, buffer->caps);
+		return ret;
+	}
+
+	tracev_buffer_with_ids(buffer, "buffer_unpark()");
+
+	buffer->parked = false;
+
+	return 0;
+}
+#endif
+
+#if CONFIG_BUFFER_COMPACTION
+/* Allocations take the lowest free blocks that fit, so memory taken for
+ * a copy of the buffer lies below it only if there is a hole the buffer
+ * fits in. The buffer then moves there and leaves its old blocks to merge
+ * with the free space above.
+ */
+bool buffer_compact(struct comp_buffer *buffer)
+{
+	char *old = buffer->stream.addr;
+	char *addr;
+	uint32_t owner;
+	uint32_t flags;
+
+	/* only buffers owning their memory on this core with no stream
+	 * running through them are moved
+	 */
+	if (buffer->group || buffer->inplace_source || buffer->inter_core ||
+	    buffer_broadcast_member(buffer) || !old || (buffer->source &&
+		     buffer->source->state == COMP_STATE_ACTIVE) ||
+	    (buffer->sink && buffer->sink->state == COMP_STATE_ACTIVE))
+		return false;
+
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+	if (buffer->parked)
+		return false;
+#endif
+
+	irq_local_disable(flags);
+
+	owner = alloc_owner_set(ALLOC_OWNER(buffer->id));
+	addr = buffer_mem_alloc(NULL, buffer->caps, buffer->stream.size,
+				PLATFORM_DCACHE_ALIGN);
+	alloc_owner_set(owner);
+	if (!addr || addr > old) {
+		rfree(addr);
+		irq_local_enable(flags);
+		return false;
+	}
+
+	memcpy_s(addr, buffer->stream.size, old, buffer->stream.size);
+	buffer_rebase(buffer, old, addr);
+	rfree(old);
+
+	irq_local_enable(flags);
+
+	return true;
+}
+#endif
+
+/*
+ * Data still waiting in a buffer downstream of an in-place chain lies in
+ * the same memory, so the free space of each buffer excludes the data
+ * available in it and in all the buffers after it.
+ */
+static void buffer_inplace_sync(struct comp_buffer *buffer)
+{
+	struct comp_buffer *root = buffer;
+	uint32_t used = 0;
+
+	while (root->inplace_source)
+		root = root->inplace_source;
+
+	for (buffer = root; buffer; buffer = buffer->inplace_sink)
+		used += buffer->stream.avail;
+
+	for (buffer = root; buffer; buffer = buffer->inplace_sink) {
+		buffer->stream.free = used < buffer->stream.size ?
+			buffer->stream.size - used : 0;
+		used -= buffer->stream.avail;
+	}
+}
+
+/*
+ * Buffers are core-local until connected to a component of another core,
+ * only then they get the shared (uncached) lock and ring indices.
+ */
+int buffer_set_inter_core(struct comp_buffer *buffer)
+{
+	if (buffer->inter_core)
+		return 0;
+
+	buffer->lock = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+			       SOF_MEM_CAPS_RAM, sizeof(*buffer->lock));
+	if (!buffer->lock) {
+		trace_buffer_error_with_ids(buffer, "buffer_set_inter_core(): could not alloc lock");
+		return -ENOMEM;
+	}
+
+	spinlock_init(buffer->lock);
+	spinlock_name(buffer->lock, "buffer");
+
+	/* indices are accessed by both cores, so use shared memory */
+	buffer->ring = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+			       SOF_MEM_CAPS_RAM, sizeof(*buffer->ring));
+	if (!buffer->ring) {
+		trace_buffer_error_with_ids(buffer, "buffer_set_inter_core(): could not alloc ring");
+		rfree(buffer->lock);
+		buffer->lock = NULL;
+		return -ENOMEM;
+	}
+
+	buffer->inter_core = true;
+
+	/* current stream state is the starting point */
+	buffer->ring->w_idx = (char *)buffer->stream.w_ptr -
+		(char *)buffer->stream.addr;
+	buffer->ring->r_idx = buffer_ring_sub(buffer, buffer->ring->w_idx,
+					      buffer->stream.avail);
+
+	return 0;
+}
+
+/* only the producer core writes the write index */
+static void __hot_text buffer_ring_produce(struct comp_buffer *buffer,
+					   uint32_t bytes)
+{
+	uint32_t w_idx = buffer_ring_sync(buffer);
+
+	audio_stream_produce(&buffer->stream, bytes);
+
+	buffer->ring->w_idx = buffer_ring_add(buffer, w_idx, bytes);
+}
+
+/* only the consumer core writes the read index */
+static void __hot_text buffer_ring_consume(struct comp_buffer *buffer,
+					   uint32_t bytes)
+{
+	uint32_t w_idx = buffer_ring_sync(buffer);
+
+	audio_stream_consume(&buffer->stream, bytes);
+
+	buffer->ring->r_idx = buffer_ring_sub(buffer, w_idx,
+					      buffer->stream.avail);
+}
+
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+/* buffers with pending notifications, each core has its own cache line */
+struct buffer_notify_core {
+	struct list_item pending;
+} __aligned(PLATFORM_DCACHE_ALIGN);
+
+static struct buffer_notify_core buffer_notify[PLATFORM_CORE_COUNT];
+
+static struct list_item *buffer_notify_pending(void)
+{
+	struct list_item *pending = &buffer_notify[cpu_get_id()].pending;
+
+	if (!pending->next)
+		list_init(pending);
+
+	return pending;
+}
+
+static void buffer_notify_send(struct comp_buffer *buffer)
+{
+	struct buffer_cb_transact cb_data = {
+		.buffer = buffer,
+	};
+	char *addr = buffer->stream.addr;
+
+	if (buffer->produce_bytes) {
+		cb_data.transaction_amount = buffer->produce_bytes;
+		cb_data.transaction_begin_address = buffer->produce_begin;
+		buffer->produce_bytes = 0;
+
+		notifier_event(buffer, NOTIFIER_ID_BUFFER_PRODUCE,
+			       NOTIFIER_TARGET_CORE_LOCAL, &cb_data,
+			       sizeof(cb_data));
+	}
+
+	if (buffer->consume_bytes) {
+		cb_data.transaction_amount = buffer->consume_bytes;
+		cb_data.transaction_begin_address = buffer->consume_begin;
+		buffer->consume_bytes = 0;
+
+		notifier_event(buffer, NOTIFIER_ID_BUFFER_CONSUME,
+			       NOTIFIER_TARGET_CORE_LOCAL, &cb_data,
+			       sizeof(cb_data));
+	}
+
+	tracev_buffer_with_ids(buffer,
+			       "buffer_notify_send(), (buffer->avail << 16) | buffer->free = %08x, (buffer->id << 16) | buffer->size = %08x, (buffer->r_ptr - buffer->addr) << 16 | (buffer->w_ptr - buffer->addr)) = %08x",
+			       (buffer->stream.avail << 16) |
+			       buffer->stream.free,
+			       (buffer->id << 16) | buffer->stream.size,
+			       ((char *)buffer->stream.r_ptr - addr) << 16 |
+			       ((char *)buffer->stream.w_ptr - addr));
+}
+
+/*
+ * Adds bytes to the pending notification, returns false if the buffer has
+ * to be notified immediately. Memory of buffers processed in-place is
+ * overwritten within the pipeline run and buffers shared between cores
+ * are produced and consumed on different cores.
+ */
+static bool buffer_notify_defer(struct comp_buffer *buffer, void **begin,
+				uint32_t *pending, void *addr, uint32_t bytes)
+{
+	if (buffer->notify_sync || buffer->inter_core ||
+	    buffer->inplace_source || buffer->inplace_sink)
+		return false;
+
+	/* pending data would be overwritten, send it now */
+	if (*pending + bytes > buffer->stream.size)
+		buffer_notify_send(buffer);
+
+	if (!*pending)
+		*begin = addr;
+	*pending += bytes;
+
+	if (list_is_empty(&buffer->notify_list))
+		list_item_append(&buffer->notify_list,
+				 buffer_notify_pending());
+
+	return true;
+}
+
+void buffer_notify_flush(void)
+{
+	struct list_item *pending = buffer_notify_pending();
+	struct comp_buffer *buffer;
+
+	while (!list_is_empty(pending)) {
+		buffer = list_first_item(pending, struct comp_buffer,
+					 notify_list);
+		list_item_del(&buffer->notify_list);
+		buffer_notify_send(buffer);
+	}
+}
+#endif
+
+void __hot_text comp_update_buffer_produce(struct comp_buffer *buffer,
+					   uint32_t bytes)
 {
 	uint32_t flags = 0;
 	struct buffer_cb_transact cb_data = {
@@ -157,17 +1077,53 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 				      dev_comp_type(buffer->source),
 				      dev_comp_id(buffer->sink),
 				      dev_comp_type(buffer->sink));
+		buffer->silence_next = false;
 		return;
 	}
 
 	buffer_lock(buffer, &flags);
 
-	audio_stream_produce(&buffer->stream, bytes);
+#if CONFIG_PIPELINE_LATENCY
+	buffer_marker_produce(buffer);
+#endif
+
+	if (buffer->ring)
+		buffer_ring_produce(buffer, bytes);
+#if CONFIG_BUFFER_BROADCAST
+	else if (!list_is_empty(&buffer->broadcast_list))
+		buffer_broadcast_produce(buffer, bytes);
+#endif
+	else
+		audio_stream_produce(&buffer->stream, bytes);
+
+	/* silence grows at the end of the data, anything else ends it */
+	if (buffer->silence_next && !buffer->inter_core)
+		buffer->silence = MIN(buffer->silence + bytes,
+				      buffer->stream.avail);
+	else
+		buffer->silence = 0;
+	buffer->silence_next = false;
+
+	if (buffer->inplace_source || buffer->inplace_sink)
+		buffer_inplace_sync(buffer);
+
+#if CONFIG_BUFFER_TAP
+	buffer_taps_produce(buffer, bytes);
+#endif
+
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+	if (buffer_notify_defer(buffer, &buffer->produce_begin,
+				&buffer->produce_bytes,
+				cb_data.transaction_begin_address, bytes)) {
+		buffer_stream_unlock(buffer, flags);
+		return;
+	}
+#endif
 
 	notifier_event(buffer, NOTIFIER_ID_BUFFER_PRODUCE,
 		       NOTIFIER_TARGET_CORE_LOCAL, &cb_data, sizeof(cb_data));
 
-	buffer_unlock(buffer, flags);
+	buffer_stream_unlock(buffer, flags);
 
 	addr = buffer->stream.addr;
 
@@ -182,7 +1138,8 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 			       ((char *)buffer->stream.w_ptr - addr));
 }
 
-void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
+void __hot_text comp_update_buffer_consume(struct comp_buffer *buffer,
+					   uint32_t bytes)
 {
 	uint32_t flags = 0;
 	struct buffer_cb_transact cb_data = {
@@ -205,12 +1162,43 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 
 	buffer_lock(buffer, &flags);
 
-	audio_stream_consume(&buffer->stream, bytes);
+#if CONFIG_SESSION_RECORD
+	session_record_stats(buffer, bytes);
+#endif
+
+	if (buffer->ring)
+		buffer_ring_consume(buffer, bytes);
+	else
+		audio_stream_consume(&buffer->stream, bytes);
+
+	buffer->silence = MIN(buffer->silence, buffer->stream.avail);
+
+#if CONFIG_PIPELINE_LATENCY
+	buffer_marker_consume(buffer, bytes);
+#endif
+
+	if (buffer->inplace_source || buffer->inplace_sink)
+		buffer_inplace_sync(buffer);
+
+#if CONFIG_BUFFER_BROADCAST
+	if (buffer_broadcast_member(buffer))
+		buffer_broadcast_sync(buffer->broadcast ? buffer->broadcast :
+				      buffer);
+#endif
+
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+	if (buffer_notify_defer(buffer, &buffer->consume_begin,
+				&buffer->consume_bytes,
+				cb_data.transaction_begin_address, bytes)) {
+		buffer_stream_unlock(buffer, flags);
+		return;
+	}
+#endif
 
 	notifier_event(buffer, NOTIFIER_ID_BUFFER_CONSUME,
 		       NOTIFIER_TARGET_CORE_LOCAL, &cb_data, sizeof(cb_data));
 
-	buffer_unlock(buffer, flags);
+	buffer_stream_unlock(buffer, flags);
 
 	addr = buffer->stream.addr;
 
@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/comp_block.h>
+#include <sof/audio/component_ext.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/uuid.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/schedule/edf_schedule.h>
+#include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
+#include <ipc/topology.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* 6a0a274f-27cc-4afb-a3e7-3444723f432e */
+DECLARE_SOF_UUID("comp-block", comp_block_uuid, 0x6a0a274f, 0x27cc, 0x4afb,
+		 0xa3, 0xe7, 0x34, 0x44, 0x72, 0x3f, 0x43, 0x2e);
+
+static enum task_state comp_block_run(void *data)
+{
+	struct comp_block *block = data;
+	struct audio_stream *in = &block->in[block->fill ^ 1];
+	uint32_t bytes = audio_stream_period_bytes(&block->result,
+						   block->frames);
+
+	block->ret = comp_process(block->dev, in, &block->result,
+				  block->frames);
+
+	audio_stream_consume(in, in->avail);
+	audio_stream_produce(&block->result, bytes);
+
+	/* the pipeline task takes the result */
+	block->busy = false;
+
+	return SOF_TASK_STATE_COMPLETED;
+}
+
+static uint64_t comp_block_deadline(void *data)
+{
+	struct comp_block *block = data;
+
+	return block->deadline;
+}
+
+static const struct task_ops comp_block_ops = {
+	.run		= comp_block_run,
+	.get_deadline	= comp_block_deadline,
+};
+
+static int comp_block_stream_init(struct audio_stream *stream,
+				  const struct audio_stream *fmt,
+				  uint32_t frames)
+{
+	uint32_t size;
+	void *addr;
+
+	stream->frame_fmt = fmt->frame_fmt;
+	stream->channels = fmt->channels;
+	stream->rate = fmt->rate;
+
+	size = audio_stream_period_bytes(stream, frames);
+	addr = rballoc(0, SOF_MEM_CAPS_RAM, size);
+	if (!addr)
+		return -ENOMEM;
+
+	audio_stream_init(stream, addr, size);
+
+	return 0;
+}
+
+static void comp_block_release(struct comp_block *block)
+{
+	rfree(block->in[0].addr);
+	rfree(block->in[1].addr);
+	rfree(block->result.addr);
+	rfree(block->out.addr);
+	rfree(block);
+}
+
+int comp_block_prepare(struct comp_dev *dev)
+{
+	struct comp_block *block;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	uint32_t frames = dev->drv->block_frames;
+	int ret;
+
+	comp_block_free(dev);
+
+	if (!dev->drv->ops.process || list_is_empty(&dev->bsource_list) ||
+	    list_is_empty(&dev->bsink_list)) {
+		comp_err(dev, "comp_block_prepare(): needs process() and buffers");
+		return -EINVAL;
+	}
+
+	/* a period can't fill more than one block */
+	if (dev->frames > frames) {
+		comp_err(dev, "comp_block_prepare(): period of %u frames exceeds block of %u",
+			 dev->frames, frames);
+		return -EINVAL;
+	}
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	block = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			sizeof(*block));
+	if (!block)
+		return -ENOMEM;
+
+	block->dev = dev;
+	block->frames = frames;
+
+	/* a block is due by the period before the next one is full */
+	block->deadline_ticks = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) *
+		(frames - dev->frames) * 1000 / sourceb->stream.rate;
+
+	ret = comp_block_stream_init(&block->in[0], &sourceb->stream, frames);
+	if (ret < 0)
+		goto err;
+
+	ret = comp_block_stream_init(&block->in[1], &sourceb->stream, frames);
+	if (ret < 0)
+		goto err;
+
+	ret = comp_block_stream_init(&block->result, &sinkb->stream, frames);
+	if (ret < 0)
+		goto err;
+
+	/* Output is two blocks late, one to collect input and one to
+	 * process it. It peaks at three blocks when a result comes in
+	 * early, and a period more is left for the last one to be taken.
+	 */
+	ret = comp_block_stream_init(&block->out, &sinkb->stream,
+				     3 * frames + dev->frames);
+	if (ret < 0)
+		goto err;
+
+	audio_stream_set_zero(&block->out,
+			      audio_stream_period_bytes(&block->out,
+							2 * frames));
+	audio_stream_produce(&block->out,
+			     audio_stream_period_bytes(&block->out,
+						       2 * frames));
+
+	ret = schedule_task_init_edf(&block->task, SOF_UUID(comp_block_uuid),
+				     &comp_block_ops, block, dev->comp.core,
+				     SOF_EDF_TASK_INLINE);
+	if (ret < 0)
+		goto err;
+
+	dev->block = block;
+	return 0;
+
+err:
+	comp_err(dev, "comp_block_prepare(): failed %d", ret);
+	comp_block_release(block);
+	return ret;
+}
+
+void comp_block_free(struct comp_dev *dev)
+{
+	struct comp_block *block = dev->block;
+
+	if (!block)
+		return;
+
+	schedule_task_cancel(&block->task);
+	schedule_task_free(&block->task);
+	comp_block_release(block);
+	dev->block = NULL;
+}
+
+/* Moves bytes from a stream to another, the one that is a pipeline buffer
+ * is updated with its notifications.
+ */
+static void comp_block_move(struct audio_stream *from,
+			    struct comp_buffer *from_buf,
+			    struct audio_stream *to, struct comp_buffer *to_buf,
+			    uint32_t bytes)
+{
+	if (!bytes)
+		return;
+
+	if (from_buf)
+		buffer_invalidate(from_buf, bytes);
+
+	audio_stream_copy(from, 0, to, 0, bytes);
+
+	if (from_buf)
+		comp_update_buffer_consume(from_buf, bytes);
+	else
+		audio_stream_consume(from, bytes);
+
+	if (to_buf) {
+		buffer_writeback(to_buf, bytes);
+		comp_update_buffer_produce(to_buf, bytes);
+	} else {
+		audio_stream_produce(to, bytes);
+	}
+}
+
+int comp_block_copy(struct comp_dev *dev)
+{
+	struct comp_block *block = dev->block;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	struct audio_stream *in;
+	uint32_t avail;
+	uint32_t room;
+	uint32_t bytes;
+	uint32_t flags = 0;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	/* take result of the task once it's done */
+	if (!block->busy && block->result.avail)
+		comp_block_move(&block->result, NULL, &block->out, NULL,
+				block->result.avail);
+
+	buffer_lock(sourceb, &flags);
+	buffer_lock(sinkb, &flags);
+
+	avail = sourceb->stream.avail;
+	room = sinkb->stream.free;
+
+	buffer_unlock(sinkb, flags);
+	buffer_unlock(sourceb, flags);
+
+	/* whole frames only, block streams have the formats of the buffers */
+	avail -= avail % audio_stream_frame_bytes(&sourceb->stream);
+	room -= room % audio_stream_frame_bytes(&sinkb->stream);
+
+	/* collect source frames, a full block goes to the task unless it's
+	 * still busy with the previous one
+	 */
+	for (;;) {
+		in = &block->in[block->fill];
+		bytes = MIN(avail, in->free);
+		comp_block_move(&sourceb->stream, sourceb, in, NULL, bytes);
+		avail -= bytes;
+
+		if (in->free || block->busy || block->result.avail)
+			break;
+
+		block->deadline = platform_timer_get(timer_get()) +
+			block->deadline_ticks;
+		block->busy = true;
+		block->fill ^= 1;
+		schedule_task(&block->task, 0, 0);
+	}
+
+	comp_block_move(&block->out, NULL, &sinkb->stream, sinkb,
+			MIN(block->out.avail, room));
+
+	return block->ret;
+}
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/comp_split.h>
+#include <sof/audio/component_ext.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/drivers/idc.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
+#include <sof/lib/cache_batch.h>
+#include <sof/lib/cpu.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/string.h>
+#include <ipc/topology.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ranges start at even channels, so pairs are never split */
+#define COMP_SPLIT_MIN_CHANNELS \
+	ALIGN_UP(MAX(CONFIG_COMP_CHANNEL_SPLIT_MIN_CHANNELS, 1), 2)
+
+static void comp_split_release(struct comp_split *split)
+{
+	uint32_t i;
+
+	for (i = 1; i < split->num_parts; i++)
+		rfree(split->part[i].sink.addr);
+	rfree(split);
+}
+
+int comp_split_prepare(struct comp_dev *dev)
+{
+	struct comp_split *split;
+	struct comp_split_part *part;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	uint32_t cores[PLATFORM_CORE_COUNT];
+	uint32_t num_cores = 0;
+	uint32_t num_parts;
+	uint32_t channels;
+	uint32_t count;
+	uint32_t first = 0;
+	uint32_t size;
+	uint32_t i;
+	void *addr;
+
+	comp_split_free(dev);
+
+	if (list_is_empty(&dev->bsource_list) ||
+	    list_is_empty(&dev->bsink_list))
+		return 0;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	channels = sinkb->stream.channels;
+	if (sourceb->stream.channels != channels)
+		return 0;
+
+	/* the owner core processes the first range */
+	cores[num_cores++] = dev->comp.core;
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		if (i != dev->comp.core && cpu_is_core_enabled(i))
+			cores[num_cores++] = i;
+
+	num_parts = MIN(num_cores, channels / COMP_SPLIT_MIN_CHANNELS);
+	if (num_parts < 2)
+		return 0;
+
+	count = ALIGN_UP(ceil_divide(channels, num_parts), 2);
+	num_parts = ceil_divide(channels, count);
+	if (num_parts < 2)
+		return 0;
+
+	split = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+			SOF_MEM_CAPS_RAM,
+			sizeof(*split) + num_parts * sizeof(*part));
+	if (!split)
+		return -ENOMEM;
+
+	split->dev = dev;
+	split->num_parts = num_parts;
+	split->frames_max = sinkb->stream.size /
+		audio_stream_frame_bytes(&sinkb->stream);
+
+	for (i = 0; i < num_parts; i++) {
+		part = &split->part[i];
+		part->core = cores[i];
+		part->first = first;
+		part->count = MIN(count, channels - first);
+		first += part->count;
+
+		/* the first range is processed straight to the sink */
+		if (!i)
+			continue;
+
+		split->core_mask |= BIT(part->core);
+
+		part->sink.frame_fmt = sinkb->stream.frame_fmt;
+		part->sink.channels = channels;
+		part->sink.rate = sinkb->stream.rate;
+
+		size = audio_stream_period_bytes(&part->sink,
+						 split->frames_max);
+		addr = rballoc(0, SOF_MEM_CAPS_RAM, size);
+		if (!addr) {
+			comp_err(dev, "comp_split_prepare(): no memory for range %u",
+				 i);
+			comp_split_release(split);
+			return -ENOMEM;
+		}
+
+		audio_stream_init(&part->sink, addr, size);
+	}
+
+	dev->split = split;
+
+	/* other cores look the split up in the component */
+	dcache_writeback_region(dev, sizeof(*dev));
+
+	comp_info(dev, "comp_split_prepare(): %u channels on %u cores",
+		  channels, num_parts);
+
+	return 0;
+}
+
+void comp_split_free(struct comp_dev *dev)
+{
+	if (!dev->split)
+		return;
+
+	comp_split_release(dev->split);
+	dev->split = NULL;
+}
+
+/* processes a range of the copy in progress, on any core */
+static int comp_split_part_run(struct comp_dev *dev, uint32_t part)
+{
+	struct comp_split *split = dev->split;
+	struct audio_stream source = split->source;
+	struct audio_stream sink = split->part[part].sink;
+	int ret;
+
+	audio_stream_invalidate(&source, split->frames *
+				audio_stream_frame_bytes(&source));
+
+	ret = comp_process_channels(dev, &source, &sink, split->frames,
+				    split->part[part].first,
+				    split->part[part].count);
+
+	/* owner core merges the range from memory */
+	dcache_writeback_region(sink.addr, split->frames *
+				audio_stream_frame_bytes(&sink));
+
+	return ret;
+}
+
+int comp_split_run(struct comp_dev *dev, uint32_t part)
+{
+	/* component may be stale in cache of this core */
+	dcache_invalidate_region(dev, sizeof(*dev));
+
+	if (!dev->split || !part || part >= dev->split->num_parts)
+		return -EINVAL;
+
+	return comp_split_part_run(dev, part);
+}
+
+/* copies channels of a range from its scratch stream to the sink */
+static void comp_split_merge(const struct audio_stream *from,
+			     struct audio_stream *to, uint32_t frames,
+			     uint32_t first, uint32_t count)
+{
+	uint32_t sample_bytes = audio_stream_sample_bytes(to);
+	uint32_t frame_bytes = audio_stream_frame_bytes(to);
+	uint32_t bytes = count * sample_bytes;
+	const char *x = (const char *)from->r_ptr + first * sample_bytes;
+	char *y = audio_stream_wrap(to, (char *)to->w_ptr +
+				    first * sample_bytes);
+	uint32_t i;
+	uint32_t n;
+	int ret;
+
+	while (frames) {
+		n = MIN(frames, audio_stream_frames_without_wrap(to, y));
+		for (i = 0; i < n; i++) {
+			ret = memcpy_s(y, bytes, x, bytes);
+			assert(!ret);
+			x += frame_bytes;
+			y += frame_bytes;
+		}
+		frames -= n;
+		y = audio_stream_wrap(to, y);
+	}
+}
+
+int comp_split_copy(struct comp_dev *dev)
+{
+	struct comp_split *split = dev->split;
+	struct comp_split_part *part;
+	struct comp_copy_limits cl;
+	struct cache_batch batch;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	struct idc_msg msg;
+	uint32_t source_bytes;
+	uint32_t sink_bytes;
+	uint32_t frames;
+	uint32_t flags = 0;
+	uint32_t i;
+	int ret;
+	int err;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	buffer_lock(sinkb, &flags);
+	buffer_lock(sourceb, &flags);
+
+	comp_get_copy_limits(sourceb, sinkb, &cl);
+
+	buffer_unlock(sinkb, flags);
+	buffer_unlock(sourceb, flags);
+
+	frames = MIN(cl.frames, split->frames_max);
+	if (!frames)
+		return 0;
+
+	source_bytes = frames * cl.source_frame_bytes;
+	sink_bytes = frames * cl.sink_frame_bytes;
+
+	buffer_invalidate(sourceb, source_bytes);
+
+	/* other cores read the source from memory */
+	audio_stream_writeback_from(&sourceb->stream, sourceb->stream.r_ptr,
+				    source_bytes);
+
+	split->source = sourceb->stream;
+	split->frames = frames;
+
+	for (i = 1; i < split->num_parts; i++) {
+		part = &split->part[i];
+		audio_stream_reset(&part->sink);
+
+		msg.header = IDC_MSG_SPLIT;
+		msg.extension = IDC_MSG_SPLIT_EXT(dev->comp.id);
+		msg.core = part->core;
+		msg.size = sizeof(i);
+		msg.payload = &i;
+		msg.complete = NULL;
+		msg.complete_data = NULL;
+
+		/* range is processed here if the core can't take it */
+		if (idc_send_msg(&msg, IDC_ASYNC) < 0)
+			comp_split_part_run(dev, i);
+	}
+
+	ret = comp_process_channels(dev, &sourceb->stream, &sinkb->stream,
+				    frames, split->part[0].first,
+				    split->part[0].count);
+
+	err = idc_wait_async(split->core_mask);
+	if (err < 0) {
+		comp_err(dev, "comp_split_copy(): ranges failed %d", err);
+		if (!ret)
+			ret = err;
+	}
+
+	/* scratch streams of ranges are often adjacent in the heap */
+	cache_batch_init(&batch, CACHE_INVALIDATE);
+	for (i = 1; i < split->num_parts; i++)
+		cache_batch_add(&batch, split->part[i].sink.r_ptr, sink_bytes);
+	cache_batch_flush(&batch);
+
+	for (i = 1; i < split->num_parts; i++) {
+		part = &split->part[i];
+		comp_split_merge(&part->sink, &sinkb->stream, frames,
+				 part->first, part->count);
+	}
+
+	buffer_writeback(sinkb, sink_bytes);
+
+	comp_update_buffer_produce(sinkb, sink_bytes);
+	comp_update_buffer_consume(sourceb, source_bytes);
+
+	return ret;
+}
@@ -21,6 +21,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#if CONFIG_COMP_LIB_LOAD
+#include <kernel/abi.h>
+#include <version.h>
+#endif
+
 static SHARED_DATA struct comp_driver_list cd;
 
 static const struct comp_driver *get_drv(uint32_t type)
@@ -55,6 +60,7 @@ struct comp_dev *comp_new(struct sof_ipc_comp *comp)
 {
 	struct comp_dev *cdev;
 	const struct comp_driver *drv;
+	uint32_t owner;
 
 	/* find the driver for our new component */
 	drv = get_drv(comp->type);
@@ -74,7 +80,9 @@ struct comp_dev *comp_new(struct sof_ipc_comp *comp)
 		    drv->uid, comp->type, comp->pipeline_id, comp->id);
 
 	/* create the new component */
+	owner = alloc_owner_set(ALLOC_OWNER(comp->id));
 	cdev = drv->ops.create(drv, comp);
+	alloc_owner_set(owner);
 	if (!cdev) {
 		comp_cl_err(drv, "comp_new(): unable to create the new component");
 		return NULL;
@@ -86,6 +94,147 @@ struct comp_dev *comp_new(struct sof_ipc_comp *comp)
 	return cdev;
 }
 
+#if CONFIG_COMP_LIB_LOAD
+/* component library relocated to runtime memory, never unloaded */
+struct comp_lib {
+	struct list_item list;
+	uint8_t name[SOF_COMP_LIB_NAME_SIZE];
+	void *addr;
+};
+
+/* tag padded as in fw_ready version */
+static const uint8_t comp_lib_tag[] = SOF_TAG;
+
+static int comp_lib_check(struct sof_comp_lib_hdr *hdr, uint32_t size)
+{
+	uint32_t relocs;
+	uint32_t image;
+
+	if (size < sizeof(*hdr) || hdr->magic != SOF_COMP_LIB_MAGIC ||
+	    hdr->size != size) {
+		trace_error(TRACE_CLASS_COMP, "comp_lib_check(): invalid library header");
+		return -EINVAL;
+	}
+
+	/* image is linked against symbols of exactly this firmware */
+	if (hdr->abi != SOF_ABI_VERSION || hdr->major != SOF_MAJOR ||
+	    hdr->minor != SOF_MINOR || hdr->micro != SOF_MICRO ||
+	    memcmp(hdr->tag, comp_lib_tag,
+		   MIN(sizeof(hdr->tag), sizeof(comp_lib_tag)))) {
+		trace_error(TRACE_CLASS_COMP, "comp_lib_check(): library built for %u.%u.%u abi 0x%x",
+			    hdr->major, hdr->minor, hdr->micro, hdr->abi);
+		return -EINVAL;
+	}
+
+	image = size - sizeof(*hdr);
+	relocs = hdr->reloc_count * sizeof(uint32_t);
+
+	if (hdr->image_size % sizeof(uint32_t) ||
+	    hdr->image_size > image ||
+	    hdr->reloc_count > image / sizeof(uint32_t) ||
+	    relocs != image - hdr->image_size ||
+	    hdr->init_offset % sizeof(uint32_t) ||
+	    hdr->init_offset > hdr->image_size ||
+	    hdr->init_count > (hdr->image_size - hdr->init_offset) /
+			      sizeof(uint32_t) ||
+	    hdr->image_size > HEAP_BUFFER_SIZE ||
+	    hdr->bss_size > HEAP_BUFFER_SIZE - hdr->image_size) {
+		trace_error(TRACE_CLASS_COMP, "comp_lib_check(): invalid library layout");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static struct comp_lib *comp_lib_find(struct comp_driver_list *drivers,
+				      const uint8_t *name)
+{
+	struct list_item *clist;
+	struct comp_lib *lib;
+
+	list_for_item(clist, &drivers->libs) {
+		lib = container_of(clist, struct comp_lib, list);
+		if (!memcmp(lib->name, name, sizeof(lib->name)))
+			return lib;
+	}
+
+	return NULL;
+}
+
+int comp_lib_load(void *data, uint32_t size)
+{
+	struct comp_driver_list *drivers = comp_drivers_get();
+	struct sof_comp_lib_hdr *hdr = data;
+	struct comp_lib *lib;
+	uint32_t *relocs;
+	uint32_t *init;
+	uint32_t i;
+	char *addr;
+	int ret;
+
+	ret = comp_lib_check(hdr, size);
+	if (ret < 0)
+		return ret;
+
+	/* drivers of a loaded library are registered already */
+	if (comp_lib_find(drivers, hdr->name)) {
+		trace_event(TRACE_CLASS_COMP, "comp_lib_load(): library is loaded");
+		return 0;
+	}
+
+	relocs = (uint32_t *)((char *)(hdr + 1) + hdr->image_size);
+	for (i = 0; i < hdr->reloc_count; i++) {
+		if (relocs[i] % sizeof(uint32_t) ||
+		    relocs[i] > hdr->image_size - sizeof(uint32_t)) {
+			trace_error(TRACE_CLASS_COMP, "comp_lib_load(): relocation %u is invalid",
+				    i);
+			return -EINVAL;
+		}
+	}
+
+	lib = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+		      SOF_MEM_CAPS_RAM, sizeof(*lib));
+	if (!lib)
+		return -ENOMEM;
+
+	/* code runs from here, bss follows the image */
+	addr = rballoc_align(0, SOF_MEM_CAPS_RAM,
+			     hdr->image_size + hdr->bss_size,
+			     PLATFORM_DCACHE_ALIGN);
+	if (!addr) {
+		trace_error(TRACE_CLASS_COMP, "comp_lib_load(): could not alloc %u bytes",
+			    hdr->image_size + hdr->bss_size);
+		rfree(lib);
+		return -ENOMEM;
+	}
+
+	memcpy_s(addr, hdr->image_size, hdr + 1, hdr->image_size);
+	bzero(addr + hdr->image_size, hdr->bss_size);
+
+	for (i = 0; i < hdr->reloc_count; i++)
+		*(uint32_t *)(addr + relocs[i]) += (uintptr_t)addr;
+
+	dcache_writeback_region(addr, hdr->image_size + hdr->bss_size);
+	icache_invalidate_region(addr, hdr->image_size);
+
+	memcpy_s(lib->name, sizeof(lib->name), hdr->name, sizeof(hdr->name));
+	lib->addr = addr;
+	list_item_prepend(&lib->list, &drivers->libs);
+
+	trace_event(TRACE_CLASS_COMP, "comp_lib_load(): %u bytes at 0x%x, %u drivers",
+		    hdr->image_size, (uintptr_t)addr, hdr->init_count);
+
+	/* relocated DECLARE_MODULE() pointers register the drivers */
+	init = (uint32_t *)(addr + hdr->init_offset);
+	for (i = 0; i < hdr->init_count; i++)
+		((void (*)(void))(uintptr_t)init[i])();
+
+	platform_shared_commit(drivers, sizeof(*drivers));
+
+	return 0;
+}
+#endif
+
 int comp_register(struct comp_driver_info *drv)
 {
 	struct comp_driver_list *drivers = comp_drivers_get();
@@ -199,6 +348,9 @@ void sys_comp_init(struct sof *sof)
 	sof->comp_drivers = platform_shared_get(&cd, sizeof(cd));
 
 	list_init(&sof->comp_drivers->list);
+#if CONFIG_COMP_LIB_LOAD
+	list_init(&sof->comp_drivers->libs);
+#endif
 
 	platform_shared_commit(sof->comp_drivers, sizeof(*sof->comp_drivers));
 }
@@ -12,6 +12,7 @@
 #include <sof/audio/pipeline.h>
 #include <sof/common.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/dmic.h>
 #include <sof/drivers/edma.h>
 #include <sof/drivers/ipc.h>
 #include <sof/drivers/timer.h>
@@ -23,6 +24,7 @@
 #include <sof/lib/notifier.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
+#include <sof/math/decibels.h>
 #include <sof/string.h>
 #include <sof/trace/trace.h>
 #include <ipc/dai.h>
@@ -30,6 +32,7 @@
 #include <ipc/topology.h>
 #include <user/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -39,6 +42,28 @@ static const struct comp_driver comp_dai;
 DECLARE_SOF_UUID("dai", dai_comp_uuid, 0xc2b00d27, 0xffbc, 0x4150,
 		 0xa5, 0x1a, 0x24, 0x5c, 0x79, 0xc5, 0xe5, 0x4b);
 
+/* ALH gateway driven by an aggregated DAI */
+struct dai_gateway {
+	struct dma_chan_data *chan;
+	struct dma_sg_config config;
+	struct comp_buffer *dma_buffer;
+	uint32_t stream_id;
+};
+
+/*
+ * DAI components of several pipelines sharing the channels (TDM slots) of
+ * one DAI frame. The first member runs the DMA and packs or unpacks the
+ * channels of every member directly in the DMA buffer.
+ */
+struct dai_slot_group {
+	struct list_item list;		/* in dai_slot_group_list */
+	struct dai *dai;
+	uint32_t direction;
+	uint32_t slot_mask;		/* channels taken by members */
+	struct comp_dev *owner;		/* member running the DMA */
+	struct list_item members;	/* dai_data of members */
+};
+
 struct dai_data {
 	/* local DMA config */
 	struct dma_chan_data *chan;
@@ -61,10 +86,254 @@ struct dai_data {
 	uint64_t *dai_pos;
 
 	uint64_t wallclock;	/* wall clock at stream start */
+
+	/* DAI timestamp read once per copy while a consumer needs it */
+	bool ts_active;			/* timestamping started */
+	bool ts_fresh;			/* ts_last not consumed yet */
+	struct timestamp_data ts_last;	/* last DAI timestamp */
+
+	/* wall clock and position after the last two copies */
+	uint64_t posn_walclk[2];
+	uint64_t posn_bytes[2];
+
+	bool gated;		/* warm paused, DMA runs on silence */
+	bool zero_copy;		/* DMA runs over the local buffer */
+	bool zc_start;		/* playback DMA start waits for prefill */
+	uint32_t zc_held;	/* playback bytes written back for DMA */
+
+	/* aggregated ALH gateways copied in lockstep, NULL if single */
+	struct dai_gateway *gw;
+	uint32_t gw_count;
+	uint32_t gw_frame_bytes;	/* frame size of one gateway */
+
+	/* frame channels shared with other pipelines, NULL group if none */
+	struct dai_slot_group *group;
+	struct list_item group_list;	/* in group->members */
+	struct comp_dev *dev;
+	uint32_t slot_mask;
+
+	/* DMA channel of each pipeline channel, 0 if not remapping */
+	uint32_t ch_map;
+	struct pcm_chmap chmap;
+	bool remap;		/* copy runs through pcm_chmap_copy() */
+
+#if CONFIG_CAVS_DMIC_SW_RAMP
+	uint32_t ramp_time_ms;	/* DMIC startup ramp length, 0 if none */
+	int32_t ramp_gain;	/* Q2.30 capture gain, 0 once ramp is done */
+	int32_t ramp_coef;	/* Q12.20 gain step per pipeline period */
+#endif
 };
 
+/* buffer the DMA is working on */
+static inline struct comp_buffer *dai_dma_buffer(struct dai_data *dd)
+{
+	return dd->zero_copy ? dd->local_buffer : dd->dma_buffer;
+}
+
+/* drops timestamps and positions of the previous run */
+static void dai_ts_reset(struct dai_data *dd)
+{
+	dd->ts_fresh = false;
+	memset(dd->posn_walclk, 0, sizeof(dd->posn_walclk));
+	memset(dd->posn_bytes, 0, sizeof(dd->posn_bytes));
+}
+
+#if CONFIG_CAVS_DMIC_SW_RAMP
+/* starts the DMIC unmute log ramp from -90 dB, stepped every period */
+static void dai_ramp_start(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	int32_t step_db;
+
+	if (!dd->ramp_time_ms)
+		return;
+
+	step_db = (int64_t)-LOGRAMP_START_DB * dev->pipeline->ipc_pipe.period /
+		  1000 / dd->ramp_time_ms;
+	dd->ramp_coef = db2lin_fixed(step_db);
+
+	/* Initial gain value, convert Q12.20 to Q2.30 */
+	dd->ramp_gain = Q_SHIFT_LEFT(db2lin_fixed(LOGRAMP_START_DB), 20, 30);
+}
+
+/* applies ramp gain to bytes of captured samples starting at ptr */
+static void dai_ramp_apply(struct dai_data *dd, void *ptr, uint32_t bytes)
+{
+	struct audio_stream *stream = &dd->local_buffer->stream;
+	uint32_t sample_bytes = audio_stream_sample_bytes(stream);
+	uint32_t samples = bytes / sample_bytes;
+	int32_t gain = dd->ramp_gain;
+	void *start = ptr;
+	int16_t *x16;
+	int32_t *x32;
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = MIN(samples,
+			audio_stream_bytes_without_wrap(stream, ptr) /
+			sample_bytes);
+
+		switch (stream->frame_fmt) {
+		case SOF_IPC_FRAME_S16_LE:
+			x16 = ptr;
+			for (i = 0; i < n; i++)
+				x16[i] = q_multsr_sat_32x32_16(x16[i], gain,
+							       30);
+			break;
+		case SOF_IPC_FRAME_S24_4LE:
+			x32 = ptr;
+			for (i = 0; i < n; i++)
+				x32[i] = q_multsr_sat_32x32_24
+					(sign_extend_s24(x32[i]), gain, 30);
+			break;
+		default:
+			x32 = ptr;
+			for (i = 0; i < n; i++)
+				x32[i] = q_multsr_sat_32x32(x32[i], gain, 30);
+			break;
+		}
+
+		samples -= n;
+		ptr = audio_stream_wrap(stream, (char *)ptr + n * sample_bytes);
+	}
+
+	audio_stream_writeback_from(stream, start, bytes);
+
+	/* Gain is Q2.30 and gain modifier is Q12.20, stop at unity */
+	gain = q_multsr_sat_32x32(gain, dd->ramp_coef,
+				  Q_SHIFT_BITS_32(30, DB2LIN_FIXED_OUTPUT_QY,
+						  30));
+	dd->ramp_gain = gain < ONE_Q2_30 ? gain : 0;
+}
+#endif
+
+static inline void dai_slot_sample(void *dst, const void *src,
+				   uint32_t sample_bytes)
+{
+	if (sample_bytes == sizeof(int16_t))
+		*(int16_t *)dst = *(const int16_t *)src;
+	else
+		*(int32_t *)dst = *(const int32_t *)src;
+}
+
+/*
+ * Copies frames of a slot group member between its local buffer and its
+ * channels of the DMA buffer. Missing playback data leave the channels
+ * zeroed, captured data not fitting the local buffer are dropped.
+ */
+static void dai_slot_copy(struct dai_data *member, struct audio_stream *dma,
+			  uint32_t frames, bool playback)
+{
+	struct comp_buffer *buffer = member->local_buffer;
+	uint32_t sample_bytes = audio_stream_sample_bytes(dma);
+	struct audio_stream *local;
+	uint32_t flags = 0;
+	uint32_t bytes;
+	uint32_t mask;
+	uint32_t n;
+	uint32_t f;
+	char *dma_ptr;
+	char *slot;
+	char *ptr;
+
+	if (!buffer || member->dev->state != COMP_STATE_ACTIVE)
+		return;
+
+	local = &buffer->stream;
+
+	buffer_lock(buffer, &flags);
+	bytes = playback ? local->avail : local->free;
+	buffer_unlock(buffer, flags);
+
+	frames = MIN(frames, bytes / audio_stream_frame_bytes(local));
+	bytes = frames * audio_stream_frame_bytes(local);
+	if (!frames)
+		return;
+
+	if (playback)
+		buffer_invalidate(buffer, bytes);
+
+	dma_ptr = playback ? dma->w_ptr : dma->r_ptr;
+	ptr = playback ? local->r_ptr : local->w_ptr;
+
+	while (frames) {
+		n = MIN(frames, audio_stream_frames_without_wrap(local, ptr));
+		n = MIN(n, audio_stream_frames_without_wrap(dma, dma_ptr));
+
+		for (f = 0; f < n; f++) {
+			slot = dma_ptr;
+			for (mask = member->slot_mask; mask; mask >>= 1) {
+				if (mask & 1) {
+					if (playback)
+						dai_slot_sample(slot, ptr,
+								sample_bytes);
+					else
+						dai_slot_sample(ptr, slot,
+								sample_bytes);
+					ptr += sample_bytes;
+				}
+				slot += sample_bytes;
+			}
+			dma_ptr += audio_stream_frame_bytes(dma);
+		}
+
+		frames -= n;
+		ptr = audio_stream_wrap(local, ptr);
+		dma_ptr = audio_stream_wrap(dma, dma_ptr);
+	}
+
+	if (playback) {
+		comp_update_buffer_consume(buffer, bytes);
+	} else {
+		buffer_writeback(buffer, bytes);
+		comp_update_buffer_produce(buffer, bytes);
+	}
+}
+
+/* packs or unpacks the channels of all slot group members in one pass */
+static void dai_slot_route(struct comp_dev *dev, uint32_t bytes)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct audio_stream *dma = &dd->dma_buffer->stream;
+	bool playback = dev->direction == SOF_IPC_STREAM_PLAYBACK;
+	uint32_t frames = bytes / audio_stream_frame_bytes(dma);
+	struct list_item *mlist;
+
+	if (playback)
+		audio_stream_set_zero(dma, bytes);
+	else
+		audio_stream_invalidate(dma, bytes);
+
+	list_for_item(mlist, &dd->group->members)
+		dai_slot_copy(container_of(mlist, struct dai_data, group_list),
+			      dma, frames, playback);
+
+	if (playback) {
+		audio_stream_writeback(dma, bytes);
+		dma->w_ptr = audio_stream_wrap(dma, (char *)dma->w_ptr + bytes);
+	} else {
+		dma->r_ptr = audio_stream_wrap(dma, (char *)dma->r_ptr + bytes);
+	}
+}
+
+/* moves DMA buffer pointers over silence or dropped data of a warm pause */
+static void dai_gated_cb(struct comp_dev *dev, uint32_t bytes)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct audio_stream *dma = &dd->dma_buffer->stream;
+
+	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+		audio_stream_set_zero(dma, bytes);
+		audio_stream_writeback(dma, bytes);
+		dma->w_ptr = audio_stream_wrap(dma, (char *)dma->w_ptr + bytes);
+	} else {
+		dma->r_ptr = audio_stream_wrap(dma, (char *)dma->r_ptr + bytes);
+	}
+}
+
 /* this is called by DMA driver every time descriptor has completed */
-static void dai_dma_cb(void *arg, enum notify_id type, void *data)
+static void __hot_text dai_dma_cb(void *arg, enum notify_id type, void *data)
 {
 	struct dma_cb_data *next = data;
 	struct comp_dev *dev = arg;
@@ -72,6 +341,7 @@ static void dai_dma_cb(void *arg, enum notify_id type, void *data)
 	uint32_t bytes = next->elem.size;
 	uint32_t sink_bytes;
 	uint32_t samples = bytes / get_sample_bytes(dd->frame_fmt);
+	struct audio_stream *stream;
 	void *buffer_ptr;
 
 	comp_dbg(dev, "dai_dma_cb()");
@@ -92,23 +362,69 @@ static void dai_dma_cb(void *arg, enum notify_id type, void *data)
 		/* make sure we only playback silence during an XRUN */
 		if (dev->direction == SOF_IPC_STREAM_PLAYBACK)
 			/* fill buffer with silence */
-			buffer_zero(dd->dma_buffer);
+			buffer_zero(dai_dma_buffer(dd));
 
 		return;
 	}
 
+	/* warm pause plays silence and drops captured data */
+	if (dd->gated) {
+		dai_gated_cb(dev, bytes);
+		return;
+	}
+
 	sink_bytes = samples *
 		     audio_stream_sample_bytes(&dd->local_buffer->stream);
 
-	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+	/* remapping keeps frames, local frames have their own channels */
+	if (dd->remap)
+		sink_bytes = bytes /
+			audio_stream_frame_bytes(&dd->dma_buffer->stream) *
+			audio_stream_frame_bytes(&dd->local_buffer->stream);
+
+	if (dd->zero_copy) {
+		/* DMA has already moved the data, only update pointers */
+		stream = &dd->local_buffer->stream;
+		if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+			comp_update_buffer_consume(dd->local_buffer, bytes);
+			dd->zc_held -= bytes;
+
+			buffer_ptr = stream->r_ptr;
+		} else {
+			audio_stream_invalidate_from(stream, stream->w_ptr,
+						     bytes);
+#if CONFIG_CAVS_DMIC_SW_RAMP
+			if (dd->ramp_gain)
+				dai_ramp_apply(dd, stream->w_ptr, bytes);
+#endif
+			comp_update_buffer_produce(dd->local_buffer, bytes);
+
+			buffer_ptr = stream->w_ptr;
+		}
+	} else if (dd->group) {
+		dai_slot_route(dev, bytes);
+
+		buffer_ptr = dev->direction == SOF_IPC_STREAM_PLAYBACK ?
+			dd->local_buffer->stream.r_ptr :
+			dd->local_buffer->stream.w_ptr;
+	} else if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
 		dma_buffer_copy_to(dd->local_buffer, sink_bytes,
 				   dd->dma_buffer, bytes,
-				   dd->process, samples);
+				   dd->process, samples,
+				   dd->remap ? &dd->chmap : NULL);
 
 		buffer_ptr = dd->local_buffer->stream.r_ptr;
 	} else {
+		buffer_ptr = dd->local_buffer->stream.w_ptr;
+
 		dma_buffer_copy_from(dd->dma_buffer, bytes, dd->local_buffer,
-				     sink_bytes, dd->process, samples);
+				     sink_bytes, dd->process, samples,
+				     dd->remap ? &dd->chmap : NULL);
+
+#if CONFIG_CAVS_DMIC_SW_RAMP
+		if (dd->ramp_gain)
+			dai_ramp_apply(dd, buffer_ptr, sink_bytes);
+#endif
 
 		buffer_ptr = dd->local_buffer->stream.w_ptr;
 	}
@@ -119,8 +435,97 @@ static void dai_dma_cb(void *arg, enum notify_id type, void *data)
 		dd->dai_pos_blks += bytes;
 		*dd->dai_pos = dd->dai_pos_blks +
 			       (char *)buffer_ptr -
-			       (char *)dd->dma_buffer->stream.addr;
+			       (char *)dai_dma_buffer(dd)->stream.addr;
+	}
+}
+
+static SHARED_DATA struct list_item dai_slot_group_list;
+
+static struct list_item *dai_slot_group_list_get(void)
+{
+	struct list_item *list = platform_shared_get(&dai_slot_group_list,
+						     sizeof(dai_slot_group_list));
+
+	/* zero until the first group is created */
+	if (!list->next)
+		list_init(list);
+
+	return list;
+}
+
+static int dai_slot_group_join(struct comp_dev *dev, uint32_t direction)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct dai_slot_group *group;
+	struct list_item *glist;
+
+	list_for_item(glist, dai_slot_group_list_get()) {
+		group = container_of(glist, struct dai_slot_group, list);
+		if (group->dai == dd->dai && group->direction == direction)
+			goto out;
+	}
+
+	group = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+			SOF_MEM_CAPS_RAM, sizeof(*group));
+	if (!group) {
+		comp_err(dev, "dai_slot_group_join(): could not alloc group");
+		return -ENOMEM;
+	}
+
+	group->dai = dd->dai;
+	group->direction = direction;
+	list_init(&group->members);
+	list_item_prepend(&group->list, dai_slot_group_list_get());
+
+out:
+	if (group->slot_mask & dd->slot_mask) {
+		comp_err(dev, "dai_slot_group_join(): slots 0x%x already taken",
+			 group->slot_mask & dd->slot_mask);
+		return -EINVAL;
+	}
+
+	if (group->owner && group->owner->comp.core != dev->comp.core) {
+		comp_err(dev, "dai_slot_group_join(): members must share core");
+		return -EINVAL;
 	}
+
+	group->slot_mask |= dd->slot_mask;
+	if (!group->owner)
+		group->owner = dev;
+	list_item_append(&dd->group_list, &group->members);
+	dd->group = group;
+
+	return 0;
+}
+
+static void dai_slot_group_leave(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct dai_slot_group *group = dd->group;
+
+	list_item_del(&dd->group_list);
+	group->slot_mask &= ~dd->slot_mask;
+	dd->group = NULL;
+
+	if (list_is_empty(&group->members)) {
+		list_item_del(&group->list);
+		rfree(group);
+		return;
+	}
+
+	/* the next member gets the DMA channel at its next config */
+	if (group->owner == dev)
+		group->owner = list_first_item(&group->members,
+					       struct dai_data,
+					       group_list)->dev;
+}
+
+/* DMA and DAI are run by another member of the slot group */
+static inline bool dai_slot_member(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+
+	return dd->group && dd->group->owner != dev;
 }
 
 static struct comp_dev *dai_new(const struct comp_driver *drv,
@@ -181,6 +586,23 @@ static struct comp_dev *dai_new(const struct comp_driver *drv,
 	dd->dai_pos_blks = 0;
 	dd->xrun = 0;
 	dd->chan = NULL;
+	dd->dev = dev;
+
+	dd->ch_map = ipc_dai->ch_map;
+	if (dd->ch_map && ipc_dai->slot_mask) {
+		comp_cl_err(&comp_dai, "dai_new(): ch_map and slot_mask are exclusive");
+		dma_put(dd->dma);
+		dai_put(dd->dai);
+		goto error;
+	}
+
+	dd->slot_mask = ipc_dai->slot_mask;
+	if (dd->slot_mask &&
+	    dai_slot_group_join(dev, ipc_dai->direction) < 0) {
+		dma_put(dd->dma);
+		dai_put(dd->dai);
+		goto error;
+	}
 
 	dev->state = COMP_STATE_READY;
 	return dev;
@@ -191,10 +613,29 @@ error:
 	return NULL;
 }
 
+static void dai_agg_free(struct dai_data *dd)
+{
+	int i;
+
+	for (i = 0; i < dd->gw_count; i++)
+		if (dd->gw[i].chan)
+			dma_channel_put(dd->gw[i].chan);
+
+	rfree(dd->gw);
+	dd->gw = NULL;
+	dd->gw_count = 0;
+}
+
 static void dai_free(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 
+	if (dd->gw)
+		dai_agg_free(dd);
+
+	if (dd->group)
+		dai_slot_group_leave(dev);
+
 	if (dd->chan) {
 		notifier_unregister(dev, dd->chan, NOTIFIER_ID_DMA_COPY);
 		dma_channel_put(dd->chan);
@@ -233,6 +674,14 @@ static int dai_comp_get_hw_params(struct comp_dev *dev,
 	if (dd->frame_fmt)
 		params->frame_fmt = dd->frame_fmt;
 
+	/* pipeline of a slot group member carries only its channels */
+	if (dd->slot_mask)
+		params->channels = popcount(dd->slot_mask);
+
+	/* and a remapping one only the channels it maps */
+	if (dd->ch_map)
+		params->channels = pcm_chmap_channels(dd->ch_map);
+
 	return 0;
 }
 
@@ -303,7 +752,7 @@ static int dai_playback_params(struct comp_dev *dev, uint32_t period_bytes,
 				   config->direction,
 				   period_count,
 				   period_bytes,
-				   (uintptr_t)(dd->dma_buffer->stream.addr),
+				   (uintptr_t)(dai_dma_buffer(dd)->stream.addr),
 				   fifo);
 		if (err < 0) {
 			comp_err(dev, "dai_playback_params(): dma_sg_alloc() failed with err = %d",
@@ -363,7 +812,7 @@ static int dai_capture_params(struct comp_dev *dev, uint32_t period_bytes,
 				   config->direction,
 				   period_count,
 				   period_bytes,
-				   (uintptr_t)(dd->dma_buffer->stream.addr),
+				   (uintptr_t)(dai_dma_buffer(dd)->stream.addr),
 				   fifo);
 		if (err < 0) {
 			comp_err(dev, "dai_capture_params(): dma_sg_alloc() failed with err = %d",
@@ -375,14 +824,219 @@ static int dai_capture_params(struct comp_dev *dev, uint32_t period_bytes,
 	return 0;
 }
 
+/* alloc DMA buffer or change its size if exists */
+static int dai_dma_buffer_alloc(struct comp_dev *dev,
+				struct comp_buffer **buffer, uint32_t size,
+				uint32_t align, uint32_t addr_align)
+{
+	uint32_t buffer_size = ALIGN_UP(size, align);
+	int err;
+
+	if (*buffer) {
+		err = buffer_set_size(*buffer, buffer_size);
+		if (err < 0) {
+			comp_err(dev, "dai_params(): buffer_set_size() failed, buffer_size = %u",
+				 buffer_size);
+			return err;
+		}
+	} else {
+		*buffer = buffer_alloc(buffer_size, BUFFER_CAPS_DMA,
+				       addr_align);
+		if (!*buffer) {
+			comp_err(dev, "dai_params(): failed to alloc dma buffer");
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+/* set up DMA of every aggregated gateway, each gets an equal channel share */
+static int dai_agg_params(struct comp_dev *dev, uint32_t period_count,
+			  uint32_t align, uint32_t addr_align)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	uint32_t channels = dd->local_buffer->stream.channels;
+	struct dai_gateway *gw;
+	uint32_t period_bytes;
+	uint32_t handshake;
+	uint32_t fifo;
+	int err;
+	int i;
+
+	if (channels % dd->gw_count) {
+		comp_err(dev, "dai_agg_params(): %u channels can't be split to %u gateways",
+			 channels, dd->gw_count);
+		return -EINVAL;
+	}
+
+	channels /= dd->gw_count;
+	dd->gw_frame_bytes = get_frame_bytes(dd->frame_fmt, channels);
+
+	period_bytes = dev->frames * dd->gw_frame_bytes;
+	period_count = dma_buffer_period_count(period_bytes, period_count,
+					       align);
+
+	for (i = 0; i < dd->gw_count; i++) {
+		gw = &dd->gw[i];
+
+		err = dai_dma_buffer_alloc(dev, &gw->dma_buffer,
+					   period_count * period_bytes,
+					   align, addr_align);
+		if (err < 0)
+			return err;
+
+		gw->dma_buffer->stream.frame_fmt = dd->frame_fmt;
+		gw->dma_buffer->stream.channels = channels;
+
+		handshake = dai_get_handshake(dd->dai, dev->direction,
+					      gw->stream_id);
+
+		gw->config.direction = dev->direction ==
+			SOF_IPC_STREAM_PLAYBACK ?
+			DMA_DIR_MEM_TO_DEV : DMA_DIR_DEV_TO_MEM;
+		gw->config.src_width = get_sample_bytes(dd->frame_fmt);
+		gw->config.dest_width = gw->config.src_width;
+		gw->config.cyclic = 1;
+		gw->config.irq_disabled =
+			pipeline_is_timer_driven(dev->pipeline);
+		gw->config.src_dev = handshake;
+		gw->config.dest_dev = handshake;
+		gw->config.period = dev->pipeline->ipc_pipe.period;
+
+		/* the first gateway schedules the copy of all of them */
+		gw->config.is_scheduling_source = !i &&
+			comp_is_scheduling_source(dev);
+
+		if (gw->config.elem_array.elems)
+			continue;
+
+		fifo = dai_get_fifo(dd->dai, dev->direction, gw->stream_id);
+
+		comp_info(dev, "dai_agg_params() stream_id = %u handshake = %u fifo %X",
+			  gw->stream_id, handshake, fifo);
+
+		err = dma_sg_alloc(&gw->config.elem_array,
+				   SOF_MEM_ZONE_RUNTIME,
+				   gw->config.direction,
+				   period_count, period_bytes,
+				   (uintptr_t)gw->dma_buffer->stream.addr,
+				   fifo);
+		if (err < 0) {
+			comp_err(dev, "dai_agg_params(): dma_sg_alloc() failed with err = %d",
+				 err);
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+/* DMA can work on the local buffer if no conversion is needed */
+static bool dai_zero_copy_supported(struct comp_dev *dev, uint32_t addr_align,
+				    uint32_t align, uint32_t period_bytes,
+				    uint32_t period_count)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *buffer = dd->local_buffer;
+	uint32_t size = buffer->stream.size;
+
+	if (buffer->stream.frame_fmt != dd->frame_fmt)
+		return false;
+
+	/* DMA must stop at the SW pointer moved by dma_copy() */
+	if (!(dd->dma->plat_data.caps &
+	      (DMA_CAP_HDA | DMA_CAP_GP_LP | DMA_CAP_GP_HP)))
+		return false;
+
+	/* playback DMA start is delayed until the pipeline has prefilled */
+	if (dev->direction == SOF_IPC_STREAM_PLAYBACK &&
+	    !pipeline_is_timer_driven(dev->pipeline))
+		return false;
+
+	if (buffer->inter_core || !(buffer->caps & SOF_MEM_CAPS_DMA))
+		return false;
+
+	return !((uintptr_t)buffer->stream.addr % addr_align) &&
+		!(size % align) && !(size % period_bytes) &&
+		size / period_bytes >= period_count;
+}
+
+/* checks a slot group member and gets the channels of the DAI frame */
+static int dai_slot_params(struct comp_dev *dev, uint32_t *channels)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct sof_ipc_stream_params hw_params;
+	int err;
+
+	err = dai_get_hw_params(dd->dai, &hw_params, dev->direction);
+	if (err < 0)
+		return err;
+
+	if (!hw_params.channels ||
+	    (hw_params.channels < 32 && dd->slot_mask >> hw_params.channels)) {
+		comp_err(dev, "dai_slot_params(): slots 0x%x out of %u channels",
+			 dd->slot_mask, hw_params.channels);
+		return -EINVAL;
+	}
+
+	/* channels are moved to the DMA buffer without conversion */
+	if (dd->local_buffer->stream.frame_fmt != dd->frame_fmt) {
+		comp_err(dev, "dai_slot_params(): local format %u isn't DAI format %u",
+			 dd->local_buffer->stream.frame_fmt, dd->frame_fmt);
+		return -EINVAL;
+	}
+
+	*channels = hw_params.channels;
+
+	return 0;
+}
+
+/* sets up channel remapping and gets the channels of the DAI frame */
+static int dai_chmap_params(struct comp_dev *dev, uint32_t *channels)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct sof_ipc_stream_params hw_params;
+	enum sof_ipc_frame local_fmt = dd->local_buffer->stream.frame_fmt;
+	int err;
+
+	if (dd->gw_count) {
+		comp_err(dev, "dai_chmap_params(): no remapping over aggregated gateways");
+		return -EINVAL;
+	}
+
+	if (!pcm_chmap_supported(local_fmt, dd->frame_fmt)) {
+		comp_err(dev, "dai_chmap_params(): can't remap format %u to %u",
+			 local_fmt, dd->frame_fmt);
+		return -EINVAL;
+	}
+
+	err = dai_get_hw_params(dd->dai, &hw_params, dev->direction);
+	if (err < 0)
+		return err;
+
+	err = pcm_chmap_init(&dd->chmap, dd->ch_map, hw_params.channels,
+			     dev->direction == SOF_IPC_STREAM_PLAYBACK);
+	if (err < 0) {
+		comp_err(dev, "dai_chmap_params(): map 0x%x invalid for %u channels",
+			 dd->ch_map, hw_params.channels);
+		return err;
+	}
+
+	dd->remap = true;
+	*channels = hw_params.channels;
+
+	return 0;
+}
+
 static int dai_params(struct comp_dev *dev,
 		      struct sof_ipc_stream_params *params)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
+	uint32_t channels;
 	uint32_t frame_size;
 	uint32_t period_count;
 	uint32_t period_bytes;
-	uint32_t buffer_size;
 	uint32_t addr_align;
 	uint32_t align;
 	int err;
@@ -416,6 +1070,22 @@ static int dai_params(struct comp_dev *dev,
 		return -EINVAL;
 	}
 
+	/* DMA frame carries all channels of a slot group */
+	channels = dd->local_buffer->stream.channels;
+	if (dd->group) {
+		err = dai_slot_params(dev, &channels);
+		if (err < 0 || dai_slot_member(dev))
+			return err;
+	}
+
+	/* or the DAI channels picked or filled by the channel map */
+	dd->remap = false;
+	if (dd->ch_map) {
+		err = dai_chmap_params(dev, &channels);
+		if (err < 0)
+			return err;
+	}
+
 	err = dma_get_attribute(dd->dma, DMA_ATTR_BUFFER_ADDRESS_ALIGNMENT,
 				&addr_align);
 	if (err < 0) {
@@ -439,9 +1109,11 @@ static int dai_params(struct comp_dev *dev,
 		return -EINVAL;
 	}
 
+	if (dd->gw_count)
+		return dai_agg_params(dev, period_count, align, addr_align);
+
 	/* calculate frame size */
-	frame_size = get_frame_bytes(dd->frame_fmt,
-				     dd->local_buffer->stream.channels);
+	frame_size = get_frame_bytes(dd->frame_fmt, channels);
 
 	/* calculate period size */
 	period_bytes = dev->frames * frame_size;
@@ -450,24 +1122,28 @@ static int dai_params(struct comp_dev *dev,
 		return -EINVAL;
 	}
 
-	/* calculate DMA buffer size */
-	buffer_size = ALIGN_UP(period_count * period_bytes, align);
+	dd->zero_copy = !dd->group && !dd->remap &&
+		dai_zero_copy_supported(dev, addr_align, align,
+					period_bytes, period_count);
+	if (dd->zero_copy) {
+		comp_info(dev, "dai_params(): zero-copy");
 
-	/* alloc DMA buffer or change its size if exists */
-	if (dd->dma_buffer) {
-		err = buffer_set_size(dd->dma_buffer, buffer_size);
-		if (err < 0) {
-			comp_err(dev, "dai_params(): buffer_set_size() failed, buffer_size = %u",
-				 buffer_size);
-			return err;
-		}
+		/* DMA runs over the whole local buffer */
+		period_count = dd->local_buffer->stream.size / period_bytes;
 	} else {
-		dd->dma_buffer = buffer_alloc(buffer_size, SOF_MEM_CAPS_DMA,
-					      addr_align);
-		if (!dd->dma_buffer) {
-			comp_err(dev, "dai_params(): failed to alloc dma buffer");
-			return -ENOMEM;
-		}
+		/* keep DMA periods equal to pipeline periods */
+		period_count = dma_buffer_period_count(period_bytes,
+						       period_count, align);
+
+		err = dai_dma_buffer_alloc(dev, &dd->dma_buffer,
+					   period_count * period_bytes,
+					   align, addr_align);
+		if (err < 0)
+			return err;
+
+		/* slot group members are routed with DMA frame strides */
+		dd->dma_buffer->stream.frame_fmt = dd->frame_fmt;
+		dd->dma_buffer->stream.channels = channels;
 	}
 
 	return dev->direction == SOF_IPC_STREAM_PLAYBACK ?
@@ -475,6 +1151,38 @@ static int dai_params(struct comp_dev *dev,
 		dai_capture_params(dev, period_bytes, period_count);
 }
 
+static int dai_agg_prepare(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	int ret;
+	int i;
+
+	for (i = 0; i < dd->gw_count; i++) {
+		if (!dd->gw[i].chan || !dd->gw[i].config.elem_array.elems) {
+			comp_err(dev, "dai_agg_prepare(): gateway %u not configured",
+				 dd->gw[i].stream_id);
+			return -EINVAL;
+		}
+
+		/* clear dma buffer to avoid pop noise */
+		buffer_zero(dd->gw[i].dma_buffer);
+	}
+
+	/* dma reconfig not required if XRUN handling */
+	if (dd->xrun) {
+		dd->xrun = 0;
+		return 0;
+	}
+
+	for (i = 0; i < dd->gw_count; i++) {
+		ret = dma_set_config(dd->gw[i].chan, &dd->gw[i].config);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
 static int dai_prepare(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
@@ -490,6 +1198,18 @@ static int dai_prepare(struct comp_dev *dev)
 		return PPL_STATUS_PATH_STOP;
 
 	dev->position = 0;
+	dai_ts_reset(dd);
+
+	/* DMA is run by the slot group owner */
+	if (dai_slot_member(dev))
+		return ret;
+
+	if (dd->gw_count) {
+		ret = dai_agg_prepare(dev);
+		if (ret < 0)
+			comp_set_state(dev, COMP_TRIGGER_RESET);
+		return ret;
+	}
 
 	if (!dd->chan) {
 		comp_err(dev, "dai_prepare(): Missing dd->chan.");
@@ -504,7 +1224,7 @@ static int dai_prepare(struct comp_dev *dev)
 	}
 
 	/* clear dma buffer to avoid pop noise */
-	buffer_zero(dd->dma_buffer);
+	buffer_zero(dai_dma_buffer(dd));
 
 	/* dma reconfig not required if XRUN handling */
 	if (dd->xrun) {
@@ -524,6 +1244,7 @@ static int dai_reset(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 	struct dma_sg_config *config = &dd->config;
+	int i;
 
 	comp_dbg(dev, "dai_reset()");
 
@@ -534,13 +1255,26 @@ static int dai_reset(struct comp_dev *dev)
 		dd->dma_buffer = NULL;
 	}
 
+	for (i = 0; i < dd->gw_count; i++) {
+		dma_sg_free(&dd->gw[i].config.elem_array);
+		if (dd->gw[i].dma_buffer) {
+			buffer_free(dd->gw[i].dma_buffer);
+			dd->gw[i].dma_buffer = NULL;
+		}
+	}
+
 	dd->dai_pos_blks = 0;
 	if (dd->dai_pos)
 		*dd->dai_pos = 0;
 	dd->dai_pos = NULL;
 	dd->wallclock = 0;
 	dev->position = 0;
+	dai_ts_reset(dd);
+	dd->ts_active = false;
 	dd->xrun = 0;
+	dd->zero_copy = false;
+	dd->zc_start = false;
+	dd->gated = false;
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 
 	return 0;
@@ -557,14 +1291,78 @@ static void dai_update_start_position(struct comp_dev *dev)
 	dd->start_position = dev->position;
 }
 
+/* runs a DMA channel operation on the channel or all aggregated gateways */
+static int dai_dma_op(struct dai_data *dd,
+		      int (*op)(struct dma_chan_data *channel))
+{
+	int ret;
+	int i;
+
+	if (!dd->gw_count)
+		return op(dd->chan);
+
+	for (i = 0; i < dd->gw_count; i++) {
+		ret = op(dd->gw[i].chan);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Warm pause, requested by SOF_PCM_FLAG_PAUSE_WARM, leaves the DAI, its
+ * DMA and the pipeline task running. The DAI stays active and feeds the
+ * DMA with silence while the rest of the pipeline is paused, so release
+ * takes effect in the next pipeline period. Returns true if cmd has been
+ * handled that way.
+ */
+static bool dai_trigger_warm(struct comp_dev *dev, int cmd)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+
+	switch (cmd) {
+	case COMP_TRIGGER_PAUSE:
+		/* DMA shared with other streams or run by a helper is
+		 * paused the usual way
+		 */
+		if (!dev->pipeline->pause_warm || dd->gated || dd->xrun ||
+		    dd->zero_copy || dd->gw_count || dd->group ||
+		    dev->state != COMP_STATE_ACTIVE)
+			return false;
+
+		comp_info(dev, "dai_trigger_warm(), PAUSE");
+		dd->gated = true;
+		return true;
+	case COMP_TRIGGER_RELEASE:
+		if (!dd->gated)
+			return false;
+
+		comp_info(dev, "dai_trigger_warm(), RELEASE");
+		dd->gated = false;
+		return true;
+	case COMP_TRIGGER_STOP:
+	case COMP_TRIGGER_XRUN:
+		/* stopped from the active state */
+		dd->gated = false;
+		return false;
+	default:
+		return false;
+	}
+}
+
 /* used to pass standard and bespoke command (with data) to component */
 static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 	int ret;
+	int i;
 
 	comp_dbg(dev, "dai_comp_trigger(), command = %u", cmd);
 
+	/* the DAI stays active, pipeline task isn't cancelled either */
+	if (dai_trigger_warm(dev, cmd))
+		return PPL_STATUS_PATH_STOP;
+
 	ret = comp_set_state(dev, cmd);
 	if (ret < 0)
 		return ret;
@@ -572,17 +1370,32 @@ static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 	if (ret == COMP_STATUS_STATE_ALREADY_SET)
 		return PPL_STATUS_PATH_STOP;
 
+	/* DAI and DMA are run by the slot group owner */
+	if (dai_slot_member(dev))
+		return ret;
+
 	switch (cmd) {
 	case COMP_TRIGGER_START:
 		comp_dbg(dev, "dai_comp_trigger(), START");
 
+		/* zero-copy playback starts once the buffer is prefilled */
+		if (dd->zero_copy && dd->xrun == 0 &&
+		    dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+			dd->zc_start = true;
+			dd->zc_held = 0;
+			break;
+		}
+
 		/* only start the DAI if we are not XRUN handling */
 		if (dd->xrun == 0) {
 			/* start the DAI */
 			dai_trigger(dd->dai, cmd, dev->direction);
-			ret = dma_start(dd->chan);
+			ret = dai_dma_op(dd, dma_start);
 			if (ret < 0)
 				return ret;
+#if CONFIG_CAVS_DMIC_SW_RAMP
+			dai_ramp_start(dev);
+#endif
 		} else {
 			dd->xrun = 0;
 		}
@@ -594,21 +1407,33 @@ static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 		 * then there is no history data sent out after release.
 		 * this is only supported at capture mode.
 		 */
-		if (dev->direction == SOF_IPC_STREAM_CAPTURE)
-			buffer_zero(dd->dma_buffer);
+		if (dev->direction == SOF_IPC_STREAM_CAPTURE) {
+			if (dd->gw_count)
+				for (i = 0; i < dd->gw_count; i++)
+					buffer_zero(dd->gw[i].dma_buffer);
+			else
+				buffer_zero(dai_dma_buffer(dd));
+		}
+
+		/* paused before zero-copy playback prefill completed */
+		if (dd->zc_start)
+			break;
 
 		/* only start the DAI if we are not XRUN handling */
 		if (dd->xrun == 0) {
 			/* recover valid start position */
-			ret = dma_release(dd->chan);
+			ret = dai_dma_op(dd, dma_release);
 			if (ret < 0)
 				return ret;
 
 			/* start the DAI */
 			dai_trigger(dd->dai, cmd, dev->direction);
-			ret = dma_start(dd->chan);
+			ret = dai_dma_op(dd, dma_start);
 			if (ret < 0)
 				return ret;
+#if CONFIG_CAVS_DMIC_SW_RAMP
+			dai_ramp_start(dev);
+#endif
 		} else {
 			dd->xrun = 0;
 		}
@@ -622,12 +1447,24 @@ static int dai_comp_trigger(struct comp_dev *dev, int cmd)
 		/* fallthrough */
 	case COMP_TRIGGER_STOP:
 		comp_dbg(dev, "dai_comp_trigger(), STOP");
-		ret = dma_stop(dd->chan);
+
+		/* DMA has not been started yet */
+		if (dd->zc_start) {
+			dd->zc_start = false;
+			break;
+		}
+
+		ret = dai_dma_op(dd, dma_stop);
 		dai_trigger(dd->dai, cmd, dev->direction);
 		break;
 	case COMP_TRIGGER_PAUSE:
 		comp_dbg(dev, "dai_comp_trigger(), PAUSE");
-		ret = dma_pause(dd->chan);
+
+		/* DMA has not been started yet, keep waiting for prefill */
+		if (dd->zc_start)
+			break;
+
+		ret = dai_dma_op(dd, dma_pause);
 		dai_trigger(dd->dai, cmd, dev->direction);
 	default:
 		break;
@@ -650,20 +1487,311 @@ static void dai_report_xrun(struct comp_dev *dev, uint32_t bytes)
 	}
 }
 
+/* start zero-copy playback DMA once the local buffer has been filled */
+static int dai_zero_copy_start(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *buffer = dd->local_buffer;
+	uint32_t period_bytes = dev->frames *
+		audio_stream_frame_bytes(&buffer->stream);
+	uint32_t flags = 0;
+	uint32_t avail;
+	int ret;
+
+	buffer_lock(buffer, &flags);
+	avail = buffer->stream.avail;
+	buffer_unlock(buffer, flags);
+
+	/* DMA has to stay a period behind the pipeline */
+	if (buffer->stream.size - avail >= period_bytes)
+		return 0;
+
+	audio_stream_writeback_from(&buffer->stream, buffer->stream.r_ptr,
+				    avail);
+	dd->zc_held = avail;
+	dd->zc_start = false;
+
+	dai_trigger(dd->dai, COMP_TRIGGER_START, dev->direction);
+	ret = dma_start(dd->chan);
+	if (ret < 0)
+		return ret;
+
+	dai_update_start_position(dev);
+
+	return 0;
+}
+
+/*
+ * Zero-copy transfer, local buffer is the DMA buffer. Playback data are
+ * written back for DMA as soon as they're produced and consumed once DMA
+ * has read them, captured data are produced once DMA has written them.
+ * Buffer pointers are updated in dai_dma_cb().
+ */
+static int dai_copy_zero_copy(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *buffer = dd->local_buffer;
+	uint32_t avail_bytes = 0;
+	uint32_t free_bytes = 0;
+	uint32_t copy_bytes;
+	uint32_t flags = 0;
+	uint32_t avail;
+	uint32_t free;
+	void *ptr;
+	int ret;
+
+	if (dd->zc_start)
+		return dai_zero_copy_start(dev);
+
+	ret = dma_get_data_size(dd->chan, &avail_bytes, &free_bytes);
+	if (ret < 0) {
+		dai_report_xrun(dev, 0);
+		return ret;
+	}
+
+	buffer_lock(buffer, &flags);
+	avail = buffer->stream.avail;
+	free = buffer->stream.free;
+	buffer_unlock(buffer, flags);
+
+	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+		/* new pipeline data must reach memory before DMA gets there */
+		if (avail > dd->zc_held) {
+			ptr = audio_stream_wrap(&buffer->stream,
+						(char *)buffer->stream.r_ptr +
+						dd->zc_held);
+			audio_stream_writeback_from(&buffer->stream, ptr,
+						    avail - dd->zc_held);
+			dd->zc_held = avail;
+		}
+
+		copy_bytes = MIN(avail, free_bytes);
+	} else {
+		copy_bytes = MIN(avail_bytes, free);
+	}
+
+	comp_dbg(dev, "dai_copy_zero_copy(), copy_bytes = 0x%x", copy_bytes);
+
+	/* return if it's not stream start */
+	if (!copy_bytes && dd->start_position != dev->position)
+		return 0;
+
+	ret = dma_copy(dd->chan, copy_bytes, 0);
+	if (ret < 0)
+		dai_report_xrun(dev, copy_bytes);
+
+	return ret;
+}
+
+/* local buffer sample to gateway MSB aligned 32 bit sample */
+static inline int32_t dai_agg_to_s32(const void *src, uint32_t frame_fmt)
+{
+	switch (frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return (int32_t)*(const int16_t *)src << 16;
+	case SOF_IPC_FRAME_S24_4LE:
+		return *(const int32_t *)src << 8;
+	default:
+		return *(const int32_t *)src;
+	}
+}
+
+/* gateway MSB aligned 32 bit sample to local buffer sample */
+static inline void dai_agg_from_s32(void *dst, int32_t x, uint32_t frame_fmt)
+{
+	switch (frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		*(int16_t *)dst = sat_int16(Q_SHIFT_RND(x, 31, 15));
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		*(int32_t *)dst = sat_int24(Q_SHIFT_RND(x, 31, 23));
+		break;
+	default:
+		*(int32_t *)dst = x;
+		break;
+	}
+}
+
+/*
+ * Splits local buffer frames to the gateways for playback, or joins them
+ * for capture, in one pass. Each gateway carries the next channels/count
+ * channels of a frame.
+ */
+static void dai_agg_process(struct comp_dev *dev, uint32_t frames)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct audio_stream *local = &dd->local_buffer->stream;
+	struct audio_stream *stream;
+	uint32_t sample_bytes = audio_stream_sample_bytes(local);
+	uint32_t channels = local->channels / dd->gw_count;
+	bool playback = dev->direction == SOF_IPC_STREAM_PLAYBACK;
+	int32_t *gw_ptr[SOF_DAI_ALH_MAX_STREAMS];
+	char *ptr;
+	uint32_t n;
+	uint32_t f;
+	uint32_t c;
+	int i;
+
+	ptr = playback ? local->r_ptr : local->w_ptr;
+	for (i = 0; i < dd->gw_count; i++) {
+		stream = &dd->gw[i].dma_buffer->stream;
+		gw_ptr[i] = playback ? stream->w_ptr : stream->r_ptr;
+	}
+
+	while (frames) {
+		n = MIN(frames, audio_stream_frames_without_wrap(local, ptr));
+		for (i = 0; i < dd->gw_count; i++)
+			n = MIN(n, audio_stream_frames_without_wrap
+				(&dd->gw[i].dma_buffer->stream, gw_ptr[i]));
+
+		for (f = 0; f < n; f++) {
+			for (i = 0; i < dd->gw_count; i++) {
+				for (c = 0; c < channels; c++) {
+					if (playback)
+						*gw_ptr[i] = dai_agg_to_s32
+							(ptr, local->frame_fmt);
+					else
+						dai_agg_from_s32
+							(ptr, *gw_ptr[i],
+							 local->frame_fmt);
+					gw_ptr[i]++;
+					ptr += sample_bytes;
+				}
+			}
+		}
+
+		frames -= n;
+		ptr = audio_stream_wrap(local, ptr);
+		for (i = 0; i < dd->gw_count; i++)
+			gw_ptr[i] = audio_stream_wrap
+				(&dd->gw[i].dma_buffer->stream, gw_ptr[i]);
+	}
+}
+
+/*
+ * Aggregated ALH copy. All gateways move by the frames the slowest one
+ * allows, so streams stay sample aligned, and data are converted between
+ * the local buffer and the gateway buffers without DMA callbacks.
+ */
+static int dai_agg_copy(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct comp_buffer *local = dd->local_buffer;
+	struct audio_stream *stream;
+	uint32_t avail_bytes = 0;
+	uint32_t free_bytes = 0;
+	uint32_t local_bytes;
+	uint32_t flags = 0;
+	uint32_t frames;
+	uint32_t bytes;
+	int ret;
+	int i;
+
+	buffer_lock(local, &flags);
+	bytes = dev->direction == SOF_IPC_STREAM_PLAYBACK ?
+		local->stream.avail : local->stream.free;
+	buffer_unlock(local, flags);
+
+	frames = bytes / audio_stream_frame_bytes(&local->stream);
+
+	for (i = 0; i < dd->gw_count; i++) {
+		ret = dma_get_data_size(dd->gw[i].chan, &avail_bytes,
+					&free_bytes);
+		if (ret < 0) {
+			dai_report_xrun(dev, 0);
+			return ret;
+		}
+
+		bytes = dev->direction == SOF_IPC_STREAM_PLAYBACK ?
+			free_bytes : avail_bytes;
+		frames = MIN(frames, bytes / dd->gw_frame_bytes);
+	}
+
+	bytes = frames * dd->gw_frame_bytes;
+	local_bytes = frames * audio_stream_frame_bytes(&local->stream);
+
+	comp_dbg(dev, "dai_agg_copy(), frames = %u", frames);
+
+	/* return if it's not stream start */
+	if (!frames && dd->start_position != dev->position)
+		return 0;
+
+	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+		buffer_invalidate(local, local_bytes);
+		dai_agg_process(dev, frames);
+
+		for (i = 0; i < dd->gw_count; i++) {
+			stream = &dd->gw[i].dma_buffer->stream;
+			audio_stream_writeback_from(stream, stream->w_ptr,
+						    bytes);
+			stream->w_ptr = audio_stream_wrap
+				(stream, (char *)stream->w_ptr + bytes);
+		}
+
+		comp_update_buffer_consume(local, local_bytes);
+	} else {
+		for (i = 0; i < dd->gw_count; i++) {
+			stream = &dd->gw[i].dma_buffer->stream;
+			audio_stream_invalidate_from(stream, stream->r_ptr,
+						     bytes);
+		}
+
+		dai_agg_process(dev, frames);
+
+		for (i = 0; i < dd->gw_count; i++) {
+			stream = &dd->gw[i].dma_buffer->stream;
+			stream->r_ptr = audio_stream_wrap
+				(stream, (char *)stream->r_ptr + bytes);
+		}
+
+		buffer_writeback(local, local_bytes);
+		comp_update_buffer_produce(local, local_bytes);
+	}
+
+	for (i = 0; i < dd->gw_count; i++) {
+		ret = dma_copy(dd->gw[i].chan, bytes, 0);
+		if (ret < 0) {
+			dai_report_xrun(dev, bytes);
+			return ret;
+		}
+	}
+
+	/* update host position (in bytes offset) for drivers */
+	dev->position += bytes * dd->gw_count;
+	if (dd->dai_pos) {
+		dd->dai_pos_blks += bytes * dd->gw_count;
+		*dd->dai_pos = dd->dai_pos_blks;
+	}
+
+	return 0;
+}
+
 /* copy and process stream data from source to sink buffers */
-static int dai_copy(struct comp_dev *dev)
+static int __hot_text dai_copy_stream(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 	uint32_t avail_bytes = 0;
 	uint32_t free_bytes = 0;
 	uint32_t copy_bytes = 0;
+	uint32_t frame_bytes;
 	uint32_t src_samples;
 	uint32_t sink_samples;
+	struct audio_stream *stream;
 	int ret = 0;
 	uint32_t flags = 0;
 
 	comp_dbg(dev, "dai_copy()");
 
+	if (dd->zero_copy)
+		return dai_copy_zero_copy(dev);
+
+	if (dd->gw_count)
+		return dai_agg_copy(dev);
+
+	/* slot group members are copied by the owner */
+	if (dai_slot_member(dev))
+		return 0;
+
 	/* get data sizes from DMA */
 	ret = dma_get_data_size(dd->chan, &avail_bytes, &free_bytes);
 	if (ret < 0) {
@@ -671,10 +1799,35 @@ static int dai_copy(struct comp_dev *dev)
 		return ret;
 	}
 
+	/* slot group DMA is never held back by any member, warm paused DMA
+	 * by the local buffer
+	 */
+	if (dd->group || dd->gated) {
+		frame_bytes = audio_stream_frame_bytes(&dd->dma_buffer->stream);
+		copy_bytes = dev->direction == SOF_IPC_STREAM_PLAYBACK ?
+			free_bytes : avail_bytes;
+		copy_bytes = copy_bytes / frame_bytes * frame_bytes;
+		goto copy;
+	}
+
 	buffer_lock(dd->local_buffer, &flags);
 
 	/* calculate minimum size to copy */
-	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+	if (dd->remap) {
+		/* remapped frames differ in channels, not in count */
+		stream = &dd->local_buffer->stream;
+		frame_bytes = audio_stream_frame_bytes(&dd->dma_buffer->stream);
+		if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+			src_samples = stream->avail /
+				audio_stream_frame_bytes(stream);
+			sink_samples = free_bytes / frame_bytes;
+		} else {
+			src_samples = avail_bytes / frame_bytes;
+			sink_samples = stream->free /
+				audio_stream_frame_bytes(stream);
+		}
+		copy_bytes = MIN(src_samples, sink_samples) * frame_bytes;
+	} else if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
 		src_samples = dd->local_buffer->stream.avail /
 			audio_stream_sample_bytes(&dd->local_buffer->stream);
 		sink_samples = free_bytes / get_sample_bytes(dd->frame_fmt);
@@ -690,6 +1843,7 @@ static int dai_copy(struct comp_dev *dev)
 
 	buffer_unlock(dd->local_buffer, flags);
 
+copy:
 	comp_dbg(dev, "dai_copy(), copy_bytes = 0x%x", copy_bytes);
 
 	/* return if it's not stream start */
@@ -705,12 +1859,63 @@ static int dai_copy(struct comp_dev *dev)
 	return ret;
 }
 
+/* takes the DAI timestamp and position of this copy, re-arming the
+ * timestamp for the next one
+ */
+static void __hot_text dai_ts_update(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	const struct timestamp_ops *ops = &dd->dai->drv->ts_ops;
+
+	dd->posn_walclk[0] = dd->posn_walclk[1];
+	dd->posn_bytes[0] = dd->posn_bytes[1];
+	dd->posn_walclk[1] = platform_timer_get(timer_get());
+	dd->posn_bytes[1] = dev->position;
+
+	if (!dd->ts_active ||
+	    ops->ts_get(dd->dai, &dd->ts_config, &dd->ts_last) < 0)
+		return;
+
+	dd->ts_fresh = true;
+	ops->ts_start(dd->dai, &dd->ts_config);
+}
+
+static int __hot_text dai_copy(struct comp_dev *dev)
+{
+	int ret = dai_copy_stream(dev);
+
+	dai_ts_update(dev);
+
+	return ret;
+}
+
+/* position at walclk, advanced from the last copy at the rate of the
+ * last two, but never by more than one copy
+ */
+static uint64_t dai_position_at(struct comp_dev *dev, uint64_t walclk)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	uint64_t span = dd->posn_walclk[1] - dd->posn_walclk[0];
+	uint64_t bytes = dd->posn_bytes[1] - dd->posn_bytes[0];
+	uint32_t frame_bytes;
+	uint64_t elapsed;
+
+	if (!dd->posn_walclk[0] || !span || walclk <= dd->posn_walclk[1])
+		return dd->posn_bytes[1];
+
+	frame_bytes = audio_stream_frame_bytes(&dd->local_buffer->stream);
+	elapsed = MIN(walclk - dd->posn_walclk[1], span);
+	bytes = bytes * elapsed / span;
+
+	return dd->posn_bytes[1] + bytes / frame_bytes * frame_bytes;
+}
+
 static int dai_position(struct comp_dev *dev, struct sof_ipc_stream_posn *posn)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 
-	/* TODO: improve accuracy by adding current DMA position */
-	posn->dai_posn = dev->position;
+	/* reported together with the wall clock read right after this */
+	posn->dai_posn = dai_position_at(dev, platform_timer_get(timer_get()));
 
 	/* set stream start wallclock */
 	posn->wallclock = dd->wallclock;
@@ -718,6 +1923,58 @@ static int dai_position(struct comp_dev *dev, struct sof_ipc_stream_posn *posn)
 	return 0;
 }
 
+/* one DAI drives several ALH streams, each with its own DMA channel */
+static int dai_alh_aggregate(struct comp_dev *dev,
+			     struct sof_ipc_dai_alh_params *alh)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct dai_gateway *gw;
+	int i;
+
+	if (alh->num_streams > SOF_DAI_ALH_MAX_STREAMS ||
+	    alh->stream_ids[0] != alh->stream_id || dd->chan) {
+		comp_err(dev, "dai_alh_aggregate(): invalid %u streams from %u",
+			 alh->num_streams, alh->stream_id);
+		return -EINVAL;
+	}
+
+	/* As with a single stream, DMA channels are got at first config */
+	if (dd->gw) {
+		if (dd->gw_count != alh->num_streams) {
+			comp_err(dev, "dai_alh_aggregate(): streams count changed");
+			return -EINVAL;
+		}
+		return 0;
+	}
+
+	dd->gw = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			 alh->num_streams * sizeof(*dd->gw));
+	if (!dd->gw)
+		return -ENOMEM;
+
+	dd->gw_count = alh->num_streams;
+
+	for (i = 0; i < dd->gw_count; i++) {
+		gw = &dd->gw[i];
+		gw->stream_id = alh->stream_ids[i];
+		gw->config.burst_elems = dd->config.burst_elems;
+		dma_sg_init(&gw->config.elem_array);
+
+		gw->chan = dma_channel_get(dd->dma, gw->stream_id);
+		if (!gw->chan) {
+			comp_err(dev, "dai_alh_aggregate(): dma_channel_get() failed for stream %u",
+				 gw->stream_id);
+			dai_agg_free(dd);
+			return -EIO;
+		}
+	}
+
+	comp_info(dev, "dai_alh_aggregate(), %u streams from %u",
+		  dd->gw_count, alh->stream_id);
+
+	return 0;
+}
+
 static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 {
 	struct sof_ipc_comp_config *dconfig = dev_comp_config(dev);
@@ -725,6 +1982,7 @@ static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 	struct sof_ipc_comp_dai *dai = COMP_GET_IPC(dev, sof_ipc_comp_dai);
 	int channel = 0;
 	int handshake;
+	int ret;
 
 	comp_info(dev, "dai_config() dai %d.%d",
 		  config->type, config->dai_index);
@@ -749,6 +2007,14 @@ static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 		comp_info(dev, "dai_config(), config->dmic.fifo_bits = %u config->dmic.num_pdm_active = %u",
 			  config->dmic.fifo_bits,
 			  config->dmic.num_pdm_active);
+
+#if CONFIG_CAVS_DMIC_SW_RAMP
+		/* range is checked by the DMIC driver */
+		if (config->dmic.unmute_ramp_time)
+			dd->ramp_time_ms = config->dmic.unmute_ramp_time;
+		else
+			dd->ramp_time_ms = LOGRAMP_TIME_MS;
+#endif
 		break;
 	case SOF_DAI_INTEL_HDA:
 		channel = config->hda.link_dma_ch;
@@ -782,6 +2048,15 @@ static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 		channel = config->alh.stream_id;
 		dd->stream_id = config->alh.stream_id;
 		comp_info(dev, "dai_config(), channel = %d", channel);
+
+		if (config->alh.num_streams > 1) {
+			ret = dai_alh_aggregate(dev, &config->alh);
+			if (ret < 0)
+				return ret;
+
+			/* channels are owned by the gateways */
+			channel = DMA_CHAN_INVALID;
+		}
 		break;
 	case SOF_DAI_IMX_SAI:
 		handshake = dai_get_handshake(dd->dai, dai->direction,
@@ -807,6 +2082,10 @@ static int dai_config(struct comp_dev *dev, struct sof_ipc_dai_config *config)
 
 	platform_shared_commit(dd->dai, sizeof(*dd->dai));
 
+	/* DAI is configured and its DMA run by the slot group owner */
+	if (dai_slot_member(dev))
+		return 0;
+
 	if (channel != DMA_CHAN_INVALID) {
 		if (dd->chan)
 			/* remove callback */
@@ -841,7 +2120,9 @@ static int dai_ts_config(struct comp_dev *dev)
 	cfg->direction = dai->direction;
 	cfg->index = dd->dai->index;
 	cfg->dma_id = dd->dma->plat_data.id;
-	cfg->dma_chan_index = dd->chan->index;
+	/* aggregated gateways are timestamped by the first one */
+	cfg->dma_chan_index = dd->gw_count ? dd->gw[0].chan->index :
+		dd->chan->index;
 	cfg->dma_chan_count = dd->dma->plat_data.channels;
 	if (!dd->dai->drv->ts_ops.ts_config)
 		return -ENXIO;
@@ -849,15 +2130,27 @@ static int dai_ts_config(struct comp_dev *dev)
 	return dd->dai->drv->ts_ops.ts_config(dd->dai, cfg);
 }
 
+/* once started, the timestamp is taken and re-armed by every copy */
 static int dai_ts_start(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
+	int ret;
 
 	comp_dbg(dev, "dai_ts_start()");
-	if (!dd->dai->drv->ts_ops.ts_start)
+	if (!dd->dai->drv->ts_ops.ts_start || !dd->dai->drv->ts_ops.ts_get)
 		return -ENXIO;
 
-	return dd->dai->drv->ts_ops.ts_start(dd->dai, &dd->ts_config);
+	if (dd->ts_active)
+		return 0;
+
+	ret = dd->dai->drv->ts_ops.ts_start(dd->dai, &dd->ts_config);
+	if (ret < 0)
+		return ret;
+
+	dd->ts_active = true;
+	dd->ts_fresh = false;
+
+	return 0;
 }
 
 static int dai_ts_stop(struct comp_dev *dev)
@@ -868,9 +2161,12 @@ static int dai_ts_stop(struct comp_dev *dev)
 	if (!dd->dai->drv->ts_ops.ts_stop)
 		return -ENXIO;
 
+	dd->ts_active = false;
+
 	return dd->dai->drv->ts_ops.ts_stop(dd->dai, &dd->ts_config);
 }
 
+/* hands out the timestamp of the last copy, each one only once */
 static int dai_ts_get(struct comp_dev *dev, struct timestamp_data *tsd)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
@@ -879,7 +2175,15 @@ static int dai_ts_get(struct comp_dev *dev, struct timestamp_data *tsd)
 	if (!dd->dai->drv->ts_ops.ts_get)
 		return -ENXIO;
 
-	return dd->dai->drv->ts_ops.ts_get(dd->dai, &dd->ts_config, tsd);
+	if (!dd->ts_fresh) {
+		tsd->walclk_rate = dd->ts_config.walclk_rate;
+		return -ENODATA;
+	}
+
+	*tsd = dd->ts_last;
+	dd->ts_fresh = false;
+
+	return 0;
 }
 
 static const struct comp_driver comp_dai = {
@@ -56,11 +56,91 @@ static void dcblock_init_state(struct comp_data *cd)
 	int i;
 
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
-		cd->state[i].y_prev = 0;
-		cd->state[i].x_prev = 0;
+		cd->state.y_prev[i] = 0;
+		cd->state.x_prev[i] = 0;
 	}
 }
 
+/**
+ * \brief Copies frames of filters with R set to one.
+ * With R of one the output equals the input, the state is updated to
+ * the last frame so the filter can resume when R is changed.
+ */
+static void dcblock_pass(const struct comp_dev *dev,
+			 const struct audio_stream *source,
+			 const struct audio_stream *sink,
+			 uint32_t frames, uint32_t first, uint32_t count)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t frame_bytes = audio_stream_frame_bytes(source);
+	uint32_t sample_bytes = audio_stream_sample_bytes(source);
+	char *last;
+	void *x;
+	void *y;
+	uint32_t i;
+	int ch;
+
+	if (!frames)
+		return;
+
+	if (count == source->channels) {
+		audio_stream_copy(source, 0, (struct audio_stream *)sink, 0,
+				  frames * frame_bytes);
+	} else {
+		/* other channels of the sink belong to other cores */
+		for (ch = first; ch < first + count; ch++) {
+			x = audio_stream_read_frag(source, ch, sample_bytes);
+			y = audio_stream_write_frag(sink, ch, sample_bytes);
+			for (i = 0; i < frames; i++) {
+				if (sample_bytes == sizeof(int16_t))
+					*(int16_t *)y = *(int16_t *)x;
+				else
+					*(int32_t *)y = *(int32_t *)x;
+				x = audio_stream_wrap(source,
+						      (char *)x + frame_bytes);
+				y = audio_stream_wrap(sink,
+						      (char *)y + frame_bytes);
+			}
+		}
+	}
+
+	last = (char *)source->r_ptr + (frames - 1) * frame_bytes +
+		first * sample_bytes;
+	for (ch = first; ch < first + count; ch++) {
+		x = audio_stream_wrap(source, last);
+		if (sample_bytes == sizeof(int16_t))
+			cd->state.x_prev[ch] = *(int16_t *)x << 16;
+		else if (source->frame_fmt == SOF_IPC_FRAME_S24_4LE)
+			cd->state.x_prev[ch] = *(int32_t *)x << 8;
+		else
+			cd->state.x_prev[ch] = *(int32_t *)x;
+
+		cd->state.y_prev[ch] = cd->state.x_prev[ch];
+		last += sample_bytes;
+	}
+}
+
+/**
+ * \brief Selects the processing function for the source format.
+ * The filters are bypassed with a plain copy when R of every channel
+ * is one.
+ */
+static dcblock_func dcblock_select_func(struct comp_data *cd)
+{
+	dcblock_func func = dcblock_find_func(cd->source_format);
+	int i;
+
+	if (!func)
+		return NULL;
+
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
+		if (cd->R_coeffs[i] != ONE_Q2_30)
+			return func;
+	}
+
+	return dcblock_pass;
+}
+
 /**
  * \brief Creates DC Blocking Filter component.
  * \return Pointer to DC Blocking Filter component device.
@@ -91,7 +171,10 @@ static struct comp_dev *dcblock_new(const struct comp_driver *drv,
 		       sizeof(struct sof_ipc_comp_process));
 	assert(!ret);
 
-	cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	/* channel state may be processed on other cores, see comp_split.h */
+	cd = rzalloc(SOF_MEM_ZONE_RUNTIME,
+		     IS_ENABLED(CONFIG_COMP_CHANNEL_SPLIT) ?
+		     SOF_MEM_FLAG_SHARED : 0, SOF_MEM_CAPS_RAM, sizeof(*cd));
 	if (!cd) {
 		rfree(dev);
 		return NULL;
@@ -225,6 +308,10 @@ static int dcblock_cmd_set_data(struct comp_dev *dev,
 			       req_size);
 		assert(!ret);
 
+		/* switch between filtering and bypass if already prepared */
+		if (cd->dcblock_func)
+			cd->dcblock_func = dcblock_select_func(cd);
+
 		break;
 	default:
 		comp_err(dev, "dcblock_set_data(), invalid command %i",
@@ -274,15 +361,44 @@ static int dcblock_trigger(struct comp_dev *dev, int cmd)
 	return comp_set_state(dev, cmd);
 }
 
+/**
+ * \brief Processes runs of channels active in sink, all channels unless
+ * the consumer reads only some of them.
+ * \param[in,out] dev DC Blocking Filter base component device.
+ * \param[in] source Source stream.
+ * \param[in,out] sink Sink stream.
+ * \param[in] frames Number of frames to process.
+ */
+static void dcblock_run(struct comp_dev *dev,
+			const struct audio_stream *source,
+			struct audio_stream *sink, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t nch = source->channels;
+	uint32_t first;
+	uint32_t ch;
+
+	for (first = 0; first < nch; first = ch + 1) {
+		if (!audio_stream_channel_active(sink, first)) {
+			ch = first;
+			continue;
+		}
+
+		for (ch = first + 1; ch < nch; ch++)
+			if (!audio_stream_channel_active(sink, ch))
+				break;
+
+		cd->dcblock_func(dev, source, sink, frames, first, ch - first);
+	}
+}
+
 static void dcblock_process(struct comp_dev *dev, struct comp_buffer *source,
 			    struct comp_buffer *sink, int frames,
 			    uint32_t source_bytes, uint32_t sink_bytes)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-
 	buffer_invalidate(source, source_bytes);
 
-	cd->dcblock_func(dev, &source->stream, &sink->stream, frames);
+	dcblock_run(dev, &source->stream, &sink->stream, frames);
 
 	buffer_writeback(sink, sink_bytes);
 
@@ -291,6 +407,46 @@ static void dcblock_process(struct comp_dev *dev, struct comp_buffer *source,
 	comp_update_buffer_produce(sink, sink_bytes);
 }
 
+/**
+ * \brief Processes frames, used when chained by the pipeline.
+ * \param[in,out] dev DC Blocking Filter base component device.
+ * \param[in] source Source stream.
+ * \param[in,out] sink Sink stream.
+ * \param[in] frames Number of frames to process.
+ * \return Error code.
+ */
+static int dcblock_process_stream(struct comp_dev *dev,
+				  const struct audio_stream *source,
+				  struct audio_stream *sink, uint32_t frames)
+{
+	dcblock_run(dev, source, sink, frames);
+
+	return 0;
+}
+
+/**
+ * \brief Processes frames of a range of channels, used when the channels
+ * are split over cores.
+ * \param[in,out] dev DC Blocking Filter base component device.
+ * \param[in] source Source stream.
+ * \param[in,out] sink Sink stream.
+ * \param[in] frames Number of frames to process.
+ * \param[in] first First channel to process.
+ * \param[in] count Number of channels to process.
+ * \return Error code.
+ */
+static int dcblock_process_channels(struct comp_dev *dev,
+				    const struct audio_stream *source,
+				    struct audio_stream *sink, uint32_t frames,
+				    uint32_t first, uint32_t count)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	cd->dcblock_func(dev, source, sink, frames, first, count);
+
+	return 0;
+}
+
 /**
  * \brief Copies and processes stream data.
  * \param[in,out] dev DC Blocking Filter base component device.
@@ -371,7 +527,7 @@ static int dcblock_prepare(struct comp_dev *dev)
 
 	dcblock_init_state(cd);
 
-	cd->dcblock_func = dcblock_find_func(cd->source_format);
+	cd->dcblock_func = dcblock_select_func(cd);
 	if (!cd->dcblock_func) {
 		comp_err(dev, "dcblock_prepare(), No processing function matching frames format");
 		ret = -EINVAL;
@@ -405,6 +561,7 @@ static int dcblock_reset(struct comp_dev *dev)
 static const struct comp_driver comp_dcblock = {
 	.type = SOF_COMP_DCBLOCK,
 	.uid  = SOF_UUID(dcblock_uuid),
+	.flags = COMP_DRV_INPLACE | COMP_DRV_CHANNEL_WISE,
 	.ops  = {
 		 .create	= dcblock_new,
 		 .free		= dcblock_free,
@@ -412,6 +569,8 @@ static const struct comp_driver comp_dcblock = {
 		 .cmd		= dcblock_cmd,
 		 .trigger	= dcblock_trigger,
 		 .copy		= dcblock_copy,
+		 .process	= dcblock_process_stream,
+		 .process_channels = dcblock_process_channels,
 		 .prepare	= dcblock_prepare,
 		 .reset		= dcblock_reset,
 	},
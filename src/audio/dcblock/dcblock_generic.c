@@ -5,59 +5,80 @@
 // Author: Sebastiano Carlucci <scarlucci@google.com>
 
 #include <stdint.h>
+#include <sof/audio/audio_stream.h>
 #include <sof/audio/component.h>
 #include <sof/audio/format.h>
 #include <sof/audio/dcblock/dcblock.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+
+#if DCBLOCK_GENERIC
 
 /**
  *
  * Genereric processing function. Input is 32 bits.
  *
  */
-static int32_t dcblock_generic(struct dcblock_state *state,
-			       int64_t R, int32_t x)
+static inline int32_t dcblock_generic(int32_t *x_prev, int32_t *y_prev,
+				      int64_t R, int32_t x)
 {
 	/*
 	 * R: Q2.30, y_prev: Q1.31
 	 * R * y_prev: Q3.61
 	 */
-	int64_t out = x - state->x_prev +
-		      Q_SHIFT_RND(R * state->y_prev, 61, 31);
+	int64_t out = x - *x_prev + Q_SHIFT_RND(R * *y_prev, 61, 31);
 
-	state->y_prev = sat_int32(out);
-	state->x_prev = x;
+	*y_prev = sat_int32(out);
+	*x_prev = x;
 
-	return state->y_prev;
+	return *y_prev;
 }
 
 #if CONFIG_FORMAT_S16LE
 static void dcblock_s16_default(const struct comp_dev *dev,
 				const struct audio_stream *source,
 				const struct audio_stream *sink,
-				uint32_t frames)
+				uint32_t frames, uint32_t first,
+				uint32_t count)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct dcblock_state *state;
+	struct dcblock_state *state = &cd->state;
 	int16_t *x;
 	int16_t *y;
+	int32_t x_prev;
+	int32_t y_prev;
 	int32_t R;
 	int32_t tmp;
-	int idx;
+	int nch = source->channels;
 	int ch;
 	int i;
-	int nch = source->channels;
+	int n;
+	int rem;
 
-	for (ch = 0; ch < nch; ch++) {
-		state = &cd->state[ch];
+	for (ch = first; ch < first + count; ch++) {
+		x = audio_stream_read_frag_s16(source, ch);
+		y = audio_stream_write_frag_s16(sink, ch);
+		x_prev = state->x_prev[ch];
+		y_prev = state->y_prev[ch];
 		R = cd->R_coeffs[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s16(source, idx);
-			y = audio_stream_read_frag_s16(sink, idx);
-			tmp = dcblock_generic(state, R, *x << 16);
-			*y = sat_int16(Q_SHIFT_RND(tmp, 31, 15));
-			idx += nch;
+		rem = frames;
+		while (rem) {
+			n = audio_stream_frames_without_wrap(source, x);
+			n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+			n = MIN(n, rem);
+			for (i = 0; i < n; i++) {
+				tmp = dcblock_generic(&x_prev, &y_prev, R,
+						      *x << 16);
+				*y = sat_int16(Q_SHIFT_RND(tmp, 31, 15));
+				x += nch;
+				y += nch;
+			}
+			rem -= n;
+			x = audio_stream_wrap(source, x);
+			y = audio_stream_wrap(sink, y);
 		}
+		state->x_prev[ch] = x_prev;
+		state->y_prev[ch] = y_prev;
 	}
 }
 #endif /* CONFIG_FORMAT_S16LE */
@@ -66,30 +87,47 @@ static void dcblock_s16_default(const struct comp_dev *dev,
 static void dcblock_s24_default(const struct comp_dev *dev,
 				const struct audio_stream *source,
 				const struct audio_stream *sink,
-				uint32_t frames)
+				uint32_t frames, uint32_t first,
+				uint32_t count)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct dcblock_state *state;
+	struct dcblock_state *state = &cd->state;
 	int32_t *x;
 	int32_t *y;
+	int32_t x_prev;
+	int32_t y_prev;
 	int32_t R;
 	int32_t tmp;
-	int idx;
+	int nch = source->channels;
 	int ch;
 	int i;
-	int nch = source->channels;
+	int n;
+	int rem;
 
-	for (ch = 0; ch < nch; ch++) {
-		state = &cd->state[ch];
+	for (ch = first; ch < first + count; ch++) {
+		x = audio_stream_read_frag_s32(source, ch);
+		y = audio_stream_write_frag_s32(sink, ch);
+		x_prev = state->x_prev[ch];
+		y_prev = state->y_prev[ch];
 		R = cd->R_coeffs[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_read_frag_s32(sink, idx);
-			tmp = dcblock_generic(state, R, *x << 8);
-			*y = sat_int24(Q_SHIFT_RND(tmp, 31, 23));
-			idx += nch;
+		rem = frames;
+		while (rem) {
+			n = audio_stream_frames_without_wrap(source, x);
+			n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+			n = MIN(n, rem);
+			for (i = 0; i < n; i++) {
+				tmp = dcblock_generic(&x_prev, &y_prev, R,
+						      *x << 8);
+				*y = sat_int24(Q_SHIFT_RND(tmp, 31, 23));
+				x += nch;
+				y += nch;
+			}
+			rem -= n;
+			x = audio_stream_wrap(source, x);
+			y = audio_stream_wrap(sink, y);
 		}
+		state->x_prev[ch] = x_prev;
+		state->y_prev[ch] = y_prev;
 	}
 }
 #endif /* CONFIG_FORMAT_S24LE */
@@ -98,28 +136,44 @@ static void dcblock_s24_default(const struct comp_dev *dev,
 static void dcblock_s32_default(const struct comp_dev *dev,
 				const struct audio_stream *source,
 				const struct audio_stream *sink,
-				uint32_t frames)
+				uint32_t frames, uint32_t first,
+				uint32_t count)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct dcblock_state *state;
+	struct dcblock_state *state = &cd->state;
 	int32_t *x;
 	int32_t *y;
+	int32_t x_prev;
+	int32_t y_prev;
 	int32_t R;
-	int idx;
+	int nch = source->channels;
 	int ch;
 	int i;
-	int nch = source->channels;
+	int n;
+	int rem;
 
-	for (ch = 0; ch < nch; ch++) {
-		state = &cd->state[ch];
+	for (ch = first; ch < first + count; ch++) {
+		x = audio_stream_read_frag_s32(source, ch);
+		y = audio_stream_write_frag_s32(sink, ch);
+		x_prev = state->x_prev[ch];
+		y_prev = state->y_prev[ch];
 		R = cd->R_coeffs[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_read_frag_s32(sink, idx);
-			*y = dcblock_generic(state, R, *x);
-			idx += nch;
+		rem = frames;
+		while (rem) {
+			n = audio_stream_frames_without_wrap(source, x);
+			n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+			n = MIN(n, rem);
+			for (i = 0; i < n; i++) {
+				*y = dcblock_generic(&x_prev, &y_prev, R, *x);
+				x += nch;
+				y += nch;
+			}
+			rem -= n;
+			x = audio_stream_wrap(source, x);
+			y = audio_stream_wrap(sink, y);
 		}
+		state->x_prev[ch] = x_prev;
+		state->y_prev[ch] = y_prev;
 	}
 }
 #endif /* CONFIG_FORMAT_S32LE */
@@ -138,3 +192,5 @@ const struct dcblock_func_map dcblock_fnmap[] = {
 };
 
 const size_t dcblock_fncount = ARRAY_SIZE(dcblock_fnmap);
+
+#endif /* DCBLOCK_GENERIC */
@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/audio/dcblock/dcblock.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+
+#if DCBLOCK_HIFI3
+
+#include <xtensa/tie/xt_hifi3.h>
+
+/*
+ * Processes one sample of a channel pair, the high lane is the lower
+ * channel. y[n] = x[n] - x[n-1] + R * y[n-1] is accumulated Q18.46 from
+ * the Q2.30 x Q1.31 products, the input difference is multiplied by one
+ * in Q2.30 to have it in the same format without overflow.
+ */
+static inline ae_int32x2 dcblock_hifi3(ae_int32x2 *x_prev,
+				       ae_int32x2 *y_prev,
+				       ae_int32x2 R, ae_int32x2 x)
+{
+	ae_f32x2 one = AE_MOVDA32(ONE_Q2_30);
+	ae_f64 acc_h;
+	ae_f64 acc_l;
+	ae_f32x2 y;
+
+	acc_h = AE_MULF32R_HH(one, x);
+	AE_MULSF32R_HH(acc_h, one, *x_prev);
+	AE_MULAF32R_HH(acc_h, R, *y_prev);
+
+	acc_l = AE_MULF32R_LL(one, x);
+	AE_MULSF32R_LL(acc_l, one, *x_prev);
+	AE_MULAF32R_LL(acc_l, R, *y_prev);
+
+	/* Convert to Q17.47, round and saturate to Q1.31 */
+	y = AE_ROUND32X2F48SSYM(AE_SLAI64S(acc_h, 1), AE_SLAI64S(acc_l, 1));
+
+	*x_prev = x;
+	*y_prev = y;
+
+	return y;
+}
+
+/* loads a channel pair or a single channel to both lanes as Q1.31 */
+static inline ae_int32x2 dcblock_load(const void *ptr, enum sof_ipc_frame fmt,
+				      bool pair)
+{
+	const int16_t *x16 = ptr;
+	ae_int32x2 x;
+
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		if (pair)
+			return AE_MOVDA32X2(x16[0] << 16, x16[1] << 16);
+		return AE_MOVDA32(x16[0] << 16);
+	case SOF_IPC_FRAME_S24_4LE:
+		x = pair ? *(const ae_int32x2 *)ptr :
+			   AE_L32_I((const ae_int32 *)ptr, 0);
+		return AE_SLAI32(x, 8);
+	default:
+		return pair ? *(const ae_int32x2 *)ptr :
+			      AE_L32_I((const ae_int32 *)ptr, 0);
+	}
+}
+
+/* stores a channel pair or the low lane of a single channel */
+static inline void dcblock_store(void *ptr, ae_int32x2 y,
+				 enum sof_ipc_frame fmt, bool pair)
+{
+	int16_t *y16 = ptr;
+
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		y = AE_SRAI32R(y, 16);
+		y = AE_SLAI32S(y, 16);
+		y = AE_SRAI32(y, 16);
+		if (pair) {
+			y16[0] = AE_MOVAD32_H(y);
+			y16[1] = AE_MOVAD32_L(y);
+		} else {
+			y16[0] = AE_MOVAD32_L(y);
+		}
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		y = AE_SRAI32R(y, 8);
+		y = AE_SLAI32S(y, 8);
+		y = AE_SRAI32(y, 8);
+		/* fall through */
+	default:
+		if (pair)
+			*(ae_int32x2 *)ptr = y;
+		else
+			AE_S32_L_I(y, (ae_int32 *)ptr, 0);
+		break;
+	}
+}
+
+/*
+ * Filters channel pairs with the state of a pair in one register each.
+ * Pair access is 64 bit aligned only with an even number of channels, so
+ * odd channel counts are processed one channel at a time. Channel split
+ * ranges start at even channels, so they never cut a pair.
+ */
+static inline void dcblock_hifi3_process(const struct comp_dev *dev,
+					 const struct audio_stream *source,
+					 const struct audio_stream *sink,
+					 uint32_t frames, uint32_t first,
+					 uint32_t count, enum sof_ipc_frame fmt)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct dcblock_state *state = &cd->state;
+	uint32_t sample_bytes = audio_stream_sample_bytes(source);
+	uint32_t frame_bytes = audio_stream_frame_bytes(source);
+	int nch = source->channels;
+	bool pair = !(nch & 1);
+	int step = pair ? 2 : 1;
+	ae_int32x2 x_prev;
+	ae_int32x2 y_prev;
+	ae_int32x2 R;
+	ae_int32x2 in;
+	ae_int32x2 out;
+	char *x;
+	char *y;
+	int ch;
+	int i;
+	int n;
+	int rem;
+
+	for (ch = first; ch < first + count; ch += step) {
+		x = audio_stream_wrap(source, (char *)source->r_ptr +
+				      ch * sample_bytes);
+		y = audio_stream_wrap(sink, (char *)sink->w_ptr +
+				      ch * sample_bytes);
+		if (pair) {
+			x_prev = *(ae_int32x2 *)&state->x_prev[ch];
+			y_prev = *(ae_int32x2 *)&state->y_prev[ch];
+			R = *(ae_int32x2 *)&cd->R_coeffs[ch];
+		} else {
+			x_prev = AE_MOVDA32(state->x_prev[ch]);
+			y_prev = AE_MOVDA32(state->y_prev[ch]);
+			R = AE_MOVDA32(cd->R_coeffs[ch]);
+		}
+
+		rem = frames;
+		while (rem) {
+			n = audio_stream_frames_without_wrap(source, x);
+			n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+			n = MIN(n, rem);
+			for (i = 0; i < n; i++) {
+				in = dcblock_load(x, fmt, pair);
+				out = dcblock_hifi3(&x_prev, &y_prev, R, in);
+				dcblock_store(y, out, fmt, pair);
+				x += frame_bytes;
+				y += frame_bytes;
+			}
+			rem -= n;
+			x = audio_stream_wrap(source, x);
+			y = audio_stream_wrap(sink, y);
+		}
+
+		if (pair) {
+			*(ae_int32x2 *)&state->x_prev[ch] = x_prev;
+			*(ae_int32x2 *)&state->y_prev[ch] = y_prev;
+		} else {
+			state->x_prev[ch] = AE_MOVAD32_L(x_prev);
+			state->y_prev[ch] = AE_MOVAD32_L(y_prev);
+		}
+	}
+}
+
+#if CONFIG_FORMAT_S16LE
+static void dcblock_s16_hifi3(const struct comp_dev *dev,
+			      const struct audio_stream *source,
+			      const struct audio_stream *sink,
+			      uint32_t frames, uint32_t first,
+			      uint32_t count)
+{
+	dcblock_hifi3_process(dev, source, sink, frames, first, count,
+			      SOF_IPC_FRAME_S16_LE);
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+static void dcblock_s24_hifi3(const struct comp_dev *dev,
+			      const struct audio_stream *source,
+			      const struct audio_stream *sink,
+			      uint32_t frames, uint32_t first,
+			      uint32_t count)
+{
+	dcblock_hifi3_process(dev, source, sink, frames, first, count,
+			      SOF_IPC_FRAME_S24_4LE);
+}
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+static void dcblock_s32_hifi3(const struct comp_dev *dev,
+			      const struct audio_stream *source,
+			      const struct audio_stream *sink,
+			      uint32_t frames, uint32_t first,
+			      uint32_t count)
+{
+	dcblock_hifi3_process(dev, source, sink, frames, first, count,
+			      SOF_IPC_FRAME_S32_LE);
+}
+#endif /* CONFIG_FORMAT_S32LE */
+
+const struct dcblock_func_map dcblock_fnmap[] = {
+/* { SOURCE_FORMAT , PROCESSING FUNCTION } */
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, dcblock_s16_hifi3 },
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, dcblock_s24_hifi3 },
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, dcblock_s32_hifi3 },
+#endif /* CONFIG_FORMAT_S32LE */
+};
+
+const size_t dcblock_fncount = ARRAY_SIZE(dcblock_fnmap);
+
+#endif /* DCBLOCK_HIFI3 */
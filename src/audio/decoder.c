@@ -0,0 +1,574 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/decoder.c
+ * \brief Decoder component playing compressed host streams
+ *
+ * Every LL run moves compressed data from the source into a linear staging
+ * area and passes decoded PCM to the sink. Decoding itself runs in an EDF
+ * task, a block at a time, so a period doesn't have to fit a codec frame.
+ * Output is two blocks late, like with comp_block.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/decoder.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/uuid.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/schedule/edf_schedule.h>
+#include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
+#include <sof/string.h>
+#include <sof/trace/trace.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <user/decoder.h>
+#include <user/trace.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const struct comp_driver comp_decoder;
+
+/* 0c6a3b2e-5f0d-4a7e-9b1c-8d2f4e6a7c91 */
+DECLARE_SOF_UUID("decoder", decoder_uuid, 0x0c6a3b2e, 0x5f0d, 0x4a7e,
+		 0x9b, 0x1c, 0x8d, 0x2f, 0x4e, 0x6a, 0x7c, 0x91);
+
+/* 6e1f8c4d-2b7a-4d93-a5e0-3c9b1f7d2a48 */
+DECLARE_SOF_UUID("decoder-task", decoder_task_uuid, 0x6e1f8c4d, 0x2b7a,
+		 0x4d93, 0xa5, 0xe0, 0x3c, 0x9b, 0x1f, 0x7d, 0x2a, 0x48);
+
+/* default length of a decoded block */
+#define DECODER_BLOCK_MS	10
+
+/* staged compressed frames, one being decoded and the next ones arriving */
+#define DECODER_STAGE_FRAMES	4
+
+struct comp_data {
+	struct sof_decoder_config config;
+	struct decoder_codec_ctx ctx;
+	bool codec_ready;		/**< ctx set up by codec init() */
+
+	uint8_t *stage;			/**< linear compressed data */
+	uint32_t stage_size;
+	uint32_t stage_bytes;		/**< compressed bytes in stage */
+
+	uint32_t block_frames;		/**< PCM frames decoded by a task run */
+	struct audio_stream result;	/**< PCM of the task */
+	struct audio_stream out;	/**< PCM going to sink */
+
+	struct task task;
+	bool task_ready;		/**< task initialized */
+	uint64_t deadline;
+	uint64_t deadline_ticks;
+	bool busy;			/**< task owns stage and result */
+	int ret;			/**< error of the last task run */
+};
+
+static SHARED_DATA struct list_item decoder_codec_list;
+
+static struct list_item *decoder_codec_list_get(void)
+{
+	struct list_item *list = platform_shared_get(&decoder_codec_list,
+						     sizeof(decoder_codec_list));
+
+	/* zero until the first codec is registered */
+	if (!list->next)
+		list_init(list);
+
+	return list;
+}
+
+static struct decoder_codec *decoder_codec_get(uint32_t id)
+{
+	struct decoder_codec *codec;
+	struct list_item *clist;
+
+	list_for_item(clist, decoder_codec_list_get()) {
+		codec = container_of(clist, struct decoder_codec, list);
+		if (codec->id == id)
+			return codec;
+	}
+
+	return NULL;
+}
+
+int decoder_codec_register(struct decoder_codec *codec)
+{
+	if (!codec->ops || !codec->ops->decode || !codec->frames_max ||
+	    !codec->frame_bytes_max)
+		return -EINVAL;
+
+	if (decoder_codec_get(codec->id))
+		return -EEXIST;
+
+	list_item_append(&codec->list, decoder_codec_list_get());
+	return 0;
+}
+
+void decoder_codec_unregister(struct decoder_codec *codec)
+{
+	list_item_del(&codec->list);
+}
+
+static enum task_state decoder_run(void *data)
+{
+	struct comp_data *cd = data;
+	const struct decoder_codec_ops *ops = cd->ctx.codec->ops;
+	uint32_t frame_bytes = audio_stream_frame_bytes(&cd->result);
+	uint32_t pos = 0;
+	uint32_t consumed;
+	uint32_t produced;
+	int ret;
+
+	/* result is emptied before the task runs, it's linear */
+	do {
+		consumed = 0;
+		produced = 0;
+		ret = ops->decode(&cd->ctx, cd->stage + pos,
+				  cd->stage_bytes - pos, &consumed,
+				  cd->result.w_ptr, cd->result.free / frame_bytes,
+				  &produced);
+		pos += consumed;
+		audio_stream_produce(&cd->result, produced * frame_bytes);
+	} while (!ret && (consumed || produced));
+
+	/* out of input or output space is fine, next run continues */
+	if (ret == -ENODATA || ret == -ENOSPC)
+		ret = 0;
+
+	/* keep the partial frame at the start of stage */
+	if (pos) {
+		cd->stage_bytes -= pos;
+		memmove(cd->stage, cd->stage + pos, cd->stage_bytes);
+	}
+
+	cd->ret = ret;
+
+	/* the pipeline task takes the result */
+	cd->busy = false;
+
+	return SOF_TASK_STATE_COMPLETED;
+}
+
+static uint64_t decoder_deadline(void *data)
+{
+	struct comp_data *cd = data;
+
+	return cd->deadline;
+}
+
+static const struct task_ops decoder_task_ops = {
+	.run		= decoder_run,
+	.get_deadline	= decoder_deadline,
+};
+
+static int decoder_apply_config(struct comp_dev *dev,
+				const struct sof_decoder_config *config,
+				uint32_t size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (size < sizeof(*config) || config->size < sizeof(*config)) {
+		comp_err(dev, "decoder_apply_config(): config size %u too small",
+			 size);
+		return -EINVAL;
+	}
+
+	if (!config->rate || !config->channels ||
+	    config->channels > SOF_IPC_MAX_CHANNELS) {
+		comp_err(dev, "decoder_apply_config(): invalid rate %u or channels %u",
+			 config->rate, config->channels);
+		return -EINVAL;
+	}
+
+	switch (config->frame_fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+#endif
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+#endif
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+#endif
+		break;
+	default:
+		comp_err(dev, "decoder_apply_config(): unsupported format %u",
+			 config->frame_fmt);
+		return -EINVAL;
+	}
+
+	cd->config = *config;
+	return 0;
+}
+
+static struct comp_dev *decoder_new(const struct comp_driver *drv,
+				    struct sof_ipc_comp *comp)
+{
+	struct sof_ipc_comp_process *ipc_decoder =
+		(struct sof_ipc_comp_process *)comp;
+	struct sof_ipc_comp_process *decoder;
+	struct comp_dev *dev;
+	struct comp_data *cd;
+	int ret;
+
+	comp_cl_info(&comp_decoder, "decoder_new()");
+
+	dev = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_process));
+	if (!dev)
+		return NULL;
+	dev->drv = drv;
+	dev->size = COMP_SIZE(struct sof_ipc_comp_process);
+
+	decoder = COMP_GET_IPC(dev, sof_ipc_comp_process);
+	ret = memcpy_s(decoder, sizeof(*decoder), ipc_decoder,
+		       sizeof(struct sof_ipc_comp_process));
+	assert(!ret);
+
+	cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	ret = decoder_apply_config(dev,
+				   (struct sof_decoder_config *)ipc_decoder->data,
+				   ipc_decoder->size);
+	if (ret < 0) {
+		rfree(cd);
+		rfree(dev);
+		return NULL;
+	}
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+/* drops everything prepare() set up */
+static void decoder_release(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct decoder_codec_ops *ops;
+
+	if (cd->task_ready) {
+		schedule_task_cancel(&cd->task);
+		schedule_task_free(&cd->task);
+		cd->task_ready = false;
+	}
+
+	if (cd->codec_ready) {
+		ops = cd->ctx.codec->ops;
+		if (ops->free)
+			ops->free(&cd->ctx);
+		cd->codec_ready = false;
+	}
+
+	rfree(cd->stage);
+	rfree(cd->result.addr);
+	rfree(cd->out.addr);
+	cd->stage = NULL;
+	cd->result.addr = NULL;
+	cd->out.addr = NULL;
+	cd->busy = false;
+	cd->ret = 0;
+}
+
+static void decoder_free(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "decoder_free()");
+
+	decoder_release(dev);
+	rfree(cd);
+	rfree(dev);
+}
+
+static int decoder_params(struct comp_dev *dev,
+			  struct sof_ipc_stream_params *params)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+	int ret;
+
+	comp_info(dev, "decoder_params()");
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	if (sourceb->buffer_fmt != SOF_IPC_BUFFER_COMPRESSED) {
+		comp_err(dev, "decoder_params(): source isn't compressed");
+		return -EINVAL;
+	}
+
+	/* sink gets the decoded PCM */
+	params->buffer_fmt = SOF_IPC_BUFFER_INTERLEAVED;
+	params->frame_fmt = cd->config.frame_fmt;
+	params->rate = cd->config.rate;
+	params->channels = cd->config.channels;
+	params->sample_container_bytes =
+		cd->config.frame_fmt == SOF_IPC_FRAME_S16_LE ? 2 : 4;
+	params->sample_valid_bytes =
+		cd->config.frame_fmt == SOF_IPC_FRAME_S24_4LE ? 3 :
+		params->sample_container_bytes;
+
+	ret = comp_verify_params(dev, 0, params);
+	if (ret < 0)
+		comp_err(dev, "decoder_params(): comp_verify_params() failed");
+
+	return ret;
+}
+
+static int decoder_stream_init(struct audio_stream *stream,
+			       const struct audio_stream *fmt,
+			       uint32_t frames)
+{
+	uint32_t size;
+	void *addr;
+
+	stream->frame_fmt = fmt->frame_fmt;
+	stream->channels = fmt->channels;
+	stream->rate = fmt->rate;
+
+	size = audio_stream_period_bytes(stream, frames);
+	addr = rballoc(0, SOF_MEM_CAPS_RAM, size);
+	if (!addr)
+		return -ENOMEM;
+
+	audio_stream_init(stream, addr, size);
+
+	return 0;
+}
+
+static int decoder_prepare(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct decoder_codec *codec;
+	struct comp_buffer *sinkb;
+	uint32_t frames;
+	int ret;
+
+	comp_info(dev, "decoder_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	if (ret == COMP_STATUS_STATE_ALREADY_SET)
+		return PPL_STATUS_PATH_STOP;
+
+	decoder_release(dev);
+
+	codec = decoder_codec_get(cd->config.codec);
+	if (!codec) {
+		comp_err(dev, "decoder_prepare(): no codec %u",
+			 cd->config.codec);
+		ret = -ENOENT;
+		goto err;
+	}
+
+	cd->ctx.codec = codec;
+	cd->ctx.config = &cd->config;
+	cd->ctx.priv = NULL;
+
+	if (codec->ops->init) {
+		ret = codec->ops->init(&cd->ctx);
+		if (ret < 0)
+			goto err;
+	}
+	cd->codec_ready = true;
+
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	/* a block takes at least a codec frame and a period */
+	frames = (cd->config.block_ms ? cd->config.block_ms :
+		  DECODER_BLOCK_MS) * sinkb->stream.rate / 1000;
+	frames = MAX(frames, MAX(codec->frames_max, dev->frames));
+	cd->block_frames = frames;
+
+	/* a block is due by the period before the next one is needed */
+	cd->deadline_ticks = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) *
+		(frames - dev->frames) * 1000 / sinkb->stream.rate;
+
+	cd->stage_size = DECODER_STAGE_FRAMES * codec->frame_bytes_max;
+	cd->stage_bytes = 0;
+	cd->stage = rballoc(0, SOF_MEM_CAPS_RAM, cd->stage_size);
+	if (!cd->stage) {
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	ret = decoder_stream_init(&cd->result, &sinkb->stream, frames);
+	if (ret < 0)
+		goto err;
+
+	/* two blocks of silence cover the first decoding, peak is reached
+	 * when a result comes in early and a period more is left for the
+	 * last one to be taken
+	 */
+	ret = decoder_stream_init(&cd->out, &sinkb->stream,
+				  3 * frames + dev->frames);
+	if (ret < 0)
+		goto err;
+
+	audio_stream_set_zero(&cd->out,
+			      audio_stream_period_bytes(&cd->out, 2 * frames));
+	audio_stream_produce(&cd->out,
+			     audio_stream_period_bytes(&cd->out, 2 * frames));
+
+	ret = schedule_task_init_edf(&cd->task, SOF_UUID(decoder_task_uuid),
+				     &decoder_task_ops, cd, dev->comp.core,
+				     SOF_EDF_TASK_INLINE);
+	if (ret < 0)
+		goto err;
+	cd->task_ready = true;
+
+	return 0;
+
+err:
+	comp_err(dev, "decoder_prepare(): failed %d", ret);
+	decoder_release(dev);
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int decoder_trigger(struct comp_dev *dev, int cmd)
+{
+	comp_info(dev, "decoder_trigger(), command = %u", cmd);
+
+	return comp_set_state(dev, cmd);
+}
+
+/* moves PCM from a block stream to the sink or between block streams */
+static void decoder_move(struct audio_stream *from, struct audio_stream *to,
+			 struct comp_buffer *to_buf, uint32_t bytes)
+{
+	if (!bytes)
+		return;
+
+	audio_stream_copy(from, 0, to, 0, bytes);
+	audio_stream_consume(from, bytes);
+
+	if (to_buf) {
+		buffer_writeback(to_buf, bytes);
+		comp_update_buffer_produce(to_buf, bytes);
+	} else {
+		audio_stream_produce(to, bytes);
+	}
+}
+
+static int decoder_copy(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	struct audio_stream *source;
+	uint32_t avail;
+	uint32_t room;
+	uint32_t bytes;
+	uint32_t flags = 0;
+
+	comp_dbg(dev, "decoder_copy()");
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+	source = &sourceb->stream;
+
+	/* take result of the task once it's done */
+	if (!cd->busy && cd->result.avail) {
+		decoder_move(&cd->result, &cd->out, NULL, cd->result.avail);
+		audio_stream_reset(&cd->result);
+	}
+
+	buffer_lock(sourceb, &flags);
+	buffer_lock(sinkb, &flags);
+
+	avail = source->avail;
+	room = sinkb->stream.free;
+
+	buffer_unlock(sinkb, flags);
+	buffer_unlock(sourceb, flags);
+
+	room -= room % audio_stream_frame_bytes(&sinkb->stream);
+	decoder_move(&cd->out, &sinkb->stream, sinkb,
+		     MIN(cd->out.avail, room));
+
+	if (cd->busy)
+		return 0;
+
+	/* stage compressed data, it's a byte stream regardless of words */
+	bytes = MIN(avail, cd->stage_size - cd->stage_bytes);
+	if (bytes) {
+		buffer_invalidate(sourceb, bytes);
+		cir_buf_copy(source->r_ptr, source->addr, source->end_addr,
+			     cd->stage + cd->stage_bytes, cd->stage,
+			     cd->stage + cd->stage_size, bytes);
+		comp_update_buffer_consume(sourceb, bytes);
+		cd->stage_bytes += bytes;
+	}
+
+	/* decode once a whole block fits out */
+	if (cd->stage_bytes &&
+	    cd->out.free >= audio_stream_period_bytes(&cd->out,
+						      cd->block_frames)) {
+		cd->deadline = platform_timer_get(timer_get()) +
+			cd->deadline_ticks;
+		cd->busy = true;
+		schedule_task(&cd->task, 0, 0);
+	}
+
+	return cd->ret;
+}
+
+static int decoder_reset(struct comp_dev *dev)
+{
+	comp_info(dev, "decoder_reset()");
+
+	decoder_release(dev);
+
+	return comp_set_state(dev, COMP_TRIGGER_RESET);
+}
+
+static const struct comp_driver comp_decoder = {
+	.type	= SOF_COMP_DECODER,
+	.uid	= SOF_UUID(decoder_uuid),
+	.ops	= {
+		.create		= decoder_new,
+		.free		= decoder_free,
+		.params		= decoder_params,
+		.trigger	= decoder_trigger,
+		.copy		= decoder_copy,
+		.prepare	= decoder_prepare,
+		.reset		= decoder_reset,
+	},
+};
+
+static SHARED_DATA struct comp_driver_info comp_decoder_info = {
+	.drv = &comp_decoder,
+};
+
+static void sys_comp_decoder_init(void)
+{
+	comp_register(platform_shared_get(&comp_decoder_info,
+					  sizeof(comp_decoder_info)));
+}
+
+DECLARE_MODULE(sys_comp_decoder_init);
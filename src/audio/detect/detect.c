@@ -0,0 +1,461 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/detect/detect.c
+ * \brief Detector component running several models on shared features
+ *
+ * Features of the KPB output are computed once per analysis frame and
+ * given to every configured model. Each model notifies the host and
+ * requests draining of its own KPB client when it detects.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/audio/kpb.h>
+#include <sof/audio/pipeline.h>
+#include <sof/audio/detect/detect.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/drivers/ipc.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/notifier.h>
+#include <sof/lib/uuid.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/string.h>
+#include <sof/trace/trace.h>
+#include <ipc/control.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <user/detect.h>
+#include <user/trace.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static const struct comp_driver comp_detect;
+
+/* df76919e-2d08-4a98-9bdb-b42700099136 */
+DECLARE_SOF_UUID("detect", detect_uuid, 0xdf76919e, 0x2d08, 0x4a98,
+		 0x9b, 0xdb, 0xb4, 0x27, 0x00, 0x09, 0x91, 0x36);
+
+static void detect_notify_kpb(const struct comp_dev *dev,
+			      struct detect_model *model,
+			      enum kpb_event event_id)
+{
+	if (model->config.kpb_client == SOF_DETECT_NO_KPB_CLIENT)
+		return;
+
+	model->client.r_ptr = NULL;
+	model->client.sink = NULL;
+	model->client.id = model->config.kpb_client;
+	model->client.history_depth = model->config.history_depth;
+	model->event_data.event_id = event_id;
+	model->event_data.client_data = &model->client;
+
+	notifier_event(dev, NOTIFIER_ID_KPB_CLIENT_EVT,
+		       NOTIFIER_TARGET_CORE_ALL_MASK, &model->event_data,
+		       sizeof(model->event_data));
+}
+
+static void detect_notify(const struct comp_dev *dev, uint32_t index)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct detect_model *model = &cd->model[index];
+
+	comp_info(dev, "detect_notify(), model %u frame %u", index,
+		  cd->fs->features.frame);
+
+	/* host learns which model detected from the event value */
+	cd->event.event_type = model->config.type == SOF_DETECT_MODEL_VAD ?
+			       SOF_CTRL_EVENT_VAD : SOF_CTRL_EVENT_KD;
+	cd->event.event_value = index;
+	ipc_msg_send(model->msg, &cd->event, true);
+
+	detect_notify_kpb(dev, model, KPB_EVENT_BEGIN_DRAINING);
+}
+
+/* computes features once and runs all models still waiting on them */
+static void detect_frame(const struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct detect_model *model;
+	uint32_t i;
+
+	detect_feature_compute(cd->fs);
+
+	for (i = 0; i < cd->num_models; i++) {
+		model = &cd->model[i];
+		if (model->detected)
+			continue;
+
+		if (model->ops->process(model, &cd->fs->features)) {
+			model->detected = true;
+			detect_notify(dev, i);
+		}
+	}
+}
+
+static void detect_process(const struct comp_dev *dev,
+			   const struct audio_stream *source,
+			   uint32_t samples)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	void *ptr = source->r_ptr;
+	int16_t *x16;
+	int32_t *x32;
+	int shift;
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		if (source->frame_fmt == SOF_IPC_FRAME_S16_LE) {
+			x16 = ptr;
+			n = audio_stream_samples_without_wrap_s16(source, x16);
+			n = MIN(n, samples);
+			for (i = 0; i < n; i++) {
+				if (detect_feature_add(cd->fs,
+						       (int32_t)x16[i] << 16))
+					detect_frame(dev);
+			}
+			ptr = x16 + n;
+		} else {
+			/* 24 bit samples are sign extended by the shift */
+			shift = source->frame_fmt == SOF_IPC_FRAME_S24_4LE ?
+				8 : 0;
+			x32 = ptr;
+			n = audio_stream_samples_without_wrap_s32(source, x32);
+			n = MIN(n, samples);
+			for (i = 0; i < n; i++) {
+				if (detect_feature_add(cd->fs, x32[i] << shift))
+					detect_frame(dev);
+			}
+			ptr = x32 + n;
+		}
+
+		ptr = audio_stream_wrap(source, ptr);
+		samples -= n;
+	}
+}
+
+static void detect_reset_models(struct comp_data *cd)
+{
+	uint32_t i;
+
+	if (cd->fs)
+		detect_feature_reset(cd->fs);
+
+	for (i = 0; i < cd->num_models; i++)
+		cd->model[i].ops->reset(&cd->model[i]);
+}
+
+static int detect_apply_config(struct comp_dev *dev,
+			       const struct sof_detect_config *cfg,
+			       uint32_t size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct sof_detect_model_config *mcfg;
+	struct detect_model *model;
+	uint32_t i;
+
+	if (size < sizeof(*cfg) || cfg->size > size ||
+	    cfg->num_models > SOF_DETECT_MAX_MODELS ||
+	    cfg->size < sizeof(*cfg) + cfg->num_models * sizeof(*mcfg)) {
+		comp_err(dev, "detect_apply_config(): invalid config size %u",
+			 size);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < cfg->num_models; i++) {
+		mcfg = &cfg->model[i];
+		model = &cd->model[i];
+
+		model->ops = detect_get_model(mcfg->type);
+		if (!model->ops) {
+			comp_err(dev, "detect_apply_config(): unknown model type %u",
+				 mcfg->type);
+			return -EINVAL;
+		}
+
+		if (mcfg->kpb_client != SOF_DETECT_NO_KPB_CLIENT &&
+		    mcfg->kpb_client >= KPB_MAX_NO_OF_CLIENTS) {
+			comp_err(dev, "detect_apply_config(): invalid KPB client %u",
+				 mcfg->kpb_client);
+			return -EINVAL;
+		}
+
+		model->config = *mcfg;
+	}
+
+	cd->num_models = cfg->num_models;
+
+	return 0;
+}
+
+static void detect_free_data(struct comp_data *cd)
+{
+	uint32_t i;
+
+	for (i = 0; i < SOF_DETECT_MAX_MODELS; i++)
+		ipc_msg_free(cd->model[i].msg);
+
+	rfree(cd->fs);
+	rfree(cd);
+}
+
+static struct comp_dev *detect_new(const struct comp_driver *drv,
+				   struct sof_ipc_comp *comp)
+{
+	struct sof_ipc_comp_process *ipc_detect =
+		(struct sof_ipc_comp_process *)comp;
+	struct sof_ipc_comp_process *detect;
+	struct comp_dev *dev;
+	struct comp_data *cd;
+	uint32_t i;
+	int ret;
+
+	comp_cl_info(&comp_detect, "detect_new()");
+
+	dev = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_process));
+	if (!dev)
+		return NULL;
+	dev->drv = drv;
+	dev->size = COMP_SIZE(struct sof_ipc_comp_process);
+
+	detect = COMP_GET_IPC(dev, sof_ipc_comp_process);
+	ret = memcpy_s(detect, sizeof(*detect), ipc_detect,
+		       sizeof(struct sof_ipc_comp_process));
+	assert(!ret);
+
+	cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	ret = detect_apply_config(dev,
+				  (struct sof_detect_config *)ipc_detect->data,
+				  ipc_detect->size);
+	if (ret < 0)
+		goto fail;
+
+	/* build component event */
+	ipc_build_comp_event(&cd->event, comp->type, comp->id);
+	cd->event.num_elems = 0;
+
+	/* models may detect in the same frame, each needs own message */
+	for (i = 0; i < cd->num_models; i++) {
+		cd->model[i].msg = ipc_msg_init(cd->event.rhdr.hdr.cmd,
+						sizeof(cd->event));
+		if (!cd->model[i].msg) {
+			comp_err(dev, "detect_new(): ipc notification init failed");
+			goto fail;
+		}
+	}
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+
+fail:
+	detect_free_data(cd);
+	rfree(dev);
+	return NULL;
+}
+
+static void detect_free(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "detect_free()");
+
+	detect_free_data(cd);
+	rfree(dev);
+}
+
+static int detect_params(struct comp_dev *dev,
+			 struct sof_ipc_stream_params *params)
+{
+	struct comp_buffer *sourceb;
+	int ret;
+
+	comp_info(dev, "detect_params()");
+
+	/* detectors take one channel selected from KPB output */
+	params->channels = 1;
+
+	ret = comp_verify_params(dev, 0, params);
+	if (ret < 0) {
+		comp_err(dev, "detect_params(): comp_verify_params() failed");
+		return ret;
+	}
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	if (sourceb->stream.channels != 1) {
+		comp_err(dev, "detect_params(): only single-channel supported");
+		return -EINVAL;
+	}
+
+	/* mel bands are laid out for the KPB rate */
+	if (sourceb->stream.rate != KPB_SAMPLNG_FREQUENCY) {
+		comp_err(dev, "detect_params(): unsupported rate %u",
+			 sourceb->stream.rate);
+		return -EINVAL;
+	}
+
+	switch (sourceb->stream.frame_fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+#endif
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+#endif
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+#endif
+		return 0;
+	default:
+		comp_err(dev, "detect_params(): unsupported format %u",
+			 sourceb->stream.frame_fmt);
+		return -EINVAL;
+	}
+}
+
+static int detect_trigger(struct comp_dev *dev, int cmd)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t i;
+	int ret;
+
+	comp_info(dev, "detect_trigger(), command = %u", cmd);
+
+	ret = comp_set_state(dev, cmd);
+	if (ret)
+		return ret;
+
+	switch (cmd) {
+	case COMP_TRIGGER_START:
+		/* KPB forgets its clients when prepared */
+		for (i = 0; i < cd->num_models; i++)
+			detect_notify_kpb(dev, &cd->model[i],
+					  KPB_EVENT_REGISTER_CLIENT);
+		/* fallthrough */
+	case COMP_TRIGGER_RELEASE:
+		detect_reset_models(cd);
+		break;
+	case COMP_TRIGGER_STOP:
+		for (i = 0; i < cd->num_models; i++)
+			detect_notify_kpb(dev, &cd->model[i],
+					  KPB_EVENT_UNREGISTER_CLIENT);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static int detect_copy(struct comp_dev *dev)
+{
+	struct comp_buffer *source;
+	uint32_t frames;
+	uint32_t bytes;
+	uint32_t flags = 0;
+
+	comp_dbg(dev, "detect_copy()");
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+
+	buffer_lock(source, &flags);
+	frames = source->stream.avail /
+		audio_stream_frame_bytes(&source->stream);
+	buffer_unlock(source, flags);
+
+	bytes = frames * audio_stream_frame_bytes(&source->stream);
+	buffer_invalidate(source, bytes);
+	detect_process(dev, &source->stream, frames);
+	comp_update_buffer_consume(source, bytes);
+
+	return 0;
+}
+
+static int detect_prepare(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int ret;
+
+	comp_info(dev, "detect_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	if (ret == COMP_STATUS_STATE_ALREADY_SET)
+		return PPL_STATUS_PATH_STOP;
+
+	/* feature front end is needed only while the stream is open */
+	if (!cd->fs) {
+		cd->fs = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				 sizeof(*cd->fs));
+		if (!cd->fs) {
+			comp_err(dev, "detect_prepare(): feature state alloc failed");
+			comp_set_state(dev, COMP_TRIGGER_RESET);
+			return -ENOMEM;
+		}
+
+		detect_feature_init(cd->fs);
+	}
+
+	return 0;
+}
+
+static int detect_reset(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "detect_reset()");
+
+	/* built again by next prepare() */
+	rfree(cd->fs);
+	cd->fs = NULL;
+
+	detect_reset_models(cd);
+
+	return comp_set_state(dev, COMP_TRIGGER_RESET);
+}
+
+static const struct comp_driver comp_detect = {
+	.type	= SOF_COMP_DETECT,
+	.uid	= SOF_UUID(detect_uuid),
+	.ops	= {
+		.create		= detect_new,
+		.free		= detect_free,
+		.params		= detect_params,
+		.trigger	= detect_trigger,
+		.copy		= detect_copy,
+		.prepare	= detect_prepare,
+		.reset		= detect_reset,
+	},
+};
+
+static SHARED_DATA struct comp_driver_info comp_detect_info = {
+	.drv = &comp_detect,
+};
+
+static void sys_comp_detect_init(void)
+{
+	comp_register(platform_shared_get(&comp_detect_info,
+					  sizeof(comp_detect_info)));
+}
+
+DECLARE_MODULE(sys_comp_detect_init);
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/detect/detect_feature.c
+ * \brief Feature front-end shared by detector models
+ *
+ * Every DETECT_HOP_SIZE samples the last DETECT_FFT_SIZE samples are
+ * windowed, transformed with a fixed point FFT and reduced to log2
+ * energies of mel spaced triangular bands and of the whole frame.
+ */
+
+#include <sof/audio/detect/detect.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <sof/math/trig.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DETECT_FFT_BITS		8
+
+/* edges of mel spaced bands in FFT bins of 62.5 Hz, band b rises from
+ * edge b to b + 1 and falls to b + 2
+ */
+static const uint8_t detect_mel_edges[DETECT_MEL_BANDS + 2] = {
+	0, 2, 4, 6, 9, 12, 16, 20, 25, 31, 38, 46, 55, 66, 78, 92, 109, 128,
+};
+
+/* log2(1 + f) - f for f in 0 .. 1 is close to f * (1 - f) * 0.3466 */
+#define DETECT_LOG2_CORR	Q_CONVERT_FLOAT(0.3466, 31)
+
+int32_t detect_log2(uint64_t x)
+{
+	uint32_t frac;
+	int32_t corr;
+	int e = 63;
+
+	if (!x)
+		return DETECT_LOG2_ZERO;
+
+	/* normalize so bit 63 is set */
+	if (!(x >> 32)) {
+		x <<= 32;
+		e -= 32;
+	}
+	if (!(x >> 48)) {
+		x <<= 16;
+		e -= 16;
+	}
+	if (!(x >> 56)) {
+		x <<= 8;
+		e -= 8;
+	}
+	if (!(x >> 60)) {
+		x <<= 4;
+		e -= 4;
+	}
+	if (!(x >> 62)) {
+		x <<= 2;
+		e -= 2;
+	}
+	if (!(x >> 63)) {
+		x <<= 1;
+		e -= 1;
+	}
+
+	/* fraction of mantissa in Q0.32 */
+	frac = (uint32_t)(x >> 31);
+	corr = Q_SHIFT_RND((int64_t)frac * (uint32_t)-frac, 64, 31);
+	corr = Q_MULTSR_32X32((int64_t)corr, DETECT_LOG2_CORR, 31, 31, 31);
+
+	return (e << 24) + (int32_t)(frac >> 8) + (corr >> 7);
+}
+
+/* sine of phase k / DETECT_FFT_SIZE of full turn, Q1.31 */
+static int32_t detect_sin_turn(int k)
+{
+	k &= DETECT_FFT_SIZE - 1;
+
+	return sin_fixed((int32_t)((int64_t)PI_MUL2_Q4_28 * k /
+				   DETECT_FFT_SIZE));
+}
+
+void detect_feature_init(struct detect_feature_state *fs)
+{
+	const int quarter = DETECT_FFT_SIZE / 4;
+	int32_t cosine;
+	int lo;
+	int hi;
+	int b;
+	int k;
+
+	/* Hann window 0.5 - 0.5 * cos() */
+	for (k = 0; k < DETECT_FFT_SIZE; k++) {
+		cosine = detect_sin_turn(k + quarter);
+		fs->window[k] = sat_int16(((1 << 30) - (cosine >> 1)) >> 16);
+	}
+
+	/* exp(-j * 2 * pi * k / N) */
+	for (k = 0; k < DETECT_FFT_SIZE / 2; k++) {
+		fs->twiddle[k].re = detect_sin_turn(k + quarter);
+		fs->twiddle[k].im = -detect_sin_turn(k);
+	}
+
+	/* bin k rises in band b and falls in band b - 1 */
+	for (b = 0; b <= DETECT_MEL_BANDS; b++) {
+		lo = detect_mel_edges[b];
+		hi = detect_mel_edges[b + 1];
+		for (k = lo + 1; k <= hi; k++) {
+			fs->bin_band[k] = b;
+			fs->bin_weight[k] = sat_int16(((k - lo) << 15) /
+						      (hi - lo));
+		}
+	}
+
+	/* DC falls in no band */
+	fs->bin_band[0] = 0;
+	fs->bin_weight[0] = 0;
+
+	detect_feature_reset(fs);
+}
+
+void detect_feature_reset(struct detect_feature_state *fs)
+{
+	memset(fs->samples, 0, sizeof(fs->samples));
+	memset(&fs->features, 0, sizeof(fs->features));
+	fs->fill = 0;
+}
+
+/* radix-2 decimation in time FFT, scaled by 1 / N to not overflow */
+static void detect_fft(struct detect_feature_state *fs)
+{
+	struct detect_complex *x = fs->fft;
+	struct detect_complex *w;
+	struct detect_complex t;
+	struct detect_complex *a;
+	struct detect_complex *b;
+	int half;
+	int step;
+	int i;
+	int j;
+
+	for (half = 1, step = DETECT_FFT_SIZE / 2; half < DETECT_FFT_SIZE;
+	     half <<= 1, step >>= 1) {
+		for (i = 0; i < DETECT_FFT_SIZE; i += half << 1) {
+			for (j = 0; j < half; j++) {
+				a = &x[i + j];
+				b = &x[i + j + half];
+				w = &fs->twiddle[j * step];
+
+				t.re = (int32_t)(((int64_t)b->re * w->re -
+						  (int64_t)b->im * w->im) >> 31);
+				t.im = (int32_t)(((int64_t)b->re * w->im +
+						  (int64_t)b->im * w->re) >> 31);
+
+				b->re = (int32_t)(((int64_t)a->re - t.re) >> 1);
+				b->im = (int32_t)(((int64_t)a->im - t.im) >> 1);
+				a->re = (int32_t)(((int64_t)a->re + t.re) >> 1);
+				a->im = (int32_t)(((int64_t)a->im + t.im) >> 1);
+			}
+		}
+	}
+}
+
+static int detect_bit_reverse(int k)
+{
+	int r = 0;
+	int i;
+
+	for (i = 0; i < DETECT_FFT_BITS; i++) {
+		r = (r << 1) | (k & 1);
+		k >>= 1;
+	}
+
+	return r;
+}
+
+void detect_feature_compute(struct detect_feature_state *fs)
+{
+	struct detect_features *f = &fs->features;
+	uint64_t band[DETECT_MEL_BANDS] = { 0 };
+	uint64_t total = 0;
+	uint64_t power;
+	int b;
+	int k;
+	int r;
+
+	/* windowed input in bit reversed order */
+	for (k = 0; k < DETECT_FFT_SIZE; k++) {
+		r = detect_bit_reverse(k);
+		fs->fft[r].re = Q_MULTSR_32X32((int64_t)fs->samples[k],
+					       fs->window[k], 31, 15, 31);
+		fs->fft[r].im = 0;
+	}
+
+	detect_fft(fs);
+
+	for (k = 1; k < DETECT_BINS; k++) {
+		power = ((uint64_t)((int64_t)fs->fft[k].re * fs->fft[k].re) +
+			 (uint64_t)((int64_t)fs->fft[k].im * fs->fft[k].im)) >>
+			DETECT_FFT_BITS;
+		total += power;
+
+		/* split power between rising and falling band of bin */
+		b = fs->bin_band[k];
+		power >>= 15;
+		if (b < DETECT_MEL_BANDS)
+			band[b] += power * fs->bin_weight[k];
+		if (b > 0)
+			band[b - 1] += power * (32768 - fs->bin_weight[k]);
+	}
+
+	for (b = 0; b < DETECT_MEL_BANDS; b++)
+		f->band[b] = detect_log2(band[b]);
+
+	f->energy = detect_log2(total);
+	f->frame++;
+
+	/* slide window by one hop */
+	memmove(fs->samples, fs->samples + DETECT_HOP_SIZE,
+		(DETECT_FFT_SIZE - DETECT_HOP_SIZE) * sizeof(int32_t));
+	fs->fill = 0;
+}
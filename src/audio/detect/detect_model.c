@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/detect/detect_model.c
+ * \brief Detector models fed with shared features
+ */
+
+#include <sof/audio/detect/detect.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+#include <user/detect.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* default activation right shift of energy model */
+#define DETECT_ENERGY_SHIFT	3
+
+/* noise floor rises by 1 / 2^shift of the difference per frame */
+#define DETECT_VAD_FLOOR_SHIFT	7
+
+static void detect_energy_reset(struct detect_model *model)
+{
+	model->level = DETECT_LOG2_ZERO;
+	model->count = 0;
+	model->detected = false;
+}
+
+/* Smoothed frame energy crossing threshold after preamble frames, the
+ * same activation as the test keyword detector computed per frame.
+ */
+static bool detect_energy_process(struct detect_model *model,
+				  const struct detect_features *features)
+{
+	uint32_t shift = model->config.shift ? model->config.shift :
+			 DETECT_ENERGY_SHIFT;
+
+	model->level += (features->energy - model->level) >> shift;
+
+	if (model->count < model->config.frames) {
+		model->count++;
+		return false;
+	}
+
+	return model->level >= model->config.threshold;
+}
+
+static void detect_vad_reset(struct detect_model *model)
+{
+	model->level = INT32_MAX;
+	model->count = 0;
+	model->detected = false;
+}
+
+/* Frame energy above slowly rising noise floor for given number of
+ * consecutive frames.
+ */
+static bool detect_vad_process(struct detect_model *model,
+			       const struct detect_features *features)
+{
+	int32_t energy = features->energy;
+
+	/* floor follows minimum at once and rises slowly */
+	if (energy < model->level)
+		model->level = energy;
+	else
+		model->level += (energy - model->level) >>
+				DETECT_VAD_FLOOR_SHIFT;
+
+	if (energy - model->level < model->config.threshold) {
+		model->count = 0;
+		return false;
+	}
+
+	return ++model->count >= MAX(model->config.frames, 1);
+}
+
+static const struct detect_model_ops detect_energy = {
+	.type = SOF_DETECT_MODEL_ENERGY,
+	.reset = detect_energy_reset,
+	.process = detect_energy_process,
+};
+
+static const struct detect_model_ops detect_vad = {
+	.type = SOF_DETECT_MODEL_VAD,
+	.reset = detect_vad_reset,
+	.process = detect_vad_process,
+};
+
+const struct detect_model_ops *const detect_model_map[] = {
+	&detect_energy,
+	&detect_vad,
+};
+
+const size_t detect_model_count = ARRAY_SIZE(detect_model_map);
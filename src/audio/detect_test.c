@@ -14,6 +14,7 @@
 #include <sof/lib/alloc.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/notifier.h>
+#include <sof/lib/overlay.h>
 #include <sof/lib/wait.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
@@ -48,6 +49,12 @@
 /* default number of samples before detection is activated  */
 #define KEYPHRASE_DEFAULT_PREAMBLE_LENGTH 0
 
+/* voice activity gate keeps detection running this long after the input
+ * level drops below the threshold and only looks at every n-th sample
+ */
+#define VAD_HANGOVER_MS 300
+#define VAD_DECIMATION 4
+
 static const struct comp_driver comp_keyword;
 
 /* eba8d51f-7827-47b5-82ee-de6e7743af67 */
@@ -69,6 +76,8 @@ struct comp_data {
 	uint32_t detect_preamble; /**< current keyphrase preamble length */
 	uint32_t keyphrase_samples; /**< keyphrase length in samples */
 	uint32_t history_depth; /** defines draining size in bytes. */
+	uint32_t vad_hangover; /**< hangover length in samples */
+	uint32_t vad_remaining; /**< samples till detection is gated */
 
 	uint16_t sample_valid_bytes;
 	struct kpb_event_data event_data;
@@ -108,7 +117,7 @@ static inline bool detector_is_sample_width_supported(enum sof_ipc_frame sf)
 	return ret;
 }
 
-static void notify_host(const struct comp_dev *dev)
+static void __overlay_text(kwd) notify_host(const struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 
@@ -117,7 +126,7 @@ static void notify_host(const struct comp_dev *dev)
 	ipc_msg_send(cd->msg, &cd->event, true);
 }
 
-static void notify_kpb(const struct comp_dev *dev)
+static void __overlay_text(kwd) notify_kpb(const struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 
@@ -138,15 +147,15 @@ static void notify_kpb(const struct comp_dev *dev)
 		       sizeof(cd->event_data));
 }
 
-static void detect_test_notify(const struct comp_dev *dev)
+static void __overlay_text(kwd) detect_test_notify(const struct comp_dev *dev)
 {
 	notify_host(dev);
 	notify_kpb(dev);
 }
 
-static void default_detect_test(struct comp_dev *dev,
-				const struct audio_stream *source,
-				uint32_t frames)
+static void __overlay_text(kwd)
+default_detect_test(struct comp_dev *dev, const struct audio_stream *source,
+		    uint32_t frames)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	void *src;
@@ -197,6 +206,57 @@ static void default_detect_test(struct comp_dev *dev,
 	}
 }
 
+/* Cheap voice activity check on the mean level of decimated samples,
+ * returns true when detection has to run on the current period.
+ */
+static bool __overlay_text(kwd)
+test_keyword_vad(struct comp_dev *dev, const struct audio_stream *source,
+		 uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint16_t valid_bits = cd->sample_valid_bytes * 8;
+	uint64_t level = 0;
+	uint32_t count = 0;
+	uint32_t sample;
+	void *src;
+
+	if (!cd->config.vad_threshold || !frames)
+		return true;
+
+	for (sample = 0; sample < frames; sample += VAD_DECIMATION) {
+		src = (valid_bits == 16U) ?
+		      audio_stream_read_frag_s16(source, sample) :
+		      audio_stream_read_frag_s32(source, sample);
+		level += (valid_bits == 16U) ? abs(*(int16_t *)src) :
+			 abs(*(int32_t *)src);
+		count++;
+	}
+
+	if (level >= (uint64_t)cd->config.vad_threshold * count) {
+		if (!cd->vad_remaining)
+			comp_dbg(dev, "test_keyword_vad(), speech start");
+		cd->vad_remaining = cd->vad_hangover;
+		return true;
+	}
+
+	if (cd->vad_remaining > frames) {
+		cd->vad_remaining -= frames;
+		return true;
+	}
+
+	if (cd->vad_remaining) {
+		comp_dbg(dev, "test_keyword_vad(), speech end");
+		cd->vad_remaining = 0;
+	}
+
+	/* silence decays activation anyway, keep preamble in time */
+	cd->activation = 0;
+	cd->detect_preamble = MIN(cd->detect_preamble + frames,
+				  cd->keyphrase_samples);
+
+	return false;
+}
+
 static void free_mem_load(struct comp_data *cd)
 {
 	if (!cd) {
@@ -435,6 +495,8 @@ static int test_keyword_params(struct comp_dev *dev,
 		cd->keyphrase_samples = KEYPHRASE_DEFAULT_PREAMBLE_LENGTH;
 	}
 
+	cd->vad_hangover = VAD_HANGOVER_MS * (sourceb->stream.rate / 1000);
+
 	return 0;
 }
 
@@ -719,13 +781,14 @@ static int test_keyword_trigger(struct comp_dev *dev, int cmd)
 		cd->detect_preamble = 0;
 		cd->detected = 0;
 		cd->activation = 0;
+		cd->vad_remaining = cd->vad_hangover;
 	}
 
 	return 0;
 }
 
 /*  process stream data from source buffer */
-static int test_keyword_copy(struct comp_dev *dev)
+static int __overlay_text(kwd) test_keyword_copy(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *source;
@@ -743,9 +806,12 @@ static int test_keyword_copy(struct comp_dev *dev)
 		audio_stream_frame_bytes(&source->stream);
 	buffer_unlock(source, flags);
 
-	/* copy and perform detection */
+	/* copy and perform detection, skipped during silence while KPB
+	 * keeps buffering the history
+	 */
 	buffer_invalidate(source, source->stream.avail);
-	cd->detect_func(dev, &source->stream, frames);
+	if (test_keyword_vad(dev, &source->stream, frames))
+		cd->detect_func(dev, &source->stream, frames);
 
 	/* calc new available */
 	comp_update_buffer_consume(source, source->stream.avail);
@@ -762,6 +828,7 @@ static int test_keyword_reset(struct comp_dev *dev)
 	cd->activation = 0;
 	cd->detect_preamble = 0;
 	cd->detected = 0;
+	cd->vad_remaining = 0;
 
 	return comp_set_state(dev, COMP_TRIGGER_RESET);
 }
@@ -788,6 +855,7 @@ static int test_keyword_prepare(struct comp_dev *dev)
 static const struct comp_driver comp_keyword = {
 	.type	= SOF_COMP_KEYWORD_DETECT,
 	.uid	= SOF_UUID(keyword_uuid),
+	.overlay = OVERLAY(kwd),
 	.ops	= {
 		.create		= test_keyword_new,
 		.free		= test_keyword_free,
@@ -8,6 +8,7 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/component.h>
+#include <sof/audio/eq_fir/eq_fir_fft.h>
 #include <sof/audio/eq_fir/fir_config.h>
 #include <sof/audio/pipeline.h>
 #include <sof/common.h>
@@ -58,6 +59,20 @@ struct comp_data {
 	int32_t *fir_delay;			/**< pointer to allocated RAM */
 	size_t fir_delay_size;			/**< allocated size */
 	bool config_ready;			/**< set when fully received */
+	/** shadow filters of config_new, swapped in by copy */
+	struct fir_state_32x16 fir_new[PLATFORM_MAX_CHANNELS];
+	int32_t *fir_delay_new;			/**< shadow delay lines */
+	size_t fir_delay_size_new;		/**< shadow delay lines size */
+	bool swap_ready;			/**< shadow filters are set up */
+	struct sof_eq_fir_config *config_old;	/**< swapped out setup */
+	int32_t *fir_delay_old;			/**< swapped out delay lines */
+	struct eq_fir_fft *fft;			/**< long responses filters */
+	struct eq_fir_fft *fft_new;		/**< shadow long filters */
+	struct eq_fir_fft *fft_old;		/**< swapped out long filters */
+	bool pass;				/**< pass-through in use */
+	uint32_t silence_frames;		/**< silent input frames */
+	uint32_t quality;			/**< requested quality level */
+	uint32_t quality_run;			/**< quality level in use */
 	void (*eq_fir_func)(struct fir_state_32x16 fir[],
 			    const struct audio_stream *source,
 			    struct audio_stream *sink,
@@ -71,39 +86,48 @@ struct comp_data {
 
 #if FIR_HIFI3
 #if CONFIG_FORMAT_S16LE
-static inline void set_s16_fir(struct comp_data *cd)
+static inline void set_s16_fir(struct comp_data *cd, int nch)
 {
-	cd->eq_fir_func = eq_fir_2x_s16_hifi3;
+	if (nch >= FIR_MC_MIN_CHANNELS)
+		cd->eq_fir_func = eq_fir_mc_s16_hifi3;
+	else
+		cd->eq_fir_func = eq_fir_2x_s16_hifi3;
 }
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
-static inline void set_s24_fir(struct comp_data *cd)
+static inline void set_s24_fir(struct comp_data *cd, int nch)
 {
-	cd->eq_fir_func = eq_fir_2x_s24_hifi3;
+	if (nch >= FIR_MC_MIN_CHANNELS)
+		cd->eq_fir_func = eq_fir_mc_s24_hifi3;
+	else
+		cd->eq_fir_func = eq_fir_2x_s24_hifi3;
 }
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
-static inline void set_s32_fir(struct comp_data *cd)
+static inline void set_s32_fir(struct comp_data *cd, int nch)
 {
-	cd->eq_fir_func = eq_fir_2x_s32_hifi3;
+	if (nch >= FIR_MC_MIN_CHANNELS)
+		cd->eq_fir_func = eq_fir_mc_s32_hifi3;
+	else
+		cd->eq_fir_func = eq_fir_2x_s32_hifi3;
 }
 #endif /* CONFIG_FORMAT_S32LE */
 
 #elif FIR_HIFIEP
 #if CONFIG_FORMAT_S16LE
-static inline void set_s16_fir(struct comp_data *cd)
+static inline void set_s16_fir(struct comp_data *cd, int nch)
 {
 	cd->eq_fir_func = eq_fir_2x_s16_hifiep;
 }
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
-static inline void set_s24_fir(struct comp_data *cd)
+static inline void set_s24_fir(struct comp_data *cd, int nch)
 {
 	cd->eq_fir_func = eq_fir_2x_s24_hifiep;
 }
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
-static inline void set_s32_fir(struct comp_data *cd)
+static inline void set_s32_fir(struct comp_data *cd, int nch)
 {
 	cd->eq_fir_func = eq_fir_2x_s32_hifiep;
 }
@@ -111,21 +135,30 @@ static inline void set_s32_fir(struct comp_data *cd)
 #else
 /* FIR_GENERIC */
 #if CONFIG_FORMAT_S16LE
-static inline void set_s16_fir(struct comp_data *cd)
+static inline void set_s16_fir(struct comp_data *cd, int nch)
 {
-	cd->eq_fir_func = eq_fir_s16;
+	if (nch >= FIR_MC_MIN_CHANNELS)
+		cd->eq_fir_func = eq_fir_mc_s16;
+	else
+		cd->eq_fir_func = eq_fir_s16;
 }
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
-static inline void set_s24_fir(struct comp_data *cd)
+static inline void set_s24_fir(struct comp_data *cd, int nch)
 {
-	cd->eq_fir_func = eq_fir_s24;
+	if (nch >= FIR_MC_MIN_CHANNELS)
+		cd->eq_fir_func = eq_fir_mc_s24;
+	else
+		cd->eq_fir_func = eq_fir_s24;
 }
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
-static inline void set_s32_fir(struct comp_data *cd)
+static inline void set_s32_fir(struct comp_data *cd, int nch)
 {
-	cd->eq_fir_func = eq_fir_s32;
+	if (nch >= FIR_MC_MIN_CHANNELS)
+		cd->eq_fir_func = eq_fir_mc_s32;
+	else
+		cd->eq_fir_func = eq_fir_s32;
 }
 #endif /* CONFIG_FORMAT_S32LE */
 #endif
@@ -138,23 +171,25 @@ static inline int set_fir_func(struct comp_dev *dev)
 	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
 				  sink_list);
 
+	cd->pass = false;
+
 	switch (sourceb->stream.frame_fmt) {
 #if CONFIG_FORMAT_S16LE
 	case SOF_IPC_FRAME_S16_LE:
 		comp_info(dev, "set_fir_func(), SOF_IPC_FRAME_S16_LE");
-		set_s16_fir(cd);
+		set_s16_fir(cd, sourceb->stream.channels);
 		break;
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
 	case SOF_IPC_FRAME_S24_4LE:
 		comp_info(dev, "set_fir_func(), SOF_IPC_FRAME_S24_4LE");
-		set_s24_fir(cd);
+		set_s24_fir(cd, sourceb->stream.channels);
 		break;
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
 	case SOF_IPC_FRAME_S32_LE:
 		comp_info(dev, "set_fir_func(), SOF_IPC_FRAME_S32_LE");
-		set_s32_fir(cd);
+		set_s32_fir(cd, sourceb->stream.channels);
 		break;
 #endif /* CONFIG_FORMAT_S32LE */
 	default:
@@ -198,6 +233,8 @@ static inline int set_pass_func(struct comp_dev *dev)
 	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
 				  sink_list);
 
+	cd->pass = true;
+
 	switch (sourceb->stream.frame_fmt) {
 #if CONFIG_FORMAT_S16LE
 	case SOF_IPC_FRAME_S16_LE:
@@ -242,6 +279,8 @@ static void eq_fir_free_delaylines(struct comp_data *cd)
 	cd->fir_delay_size = 0;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		fir[i].delay = NULL;
+
+	eq_fir_fft_free(&cd->fft);
 }
 
 static int eq_fir_init_coef(struct sof_eq_fir_config *config,
@@ -355,15 +394,18 @@ static void eq_fir_init_delay(struct fir_state_32x16 *fir,
 	}
 }
 
-static int eq_fir_setup(struct comp_data *cd, int nch)
+/* Sets up filters of all channels from config with delay lines in a new
+ * chunk returned in delay. Returns size of the chunk or error code.
+ */
+static int eq_fir_init(struct sof_eq_fir_config *config,
+		       struct fir_state_32x16 *fir, int32_t **delay, int nch)
 {
 	int delay_size;
 
-	/* Free existing FIR channels data if it was allocated */
-	eq_fir_free_delaylines(cd);
+	*delay = NULL;
 
 	/* Set coefficients for each channel EQ from coefficient blob */
-	delay_size = eq_fir_init_coef(cd->config, cd->fir, nch);
+	delay_size = eq_fir_init_coef(config, fir, nch);
 	if (delay_size < 0)
 		return delay_size; /* Contains error code */
 
@@ -374,21 +416,122 @@ static int eq_fir_setup(struct comp_data *cd, int nch)
 		return 0;
 
 	/* Allocate all FIR channels data in a big chunk and clear it */
-	cd->fir_delay = rballoc(0, SOF_MEM_CAPS_RAM, delay_size);
-	if (!cd->fir_delay) {
-		comp_cl_err(&comp_eq_fir, "eq_fir_setup(), delay allocation failed for size %d",
+	*delay = rballoc(0, SOF_MEM_CAPS_RAM, delay_size);
+	if (!*delay) {
+		comp_cl_err(&comp_eq_fir, "eq_fir_init(), delay allocation failed for size %d",
 			    delay_size);
 		return -ENOMEM;
 	}
 
-	memset(cd->fir_delay, 0, delay_size);
-	cd->fir_delay_size = delay_size;
+	memset(*delay, 0, delay_size);
 
 	/* Assign delay line to each channel EQ */
-	eq_fir_init_delay(cd->fir, cd->fir_delay, nch);
+	eq_fir_init_delay(fir, *delay, nch);
+	return delay_size;
+}
+
+static int eq_fir_setup(struct comp_data *cd, int nch)
+{
+	int delay_size;
+
+	/* Free existing FIR channels data if it was allocated */
+	eq_fir_free_delaylines(cd);
+
+	/* long responses are filtered in frequency domain */
+	if (eq_fir_fft_needed(cd->config)) {
+		comp_cl_info(&comp_eq_fir, "eq_fir_setup(), frequency domain filtering");
+		return eq_fir_fft_new(&cd->fft, cd->config, nch);
+	}
+
+	delay_size = eq_fir_init(cd->config, cd->fir, &cd->fir_delay, nch);
+	if (delay_size < 0)
+		return delay_size;
+
+	cd->fir_delay_size = delay_size;
 	return 0;
 }
 
+/* Sets up filters of a configuration received while processing in the
+ * IPC thread, so copy only has to swap them in between two periods.
+ */
+static int eq_fir_shadow_setup(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+	int delay_size;
+	int ret;
+	int i;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		fir_reset(&cd->fir_new[i]);
+
+	if (eq_fir_fft_needed(cd->config_new)) {
+		ret = eq_fir_fft_new(&cd->fft_new, cd->config_new,
+				     sourceb->stream.channels);
+		if (ret < 0)
+			return ret;
+	} else {
+		delay_size = eq_fir_init(cd->config_new, cd->fir_new,
+					 &cd->fir_delay_new,
+					 sourceb->stream.channels);
+		if (delay_size < 0)
+			return delay_size;
+
+		cd->fir_delay_size_new = delay_size;
+	}
+
+	/* copy takes the filters only once they are complete */
+	cd->swap_ready = true;
+
+	return 0;
+}
+
+/* Takes shadow filters in use, replaced filters are freed later by IPC,
+ * not in the audio thread.
+ */
+static void eq_fir_swap(struct comp_data *cd)
+{
+	int ret;
+
+	ret = memcpy_s(cd->fir, sizeof(cd->fir), cd->fir_new,
+		       sizeof(cd->fir_new));
+	assert(!ret);
+
+	cd->config_old = cd->config;
+	cd->fir_delay_old = cd->fir_delay;
+	cd->config = cd->config_new;
+	cd->fir_delay = cd->fir_delay_new;
+	cd->fir_delay_size = cd->fir_delay_size_new;
+	cd->config_new = NULL;
+	cd->fir_delay_new = NULL;
+	cd->fft_old = cd->fft;
+	cd->fft = cd->fft_new;
+	cd->fft_new = NULL;
+	cd->swap_ready = false;
+}
+
+/* frees filters replaced by the last swap */
+static void eq_fir_free_old(struct comp_data *cd)
+{
+	eq_fir_free_parameters(&cd->config_old);
+	rfree(cd->fir_delay_old);
+	cd->fir_delay_old = NULL;
+	eq_fir_fft_free(&cd->fft_old);
+}
+
+/* drops shadow filters not taken in use */
+static void eq_fir_free_shadow(struct comp_data *cd)
+{
+	rfree(cd->fir_delay_new);
+	cd->fir_delay_new = NULL;
+	cd->fir_delay_size_new = 0;
+	eq_fir_fft_free(&cd->fft_new);
+	cd->swap_ready = false;
+}
+
 /*
  * End of algorithm code. Next the standard component methods.
  */
@@ -474,6 +617,8 @@ static void eq_fir_free(struct comp_dev *dev)
 	comp_info(dev, "eq_fir_free()");
 
 	eq_fir_free_delaylines(cd);
+	eq_fir_free_shadow(cd);
+	eq_fir_free_old(cd);
 	eq_fir_free_parameters(&cd->config);
 	eq_fir_free_parameters(&cd->config_new);
 
@@ -596,6 +741,8 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 			return -EINVAL;
 
 		if (cdata->msg_index == 0) {
+			eq_fir_free_old(cd);
+
 			/* Allocate buffer for copy of the blob. */
 			cd->config_new = rballoc(0, SOF_MEM_CAPS_RAM,
 						 cdata->num_elems +
@@ -632,7 +779,8 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 
 			/* If component state is READY we can omit old
 			 * configuration immediately. When in playback/capture
-			 * the new configuration presence is checked in copy().
+			 * the new filters are set up here and swapped in by
+			 * copy().
 			 */
 			if (dev->state ==  COMP_STATE_READY)
 				eq_fir_free_parameters(&cd->config);
@@ -644,6 +792,14 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 			if (!cd->config) {
 				cd->config = cd->config_new;
 				cd->config_new = NULL;
+				break;
+			}
+
+			ret = eq_fir_shadow_setup(dev);
+			if (ret < 0) {
+				comp_err(dev, "fir_cmd_set_data(), failed FIR setup");
+				eq_fir_free_shadow(cd);
+				eq_fir_free_parameters(&cd->config_new);
 			}
 		}
 		break;
@@ -692,16 +848,53 @@ static int eq_fir_trigger(struct comp_dev *dev, int cmd)
 	return comp_set_state(dev, cmd);
 }
 
+/* silent input frames after which all delay lines hold zeros */
+static uint32_t eq_fir_flush_frames(struct comp_data *cd, int nch)
+{
+	uint32_t frames = 0;
+	int i;
+
+	if (cd->pass)
+		return 0;
+
+	if (cd->fft)
+		return eq_fir_fft_flush_frames(cd->fft);
+
+	for (i = 0; i < nch; i++)
+		frames = MAX(frames, cd->fir[i].taps);
+
+	return frames;
+}
+
 static void eq_fir_process(struct comp_dev *dev, struct comp_buffer *source,
 			   struct comp_buffer *sink, int frames,
 			   uint32_t source_bytes, uint32_t sink_bytes)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-
-	buffer_invalidate(source, source_bytes);
-
-	cd->eq_fir_func(cd->fir, &source->stream, &sink->stream, frames,
-			source->stream.channels);
+	bool silence = buffer_is_silent(source);
+
+	if (!silence)
+		cd->silence_frames = 0;
+
+	/* filters which have flushed their history give only zeros */
+	if (silence && cd->silence_frames >=
+	    eq_fir_flush_frames(cd, source->stream.channels)) {
+		audio_stream_set_zero(&sink->stream, sink_bytes);
+		buffer_mark_silence(sink);
+	} else {
+		buffer_invalidate(source, source_bytes);
+
+		if (cd->fft && !cd->pass)
+			eq_fir_fft_process(cd->fft, &source->stream,
+					   &sink->stream, frames);
+		else
+			cd->eq_fir_func(cd->fir, &source->stream,
+					&sink->stream, frames,
+					source->stream.channels);
+
+		if (silence)
+			cd->silence_frames += frames;
+	}
 
 	buffer_writeback(sink, sink_bytes);
 
@@ -710,6 +903,31 @@ static void eq_fir_process(struct comp_dev *dev, struct comp_buffer *source,
 	comp_update_buffer_produce(sink, sink_bytes);
 }
 
+/* switches between filtering and pass-through between copies */
+static int eq_fir_quality_update(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	bool bypass = cd->quality >= COMP_QUALITY_BYPASS;
+	bool changed = bypass != (cd->quality_run >= COMP_QUALITY_BYPASS);
+
+	cd->quality_run = cd->quality;
+
+	/* nothing to switch when not set up for response */
+	if (!changed || (!cd->fir_delay && !cd->fft))
+		return 0;
+
+	if (bypass)
+		return set_pass_func(dev);
+
+	/* filters restart from silence instead of stale history */
+	if (cd->fft)
+		eq_fir_fft_reset(cd->fft);
+	else
+		memset(cd->fir_delay, 0, cd->fir_delay_size);
+
+	return set_fir_func(dev);
+}
+
 /* copy and process stream data from source to sink buffers */
 static int eq_fir_copy(struct comp_dev *dev)
 {
@@ -727,15 +945,13 @@ static int eq_fir_copy(struct comp_dev *dev)
 				  sink_list);
 
 	/* Check for changed configuration */
-	if (cd->config_new && cd->config_ready) {
-		eq_fir_free_parameters(&cd->config);
-		cd->config = cd->config_new;
-		cd->config_new = NULL;
-		ret = eq_fir_setup(cd, sourceb->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "eq_fir_copy(), failed FIR setup");
+	if (cd->swap_ready)
+		eq_fir_swap(cd);
+
+	if (cd->quality != cd->quality_run) {
+		ret = eq_fir_quality_update(dev);
+		if (ret < 0)
 			return ret;
-		}
 	}
 
 	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
@@ -816,6 +1032,9 @@ static int eq_fir_prepare(struct comp_dev *dev)
 			goto err;
 		}
 
+		/* requested quality is taken in use by the first copy */
+		cd->quality_run = COMP_QUALITY_FULL;
+
 		ret = set_fir_func(dev);
 		return ret;
 	}
@@ -836,8 +1055,20 @@ static int eq_fir_reset(struct comp_dev *dev)
 	comp_info(dev, "eq_fir_reset()");
 
 	eq_fir_free_delaylines(cd);
+	eq_fir_free_old(cd);
+
+	/* configuration not swapped in yet is set up again by prepare */
+	if (cd->swap_ready) {
+		eq_fir_free_shadow(cd);
+		eq_fir_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
 
 	cd->eq_fir_func = NULL;
+	cd->quality = COMP_QUALITY_FULL;
+	cd->quality_run = COMP_QUALITY_FULL;
+	cd->silence_frames = 0;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		fir_reset(&cd->fir[i]);
 
@@ -845,9 +1076,28 @@ static int eq_fir_reset(struct comp_dev *dev)
 	return 0;
 }
 
+/* FIR has no cheaper filtering, so lower quality levels keep it full */
+static int eq_fir_set_attribute(struct comp_dev *dev, uint32_t type,
+				void *value)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (type != COMP_ATTR_QUALITY)
+		return -EINVAL;
+
+	comp_info(dev, "eq_fir_set_attribute(), quality %u",
+		  *(uint32_t *)value);
+
+	/* taken in use by the next copy */
+	cd->quality = *(uint32_t *)value;
+
+	return 0;
+}
+
 static const struct comp_driver comp_eq_fir = {
 	.type = SOF_COMP_EQ_FIR,
 	.uid = SOF_UUID(eq_fir_uuid),
+	.flags = COMP_DRV_INPLACE,
 	.ops = {
 		.create = eq_fir_new,
 		.free = eq_fir_free,
@@ -857,6 +1107,7 @@ static const struct comp_driver comp_eq_fir = {
 		.copy = eq_fir_copy,
 		.prepare = eq_fir_prepare,
 		.reset = eq_fir_reset,
+		.set_attribute = eq_fir_set_attribute,
 	},
 };
 
@@ -0,0 +1,418 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/eq_fir/eq_fir_fft.h>
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/lib/alloc.h>
+#include <sof/math/fft.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <sof/string.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <user/eq.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EQ_FIR_FFT_ABS64(x)	((uint64_t)((x) ^ ((x) >> 63)))
+
+/* products are accumulated with this many bits dropped, so that the sum of
+ * SOF_EQ_FIR_FFT_MAX_LENGTH / EQ_FIR_FFT_BLOCK partitions can't overflow
+ */
+#define EQ_FIR_FFT_ACC_SHIFT	8
+
+/* spectrum for the inverse transform is at most this */
+#define EQ_FIR_FFT_PEAK		(1ull << 29)
+
+/* collects start of each response in config, returns number of responses
+ * or error code
+ */
+static int eq_fir_fft_lookup(const struct sof_eq_fir_config *config,
+			     const struct sof_eq_fir_coef_data **lookup)
+{
+	const int16_t *coef_data;
+	int j = 0;
+	int i;
+
+	if (config->number_of_responses > SOF_EQ_FIR_MAX_RESPONSES)
+		return -EINVAL;
+
+	coef_data = ASSUME_ALIGNED(&config->data[config->channels_in_config],
+				   4);
+	for (i = 0; i < config->number_of_responses; i++) {
+		lookup[i] = (const struct sof_eq_fir_coef_data *)&coef_data[j];
+		if (lookup[i]->length < 1)
+			return -EINVAL;
+
+		j += SOF_EQ_FIR_COEF_NHEADER + lookup[i]->length;
+	}
+
+	return config->number_of_responses;
+}
+
+bool eq_fir_fft_needed(const struct sof_eq_fir_config *config)
+{
+	const struct sof_eq_fir_coef_data *lookup[SOF_EQ_FIR_MAX_RESPONSES];
+	int n;
+	int i;
+
+	n = eq_fir_fft_lookup(config, lookup);
+	for (i = 0; i < n; i++) {
+		if (lookup[i]->length > EQ_FIR_FFT_MIN_LENGTH)
+			return true;
+	}
+
+	return false;
+}
+
+/* transforms partitions of response eq, a unit impulse when NULL */
+static void eq_fir_fft_response(struct eq_fir_fft *fft,
+				const struct sof_eq_fir_coef_data *eq,
+				struct icomplex32 *h, int partitions)
+{
+	const int16_t *coef;
+	int32_t *x = fft->block;
+	int n;
+	int p;
+	int i;
+
+	for (p = 0; p < partitions; p++) {
+		memset(x, 0, sizeof(fft->block));
+
+		if (eq) {
+			coef = ASSUME_ALIGNED(&eq->coef[p * EQ_FIR_FFT_BLOCK],
+					      2);
+			n = MIN(eq->length - p * EQ_FIR_FFT_BLOCK,
+				EQ_FIR_FFT_BLOCK);
+			for (i = 0; i < n; i++)
+				x[i] = (int32_t)coef[i] << 16;
+		} else {
+			x[0] = INT32_MAX;
+		}
+
+		fft_real(&fft->plan, x, h + p * EQ_FIR_FFT_BINS);
+	}
+}
+
+int eq_fir_fft_new(struct eq_fir_fft **fft, struct sof_eq_fir_config *config,
+		   int nch)
+{
+	const struct sof_eq_fir_coef_data *lookup[SOF_EQ_FIR_MAX_RESPONSES + 1];
+	struct icomplex32 *h[SOF_EQ_FIR_MAX_RESPONSES + 1];
+	int parts[SOF_EQ_FIR_MAX_RESPONSES + 1];
+	int assign[PLATFORM_MAX_CHANNELS];
+	struct eq_fir_fft_channel *c;
+	const int16_t *assign_response;
+	struct icomplex32 *spectra;
+	struct eq_fir_fft *f;
+	size_t spectra_sum = 0;
+	int bypass;
+	int resp = 0;
+	int n;
+	int i;
+
+	*fft = NULL;
+
+	if (nch > PLATFORM_MAX_CHANNELS ||
+	    config->channels_in_config > PLATFORM_MAX_CHANNELS ||
+	    !config->channels_in_config)
+		return -EINVAL;
+
+	n = eq_fir_fft_lookup(config, lookup);
+	if (n < 0)
+		return n;
+
+	/* bypassed channels get a unit impulse response after the others to
+	 * have the same delay
+	 */
+	bypass = n;
+	lookup[bypass] = NULL;
+	memset(parts, 0, sizeof(parts));
+
+	assign_response = ASSUME_ALIGNED(&config->data[0], 4);
+	for (i = 0; i < nch; i++) {
+		/* additional channels use the last assigned response */
+		if (i < config->channels_in_config)
+			resp = assign_response[i];
+
+		if (resp >= n)
+			return -EINVAL;
+
+		assign[i] = resp < 0 ? bypass : resp;
+		if (parts[assign[i]])
+			continue;
+
+		if (assign[i] == bypass) {
+			parts[bypass] = 1;
+		} else {
+			if (lookup[resp]->length > SOF_EQ_FIR_FFT_MAX_LENGTH)
+				return -EINVAL;
+
+			parts[resp] = ceil_divide(lookup[resp]->length,
+						  EQ_FIR_FFT_BLOCK);
+		}
+
+		spectra_sum += parts[assign[i]];
+	}
+
+	for (i = 0; i < nch; i++)
+		spectra_sum += parts[assign[i]];
+
+	f = rballoc(0, SOF_MEM_CAPS_RAM, sizeof(*f) + spectra_sum *
+		    EQ_FIR_FFT_BINS * sizeof(struct icomplex32));
+	if (!f)
+		return -ENOMEM;
+
+	memset(f, 0, sizeof(*f));
+	fft_plan_init(&f->plan, EQ_FIR_FFT_BITS, f->twiddle, f->work);
+
+	/* response spectra first, then input spectra of channels */
+	spectra = f->spectra;
+	for (i = 0; i <= n; i++) {
+		if (!parts[i])
+			continue;
+
+		h[i] = spectra;
+		eq_fir_fft_response(f, lookup[i], h[i], parts[i]);
+		spectra += parts[i] * EQ_FIR_FFT_BINS;
+	}
+
+	f->fdl = spectra;
+	for (i = 0; i < nch; i++) {
+		c = &f->ch[i];
+		c->h = h[assign[i]];
+		c->partitions = parts[assign[i]];
+		c->out_shift = lookup[assign[i]] ?
+			lookup[assign[i]]->out_shift : 0;
+		c->fdl = spectra;
+		spectra += c->partitions * EQ_FIR_FFT_BINS;
+	}
+
+	f->fdl_size = (char *)spectra - (char *)f->fdl;
+	f->nch = nch;
+	eq_fir_fft_reset(f);
+
+	*fft = f;
+	return 0;
+}
+
+void eq_fir_fft_free(struct eq_fir_fft **fft)
+{
+	rfree(*fft);
+	*fft = NULL;
+}
+
+void eq_fir_fft_reset(struct eq_fir_fft *fft)
+{
+	int i;
+
+	for (i = 0; i < fft->nch; i++) {
+		memset(fft->ch[i].in, 0, sizeof(fft->ch[i].in));
+		memset(fft->ch[i].out, 0, sizeof(fft->ch[i].out));
+		fft->ch[i].fdl_pos = 0;
+	}
+
+	memset(fft->fdl, 0, fft->fdl_size);
+	fft->pos = 0;
+}
+
+uint32_t eq_fir_fft_flush_frames(const struct eq_fir_fft *fft)
+{
+	int partitions = 0;
+	int i;
+
+	for (i = 0; i < fft->nch; i++)
+		partitions = MAX(partitions, fft->ch[i].partitions);
+
+	/* the block being filled, all partitions and the output delay */
+	return (partitions + 2) * EQ_FIR_FFT_BLOCK;
+}
+
+/* adds products of input spectrum x and response partition h */
+static void eq_fir_fft_mac(struct eq_fir_fft *fft, const struct icomplex32 *x,
+			   const struct icomplex32 *h)
+{
+	int k;
+
+	for (k = 0; k < EQ_FIR_FFT_BINS; k++) {
+		fft->acc_real[k] +=
+			(((int64_t)x[k].real * h[k].real) >>
+			 EQ_FIR_FFT_ACC_SHIFT) -
+			(((int64_t)x[k].imag * h[k].imag) >>
+			 EQ_FIR_FFT_ACC_SHIFT);
+		fft->acc_imag[k] +=
+			(((int64_t)x[k].real * h[k].imag) >>
+			 EQ_FIR_FFT_ACC_SHIFT) +
+			(((int64_t)x[k].imag * h[k].real) >>
+			 EQ_FIR_FFT_ACC_SHIFT);
+	}
+}
+
+/* Converts the accumulated spectrum to 32 bits for the inverse transform,
+ * returns the right shift done.
+ */
+static int eq_fir_fft_normalize(struct eq_fir_fft *fft)
+{
+	uint64_t peak = 0;
+	int shift = 0;
+	int k;
+
+	for (k = 0; k < EQ_FIR_FFT_BINS; k++)
+		peak |= EQ_FIR_FFT_ABS64(fft->acc_real[k]) |
+			EQ_FIR_FFT_ABS64(fft->acc_imag[k]);
+
+	while (peak >= EQ_FIR_FFT_PEAK) {
+		peak >>= 1;
+		shift++;
+	}
+
+	for (k = 0; k < EQ_FIR_FFT_BINS; k++) {
+		fft->spectrum[k].real = fft->acc_real[k] >> shift;
+		fft->spectrum[k].imag = fft->acc_imag[k] >> shift;
+	}
+
+	return shift;
+}
+
+/* filters the input block of every channel into its output block */
+static void eq_fir_fft_block(struct eq_fir_fft *fft)
+{
+	struct eq_fir_fft_channel *c;
+	int64_t y;
+	int shift;
+	int ret;
+	int idx;
+	int ch;
+	int p;
+	int i;
+
+	for (ch = 0; ch < fft->nch; ch++) {
+		c = &fft->ch[ch];
+
+		fft_real(&fft->plan, c->in, c->fdl + c->fdl_pos *
+			 EQ_FIR_FFT_BINS);
+
+		memset(fft->acc_real, 0, sizeof(fft->acc_real));
+		memset(fft->acc_imag, 0, sizeof(fft->acc_imag));
+
+		/* partition p filters the input block p blocks ago */
+		idx = c->fdl_pos;
+		for (p = 0; p < c->partitions; p++) {
+			eq_fir_fft_mac(fft, c->fdl + idx * EQ_FIR_FFT_BINS,
+				       c->h + p * EQ_FIR_FFT_BINS);
+			idx = idx ? idx - 1 : c->partitions - 1;
+		}
+
+		/* Transforms are scaled by 1 / size and the accumulated
+		 * products by 2^-EQ_FIR_FFT_ACC_SHIFT, and the Q1.31 by
+		 * Q1.31 product needs 31 right shifts.
+		 */
+		shift = eq_fir_fft_normalize(fft);
+		shift += fft_real_inverse(&fft->plan, fft->spectrum,
+					  fft->block);
+		shift += 2 * EQ_FIR_FFT_BITS + EQ_FIR_FFT_ACC_SHIFT - 31 -
+			c->out_shift;
+
+		/* the last block of the circular convolution is valid */
+		for (i = 0; i < EQ_FIR_FFT_BLOCK; i++) {
+			y = fft->block[EQ_FIR_FFT_BLOCK + i];
+			if (shift >= 0)
+				c->out[i] = sat_int32(y << MIN(shift, 32));
+			else if (shift > -63)
+				c->out[i] = sat_int32(((y >> (-shift - 1)) +
+						       1) >> 1);
+			else
+				c->out[i] = 0;
+		}
+
+		ret = memcpy_s(c->in, sizeof(c->in), c->in + EQ_FIR_FFT_BLOCK,
+			       EQ_FIR_FFT_BLOCK * sizeof(int32_t));
+		assert(!ret);
+
+		if (++c->fdl_pos == c->partitions)
+			c->fdl_pos = 0;
+	}
+}
+
+/* returns sample as Q1.31 */
+static inline int32_t eq_fir_fft_get(const void *ptr, enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return (int32_t)*(const int16_t *)ptr << 16;
+	case SOF_IPC_FRAME_S24_4LE:
+		return sign_extend_s24(*(const int32_t *)ptr) << 8;
+	default:
+		return *(const int32_t *)ptr;
+	}
+}
+
+/* stores Q1.31 sample rounded to format */
+static inline void eq_fir_fft_set(void *ptr, enum sof_ipc_frame fmt,
+				  int32_t x)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		*(int16_t *)ptr = sat_int16(Q_SHIFT_RND(x, 31, 15));
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		*(int32_t *)ptr = sat_int24(Q_SHIFT_RND(x, 31, 23));
+		break;
+	default:
+		*(int32_t *)ptr = x;
+		break;
+	}
+}
+
+void eq_fir_fft_process(struct eq_fir_fft *fft,
+			const struct audio_stream *source,
+			struct audio_stream *sink, int frames)
+{
+	enum sof_ipc_frame fmt = source->frame_fmt;
+	uint32_t sample_bytes = audio_stream_sample_bytes(source);
+	uint32_t frame_bytes = audio_stream_frame_bytes(source);
+	struct eq_fir_fft_channel *c;
+	char *x = source->r_ptr;
+	char *y = sink->w_ptr;
+	int ch;
+	int n;
+	int i;
+
+	while (frames) {
+		n = MIN(frames, EQ_FIR_FFT_BLOCK - fft->pos);
+		n = MIN(n, audio_stream_frames_without_wrap(source, x));
+		n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+
+		for (i = 0; i < n; i++) {
+			/* input is read before output for in-place use */
+			for (ch = 0; ch < fft->nch; ch++) {
+				c = &fft->ch[ch];
+				c->in[EQ_FIR_FFT_BLOCK + fft->pos] =
+					eq_fir_fft_get(x + ch * sample_bytes,
+						       fmt);
+				eq_fir_fft_set(y + ch * sample_bytes, fmt,
+					       c->out[fft->pos]);
+			}
+
+			fft->pos++;
+			x += frame_bytes;
+			y += frame_bytes;
+		}
+
+		frames -= n;
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+
+		if (fft->pos == EQ_FIR_FFT_BLOCK) {
+			eq_fir_fft_block(fft);
+			fft->pos = 0;
+		}
+	}
+}
@@ -14,6 +14,7 @@
 #include <sof/audio/buffer.h>
 #include <sof/audio/eq_fir/fir.h>
 #include <sof/audio/format.h>
+#include <sof/math/numbers.h>
 #include <user/eq.h>
 #include <errno.h>
 #include <stddef.h>
@@ -70,19 +71,31 @@ void eq_fir_s16(struct fir_state_32x16 fir[], const struct audio_stream *source,
 	int16_t *x;
 	int16_t *y;
 	int32_t z;
-	int idx;
+	int remaining;
 	int ch;
+	int n;
 	int i;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &fir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s16(source, idx);
-			y = audio_stream_write_frag_s16(sink, idx);
-			z = fir_32x16(filter, *x << 16);
-			*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
-			idx += nch;
+		x = audio_stream_read_frag_s16(source, ch);
+		y = audio_stream_write_frag_s16(sink, ch);
+		remaining = frames;
+		while (remaining) {
+			/* process frames till the closest buffer wrap */
+			n = audio_stream_frames_without_wrap(source, x);
+			n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+			n = MIN(n, remaining);
+			for (i = 0; i < n; i++) {
+				z = fir_32x16(filter, *x << 16);
+				*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
+				x += nch;
+				y += nch;
+			}
+
+			x = audio_stream_wrap(source, x);
+			y = audio_stream_wrap(sink, y);
+			remaining -= n;
 		}
 	}
 }
@@ -96,19 +109,31 @@ void eq_fir_s24(struct fir_state_32x16 fir[], const struct audio_stream *source,
 	int32_t *x;
 	int32_t *y;
 	int32_t z;
-	int idx;
+	int remaining;
 	int ch;
+	int n;
 	int i;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &fir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_write_frag_s32(sink, idx);
-			z = fir_32x16(filter, *x << 8);
-			*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
-			idx += nch;
+		x = audio_stream_read_frag_s32(source, ch);
+		y = audio_stream_write_frag_s32(sink, ch);
+		remaining = frames;
+		while (remaining) {
+			/* process frames till the closest buffer wrap */
+			n = audio_stream_frames_without_wrap(source, x);
+			n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+			n = MIN(n, remaining);
+			for (i = 0; i < n; i++) {
+				z = fir_32x16(filter, *x << 8);
+				*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
+				x += nch;
+				y += nch;
+			}
+
+			x = audio_stream_wrap(source, x);
+			y = audio_stream_wrap(sink, y);
+			remaining -= n;
 		}
 	}
 }
@@ -121,19 +146,143 @@ void eq_fir_s32(struct fir_state_32x16 fir[], const struct audio_stream *source,
 	struct fir_state_32x16 *filter;
 	int32_t *x;
 	int32_t *y;
-	int idx;
+	int remaining;
 	int ch;
+	int n;
 	int i;
 
 	for (ch = 0; ch < nch; ch++) {
 		filter = &fir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_write_frag_s32(sink, idx);
-			*y = fir_32x16(filter, *x);
-			idx += nch;
+		x = audio_stream_read_frag_s32(source, ch);
+		y = audio_stream_write_frag_s32(sink, ch);
+		remaining = frames;
+		while (remaining) {
+			/* process frames till the closest buffer wrap */
+			n = audio_stream_frames_without_wrap(source, x);
+			n = MIN(n, audio_stream_frames_without_wrap(sink, y));
+			n = MIN(n, remaining);
+			for (i = 0; i < n; i++) {
+				*y = fir_32x16(filter, *x);
+				x += nch;
+				y += nch;
+			}
+
+			x = audio_stream_wrap(source, x);
+			y = audio_stream_wrap(sink, y);
+			remaining -= n;
+		}
+	}
+}
+#endif /* CONFIG_FORMAT_S32LE */
+
+#if CONFIG_FORMAT_S16LE
+/* Frame interleaved version, all channels of a frame are processed before
+ * advancing to the next frame so the source and sink buffers are passed
+ * only once.
+ */
+void eq_fir_mc_s16(struct fir_state_32x16 fir[],
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames, int nch)
+{
+	int16_t *x = source->r_ptr;
+	int16_t *y = sink->w_ptr;
+	int32_t z;
+	int samples = frames * nch;
+	int ch = 0;
+	int n;
+	int i;
+
+	while (samples) {
+		/* process samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s16(source, x);
+		n = MIN(n, audio_stream_samples_without_wrap_s16(sink, y));
+		n = MIN(n, samples);
+		for (i = 0; i < n; i++) {
+			z = fir_32x16(&fir[ch], *x << 16);
+			*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
+			x++;
+			y++;
+			if (++ch == nch)
+				ch = 0;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+/* Frame interleaved version, all channels of a frame are processed before
+ * advancing to the next frame so the source and sink buffers are passed
+ * only once.
+ */
+void eq_fir_mc_s24(struct fir_state_32x16 fir[],
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames, int nch)
+{
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int32_t z;
+	int samples = frames * nch;
+	int ch = 0;
+	int n;
+	int i;
+
+	while (samples) {
+		/* process samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s32(source, x);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, y));
+		n = MIN(n, samples);
+		for (i = 0; i < n; i++) {
+			z = fir_32x16(&fir[ch], *x << 8);
+			*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
+			x++;
+			y++;
+			if (++ch == nch)
+				ch = 0;
 		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+/* Frame interleaved version, all channels of a frame are processed before
+ * advancing to the next frame so the source and sink buffers are passed
+ * only once.
+ */
+void eq_fir_mc_s32(struct fir_state_32x16 fir[],
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames, int nch)
+{
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int samples = frames * nch;
+	int ch = 0;
+	int n;
+	int i;
+
+	while (samples) {
+		/* process samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s32(source, x);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, y));
+		n = MIN(n, samples);
+		for (i = 0; i < n; i++) {
+			*y = fir_32x16(&fir[ch], *x);
+			x++;
+			y++;
+			if (++ch == nch)
+				ch = 0;
+		}
+
+		x = audio_stream_wrap(source, x);
+		y = audio_stream_wrap(sink, y);
+		samples -= n;
 	}
 }
 #endif /* CONFIG_FORMAT_S32LE */
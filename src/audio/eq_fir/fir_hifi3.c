@@ -10,6 +10,7 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/eq_fir/fir_hifi3.h>
+#include <sof/platform.h>
 #include <user/eq.h>
 #include <xtensa/config/defs.h>
 #include <xtensa/tie/xt_hifi3.h>
@@ -141,6 +142,68 @@ void eq_fir_2x_s32_hifi3(struct fir_state_32x16 fir[],
 	}
 }
 
+/* Frame interleaved FIR for even number of frames. All channels of two
+ * successive frames are loaded and stored with a single pass over the
+ * component buffers, so the circular addressing for source and sink needs
+ * to be set up only once per frame pair instead of once per sample.
+ */
+void eq_fir_mc_s32_hifi3(struct fir_state_32x16 fir[],
+			 const struct audio_stream *source,
+			 struct audio_stream *sink, int frames, int nch)
+{
+	struct fir_state_32x16 *f;
+	ae_int32 in0[PLATFORM_MAX_CHANNELS];
+	ae_int32 in1[PLATFORM_MAX_CHANNELS];
+	ae_int32 out0[PLATFORM_MAX_CHANNELS];
+	ae_int32 out1[PLATFORM_MAX_CHANNELS];
+	int shift[PLATFORM_MAX_CHANNELS];
+	ae_int32x2 d = 0;
+	ae_int32 *x = (ae_int32 *)source->r_ptr;
+	ae_int32 *y = (ae_int32 *)sink->w_ptr;
+	int ch;
+	int i;
+	int rshift;
+	int lshift;
+
+	/* Get shifts of all channels once for the whole period */
+	for (ch = 0; ch < nch; ch++) {
+		fir_get_lrshifts(&fir[ch], &lshift, &rshift);
+		shift[ch] = lshift - rshift;
+	}
+
+	for (i = 0; i < (frames >> 1); i++) {
+		/* Load two input frames */
+		fir_comp_setup_circular(source);
+		for (ch = 0; ch < nch; ch++) {
+			AE_L32_XC(d, x, sizeof(int32_t));
+			in0[ch] = d;
+		}
+		for (ch = 0; ch < nch; ch++) {
+			AE_L32_XC(d, x, sizeof(int32_t));
+			in1[ch] = d;
+		}
+
+		/* Compute FIR for each channel */
+		for (ch = 0; ch < nch; ch++) {
+			f = &fir[ch];
+			fir_core_setup_circular(f);
+			fir_32x16_2x_hifi3(f, in0[ch], in1[ch], &out0[ch],
+					   &out1[ch], shift[ch]);
+		}
+
+		/* Store two output frames */
+		fir_comp_setup_circular(sink);
+		for (ch = 0; ch < nch; ch++) {
+			d = out0[ch];
+			AE_S32_L_XC(d, y, sizeof(int32_t));
+		}
+		for (ch = 0; ch < nch; ch++) {
+			d = out1[ch];
+			AE_S32_L_XC(d, y, sizeof(int32_t));
+		}
+	}
+}
+
 /* FIR for any number of frames */
 void eq_fir_s32_hifi3(struct fir_state_32x16 fir[],
 		      const struct audio_stream *source,
@@ -265,6 +328,68 @@ void eq_fir_2x_s24_hifi3(struct fir_state_32x16 fir[],
 	}
 }
 
+/* Frame interleaved FIR for even number of frames. All channels of two
+ * successive frames are loaded and stored with a single pass over the
+ * component buffers, so the circular addressing for source and sink needs
+ * to be set up only once per frame pair instead of once per sample.
+ */
+void eq_fir_mc_s24_hifi3(struct fir_state_32x16 fir[],
+			 const struct audio_stream *source,
+			 struct audio_stream *sink, int frames, int nch)
+{
+	struct fir_state_32x16 *f;
+	ae_int32 in0[PLATFORM_MAX_CHANNELS];
+	ae_int32 in1[PLATFORM_MAX_CHANNELS];
+	ae_int32 out0[PLATFORM_MAX_CHANNELS];
+	ae_int32 out1[PLATFORM_MAX_CHANNELS];
+	int shift[PLATFORM_MAX_CHANNELS];
+	ae_int32x2 d = 0;
+	ae_int32 *x = (ae_int32 *)source->r_ptr;
+	ae_int32 *y = (ae_int32 *)sink->w_ptr;
+	int ch;
+	int i;
+	int rshift;
+	int lshift;
+
+	/* Get shifts of all channels once for the whole period */
+	for (ch = 0; ch < nch; ch++) {
+		fir_get_lrshifts(&fir[ch], &lshift, &rshift);
+		shift[ch] = lshift - rshift;
+	}
+
+	for (i = 0; i < (frames >> 1); i++) {
+		/* Load two input frames and convert Q1.23 to Q1.31 */
+		fir_comp_setup_circular(source);
+		for (ch = 0; ch < nch; ch++) {
+			AE_L32_XC(d, x, sizeof(int32_t));
+			in0[ch] = AE_SLAA32(d, 8);
+		}
+		for (ch = 0; ch < nch; ch++) {
+			AE_L32_XC(d, x, sizeof(int32_t));
+			in1[ch] = AE_SLAA32(d, 8);
+		}
+
+		/* Compute FIR for each channel */
+		for (ch = 0; ch < nch; ch++) {
+			f = &fir[ch];
+			fir_core_setup_circular(f);
+			fir_32x16_2x_hifi3(f, in0[ch], in1[ch], &out0[ch],
+					   &out1[ch], shift[ch]);
+		}
+
+		/* Store two output frames */
+		fir_comp_setup_circular(sink);
+		for (ch = 0; ch < nch; ch++) {
+			d = AE_SRAI32R(out0[ch], 8);
+			AE_S32_L_XC(d, y, sizeof(int32_t));
+		}
+		for (ch = 0; ch < nch; ch++) {
+			d = AE_SRAI32R(out1[ch], 8);
+			AE_S32_L_XC(d, y, sizeof(int32_t));
+		}
+	}
+}
+
 void eq_fir_s24_hifi3(struct fir_state_32x16 fir[],
 		      const struct audio_stream *source,
 		      struct audio_stream *sink, int frames, int nch)
@@ -397,6 +522,68 @@ void eq_fir_2x_s16_hifi3(struct fir_state_32x16 fir[],
 	}
 }
 
+/* Frame interleaved FIR for even number of frames. All channels of two
+ * successive frames are loaded and stored with a single pass over the
+ * component buffers, so the circular addressing for source and sink needs
+ * to be set up only once per frame pair instead of once per sample.
+ */
+void eq_fir_mc_s16_hifi3(struct fir_state_32x16 fir[],
+			 const struct audio_stream *source,
+			 struct audio_stream *sink, int frames, int nch)
+{
+	struct fir_state_32x16 *f;
+	ae_int32 in0[PLATFORM_MAX_CHANNELS];
+	ae_int32 in1[PLATFORM_MAX_CHANNELS];
+	ae_int32 out0[PLATFORM_MAX_CHANNELS];
+	ae_int32 out1[PLATFORM_MAX_CHANNELS];
+	int shift[PLATFORM_MAX_CHANNELS];
+	ae_int16x4 d = AE_ZERO16();
+	ae_int16 *x = (ae_int16 *)source->r_ptr;
+	ae_int16 *y = (ae_int16 *)sink->w_ptr;
+	int ch;
+	int i;
+	int rshift;
+	int lshift;
+
+	/* Get shifts of all channels once for the whole period */
+	for (ch = 0; ch < nch; ch++) {
+		fir_get_lrshifts(&fir[ch], &lshift, &rshift);
+		shift[ch] = lshift - rshift;
+	}
+
+	for (i = 0; i < (frames >> 1); i++) {
+		/* Load two input frames and convert Q1.15 to Q1.31 */
+		fir_comp_setup_circular(source);
+		for (ch = 0; ch < nch; ch++) {
+			AE_L16_XC(d, x, sizeof(int16_t));
+			in0[ch] = AE_CVT32X2F16_32(d);
+		}
+		for (ch = 0; ch < nch; ch++) {
+			AE_L16_XC(d, x, sizeof(int16_t));
+			in1[ch] = AE_CVT32X2F16_32(d);
+		}
+
+		/* Compute FIR for each channel */
+		for (ch = 0; ch < nch; ch++) {
+			f = &fir[ch];
+			fir_core_setup_circular(f);
+			fir_32x16_2x_hifi3(f, in0[ch], in1[ch], &out0[ch],
+					   &out1[ch], shift[ch]);
+		}
+
+		/* Store two output frames */
+		fir_comp_setup_circular(sink);
+		for (ch = 0; ch < nch; ch++) {
+			d = AE_ROUND16X4F32SSYM(out0[ch], out0[ch]);
+			AE_S16_0_XC(d, y, sizeof(int16_t));
+		}
+		for (ch = 0; ch < nch; ch++) {
+			d = AE_ROUND16X4F32SSYM(out1[ch], out1[ch]);
+			AE_S16_0_XC(d, y, sizeof(int16_t));
+		}
+	}
+}
+
 void eq_fir_s16_hifi3(struct fir_state_32x16 fir[],
 		      const struct audio_stream *source,
 		      struct audio_stream *sink, int frames, int nch)
@@ -18,6 +18,7 @@
 #include <sof/lib/alloc.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/uuid.h>
+#include <sof/math/numbers.h>
 #include <sof/list.h>
 #include <sof/platform.h>
 #include <sof/string.h>
@@ -28,6 +29,7 @@
 #include <user/eq.h>
 #include <user/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -46,14 +48,176 @@ struct comp_data {
 	enum sof_ipc_frame sink_format;		/**< sink frame format */
 	int64_t *iir_delay;			/**< pointer to allocated RAM */
 	size_t iir_delay_size;			/**< allocated size */
+	/** shadow filters of config_new, swapped in by copy */
+	struct iir_state_df2t iir_new[PLATFORM_MAX_CHANNELS];
+	int64_t *iir_delay_new;			/**< shadow delay lines */
+	size_t iir_delay_size_new;		/**< shadow delay lines size */
+	bool swap_ready;			/**< shadow filters are set up */
+	struct sof_eq_iir_config *config_old;	/**< swapped out setup */
+	int64_t *iir_delay_old;			/**< swapped out delay lines */
 	eq_iir_func eq_iir_func;		/**< processing function */
+	uint32_t quality;			/**< requested quality level */
+	uint32_t quality_run;			/**< quality level in use */
+	bool decayed;				/**< silence, not filtering */
+	/** Q1.31 samples block for in-place filtering */
+	int32_t block[EQ_IIR_BLOCK_FRAMES * PLATFORM_MAX_CHANNELS];
 };
 
-#if CONFIG_FORMAT_S16LE
 /*
  * EQ IIR algorithm code
+ *
+ * The samples are processed in blocks of EQ_IIR_BLOCK_FRAMES frames. A
+ * block is first converted to Q1.31 into cd->block, then each channel is
+ * filtered in place with the block IIR functions and finally the block
+ * is converted to sink format.
  */
 
+static void eq_iir_block(struct comp_data *cd,
+			 const struct audio_stream *sink, int frames, int nch)
+{
+	int32_t *b = cd->block;
+	int ch;
+
+	/* channels not read by the consumer are left unfiltered */
+	for (ch = 0; ch < nch; ch++) {
+		if (!audio_stream_channel_active(sink, ch))
+			continue;
+
+		if (ch + 1 < nch && audio_stream_channel_active(sink, ch + 1)) {
+			iir_df2t_block_2x(&cd->iir[ch], &cd->iir[ch + 1],
+					  b + ch, b + ch, frames, nch);
+			ch++;
+		} else {
+			iir_df2t_block(&cd->iir[ch], b + ch, b + ch, frames,
+				       nch);
+		}
+	}
+}
+
+#if CONFIG_FORMAT_S16LE
+static void eq_iir_load_s16(const struct audio_stream *source, int16_t **src,
+			    int32_t *b, int samples)
+{
+	int16_t *x = *src;
+	int n;
+	int i;
+
+	while (samples) {
+		n = MIN(samples, audio_stream_samples_without_wrap_s16(source,
+								       x));
+		for (i = 0; i < n; i++) {
+			*b = *x << 16;
+			b++;
+			x++;
+		}
+
+		x = audio_stream_wrap(source, x);
+		samples -= n;
+	}
+
+	*src = x;
+}
+
+static void eq_iir_store_s16(struct audio_stream *sink, int16_t **snk,
+			     const int32_t *b, int samples)
+{
+	int16_t *y = *snk;
+	int n;
+	int i;
+
+	while (samples) {
+		n = MIN(samples, audio_stream_samples_without_wrap_s16(sink,
+								       y));
+		for (i = 0; i < n; i++) {
+			*y = sat_int16(Q_SHIFT_RND(*b, 31, 15));
+			b++;
+			y++;
+		}
+
+		y = audio_stream_wrap(sink, y);
+		samples -= n;
+	}
+
+	*snk = y;
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+static void eq_iir_load_s32(const struct audio_stream *source, int32_t **src,
+			    int32_t *b, int samples, int shift)
+{
+	int32_t *x = *src;
+	int n;
+	int i;
+
+	while (samples) {
+		n = MIN(samples, audio_stream_samples_without_wrap_s32(source,
+								       x));
+		for (i = 0; i < n; i++) {
+			*b = *x << shift;
+			b++;
+			x++;
+		}
+
+		x = audio_stream_wrap(source, x);
+		samples -= n;
+	}
+
+	*src = x;
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
+#if CONFIG_FORMAT_S24LE
+static void eq_iir_store_s24(struct audio_stream *sink, int32_t **snk,
+			     const int32_t *b, int samples)
+{
+	int32_t *y = *snk;
+	int n;
+	int i;
+
+	while (samples) {
+		n = MIN(samples, audio_stream_samples_without_wrap_s32(sink,
+								       y));
+		for (i = 0; i < n; i++) {
+			*y = sat_int24(Q_SHIFT_RND(*b, 31, 23));
+			b++;
+			y++;
+		}
+
+		y = audio_stream_wrap(sink, y);
+		samples -= n;
+	}
+
+	*snk = y;
+}
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+static void eq_iir_store_s32(struct audio_stream *sink, int32_t **snk,
+			     const int32_t *b, int samples)
+{
+	int32_t *y = *snk;
+	int n;
+	int i;
+
+	while (samples) {
+		n = MIN(samples, audio_stream_samples_without_wrap_s32(sink,
+								       y));
+		for (i = 0; i < n; i++) {
+			*y = *b;
+			b++;
+			y++;
+		}
+
+		y = audio_stream_wrap(sink, y);
+		samples -= n;
+	}
+
+	*snk = y;
+}
+#endif /* CONFIG_FORMAT_S32LE */
+
+#if CONFIG_FORMAT_S16LE
 static void eq_iir_s16_default(const struct comp_dev *dev,
 			       const struct audio_stream *source,
 			       struct audio_stream *sink,
@@ -61,25 +225,17 @@ static void eq_iir_s16_default(const struct comp_dev *dev,
 
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct iir_state_df2t *filter;
-	int16_t *x;
-	int16_t *y;
-	int32_t z;
-	int ch;
-	int i;
-	int idx;
+	int16_t *x = source->r_ptr;
+	int16_t *y = sink->w_ptr;
 	int nch = source->channels;
-
-	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s16(source, idx);
-			y = audio_stream_write_frag_s16(sink, idx);
-			z = iir_df2t(filter, *x << 16);
-			*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
-			idx += nch;
-		}
+	int n;
+
+	while (frames) {
+		n = MIN(frames, EQ_IIR_BLOCK_FRAMES);
+		eq_iir_load_s16(source, &x, cd->block, n * nch);
+		eq_iir_block(cd, sink, n, nch);
+		eq_iir_store_s16(sink, &y, cd->block, n * nch);
+		frames -= n;
 	}
 }
 #endif /* CONFIG_FORMAT_S16LE */
@@ -92,25 +248,17 @@ static void eq_iir_s24_default(const struct comp_dev *dev,
 
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct iir_state_df2t *filter;
-	int32_t *x;
-	int32_t *y;
-	int32_t z;
-	int idx;
-	int ch;
-	int i;
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
 	int nch = source->channels;
-
-	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_write_frag_s32(sink, idx);
-			z = iir_df2t(filter, *x << 8);
-			*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
-			idx += nch;
-		}
+	int n;
+
+	while (frames) {
+		n = MIN(frames, EQ_IIR_BLOCK_FRAMES);
+		eq_iir_load_s32(source, &x, cd->block, n * nch, 8);
+		eq_iir_block(cd, sink, n, nch);
+		eq_iir_store_s24(sink, &y, cd->block, n * nch);
+		frames -= n;
 	}
 }
 #endif /* CONFIG_FORMAT_S24LE */
@@ -123,23 +271,17 @@ static void eq_iir_s32_default(const struct comp_dev *dev,
 
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct iir_state_df2t *filter;
-	int32_t *x;
-	int32_t *y;
-	int idx;
-	int ch;
-	int i;
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
 	int nch = source->channels;
-
-	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_write_frag_s32(sink, idx);
-			*y = iir_df2t(filter, *x);
-			idx += nch;
-		}
+	int n;
+
+	while (frames) {
+		n = MIN(frames, EQ_IIR_BLOCK_FRAMES);
+		eq_iir_load_s32(source, &x, cd->block, n * nch, 0);
+		eq_iir_block(cd, sink, n, nch);
+		eq_iir_store_s32(sink, &y, cd->block, n * nch);
+		frames -= n;
 	}
 }
 #endif /* CONFIG_FORMAT_S32LE */
@@ -152,25 +294,17 @@ static void eq_iir_s32_16_default(const struct comp_dev *dev,
 
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct iir_state_df2t *filter;
-	int32_t *x;
-	int16_t *y;
-	int32_t z;
-	int idx;
-	int ch;
-	int i;
+	int32_t *x = source->r_ptr;
+	int16_t *y = sink->w_ptr;
 	int nch = source->channels;
-
-	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_write_frag_s16(sink, idx);
-			z = iir_df2t(filter, *x);
-			*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
-			idx += nch;
-		}
+	int n;
+
+	while (frames) {
+		n = MIN(frames, EQ_IIR_BLOCK_FRAMES);
+		eq_iir_load_s32(source, &x, cd->block, n * nch, 0);
+		eq_iir_block(cd, sink, n, nch);
+		eq_iir_store_s16(sink, &y, cd->block, n * nch);
+		frames -= n;
 	}
 }
 #endif /* CONFIG_FORMAT_S32LE && CONFIG_FORMAT_S16LE */
@@ -183,25 +317,17 @@ static void eq_iir_s32_24_default(const struct comp_dev *dev,
 
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	struct iir_state_df2t *filter;
-	int32_t *x;
-	int32_t *y;
-	int32_t z;
-	int idx;
-	int ch;
-	int i;
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
 	int nch = source->channels;
-
-	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
-		idx = ch;
-		for (i = 0; i < frames; i++) {
-			x = audio_stream_read_frag_s32(source, idx);
-			y = audio_stream_write_frag_s32(sink, idx);
-			z = iir_df2t(filter, *x);
-			*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
-			idx += nch;
-		}
+	int n;
+
+	while (frames) {
+		n = MIN(frames, EQ_IIR_BLOCK_FRAMES);
+		eq_iir_load_s32(source, &x, cd->block, n * nch, 0);
+		eq_iir_block(cd, sink, n, nch);
+		eq_iir_store_s24(sink, &y, cd->block, n * nch);
+		frames -= n;
 	}
 }
 #endif /* CONFIG_FORMAT_S32LE && CONFIG_FORMAT_S24LE */
@@ -461,15 +587,18 @@ static void eq_iir_init_delay(struct iir_state_df2t *iir,
 	}
 }
 
-static int eq_iir_setup(struct comp_data *cd, int nch)
+/* Sets up filters of all channels from config with delay lines in a new
+ * chunk returned in delay. Returns size of the chunk or error code.
+ */
+static int eq_iir_init(struct sof_eq_iir_config *config,
+		       struct iir_state_df2t *iir, int64_t **delay, int nch)
 {
 	int delay_size;
 
-	/* Free existing IIR channels data if it was allocated */
-	eq_iir_free_delaylines(cd);
+	*delay = NULL;
 
 	/* Set coefficients for each channel EQ from coefficient blob */
-	delay_size = eq_iir_init_coef(cd->config, cd->iir, nch);
+	delay_size = eq_iir_init_coef(config, iir, nch);
 	if (delay_size < 0)
 		return delay_size; /* Contains error code */
 
@@ -480,21 +609,114 @@ static int eq_iir_setup(struct comp_data *cd, int nch)
 		return 0;
 
 	/* Allocate all IIR channels data in a big chunk and clear it */
-	cd->iir_delay = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-				delay_size);
-	if (!cd->iir_delay) {
-		comp_cl_err(&comp_eq_iir, "eq_iir_setup(), delay allocation fail");
+	*delay = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			 delay_size);
+	if (!*delay) {
+		comp_cl_err(&comp_eq_iir, "eq_iir_init(), delay allocation fail");
 		return -ENOMEM;
 	}
 
-	memset(cd->iir_delay, 0, delay_size);
-	cd->iir_delay_size = delay_size;
+	memset(*delay, 0, delay_size);
 
 	/* Assign delay line to each channel EQ */
-	eq_iir_init_delay(cd->iir, cd->iir_delay, nch);
+	eq_iir_init_delay(iir, *delay, nch);
+	return delay_size;
+}
+
+static int eq_iir_setup(struct comp_data *cd, int nch)
+{
+	int delay_size;
+
+	/* Free existing IIR channels data if it was allocated */
+	eq_iir_free_delaylines(cd);
+
+	delay_size = eq_iir_init(cd->config, cd->iir, &cd->iir_delay, nch);
+	if (delay_size < 0)
+		return delay_size;
+
+	cd->iir_delay_size = delay_size;
+	return 0;
+}
+
+/* Sets up filters of a configuration received while processing in the
+ * IPC thread, so copy only has to swap them in between two periods.
+ */
+static int eq_iir_shadow_setup(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+	int delay_size;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	memset(cd->iir_new, 0, sizeof(cd->iir_new));
+	delay_size = eq_iir_init(cd->config_new, cd->iir_new,
+				 &cd->iir_delay_new, sourceb->stream.channels);
+	if (delay_size < 0)
+		return delay_size;
+
+	cd->iir_delay_size_new = delay_size;
+
+	/* copy takes the filters only once they are complete */
+	cd->swap_ready = true;
+
 	return 0;
 }
 
+/* Takes shadow filters in use. Filter state is kept if all channels have
+ * the same sections, so tuning a response doesn't restart it. Replaced
+ * filters are freed later by IPC, not in the audio thread.
+ */
+static void eq_iir_swap(struct comp_data *cd)
+{
+	bool keep = cd->iir_delay && cd->iir_delay_new &&
+		cd->iir_delay_size == cd->iir_delay_size_new;
+	int ret;
+	int i;
+
+	for (i = 0; i < PLATFORM_MAX_CHANNELS && keep; i++)
+		keep = cd->iir[i].biquads == cd->iir_new[i].biquads &&
+			cd->iir[i].biquads_in_series ==
+			cd->iir_new[i].biquads_in_series;
+
+	if (keep) {
+		ret = memcpy_s(cd->iir_delay_new, cd->iir_delay_size_new,
+			       cd->iir_delay, cd->iir_delay_size);
+		assert(!ret);
+	}
+
+	ret = memcpy_s(cd->iir, sizeof(cd->iir), cd->iir_new,
+		       sizeof(cd->iir_new));
+	assert(!ret);
+
+	cd->config_old = cd->config;
+	cd->iir_delay_old = cd->iir_delay;
+	cd->config = cd->config_new;
+	cd->iir_delay = cd->iir_delay_new;
+	cd->iir_delay_size = cd->iir_delay_size_new;
+	cd->config_new = NULL;
+	cd->iir_delay_new = NULL;
+	cd->swap_ready = false;
+}
+
+/* frees filters replaced by the last swap */
+static void eq_iir_free_old(struct comp_data *cd)
+{
+	eq_iir_free_parameters(&cd->config_old);
+	rfree(cd->iir_delay_old);
+	cd->iir_delay_old = NULL;
+}
+
+/* drops shadow filters not taken in use */
+static void eq_iir_free_shadow(struct comp_data *cd)
+{
+	rfree(cd->iir_delay_new);
+	cd->iir_delay_new = NULL;
+	cd->iir_delay_size_new = 0;
+	cd->swap_ready = false;
+}
+
 /*
  * End of EQ setup code. Next the standard component methods.
  */
@@ -579,6 +801,8 @@ static void eq_iir_free(struct comp_dev *dev)
 	comp_info(dev, "eq_iir_free()");
 
 	eq_iir_free_delaylines(cd);
+	eq_iir_free_shadow(cd);
+	eq_iir_free_old(cd);
 	eq_iir_free_parameters(&cd->config);
 	eq_iir_free_parameters(&cd->config_new);
 
@@ -622,6 +846,15 @@ static int eq_iir_verify_params(struct comp_dev *dev,
 	return 0;
 }
 
+/* conversion is done by the IIR filter functions */
+static bool eq_iir_frame_fmt_supported(struct comp_dev *dev,
+				       enum sof_ipc_frame source,
+				       enum sof_ipc_frame sink)
+{
+	return eq_iir_find_func(source, sink, fm_configured,
+				ARRAY_SIZE(fm_configured)) != NULL;
+}
+
 /* set component audio stream parameters */
 static int eq_iir_params(struct comp_dev *dev,
 			 struct sof_ipc_stream_params *params)
@@ -707,6 +940,8 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 			return -EBUSY;
 		}
 
+		eq_iir_free_old(cd);
+
 		/* Allocate and make a copy of the blob and setup IIR */
 		cd->config_new = rzalloc(SOF_MEM_ZONE_RUNTIME, 0,
 					 SOF_MEM_CAPS_RAM, bs);
@@ -722,8 +957,8 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 		assert(!ret);
 
 		/* If component state is READY we can omit old configuration
-		 * immediately. When in playback/capture the new configuration
-		 * presence is checked in copy().
+		 * immediately. When in playback/capture the new filters are
+		 * set up here and swapped in by copy().
 		 */
 		if (dev->state ==  COMP_STATE_READY)
 			eq_iir_free_parameters(&cd->config);
@@ -735,6 +970,14 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 		if (!cd->config) {
 			cd->config = cd->config_new;
 			cd->config_new = NULL;
+			break;
+		}
+
+		ret = eq_iir_shadow_setup(dev);
+		if (ret < 0) {
+			comp_err(dev, "iir_cmd_set_data(), failed IIR setup");
+			eq_iir_free_shadow(cd);
+			eq_iir_free_parameters(&cd->config_new);
 		}
 
 		break;
@@ -788,10 +1031,33 @@ static void eq_iir_process(struct comp_dev *dev, struct comp_buffer *source,
 			   uint32_t source_bytes, uint32_t sink_bytes)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
+	bool silence = buffer_is_silent(source);
+
+	if (!silence)
+		cd->decayed = false;
 
-	buffer_invalidate(source, source_bytes);
+	if (cd->decayed) {
+		audio_stream_set_zero(&sink->stream, sink_bytes);
+	} else {
+		buffer_invalidate(source, source_bytes);
 
-	cd->eq_iir_func(dev, &source->stream, &sink->stream, frames);
+		cd->eq_iir_func(dev, &source->stream, &sink->stream, frames);
+
+		/* Filters run on silence until their tail is below one LSB
+		 * for a whole period. Delay lines are then cleared not to
+		 * hold a limit cycle and silence is passed on for free.
+		 */
+		if (silence && audio_stream_is_zero(&sink->stream,
+						    sink->stream.w_ptr,
+						    sink_bytes)) {
+			if (cd->iir_delay)
+				memset(cd->iir_delay, 0, cd->iir_delay_size);
+			cd->decayed = true;
+		}
+	}
+
+	if (cd->decayed)
+		buffer_mark_silence(sink);
 
 	buffer_writeback(sink, sink_bytes);
 
@@ -800,6 +1066,56 @@ static void eq_iir_process(struct comp_dev *dev, struct comp_buffer *source,
 	comp_update_buffer_produce(sink, sink_bytes);
 }
 
+/* switches to configuration received since the last copy */
+/* switches between filtering and pass-through between blocks */
+static void eq_iir_quality_update(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	bool bypass = cd->quality >= COMP_QUALITY_BYPASS;
+	eq_iir_func func;
+
+	cd->quality_run = cd->quality;
+
+	if (!cd->config)
+		return;
+
+	if (bypass)
+		func = eq_iir_find_func(cd->source_format, cd->sink_format,
+					fm_passthrough,
+					ARRAY_SIZE(fm_passthrough));
+	else
+		func = eq_iir_find_func(cd->source_format, cd->sink_format,
+					fm_configured,
+					ARRAY_SIZE(fm_configured));
+	if (!func || func == cd->eq_iir_func)
+		return;
+
+	/* filters restart from silence instead of stale history */
+	if (!bypass && cd->iir_delay)
+		memset(cd->iir_delay, 0, cd->iir_delay_size);
+
+	cd->eq_iir_func = func;
+}
+
+/* process stream data only, used when chained by the pipeline */
+static int eq_iir_process_stream(struct comp_dev *dev,
+				 const struct audio_stream *source,
+				 struct audio_stream *sink, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	/* Check for changed configuration */
+	if (cd->swap_ready)
+		eq_iir_swap(cd);
+
+	if (cd->quality != cd->quality_run)
+		eq_iir_quality_update(dev);
+
+	cd->eq_iir_func(dev, source, sink, frames);
+
+	return 0;
+}
+
 /* copy and process stream data from source to sink buffers */
 static int eq_iir_copy(struct comp_dev *dev)
 {
@@ -807,7 +1123,6 @@ static int eq_iir_copy(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *sourceb;
 	struct comp_buffer *sinkb;
-	int ret;
 	uint32_t flags = 0;
 
 	comp_dbg(dev, "eq_iir_copy()");
@@ -816,16 +1131,11 @@ static int eq_iir_copy(struct comp_dev *dev)
 				  sink_list);
 
 	/* Check for changed configuration */
-	if (cd->config_new) {
-		eq_iir_free_parameters(&cd->config);
-		cd->config = cd->config_new;
-		cd->config_new = NULL;
-		ret = eq_iir_setup(cd, sourceb->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "eq_iir_copy(), failed IIR setup");
-			return ret;
-		}
-	}
+	if (cd->swap_ready)
+		eq_iir_swap(cd);
+
+	if (cd->quality != cd->quality_run)
+		eq_iir_quality_update(dev);
 
 	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
 				source_list);
@@ -916,6 +1226,9 @@ static int eq_iir_prepare(struct comp_dev *dev)
 		}
 		comp_info(dev, "eq_iir_prepare(), pass-through mode.");
 	}
+
+	/* requested quality is taken in use again by the first copy */
+	cd->quality_run = COMP_QUALITY_FULL;
 	return 0;
 
 err:
@@ -931,8 +1244,20 @@ static int eq_iir_reset(struct comp_dev *dev)
 	comp_info(dev, "eq_iir_reset()");
 
 	eq_iir_free_delaylines(cd);
+	eq_iir_free_old(cd);
+
+	/* configuration not swapped in yet is set up again by prepare */
+	if (cd->swap_ready) {
+		eq_iir_free_shadow(cd);
+		eq_iir_free_parameters(&cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
 
 	cd->eq_iir_func = NULL;
+	cd->quality = COMP_QUALITY_FULL;
+	cd->quality_run = COMP_QUALITY_FULL;
+	cd->decayed = false;
 	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
 		iir_reset_df2t(&cd->iir[i]);
 
@@ -940,18 +1265,40 @@ static int eq_iir_reset(struct comp_dev *dev)
 	return 0;
 }
 
+/* IIR has no cheaper filtering, so lower quality levels keep it full */
+static int eq_iir_set_attribute(struct comp_dev *dev, uint32_t type,
+				void *value)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (type != COMP_ATTR_QUALITY)
+		return -EINVAL;
+
+	comp_info(dev, "eq_iir_set_attribute(), quality %u",
+		  *(uint32_t *)value);
+
+	/* taken in use by the next copy */
+	cd->quality = *(uint32_t *)value;
+
+	return 0;
+}
+
 static const struct comp_driver comp_eq_iir = {
 	.type = SOF_COMP_EQ_IIR,
 	.uid = SOF_UUID(eq_iir_uuid),
+	.flags = COMP_DRV_INPLACE | COMP_DRV_CHANNEL_WISE,
 	.ops = {
 		.create = eq_iir_new,
 		.free = eq_iir_free,
 		.params = eq_iir_params,
+		.frame_fmt_supported = eq_iir_frame_fmt_supported,
 		.cmd = eq_iir_cmd,
 		.trigger = eq_iir_trigger,
 		.copy = eq_iir_copy,
+		.process = eq_iir_process_stream,
 		.prepare = eq_iir_prepare,
 		.reset = eq_iir_reset,
+		.set_attribute = eq_iir_set_attribute,
 	},
 };
 
@@ -104,5 +104,98 @@ int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x)
 	return out;
 }
 
+
+/* Block version of the filter, each biquad is run over all the frames
+ * before proceeding to the next one, so the coefficients and the delay
+ * line state stay in local variables. The input and output are Q1.31
+ * samples spaced with stride, and they may point to the same data for
+ * in-place processing.
+ */
+void iir_df2t_block(struct iir_state_df2t *iir, const int32_t *in,
+		    int32_t *out, int frames, int stride)
+{
+	const int32_t *x = in;
+	int32_t *y = out;
+	int32_t *coef = iir->coef;
+	int64_t *delay = iir->delay;
+	int64_t acc;
+	int64_t d0;
+	int64_t d1;
+	int32_t tmp;
+	int32_t s;
+	int shift;
+	int idx;
+	int i;
+	int j;
+
+	/* Parallel sections need the unmodified input for each branch, so
+	 * they are processed sample by sample.
+	 */
+	if (iir->biquads != iir->biquads_in_series) {
+		for (i = 0; i < frames; i++) {
+			*y = iir_df2t(iir, *x);
+			x += stride;
+			y += stride;
+		}
+		return;
+	}
+
+	/* Bypass is set with number of biquads set to zero. */
+	if (!iir->biquads) {
+		if (in != out) {
+			for (i = 0; i < frames; i++) {
+				*y = *x;
+				x += stride;
+				y += stride;
+			}
+		}
+		return;
+	}
+
+	/* Coefficients order in coef[] is {a2, a1, b2, b1, b0, shift, gain} */
+	for (j = 0; j < iir->biquads; j++) {
+		d0 = delay[0];
+		d1 = delay[1];
+		shift = 45 + coef[5];
+		idx = 0;
+		for (i = 0; i < frames; i++) {
+			s = x[idx];
+			acc = ((int64_t)coef[4]) * s + d0; /* Coef b0 */
+			tmp = (int32_t)Q_SHIFT_RND(acc, 61, 31);
+			d0 = d1 + ((int64_t)coef[3]) * s; /* Coef b1 */
+			d0 += ((int64_t)coef[1]) * tmp; /* Coef a1 */
+			d1 = ((int64_t)coef[2]) * s; /* Coef b2 */
+			d1 += ((int64_t)coef[0]) * tmp; /* Coef a2 */
+			acc = ((int64_t)coef[6]) * tmp; /* Gain */
+			y[idx] = sat_int32(Q_SHIFT_RND(acc, shift, 31));
+			idx += stride;
+		}
+
+		delay[0] = d0;
+		delay[1] = d1;
+
+		/* Next biquad processes the output of this one in place */
+		x = out;
+		coef += SOF_EQ_IIR_NBIQUAD_DF2T;
+		delay += IIR_DF2T_NUM_DELAYS;
+	}
+}
+
+#if !IIR_X86
+
+/* Two channels version for adjacent interleaved channels. The generic
+ * code has no benefit from mixing the channels so just run the channels
+ * one after another.
+ */
+void iir_df2t_block_2x(struct iir_state_df2t *iir0,
+		       struct iir_state_df2t *iir1, const int32_t *in,
+		       int32_t *out, int frames, int stride)
+{
+	iir_df2t_block(iir0, in, out, frames, stride);
+	iir_df2t_block(iir1, in + 1, out + 1, frames, stride);
+}
+
+#endif /* !IIR_X86 */
+
 #endif
 
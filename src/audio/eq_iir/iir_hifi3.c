@@ -131,4 +131,247 @@ int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x)
 	return out;
 }
 
+
+/* Block version of the filter, each biquad is run over all the frames
+ * before proceeding to the next one, so the coefficients and the delay
+ * line state are loaded into registers once per block. The input and
+ * output are Q1.31 samples spaced with stride, and they may point to the
+ * same data for in-place processing.
+ */
+void iir_df2t_block(struct iir_state_df2t *iir, const int32_t *in,
+		    int32_t *out, int frames, int stride)
+{
+	ae_f64 acc;
+	ae_f64 d0;
+	ae_f64 d1;
+	ae_valign align;
+	ae_f32x2 coef_a2a1;
+	ae_f32x2 coef_b2b1;
+	ae_f32x2 coef_b0shift;
+	ae_f32x2 gain;
+	ae_f32 x;
+	ae_f32 tmp;
+	ae_f32x2 *coefp;
+	ae_f64 *delayp;
+	const int32_t *src = in;
+	int32_t *dst;
+	int shift;
+	int i;
+	int j;
+
+	/* Parallel sections need the unmodified input for each branch, so
+	 * they are processed sample by sample.
+	 */
+	if (iir->biquads != iir->biquads_in_series) {
+		dst = out;
+		for (i = 0; i < frames; i++) {
+			*dst = iir_df2t(iir, *src);
+			src += stride;
+			dst += stride;
+		}
+		return;
+	}
+
+	/* Bypass is set with number of biquads set to zero. */
+	if (!iir->biquads) {
+		dst = out;
+		if (in != out) {
+			for (i = 0; i < frames; i++) {
+				*dst = *src;
+				src += stride;
+				dst += stride;
+			}
+		}
+		return;
+	}
+
+	/* Coefficients order in coef[] is {a2, a1, b2, b1, b0, shift, gain} */
+	coefp = (ae_f32x2 *)&iir->coef[0];
+	delayp = (ae_f64 *)&iir->delay[0];
+	for (j = 0; j < iir->biquads; j++) {
+		align = AE_LA64_PP(coefp);
+		AE_LA32X2_IP(coef_a2a1, align, coefp);
+		AE_LA32X2_IP(coef_b2b1, align, coefp);
+		AE_LA32X2_IP(coef_b0shift, align, coefp);
+		AE_LA32X2_IP(gain, align, coefp);
+		shift = AE_SEL32_LL(coef_b0shift, coef_b0shift);
+		d0 = delayp[0];
+		d1 = delayp[1];
+
+		dst = out;
+		for (i = 0; i < frames; i++) {
+			x = *src;
+
+			/* Compute output, see iir_df2t() for the alignment
+			 * of delay line values.
+			 */
+			acc = AE_SRAI64(d0, 1);
+			AE_MULAF32R_HH(acc, coef_b0shift, x); /* Coef b0 */
+			acc = AE_SLAI64S(acc, 1);
+			tmp = AE_ROUND32F48SSYM(acc);
+
+			/* Compute delay d0 */
+			acc = AE_SRAI64(d1, 1);
+			AE_MULAF32R_LL(acc, coef_b2b1, x); /* Coef b1 */
+			AE_MULAF32R_LL(acc, coef_a2a1, tmp); /* Coef a1 */
+			d0 = AE_SLAI64S(acc, 1);
+
+			/* Compute delay d1 */
+			acc = AE_MULF32R_HH(coef_b2b1, x); /* Coef b2 */
+			AE_MULAF32R_HH(acc, coef_a2a1, tmp); /* Coef a2 */
+			d1 = AE_SLAI64S(acc, 1);
+
+			/* Apply gain and biquad output shift, round and
+			 * saturate to Q1.31.
+			 */
+			acc = AE_MULF32R_HH(gain, tmp); /* Gain */
+			acc = AE_SLAI64S(acc, 17);
+			acc = AE_SRAA64(acc, shift);
+			*dst = AE_ROUND32F48SSYM(acc);
+
+			src += stride;
+			dst += stride;
+		}
+
+		/* Store state, next biquad processes the output of this
+		 * one in place. The coefp needs rewind by one int32_t due to
+		 * odd number of words in coefficient block.
+		 */
+		delayp[0] = d0;
+		delayp[1] = d1;
+		delayp += IIR_DF2T_NUM_DELAYS;
+		coefp = (ae_f32x2 *)((int32_t *)coefp - 1);
+		src = out;
+	}
+}
+
+/* Two channels version for adjacent interleaved channels. The biquads of
+ * both channels are computed in the same loop, so the two independent
+ * chains of multiply-accumulates can be scheduled in parallel. If the
+ * channels don't have the same single series structure they are run one
+ * after another.
+ */
+void iir_df2t_block_2x(struct iir_state_df2t *iir0,
+		       struct iir_state_df2t *iir1, const int32_t *in,
+		       int32_t *out, int frames, int stride)
+{
+	ae_f64 acc0;
+	ae_f64 acc1;
+	ae_f64 d00;
+	ae_f64 d01;
+	ae_f64 d10;
+	ae_f64 d11;
+	ae_valign align;
+	ae_f32x2 coef0_a2a1;
+	ae_f32x2 coef0_b2b1;
+	ae_f32x2 coef0_b0shift;
+	ae_f32x2 gain0;
+	ae_f32x2 coef1_a2a1;
+	ae_f32x2 coef1_b2b1;
+	ae_f32x2 coef1_b0shift;
+	ae_f32x2 gain1;
+	ae_f32 x0;
+	ae_f32 x1;
+	ae_f32 tmp0;
+	ae_f32 tmp1;
+	ae_f32x2 *coefp0;
+	ae_f32x2 *coefp1;
+	ae_f64 *delayp0;
+	ae_f64 *delayp1;
+	const int32_t *src = in;
+	int32_t *dst;
+	int shift0;
+	int shift1;
+	int i;
+	int j;
+
+	if (!iir0->biquads || iir0->biquads != iir1->biquads ||
+	    iir0->biquads != iir0->biquads_in_series ||
+	    iir1->biquads != iir1->biquads_in_series) {
+		iir_df2t_block(iir0, in, out, frames, stride);
+		iir_df2t_block(iir1, in + 1, out + 1, frames, stride);
+		return;
+	}
+
+	coefp0 = (ae_f32x2 *)&iir0->coef[0];
+	coefp1 = (ae_f32x2 *)&iir1->coef[0];
+	delayp0 = (ae_f64 *)&iir0->delay[0];
+	delayp1 = (ae_f64 *)&iir1->delay[0];
+	for (j = 0; j < iir0->biquads; j++) {
+		align = AE_LA64_PP(coefp0);
+		AE_LA32X2_IP(coef0_a2a1, align, coefp0);
+		AE_LA32X2_IP(coef0_b2b1, align, coefp0);
+		AE_LA32X2_IP(coef0_b0shift, align, coefp0);
+		AE_LA32X2_IP(gain0, align, coefp0);
+		align = AE_LA64_PP(coefp1);
+		AE_LA32X2_IP(coef1_a2a1, align, coefp1);
+		AE_LA32X2_IP(coef1_b2b1, align, coefp1);
+		AE_LA32X2_IP(coef1_b0shift, align, coefp1);
+		AE_LA32X2_IP(gain1, align, coefp1);
+		shift0 = AE_SEL32_LL(coef0_b0shift, coef0_b0shift);
+		shift1 = AE_SEL32_LL(coef1_b0shift, coef1_b0shift);
+		d00 = delayp0[0];
+		d01 = delayp0[1];
+		d10 = delayp1[0];
+		d11 = delayp1[1];
+
+		dst = out;
+		for (i = 0; i < frames; i++) {
+			x0 = src[0];
+			x1 = src[1];
+
+			/* Compute outputs */
+			acc0 = AE_SRAI64(d00, 1);
+			acc1 = AE_SRAI64(d10, 1);
+			AE_MULAF32R_HH(acc0, coef0_b0shift, x0);
+			AE_MULAF32R_HH(acc1, coef1_b0shift, x1);
+			acc0 = AE_SLAI64S(acc0, 1);
+			acc1 = AE_SLAI64S(acc1, 1);
+			tmp0 = AE_ROUND32F48SSYM(acc0);
+			tmp1 = AE_ROUND32F48SSYM(acc1);
+
+			/* Compute delays d0 */
+			acc0 = AE_SRAI64(d01, 1);
+			acc1 = AE_SRAI64(d11, 1);
+			AE_MULAF32R_LL(acc0, coef0_b2b1, x0);
+			AE_MULAF32R_LL(acc1, coef1_b2b1, x1);
+			AE_MULAF32R_LL(acc0, coef0_a2a1, tmp0);
+			AE_MULAF32R_LL(acc1, coef1_a2a1, tmp1);
+			d00 = AE_SLAI64S(acc0, 1);
+			d10 = AE_SLAI64S(acc1, 1);
+
+			/* Compute delays d1 */
+			acc0 = AE_MULF32R_HH(coef0_b2b1, x0);
+			acc1 = AE_MULF32R_HH(coef1_b2b1, x1);
+			AE_MULAF32R_HH(acc0, coef0_a2a1, tmp0);
+			AE_MULAF32R_HH(acc1, coef1_a2a1, tmp1);
+			d01 = AE_SLAI64S(acc0, 1);
+			d11 = AE_SLAI64S(acc1, 1);
+
+			/* Apply gains and output shifts */
+			acc0 = AE_MULF32R_HH(gain0, tmp0);
+			acc1 = AE_MULF32R_HH(gain1, tmp1);
+			acc0 = AE_SLAI64S(acc0, 17);
+			acc1 = AE_SLAI64S(acc1, 17);
+			acc0 = AE_SRAA64(acc0, shift0);
+			acc1 = AE_SRAA64(acc1, shift1);
+			dst[0] = AE_ROUND32F48SSYM(acc0);
+			dst[1] = AE_ROUND32F48SSYM(acc1);
+
+			src += stride;
+			dst += stride;
+		}
+
+		delayp0[0] = d00;
+		delayp0[1] = d01;
+		delayp1[0] = d10;
+		delayp1[1] = d11;
+		delayp0 += IIR_DF2T_NUM_DELAYS;
+		delayp1 += IIR_DF2T_NUM_DELAYS;
+		coefp0 = (ae_f32x2 *)((int32_t *)coefp0 - 1);
+		coefp1 = (ae_f32x2 *)((int32_t *)coefp1 - 1);
+		src = out;
+	}
+}
+
 #endif
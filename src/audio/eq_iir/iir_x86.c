@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/eq_iir/iir.h>
+#include <sof/audio/format.h>
+#include <user/eq.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if IIR_X86
+
+#include <immintrin.h>
+
+/* SSE4.2 version of the two channels block filter for host builds. The
+ * biquads of both channels run in the two 64 bit lanes of a vector. The
+ * products, delays and roundings are calculated exactly as in the generic
+ * version, so the output is bit exact with it.
+ */
+
+/* Arithmetic shift right of 64 bit lanes by per lane amounts */
+static inline __m128i iir_srav_epi64(__m128i x, __m128i shift)
+{
+	__m128i sign = _mm_cmpgt_epi64(_mm_setzero_si128(), x);
+
+	x = _mm_xor_si128(x, sign);
+#if defined(__AVX2__)
+	x = _mm_srlv_epi64(x, shift);
+#else
+	x = _mm_blend_epi16(_mm_srl_epi64(x, shift),
+			    _mm_srl_epi64(x, _mm_unpackhi_epi64(shift, shift)),
+			    0xf0);
+#endif
+	return _mm_xor_si128(x, sign);
+}
+
+/* Saturates 64 bit lanes to 32 bits and packs them to the low half */
+static inline __m128i iir_sat_int32(__m128i x)
+{
+	const __m128i max = _mm_set1_epi64x(INT32_MAX);
+	const __m128i min = _mm_set1_epi64x(INT32_MIN);
+
+	x = _mm_blendv_epi8(x, max, _mm_cmpgt_epi64(x, max));
+	x = _mm_blendv_epi8(x, min, _mm_cmpgt_epi64(min, x));
+	return _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+void iir_df2t_block_2x(struct iir_state_df2t *iir0,
+		       struct iir_state_df2t *iir1, const int32_t *in,
+		       int32_t *out, int frames, int stride)
+{
+	const int32_t *x = in;
+	int32_t *coef0 = iir0->coef;
+	int32_t *coef1 = iir1->coef;
+	int64_t *delay0 = iir0->delay;
+	int64_t *delay1 = iir1->delay;
+	__m128i a2;
+	__m128i a1;
+	__m128i b2;
+	__m128i b1;
+	__m128i b0;
+	__m128i gain;
+	__m128i shift;
+	__m128i rnd;
+	__m128i acc;
+	__m128i d0;
+	__m128i d1;
+	__m128i tmp;
+	__m128i s;
+	int idx;
+	int i;
+	int j;
+
+	/* Parallel sections and different filters are run per channel */
+	if (!iir0->biquads || iir0->biquads != iir1->biquads ||
+	    iir0->biquads != iir0->biquads_in_series ||
+	    iir1->biquads != iir1->biquads_in_series) {
+		iir_df2t_block(iir0, in, out, frames, stride);
+		iir_df2t_block(iir1, in + 1, out + 1, frames, stride);
+		return;
+	}
+
+	/* Coefficients order in coef[] is {a2, a1, b2, b1, b0, shift, gain} */
+	for (j = 0; j < iir0->biquads; j++) {
+		a2 = _mm_set_epi64x(coef1[0], coef0[0]);
+		a1 = _mm_set_epi64x(coef1[1], coef0[1]);
+		b2 = _mm_set_epi64x(coef1[2], coef0[2]);
+		b1 = _mm_set_epi64x(coef1[3], coef0[3]);
+		b0 = _mm_set_epi64x(coef1[4], coef0[4]);
+		gain = _mm_set_epi64x(coef1[6], coef0[6]);
+
+		/* Q_SHIFT_RND(acc, 45 + shift, 31) done as one shift after
+		 * adding the half LSB.
+		 */
+		shift = _mm_set_epi64x(14 + coef1[5], 14 + coef0[5]);
+		rnd = _mm_set_epi64x(1LL << (13 + coef1[5]),
+				     1LL << (13 + coef0[5]));
+
+		d0 = _mm_set_epi64x(delay1[0], delay0[0]);
+		d1 = _mm_set_epi64x(delay1[1], delay0[1]);
+		idx = 0;
+		for (i = 0; i < frames; i++) {
+			s = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i *)
+							       &x[idx]));
+
+			/* Only the low 32 bits of tmp are used so the shift
+			 * does not need to be arithmetic.
+			 */
+			acc = _mm_add_epi64(_mm_mul_epi32(b0, s), d0);
+			tmp = _mm_srli_epi64(acc, 29);
+			tmp = _mm_srli_epi64(_mm_add_epi64(tmp,
+							   _mm_set1_epi64x(1)),
+					     1);
+
+			d0 = _mm_add_epi64(d1, _mm_mul_epi32(b1, s));
+			d0 = _mm_add_epi64(d0, _mm_mul_epi32(a1, tmp));
+			d1 = _mm_add_epi64(_mm_mul_epi32(b2, s),
+					   _mm_mul_epi32(a2, tmp));
+
+			acc = _mm_add_epi64(_mm_mul_epi32(gain, tmp), rnd);
+			acc = iir_sat_int32(iir_srav_epi64(acc, shift));
+			_mm_storel_epi64((__m128i *)&out[idx], acc);
+			idx += stride;
+		}
+
+		delay0[0] = _mm_cvtsi128_si64(d0);
+		delay1[0] = _mm_extract_epi64(d0, 1);
+		delay0[1] = _mm_cvtsi128_si64(d1);
+		delay1[1] = _mm_extract_epi64(d1, 1);
+
+		/* Next biquad processes the output of this one in place */
+		x = out;
+		coef0 += SOF_EQ_IIR_NBIQUAD_DF2T;
+		coef1 += SOF_EQ_IIR_NBIQUAD_DF2T;
+		delay0 += IIR_DF2T_NUM_DELAYS;
+		delay1 += IIR_DF2T_NUM_DELAYS;
+	}
+}
+
+#endif
@@ -13,6 +13,7 @@
 #include <sof/debug/panic.h>
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/memory.h>
@@ -45,6 +46,35 @@ struct hc_buf {
 	uint32_t current_end;
 };
 
+/*
+ * Playback host components of several pipelines sharing one host DMA
+ * channel. The DMA carries frames of struct sof_ipc_stream_mux_hdr, each
+ * followed by the payload of one member, which a running member copying
+ * for all of them moves into the local buffers of the members.
+ */
+struct host_mux_group {
+	struct list_item list;		/* in host_mux_group_list */
+	uint16_t stream_tag;
+	uint16_t pcms;			/* members announced by the host */
+	uint32_t count;			/* members joined */
+	uint32_t core;
+	struct dma *dma;
+	struct dma_chan_data *chan;
+	struct dma_sg_config config;
+	struct comp_buffer *dma_buffer;
+	uint32_t dma_copy_align;
+	uint32_t held;			/* demultiplexed, not given back yet */
+	uint32_t running;		/* members started */
+	struct comp_dev *driver;	/* member doing the copies */
+	struct list_item members;	/* host_data of members */
+
+	/* frame being demultiplexed */
+	struct sof_ipc_stream_mux_hdr hdr;
+	uint32_t hdr_bytes;		/* header bytes read so far */
+	struct host_data *frame;	/* payload destination, NULL drops it */
+	uint32_t frame_left;		/* payload bytes still to come */
+};
+
 /**
  * \brief Host component data.
  *
@@ -87,6 +117,19 @@ struct host_data {
 
 	pcm_converter_func process;	/**< processing function */
 
+	/* host frame channel order, used if remap is set */
+	struct pcm_chmap chmap;
+	bool remap;
+
+	/* zero-copy, DMA works directly on local_buffer */
+	bool zero_copy;
+	uint32_t zc_held;	/**< bytes owned by both DMA and pipeline */
+
+	/* host DMA shared with other PCMs, copied by the group */
+	struct host_mux_group *mux;
+	struct list_item mux_list;	/**< in mux->members */
+	struct comp_dev *dev;
+
 	/* stream info */
 	struct sof_ipc_stream_posn posn; /* TODO: update this */
 	struct ipc_msg *msg;	/**< host notification */
@@ -124,16 +167,24 @@ static void host_update_position(struct comp_dev *dev, uint32_t bytes)
 	struct host_data *hd = comp_get_drvdata(dev);
 	uint32_t samples;
 
-	samples = bytes / audio_stream_sample_bytes(&hd->local_buffer->stream);
+	/* zero-copy moves local_buffer pointers in host_copy_zero_copy(),
+	 * a shared DMA is copied by host_mux_demux()
+	 */
+	if (!hd->zero_copy && !hd->mux) {
+		samples = bytes /
+			audio_stream_sample_bytes(&hd->local_buffer->stream);
 
-	if (dev->direction == SOF_IPC_STREAM_PLAYBACK)
-		dma_buffer_copy_from(hd->dma_buffer, bytes,
-				     hd->local_buffer, bytes,
-				     hd->process, samples);
-	else
-		dma_buffer_copy_to(hd->local_buffer, bytes,
-				   hd->dma_buffer, bytes,
-				   hd->process, samples);
+		if (dev->direction == SOF_IPC_STREAM_PLAYBACK)
+			dma_buffer_copy_from(hd->dma_buffer, bytes,
+					     hd->local_buffer, bytes,
+					     hd->process, samples,
+					     hd->remap ? &hd->chmap : NULL);
+		else
+			dma_buffer_copy_to(hd->local_buffer, bytes,
+					   hd->dma_buffer, bytes,
+					   hd->process, samples,
+					   hd->remap ? &hd->chmap : NULL);
+	}
 
 	dev->position += bytes;
 
@@ -162,8 +213,7 @@ static void host_update_position(struct comp_dev *dev, uint32_t bytes)
 			 * (updates position first, by calling ops.position())
 			 */
 			pipeline_get_timestamp(dev->pipeline, dev, &hd->posn);
-			mailbox_stream_write(dev->pipeline->posn_offset,
-					     &hd->posn, sizeof(hd->posn));
+			pipeline_posn_write(dev->pipeline, &hd->posn);
 			ipc_msg_send(hd->msg, &hd->posn, false);
 		}
 	}
@@ -227,7 +277,7 @@ static void host_dma_cb(void *arg, enum notify_id type, void *data)
 }
 
 static int create_local_elems(struct comp_dev *dev, uint32_t buffer_count,
-			      uint32_t buffer_bytes)
+			      uint32_t buffer_bytes, void *buffer_addr)
 {
 	struct host_data *hd = comp_get_drvdata(dev);
 	struct dma_sg_elem_array *elem_array;
@@ -242,27 +292,420 @@ static int create_local_elems(struct comp_dev *dev, uint32_t buffer_count,
 		elem_array = &hd->local.elem_array;
 
 		/* config buffer will be used as proxy */
-		err = dma_sg_alloc(&hd->config.elem_array, SOF_MEM_ZONE_RUNTIME,
-				   dir, 1, 0, 0, 0);
+		err = dma_sg_update(&hd->config.elem_array,
+				    SOF_MEM_ZONE_RUNTIME, dir, 1, 0, 0, 0);
 		if (err < 0) {
-			comp_err(dev, "create_local_elems(): dma_sg_alloc() failed");
+			comp_err(dev, "create_local_elems(): dma_sg_update() failed");
 			return err;
 		}
 	} else {
 		elem_array = &hd->config.elem_array;
 	}
 
-	err = dma_sg_alloc(elem_array, SOF_MEM_ZONE_RUNTIME, dir, buffer_count,
-			   buffer_bytes,
-			   (uintptr_t)(hd->dma_buffer->stream.addr), 0);
+	/* elems of previous params are reused by restarted stream */
+	err = dma_sg_update(elem_array, SOF_MEM_ZONE_RUNTIME, dir,
+			    buffer_count, buffer_bytes, (uintptr_t)buffer_addr,
+			    0);
 	if (err < 0) {
-		comp_err(dev, "create_local_elems(): dma_sg_alloc() failed");
+		comp_err(dev, "create_local_elems(): dma_sg_update() failed");
 		return err;
 	}
 
 	return 0;
 }
 
+static SHARED_DATA struct list_item host_mux_group_list;
+
+static struct list_item *host_mux_group_list_get(void)
+{
+	struct list_item *list;
+
+	list = platform_shared_get(&host_mux_group_list,
+				   sizeof(host_mux_group_list));
+
+	/* zero until the first group is created */
+	if (!list->next)
+		list_init(list);
+
+	return list;
+}
+
+/* sets up the shared DMA, each of its periods fits a period of every PCM */
+static int host_mux_dma_init(struct comp_dev *dev,
+			     struct host_mux_group *group,
+			     uint32_t period_bytes, uint32_t period_count,
+			     uint32_t align, uint32_t addr_align)
+{
+	struct sof_ipc_comp_host *ipc_host =
+		COMP_GET_IPC(dev, sof_ipc_comp_host);
+	struct dma_sg_config *config = &group->config;
+	uint32_t bytes;
+	int err;
+
+	bytes = group->pcms *
+		(period_bytes + sizeof(struct sof_ipc_stream_mux_hdr));
+	period_count = dma_buffer_period_count(bytes, period_count, align);
+
+	group->dma_buffer = buffer_alloc(period_count * bytes, BUFFER_CAPS_DMA,
+					 addr_align);
+	if (!group->dma_buffer) {
+		comp_err(dev, "host_mux_dma_init(): failed to alloc dma buffer");
+		return -ENOMEM;
+	}
+
+	dma_sg_init(&config->elem_array);
+	err = dma_sg_alloc(&config->elem_array, SOF_MEM_ZONE_RUNTIME,
+			   DMA_DIR_HMEM_TO_LMEM, period_count, bytes,
+			   (uintptr_t)group->dma_buffer->stream.addr, 0);
+	if (err < 0) {
+		comp_err(dev, "host_mux_dma_init(): dma_sg_alloc() failed");
+		return err;
+	}
+
+	/* the shared stream is just bytes to the DMA */
+	config->direction = DMA_DIR_HMEM_TO_LMEM;
+	config->src_width = sizeof(uint32_t);
+	config->dest_width = sizeof(uint32_t);
+	config->cyclic = 0;
+	config->irq_disabled = pipeline_is_timer_driven(dev->pipeline);
+	config->is_scheduling_source = comp_is_scheduling_source(dev);
+	config->period = dev->pipeline->ipc_pipe.period;
+	config->dmac_config = ipc_host->dmac_config;
+
+	err = dma_get_attribute(group->dma, DMA_ATTR_COPY_ALIGNMENT,
+				&group->dma_copy_align);
+	if (err < 0) {
+		comp_err(dev, "host_mux_dma_init(): dma_get_attribute()");
+		return err;
+	}
+
+	group->chan = dma_channel_get(group->dma, group->stream_tag - 1);
+	if (!group->chan) {
+		comp_err(dev, "host_mux_dma_init(): no channel for stream %u",
+			 group->stream_tag);
+		return -ENODEV;
+	}
+
+	err = dma_set_config(group->chan, config);
+	if (err < 0) {
+		comp_err(dev, "host_mux_dma_init(): dma_set_config() failed");
+		dma_channel_put(group->chan);
+		group->chan = NULL;
+	}
+
+	return err;
+}
+
+static void host_mux_group_free(struct host_mux_group *group)
+{
+	if (group->chan)
+		dma_channel_put(group->chan);
+	dma_sg_free(&group->config.elem_array);
+	if (group->dma_buffer)
+		buffer_free(group->dma_buffer);
+	list_item_del(&group->list);
+	rfree(group);
+}
+
+static void host_mux_leave(struct comp_dev *dev)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct host_mux_group *group = hd->mux;
+
+	list_item_del(&hd->mux_list);
+	hd->mux = NULL;
+
+	if (group->frame == hd)
+		group->frame = NULL;
+	if (group->driver == dev)
+		group->driver = NULL;
+
+	if (!--group->count)
+		host_mux_group_free(group);
+}
+
+static int host_mux_join(struct comp_dev *dev,
+			 struct sof_ipc_stream_params *params,
+			 uint32_t period_bytes, uint32_t period_count,
+			 uint32_t align, uint32_t addr_align)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct host_mux_group *group;
+	struct list_item *glist;
+	int err;
+
+	/* params again without reset */
+	if (hd->mux)
+		host_mux_leave(dev);
+
+	if (dev->direction != SOF_IPC_STREAM_PLAYBACK ||
+	    hd->host.elem_array.count || hd->copy_type != COMP_COPY_NORMAL) {
+		comp_err(dev, "host_mux_join(): only playback host DMA can be shared");
+		return -EINVAL;
+	}
+
+	list_for_item(glist, host_mux_group_list_get()) {
+		group = container_of(glist, struct host_mux_group, list);
+		if (group->stream_tag == params->stream_tag)
+			goto out;
+	}
+
+	group = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+			SOF_MEM_CAPS_RAM, sizeof(*group));
+	if (!group) {
+		comp_err(dev, "host_mux_join(): could not alloc group");
+		return -ENOMEM;
+	}
+
+	group->stream_tag = params->stream_tag;
+	group->pcms = params->mux_pcms;
+	group->core = dev->comp.core;
+	group->dma = hd->dma;
+	list_init(&group->members);
+	list_item_prepend(&group->list, host_mux_group_list_get());
+
+	err = host_mux_dma_init(dev, group, period_bytes, period_count, align,
+				addr_align);
+	if (err < 0) {
+		host_mux_group_free(group);
+		return err;
+	}
+
+out:
+	if (group->count == group->pcms) {
+		comp_err(dev, "host_mux_join(): stream %u has %u PCMs already",
+			 group->stream_tag, group->count);
+		return -EINVAL;
+	}
+
+	if (group->core != dev->comp.core) {
+		comp_err(dev, "host_mux_join(): members must share core");
+		return -EINVAL;
+	}
+
+	group->count++;
+	list_item_append(&hd->mux_list, &group->members);
+	hd->mux = group;
+
+	hd->process =
+		pcm_get_conversion_function(hd->local_buffer->stream.frame_fmt,
+					    hd->local_buffer->stream.frame_fmt);
+
+	return 0;
+}
+
+/* reads bytes of a frame header from the DMA buffer */
+static void host_mux_read(struct audio_stream *dma, uint8_t *data,
+			  uint32_t bytes)
+{
+	uint32_t i;
+
+	audio_stream_invalidate(dma, bytes);
+
+	for (i = 0; i < bytes; i++) {
+		data[i] = *(uint8_t *)dma->r_ptr;
+		dma->r_ptr = audio_stream_wrap(dma, (uint8_t *)dma->r_ptr + 1);
+	}
+}
+
+/* finds the member of a complete frame header */
+static void host_mux_frame(struct host_mux_group *group)
+{
+	struct host_data *member;
+	struct list_item *mlist;
+	uint32_t frame_bytes;
+
+	group->frame = NULL;
+	group->frame_left = group->hdr.size;
+
+	list_for_item(mlist, &group->members) {
+		member = container_of(mlist, struct host_data, mux_list);
+		if (dev_comp_id(member->dev) != group->hdr.comp_id)
+			continue;
+
+		/* stopped or paused PCMs drop their data */
+		if (member->dev->state != COMP_STATE_ACTIVE)
+			return;
+
+		frame_bytes =
+			audio_stream_frame_bytes(&member->local_buffer->stream);
+		if (group->hdr.size % frame_bytes) {
+			comp_err(member->dev, "host_mux_frame(): payload %u is not whole frames",
+				 group->hdr.size);
+			return;
+		}
+
+		group->frame = member;
+		return;
+	}
+}
+
+/* moves new DMA data into the members, returns the bytes taken */
+static uint32_t host_mux_demux(struct host_mux_group *group, uint32_t bytes)
+{
+	struct audio_stream *dma = &group->dma_buffer->stream;
+	struct host_data *hd;
+	struct audio_stream *local;
+	uint32_t samples;
+	uint32_t flags = 0;
+	uint32_t done = 0;
+	uint32_t n;
+
+	while (done < bytes) {
+		/* header of the next frame, it may come in pieces */
+		if (group->hdr_bytes < sizeof(group->hdr)) {
+			n = MIN(bytes - done,
+				sizeof(group->hdr) - group->hdr_bytes);
+			host_mux_read(dma, (uint8_t *)&group->hdr +
+				      group->hdr_bytes, n);
+			group->hdr_bytes += n;
+			done += n;
+
+			if (group->hdr_bytes == sizeof(group->hdr))
+				host_mux_frame(group);
+			continue;
+		}
+
+		if (!group->frame_left) {
+			group->hdr_bytes = 0;
+			continue;
+		}
+
+		n = MIN(bytes - done, group->frame_left);
+		hd = group->frame;
+
+		if (hd) {
+			local = &hd->local_buffer->stream;
+
+			/* a full member holds back the whole DMA */
+			buffer_lock(hd->local_buffer, &flags);
+			n = MIN(n, local->free);
+			buffer_unlock(hd->local_buffer, flags);
+
+			n = n / audio_stream_frame_bytes(local) *
+				audio_stream_frame_bytes(local);
+			if (!n)
+				break;
+
+			samples = n / audio_stream_sample_bytes(local);
+
+			/* remapping walks the DMA buffer in member frames */
+			dma->frame_fmt = local->frame_fmt;
+			dma->channels = local->channels;
+
+			dma_buffer_copy_from(group->dma_buffer, n,
+					     hd->local_buffer, n, hd->process,
+					     samples,
+					     hd->remap ? &hd->chmap : NULL);
+			host_update_position(hd->dev, n);
+		} else {
+			dma->r_ptr = audio_stream_wrap(dma,
+						       (char *)dma->r_ptr + n);
+		}
+
+		group->frame_left -= n;
+		done += n;
+	}
+
+	return done;
+}
+
+/* the DMA is copied by one running member for the whole group */
+static int host_mux_copy(struct comp_dev *dev)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct host_mux_group *group = hd->mux;
+	uint32_t avail_bytes = 0;
+	uint32_t free_bytes = 0;
+	uint32_t bytes;
+	int ret;
+
+	if (group->driver != dev)
+		return 0;
+
+	ret = dma_get_data_size(group->chan, &avail_bytes, &free_bytes);
+	if (ret < 0) {
+		comp_err(dev, "host_mux_copy(): dma_get_data_size() failed, ret = %u",
+			 ret);
+		return ret;
+	}
+
+	/* new data follows the bytes held back for the copy alignment */
+	group->held += host_mux_demux(group, avail_bytes - group->held);
+
+	bytes = ALIGN_DOWN(group->held, group->dma_copy_align);
+	if (!bytes)
+		return 0;
+
+	group->held -= bytes;
+
+	ret = dma_copy(group->chan, bytes, 0);
+	if (ret < 0)
+		comp_err(dev, "host_mux_copy(): dma_copy() failed, ret = %u",
+			 ret);
+
+	return ret;
+}
+
+/* DMA runs while any member is started and is copied by an active one */
+static int host_mux_trigger(struct comp_dev *dev, int cmd)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct host_mux_group *group = hd->mux;
+	struct host_data *member;
+	struct list_item *mlist;
+	int ret = 0;
+
+	switch (cmd) {
+	case COMP_TRIGGER_START:
+		if (group->running++)
+			break;
+
+		group->held = 0;
+		group->hdr_bytes = 0;
+		group->frame_left = 0;
+		group->dma_buffer->stream.r_ptr =
+			group->dma_buffer->stream.addr;
+
+		ret = dma_start(group->chan);
+		if (ret < 0) {
+			comp_err(dev, "host_mux_trigger(): dma_start() failed, ret = %u",
+				 ret);
+			group->running--;
+		}
+		break;
+	case COMP_TRIGGER_STOP:
+	case COMP_TRIGGER_XRUN:
+		if (!group->running || --group->running)
+			break;
+
+		ret = dma_stop(group->chan);
+		if (ret < 0)
+			comp_err(dev, "host_mux_trigger(): dma stop failed: %d",
+				 ret);
+		break;
+	default:
+		break;
+	}
+
+	if (group->driver == dev && dev->state != COMP_STATE_ACTIVE) {
+		group->driver = NULL;
+		list_for_item(mlist, &group->members) {
+			member = container_of(mlist, struct host_data,
+					      mux_list);
+			if (member->dev->state == COMP_STATE_ACTIVE) {
+				group->driver = member->dev;
+				break;
+			}
+		}
+	}
+
+	if (!group->driver && dev->state == COMP_STATE_ACTIVE)
+		group->driver = dev;
+
+	return ret;
+}
+
 /**
  * \brief Command handler.
  * \param[in,out] dev Device
@@ -295,6 +738,9 @@ static int host_trigger(struct comp_dev *dev, int cmd)
 	if (cmd != COMP_TRIGGER_START && hd->copy_type == COMP_COPY_ONE_SHOT)
 		return ret;
 
+	if (hd->mux)
+		return host_mux_trigger(dev, cmd);
+
 	if (!hd->chan) {
 		comp_err(dev, "host_trigger(): no dma channel configured");
 		return -EINVAL;
@@ -302,6 +748,14 @@ static int host_trigger(struct comp_dev *dev, int cmd)
 
 	switch (cmd) {
 	case COMP_TRIGGER_START:
+		/* no dirty lines may be evicted over DMA data later on */
+		if (hd->zero_copy) {
+			dcache_writeback_invalidate_region
+				(hd->local_buffer->stream.addr,
+				 hd->local_buffer->stream.size);
+			hd->zc_held = 0;
+		}
+
 		ret = dma_start(hd->chan);
 		if (ret < 0)
 			comp_err(dev, "host_trigger(): dma_start() failed, ret = %u",
@@ -353,6 +807,7 @@ static struct comp_dev *host_new(const struct comp_driver *drv,
 	}
 
 	comp_set_drvdata(dev, hd);
+	hd->dev = dev;
 
 	/* request HDA DMA with shared access privilege */
 	dir = ipc_host->direction == SOF_IPC_STREAM_PLAYBACK ?
@@ -395,10 +850,14 @@ static void host_free(struct comp_dev *dev)
 
 	comp_info(dev, "host_free()");
 
+	if (hd->mux)
+		host_mux_leave(dev);
+
 	dma_put(hd->dma);
 
 	ipc_msg_free(hd->msg);
 	dma_sg_free(&hd->config.elem_array);
+	dma_sg_free(&hd->local.elem_array);
 	rfree(hd);
 	rfree(dev);
 }
@@ -453,15 +912,95 @@ static int host_verify_params(struct comp_dev *dev,
 	return 0;
 }
 
+/* alloc DMA buffer or change its size if exists */
+static int host_dma_buffer_alloc(struct comp_dev *dev, uint32_t size,
+				 uint32_t align, uint32_t addr_align)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	uint32_t buffer_size = ALIGN_UP(size, align);
+	int err;
+
+	if (hd->dma_buffer) {
+		err = buffer_set_size(hd->dma_buffer, buffer_size);
+		if (err < 0) {
+			comp_err(dev, "host_params(): buffer_set_size() failed, buffer_size = %u",
+				 buffer_size);
+			return err;
+		}
+	} else {
+		hd->dma_buffer = buffer_alloc(buffer_size, BUFFER_CAPS_DMA,
+					      addr_align);
+		if (!hd->dma_buffer) {
+			comp_err(dev, "host_params(): failed to alloc dma buffer");
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+/* DMA can work on the pipeline buffer if it's usable as the DMA buffer */
+static bool host_zero_copy_supported(struct comp_dev *dev, uint32_t addr_align,
+				     uint32_t align, uint32_t period_bytes,
+				     uint32_t period_count)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct comp_buffer *buffer = hd->local_buffer;
+	uint32_t size = buffer->stream.size;
+
+	/* only HDA DMA runs cyclically over a single local buffer */
+	if (!(hd->dma->plat_data.caps & DMA_CAP_HDA) ||
+	    hd->host.elem_array.count || hd->copy_type == COMP_COPY_ONE_SHOT)
+		return false;
+
+	if (buffer->inter_core || !(buffer->caps & SOF_MEM_CAPS_DMA))
+		return false;
+
+	return !((uintptr_t)buffer->stream.addr % addr_align) &&
+		!(size % align) && !(size % period_bytes) &&
+		size / period_bytes >= period_count;
+}
+
 /* configure the DMA params and descriptors for host buffer IO */
+/* sets up reordering of channels between host and pipeline frames */
+static int host_chmap_params(struct comp_dev *dev, uint32_t map)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct audio_stream *local = &hd->local_buffer->stream;
+	int err;
+
+	/* host frames carry the pipeline channels, only their order differs */
+	if (pcm_chmap_channels(map) != local->channels ||
+	    !pcm_chmap_supported(local->frame_fmt, local->frame_fmt)) {
+		comp_err(dev, "host_chmap_params(): map 0x%x invalid for %u channels of format %u",
+			 map, local->channels, local->frame_fmt);
+		return -EINVAL;
+	}
+
+	err = pcm_chmap_init(&hd->chmap, map, local->channels,
+			     dev->direction == SOF_IPC_STREAM_CAPTURE);
+	if (err < 0) {
+		comp_err(dev, "host_chmap_params(): map 0x%x has duplicate channels",
+			 map);
+		return err;
+	}
+
+	hd->remap = true;
+
+	return 0;
+}
+
 static int host_params(struct comp_dev *dev,
 		       struct sof_ipc_stream_params *params)
 {
+	struct sof_ipc_comp_host *ipc_host =
+		COMP_GET_IPC(dev, sof_ipc_comp_host);
 	struct host_data *hd = comp_get_drvdata(dev);
 	struct dma_sg_config *config = &hd->config;
 	uint32_t period_count;
 	uint32_t period_bytes;
 	uint32_t buffer_size;
+	void *buffer_addr;
 	uint32_t addr_align;
 	uint32_t align;
 	int err;
@@ -540,28 +1079,62 @@ static int host_params(struct comp_dev *dev,
 		period_count = 1;
 	}
 
-	/* calculate DMA buffer size */
-	buffer_size = ALIGN_UP(period_count * period_bytes, align);
+	/* Compressed streams are words at a rate covering the peak bitrate,
+	 * they have no channels to map.
+	 */
+	if (params->buffer_fmt == SOF_IPC_BUFFER_COMPRESSED &&
+	    ipc_host->ch_map) {
+		comp_err(dev, "host_params(): channel map on compressed stream");
+		return -EINVAL;
+	}
 
-	/* alloc DMA buffer or change its size if exists */
-	if (hd->dma_buffer) {
-		err = buffer_set_size(hd->dma_buffer, buffer_size);
-		if (err < 0) {
-			comp_err(dev, "host_params(): buffer_set_size() failed, buffer_size = %u",
-				 buffer_size);
+	hd->remap = false;
+	if (ipc_host->ch_map) {
+		err = host_chmap_params(dev, ipc_host->ch_map);
+		if (err < 0)
 			return err;
-		}
+	}
+
+	/* PCMs sharing one host DMA channel */
+	if (params->mux_pcms)
+		return host_mux_join(dev, params, period_bytes, period_count,
+				     align, addr_align);
+
+	hd->zero_copy = !hd->remap &&
+		host_zero_copy_supported(dev, addr_align, align,
+					 period_bytes, period_count);
+	if (hd->zero_copy) {
+		comp_info(dev, "host_params(): zero-copy");
+
+		/* DMA runs over the whole pipeline buffer */
+		buffer_size = hd->local_buffer->stream.size;
+		period_count = buffer_size / period_bytes;
+		buffer_addr = hd->local_buffer->stream.addr;
 	} else {
-		hd->dma_buffer = buffer_alloc(buffer_size, SOF_MEM_CAPS_DMA,
-					      addr_align);
-		if (!hd->dma_buffer) {
-			comp_err(dev, "host_params(): failed to alloc dma buffer");
-			return -ENOMEM;
-		}
+		/* keep DMA periods equal to pipeline periods */
+		if (!hd->host.elem_array.count)
+			period_count = dma_buffer_period_count(period_bytes,
+							       period_count,
+							       align);
+
+		err = host_dma_buffer_alloc(dev, period_count * period_bytes,
+					    align, addr_align);
+		if (err < 0)
+			return err;
+
+		buffer_size = hd->dma_buffer->stream.size;
+		buffer_addr = hd->dma_buffer->stream.addr;
+
+		/* remapping walks the DMA buffer in frames */
+		hd->dma_buffer->stream.frame_fmt =
+			hd->local_buffer->stream.frame_fmt;
+		hd->dma_buffer->stream.channels =
+			hd->local_buffer->stream.channels;
 	}
 
 	/* create SG DMA elems for local DMA buffer */
-	err = create_local_elems(dev, period_count, buffer_size / period_count);
+	err = create_local_elems(dev, period_count, buffer_size / period_count,
+				 buffer_addr);
 	if (err < 0)
 		return err;
 
@@ -574,6 +1147,7 @@ static int host_params(struct comp_dev *dev,
 	config->irq_disabled = pipeline_is_timer_driven(dev->pipeline);
 	config->is_scheduling_source = comp_is_scheduling_source(dev);
 	config->period = dev->pipeline->ipc_pipe.period;
+	config->dmac_config = ipc_host->dmac_config;
 
 	host_elements_reset(dev);
 
@@ -615,6 +1189,42 @@ static int host_params(struct comp_dev *dev,
 	return 0;
 }
 
+/* Changes rate or format of a prepared or running stream. DMA goes on
+ * moving bytes as it is set up, so the sample size can't change.
+ */
+static int host_reconfig(struct comp_dev *dev,
+			 struct sof_ipc_stream_params *params)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct audio_stream *local = &hd->local_buffer->stream;
+	int err;
+
+	comp_info(dev, "host_reconfig()");
+
+	if (get_sample_bytes(params->frame_fmt) !=
+	    audio_stream_sample_bytes(local) ||
+	    (hd->remap && params->channels != local->channels)) {
+		comp_err(dev, "host_reconfig(): can't change frame_fmt %d channels %d to %d %d",
+			 local->frame_fmt, local->channels, params->frame_fmt,
+			 params->channels);
+		return -EINVAL;
+	}
+
+	err = host_verify_params(dev, params);
+	if (err < 0)
+		return err;
+
+	if (hd->dma_buffer) {
+		hd->dma_buffer->stream.frame_fmt = local->frame_fmt;
+		hd->dma_buffer->stream.channels = local->channels;
+	}
+
+	hd->process = pcm_get_conversion_function(local->frame_fmt,
+						  local->frame_fmt);
+
+	return 0;
+}
+
 static int host_prepare(struct comp_dev *dev)
 {
 	struct host_data *hd = comp_get_drvdata(dev);
@@ -665,16 +1275,17 @@ static int host_reset(struct comp_dev *dev)
 
 	comp_dbg(dev, "host_reset()");
 
+	if (hd->mux)
+		host_mux_leave(dev);
+
 	if (hd->chan) {
 		/* remove callback */
 		notifier_unregister(dev, hd->chan, NOTIFIER_ID_DMA_COPY);
 		dma_channel_put(hd->chan);
 	}
 
-	/* free all DMA elements */
+	/* free host DMA elements, local ones are kept for next params */
 	dma_sg_free(&hd->host.elem_array);
-	dma_sg_free(&hd->local.elem_array);
-	dma_sg_free(&hd->config.elem_array);
 
 	/* free DMA buffer */
 	if (hd->dma_buffer) {
@@ -687,6 +1298,7 @@ static int host_reset(struct comp_dev *dev)
 
 	host_pointer_reset(dev);
 	hd->copy_type = COMP_COPY_NORMAL;
+	hd->zero_copy = false;
 	hd->source = NULL;
 	hd->sink = NULL;
 	dev->state = COMP_STATE_READY;
@@ -694,7 +1306,7 @@ static int host_reset(struct comp_dev *dev)
 	return 0;
 }
 
-static uint32_t host_buffer_get_copy_bytes(struct comp_dev *dev)
+static uint32_t __hot_text host_buffer_get_copy_bytes(struct comp_dev *dev)
 {
 	struct host_data *hd = comp_get_drvdata(dev);
 	struct dma_sg_elem *local_elem = hd->config.elem_array.elems;
@@ -757,8 +1369,90 @@ static uint32_t host_buffer_get_copy_bytes(struct comp_dev *dev)
 	return copy_bytes;
 }
 
+/*
+ * Zero-copy transfer, pipeline buffer is the DMA buffer. Playback data
+ * written by DMA is produced into the buffer and space consumed by the
+ * pipeline is given back to DMA. Capture data produced by the pipeline is
+ * given to DMA and consumed from the buffer once DMA has read it.
+ */
+static int host_copy_zero_copy(struct comp_dev *dev, uint32_t flags)
+{
+	struct host_data *hd = comp_get_drvdata(dev);
+	struct comp_buffer *buffer = hd->local_buffer;
+	uint32_t avail_bytes = 0;
+	uint32_t free_bytes = 0;
+	uint32_t buffer_flags = 0;
+	uint32_t local_bytes;
+	uint32_t bytes;
+	void *ptr;
+	int ret;
+
+	ret = dma_get_data_size(hd->chan, &avail_bytes, &free_bytes);
+	if (ret < 0) {
+		comp_err(dev, "host_copy_zero_copy(): dma_get_data_size() failed, ret = %u",
+			 ret);
+		return ret;
+	}
+
+	buffer_lock(buffer, &buffer_flags);
+	local_bytes = buffer->stream.avail;
+	buffer_unlock(buffer, buffer_flags);
+
+	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+		/* new data from DMA, only this window is invalidated */
+		bytes = avail_bytes - hd->zc_held;
+		if (bytes) {
+			audio_stream_invalidate_from(&buffer->stream,
+						     buffer->stream.w_ptr,
+						     bytes);
+			if (audio_stream_is_zero(&buffer->stream,
+						 buffer->stream.w_ptr, bytes))
+				buffer_mark_silence(buffer);
+			comp_update_buffer_produce(buffer, bytes);
+		}
+
+		hd->zc_held += bytes;
+
+		/* give back to DMA what the pipeline has consumed */
+		bytes = ALIGN_DOWN(hd->zc_held - bytes - local_bytes,
+				   hd->dma_copy_align);
+		hd->zc_held -= bytes;
+	} else {
+		/* release data that DMA has already read */
+		bytes = hd->zc_held - (buffer->stream.size - free_bytes);
+		if (bytes) {
+			comp_update_buffer_consume(buffer, bytes);
+			local_bytes -= bytes;
+			hd->zc_held -= bytes;
+		}
+
+		/* give new pipeline data to DMA */
+		bytes = ALIGN_DOWN(local_bytes - hd->zc_held,
+				   hd->dma_copy_align);
+		if (bytes) {
+			ptr = audio_stream_wrap(&buffer->stream,
+						(char *)buffer->stream.r_ptr +
+						hd->zc_held);
+			audio_stream_writeback_from(&buffer->stream, ptr,
+						    bytes);
+		}
+
+		hd->zc_held += bytes;
+	}
+
+	if (!bytes)
+		return 0;
+
+	ret = dma_copy(hd->chan, bytes, flags);
+	if (ret < 0)
+		comp_err(dev, "host_copy_zero_copy(): dma_copy() failed, ret = %u",
+			 ret);
+
+	return ret;
+}
+
 /* copy and process stream data from source to sink buffers */
-static int host_copy(struct comp_dev *dev)
+static int __hot_text host_copy(struct comp_dev *dev)
 {
 	struct host_data *hd = comp_get_drvdata(dev);
 	uint32_t copy_bytes = 0;
@@ -775,6 +1469,12 @@ static int host_copy(struct comp_dev *dev)
 	else if (hd->copy_type == COMP_COPY_ONE_SHOT)
 		flags |= DMA_COPY_ONE_SHOT;
 
+	if (hd->zero_copy)
+		return host_copy_zero_copy(dev, flags);
+
+	if (hd->mux)
+		return host_mux_copy(dev);
+
 	/* update first transfer manually */
 	if (!dev->position && flags & COMP_COPY_ONE_SHOT)
 		host_one_shot_cb(dev, hd->dma_buffer->stream.size);
@@ -829,6 +1529,7 @@ static const struct comp_driver comp_host = {
 		.create		= host_new,
 		.free		= host_free,
 		.params		= host_params,
+		.reconfig	= host_reconfig,
 		.reset		= host_reset,
 		.trigger	= host_trigger,
 		.copy		= host_copy,
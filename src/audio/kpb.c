@@ -23,15 +23,18 @@
 #include <sof/drivers/ipc.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
 #include <sof/lib/clk.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/dma.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/notifier.h>
-#include <sof/lib/pm_runtime.h>
+#include <sof/lib/overlay.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
 #include <sof/math/numbers.h>
 #include <sof/platform.h>
-#include <sof/schedule/edf_schedule.h>
+#include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
 #include <sof/string.h>
@@ -68,6 +71,7 @@ struct comp_data {
 	struct comp_buffer *host_sink; /**< draining sink (client) */
 	struct hb *history_buffer; /**< internal history buffer */
 	size_t buffered_data; /**< keeps info about amount of buffered data */
+	size_t buffered_pos; /**< stream position of history write pointer */
 	struct dd draining_task_data;
 	size_t buffer_size; /**< size of internal history buffer */
 	size_t host_buffer_size; /**< size of host buffer */
@@ -76,11 +80,18 @@ struct comp_data {
 				   * host?
 				   */
 	spinlock_t lock; /**< locking mechanism for read pointer calculations */
+#if CONFIG_KPB_DMA_DRAIN
+	struct dma_copy dma_drain; /**< DMA used for draining */
+	bool dma_drain_on; /**< is DMA channel acquired for draining? */
+	size_t dma_drain_size; /**< bytes of DMA transfer in flight */
+#endif
 };
 
 /*! KPB private functions */
 static void kpb_event_handler(void *arg, enum notify_id type, void *event_data);
 static int kpb_register_client(struct comp_data *kpb, struct kpb_client *cli);
+static int kpb_unregister_client(struct comp_data *kpb,
+				 struct kpb_client *cli);
 static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli);
 static enum task_state kpb_draining_task(void *arg);
 static int kpb_buffer_data(struct comp_dev *dev,
@@ -106,9 +117,36 @@ static inline bool validate_host_params(struct comp_dev *dev,
 static inline void kpb_change_state(struct comp_data *kpb,
 				    enum kpb_state state);
 
-static uint64_t kpb_task_deadline(void *data)
+/**
+ * \brief Calculate history buffer space taken by stream data.
+ *
+ * \param[in] size - size of stream data in bytes.
+ * \param[in] sample_width - sample width in bits.
+ *
+ * \return: size of stored data in bytes.
+ */
+static inline size_t kpb_hb_size(size_t size, size_t sample_width)
+{
+	if (sample_width == 16)
+		return size;
+
+	return size / sizeof(int32_t) * KPB_HB_SAMPLE_BYTES;
+}
+
+/**
+ * \brief Calculate stream data size of data stored in history buffer.
+ *
+ * \param[in] hb_size - size of stored data in bytes.
+ * \param[in] sample_width - sample width in bits.
+ *
+ * \return: size of stream data in bytes.
+ */
+static inline size_t kpb_stream_size(size_t hb_size, size_t sample_width)
 {
-	return SOF_TASK_DEADLINE_ALMOST_IDLE;
+	if (sample_width == 16)
+		return hb_size;
+
+	return hb_size / KPB_HB_SAMPLE_BYTES * sizeof(int32_t);
 }
 
 /**
@@ -122,10 +160,6 @@ static struct comp_dev *kpb_new(const struct comp_driver *drv,
 {
 	struct sof_ipc_comp_process *ipc_process =
 					(struct sof_ipc_comp_process *)comp;
-	struct task_ops ops = {
-		.run = kpb_draining_task,
-		.get_deadline = kpb_task_deadline,
-	};
 	size_t bs = ipc_process->size;
 	struct comp_dev *dev;
 	struct comp_data *kpb;
@@ -174,12 +208,20 @@ static struct comp_dev *kpb_new(const struct comp_driver *drv,
 	}
 
 	/* Initialize draining task */
-	schedule_task_init_edf(&kpb->draining_task, /* task structure */
-			       SOF_UUID(kpb_task_uuid), /* task uuid */
-			       &ops, /* task ops */
-			       &kpb->draining_task_data, /* task private data */
-			       0, /* core on which we should run */
-			       0); /* no flags */
+	ret = schedule_task_init_ll(&kpb->draining_task, /* task structure */
+				    SOF_UUID(kpb_task_uuid), /* task uuid */
+				    SOF_SCHEDULE_LL_TIMER, /* task type */
+				    SOF_TASK_PRI_LOW, /* task priority */
+				    kpb_draining_task, /* task run function */
+				    &kpb->draining_task_data, /* task data */
+				    cpu_get_id(), /* core to run on */
+				    0); /* no flags */
+	if (ret < 0) {
+		comp_err(dev, "kpb_new(): draining task init failed");
+		rfree(kpb);
+		rfree(dev);
+		return NULL;
+	}
 
 	/* Init basic component data */
 	kpb->history_buffer = NULL;
@@ -204,8 +246,13 @@ static size_t kpb_allocate_history_buffer(struct comp_data *kpb,
 {
 	struct hb *history_buffer;
 	struct hb *new_hb = NULL;
+	size_t sample_width = kpb->config.sampling_width;
+	/*! Size of one frame in history buffer */
+	size_t hb_frame = kpb_hb_size(KPB_NUM_OF_CHANNELS *
+				      KPB_SAMPLE_CONTAINER_SIZE(sample_width) /
+				      8, sample_width);
 	/*! Total allocation size */
-	size_t hb_size = hb_size_req;
+	size_t hb_size = kpb_hb_size(hb_size_req, sample_width);
 	/*! Current allocation size */
 	size_t ca_size = hb_size;
 	/*! Memory caps priorites for history buffer */
@@ -231,6 +278,8 @@ static size_t kpb_allocate_history_buffer(struct comp_data *kpb,
 	 * KPB_MAX_BUFFER_SIZE, since there is no single memory block
 	 * that big, we need to allocate couple smaller blocks which
 	 * linked together will form history buffer.
+	 * With CONFIG_KPB_CONTIGUOUS_HISTORY whole history buffer has to
+	 * fit in one block of one of the memory types.
 	 */
 	while (hb_size > 0 && i < ARRAY_SIZE(hb_mcp)) {
 		/* Try to allocate ca_size (current allocation size). At first
@@ -240,8 +289,9 @@ static size_t kpb_allocate_history_buffer(struct comp_data *kpb,
 
 		if (new_mem_block) {
 			/* We managed to allocate a block of ca_size.
-			 * Now we initialize it.
+			 * Now we initialize it, so it holds whole frames.
 			 */
+			ca_size -= ca_size % hb_frame;
 			comp_cl_info(&comp_kpb, "kpb new memory block: %d",
 				     ca_size);
 			allocated_size += ca_size;
@@ -272,6 +322,11 @@ static size_t kpb_allocate_history_buffer(struct comp_data *kpb,
 				ca_size = hb_size;
 				i++;
 			}
+		} else if (IS_ENABLED(CONFIG_KPB_CONTIGUOUS_HISTORY)) {
+			/* Whole history buffer doesn't fit in memory
+			 * of that hb_mcp, let's try the next one.
+			 */
+			i++;
 		} else {
 			/* We've failed to allocate ca_size of that hb_mcp
 			 * let's try again with some smaller size.
@@ -294,7 +349,7 @@ static size_t kpb_allocate_history_buffer(struct comp_data *kpb,
 	comp_cl_info(&comp_kpb, "kpb_allocate_history_buffer(): allocated %d bytes",
 		     allocated_size);
 
-	return allocated_size;
+	return kpb_stream_size(allocated_size, sample_width);
 }
 
 /**
@@ -459,6 +514,7 @@ static int kpb_prepare(struct comp_dev *dev)
 	/* Init private data */
 	kpb->kpb_no_of_clients = 0;
 	kpb->buffered_data = 0;
+	kpb->buffered_pos = 0;
 	kpb->sel_sink = NULL;
 	kpb->host_sink = NULL;
 
@@ -578,6 +634,7 @@ static int kpb_reset(struct comp_dev *dev)
 		break;
 	default:
 		kpb->buffered_data = 0;
+		kpb->buffered_pos = 0;
 
 		if (kpb->history_buffer) {
 			/* Reset history buffer - zero its data, reset pointers
@@ -609,7 +666,7 @@ static int kpb_reset(struct comp_dev *dev)
  *	0 - success
  *	-EINVAL - failure.
  */
-static int kpb_copy(struct comp_dev *dev)
+static int __overlay_text(kwd) kpb_copy(struct comp_dev *dev)
 {
 	int ret = 0;
 	struct comp_data *kpb = comp_get_drvdata(dev);
@@ -761,8 +818,9 @@ out:
  * \param[in] source pointer to the buffer source.
  *
  */
-static int kpb_buffer_data(struct comp_dev *dev,
-			   const struct comp_buffer *source, size_t size)
+static int __overlay_text(kwd) kpb_buffer_data(struct comp_dev *dev,
+					       const struct comp_buffer *source,
+					       size_t size)
 {
 	int ret = 0;
 	size_t size_to_copy = size;
@@ -773,7 +831,6 @@ static int kpb_buffer_data(struct comp_dev *dev,
 	uint64_t timeout = 0;
 	uint64_t current_time;
 	enum kpb_state state_preserved = kpb->state;
-	struct dd *draining_data = &kpb->draining_task_data;
 	size_t sample_width = kpb->config.sampling_width;
 	struct timer *timer = timer_get();
 
@@ -791,8 +848,8 @@ static int kpb_buffer_data(struct comp_dev *dev,
 		return PPL_STATUS_PATH_STOP;
 	}
 
-	if (kpb->state == KPB_STATE_DRAINING)
-		draining_data->buffered_while_draining += size_to_copy;
+	/* the draining task reads up to this position */
+	kpb->buffered_pos += size_to_copy;
 
 	kpb_change_state(kpb, KPB_STATE_BUFFERING);
 
@@ -819,7 +876,9 @@ static int kpb_buffer_data(struct comp_dev *dev,
 		}
 
 		/* Check how much space there is in current write buffer */
-		space_avail = (uint32_t)buff->end_addr - (uint32_t)buff->w_ptr;
+		space_avail = kpb_stream_size((uint32_t)buff->end_addr -
+					      (uint32_t)buff->w_ptr,
+					      sample_width);
 
 		if (size_to_copy > space_avail) {
 			/* We have more data to copy than available space
@@ -829,7 +888,8 @@ static int kpb_buffer_data(struct comp_dev *dev,
 			kpb_buffer_samples(&source->stream, offset, buff->w_ptr,
 					   space_avail, sample_width);
 			/* Update write pointer & requested copy size */
-			buff->w_ptr = (char *)buff->w_ptr + space_avail;
+			buff->w_ptr = (char *)buff->w_ptr +
+				      kpb_hb_size(space_avail, sample_width);
 			size_to_copy = size_to_copy - space_avail;
 			/* Update read pointer's offset before continuing
 			 * with next buffer.
@@ -843,7 +903,8 @@ static int kpb_buffer_data(struct comp_dev *dev,
 			kpb_buffer_samples(&source->stream, offset, buff->w_ptr,
 					   size_to_copy, sample_width);
 			/* Update write pointer & requested copy size */
-			buff->w_ptr = (char *)buff->w_ptr + size_to_copy;
+			buff->w_ptr = (char *)buff->w_ptr +
+				      kpb_hb_size(size_to_copy, sample_width);
 			/* Reset requested copy size */
 			size_to_copy = 0;
 		}
@@ -899,7 +960,7 @@ static void kpb_event_handler(void *arg, enum notify_id type, void *event_data)
 		kpb_register_client(kpb, cli);
 		break;
 	case KPB_EVENT_UNREGISTER_CLIENT:
-		/*TODO*/
+		kpb_unregister_client(kpb, cli);
 		break;
 	case KPB_EVENT_BEGIN_DRAINING:
 		kpb_init_draining(dev, cli);
@@ -957,6 +1018,34 @@ static int kpb_register_client(struct comp_data *kpb, struct kpb_client *cli)
 	return ret;
 }
 
+/**
+ * \brief Unregister client, its id can be registered again.
+ *
+ * \param[in] kpb - kpb component data.
+ * \param[in] cli - pointer to KPB client's data.
+ *
+ * \return integer representing either:
+ *	0 - success
+ *	-EINVAL - failure.
+ */
+static int kpb_unregister_client(struct comp_data *kpb,
+				 struct kpb_client *cli)
+{
+	comp_cl_info(&comp_kpb, "kpb_unregister_client()");
+
+	if (!cli || cli->id >= KPB_MAX_NO_OF_CLIENTS ||
+	    kpb->clients[cli->id].state == KPB_CLIENT_UNREGISTERED) {
+		comp_cl_err(&comp_kpb, "kpb_unregister_client(): client not registered");
+		return -EINVAL;
+	}
+
+	kpb->clients[cli->id].state = KPB_CLIENT_UNREGISTERED;
+	kpb->clients[cli->id].r_ptr = NULL;
+	kpb->kpb_no_of_clients--;
+
+	return 0;
+}
+
 /**
  * \brief Prepare history buffer for draining.
  *
@@ -979,7 +1068,6 @@ static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli)
 	enum comp_copy_type copy_type = COMP_COPY_NORMAL;
 	size_t drain_interval;
 	size_t host_period_size = kpb->host_period_size;
-	size_t ticks_per_ms = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
 	size_t bytes_per_ms = KPB_SAMPLES_PER_MS *
 			      (KPB_SAMPLE_CONTAINER_SIZE(sample_width) / 8) *
 			      kpb->config.channels;
@@ -991,9 +1079,12 @@ static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli)
 
 	if (kpb->state != KPB_STATE_RUN) {
 		comp_err(dev, "kpb_init_draining(): wrong KPB state");
-	} else if (cli->id > KPB_MAX_NO_OF_CLIENTS) {
+	} else if (cli->id >= KPB_MAX_NO_OF_CLIENTS) {
 		comp_err(dev, "kpb_init_draining(): wrong client id");
-	/* TODO: check also if client is registered */
+	} else if (kpb->kpb_no_of_clients &&
+		   kpb->clients[cli->id].state == KPB_CLIENT_UNREGISTERED) {
+		/* once clients register only they can request draining */
+		comp_err(dev, "kpb_init_draining(): client not registered");
 	} else if (!is_sink_ready) {
 		comp_err(dev, "kpb_init_draining(): sink not ready for draining");
 	} else if (kpb->buffered_data < history_depth ||
@@ -1017,11 +1108,13 @@ static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli)
 			if (buff->state == KPB_BUFFER_FREE) {
 				local_buffered = (uint32_t)buff->w_ptr -
 						 (uint32_t)buff->start_addr;
-				buffered += local_buffered;
+				buffered += kpb_stream_size(local_buffered,
+							    sample_width);
 			} else if (buff->state == KPB_BUFFER_FULL) {
 				local_buffered = (uint32_t)buff->end_addr -
 						 (uint32_t)buff->start_addr;
-				buffered += local_buffered;
+				buffered += kpb_stream_size(local_buffered,
+							    sample_width);
 			} else {
 				comp_err(dev, "kpb_init_draining(): incorrect buffer label");
 			}
@@ -1039,10 +1132,15 @@ static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli)
 					 * and buffer's end address.
 					 */
 					buff = buff->prev;
-					buffered += (uint32_t)buff->end_addr -
-						    (uint32_t)buff->w_ptr;
+					local_buffered =
+						(uint32_t)buff->end_addr -
+						(uint32_t)buff->w_ptr;
+					buffered += kpb_stream_size
+						(local_buffered, sample_width);
 					buff->r_ptr = (char *)buff->w_ptr +
-						      (buffered - history_depth);
+						kpb_hb_size(buffered -
+							    history_depth,
+							    sample_width);
 					break;
 				}
 				buff = buff->prev;
@@ -1051,7 +1149,9 @@ static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli)
 				break;
 			} else {
 				buff->r_ptr = (char *)buff->start_addr +
-					      (buffered - history_depth);
+					      kpb_hb_size(buffered -
+							  history_depth,
+							  sample_width);
 				break;
 			}
 
@@ -1063,34 +1163,39 @@ static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli)
 		 * kpb_prepare().
 		 */
 		if (kpb->sync_draining_mode) {
-			/* Calculate time in clock ticks each draining event
-			 * shall take place. This time will be used to
-			 * synchronize us with application interrupts.
+			/* Calculate period in microseconds of the draining
+			 * task. Each run copies one host period, which
+			 * synchronizes us with application interrupts.
 			 */
-			drain_interval = ((host_period_size / bytes_per_ms) *
-					 ticks_per_ms) /
+			drain_interval = (host_period_size / bytes_per_ms) *
+					 1000 /
 					 KPB_DRAIN_NUM_OF_PPL_PERIODS_AT_ONCE;
 			period_bytes_limit = host_period_size;
 			comp_info(dev, "kpb_init_draining(): sync_draining_mode selected with interval %d [uS].",
-				  drain_interval * 1000 / ticks_per_ms);
+				  drain_interval);
 		} else {
-			/* Unlimited draining */
-			drain_interval = 0;
-			period_bytes_limit = 0;
+			/* Unlimited draining, each run copies as much
+			 * as host is able to take.
+			 */
+			drain_interval = KPB_DRAIN_INTERVAL_US;
+			period_bytes_limit = kpb->host_buffer_size;
 			comp_info(dev, "kpb_init_draining: unlimited draining speed selected.");
 		}
 
 		comp_info(dev, "kpb_init_draining(), schedule draining task");
 
-		/* Add one-time draining task into the scheduler. */
+		/* Add periodic draining task into the scheduler. */
 		kpb->draining_task_data.sink = kpb->host_sink;
 		kpb->draining_task_data.history_buffer = buff;
-		kpb->draining_task_data.history_depth = history_depth;
+		kpb->draining_task_data.read_pos = kpb->buffered_pos -
+						   history_depth;
+		kpb->draining_task_data.is_draining_active = 0;
 		kpb->draining_task_data.sample_width = sample_width;
 		kpb->draining_task_data.drain_interval = drain_interval;
 		kpb->draining_task_data.pb_limit = period_bytes_limit;
 		kpb->draining_task_data.dev = dev;
 		kpb->draining_task_data.sync_mode_on = kpb->sync_draining_mode;
+		kpb->draining_task_data.drained = 0;
 
 		/* Set host-sink copy mode to blocking */
 		comp_set_attribute(kpb->host_sink->sink, COMP_ATTR_COPY_TYPE,
@@ -1099,128 +1204,160 @@ static void kpb_init_draining(struct comp_dev *dev, struct kpb_client *cli)
 		/* Pause selector copy. */
 		kpb->sel_sink->sink->state = COMP_STATE_PAUSED;
 
+#if CONFIG_KPB_DMA_DRAIN
+		/* DSP copies samples if there is no DMA channel available */
+		kpb->dma_drain_on = !dma_copy_new_local(&kpb->dma_drain);
+		if (!kpb->dma_drain_on)
+			comp_warn(dev, "kpb_init_draining(): no DMA for draining");
+#endif
+
 		/* Schedule draining task */
-		schedule_task(&kpb->draining_task, 0, 0);
+		schedule_task(&kpb->draining_task, 0, drain_interval);
 	}
 }
 
 /**
- * \brief Draining task.
- *
- * \param[in] arg - pointer keeping drainig data previously prepared
- * by kpb_init_draining().
+ * \brief Moves drain read pointer past drained data and passes the data
+ *	  to the sink.
  *
- * \return none.
+ * \param[in] draining_data - draining data of the draining task.
+ * \param[in] size - drained size in bytes.
  */
-static enum task_state kpb_draining_task(void *arg)
+static void __overlay_text(kwd) kpb_drain_commit(struct dd *draining_data,
+						 size_t size)
 {
-	struct dd *draining_data = (struct dd *)arg;
-	struct comp_buffer *sink = draining_data->sink;
 	struct hb *buff = draining_data->history_buffer;
-	size_t history_depth = draining_data->history_depth;
-	size_t sample_width = draining_data->sample_width;
-	size_t size_to_read;
-	size_t size_to_copy;
-	bool move_buffer = false;
-	uint32_t drained = 0;
-	uint64_t draining_time_start = 0;
-	uint64_t draining_time_end = 0;
-	enum comp_copy_type copy_type = COMP_COPY_NORMAL;
-	uint64_t drain_interval = draining_data->drain_interval;
-	uint64_t next_copy_time = 0;
-	uint64_t current_time = 0;
-	size_t period_bytes = 0;
-	size_t period_bytes_limit = draining_data->pb_limit;
-	struct timer *timer = timer_get();
-	size_t period_copy_start = platform_timer_get(timer);
-	size_t time_taken = 0;
-	size_t *rt_stream_update = &draining_data->buffered_while_draining;
-	struct comp_data *kpb = comp_get_drvdata(draining_data->dev);
-	bool sync_mode_on = &draining_data->sync_mode_on;
+	struct comp_buffer *sink = draining_data->sink;
+
+	buff->r_ptr = (char *)buff->r_ptr +
+		      kpb_hb_size(size, draining_data->sample_width);
+	draining_data->read_pos += size;
+	draining_data->drained += size;
+
+	if (buff->r_ptr == buff->end_addr) {
+		buff->r_ptr = buff->start_addr;
+		draining_data->history_buffer = buff->next;
+	}
+
+	comp_update_buffer_produce(sink, size);
+	comp_copy(sink->sink);
+}
 
-	comp_cl_info(&comp_kpb, "kpb_draining_task(), start.");
+#if CONFIG_KPB_DMA_DRAIN
+/**
+ * \brief Releases DMA channel used for draining, transfer still in flight
+ *	  is stopped and its data dropped.
+ *
+ * \param[in] kpb - kpb component data.
+ */
+static void kpb_dma_drain_release(struct comp_data *kpb)
+{
+	if (!kpb->dma_drain_on)
+		return;
 
-	pm_runtime_disable(PM_RUNTIME_DSP, PLATFORM_MASTER_CORE_ID);
+	if (kpb->dma_drain_size) {
+		dma_stop(kpb->dma_drain.chan);
+		kpb->dma_drain_size = 0;
+	}
 
-	/* Change KPB internal state to DRAINING */
-	kpb_change_state(kpb, KPB_STATE_DRAINING);
+	dma_copy_free(&kpb->dma_drain);
+	dma_put(kpb->dma_drain.dmac);
+	kpb->dma_drain_on = false;
+}
 
-	draining_time_start = platform_timer_get(timer);
+/**
+ * \brief Starts draining data with DMA, the data is passed to the sink by
+ *	  kpb_dma_drain_commit() once the transfer has finished.
+ *
+ * \param[in] kpb - kpb component data.
+ * \param[in] source - pointer to contiguous history data.
+ * \param[in] sink - pointer to sink stream.
+ * \param[in] size - requested copy size in bytes, copied up to the sink
+ *		     buffer wrap at most.
+ *
+ * \return 0 on success, error code otherwise.
+ */
+static int __overlay_text(kwd) kpb_dma_drain_start(struct comp_data *kpb,
+						   void *source,
+						   struct audio_stream *sink,
+						   size_t size)
+{
+	int ret;
 
-	while (history_depth > 0) {
-		/* Have we received reset request? */
-		if (kpb->state == KPB_STATE_RESETTING) {
-			kpb_change_state(kpb, KPB_STATE_RESET_FINISHING);
-			kpb_reset(draining_data->dev);
-			goto out;
-		}
-		/* Are we ready to drain further or host still need some time
-		 * to read the data already provided?
-		 */
-		if (sync_mode_on &&
-		    next_copy_time > platform_timer_get(timer)) {
-			period_bytes = 0;
-			period_copy_start = platform_timer_get(timer);
-			continue;
-		} else if (next_copy_time == 0) {
-			period_copy_start = platform_timer_get(timer);
-		}
+	size = MIN(size, audio_stream_bytes_without_wrap(sink, sink->w_ptr));
 
-		size_to_read = (uint32_t)buff->end_addr - (uint32_t)buff->r_ptr;
+	/* DMA reads memory, so samples buffered by DSP have to be there */
+	dcache_writeback_region(source, size);
 
-		if (size_to_read > sink->stream.free) {
-			if (sink->stream.free >= history_depth)
-				size_to_copy = history_depth;
-			else
-				size_to_copy = sink->stream.free;
-		} else {
-			if (size_to_read > history_depth) {
-				size_to_copy = history_depth;
-			} else {
-				size_to_copy = size_to_read;
-				move_buffer = true;
-			}
-		}
+	/* dirty sink lines evicted later would overwrite DMA data */
+	dcache_writeback_invalidate_region(sink->w_ptr, size);
 
-		kpb_drain_samples(buff->r_ptr, &sink->stream, size_to_copy,
-				  sample_width);
+	ret = dma_copy_local_start(&kpb->dma_drain, sink->w_ptr, source,
+				   size);
+	if (ret < 0)
+		return ret;
 
-		buff->r_ptr = (char *)buff->r_ptr + (uint32_t)size_to_copy;
-		history_depth -= size_to_copy;
-		drained += size_to_copy;
-		period_bytes += size_to_copy;
+	kpb->dma_drain_size = size;
 
-		if (move_buffer) {
-			buff->r_ptr = buff->start_addr;
-			buff = buff->next;
-			move_buffer = false;
-		}
+	return 0;
+}
 
-		if (size_to_copy) {
-			comp_update_buffer_produce(sink, size_to_copy);
-			comp_copy(sink->sink);
-		}
+/**
+ * \brief Checks DMA transfer started by kpb_dma_drain_start().
+ *
+ * \param[in] kpb - kpb component data.
+ *
+ * \return true while the transfer runs.
+ */
+static bool __overlay_text(kwd) kpb_dma_drain_busy(struct comp_data *kpb)
+{
+	int ret;
 
-		if (sync_mode_on && period_bytes >= period_bytes_limit) {
-			current_time = platform_timer_get(timer);
-			time_taken = current_time - period_copy_start;
-			next_copy_time = current_time + drain_interval -
-					 time_taken;
-		}
+	ret = dma_copy_local_done(&kpb->dma_drain);
+	if (ret == -EBUSY)
+		return true;
 
-		if (history_depth == 0) {
-		/* We have finished draining of requested data however
-		 * while we were draining real time stream could provided
-		 * new data which needs to be copy to host.
-		 */
-			comp_cl_info(&comp_kpb, "kpb: update history_depth by %d",
-				     *rt_stream_update);
-			history_depth += *rt_stream_update;
-			*rt_stream_update = 0;
-		}
+	/* sink write pointer hasn't moved, copy it again on DSP */
+	if (ret < 0) {
+		comp_cl_err(&comp_kpb, "kpb_dma_drain_busy(): DMA copy failed");
+		kpb_dma_drain_release(kpb);
 	}
-out:
-	draining_time_end = platform_timer_get(timer);
+
+	return false;
+}
+
+/**
+ * \brief Passes data of finished DMA transfer to the sink.
+ *
+ * \param[in] kpb - kpb component data.
+ * \param[in] draining_data - draining data of the draining task.
+ */
+static void __overlay_text(kwd) kpb_dma_drain_commit(struct comp_data *kpb,
+						     struct dd *draining_data)
+{
+	struct audio_stream *sink = &draining_data->sink->stream;
+
+	/* drop sink lines the core may have fetched meanwhile */
+	dcache_invalidate_region(sink->w_ptr, kpb->dma_drain_size);
+
+	kpb_drain_commit(draining_data, kpb->dma_drain_size);
+	kpb->dma_drain_size = 0;
+}
+#endif
+
+/**
+ * \brief Finishes draining.
+ *
+ * \param[in] draining_data - draining data of the draining task.
+ *
+ * \return task state to be returned by the draining task.
+ */
+static enum task_state __overlay_text(kwd)
+kpb_draining_done(struct dd *draining_data)
+{
+	struct comp_data *kpb = comp_get_drvdata(draining_data->dev);
+	enum comp_copy_type copy_type = COMP_COPY_NORMAL;
+	uint64_t draining_time_end = platform_timer_get(timer_get());
 
 	/* Draining is done. Now switch KPB to copy real time stream
 	 * to client's sink. This state is called "draining on demand"
@@ -1231,23 +1368,226 @@ out:
 		kpb_change_state(kpb, KPB_STATE_HOST_COPY);
 
 	/* Reset host-sink copy mode back to unblocking */
-	comp_set_attribute(sink->sink, COMP_ATTR_COPY_TYPE, &copy_type);
+	comp_set_attribute(draining_data->sink->sink, COMP_ATTR_COPY_TYPE,
+			   &copy_type);
 
 	comp_cl_info(&comp_kpb, "KPB: kpb_draining_task(), done. %u drained in %d ms",
-		     drained,
-		     (draining_time_end - draining_time_start)
+		     draining_data->drained,
+		     (draining_time_end - draining_data->draining_time_start)
 		     / clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1));
 
 	/* If traces are disabled, prevent compile error from unused
 	 * variables.
 	 */
-	(void)(draining_time_end - draining_time_start);
+	(void)draining_time_end;
+
+#if CONFIG_KPB_DMA_DRAIN
+	kpb_dma_drain_release(kpb);
+#endif
 
-	pm_runtime_enable(PM_RUNTIME_DSP, PLATFORM_MASTER_CORE_ID);
+	draining_data->is_draining_active = 0;
 
 	return SOF_TASK_STATE_COMPLETED;
 }
 
+/**
+ * \brief Draining task.
+ *
+ * Each run copies at most pb_limit bytes and stops earlier when host
+ * doesn't free any more space in the sink, then the task waits for its
+ * next period, so the core can do other work or idle in the meantime.
+ * With DMA draining a run starts one transfer and leaves it running, the
+ * next run passes its data to the sink once it has finished.
+ *
+ * The read pointer follows the history write pointer, so samples of the
+ * real time stream buffered while draining are drained from the same ring
+ * right after the history. Once it catches up, KPB passes the real time
+ * stream directly to the sink.
+ *
+ * \param[in] arg - pointer keeping drainig data previously prepared
+ * by kpb_init_draining().
+ *
+ * \return task state.
+ */
+static enum task_state __overlay_text(kwd) kpb_draining_task(void *arg)
+{
+	struct dd *draining_data = (struct dd *)arg;
+	struct comp_buffer *sink = draining_data->sink;
+	struct hb *buff;
+	size_t sample_width = draining_data->sample_width;
+	size_t size_to_copy;
+	size_t pending;
+	size_t period_bytes = 0;
+	size_t period_bytes_limit = draining_data->pb_limit;
+	struct comp_data *kpb = comp_get_drvdata(draining_data->dev);
+
+	/* Have we received reset request? */
+	if (kpb->state == KPB_STATE_RESETTING) {
+#if CONFIG_KPB_DMA_DRAIN
+		kpb_dma_drain_release(kpb);
+#endif
+		kpb_change_state(kpb, KPB_STATE_RESET_FINISHING);
+		kpb_reset(draining_data->dev);
+		return kpb_draining_done(draining_data);
+	}
+
+	if (!draining_data->is_draining_active) {
+		comp_cl_info(&comp_kpb, "kpb_draining_task(), start.");
+
+		/* Change KPB internal state to DRAINING */
+		kpb_change_state(kpb, KPB_STATE_DRAINING);
+
+		draining_data->draining_time_start =
+			platform_timer_get(timer_get());
+		draining_data->is_draining_active = 1;
+	}
+
+#if CONFIG_KPB_DMA_DRAIN
+	/* transfer started by the previous run has to finish first */
+	if (kpb->dma_drain_size && kpb_dma_drain_busy(kpb))
+		return SOF_TASK_STATE_RESCHEDULE;
+#endif
+
+	/* bytes between read and write pointer of the history ring, checked
+	 * before data of a finished transfer is passed on, since overrun
+	 * would have overwritten it
+	 */
+	pending = kpb->buffered_pos - draining_data->read_pos;
+	if (pending > kpb->buffer_size) {
+		comp_cl_err(&comp_kpb, "kpb_draining_task(): real time stream overran draining by %u bytes",
+			    pending - kpb->buffer_size);
+		return kpb_draining_done(draining_data);
+	}
+
+#if CONFIG_KPB_DMA_DRAIN
+	if (kpb->dma_drain_size) {
+		pending -= kpb->dma_drain_size;
+		kpb_dma_drain_commit(kpb, draining_data);
+	}
+#endif
+
+	while (pending > 0 && period_bytes < period_bytes_limit) {
+		buff = draining_data->history_buffer;
+		size_to_copy = kpb_stream_size((uint32_t)buff->end_addr -
+					       (uint32_t)buff->r_ptr,
+					       sample_width);
+		size_to_copy = MIN(size_to_copy, sink->stream.free);
+		size_to_copy = MIN(size_to_copy, pending);
+		size_to_copy = MIN(size_to_copy,
+				   period_bytes_limit - period_bytes);
+
+		/* Host still needs some time to read the data already
+		 * provided, continue in the next period.
+		 */
+		if (!size_to_copy)
+			break;
+
+#if CONFIG_KPB_DMA_DRAIN
+		if (kpb->dma_drain_on) {
+			if (!kpb_dma_drain_start(kpb, buff->r_ptr,
+						 &sink->stream, size_to_copy))
+				return SOF_TASK_STATE_RESCHEDULE;
+
+			/* sink write pointer hasn't moved, copy it on DSP */
+			comp_cl_err(&comp_kpb, "kpb_draining_task(): DMA copy failed");
+			kpb_dma_drain_release(kpb);
+		}
+#endif
+
+		kpb_drain_samples(buff->r_ptr, &sink->stream, size_to_copy,
+				  sample_width);
+		kpb_drain_commit(draining_data, size_to_copy);
+
+		period_bytes += size_to_copy;
+		pending -= size_to_copy;
+	}
+
+	if (pending > 0)
+		return SOF_TASK_STATE_RESCHEDULE;
+
+	return kpb_draining_done(draining_data);
+}
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+/**
+ * \brief Store 24 or 32 bit sample in history buffer.
+ *
+ * \param[in] dst - history buffer write position.
+ * \param[in] x - sample to be stored.
+ * \param[in] sample_width - sample width in bits.
+ *
+ * \return: history buffer position after stored sample.
+ */
+static inline void *kpb_hb_store_s32(void *dst, int32_t x,
+				     size_t sample_width)
+{
+#if CONFIG_KPB_HISTORY_S24_PACKED
+	uint8_t *hb = dst;
+
+	/* keep 24 most significant bits of 32 bit samples */
+	if (sample_width == 32)
+		x >>= 8;
+
+	hb[0] = x;
+	hb[1] = x >> 8;
+	hb[2] = x >> 16;
+
+	return hb + 3;
+#elif CONFIG_KPB_HISTORY_S16
+	int16_t *hb = dst;
+
+	if (sample_width == 24)
+		x = sign_extend_s24(x);
+
+	/* apply gain and keep 16 most significant bits */
+	*hb = sat_int16(x >> (sample_width - 16 -
+			      CONFIG_KPB_HISTORY_S16_GAIN_SHIFT));
+
+	return hb + 1;
+#else
+	int32_t *hb = dst;
+
+	*hb = x;
+
+	return hb + 1;
+#endif
+}
+
+/**
+ * \brief Load 24 or 32 bit sample from history buffer.
+ *
+ * \param[in,out] src - history buffer read position, moved past the sample.
+ * \param[in] sample_width - sample width in bits.
+ *
+ * \return: sample in stream format.
+ */
+static inline int32_t kpb_hb_load_s32(void **src, size_t sample_width)
+{
+#if CONFIG_KPB_HISTORY_S24_PACKED
+	uint8_t *hb = *src;
+	int32_t x = hb[0] | hb[1] << 8 | hb[2] << 16;
+
+	*src = hb + 3;
+
+	return sample_width == 32 ? x << 8 : sign_extend_s24(x);
+#elif CONFIG_KPB_HISTORY_S16
+	int16_t *hb = *src;
+
+	*src = hb + 1;
+
+	/* remove gain and restore stream sample width */
+	return (int32_t)*hb << (sample_width - 16 -
+				CONFIG_KPB_HISTORY_S16_GAIN_SHIFT);
+#else
+	int32_t *hb = *src;
+
+	*src = hb + 1;
+
+	return *hb;
+#endif
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
 /**
  * \brief Drain data samples safe, according to configuration.
  *
@@ -1258,8 +1598,10 @@ out:
  *
  * \return none.
  */
-static void kpb_drain_samples(void *source, struct audio_stream *sink,
-			      size_t size, size_t sample_width)
+static void __overlay_text(kwd) kpb_drain_samples(void *source,
+						  struct audio_stream *sink,
+						  size_t size,
+						  size_t sample_width)
 {
 #if CONFIG_FORMAT_S16LE || CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
 	void *dst;
@@ -1284,8 +1626,8 @@ static void kpb_drain_samples(void *source, struct audio_stream *sink,
 			case 24:
 			case 32:
 				dst = audio_stream_write_frag_s32(sink, j);
-				*((int32_t *)dst) = *((int32_t *)src);
-				src = ((int32_t *)src) + 1;
+				*((int32_t *)dst) =
+					kpb_hb_load_s32(&src, sample_width);
 				break;
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 			default:
@@ -1305,9 +1647,9 @@ static void kpb_drain_samples(void *source, struct audio_stream *sink,
  * \param[in] size Requested copy size in bytes.
  * \param[in] sample_width Sample size.
  */
-static void kpb_buffer_samples(const struct audio_stream *source,
-			       uint32_t start, void *sink, size_t size,
-			       size_t sample_width)
+static void __overlay_text(kwd)
+kpb_buffer_samples(const struct audio_stream *source, uint32_t start,
+		   void *sink, size_t size, size_t sample_width)
 {
 	void *src;
 	void *dst = sink;
@@ -1329,8 +1671,8 @@ static void kpb_buffer_samples(const struct audio_stream *source,
 			case 24:
 			case 32:
 				src = audio_stream_read_frag_s32(source, j);
-				*((int32_t *)dst) = *((int32_t *)src);
-				dst = ((int32_t *)dst) + 1;
+				dst = kpb_hb_store_s32(dst, *((int32_t *)src),
+						       sample_width);
 				break;
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE*/
 			default:
@@ -1402,50 +1744,39 @@ static inline bool kpb_is_sample_width_supported(uint32_t sampling_width)
  *
  * \return none.
  */
-static void kpb_copy_samples(struct comp_buffer *sink,
-			     struct comp_buffer *source, size_t size,
-			     size_t sample_width)
+static void __overlay_text(kwd) kpb_copy_samples(struct comp_buffer *sink,
+						 struct comp_buffer *source,
+						 size_t size,
+						 size_t sample_width)
 {
-#if CONFIG_FORMAT_S16LE || CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
-	void *dst;
-	void *src;
-#endif
-	size_t i;
-	size_t j = 0;
-	size_t channel;
 	size_t frames = KPB_BYTES_TO_FRAMES(size, sample_width);
-	struct audio_stream *istream = &source->stream;
-	struct audio_stream *ostream = &sink->stream;
+	size_t sample_bytes;
 
-	buffer_invalidate(source, size);
-
-	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < KPB_NUM_OF_CHANNELS; channel++) {
-			switch (sample_width) {
+	switch (sample_width) {
 #if CONFIG_FORMAT_S16LE
-			case 16:
-				dst = audio_stream_write_frag_s16(ostream, j);
-				src = audio_stream_read_frag_s16(istream, j);
-				*((int16_t *)dst) = *((int16_t *)src);
-				break;
+	case 16:
+		sample_bytes = sizeof(int16_t);
+		break;
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
-			case 24:
-				/* FALLTHROUGH */
-			case 32:
-				dst = audio_stream_write_frag_s32(ostream, j);
-				src = audio_stream_read_frag_s32(istream, j);
-				*((int32_t *)dst) = *((int32_t *)src);
-				break;
+	case 24:
+		/* FALLTHROUGH */
+	case 32:
+		sample_bytes = sizeof(int32_t);
+		break;
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE*/
-			default:
-				comp_cl_err(&comp_kpb, "KPB: An attempt to copy not supported format!");
-				return;
-			}
-			j++;
-		}
+	default:
+		comp_cl_err(&comp_kpb, "KPB: An attempt to copy not supported format!");
+		return;
 	}
 
+	/* samples are copied unchanged, so whole frames are copied at once */
+	size = frames * KPB_NUM_OF_CHANNELS * sample_bytes;
+
+	buffer_invalidate(source, size);
+
+	audio_stream_copy(&source->stream, 0, &sink->stream, 0, size);
+
 	buffer_writeback(sink, size);
 }
 
@@ -1544,6 +1875,7 @@ static inline void kpb_change_state(struct comp_data *kpb,
 static const struct comp_driver comp_kpb = {
 	.type = SOF_COMP_KPB,
 	.uid = SOF_UUID(kpb_uuid),
+	.overlay = OVERLAY(kwd),
 	.ops = {
 		.create = kpb_new,
 		.free = kpb_free,
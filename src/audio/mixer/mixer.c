@@ -22,9 +22,11 @@
 #include <sof/string.h>
 #include <sof/trace/trace.h>
 #include <sof/ut.h>
+#include <ipc/control.h>
 #include <ipc/stream.h>
 #include <ipc/topology.h>
 #include <user/trace.h>
+#include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -34,83 +36,6 @@ static const struct comp_driver comp_mixer;
 DECLARE_SOF_UUID("mixer", mixer_uuid, 0xbc06c037, 0x12aa, 0x417c,
 		 0x9a, 0x97, 0x89, 0x28, 0x2e, 0x32, 0x1a, 0x76);
 
-/* mixer component private data */
-struct mixer_data {
-	void (*mix_func)(struct comp_dev *dev, struct audio_stream *sink,
-			 const struct audio_stream **sources, uint32_t count,
-			 uint32_t frames);
-};
-
-#if CONFIG_FORMAT_S16LE
-/* Mix n 16 bit PCM source streams to one sink stream */
-static void mix_n_s16(struct comp_dev *dev, struct audio_stream *sink,
-		      const struct audio_stream **sources, uint32_t num_sources,
-		      uint32_t frames)
-{
-	int16_t *src;
-	int16_t *dest;
-	int32_t val;
-	int i;
-	int j;
-	int channel;
-	uint32_t frag = 0;
-
-	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < sink->channels; channel++) {
-			val = 0;
-
-			for (j = 0; j < num_sources; j++) {
-				src = audio_stream_read_frag_s16(sources[j],
-								 frag);
-				val += *src;
-			}
-
-			dest = audio_stream_write_frag_s16(sink, frag);
-
-			/* Saturate to 16 bits */
-			*dest = sat_int16(val);
-
-			frag++;
-		}
-	}
-}
-#endif /* CONFIG_FORMAT_S16LE */
-
-#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
-/* Mix n 32 bit PCM source streams to one sink stream */
-static void mix_n_s32(struct comp_dev *dev, struct audio_stream *sink,
-		      const struct audio_stream **sources, uint32_t num_sources,
-		      uint32_t frames)
-{
-	int32_t *src;
-	int32_t *dest;
-	int64_t val;
-	int i;
-	int j;
-	int channel;
-	uint32_t frag = 0;
-
-	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < sink->channels; channel++) {
-			val = 0;
-
-			for (j = 0; j < num_sources; j++) {
-				src = audio_stream_read_frag_s32(sources[j],
-								 frag);
-				val += *src;
-			}
-
-			dest = audio_stream_write_frag_s32(sink, frag);
-
-			/* Saturate to 32 bits */
-			*dest = sat_int32(val);
-
-			frag++;
-		}
-	}
-}
-#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
-
 static struct comp_dev *mixer_new(const struct comp_driver *drv,
 				  struct sof_ipc_comp *comp)
 {
@@ -120,6 +45,7 @@ static struct comp_dev *mixer_new(const struct comp_driver *drv,
 		(struct sof_ipc_comp_mixer *)comp;
 	struct mixer_data *md;
 	int ret;
+	int i;
 
 	comp_cl_dbg(&comp_mixer, "mixer_new()");
 
@@ -143,6 +69,9 @@ static struct comp_dev *mixer_new(const struct comp_driver *drv,
 		return NULL;
 	}
 
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++)
+		md->gain[i] = MIXER_GAIN_UNITY;
+
 	comp_set_drvdata(dev, md);
 	dev->state = COMP_STATE_READY;
 	return dev;
@@ -267,19 +196,206 @@ static int mixer_trigger(struct comp_dev *dev, int cmd)
 	return ret;
 }
 
+/* sets gains of sources, channel of each element is the source index */
+static int mixer_ctrl_set_cmd(struct comp_dev *dev,
+			      struct sof_ipc_ctrl_data *cdata)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	uint32_t source;
+	int i;
+
+	if (cdata->cmd != SOF_CTRL_CMD_VOLUME) {
+		comp_err(dev, "mixer_ctrl_set_cmd(): invalid cdata->cmd %u",
+			 cdata->cmd);
+		return -EINVAL;
+	}
+
+	if (cdata->num_elems == 0 || cdata->num_elems > PLATFORM_MAX_STREAMS) {
+		comp_err(dev, "mixer_ctrl_set_cmd(): invalid cdata->num_elems %u",
+			 cdata->num_elems);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < cdata->num_elems; i++) {
+		source = cdata->chanv[i].channel;
+		if (source >= PLATFORM_MAX_STREAMS) {
+			comp_err(dev, "mixer_ctrl_set_cmd(): illegal source %u",
+				 source);
+			return -EINVAL;
+		}
+
+		comp_info(dev, "mixer_ctrl_set_cmd(), source = %u, gain = %u",
+			  source, cdata->chanv[i].value);
+		md->gain[source] = cdata->chanv[i].value;
+	}
+
+	md->gain_active = false;
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++) {
+		if (md->gain[i] != MIXER_GAIN_UNITY)
+			md->gain_active = true;
+	}
+
+	return 0;
+}
+
+static int mixer_ctrl_get_cmd(struct comp_dev *dev,
+			      struct sof_ipc_ctrl_data *cdata)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	int i;
+
+	if (cdata->cmd != SOF_CTRL_CMD_VOLUME) {
+		comp_err(dev, "mixer_ctrl_get_cmd(): invalid cdata->cmd %u",
+			 cdata->cmd);
+		return -EINVAL;
+	}
+
+	if (cdata->num_elems == 0 || cdata->num_elems > PLATFORM_MAX_STREAMS) {
+		comp_err(dev, "mixer_ctrl_get_cmd(): invalid cdata->num_elems %u",
+			 cdata->num_elems);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < cdata->num_elems; i++) {
+		cdata->chanv[i].channel = i;
+		cdata->chanv[i].value = md->gain[i];
+	}
+
+	return 0;
+}
+
+/* used to pass standard and bespoke commands (with data) to component */
+static int mixer_cmd(struct comp_dev *dev, int cmd, void *data,
+		     int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	comp_dbg(dev, "mixer_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_VALUE:
+		return mixer_ctrl_set_cmd(dev, cdata);
+	case COMP_CMD_GET_VALUE:
+		return mixer_ctrl_get_cmd(dev, cdata);
+	default:
+		return -EINVAL;
+	}
+}
+
+#if CONFIG_COMP_MIXER_ASYNC
+/*
+ * Mix each source PCM stream at its own position after the sink write
+ * pointer, as many frames as the source has. Sink is produced as far as all
+ * sources holding mixed frames have reached, so sources with different
+ * periods don't wait for each other. A source which has run dry doesn't
+ * hold the sink and is mixed as silence until it has data again.
+ */
+static int __hot_text mixer_copy(struct comp_dev *dev)
+{
+	struct mixer_data *md = comp_get_drvdata(dev);
+	struct comp_buffer *sink;
+	struct comp_buffer *source;
+	struct list_item *blist;
+	uint32_t commit = UINT32_MAX;
+	uint32_t sink_frames;
+	uint32_t source_bytes;
+	uint32_t sink_bytes;
+	uint32_t overlap;
+	uint32_t frames;
+	uint32_t flags = 0;
+	uint32_t index = 0;
+	uint32_t i;
+
+	comp_dbg(dev, "mixer_copy()");
+
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	buffer_lock(sink, &flags);
+	sink_frames = sink->stream.free /
+		audio_stream_frame_bytes(&sink->stream);
+	buffer_unlock(sink, flags);
+
+	/* walk sources backwards to index them in order of connection */
+	list_for_item_prev(blist, &dev->bsource_list) {
+		source = container_of(blist, struct comp_buffer, sink_list);
+
+		/* too many sources ? */
+		if (index == PLATFORM_MAX_STREAMS)
+			break;
+
+		/* source not mixed anymore restarts at sink write pointer */
+		if (source->source->state != dev->state) {
+			md->pending[index++] = 0;
+			continue;
+		}
+
+		buffer_lock(source, &flags);
+		frames = source->stream.avail /
+			audio_stream_frame_bytes(&source->stream);
+		buffer_unlock(source, flags);
+
+		frames = MIN(frames, sink_frames > md->pending[index] ?
+			     sink_frames - md->pending[index] : 0);
+		if (frames) {
+			/* frames already written by other sources are added */
+			overlap = md->mixed > md->pending[index] ?
+				MIN(frames, md->mixed - md->pending[index]) : 0;
+			source_bytes = frames *
+				audio_stream_frame_bytes(&source->stream);
+
+			buffer_invalidate(source, source_bytes);
+			md->acc_func(&sink->stream, &source->stream,
+				     md->gain[index], md->pending[index],
+				     overlap, frames);
+			comp_update_buffer_consume(source, source_bytes);
+
+			md->pending[index] += frames;
+			md->mixed = MAX(md->mixed, md->pending[index]);
+		}
+
+		if (md->pending[index])
+			commit = MIN(commit, md->pending[index]);
+
+		index++;
+	}
+
+	/* nothing mixed by any source */
+	if (commit == UINT32_MAX)
+		return 0;
+
+	for (i = 0; i < PLATFORM_MAX_STREAMS; i++)
+		md->pending[i] -= MIN(md->pending[i], commit);
+	md->mixed -= commit;
+
+	sink_bytes = commit * audio_stream_frame_bytes(&sink->stream);
+
+	comp_dbg(dev, "mixer_copy(), sink_bytes = 0x%x", sink_bytes);
+
+	buffer_writeback(sink, sink_bytes);
+	comp_update_buffer_produce(sink, sink_bytes);
+
+	return 0;
+}
+#else
 /*
  * Mix N source PCM streams to one sink PCM stream. Frames copied is constant.
+ * Sources are scaled by their gains within the mix if any of them is not
+ * at unity gain.
  */
-static int mixer_copy(struct comp_dev *dev)
+static int __hot_text mixer_copy(struct comp_dev *dev)
 {
 	struct mixer_data *md = comp_get_drvdata(dev);
 	struct comp_buffer *sink;
 	struct comp_buffer *sources[PLATFORM_MAX_STREAMS];
 	const struct audio_stream *sources_stream[PLATFORM_MAX_STREAMS];
+	int32_t gains[PLATFORM_MAX_STREAMS];
 	struct comp_buffer *source;
 	struct list_item *blist;
 	int32_t i = 0;
+	int32_t index = 0;
 	int32_t num_mix_sources = 0;
+	int32_t num_audible_sources = 0;
 	uint32_t frames = INT32_MAX;
 	uint32_t source_bytes;
 	uint32_t sink_bytes;
@@ -291,18 +407,23 @@ static int mixer_copy(struct comp_dev *dev)
 			       source_list);
 
 	/* calculate the highest runtime component status
-	 * between input streams
+	 * between input streams, sources are connected to the list head
+	 * so walk it backwards to index them in order of connection
 	 */
-	list_for_item(blist, &dev->bsource_list) {
+	list_for_item_prev(blist, &dev->bsource_list) {
 		source = container_of(blist, struct comp_buffer, sink_list);
 
 		/* only mix the sources with the same state with mixer */
 		if (source->source->state == dev->state) {
 			sources[num_mix_sources] = source;
 			sources_stream[num_mix_sources] = &source->stream;
+			gains[num_mix_sources] = index < PLATFORM_MAX_STREAMS ?
+				md->gain[index] : MIXER_GAIN_UNITY;
 			num_mix_sources++;
 		}
 
+		index++;
+
 		/* too many sources ? */
 		if (num_mix_sources == PLATFORM_MAX_STREAMS - 1)
 			return 0;
@@ -334,11 +455,28 @@ static int mixer_copy(struct comp_dev *dev)
 	comp_dbg(dev, "mixer_copy(), source_bytes = 0x%x, sink_bytes = 0x%x",
 		 source_bytes, sink_bytes);
 
-	/* mix streams */
-	for (i = num_mix_sources - 1; i >= 0; i--)
+	/* silent sources add nothing to the mix, they are left out */
+	for (i = 0; i < num_mix_sources; i++) {
+		if (buffer_is_silent(sources[i]))
+			continue;
+
 		buffer_invalidate(sources[i], source_bytes);
-	md->mix_func(dev, &sink->stream, sources_stream, num_mix_sources,
-		     frames);
+		sources_stream[num_audible_sources] = sources_stream[i];
+		gains[num_audible_sources] = gains[i];
+		num_audible_sources++;
+	}
+
+	/* mix streams */
+	if (!num_audible_sources) {
+		audio_stream_set_zero(&sink->stream, sink_bytes);
+		buffer_mark_silence(sink);
+	} else if (md->gain_active) {
+		md->mix_gain_func(dev, &sink->stream, sources_stream, gains,
+				  num_audible_sources, frames);
+	} else {
+		md->mix_func(dev, &sink->stream, sources_stream,
+			     num_audible_sources, frames);
+	}
 	buffer_writeback(sink, sink_bytes);
 
 	/* update source buffer pointers */
@@ -350,6 +488,7 @@ static int mixer_copy(struct comp_dev *dev)
 
 	return 0;
 }
+#endif
 
 static int mixer_reset(struct comp_dev *dev)
 {
@@ -395,27 +534,27 @@ static int mixer_prepare(struct comp_dev *dev)
 	/* does mixer already have active source streams ? */
 	if (dev->state != COMP_STATE_ACTIVE) {
 		/* currently inactive so setup mixer */
-		switch (sink->stream.frame_fmt) {
-#if CONFIG_FORMAT_S16LE
-		case SOF_IPC_FRAME_S16_LE:
-			md->mix_func = mix_n_s16;
-			break;
-#endif /* CONFIG_FORMAT_S16LE */
-#if CONFIG_FORMAT_S24LE
-		case SOF_IPC_FRAME_S24_4LE:
-			md->mix_func = mix_n_s32;
-			break;
-#endif /* CONFIG_FORMAT_S24LE */
-#if CONFIG_FORMAT_S32LE
-		case SOF_IPC_FRAME_S32_LE:
-			md->mix_func = mix_n_s32;
-			break;
-#endif /* CONFIG_FORMAT_S32LE */
-		default:
+		md->mix_func =
+			mixer_get_processing_function(sink->stream.frame_fmt);
+		md->mix_gain_func =
+			mixer_get_gain_function(sink->stream.frame_fmt);
+		if (!md->mix_func || !md->mix_gain_func) {
+			comp_err(dev, "unsupported data format");
+			return -EINVAL;
+		}
+
+#if CONFIG_COMP_MIXER_ASYNC
+		md->acc_func = mixer_get_acc_function(sink->stream.frame_fmt);
+		if (!md->acc_func) {
 			comp_err(dev, "unsupported data format");
 			return -EINVAL;
 		}
 
+		/* sink is reset, nothing is mixed ahead of it */
+		memset(md->pending, 0, sizeof(md->pending));
+		md->mixed = 0;
+#endif
+
 		ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
 		if (ret < 0)
 			return ret;
@@ -448,6 +587,7 @@ static const struct comp_driver comp_mixer = {
 		.params		= mixer_params,
 		.prepare	= mixer_prepare,
 		.trigger	= mixer_trigger,
+		.cmd		= mixer_cmd,
 		.copy		= mixer_copy,
 		.reset		= mixer_reset,
 	},
@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/mixer/mixer_gain.c
+ * \brief Mixer processing with source gains implementation
+ */
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/format.h>
+#include <sof/audio/mixer.h>
+#include <sof/common.h>
+#include <sof/compiler_attributes.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <ipc/stream.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if CONFIG_FORMAT_S16LE
+/* Mix n 16 bit PCM source streams scaled by their gains to one sink stream */
+static void __hot_text mix_n_gain_s16(struct comp_dev *dev,
+				      struct audio_stream *sink,
+				      const struct audio_stream **sources,
+				      const int32_t *gains,
+				      uint32_t num_sources, uint32_t frames)
+{
+	int16_t *src[PLATFORM_MAX_STREAMS];
+	int16_t *dest = sink->w_ptr;
+	int64_t val;
+	uint32_t samples = frames * sink->channels;
+	uint32_t span;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+
+	for (j = 0; j < num_sources; j++)
+		src[j] = sources[j]->r_ptr;
+
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s16(sink, dest);
+		n = MIN(n, samples);
+		for (j = 0; j < num_sources; j++) {
+			span = audio_stream_samples_without_wrap_s16(sources[j],
+								     src[j]);
+			n = MIN(n, span);
+		}
+
+		for (i = 0; i < n; i++) {
+			val = 0;
+
+			/* accumulate Q1.15 x Q8.16 products */
+			for (j = 0; j < num_sources; j++) {
+				val += (int64_t)*src[j] * gains[j];
+				src[j]++;
+			}
+
+			/* round and saturate to 16 bits once */
+			*dest = sat_int16(Q_SHIFT_RND(val, 31, 15));
+			dest++;
+		}
+
+		/* handle wrap at the end of span */
+		for (j = 0; j < num_sources; j++)
+			src[j] = audio_stream_wrap(sources[j], src[j]);
+		dest = audio_stream_wrap(sink, dest);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+/* Mix n 32 bit PCM source streams scaled by their gains to one sink stream */
+static void __hot_text mix_n_gain_s32(struct comp_dev *dev,
+				      struct audio_stream *sink,
+				      const struct audio_stream **sources,
+				      const int32_t *gains,
+				      uint32_t num_sources, uint32_t frames)
+{
+	int32_t *src[PLATFORM_MAX_STREAMS];
+	int32_t *dest = sink->w_ptr;
+	int64_t val;
+	uint32_t samples = frames * sink->channels;
+	uint32_t span;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+
+	for (j = 0; j < num_sources; j++)
+		src[j] = sources[j]->r_ptr;
+
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s32(sink, dest);
+		n = MIN(n, samples);
+		for (j = 0; j < num_sources; j++) {
+			span = audio_stream_samples_without_wrap_s32(sources[j],
+								     src[j]);
+			n = MIN(n, span);
+		}
+
+		for (i = 0; i < n; i++) {
+			val = 0;
+
+			/* accumulate Q1.31 x Q8.16 products */
+			for (j = 0; j < num_sources; j++) {
+				val += (int64_t)*src[j] * gains[j];
+				src[j]++;
+			}
+
+			/* round and saturate to 32 bits once */
+			*dest = sat_int32(Q_SHIFT_RND(val, 47, 31));
+			dest++;
+		}
+
+		/* handle wrap at the end of span */
+		for (j = 0; j < num_sources; j++)
+			src[j] = audio_stream_wrap(sources[j], src[j]);
+		dest = audio_stream_wrap(sink, dest);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
+#if CONFIG_COMP_MIXER_ASYNC
+#if CONFIG_FORMAT_S16LE
+/* Scales n samples of source into sink, adds to sink samples if add is set */
+static inline void mix_acc_span_s16(const struct audio_stream *sink,
+				    int16_t **dest,
+				    const struct audio_stream *source,
+				    int16_t **src, int32_t gain,
+				    uint32_t samples, bool add)
+{
+	int32_t val;
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s16(sink, *dest);
+		n = MIN(n, samples);
+		n = MIN(n, audio_stream_samples_without_wrap_s16(source, *src));
+
+		for (i = 0; i < n; i++) {
+			val = Q_SHIFT_RND((int64_t)**src * gain, 31, 15);
+			if (add)
+				val += **dest;
+
+			**dest = sat_int16(val);
+			(*src)++;
+			(*dest)++;
+		}
+
+		*src = audio_stream_wrap(source, *src);
+		*dest = audio_stream_wrap(sink, *dest);
+		samples -= n;
+	}
+}
+
+/* Mixes 16 bit source stream into sink stream ahead of its write pointer */
+static void __hot_text mix_acc_s16(struct audio_stream *sink,
+				   const struct audio_stream *source,
+				   int32_t gain, uint32_t offset,
+				   uint32_t overlap, uint32_t frames)
+{
+	int16_t *src = source->r_ptr;
+	int16_t *dest = audio_stream_wrap(sink, (int16_t *)sink->w_ptr +
+					  offset * sink->channels);
+
+	mix_acc_span_s16(sink, &dest, source, &src, gain,
+			 overlap * sink->channels, true);
+	mix_acc_span_s16(sink, &dest, source, &src, gain,
+			 (frames - overlap) * sink->channels, false);
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+/* Scales n samples of source into sink, adds to sink samples if add is set */
+static inline void mix_acc_span_s32(const struct audio_stream *sink,
+				    int32_t **dest,
+				    const struct audio_stream *source,
+				    int32_t **src, int32_t gain,
+				    uint32_t samples, bool add)
+{
+	int64_t val;
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(sink, *dest);
+		n = MIN(n, samples);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(source, *src));
+
+		for (i = 0; i < n; i++) {
+			val = Q_SHIFT_RND((int64_t)**src * gain, 47, 31);
+			if (add)
+				val += **dest;
+
+			**dest = sat_int32(val);
+			(*src)++;
+			(*dest)++;
+		}
+
+		*src = audio_stream_wrap(source, *src);
+		*dest = audio_stream_wrap(sink, *dest);
+		samples -= n;
+	}
+}
+
+/* Mixes 32 bit source stream into sink stream ahead of its write pointer */
+static void __hot_text mix_acc_s32(struct audio_stream *sink,
+				   const struct audio_stream *source,
+				   int32_t gain, uint32_t offset,
+				   uint32_t overlap, uint32_t frames)
+{
+	int32_t *src = source->r_ptr;
+	int32_t *dest = audio_stream_wrap(sink, (int32_t *)sink->w_ptr +
+					  offset * sink->channels);
+
+	mix_acc_span_s32(sink, &dest, source, &src, gain,
+			 overlap * sink->channels, true);
+	mix_acc_span_s32(sink, &dest, source, &src, gain,
+			 (frames - overlap) * sink->channels, false);
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
+const struct mixer_acc_func_map mixer_acc_func_map[] = {
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, mix_acc_s16 },
+#endif
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, mix_acc_s32 },
+#endif
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, mix_acc_s32 },
+#endif
+};
+
+const size_t mixer_acc_func_count = ARRAY_SIZE(mixer_acc_func_map);
+#endif /* CONFIG_COMP_MIXER_ASYNC */
+
+const struct mixer_gain_func_map mixer_gain_func_map[] = {
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, mix_n_gain_s16 },
+#endif
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, mix_n_gain_s32 },
+#endif
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, mix_n_gain_s32 },
+#endif
+};
+
+const size_t mixer_gain_func_count = ARRAY_SIZE(mixer_gain_func_map);
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2016 Intel Corporation. All rights reserved.
+//
+// Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
+//         Keyon Jie <yang.jie@linux.intel.com>
+
+/**
+ * \file audio/mixer/mixer_generic.c
+ * \brief Mixer generic processing implementation
+ */
+
+#include <sof/audio/mixer.h>
+
+#ifdef MIXER_GENERIC
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <ipc/stream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if CONFIG_FORMAT_S16LE
+/* Mix n 16 bit PCM source streams to one sink stream */
+static void __hot_text mix_n_s16(struct comp_dev *dev,
+				 struct audio_stream *sink,
+				 const struct audio_stream **sources,
+				 uint32_t num_sources, uint32_t frames)
+{
+	int16_t *src[PLATFORM_MAX_STREAMS];
+	int16_t *dest = sink->w_ptr;
+	int32_t val;
+	uint32_t samples = frames * sink->channels;
+	uint32_t span;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+
+	for (j = 0; j < num_sources; j++)
+		src[j] = sources[j]->r_ptr;
+
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s16(sink, dest);
+		n = MIN(n, samples);
+		for (j = 0; j < num_sources; j++) {
+			span = audio_stream_samples_without_wrap_s16(sources[j],
+								     src[j]);
+			n = MIN(n, span);
+		}
+
+		for (i = 0; i < n; i++) {
+			val = 0;
+
+			for (j = 0; j < num_sources; j++) {
+				val += *src[j];
+				src[j]++;
+			}
+
+			/* Saturate to 16 bits */
+			*dest = sat_int16(val);
+			dest++;
+		}
+
+		/* handle wrap at the end of span */
+		for (j = 0; j < num_sources; j++)
+			src[j] = audio_stream_wrap(sources[j], src[j]);
+		dest = audio_stream_wrap(sink, dest);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+/* Mix n 32 bit PCM source streams to one sink stream */
+static void __hot_text mix_n_s32(struct comp_dev *dev,
+				 struct audio_stream *sink,
+				 const struct audio_stream **sources,
+				 uint32_t num_sources, uint32_t frames)
+{
+	int32_t *src[PLATFORM_MAX_STREAMS];
+	int32_t *dest = sink->w_ptr;
+	int64_t val;
+	uint32_t samples = frames * sink->channels;
+	uint32_t span;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+
+	for (j = 0; j < num_sources; j++)
+		src[j] = sources[j]->r_ptr;
+
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s32(sink, dest);
+		n = MIN(n, samples);
+		for (j = 0; j < num_sources; j++) {
+			span = audio_stream_samples_without_wrap_s32(sources[j],
+								     src[j]);
+			n = MIN(n, span);
+		}
+
+		for (i = 0; i < n; i++) {
+			val = 0;
+
+			for (j = 0; j < num_sources; j++) {
+				val += *src[j];
+				src[j]++;
+			}
+
+			/* Saturate to 32 bits */
+			*dest = sat_int32(val);
+			dest++;
+		}
+
+		/* handle wrap at the end of span */
+		for (j = 0; j < num_sources; j++)
+			src[j] = audio_stream_wrap(sources[j], src[j]);
+		dest = audio_stream_wrap(sink, dest);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
+const struct mixer_func_map mixer_func_map[] = {
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, mix_n_s16 },
+#endif
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, mix_n_s32 },
+#endif
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, mix_n_s32 },
+#endif
+};
+
+const size_t mixer_func_count = ARRAY_SIZE(mixer_func_map);
+
+#endif
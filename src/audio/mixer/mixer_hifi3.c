@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/mixer/mixer_hifi3.c
+ * \brief Mixer HiFi3 processing implementation
+ */
+
+#include <sof/audio/mixer.h>
+
+#ifdef MIXER_HIFI3
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <ipc/stream.h>
+#include <xtensa/tie/xt_hifi3.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if CONFIG_FORMAT_S16LE
+/**
+ * \brief HiFi3 enabled mixing of n 16 bit streams.
+ *
+ * Buffers are processed in spans that don't cross any of the buffer ends,
+ * so there is no need to switch circular buffer settings between sources.
+ * Four samples are mixed at a time with 32 bit accumulation and saturated
+ * to 16 bits on store.
+ *
+ * \param[in,out] dev Mixer base component device.
+ * \param[in,out] sink Destination stream.
+ * \param[in] sources Array of source streams.
+ * \param[in] num_sources Number of source streams.
+ * \param[in] frames Number of frames to process.
+ */
+static void __hot_text mix_n_s16(struct comp_dev *dev,
+				 struct audio_stream *sink,
+				 const struct audio_stream **sources,
+				 uint32_t num_sources, uint32_t frames)
+{
+	void *in[PLATFORM_MAX_STREAMS];
+	ae_valign align_in[PLATFORM_MAX_STREAMS];
+	ae_valign align_out = AE_ZALIGN64();
+	ae_int16x4 *out = sink->w_ptr;
+	ae_int16x4 *pin;
+	ae_int16x4 sample = AE_ZERO16();
+	ae_int32x2 acc_h;
+	ae_int32x2 acc_l;
+	ae_int32x2 tmp;
+	uint32_t samples = frames * sink->channels;
+	uint32_t span;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+	int16_t *src;
+	int16_t *dest;
+	int32_t val;
+
+	for (j = 0; j < num_sources; j++)
+		in[j] = sources[j]->r_ptr;
+
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s16(sink, out);
+		n = MIN(n, samples);
+		for (j = 0; j < num_sources; j++) {
+			span = audio_stream_samples_without_wrap_s16(sources[j],
+								     in[j]);
+			n = MIN(n, span);
+		}
+
+		for (j = 0; j < num_sources; j++)
+			align_in[j] = AE_LA64_PP(in[j]);
+
+		/* main loop processes 4 samples at a time */
+		for (i = 0; i < (n >> 2); i++) {
+			acc_h = AE_ZERO32();
+			acc_l = AE_ZERO32();
+
+			for (j = 0; j < num_sources; j++) {
+				pin = in[j];
+				AE_LA16X4_IP(sample, align_in[j], pin);
+				in[j] = pin;
+
+				/* sign extend to 32 bits and accumulate */
+				tmp = AE_SRAI32(AE_CVT32X2F16_32(sample), 16);
+				acc_h = AE_ADD32S(acc_h, tmp);
+				tmp = AE_SRAI32(AE_CVT32X2F16_10(sample), 16);
+				acc_l = AE_ADD32S(acc_l, tmp);
+			}
+
+			/* saturate to 16 bits and store four samples */
+			sample = AE_ROUND16X4F32SSYM(AE_SLAI32S(acc_h, 16),
+						     AE_SLAI32S(acc_l, 16));
+			AE_SA16X4_IP(sample, align_out, out);
+		}
+
+		/* flush align_out register to memory */
+		AE_SA64POS_FP(align_out, out);
+
+		/* mix remaining samples of the span one by one */
+		for (i = 0; i < (n & 0x3); i++) {
+			val = 0;
+
+			for (j = 0; j < num_sources; j++) {
+				src = in[j];
+				val += *src;
+				in[j] = src + 1;
+			}
+
+			dest = (int16_t *)out;
+			*dest = sat_int16(val);
+			out = (ae_int16x4 *)(dest + 1);
+		}
+
+		/* handle wrap at the end of span */
+		for (j = 0; j < num_sources; j++)
+			in[j] = audio_stream_wrap(sources[j], in[j]);
+		out = audio_stream_wrap(sink, out);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+/**
+ * \brief HiFi3 enabled mixing of n 32 bit streams.
+ *
+ * Buffers are processed in spans that don't cross any of the buffer ends.
+ * Two samples are mixed at a time using saturating 32 bit additions.
+ *
+ * \param[in,out] dev Mixer base component device.
+ * \param[in,out] sink Destination stream.
+ * \param[in] sources Array of source streams.
+ * \param[in] num_sources Number of source streams.
+ * \param[in] frames Number of frames to process.
+ */
+static void __hot_text mix_n_s32(struct comp_dev *dev,
+				 struct audio_stream *sink,
+				 const struct audio_stream **sources,
+				 uint32_t num_sources, uint32_t frames)
+{
+	void *in[PLATFORM_MAX_STREAMS];
+	ae_valign align_in[PLATFORM_MAX_STREAMS];
+	ae_valign align_out = AE_ZALIGN64();
+	ae_int32x2 *out = sink->w_ptr;
+	ae_int32x2 *pin;
+	ae_int32x2 sample = AE_ZERO32();
+	ae_int32x2 acc;
+	uint32_t samples = frames * sink->channels;
+	uint32_t span;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+	int32_t *src;
+	int32_t *dest;
+	int64_t val;
+
+	for (j = 0; j < num_sources; j++)
+		in[j] = sources[j]->r_ptr;
+
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s32(sink, out);
+		n = MIN(n, samples);
+		for (j = 0; j < num_sources; j++) {
+			span = audio_stream_samples_without_wrap_s32(sources[j],
+								     in[j]);
+			n = MIN(n, span);
+		}
+
+		for (j = 0; j < num_sources; j++)
+			align_in[j] = AE_LA64_PP(in[j]);
+
+		/* main loop processes 2 samples at a time */
+		for (i = 0; i < (n >> 1); i++) {
+			acc = AE_ZERO32();
+
+			for (j = 0; j < num_sources; j++) {
+				pin = in[j];
+				AE_LA32X2_IP(sample, align_in[j], pin);
+				in[j] = pin;
+				acc = AE_ADD32S(acc, sample);
+			}
+
+			AE_SA32X2_IP(acc, align_out, out);
+		}
+
+		/* flush align_out register to memory */
+		AE_SA64POS_FP(align_out, out);
+
+		/* mix the last sample of the span */
+		if (n & 0x1) {
+			val = 0;
+
+			for (j = 0; j < num_sources; j++) {
+				src = in[j];
+				val += *src;
+				in[j] = src + 1;
+			}
+
+			dest = (int32_t *)out;
+			*dest = sat_int32(val);
+			out = (ae_int32x2 *)(dest + 1);
+		}
+
+		/* handle wrap at the end of span */
+		for (j = 0; j < num_sources; j++)
+			in[j] = audio_stream_wrap(sources[j], in[j]);
+		out = audio_stream_wrap(sink, out);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
+const struct mixer_func_map mixer_func_map[] = {
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, mix_n_s16 },
+#endif
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, mix_n_s32 },
+#endif
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, mix_n_s32 },
+#endif
+};
+
+const size_t mixer_func_count = ARRAY_SIZE(mixer_func_map);
+
+#endif
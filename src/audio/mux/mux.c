@@ -287,9 +287,7 @@ static int demux_copy(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct comp_buffer *source;
-	struct comp_buffer *sink;
 	struct comp_buffer *sinks[MUX_MAX_STREAMS] = { NULL };
-	struct list_item *clist;
 	uint32_t num_sinks = 0;
 	uint32_t i = 0;
 	uint32_t frames = -1;
@@ -306,13 +304,12 @@ static int demux_copy(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
-	// align sink streams with their respective configurations
-	list_for_item(clist, &dev->bsink_list) {
-		sink = container_of(clist, struct comp_buffer, source_list);
-		if (sink->sink->state == dev->state) {
+	/* sinks aligned with their configurations in prepare */
+	for (i = 0; i < MUX_MAX_STREAMS; i++) {
+		if (cd->streams[i] &&
+		    cd->streams[i]->sink->state == dev->state) {
 			num_sinks++;
-			i = get_stream_index(cd, sink->pipeline_id);
-			sinks[i] = sink;
+			sinks[i] = cd->streams[i];
 		}
 	}
 
@@ -351,9 +348,11 @@ static int demux_copy(struct comp_dev *dev)
 				 audio_stream_frame_bytes(&sinks[i]->stream);
 	}
 
-	/* produce output, one sink at a time */
+	/* produce output, one sink at a time, broadcast readers get the
+	 * output of their writer
+	 */
 	for (i = 0; i < MUX_MAX_STREAMS; i++) {
-		if (!sinks[i])
+		if (!sinks[i] || buffer_broadcast_joined(sinks[i]))
 			continue;
 
 		buffer_invalidate(source, source_bytes);
@@ -364,7 +363,7 @@ static int demux_copy(struct comp_dev *dev)
 
 	/* update components */
 	for (i = 0; i < MUX_MAX_STREAMS; i++) {
-		if (!sinks[i])
+		if (!sinks[i] || buffer_broadcast_joined(sinks[i]))
 			continue;
 		comp_update_buffer_produce(sinks[i], sinks_bytes[i]);
 	}
@@ -381,7 +380,6 @@ static int mux_copy(struct comp_dev *dev)
 	struct comp_buffer *source;
 	struct comp_buffer *sources[MUX_MAX_STREAMS] = { NULL };
 	const struct audio_stream *sources_stream[MUX_MAX_STREAMS] = { NULL };
-	struct list_item *clist;
 	uint32_t num_sources = 0;
 	uint32_t i = 0;
 	uint32_t frames = -1;
@@ -397,13 +395,14 @@ static int mux_copy(struct comp_dev *dev)
 		return -EINVAL;
 	}
 
-	/* align source streams with their respective configurations */
-	list_for_item(clist, &dev->bsource_list) {
-		source = container_of(clist, struct comp_buffer, sink_list);
+	/* sources aligned with their configurations in prepare */
+	for (i = 0; i < MUX_MAX_STREAMS; i++) {
+		source = cd->streams[i];
+		if (!source)
+			continue;
 		buffer_lock(source, &flags);
 		if (source->source->state == dev->state) {
 			num_sources++;
-			i = get_stream_index(cd, source->pipeline_id);
 			sources[i] = source;
 			sources_stream[i] = &source->stream;
 		} else {
@@ -475,6 +474,32 @@ static int mux_reset(struct comp_dev *dev)
 	return comp_set_state(dev, COMP_TRIGGER_RESET);
 }
 
+/* caches the connected buffer of each configured stream */
+static void mux_prepare_streams(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *buffer;
+	struct list_item *clist;
+
+	memset(cd->streams, 0, sizeof(cd->streams));
+
+	if (dev->comp.type == SOF_COMP_MUX) {
+		list_for_item(clist, &dev->bsource_list) {
+			buffer = container_of(clist, struct comp_buffer,
+					      sink_list);
+			cd->streams[get_stream_index(cd, buffer->pipeline_id)] =
+				buffer;
+		}
+	} else {
+		list_for_item(clist, &dev->bsink_list) {
+			buffer = container_of(clist, struct comp_buffer,
+					      source_list);
+			cd->streams[get_stream_index(cd, buffer->pipeline_id)] =
+				buffer;
+		}
+	}
+}
+
 static int mux_prepare(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
@@ -482,6 +507,9 @@ static int mux_prepare(struct comp_dev *dev)
 
 	comp_info(dev, "mux_prepare()");
 
+	/* buffers are connected before and kept until reset */
+	mux_prepare_streams(dev);
+
 	if (dev->comp.type == SOF_COMP_MUX)
 		cd->mux = mux_get_processing_function(dev);
 	else
@@ -15,6 +15,7 @@
 #include <sof/bit.h>
 #include <sof/common.h>
 #include <ipc/stream.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -134,8 +135,160 @@ static void mux_s16le(const struct comp_dev *dev, struct audio_stream *sink,
 		}
 	}
 }
+/* \brief Demuxing 16 bit streams by routing table.
+ *
+ * Each sink channel is copied from a single source channel found in
+ * the routing table prepared from masks, the source frame is wrapped
+ * once per frame instead of once per sample.
+ *
+ * \param[in,out] dev Demux base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ * \param[in] data Parameters describing channel count and routing.
+ */
+static void demux_route_s16le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream *source,
+			      uint32_t frames, struct mux_stream_data *data)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct mux_look_up *lookup =
+		&cd->lookup[data - cd->config.streams];
+	int16_t *src = source->r_ptr;
+	int16_t *dst = sink->w_ptr;
+	uint32_t i;
+	uint8_t out_ch;
+
+	for (i = 0; i < frames; i++) {
+		for (out_ch = 0; out_ch < data->num_channels; out_ch++)
+			dst[out_ch] = lookup->in_ch[out_ch] == MUX_LOOK_UP_NONE ?
+				0 : src[lookup->in_ch[out_ch]];
+
+		src = audio_stream_wrap(source, src + cd->config.num_channels);
+		dst = audio_stream_wrap(sink, dst + data->num_channels);
+	}
+}
+
+/* \brief Muxing 16 bit streams by routing table.
+ *
+ * Each sink channel is copied from a single channel of one source
+ * stream found in the routing table prepared from masks.
+ *
+ * \param[in,out] dev Mux base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] sources Array of source buffers.
+ * \param[in] frames Number of frames to process.
+ * \param[in] data Array of parameters describing channel count and routing for
+ *		   each stream.
+ */
+static void mux_route_s16le(const struct comp_dev *dev,
+			    struct audio_stream *sink,
+			    const struct audio_stream **sources,
+			    uint32_t frames, struct mux_stream_data *data)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct mux_look_up *lookup = &cd->lookup[0];
+	int16_t *src[MUX_MAX_STREAMS] = { NULL };
+	int16_t *dst = sink->w_ptr;
+	uint32_t i;
+	uint8_t out_ch;
+	uint8_t j;
+
+	for (j = 0; j < MUX_MAX_STREAMS; j++)
+		if (sources[j])
+			src[j] = sources[j]->r_ptr;
+
+	for (i = 0; i < frames; i++) {
+		for (out_ch = 0; out_ch < cd->config.num_channels; out_ch++) {
+			j = lookup->stream[out_ch];
+			dst[out_ch] = j == MUX_LOOK_UP_NONE || !src[j] ?
+				0 : src[j][lookup->in_ch[out_ch]];
+		}
+
+		for (j = 0; j < MUX_MAX_STREAMS; j++)
+			if (src[j])
+				src[j] = audio_stream_wrap(sources[j], src[j] +
+							   data[j].num_channels);
+		dst = audio_stream_wrap(sink, dst + cd->config.num_channels);
+	}
+}
 #endif /* CONFIG_FORMAT_S16LE */
 
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+/* routes 32 bit container samples, sign extending 24 bit ones */
+static inline void demux_route_s32(const struct comp_dev *dev,
+				   struct audio_stream *sink,
+				   const struct audio_stream *source,
+				   uint32_t frames,
+				   struct mux_stream_data *data, bool s24)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct mux_look_up *lookup =
+		&cd->lookup[data - cd->config.streams];
+	int32_t *src = source->r_ptr;
+	int32_t *dst = sink->w_ptr;
+	uint32_t i;
+	uint8_t out_ch;
+	int32_t sample;
+
+	for (i = 0; i < frames; i++) {
+		for (out_ch = 0; out_ch < data->num_channels; out_ch++) {
+			if (lookup->in_ch[out_ch] == MUX_LOOK_UP_NONE) {
+				dst[out_ch] = 0;
+				continue;
+			}
+
+			sample = src[lookup->in_ch[out_ch]];
+			dst[out_ch] = s24 ? sign_extend_s24(sample) : sample;
+		}
+
+		src = audio_stream_wrap(source, src + cd->config.num_channels);
+		dst = audio_stream_wrap(sink, dst + data->num_channels);
+	}
+}
+
+/* routes 32 bit container samples, sign extending 24 bit ones */
+static inline void mux_route_s32(const struct comp_dev *dev,
+				 struct audio_stream *sink,
+				 const struct audio_stream **sources,
+				 uint32_t frames,
+				 struct mux_stream_data *data, bool s24)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct mux_look_up *lookup = &cd->lookup[0];
+	int32_t *src[MUX_MAX_STREAMS] = { NULL };
+	int32_t *dst = sink->w_ptr;
+	uint32_t i;
+	uint8_t out_ch;
+	uint8_t j;
+	int32_t sample;
+
+	for (j = 0; j < MUX_MAX_STREAMS; j++)
+		if (sources[j])
+			src[j] = sources[j]->r_ptr;
+
+	for (i = 0; i < frames; i++) {
+		for (out_ch = 0; out_ch < cd->config.num_channels; out_ch++) {
+			j = lookup->stream[out_ch];
+			if (j == MUX_LOOK_UP_NONE || !src[j]) {
+				dst[out_ch] = 0;
+				continue;
+			}
+
+			sample = src[j][lookup->in_ch[out_ch]];
+			dst[out_ch] = s24 ? sign_extend_s24(sample) : sample;
+		}
+
+		for (j = 0; j < MUX_MAX_STREAMS; j++)
+			if (src[j])
+				src[j] = audio_stream_wrap(sources[j], src[j] +
+							   data[j].num_channels);
+		dst = audio_stream_wrap(sink, dst + cd->config.num_channels);
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
 #if CONFIG_FORMAT_S24LE
 /*
  * \brief Fetch 24b samples from source buffer and perform routing operations
@@ -251,6 +404,23 @@ static void mux_s24le(const struct comp_dev *dev, struct audio_stream *sink,
 		}
 	}
 }
+/* \brief Demuxing 24 bit streams by routing table. */
+static void demux_route_s24le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream *source,
+			      uint32_t frames, struct mux_stream_data *data)
+{
+	demux_route_s32(dev, sink, source, frames, data, true);
+}
+
+/* \brief Muxing 24 bit streams by routing table. */
+static void mux_route_s24le(const struct comp_dev *dev,
+			    struct audio_stream *sink,
+			    const struct audio_stream **sources,
+			    uint32_t frames, struct mux_stream_data *data)
+{
+	mux_route_s32(dev, sink, sources, frames, data, true);
+}
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
@@ -369,28 +539,131 @@ static void mux_s32le(const struct comp_dev *dev, struct audio_stream *sink,
 	}
 }
 
+/* \brief Demuxing 32 bit streams by routing table. */
+static void demux_route_s32le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream *source,
+			      uint32_t frames, struct mux_stream_data *data)
+{
+	demux_route_s32(dev, sink, source, frames, data, false);
+}
+
+/* \brief Muxing 32 bit streams by routing table. */
+static void mux_route_s32le(const struct comp_dev *dev,
+			    struct audio_stream *sink,
+			    const struct audio_stream **sources,
+			    uint32_t frames, struct mux_stream_data *data)
+{
+	mux_route_s32(dev, sink, sources, frames, data, false);
+}
 #endif /* CONFIG_FORMAT_S32LE */
 
 const struct comp_func_map mux_func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, &mux_s16le, &demux_s16le },
+	{ SOF_IPC_FRAME_S16_LE, &mux_s16le, &demux_s16le,
+	  &mux_route_s16le, &demux_route_s16le },
 #endif
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, &mux_s24le, &demux_s24le },
+	{ SOF_IPC_FRAME_S24_4LE, &mux_s24le, &demux_s24le,
+	  &mux_route_s24le, &demux_route_s24le },
 #endif
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, &mux_s32le, &demux_s32le },
+	{ SOF_IPC_FRAME_S32_LE, &mux_s32le, &demux_s32le,
+	  &mux_route_s32le, &demux_route_s32le },
 #endif
 };
 
+/* finds the only source channel of mask, false if it mixes channels */
+static bool mux_mask_route(uint8_t mask, uint8_t num_ch, uint8_t *in_ch)
+{
+	mask &= BIT(num_ch) - 1;
+	*in_ch = mask ? ffs(mask) - 1 : MUX_LOOK_UP_NONE;
+
+	return !(mask & (mask - 1));
+}
+
+/* builds sink channel sources, returns false if any channel is a mix */
+static bool mux_prepare_look_up_table(struct comp_data *cd)
+{
+	struct mux_look_up *lookup = &cd->lookup[0];
+	struct mux_stream_data *data;
+	uint8_t out_ch;
+	uint8_t in_ch;
+	uint8_t j;
+
+	for (out_ch = 0; out_ch < cd->config.num_channels; out_ch++) {
+		lookup->stream[out_ch] = MUX_LOOK_UP_NONE;
+		lookup->in_ch[out_ch] = MUX_LOOK_UP_NONE;
+
+		for (j = 0; j < MUX_MAX_STREAMS; j++) {
+			data = &cd->config.streams[j];
+			if (!mux_mask_route(data->mask[out_ch],
+					    data->num_channels, &in_ch))
+				return false;
+
+			if (in_ch == MUX_LOOK_UP_NONE)
+				continue;
+
+			/* mixed from more than one stream */
+			if (lookup->stream[out_ch] != MUX_LOOK_UP_NONE)
+				return false;
+
+			lookup->stream[out_ch] = j;
+			lookup->in_ch[out_ch] = in_ch;
+		}
+	}
+
+	return true;
+}
+
+/* builds source channel of each sink stream channel, false if mixing */
+static bool demux_prepare_look_up_table(struct comp_data *cd)
+{
+	struct mux_look_up *lookup;
+	struct mux_stream_data *data;
+	uint8_t out_ch;
+	uint8_t j;
+
+	for (j = 0; j < MUX_MAX_STREAMS; j++) {
+		data = &cd->config.streams[j];
+		lookup = &cd->lookup[j];
+
+		for (out_ch = 0; out_ch < data->num_channels; out_ch++) {
+			if (!mux_mask_route(data->mask[out_ch],
+					    cd->config.num_channels,
+					    &lookup->in_ch[out_ch]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static bool mux_channels_valid(struct comp_data *cd)
+{
+	uint8_t j;
+
+	if (cd->config.num_channels > PLATFORM_MAX_CHANNELS)
+		return false;
+
+	for (j = 0; j < MUX_MAX_STREAMS; j++)
+		if (cd->config.streams[j].num_channels > PLATFORM_MAX_CHANNELS)
+			return false;
+
+	return true;
+}
+
 mux_func mux_get_processing_function(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	uint8_t i;
 
+	cd->route = mux_channels_valid(cd) && mux_prepare_look_up_table(cd);
+
 	for (i = 0; i < ARRAY_SIZE(mux_func_map); i++) {
 		if (cd->config.frame_format == mux_func_map[i].frame_format)
-			return mux_func_map[i].mux_proc_func;
+			return cd->route ? mux_func_map[i].mux_route_func :
+				mux_func_map[i].mux_proc_func;
 	}
 
 	return NULL;
@@ -401,9 +674,12 @@ demux_func demux_get_processing_function(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	uint8_t i;
 
+	cd->route = mux_channels_valid(cd) && demux_prepare_look_up_table(cd);
+
 	for (i = 0; i < ARRAY_SIZE(mux_func_map); i++) {
 		if (cd->config.frame_format == mux_func_map[i].frame_format)
-			return mux_func_map[i].demux_proc_func;
+			return cd->route ? mux_func_map[i].demux_route_func :
+				mux_func_map[i].demux_proc_func;
 	}
 
 	return NULL;
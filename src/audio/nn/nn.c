@@ -0,0 +1,564 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/nn/nn.c
+ * \brief Component running a quantized neural network model
+ *
+ * One channel of the source is fed to the model a frame at a time. The
+ * model output either replaces the audio on all sink channels, like for
+ * noise suppression, or is a score notified to the host when it crosses
+ * the threshold while the audio passes, like for keyword detection. The
+ * model is a binary control blob and can only be changed while the
+ * stream is not prepared, its run-time memory is allocated at prepare.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/audio/nn/nn.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/drivers/ipc.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/uuid.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/string.h>
+#include <sof/trace/trace.h>
+#include <ipc/control.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <user/nn.h>
+#include <user/trace.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static const struct comp_driver comp_nn;
+
+/* 6ddd67bf-33ac-426c-8fed-2403e791f02b */
+DECLARE_SOF_UUID("nn", nn_uuid, 0x6ddd67bf, 0x33ac, 0x426c,
+		 0x8f, 0xed, 0x24, 0x03, 0xe7, 0x91, 0xf0, 0x2b);
+
+/* sample as Q1.15 */
+static int16_t nn_get_sample(const struct audio_stream *stream, uint32_t idx)
+{
+	int32_t *x32;
+
+	if (stream->frame_fmt == SOF_IPC_FRAME_S16_LE)
+		return *(int16_t *)audio_stream_read_frag_s16(stream, idx);
+
+	x32 = audio_stream_read_frag_s32(stream, idx);
+
+	/* 24 bit samples are sign extended by the shift */
+	if (stream->frame_fmt == SOF_IPC_FRAME_S24_4LE)
+		return (*x32 << 8) >> 16;
+
+	return *x32 >> 16;
+}
+
+static void nn_set_sample(const struct audio_stream *stream, uint32_t idx,
+			  int16_t sample)
+{
+	int32_t *y32;
+
+	if (stream->frame_fmt == SOF_IPC_FRAME_S16_LE) {
+		*(int16_t *)audio_stream_write_frag_s16(stream, idx) = sample;
+		return;
+	}
+
+	y32 = audio_stream_write_frag_s32(stream, idx);
+
+	if (stream->frame_fmt == SOF_IPC_FRAME_S24_4LE)
+		*y32 = (int32_t)sample << 8;
+	else
+		*y32 = (int32_t)sample << 16;
+}
+
+static void nn_score(const struct comp_dev *dev, int32_t score)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	/* notified once each time the score rises above threshold */
+	if (score < cd->config->threshold) {
+		cd->detected = false;
+		return;
+	}
+
+	if (cd->detected)
+		return;
+
+	cd->detected = true;
+
+	comp_info(dev, "nn_score(), score %d", score);
+
+	cd->event.event_type = SOF_CTRL_EVENT_KD;
+	cd->event.event_value = score;
+	ipc_msg_send(cd->msg, &cd->event, true);
+}
+
+/* runs model on one frame starting at frame offset of both streams */
+static void nn_process(const struct comp_dev *dev,
+		       const struct audio_stream *source,
+		       struct audio_stream *sink, uint32_t offset)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct sof_nn_config *cfg = cd->config;
+	int16_t *in = nn_model_input(&cd->model);
+	const int16_t *out;
+	uint32_t nch = source->channels;
+	uint32_t idx = offset * nch;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < cfg->frames; i++)
+		in[i] = nn_get_sample(source, idx + i * nch + cfg->channel);
+
+	out = nn_model_run(&cd->model);
+
+	if (cfg->output == SOF_NN_OUTPUT_SCORE) {
+		audio_stream_copy(source, offset *
+				  audio_stream_frame_bytes(source), sink,
+				  offset * audio_stream_frame_bytes(sink),
+				  cfg->frames *
+				  audio_stream_frame_bytes(source));
+		nn_score(dev, out[cfg->score_index]);
+		return;
+	}
+
+	for (i = 0; i < cfg->frames; i++)
+		for (j = 0; j < nch; j++)
+			nn_set_sample(sink, idx + i * nch + j, out[i]);
+}
+
+/* parses new model blob, the old one is kept if it is invalid */
+static int nn_set_model(struct comp_dev *dev, struct sof_nn_config *config,
+			uint32_t size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int ret;
+
+	ret = size >= sizeof(*config) && size == config->size ?
+	      nn_model_init(&cd->model, config) : -EINVAL;
+	if (ret < 0) {
+		comp_err(dev, "nn_set_model(): invalid model of size %u",
+			 size);
+		rfree(config);
+		if (cd->config)
+			nn_model_init(&cd->model, cd->config);
+		return ret;
+	}
+
+	rfree(cd->config);
+	cd->config = config;
+
+	comp_info(dev, "nn_set_model(), %u layers, %u frames",
+		  config->num_layers, config->frames);
+
+	return 0;
+}
+
+static void nn_free_data(struct comp_data *cd)
+{
+	nn_model_free(&cd->model);
+	ipc_msg_free(cd->msg);
+	rfree(cd->config_new);
+	rfree(cd->config);
+	rfree(cd);
+}
+
+static struct comp_dev *nn_new(const struct comp_driver *drv,
+			       struct sof_ipc_comp *comp)
+{
+	struct sof_ipc_comp_process *ipc_nn =
+		(struct sof_ipc_comp_process *)comp;
+	struct sof_ipc_comp_process *nn;
+	struct sof_nn_config *config;
+	struct comp_dev *dev;
+	struct comp_data *cd;
+	size_t bs = ipc_nn->size;
+	int ret;
+
+	comp_cl_info(&comp_nn, "nn_new()");
+
+	if (bs > SOF_NN_MAX_SIZE) {
+		comp_cl_err(&comp_nn, "nn_new(): model blob size = %u > SOF_NN_MAX_SIZE",
+			    bs);
+		return NULL;
+	}
+
+	dev = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_process));
+	if (!dev)
+		return NULL;
+	dev->drv = drv;
+	dev->size = COMP_SIZE(struct sof_ipc_comp_process);
+
+	nn = COMP_GET_IPC(dev, sof_ipc_comp_process);
+	ret = memcpy_s(nn, sizeof(*nn), ipc_nn,
+		       sizeof(struct sof_ipc_comp_process));
+	assert(!ret);
+
+	cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	/* build component event */
+	ipc_build_comp_event(&cd->event, comp->type, comp->id);
+	cd->event.num_elems = 0;
+
+	cd->msg = ipc_msg_init(cd->event.rhdr.hdr.cmd, sizeof(cd->event));
+	if (!cd->msg) {
+		comp_err(dev, "nn_new(): ipc notification init failed");
+		goto fail;
+	}
+
+	/* model may also be loaded later by binary control */
+	if (bs) {
+		config = rballoc(0, SOF_MEM_CAPS_RAM, bs);
+		if (!config)
+			goto fail;
+
+		ret = memcpy_s(config, bs, ipc_nn->data, bs);
+		assert(!ret);
+
+		if (nn_set_model(dev, config, bs) < 0)
+			goto fail;
+	}
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+
+fail:
+	nn_free_data(cd);
+	rfree(dev);
+	return NULL;
+}
+
+static void nn_free(struct comp_dev *dev)
+{
+	comp_info(dev, "nn_free()");
+
+	nn_free_data(comp_get_drvdata(dev));
+	rfree(dev);
+}
+
+static int nn_params(struct comp_dev *dev,
+		     struct sof_ipc_stream_params *params)
+{
+	struct comp_buffer *sourceb;
+	int ret;
+
+	comp_info(dev, "nn_params()");
+
+	ret = comp_verify_params(dev, 0, params);
+	if (ret < 0) {
+		comp_err(dev, "nn_params(): comp_verify_params() failed");
+		return ret;
+	}
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	switch (sourceb->stream.frame_fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+#endif
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+#endif
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+#endif
+		return 0;
+	default:
+		comp_err(dev, "nn_params(): unsupported format %u",
+			 sourceb->stream.frame_fmt);
+		return -EINVAL;
+	}
+}
+
+static int nn_cmd_set_data(struct comp_dev *dev,
+			   struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t size = cdata->num_elems + cdata->elems_remaining;
+	struct sof_nn_config *config;
+	uint32_t offset;
+	int ret;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		comp_err(dev, "nn_cmd_set_data(): invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	/* running model refers to its blob and arena */
+	if (dev->state != COMP_STATE_READY) {
+		comp_err(dev, "nn_cmd_set_data(): model can't change in state %u",
+			 dev->state);
+		return -EBUSY;
+	}
+
+	comp_info(dev, "nn_cmd_set_data(): blob size: %u msg_index %u",
+		  size, cdata->msg_index);
+
+	if (cdata->msg_index == 0) {
+		if (size > SOF_NN_MAX_SIZE)
+			return -EINVAL;
+
+		rfree(cd->config_new);
+		cd->config_new = rballoc(0, SOF_MEM_CAPS_RAM, size);
+		if (!cd->config_new) {
+			comp_err(dev, "nn_cmd_set_data(): buffer allocation failed");
+			return -ENOMEM;
+		}
+
+		cd->config_new_size = size;
+	} else if (!cd->config_new || size > cd->config_new_size) {
+		comp_err(dev, "nn_cmd_set_data(): unexpected fragment");
+		return -EINVAL;
+	}
+
+	offset = cd->config_new_size - size;
+	ret = memcpy_s((uint8_t *)cd->config_new + offset,
+		       cd->config_new_size - offset, cdata->data->data,
+		       cdata->num_elems);
+	assert(!ret);
+
+	if (cdata->elems_remaining)
+		return 0;
+
+	config = cd->config_new;
+	cd->config_new = NULL;
+
+	return nn_set_model(dev, config, cd->config_new_size);
+}
+
+static int nn_cmd_get_data(struct comp_dev *dev,
+			   struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t offset;
+	uint32_t bs;
+	int ret;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY || !cd->config) {
+		comp_err(dev, "nn_cmd_get_data(): invalid cdata->cmd or no model");
+		return -EINVAL;
+	}
+
+	max_size -= sizeof(struct sof_ipc_ctrl_data) +
+		    sizeof(struct sof_abi_hdr);
+
+	offset = cdata->msg_index * max_size;
+	if (offset >= cd->config->size)
+		return -EINVAL;
+
+	bs = MIN(cd->config->size - offset, max_size);
+	cdata->elems_remaining = cd->config->size - offset - bs;
+	cdata->num_elems = bs;
+
+	ret = memcpy_s(cdata->data->data, max_size,
+		       (uint8_t *)cd->config + offset, bs);
+	assert(!ret);
+
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = bs;
+
+	return 0;
+}
+
+static int nn_cmd(struct comp_dev *dev, int cmd, void *data,
+		  int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	comp_info(dev, "nn_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_DATA:
+		return nn_cmd_set_data(dev, cdata);
+	case COMP_CMD_GET_DATA:
+		return nn_cmd_get_data(dev, cdata, max_data_size);
+	default:
+		comp_err(dev, "nn_cmd(): invalid command");
+		return -EINVAL;
+	}
+}
+
+static int nn_trigger(struct comp_dev *dev, int cmd)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int ret;
+
+	comp_info(dev, "nn_trigger(), command = %u", cmd);
+
+	ret = comp_set_state(dev, cmd);
+	if (ret)
+		return ret;
+
+	/* recurrent state is kept over pause */
+	if (cmd == COMP_TRIGGER_START) {
+		nn_model_reset(&cd->model);
+		cd->detected = false;
+	}
+
+	return 0;
+}
+
+static int nn_copy(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_copy_limits cl;
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t frames = cd->config->frames;
+	uint32_t blocks;
+	uint32_t i;
+	uint32_t flags = 0;
+
+	comp_dbg(dev, "nn_copy()");
+
+	source = list_first_item(&dev->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
+			       source_list);
+
+	buffer_lock(source, &flags);
+	buffer_lock(sink, &flags);
+
+	comp_get_copy_limits(source, sink, &cl);
+
+	buffer_unlock(sink, flags);
+	buffer_unlock(source, flags);
+
+	/* the model runs on whole frames only */
+	blocks = cl.frames / frames;
+	if (!blocks)
+		return PPL_STATUS_PATH_STOP;
+
+	buffer_invalidate(source, blocks * frames * cl.source_frame_bytes);
+
+	for (i = 0; i < blocks; i++)
+		nn_process(dev, &source->stream, &sink->stream, i * frames);
+
+	buffer_writeback(sink, blocks * frames * cl.sink_frame_bytes);
+
+	comp_update_buffer_produce(sink, blocks * frames * cl.sink_frame_bytes);
+	comp_update_buffer_consume(source,
+				   blocks * frames * cl.source_frame_bytes);
+
+	return 0;
+}
+
+static int nn_prepare(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	int ret;
+
+	comp_info(dev, "nn_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	if (ret == COMP_STATUS_STATE_ALREADY_SET)
+		return PPL_STATUS_PATH_STOP;
+
+	if (!cd->config) {
+		comp_err(dev, "nn_prepare(): no model");
+		ret = -EINVAL;
+		goto err;
+	}
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+
+	if (sourceb->stream.frame_fmt != sinkb->stream.frame_fmt ||
+	    sourceb->stream.channels != sinkb->stream.channels ||
+	    cd->config->channel >= sourceb->stream.channels) {
+		comp_err(dev, "nn_prepare(): invalid streams for model channel %u",
+			 cd->config->channel);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	/* a model frame must fit in both buffers to ever run */
+	dev->min_source_bytes = cd->config->frames *
+		audio_stream_frame_bytes(&sourceb->stream);
+	dev->min_sink_bytes = cd->config->frames *
+		audio_stream_frame_bytes(&sinkb->stream);
+
+	if (sourceb->stream.size < dev->min_source_bytes ||
+	    sinkb->stream.size < dev->min_sink_bytes) {
+		comp_err(dev, "nn_prepare(): buffers smaller than model frame of %u",
+			 cd->config->frames);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	ret = nn_model_prepare(&cd->model);
+	if (ret < 0) {
+		comp_err(dev, "nn_prepare(): arena allocation failed");
+		goto err;
+	}
+
+	return 0;
+
+err:
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int nn_reset(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "nn_reset()");
+
+	nn_model_free(&cd->model);
+	cd->detected = false;
+	dev->min_source_bytes = 0;
+	dev->min_sink_bytes = 0;
+
+	return comp_set_state(dev, COMP_TRIGGER_RESET);
+}
+
+static const struct comp_driver comp_nn = {
+	.type	= SOF_COMP_NN,
+	.uid	= SOF_UUID(nn_uuid),
+	.ops	= {
+		.create		= nn_new,
+		.free		= nn_free,
+		.params		= nn_params,
+		.cmd		= nn_cmd,
+		.trigger	= nn_trigger,
+		.copy		= nn_copy,
+		.prepare	= nn_prepare,
+		.reset		= nn_reset,
+	},
+};
+
+static SHARED_DATA struct comp_driver_info comp_nn_info = {
+	.drv = &comp_nn,
+};
+
+static void sys_comp_nn_init(void)
+{
+	comp_register(platform_shared_get(&comp_nn_info,
+					  sizeof(comp_nn_info)));
+}
+
+DECLARE_MODULE(sys_comp_nn_init);
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/nn/nn.h>
+
+#if NN_GENERIC
+
+#include <sof/audio/format.h>
+#include <stdint.h>
+
+void nn_mac_s16(int32_t *acc, const int16_t *w, const int16_t *x,
+		uint32_t rows, uint32_t cols, int16_t *row)
+{
+	int64_t sum;
+	uint32_t r;
+	uint32_t c;
+
+	for (r = 0; r < rows; r++) {
+		sum = acc[r];
+		for (c = 0; c < cols; c++)
+			sum += (int32_t)w[c] * x[c];
+
+		acc[r] = sat_int32(sum);
+		w += cols;
+	}
+}
+
+void nn_mac_s8(int32_t *acc, const int8_t *w, const int16_t *x,
+	       uint32_t rows, uint32_t cols, int16_t *row)
+{
+	int64_t sum;
+	uint32_t r;
+	uint32_t c;
+
+	for (r = 0; r < rows; r++) {
+		sum = acc[r];
+		for (c = 0; c < cols; c++)
+			sum += (int32_t)w[c] * x[c];
+
+		acc[r] = sat_int32(sum);
+		w += cols;
+	}
+}
+
+#endif /* NN_GENERIC */
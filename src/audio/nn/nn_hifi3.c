@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/nn/nn.h>
+
+#if NN_HIFI3
+
+#include <sof/audio/format.h>
+#include <xtensa/config/defs.h>
+#include <xtensa/tie/xt_hifi3.h>
+#include <stdint.h>
+
+/* dot product of int16 vectors, saturated to int32 */
+static int32_t nn_dot_hifi3(const int16_t *w, const int16_t *x,
+			    uint32_t cols)
+{
+	const ae_int16x4 *wp = (const ae_int16x4 *)w;
+	const ae_int16x4 *xp = (const ae_int16x4 *)x;
+	ae_valign uw = AE_LA64_PP(wp);
+	ae_valign ux = AE_LA64_PP(xp);
+	ae_int16x4 w4;
+	ae_int16x4 x4;
+	ae_f64 a = AE_ZERO64();
+	int32_t sum;
+	uint32_t i;
+
+	for (i = 0; i < cols >> 2; i++) {
+		AE_LA16X4_IP(w4, uw, wp);
+		AE_LA16X4_IP(x4, ux, xp);
+
+		/* The input widened to Q1.31 by Q1.15 weights accumulates
+		 * in Q17.47, which is the integer product shifted left
+		 * by 17.
+		 */
+		AE_MULAAFD32X16_H3_L2(a, AE_CVT32X2F16_32(x4), w4);
+		AE_MULAAFD32X16_H1_L0(a, AE_CVT32X2F16_10(x4), w4);
+	}
+
+	/* high 32 bits of Q17.47 are the product when shifted left by 16 */
+	a = AE_SRAA64(a, 1);
+	sum = AE_MOVAD32_L(AE_ROUND32F48SSYM(a));
+
+	for (i = cols & ~3; i < cols; i++)
+		sum = sat_int32((int64_t)sum + (int32_t)w[i] * x[i]);
+
+	return sum;
+}
+
+void nn_mac_s16(int32_t *acc, const int16_t *w, const int16_t *x,
+		uint32_t rows, uint32_t cols, int16_t *row)
+{
+	uint32_t r;
+
+	for (r = 0; r < rows; r++) {
+		acc[r] = sat_int32((int64_t)acc[r] +
+				   nn_dot_hifi3(w, x, cols));
+		w += cols;
+	}
+}
+
+/* HiFi3 has no 8 bit multipliers, so each row is widened to the
+ * scratch row and multiplied by the 16 bit kernel
+ */
+void nn_mac_s8(int32_t *acc, const int8_t *w, const int16_t *x,
+	       uint32_t rows, uint32_t cols, int16_t *row)
+{
+	uint32_t r;
+	uint32_t c;
+
+	for (r = 0; r < rows; r++) {
+		for (c = 0; c < cols; c++)
+			row[c] = w[c];
+
+		acc[r] = sat_int32((int64_t)acc[r] +
+				   nn_dot_hifi3(row, x, cols));
+		w += cols;
+	}
+}
+
+#endif /* NN_HIFI3 */
@@ -0,0 +1,483 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/nn/nn_model.c
+ * \brief Quantized neural network model parsed from blob and run per frame
+ *
+ * Activations are int16, weights int8 or int16 and accumulators int32.
+ * Every layer reduces to matrix by vector products done by the
+ * architecture specific nn_mac_ kernels, requantization and activation
+ * tables are common code.
+ */
+
+#include <sof/audio/format.h>
+#include <sof/audio/nn/nn.h>
+#include <sof/common.h>
+#include <sof/lib/alloc.h>
+#include <sof/math/numbers.h>
+#include <ipc/topology.h>
+#include <user/nn.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* arena parts are aligned for 64 bit loads */
+#define NN_ARENA_ALIGN	8
+
+static const int16_t *nn_get_lut(const struct sof_nn_config *cfg,
+				 uint32_t index)
+{
+	const int16_t *luts = (const int16_t *)cfg->data;
+
+	if (index >= cfg->num_luts)
+		return NULL;
+
+	return luts + index * SOF_NN_LUT_SIZE;
+}
+
+static uint32_t nn_gates(uint32_t type)
+{
+	switch (type) {
+	case SOF_NN_LAYER_GRU:
+		return 3;
+	case SOF_NN_LAYER_LSTM:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+/* resolves parameters of layer fed by tensor of len time steps */
+static int nn_layer_init(struct nn_model *m, struct nn_layer *l,
+			 const struct sof_nn_layer *lc, uint32_t len)
+{
+	uint64_t wbytes = lc->weight_bits / 8;
+	uint64_t rows = nn_gates(lc->type) * lc->out_ch;
+	uint64_t cols = lc->in_ch;
+	uint64_t w_size;
+	uint64_t u_size = 0;
+	uint64_t b_size;
+	bool recurrent = false;
+
+	l->cfg = lc;
+	l->w = NULL;
+	l->u = NULL;
+	l->b = NULL;
+	l->bu = NULL;
+	l->state = NULL;
+	l->lut = nn_get_lut(m->config, lc->lut);
+	l->lut2 = nn_get_lut(m->config, lc->lut2);
+	l->in_len = len;
+	l->out_len = len;
+
+	if (!l->lut && lc->lut != SOF_NN_NO_LUT)
+		return -EINVAL;
+
+	switch (lc->type) {
+	case SOF_NN_LAYER_DENSE:
+		break;
+	case SOF_NN_LAYER_CONV1D:
+		if (!lc->kernel || !lc->stride || len < lc->kernel)
+			return -EINVAL;
+		l->out_len = (len - lc->kernel) / lc->stride + 1;
+		cols *= lc->kernel;
+		break;
+	case SOF_NN_LAYER_GRU:
+	case SOF_NN_LAYER_LSTM:
+		if (!l->lut || !l->lut2)
+			return -EINVAL;
+		recurrent = true;
+		break;
+	case SOF_NN_LAYER_ACT:
+		if (!l->lut || lc->out_ch != lc->in_ch)
+			return -EINVAL;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+
+	if (!lc->out_ch || lc->shift > 31 || lc->rshift > 31 ||
+	    (lc->weight_bits != 8 && lc->weight_bits != 16))
+		return -EINVAL;
+
+	w_size = ALIGN_UP(rows * cols * wbytes, 4);
+	if (recurrent)
+		u_size = ALIGN_UP(rows * lc->out_ch * wbytes, 4);
+	b_size = rows * sizeof(int32_t);
+
+	if (w_size + u_size + b_size *
+	    (lc->type == SOF_NN_LAYER_GRU ? 2 : 1) > lc->size - sizeof(*lc))
+		return -EINVAL;
+
+	l->w = lc->data;
+	if (recurrent)
+		l->u = lc->data + w_size;
+	l->b = (const int32_t *)(lc->data + w_size + u_size);
+	if (lc->type == SOF_NN_LAYER_GRU)
+		l->bu = l->b + rows;
+
+	/* recurrent layers keep input and recurrent products apart */
+	m->acc_size = MAX(m->acc_size, recurrent ? 2 * rows : rows);
+	if (recurrent)
+		m->state_size += lc->type == SOF_NN_LAYER_LSTM ?
+				 2 * lc->out_ch : lc->out_ch;
+	if (lc->weight_bits == 8)
+		m->row_size = MAX(m->row_size, MAX(cols, lc->out_ch));
+
+	return 0;
+}
+
+int nn_model_init(struct nn_model *m, const struct sof_nn_config *cfg)
+{
+	const uint8_t *end = (const uint8_t *)cfg + cfg->size;
+	const struct sof_nn_layer *lc;
+	const uint8_t *p;
+	uint32_t len = cfg->frames;
+	uint32_t ch = 1;
+	uint32_t i;
+	int ret;
+
+	if (cfg->size < sizeof(*cfg) || !cfg->frames ||
+	    cfg->frames > SOF_NN_MAX_SIZE ||
+	    !cfg->num_layers || cfg->num_layers > SOF_NN_MAX_LAYERS ||
+	    cfg->num_luts > SOF_NN_MAX_LUTS)
+		return -EINVAL;
+
+	if (cfg->num_luts * SOF_NN_LUT_SIZE * sizeof(int16_t) >
+	    cfg->size - sizeof(*cfg))
+		return -EINVAL;
+
+	p = cfg->data + cfg->num_luts * SOF_NN_LUT_SIZE * sizeof(int16_t);
+
+	m->config = cfg;
+	m->num_layers = cfg->num_layers;
+	m->tensor_size = len;
+	m->acc_size = 0;
+	m->state_size = 0;
+	m->row_size = 0;
+
+	for (i = 0; i < cfg->num_layers; i++) {
+		lc = (const struct sof_nn_layer *)p;
+		if ((size_t)(end - p) < sizeof(*lc) ||
+		    lc->size < sizeof(*lc) || lc->size > (size_t)(end - p) ||
+		    lc->in_ch != ch)
+			return -EINVAL;
+
+		ret = nn_layer_init(m, &m->layer[i], lc, len);
+		if (ret < 0)
+			return ret;
+
+		len = m->layer[i].out_len;
+		ch = lc->out_ch;
+		/* no tensor is larger than any model fitting in memory */
+		if ((uint64_t)len * ch > SOF_NN_MAX_SIZE)
+			return -EINVAL;
+
+		m->tensor_size = MAX(m->tensor_size, len * ch);
+		p += lc->size;
+	}
+
+	m->out_size = len * ch;
+
+	switch (cfg->output) {
+	case SOF_NN_OUTPUT_AUDIO:
+		if (m->out_size != cfg->frames)
+			return -EINVAL;
+		break;
+	case SOF_NN_OUTPUT_SCORE:
+		if (cfg->score_index >= m->out_size)
+			return -EINVAL;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int nn_model_prepare(struct nn_model *m)
+{
+	size_t tensor_bytes = ALIGN_UP(m->tensor_size * sizeof(int16_t),
+				       NN_ARENA_ALIGN);
+	size_t state_bytes = ALIGN_UP(m->state_size * sizeof(int16_t),
+				      NN_ARENA_ALIGN);
+	size_t acc_bytes = m->acc_size * sizeof(int32_t);
+	size_t row_bytes = 0;
+	int16_t *state;
+	uint8_t *p;
+	uint32_t i;
+
+#if NN_HIFI3
+	row_bytes = m->row_size * sizeof(int16_t);
+#endif
+
+	nn_model_free(m);
+
+	m->arena = rballoc_align(0, SOF_MEM_CAPS_RAM, 2 * tensor_bytes +
+				 state_bytes + acc_bytes + row_bytes,
+				 NN_ARENA_ALIGN);
+	if (!m->arena)
+		return -ENOMEM;
+
+	p = m->arena;
+	m->tensor[0] = (int16_t *)p;
+	p += tensor_bytes;
+	m->tensor[1] = (int16_t *)p;
+	p += tensor_bytes;
+	m->state = (int16_t *)p;
+	p += state_bytes;
+	m->acc = (int32_t *)p;
+	p += acc_bytes;
+	m->row = row_bytes ? (int16_t *)p : NULL;
+
+	state = m->state;
+	for (i = 0; i < m->num_layers; i++) {
+		switch (m->layer[i].cfg->type) {
+		case SOF_NN_LAYER_GRU:
+			m->layer[i].state = state;
+			state += m->layer[i].cfg->out_ch;
+			break;
+		case SOF_NN_LAYER_LSTM:
+			m->layer[i].state = state;
+			state += 2 * m->layer[i].cfg->out_ch;
+			break;
+		default:
+			break;
+		}
+	}
+
+	nn_model_reset(m);
+
+	return 0;
+}
+
+void nn_model_free(struct nn_model *m)
+{
+	rfree(m->arena);
+	m->arena = NULL;
+}
+
+void nn_model_reset(struct nn_model *m)
+{
+	uint32_t i;
+
+	if (!m->arena)
+		return;
+
+	for (i = 0; i < m->state_size; i++)
+		m->state[i] = 0;
+}
+
+/* rounds and saturates accumulator shifted right to int16 */
+static inline int32_t nn_requant(int32_t acc, uint32_t shift)
+{
+	if (!shift)
+		return sat_int16(acc);
+
+	return sat_int16(((int64_t)acc + ((int64_t)1 << (shift - 1))) >>
+			 shift);
+}
+
+static inline int32_t nn_mul_q15(int32_t a, int32_t b)
+{
+	return (a * b + (1 << 14)) >> 15;
+}
+
+/* table lookup with linear interpolation, identity without table */
+static inline int32_t nn_lut(const int16_t *lut, int32_t x)
+{
+	int32_t idx;
+	int32_t frac;
+	int32_t next;
+
+	if (!lut)
+		return x;
+
+	idx = (x >> 8) + SOF_NN_LUT_SIZE / 2;
+	frac = x & 0xff;
+	next = MIN(idx + 1, SOF_NN_LUT_SIZE - 1);
+
+	return lut[idx] + (((lut[next] - lut[idx]) * frac) >> 8);
+}
+
+static void nn_mac(const struct nn_model *m, const struct nn_layer *l,
+		   int32_t *acc, const int32_t *bias, const void *w,
+		   const int16_t *x, uint32_t rows, uint32_t cols)
+{
+	uint32_t i;
+
+	for (i = 0; i < rows; i++)
+		acc[i] = bias ? bias[i] : 0;
+
+	if (l->cfg->weight_bits == 8)
+		nn_mac_s8(acc, w, x, rows, cols, m->row);
+	else
+		nn_mac_s16(acc, w, x, rows, cols, m->row);
+}
+
+/* dense over each time step, or convolution over windows of time steps */
+static void nn_dense_run(const struct nn_model *m, const struct nn_layer *l,
+			 const int16_t *x, int16_t *y)
+{
+	const struct sof_nn_layer *lc = l->cfg;
+	uint32_t cols = lc->in_ch;
+	uint32_t step = lc->in_ch;
+	uint32_t t;
+	uint32_t i;
+
+	if (lc->type == SOF_NN_LAYER_CONV1D) {
+		cols *= lc->kernel;
+		step *= lc->stride;
+	}
+
+	for (t = 0; t < l->out_len; t++) {
+		nn_mac(m, l, m->acc, l->b, l->w, x, lc->out_ch, cols);
+		for (i = 0; i < lc->out_ch; i++)
+			y[i] = nn_lut(l->lut, nn_requant(m->acc[i], lc->shift));
+
+		x += step;
+		y += lc->out_ch;
+	}
+}
+
+static void nn_act_run(const struct nn_layer *l, const int16_t *x,
+		       int16_t *y)
+{
+	uint32_t n = l->in_len * l->cfg->in_ch;
+	uint32_t i;
+
+	for (i = 0; i < n; i++)
+		y[i] = nn_lut(l->lut, x[i]);
+}
+
+/* computes input and recurrent products of all gates for time step */
+static void nn_gates_run(const struct nn_model *m, const struct nn_layer *l,
+			 const int16_t *x)
+{
+	const struct sof_nn_layer *lc = l->cfg;
+	uint32_t rows = nn_gates(lc->type) * lc->out_ch;
+
+	nn_mac(m, l, m->acc, l->b, l->w, x, rows, lc->in_ch);
+	nn_mac(m, l, m->acc + rows, l->bu, l->u, l->state, rows, lc->out_ch);
+}
+
+/* Q4.11 input of gate of unit j */
+static inline int32_t nn_gate_in(const struct nn_model *m,
+				 const struct nn_layer *l, uint32_t gate,
+				 uint32_t j)
+{
+	const struct sof_nn_layer *lc = l->cfg;
+	uint32_t rows = nn_gates(lc->type) * lc->out_ch;
+	uint32_t k = gate * lc->out_ch + j;
+
+	return sat_int16(nn_requant(m->acc[k], lc->shift) +
+			 nn_requant(m->acc[rows + k], lc->rshift));
+}
+
+static void nn_gru_run(const struct nn_model *m, const struct nn_layer *l,
+		       const int16_t *x, int16_t *y)
+{
+	const struct sof_nn_layer *lc = l->cfg;
+	uint32_t units = lc->out_ch;
+	int32_t *acc_u = m->acc + 3 * units;
+	int16_t *h = l->state;
+	int32_t z;
+	int32_t r;
+	int32_t n;
+	uint32_t t;
+	uint32_t j;
+
+	for (t = 0; t < l->in_len; t++) {
+		nn_gates_run(m, l, x);
+
+		for (j = 0; j < units; j++) {
+			z = nn_lut(l->lut, nn_gate_in(m, l, 0, j));
+			r = nn_lut(l->lut, nn_gate_in(m, l, 1, j));
+
+			/* reset gate scales the recurrent product only */
+			n = nn_requant(m->acc[2 * units + j], lc->shift) +
+			    nn_mul_q15(r, nn_requant(acc_u[2 * units + j],
+						     lc->rshift));
+			n = nn_lut(l->lut2, sat_int16(n));
+
+			h[j] = sat_int16(nn_mul_q15(32768 - z, n) +
+					 nn_mul_q15(z, h[j]));
+			y[j] = h[j];
+		}
+
+		x += lc->in_ch;
+		y += units;
+	}
+}
+
+static void nn_lstm_run(const struct nn_model *m, const struct nn_layer *l,
+			const int16_t *x, int16_t *y)
+{
+	const struct sof_nn_layer *lc = l->cfg;
+	uint32_t units = lc->out_ch;
+	int16_t *h = l->state;
+	int16_t *c = l->state + units;
+	int32_t i;
+	int32_t f;
+	int32_t g;
+	int32_t o;
+	uint32_t t;
+	uint32_t j;
+
+	for (t = 0; t < l->in_len; t++) {
+		nn_gates_run(m, l, x);
+
+		for (j = 0; j < units; j++) {
+			i = nn_lut(l->lut, nn_gate_in(m, l, 0, j));
+			f = nn_lut(l->lut, nn_gate_in(m, l, 1, j));
+			g = nn_lut(l->lut2, nn_gate_in(m, l, 2, j));
+			o = nn_lut(l->lut, nn_gate_in(m, l, 3, j));
+
+			/* Q1.15 products to Q4.11 cell */
+			c[j] = sat_int16(nn_mul_q15(f, c[j]) +
+					 ((i * g + (1 << 18)) >> 19));
+			h[j] = sat_int16(nn_mul_q15(o, nn_lut(l->lut2, c[j])));
+			y[j] = h[j];
+		}
+
+		x += lc->in_ch;
+		y += units;
+	}
+}
+
+const int16_t *nn_model_run(struct nn_model *m)
+{
+	const struct nn_layer *l;
+	int16_t *x = m->tensor[0];
+	int16_t *y = m->tensor[1];
+	int16_t *tmp;
+	uint32_t i;
+
+	for (i = 0; i < m->num_layers; i++) {
+		l = &m->layer[i];
+
+		switch (l->cfg->type) {
+		case SOF_NN_LAYER_DENSE:
+		case SOF_NN_LAYER_CONV1D:
+			nn_dense_run(m, l, x, y);
+			break;
+		case SOF_NN_LAYER_GRU:
+			nn_gru_run(m, l, x, y);
+			break;
+		case SOF_NN_LAYER_LSTM:
+			nn_lstm_run(m, l, x, y);
+			break;
+		default:
+			nn_act_run(l, x, y);
+			break;
+		}
+
+		tmp = x;
+		x = y;
+		y = tmp;
+	}
+
+	return x;
+}
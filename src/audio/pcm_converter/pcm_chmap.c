@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/pcm_converter/pcm_chmap.c
+ * \brief Channel remapping copy between pipeline and DMA frames
+ *
+ * Lets host and DAI components extract, reorder or place channels while
+ * copying to or from their DMA buffers, instead of a selector or mux
+ * component with its own buffer.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/format.h>
+#include <sof/audio/pcm_converter.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+int pcm_chmap_init(struct pcm_chmap *chmap, uint32_t map,
+		   uint32_t dma_channels, bool to_dma)
+{
+	uint32_t channels = pcm_chmap_channels(map);
+	uint32_t dma_ch;
+	uint32_t ch;
+
+	if (!channels || !dma_channels ||
+	    dma_channels > PCM_CHMAP_MAX_CHANNELS)
+		return -EINVAL;
+
+	memset(chmap->ch, PCM_CHMAP_SILENCE, sizeof(chmap->ch));
+
+	for (ch = 0; ch < channels; ch++) {
+		dma_ch = SOF_IPC_CH_MAP_GET(map, ch) - 1;
+		if (dma_ch >= dma_channels)
+			return -EINVAL;
+
+		if (!to_dma) {
+			chmap->ch[ch] = dma_ch;
+			continue;
+		}
+
+		/* a DMA channel is written by one pipeline channel */
+		if (chmap->ch[dma_ch] != PCM_CHMAP_SILENCE)
+			return -EINVAL;
+
+		chmap->ch[dma_ch] = ch;
+	}
+
+	return 0;
+}
+
+bool pcm_chmap_supported(enum sof_ipc_frame in, enum sof_ipc_frame out)
+{
+	return in <= SOF_IPC_FRAME_S32_LE && out <= SOF_IPC_FRAME_S32_LE;
+}
+
+/* returns sample as Q1.31 */
+static inline int32_t pcm_chmap_get(const void *ptr, enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return (int32_t)*(const int16_t *)ptr << 16;
+	case SOF_IPC_FRAME_S24_4LE:
+		return sign_extend_s24(*(const int32_t *)ptr) << 8;
+	default:
+		return *(const int32_t *)ptr;
+	}
+}
+
+/* stores Q1.31 sample rounded to format */
+static inline void pcm_chmap_set(void *ptr, enum sof_ipc_frame fmt, int32_t x)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		*(int16_t *)ptr = sat_int16(Q_SHIFT_RND(x, 31, 15));
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		*(int32_t *)ptr = sat_int24(Q_SHIFT_RND(x, 31, 23));
+		break;
+	default:
+		*(int32_t *)ptr = x;
+		break;
+	}
+}
+
+void pcm_chmap_copy(const struct audio_stream *source,
+		    struct audio_stream *sink, uint32_t frames,
+		    const struct pcm_chmap *chmap)
+{
+	uint32_t src_bytes = audio_stream_sample_bytes(source);
+	uint32_t snk_bytes = audio_stream_sample_bytes(sink);
+	uint32_t src_frame = audio_stream_frame_bytes(source);
+	uint32_t snk_frame = audio_stream_frame_bytes(sink);
+	bool convert = source->frame_fmt != sink->frame_fmt;
+	char *src = source->r_ptr;
+	char *snk = sink->w_ptr;
+	const uint8_t *ch;
+	char *in;
+	char *out;
+	uint32_t n;
+	uint32_t i;
+
+	while (frames) {
+		n = MIN(frames, audio_stream_frames_without_wrap(source, src));
+		n = MIN(n, audio_stream_frames_without_wrap(sink, snk));
+
+		for (i = 0; i < n; i++) {
+			out = snk;
+			for (ch = chmap->ch; ch < chmap->ch + sink->channels;
+			     ch++) {
+				in = src + *ch * src_bytes;
+				if (*ch == PCM_CHMAP_SILENCE)
+					memset(out, 0, snk_bytes);
+				else if (convert)
+					pcm_chmap_set(out, sink->frame_fmt,
+						      pcm_chmap_get(in,
+							source->frame_fmt));
+				else if (snk_bytes == sizeof(int16_t))
+					*(int16_t *)out = *(int16_t *)in;
+				else
+					*(int32_t *)out = *(int32_t *)in;
+				out += snk_bytes;
+			}
+			src += src_frame;
+			snk += snk_frame;
+		}
+
+		frames -= n;
+		src = audio_stream_wrap(source, src);
+		snk = audio_stream_wrap(sink, snk);
+	}
+}
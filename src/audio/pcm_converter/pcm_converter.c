@@ -0,0 +1,579 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/pcm_converter/pcm_converter.c
+ * \brief PCM converter table and packed 24 bit and float conversions
+ *
+ * Conversions between 4 byte integer containers come from the generic or
+ * the HiFi3 implementation. Packed 24 bit samples have no aligned lanes
+ * and float has no HiFi3 support, so their conversions are shared by both.
+ * Buffers of packed samples always hold whole samples so a sample never
+ * crosses the buffer end.
+ */
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/format.h>
+#include <sof/audio/pcm_converter.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+#include <ipc/stream.h>
+#include <config.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if CONFIG_FORMAT_S24_3LE
+
+#define PCM_S24_3LE_BYTES	3
+
+/* number of packed samples till the buffer wrap */
+static inline uint32_t pcm_s24_3le_without_wrap(const struct audio_stream *s,
+						const uint8_t *ptr)
+{
+	return audio_stream_bytes_without_wrap(s, ptr) / PCM_S24_3LE_BYTES;
+}
+
+/* returns sign extended packed sample */
+static inline int32_t pcm_s24_3le_get(const uint8_t *ptr)
+{
+	return (int32_t)((uint32_t)ptr[0] << 8 | (uint32_t)ptr[1] << 16 |
+			 (uint32_t)ptr[2] << 24) >> 8;
+}
+
+static inline void pcm_s24_3le_set(uint8_t *ptr, int32_t x)
+{
+	ptr[0] = x;
+	ptr[1] = x >> 8;
+	ptr[2] = x >> 16;
+}
+
+/* Four packed samples starting at an aligned address fill three words,
+ * which are accessed whole instead of byte by byte.
+ */
+#define PCM_S24_3LE_WORD_SAMPLES	4
+
+static inline bool pcm_s24_3le_word_aligned(const uint8_t *ptr, uint32_t n)
+{
+	return n >= PCM_S24_3LE_WORD_SAMPLES &&
+		IS_ALIGNED((uintptr_t)ptr, sizeof(uint32_t));
+}
+
+/* returns four sign extended packed samples */
+static inline void pcm_s24_3le_get4(const uint8_t *ptr, int32_t *x)
+{
+	const uint32_t *w = (const uint32_t *)ptr;
+
+	x[0] = (int32_t)(w[0] << 8) >> 8;
+	x[1] = (int32_t)(w[0] >> 24 << 8 | w[1] << 16) >> 8;
+	x[2] = (int32_t)(w[1] >> 16 << 8 | w[2] << 24) >> 8;
+	x[3] = (int32_t)w[2] >> 8;
+}
+
+static inline void pcm_s24_3le_set4(uint8_t *ptr, const int32_t *x)
+{
+	uint32_t *w = (uint32_t *)ptr;
+
+	w[0] = ((uint32_t)x[0] & 0xffffff) | (uint32_t)x[1] << 24;
+	w[1] = ((uint32_t)x[1] >> 8 & 0xffff) | (uint32_t)x[2] << 16;
+	w[2] = ((uint32_t)x[2] >> 16 & 0xff) | (uint32_t)x[3] << 8;
+}
+
+static void pcm_copy_s24_3le(const struct audio_stream *source,
+			     uint32_t ioffset, struct audio_stream *sink,
+			     uint32_t ooffset, uint32_t samples)
+{
+	audio_stream_copy(source, ioffset * PCM_S24_3LE_BYTES, sink,
+			  ooffset * PCM_S24_3LE_BYTES,
+			  samples * PCM_S24_3LE_BYTES);
+}
+
+#if CONFIG_FORMAT_S16LE
+
+static void pcm_convert_s16_to_s24_3le(const struct audio_stream *source,
+				       uint32_t ioffset,
+				       struct audio_stream *sink,
+				       uint32_t ooffset, uint32_t samples)
+{
+	int16_t *src = audio_stream_read_frag_s16(source, ioffset);
+	uint8_t *dst = audio_stream_write_frag(sink, ooffset,
+					       PCM_S24_3LE_BYTES);
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s16(source, src);
+		n = MIN(n, pcm_s24_3le_without_wrap(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			pcm_s24_3le_set(dst, *src << 8);
+			src++;
+			dst += PCM_S24_3LE_BYTES;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+static void pcm_convert_s24_3le_to_s16(const struct audio_stream *source,
+				       uint32_t ioffset,
+				       struct audio_stream *sink,
+				       uint32_t ooffset, uint32_t samples)
+{
+	uint8_t *src = audio_stream_read_frag(source, ioffset,
+					      PCM_S24_3LE_BYTES);
+	int16_t *dst = audio_stream_write_frag_s16(sink, ooffset);
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = pcm_s24_3le_without_wrap(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s16(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = sat_int16(Q_SHIFT_RND(pcm_s24_3le_get(src),
+						     23, 15));
+			src += PCM_S24_3LE_BYTES;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+
+static void pcm_convert_s24_to_s24_3le(const struct audio_stream *source,
+				       uint32_t ioffset,
+				       struct audio_stream *sink,
+				       uint32_t ooffset, uint32_t samples)
+{
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	uint8_t *dst = audio_stream_write_frag(sink, ooffset,
+					       PCM_S24_3LE_BYTES);
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, pcm_s24_3le_without_wrap(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			if (pcm_s24_3le_word_aligned(dst, n - i)) {
+				pcm_s24_3le_set4(dst, src);
+				src += PCM_S24_3LE_WORD_SAMPLES;
+				dst += PCM_S24_3LE_WORD_SAMPLES *
+					PCM_S24_3LE_BYTES;
+				i += PCM_S24_3LE_WORD_SAMPLES - 1;
+				continue;
+			}
+
+			pcm_s24_3le_set(dst, *src);
+			src++;
+			dst += PCM_S24_3LE_BYTES;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+static void pcm_convert_s24_3le_to_s24(const struct audio_stream *source,
+				       uint32_t ioffset,
+				       struct audio_stream *sink,
+				       uint32_t ooffset, uint32_t samples)
+{
+	uint8_t *src = audio_stream_read_frag(source, ioffset,
+					      PCM_S24_3LE_BYTES);
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = pcm_s24_3le_without_wrap(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			if (pcm_s24_3le_word_aligned(src, n - i)) {
+				pcm_s24_3le_get4(src, dst);
+				src += PCM_S24_3LE_WORD_SAMPLES *
+					PCM_S24_3LE_BYTES;
+				dst += PCM_S24_3LE_WORD_SAMPLES;
+				i += PCM_S24_3LE_WORD_SAMPLES - 1;
+				continue;
+			}
+
+			*dst = pcm_s24_3le_get(src);
+			src += PCM_S24_3LE_BYTES;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+
+static void pcm_convert_s32_to_s24_3le(const struct audio_stream *source,
+				       uint32_t ioffset,
+				       struct audio_stream *sink,
+				       uint32_t ooffset, uint32_t samples)
+{
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	uint8_t *dst = audio_stream_write_frag(sink, ooffset,
+					       PCM_S24_3LE_BYTES);
+	int32_t x[PCM_S24_3LE_WORD_SAMPLES];
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, pcm_s24_3le_without_wrap(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			if (pcm_s24_3le_word_aligned(dst, n - i)) {
+				for (j = 0; j < PCM_S24_3LE_WORD_SAMPLES; j++)
+					x[j] = sat_int24(Q_SHIFT_RND(src[j],
+								     31, 23));
+				pcm_s24_3le_set4(dst, x);
+				src += PCM_S24_3LE_WORD_SAMPLES;
+				dst += PCM_S24_3LE_WORD_SAMPLES *
+					PCM_S24_3LE_BYTES;
+				i += PCM_S24_3LE_WORD_SAMPLES - 1;
+				continue;
+			}
+
+			pcm_s24_3le_set(dst,
+					sat_int24(Q_SHIFT_RND(*src, 31, 23)));
+			src++;
+			dst += PCM_S24_3LE_BYTES;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+static void pcm_convert_s24_3le_to_s32(const struct audio_stream *source,
+				       uint32_t ioffset,
+				       struct audio_stream *sink,
+				       uint32_t ooffset, uint32_t samples)
+{
+	uint8_t *src = audio_stream_read_frag(source, ioffset,
+					      PCM_S24_3LE_BYTES);
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+
+	while (samples) {
+		n = pcm_s24_3le_without_wrap(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			if (pcm_s24_3le_word_aligned(src, n - i)) {
+				pcm_s24_3le_get4(src, dst);
+				for (j = 0; j < PCM_S24_3LE_WORD_SAMPLES; j++)
+					dst[j] <<= 8;
+				src += PCM_S24_3LE_WORD_SAMPLES *
+					PCM_S24_3LE_BYTES;
+				dst += PCM_S24_3LE_WORD_SAMPLES;
+				i += PCM_S24_3LE_WORD_SAMPLES - 1;
+				continue;
+			}
+
+			*dst = pcm_s24_3le_get(src) << 8;
+			src += PCM_S24_3LE_BYTES;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+#endif /* CONFIG_FORMAT_S32LE */
+
+#endif /* CONFIG_FORMAT_S24_3LE */
+
+#if CONFIG_FORMAT_FLOAT
+
+#define PCM_FLOAT_SCALE_S16	32768.0f
+#define PCM_FLOAT_SCALE_S24	8388608.0f
+#define PCM_FLOAT_SCALE_S32	2147483648.0f
+
+/* scales and rounds float sample saturated to 32 bits, the range is
+ * checked before the conversion as float to integer overflow is undefined
+ */
+static inline int32_t pcm_float_to_int(float x, float scale)
+{
+	x *= scale;
+
+	if (!(x > -PCM_FLOAT_SCALE_S32))
+		return INT32_MIN;
+	if (x >= PCM_FLOAT_SCALE_S32 - 0.5f)
+		return INT32_MAX;
+
+	return (int32_t)(x < 0 ? x - 0.5f : x + 0.5f);
+}
+
+#if CONFIG_FORMAT_S16LE
+
+static void pcm_convert_s16_to_float(const struct audio_stream *source,
+				     uint32_t ioffset,
+				     struct audio_stream *sink,
+				     uint32_t ooffset, uint32_t samples)
+{
+	int16_t *src = audio_stream_read_frag_s16(source, ioffset);
+	float *dst = audio_stream_write_frag(sink, ooffset, sizeof(float));
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s16(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = *src * (1.0f / PCM_FLOAT_SCALE_S16);
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+static void pcm_convert_float_to_s16(const struct audio_stream *source,
+				     uint32_t ioffset,
+				     struct audio_stream *sink,
+				     uint32_t ooffset, uint32_t samples)
+{
+	float *src = audio_stream_read_frag(source, ioffset, sizeof(float));
+	int16_t *dst = audio_stream_write_frag_s16(sink, ooffset);
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s16(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = sat_int16(pcm_float_to_int(*src,
+							  PCM_FLOAT_SCALE_S16));
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+
+static void pcm_convert_s24_to_float(const struct audio_stream *source,
+				     uint32_t ioffset,
+				     struct audio_stream *sink,
+				     uint32_t ooffset, uint32_t samples)
+{
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	float *dst = audio_stream_write_frag(sink, ooffset, sizeof(float));
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = sign_extend_s24(*src) *
+			       (1.0f / PCM_FLOAT_SCALE_S24);
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+static void pcm_convert_float_to_s24(const struct audio_stream *source,
+				     uint32_t ioffset,
+				     struct audio_stream *sink,
+				     uint32_t ooffset, uint32_t samples)
+{
+	float *src = audio_stream_read_frag(source, ioffset, sizeof(float));
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = sat_int24(pcm_float_to_int(*src,
+							  PCM_FLOAT_SCALE_S24));
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+
+static void pcm_convert_s32_to_float(const struct audio_stream *source,
+				     uint32_t ioffset,
+				     struct audio_stream *sink,
+				     uint32_t ooffset, uint32_t samples)
+{
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	float *dst = audio_stream_write_frag(sink, ooffset, sizeof(float));
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = *src * (1.0f / PCM_FLOAT_SCALE_S32);
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+static void pcm_convert_float_to_s32(const struct audio_stream *source,
+				     uint32_t ioffset,
+				     struct audio_stream *sink,
+				     uint32_t ooffset, uint32_t samples)
+{
+	float *src = audio_stream_read_frag(source, ioffset, sizeof(float));
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
+	uint32_t i;
+
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = pcm_float_to_int(*src, PCM_FLOAT_SCALE_S32);
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
+	}
+}
+
+#endif /* CONFIG_FORMAT_S32LE */
+
+#endif /* CONFIG_FORMAT_FLOAT */
+
+const pcm_converter_func
+pcm_func_table[PCM_CONVERTER_FORMATS][PCM_CONVERTER_FORMATS] = {
+#if CONFIG_FORMAT_S16LE
+	[SOF_IPC_FRAME_S16_LE][SOF_IPC_FRAME_S16_LE] = audio_stream_copy_s16,
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	[SOF_IPC_FRAME_S24_4LE][SOF_IPC_FRAME_S24_4LE] = audio_stream_copy_s32,
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	[SOF_IPC_FRAME_S32_LE][SOF_IPC_FRAME_S32_LE] = audio_stream_copy_s32,
+#endif /* CONFIG_FORMAT_S32LE */
+#if CONFIG_FORMAT_FLOAT
+	[SOF_IPC_FRAME_FLOAT][SOF_IPC_FRAME_FLOAT] = audio_stream_copy_s32,
+#endif /* CONFIG_FORMAT_FLOAT */
+#if CONFIG_FORMAT_S24_3LE
+	[SOF_IPC_FRAME_S24_3LE][SOF_IPC_FRAME_S24_3LE] = pcm_copy_s24_3le,
+#endif /* CONFIG_FORMAT_S24_3LE */
+#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE
+	[SOF_IPC_FRAME_S16_LE][SOF_IPC_FRAME_S24_4LE] = pcm_convert_s16_to_s24,
+	[SOF_IPC_FRAME_S24_4LE][SOF_IPC_FRAME_S16_LE] = pcm_convert_s24_to_s16,
+#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE
+	[SOF_IPC_FRAME_S16_LE][SOF_IPC_FRAME_S32_LE] = pcm_convert_s16_to_s32,
+	[SOF_IPC_FRAME_S32_LE][SOF_IPC_FRAME_S16_LE] = pcm_convert_s32_to_s16,
+#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE */
+#if CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE
+	[SOF_IPC_FRAME_S24_4LE][SOF_IPC_FRAME_S32_LE] = pcm_convert_s24_to_s32,
+	[SOF_IPC_FRAME_S32_LE][SOF_IPC_FRAME_S24_4LE] = pcm_convert_s32_to_s24,
+#endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
+#if CONFIG_FORMAT_S24_3LE && CONFIG_FORMAT_S16LE
+	[SOF_IPC_FRAME_S16_LE][SOF_IPC_FRAME_S24_3LE] =
+		pcm_convert_s16_to_s24_3le,
+	[SOF_IPC_FRAME_S24_3LE][SOF_IPC_FRAME_S16_LE] =
+		pcm_convert_s24_3le_to_s16,
+#endif /* CONFIG_FORMAT_S24_3LE && CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24_3LE && CONFIG_FORMAT_S24LE
+	[SOF_IPC_FRAME_S24_4LE][SOF_IPC_FRAME_S24_3LE] =
+		pcm_convert_s24_to_s24_3le,
+	[SOF_IPC_FRAME_S24_3LE][SOF_IPC_FRAME_S24_4LE] =
+		pcm_convert_s24_3le_to_s24,
+#endif /* CONFIG_FORMAT_S24_3LE && CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S24_3LE && CONFIG_FORMAT_S32LE
+	[SOF_IPC_FRAME_S32_LE][SOF_IPC_FRAME_S24_3LE] =
+		pcm_convert_s32_to_s24_3le,
+	[SOF_IPC_FRAME_S24_3LE][SOF_IPC_FRAME_S32_LE] =
+		pcm_convert_s24_3le_to_s32,
+#endif /* CONFIG_FORMAT_S24_3LE && CONFIG_FORMAT_S32LE */
+#if CONFIG_FORMAT_FLOAT && CONFIG_FORMAT_S16LE
+	[SOF_IPC_FRAME_S16_LE][SOF_IPC_FRAME_FLOAT] = pcm_convert_s16_to_float,
+	[SOF_IPC_FRAME_FLOAT][SOF_IPC_FRAME_S16_LE] = pcm_convert_float_to_s16,
+#endif /* CONFIG_FORMAT_FLOAT && CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_FLOAT && CONFIG_FORMAT_S24LE
+	[SOF_IPC_FRAME_S24_4LE][SOF_IPC_FRAME_FLOAT] = pcm_convert_s24_to_float,
+	[SOF_IPC_FRAME_FLOAT][SOF_IPC_FRAME_S24_4LE] = pcm_convert_float_to_s24,
+#endif /* CONFIG_FORMAT_FLOAT && CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_FLOAT && CONFIG_FORMAT_S32LE
+	[SOF_IPC_FRAME_S32_LE][SOF_IPC_FRAME_FLOAT] = pcm_convert_s32_to_float,
+	[SOF_IPC_FRAME_FLOAT][SOF_IPC_FRAME_S32_LE] = pcm_convert_float_to_s32,
+#endif /* CONFIG_FORMAT_FLOAT && CONFIG_FORMAT_S32LE */
+};
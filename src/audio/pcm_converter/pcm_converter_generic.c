@@ -17,6 +17,7 @@
 #include <sof/audio/buffer.h>
 #include <sof/audio/format.h>
 #include <sof/common.h>
+#include <sof/math/numbers.h>
 #include <ipc/stream.h>
 #include <config.h>
 #include <stddef.h>
@@ -24,37 +25,56 @@
 
 #if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE
 
-static void pcm_convert_s16_to_s24(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s16_to_s24(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
-	uint32_t buff_frag = 0;
-	int16_t *src;
-	int32_t *dst;
+	int16_t *src = audio_stream_read_frag_s16(source, ioffset);
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
 	uint32_t i;
 
-	for (i = 0; i < samples; i++) {
-		src = audio_stream_read_frag_s16(source, buff_frag + ioffset);
-		dst = audio_stream_write_frag_s32(sink, buff_frag + ooffset);
-		*dst = *src << 8;
-		buff_frag++;
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s16(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = *src << 8;
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
 	}
 }
 
-static void pcm_convert_s24_to_s16(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s24_to_s16(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
-	uint32_t buff_frag = 0;
-	int32_t *src;
-	int16_t *dst;
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	int16_t *dst = audio_stream_write_frag_s16(sink, ooffset);
+	uint32_t n;
 	uint32_t i;
 
-	for (i = 0; i < samples; i++) {
-		src = audio_stream_read_frag_s32(source, buff_frag + ioffset);
-		dst = audio_stream_write_frag_s16(sink, buff_frag + ooffset);
-		*dst = sat_int16(Q_SHIFT_RND(sign_extend_s24(*src), 23, 15));
-		buff_frag++;
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s16(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = sat_int16(Q_SHIFT_RND(sign_extend_s24(*src),
+						     23, 15));
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
 	}
 }
 
@@ -62,37 +82,55 @@ static void pcm_convert_s24_to_s16(const struct audio_stream *source,
 
 #if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE
 
-static void pcm_convert_s16_to_s32(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s16_to_s32(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
-	uint32_t buff_frag = 0;
-	int16_t *src;
-	int32_t *dst;
+	int16_t *src = audio_stream_read_frag_s16(source, ioffset);
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
 	uint32_t i;
 
-	for (i = 0; i < samples; i++) {
-		src = audio_stream_read_frag_s16(source, buff_frag + ioffset);
-		dst = audio_stream_write_frag_s32(sink, buff_frag + ooffset);
-		*dst = *src << 16;
-		buff_frag++;
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s16(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = *src << 16;
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
 	}
 }
 
-static void pcm_convert_s32_to_s16(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s32_to_s16(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
-	uint32_t buff_frag = 0;
-	int32_t *src;
-	int16_t *dst;
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	int16_t *dst = audio_stream_write_frag_s16(sink, ooffset);
+	uint32_t n;
 	uint32_t i;
 
-	for (i = 0; i < samples; i++) {
-		src = audio_stream_read_frag_s32(source, buff_frag + ioffset);
-		dst = audio_stream_write_frag_s16(sink, buff_frag + ooffset);
-		*dst = sat_int16(Q_SHIFT_RND(*src, 31, 15));
-		buff_frag++;
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s16(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = sat_int16(Q_SHIFT_RND(*src, 31, 15));
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
 	}
 }
 
@@ -100,66 +138,58 @@ static void pcm_convert_s32_to_s16(const struct audio_stream *source,
 
 #if CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE
 
-static void pcm_convert_s24_to_s32(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s24_to_s32(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
-	uint32_t buff_frag = 0;
-	int32_t *src;
-	int32_t *dst;
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
 	uint32_t i;
 
-	for (i = 0; i < samples; i++) {
-		src = audio_stream_read_frag_s32(source, buff_frag + ioffset);
-		dst = audio_stream_write_frag_s32(sink, buff_frag + ooffset);
-		*dst = *src << 8;
-		buff_frag++;
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = *src << 8;
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
 	}
 }
 
-static void pcm_convert_s32_to_s24(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s32_to_s24(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
-	uint32_t buff_frag = 0;
-	int32_t *src;
-	int32_t *dst;
+	int32_t *src = audio_stream_read_frag_s32(source, ioffset);
+	int32_t *dst = audio_stream_write_frag_s32(sink, ooffset);
+	uint32_t n;
 	uint32_t i;
 
-	for (i = 0; i < samples; i++) {
-		src = audio_stream_read_frag_s32(source, buff_frag + ioffset);
-		dst = audio_stream_write_frag_s32(sink, buff_frag + ooffset);
-		*dst = sat_int24(Q_SHIFT_RND(*src, 31, 23));
-		buff_frag++;
+	while (samples) {
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dst));
+		n = MIN(n, samples);
+
+		for (i = 0; i < n; i++) {
+			*dst = sat_int24(Q_SHIFT_RND(*src, 31, 23));
+			src++;
+			dst++;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dst = audio_stream_wrap(sink, dst);
+		samples -= n;
 	}
 }
 
 #endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
 
-const struct pcm_func_map pcm_func_map[] = {
-#if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, audio_stream_copy_s16 },
-#endif /* CONFIG_FORMAT_S16LE */
-#if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, audio_stream_copy_s32 },
-#endif /* CONFIG_FORMAT_S24LE */
-#if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, audio_stream_copy_s32 },
-#endif /* CONFIG_FORMAT_S32LE */
-#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, pcm_convert_s16_to_s24 },
-	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE, pcm_convert_s24_to_s16 },
-#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE */
-#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, pcm_convert_s16_to_s32 },
-	{ SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, pcm_convert_s32_to_s16 },
-#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE */
-#if CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE, pcm_convert_s24_to_s32 },
-	{ SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, pcm_convert_s32_to_s24 },
-#endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
-};
-
-const size_t pcm_func_count = ARRAY_SIZE(pcm_func_map);
-
 #endif
@@ -40,9 +40,9 @@ static void pcm_converter_setup_circular(const struct audio_stream *source)
  * \param[in,out] sink Destination buffer.
  * \param[in] samples Number of samples to process.
  */
-static void pcm_convert_s16_to_s24(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s16_to_s24(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
 	ae_int16 *in = audio_stream_read_frag(source, ioffset, sizeof(int16_t));
 	ae_int32 *out = audio_stream_write_frag(sink, ooffset, sizeof(int32_t));
@@ -142,9 +142,9 @@ static ae_int32x2 pcm_shift_s24_to_s16(ae_int32x2 sample)
  * \param[in,out] sink Destination buffer.
  * \param[in] samples Number of samples to process.
  */
-static void pcm_convert_s24_to_s16(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s24_to_s16(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
 	ae_int32x2 *in = audio_stream_read_frag(source, ioffset,
 						sizeof(int32_t));
@@ -251,9 +251,9 @@ static void pcm_convert_s24_to_s16(const struct audio_stream *source,
  * \param[in,out] sink Destination buffer.
  * \param[in] samples Number of samples to process.
  */
-static void pcm_convert_s16_to_s32(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s16_to_s32(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
 	ae_int16 *in = audio_stream_read_frag(source, ioffset,
 					      sizeof(int16_t));
@@ -335,9 +335,9 @@ static void pcm_convert_s16_to_s32(const struct audio_stream *source,
  * \param[in,out] sink Destination buffer.
  * \param[in] samples Number of samples to process.
  */
-static void pcm_convert_s32_to_s16(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s32_to_s16(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
 	ae_int32x2 *in = audio_stream_read_frag(source, ioffset,
 						sizeof(int32_t));
@@ -440,9 +440,9 @@ static void pcm_convert_s32_to_s16(const struct audio_stream *source,
  * \param[in,out] sink Destination buffer.
  * \param[in] samples Number of samples to process.
  */
-static void pcm_convert_s24_to_s32(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s24_to_s32(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
 	ae_int32x2 *in = audio_stream_read_frag(source, ioffset,
 						sizeof(int32_t));
@@ -530,9 +530,9 @@ static ae_int32x2 pcm_shift_s32_to_s24(ae_int32x2 sample)
  * \param[in,out] sink Destination buffer.
  * \param[in] samples Number of samples to process.
  */
-static void pcm_convert_s32_to_s24(const struct audio_stream *source,
-				   uint32_t ioffset, struct audio_stream *sink,
-				   uint32_t ooffset, uint32_t samples)
+void pcm_convert_s32_to_s24(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples)
 {
 	ae_int32x2 *in = audio_stream_read_frag(source, ioffset,
 						sizeof(int32_t));
@@ -603,30 +603,4 @@ static void pcm_convert_s32_to_s24(const struct audio_stream *source,
 
 #endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
 
-const struct pcm_func_map pcm_func_map[] = {
-#if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, audio_stream_copy_s16 },
-#endif /* CONFIG_FORMAT_S16LE */
-#if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, audio_stream_copy_s32 },
-#endif /* CONFIG_FORMAT_S24LE */
-#if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, audio_stream_copy_s32 },
-#endif /* CONFIG_FORMAT_S32LE */
-#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S24_4LE, pcm_convert_s16_to_s24 },
-	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S16_LE, pcm_convert_s24_to_s16 },
-#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE */
-#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S32_LE, pcm_convert_s16_to_s32 },
-	{ SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S16_LE, pcm_convert_s32_to_s16 },
-#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE */
-#if CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S32_LE, pcm_convert_s24_to_s32 },
-	{ SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S24_4LE, pcm_convert_s32_to_s24 },
-#endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
-};
-
-const size_t pcm_func_count = ARRAY_SIZE(pcm_func_map);
-
 #endif
@@ -8,23 +8,30 @@
 #include <sof/audio/buffer.h>
 #include <sof/audio/component_ext.h>
 #include <sof/audio/pipeline.h>
+#include <sof/bit.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/idc.h>
 #include <sof/drivers/interrupt.h>
 #include <sof/drivers/ipc.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/idle.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/mm_heap.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
 #include <sof/math/numbers.h>
+#include <sof/schedule/edf_schedule.h>
 #include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
 #include <sof/spinlock.h>
 #include <sof/string.h>
+#include <sof/ut.h>
 #include <ipc/header.h>
 #include <ipc/stream.h>
+#include <ipc/trace.h>
 #include <ipc/topology.h>
 #include <errno.h>
 #include <stddef.h>
@@ -37,12 +44,24 @@ struct pipeline_data {
 	struct sof_ipc_stream_posn *posn;
 	struct pipeline *p;
 	int cmd;
+	uint32_t count;
+	struct list_item *group;	/* started pipelines wait here */
+	uint32_t remote_cores;	/* cores with component commands queued */
 };
 
 /* f11818eb-e92e-4082-82a3-dc54c604ebb3 */
 DECLARE_SOF_UUID("pipe-task", pipe_task_uuid, 0xf11818eb, 0xe92e, 0x4082,
 		 0x82,  0xa3, 0xdc, 0x54, 0xc6, 0x04, 0xeb, 0xb3);
 
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+/* 3e567138-9403-4976-ae4e-a11db289ff20 */
+DECLARE_SOF_UUID("pipe-idle", pipe_idle_task_uuid, 0x3e567138, 0x9403,
+		 0x4976, 0xae, 0x4e, 0xa1, 0x1d, 0xb2, 0x89, 0xff, 0x20);
+
+/* period of parking runs, each moves one buffer */
+#define PPL_PARK_PERIOD_US	1000
+#endif
+
 static SHARED_DATA struct pipeline_posn pipeline_posn;
 
 void pipeline_posn_init(struct sof *sof)
@@ -54,10 +73,13 @@ void pipeline_posn_init(struct sof *sof)
 }
 
 static enum task_state pipeline_task(void *arg);
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+static enum task_state pipeline_idle_task(void *arg);
+#endif
 
 /* create new pipeline - returns pipeline id or negative error */
-struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
-			      struct comp_dev *cd)
+struct pipeline __cold_text *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
+					  struct comp_dev *cd)
 {
 	struct sof_ipc_stream_posn posn;
 	struct pipeline *p;
@@ -75,6 +97,7 @@ struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 	/* init pipeline */
 	p->sched_comp = cd;
 	p->status = COMP_STATE_INIT;
+	list_init(&p->group_list);
 
 	ret = pipeline_posn_offset_get(&p->posn_offset);
 	if (ret < 0) {
@@ -88,6 +111,17 @@ struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 		       pipe_desc, sizeof(*pipe_desc));
 	assert(!ret);
 
+	/* deep buffer pipeline runs once per batch of periods, so all its
+	 * components and DMA buffers work on the batch at once
+	 */
+	if (p->ipc_pipe.batch_periods > 1)
+		p->ipc_pipe.period *= p->ipc_pipe.batch_periods;
+
+#if CONFIG_PIPELINE_QOS
+	p->tplg_period = p->ipc_pipe.period;
+	p->tplg_priority = p->ipc_pipe.priority;
+#endif
+
 	/* just for retrieving valid ipc_msg header */
 	ipc_build_stream_posn(&posn, SOF_IPC_STREAM_TRIG_XRUN,
 			      p->ipc_pipe.comp_id);
@@ -99,6 +133,35 @@ struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 		return NULL;
 	}
 
+#if CONFIG_PIPELINE_MCPS_BUDGET
+	p->budget_msg = ipc_msg_init(SOF_IPC_GLB_COMP_MSG |
+				     SOF_IPC_COMP_NOTIFICATION |
+				     p->ipc_pipe.comp_id,
+				     sizeof(struct sof_ipc_comp_event));
+	if (!p->budget_msg) {
+		pipe_cl_err("pipeline_new(): ipc_msg_init failed");
+		ipc_msg_free(p->msg);
+		rfree(p);
+		return NULL;
+	}
+#endif
+
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+	ret = schedule_task_init_ll(&p->idle_task,
+				    SOF_UUID(pipe_idle_task_uuid),
+				    SOF_SCHEDULE_LL_TIMER, SOF_TASK_PRI_LOW,
+				    pipeline_idle_task, p, p->ipc_pipe.core, 0);
+	if (ret < 0) {
+		pipe_cl_err("pipeline_new(): idle task init failed %d", ret);
+#if CONFIG_PIPELINE_MCPS_BUDGET
+		ipc_msg_free(p->budget_msg);
+#endif
+		ipc_msg_free(p->msg);
+		rfree(p);
+		return NULL;
+	}
+#endif
+
 	return p;
 }
 
@@ -111,8 +174,15 @@ int pipeline_connect(struct comp_dev *comp, struct comp_buffer *buffer,
 		     dev_comp_id(comp), buffer->id);
 
 	irq_local_disable(flags);
-	list_item_prepend(buffer_comp_list(buffer, dir),
-			  comp_buffer_list(comp, dir));
+#if CONFIG_BUFFER_BROADCAST
+	/* the first sink buffer of a component is the broadcast writer */
+	if (buffer->broadcast_reader && dir == PPL_CONN_DIR_COMP_TO_BUFFER)
+		list_item_append(buffer_comp_list(buffer, dir),
+				 comp_buffer_list(comp, dir));
+	else
+#endif
+		list_item_prepend(buffer_comp_list(buffer, dir),
+				  comp_buffer_list(comp, dir));
 	buffer_set_comp(buffer, comp, dir);
 	irq_local_enable(flags);
 
@@ -188,10 +258,65 @@ static int pipeline_comp_complete(struct comp_dev *current,
 	return 0;
 }
 
-int pipeline_complete(struct pipeline *p, struct comp_dev *source,
-		      struct comp_dev *sink)
+/* counts components of the pipeline reachable in the given direction */
+static int pipeline_comp_count(struct comp_dev *current,
+			       struct comp_buffer *calling_buf, void *data,
+			       int dir)
+{
+	struct pipeline_data *ppl_data = data;
+
+	if (!comp_is_single_pipeline(current, ppl_data->start))
+		return 0;
+
+	ppl_data->count++;
+
+	return pipeline_for_each_comp(current, &pipeline_comp_count, data,
+				      NULL, NULL, dir);
+}
+
+/* allocates flattened copy schedule big enough for any copy direction */
+static int pipeline_copy_list_alloc(struct pipeline *p,
+				    struct comp_dev *source,
+				    struct comp_dev *sink)
+{
+	struct pipeline_data data;
+	uint32_t count;
+
+	data.start = source;
+	data.count = 0;
+	pipeline_comp_count(source, NULL, &data, PPL_DIR_DOWNSTREAM);
+	count = data.count;
+
+	data.start = sink;
+	data.count = 0;
+	pipeline_comp_count(sink, NULL, &data, PPL_DIR_UPSTREAM);
+	count = MAX(count, data.count);
+
+	p->copy_list = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			       count * sizeof(*p->copy_list));
+	if (!p->copy_list)
+		return -ENOMEM;
+
+	p->copy_list_size = count;
+	p->copy_list_count = 0;
+	pipeline_copy_list_invalidate(p);
+
+#if CONFIG_PIPELINE_FUSED_CHAINS
+	/* chains are just not fused without memory for their blocks */
+	p->fused_scratch = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				   2 * PPL_FUSED_BLOCK_SIZE);
+	if (!p->fused_scratch)
+		pipe_warn(p, "pipeline_copy_list_alloc(): no fused scratch");
+#endif
+
+	return 0;
+}
+
+int __cold_text pipeline_complete(struct pipeline *p, struct comp_dev *source,
+				  struct comp_dev *sink)
 {
 	struct pipeline_data data;
+	int ret;
 
 	pipe_info(p, "pipeline_complete()");
 
@@ -209,6 +334,12 @@ int pipeline_complete(struct pipeline *p, struct comp_dev *source,
 	 */
 	pipeline_comp_complete(source, NULL, &data, PPL_DIR_DOWNSTREAM);
 
+	ret = pipeline_copy_list_alloc(p, source, sink);
+	if (ret < 0) {
+		pipe_err(p, "pipeline_complete(): copy list alloc failed");
+		return ret;
+	}
+
 	p->source_comp = source;
 	p->sink_comp = sink;
 	p->status = COMP_STATE_READY;
@@ -249,7 +380,7 @@ static int pipeline_comp_free(struct comp_dev *current,
 }
 
 /* pipelines must be inactive */
-int pipeline_free(struct pipeline *p)
+int __cold_text pipeline_free(struct pipeline *p)
 {
 	struct pipeline_data data;
 
@@ -276,8 +407,19 @@ int pipeline_free(struct pipeline *p)
 		schedule_task_free(p->pipe_task);
 		rfree(p->pipe_task);
 	}
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+	schedule_task_free(&p->idle_task);
+#endif
+
+	rfree(p->copy_list);
+#if CONFIG_PIPELINE_FUSED_CHAINS
+	rfree(p->fused_scratch);
+#endif
 
 	ipc_msg_free(p->msg);
+#if CONFIG_PIPELINE_MCPS_BUDGET
+	ipc_msg_free(p->budget_msg);
+#endif
 
 	pipeline_posn_offset_put(p->posn_offset);
 
@@ -301,6 +443,7 @@ static void pipeline_update_buffer_pcm_params(struct comp_buffer *buffer,
 	params->frame_fmt = buffer->stream.frame_fmt;
 	params->rate = buffer->stream.rate;
 	params->channels = buffer->stream.channels;
+	params->active_mask = buffer->stream.active_mask;
 	for (i = 0; i < SOF_IPC_MAX_CHANNELS; i++)
 		params->chmap[i] = buffer->chmap[i];
 }
@@ -343,6 +486,188 @@ static int pipeline_comp_hw_params(struct comp_dev *current,
 	return ret;
 }
 
+/* give memory to lazily allocated buffers of the component */
+static int pipeline_comp_buffers_attach(struct comp_dev *current)
+{
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+	int err;
+
+	list_for_item(clist, &current->bsource_list) {
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+		err = buffer_group_attach(buffer);
+		if (err < 0)
+			return err;
+	}
+
+	list_for_item(clist, &current->bsink_list) {
+		buffer = container_of(clist, struct comp_buffer, source_list);
+		err = buffer_group_attach(buffer);
+		if (err < 0)
+			return err;
+	}
+
+	return 0;
+}
+
+/* release memory of lazily allocated buffers no longer used by any side,
+ * prepared or paused peers still use their buffers when started again
+ */
+static void pipeline_comp_buffers_detach(struct comp_dev *current)
+{
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+
+	list_for_item(clist, &current->bsource_list) {
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+		if (buffer->source->state == COMP_STATE_READY)
+			buffer_group_detach(buffer);
+	}
+
+	list_for_item(clist, &current->bsink_list) {
+		buffer = container_of(clist, struct comp_buffer, source_list);
+		if (buffer->sink->state == COMP_STATE_READY)
+			buffer_group_detach(buffer);
+	}
+}
+
+#if CONFIG_BUFFER_BROADCAST
+/* tells if the buffer is a broadcast reader or the writer of one, joined
+ * or not, readers are behind the writer in the sink buffers of its source
+ */
+static bool pipeline_buffer_broadcast(struct comp_buffer *buffer)
+{
+	struct list_item *last;
+
+	if (buffer->broadcast_reader)
+		return true;
+
+	if (!buffer->source)
+		return false;
+
+	last = buffer->source->bsink_list.prev;
+
+	return last != &buffer->source->bsink_list &&
+		container_of(last, struct comp_buffer,
+			     source_list)->broadcast_reader;
+}
+
+/* joins broadcast readers between current and its neighbours */
+static int pipeline_comp_broadcast(struct comp_dev *current)
+{
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+	int ret;
+
+	list_for_item(clist, &current->bsink_list) {
+		buffer = container_of(clist, struct comp_buffer, source_list);
+		ret = buffer_broadcast_join(buffer);
+		if (ret < 0)
+			return ret;
+	}
+
+	list_for_item(clist, &current->bsource_list) {
+		buffer = container_of(clist, struct comp_buffer, sink_list);
+		ret = buffer_broadcast_join(buffer);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* readers of current give their writers free */
+static void pipeline_comp_broadcast_leave(struct comp_dev *current)
+{
+	struct list_item *clist;
+
+	list_for_item(clist, &current->bsource_list)
+		buffer_broadcast_leave(container_of(clist, struct comp_buffer,
+						    sink_list));
+}
+#else
+static bool pipeline_buffer_broadcast(struct comp_buffer *buffer)
+{
+	return false;
+}
+
+static int pipeline_comp_broadcast(struct comp_dev *current)
+{
+	return 0;
+}
+
+static void pipeline_comp_broadcast_leave(struct comp_dev *current) { }
+#endif
+
+#if CONFIG_BUFFER_RESIZE
+/* bytes of the periods a component keeps in a buffer at its stream format */
+static uint32_t pipeline_buffer_need(struct comp_buffer *buffer,
+				     struct comp_dev *dev, uint32_t periods)
+{
+	uint32_t frames = ceil_divide(buffer->stream.rate * dev->period,
+				      1000000);
+
+	return periods * frames * audio_stream_frame_bytes(&buffer->stream);
+}
+
+/* fit buffer reached by params to the periods its components require */
+static int pipeline_buffer_resize(struct comp_buffer *buffer,
+				  struct comp_dev *start)
+{
+	struct comp_dev *source = buffer->source;
+	struct comp_dev *sink = buffer->sink;
+	uint32_t size;
+
+	/* memory not owned by the buffer or already seen by its user */
+	if (buffer->group || buffer->inplace_source || buffer->inplace_sink ||
+	    pipeline_buffer_broadcast(buffer) ||
+	    buffer->inter_core || source == start || sink == start ||
+	    source->state == COMP_STATE_ACTIVE ||
+	    sink->state == COMP_STATE_ACTIVE)
+		return 0;
+
+	if (!buffer->stream.rate || !audio_stream_frame_bytes(&buffer->stream))
+		return 0;
+
+	size = MAX(pipeline_buffer_need(buffer, source,
+					dev_comp_config(source)->periods_sink),
+		   pipeline_buffer_need(buffer, sink,
+					dev_comp_config(sink)->periods_source));
+	if (!size)
+		return 0;
+
+	size = MIN(size, buffer->tplg_size);
+	if (size == buffer->stream.size)
+		return 0;
+
+	pipe_cl_info("pipeline_buffer_resize(), buffer %u size %u -> %u",
+		     buffer->id, buffer->stream.size, size);
+
+	return buffer_set_size(buffer, size);
+}
+#endif
+
+/* commands to components of other cores are queued during the walk */
+static void pipeline_comp_remote_mark(struct comp_dev *current,
+				      struct pipeline_data *ppl_data)
+{
+	if (comp_is_remote(current))
+		ppl_data->remote_cores |= BIT(current->comp.core);
+}
+
+/* waits once for all commands queued by the walk, returns its result or
+ * the first error of the queued commands
+ */
+static int pipeline_comp_remote_wait(struct pipeline_data *ppl_data, int ret)
+{
+	int err;
+
+	err = idc_wait_async(ppl_data->remote_cores);
+	ppl_data->remote_cores = 0;
+
+	return ret < 0 || err >= 0 ? ret : err;
+}
+
 static int pipeline_comp_params(struct comp_dev *current,
 				struct comp_buffer *calling_buf, void *data,
 				int dir)
@@ -381,10 +706,41 @@ static int pipeline_comp_params(struct comp_dev *current,
 	if (current->state == COMP_STATE_ACTIVE)
 		return 0;
 
+	/* endpoints pause as requested for the stream */
+	current->pipeline->pause_warm =
+		!!(ppl_data->params->flags & SOF_PCM_FLAG_PAUSE_WARM);
+
+#if CONFIG_PIPELINE_QOS
+	/* stream class may have changed scheduling of the pipeline */
+	current->period = current->pipeline->ipc_pipe.period;
+	current->priority = current->pipeline->ipc_pipe.priority;
+#endif
+
+	err = pipeline_comp_buffers_attach(current);
+	if (err < 0)
+		return err;
+
+#if CONFIG_BUFFER_RESIZE
+	/* stream format of calling buffer is known, before current uses it */
+	if (calling_buf) {
+		err = pipeline_buffer_resize(calling_buf, ppl_data->start);
+		if (err < 0)
+			return err;
+	}
+#endif
+
 	/* set comp direction */
 	current->direction = ppl_data->params->params.direction;
 
+#if CONFIG_ACTIVE_CHANNELS
+	/* other components need all channels of their inputs */
+	if (current != ppl_data->start &&
+	    !(current->drv->flags & COMP_DRV_CHANNEL_WISE))
+		ppl_data->params->params.active_mask = 0;
+#endif
+
 	err = comp_params(current, &ppl_data->params->params);
+	pipeline_comp_remote_mark(current, ppl_data);
 	if (err < 0 || err == PPL_STATUS_PATH_STOP)
 		return err;
 
@@ -394,6 +750,122 @@ static int pipeline_comp_params(struct comp_dev *current,
 				      dir);
 }
 
+#if CONFIG_PIPELINE_FORMAT_PLAN
+/* next component on a linear path, buffer to it returned in buffer */
+static struct comp_dev *pipeline_plan_next(struct comp_dev *current, int dir,
+					   struct comp_buffer **buffer)
+{
+	struct list_item *list = comp_buffer_list(current, dir);
+	struct comp_buffer *next;
+
+	*buffer = NULL;
+
+	if (list_is_empty(list) || list->next->next != list)
+		return NULL;
+
+	next = buffer_from_list(list->next, struct comp_buffer, dir);
+	*buffer = next;
+
+	return buffer_get_comp(next, dir);
+}
+
+/* finds DAI at the end of a linear path not running yet */
+static struct comp_dev *pipeline_plan_dai(struct comp_dev *host, int dir)
+{
+	struct comp_dev *current = host;
+	struct comp_buffer *buffer;
+
+	while (current && current->state != COMP_STATE_ACTIVE) {
+		if (dev_comp_type(current) == SOF_COMP_DAI)
+			return current;
+
+		current = pipeline_plan_next(current, dir, &buffer);
+	}
+
+	return NULL;
+}
+
+/* Chooses frame formats of the buffers on the path from host to DAI, so
+ * the stream is converted at most once and preferably by a component
+ * converting while it processes, instead of by the DAI. The DAI then
+ * moves data without conversion and can use its zero-copy mode. Of the
+ * components able to convert, the one keeping the narrower format on the
+ * longer part of the path is chosen. Components after it must process
+ * the DAI format. Paths with branches or running components are left to
+ * local negotiation.
+ */
+static void pipeline_format_plan(struct comp_dev *host,
+				 struct sof_ipc_stream_params *params)
+{
+	struct sof_ipc_stream_params hw_params;
+	struct comp_dev *dai;
+	struct comp_dev *current;
+	struct comp_dev *first = NULL;
+	struct comp_dev *last = NULL;
+	struct comp_dev *conv;
+	struct comp_buffer *buffer = NULL;
+	enum sof_ipc_frame pcm_fmt = params->frame_fmt;
+	enum sof_ipc_frame dai_fmt;
+	enum sof_ipc_frame source_fmt;
+	enum sof_ipc_frame sink_fmt;
+	enum sof_ipc_frame fmt;
+	int dir = params->direction;
+	uint32_t flags = 0;
+
+	dai = pipeline_plan_dai(host, dir);
+	if (!dai || comp_dai_get_hw_params(dai, &hw_params, dir) < 0)
+		return;
+
+	dai_fmt = hw_params.frame_fmt;
+
+	/* source of a capture component is on the DAI side */
+	source_fmt = dir == PPL_DIR_DOWNSTREAM ? pcm_fmt : dai_fmt;
+	sink_fmt = dir == PPL_DIR_DOWNSTREAM ? dai_fmt : pcm_fmt;
+
+	/* converters followed only by components processing DAI format */
+	current = pipeline_plan_next(host, dir, &buffer);
+	while (pcm_fmt != dai_fmt && current && current != dai) {
+		if (!comp_frame_fmt_supported(current, dai_fmt, dai_fmt))
+			first = NULL;
+
+		if (comp_frame_fmt_supported(current, source_fmt, sink_fmt)) {
+			if (!first)
+				first = current;
+			last = current;
+		}
+
+		current = pipeline_plan_next(current, dir, &buffer);
+	}
+
+	if (!first)
+		conv = NULL;
+	else if (get_sample_bytes(dai_fmt) >= get_sample_bytes(pcm_fmt))
+		conv = last;
+	else
+		conv = first;
+
+	pipe_cl_info("pipeline_format_plan(), host %u dai %u fmt %u -> %u converted by %d",
+		     dev_comp_id(host), dev_comp_id(dai), pcm_fmt, dai_fmt,
+		     conv ? (int)dev_comp_id(conv) : -1);
+
+	/* components take the format of their buffers in params */
+	fmt = pcm_fmt;
+	current = host;
+	while (current && current != dai) {
+		if (current == conv)
+			fmt = dai_fmt;
+
+		current = pipeline_plan_next(current, dir, &buffer);
+		if (!buffer)
+			break;
+
+		buffer_lock(buffer, &flags);
+		buffer->stream.frame_fmt = fmt;
+		buffer_unlock(buffer, flags);
+	}
+}
+#endif
+
 /* Send pipeline component params from host to endpoints.
  * Params always start at host (PCM) and go downstream for playback and
  * upstream for capture.
@@ -406,6 +878,100 @@ static int pipeline_comp_params(struct comp_dev *current,
  *
  * Params are always modified in the direction of host PCM to DAI.
  */
+#if CONFIG_PIPELINE_QOS
+/* latency and power trade-off of a stream QoS class */
+struct pipeline_qos {
+	uint32_t priority;	/* LL task priority, SOF_TASK_PRI_ */
+	bool batch;		/* deep buffer batching of topology kept */
+	int clk_floor;		/* CLOCK_GOV_FLOOR_ */
+	int idle_limit;		/* deepest idle state, SOF_IPC_IDLE_ */
+};
+
+static const struct pipeline_qos pipeline_qos[SOF_IPC_STREAM_QOS_CLASSES] = {
+	[SOF_IPC_STREAM_QOS_DEFAULT] = {
+		.clk_floor = CLOCK_GOV_FLOOR_NONE,
+		.idle_limit = SOF_IPC_IDLE_LPS,
+	},
+	[SOF_IPC_STREAM_QOS_ULL] = {
+		.priority = SOF_TASK_PRI_HIGH,
+		.clk_floor = CLOCK_GOV_FLOOR_MAX,
+		.idle_limit = SOF_IPC_IDLE_WAITI,
+	},
+	[SOF_IPC_STREAM_QOS_VOICE] = {
+		.priority = SOF_TASK_PRI_HIGH + 1,
+		.clk_floor = CLOCK_GOV_FLOOR_HALF,
+		.idle_limit = SOF_IPC_IDLE_CLK_GATE,
+	},
+	[SOF_IPC_STREAM_QOS_MEDIA] = {
+		.priority = SOF_TASK_PRI_MED,
+		.batch = true,
+		.clk_floor = CLOCK_GOV_FLOOR_NONE,
+		.idle_limit = SOF_IPC_IDLE_LPS,
+	},
+	[SOF_IPC_STREAM_QOS_SENSING] = {
+		.priority = SOF_TASK_PRI_LOW,
+		.batch = true,
+		.clk_floor = CLOCK_GOV_FLOOR_NONE,
+		.idle_limit = SOF_IPC_IDLE_LPS,
+	},
+};
+
+/* schedules the pipeline as its stream class asks, before params reach
+ * its components and DMAs
+ */
+static int pipeline_qos_set(struct pipeline *p, uint32_t qos)
+{
+	if (qos >= SOF_IPC_STREAM_QOS_CLASSES) {
+		pipe_err(p, "pipeline_qos_set(): invalid class %u", qos);
+		return -EINVAL;
+	}
+
+	p->qos = qos;
+	p->ipc_pipe.period = p->tplg_period;
+	p->ipc_pipe.priority = p->tplg_priority;
+
+	if (qos == SOF_IPC_STREAM_QOS_DEFAULT)
+		goto out;
+
+	p->ipc_pipe.priority = pipeline_qos[qos].priority;
+
+	/* low latency streams move every period as it comes */
+	if (!pipeline_qos[qos].batch && p->ipc_pipe.batch_periods > 1)
+		p->ipc_pipe.period /= p->ipc_pipe.batch_periods;
+
+out:
+	/* the task is queued by priority when scheduled */
+	if (p->pipe_task)
+		p->pipe_task->priority = p->ipc_pipe.priority;
+
+	pipe_info(p, "pipeline_qos_set(): class %u period %u priority %u",
+		  qos, p->ipc_pipe.period, p->ipc_pipe.priority);
+
+	return 0;
+}
+
+/* clock and idle limits of the class are held while the stream runs */
+static void pipeline_qos_start(struct pipeline *p)
+{
+	clock_gov_floor_get(p->ipc_pipe.core, pipeline_qos[p->qos].clk_floor);
+	idle_limit_get(p->ipc_pipe.core, pipeline_qos[p->qos].idle_limit);
+}
+
+static void pipeline_qos_stop(struct pipeline *p)
+{
+	clock_gov_floor_put(p->ipc_pipe.core, pipeline_qos[p->qos].clk_floor);
+	idle_limit_put(p->ipc_pipe.core, pipeline_qos[p->qos].idle_limit);
+}
+#else
+static int pipeline_qos_set(struct pipeline *p, uint32_t qos)
+{
+	return 0;
+}
+
+static void pipeline_qos_start(struct pipeline *p) { }
+static void pipeline_qos_stop(struct pipeline *p) { }
+#endif
+
 int pipeline_params(struct pipeline *p, struct comp_dev *host,
 		    struct sof_ipc_pcm_params *params)
 {
@@ -422,10 +988,17 @@ int pipeline_params(struct pipeline *p, struct comp_dev *host,
 		  params->params.sample_valid_bytes,
 		  params->params.sample_container_bytes);
 
+	ret = pipeline_qos_set(p, params->qos);
+	if (ret < 0)
+		return ret;
+
 	/* settin hw params */
 	data.start = host;
 	data.params = &hw_params;
 
+	/* all channels of DAI hardware are produced */
+	hw_params.params.active_mask = 0;
+
 	ret = pipeline_comp_hw_params(data.start, NULL, &data, dir);
 	if (ret < 0) {
 		pipe_cl_err("pipeline_prepare(): ret = %d, dev->comp.id = %u",
@@ -437,7 +1010,24 @@ int pipeline_params(struct pipeline *p, struct comp_dev *host,
 	data.params = params;
 	data.start = host;
 
+	/* channels not produced would be played */
+	if (params->params.direction == SOF_IPC_STREAM_PLAYBACK ||
+	    !IS_ENABLED(CONFIG_ACTIVE_CHANNELS))
+		params->params.active_mask = 0;
+
+	/* positions published by the pipeline task, if requested */
+	p->posn_periods = params->params.posn_periods;
+	p->posn_count = 0;
+	p->posn_host = host;
+
+#if CONFIG_PIPELINE_FORMAT_PLAN
+	pipeline_format_plan(host, &params->params);
+#endif
+
+	data.remote_cores = 0;
+
 	ret = pipeline_comp_params(host, NULL, &data, params->params.direction);
+	ret = pipeline_comp_remote_wait(&data, ret);
 	if (ret < 0) {
 		pipe_cl_err("pipeline_params(): ret = %d, host->comp.id = %u",
 			    ret, dev_comp_id(host));
@@ -446,30 +1036,133 @@ int pipeline_params(struct pipeline *p, struct comp_dev *host,
 	return ret;
 }
 
-static struct task *pipeline_task_init(struct pipeline *p, uint32_t type,
-				       enum task_state (*func)(void *data))
+/* checks if a stream keeps its format, data in it stays valid */
+static bool pipeline_stream_same(const struct audio_stream *a,
+				 const struct audio_stream *b)
 {
-	struct pipeline_task *task = NULL;
+	return a->frame_fmt == b->frame_fmt && a->rate == b->rate &&
+	       a->channels == b->channels;
+}
 
-	task = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-		       sizeof(*task));
-	if (!task)
-		return NULL;
+/* Follows a stream change from the host along a single path, until a
+ * component keeps its output format, as SRC keeps its sink rate.
+ */
+static int pipeline_comp_reconfig(struct comp_dev *current,
+				  struct comp_buffer *calling_buf, void *data,
+				  int dir)
+{
+	struct pipeline_data *ppl_data = data;
+	struct list_item *buffer_list = comp_buffer_list(current, dir);
+	struct comp_buffer *buffer = NULL;
+	struct audio_stream old;
+	struct comp_dev *next;
+	int err;
 
-	if (schedule_task_init_ll(&task->task, SOF_UUID(pipe_task_uuid), type,
-				  p->ipc_pipe.priority, func,
-				  p, p->ipc_pipe.core, 0) < 0) {
-		rfree(task);
-		return NULL;
-	}
+	pipe_cl_dbg("pipeline_comp_reconfig(), current->comp.id = %u, dir = %u",
+		    dev_comp_id(current), dir);
 
-	task->sched_comp = p->sched_comp;
-	task->registrable = p == p->sched_comp->pipeline;
+	if (!list_is_empty(buffer_list)) {
+		if (buffer_list->next->next != buffer_list) {
+			pipe_cl_err("pipeline_comp_reconfig(): comp %u splits the stream",
+				    dev_comp_id(current));
+			return -ENOTSUP;
+		}
 
-	return &task->task;
-}
+		buffer = buffer_from_list(buffer_list->next, struct comp_buffer,
+					  dir);
+		old = buffer->stream;
+	}
 
-static int pipeline_comp_task_init(struct pipeline *p)
+	err = comp_reconfig(current, &ppl_data->params->params);
+	if (err < 0) {
+		pipe_cl_err("pipeline_comp_reconfig(): comp %u failed %d",
+			    dev_comp_id(current), err);
+		return err;
+	}
+
+	if (!buffer || pipeline_stream_same(&old, &buffer->stream))
+		return 0;
+
+	/* frames left in the old format can't be read in the new one */
+	if (old.frame_fmt != buffer->stream.frame_fmt ||
+	    old.channels != buffer->stream.channels)
+		buffer_reset_pos(buffer, NULL);
+
+	next = buffer_get_comp(buffer, dir);
+	if (!next)
+		return 0;
+
+	if (!comp_is_single_pipeline(next, ppl_data->start)) {
+		pipe_cl_err("pipeline_comp_reconfig(): change reaches comp %u of another pipeline",
+			    dev_comp_id(next));
+		return -ENOTSUP;
+	}
+
+	pipeline_update_buffer_pcm_params(buffer, &ppl_data->params->params);
+
+	return pipeline_comp_reconfig(next, buffer, data, dir);
+}
+
+/* Changes stream parameters of a prepared or running pipeline in place.
+ * Local interrupts are disabled, so the change is done between two runs
+ * of the pipeline task. Only components which the change reaches are
+ * updated, a failure leaves the stream to be set up again.
+ */
+int pipeline_reconfig(struct pipeline *p, struct comp_dev *host,
+		      struct sof_ipc_pcm_params *params)
+{
+	struct pipeline_data data;
+	uint32_t flags;
+	int ret;
+
+	pipe_info(p, "pipe reconfig frame_fmt %d rate %d channels %d",
+		  params->params.frame_fmt, params->params.rate,
+		  params->params.channels);
+
+	data.start = host;
+	data.params = params;
+
+	irq_local_disable(flags);
+
+	ret = pipeline_comp_reconfig(host, NULL, &data,
+				     params->params.direction);
+
+	/* copy schedule may fuse components which no longer fit */
+	pipeline_copy_list_invalidate(p);
+
+	irq_local_enable(flags);
+
+	if (ret < 0)
+		pipe_cl_err("pipeline_reconfig(): ret = %d, host->comp.id = %u",
+			    ret, dev_comp_id(host));
+
+	return ret;
+}
+
+static struct task *pipeline_task_init(struct pipeline *p, uint32_t type,
+				       enum task_state (*func)(void *data))
+{
+	struct pipeline_task *task = NULL;
+
+	task = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		       sizeof(*task));
+	if (!task)
+		return NULL;
+
+	if (schedule_task_init_ll(&task->task, SOF_UUID(pipe_task_uuid), type,
+				  p->ipc_pipe.priority, func,
+				  p, p->ipc_pipe.core, 0) < 0) {
+		rfree(task);
+		return NULL;
+	}
+
+	task->sched_comp = p->sched_comp;
+	task->registrable = p == p->sched_comp->pipeline;
+
+	return &task->task;
+}
+
+static int pipeline_comp_task_init(struct pipeline *p)
 {
 	uint32_t type;
 
@@ -491,51 +1184,261 @@ static int pipeline_comp_task_init(struct pipeline *p)
 	return 0;
 }
 
+/* let an in-place component write its output over its input */
+static void pipeline_comp_inplace(struct comp_dev *current)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	int ret;
+
+	if (!(current->drv->flags & COMP_DRV_INPLACE))
+		return;
+
+	/* only a single source and a single sink buffer */
+	if (list_is_empty(&current->bsource_list) ||
+	    list_is_empty(&current->bsink_list) ||
+	    current->bsource_list.next != current->bsource_list.prev ||
+	    current->bsink_list.next != current->bsink_list.prev)
+		return;
+
+	source = list_first_item(&current->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&current->bsink_list, struct comp_buffer,
+			       source_list);
+
+	if (source->inplace_sink || sink->inplace_source ||
+	    source->group || sink->group)
+		return;
+
+	/* broadcast readers see the data as produced */
+	if (pipeline_buffer_broadcast(source) ||
+	    pipeline_buffer_broadcast(sink))
+		return;
+
+	/* both buffers are driven by the pipeline task of this component */
+	if (source->inter_core || sink->inter_core ||
+	    source->source->pipeline != current->pipeline ||
+	    sink->sink->pipeline != current->pipeline)
+		return;
+
+	if (source->stream.frame_fmt != sink->stream.frame_fmt ||
+	    source->stream.channels != sink->stream.channels ||
+	    source->stream.rate != sink->stream.rate ||
+	    source->stream.size != sink->stream.size ||
+	    (source->caps & sink->caps) != sink->caps)
+		return;
+
+	ret = buffer_share_inplace(source, sink);
+	if (ret < 0)
+		pipe_cl_err("pipeline_comp_inplace(): ret = %d, current->comp.id = %u",
+			    ret, dev_comp_id(current));
+}
+
+/* tells if preparing goes no further into the pipeline of current */
+static bool pipeline_comp_prepare_stop(struct comp_dev *current,
+				       struct comp_dev *start, int dir)
+{
+	int end_type;
+
+	if (comp_is_single_pipeline(current, start))
+		return false;
+
+	/* If pipeline connected to the starting one is in improper
+	 * direction (CAPTURE towards DAI, PLAYBACK towards HOST),
+	 * stop propagation. Direction param of the pipeline can not be
+	 * trusted at this point, as it might not be configured yet,
+	 * hence checking for endpoint component type.
+	 */
+	end_type = comp_get_endpoint_type(current->pipeline->sink_comp);
+	if (dir == SOF_IPC_STREAM_PLAYBACK)
+		return end_type == COMP_ENDPOINT_HOST ||
+			end_type == COMP_ENDPOINT_NODE;
+
+	if (dir == SOF_IPC_STREAM_CAPTURE)
+		return end_type == COMP_ENDPOINT_DAI ||
+			end_type == COMP_ENDPOINT_NODE;
+
+	return false;
+}
+
 static int pipeline_comp_prepare(struct comp_dev *current,
 				 struct comp_buffer *calling_buf, void *data,
 				 int dir)
 {
 	int err = 0;
 	struct pipeline_data *ppl_data = data;
-	int stream_direction = dir;
-	int end_type;
 
 	pipe_cl_dbg("pipeline_comp_prepare(), current->comp.id = %u, dir = %u",
 		    dev_comp_id(current), dir);
 
-	if (!comp_is_single_pipeline(current, ppl_data->start)) {
-		/* If pipeline connected to the starting one is in improper
-		 * direction (CAPTURE towards DAI, PLAYBACK towards HOST),
-		 * stop propagation. Direction param of the pipeline can not be
-		 * trusted at this point, as it might not be configured yet,
-		 * hence checking for endpoint component type.
-		 */
-		end_type = comp_get_endpoint_type(current->pipeline->sink_comp);
-		if (stream_direction == SOF_IPC_STREAM_PLAYBACK) {
-			if (end_type == COMP_ENDPOINT_HOST ||
-			    end_type == COMP_ENDPOINT_NODE)
-				return 0;
-		}
-
-		if (stream_direction == SOF_IPC_STREAM_CAPTURE) {
-			if (end_type == COMP_ENDPOINT_DAI ||
-			    end_type == COMP_ENDPOINT_NODE)
-				return 0;
-		}
-	}
+	if (pipeline_comp_prepare_stop(current, ppl_data->start, dir))
+		return 0;
 
 	err = pipeline_comp_task_init(current->pipeline);
 	if (err < 0)
 		return err;
 
+	/* processing code of the component may have to be paged in */
+	err = comp_overlay_map(current);
+	if (err < 0) {
+		pipe_cl_err("pipeline_comp_prepare(): overlay of comp %u busy",
+			    dev_comp_id(current));
+		return err;
+	}
+
 	err = comp_prepare(current);
-	if (err < 0 || err == PPL_STATUS_PATH_STOP)
+	pipeline_comp_remote_mark(current, ppl_data);
+	if (err < 0) {
+		/* keep overlay of a component prepared before */
+		if (current->state == COMP_STATE_READY)
+			comp_overlay_unmap(current);
+		return err;
+	}
+
+	if (err == PPL_STATUS_PATH_STOP)
 		return err;
 
+	pipeline_comp_inplace(current);
+
+	err = pipeline_comp_broadcast(current);
+	if (err < 0) {
+		pipe_cl_err("pipeline_comp_prepare(): broadcast of comp %u failed %d",
+			    dev_comp_id(current), err);
+		return err;
+	}
+
 	return pipeline_for_each_comp(current, &pipeline_comp_prepare, data,
 				      &buffer_reset_pos, NULL, dir);
 }
 
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+/* parks the first buffer of the pipeline that can still be parked */
+static int pipeline_comp_park(struct comp_dev *current,
+			      struct comp_buffer *calling_buf, void *data,
+			      int dir)
+{
+	struct pipeline_data *ppl_data = data;
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+
+	if (!comp_is_single_pipeline(current, ppl_data->start))
+		return 0;
+
+	list_for_item(clist, &current->bsink_list) {
+		buffer = container_of(clist, struct comp_buffer, source_list);
+
+		if (buffer->pipeline_id == ppl_data->p->ipc_pipe.pipeline_id &&
+		    !buffer->parked && !buffer_park(buffer) && buffer->parked)
+			return PPL_STATUS_PATH_STOP;
+
+		if (buffer->sink &&
+		    pipeline_comp_park(buffer->sink, buffer, data, dir) ==
+		    PPL_STATUS_PATH_STOP)
+			return PPL_STATUS_PATH_STOP;
+	}
+
+	return 0;
+}
+
+static void pipeline_buffer_unpark(struct comp_buffer *buffer, void *data)
+{
+	struct pipeline_data *ppl_data = data;
+
+	if (buffer->pipeline_id == ppl_data->p->ipc_pipe.pipeline_id &&
+	    buffer_unpark(buffer) < 0)
+		ppl_data->count++;
+}
+
+static int pipeline_comp_unpark(struct comp_dev *current,
+				struct comp_buffer *calling_buf, void *data,
+				int dir)
+{
+	struct pipeline_data *ppl_data = data;
+
+	if (!comp_is_single_pipeline(current, ppl_data->start))
+		return 0;
+
+	return pipeline_for_each_comp(current, &pipeline_comp_unpark, data,
+				      &pipeline_buffer_unpark, data, dir);
+}
+
+/* Runs in LL context once the pipeline has been idle long enough. Nothing
+ * else runs on the core meanwhile, but an interrupted IPC or IDC task may be
+ * in the middle of changing the graph, so parking waits until no EDF task
+ * is queued. One buffer is parked per run to keep the LL tick short.
+ */
+static enum task_state pipeline_idle_task(void *arg)
+{
+	struct pipeline *p = arg;
+	struct pipeline_data data;
+
+	if (schedule_edf_num_tasks())
+		return SOF_TASK_STATE_RESCHEDULE;
+
+	if (p->source_comp) {
+		data.start = p->source_comp;
+		data.p = p;
+
+		if (pipeline_comp_park(p->source_comp, NULL, &data,
+				       PPL_DIR_DOWNSTREAM) ==
+		    PPL_STATUS_PATH_STOP) {
+			p->parked = true;
+			return SOF_TASK_STATE_RESCHEDULE;
+		}
+	}
+
+	p->idle_armed = false;
+
+	if (p->parked)
+		heap_gate_free_banks();
+
+	return SOF_TASK_STATE_COMPLETED;
+}
+
+/* starts idle timeout of reset or paused pipeline */
+static void pipeline_idle_arm(struct pipeline *p)
+{
+	if (p->idle_armed)
+		schedule_task_cancel(&p->idle_task);
+
+	p->idle_armed = true;
+	schedule_task(&p->idle_task, CONFIG_PIPELINE_IDLE_LP_MEMORY_MS * 1000,
+		      PPL_PARK_PERIOD_US);
+}
+
+/* stops idle timeout and brings parked buffers back before the pipeline
+ * runs again, buffers which can't be moved back keep working from LP memory
+ */
+static void pipeline_idle_restore(struct pipeline *p)
+{
+	struct pipeline_data data;
+
+	if (p->idle_armed) {
+		schedule_task_cancel(&p->idle_task);
+		p->idle_armed = false;
+	}
+
+	if (!p->parked || !p->source_comp)
+		return;
+
+	data.start = p->source_comp;
+	data.p = p;
+	data.count = 0;
+
+	pipeline_comp_unpark(p->source_comp, NULL, &data, PPL_DIR_DOWNSTREAM);
+
+	if (data.count)
+		pipe_warn(p, "pipeline_idle_restore(): %u buffers left in LP memory",
+			  data.count);
+
+	/* the rest is tried again on the next restore */
+	p->parked = data.count > 0;
+}
+#else
+static inline void pipeline_idle_arm(struct pipeline *p) { }
+static inline void pipeline_idle_restore(struct pipeline *p) { }
+#endif
+
 /* prepare the pipeline for usage */
 int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
 {
@@ -544,9 +1447,13 @@ int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
 
 	pipe_info(p, "pipe prepare");
 
+	pipeline_idle_restore(p);
+
 	ppl_data.start = dev;
+	ppl_data.remote_cores = 0;
 
 	ret = pipeline_comp_prepare(dev, NULL, &ppl_data, dev->direction);
+	ret = pipeline_comp_remote_wait(&ppl_data, ret);
 	if (ret < 0) {
 		pipe_cl_err("pipeline_prepare(): ret = %d, dev->comp.id = %u",
 			    ret, dev_comp_id(dev));
@@ -559,8 +1466,11 @@ int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
 }
 
 static void pipeline_comp_trigger_sched_comp(struct pipeline *p,
-					     struct comp_dev *comp, int cmd)
+					     struct comp_dev *comp,
+					     struct pipeline_data *ppl_data)
 {
+	int cmd = ppl_data->cmd;
+
 	/* only required by the scheduling component or sink component
 	 * on pipeline without one
 	 */
@@ -573,13 +1483,40 @@ static void pipeline_comp_trigger_sched_comp(struct pipeline *p,
 	case COMP_TRIGGER_STOP:
 	case COMP_TRIGGER_XRUN:
 		pipeline_schedule_cancel(p);
+		if (p->status == COMP_STATE_ACTIVE) {
+			clock_gov_pipeline_stop(p->ipc_pipe.core,
+						pipeline_mcps(p));
+			pipeline_qos_stop(p);
+		}
 		p->status = COMP_STATE_PAUSED;
+		/* warm pause is kept ready for a fast release */
+		if (cmd == COMP_TRIGGER_PAUSE && !p->pause_warm)
+			pipeline_idle_arm(p);
 		break;
 	case COMP_TRIGGER_RELEASE:
 	case COMP_TRIGGER_START:
-		pipeline_schedule_copy(p, 0);
+		pipeline_idle_restore(p);
+		/* raise the clock before the first copy */
+		if (p->status != COMP_STATE_ACTIVE) {
+			clock_gov_pipeline_start(p->ipc_pipe.core,
+						 pipeline_mcps(p));
+			pipeline_qos_start(p);
+		}
+		/* a group is scheduled together once all of it is started */
+		if (!ppl_data->group)
+			pipeline_schedule_copy(p, 0);
+		else if (list_is_empty(&p->group_list))
+			list_item_append(&p->group_list, ppl_data->group);
 		p->xrun_bytes = 0;
 		p->status = COMP_STATE_ACTIVE;
+#if CONFIG_PIPELINE_MCPS_BUDGET
+		p->budget_cycles = 0;
+		p->budget_count = 0;
+		if (cmd == COMP_TRIGGER_START) {
+			p->budget_over = false;
+			p->budget_done = false;
+		}
+#endif
 		break;
 	case COMP_TRIGGER_SUSPEND:
 	case COMP_TRIGGER_RESUME:
@@ -612,11 +1549,15 @@ static int pipeline_comp_trigger(struct comp_dev *current,
 
 	/* send command to the component and update pipeline state */
 	err = comp_trigger(current, ppl_data->cmd);
+	pipeline_comp_remote_mark(current, ppl_data);
+
+	/* component state may have changed, copy schedule needs rebuild */
+	pipeline_copy_list_invalidate(current->pipeline);
+
 	if (err < 0 || err == PPL_STATUS_PATH_STOP)
 		return err;
 
-	pipeline_comp_trigger_sched_comp(current->pipeline, current,
-					 ppl_data->cmd);
+	pipeline_comp_trigger_sched_comp(current->pipeline, current, ppl_data);
 
 	return pipeline_for_each_comp(current, &pipeline_comp_trigger, data,
 				      NULL, NULL, dir);
@@ -664,8 +1605,8 @@ static int pipeline_xrun_handle_trigger(struct pipeline *p, int cmd)
 	return ret;
 }
 
-/* trigger pipeline */
-int pipeline_trigger(struct pipeline *p, struct comp_dev *host, int cmd)
+static int pipeline_trigger_run(struct pipeline *p, struct comp_dev *host,
+				int cmd, struct list_item *group)
 {
 	struct pipeline_data data;
 	int ret;
@@ -685,8 +1626,11 @@ int pipeline_trigger(struct pipeline *p, struct comp_dev *host, int cmd)
 
 	data.start = host;
 	data.cmd = cmd;
+	data.group = group;
+	data.remote_cores = 0;
 
 	ret = pipeline_comp_trigger(host, NULL, &data, host->direction);
+	ret = pipeline_comp_remote_wait(&data, ret);
 	if (ret < 0) {
 		pipe_cl_err("pipeline_trigger(): ret = %d, host->comp.id = %u, cmd = %d",
 			    ret, dev_comp_id(host), cmd);
@@ -695,6 +1639,75 @@ int pipeline_trigger(struct pipeline *p, struct comp_dev *host, int cmd)
 	return ret;
 }
 
+/* trigger pipeline */
+int pipeline_trigger(struct pipeline *p, struct comp_dev *host, int cmd)
+{
+	return pipeline_trigger_run(p, host, cmd, NULL);
+}
+
+/* Starts all pipelines of a group first and then schedules their tasks
+ * with local interrupts disabled, so no LL tick can run between them and
+ * they all copy for the first time in the same tick. Stopping is done
+ * with interrupts disabled for the same reason.
+ */
+int pipeline_trigger_group(struct comp_dev **hosts, uint32_t count, int cmd)
+{
+	struct list_item group;
+	struct list_item *tlist;
+	struct list_item *tmp;
+	struct pipeline *p;
+	uint32_t flags;
+	uint32_t i;
+	int ret = 0;
+
+	list_init(&group);
+
+	switch (cmd) {
+	case COMP_TRIGGER_START:
+		for (i = 0; i < count; i++) {
+			ret = pipeline_trigger_run(hosts[i]->pipeline, hosts[i],
+						   cmd, &group);
+			if (ret < 0)
+				break;
+		}
+
+		irq_local_disable(flags);
+
+		list_for_item_safe(tlist, tmp, &group) {
+			p = container_of(tlist, struct pipeline, group_list);
+			list_item_del(&p->group_list);
+			if (ret >= 0)
+				pipeline_schedule_copy(p, 0);
+		}
+
+		irq_local_enable(flags);
+
+		/* none of the group runs unless all of it does */
+		if (ret < 0) {
+			while (i--)
+				pipeline_trigger(hosts[i]->pipeline, hosts[i],
+						 COMP_TRIGGER_STOP);
+		}
+		break;
+	case COMP_TRIGGER_STOP:
+		irq_local_disable(flags);
+
+		for (i = 0; i < count; i++) {
+			ret = pipeline_trigger(hosts[i]->pipeline, hosts[i],
+					       cmd);
+			if (ret < 0)
+				break;
+		}
+
+		irq_local_enable(flags);
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return ret;
+}
+
 static int pipeline_comp_reset(struct comp_dev *current,
 			       struct comp_buffer *calling_buf, void *data,
 			       int dir)
@@ -729,9 +1742,28 @@ static int pipeline_comp_reset(struct comp_dev *current,
 	}
 
 	err = comp_reset(current);
+
+	/* a component still busy keeps running its overlay code */
+	if (current->state == COMP_STATE_READY)
+		comp_overlay_unmap(current);
+
+	pipeline_copy_list_invalidate(current->pipeline);
+
+	if (current->drv->flags & COMP_DRV_INPLACE &&
+	    !list_is_empty(&current->bsink_list))
+		buffer_unshare_inplace(list_first_item(&current->bsink_list,
+						       struct comp_buffer,
+						       source_list));
+
+	/* a reader no longer read doesn't hold back its writer */
+	if (current->state == COMP_STATE_READY)
+		pipeline_comp_broadcast_leave(current);
+
 	if (err < 0 || err == PPL_STATUS_PATH_STOP)
 		return err;
 
+	pipeline_comp_buffers_detach(current);
+
 	return pipeline_for_each_comp(current, &pipeline_comp_reset, data,
 				      buffer_reset_params, NULL, dir);
 }
@@ -749,18 +1781,84 @@ int pipeline_reset(struct pipeline *p, struct comp_dev *host)
 			    ret, dev_comp_id(host));
 	}
 
+	p->posn_periods = 0;
+#if CONFIG_PIPELINE_MCPS_BUDGET
+	/* components are back at full quality */
+	p->budget_quality = COMP_QUALITY_FULL;
+#endif
+
+	/* buffer memory may be released by the reset */
+	heap_gate_free_banks();
+
+	pipeline_idle_arm(p);
+
 	return ret;
 }
 
-static int pipeline_comp_copy(struct comp_dev *current,
-			      struct comp_buffer *calling_buf, void *data,
-			      int dir)
+#if CONFIG_PIPELINE_DATA_DRIVEN
+/* Checks the data thresholds of the component against its buffers.
+ * A component without thresholds is always ready.
+ */
+static bool __hot_text pipeline_comp_ready(struct comp_dev *dev)
 {
-	struct pipeline_data *ppl_data = data;
-	int is_single_ppl = comp_is_single_pipeline(current, ppl_data->start);
-	int err;
-
-	pipe_cl_dbg("pipeline_comp_copy(), current->comp.id = %u, dir = %u",
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+	uint32_t flags = 0;
+	bool ready = true;
+
+	if (dev->min_source_bytes) {
+		list_for_item(clist, &dev->bsource_list) {
+			buffer = container_of(clist, struct comp_buffer,
+					      sink_list);
+			buffer_lock(buffer, &flags);
+			ready = buffer->stream.avail >= dev->min_source_bytes;
+			buffer_unlock(buffer, flags);
+			if (!ready)
+				return false;
+		}
+	}
+
+	if (dev->min_sink_bytes) {
+		list_for_item(clist, &dev->bsink_list) {
+			buffer = container_of(clist, struct comp_buffer,
+					      source_list);
+			buffer_lock(buffer, &flags);
+			ready = buffer->stream.free >= dev->min_sink_bytes;
+			buffer_unlock(buffer, flags);
+			if (!ready)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/* Copies the component only when its buffers meet its thresholds,
+ * a component that isn't ready stops its path without being called.
+ */
+static int __hot_text pipeline_comp_run(struct comp_dev *dev)
+{
+	if (!pipeline_comp_ready(dev))
+		return PPL_STATUS_PATH_STOP;
+
+	return comp_copy(dev);
+}
+#else
+static inline int pipeline_comp_run(struct comp_dev *dev)
+{
+	return comp_copy(dev);
+}
+#endif
+
+static int __hot_text pipeline_comp_copy(struct comp_dev *current,
+					 struct comp_buffer *calling_buf,
+					 void *data, int dir)
+{
+	struct pipeline_data *ppl_data = data;
+	int is_single_ppl = comp_is_single_pipeline(current, ppl_data->start);
+	int err;
+
+	pipe_cl_dbg("pipeline_comp_copy(), current->comp.id = %u, dir = %u",
 		    dev_comp_id(current), dir);
 
 	if (!is_single_ppl) {
@@ -775,7 +1873,7 @@ static int pipeline_comp_copy(struct comp_dev *current,
 
 	/* copy to downstream immediately */
 	if (dir == PPL_DIR_DOWNSTREAM) {
-		err = comp_copy(current);
+		err = pipeline_comp_run(current);
 		if (err < 0 || err == PPL_STATUS_PATH_STOP)
 			return err;
 	}
@@ -786,17 +1884,307 @@ static int pipeline_comp_copy(struct comp_dev *current,
 		return err;
 
 	if (dir == PPL_DIR_UPSTREAM)
-		err = comp_copy(current);
+		err = pipeline_comp_run(current);
 
 	return err;
 }
 
+/* Flattens the active part of the graph into the pipeline copy schedule,
+ * following the same order as pipeline_comp_copy(). Returns 1 when an
+ * entry was added, pipeline_for_each_comp() passes on that of the last
+ * visited neighbour.
+ */
+static int pipeline_comp_list_build(struct comp_dev *current,
+				    struct comp_buffer *calling_buf,
+				    void *data, int dir)
+{
+	struct pipeline_data *ppl_data = data;
+	struct pipeline *p = ppl_data->p;
+	struct pipeline_copy_entry *entry;
+	uint32_t first = p->copy_list_count;
+	int err;
+
+	if (!comp_is_single_pipeline(current, ppl_data->start) ||
+	    !comp_is_active(current))
+		return 0;
+
+	/* downstream entry goes before its subtree */
+	if (dir == PPL_DIR_DOWNSTREAM) {
+		if (p->copy_list_count == p->copy_list_size)
+			return -ENOSPC;
+		p->copy_list_count++;
+	}
+
+	err = pipeline_for_each_comp(current, &pipeline_comp_list_build,
+				     data, NULL, NULL, dir);
+	if (err < 0)
+		return err;
+
+	if (dir == PPL_DIR_DOWNSTREAM) {
+		entry = &p->copy_list[first];
+		entry->span = p->copy_list_count - first - 1;
+	} else {
+		/* upstream entry goes after its subtree */
+		if (p->copy_list_count == p->copy_list_size)
+			return -ENOSPC;
+		entry = &p->copy_list[p->copy_list_count++];
+		entry->span = p->copy_list_count - first - 1;
+	}
+
+	entry->comp = current;
+
+	/* upstream, the entry right before is the last visited source */
+	entry->stop_prev = dir == PPL_DIR_UPSTREAM && err > 0;
+
+	return 1;
+}
+
+#if CONFIG_PIPELINE_FUSED_CHAINS
+/* returns the only buffer connected in dir or NULL */
+static struct comp_buffer *pipeline_comp_single_buffer(struct comp_dev *comp,
+						       int dir)
+{
+	struct list_item *list = comp_buffer_list(comp, dir);
+
+	if (list_is_empty(list) || list->next->next != list)
+		return NULL;
+
+	return buffer_from_list(list->next, struct comp_buffer, dir);
+}
+
+/* checks if the buffer between two components can be left out */
+static bool pipeline_comp_fusable(struct comp_dev *prev,
+				  struct comp_dev *current)
+{
+	struct comp_buffer *buffer;
+
+	if (!prev->drv->ops.process || !current->drv->ops.process ||
+	    prev->drv->block_frames || current->drv->block_frames ||
+	    !pipeline_comp_single_buffer(prev, PPL_DIR_UPSTREAM) ||
+	    !pipeline_comp_single_buffer(current, PPL_DIR_DOWNSTREAM))
+		return false;
+
+	buffer = pipeline_comp_single_buffer(current, PPL_DIR_UPSTREAM);
+	if (!buffer || buffer->source != prev ||
+	    buffer != pipeline_comp_single_buffer(prev, PPL_DIR_DOWNSTREAM))
+		return false;
+
+	/* buffer must not hold any data nor share memory with another one */
+	return !buffer->inter_core && !buffer->inplace_source &&
+	       !buffer->inplace_sink && !buffer->stream.avail;
+}
+
+/* Marks chains of components run with comp_ops::process(). Connected
+ * components are adjacent in the schedule in data flow order for both
+ * directions, so every chain is a run of entries led by its first one.
+ */
+static void pipeline_copy_list_fuse(struct pipeline *p)
+{
+	struct pipeline_copy_entry *head = p->copy_list;
+	uint32_t i;
+
+	for (i = 0; i < p->copy_list_count; i++)
+		p->copy_list[i].fused = 0;
+
+	if (!p->fused_scratch)
+		return;
+
+	for (i = 1; i < p->copy_list_count; i++) {
+		if (pipeline_comp_fusable(p->copy_list[i - 1].comp,
+					  p->copy_list[i].comp))
+			head->fused++;
+		else
+			head = &p->copy_list[i];
+	}
+}
+#endif
+
+static int pipeline_copy_list_build(struct pipeline *p,
+				    struct comp_dev *start, uint32_t dir)
+{
+	struct pipeline_data data;
+	int ret;
+
+	data.start = start;
+	data.p = p;
+
+	p->copy_list_count = 0;
+
+	ret = pipeline_comp_list_build(start, NULL, &data, dir);
+	if (ret < 0) {
+		pipe_warn(p, "pipeline_copy_list_build(): ret = %d", ret);
+		return ret;
+	}
+
+#if CONFIG_PIPELINE_FUSED_CHAINS
+	pipeline_copy_list_fuse(p);
+#endif
+
+	p->copy_list_valid = true;
+
+	return 0;
+}
+
+#if CONFIG_PIPELINE_FUSED_CHAINS
+/* points block with format of the sink buffer of comp to scratch memory */
+static struct audio_stream *pipeline_fused_block(struct pipeline *p,
+						 struct comp_dev *comp,
+						 struct audio_stream *block,
+						 uint32_t index)
+{
+	struct comp_buffer *buffer;
+	char *addr = (char *)p->fused_scratch + index * PPL_FUSED_BLOCK_SIZE;
+
+	buffer = pipeline_comp_single_buffer(comp, PPL_DIR_DOWNSTREAM);
+
+	*block = buffer->stream;
+	block->addr = addr;
+	block->end_addr = addr + PPL_FUSED_BLOCK_SIZE;
+	block->size = PPL_FUSED_BLOCK_SIZE;
+	audio_stream_reset(block);
+
+	return block;
+}
+
+/* Runs a chain of components block by block, passing samples between them
+ * through two small blocks of scratch memory which stay in cache. Buffers
+ * inside the chain are never written, only source of the first and sink
+ * of the last component are updated, by the amount of frames each copy()
+ * would have moved.
+ */
+static int __hot_text pipeline_fused_copy(struct pipeline *p,
+					  struct pipeline_copy_entry *head)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	struct comp_buffer *buffer;
+	struct audio_stream block[2];
+	struct audio_stream src;
+	struct audio_stream snk;
+	const struct audio_stream *in;
+	struct audio_stream *out;
+	uint32_t source_bytes;
+	uint32_t sink_bytes;
+	uint32_t frames;
+	uint32_t flags = 0;
+	uint32_t n;
+	uint32_t i;
+	int ret;
+
+	source = pipeline_comp_single_buffer(head->comp, PPL_DIR_UPSTREAM);
+	sink = pipeline_comp_single_buffer(head[head->fused].comp,
+					   PPL_DIR_DOWNSTREAM);
+
+	buffer_lock(source, &flags);
+	buffer_lock(sink, &flags);
+
+	frames = audio_stream_avail_frames(&source->stream, &sink->stream);
+	src = source->stream;
+	snk = sink->stream;
+
+	buffer_unlock(sink, flags);
+	buffer_unlock(source, flags);
+
+	/* buffers inside the chain limit frames as in separate copies */
+	for (i = 0; i < head->fused; i++) {
+		buffer = pipeline_comp_single_buffer(head[i].comp,
+						     PPL_DIR_DOWNSTREAM);
+		frames = MIN(frames, buffer->stream.free /
+			     audio_stream_frame_bytes(&buffer->stream));
+	}
+
+	source_bytes = frames * audio_stream_frame_bytes(&src);
+	sink_bytes = frames * audio_stream_frame_bytes(&snk);
+
+	buffer_invalidate(source, source_bytes);
+
+	while (frames) {
+		n = MIN(frames, PPL_FUSED_BLOCK_FRAMES);
+		in = &src;
+
+		for (i = 0; i <= head->fused; i++) {
+			out = i == head->fused ? &snk :
+				pipeline_fused_block(p, head[i].comp,
+						     &block[i & 1], i & 1);
+
+			ret = comp_process(head[i].comp, in, out, n);
+			if (ret < 0)
+				return ret;
+
+			in = out;
+		}
+
+		audio_stream_consume(&src, n * audio_stream_frame_bytes(&src));
+		audio_stream_produce(&snk, n * audio_stream_frame_bytes(&snk));
+		frames -= n;
+	}
+
+	buffer_writeback(sink, sink_bytes);
+
+	comp_update_buffer_produce(sink, sink_bytes);
+	comp_update_buffer_consume(source, source_bytes);
+
+	return 0;
+}
+#endif
+
+/* Runs copy on the flattened schedule with the path stop semantics of
+ * pipeline_comp_copy(). Downstream, a component stopping its path skips
+ * its subtree. Upstream, a component is skipped only when its last
+ * visited source has stopped, so other inputs of a mixer don't stop it.
+ */
+static int __hot_text pipeline_copy_list_run(struct pipeline *p, uint32_t dir)
+{
+	struct pipeline_copy_entry *entry;
+	bool stopped = false;
+	uint32_t i;
+	int err;
+
+	for (i = 0; i < p->copy_list_count; i++) {
+		entry = &p->copy_list[i];
+
+		/* stop passed on from the last source, as from recursion */
+		if (entry->stop_prev && stopped) {
+#if CONFIG_PIPELINE_FUSED_CHAINS
+			i += entry->fused;
+#endif
+			continue;
+		}
+
+#if CONFIG_PIPELINE_FUSED_CHAINS
+		if (entry->fused) {
+			err = pipeline_fused_copy(p, entry);
+			if (err < 0)
+				return err;
+
+			i += entry->fused;
+			stopped = false;
+			continue;
+		}
+#endif
+
+		err = pipeline_comp_run(entry->comp);
+		if (err < 0)
+			return err;
+
+		stopped = err == PPL_STATUS_PATH_STOP;
+		if (stopped && dir == PPL_DIR_DOWNSTREAM)
+			i += entry->span;
+	}
+
+	return 0;
+}
+
 /* Copy data across all pipeline components.
  * For capture pipelines it always starts from source component
  * and continues downstream and for playback pipelines it first
  * copies sink component itself and then goes upstream.
+ *
+ * Components are copied in the order of the flattened copy schedule,
+ * which gets rebuilt only when state of any component has changed.
+ * Recursive graph walk is used only if the schedule couldn't be built.
  */
-static int pipeline_copy(struct pipeline *p)
+UT_STATIC int __hot_text pipeline_copy(struct pipeline *p)
 {
 	struct pipeline_data data;
 	struct comp_dev *start;
@@ -811,14 +2199,25 @@ static int pipeline_copy(struct pipeline *p)
 		start = p->source_comp;
 	}
 
-	data.start = start;
-	data.p = p;
+	if (!p->copy_list_valid && p->copy_list)
+		pipeline_copy_list_build(p, start, dir);
+
+	if (p->copy_list_valid) {
+		ret = pipeline_copy_list_run(p, dir);
+	} else {
+		data.start = start;
+		data.p = p;
+
+		ret = pipeline_comp_copy(start, NULL, &data, dir);
+	}
 
-	ret = pipeline_comp_copy(start, NULL, &data, dir);
 	if (ret < 0)
 		pipe_cl_err("pipeline_copy(): ret = %d, start->comp.id = %u, dir = %u",
 			    ret, dev_comp_id(start), dir);
 
+	/* produce and consume notifications collected during the copy */
+	buffer_notify_flush();
+
 	return ret;
 }
 
@@ -848,6 +2247,46 @@ static int pipeline_comp_timestamp(struct comp_dev *current,
 				      NULL, NULL, dir);
 }
 
+/*
+ * Host reads the position without IPC, so it may read while the mailbox
+ * copy is written. The sequence is odd during the update, a read is
+ * consistent if it saw the same even sequence before and after it.
+ */
+void pipeline_posn_write(struct pipeline *p, struct sof_ipc_stream_posn *posn)
+{
+	size_t seq_offset = p->posn_offset +
+		offsetof(struct sof_ipc_stream_posn, seq);
+	uint32_t flags;
+
+	irq_local_disable(flags);
+
+	posn->seq = ++p->posn_seq;
+	mailbox_stream_write(seq_offset, &posn->seq, sizeof(posn->seq));
+	mailbox_stream_write(p->posn_offset, posn, sizeof(*posn));
+
+	posn->seq = ++p->posn_seq;
+	mailbox_stream_write(seq_offset, &posn->seq, sizeof(posn->seq));
+
+	irq_local_enable(flags);
+}
+
+/* publish position in the mailbox every posn_periods periods */
+static void __hot_text pipeline_posn_update(struct pipeline *p)
+{
+	struct sof_ipc_stream_posn posn;
+
+	if (!p->posn_periods || ++p->posn_count < p->posn_periods)
+		return;
+
+	p->posn_count = 0;
+
+	memset(&posn, 0, sizeof(posn));
+	ipc_build_stream_posn(&posn, SOF_IPC_STREAM_POSITION,
+			      dev_comp_id(p->posn_host));
+	pipeline_get_timestamp(p, p->posn_host, &posn);
+	pipeline_posn_write(p, &posn);
+}
+
 /* Get the timestamps for host and first active DAI found. */
 void pipeline_get_timestamp(struct pipeline *p, struct comp_dev *host,
 			    struct sof_ipc_stream_posn *posn)
@@ -876,8 +2315,7 @@ static int pipeline_comp_xrun(struct comp_dev *current,
 		platform_host_timestamp(current, ppl_data->posn);
 
 		/* send XRUN to host */
-		mailbox_stream_write(ppl_data->p->posn_offset, ppl_data->posn,
-				     sizeof(*ppl_data->posn));
+		pipeline_posn_write(ppl_data->p, ppl_data->posn);
 		ipc_msg_send(ppl_data->p->msg, ppl_data->posn, true);
 	}
 
@@ -886,11 +2324,27 @@ static int pipeline_comp_xrun(struct comp_dev *current,
 }
 
 /* Send an XRUN to each host for this component. */
-void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
-		   int32_t bytes)
+static void pipeline_xrun_notify(struct pipeline *p, struct comp_dev *dev,
+				 int32_t bytes)
 {
 	struct pipeline_data data;
 	struct sof_ipc_stream_posn posn;
+
+	memset(&posn, 0, sizeof(posn));
+	ipc_build_stream_posn(&posn, SOF_IPC_STREAM_TRIG_XRUN,
+			      dev_comp_id(dev));
+	p->xrun_bytes = bytes;
+	posn.xrun_size = bytes;
+	posn.xrun_comp_id = dev_comp_id(dev);
+	data.posn = &posn;
+	data.p = p;
+
+	pipeline_comp_xrun(dev, NULL, &data, dev->direction);
+}
+
+void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
+		   int32_t bytes)
+{
 	int ret;
 
 	/* don't flood host */
@@ -907,19 +2361,78 @@ void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
 		pipe_err(p, "pipeline_xrun(): Pipelines notification about XRUN failed, ret = %d",
 			 ret);
 
-	memset(&posn, 0, sizeof(posn));
-	ipc_build_stream_posn(&posn, SOF_IPC_STREAM_TRIG_XRUN,
-			      dev_comp_id(dev));
+#if CONFIG_XRUN_FAST_RECOVERY
+	/* host is told only if the pipeline task can't recover */
 	p->xrun_bytes = bytes;
-	posn.xrun_size = bytes;
-	posn.xrun_comp_id = dev_comp_id(dev);
-	data.posn = &posn;
-	data.p = p;
+	p->xrun_comp = dev;
+#else
+	pipeline_xrun_notify(p, dev, bytes);
+#endif
+}
 
-	pipeline_comp_xrun(dev, NULL, &data, dev->direction);
+#if CONFIG_XRUN_FAST_RECOVERY
+/* brings a component back to prepared keeping its processing state, only
+ * DAIs are prepared again to silence and realign their DMA
+ */
+static int pipeline_comp_realign(struct comp_dev *current,
+				 struct comp_buffer *calling_buf, void *data,
+				 int dir)
+{
+	struct pipeline_data *ppl_data = data;
+	int err;
+
+	if (pipeline_comp_prepare_stop(current, ppl_data->start, dir))
+		return 0;
+
+	if (comp_get_endpoint_type(current) == COMP_ENDPOINT_DAI) {
+		err = comp_prepare(current);
+		pipeline_comp_remote_mark(current, ppl_data);
+	} else {
+		err = comp_set_state(current, COMP_TRIGGER_PREPARE);
+	}
+	if (err < 0 || err == PPL_STATUS_PATH_STOP)
+		return err;
+
+	return pipeline_for_each_comp(current, &pipeline_comp_realign, data,
+				      &buffer_reset_pos, NULL, dir);
 }
 
-#if NO_XRUN_RECOVERY
+/* recover the pipeline from a XRUN condition in place */
+static int pipeline_xrun_recover(struct pipeline *p)
+{
+	struct comp_dev *dev = p->source_comp;
+	struct pipeline_data data;
+	int ret;
+
+	pipe_warn(p, "pipeline_xrun_recover(), xrun_bytes = %d",
+		  p->xrun_bytes);
+
+	data.start = dev;
+	data.remote_cores = 0;
+
+	ret = pipeline_comp_realign(dev, NULL, &data, dev->direction);
+	ret = pipeline_comp_remote_wait(&data, ret);
+	if (ret < 0)
+		goto err;
+
+	p->status = COMP_STATE_PREPARE;
+	p->xrun_bytes = 0;
+
+	ret = pipeline_trigger(p, dev, COMP_TRIGGER_START);
+	if (ret < 0)
+		goto err;
+
+	return 0;
+
+err:
+	pipe_err(p, "pipeline_xrun_recover(): failed, ret = %d", ret);
+
+	/* leave it to the host, stopping the stream */
+	pipeline_xrun_notify(p, p->xrun_comp, p->xrun_bytes);
+	return ret;
+}
+
+#elif NO_XRUN_RECOVERY
 /* recover the pipeline from a XRUN condition */
 static int pipeline_xrun_recover(struct pipeline *p)
 {
@@ -957,9 +2470,60 @@ static int pipeline_xrun_recover(struct pipeline *p)
 }
 #endif
 
+static uint32_t pipeline_comp_order(struct comp_dev *current, uint32_t hops);
+
+/* order of current as fed by source */
+static uint32_t pipeline_source_order(struct comp_dev *current,
+				      struct comp_dev *source, uint32_t hops)
+{
+	uint32_t cross;
+
+	if (!source)
+		return 0;
+
+	cross = source->pipeline != current->pipeline;
+
+	/* pipelines feeding each other in a loop */
+	if (hops + cross > PPL_ORDER_MAX)
+		return 0;
+
+	return pipeline_comp_order(source, hops + cross) + cross;
+}
+
+/* number of pipelines on the longest path feeding current */
+static uint32_t pipeline_comp_order(struct comp_dev *current, uint32_t hops)
+{
+	struct list_item *clist;
+	struct comp_buffer *buffer;
+	struct comp_dev *source;
+	uint32_t order = 0;
+
+	list_for_item(clist, comp_buffer_list(current, PPL_DIR_UPSTREAM)) {
+		buffer = buffer_from_list(clist, struct comp_buffer,
+					  PPL_DIR_UPSTREAM);
+		source = buffer_get_comp(buffer, PPL_DIR_UPSTREAM);
+		order = MAX(order, pipeline_source_order(current, source,
+							 hops));
+	}
+
+#if CONFIG_BUFFER_TAP
+	/* a tapped buffer feeds the reader like a source buffer */
+	if (current->tap && current->tap->buffer) {
+		source = current->tap->buffer->source;
+		order = MAX(order, pipeline_source_order(current, source,
+							 hops));
+	}
+#endif
+
+	return order;
+}
+
 /* notify pipeline that this component requires buffers emptied/filled */
 void pipeline_schedule_copy(struct pipeline *p, uint64_t start)
 {
+	/* producers run before their consumers within the same tick */
+	p->pipe_task->order = pipeline_comp_order(p->sink_comp, 0);
+
 	schedule_task(p->pipe_task, start, p->ipc_pipe.period);
 }
 
@@ -968,9 +2532,85 @@ void pipeline_schedule_cancel(struct pipeline *p)
 	schedule_task_cancel(p->pipe_task);
 }
 
-static enum task_state pipeline_task(void *arg)
+#if CONFIG_PIPELINE_MCPS_BUDGET
+#if CONFIG_PIPELINE_MCPS_DEGRADE
+/* Lowers processing quality of the pipeline components by one level,
+ * returns false if they are already at the lowest one.
+ */
+static bool pipeline_budget_degrade(struct pipeline *p)
+{
+	uint32_t i;
+
+	if (p->budget_quality == COMP_QUALITY_BYPASS || !p->copy_list_valid)
+		return false;
+
+	p->budget_quality++;
+
+	pipe_warn(p, "pipeline_budget_degrade(): quality level %u",
+		  p->budget_quality);
+
+	for (i = 0; i < p->copy_list_count; i++)
+		comp_set_attribute(p->copy_list[i].comp, COMP_ATTR_QUALITY,
+				   &p->budget_quality);
+
+	return true;
+}
+#else
+static inline bool pipeline_budget_degrade(struct pipeline *p)
+{
+	return false;
+}
+#endif
+
+/* Compares cycles averaged over a window of runs with the worst case
+ * instruction count per period declared in topology. The host is told
+ * about the first window over budget since the pipeline has started,
+ * quality of its components is lowered after every such window.
+ */
+static void pipeline_budget_check(struct pipeline *p, uint64_t cycles)
+{
+	struct sof_ipc_comp_event event;
+	uint64_t budget = p->ipc_pipe.period_mips;
+
+	if (!budget || p->budget_done)
+		return;
+
+	p->budget_cycles += cycles;
+	if (++p->budget_count < PPL_BUDGET_WINDOW)
+		return;
+
+	cycles = p->budget_cycles / PPL_BUDGET_WINDOW;
+	p->budget_cycles = 0;
+	p->budget_count = 0;
+
+	if (cycles <= budget)
+		return;
+
+	if (!p->budget_over) {
+		pipe_warn(p, "pipeline_budget_check(): %u cycles over budget %u",
+			  (uint32_t)cycles, (uint32_t)budget);
+
+		p->budget_over = true;
+
+		memset(&event, 0, sizeof(event));
+		ipc_build_comp_event(&event, SOF_COMP_NONE,
+				     p->ipc_pipe.comp_id);
+		event.event_type = SOF_CTRL_EVENT_MCPS_BUDGET;
+		/* load in per mille of the budget */
+		event.event_value = cycles * 1000 / budget;
+		ipc_msg_send(p->budget_msg, &event, false);
+	}
+
+	p->budget_done = !pipeline_budget_degrade(p);
+}
+#endif
+
+static enum task_state __hot_text pipeline_task(void *arg)
 {
 	struct pipeline *p = arg;
+#if CONFIG_PIPELINE_MCPS_BUDGET
+	uint64_t start = arch_timer_get_system(cpu_timer_get());
+#endif
 	int err;
 
 	pipe_dbg(p, "pipeline_task()");
@@ -985,7 +2625,7 @@ static enum task_state pipeline_task(void *arg)
 	}
 
 	err = pipeline_copy(p);
-	if (err < 0) {
+	if (err < 0 || p->xrun_bytes) {
 		/* try to recover */
 		err = pipeline_xrun_recover(p);
 		if (err < 0) {
@@ -995,6 +2635,13 @@ static enum task_state pipeline_task(void *arg)
 		}
 	}
 
+	pipeline_posn_update(p);
+
+#if CONFIG_PIPELINE_MCPS_BUDGET
+	pipeline_budget_check(p, arch_timer_get_system(cpu_timer_get()) -
+			      start);
+#endif
+
 	pipe_cl_dbg("pipeline_task() sched");
 
 	return SOF_TASK_STATE_RESCHEDULE;
@@ -163,6 +163,12 @@ static int selector_verify_params(struct comp_dev *dev,
 		in_channels = cd->config.in_channels_count ?
 			cd->config.in_channels_count : buffer->stream.channels;
 		params->channels = in_channels;
+
+#if CONFIG_ACTIVE_CHANNELS
+		/* upstream produces only the selected channel */
+		params->active_mask = out_channels == SEL_SINK_1CH ?
+			BIT(cd->config.sel_channel) : 0;
+#endif
 	}
 
 	/* Set buffer params */
@@ -486,6 +492,17 @@ static int selector_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
+	/* identity channel configuration needs no per-sample work, the
+	 * pipeline then also lets the sink buffer share source memory
+	 */
+	if (cd->source_format == cd->sink_format &&
+	    sourceb->stream.channels == sinkb->stream.channels &&
+	    cd->config.in_channels_count == cd->config.out_channels_count) {
+		comp_info(dev, "selector_prepare(): passthrough");
+		cd->sel_func = sel_passthrough;
+		return 0;
+	}
+
 	cd->sel_func = sel_get_processing_function(dev);
 	if (!cd->sel_func) {
 		comp_err(dev, "selector_prepare(): invalid cd->sel_func, cd->source_format = %u, cd->sink_format = %u, cd->out_channels_count = %u",
@@ -522,6 +539,7 @@ static int selector_reset(struct comp_dev *dev)
 static const struct comp_driver comp_selector = {
 	.type	= SOF_COMP_SELECTOR,
 	.uid	= SOF_UUID(selector_uuid),
+	.flags	= COMP_DRV_INPLACE,
 	.ops	= {
 		.create		= selector_new,
 		.free		= selector_free,
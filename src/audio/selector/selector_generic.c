@@ -126,6 +126,14 @@ static void sel_s32le_nch(struct comp_dev *dev, struct audio_stream *sink,
 }
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 
+void sel_passthrough(struct comp_dev *dev, struct audio_stream *sink,
+		     const struct audio_stream *source, uint32_t frames)
+{
+	/* no-op when the pipeline has the sink sharing source memory */
+	audio_stream_copy(source, 0, sink, 0,
+			  frames * audio_stream_frame_bytes(source));
+}
+
 const struct comp_func_map func_table[] = {
 #if CONFIG_FORMAT_S16LE
 	{SOF_IPC_FRAME_S16_LE, 1, sel_s16le_1ch},
@@ -25,23 +25,35 @@
 #include <ipc/control.h>
 #include <ipc/stream.h>
 #include <ipc/topology.h>
+#include <user/src.h>
 #include <user/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #if SRC_SHORT
 #include <sof/audio/coefficients/src/src_tiny_int16_define.h>
+#if !CONFIG_COMP_SRC_COEF_BLOB_ONLY
 #include <sof/audio/coefficients/src/src_tiny_int16_table.h>
+#endif
 #else
 #include <sof/audio/coefficients/src/src_std_int32_define.h>
+#if !CONFIG_COMP_SRC_COEF_BLOB_ONLY
 #include <sof/audio/coefficients/src/src_std_int32_table.h>
 #endif
+#endif
 
 /* The FIR maximum lengths are per channel so need to multiply them */
 #define MAX_FIR_DELAY_SIZE_XNCH (PLATFORM_MAX_CHANNELS * MAX_FIR_DELAY_SIZE)
 #define MAX_OUT_DELAY_SIZE_XNCH (PLATFORM_MAX_CHANNELS * MAX_OUT_DELAY_SIZE)
 
+/* Max. stage 1 output in bytes per pass of 2 stage SRC. Stage 2 is run
+ * after every pass to consume the intermediate data while it is still
+ * in data cache.
+ */
+#define SRC_2S_PASS_BYTES 2048
+
 static const struct comp_driver comp_src;
 
 /* c1c5326d-8390-46b4-aa47-95c3beca6550 */
@@ -70,8 +82,21 @@ struct comp_data {
 			 int *consumed,
 			 int *produced);
 	void (*polyphase_func)(struct src_stage_prm *s);
+#if CONFIG_COMP_SRC_COEF_BLOB
+	struct src_coef *coef;		/* run-time coefficients in use */
+	struct src_coef *coef_loaded;	/* coefficients loaded by this SRC */
+	struct sof_src_coef_config *config_new;
+	uint32_t config_size;
+#endif
 };
 
+#if CONFIG_COMP_SRC_COEF_BLOB_ONLY
+/* Only the 1:1 copy is available before coefficients are loaded, it does
+ * not use the coefficients.
+ */
+static struct src_stage src_pass = { 0, 0, 1, 1, 1, 1, 1, 0, -1, NULL };
+#endif
+
 /* Calculates the needed FIR delay line length */
 static int src_fir_delay_length(struct src_stage *s)
 {
@@ -85,6 +110,29 @@ static int src_out_delay_length(struct src_stage *s)
 	return 1 + (s->num_of_subfilters - 1) * s->odm;
 }
 
+#if CONFIG_PIPELINE_LATENCY
+/* Calculates the group delay of the conversion in output frames, half of
+ * the subfilter length of each stage taken at the stage input rate.
+ */
+static uint32_t src_delay_frames(struct comp_data *cd)
+{
+	struct src_param *a = &cd->param;
+	struct src_stage *s1 = a->stage1;
+	struct src_stage *s2 = a->stage2;
+	uint32_t delay = 0;
+
+	if (s1->filter_length > 1)
+		delay += s1->subfilter_length * a->fs_out / (2 * a->fs_in);
+
+	if (s2->filter_length > 1)
+		delay += s2->subfilter_length * s2->blk_out /
+			(2 * s2->blk_in);
+
+	return delay;
+}
+#endif
+
+#if !CONFIG_COMP_SRC_COEF_BLOB_ONLY
 /* Returns index of a matching sample rate */
 static int src_find_fs(int fs_list[], int list_length, int fs)
 {
@@ -96,40 +144,115 @@ static int src_find_fs(int fs_list[], int list_length, int fs)
 	}
 	return -EINVAL;
 }
+#endif
 
-/* Calculates buffers to allocate for a SRC mode */
-int src_buffer_lengths(struct src_param *a, int fs_in, int fs_out, int nch,
-		       int source_frames)
+#if CONFIG_COMP_SRC_CASCADE
+/* Tells if the tables convert with a single polyphase stage */
+static bool src_single_stage(int idx_out, int idx_in)
 {
-	struct src_stage *stage1;
-	struct src_stage *stage2;
-	int r1;
+	return src_table1[idx_out][idx_in]->filter_length > 1 &&
+		src_table2[idx_out][idx_in]->filter_length == 1;
+}
 
-	if (nch > PLATFORM_MAX_CHANNELS) {
-		/* TODO: should be device, not class */
-		comp_cl_err(&comp_src, "src_buffer_lengths(): nch = %u > PLATFORM_MAX_CHANNELS",
-			    nch);
+/* Composes a conversion missing from the tables of two single stage
+ * conversions through an intermediate rate. The lowest intermediate rate
+ * that keeps the bandwidth of a direct conversion is taken for the
+ * least load. The stages stay unset if there is no such rate.
+ */
+static void src_cascade_stages(struct src_param *a, int idx_in, int idx_out)
+{
+	int fs_min = MIN(src_in_fs[idx_in], src_out_fs[idx_out]);
+	int fs_mid = 0;
+	int mid_out = 0;
+	int mid_in = 0;
+	int idx;
+	int i;
+
+	for (i = 0; i < NUM_OUT_FS; i++) {
+		if (src_out_fs[i] < fs_min ||
+		    (fs_mid && src_out_fs[i] >= fs_mid))
+			continue;
+
+		idx = src_find_fs(src_in_fs, NUM_IN_FS, src_out_fs[i]);
+		if (idx < 0 || !src_single_stage(i, idx_in) ||
+		    !src_single_stage(idx_out, idx))
+			continue;
+
+		fs_mid = src_out_fs[i];
+		mid_out = i;
+		mid_in = idx;
+	}
+
+	if (!fs_mid)
+		return;
+
+	a->stage1 = src_table1[mid_out][idx_in];
+	a->stage2 = src_table1[idx_out][mid_in];
+
+	comp_cl_info(&comp_src, "src_cascade_stages(): fs_in: %u, fs_mid: %u, fs_out: %u",
+		     src_in_fs[idx_in], fs_mid, src_out_fs[idx_out]);
+}
+#endif
+
+/* Finds the built-in coefficients for a conversion */
+int src_find_stages(struct src_param *a, int fs_in, int fs_out)
+{
+#if CONFIG_COMP_SRC_COEF_BLOB_ONLY
+	if (fs_in != fs_out) {
+		comp_cl_err(&comp_src, "src_find_stages(): no coefficients loaded, fs_in: %u, fs_out: %u",
+			    fs_in, fs_out);
 		return -EINVAL;
 	}
 
-	a->nch = nch;
-	a->idx_in = src_find_fs(src_in_fs, NUM_IN_FS, fs_in);
-	a->idx_out = src_find_fs(src_out_fs, NUM_OUT_FS, fs_out);
+	a->stage1 = &src_pass;
+	a->stage2 = &src_pass;
+#else
+	int idx_in = src_find_fs(src_in_fs, NUM_IN_FS, fs_in);
+	int idx_out = src_find_fs(src_out_fs, NUM_OUT_FS, fs_out);
 
 	/* Check that both in and out rates are supported */
-	if (a->idx_in < 0 || a->idx_out < 0) {
-		comp_cl_err(&comp_src, "src_buffer_lengths(): rates not supported, fs_in: %u, fs_out: %u",
+	if (idx_in < 0 || idx_out < 0) {
+		comp_cl_err(&comp_src, "src_find_stages(): rates not supported, fs_in: %u, fs_out: %u",
 			    fs_in, fs_out);
 		return -EINVAL;
 	}
 
-	stage1 = src_table1[a->idx_out][a->idx_in];
-	stage2 = src_table2[a->idx_out][a->idx_in];
+	a->stage1 = src_table1[idx_out][idx_in];
+	a->stage2 = src_table2[idx_out][idx_in];
+
+#if CONFIG_COMP_SRC_CASCADE
+	if (a->stage1->filter_length < 1)
+		src_cascade_stages(a, idx_in, idx_out);
+#endif
+#endif
+	a->fs_in = fs_in;
+	a->fs_out = fs_out;
+
+	return 0;
+}
+
+/* Calculates buffers to allocate for a SRC mode, the stages are set
+ * with src_find_stages() or from run-time loaded coefficients.
+ */
+int src_buffer_lengths(struct src_param *a, int nch, int source_frames)
+{
+	struct src_stage *stage1 = a->stage1;
+	struct src_stage *stage2 = a->stage2;
+	int r1;
+
+	if (nch > PLATFORM_MAX_CHANNELS) {
+		/* TODO: should be device, not class */
+		comp_cl_err(&comp_src, "src_buffer_lengths(): nch = %u > PLATFORM_MAX_CHANNELS",
+			    nch);
+		return -EINVAL;
+	}
+
+	a->nch = nch;
 
 	/* Check from stage1 parameter for a deleted in/out rate combination.*/
 	if (stage1->filter_length < 1) {
 		comp_cl_err(&comp_src, "src_buffer_lengths(): Non-supported combination sfs_in = %d, fs_out = %d",
-			    fs_in, fs_out);
+			    a->fs_in, a->fs_out);
 		return -EINVAL;
 	}
 
@@ -256,18 +379,14 @@ void src_polyphase_reset(struct polyphase_src *src)
 int src_polyphase_init(struct polyphase_src *src, struct src_param *p,
 		       int32_t *delay_lines_start)
 {
-	struct src_stage *stage1;
-	struct src_stage *stage2;
 	int n_stages;
 	int ret;
 
-	if (p->idx_in < 0 || p->idx_out < 0)
+	if (!p->stage1 || !p->stage2)
 		return -EINVAL;
 
 	/* Get setup for 2 stage conversion */
-	stage1 = src_table1[p->idx_out][p->idx_in];
-	stage2 = src_table2[p->idx_out][p->idx_in];
-	ret = init_stages(stage1, stage2, src, p, 2, delay_lines_start);
+	ret = init_stages(p->stage1, p->stage2, src, p, 2, delay_lines_start);
 	if (ret < 0)
 		return -EINVAL;
 
@@ -278,7 +397,7 @@ int src_polyphase_init(struct polyphase_src *src, struct src_param *p,
 	 * tap.
 	 */
 	n_stages = (src->stage2->filter_length == 1) ? 1 : 2;
-	if (p->idx_in == p->idx_out)
+	if (p->fs_in == p->fs_out)
 		n_stages = 0;
 
 	/* If filter length for first stage is zero this is a deleted
@@ -306,8 +425,11 @@ static void src_2s(struct comp_dev *dev, const struct audio_stream *source,
 {
 	struct src_stage_prm s1;
 	struct src_stage_prm s2;
+	int s1_times;
+	int s1_pass;
 	int s1_blk_in;
 	int s1_blk_out;
+	int s2_times;
 	int s2_blk_in;
 	int s2_blk_out;
 	struct comp_data *cd = comp_get_drvdata(dev);
@@ -347,48 +469,59 @@ static void src_2s(struct comp_dev *dev, const struct audio_stream *source,
 	s2.shift = cd->data_shift;
 
 	/* Test if 1st stage can be run with default block length to reach
-	 * the period length or just under it.
-	 */
-	s1.times = cd->param.stage1_times;
-	s1_blk_in = s1.times * cd->src.stage1->blk_in * nch;
-	s1_blk_out = s1.times * cd->src.stage1->blk_out * nch;
-
-	/* The sbuf may limit how many times s1 can be looped. It's harder
-	 * to prepare for in advance so the repeats number is adjusted down
-	 * here if need.
+	 * the period length or just under it. The repeats are already
+	 * limited by sbuf free space in src_get_copy_limits().
 	 */
-	if (s1_blk_out > sbuf_free) {
-		s1.times = sbuf_free / (cd->src.stage1->blk_out * nch);
-		s1_blk_in = s1.times * cd->src.stage1->blk_in * nch;
-		s1_blk_out = s1.times * cd->src.stage1->blk_out * nch;
-		comp_dbg(dev, "s1.times = %d", s1.times);
+	s1_times = cd->param.stage1_times;
+	s1_blk_in = s1_times * cd->src.stage1->blk_in * nch;
+	s1_blk_out = s1_times * cd->src.stage1->blk_out * nch;
+	if (avail_b < s1_blk_in * sz || sbuf_free < s1_blk_out) {
+		s1_times = 0;
+		s1_blk_out = 0;
 	}
 
-	if (avail_b >= s1_blk_in * sz && sbuf_free >= s1_blk_out) {
-		cd->polyphase_func(&s1);
-
-		cd->sbuf_w_ptr = s1.y_wptr;
-		cd->sbuf_avail += s1_blk_out;
-		*n_read += s1.times * cd->src.stage1->blk_in;
-	}
-
-	s2.times = cd->param.stage2_times;
-	s2_blk_in = s2.times * cd->src.stage2->blk_in * nch;
-	s2_blk_out = s2.times * cd->src.stage2->blk_out * nch;
-	if (s2_blk_in > cd->sbuf_avail) {
-		s2.times = cd->sbuf_avail / (cd->src.stage2->blk_in * nch);
-		s2_blk_in = s2.times * cd->src.stage2->blk_in * nch;
-		s2_blk_out = s2.times * cd->src.stage2->blk_out * nch;
-		comp_dbg(dev, "s2.times = %d", s2.times);
+	/* Stage 2 can consume what is in sbuf after stage 1 has run */
+	s2_times = cd->param.stage2_times;
+	s2_blk_in = cd->src.stage2->blk_in * nch;
+	s2_blk_out = cd->src.stage2->blk_out * nch;
+	if (s2_times * s2_blk_in > cd->sbuf_avail + s1_blk_out) {
+		s2_times = (cd->sbuf_avail + s1_blk_out) / s2_blk_in;
+		comp_dbg(dev, "s2.times = %d", s2_times);
 	}
 
 	/* Test if second stage can be run with default block length. */
-	if (cd->sbuf_avail >= s2_blk_in && free_b >= s2_blk_out * sz) {
-		cd->polyphase_func(&s2);
+	if (free_b < s2_times * s2_blk_out * sz)
+		s2_times = 0;
+
+	/* Run stage 1 in passes of limited output size and stage 2 after
+	 * each pass, so that the sbuf data stays in cache between stages.
+	 * With short periods this is a single pass of both stages.
+	 */
+	s1_pass = MAX(SRC_2S_PASS_BYTES /
+		      (cd->src.stage1->blk_out * nch * sizeof(int32_t)), 1);
+	while (s1_times > 0 || s2_times > 0) {
+		s1.times = MIN(s1_times, s1_pass);
+		if (s1.times) {
+			cd->polyphase_func(&s1);
+
+			cd->sbuf_w_ptr = s1.y_wptr;
+			cd->sbuf_avail += s1.times * cd->src.stage1->blk_out *
+					  nch;
+			*n_read += s1.times * cd->src.stage1->blk_in;
+			s1_times -= s1.times;
+		}
 
-		cd->sbuf_r_ptr = s2.x_rptr;
-		cd->sbuf_avail -= s2_blk_in;
-		*n_written += s2.times * cd->src.stage2->blk_out;
+		s2.times = MIN(s2_times, cd->sbuf_avail / s2_blk_in);
+		if (s2.times) {
+			cd->polyphase_func(&s2);
+
+			cd->sbuf_r_ptr = s2.x_rptr;
+			cd->sbuf_avail -= s2.times * s2_blk_in;
+			*n_written += s2.times * cd->src.stage2->blk_out;
+			s2_times -= s2.times;
+		} else if (!s1.times) {
+			break;
+		}
 	}
 }
 
@@ -506,6 +639,13 @@ static void src_free(struct comp_dev *dev)
 	if (cd->delay_lines)
 		rfree(cd->delay_lines);
 
+#if CONFIG_COMP_SRC_COEF_BLOB
+	src_coef_put(cd->coef);
+	src_coef_put(cd->coef_loaded);
+	if (cd->config_new)
+		rfree(cd->config_new);
+#endif
+
 	rfree(cd);
 	rfree(dev);
 }
@@ -546,6 +686,29 @@ static int src_verify_params(struct comp_dev *dev,
 	return 0;
 }
 
+/* Selects coefficients loaded at run-time for the conversion when available,
+ * the built-in tables otherwise.
+ */
+static int src_setup_stages(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+#if CONFIG_COMP_SRC_COEF_BLOB
+	src_coef_put(cd->coef);
+	cd->coef = src_coef_get(cd->source_rate, cd->sink_rate);
+	if (cd->coef) {
+		comp_info(dev, "src_setup_stages(), using loaded coefficients");
+		cd->param.stage1 = &cd->coef->stage1;
+		cd->param.stage2 = &cd->coef->stage2;
+		cd->param.fs_in = cd->source_rate;
+		cd->param.fs_out = cd->sink_rate;
+		return 0;
+	}
+#endif
+
+	return src_find_stages(&cd->param, cd->source_rate, cd->sink_rate);
+}
+
 /* set component audio stream parameters */
 static int src_params(struct comp_dev *dev,
 		      struct sof_ipc_stream_params *params)
@@ -595,9 +758,14 @@ static int src_params(struct comp_dev *dev,
 	comp_info(dev, "src_params(), sourceb->channels = %u, sinkb->channels = %u, dev->frames = %u",
 		  sourceb->stream.channels,
 		  sinkb->stream.channels, dev->frames);
-	err = src_buffer_lengths(&cd->param, cd->source_rate,
-				 cd->sink_rate,
-				 sourceb->stream.channels, cd->source_frames);
+	err = src_setup_stages(dev);
+	if (err < 0) {
+		comp_err(dev, "src_params(): src_setup_stages() failed");
+		return err;
+	}
+
+	err = src_buffer_lengths(&cd->param, sourceb->stream.channels,
+				 cd->source_frames);
 	if (err < 0) {
 		comp_err(dev, "src_params(): src_buffer_lengths() failed");
 		return err;
@@ -664,6 +832,87 @@ static int src_ctrl_cmd(struct comp_dev *dev, struct sof_ipc_ctrl_data *cdata)
 	return -EINVAL;
 }
 
+#if CONFIG_COMP_SRC_COEF_BLOB
+/* Receives a coefficient blob, possibly in several messages. The
+ * coefficients are registered for sharing once complete and are used
+ * from the next params() with the matching rates.
+ */
+static int src_cmd_set_data(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct src_coef *coef;
+	uint32_t size = cdata->num_elems + cdata->elems_remaining;
+	uint32_t offset;
+	int ret;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		comp_err(dev, "src_cmd_set_data(): invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	comp_info(dev, "src_cmd_set_data(): blob size: %u msg_index %u",
+		  size, cdata->msg_index);
+
+	if (cdata->msg_index == 0) {
+		/* Check that there is no work-in-progress previous request */
+		if (cd->config_new) {
+			comp_err(dev, "src_cmd_set_data(), busy with previous request");
+			return -EBUSY;
+		}
+
+		if (size > SOF_SRC_COEF_MAX_SIZE)
+			return -EINVAL;
+
+		cd->config_new = rballoc(0, SOF_MEM_CAPS_RAM, size);
+		if (!cd->config_new) {
+			comp_err(dev, "src_cmd_set_data(): buffer allocation failed");
+			return -ENOMEM;
+		}
+
+		cd->config_size = size;
+		offset = 0;
+	} else {
+		if (!cd->config_new || size > cd->config_size)
+			return -EINVAL;
+
+		offset = cd->config_size - size;
+	}
+
+	ret = memcpy_s((char *)cd->config_new + offset,
+		       cd->config_size - offset, cdata->data->data,
+		       cdata->num_elems);
+	if (ret < 0 || cdata->elems_remaining)
+		goto out;
+
+	if (cd->config_new->size != cd->config_size) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	ret = src_coef_add(cd->config_new, &coef);
+	if (ret < 0)
+		goto out;
+
+	/* a previously loaded set is released when no SRC uses it */
+	src_coef_put(cd->coef_loaded);
+	cd->coef_loaded = coef;
+
+	comp_info(dev, "src_cmd_set_data(): coefficients for %u -> %u, %d users",
+		  coef->fs_in, coef->fs_out, coef->refs);
+
+out:
+	if (ret < 0 || !cdata->elems_remaining) {
+		if (ret < 0)
+			comp_err(dev, "src_cmd_set_data(): invalid blob");
+		rfree(cd->config_new);
+		cd->config_new = NULL;
+	}
+
+	return ret;
+}
+#endif /* CONFIG_COMP_SRC_COEF_BLOB */
+
 /* used to pass standard and bespoke commands (with data) to component */
 static int src_cmd(struct comp_dev *dev, int cmd, void *data,
 		   int max_data_size)
@@ -673,8 +922,18 @@ static int src_cmd(struct comp_dev *dev, int cmd, void *data,
 
 	comp_info(dev, "src_cmd()");
 
-	if (cmd == COMP_CMD_SET_VALUE)
+	switch (cmd) {
+	case COMP_CMD_SET_VALUE:
 		ret = src_ctrl_cmd(dev, cdata);
+		break;
+#if CONFIG_COMP_SRC_COEF_BLOB
+	case COMP_CMD_SET_DATA:
+		ret = src_cmd_set_data(dev, cdata);
+		break;
+#endif
+	default:
+		break;
+	}
 
 	return ret;
 }
@@ -700,6 +959,8 @@ static int src_get_copy_limits(struct comp_data *cd,
 	struct src_stage *s2;
 	int frames_src;
 	int frames_snk;
+	int sbuf_free;
+	int nch;
 
 	/* Get SRC parameters */
 	sp = &cd->param;
@@ -739,6 +1000,17 @@ static int src_get_copy_limits(struct comp_data *cd,
 	if (sp->blk_in == 0 || sp->blk_out == 0)
 		return -EIO;
 
+	/* The sbuf may limit how many times s1 can be looped, stage 2 can
+	 * still run from sbuf when s1 can't be run at all.
+	 */
+	if (s2->filter_length > 1) {
+		nch = source->stream.channels;
+		sbuf_free = sp->sbuf_length - cd->sbuf_avail;
+		sp->stage1_times = MIN(sp->stage1_times,
+				       sbuf_free / (s1->blk_out * nch));
+		sp->blk_in = sp->stage1_times * s1->blk_in;
+	}
+
 	return 0;
 }
 
@@ -749,8 +1021,9 @@ static void src_process(struct comp_dev *dev, struct comp_buffer *source,
 	int consumed = 0;
 	int produced = 0;
 
-	/* consumed bytes are not known at this point */
-	buffer_invalidate(source, source->stream.size);
+	/* invalidate only the frames that will be read */
+	buffer_invalidate(source, cd->param.blk_in *
+			  audio_stream_frame_bytes(&source->stream));
 	cd->src_func(dev, &source->stream, &sink->stream, &consumed, &produced);
 	buffer_writeback(sink, produced *
 			 audio_stream_frame_bytes(&sink->stream));
@@ -804,9 +1077,72 @@ static int src_copy(struct comp_dev *dev)
 	return 0;
 }
 
-static int src_prepare(struct comp_dev *dev)
+/* selects processing functions for the format of the buffers */
+static int src_set_format(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sinkb;
+	struct comp_buffer *sourceb;
+
+	sourceb = list_first_item(&dev->bsource_list,
+				  struct comp_buffer, sink_list);
+	sinkb = list_first_item(&dev->bsink_list,
+				struct comp_buffer, source_list);
+
+	cd->source_format = sourceb->stream.frame_fmt;
+	cd->sink_format = sinkb->stream.frame_fmt;
+
+	/* SRC supports S16_LE, S24_4LE and S32_LE formats */
+	if (cd->source_format != cd->sink_format) {
+		comp_err(dev, "src_set_format(): Source fmt %d and sink fmt %d are different.",
+			 cd->source_format, cd->sink_format);
+		return -EINVAL;
+	}
+
+	switch (cd->source_format) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+		cd->data_shift = 0;
+		cd->polyphase_func = src_polyphase_stage_cir_s16;
+		/* Copy function is set by default in params() for 32 bit
+		 * data. Change it to 16 bit version here if source and sink
+		 * rates are equal.
+		 */
+		if (cd->source_rate == cd->sink_rate)
+			cd->src_func = src_copy_s16;
+		break;
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+		cd->data_shift = 8;
+		cd->polyphase_func = src_polyphase_stage_cir;
+		break;
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+		cd->data_shift = 0;
+		cd->polyphase_func = src_polyphase_stage_cir;
+		break;
+#endif /* CONFIG_FORMAT_S32LE */
+	default:
+		comp_err(dev, "src_set_format(): invalid format %d",
+			 cd->source_format);
+		return -EINVAL;
+	}
+
+	/* one block of the first stage in and of the last stage out */
+	dev->min_source_bytes = cd->src.stage1->blk_in *
+		audio_stream_frame_bytes(&sourceb->stream);
+	dev->min_sink_bytes = (cd->src.stage2->filter_length > 1 ?
+			       cd->src.stage2->blk_out :
+			       cd->src.stage1->blk_out) *
+		audio_stream_frame_bytes(&sinkb->stream);
+
+	return 0;
+}
+
+static int src_prepare(struct comp_dev *dev)
+{
 	struct sof_ipc_comp_config *config = dev_comp_config(dev);
 	struct comp_buffer *sinkb;
 	struct comp_buffer *sourceb;
@@ -829,13 +1165,11 @@ static int src_prepare(struct comp_dev *dev)
 	sinkb = list_first_item(&dev->bsink_list,
 				struct comp_buffer, source_list);
 
-	/* get source data format and period bytes */
-	cd->source_format = sourceb->stream.frame_fmt;
+	/* get source period bytes */
 	source_period_bytes = audio_stream_period_bytes(&sourceb->stream,
 							dev->frames);
 
-	/* get sink data format and period bytes */
-	cd->sink_format = sinkb->stream.frame_fmt;
+	/* get sink period bytes */
 	sink_period_bytes = audio_stream_period_bytes(&sinkb->stream,
 						      dev->frames);
 
@@ -857,45 +1191,13 @@ static int src_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
-	/* SRC supports S16_LE, S24_4LE and S32_LE formats */
-	if (cd->source_format != cd->sink_format) {
-		comp_err(dev, "src_prepare(): Source fmt %d and sink fmt %d are different.",
-			 cd->source_format, cd->sink_format);
-		ret = -EINVAL;
+	ret = src_set_format(dev);
+	if (ret < 0)
 		goto err;
-	}
 
-	switch (cd->source_format) {
-#if CONFIG_FORMAT_S16LE
-	case SOF_IPC_FRAME_S16_LE:
-		cd->data_shift = 0;
-		cd->polyphase_func = src_polyphase_stage_cir_s16;
-		/* Copy function is set by default in params() for 32 bit
-		 * data. Change it to 16 bit version here if source and sink
-		 * rates are equal.
-		 */
-		if (cd->source_rate == cd->sink_rate)
-			cd->src_func = src_copy_s16;
-		break;
-#endif /* CONFIG_FORMAT_S16LE */
-#if CONFIG_FORMAT_S24LE
-	case SOF_IPC_FRAME_S24_4LE:
-		cd->data_shift = 8;
-		cd->polyphase_func = src_polyphase_stage_cir;
-		break;
-#endif /* CONFIG_FORMAT_S24LE */
-#if CONFIG_FORMAT_S32LE
-	case SOF_IPC_FRAME_S32_LE:
-		cd->data_shift = 0;
-		cd->polyphase_func = src_polyphase_stage_cir;
-		break;
-#endif /* CONFIG_FORMAT_S32LE */
-	default:
-		comp_err(dev, "src_prepare(): invalid format %d",
-			 cd->source_format);
-		ret = -EINVAL;
-		goto err;
-	}
+#if CONFIG_PIPELINE_LATENCY
+	dev->delay_frames = src_delay_frames(comp_get_drvdata(dev));
+#endif
 
 	return 0;
 
@@ -904,6 +1206,23 @@ err:
 	return ret;
 }
 
+/* Changes rates or format of a prepared or running SRC. Delay lines are
+ * set up again, so the conversion restarts from silence.
+ */
+static int src_reconfig(struct comp_dev *dev,
+			struct sof_ipc_stream_params *params)
+{
+	int ret;
+
+	comp_info(dev, "src_reconfig()");
+
+	ret = src_params(dev, params);
+	if (ret < 0)
+		return ret;
+
+	return src_set_format(dev);
+}
+
 static int src_reset(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
@@ -912,6 +1231,20 @@ static int src_reset(struct comp_dev *dev)
 
 	cd->src_func = src_fallback;
 	src_polyphase_reset(&cd->src);
+	dev->min_source_bytes = 0;
+	dev->min_sink_bytes = 0;
+
+	/* delay lines are allocated again by next params() */
+	rfree(cd->delay_lines);
+	cd->delay_lines = NULL;
+
+#if CONFIG_COMP_SRC_COEF_BLOB
+	/* drop a run-time coefficient set not used after reset */
+	src_coef_put(cd->coef);
+	cd->coef = NULL;
+	cd->param.stage1 = NULL;
+	cd->param.stage2 = NULL;
+#endif
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
@@ -924,6 +1257,7 @@ static const struct comp_driver comp_src = {
 		.create = src_new,
 		.free = src_free,
 		.params = src_params,
+		.reconfig = src_reconfig,
 		.cmd = src_cmd,
 		.trigger = src_trigger,
 		.copy = src_copy,
@@ -938,6 +1272,9 @@ static SHARED_DATA struct comp_driver_info comp_src_info = {
 
 static void sys_comp_src_init(void)
 {
+#if CONFIG_COMP_SRC_COEF_BLOB
+	src_coef_init();
+#endif
 	comp_register(platform_shared_get(&comp_src_info,
 					  sizeof(comp_src_info)));
 }
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/common.h>
+#include <sof/audio/src/src.h>
+#include <sof/audio/src/src_config.h>
+#include <sof/debug/panic.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
+#include <sof/lib/memory.h>
+#include <sof/list.h>
+#include <sof/string.h>
+#include <ipc/topology.h>
+#include <user/src.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if SRC_SHORT
+#define SRC_COEF_BITS	16
+#else
+#define SRC_COEF_BITS	32
+#endif
+
+/* coefficient sets loaded at run-time, all accesses come from IPC context */
+static SHARED_DATA struct list_item src_coef_list;
+
+static struct list_item *src_coef_list_get(void)
+{
+	return platform_shared_get(&src_coef_list, sizeof(src_coef_list));
+}
+
+/* Bytes taken by the coefficients of one stage in the blob */
+static size_t src_coef_stage_bytes(const struct sof_src_stage_config *s)
+{
+	return ALIGN_UP(s->filter_length * SRC_COEF_BITS / 8, sizeof(int32_t));
+}
+
+static int src_coef_stage_valid(const struct sof_src_stage_config *s)
+{
+	if (s->filter_length < 1 || s->num_of_subfilters < 1 ||
+	    s->subfilter_length < 1 || s->blk_in < 1 || s->blk_out < 1)
+		return 0;
+
+	return s->filter_length == s->num_of_subfilters * s->subfilter_length;
+}
+
+static void src_coef_stage_init(struct src_stage *stage,
+				const struct sof_src_stage_config *s,
+				const void *coefs)
+{
+	struct src_stage init = {
+		.idm = s->idm,
+		.odm = s->odm,
+		.num_of_subfilters = s->num_of_subfilters,
+		.subfilter_length = s->subfilter_length,
+		.filter_length = s->filter_length,
+		.blk_in = s->blk_in,
+		.blk_out = s->blk_out,
+		.halfband = s->halfband,
+		.shift = s->shift,
+		.coefs = coefs,
+	};
+	int ret;
+
+	/* stage parameters are const, the entry was just allocated */
+	ret = memcpy_s(stage, sizeof(*stage), &init, sizeof(init));
+	assert(!ret);
+}
+
+static struct src_coef *src_coef_find(int fs_in, int fs_out)
+{
+	struct list_item *clist;
+	struct src_coef *coef;
+
+	list_for_item(clist, src_coef_list_get()) {
+		coef = container_of(clist, struct src_coef, list);
+		if (coef->fs_in == fs_in && coef->fs_out == fs_out)
+			return coef;
+	}
+
+	return NULL;
+}
+
+int src_coef_add(const struct sof_src_coef_config *config,
+		 struct src_coef **coef)
+{
+	const struct sof_src_stage_config *s1 = &config->stage[0];
+	const struct sof_src_stage_config *s2 = &config->stage[1];
+	struct src_coef *new;
+	size_t bytes;
+	int ret;
+
+	if (config->size < sizeof(*config) ||
+	    config->size > SOF_SRC_COEF_MAX_SIZE ||
+	    !config->source_rate || !config->sink_rate)
+		return -EINVAL;
+
+	if (config->coef_bits != SRC_COEF_BITS)
+		return -EINVAL;
+
+	if (!src_coef_stage_valid(s1) || !src_coef_stage_valid(s2))
+		return -EINVAL;
+
+	bytes = src_coef_stage_bytes(s1) + src_coef_stage_bytes(s2);
+	if (config->size != sizeof(*config) + bytes)
+		return -EINVAL;
+
+	/* an identical ratio is already loaded, share it */
+	new = src_coef_find(config->source_rate, config->sink_rate);
+	if (new) {
+		new->refs++;
+		*coef = new;
+		return 0;
+	}
+
+	new = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+		      SOF_MEM_CAPS_RAM, sizeof(*new));
+	if (!new)
+		return -ENOMEM;
+
+	/* coefficients are read in the FIR loops so keep them cacheable */
+	new->coefs = rballoc(0, SOF_MEM_CAPS_RAM, bytes);
+	if (!new->coefs) {
+		rfree(new);
+		return -ENOMEM;
+	}
+
+	ret = memcpy_s(new->coefs, bytes, config->data, bytes);
+	assert(!ret);
+	dcache_writeback_region(new->coefs, bytes);
+
+	new->fs_in = config->source_rate;
+	new->fs_out = config->sink_rate;
+	new->refs = 1;
+	src_coef_stage_init(&new->stage1, s1, new->coefs);
+	src_coef_stage_init(&new->stage2, s2, (char *)new->coefs +
+			    src_coef_stage_bytes(s1));
+
+	list_item_prepend(&new->list, src_coef_list_get());
+
+	*coef = new;
+	return 0;
+}
+
+struct src_coef *src_coef_get(int fs_in, int fs_out)
+{
+	struct src_coef *coef = src_coef_find(fs_in, fs_out);
+
+	if (coef)
+		coef->refs++;
+
+	return coef;
+}
+
+void src_coef_put(struct src_coef *coef)
+{
+	if (!coef || --coef->refs > 0)
+		return;
+
+	list_item_del(&coef->list);
+	rfree(coef->coefs);
+	rfree(coef);
+}
+
+void src_coef_init(void)
+{
+	list_init(src_coef_list_get());
+}
@@ -14,6 +14,7 @@
 
 #include <sof/audio/format.h>
 #include <sof/audio/src/src.h>
+#include <sof/compiler_attributes.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -223,7 +224,7 @@ static inline void fir_filter_generic(int32_t *rp, const void *cp, int32_t *wp0,
 #endif /* 32bit coefficients version */
 
 #if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
-void src_polyphase_stage_cir(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir(struct src_stage_prm *s)
 {
 	int i;
 	int n;
@@ -324,7 +325,7 @@ void src_polyphase_stage_cir(struct src_stage_prm *s)
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 
 #if CONFIG_FORMAT_S16LE
-void src_polyphase_stage_cir_s16(struct src_stage_prm *s)
+void __hot_text src_polyphase_stage_cir_s16(struct src_stage_prm *s)
 {
 	int i;
 	int n;
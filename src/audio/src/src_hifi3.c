@@ -47,64 +47,74 @@ static inline void fir_filter(ae_f32 *rp, const void *cp, ae_f32 *wp0,
 	ae_f32 *wp = wp0;
 	const int inc = nch * sizeof(int32_t);
 
-	if (nch == 2) {
-		/* Move data pointer back by one sample to start from right
-		 * channel sample. Discard read value p0.
+	if (!(nch & 1)) {
+		/* Even channels count, compute the channels in pairs with
+		 * two accumulators. The delay line is written backwards so
+		 * a pair is loaded from one sample below its first channel,
+		 * that is 64 bit aligned when channels count is even.
 		 */
-		dp = (ae_f32x2 *)rp;
-		AE_L32_XC(d0, (ae_f32 *)dp, -sizeof(ae_f32));
-
-		/* Reset coefficient pointer and clear accumulator */
-		coefp = (ae_f16x4 *)cp;
-		a0 = AE_ZERO64();
-		a1 = AE_ZERO64();
-
-		/* Compute FIR filter for current channel with four
-		 * taps per every loop iteration.  Four coefficients
-		 * are loaded simultaneously. Data is read
-		 * from interleaved buffer with stride of channels
-		 * count.
-		 */
-		for (i = 0; i < taps_div_4; i++) {
-			/* Load four coefficients */
-			AE_LA16X4_IP(coef4, u, coefp);
-
-			/* Load two data samples from two channels */
-			AE_L32X2_XC(d0, dp, inc); /* r0, l0 */
-			AE_L32X2_XC(d1, dp, inc); /* r1, l1 */
-
-			/* Select to data2 sequential samples from a channel
-			 * and then accumulate to a0 and a1
-			 * data2_h * coef4_3 + data2_l * coef4_2.
-			 * The data is 32 bits Q1.31 and coefficient 16 bits
-			 * Q1.15. The accumulators are Q17.47.
+		dp1 = (ae_f32 *)rp;
+		for (j = 0; j < nch; j += 2) {
+			/* Move data pointer back by one sample to start
+			 * from right channel sample of the pair, and the
+			 * pair pointer to the next pair. Discard read values.
 			 */
-			data2 = AE_SEL32_LL(d0, d1); /* l0, l1 */
-			AE_MULAAFD32X16_H3_L2(a0, data2, coef4);
-			data2 = AE_SEL32_HH(d0, d1); /* r0, r1 */
-			AE_MULAAFD32X16_H3_L2(a1, data2, coef4);
+			dp = (ae_f32x2 *)dp1;
+			AE_L32_XC(d0, (ae_f32 *)dp, -sizeof(ae_f32));
+			AE_L32_XC(d0, dp1, -2 * sizeof(ae_f32));
+
+			/* Reset coefficient pointer and clear accumulator */
+			coefp = (ae_f16x4 *)cp;
+			a0 = AE_ZERO64();
+			a1 = AE_ZERO64();
+
+			/* Compute FIR filter for current channel pair with
+			 * four taps per every loop iteration. Four
+			 * coefficients are loaded simultaneously. Data is
+			 * read from interleaved buffer with stride of
+			 * channels count.
+			 */
+			for (i = 0; i < taps_div_4; i++) {
+				/* Load four coefficients */
+				AE_LA16X4_IP(coef4, u, coefp);
+
+				/* Load two data samples from two channels */
+				AE_L32X2_XC(d0, dp, inc); /* r0, l0 */
+				AE_L32X2_XC(d1, dp, inc); /* r1, l1 */
+
+				/* Select to data2 sequential samples from a
+				 * channel and then accumulate to a0 and a1
+				 * data2_h * coef4_3 + data2_l * coef4_2.
+				 * The data is 32 bits Q1.31 and coefficient
+				 * 16 bits Q1.15. The accumulators are Q17.47.
+				 */
+				data2 = AE_SEL32_LL(d0, d1); /* l0, l1 */
+				AE_MULAAFD32X16_H3_L2(a0, data2, coef4);
+				data2 = AE_SEL32_HH(d0, d1); /* r0, r1 */
+				AE_MULAAFD32X16_H3_L2(a1, data2, coef4);
 
-			/* Load two data samples from two channels */
-			AE_L32X2_XC(d0, dp, inc); /* r2, l2 */
-			AE_L32X2_XC(d1, dp, inc); /* r3, l3 */
+				/* Load two data samples from two channels */
+				AE_L32X2_XC(d0, dp, inc); /* r2, l2 */
+				AE_L32X2_XC(d1, dp, inc); /* r3, l3 */
 
-			/* Accumulate
-			 * data2_h * coef4_1 + data2_l * coef4_0.
+				/* Accumulate
+				 * data2_h * coef4_1 + data2_l * coef4_0.
+				 */
+				data2 = AE_SEL32_LL(d0, d1); /* l2, l3 */
+				AE_MULAAFD32X16_H1_L0(a0, data2, coef4);
+				data2 = AE_SEL32_HH(d0, d1); /* r2, r3 */
+				AE_MULAAFD32X16_H1_L0(a1, data2, coef4);
+			}
+
+			/* Scale FIR output with right shifts, round/saturate
+			 * to Q1.31, and store 32 bit output.
 			 */
-			data2 = AE_SEL32_LL(d0, d1); /* l2, l3 */
-			AE_MULAAFD32X16_H1_L0(a0, data2, coef4);
-			data2 = AE_SEL32_HH(d0, d1); /* r2, r3 */
-			AE_MULAAFD32X16_H1_L0(a1, data2, coef4);
+			AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a0, shift)),
+				    wp, sizeof(int32_t));
+			AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a1, shift)),
+				    wp, sizeof(int32_t));
 		}
 
-		/* Scale FIR output with right shifts, round/saturate
-		 * to Q1.31, and store 32 bit output.
-		 */
-		AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a0, shift)), wp,
-			    sizeof(int32_t));
-		AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a1, shift)), wp,
-			    sizeof(int32_t));
-
 		return;
 	}
 
@@ -186,64 +196,74 @@ static inline void fir_filter(ae_f32 *rp, const void *cp, ae_f32 *wp0,
 	ae_f32 *wp = wp0;
 	const int inc = nch * sizeof(int32_t);
 
-	if (nch == 2) {
-		/* Move data pointer back by one sample to start from right
-		 * channel sample. Discard read value p0.
-		 */
-		dp = (ae_f24x2 *)rp;
-		AE_L32F24_XC(d0, (ae_f24 *)dp, -sizeof(ae_f24));
-
-		/* Reset coefficient pointer and clear accumulator */
-		coefp = (ae_f24x2 *)cp;
-		a0 = AE_ZERO64();
-		a1 = AE_ZERO64();
-
-		/* Compute FIR filter for current channel with four
-		 * taps per every loop iteration.  Two coefficients
-		 * are loaded simultaneously. Data is read
-		 * from interleaved buffer with stride of channels
-		 * count.
+	if (!(nch & 1)) {
+		/* Even channels count, compute the channels in pairs with
+		 * two accumulators. The delay line is written backwards so
+		 * a pair is loaded from one sample below its first channel,
+		 * that is 64 bit aligned when channels count is even.
 		 */
-		for (i = 0; i < taps_div_4; i++) {
-			/* Load two coefficients. Coef2_h contains tap *coefp
-			 * and coef2_l contains the next tap.
+		dp1 = (ae_f24 *)rp;
+		for (j = 0; j < nch; j += 2) {
+			/* Move data pointer back by one sample to start
+			 * from right channel sample of the pair, and the
+			 * pair pointer to the next pair. Discard read values.
 			 */
-			/* TODO: Ensure coefficients are 64 bits aligned */
-			AE_L32X2F24_IP(coef2, coefp, sizeof(ae_f24x2));
-
-			/* Load two data samples from two channels */
-			AE_L32X2F24_XC(d0, dp, inc); /* r0, l0 */
-			AE_L32X2F24_XC(d1, dp, inc); /* r1, l1 */
-
-			/* Select to d0 successive left channel samples, to d1
-			 * successive right channel samples. Then Accumulate
-			 * to a0 and a1
-			 * data2_h * coef2_h + data2_l * coef2_l. The Q1.31
-			 * data and Q1.15 coefficients are used as 24 bits as
-			 * Q1.23 values.
+			dp = (ae_f24x2 *)dp1;
+			AE_L32F24_XC(d0, (ae_f24 *)dp, -sizeof(ae_f24));
+			AE_L32F24_XC(d0, dp1, -2 * sizeof(ae_f24));
+
+			/* Reset coefficient pointer and clear accumulator */
+			coefp = (ae_f24x2 *)cp;
+			a0 = AE_ZERO64();
+			a1 = AE_ZERO64();
+
+			/* Compute FIR filter for current channel pair with
+			 * four taps per every loop iteration. Two
+			 * coefficients are loaded simultaneously. Data is
+			 * read from interleaved buffer with stride of
+			 * channels count.
 			 */
-			data2 = AE_SELP24_LL(d0, d1);
-			AE_MULAAFP24S_HH_LL(a0, data2, coef2);
-			data2 = AE_SELP24_HH(d0, d1);
-			AE_MULAAFP24S_HH_LL(a1, data2, coef2);
-
-			/* Repeat for next two taps */
-			AE_L32X2F24_IP(coef2, coefp, sizeof(ae_f24x2));
-			AE_L32X2F24_XC(d0, dp, inc); /* r2, l2 */
-			AE_L32X2F24_XC(d1, dp, inc); /* r3, l3 */
-			data2 = AE_SELP24_LL(d0, d1);
-			AE_MULAAFP24S_HH_LL(a0, data2, coef2);
-			data2 = AE_SELP24_HH(d0, d1);
-			AE_MULAAFP24S_HH_LL(a1, data2, coef2);
-		}
+			for (i = 0; i < taps_div_4; i++) {
+				/* Load two coefficients. Coef2_h contains tap
+				 * *coefp and coef2_l contains the next tap.
+				 */
+				/* TODO: Ensure 64 bits aligned coefficients */
+				AE_L32X2F24_IP(coef2, coefp, sizeof(ae_f24x2));
+
+				/* Load two data samples from two channels */
+				AE_L32X2F24_XC(d0, dp, inc); /* r0, l0 */
+				AE_L32X2F24_XC(d1, dp, inc); /* r1, l1 */
+
+				/* Select to d0 successive left channel
+				 * samples, to d1 successive right channel
+				 * samples. Then Accumulate to a0 and a1
+				 * data2_h * coef2_h + data2_l * coef2_l. The
+				 * Q1.31 data and Q1.15 coefficients are used as
+				 * 24 bits as Q1.23 values.
+				 */
+				data2 = AE_SELP24_LL(d0, d1);
+				AE_MULAAFP24S_HH_LL(a0, data2, coef2);
+				data2 = AE_SELP24_HH(d0, d1);
+				AE_MULAAFP24S_HH_LL(a1, data2, coef2);
+
+				/* Repeat for next two taps */
+				AE_L32X2F24_IP(coef2, coefp, sizeof(ae_f24x2));
+				AE_L32X2F24_XC(d0, dp, inc); /* r2, l2 */
+				AE_L32X2F24_XC(d1, dp, inc); /* r3, l3 */
+				data2 = AE_SELP24_LL(d0, d1);
+				AE_MULAAFP24S_HH_LL(a0, data2, coef2);
+				data2 = AE_SELP24_HH(d0, d1);
+				AE_MULAAFP24S_HH_LL(a1, data2, coef2);
+			}
 
-		/* Scale FIR output with right shifts, round/saturate
-		 * to Q1.31, and store 32 bit output.
-		 */
-		AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a0, shift)), wp,
-			    sizeof(int32_t));
-		AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a1, shift)), wp,
-			    sizeof(int32_t));
+			/* Scale FIR output with right shifts, round/saturate
+			 * to Q1.31, and store 32 bit output.
+			 */
+			AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a0, shift)),
+				    wp, sizeof(int32_t));
+			AE_S32_L_XP(AE_ROUND32F48SSYM(AE_SRAA64(a1, shift)),
+				    wp, sizeof(int32_t));
+		}
 
 		return;
 	}
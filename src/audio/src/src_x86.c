@@ -0,0 +1,549 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* SSE4.2 and AVX2 optimized code parts for SRC in host builds. The 32x32
+ * bit products are calculated with 64 bit lanes and summed exactly as in
+ * the generic version, so the output is bit exact with it.
+ */
+
+#include <sof/audio/src/src_config.h>
+
+#if SRC_X86
+
+#include <sof/audio/format.h>
+#include <sof/audio/src/src.h>
+#include <sof/compiler_attributes.h>
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+
+/* Number of 64 bit accumulators in a vector */
+#define SRC_LANES 4
+
+#define src_vec __m256i
+
+/* Loads SRC_LANES words sign extended to 64 bit lanes */
+static inline src_vec src_load_s32(const int32_t *ptr)
+{
+	return _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)ptr));
+}
+
+/* Loads 2 * SRC_LANES words, odd ones are multiplied after src_odd() */
+static inline src_vec src_load_pairs(const int32_t *ptr)
+{
+	return _mm256_loadu_si256((const __m256i *)ptr);
+}
+
+#if SRC_SHORT
+static inline src_vec src_load_coef(const int16_t *ptr)
+{
+	return _mm256_cvtepi16_epi64(_mm_loadl_epi64((const __m128i *)ptr));
+}
+#else
+static inline src_vec src_load_coef(const int32_t *ptr)
+{
+	__m128i c = _mm_loadu_si128((const __m128i *)ptr);
+
+	return _mm256_cvtepi32_epi64(_mm_srai_epi32(c, 8));
+}
+#endif
+
+static inline void src_store_s64(int64_t *ptr, src_vec x)
+{
+	_mm256_storeu_si256((__m256i *)ptr, x);
+}
+
+#define src_setzero		_mm256_setzero_si256
+#define src_set1_epi64		_mm256_set1_epi64x
+#define src_add_epi64		_mm256_add_epi64
+#define src_mul_epi32		_mm256_mul_epi32
+#define src_odd(x)		_mm256_srli_epi64(x, 32)
+
+#else
+
+/* Number of 64 bit accumulators in a vector */
+#define SRC_LANES 2
+
+#define src_vec __m128i
+
+/* Loads SRC_LANES words sign extended to 64 bit lanes */
+static inline src_vec src_load_s32(const int32_t *ptr)
+{
+	return _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i *)ptr));
+}
+
+/* Loads 2 * SRC_LANES words, odd ones are multiplied after src_odd() */
+static inline src_vec src_load_pairs(const int32_t *ptr)
+{
+	return _mm_loadu_si128((const __m128i *)ptr);
+}
+
+#if SRC_SHORT
+static inline src_vec src_load_coef(const int16_t *ptr)
+{
+	return _mm_cvtepi16_epi64(_mm_loadu_si32(ptr));
+}
+#else
+static inline src_vec src_load_coef(const int32_t *ptr)
+{
+	__m128i c = _mm_loadl_epi64((const __m128i *)ptr);
+
+	return _mm_cvtepi32_epi64(_mm_srai_epi32(c, 8));
+}
+#endif
+
+static inline void src_store_s64(int64_t *ptr, src_vec x)
+{
+	_mm_storeu_si128((__m128i *)ptr, x);
+}
+
+#define src_setzero		_mm_setzero_si128
+#define src_set1_epi64		_mm_set1_epi64x
+#define src_add_epi64		_mm_add_epi64
+#define src_mul_epi32		_mm_mul_epi32
+#define src_odd(x)		_mm_srli_epi64(x, 32)
+
+#endif
+
+#if SRC_SHORT /* 16 bit coefficients version */
+
+/* The FIR is calculated as Q1.15 x Q1.31 -> Q2.46. The output shift
+ * includes the shift by 15 for Qx.46 to Qx.31.
+ */
+#define SRC_COEF_SHIFT	15
+#define src_coef(c)	(c)
+
+typedef int16_t src_coef_t;
+
+#else /* 32bit coefficients version */
+
+/* The FIR is calculated as Q1.23 x Q1.31 -> Q2.54. The output shift
+ * includes the shift by 23 for Qx.54 to Qx.31.
+ */
+#define SRC_COEF_SHIFT	23
+#define src_coef(c)	((c) >> 8)
+
+typedef int32_t src_coef_t;
+
+#endif
+
+static inline int64_t src_sum_s64(src_vec x)
+{
+	int64_t y[SRC_LANES];
+	int64_t sum = 0;
+	int i;
+
+	src_store_s64(y, x);
+	for (i = 0; i < SRC_LANES; i++)
+		sum += y[i];
+
+	return sum;
+}
+
+/* Interleaved 2ch FIR core for taps without circular wrap, even words are
+ * summed to y0 and odd words to y1.
+ */
+static inline void src_fir_2ch(int32_t **data, const src_coef_t **coef,
+			       int taps, int64_t *y0, int64_t *y1)
+{
+	src_vec acc0 = src_setzero();
+	src_vec acc1 = src_setzero();
+	src_vec c;
+	src_vec d;
+	int32_t *dp = *data;
+	const src_coef_t *cp = *coef;
+	int i;
+
+	for (i = 0; i + SRC_LANES <= taps; i += SRC_LANES) {
+		d = src_load_pairs(dp);
+		c = src_load_coef(cp);
+		acc0 = src_add_epi64(acc0, src_mul_epi32(d, c));
+		acc1 = src_add_epi64(acc1, src_mul_epi32(src_odd(d), c));
+		dp += 2 * SRC_LANES;
+		cp += SRC_LANES;
+	}
+
+	for (; i < taps; i++) {
+		*y0 += (int64_t)src_coef(*cp) * dp[0];
+		*y1 += (int64_t)src_coef(*cp) * dp[1];
+		dp += 2;
+		cp++;
+	}
+
+	*y0 += src_sum_s64(acc0);
+	*y1 += src_sum_s64(acc1);
+	*data = dp;
+	*coef = cp;
+}
+
+/* Mono FIR core for taps without circular wrap */
+static inline int64_t src_fir_1ch(int32_t **data, const src_coef_t **coef,
+				  int taps)
+{
+	src_vec acc = src_setzero();
+	int32_t *dp = *data;
+	const src_coef_t *cp = *coef;
+	int64_t y = 0;
+	int i;
+
+	for (i = 0; i + SRC_LANES <= taps; i += SRC_LANES) {
+		acc = src_add_epi64(acc, src_mul_epi32(src_load_s32(dp),
+						       src_load_coef(cp)));
+		dp += SRC_LANES;
+		cp += SRC_LANES;
+	}
+
+	for (; i < taps; i++) {
+		y += (int64_t)src_coef(*cp) * (*dp);
+		dp++;
+		cp++;
+	}
+
+	*data = dp;
+	*coef = cp;
+	return y + src_sum_s64(acc);
+}
+
+/* FIR core for SRC_LANES adjacent channels of a frame. The lowest lane
+ * holds the channel at the lowest address, i.e. the last of the channels.
+ */
+static inline src_vec src_fir_nch(src_vec acc, int32_t **data,
+				  const src_coef_t **coef, int taps,
+				  const int nch)
+{
+	int32_t *dp = *data;
+	const src_coef_t *cp = *coef;
+	src_vec c;
+	int i;
+
+	for (i = 0; i < taps; i++) {
+		c = src_set1_epi64(src_coef(*cp));
+		acc = src_add_epi64(acc, src_mul_epi32(src_load_s32(dp), c));
+		dp += nch;
+		cp++;
+	}
+
+	*data = dp;
+	*coef = cp;
+	return acc;
+}
+
+static inline void fir_filter_x86(int32_t *rp, const void *cp, int32_t *wp0,
+				  int32_t *fir_start, int32_t *fir_end,
+				  const int fir_delay_length,
+				  const int taps_x_nch, const int shift,
+				  const int nch)
+{
+	int64_t y[SRC_LANES];
+	int64_t y0;
+	int64_t y1;
+	src_vec acc;
+	int32_t *data;
+	const src_coef_t *coef;
+	int i;
+	int j;
+	int n1;
+	int n2;
+	int frames;
+	const int qshift = SRC_COEF_SHIFT + shift;
+	const int32_t rnd = 1 << (qshift - 1); /* Half LSB */
+	int32_t *d = rp;
+	int32_t *wp = wp0;
+
+	/* Check for 2ch FIR case */
+	if (nch == 2) {
+		/* Decrement data pointer to next channel start. Note that
+		 * initialization code ensures that circular wrap does not
+		 * happen mid-frame.
+		 */
+		data = d - 1;
+
+		/* Initialize to half LSB for rounding, prepare for FIR core */
+		y0 = rnd;
+		y1 = rnd;
+		coef = (const src_coef_t *)cp;
+		frames = fir_end - data; /* Frames until wrap */
+		n1 = ((taps_x_nch < frames) ? taps_x_nch : frames) >> 1;
+		n2 = (taps_x_nch >> 1) - n1;
+
+		src_fir_2ch(&data, &coef, n1, &y0, &y1);
+		if (data == fir_end)
+			data = fir_start;
+
+		src_fir_2ch(&data, &coef, n2, &y0, &y1);
+
+		*wp = sat_int32(y1 >> qshift);
+		*(wp + 1) = sat_int32(y0 >> qshift);
+		return;
+	}
+
+	if (nch == 1) {
+		y0 = rnd;
+		data = d;
+		coef = (const src_coef_t *)cp;
+		frames = fir_end - data; /* Frames until wrap */
+		n1 = (taps_x_nch < frames) ? taps_x_nch : frames;
+		n2 = taps_x_nch - n1;
+
+		y0 += src_fir_1ch(&data, &coef, n1);
+		if (data >= fir_end)
+			data -= fir_delay_length;
+
+		y0 += src_fir_1ch(&data, &coef, n2);
+
+		*wp = sat_int32(y0 >> qshift);
+		return;
+	}
+
+	/* The circular wrap happens at the same tap for all channels of
+	 * a frame, so SRC_LANES channels are filtered at once.
+	 */
+	for (j = 0; j + SRC_LANES <= nch; j += SRC_LANES) {
+		data = d - j - (SRC_LANES - 1);
+		coef = (const src_coef_t *)cp;
+		/* Frames until wrap */
+		frames = fir_end - (d - j) + nch - j - 1;
+		n1 = (taps_x_nch < frames) ? taps_x_nch : frames;
+		n2 = taps_x_nch - n1;
+
+		acc = src_fir_nch(src_setzero(), &data, &coef,
+				  (n1 + nch - 1) / nch, nch);
+		if (data + SRC_LANES - 1 >= fir_end)
+			data -= fir_delay_length;
+
+		acc = src_fir_nch(acc, &data, &coef, (n2 + nch - 1) / nch, nch);
+
+		src_store_s64(y, acc);
+		for (i = 0; i < SRC_LANES; i++) {
+			y0 = y[SRC_LANES - 1 - i] + rnd;
+			wp[i] = sat_int32(y0 >> qshift);
+		}
+
+		wp += SRC_LANES;
+	}
+
+	for (; j < nch; j++) {
+		data = d - j;
+		y0 = rnd;
+		coef = (const src_coef_t *)cp;
+		frames = fir_end - data + nch - j - 1; /* Frames until wrap */
+		n1 = (taps_x_nch < frames) ? taps_x_nch : frames;
+		n2 = taps_x_nch - n1;
+
+		for (i = 0; i < n1; i += nch) {
+			y0 += (int64_t)src_coef(*coef) * (*data);
+			coef++;
+			data += nch;
+		}
+		if (data >= fir_end)
+			data -= fir_delay_length;
+
+		for (i = 0; i < n2; i += nch) {
+			y0 += (int64_t)src_coef(*coef) * (*data);
+			coef++;
+			data += nch;
+		}
+
+		*wp = sat_int32(y0 >> qshift);
+		wp++;
+	}
+}
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+void __hot_text src_polyphase_stage_cir(struct src_stage_prm *s)
+{
+	int i;
+	int n;
+	int m;
+	int n_wrap_buf;
+	int n_wrap_fir;
+	int n_min;
+	int32_t *rp;
+	int32_t *wp;
+
+	struct src_state *fir = s->state;
+	struct src_stage *cfg = s->stage;
+	int32_t *fir_delay = fir->fir_delay;
+	int32_t *fir_end = &fir->fir_delay[fir->fir_delay_size];
+	int32_t *out_delay_end = &fir->out_delay[fir->out_delay_size];
+	const void *cp; /* Can be int32_t or int16_t */
+	const size_t out_size = fir->out_delay_size * sizeof(int32_t);
+	const int nch = s->nch;
+	const int nch_x_odm = cfg->odm * nch;
+	const int blk_in_words = nch * cfg->blk_in;
+	const int blk_out_words = nch * cfg->num_of_subfilters;
+	const int fir_length = fir->fir_delay_size;
+	const int rewind = nch * (cfg->blk_in
+		+ (cfg->num_of_subfilters - 1) * cfg->idm) - nch;
+	const int nch_x_idm = nch * cfg->idm;
+	const size_t fir_size = fir->fir_delay_size * sizeof(int32_t);
+	const int taps_x_nch = cfg->subfilter_length * nch;
+	const size_t subfilter_size = cfg->subfilter_length *
+		sizeof(src_coef_t);
+	int32_t *x_rptr = (int32_t *)s->x_rptr;
+	int32_t *y_wptr = (int32_t *)s->y_wptr;
+	int32_t *x_end_addr = (int32_t *)s->x_end_addr;
+	int32_t *y_end_addr = (int32_t *)s->y_end_addr;
+
+	for (n = 0; n < s->times; n++) {
+		/* Input data, for s24 format s->shift is 8 */
+		m = blk_in_words;
+		while (m > 0) {
+			/* Number of words without circular wrap */
+			n_wrap_buf = x_end_addr - x_rptr;
+			n_wrap_fir = fir->fir_wp - fir->fir_delay + 1;
+			n_min = (n_wrap_fir < n_wrap_buf)
+				? n_wrap_fir : n_wrap_buf;
+			n_min = (m < n_min) ? m : n_min;
+			m -= n_min;
+			for (i = 0; i < n_min; i++) {
+				*fir->fir_wp = *x_rptr << s->shift;
+				fir->fir_wp--;
+				x_rptr++;
+			}
+			/* Check for wrap */
+			src_dec_wrap(&fir->fir_wp, fir_delay, fir_size);
+			src_inc_wrap(&x_rptr, x_end_addr, s->x_size);
+		}
+
+		/* Filter */
+		cp = cfg->coefs; /* Reset to 1st coefficient */
+		rp = fir->fir_wp + rewind;
+		src_inc_wrap(&rp, fir_end, fir_size);
+		wp = fir->out_rp;
+		for (i = 0; i < cfg->num_of_subfilters; i++) {
+			fir_filter_x86(rp, cp, wp,
+				       fir_delay, fir_end, fir_length,
+				       taps_x_nch, cfg->shift, nch);
+			wp += nch_x_odm;
+			cp = (char *)cp + subfilter_size;
+			src_inc_wrap(&wp, out_delay_end, out_size);
+			rp -= nch_x_idm; /* Next sub-filter start */
+			src_dec_wrap(&rp, fir_delay, fir_size);
+		}
+
+		/* Output, for s24 format s->shift is 8 */
+		m = blk_out_words;
+		while (m > 0) {
+			n_wrap_fir = out_delay_end - fir->out_rp;
+			n_wrap_buf = y_end_addr - y_wptr;
+			n_min = (n_wrap_fir < n_wrap_buf)
+				? n_wrap_fir : n_wrap_buf;
+			n_min = (m < n_min) ? m : n_min;
+			m -= n_min;
+			for (i = 0; i < n_min; i++) {
+				*y_wptr = *fir->out_rp >> s->shift;
+				y_wptr++;
+				fir->out_rp++;
+			}
+			/* Check wrap */
+			src_inc_wrap(&y_wptr, y_end_addr, s->y_size);
+			src_inc_wrap(&fir->out_rp, out_delay_end, out_size);
+		}
+	}
+	s->x_rptr = x_rptr;
+	s->y_wptr = y_wptr;
+}
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+
+#if CONFIG_FORMAT_S16LE
+void __hot_text src_polyphase_stage_cir_s16(struct src_stage_prm *s)
+{
+	int i;
+	int n;
+	int m;
+	int n_wrap_buf;
+	int n_wrap_fir;
+	int n_min;
+	int32_t *rp;
+	int32_t *wp;
+
+	struct src_state *fir = s->state;
+	struct src_stage *cfg = s->stage;
+	int32_t *fir_delay = fir->fir_delay;
+	int32_t *fir_end = &fir->fir_delay[fir->fir_delay_size];
+	int32_t *out_delay_end = &fir->out_delay[fir->out_delay_size];
+	const void *cp; /* Can be int32_t or int16_t */
+	const size_t out_size = fir->out_delay_size * sizeof(int32_t);
+	const int nch = s->nch;
+	const int nch_x_odm = cfg->odm * nch;
+	const int blk_in_words = nch * cfg->blk_in;
+	const int blk_out_words = nch * cfg->num_of_subfilters;
+	const int fir_length = fir->fir_delay_size;
+	const int rewind = nch * (cfg->blk_in
+		+ (cfg->num_of_subfilters - 1) * cfg->idm) - nch;
+	const int nch_x_idm = nch * cfg->idm;
+	const size_t fir_size = fir->fir_delay_size * sizeof(int32_t);
+	const int taps_x_nch = cfg->subfilter_length * nch;
+	const size_t subfilter_size = cfg->subfilter_length *
+		sizeof(src_coef_t);
+	int16_t *x_rptr = (int16_t *)s->x_rptr;
+	int16_t *y_wptr = (int16_t *)s->y_wptr;
+	int16_t *x_end_addr = (int16_t *)s->x_end_addr;
+	int16_t *y_end_addr = (int16_t *)s->y_end_addr;
+
+	for (n = 0; n < s->times; n++) {
+		/* Input data, used fixed shift by 16 */
+		m = blk_in_words;
+		while (m > 0) {
+			/* Number of words without circular wrap */
+			n_wrap_buf = x_end_addr - x_rptr;
+			n_wrap_fir = fir->fir_wp - fir->fir_delay + 1;
+			n_min = (n_wrap_fir < n_wrap_buf)
+				? n_wrap_fir : n_wrap_buf;
+			n_min = (m < n_min) ? m : n_min;
+			m -= n_min;
+			for (i = 0; i < n_min; i++) {
+				*fir->fir_wp = Q_SHIFT_LEFT(*x_rptr, 15, 31);
+				fir->fir_wp--;
+				x_rptr++;
+			}
+			/* Check for wrap */
+			src_dec_wrap(&fir->fir_wp, fir_delay, fir_size);
+			src_inc_wrap_s16(&x_rptr, x_end_addr, s->x_size);
+		}
+
+		/* Filter */
+		cp = cfg->coefs; /* Reset to 1st coefficient */
+		rp = fir->fir_wp + rewind;
+		src_inc_wrap(&rp, fir_end, fir_size);
+		wp = fir->out_rp;
+		for (i = 0; i < cfg->num_of_subfilters; i++) {
+			fir_filter_x86(rp, cp, wp,
+				       fir_delay, fir_end, fir_length,
+				       taps_x_nch, cfg->shift, nch);
+			wp += nch_x_odm;
+			cp = (char *)cp + subfilter_size;
+			src_inc_wrap(&wp, out_delay_end, out_size);
+			rp -= nch_x_idm; /* Next sub-filter start */
+			src_dec_wrap(&rp, fir_delay, fir_size);
+		}
+
+		/* Output, use fixed shift by 16 */
+		m = blk_out_words;
+		while (m > 0) {
+			n_wrap_fir = out_delay_end - fir->out_rp;
+			n_wrap_buf = y_end_addr - y_wptr;
+			n_min = (n_wrap_fir < n_wrap_buf)
+				? n_wrap_fir : n_wrap_buf;
+			n_min = (m < n_min) ? m : n_min;
+			m -= n_min;
+			for (i = 0; i < n_min; i++) {
+				*y_wptr = Q_SHIFT_RND(*fir->out_rp, 31, 15);
+				y_wptr++;
+				fir->out_rp++;
+			}
+			/* Check wrap */
+			src_inc_wrap_s16(&y_wptr, y_end_addr, s->y_size);
+			src_inc_wrap(&fir->out_rp, out_delay_end, out_size);
+		}
+	}
+	s->x_rptr = x_rptr;
+	s->y_wptr = y_wptr;
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#endif
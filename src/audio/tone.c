@@ -15,6 +15,7 @@
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/memory.h>
+#include <sof/lib/overlay.h>
 #include <sof/lib/uuid.h>
 #include <sof/list.h>
 #include <sof/math/trig.h>
@@ -41,6 +42,7 @@
 #define TONE_AMPLITUDE_DEFAULT TONE_GAIN(0.1)      /*  -20 dB  */
 #define TONE_FREQUENCY_DEFAULT TONE_FREQ(997.0)
 #define TONE_NUM_FS            13       /* Table size for 8-192 kHz range */
+#define TONE_MAX_TONES         4        /* Simultaneous tones per channel */
 
 static const struct comp_driver comp_tone;
 
@@ -71,8 +73,10 @@ struct tone_state {
 	int32_t freq_coef; /* Frequency multiplier Q2.30 */
 	int32_t fs; /* Sample rate in Hertz Q32.0 */
 	int32_t ramp_step; /* Amplitude ramp step Q1.31 */
-	int32_t w; /* Angle radians Q4.28 */
-	int32_t w_step; /* Angle step Q4.28 */
+	int32_t w[TONE_MAX_TONES]; /* Angle radians Q4.28 */
+	int32_t w_step[TONE_MAX_TONES]; /* Angle step Q4.28 */
+	struct sin_osc osc[TONE_MAX_TONES]; /* Oscillators set from w */
+	uint32_t tones; /* Tones at f * freq_coef^n, n = 0 .. tones - 1 */
 	uint32_t block_count;
 	uint32_t repeat_count;
 	uint32_t repeats; /* Number of repeats for tone (sweep steps) */
@@ -92,7 +96,6 @@ struct comp_data {
 			  uint32_t frames);
 };
 
-static int32_t tonegen(struct tone_state *sg);
 static void tonegen_control(struct tone_state *sg);
 static void tonegen_update_f(struct tone_state *sg, int32_t f);
 
@@ -100,72 +103,85 @@ static void tonegen_update_f(struct tone_state *sg, int32_t f);
  * Tone generator algorithm code
  */
 
-static inline void tone_circ_inc_wrap(int32_t **ptr, int32_t *end, size_t size)
+/* Set oscillators from the tone phases */
+static void __overlay_text(tone) tonegen_osc_init(struct tone_state *sg)
 {
-	if (*ptr >= end)
-		*ptr = (int32_t *)((size_t)*ptr - size);
+	int i;
+
+	for (i = 0; i < sg->tones; i++)
+		sin_osc_init(&sg->osc[i], sg->w[i], sg->w_step[i]);
+}
+
+/* Generate n samples of all tones into every nch:th sample of dest */
+static void __overlay_text(tone) tonegen_block(struct tone_state *sg,
+					       int32_t *dest, int nch,
+					       uint32_t n)
+{
+	/* Tones share the amplitude so their sum doesn't clip */
+	int32_t a = sg->mute ? 0 : sg->a / (int32_t)sg->tones;
+	int i;
+
+	for (i = 0; i < sg->tones; i++) {
+		sin_osc_block(&sg->osc[i], a, dest, nch, n, i > 0);
+
+		/* Keep phase for setting the oscillator again */
+		sg->w[i] = ((int64_t)sg->w[i] + (int64_t)n * sg->w_step[i]) %
+			PI_MUL2_Q4_28;
+	}
 }
 
-static void tone_s32_default(struct comp_dev *dev, struct audio_stream *sink,
-			     uint32_t frames)
+static void __overlay_text(tone) tone_s32_default(struct comp_dev *dev,
+						  struct audio_stream *sink,
+						  uint32_t frames)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *dest = (int32_t *)sink->w_ptr;
+	struct tone_state *sg;
+	int32_t *dest;
+	uint32_t n;
+	uint32_t m;
 	int i;
-	int n;
-	int n_wrap_dest;
-	int n_min;
-	int nch = cd->channels;
-
-	n = frames * nch;
-	while (n > 0) {
-		n_wrap_dest = (int32_t *)sink->end_addr - dest;
-		n_min = (n < n_wrap_dest) ? n : n_wrap_dest;
-		/* Process until wrap or completed n */
-		while (n_min > 0) {
-			n -= nch;
-			n_min -= nch;
-			for (i = 0; i < nch; i++) {
-				tonegen_control(&cd->sg[i]);
-				*dest = tonegen(&cd->sg[i]);
-				dest++;
-			}
+
+	for (i = 0; i < cd->channels; i++) {
+		sg = &cd->sg[i];
+		dest = (int32_t *)sink->w_ptr + i;
+
+		/* Renormalize, recursive oscillators drift with rounding */
+		tonegen_osc_init(sg);
+
+		/* Linear spans of sink up to next 125 us control block */
+		for (n = frames; n; n -= m) {
+			m = audio_stream_frames_without_wrap(sink, dest);
+			m = MIN(m, sg->samples_in_block - sg->sample_count);
+			m = MIN(m, n);
+
+			tonegen_block(sg, dest, cd->channels, m);
+
+			sg->sample_count += m;
+			if (sg->sample_count >= sg->samples_in_block)
+				tonegen_control(sg);
+
+			dest = audio_stream_wrap(sink, dest + m * cd->channels);
 		}
-		tone_circ_inc_wrap(&dest, sink->end_addr, sink->size);
 	}
 }
 
-static int32_t tonegen(struct tone_state *sg)
+/* Reset phase of all tones */
+static void __overlay_text(tone) tonegen_reset_phase(struct tone_state *sg)
 {
-	int64_t sine;
-	int64_t w;
-
-	/* sg->w is angle in Q4.28 radians format, sin() returns Q1.31 */
-	/* sg->a is amplitude as Q1.31 */
-	sine =
-		q_mults_32x32(sin_fixed(sg->w), sg->a,
-			      Q_SHIFT_BITS_64(31, 31, 31));
+	int i;
 
-	/* Next point */
-	w = (int64_t)sg->w + sg->w_step;
-	sg->w = (w > PI_MUL2_Q4_28)
-		? (int32_t)(w - PI_MUL2_Q4_28) : (int32_t)w;
+	for (i = 0; i < TONE_MAX_TONES; i++)
+		sg->w[i] = 0;
 
-	if (sg->mute)
-		return 0;
-	else
-		return (int32_t)sine; /* Q1.31 no saturation need */
+	tonegen_osc_init(sg);
 }
 
-static void tonegen_control(struct tone_state *sg)
+/* Called after every 125 us block of samples */
+static void __overlay_text(tone) tonegen_control(struct tone_state *sg)
 {
 	int64_t a;
 	int64_t p;
-
-	/* Count samples, 125 us blocks */
-	sg->sample_count++;
-	if (sg->sample_count < sg->samples_in_block)
-		return;
+	int i;
 
 	sg->sample_count = 0;
 	if (sg->block_count < INT32_MAX)
@@ -174,7 +190,7 @@ static void tonegen_control(struct tone_state *sg)
 	/* Fade-in ramp during tone */
 	if (sg->block_count < sg->tone_length) {
 		if (sg->a == 0)
-			sg->w = 0; /* Reset phase to have less clicky ramp */
+			tonegen_reset_phase(sg); /* Less clicky ramp */
 
 		if (sg->a > sg->a_target) {
 			a = (int64_t)sg->a - sg->ramp_step;
@@ -210,10 +226,15 @@ static void tonegen_control(struct tone_state *sg)
 				? sg->a_target : sg->ramp_step;
 		}
 		if (sg->freq_coef > 0) {
-			/* f is Q16.16, freq_coef is Q2.30 */
-			p = q_multsr_32x32(sg->f, sg->freq_coef,
-				Q_SHIFT_BITS_64(16, 30, 16));
+			/* f is Q16.16, freq_coef is Q2.30, step over all
+			 * the tones played at once
+			 */
+			p = sg->f;
+			for (i = 0; i < sg->tones; i++)
+				p = q_multsr_32x32(p, sg->freq_coef,
+					Q_SHIFT_BITS_64(16, 30, 16));
 			tonegen_update_f(sg, (int32_t)p); /* No saturation */
+			tonegen_osc_init(sg);
 		}
 		sg->repeat_count++;
 	}
@@ -240,6 +261,16 @@ static void tonegen_set_repeats(struct tone_state *sg, uint32_t r)
 static void tonegen_set_freq_mult(struct tone_state *sg, int32_t fm)
 {
 	sg->freq_coef = (fm > 0) ? fm : ONE_Q2_30; /* Set freq mult to 1.0 */
+	tonegen_update_f(sg, sg->f); /* Frequencies of the other tones */
+}
+
+/* Number of simultaneous tones, each next one is at freq_coef times the
+ * frequency of previous one. A sweep steps over all of them at once.
+ */
+static void tonegen_set_tones(struct tone_state *sg, uint32_t tones)
+{
+	sg->tones = (tones > 0 && tones <= TONE_MAX_TONES) ? tones : 1;
+	tonegen_update_f(sg, sg->f);
 }
 
 /* Multiplication factor for amplitude as Q2.30 for logarithmic change */
@@ -295,26 +326,44 @@ static void tonegen_update_f(struct tone_state *sg, int32_t f)
 {
 	int64_t w_tmp;
 	int64_t f_max;
+	int64_t f_tone;
+	int i;
 
 	/* Calculate Fs/2, fs is Q32.0, f is Q16.16 */
 	f_max = Q_SHIFT_LEFT((int64_t)sg->fs, 0, 16 - 1);
 	f_max = (f_max > INT32_MAX) ? INT32_MAX : f_max;
 	sg->f = (f > f_max) ? f_max : f;
-	/* Q16 x Q31 -> Q28 */
-	w_tmp = q_multsr_32x32(sg->f, sg->c, Q_SHIFT_BITS_64(16, 31, 28));
-	w_tmp = (w_tmp > PI_Q4_28) ? PI_Q4_28 : w_tmp; /* Limit to pi Q4.28 */
-	sg->w_step = (int32_t)w_tmp;
+
+	f_tone = sg->f;
+	for (i = 0; i < sg->tones; i++) {
+		/* Q16 x Q31 -> Q28 */
+		w_tmp = q_multsr_32x32(f_tone, sg->c,
+				       Q_SHIFT_BITS_64(16, 31, 28));
+		/* Limit to pi Q4.28 */
+		w_tmp = (w_tmp > PI_Q4_28) ? PI_Q4_28 : w_tmp;
+		sg->w_step[i] = (int32_t)w_tmp;
+
+		/* Next tone, f is Q16.16, freq_coef is Q2.30 */
+		f_tone = q_multsr_32x32(f_tone, sg->freq_coef,
+					Q_SHIFT_BITS_64(16, 30, 16));
+		f_tone = (f_tone > f_max) ? f_max : f_tone;
+	}
 }
 
 static void tonegen_reset(struct tone_state *sg)
 {
+	int i;
+
 	sg->mute = 1;
 	sg->a = 0;
 	sg->a_target = TONE_AMPLITUDE_DEFAULT;
 	sg->c = 0;
 	sg->f = TONE_FREQUENCY_DEFAULT;
-	sg->w = 0;
-	sg->w_step = 0;
+	sg->tones = 1;
+	for (i = 0; i < TONE_MAX_TONES; i++) {
+		sg->w[i] = 0;
+		sg->w_step[i] = 0;
+	}
 
 	sg->block_count = 0;
 	sg->repeat_count = 0;
@@ -351,7 +400,8 @@ static int tonegen_init(struct tone_state *sg, int32_t fs, int32_t f, int32_t a)
 	}
 
 	if (idx < 0) {
-		sg->w_step = 0;
+		for (i = 0; i < TONE_MAX_TONES; i++)
+			sg->w_step[i] = 0;
 		return -EINVAL;
 	}
 
@@ -571,6 +621,10 @@ static int tone_cmd_set_data(struct comp_dev *dev,
 				comp_info(dev, "tone_cmd_set_data(), SOF_TONE_IDX_LIN_RAMP_STEP");
 				tonegen_set_linramp(&cd->sg[ch], val);
 				break;
+			case SOF_TONE_IDX_TONES:
+				comp_info(dev, "tone_cmd_set_data(), SOF_TONE_IDX_TONES");
+				tonegen_set_tones(&cd->sg[ch], val);
+				break;
 			default:
 				comp_err(dev, "tone_cmd_set_data(): invalid cdata->index");
 				return -EINVAL;
@@ -617,7 +671,7 @@ static int tone_trigger(struct comp_dev *dev, int cmd)
 }
 
 /* copy and process stream data from source to sink buffers */
-static int tone_copy(struct comp_dev *dev)
+static int __overlay_text(tone) tone_copy(struct comp_dev *dev)
 {
 	struct comp_buffer *sink;
 	struct comp_data *cd = comp_get_drvdata(dev);
@@ -708,6 +762,7 @@ static int tone_reset(struct comp_dev *dev)
 static const struct comp_driver comp_tone = {
 	.type = SOF_COMP_TONE,
 	.uid = SOF_UUID(tone_uuid),
+	.overlay = OVERLAY(tone),
 	.ops = {
 		.create = tone_new,
 		.free = tone_free,
@@ -28,9 +28,6 @@
 #include <sof/list.h>
 #include <sof/math/numbers.h>
 #include <sof/platform.h>
-#include <sof/schedule/ll_schedule.h>
-#include <sof/schedule/schedule.h>
-#include <sof/schedule/task.h>
 #include <sof/string.h>
 #include <sof/trace/trace.h>
 #include <sof/ut.h>
@@ -51,10 +48,6 @@ static const struct comp_driver comp_volume;
 DECLARE_SOF_UUID("volume", volume_uuid, 0xb77e677e, 0x5ff4, 0x4188,
 		 0xaf, 0x14, 0xfb, 0xa8, 0xbd, 0xbf, 0x86, 0x82);
 
-/* 34dc0385-fc2f-4f7f-82d2-6cee444533e0 */
-DECLARE_SOF_UUID("volume-task", volume_task_uuid, 0x34dc0385, 0xfc2f, 0x4f7f,
-		 0x82, 0xd2, 0x6c, 0xee, 0x44, 0x45, 0x33, 0xe0);
-
 /**
  * \brief Synchronize host mmap() volume with real value.
  * \param[in,out] cd Volume component private data.
@@ -80,34 +73,82 @@ static void vol_sync_host(struct comp_dev *dev, unsigned int num_channels)
 }
 
 /**
- * \brief Ramps volume changes over time.
- * \param[in,out] data Volume base component device.
- * \param[in] delay Update time.
- * \return Time until next work.
+ * \brief Copies frames unchanged for unity gain.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ */
+static void vol_passthrough(struct comp_dev *dev, struct audio_stream *sink,
+			    const struct audio_stream *source,
+			    uint32_t frames)
+{
+	audio_stream_copy(source, 0, sink, 0,
+			  frames * audio_stream_frame_bytes(source));
+}
+
+/**
+ * \brief Writes silence for muted gain.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in] source Source buffer.
+ * \param[in] frames Number of frames to process.
  */
-static enum task_state vol_work(void *data)
+static void vol_zero(struct comp_dev *dev, struct audio_stream *sink,
+		     const struct audio_stream *source, uint32_t frames)
+{
+	audio_stream_set_zero(sink, frames * audio_stream_frame_bytes(sink));
+}
+
+/**
+ * \brief Selects processing function for the current constant gain.
+ * \param[in,out] dev Volume base component device.
+ *
+ * Called only when volume isn't ramping, so unity and mute fast paths
+ * are switched at ramp end and never during a ramp.
+ */
+static void vol_select_process(struct comp_dev *dev)
 {
-	struct comp_dev *dev = (struct comp_dev *)data;
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t vol;
-	int again = 0;
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	bool unity = true;
+	bool mute = true;
 	int i;
 
-	/* No need to ramp in idle state, jump volume to request. */
-	if (dev->state == COMP_STATE_READY) {
-		for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-			cd->volume[i] = cd->tvolume[i];
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
 
-		vol_sync_host(dev, PLATFORM_MAX_CHANNELS);
-		return SOF_TASK_STATE_COMPLETED;
+	for (i = 0; i < cd->channels; i++) {
+		if (cd->volume[i] != VOL_ZERO_DB)
+			unity = false;
+		if (cd->volume[i])
+			mute = false;
 	}
 
-	/* The first is set and cleared to indicate ongoing ramp, the
-	 * latter is set once to enable self launched ramp only once
-	 * in stream start.
-	 */
-	cd->vol_ramp_active = true;
-	cd->ramp_started = true;
+	/* a copy would bypass the metering in processing functions */
+	if (unity && sourceb->stream.frame_fmt == sinkb->stream.frame_fmt &&
+	    !IS_ENABLED(CONFIG_COMP_VOLUME_METER))
+		cd->process_vol = vol_passthrough;
+	else if (mute)
+		cd->process_vol = vol_zero;
+	else
+		cd->process_vol = cd->scale_vol;
+}
+
+/**
+ * \brief Steps volume gains of ramping channels towards target.
+ * \param[in,out] dev Volume base component device.
+ * \return True if the ramp continues.
+ */
+static bool vol_ramp_step(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t vol;
+	bool again = false;
+	int i;
 
 	/* inc/dec each volume if it's not at target for active channels */
 	for (i = 0; i < cd->channels; i++) {
@@ -127,7 +168,7 @@ static enum task_state vol_work(void *data)
 				cd->volume[i] = cd->tvolume[i];
 			} else {
 				cd->volume[i] = vol;
-				again = 1;
+				again = true;
 			}
 		} else {
 			/* ramp down */
@@ -143,54 +184,194 @@ static enum task_state vol_work(void *data)
 					cd->volume[i] = cd->tvolume[i];
 				} else {
 					cd->volume[i] = vol;
-					again = 1;
+					again = true;
 				}
 			}
 		}
+	}
 
+	return again;
+}
+
+/**
+ * \brief Starts volume ramp over the next processed frames.
+ * \param[in,out] dev Volume base component device.
+ */
+static void vol_ramp_start(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int i;
+
+	/* No need to ramp in idle state, jump volume to request. */
+	if (dev->state == COMP_STATE_READY) {
+		for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+			cd->volume[i] = cd->tvolume[i];
+
+		vol_sync_host(dev, PLATFORM_MAX_CHANNELS);
+		return;
+	}
+
+	if (!cd->vol_ramp_active) {
+		cd->ramp_frames_left = cd->ramp_block_frames;
+		cd->vol_ramp_active = true;
+	}
+}
+
+/**
+ * \brief Processes frames while ramping, gain is stepped between blocks.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ */
+static void vol_ramp(struct comp_dev *dev, struct audio_stream *sink,
+		     const struct audio_stream *source, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct audio_stream src = *source;
+	struct audio_stream snk = *sink;
+	uint32_t source_frame_bytes = audio_stream_frame_bytes(source);
+	uint32_t sink_frame_bytes = audio_stream_frame_bytes(sink);
+	uint32_t n;
+
+	while (frames) {
+		n = cd->vol_ramp_active ?
+			MIN(frames, cd->ramp_frames_left) : frames;
+
+		/* constant gain within a block */
+		cd->scale_vol(dev, &snk, &src, n);
+
+		src.r_ptr = audio_stream_wrap(&src, (char *)src.r_ptr +
+					      n * source_frame_bytes);
+		snk.w_ptr = audio_stream_wrap(&snk, (char *)snk.w_ptr +
+					      n * sink_frame_bytes);
+		frames -= n;
+
+		if (!cd->vol_ramp_active)
+			break;
+
+		cd->ramp_frames_left -= n;
+		if (!cd->ramp_frames_left) {
+			cd->ramp_frames_left = cd->ramp_block_frames;
+			cd->vol_ramp_active = vol_ramp_step(dev);
+			if (!cd->vol_ramp_active)
+				vol_select_process(dev);
+		}
 	}
 
 	/* sync host with new value */
 	vol_sync_host(dev, cd->channels);
+}
+
+#if CONFIG_COMP_VOLUME_METER
+/* integer square root rounded down, once per channel and window */
+static uint32_t vol_meter_sqrt(uint64_t x)
+{
+	uint64_t root = 0;
+	uint64_t bit = 1ULL << 62;
 
-	/* do we need to continue ramping */
-	if (again)
-		return SOF_TASK_STATE_RESCHEDULE;
+	while (bit > x)
+		bit >>= 2;
 
-	cd->vol_ramp_active = 0;
-	return SOF_TASK_STATE_COMPLETED;
+	while (bit) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
 }
 
 /**
- * \brief Allocates task of volume component.
+ * \brief Publishes levels once a window of frames is metered.
  * \param[in,out] dev Volume base component device.
- * \return Error code.
+ * \param[in] frames Number of frames processed.
+ *
+ * Frames of fast paths not going through processing functions are
+ * silence, so they only count.
  */
-static int vol_task_init(struct comp_dev *dev)
+static void vol_meter_update(struct comp_dev *dev, uint32_t frames)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int ret;
+	struct vol_meter *meter = &cd->meter;
+	int64_t mean;
+	int i;
 
-	/* initialize task if necessary */
-	if (cd->volwork)
-		return 0;
+	meter->frames += frames;
+	if (meter->frames < meter->window)
+		return;
 
-	cd->volwork = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-			      sizeof(*cd->volwork));
-	if (!cd->volwork)
-		return -ENOMEM;
+	/* Q1.23 levels to Q1.31, mean of Q2.46 squares has Q1.23 root */
+	for (i = 0; i < cd->channels; i++) {
+		mean = meter->sum[i] / meter->frames;
+		meter->level_peak[i] = sat_int32((int64_t)meter->peak[i] << 8);
+		meter->level_rms[i] =
+			sat_int32((int64_t)vol_meter_sqrt(mean) << 8);
+		meter->peak[i] = 0;
+		meter->sum[i] = 0;
+	}
 
-	ret = schedule_task_init_ll(cd->volwork, SOF_UUID(volume_task_uuid),
-				    SOF_SCHEDULE_LL_TIMER,
-				    SOF_TASK_PRI_MED, vol_work, dev,
-				    cpu_get_id(), 0);
-	if (ret < 0) {
-		rfree(cd->volwork);
-		return ret;
+	meter->frames = 0;
+}
+
+/**
+ * \brief Starts metering of a stream.
+ * \param[in,out] dev Volume base component device.
+ * \param[in] rate Sample rate of the stream.
+ */
+static void vol_meter_init(struct comp_dev *dev, uint32_t rate)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	memset(&cd->meter, 0, sizeof(cd->meter));
+	cd->meter.window = MAX(rate * CONFIG_COMP_VOLUME_METER_MS / 1000, 1);
+}
+
+/**
+ * \brief Gets levels of the last window, peak and RMS for each channel.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] cdata Control command data.
+ * \return Error code.
+ */
+static int vol_meter_get(struct comp_dev *dev,
+			 struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct vol_meter *meter = &cd->meter;
+	uint32_t ch;
+	int j;
+
+	for (j = 0; j < cdata->num_elems; j++) {
+		ch = j >> 1;
+		cdata->chanv[j].channel = ch;
+		if (j & 1)
+			cdata->chanv[j].value = meter->level_rms[ch];
+		else
+			cdata->chanv[j].value = meter->level_peak[ch];
 	}
 
 	return 0;
 }
+#else
+static inline void vol_meter_update(struct comp_dev *dev, uint32_t frames)
+{
+}
+
+static inline void vol_meter_init(struct comp_dev *dev, uint32_t rate)
+{
+}
+
+static inline int vol_meter_get(struct comp_dev *dev,
+				struct sof_ipc_ctrl_data *cdata)
+{
+	comp_err(dev, "vol_meter_get(): metering not supported");
+	return -EINVAL;
+}
+#endif
 
 /**
  * \brief Creates volume component.
@@ -296,12 +477,6 @@ static void volume_free(struct comp_dev *dev)
 
 	comp_dbg(dev, "volume_free()");
 
-	/* remove scheduling */
-	if (cd->volwork) {
-		schedule_task_free(cd->volwork);
-		rfree(cd->volwork);
-	}
-
 	rfree(cd);
 	rfree(dev);
 }
@@ -406,11 +581,11 @@ static inline int volume_set_chan(struct comp_dev *dev, int chan,
 		if (pga->initial_ramp > 0) {
 			if (constant_rate_ramp && cd->vol_ramp_range > 0)
 				inc = q_multsr_32x32(cd->vol_ramp_range,
-						     VOL_RAMP_STEP_CONST,
+						     cd->ramp_step,
 						     Q_MUL_SHIFT);
 			else
 				inc = q_multsr_32x32(delta_abs,
-						     VOL_RAMP_STEP_CONST,
+						     cd->ramp_step,
 						     Q_MUL_SHIFT);
 
 			/* Divide and round to nearest. Note that there will
@@ -521,14 +696,7 @@ static int volume_ctrl_set_cmd(struct comp_dev *dev,
 			}
 		}
 
-		if (!cd->vol_ramp_active) {
-			ret = vol_task_init(dev);
-			if (ret < 0)
-				return ret;
-
-			schedule_task(cd->volwork, VOL_RAMP_UPDATE_US,
-				      VOL_RAMP_UPDATE_US);
-		}
+		vol_ramp_start(dev);
 		break;
 
 	case SOF_CTRL_CMD_SWITCH:
@@ -551,14 +719,7 @@ static int volume_ctrl_set_cmd(struct comp_dev *dev,
 				volume_set_chan_mute(dev, ch);
 		}
 
-		if (!cd->vol_ramp_active) {
-			ret = vol_task_init(dev);
-			if (ret < 0)
-				return ret;
-
-			schedule_task(cd->volwork, VOL_RAMP_UPDATE_US,
-				      VOL_RAMP_UPDATE_US);
-		}
+		vol_ramp_start(dev);
 		break;
 
 	default:
@@ -579,10 +740,15 @@ static int volume_ctrl_get_cmd(struct comp_dev *dev,
 			       struct sof_ipc_ctrl_data *cdata, int size)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
+	uint32_t max_elems = SOF_IPC_MAX_CHANNELS;
 	int j;
 
+	/* levels are peak and RMS pairs */
+	if (cdata->cmd == SOF_CTRL_CMD_LEVEL)
+		max_elems *= 2;
+
 	/* validate */
-	if (cdata->num_elems == 0 || cdata->num_elems > SOF_IPC_MAX_CHANNELS) {
+	if (cdata->num_elems == 0 || cdata->num_elems > max_elems) {
 		comp_err(dev, "volume_ctrl_get_cmd(): invalid cdata->num_elems %u",
 			 cdata->num_elems);
 		return -EINVAL;
@@ -599,6 +765,8 @@ static int volume_ctrl_get_cmd(struct comp_dev *dev,
 				  cdata->chanv[j].channel,
 				  cdata->chanv[j].value);
 		}
+	} else if (cdata->cmd == SOF_CTRL_CMD_LEVEL) {
+		return vol_meter_get(dev, cdata);
 	} else {
 		comp_err(dev, "volume_ctrl_get_cmd(): invalid cdata->cmd");
 		return -EINVAL;
@@ -644,6 +812,28 @@ static int volume_trigger(struct comp_dev *dev, int cmd)
 	return comp_set_state(dev, cmd);
 }
 
+/**
+ * \brief Scales frames, ramping the gain if a ramp is active.
+ * \param[in,out] dev Volume base component device.
+ * \param[in] source Source stream.
+ * \param[in,out] sink Sink stream.
+ * \param[in] frames Number of frames to process.
+ * \return Error code.
+ */
+static int volume_process(struct comp_dev *dev,
+			  const struct audio_stream *source,
+			  struct audio_stream *sink, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (cd->vol_ramp_active)
+		vol_ramp(dev, sink, source, frames);
+	else
+		cd->process_vol(dev, sink, source, frames);
+
+	return 0;
+}
+
 /**
  * \brief Copies and processes stream data.
  * \param[in,out] dev Volume base component device.
@@ -651,18 +841,16 @@ static int volume_trigger(struct comp_dev *dev, int cmd)
  */
 static int volume_copy(struct comp_dev *dev)
 {
-	struct comp_copy_limits c;
 	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_copy_limits c;
 	struct comp_buffer *source;
 	struct comp_buffer *sink;
 	uint32_t flags = 0;
+	bool silence;
+	bool muted;
 
 	comp_dbg(dev, "volume_copy()");
 
-	if (!cd->ramp_started)
-		schedule_task(cd->volwork, VOL_RAMP_UPDATE_US,
-			      VOL_RAMP_UPDATE_US);
-
 	source = list_first_item(&dev->bsource_list, struct comp_buffer,
 				 sink_list);
 	sink = list_first_item(&dev->bsink_list, struct comp_buffer,
@@ -680,11 +868,24 @@ static int volume_copy(struct comp_dev *dev)
 	comp_dbg(dev, "volume_copy(), source_bytes = 0x%x, sink_bytes = 0x%x",
 		 c.source_bytes, c.sink_bytes);
 
+	/* silence stays silence at any gain, only a ramp has to go on */
+	silence = buffer_is_silent(source);
+	muted = !cd->vol_ramp_active && cd->process_vol == vol_zero;
+
 	/* copy and scale volume */
-	buffer_invalidate(source, c.source_bytes);
-	cd->scale_vol(dev, &sink->stream, &source->stream, c.frames);
+	if (silence && !cd->vol_ramp_active) {
+		vol_zero(dev, &sink->stream, &source->stream, c.frames);
+	} else {
+		buffer_invalidate(source, c.source_bytes);
+		volume_process(dev, &source->stream, &sink->stream, c.frames);
+	}
 	buffer_writeback(sink, c.sink_bytes);
 
+	vol_meter_update(dev, c.frames);
+
+	if (silence || muted)
+		buffer_mark_silence(sink);
+
 	/* calculate new free and available */
 	comp_update_buffer_produce(sink, c.sink_bytes);
 	comp_update_buffer_consume(source, c.source_bytes);
@@ -740,24 +941,38 @@ static int volume_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
+	cd->process_vol = cd->scale_vol;
+
+	if (!sinkb->stream.rate) {
+		comp_err(dev, "volume_prepare(): invalid sink rate");
+		ret = -EINVAL;
+		goto err;
+	}
+
 	vol_sync_host(dev, PLATFORM_MAX_CHANNELS);
 
+	/* Gain is stepped every ramp block of frames, the ramp step is
+	 * scaled with the exact block duration in ms as Q16.
+	 */
+	cd->ramp_block_frames = MAX(sinkb->stream.rate * VOL_RAMP_UPDATE_US /
+				    1000000, 1);
+	cd->ramp_step = (cd->ramp_block_frames * 1000 << VOL_QXY_Y) /
+			sinkb->stream.rate;
+
 	/* Set current volume to min to ensure ramp starts from minimum
-	 * to previous volume request. Copy() checks for ramp started
-	 * and schedules it if it has not yet started as result of
-	 * driver commands. Ramp is not constant rate to ensure it lasts
-	 * for entire topology specified time.
+	 * to previous volume request. Ramp is not constant rate to ensure
+	 * it lasts for entire topology specified time.
 	 */
-	cd->ramp_started = false;
 	cd->channels = sinkb->stream.channels;
 	for (i = 0; i < cd->channels; i++) {
 		cd->volume[i] = cd->vol_min;
 		volume_set_chan(dev, i, cd->tvolume[i], false);
 	}
 
-	ret = vol_task_init(dev);
-	if (ret < 0)
-		return ret;
+	cd->vol_ramp_active = false;
+	vol_ramp_start(dev);
+
+	vol_meter_init(dev, sinkb->stream.rate);
 
 	return 0;
 
@@ -783,6 +998,7 @@ static int volume_reset(struct comp_dev *dev)
 static const struct comp_driver comp_volume = {
 	.type	= SOF_COMP_VOLUME,
 	.uid	= SOF_UUID(volume_uuid),
+	.flags	= COMP_DRV_INPLACE | COMP_DRV_CHANNEL_WISE,
 	.ops	= {
 		.create		= volume_new,
 		.free		= volume_free,
@@ -790,6 +1006,7 @@ static const struct comp_driver comp_volume = {
 		.cmd		= volume_cmd,
 		.trigger	= volume_trigger,
 		.copy		= volume_copy,
+		.process	= volume_process,
 		.prepare	= volume_prepare,
 		.reset		= volume_reset,
 	},
@@ -26,6 +26,93 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/* processing for any channels count */
+#define VOL_FUNC(name)							\
+static void __hot_text name(struct comp_dev *dev,			\
+			    struct audio_stream *sink,			\
+			    const struct audio_stream *source,		\
+			    uint32_t frames)				\
+{									\
+	name##_nch(dev, sink, source, frames, sink->channels, 0);	\
+}
+
+/* processing specialized for nch channels, the channel loop unrolls */
+#define VOL_FUNC_CH(name, nch)						\
+static void __hot_text name##_##nch##ch(struct comp_dev *dev,		\
+					struct audio_stream *sink,	\
+					const struct audio_stream *source, \
+					uint32_t frames)		\
+{									\
+	name##_nch(dev, sink, source, frames, nch, 0);			\
+}
+
+#if CONFIG_ACTIVE_CHANNELS
+/* processing of the channels read by the consumer only */
+#define VOL_FUNC_MASKED(name)						\
+static void __hot_text name##_masked(struct comp_dev *dev,		\
+				     struct audio_stream *sink,		\
+				     const struct audio_stream *source,	\
+				     uint32_t frames)			\
+{									\
+	name##_nch(dev, sink, source, frames, sink->channels,		\
+		   sink->active_mask);					\
+}
+
+#define VOL_MASKED(name) name##_masked
+#else
+#define VOL_FUNC_MASKED(name)
+#define VOL_MASKED(name) NULL
+#endif
+
+#if CONFIG_COMP_VOLUME_1CH
+#define VOL_FUNC_1CH(name) VOL_FUNC_CH(name, 1)
+#define VOL_MAP_1CH(fmt, name) { fmt, 1, name##_1ch },
+#else
+#define VOL_FUNC_1CH(name)
+#define VOL_MAP_1CH(fmt, name)
+#endif
+
+#if CONFIG_COMP_VOLUME_2CH
+#define VOL_FUNC_2CH(name) VOL_FUNC_CH(name, 2)
+#define VOL_MAP_2CH(fmt, name) { fmt, 2, name##_2ch },
+#else
+#define VOL_FUNC_2CH(name)
+#define VOL_MAP_2CH(fmt, name)
+#endif
+
+#if CONFIG_COMP_VOLUME_4CH
+#define VOL_FUNC_4CH(name) VOL_FUNC_CH(name, 4)
+#define VOL_MAP_4CH(fmt, name) { fmt, 4, name##_4ch },
+#else
+#define VOL_FUNC_4CH(name)
+#define VOL_MAP_4CH(fmt, name)
+#endif
+
+#if CONFIG_COMP_VOLUME_8CH
+#define VOL_FUNC_8CH(name) VOL_FUNC_CH(name, 8)
+#define VOL_MAP_8CH(fmt, name) { fmt, 8, name##_8ch },
+#else
+#define VOL_FUNC_8CH(name)
+#define VOL_MAP_8CH(fmt, name)
+#endif
+
+/* generic and enabled specialized functions of a format */
+#define VOL_FUNCS(name)							\
+	VOL_FUNC(name)							\
+	VOL_FUNC_1CH(name)						\
+	VOL_FUNC_2CH(name)						\
+	VOL_FUNC_4CH(name)						\
+	VOL_FUNC_8CH(name)						\
+	VOL_FUNC_MASKED(name)
+
+/* map entries of a format, specializations match before the generic one */
+#define VOL_MAP(fmt, name)						\
+	VOL_MAP_1CH(fmt, name)						\
+	VOL_MAP_2CH(fmt, name)						\
+	VOL_MAP_4CH(fmt, name)						\
+	VOL_MAP_8CH(fmt, name)						\
+	{ fmt, 0, name, VOL_MASKED(name) },
+
 #if CONFIG_FORMAT_S24LE
 /**
  * \brief Volume s24 to s24 multiply function
@@ -47,12 +134,17 @@ static inline int32_t vol_mult_s24_to_s24(int32_t x, int32_t vol)
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  * \param[in] frames Number of frames to process.
+ * \param[in] nch Number of channels, constant in specializations.
+ * \param[in] mask Channels to process, 0 for all, constant 0 unless masked.
  *
  * Copy and scale volume from 24/32 bit source buffer
  * to 24/32 bit destination buffer.
  */
-static void vol_s24_to_s24(struct comp_dev *dev, struct audio_stream *sink,
-			   const struct audio_stream *source, uint32_t frames)
+static inline void vol_s24_to_s24_nch(struct comp_dev *dev,
+				      struct audio_stream *sink,
+				      const struct audio_stream *source,
+				      uint32_t frames, uint32_t nch,
+				      uint32_t mask)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int32_t *src;
@@ -63,16 +155,24 @@ static void vol_s24_to_s24(struct comp_dev *dev, struct audio_stream *sink,
 
 	/* Samples are Q1.23 --> Q1.23 and volume is Q8.16 */
 	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < sink->channels; channel++) {
+		for (channel = 0; channel < nch; channel++) {
+			if (mask && !(mask & BIT(channel))) {
+				buff_frag++;
+				continue;
+			}
+
 			src = audio_stream_read_frag_s32(source, buff_frag);
 			dest = audio_stream_write_frag_s32(sink, buff_frag);
 
 			*dest = vol_mult_s24_to_s24(*src, cd->volume[channel]);
+			vol_meter_sample(cd, channel, *dest);
 
 			buff_frag++;
 		}
 	}
 }
+
+VOL_FUNCS(vol_s24_to_s24)
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
@@ -82,12 +182,17 @@ static void vol_s24_to_s24(struct comp_dev *dev, struct audio_stream *sink,
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  * \param[in] frames Number of frames to process.
+ * \param[in] nch Number of channels, constant in specializations.
+ * \param[in] mask Channels to process, 0 for all, constant 0 unless masked.
  *
  * Copy and scale volume from 32 bit source buffer
  * to 32 bit destination buffer.
  */
-static void vol_s32_to_s32(struct comp_dev *dev, struct audio_stream *sink,
-			   const struct audio_stream *source, uint32_t frames)
+static inline void vol_s32_to_s32_nch(struct comp_dev *dev,
+				      struct audio_stream *sink,
+				      const struct audio_stream *source,
+				      uint32_t frames, uint32_t nch,
+				      uint32_t mask)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int32_t *src;
@@ -98,18 +203,26 @@ static void vol_s32_to_s32(struct comp_dev *dev, struct audio_stream *sink,
 
 	/* Samples are Q1.31 --> Q1.31 and volume is Q8.16 */
 	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < sink->channels; channel++) {
+		for (channel = 0; channel < nch; channel++) {
+			if (mask && !(mask & BIT(channel))) {
+				buff_frag++;
+				continue;
+			}
+
 			src = audio_stream_read_frag_s32(source, buff_frag);
 			dest = audio_stream_write_frag_s32(sink, buff_frag);
 
 			*dest = q_multsr_sat_32x32
 				(*src, cd->volume[channel],
 				 Q_SHIFT_BITS_64(31, 16, 31));
+			vol_meter_sample(cd, channel, *dest >> 8);
 
 			buff_frag++;
 		}
 	}
 }
+
+VOL_FUNCS(vol_s32_to_s32)
 #endif /* CONFIG_FORMAT_S32LE */
 
 #if CONFIG_FORMAT_S16LE
@@ -119,12 +232,17 @@ static void vol_s32_to_s32(struct comp_dev *dev, struct audio_stream *sink,
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  * \param[in] frames Number of frames to process.
+ * \param[in] nch Number of channels, constant in specializations.
+ * \param[in] mask Channels to process, 0 for all, constant 0 unless masked.
  *
  * Copy and scale volume from 16 bit source buffer
  * to 16 bit destination buffer.
  */
-static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
-			   const struct audio_stream *source, uint32_t frames)
+static inline void vol_s16_to_s16_nch(struct comp_dev *dev,
+				      struct audio_stream *sink,
+				      const struct audio_stream *source,
+				      uint32_t frames, uint32_t nch,
+				      uint32_t mask)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	int16_t *src;
@@ -135,29 +253,37 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 
 	/* Samples are Q1.15 --> Q1.15 and volume is Q8.16 */
 	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < sink->channels; channel++) {
+		for (channel = 0; channel < nch; channel++) {
+			if (mask && !(mask & BIT(channel))) {
+				buff_frag++;
+				continue;
+			}
+
 			src = audio_stream_read_frag_s16(source, buff_frag);
 			dest = audio_stream_write_frag_s16(sink, buff_frag);
 
 			*dest = q_multsr_sat_32x32_16
 				(*src, cd->volume[channel],
 				 Q_SHIFT_BITS_32(15, 16, 15));
+			vol_meter_sample(cd, channel, *dest << 8);
 
 			buff_frag++;
 		}
 	}
 }
+
+VOL_FUNCS(vol_s16_to_s16)
 #endif /* CONFIG_FORMAT_S16LE */
 
 const struct comp_func_map func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16 },
+	VOL_MAP(SOF_IPC_FRAME_S16_LE, vol_s16_to_s16)
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24 },
+	VOL_MAP(SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24)
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s32 },
+	VOL_MAP(SOF_IPC_FRAME_S32_LE, vol_s32_to_s32)
 #endif /* CONFIG_FORMAT_S32LE */
 };
 
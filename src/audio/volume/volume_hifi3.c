@@ -82,6 +82,8 @@ static void vol_s24_to_s24_s32(struct comp_dev *dev, struct audio_stream *sink,
 			out_sample = AE_SRAA32RS(out_sample, shift);
 			out_sample = AE_SLAA32S(out_sample, shift);
 			out_sample = AE_SRAA32(out_sample, shift);
+			vol_meter_sample(cd, channel,
+					 AE_MOVAD32_L(out_sample));
 
 			/* Set sink as circular buffer */
 			vol_setup_circular(sink);
@@ -143,6 +145,8 @@ static void vol_s32_to_s24_s32(struct comp_dev *dev, struct audio_stream *sink,
 			out_sample = AE_SRAA32RS(out_sample, shift);
 			out_sample = AE_SLAA32S(out_sample, shift);
 			out_sample = AE_SRAA32(out_sample, shift);
+			vol_meter_sample(cd, channel,
+					 AE_MOVAD32_L(out_sample) >> 8);
 
 			/* Set sink as circular buffer */
 			vol_setup_circular(sink);
@@ -196,6 +200,8 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 			 * by 31 to get Q1.63. Sample is Q1.31.
 			 */
 			out_sample = AE_ROUND32F64SSYM(AE_SLAI64S(mult, 31));
+			vol_meter_sample(cd, channel,
+					 AE_MOVAD32_L(out_sample) >> 8);
 
 			/* Set sink as circular buffer */
 			vol_setup_circular(sink);
@@ -210,13 +216,13 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 
 const struct comp_func_map func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16 },
+	{ SOF_IPC_FRAME_S16_LE, 0, vol_s16_to_s16 },
 #endif
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24_s32 },
+	{ SOF_IPC_FRAME_S24_4LE, 0, vol_s24_to_s24_s32 },
 #endif
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s24_s32 },
+	{ SOF_IPC_FRAME_S32_LE, 0, vol_s32_to_s24_s32 },
 #endif
 };
 
@@ -0,0 +1,373 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/**
+ * \file audio/volume/volume_x86.c
+ * \brief Volume SSE4.2 and AVX2 processing implementation for host builds
+ */
+
+#include <sof/audio/volume.h>
+
+#ifdef VOLUME_X86
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+#include <ipc/stream.h>
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+
+/** \brief Number of 32 bit samples in a vector. */
+#define VOL_LANES 8
+
+#define vol_vec __m256i
+
+static inline vol_vec vol_load_s32(const int32_t *ptr)
+{
+	return _mm256_loadu_si256((const __m256i *)ptr);
+}
+
+static inline void vol_store_s32(int32_t *ptr, vol_vec x)
+{
+	_mm256_storeu_si256((__m256i *)ptr, x);
+}
+
+static inline vol_vec vol_load_s16(const int16_t *ptr)
+{
+	return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)ptr));
+}
+
+static inline void vol_store_s16(int16_t *ptr, vol_vec x)
+{
+	/* packing works per 128 bit lane, so gather both halves first */
+	x = _mm256_permute4x64_epi64(_mm256_packs_epi32(x, x), 0x08);
+	_mm_storeu_si128((__m128i *)ptr, _mm256_castsi256_si128(x));
+}
+
+#define vol_set1_epi32		_mm256_set1_epi32
+#define vol_set1_epi64		_mm256_set1_epi64x
+#define vol_add_epi64		_mm256_add_epi64
+#define vol_mul_epi32		_mm256_mul_epi32
+#define vol_srli_epi64		_mm256_srli_epi64
+#define vol_slli_epi64		_mm256_slli_epi64
+#define vol_slli_epi32		_mm256_slli_epi32
+#define vol_srai_epi32		_mm256_srai_epi32
+#define vol_cmpgt_epi64		_mm256_cmpgt_epi64
+#define vol_blendv_epi8		_mm256_blendv_epi8
+#define vol_blend_epi16		_mm256_blend_epi16
+#define vol_min_epi32		_mm256_min_epi32
+#define vol_max_epi32		_mm256_max_epi32
+
+#else
+
+/** \brief Number of 32 bit samples in a vector. */
+#define VOL_LANES 4
+
+#define vol_vec __m128i
+
+static inline vol_vec vol_load_s32(const int32_t *ptr)
+{
+	return _mm_loadu_si128((const __m128i *)ptr);
+}
+
+static inline void vol_store_s32(int32_t *ptr, vol_vec x)
+{
+	_mm_storeu_si128((__m128i *)ptr, x);
+}
+
+static inline vol_vec vol_load_s16(const int16_t *ptr)
+{
+	return _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)ptr));
+}
+
+static inline void vol_store_s16(int16_t *ptr, vol_vec x)
+{
+	_mm_storel_epi64((__m128i *)ptr, _mm_packs_epi32(x, x));
+}
+
+#define vol_set1_epi32		_mm_set1_epi32
+#define vol_set1_epi64		_mm_set1_epi64x
+#define vol_add_epi64		_mm_add_epi64
+#define vol_mul_epi32		_mm_mul_epi32
+#define vol_srli_epi64		_mm_srli_epi64
+#define vol_slli_epi64		_mm_slli_epi64
+#define vol_slli_epi32		_mm_slli_epi32
+#define vol_srai_epi32		_mm_srai_epi32
+#define vol_cmpgt_epi64		_mm_cmpgt_epi64
+#define vol_blendv_epi8		_mm_blendv_epi8
+#define vol_blend_epi16		_mm_blend_epi16
+#define vol_min_epi32		_mm_min_epi32
+#define vol_max_epi32		_mm_max_epi32
+
+#endif
+
+/** \brief Gains for one vector of samples starting at any channel. */
+#define VOL_TABLE_SIZE (SOF_IPC_MAX_CHANNELS * VOL_LANES + VOL_LANES)
+
+/**
+ * \brief Fills table of gains in the order of interleaved samples.
+ * \param[in] cd Volume component private data.
+ * \param[in] channels Number of channels.
+ * \param[out] vol Gain table of VOL_TABLE_SIZE entries.
+ * \return Length of the repeating gain pattern, multiple of VOL_LANES.
+ */
+static uint32_t vol_table_init(struct comp_data *cd, uint32_t channels,
+			       int32_t *vol)
+{
+	uint32_t period = channels * VOL_LANES;
+	uint32_t i;
+
+	for (i = 0; i < period + VOL_LANES; i++)
+		vol[i] = cd->volume[i % channels];
+
+	return period;
+}
+
+/**
+ * \brief Multiplies samples with Q8.16 gains with rounding.
+ *
+ * Products are calculated in 64 bits for even and odd lanes separately,
+ * only the low 32 bits of the rounded results are kept, so they need to
+ * fit in 32 bits.
+ */
+static inline vol_vec vol_mult_q16(vol_vec x, vol_vec vol)
+{
+	vol_vec rnd = vol_set1_epi64(1 << 15);
+	vol_vec even = vol_add_epi64(vol_mul_epi32(x, vol), rnd);
+	vol_vec odd = vol_add_epi64(vol_mul_epi32(vol_srli_epi64(x, 32),
+						  vol_srli_epi64(vol, 32)),
+				    rnd);
+
+	/* odd results end up in the high halves of 64 bit lanes */
+	return vol_blend_epi16(vol_srli_epi64(even, 16),
+			       vol_slli_epi64(odd, 16), 0xCC);
+}
+
+/** \brief Shifts rounded 64 bit products by 16 and saturates to 32 bits. */
+static inline vol_vec vol_sat_q16(vol_vec prod)
+{
+	vol_vec max = vol_set1_epi64(((int64_t)INT32_MAX << 16) + 0xffff);
+	vol_vec min = vol_set1_epi64((int64_t)INT32_MIN << 16);
+	vol_vec res = vol_srli_epi64(prod, 16);
+
+	res = vol_blendv_epi8(res, vol_set1_epi64(INT32_MAX),
+			      vol_cmpgt_epi64(prod, max));
+	return vol_blendv_epi8(res, vol_set1_epi64(INT32_MIN),
+			       vol_cmpgt_epi64(min, prod));
+}
+
+/** \brief Multiplies samples with Q8.16 gains with 32 bit saturation. */
+static inline vol_vec vol_mult_q16_sat(vol_vec x, vol_vec vol)
+{
+	vol_vec rnd = vol_set1_epi64(1 << 15);
+	vol_vec even = vol_add_epi64(vol_mul_epi32(x, vol), rnd);
+	vol_vec odd = vol_add_epi64(vol_mul_epi32(vol_srli_epi64(x, 32),
+						  vol_srli_epi64(vol, 32)),
+				    rnd);
+
+	return vol_blend_epi16(vol_sat_q16(even),
+			       vol_slli_epi64(vol_sat_q16(odd), 32), 0xCC);
+}
+
+#if CONFIG_FORMAT_S24LE
+/**
+ * \brief SIMD volume processing from 24/32 bit to 24/32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Buffers are processed in spans that don't cross any of the buffer ends,
+ * samples which don't fill a whole vector are processed one by one.
+ */
+static void vol_s24_to_s24(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t vol[VOL_TABLE_SIZE];
+	vol_vec min = vol_set1_epi32(INT24_MINVALUE);
+	vol_vec max = vol_set1_epi32(INT24_MAXVALUE);
+	vol_vec x;
+	int32_t *src = source->r_ptr;
+	int32_t *dest = sink->w_ptr;
+	uint32_t samples = frames * sink->channels;
+	uint32_t period = vol_table_init(cd, sink->channels, vol);
+	uint32_t j = 0;
+	uint32_t n;
+	uint32_t i;
+
+	/* Samples are Q1.23 --> Q1.23 and volume is Q8.16 */
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dest));
+		n = MIN(n, samples);
+
+		for (i = 0; i + VOL_LANES <= n; i += VOL_LANES) {
+			x = vol_load_s32(src + i);
+			x = vol_srai_epi32(vol_slli_epi32(x, 8), 8);
+			x = vol_mult_q16(x, vol_load_s32(vol + j));
+			x = vol_max_epi32(vol_min_epi32(x, max), min);
+			vol_store_s32(dest + i, x);
+
+			j += VOL_LANES;
+			if (j >= period)
+				j -= period;
+		}
+
+		for (; i < n; i++) {
+			dest[i] = q_multsr_sat_32x32_24(sign_extend_s24(src[i]),
+							vol[j],
+							Q_SHIFT_BITS_64(23, 16,
+									23));
+			if (++j == period)
+				j = 0;
+		}
+
+		/* handle wrap at the end of span */
+		src = audio_stream_wrap(source, src + n);
+		dest = audio_stream_wrap(sink, dest + n);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+/**
+ * \brief SIMD volume processing from 32 bit to 32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Buffers are processed in spans that don't cross any of the buffer ends,
+ * samples which don't fill a whole vector are processed one by one.
+ */
+static void vol_s32_to_s32(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t vol[VOL_TABLE_SIZE];
+	int32_t *src = source->r_ptr;
+	int32_t *dest = sink->w_ptr;
+	uint32_t samples = frames * sink->channels;
+	uint32_t period = vol_table_init(cd, sink->channels, vol);
+	uint32_t j = 0;
+	uint32_t n;
+	uint32_t i;
+
+	/* Samples are Q1.31 --> Q1.31 and volume is Q8.16 */
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s32(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s32(sink, dest));
+		n = MIN(n, samples);
+
+		for (i = 0; i + VOL_LANES <= n; i += VOL_LANES) {
+			vol_store_s32(dest + i,
+				      vol_mult_q16_sat(vol_load_s32(src + i),
+						       vol_load_s32(vol + j)));
+
+			j += VOL_LANES;
+			if (j >= period)
+				j -= period;
+		}
+
+		for (; i < n; i++) {
+			dest[i] = q_multsr_sat_32x32(src[i], vol[j],
+						     Q_SHIFT_BITS_64(31, 16,
+								     31));
+			if (++j == period)
+				j = 0;
+		}
+
+		/* handle wrap at the end of span */
+		src = audio_stream_wrap(source, src + n);
+		dest = audio_stream_wrap(sink, dest + n);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S32LE */
+
+#if CONFIG_FORMAT_S16LE
+/**
+ * \brief SIMD volume processing from 16 bit to 16 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Buffers are processed in spans that don't cross any of the buffer ends,
+ * samples which don't fill a whole vector are processed one by one.
+ */
+static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t vol[VOL_TABLE_SIZE];
+	int16_t *src = source->r_ptr;
+	int16_t *dest = sink->w_ptr;
+	uint32_t samples = frames * sink->channels;
+	uint32_t period = vol_table_init(cd, sink->channels, vol);
+	uint32_t j = 0;
+	uint32_t n;
+	uint32_t i;
+
+	/* Samples are Q1.15 --> Q1.15 and volume is Q8.16 */
+	while (samples) {
+		/* find number of samples till the closest buffer wrap */
+		n = audio_stream_samples_without_wrap_s16(source, src);
+		n = MIN(n, audio_stream_samples_without_wrap_s16(sink, dest));
+		n = MIN(n, samples);
+
+		for (i = 0; i + VOL_LANES <= n; i += VOL_LANES) {
+			vol_store_s16(dest + i,
+				      vol_mult_q16(vol_load_s16(src + i),
+						   vol_load_s32(vol + j)));
+
+			j += VOL_LANES;
+			if (j >= period)
+				j -= period;
+		}
+
+		for (; i < n; i++) {
+			dest[i] = q_multsr_sat_32x32_16(src[i], vol[j],
+							Q_SHIFT_BITS_32(15, 16,
+									15));
+			if (++j == period)
+				j = 0;
+		}
+
+		/* handle wrap at the end of span */
+		src = audio_stream_wrap(source, src + n);
+		dest = audio_stream_wrap(sink, dest + n);
+
+		samples -= n;
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+const struct comp_func_map func_map[] = {
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, 0, vol_s16_to_s16 },
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, 0, vol_s24_to_s24 },
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, 0, vol_s32_to_s32 },
+#endif /* CONFIG_FORMAT_S32LE */
+};
+
+const size_t func_count = ARRAY_SIZE(func_map);
+
+#endif
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/debug/boot_profile.h>
+#include <sof/drivers/timer.h>
+#include <sof/fw-ready-metadata.h>
+#include <sof/lib/cpu.h>
+#include <sof/trace/trace.h>
+#include <ipc/header.h>
+#include <ipc/info.h>
+#include <stdint.h>
+
+/* written to mailbox with FW_READY, phases are recorded until then */
+struct sof_ipc_boot_profile boot_profile = {
+	.ext_hdr = {
+		.hdr.cmd = SOF_IPC_FW_READY,
+		.hdr.size = sizeof(struct sof_ipc_boot_profile),
+		.type = SOF_IPC_EXT_BOOT_PROFILE,
+	},
+	.point = {
+		[BOOT_PROFILE_POINTS - 1] = { 0 },
+	},
+};
+
+void boot_profile_point(uint32_t id)
+{
+	struct sof_ipc_boot_profile *profile = &boot_profile;
+	struct sof_ipc_boot_point *point;
+	uint32_t cycles = arch_timer_get_cycles();
+	uint32_t count = profile->num_points;
+
+	if (cpu_get_id() != PLATFORM_MASTER_CORE_ID ||
+	    count == BOOT_PROFILE_POINTS ||
+	    (count && profile->point[count - 1].id == TRACE_BOOT_SYS_READY))
+		return;
+
+	point = &profile->point[count];
+	point->id = id;
+	point->cycles = cycles;
+
+	profile->num_points = count + 1;
+	profile->ext_hdr.hdr.size += sizeof(*point);
+}
@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/common.h>
+#include <sof/debug/session.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/memory.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <sof/spinlock.h>
+#include <ipc/header.h>
+#include <ipc/topology.h>
+#include <ipc/trace.h>
+#include <kernel/abi.h>
+#include <user/session.h>
+#include <config.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Records are kept in a ring addressed by session offsets, which grow from
+ * zero at the start of the session. The ring size is a power of two, so an
+ * offset masked with it is the position in the ring even once the offsets
+ * wrap. Records are word aligned, their headers never wrap.
+ */
+#define SESSION_MASK	(CONFIG_SESSION_RECORD_SIZE - 1)
+
+struct session {
+	spinlock_t lock;
+	bool started;
+	uint64_t start;		/* timer ticks at session start */
+	uint32_t head;		/* offset of the oldest record */
+	uint32_t tail;		/* offset past the newest record */
+	uint8_t data[CONFIG_SESSION_RECORD_SIZE] __aligned(4);
+};
+
+static SHARED_DATA struct session session;
+
+static struct session *session_get(void)
+{
+	return platform_shared_get(&session, sizeof(session));
+}
+
+static void session_copy_in(struct session *s, uint32_t offset,
+			    const void *src, uint32_t bytes)
+{
+	const uint8_t *in = src;
+	uint32_t i;
+
+	for (i = 0; i < bytes; i++)
+		s->data[(offset + i) & SESSION_MASK] = in[i];
+}
+
+static void session_copy_out(struct session *s, uint32_t offset, void *dst,
+			     uint32_t bytes)
+{
+	uint8_t *out = dst;
+	uint32_t i;
+
+	for (i = 0; i < bytes; i++)
+		out[i] = s->data[(offset + i) & SESSION_MASK];
+}
+
+static uint16_t session_rec_size(struct session *s, uint32_t offset)
+{
+	struct sof_session_rec rec;
+
+	session_copy_out(s, offset, &rec, sizeof(rec));
+
+	return rec.size;
+}
+
+/* appends a record, dropping the oldest ones it doesn't fit next to */
+static void session_append(struct session *s, struct sof_session_rec *rec,
+			   const void *payload, uint32_t bytes)
+{
+	uint64_t ticks_per_ms = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+	uint32_t zero = 0;
+
+	rec->size = sizeof(*rec) + ALIGN_UP(bytes, 4);
+	rec->time_us = (platform_timer_get(timer_get()) - s->start) * 1000 /
+		ticks_per_ms;
+
+	while (s->tail + rec->size - s->head > CONFIG_SESSION_RECORD_SIZE)
+		s->head += session_rec_size(s, s->head);
+
+	session_copy_in(s, s->tail, rec, sizeof(*rec));
+	session_copy_in(s, s->tail + sizeof(*rec), payload, bytes);
+	session_copy_in(s, s->tail + sizeof(*rec) + bytes, &zero,
+			rec->size - sizeof(*rec) - bytes);
+	s->tail += rec->size;
+}
+
+static void session_restart(struct session *s)
+{
+	struct sof_session_start start = {
+		.rec.type = SOF_SESSION_START,
+		.abi_version = SOF_ABI_VERSION,
+		.stats_ms = CONFIG_SESSION_RECORD_STATS_MS,
+	};
+
+	s->start = platform_timer_get(timer_get());
+	s->head = 0;
+	s->tail = 0;
+	s->started = true;
+
+	session_append(s, &start.rec, &start.abi_version,
+		       sizeof(start) - sizeof(start.rec));
+}
+
+static void session_write(struct sof_session_rec *rec, const void *payload,
+			  uint32_t bytes)
+{
+	struct session *s = session_get();
+	uint32_t flags;
+
+	spin_lock_irq(&s->lock, flags);
+
+	if (!s->started)
+		session_restart(s);
+
+	session_append(s, rec, payload, bytes);
+
+	spin_unlock_irq(&s->lock, flags);
+}
+
+void session_record_ipc(struct sof_ipc_cmd_hdr *hdr)
+{
+	struct sof_session_rec rec = {
+		.type = SOF_SESSION_IPC,
+	};
+
+	/* commands of a compound are recorded one by one, reads not at all */
+	if ((hdr->cmd & SOF_GLB_TYPE_MASK) == SOF_IPC_GLB_COMPOUND ||
+	    hdr->cmd == (SOF_IPC_GLB_TRACE_MSG | SOF_IPC_TRACE_SESSION))
+		return;
+
+	session_write(&rec, hdr, MIN(hdr->size, SOF_SESSION_IPC_BYTES));
+}
+
+/* sample at index in Q1.15, false for formats without statistics */
+static bool session_sample(struct audio_stream *stream, uint32_t idx,
+			   int32_t *x)
+{
+	switch (stream->frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		*x = *(int16_t *)audio_stream_read_frag_s16(stream, idx);
+		return true;
+	case SOF_IPC_FRAME_S24_4LE:
+		*x = *(int32_t *)audio_stream_read_frag_s32(stream, idx) << 8;
+		*x >>= 16;
+		return true;
+	case SOF_IPC_FRAME_S32_LE:
+		*x = *(int32_t *)audio_stream_read_frag_s32(stream, idx) >> 16;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* input signal enters the DSP through sink buffers of host and DAI */
+static bool session_input_buffer(struct comp_buffer *buffer)
+{
+	if (!buffer->source)
+		return false;
+
+	switch (dev_comp_type(buffer->source)) {
+	case SOF_COMP_HOST:
+	case SOF_COMP_SG_HOST:
+	case SOF_COMP_DAI:
+	case SOF_COMP_SG_DAI:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void session_record_stats(struct comp_buffer *buffer, uint32_t bytes)
+{
+	struct audio_stream *stream = &buffer->stream;
+	struct session_stats *stats = &buffer->session;
+	struct sof_session_stats rec = {
+		.rec.type = SOF_SESSION_STATS,
+	};
+	uint32_t samples;
+	uint32_t window;
+	uint32_t i;
+	int32_t x;
+
+	if (!session_input_buffer(buffer) || !stream->rate ||
+	    !stream->channels)
+		return;
+
+	samples = bytes / audio_stream_sample_bytes(stream);
+
+	for (i = 0; i < samples; i++) {
+		if (!session_sample(stream, i, &x))
+			return;
+
+		stats->peak = MAX(stats->peak, (uint32_t)ABS(x));
+		stats->sum_sq += (int64_t)x * x;
+	}
+
+	stats->frames += samples / stream->channels;
+
+	window = stream->rate * CONFIG_SESSION_RECORD_STATS_MS / 1000;
+	if (stats->frames < window)
+		return;
+
+	rec.comp_id = dev_comp_id(buffer->source);
+	rec.rate = stream->rate;
+	rec.channels = stream->channels;
+	rec.peak = stats->peak;
+	rec.frames = stats->frames;
+	rec.sum_sq = stats->sum_sq;
+
+	session_write(&rec.rec, &rec.comp_id, sizeof(rec) - sizeof(rec.rec));
+
+	stats->frames = 0;
+	stats->peak = 0;
+	stats->sum_sq = 0;
+}
+
+int session_read(struct sof_ipc_dbg_session_data *reply, uint32_t offset,
+		 uint32_t max_size, bool restart)
+{
+	struct session *s = session_get();
+	uint32_t flags;
+	uint16_t size;
+
+	spin_lock_irq(&s->lock, flags);
+
+	if (restart || !s->started)
+		session_restart(s);
+
+	/* overwritten records are skipped, unknown offsets start over */
+	reply->lost = 0;
+	if ((int32_t)(offset - s->head) < 0) {
+		reply->lost = s->head - offset;
+		offset = s->head;
+	} else if ((int32_t)(s->tail - offset) < 0) {
+		offset = s->head;
+	}
+
+	reply->rhdr.hdr.size = sizeof(*reply);
+	reply->offset = offset;
+	reply->size = 0;
+
+	while (offset != s->tail) {
+		size = session_rec_size(s, offset);
+		if (reply->rhdr.hdr.size + size > max_size)
+			break;
+
+		session_copy_out(s, offset, reply->data + reply->size, size);
+		reply->size += size;
+		reply->rhdr.hdr.size += size;
+		offset += size;
+	}
+
+	spin_unlock_irq(&s->lock, flags);
+
+	return 0;
+}
@@ -55,9 +55,12 @@ struct dw_dma_ptr_data {
 struct dw_dma_chan_data {
 	struct dw_lli *lli;
 	struct dw_lli *lli_current;
+	uint32_t lli_count;		/* descriptors allocated */
+	bool ring;			/* whole buffer as one reloaded block */
 	uint32_t cfg_lo;
 	uint32_t cfg_hi;
 	struct dw_dma_ptr_data ptr_data;	/* pointer data */
+	struct dma_sg_config config;	/* config of built descriptors */
 };
 
 /* use array to get burst_elems for specific slot number setting.
@@ -68,12 +71,35 @@ static const uint32_t burst_elems[] = {1, 2, 4, 8};
 
 #if CONFIG_HW_LLI
 #define DW_DMA_BUFFER_PERIOD_COUNT	3
+#elif CONFIG_DW_DMA_RING_RELOAD
+#define DW_DMA_BUFFER_PERIOD_COUNT	CONFIG_DW_DMA_RING_PERIODS
 #else
 #define DW_DMA_BUFFER_PERIOD_COUNT	2
 #endif
 
+/* descriptors preallocated for each channel */
+#define DW_DMA_LLI_POOL_COUNT	4
+
 static int dw_dma_stop(struct dma_chan_data *channel);
 
+/* clear done bits written back by hardware, so descriptors can be reused */
+static void dw_dma_lli_clear_done(struct dma_chan_data *channel)
+{
+#if CONFIG_HW_LLI
+	struct dw_dma_chan_data *dw_chan = dma_chan_get_data(channel);
+	struct dw_lli *lli = dw_chan->lli;
+	int i;
+
+	for (i = 0; i < channel->desc_count; i++) {
+		lli->ctrl_hi &= ~DW_CTLH_DONE(1);
+		lli++;
+	}
+
+	dcache_writeback_region(dw_chan->lli,
+				sizeof(struct dw_lli) * channel->desc_count);
+#endif
+}
+
 static void dw_dma_interrupt_mask(struct dma_chan_data *channel)
 {
 	/* mask block, transfer and error interrupts for channel */
@@ -83,16 +109,28 @@ static void dw_dma_interrupt_mask(struct dma_chan_data *channel)
 	dma_reg_write(channel->dma, DW_MASK_ERR, DW_CHAN_MASK(channel->index));
 }
 
-static void dw_dma_interrupt_unmask(struct dma_chan_data *channel)
+/* block interrupt is used unless transfer ends after each block */
+static inline bool dw_dma_block_irq(struct dma_chan_data *channel)
 {
-	/* unmask block, transfer and error interrupts for channel */
 #if CONFIG_HW_LLI
-	dma_reg_write(channel->dma, DW_MASK_BLOCK,
-		      DW_CHAN_UNMASK(channel->index));
+	return true;
 #else
-	dma_reg_write(channel->dma, DW_MASK_TFR,
-		      DW_CHAN_UNMASK(channel->index));
+	struct dw_dma_chan_data *dw_chan = dma_chan_get_data(channel);
+
+	return dw_chan->ring;
 #endif
+}
+
+static void dw_dma_interrupt_unmask(struct dma_chan_data *channel)
+{
+	/* unmask block, transfer and error interrupts for channel */
+	if (dw_dma_block_irq(channel))
+		dma_reg_write(channel->dma, DW_MASK_BLOCK,
+			      DW_CHAN_UNMASK(channel->index));
+	else
+		dma_reg_write(channel->dma, DW_MASK_TFR,
+			      DW_CHAN_UNMASK(channel->index));
+
 	dma_reg_write(channel->dma, DW_MASK_ERR,
 		      DW_CHAN_UNMASK(channel->index));
 }
@@ -111,11 +149,10 @@ static uint32_t dw_dma_interrupt_status(struct dma_chan_data *channel)
 {
 	uint32_t status;
 
-#if CONFIG_HW_LLI
-	status = dma_reg_read(channel->dma, DW_STATUS_BLOCK);
-#else
-	status = dma_reg_read(channel->dma, DW_STATUS_TFR);
-#endif
+	if (dw_dma_block_irq(channel))
+		status = dma_reg_read(channel->dma, DW_STATUS_BLOCK);
+	else
+		status = dma_reg_read(channel->dma, DW_STATUS_TFR);
 
 	return status & DW_CHAN(channel->index);
 }
@@ -138,6 +175,10 @@ static inline void dw_dma_chan_reload_lli_cb(void *arg, enum notify_id type,
 	struct dw_dma_chan_data *dw_chan = dma_chan_get_data(channel);
 	struct dw_lli *lli = dw_chan->lli_current;
 
+	/* hardware reloads the block by itself */
+	if (dw_chan->ring)
+		return;
+
 	/* only need to reload if this is a block transfer */
 	if (!lli || !lli->llp) {
 		channel->status = COMP_STATE_PREPARE;
@@ -220,11 +261,7 @@ static void dw_dma_channel_put_unlocked(struct dma_chan_data *channel)
 
 	dw_dma_interrupt_mask(channel);
 
-	/* free the lli allocated by set_config*/
-	if (dw_chan->lli) {
-		rfree(dw_chan->lli);
-		dw_chan->lli = NULL;
-	}
+	/* descriptors are kept for the next user of the channel */
 
 	notifier_unregister_all(NULL, channel);
 
@@ -397,14 +434,10 @@ static int dw_dma_stop(struct dma_chan_data *channel)
 	struct dma *dma = channel->dma;
 	uint32_t flags;
 
-#if CONFIG_HW_LLI || CONFIG_DMA_SUSPEND_DRAIN
+#if CONFIG_DMA_SUSPEND_DRAIN
 	struct dw_dma_chan_data *dw_chan = dma_chan_get_data(channel);
 #endif
 
-#if CONFIG_HW_LLI
-	struct dw_lli *lli = dw_chan->lli;
-	int i;
-#endif
 #if CONFIG_DMA_SUSPEND_DRAIN
 	int ret;
 #endif
@@ -438,15 +471,7 @@ static int dw_dma_stop(struct dma_chan_data *channel)
 
 	dma_reg_write(dma, DW_DMA_CHAN_EN, DW_CHAN_MASK(channel->index));
 
-#if CONFIG_HW_LLI
-	for (i = 0; i < channel->desc_count; i++) {
-		lli->ctrl_hi &= ~DW_CTLH_DONE(1);
-		lli++;
-	}
-
-	dcache_writeback_region(dw_chan->lli,
-				sizeof(struct dw_lli) * channel->desc_count);
-#endif
+	dw_dma_lli_clear_done(channel);
 
 	/* disable linear link position */
 	platform_dw_dma_llp_disable(dma, channel);
@@ -465,6 +490,13 @@ static int dw_dma_status(struct dma_chan_data *channel,
 			 uint8_t direction)
 {
 	status->state = channel->status;
+
+	/* hardware disables the channel when one shot transfer is done */
+	if (channel->status == COMP_STATE_ACTIVE &&
+	    !(dma_reg_read(channel->dma, DW_DMA_CHAN_EN) &
+	      DW_CHAN(channel->index)))
+		status->state = COMP_STATE_PREPARE;
+
 	status->r_pos = dma_reg_read(channel->dma, DW_SAR(channel->index));
 	status->w_pos = dma_reg_read(channel->dma, DW_DAR(channel->index));
 	status->timestamp = timer_get_system(timer_get());
@@ -500,6 +532,117 @@ static void dw_dma_mask_address(struct dma_sg_elem *sg_elem,
 	}
 }
 
+/* check if descriptors were built of the same configuration */
+static bool dw_dma_config_cached(struct dw_dma_chan_data *dw_chan,
+				 struct dma_sg_config *config)
+{
+	struct dma_sg_config *cached = &dw_chan->config;
+	struct dma_sg_elem *elem;
+	struct dma_sg_elem *cached_elem;
+	int i;
+
+	if (cached->elem_array.count != config->elem_array.count ||
+	    cached->direction != config->direction ||
+	    cached->src_width != config->src_width ||
+	    cached->dest_width != config->dest_width ||
+	    cached->burst_elems != config->burst_elems ||
+	    cached->src_dev != config->src_dev ||
+	    cached->dest_dev != config->dest_dev ||
+	    cached->cyclic != config->cyclic ||
+	    cached->scatter != config->scatter ||
+	    cached->irq_disabled != config->irq_disabled ||
+	    cached->is_scheduling_source != config->is_scheduling_source)
+		return false;
+
+	for (i = 0; i < config->elem_array.count; i++) {
+		elem = config->elem_array.elems + i;
+		cached_elem = cached->elem_array.elems + i;
+
+		if (elem->src != cached_elem->src ||
+		    elem->dest != cached_elem->dest ||
+		    elem->size != cached_elem->size)
+			return false;
+	}
+
+	return true;
+}
+
+#if CONFIG_DW_DMA_RING_RELOAD
+/* check if cyclic buffer can be transferred as one auto-reloaded block */
+static bool dw_dma_ring_supported(struct dma_sg_config *config)
+{
+	struct dma_sg_elem *elem = config->elem_array.elems;
+	uint32_t mem = 0;
+	uint32_t dev = 0;
+	uint32_t bytes = 0;
+	int i;
+
+	/* DMA driven scheduling needs an interrupt every period */
+	if (!config->cyclic ||
+	    (config->is_scheduling_source && !config->irq_disabled))
+		return false;
+
+	if (config->direction != DMA_DIR_MEM_TO_DEV &&
+	    config->direction != DMA_DIR_DEV_TO_MEM)
+		return false;
+
+	for (i = 0; i < config->elem_array.count; i++, elem++) {
+		/* periods contiguous in memory, peripheral address fixed */
+		if (config->direction == DMA_DIR_MEM_TO_DEV) {
+			if (i && (elem->src != mem || elem->dest != dev))
+				return false;
+			mem = elem->src + elem->size;
+			dev = elem->dest;
+		} else {
+			if (i && (elem->dest != mem || elem->src != dev))
+				return false;
+			mem = elem->dest + elem->size;
+			dev = elem->src;
+		}
+
+		bytes += elem->size;
+	}
+
+	return bytes <= DW_CTLH_BLOCK_TS_MASK;
+}
+#else
+static inline bool dw_dma_ring_supported(struct dma_sg_config *config)
+{
+	return false;
+}
+#endif
+
+/* make room for descriptors if the pool is too small */
+static int dw_dma_lli_alloc(struct dw_dma_chan_data *dw_chan, uint32_t count)
+{
+	struct dma_sg_elem *elems;
+	struct dw_lli *lli;
+
+	if (count <= dw_chan->lli_count)
+		return 0;
+
+	lli = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+		      SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+		      sizeof(struct dw_lli) * count);
+	elems = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			sizeof(struct dma_sg_elem) * count);
+	if (!lli || !elems) {
+		rfree(lli);
+		rfree(elems);
+		return -ENOMEM;
+	}
+
+	rfree(dw_chan->lli);
+	rfree(dw_chan->config.elem_array.elems);
+
+	dw_chan->lli = lli;
+	dw_chan->config.elem_array.elems = elems;
+	dw_chan->config.elem_array.count = 0;
+	dw_chan->lli_count = count;
+
+	return 0;
+}
+
 /* set the DMA channel configuration, source/target address, buffer sizes */
 static int dw_dma_set_config(struct dma_chan_data *channel,
 			     struct dma_sg_config *config)
@@ -514,6 +657,7 @@ static int dw_dma_set_config(struct dma_chan_data *channel,
 	uint16_t chan_class;
 	uint32_t msize = 3;/* default msize */
 	uint32_t flags;
+	bool ring;
 	int ret = 0;
 	int i;
 
@@ -528,8 +672,6 @@ static int dw_dma_set_config(struct dma_chan_data *channel,
 	channel->direction = config->direction;
 	channel->is_scheduling_source = config->is_scheduling_source;
 	channel->period = config->period;
-	dw_chan->cfg_lo = DW_CFG_LOW_DEF;
-	dw_chan->cfg_hi = DW_CFG_HIGH_DEF;
 
 	if (!config->elem_array.count) {
 		trace_dwdma_error("dw_dma_set_config(): dma %d channel %d no elems",
@@ -538,7 +680,10 @@ static int dw_dma_set_config(struct dma_chan_data *channel,
 		goto out;
 	}
 
-	if (config->irq_disabled &&
+	/* ring is reloaded by hardware, so doesn't need more elems */
+	ring = dw_dma_ring_supported(config);
+
+	if (config->irq_disabled && !ring &&
 	    config->elem_array.count < DW_DMA_CFG_NO_IRQ_MIN_ELEMS) {
 		trace_dwdma_error("dw_dma_set_config(): dma %d channel %d not enough elems for config with irq disabled %d",
 				  channel->dma->plat_data.id,
@@ -547,28 +692,43 @@ static int dw_dma_set_config(struct dma_chan_data *channel,
 		goto out;
 	}
 
-	/* do we need to realloc descriptors */
-	if (config->elem_array.count != channel->desc_count) {
+	channel->desc_count = config->elem_array.count;
 
-		channel->desc_count = config->elem_array.count;
+	/* restarts with unchanged config reuse descriptors as they are */
+	if (dw_dma_config_cached(dw_chan, config)) {
+		dw_dma_lli_clear_done(channel);
 
-		/* allocate descriptors for channel */
-		if (dw_chan->lli)
-			rfree(dw_chan->lli);
+		/* pointer data is cleared on channel put */
+		dw_chan->ptr_data.buffer_bytes = 0;
+		for (i = 0; i < config->elem_array.count; i++)
+			dw_chan->ptr_data.buffer_bytes +=
+				config->elem_array.elems[i].size;
 
-		dw_chan->lli = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
-				       SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
-				       sizeof(struct dw_lli) *
-				       channel->desc_count);
-		if (!dw_chan->lli) {
-			trace_dwdma_error("dw_dma_set_config(): dma %d channel %d lli alloc failed",
-					  channel->dma->plat_data.id,
-					  channel->index);
-			ret = -ENOMEM;
-			goto out;
-		}
+		if (config->direction == DMA_DIR_MEM_TO_DEV)
+			platform_dw_dma_llp_config(channel->dma, channel,
+						   config->dest_dev);
+		else if (config->direction == DMA_DIR_DEV_TO_MEM)
+			platform_dw_dma_llp_config(channel->dma, channel,
+						   config->src_dev);
+
+		goto ready;
 	}
 
+	/* do we need to realloc descriptors */
+	ret = dw_dma_lli_alloc(dw_chan, channel->desc_count);
+	if (ret < 0) {
+		trace_dwdma_error("dw_dma_set_config(): dma %d channel %d lli alloc failed",
+				  channel->dma->plat_data.id,
+				  channel->index);
+		goto out;
+	}
+
+	/* descriptors are invalid until fully built */
+	dw_chan->config.elem_array.count = 0;
+	dw_chan->ring = false;
+	dw_chan->cfg_lo = DW_CFG_LOW_DEF;
+	dw_chan->cfg_hi = DW_CFG_HIGH_DEF;
+
 	/* initialise descriptors */
 	bzero(dw_chan->lli, sizeof(struct dw_lli) * channel->desc_count);
 	lli_desc = dw_chan->lli;
@@ -767,10 +927,38 @@ static int dw_dma_set_config(struct dma_chan_data *channel,
 #endif
 	}
 
+	/* whole buffer in the first descriptor reloaded at block end */
+	if (ring) {
+		lli_desc_head->ctrl_hi &= ~DW_CTLH_BLOCK_TS_MASK;
+		platform_dw_dma_set_transfer_size(dw_chan, lli_desc_head,
+				dw_chan->ptr_data.buffer_bytes);
+		lli_desc_head->llp = (uint32_t)lli_desc_head;
+		dw_chan->cfg_lo |= DW_CFGL_RELOAD_SRC | DW_CFGL_RELOAD_DST;
+		dw_chan->ring = true;
+	}
+
 	/* write back descriptors so DMA engine can read them directly */
 	dcache_writeback_region(dw_chan->lli,
 				sizeof(struct dw_lli) * channel->desc_count);
 
+	/* remember config for next restarts */
+	memcpy_s(dw_chan->config.elem_array.elems,
+		 sizeof(struct dma_sg_elem) * dw_chan->lli_count,
+		 config->elem_array.elems,
+		 sizeof(struct dma_sg_elem) * config->elem_array.count);
+	dw_chan->config.direction = config->direction;
+	dw_chan->config.src_width = config->src_width;
+	dw_chan->config.dest_width = config->dest_width;
+	dw_chan->config.burst_elems = config->burst_elems;
+	dw_chan->config.src_dev = config->src_dev;
+	dw_chan->config.dest_dev = config->dest_dev;
+	dw_chan->config.cyclic = config->cyclic;
+	dw_chan->config.scatter = config->scatter;
+	dw_chan->config.irq_disabled = config->irq_disabled;
+	dw_chan->config.is_scheduling_source = config->is_scheduling_source;
+	dw_chan->config.elem_array.count = config->elem_array.count;
+
+ready:
 	channel->status = COMP_STATE_PREPARE;
 	dw_chan->lli_current = dw_chan->lli;
 
@@ -931,6 +1119,18 @@ static int dw_dma_setup(struct dma *dma)
 	return 0;
 }
 
+static void dw_dma_chan_data_free(struct dma_chan_data *channel)
+{
+	struct dw_dma_chan_data *dw_chan = dma_chan_get_data(channel);
+
+	if (!dw_chan)
+		return;
+
+	rfree(dw_chan->lli);
+	rfree(dw_chan->config.elem_array.elems);
+	rfree(dw_chan);
+}
+
 static int dw_dma_probe(struct dma *dma)
 {
 	struct dma_chan_data *chan;
@@ -977,6 +1177,13 @@ static int dw_dma_probe(struct dma *dma)
 		}
 
 		dma_chan_set_data(chan, dw_chan);
+
+		/* preallocate descriptors, so stream starts don't alloc */
+		if (dw_dma_lli_alloc(dw_chan, DW_DMA_LLI_POOL_COUNT) < 0) {
+			trace_dwdma_error("dw_dma_probe(): dma %d allocaction of channel %d descriptors failed",
+					  dma->plat_data.id, i);
+			goto out;
+		}
 	}
 
 	/* init number of channels draining */
@@ -987,7 +1194,7 @@ static int dw_dma_probe(struct dma *dma)
 out:
 	if (dma->chan) {
 		for (i = 0; i < dma->plat_data.channels; i++)
-			rfree(dma_chan_get_data(&dma->chan[i]));
+			dw_dma_chan_data_free(&dma->chan[i]);
 		rfree(dma->chan);
 		dma->chan = NULL;
 	}
@@ -1004,7 +1211,7 @@ static int dw_dma_remove(struct dma *dma)
 	pm_runtime_put_sync(DW_DMAC_CLK, dma->plat_data.id);
 
 	for (i = 0; i < dma->plat_data.channels; i++)
-		rfree(dma_chan_get_data(&dma->chan[i]));
+		dw_dma_chan_data_free(&dma->chan[i]);
 
 	rfree(dma->chan);
 	dma->chan = NULL;
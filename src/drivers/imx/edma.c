@@ -9,15 +9,27 @@
 #include <sof/drivers/edma.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/io.h>
 #include <sof/lib/notifier.h>
 #include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#if CONFIG_IMX_DMA_RING
+/* ring of TCDs chained by the controller, one per buffer period */
+struct edma_ring {
+	struct edma_tcd *tcd;
+	uint32_t base;		/* buffer start on the memory side */
+	uint32_t size;		/* whole buffer size */
+	uint32_t pos;		/* position moved by copy() */
+};
+#endif
+
 static int edma_encode_tcd_attr(int src_width, int dest_width)
 {
 	int result = 0;
@@ -202,6 +214,11 @@ static int edma_copy(struct dma_chan_data *channel, int bytes, uint32_t flags)
 		.channel = channel,
 		.elem.size = bytes,
 	};
+#if CONFIG_IMX_DMA_RING
+	struct edma_ring *ring = dma_chan_get_data(channel);
+
+	ring->pos = (ring->pos + bytes) % ring->size;
+#endif
 
 	notifier_event(channel, NOTIFIER_ID_DMA_COPY,
 		       NOTIFIER_TARGET_CORE_LOCAL, &next, sizeof(next));
@@ -227,26 +244,107 @@ static int edma_validate_nonsg_config(struct dma_sg_elem_array *sgelems,
 				      uint32_t soff, uint32_t doff)
 {
 	uint32_t sbase, dbase, size;
+	int i;
 
 	if (!sgelems)
 		return -EINVAL;
-	if (sgelems->count != 2)
-		return -EINVAL; /* Only ping-pong configs supported */
+	if (sgelems->count != EDMA_BUFFER_PERIOD_COUNT)
+		return -EINVAL; /* Only whole period buffers supported */
 
 	sbase = sgelems->elems[0].src;
 	dbase = sgelems->elems[0].dest;
 	size = sgelems->elems[0].size;
 
-	if (sbase + size * SGN(soff) != sgelems->elems[1].src)
-		return -EINVAL; /**< Not contiguous */
-	if (dbase + size * SGN(doff) != sgelems->elems[1].dest)
-		return -EINVAL; /**< Not contiguous */
-	if (size != sgelems->elems[1].size)
-		return -EINVAL; /**< Mismatched sizes */
+	for (i = 1; i < sgelems->count; i++) {
+		if (sbase + i * size * SGN(soff) != sgelems->elems[i].src)
+			return -EINVAL; /**< Not contiguous */
+		if (dbase + i * size * SGN(doff) != sgelems->elems[i].dest)
+			return -EINVAL; /**< Not contiguous */
+		if (size != sgelems->elems[i].size)
+			return -EINVAL; /**< Mismatched sizes */
+	}
 
 	return 0; /* Ok, we good */
 }
 
+#if CONFIG_IMX_DMA_RING
+/* interrupt at the end of every few TCDs and always at buffer end */
+static void edma_ring_irq(struct dma_chan_data *channel, bool enable)
+{
+	struct edma_ring *ring = dma_chan_get_data(channel);
+	uint32_t next;
+	int i;
+
+	for (i = 0; i < EDMA_BUFFER_PERIOD_COUNT; i++) {
+		ring->tcd[i].csr &= ~EDMA_TCD_CSR_INTMAJOR;
+		if (enable &&
+		    (!((i + 1) % CONFIG_IMX_DMA_RING_IRQ_PERIODS) ||
+		     i == EDMA_BUFFER_PERIOD_COUNT - 1))
+			ring->tcd[i].csr |= EDMA_TCD_CSR_INTMAJOR;
+	}
+
+	dcache_writeback_region(ring->tcd,
+				sizeof(*ring->tcd) * EDMA_BUFFER_PERIOD_COUNT);
+
+	/* TCD loaded in the channel links to the next one */
+	next = dma_chan_reg_read(channel, EDMA_TCD_DLAST_SGA);
+	i = (next - (uint32_t)ring->tcd) / sizeof(*ring->tcd);
+	i = (i + EDMA_BUFFER_PERIOD_COUNT - 1) % EDMA_BUFFER_PERIOD_COUNT;
+
+	dma_chan_reg_update_bits16(channel, EDMA_TCD_CSR,
+				   EDMA_TCD_CSR_INTMAJOR,
+				   ring->tcd[i].csr & EDMA_TCD_CSR_INTMAJOR);
+}
+
+/* builds the TCD ring and loads its first TCD into the channel */
+static void edma_setup_ring(struct dma_chan_data *channel, int16_t soff,
+			    int16_t doff, uint32_t sbase, uint32_t dbase,
+			    uint32_t elem_size, uint32_t total_size,
+			    uint32_t size, int attr)
+{
+	struct edma_ring *ring = dma_chan_get_data(channel);
+	struct edma_tcd *tcd;
+	int i;
+
+	for (i = 0; i < EDMA_BUFFER_PERIOD_COUNT; i++) {
+		tcd = &ring->tcd[i];
+		tcd->saddr = sbase + i * elem_size * SGN(soff);
+		tcd->soff = soff;
+		tcd->attr = attr;
+		tcd->nbytes = size;
+		tcd->slast = 0;
+		tcd->daddr = dbase + i * elem_size * SGN(doff);
+		tcd->doff = doff;
+		tcd->citer = elem_size / size;
+		tcd->biter = elem_size / size;
+		tcd->dlast_sga =
+			(uint32_t)&ring->tcd[(i + 1) % EDMA_BUFFER_PERIOD_COUNT];
+		/* interrupts are enabled on unmask */
+		tcd->csr = EDMA_TCD_CSR_ESG;
+	}
+
+	dcache_writeback_region(ring->tcd,
+				sizeof(*ring->tcd) * EDMA_BUFFER_PERIOD_COUNT);
+
+	ring->base = soff ? sbase : dbase;
+	ring->size = total_size;
+	ring->pos = 0;
+
+	tcd = ring->tcd;
+	dma_chan_reg_write(channel, EDMA_TCD_SADDR, tcd->saddr);
+	dma_chan_reg_write16(channel, EDMA_TCD_SOFF, tcd->soff);
+	dma_chan_reg_write16(channel, EDMA_TCD_ATTR, tcd->attr);
+	dma_chan_reg_write(channel, EDMA_TCD_NBYTES, tcd->nbytes);
+	dma_chan_reg_write(channel, EDMA_TCD_SLAST, tcd->slast);
+	dma_chan_reg_write(channel, EDMA_TCD_DADDR, tcd->daddr);
+	dma_chan_reg_write16(channel, EDMA_TCD_DOFF, tcd->doff);
+	dma_chan_reg_write16(channel, EDMA_TCD_CITER, tcd->citer);
+	dma_chan_reg_write(channel, EDMA_TCD_DLAST_SGA, tcd->dlast_sga);
+	dma_chan_reg_write16(channel, EDMA_TCD_BITER, tcd->biter);
+	dma_chan_reg_write16(channel, EDMA_TCD_CSR, tcd->csr);
+}
+#endif
+
 /* Some set_config helper functions */
 /**
  * \brief Compute and set the TCDs for this channel
@@ -280,7 +378,7 @@ static int edma_setup_tcd(struct dma_chan_data *channel, int16_t soff,
 	 */
 
 	/* The only supported non-SG configurations are:
-	 * -> 2 buffers
+	 * -> EDMA_BUFFER_PERIOD_COUNT buffers
 	 * -> The buffers must be of equal size
 	 * -> The buffers must be contiguous
 	 * -> The first buffer should be of the lower address
@@ -294,12 +392,9 @@ static int edma_setup_tcd(struct dma_chan_data *channel, int16_t soff,
 
 	sbase = sgelems->elems[0].src;
 	dbase = sgelems->elems[0].dest;
-	total_size = 2 * sgelems->elems[0].size;
-	/* TODO more flexible elem_count and elem_size
-	 * calculations
-	 */
-	elem_count = 2;
-	elem_size = total_size / elem_count;
+	elem_count = EDMA_BUFFER_PERIOD_COUNT;
+	elem_size = sgelems->elems[0].size;
+	total_size = elem_count * elem_size;
 
 	/* burst_elems is in words translate it in bytes and divide by two
 	 * to fill the FIFO to half its size
@@ -317,6 +412,10 @@ static int edma_setup_tcd(struct dma_chan_data *channel, int16_t soff,
 	if (rc < 0)
 		return rc;
 
+#if CONFIG_IMX_DMA_RING
+	edma_setup_ring(channel, soff, doff, sbase, dbase, elem_size,
+			total_size, size, rc);
+#else
 	/* Configure the in-hardware TCD */
 	dma_chan_reg_write(channel, EDMA_TCD_SADDR, sbase);
 	dma_chan_reg_write16(channel, EDMA_TCD_SOFF, soff);
@@ -330,6 +429,7 @@ static int edma_setup_tcd(struct dma_chan_data *channel, int16_t soff,
 			   -total_size * SGN(doff));
 	dma_chan_reg_write16(channel, EDMA_TCD_BITER, total_size / size);
 	dma_chan_reg_write16(channel, EDMA_TCD_CSR, 0);
+#endif
 
 	channel->status = COMP_STATE_PREPARE;
 	return 0;
@@ -401,6 +501,10 @@ static int edma_pm_context_store(struct dma *dma)
 
 static int edma_probe(struct dma *dma)
 {
+#if CONFIG_IMX_DMA_RING
+	struct edma_ring *ring;
+	struct edma_tcd *tcd;
+#endif
 	int channel;
 
 	if (dma->chan) {
@@ -416,15 +520,39 @@ static int edma_probe(struct dma *dma)
 		trace_edma_error("EDMA: Probe failure, unable to allocate channel descriptors");
 		return -ENOMEM;
 	}
+
+#if CONFIG_IMX_DMA_RING
+	ring = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		       dma->plat_data.channels * sizeof(*ring));
+	tcd = rballoc_align(0, SOF_MEM_CAPS_RAM, dma->plat_data.channels *
+			    EDMA_BUFFER_PERIOD_COUNT * sizeof(*tcd),
+			    EDMA_TCD_ALIGNMENT);
+	if (!ring || !tcd) {
+		trace_edma_error("EDMA: Probe failure, unable to allocate TCD rings");
+		rfree(ring);
+		rfree(tcd);
+		rfree(dma->chan);
+		dma->chan = NULL;
+		return -ENOMEM;
+	}
+#endif
+
 	for (channel = 0; channel < dma->plat_data.channels; channel++) {
 		dma->chan[channel].dma = dma;
 		dma->chan[channel].index = channel;
+#if CONFIG_IMX_DMA_RING
+		ring[channel].tcd = tcd + channel * EDMA_BUFFER_PERIOD_COUNT;
+		dma_chan_set_data(&dma->chan[channel], &ring[channel]);
+#endif
 	}
 	return 0;
 }
 
 static int edma_remove(struct dma *dma)
 {
+#if CONFIG_IMX_DMA_RING
+	struct edma_ring *ring;
+#endif
 	int channel;
 
 	if (!dma->chan) {
@@ -437,6 +565,11 @@ static int edma_remove(struct dma *dma)
 		/* Remove TCD from channel */
 		dma_chan_reg_write16(&dma->chan[channel], EDMA_TCD_CSR, 0);
 	}
+#if CONFIG_IMX_DMA_RING
+	ring = dma_chan_get_data(&dma->chan[0]);
+	rfree(ring->tcd);
+	rfree(ring);
+#endif
 	rfree(dma->chan);
 	dma->chan = NULL;
 
@@ -455,14 +588,22 @@ static int edma_interrupt(struct dma_chan_data *channel, enum dma_irq_cmd cmd)
 		dma_chan_reg_write(channel, EDMA_CH_INT, 1);
 		return 0;
 	case DMA_IRQ_MASK:
+#if CONFIG_IMX_DMA_RING
+		edma_ring_irq(channel, false);
+#else
 		dma_chan_reg_update_bits16(channel, EDMA_TCD_CSR,
 					   EDMA_TCD_CSR_INTHALF_INTMAJOR,
 					   0);
+#endif
 		return 0;
 	case DMA_IRQ_UNMASK:
+#if CONFIG_IMX_DMA_RING
+		edma_ring_irq(channel, true);
+#else
 		dma_chan_reg_update_bits16(channel, EDMA_TCD_CSR,
 					   EDMA_TCD_CSR_INTHALF_INTMAJOR,
 					   EDMA_TCD_CSR_INTHALF_INTMAJOR);
+#endif
 		return 0;
 	default:
 		return -EINVAL;
@@ -499,6 +640,36 @@ static int edma_get_attribute(struct dma *dma, uint32_t type, uint32_t *value)
 	return 0;
 }
 
+#if CONFIG_IMX_DMA_RING
+static int edma_get_data_size(struct dma_chan_data *channel,
+			      uint32_t *avail, uint32_t *free)
+{
+	/* Bytes transferred since the position moved by copy(), the
+	 * controller position is read back from the channel TCD. It
+	 * only moves by whole minor loops.
+	 */
+	struct edma_ring *ring = dma_chan_get_data(channel);
+	uint32_t hw_pos;
+
+	switch (channel->direction) {
+	case DMA_DIR_MEM_TO_DEV:
+		hw_pos = dma_chan_reg_read(channel, EDMA_TCD_SADDR) -
+			ring->base;
+		*free = (hw_pos + ring->size - ring->pos) % ring->size;
+		break;
+	case DMA_DIR_DEV_TO_MEM:
+		hw_pos = dma_chan_reg_read(channel, EDMA_TCD_DADDR) -
+			ring->base;
+		*avail = (hw_pos + ring->size - ring->pos) % ring->size;
+		break;
+	default:
+		trace_edma_error("edma_get_data_size() unsupported direction %d",
+				 channel->direction);
+		return -EINVAL;
+	}
+	return 0;
+}
+#else
 static int edma_get_data_size(struct dma_chan_data *channel,
 			      uint32_t *avail, uint32_t *free)
 {
@@ -536,6 +707,7 @@ static int edma_get_data_size(struct dma_chan_data *channel,
 	}
 	return 0;
 }
+#endif
 
 const struct dma_ops edma_ops = {
 	.channel_get	= edma_channel_get,
@@ -148,6 +148,17 @@ static void irqstr_mask_int(uint32_t irq)
 	irqstr_update_bits(IRQSTR_CH_MASK(IRQSTR_INT_REG(irq)), mask, 0);
 }
 
+/* Mask all interrupts set in the 64 bits of an output line at once */
+static void irqstr_mask_line_ints(uint32_t line_index, uint64_t ints)
+{
+	uint32_t index = 2 * line_index;
+
+	if ((uint32_t)ints)
+		irqstr_update_bits(IRQSTR_CH_MASK(index), (uint32_t)ints, 0);
+	if (ints >> 32)
+		irqstr_update_bits(IRQSTR_CH_MASK(index + 1), ints >> 32, 0);
+}
+
 /* Unmask, that is, enable interrupts */
 static void irqstr_unmask_int(uint32_t irq)
 {
@@ -183,6 +194,85 @@ const char * const irq_name_irqsteer[] = {
 
 #define IRQ_MAX_TRIES	1000
 
+#define IRQSTR_LINES	ARRAY_SIZE(irq_name_irqsteer)
+#define IRQSTR_HOT_MAX	8
+
+/* Hot interrupts are dispatched straight from the status word to the
+ * only handler registered for them, without taking the cascade lock or
+ * walking its child list. The handler is cached on unmask.
+ */
+struct irqstr_hot {
+	uint64_t mask[IRQSTR_LINES];	/* hot inputs per output line */
+	uint64_t ready[IRQSTR_LINES];	/* hot inputs with cached handler */
+	uint32_t count;
+	struct {
+		uint32_t line;
+		uint32_t bit;
+		struct irq_desc *child;
+	} slot[IRQSTR_HOT_MAX];
+};
+
+static struct irqstr_hot irqstr_hot;
+
+int irqstr_set_hot(int irqstr_int)
+{
+	struct irqstr_hot *hot = &irqstr_hot;
+	uint32_t line, bit;
+
+	if (irqstr_int < IRQSTR_RESERVED_IRQS_NUM ||
+	    irqstr_int >= IRQSTR_IRQS_NUM)
+		return -EINVAL;
+
+	line = irqstr_int / IRQSTR_IRQS_PER_LINE;
+	bit = irqstr_int % IRQSTR_IRQS_PER_LINE;
+
+	/* several channels may share one interrupt */
+	if (hot->mask[line] & (1ull << bit))
+		return 0;
+
+	if (hot->count == IRQSTR_HOT_MAX)
+		return -ENOSPC;
+
+	hot->slot[hot->count].line = line;
+	hot->slot[hot->count].bit = bit;
+	hot->count++;
+	hot->mask[line] |= 1ull << bit;
+
+	return 0;
+}
+
+static int irqstr_hot_slot(uint32_t line, uint32_t bit)
+{
+	int i;
+
+	for (i = 0; i < irqstr_hot.count; i++)
+		if (irqstr_hot.slot[i].line == line &&
+		    irqstr_hot.slot[i].bit == bit)
+			return i;
+
+	return -EINVAL;
+}
+
+/* caches the handler when it is the only one, cascade lock is held */
+static void irqstr_hot_update(struct irq_cascade_desc *cascade,
+			      uint32_t line, uint32_t bit, bool enable)
+{
+	struct list_item *head = &cascade->child[bit].list;
+	int i = irqstr_hot_slot(line, bit);
+
+	if (i < 0)
+		return;
+
+	irqstr_hot.ready[line] &= ~(1ull << bit);
+	irqstr_hot.slot[i].child = NULL;
+
+	if (enable && !list_is_empty(head) && head->next == head->prev) {
+		irqstr_hot.slot[i].child =
+			container_of(head->next, struct irq_desc, irq_list);
+		irqstr_hot.ready[line] |= 1ull << bit;
+	}
+}
+
 /* Extract the 64 status bits corresponding to output interrupt line
  * index (64 input interrupts)
  */
@@ -210,12 +300,45 @@ static int get_first_irq(uint64_t ints)
 	return ffsll(ints) - 1;
 }
 
+/* Runs cached handlers of the hot interrupts in status, returns the
+ * interrupts left for the cascade child lists
+ */
+static inline uint64_t handle_irq_hot(struct irq_cascade_desc *cascade,
+				      uint32_t line_index, uint64_t status)
+{
+	uint64_t hot = status & irqstr_hot.ready[line_index];
+	struct list_item *head;
+	struct irq_desc *child;
+	int core = cpu_get_id();
+	int bit;
+
+	while (hot) {
+		bit = get_first_irq(hot);
+		hot &= ~(1ull << bit);
+
+		child = irqstr_hot.slot[irqstr_hot_slot(line_index, bit)].child;
+		head = &cascade->child[bit].list;
+
+		/* another handler joined since, take the slow path */
+		if (head->next != &child->irq_list ||
+		    head->prev != &child->irq_list ||
+		    !(child->cpu_mask & 1 << core))
+			continue;
+
+		interrupt_desc_run(child, core);
+		status &= ~(1ull << bit);
+	}
+
+	return status;
+}
+
 static inline void handle_irq_batch(struct irq_cascade_desc *cascade,
 				    uint32_t line_index, uint64_t status)
 {
 	int core = cpu_get_id();
 	struct list_item *clist;
 	struct irq_desc *child = NULL;
+	uint64_t unhandled = 0;
 	int bit;
 	bool handled;
 
@@ -233,7 +356,7 @@ static inline void handle_irq_batch(struct irq_cascade_desc *cascade,
 			if (child->handler && (child->cpu_mask & 1 << core)) {
 				/* run handler in non atomic context */
 				spin_unlock(&cascade->lock);
-				child->handler(child->handler_arg);
+				interrupt_desc_run(child, core);
 				spin_lock(&cascade->lock);
 
 				handled = true;
@@ -249,10 +372,13 @@ static inline void handle_irq_batch(struct irq_cascade_desc *cascade,
 		if (!handled) {
 			trace_irq_error("irq_handler(): nobody cared, bit %d",
 					bit);
-			/* Mask this interrupt so it won't happen again */
-			irqstr_mask_int(line_index * IRQSTR_IRQS_PER_LINE + bit);
+			unhandled |= 1ull << bit;
 		}
 	}
+
+	/* Mask these interrupts so they won't happen again */
+	if (unhandled)
+		irqstr_mask_line_ints(line_index, unhandled);
 }
 
 static inline void irq_handler(void *data, uint32_t line_index)
@@ -266,8 +392,10 @@ static inline void irq_handler(void *data, uint32_t line_index)
 	status = get_irqsteer_interrupts(line_index);
 
 	while (status) {
-		/* Handle current interrupts */
-		handle_irq_batch(cascade, line_index, status);
+		/* Handle current interrupts, hot ones first */
+		status = handle_irq_hot(cascade, line_index, status);
+		if (status)
+			handle_irq_batch(cascade, line_index, status);
 
 		/* Any interrupts happened while we were handling the
 		 * current ones?
@@ -314,6 +442,9 @@ static void irq_mask(struct irq_desc *desc, uint32_t irq, unsigned int core)
 	irq_base *= IRQSTR_IRQS_PER_LINE;
 	irq += irq_base;
 
+	irqstr_hot_update(container_of(desc, struct irq_cascade_desc, desc),
+			  irq_base / IRQSTR_IRQS_PER_LINE,
+			  irq - irq_base, false);
 	irqstr_mask_int(irq);
 
 	platform_shared_commit(desc, sizeof(*desc));
@@ -327,6 +458,9 @@ static void irq_unmask(struct irq_desc *desc, uint32_t irq, unsigned int core)
 	irq_base *= IRQSTR_IRQS_PER_LINE;
 	irq += irq_base;
 
+	irqstr_hot_update(container_of(desc, struct irq_cascade_desc, desc),
+			  irq_base / IRQSTR_IRQS_PER_LINE,
+			  irq - irq_base, true);
 	irqstr_unmask_int(irq);
 
 	platform_shared_commit(desc, sizeof(*desc));
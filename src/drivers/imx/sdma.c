@@ -8,12 +8,14 @@
 #include <sof/drivers/sdma.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/cache_batch.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/io.h>
 #include <sof/lib/notifier.h>
 #include <sof/lib/wait.h>
 #include <sof/platform.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -22,7 +24,11 @@
 #define trace_sdma_error(fmt, ...) \
 	trace_error(TRACE_CLASS_DMA, fmt, ##__VA_ARGS__)
 
+#if CONFIG_IMX_DMA_RING
+#define SDMA_BUFFER_PERIOD_COUNT CONFIG_IMX_DMA_RING_PERIODS
+#else
 #define SDMA_BUFFER_PERIOD_COUNT 2
+#endif
 
 struct sdma_bd {
 	/* SDMA BD (buffer descriptor) configuration */
@@ -581,18 +587,29 @@ static int sdma_copy(struct dma_chan_data *channel, int bytes, uint32_t flags)
 	 * will be audible.
 	 */
 	struct sdma_chan *pdata = dma_chan_get_data(channel);
+	struct cache_batch batch;
+	int i;
 
 	tracev_sdma("sdma_copy");
-	for (int i = 0; i < pdata->descriptor_count; i++) {
-		/* Work around the fact that we cannot allocate uncached memory
-		 * on all platforms supporting SDMA.
-		 */
-		dcache_invalidate_region(&pdata->descriptors[i].config,
-					 sizeof(pdata->descriptors[i].config));
+
+	/* Work around the fact that we cannot allocate uncached memory
+	 * on all platforms supporting SDMA. Descriptors are adjacent, so
+	 * their cache lines are maintained at once.
+	 */
+	cache_batch_init(&batch, CACHE_INVALIDATE);
+	for (i = 0; i < pdata->descriptor_count; i++)
+		cache_batch_add(&batch, &pdata->descriptors[i].config,
+				sizeof(pdata->descriptors[i].config));
+	cache_batch_flush(&batch);
+
+	cache_batch_init(&batch, CACHE_WRITEBACK);
+	for (i = 0; i < pdata->descriptor_count; i++) {
 		pdata->descriptors[i].config |= SDMA_BD_DONE;
-		dcache_writeback_region(&pdata->descriptors[i].config,
-					sizeof(pdata->descriptors[i].config));
+		cache_batch_add(&batch, &pdata->descriptors[i].config,
+				sizeof(pdata->descriptors[i].config));
 	}
+	cache_batch_flush(&batch);
+
 	return 0;
 }
 
@@ -632,6 +649,17 @@ static int sdma_status(struct dma_chan_data *channel,
 	return 0;
 }
 
+/* interrupt after every few descriptors and always at the ring end */
+static inline bool sdma_bd_irq(struct dma_sg_config *config, int bd)
+{
+#if CONFIG_IMX_DMA_RING
+	return !((bd + 1) % CONFIG_IMX_DMA_RING_IRQ_PERIODS) ||
+		bd == config->elem_array.count - 1;
+#else
+	return true;
+#endif
+}
+
 static int sdma_set_config(struct dma_chan_data *channel,
 			   struct dma_sg_config *config)
 {
@@ -766,7 +794,7 @@ static int sdma_set_config(struct dma_chan_data *channel,
 		pdata->descriptors[i].config =
 			SDMA_BD_COUNT(config->elem_array.elems[i].size) |
 			SDMA_BD_CMD(SDMA_CMD_XFER_SIZE(width)) | SDMA_BD_CONT;
-		if (!config->irq_disabled)
+		if (!config->irq_disabled && sdma_bd_irq(config, i))
 			pdata->descriptors[i].config |= SDMA_BD_INT;
 		if (dst_may_change) {
 			/* Capture or M2M, enable this descriptor to be
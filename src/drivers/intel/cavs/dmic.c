@@ -34,6 +34,7 @@
 #include <ipc/topology.h>
 #include <user/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -125,16 +126,6 @@ struct pdm_controllers_configuration {
 /* Used in unmute ramp values calculation */
 #define DMIC_HW_FIR_GAIN_MAX ((1 << (DMIC_HW_BITS_FIR_GAIN - 1)) - 1)
 
-/* Hardwired log ramp parameters. The first value is the initial gain in
- * decibels. The second value is the default ramp time.
- */
-#define LOGRAMP_START_DB Q_CONVERT_FLOAT(-90, DB2LIN_FIXED_INPUT_QY)
-#define LOGRAMP_TIME_MS 400 /* Default ramp time in milliseconds */
-
-/* Limits for ramp time from topology */
-#define LOGRAMP_TIME_MIN_MS 10 /* Min. 10 ms */
-#define LOGRAMP_TIME_MAX_MS 1000 /* Max. 1s */
-
 /* Simplify log ramp step calculation equation with this constant term */
 #define LOGRAMP_CONST_TERM ((int32_t) \
 	((int64_t)-LOGRAMP_START_DB * DMIC_UNMUTE_RAMP_US / 1000))
@@ -154,54 +145,30 @@ static const uint32_t coef_base_b[4] = {PDM0_COEFFICIENT_B, PDM1_COEFFICIENT_B,
 static struct sof_ipc_dai_dmic_params *dmic_prm[DMIC_HW_FIFOS];
 static int dmic_active_fifos;
 
-/* this ramps volume changes over time */
-static enum task_state dmic_work(void *data)
+/* Decimators configuration of the last mode search, valid for FIFO
+ * dmic_cfg_di while all FIFOs request the params saved in dmic_cfg_prm.
+ */
+static struct sof_ipc_dai_dmic_params *dmic_cfg_prm;
+static struct dmic_configuration dmic_cfg;
+static int dmic_cfg_di = -1;
+
+/* writes gain of the enabled controllers, optionally unmuting CIC and FIR */
+static void dmic_update_gain(struct dai *dai, int32_t gval, bool unmute_cic,
+			     bool unmute_fir)
 {
-	struct dai *dai = (struct dai *)data;
 	struct dmic_pdata *dmic = dai_get_drvdata(dai);
-	int32_t gval;
 	uint32_t val;
 	int i;
-	int ret;
-
-	dai_dbg(dai, "dmic_work()");
 
-	ret = spin_try_lock(&dai->lock);
-	if (!ret) {
-		platform_shared_commit(dai, sizeof(*dai));
-		dai_dbg(dai, "dmic_work(): spin_try_lock(dai->lock, ret) failed: RESCHEDULE");
-		return SOF_TASK_STATE_RESCHEDULE;
-	}
-
-	/* Increment gain with logarithmic step.
-	 * Gain is Q2.30 and gain modifier is Q12.20.
-	 */
-	dmic->startcount++;
-	dmic->gain = q_multsr_sat_32x32(dmic->gain, dmic->gain_coef,
-					Q_SHIFT_GAIN_X_GAIN_COEF);
-
-	/* Gain is stored as Q2.30, while HW register is Q1.19 so shift
-	 * the value right by 11.
-	 */
-	gval = dmic->gain >> 11;
-
-	/* Note that DMIC gain value zero has a special purpose. Value zero
-	 * sets gain bypass mode in HW. Zero value will be applied after ramp
-	 * is complete. It is because exact 1.0 gain is not possible with Q1.19.
-	 */
-	if (gval > DMIC_HW_FIR_GAIN_MAX)
-		gval = 0;
-
-	/* Write gain to registers */
 	for (i = 0; i < DMIC_HW_CONTROLLERS; i++) {
 		if (!dmic->enable[i])
 			continue;
 
-		if (dmic->startcount == DMIC_UNMUTE_CIC)
+		if (unmute_cic)
 			dai_update_bits(dai, base[i] + CIC_CONTROL,
 					CIC_CONTROL_MIC_MUTE_BIT, 0);
 
-		if (dmic->startcount == DMIC_UNMUTE_FIR) {
+		if (unmute_fir) {
 			switch (dai->index) {
 			case 0:
 				dai_update_bits(dai, base[i] + FIR_CONTROL_A,
@@ -226,6 +193,46 @@ static enum task_state dmic_work(void *data)
 			break;
 		}
 	}
+}
+
+/* this ramps volume changes over time */
+static enum task_state dmic_work(void *data)
+{
+	struct dai *dai = (struct dai *)data;
+	struct dmic_pdata *dmic = dai_get_drvdata(dai);
+	int32_t gval;
+	int ret;
+
+	dai_dbg(dai, "dmic_work()");
+
+	ret = spin_try_lock(&dai->lock);
+	if (!ret) {
+		platform_shared_commit(dai, sizeof(*dai));
+		dai_dbg(dai, "dmic_work(): spin_try_lock(dai->lock, ret) failed: RESCHEDULE");
+		return SOF_TASK_STATE_RESCHEDULE;
+	}
+
+	/* Increment gain with logarithmic step.
+	 * Gain is Q2.30 and gain modifier is Q12.20.
+	 */
+	dmic->startcount++;
+	dmic->gain = q_multsr_sat_32x32(dmic->gain, dmic->gain_coef,
+					Q_SHIFT_GAIN_X_GAIN_COEF);
+
+	/* Gain is stored as Q2.30, while HW register is Q1.19 so shift
+	 * the value right by 11.
+	 */
+	gval = dmic->gain >> 11;
+
+	/* Note that DMIC gain value zero has a special purpose. Value zero
+	 * sets gain bypass mode in HW. Zero value will be applied after ramp
+	 * is complete. It is because exact 1.0 gain is not possible with Q1.19.
+	 */
+	if (gval > DMIC_HW_FIR_GAIN_MAX)
+		gval = 0;
+
+	dmic_update_gain(dai, gval, dmic->startcount == DMIC_UNMUTE_CIC,
+			 dmic->startcount == DMIC_UNMUTE_FIR);
 
 	platform_shared_commit(dai, sizeof(*dai));
 
@@ -1146,13 +1153,13 @@ static int dmic_set_config(struct dai *dai, struct sof_ipc_dai_config *config)
 	 * the active controllers
 	 * "prm" is initialized with default params for all HW controllers
 	 */
+	size = sizeof(struct sof_ipc_dai_dmic_params)
+		+ DMIC_HW_CONTROLLERS * sizeof(struct sof_ipc_dai_dmic_pdm_ctrl);
 	if (!dmic_prm[0]) {
-		size = sizeof(struct sof_ipc_dai_dmic_params)
-			+ DMIC_HW_CONTROLLERS
-			* sizeof(struct sof_ipc_dai_dmic_pdm_ctrl);
+		/* params of all FIFOs followed by the cached search key */
 		dmic_prm[0] = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
 				      SOF_MEM_CAPS_RAM,
-				      DMIC_HW_FIFOS * size);
+				      2 * DMIC_HW_FIFOS * size);
 		if (!dmic_prm[0]) {
 			dai_err(dai, "dmic_set_config(): prm not initialized");
 			return -ENOMEM;
@@ -1160,6 +1167,9 @@ static int dmic_set_config(struct dai *dai, struct sof_ipc_dai_config *config)
 		for (i = 1; i < DMIC_HW_FIFOS; i++)
 			dmic_prm[i] = (struct sof_ipc_dai_dmic_params *)
 				((uint8_t *)dmic_prm[i - 1] + size);
+		dmic_cfg_prm = (struct sof_ipc_dai_dmic_params *)
+			((uint8_t *)dmic_prm[0] + DMIC_HW_FIFOS * size);
+		dmic_cfg_di = -1;
 	}
 
 	/* Copy the new DMIC params to persistent.  The last request
@@ -1204,6 +1214,16 @@ static int dmic_set_config(struct dai *dai, struct sof_ipc_dai_config *config)
 		return -EINVAL;
 	}
 
+	/* The same request is sent again on every resume and capture start,
+	 * reuse the decimators configuration found for it last time.
+	 */
+	if (dmic_cfg_di == di &&
+	    !memcmp(dmic_cfg_prm, dmic_prm[0], DMIC_HW_FIFOS * size)) {
+		dai_info(dai, "dmic_set_config(), cached mode");
+		cfg = dmic_cfg;
+		goto configure;
+	}
+
 	/* Match and select optimal decimators configuration for FIFOs A and B
 	 * paths. This setup phase is still abstract. Successful completion
 	 * points struct cfg to FIR coefficients and contains the scale value
@@ -1229,6 +1249,13 @@ static int dmic_set_config(struct dai *dai, struct sof_ipc_dai_config *config)
 		return -EINVAL;
 	}
 
+	ret = memcpy_s(dmic_cfg_prm, DMIC_HW_FIFOS * size, dmic_prm[0],
+		       DMIC_HW_FIFOS * size);
+	assert(!ret);
+	dmic_cfg = cfg;
+	dmic_cfg_di = di;
+
+configure:
 	dai_info(dai, "dmic_set_config(), cfg clkdiv = %u, mcic = %u",
 		 cfg.clkdiv, cfg.mcic);
 	dai_info(dai, "dmic_set_config(), cfg mfir_a = %u, mfir_b = %u",
@@ -1369,6 +1396,13 @@ static void dmic_start(struct dai *dai)
 
 	dmic_active_fifos++;
 
+#if CONFIG_CAVS_DMIC_SW_RAMP
+	/* The DAI component ramps the captured samples, so unmute at once
+	 * with the HW gain in bypass instead of ramping it from a task.
+	 */
+	dmic_update_gain(dai, 0, true, true);
+#endif
+
 	spin_unlock(&dai->lock);
 
 	/* Currently there's no DMIC HW internal mutings and wait times
@@ -1377,8 +1411,10 @@ static void dmic_start(struct dai *dai)
 	 * is not suppressed by gain ramp somewhere in the capture pipe.
 	 */
 
+#if !CONFIG_CAVS_DMIC_SW_RAMP
 	schedule_task(&dmic->dmicwork, DMIC_UNMUTE_RAMP_US,
 		      DMIC_UNMUTE_RAMP_US);
+#endif
 
 	dai_info(dai, "dmic_start(), done active_fifos = %d",
 		 dmic_active_fifos);
@@ -1610,6 +1646,8 @@ static int dmic_remove(struct dai *dai)
 	rfree(dmic_prm[0]);
 	for (i = 0; i < DMIC_HW_FIFOS; i++)
 		dmic_prm[i] = NULL;
+	dmic_cfg_prm = NULL;
+	dmic_cfg_di = -1;
 
 	return 0;
 }
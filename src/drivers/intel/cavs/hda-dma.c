@@ -135,6 +135,10 @@ struct hda_chan_data {
 	uint32_t period_bytes;
 	uint32_t buffer_bytes;
 
+	uint32_t fpi_batch_bytes;	/* FPI update threshold, 0 every copy */
+	uint32_t fpi_pending;		/* bytes copied but not yet released */
+	bool l1_defer;			/* don't force host DMA L1 exit */
+
 #if HDA_DMA_PTR_DBG
 	struct hda_dbg_data dbg_data;
 #endif
@@ -275,8 +279,10 @@ static int hda_dma_wait_for_buffer_empty(struct dma_chan_data *chan)
 	return 0;
 }
 
-static void hda_dma_post_copy(struct dma_chan_data *chan, int bytes)
+static void hda_dma_post_copy(struct dma_chan_data *chan, int bytes,
+			      uint32_t flags)
 {
+	struct hda_chan_data *hda_chan = dma_chan_get_data(chan);
 	struct dma_cb_data next = {
 		.channel = chan,
 		.elem = { .size = bytes },
@@ -287,13 +293,21 @@ static void hda_dma_post_copy(struct dma_chan_data *chan, int bytes)
 
 	if (chan->direction == DMA_DIR_HMEM_TO_LMEM ||
 	    chan->direction == DMA_DIR_LMEM_TO_HMEM) {
+		/* batched streams release several periods at once */
+		hda_chan->fpi_pending += bytes;
+		if (!(flags & DMA_COPY_BLOCKING) &&
+		    hda_chan->fpi_pending < hda_chan->fpi_batch_bytes)
+			return;
+
 		/* set BFPI to let host gateway know we have read size,
 		 * which will trigger next copy start.
 		 */
-		hda_dma_inc_fp(chan, bytes);
+		hda_dma_inc_fp(chan, hda_chan->fpi_pending);
+		hda_chan->fpi_pending = 0;
 
 		/* Force Host DMA to exit L1 */
-		pm_runtime_put(PM_RUNTIME_HOST_DMA_L1, 0);
+		if (!hda_chan->l1_defer)
+			pm_runtime_put(PM_RUNTIME_HOST_DMA_L1, 0);
 	} else {
 		/*
 		 * set BFPI to let link gateway know we have read size,
@@ -312,7 +326,7 @@ static int hda_dma_link_copy_ch(struct dma_chan_data *chan, int bytes)
 
 	hda_dma_get_dbg_vals(chan, HDA_DBG_PRE, HDA_DBG_LINK);
 
-	hda_dma_post_copy(chan, bytes);
+	hda_dma_post_copy(chan, bytes, 0);
 
 	hda_dma_get_dbg_vals(chan, HDA_DBG_POST, HDA_DBG_LINK);
 	hda_dma_ptr_trace(chan, "link copy", HDA_DBG_LINK);
@@ -381,7 +395,7 @@ static int hda_dma_host_copy(struct dma_chan_data *channel, int bytes,
 			return ret;
 	}
 
-	hda_dma_post_copy(channel, bytes);
+	hda_dma_post_copy(channel, bytes, flags);
 
 	hda_dma_get_dbg_vals(channel, HDA_DBG_POST, HDA_DBG_HOST);
 	hda_dma_ptr_trace(channel, "host copy", HDA_DBG_HOST);
@@ -564,6 +578,30 @@ static int hda_dma_status(struct dma_chan_data *channel,
 	return 0;
 }
 
+/* apply host stream policy of burst threshold, FPI batching and L1 exit */
+static uint32_t hda_dma_host_policy(struct hda_chan_data *hda_chan,
+				    struct dma_sg_config *config)
+{
+	uint32_t periods = config->elem_array.count;
+	uint32_t burst = SOF_HDA_DMAC_BURST(config->dmac_config);
+	uint32_t batch = SOF_HDA_DMAC_FPI_BATCH(config->dmac_config);
+
+	/* gateway needs free space left, so keep one period unreleased */
+	if (batch >= periods)
+		batch = periods - 1;
+	hda_chan->fpi_batch_bytes = batch > 1 ?
+		batch * hda_chan->period_bytes : 0;
+	hda_chan->fpi_pending = 0;
+	hda_chan->l1_defer = !!(config->dmac_config & SOF_HDA_DMAC_L1_DEFER);
+
+	/* whole buffer by default, which gives the largest bursts */
+	if (!burst || burst > periods)
+		burst = periods;
+
+	return ALIGN_UP(burst * hda_chan->period_bytes,
+			HDA_DMA_BUFFER_ALIGNMENT);
+}
+
 /* set the DMA channel configuration, source/target address, buffer sizes */
 static int hda_dma_set_config(struct dma_chan_data *channel,
 			      struct dma_sg_config *config)
@@ -659,6 +697,9 @@ static int hda_dma_set_config(struct dma_chan_data *channel,
 	hda_chan = dma_chan_get_data(channel);
 	hda_chan->period_bytes = period_bytes;
 	hda_chan->buffer_bytes = buffer_bytes;
+	hda_chan->fpi_batch_bytes = 0;
+	hda_chan->fpi_pending = 0;
+	hda_chan->l1_defer = false;
 
 	/* init channel in HW */
 	dma_chan_reg_write(channel, DGBBA, buffer_addr);
@@ -667,8 +708,7 @@ static int hda_dma_set_config(struct dma_chan_data *channel,
 	if (config->direction == DMA_DIR_LMEM_TO_HMEM ||
 	    config->direction == DMA_DIR_HMEM_TO_LMEM)
 		dma_chan_reg_write(channel, DGMBS,
-				   ALIGN_UP(buffer_bytes,
-					    HDA_DMA_BUFFER_ALIGNMENT));
+				   hda_dma_host_policy(hda_chan, config));
 
 	/* firmware control buffer */
 	dgcs = DGCS_FWCB;
@@ -848,6 +888,7 @@ static int hda_dma_free_data_size(struct dma_chan_data *chan)
 static int hda_dma_data_size(struct dma_chan_data *channel,
 			     uint32_t *avail, uint32_t *free)
 {
+	struct hda_chan_data *hda_chan = dma_chan_get_data(channel);
 	uint32_t flags;
 	int ret = 0;
 
@@ -866,6 +907,12 @@ static int hda_dma_data_size(struct dma_chan_data *channel,
 	else
 		*free = hda_dma_free_data_size(channel);
 
+	/* bytes waiting for batched FPI update are already copied */
+	if (channel->direction == DMA_DIR_HMEM_TO_LMEM)
+		*avail -= hda_chan->fpi_pending;
+	else if (channel->direction == DMA_DIR_LMEM_TO_HMEM)
+		*free -= hda_chan->fpi_pending;
+
 unlock:
 	irq_local_enable(flags);
 
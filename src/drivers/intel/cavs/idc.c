@@ -6,6 +6,7 @@
 
 #include <sof/audio/component_ext.h>
 #include <sof/audio/pipeline.h>
+#include <sof/bit.h>
 #include <sof/debug/panic.h>
 #include <sof/drivers/idc.h>
 #include <sof/drivers/interrupt.h>
@@ -38,6 +39,10 @@
 /** \brief IDC message payload per core. */
 static SHARED_DATA struct idc_payload payload[PLATFORM_CORE_COUNT];
 
+/** \brief IDC message queues per source and target core. */
+static SHARED_DATA struct idc_queue
+	queue[PLATFORM_CORE_COUNT][PLATFORM_CORE_COUNT];
+
 /* b90f5a4e-5537-4375-a1df-95485472ff9e */
 DECLARE_SOF_UUID("comp-task", idc_comp_task_uuid, 0xb90f5a4e, 0x5537, 0x4375,
 		 0xa1, 0xdf, 0x95, 0x48, 0x54, 0x72, 0xff, 0x9e);
@@ -197,6 +202,213 @@ static int idc_wait_in_blocking_mode(uint32_t target_core, bool (*cond)(int))
 	return 0;
 }
 
+/**
+ * \brief Checks whether the last doorbell to target core has been handled.
+ * \param[in] target_core Id of the core receiving the message.
+ * \return True if doorbell registers can be written, false otherwise.
+ */
+static bool idc_is_free(int target_core)
+{
+	return !(idc_read(IPC_IDCITC(target_core), cpu_get_id()) &
+		 IPC_IDCITC_BUSY);
+}
+
+/**
+ * \brief Rings the doorbell of target core.
+ * \param[in] target_core Id of the core receiving the message.
+ * \param[in] header Message header.
+ * \param[in] extension Message extension.
+ */
+static void idc_doorbell(uint32_t target_core, uint32_t header,
+			 uint32_t extension)
+{
+	int core = cpu_get_id();
+
+	idc_write(IPC_IDCIETC(target_core), core, extension);
+	idc_write(IPC_IDCITC(target_core), core, header | IPC_IDCITC_BUSY);
+}
+
+/**
+ * \brief Completes messages already executed by target core.
+ *
+ * Completion callbacks are called with local interrupts disabled.
+ * \param[in] target_core Id of the core receiving the messages.
+ */
+static void idc_queue_reap(int target_core)
+{
+	struct idc *idc = *idc_get();
+	struct idc_queue *queue = idc_queue_get(idc, cpu_get_id(),
+						target_core);
+	struct idc_completion *completion;
+	uint32_t flags;
+	uint32_t slot;
+	int status;
+
+	irq_local_disable(flags);
+
+	while (idc->reaped[target_core] != queue->tail) {
+		slot = idc->reaped[target_core] % IDC_QUEUE_SIZE;
+		status = queue->msg[slot].status;
+
+		/* remember the first error till idc_wait_async() */
+		if (status < 0 && !idc->async_status[target_core])
+			idc->async_status[target_core] = status;
+
+		completion = &idc->completion[target_core][slot];
+		if (completion->cb)
+			completion->cb(completion->data, status);
+
+		if (completion->payload) {
+			rfree(completion->payload);
+			completion->payload = NULL;
+		}
+
+		idc->reaped[target_core]++;
+	}
+
+	irq_local_enable(flags);
+}
+
+/**
+ * \brief Checks whether message can be queued to target core.
+ * \param[in] target_core Id of the core receiving the message.
+ * \return True if there is space in the queue, false otherwise.
+ */
+static bool idc_queue_has_space(int target_core)
+{
+	struct idc *idc = *idc_get();
+	struct idc_queue *queue = idc_queue_get(idc, cpu_get_id(),
+						target_core);
+
+	idc_queue_reap(target_core);
+
+	return queue->head - idc->reaped[target_core] < IDC_QUEUE_SIZE;
+}
+
+/**
+ * \brief Checks whether all messages queued to target core are completed.
+ * \param[in] target_core Id of the core receiving the messages.
+ * \return True if nothing is pending, false otherwise.
+ */
+static bool idc_queue_is_idle(int target_core)
+{
+	struct idc *idc = *idc_get();
+	struct idc_queue *queue = idc_queue_get(idc, cpu_get_id(),
+						target_core);
+
+	idc_queue_reap(target_core);
+
+	return queue->head == idc->reaped[target_core];
+}
+
+/**
+ * \brief Queues IDC message without waiting for its execution.
+ *
+ * Message is added to the queue of source and target core pair. Doorbell
+ * is rung only if the target isn't already handling one, otherwise it will
+ * drain the queue on its own, so a batch of messages costs one interrupt.
+ * Payload not fitting inline is copied to the shared heap until the
+ * message is completed.
+ * \param[in,out] msg Pointer to IDC message.
+ * \return Error code.
+ */
+static int idc_send_msg_async(struct idc_msg *msg)
+{
+	struct idc *idc = *idc_get();
+	struct idc_queue *queue = idc_queue_get(idc, cpu_get_id(), msg->core);
+	struct idc_queue_msg *entry;
+	struct idc_completion *completion;
+	void *ext_payload = NULL;
+	uint32_t flags;
+	uint32_t slot;
+	int ret;
+
+	if (msg->size > IDC_MAX_PAYLOAD_SIZE)
+		return -EINVAL;
+
+	if (msg->size > IDC_QUEUE_PAYLOAD_SIZE) {
+		ext_payload = rmalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+				      SOF_MEM_CAPS_RAM, msg->size);
+		if (!ext_payload)
+			return -ENOMEM;
+
+		ret = memcpy_s(ext_payload, msg->size, msg->payload,
+			       msg->size);
+		assert(!ret);
+	}
+
+	/* queue can be also used from interrupt context */
+	for (;;) {
+		ret = idc_wait_in_blocking_mode(msg->core, idc_queue_has_space);
+		if (ret < 0) {
+			rfree(ext_payload);
+			return ret;
+		}
+
+		irq_local_disable(flags);
+		if (queue->head - idc->reaped[msg->core] < IDC_QUEUE_SIZE)
+			break;
+		irq_local_enable(flags);
+	}
+
+	slot = queue->head % IDC_QUEUE_SIZE;
+	entry = &queue->msg[slot];
+	entry->header = msg->header;
+	entry->extension = msg->extension;
+	entry->size = msg->size;
+	entry->status = 0;
+	entry->ext_payload = ext_payload;
+	if (msg->size && !ext_payload) {
+		ret = memcpy_s(entry->data, sizeof(entry->data),
+			       msg->payload, msg->size);
+		assert(!ret);
+	}
+
+	completion = &idc->completion[msg->core][slot];
+	completion->cb = msg->complete;
+	completion->data = msg->complete_data;
+	completion->payload = ext_payload;
+
+	queue->head++;
+
+	/* busy target processes the queue again after clearing BUSY */
+	if (idc_is_free(msg->core))
+		idc_doorbell(msg->core, IDC_MSG_QUEUE, IDC_MSG_QUEUE_EXT);
+
+	irq_local_enable(flags);
+
+	return 0;
+}
+
+/**
+ * \brief Waits for all asynchronous messages sent to selected cores.
+ * \param[in] core_mask Mask of target cores.
+ * \return First error returned by any of the messages or wait timeout.
+ */
+int idc_wait_async(uint32_t core_mask)
+{
+	struct idc *idc = *idc_get();
+	int core = cpu_get_id();
+	int ret = 0;
+	int err;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (i == core || !(core_mask & BIT(i)))
+			continue;
+
+		err = idc_wait_in_blocking_mode(i, idc_queue_is_idle);
+		if (!err)
+			err = idc->async_status[i];
+		idc->async_status[i] = 0;
+
+		if (!ret)
+			ret = err;
+	}
+
+	return ret;
+}
+
 /**
  * \brief Sends IDC message.
  * \param[in,out] msg Pointer to IDC message.
@@ -209,10 +421,32 @@ int idc_send_msg(struct idc_msg *msg, uint32_t mode)
 	struct idc_payload *payload = idc_payload_get(idc, msg->core);
 	int core = cpu_get_id();
 	uint32_t idcietc;
+	uint32_t flags;
 	int ret = 0;
 
 	tracev_idc("arch_idc_send_msg()");
 
+	/* gated core can only be woken up by IDC, so ungate it first */
+	cpu_wake_core(msg->core);
+
+	if (mode == IDC_ASYNC)
+		return idc_send_msg_async(msg);
+
+	/* wait for queued messages doorbell to be handled */
+	for (;;) {
+		if (mode != IDC_POWER_UP) {
+			ret = idc_wait_in_blocking_mode(msg->core,
+							idc_is_free);
+			if (ret < 0)
+				return ret;
+		}
+
+		irq_local_disable(flags);
+		if (mode == IDC_POWER_UP || idc_is_free(msg->core))
+			break;
+		irq_local_enable(flags);
+	}
+
 	/* clear any previous messages */
 	idcietc = idc_read(IPC_IDCIETC(msg->core), core);
 	if (idcietc & IPC_IDCIETC_DONE)
@@ -226,8 +460,9 @@ int idc_send_msg(struct idc_msg *msg, uint32_t mode)
 		platform_shared_commit(payload, sizeof(*payload));
 	}
 
-	idc_write(IPC_IDCIETC(msg->core), core, msg->extension);
-	idc_write(IPC_IDCITC(msg->core), core, msg->header | IPC_IDCITC_BUSY);
+	idc_doorbell(msg->core, msg->header, msg->extension);
+
+	irq_local_enable(flags);
 
 	switch (mode) {
 	case IDC_BLOCKING:
@@ -252,28 +487,26 @@ int idc_send_msg(struct idc_msg *msg, uint32_t mode)
 
 /**
  * \brief Executes IDC IPC processing message.
+ * \return Error code the host is replied with.
  */
-static void idc_ipc(void)
+static int idc_ipc(void)
 {
 	struct ipc *ipc = ipc_get();
 	struct sof_ipc_cmd_hdr *hdr = ipc->comp_data;
 
-	ipc_cmd(hdr);
+	return ipc_cmd(hdr);
 }
 
 /**
  * \brief Executes IDC component params message.
  * \param[in] comp_id Component id to have params set.
+ * \param[in] params Stream parameters.
  * \return Error code.
  */
-static int idc_params(uint32_t comp_id)
+static int idc_params(uint32_t comp_id, struct sof_ipc_stream_params *params)
 {
 	struct ipc *ipc = ipc_get();
 	struct ipc_comp_dev *ipc_dev;
-	struct idc *idc = *idc_get();
-	struct idc_payload *payload = idc_payload_get(idc, cpu_get_id());
-	struct sof_ipc_stream_params *params =
-		(struct sof_ipc_stream_params *)payload;
 	int ret;
 
 	ipc_dev = ipc_get_comp_by_id(ipc, comp_id);
@@ -282,7 +515,6 @@ static int idc_params(uint32_t comp_id)
 
 	ret = comp_params(ipc_dev->cd, params);
 
-	platform_shared_commit(payload, sizeof(*payload));
 	platform_shared_commit(ipc_dev, sizeof(*ipc_dev));
 	platform_shared_commit(ipc, sizeof(*ipc));
 
@@ -349,15 +581,13 @@ out:
 /**
  * \brief Executes IDC component trigger message.
  * \param[in] comp_id Component id to be triggered.
+ * \param[in] cmd Trigger command.
  * \return Error code.
  */
-static int idc_trigger(uint32_t comp_id)
+static int idc_trigger(uint32_t comp_id, uint32_t cmd)
 {
 	struct ipc *ipc = ipc_get();
 	struct ipc_comp_dev *ipc_dev;
-	struct idc *idc = *idc_get();
-	struct idc_payload *payload = idc_payload_get(idc, cpu_get_id());
-	uint32_t cmd = *(uint32_t *)payload;
 	int ret;
 
 	ipc_dev = ipc_get_comp_by_id(ipc, comp_id);
@@ -382,7 +612,6 @@ static int idc_trigger(uint32_t comp_id)
 	}
 
 out:
-	platform_shared_commit(payload, sizeof(*payload));
 	platform_shared_commit(ipc_dev->cd, sizeof(*ipc_dev->cd));
 	platform_shared_commit(ipc_dev, sizeof(*ipc_dev));
 	platform_shared_commit(ipc, sizeof(*ipc));
@@ -413,11 +642,38 @@ static int idc_reset(uint32_t comp_id)
 	return ret;
 }
 
+/**
+ * \brief Executes IDC component channel split message.
+ * \param[in] comp_id Component id to be processed.
+ * \param[in] part Index of the channel range to process.
+ * \return Error code.
+ */
+static int idc_split(uint32_t comp_id, uint32_t part)
+{
+	struct ipc *ipc = ipc_get();
+	struct ipc_comp_dev *ipc_dev;
+	int ret;
+
+	ipc_dev = ipc_get_comp_by_id(ipc, comp_id);
+	if (!ipc_dev)
+		return -ENODEV;
+
+	ret = comp_split_run(ipc_dev->cd, part);
+
+	platform_shared_commit(ipc_dev, sizeof(*ipc_dev));
+	platform_shared_commit(ipc, sizeof(*ipc));
+
+	return ret;
+}
+
+static void idc_queue_process(uint32_t source_core);
+
 /**
  * \brief Executes IDC message based on type.
  * \param[in,out] msg Pointer to IDC message.
+ * \return Error code.
  */
-static void idc_cmd(struct idc_msg *msg)
+static int idc_cmd(struct idc_msg *msg)
 {
 	uint32_t type = iTS(msg->header);
 	int ret = 0;
@@ -430,26 +686,69 @@ static void idc_cmd(struct idc_msg *msg)
 		notifier_notify_remote();
 		break;
 	case iTS(IDC_MSG_IPC):
-		idc_ipc();
+		ret = idc_ipc();
 		break;
 	case iTS(IDC_MSG_PARAMS):
-		ret = idc_params(msg->extension);
+		ret = idc_params(msg->extension, msg->payload);
 		break;
 	case iTS(IDC_MSG_PREPARE):
 		ret = idc_prepare(msg->extension);
 		break;
 	case iTS(IDC_MSG_TRIGGER):
-		ret = idc_trigger(msg->extension);
+		ret = idc_trigger(msg->extension, *(uint32_t *)msg->payload);
 		break;
 	case iTS(IDC_MSG_RESET):
 		ret = idc_reset(msg->extension);
 		break;
+	case iTS(IDC_MSG_QUEUE):
+		idc_queue_process(msg->core);
+		break;
+	case iTS(IDC_MSG_SPLIT):
+		ret = idc_split(msg->extension, *(uint32_t *)msg->payload);
+		break;
+	case iTS(IDC_MSG_EDF_STEAL):
+		schedule_edf_steal();
+		break;
 	default:
 		trace_idc_error("idc_cmd(): invalid msg->header = %u",
 				msg->header);
+		ret = -EINVAL;
 	}
 
-	idc_msg_status_set(ret, cpu_get_id());
+	return ret;
+}
+
+/**
+ * \brief Executes all messages queued by source core.
+ * \param[in] source_core Id of the core sending the messages.
+ */
+static void idc_queue_process(uint32_t source_core)
+{
+	struct idc *idc = *idc_get();
+	struct idc_queue *queue = idc_queue_get(idc, source_core,
+						cpu_get_id());
+	struct idc_queue_msg *entry;
+	struct idc_msg msg;
+
+	while (queue->tail != queue->head) {
+		entry = &queue->msg[queue->tail % IDC_QUEUE_SIZE];
+
+		msg.header = entry->header;
+		msg.extension = entry->extension;
+		msg.core = source_core;
+		msg.size = entry->size;
+		msg.payload = entry->ext_payload ? entry->ext_payload :
+			entry->data;
+
+		/* queue doorbell can't be queued itself */
+		if (iTS(msg.header) == iTS(IDC_MSG_QUEUE))
+			entry->status = -EINVAL;
+		else
+			entry->status = idc_cmd(&msg);
+
+		/* status has to be visible before the slot is released */
+		queue->tail++;
+	}
 }
 
 /**
@@ -459,12 +758,22 @@ static void idc_cmd(struct idc_msg *msg)
 static enum task_state idc_do_cmd(void *data)
 {
 	struct idc *idc = data;
+	struct idc_payload *payload;
 	int core = cpu_get_id();
 	int initiator = idc->received_msg.core;
+	int ret;
 
 	trace_idc("idc_do_cmd()");
 
-	idc_cmd(&idc->received_msg);
+	payload = idc_payload_get(idc, core);
+	idc->received_msg.payload = payload;
+
+	ret = idc_cmd(&idc->received_msg);
+
+	if (iTS(idc->received_msg.header) != iTS(IDC_MSG_QUEUE))
+		idc_msg_status_set(ret, core);
+
+	platform_shared_commit(payload, sizeof(*payload));
 
 	/* clear BUSY bit */
 	idc_write(IPC_IDCTFC(initiator), core,
@@ -473,6 +782,9 @@ static enum task_state idc_do_cmd(void *data)
 	/* enable BUSY interrupt */
 	idc_write(IPC_IDCCTL, core, idc->busy_bit_mask);
 
+	/* messages queued while BUSY was set didn't ring the doorbell */
+	idc_queue_process(initiator);
+
 	return SOF_TASK_STATE_COMPLETED;
 }
 
@@ -499,8 +811,10 @@ static uint32_t idc_get_busy_bit_mask(int core)
  */
 int idc_init(void)
 {
+	struct idc_queue *q;
 	int core = cpu_get_id();
 	int ret;
+	int i;
 	struct task_ops ops = {
 		.run = idc_do_cmd,
 		.get_deadline = ipc_task_deadline,
@@ -513,6 +827,18 @@ int idc_init(void)
 	*idc = rzalloc(SOF_MEM_ZONE_SYS, 0, SOF_MEM_CAPS_RAM, sizeof(**idc));
 	(*idc)->busy_bit_mask = idc_get_busy_bit_mask(core);
 	(*idc)->payload = cache_to_uncache((struct idc_payload *)payload);
+	(*idc)->queue = cache_to_uncache((struct idc_queue *)queue);
+
+	/* drop anything left in the queues since the core was powered down */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (i == core)
+			continue;
+
+		q = idc_queue_get(*idc, i, core);
+		q->tail = q->head;
+
+		(*idc)->reaped[i] = idc_queue_get(*idc, core, i)->head;
+	}
 
 	/* process task */
 	schedule_task_init_edf(&(*idc)->idc_task, SOF_UUID(idc_cmd_task_uuid),
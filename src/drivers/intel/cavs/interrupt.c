@@ -79,7 +79,7 @@ static inline void irq_lvl2_handler(void *data, int level, uint32_t ilxsd,
 			if (child->handler && (child->cpu_mask & 1 << core)) {
 				/* run handler in non atomic context */
 				spin_unlock(&cascade->lock);
-				child->handler(child->handler_arg);
+				interrupt_desc_run(child, core);
 				spin_lock(&cascade->lock);
 
 				handled = true;
@@ -60,6 +60,30 @@ static inline void increment_ipc_processed_counter(void)
 }
 #endif
 
+#if CONFIG_CAVS_IPC_FAST_PATH
+/* runs latency critical commands without waiting for the IPC task */
+static bool ipc_platform_fast_cmd(struct ipc *ipc)
+{
+#if CAVS_VERSION >= CAVS_VERSION_1_8
+	/* compact cAVS module messages always go to the task */
+	if (ipc_read(IPC_DIPCTDR) & CAVS_IPC_MSG_TGT)
+		return false;
+#endif
+
+	if (!ipc_cmd_fast())
+		return false;
+
+	ipc_platform_complete_cmd(ipc);
+
+	return true;
+}
+#else
+static inline bool ipc_platform_fast_cmd(struct ipc *ipc)
+{
+	return false;
+}
+#endif
+
 /* test code to check working IRQ */
 static void ipc_irq_handler(void *arg)
 {
@@ -102,7 +126,8 @@ static void ipc_irq_handler(void *arg)
 		increment_ipc_received_counter();
 #endif
 
-		ipc_schedule_process(ipc);
+		if (!ipc_platform_fast_cmd(ipc))
+			ipc_schedule_process(ipc);
 	}
 
 	/* reply message(done) from host */
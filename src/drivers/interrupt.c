@@ -7,6 +7,7 @@
 
 #include <sof/common.h>
 #include <sof/drivers/interrupt.h>
+#include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/memory.h>
@@ -15,12 +16,150 @@
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
 #include <ipc/topology.h>
+#include <ipc/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 static SHARED_DATA struct cascade_root cascade_root;
 
+#if CONFIG_IRQ_STATS
+/* DSP internal interrupt handler of a core, called through the accounting */
+struct irq_direct {
+	void (*handler)(void *arg);
+	void *arg;
+	struct irq_stats stats;
+};
+
+static SHARED_DATA struct irq_direct
+	irq_direct[PLATFORM_CORE_COUNT][PLATFORM_IRQ_HW_NUM];
+
+/* cycles include interrupts of higher levels nested in the handler */
+static void irq_stats_run(struct irq_stats *stats,
+			  void (*handler)(void *arg), void *arg)
+{
+	uint32_t start = arch_timer_get_cycles();
+	uint32_t cycles;
+
+	handler(arg);
+
+	cycles = arch_timer_get_cycles() - start;
+	stats->count++;
+	stats->cycles += cycles;
+	if (cycles > stats->cycles_max)
+		stats->cycles_max = cycles;
+}
+
+void interrupt_desc_run(struct irq_desc *desc, int core)
+{
+	irq_stats_run(&desc->stats[core], desc->handler, desc->handler_arg);
+}
+
+static void irq_direct_run(void *data)
+{
+	struct irq_direct *direct = data;
+
+	irq_stats_run(&direct->stats, direct->handler, direct->arg);
+}
+
+static int irq_direct_register(uint32_t irq, void (*handler)(void *arg),
+			       void *arg)
+{
+	struct irq_direct *direct;
+
+	direct = platform_shared_get(&irq_direct[cpu_get_id()][irq],
+				     sizeof(*direct));
+	direct->handler = handler;
+	direct->arg = arg;
+
+	return arch_interrupt_register(irq, irq_direct_run, direct);
+}
+
+/* adds accounting of an interrupt that has run to the reply */
+static void irq_stats_elem_add(struct sof_ipc_dbg_irq_stats *info,
+			       uint32_t max_size, uint32_t irq,
+			       struct irq_stats *stats, bool reset)
+{
+	struct sof_ipc_dbg_irq_elem *elem = &info->elems[info->num_elems];
+
+	if (!stats->count)
+		return;
+
+	info->total_elems++;
+
+	if (info->rhdr.hdr.size + sizeof(*elem) <= max_size) {
+		elem->irq = irq;
+		elem->count = stats->count;
+		elem->cycles = stats->cycles;
+		elem->cycles_max = stats->cycles_max;
+		elem->reserved = 0;
+		info->num_elems++;
+		info->rhdr.hdr.size += sizeof(*elem);
+	}
+
+	if (reset) {
+		stats->count = 0;
+		stats->cycles = 0;
+		stats->cycles_max = 0;
+	}
+}
+
+int interrupt_stats_get(struct sof_ipc_dbg_irq_stats *info,
+			uint32_t max_size, int core, bool reset)
+{
+	struct cascade_root *root = cascade_root_get();
+	struct irq_cascade_desc *cascade;
+	struct irq_direct *direct;
+	struct irq_desc *child;
+	struct list_item *clist;
+	unsigned long flags;
+	int i;
+
+	if (core < 0 || core >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	info->rhdr.hdr.size = sizeof(*info);
+	info->core = core;
+	info->num_elems = 0;
+	info->total_elems = 0;
+
+	for (i = 0; i < PLATFORM_IRQ_HW_NUM; i++) {
+		direct = platform_shared_get(&irq_direct[core][i],
+					     sizeof(*direct));
+		irq_stats_elem_add(info, max_size, i, &direct->stats, reset);
+	}
+
+	/* cascades are only ever added, so the list is walked unlocked */
+	spin_lock_irq(&root->lock, flags);
+	cascade = root->list;
+	spin_unlock_irq(&root->lock, flags);
+
+	for (; cascade; cascade = cascade->next) {
+		spin_lock_irq(&cascade->lock, flags);
+
+		for (i = 0; i < PLATFORM_IRQ_CHILDREN; i++) {
+			list_for_item(clist, &cascade->child[i].list) {
+				child = container_of(clist, struct irq_desc,
+						     irq_list);
+				irq_stats_elem_add(info, max_size, child->irq,
+						   &child->stats[core], reset);
+			}
+		}
+
+		spin_unlock_irq(&cascade->lock, flags);
+	}
+
+	return 0;
+}
+#else
+static int irq_direct_register(uint32_t irq, void (*handler)(void *arg),
+			       void *arg)
+{
+	return arch_interrupt_register(irq, handler, arg);
+}
+#endif
+
 static int interrupt_register_internal(uint32_t irq, void (*handler)(void *arg),
 				       void *arg, struct irq_desc *desc);
 static void interrupt_unregister_internal(uint32_t irq, const void *arg,
@@ -381,7 +520,7 @@ static int interrupt_register_internal(uint32_t irq, void (*handler)(void *arg),
 	/* no parent means we are registering DSP internal IRQ */
 	cascade = interrupt_get_parent(irq);
 	if (!cascade)
-		return arch_interrupt_register(irq, handler, arg);
+		return irq_direct_register(irq, handler, arg);
 
 	spin_lock_irq(&cascade->lock, flags);
 	ret = irq_register_child(cascade, irq, handler, arg, desc);
@@ -95,6 +95,8 @@ enum sof_ipc_ctrl_cmd {
 	SOF_CTRL_CMD_ENUM,	/**< maps to ALSA enum style controls */
 	SOF_CTRL_CMD_SWITCH,	/**< maps to ALSA switch style controls */
 	SOF_CTRL_CMD_BINARY,	/**< maps to ALSA binary style controls */
+	SOF_CTRL_CMD_QUALITY,	/**< processing quality level of component */
+	SOF_CTRL_CMD_LEVEL,	/**< read only peak and RMS of channels */
 };
 
 /** Generic channel mapped value data. */
@@ -126,7 +128,10 @@ struct sof_ipc_ctrl_data {
 	uint32_t cmd;		/**< enum sof_ipc_ctrl_cmd */
 	uint32_t index;		/**< control index for comps > 1 control */
 
-	/* control data - can either be appended or DMAed from host */
+	/* control data - can either be appended or DMAed from host, a
+	 * SET_DATA or GET_DATA blob is DMAed as one message when buffer
+	 * size is set
+	 */
 	struct sof_ipc_host_buffer buffer;
 	uint32_t num_elems;	/**< in array elems or bytes for data type */
 	uint32_t elems_remaining;	/**< elems remaining if sent in parts */
@@ -153,8 +158,25 @@ enum sof_ipc_ctrl_event_type {
 	SOF_CTRL_EVENT_GENERIC_METADATA,	/**< generic event with metadata */
 	SOF_CTRL_EVENT_KD,	/**< keyword detection event */
 	SOF_CTRL_EVENT_VAD,	/**< voice activity detection event */
+	SOF_CTRL_EVENT_MCPS_BUDGET,	/**< pipeline over its cycles budget */
 };
 
+/**
+ * Control updates of components on one core, applied together between two
+ * runs of their pipelines. The elements are sof_ipc_ctrl_data of the SET
+ * types in single messages, each padded to 4 bytes. They follow the header,
+ * or are copied from host pages when buffer size is set.
+ */
+struct sof_ipc_ctrl_batch {
+	struct sof_ipc_cmd_hdr hdr;
+	struct sof_ipc_host_buffer buffer;
+	uint32_t num_elems;	/**< control updates */
+	uint32_t size;		/**< bytes of the elements */
+
+	/* reserved for future use */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
 /**
  * Generic notification data.
  */
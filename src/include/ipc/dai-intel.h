@@ -95,13 +95,23 @@ struct sof_ipc_dai_hda_params {
 	uint32_t link_dma_ch;
 } __attribute__((packed));
 
+/* Max ALH streams aggregated into one DAI */
+#define SOF_DAI_ALH_MAX_STREAMS		8
+
 /* ALH Configuration Request - SOF_IPC_DAI_ALH_CONFIG */
 struct sof_ipc_dai_alh_params {
 	uint32_t reserved0;
 	uint32_t stream_id;
 
+	/* When num_streams is above 1 the DAI drives all stream_ids in
+	 * lockstep, each carrying an equal share of the stream channels in
+	 * stream_ids order. stream_id must equal stream_ids[0].
+	 */
+	uint32_t num_streams;
+	uint32_t stream_ids[SOF_DAI_ALH_MAX_STREAMS];
+
 	/* reserved for future use */
-	uint32_t reserved[15];
+	uint32_t reserved[6];
 } __attribute__((packed));
 
 /* DMIC Configuration Request - SOF_IPC_DAI_DMIC_CONFIG */
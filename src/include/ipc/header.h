@@ -89,6 +89,8 @@
 #define SOF_IPC_TPLG_PIPE_COMPLETE		SOF_CMD_TYPE(0x013)
 #define SOF_IPC_TPLG_BUFFER_NEW			SOF_CMD_TYPE(0x020)
 #define SOF_IPC_TPLG_BUFFER_FREE		SOF_CMD_TYPE(0x021)
+#define SOF_IPC_TPLG_IMAGE_LOAD			SOF_CMD_TYPE(0x030)
+#define SOF_IPC_TPLG_LIB_LOAD			SOF_CMD_TYPE(0x031)
 
 /** @} */
 
@@ -116,6 +118,7 @@
 #define SOF_IPC_COMP_SET_DATA			SOF_CMD_TYPE(0x003)
 #define SOF_IPC_COMP_GET_DATA			SOF_CMD_TYPE(0x004)
 #define SOF_IPC_COMP_NOTIFICATION		SOF_CMD_TYPE(0x005)
+#define SOF_IPC_COMP_SET_BATCH			SOF_CMD_TYPE(0x006)
 
 /** @} */
 
@@ -140,6 +143,9 @@
 #define SOF_IPC_STREAM_TRIG_DRAIN		SOF_CMD_TYPE(0x008)
 #define SOF_IPC_STREAM_TRIG_XRUN		SOF_CMD_TYPE(0x009)
 #define SOF_IPC_STREAM_POSITION			SOF_CMD_TYPE(0x00a)
+#define SOF_IPC_STREAM_TRIG_GROUP_START		SOF_CMD_TYPE(0x00b)
+#define SOF_IPC_STREAM_TRIG_GROUP_STOP		SOF_CMD_TYPE(0x00c)
+#define SOF_IPC_STREAM_PCM_RECONFIG		SOF_CMD_TYPE(0x00d)
 #define SOF_IPC_STREAM_VORBIS_PARAMS		SOF_CMD_TYPE(0x010)
 #define SOF_IPC_STREAM_VORBIS_FREE		SOF_CMD_TYPE(0x011)
 
@@ -152,6 +158,17 @@
 #define SOF_IPC_TRACE_DMA_PARAMS		SOF_CMD_TYPE(0x001)
 #define SOF_IPC_TRACE_DMA_POSITION		SOF_CMD_TYPE(0x002)
 #define SOF_IPC_TRACE_DMA_PARAMS_EXT		SOF_CMD_TYPE(0x003)
+#define SOF_IPC_TRACE_HEAP_INFO			SOF_CMD_TYPE(0x004)
+#define SOF_IPC_TRACE_COMP_PERF_INFO		SOF_CMD_TYPE(0x005)
+#define SOF_IPC_TRACE_LL_STATS			SOF_CMD_TYPE(0x006)
+#define SOF_IPC_TRACE_FILTER_UPDATE		SOF_CMD_TYPE(0x007)
+#define SOF_IPC_TRACE_STACK_INFO		SOF_CMD_TYPE(0x008)
+#define SOF_IPC_TRACE_LOCK_STATS		SOF_CMD_TYPE(0x009)
+#define SOF_IPC_TRACE_IRQ_STATS			SOF_CMD_TYPE(0x00A)
+#define SOF_IPC_TRACE_MEM_OWNER_INFO		SOF_CMD_TYPE(0x00B)
+#define SOF_IPC_TRACE_LATENCY			SOF_CMD_TYPE(0x00C)
+#define SOF_IPC_TRACE_IDLE_STATS		SOF_CMD_TYPE(0x00D)
+#define SOF_IPC_TRACE_SESSION			SOF_CMD_TYPE(0x00E)
 
 /** @} */
 
@@ -167,6 +184,7 @@
 #define SOF_IPC_PROBE_POINT_ADD			SOF_CMD_TYPE(0x006)
 #define SOF_IPC_PROBE_POINT_INFO		SOF_CMD_TYPE(0x007)
 #define SOF_IPC_PROBE_POINT_REMOVE		SOF_CMD_TYPE(0x008)
+#define SOF_IPC_PROBE_POINT_STATS		SOF_CMD_TYPE(0x009)
 
  /** @} */
 
@@ -224,13 +242,21 @@ struct sof_ipc_reply {
  * Compound commands - SOF_IPC_GLB_COMPOUND.
  *
  * Compound commands are sent to the DSP as a single IPC operation. The
- * commands are split into blocks and each block has a header. This header
- * identifies the command type and the number of commands before the next
- * header.
+ * header is followed by count commands, each starting with its own
+ * struct sof_ipc_cmd_hdr and no bigger than SOF_IPC_MSG_MAX_SIZE. The whole
+ * compound message may use the full host mailbox. Commands are run in order
+ * until one of them fails. Data replied by single commands is dropped, so
+ * commands with reply data other than the error should be sent alone.
  */
 struct sof_ipc_compound_hdr {
 	struct sof_ipc_cmd_hdr hdr;
-	uint32_t count;		/**< count of 0 means end of compound sequence */
+	uint32_t count;		/**< number of commands */
+} __attribute__((packed));
+
+/** Reply to compound commands */
+struct sof_ipc_compound_reply {
+	struct sof_ipc_reply rhdr;	/**< error of the failed command */
+	uint32_t count;			/**< number of commands completed */
 } __attribute__((packed));
 
 /**
@@ -41,6 +41,7 @@ enum sof_ipc_ext_data {
 	SOF_IPC_EXT_CC_INFO		= 2,
 	SOF_IPC_EXT_PROBE_INFO		= 3,
 	SOF_IPC_EXT_USER_ABI_INFO 	= 4,
+	SOF_IPC_EXT_BOOT_PROFILE	= 5,
 };
 
 /* FW version - SOF_IPC_GLB_VERSION */
@@ -143,4 +144,22 @@ struct sof_ipc_user_abi_version {
 	uint32_t abi_dbg_version;
 } __attribute__((packed));
 
+/* boot phase started at cycles */
+struct sof_ipc_boot_point {
+	uint32_t id;		/**< TRACE_BOOT_ code of the phase */
+	uint32_t cycles;	/**< master core clock cycles from reset */
+} __attribute__((packed));
+
+/* extended data: boot profile, phases in the order they started */
+struct sof_ipc_boot_profile {
+	struct sof_ipc_ext_data_hdr ext_hdr;
+
+	uint32_t num_points;
+
+	/* reserved for future use */
+	uint32_t reserved[3];
+
+	struct sof_ipc_boot_point point[];
+} __attribute__((packed));
+
 #endif /* __IPC_INFO_H__ */
@@ -24,6 +24,7 @@
 #define PROBE_PURPOSE_INJECTION		0x2
 
 #define PROBE_EXTRACT_SYNC_WORD		0xBABEBEBA
+#define PROBE_EXTRACT_FRAME_SYNC_WORD	0xBABEBEBB
 
 /**
  * \brief Definitions of shifts and masks for format encoding in probe
@@ -91,7 +92,29 @@ struct probe_data_packet {
 	uint32_t format;		/**< Encoded data format */
 	uint32_t timestamp_low;		/**< Low 32 bits of timestamp in us */
 	uint32_t timestamp_high;	/**< High 32 bits of timestamp in us */
-	uint32_t checksum;		/**< CRC32 of header and payload */
+	uint32_t checksum;		/**< CRC32 of header, or header and payload */
+	uint32_t data_size_bytes;	/**< Size of following audio data */
+	uint32_t data[];		/**< Audio data extracted from buffer */
+} __attribute__((packed));
+
+/**
+ * Header of aggregated extraction frame, followed by frame_size bytes of
+ * chunks. Each chunk is a probe_chunk_header with data of one probe point.
+ */
+struct probe_frame_header {
+	uint32_t sync_word;		/**< PROBE_EXTRACT_FRAME_SYNC_WORD */
+	uint32_t frame_size;		/**< Size of following chunks */
+	uint32_t timestamp_low;		/**< Low 32 bits of timestamp in us */
+	uint32_t timestamp_high;	/**< High 32 bits of timestamp in us */
+	uint32_t checksum;		/**< CRC32 of frame header */
+} __attribute__((packed));
+
+/**
+ * Header of aggregated extraction chunk, data is padded to 4 bytes
+ */
+struct probe_chunk_header {
+	uint32_t buffer_id;		/**< Buffer ID from which data was extracted */
+	uint32_t format;		/**< Encoded data format */
 	uint32_t data_size_bytes;	/**< Size of following audio data */
 	uint32_t data[];		/**< Audio data extracted from buffer */
 } __attribute__((packed));
@@ -104,6 +127,16 @@ struct probe_dma {
 	uint32_t dma_buffer_size;	/**< Size of buffer associated with this DMA */
 } __attribute__((packed));
 
+/**
+ * Description of probe dma with its injection statistics
+ */
+struct probe_dma_info {
+	uint32_t stream_tag;		/**< Stream tag associated with this DMA */
+	uint32_t dma_buffer_size;	/**< Size of buffer associated with this DMA */
+	uint32_t underruns;		/**< Number of injection underruns */
+	uint32_t underrun_bytes;	/**< Silence injected after first underrun */
+} __attribute__((packed));
+
 /**
  * Description of probe point
  */
@@ -116,6 +149,17 @@ struct probe_point {
 				 */
 } __attribute__((packed));
 
+/**
+ * Statistics of probe point
+ */
+struct probe_point_stats {
+	uint32_t buffer_id;	/**< ID of buffer to which probe is attached */
+	uint32_t purpose;	/**< PROBE_PURPOSE_EXTRACTION or PROBE_PURPOSE_INJECTION */
+	uint32_t bytes;		/**< Bytes extracted or injected */
+	uint32_t dropped_bytes;	/**< Bytes lost on extraction overflow or injection underrun */
+	uint32_t drops;		/**< Number of overflows or underruns */
+} __attribute__((packed));
+
 /**
  * \brief DMA ADD for probes.
  *
@@ -130,14 +174,16 @@ struct sof_ipc_probe_dma_add_params {
 /**
  * \brief Reply to INFO functions.
  *
- * Used as payload for IPCs: SOF_IPC_PROBE_DMA_INFO, SOF_IPC_PROBE_POINT_INFO.
+ * Used as payload for IPCs: SOF_IPC_PROBE_DMA_INFO, SOF_IPC_PROBE_POINT_INFO,
+ * SOF_IPC_PROBE_POINT_STATS.
  */
 struct sof_ipc_probe_info_params {
 	struct sof_ipc_reply rhdr;			/**< Header */
 	uint32_t num_elems;				/**< Count of elements in array */
 	union {
-		struct probe_dma probe_dma[0];		/**< DMA info */
+		struct probe_dma_info probe_dma[0];	/**< DMA info */
 		struct probe_point probe_point[0];	/**< Probe Point info */
+		struct probe_point_stats probe_point_stats[0];	/**< Probe Point stats */
 	};
 } __attribute__((packed));
 
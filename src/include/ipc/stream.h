@@ -47,6 +47,7 @@
 
 /* generic PCM flags for runtime settings */
 #define SOF_PCM_FLAG_XRUN_STOP	(1 << 0) /**< Stop on any XRUN */
+#define SOF_PCM_FLAG_PAUSE_WARM	(1 << 1) /**< Keep DAI running on pause */
 
 /* stream PCM frame format */
 enum sof_ipc_frame {
@@ -54,6 +55,7 @@ enum sof_ipc_frame {
 	SOF_IPC_FRAME_S24_4LE,
 	SOF_IPC_FRAME_S32_LE,
 	SOF_IPC_FRAME_FLOAT,
+	SOF_IPC_FRAME_S24_3LE,
 	/* other formats here */
 };
 
@@ -61,6 +63,8 @@ enum sof_ipc_frame {
 enum sof_ipc_buffer_format {
 	SOF_IPC_BUFFER_INTERLEAVED,
 	SOF_IPC_BUFFER_NONINTERLEAVED,
+	/* compressed data, frames are words moved by the host DMA */
+	SOF_IPC_BUFFER_COMPRESSED,
 	/* other formats here */
 };
 
@@ -93,17 +97,44 @@ struct sof_ipc_stream_params {
 
 	uint32_t host_period_bytes;
 	uint16_t no_stream_position; /**< 1 means don't send stream position */
+	/**< periods between position updates in the mailbox, 0 means none */
+	uint16_t posn_periods;
 
-	uint16_t reserved[3];
+	/**< PCMs sharing the host DMA of stream_tag, 0 if not shared */
+	uint16_t mux_pcms;
+	/**< capture channels the host reads, 0 for all, others are undefined */
+	uint16_t active_mask;
 	uint16_t chmap[SOF_IPC_MAX_CHANNELS];	/**< channel map - SOF_CHMAP_ */
 } __attribute__((packed));
 
-/* PCM params info - SOF_IPC_STREAM_PCM_PARAMS */
+/*
+ * Framing of a host DMA shared by several playback PCMs. The stream holds
+ * frames of this header followed by size bytes of whole PCM frames for the
+ * host component comp_id. Payloads of unknown components are dropped.
+ */
+struct sof_ipc_stream_mux_hdr {
+	uint32_t comp_id;	/**< host component of the payload */
+	uint32_t size;		/**< payload bytes following the header */
+} __attribute__((packed));
+
+/*
+ * Stream QoS classes, each sets LL priority, batching of periods, lowest
+ * CPU clock and deepest idle state of the pipeline while it runs.
+ */
+#define SOF_IPC_STREAM_QOS_DEFAULT	0	/**< topology settings */
+#define SOF_IPC_STREAM_QOS_ULL		1	/**< ultra low latency */
+#define SOF_IPC_STREAM_QOS_VOICE	2	/**< voice call */
+#define SOF_IPC_STREAM_QOS_MEDIA	3	/**< media deep buffer */
+#define SOF_IPC_STREAM_QOS_SENSING	4	/**< always-on sensing */
+#define SOF_IPC_STREAM_QOS_CLASSES	5
+
+/* PCM params info - SOF_IPC_STREAM_PCM_PARAMS, SOF_IPC_STREAM_PCM_RECONFIG */
 struct sof_ipc_pcm_params {
 	struct sof_ipc_cmd_hdr hdr;
 	uint32_t comp_id;
 	uint32_t flags;		/**< generic PCM flags - SOF_PCM_FLAG_ */
-	uint32_t reserved[2];
+	uint32_t qos;		/**< SOF_IPC_STREAM_QOS_ class */
+	uint32_t reserved;
 	struct sof_ipc_stream_params params;
 } __attribute__((packed));
 
@@ -120,6 +151,16 @@ struct sof_ipc_stream {
 	uint32_t comp_id;
 } __attribute__((packed));
 
+/* streams started or stopped in the same LL tick -
+ * SOF_IPC_STREAM_TRIG_GROUP_START, SOF_IPC_STREAM_TRIG_GROUP_STOP
+ */
+struct sof_ipc_stream_group {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t num_comps;	/**< number of host components */
+	uint32_t reserved[3];
+	uint32_t comp_id[];	/**< host component IDs, all on one core */
+} __attribute__((packed));
+
 /* flags indicating which time stamps are in sync with each other */
 #define	SOF_TIME_HOST_SYNC	(1 << 0)
 #define	SOF_TIME_DAI_SYNC	(1 << 1)
@@ -151,6 +192,7 @@ struct sof_ipc_stream_posn {
 	uint64_t timestamp;	/**< system time stamp */
 	uint32_t xrun_comp_id;	/**< comp ID of XRUN component */
 	int32_t xrun_size;	/**< XRUN size in bytes */
+	uint32_t seq;		/**< odd while the mailbox copy is updated */
 } __attribute__((packed));
 
 #endif /* __IPC_STREAM_H__ */
@@ -17,6 +17,7 @@
 #define __IPC_TOPOLOGY_H__
 
 #include <ipc/header.h>
+#include <ipc/stream.h>
 #include <stdint.h>
 
 /*
@@ -46,6 +47,9 @@ enum sof_comp_type {
 	SOF_COMP_DEMUX,
 	SOF_COMP_ASRC,		/**< Asynchronous sample rate converter */
 	SOF_COMP_DCBLOCK,
+	SOF_COMP_DETECT,	/**< detectors sharing feature front-end */
+	SOF_COMP_DECODER,	/**< compressed stream decoder */
+	SOF_COMP_NN,		/**< neural network model */
 	/* keep FILEREAD/FILEWRITE as the last ones */
 	SOF_COMP_FILEREAD = 10000,	/**< host test based file IO */
 	SOF_COMP_FILEWRITE = 10001,	/**< host test based file IO */
@@ -56,6 +60,11 @@ enum sof_comp_type {
 #define SOF_XRUN_UNDER_ZERO	2	/**< send 0s to sink */
 #define SOF_XRUN_OVER_NULL	4	/**< send data to NULL */
 
+/* core of a new component, buffer or pipeline picked by the firmware, the
+ * objects of one pipeline are all placed on the same core
+ */
+#define SOF_IPC_CORE_AUTO	0xffffffff
+
 /* create new generic component - SOF_IPC_TPLG_COMP_NEW */
 struct sof_ipc_comp {
 	struct sof_ipc_cmd_hdr hdr;
@@ -84,11 +93,22 @@ struct sof_ipc_comp {
 #define SOF_MEM_CAPS_CACHE			(1 << 6) /**< cacheable */
 #define SOF_MEM_CAPS_EXEC			(1 << 7) /**< executable */
 
+/* buffer flags */
+#define SOF_BUF_LAZY_ALLOC	(1 << 0) /**< memory only from params to reset */
+#define SOF_BUF_BROADCAST	(1 << 1) /**< reads first sink buf of source */
+
 /* create new component buffer - SOF_IPC_TPLG_BUFFER_NEW */
 struct sof_ipc_buffer {
 	struct sof_ipc_comp comp;
 	uint32_t size;		/**< buffer size in bytes */
 	uint32_t caps;		/**< SOF_MEM_CAPS_ */
+	uint32_t flags;		/**< SOF_BUF_ */
+	/**
+	 * Buffers with the same non zero group share one memory area, they
+	 * must be in pipelines never running at the same time. Implies
+	 * SOF_BUF_LAZY_ALLOC.
+	 */
+	uint32_t group;
 } __attribute__((packed));
 
 /* generic component config data - must always be after struct sof_ipc_comp */
@@ -111,8 +131,37 @@ struct sof_ipc_comp_host {
 	uint32_t direction;	/**< SOF_IPC_STREAM_ */
 	uint32_t no_irq;	/**< don't send periodic IRQ to host/DSP */
 	uint32_t dmac_config; /**< DMA engine specific */
+	uint32_t ch_map;	/**< SOF_IPC_CH_MAP_ of host stream channels */
 } __attribute__((packed));
 
+/*
+ * Channel map of sof_ipc_comp_host.ch_map and sof_ipc_comp_dai.ch_map
+ * applied while copying between DMA and pipeline buffers. Every 4 bits
+ * from the lowest ones belong to one pipeline channel and hold the DMA
+ * frame channel + 1, the first zero field ends the map. Zero map copies
+ * frames unchanged.
+ */
+#define SOF_IPC_CH_MAP_BITS		4
+#define SOF_IPC_CH_MAP_MAX_CHANNELS	8
+
+#define SOF_IPC_CH_MAP_GET(map, ch) \
+	(((map) >> ((ch) * SOF_IPC_CH_MAP_BITS)) & 0xf)
+
+/*
+ * HDA host DMA stream policy in sof_ipc_comp_host.dmac_config,
+ * zero fields keep the driver defaults.
+ */
+#define SOF_HDA_DMAC_BURST_SHIFT	0 /**< burst threshold in periods */
+#define SOF_HDA_DMAC_BURST_MASK		0xff
+#define SOF_HDA_DMAC_FPI_BATCH_SHIFT	8 /**< periods per FPI update */
+#define SOF_HDA_DMAC_FPI_BATCH_MASK	0xff
+#define SOF_HDA_DMAC_L1_DEFER		(1 << 16) /**< no forced L1 exit */
+
+#define SOF_HDA_DMAC_BURST(x) \
+	(((x) >> SOF_HDA_DMAC_BURST_SHIFT) & SOF_HDA_DMAC_BURST_MASK)
+#define SOF_HDA_DMAC_FPI_BATCH(x) \
+	(((x) >> SOF_HDA_DMAC_FPI_BATCH_SHIFT) & SOF_HDA_DMAC_FPI_BATCH_MASK)
+
 /* generic DAI component */
 struct sof_ipc_comp_dai {
 	struct sof_ipc_comp comp;
@@ -120,7 +169,10 @@ struct sof_ipc_comp_dai {
 	uint32_t direction;	/**< SOF_IPC_STREAM_ */
 	uint32_t dai_index;	/**< index of this type dai */
 	uint32_t type;		/**< DAI type - SOF_DAI_ */
-	uint32_t reserved;	/**< reserved */
+	uint32_t slot_mask;	/**< DAI frame channels shared with other
+				  *  pipelines, 0 for the whole frame
+				  */
+	uint32_t ch_map;	/**< SOF_IPC_CH_MAP_ of DAI frame channels */
 } __attribute__((packed));
 
 /* generic mixer component */
@@ -230,6 +282,7 @@ struct sof_ipc_comp_reply {
 	struct sof_ipc_reply rhdr;
 	uint32_t id;
 	uint32_t offset;
+	uint32_t core;		/**< core the object has been created on */
 } __attribute__((packed));
 
 /*
@@ -255,6 +308,7 @@ struct sof_ipc_pipe_new {
 	uint32_t frames_per_sched;/**< output frames of pipeline, 0 is variable */
 	uint32_t xrun_limit_usecs; /**< report xruns greater than limit */
 	uint32_t time_domain;	/**< scheduling time domain */
+	uint32_t batch_periods;	/**< periods processed per run, 0 is 1 */
 } __attribute__((packed));
 
 /* pipeline construction complete - SOF_IPC_TPLG_PIPE_COMPLETE */
@@ -275,4 +329,94 @@ struct sof_ipc_pipe_comp_connect {
 	uint32_t sink_id;
 } __attribute__((packed));
 
+/*
+ * Topology image
+ */
+
+/* "TPLI" */
+#define SOF_TPLG_IMAGE_MAGIC	0x494C5054
+
+/**
+ * Pre-linked topology image built offline by sof-tplg-image. The header is
+ * followed by count records, each a complete SOF_IPC_GLB_TPLG_MSG command
+ * of COMP_NEW, BUFFER_NEW, PIPE_NEW, COMP_CONNECT or PIPE_COMPLETE type with
+ * its hdr.size a multiple of 4 bytes. Records are laid out in the order they
+ * are instantiated and use the firmware structures of the abi version
+ * exactly, so they are not ABI-safe copied and the image must be built for
+ * the MAJOR and MINOR ABI of the firmware.
+ */
+struct sof_tplg_image_hdr {
+	uint32_t magic;		/**< SOF_TPLG_IMAGE_MAGIC */
+	uint32_t abi;		/**< SOF_ABI_VERSION of the records */
+	uint32_t size;		/**< image size in bytes including header */
+	uint32_t count;		/**< number of records */
+
+	/* reserved for future use */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+/* load topology image from host pages - SOF_IPC_TPLG_IMAGE_LOAD */
+struct sof_ipc_tplg_image {
+	struct sof_ipc_cmd_hdr hdr;
+	struct sof_ipc_host_buffer buffer;	/**< pages holding the image */
+	uint32_t size;				/**< image size in bytes */
+
+	/* reserved for future use */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+/* reply to SOF_IPC_TPLG_IMAGE_LOAD */
+struct sof_ipc_tplg_image_reply {
+	struct sof_ipc_reply rhdr;	/**< error of the failed record */
+	uint32_t count;			/**< number of records instantiated */
+} __attribute__((packed));
+
+/*
+ * Component library
+ */
+
+/* "SOFL" */
+#define SOF_COMP_LIB_MAGIC	0x4C464F53
+
+#define SOF_COMP_LIB_NAME_SIZE	16
+
+/**
+ * Component drivers built apart from the base firmware and loaded when a
+ * topology first uses them. The header is followed by the library image,
+ * code and initialized data linked at address 0 against the symbols of the
+ * base firmware it is loaded to, and by the relocation table. Every entry
+ * of the table is the offset of a 32-bit word of the image holding an
+ * image address, the load address is added to it. Words of the image from
+ * init_offset are init_count DECLARE_MODULE() pointers called once the
+ * image is relocated to register the drivers.
+ */
+struct sof_comp_lib_hdr {
+	uint32_t magic;		/**< SOF_COMP_LIB_MAGIC */
+	uint32_t abi;		/**< SOF_ABI_VERSION of the base firmware */
+	uint16_t major;		/**< version of the base firmware */
+	uint16_t minor;
+	uint16_t micro;
+	uint8_t tag[6];		/**< git tag of the base firmware */
+	uint8_t name[SOF_COMP_LIB_NAME_SIZE];	/**< library name */
+	uint32_t size;		/**< library size in bytes including header */
+	uint32_t image_size;	/**< bytes of image following the header */
+	uint32_t bss_size;	/**< zeroed bytes after the image */
+	uint32_t init_offset;	/**< image offset of init pointers */
+	uint32_t init_count;	/**< number of init pointers */
+	uint32_t reloc_count;	/**< number of relocation entries */
+
+	/* reserved for future use */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+/* load component library from host pages - SOF_IPC_TPLG_LIB_LOAD */
+struct sof_ipc_comp_lib {
+	struct sof_ipc_cmd_hdr hdr;
+	struct sof_ipc_host_buffer buffer;	/**< pages holding the library */
+	uint32_t size;				/**< library size in bytes */
+
+	/* reserved for future use */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
 #endif /* __IPC_TOPOLOGY_H__ */
@@ -51,6 +51,396 @@ struct sof_ipc_dma_trace_posn {
 	uint32_t messages;	/* total trace messages */
 } __attribute__((packed));
 
+/*
+ * Heap usage
+ */
+
+/* heap zones reported in struct sof_ipc_dbg_heap_elem */
+#define SOF_IPC_HEAP_ZONE_SYS			0
+#define SOF_IPC_HEAP_ZONE_SYS_RUNTIME		1
+#define SOF_IPC_HEAP_ZONE_RUNTIME		2
+#define SOF_IPC_HEAP_ZONE_BUFFER		3
+
+/* usage of one heap, all sizes in bytes */
+struct sof_ipc_dbg_heap_elem {
+	uint16_t zone;		/* SOF_IPC_HEAP_ZONE_ */
+	uint16_t id;		/* heap index in zone, core id for per core */
+	uint32_t caps;		/* SOF_MEM_CAPS_ */
+	uint32_t size;
+	uint32_t used;
+	uint32_t free;
+	uint32_t peak_used;	/* high water mark of used */
+	uint32_t largest_free;	/* largest contiguous free space */
+	uint32_t alloc_fails;	/* failed allocation attempts */
+} __attribute__((packed));
+
+/* heap usage snapshot - SOF_IPC_TRACE_HEAP_INFO reply */
+struct sof_ipc_dbg_heap_info {
+	struct sof_ipc_reply rhdr;
+	uint32_t num_elems;	/* heaps present in this reply */
+	uint32_t total_elems;	/* heaps in the firmware */
+	struct sof_ipc_dbg_heap_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Component performance
+ */
+
+/* SOF_IPC_TRACE_COMP_PERF_INFO request */
+struct sof_ipc_dbg_comp_perf_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t first_elem;	/* index of the first component to report */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+/* copy() cost of one component, cycles are DSP core clock cycles */
+struct sof_ipc_dbg_comp_perf_elem {
+	uint32_t comp_id;
+	uint32_t pipeline_id;
+	uint16_t core;
+	uint16_t reserved;
+	uint32_t period;	/* scheduling period in us */
+	uint32_t cycles_avg;	/* windowed average of cycles per copy */
+	uint32_t cycles_peak;	/* peak cycles per copy */
+	uint32_t load_avg;	/* cycles_avg per mille of the period budget */
+	uint32_t load_peak;	/* cycles_peak per mille of the period budget */
+
+	/* windowed averages per copy counted by the core performance
+	 * monitor, zero if the core doesn't count the event
+	 */
+	uint32_t stall_data_avg;	/* cycles stalled on data memory */
+	uint32_t stall_instr_avg;	/* cycles stalled on instruction fetch */
+	uint32_t dcache_miss_avg;	/* data cache misses */
+	uint32_t icache_miss_avg;	/* instruction cache misses */
+} __attribute__((packed));
+
+/* component performance snapshot - SOF_IPC_TRACE_COMP_PERF_INFO reply */
+struct sof_ipc_dbg_comp_perf_info {
+	struct sof_ipc_reply rhdr;
+	uint32_t num_elems;	/* components present in this reply */
+	uint32_t total_elems;	/* components in the firmware */
+	struct sof_ipc_dbg_comp_perf_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Low latency scheduler statistics
+ */
+
+/* number of log2 buckets in histograms, last one collects the rest */
+#define SOF_IPC_LL_STATS_BUCKETS		16
+
+/* maximum number of tasks reported per scheduler */
+#define SOF_IPC_LL_STATS_TASKS			8
+
+/* clear statistics after they are read */
+#define SOF_IPC_LL_STATS_RESET			(1 << 0)
+
+/* SOF_IPC_TRACE_LL_STATS request */
+struct sof_ipc_dbg_ll_stats_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t sched_type;	/* LL timer or LL DMA scheduler type */
+	uint32_t core;
+	uint32_t flags;		/* SOF_IPC_LL_STATS_ */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* statistics of one scheduled task, times are in scheduler ticks */
+struct sof_ipc_dbg_ll_task_stats {
+	uint32_t uid;
+	uint32_t period;	/* scheduling period in us */
+	uint32_t overruns;	/* runs longer than the period */
+	uint32_t exec_peak;	/* longest run */
+} __attribute__((packed));
+
+/*
+ * LL scheduler statistics - SOF_IPC_TRACE_LL_STATS reply.
+ * Bucket n of a histogram counts values in range [2^(n-1), 2^n) ticks,
+ * bucket 0 counts zeros.
+ */
+struct sof_ipc_dbg_ll_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t sched_type;
+	uint32_t core;
+	uint32_t ticks_per_ms;	/* scheduler clock ticks per ms */
+	uint32_t overruns;	/* task overruns of all tasks */
+	uint32_t lateness[SOF_IPC_LL_STATS_BUCKETS];	/* tick start delay */
+	uint32_t exec[SOF_IPC_LL_STATS_BUCKETS];	/* tick run time */
+	uint32_t num_tasks;	/* tasks present in this reply */
+	struct sof_ipc_dbg_ll_task_stats tasks[];
+} __attribute__((packed));
+
+/*
+ * Interrupt accounting
+ */
+
+/* clear accounting after it is read */
+#define SOF_IPC_IRQ_STATS_RESET			(1 << 0)
+
+/* SOF_IPC_TRACE_IRQ_STATS request */
+struct sof_ipc_dbg_irq_stats_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t core;
+	uint32_t flags;		/* SOF_IPC_IRQ_STATS_ */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+/*
+ * Handler runs of one interrupt on the core, cycles are DSP core clock
+ * cycles. A DSP interrupt of a cascading controller includes the cycles
+ * of its cascaded interrupts, which have virtual numbers above the DSP
+ * ones.
+ */
+struct sof_ipc_dbg_irq_elem {
+	uint32_t irq;
+	uint32_t count;
+	uint64_t cycles;	/* cycles of all runs */
+	uint32_t cycles_max;	/* longest run */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* accounting of interrupts that have run - SOF_IPC_TRACE_IRQ_STATS reply */
+struct sof_ipc_dbg_irq_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t core;
+	uint32_t num_elems;	/* interrupts present in this reply */
+	uint32_t total_elems;	/* interrupts that have run */
+	struct sof_ipc_dbg_irq_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Task stack usage
+ */
+
+/* stack of one task context, sizes in bytes */
+struct sof_ipc_dbg_stack_elem {
+	uint32_t uid;		/* task uid, 0 for context of inline tasks */
+	uint32_t size;
+	uint32_t peak_used;	/* high water mark of the stack */
+} __attribute__((packed));
+
+/* stacks of EDF tasks of the IPC core - SOF_IPC_TRACE_STACK_INFO reply */
+struct sof_ipc_dbg_stack_info {
+	struct sof_ipc_reply rhdr;
+	uint32_t core;
+	uint32_t num_elems;	/* stacks present in this reply */
+	uint32_t total_elems;	/* stacks of the core */
+	struct sof_ipc_dbg_stack_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Spinlock statistics
+ */
+
+#define SOF_IPC_LOCK_NAME_SIZE			12
+
+/* clear statistics after they are read */
+#define SOF_IPC_LOCK_STATS_RESET		(1 << 0)
+
+/* SOF_IPC_TRACE_LOCK_STATS request */
+struct sof_ipc_dbg_lock_stats_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t flags;		/* SOF_IPC_LOCK_STATS_ */
+	uint32_t reserved[3];
+} __attribute__((packed));
+
+/* statistics of locks sharing a name, cycles are DSP core clock cycles */
+struct sof_ipc_dbg_lock_elem {
+	char name[SOF_IPC_LOCK_NAME_SIZE];
+	uint32_t acquires;
+	uint32_t contended;	/* acquires that had to spin */
+	uint64_t spin_cycles;	/* cycles spent spinning */
+	uint32_t spin_max;	/* longest spin */
+	uint32_t hold_max;	/* longest time held */
+} __attribute__((packed));
+
+/* named lock statistics - SOF_IPC_TRACE_LOCK_STATS reply */
+struct sof_ipc_dbg_lock_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t num_elems;	/* names present in this reply */
+	uint32_t total_elems;	/* names in the firmware */
+	struct sof_ipc_dbg_lock_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Memory of topology objects
+ */
+
+/* report pipelines with the memory of all their objects */
+#define SOF_IPC_MEM_OWNER_PIPELINES		(1 << 0)
+
+/* topology object types */
+#define SOF_IPC_MEM_OWNER_COMP			0
+#define SOF_IPC_MEM_OWNER_BUFFER		1
+#define SOF_IPC_MEM_OWNER_PIPELINE		2
+
+/* SOF_IPC_TRACE_MEM_OWNER_INFO request */
+struct sof_ipc_dbg_mem_owner_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t first_elem;	/* index of the first object to report */
+	uint32_t flags;		/* SOF_IPC_MEM_OWNER_ */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/*
+ * Heap memory allocated for an object when it was created, got params and
+ * was prepared, in bytes of heap blocks taken.
+ */
+struct sof_ipc_dbg_mem_owner_elem {
+	uint32_t id;		/* topology object id */
+	uint32_t pipeline_id;
+	uint16_t type;		/* SOF_IPC_MEM_OWNER_ object type */
+	uint16_t core;
+	uint32_t bytes;
+	uint32_t allocs;	/* number of allocations */
+} __attribute__((packed));
+
+/* memory of objects - SOF_IPC_TRACE_MEM_OWNER_INFO reply */
+struct sof_ipc_dbg_mem_owner_info {
+	struct sof_ipc_reply rhdr;
+	uint32_t num_elems;	/* objects present in this reply */
+	uint32_t total_elems;	/* objects reported */
+	struct sof_ipc_dbg_mem_owner_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Pipeline latency
+ */
+
+/* inject a new marker at the source component of the pipeline */
+#define SOF_IPC_LATENCY_MARK			(1 << 0)
+
+/* SOF_IPC_TRACE_LATENCY request */
+struct sof_ipc_dbg_latency_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t pipeline_id;	/* pipeline to inject the marker into */
+	uint32_t flags;		/* SOF_IPC_LATENCY_ */
+	uint32_t seq;		/* marker to report, 0 for the last one */
+	uint32_t first_elem;	/* index of the first component to report */
+} __attribute__((packed));
+
+/*
+ * Time from the injection of the marker until the component consumed the
+ * marked frame, the algorithmic delay of the component is included in the
+ * time of its downstream components.
+ */
+struct sof_ipc_dbg_latency_elem {
+	uint32_t comp_id;
+	uint32_t pipeline_id;
+	uint32_t latency_us;
+	uint32_t delay_frames;	/* algorithmic delay of the component */
+} __attribute__((packed));
+
+/* components reached by a marker - SOF_IPC_TRACE_LATENCY reply */
+struct sof_ipc_dbg_latency_info {
+	struct sof_ipc_reply rhdr;
+	uint32_t seq;		/* marker reported, or injected */
+	uint32_t total_us;	/* latency of the furthest component reached */
+	uint32_t num_elems;	/* components present in this reply */
+	uint32_t total_elems;	/* components reached */
+	struct sof_ipc_dbg_latency_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Idle state statistics
+ */
+
+/* idle states of a core, deepest last */
+#define SOF_IPC_IDLE_WAITI			0	/* wait for interrupt */
+#define SOF_IPC_IDLE_CLK_GATE			1	/* waiti on LPRO */
+#define SOF_IPC_IDLE_LPS			2	/* D0i3 LP SRAM */
+#define SOF_IPC_IDLE_STATES			3
+
+/* clear statistics after they are read */
+#define SOF_IPC_IDLE_STATS_RESET		(1 << 0)
+
+/* SOF_IPC_TRACE_IDLE_STATS request */
+struct sof_ipc_dbg_idle_stats_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t core;
+	uint32_t flags;		/* SOF_IPC_IDLE_STATS_ */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+/*
+ * Entries of one idle state. Early wakeups are the entries that ended
+ * before the state paid off its entry and exit cost.
+ */
+struct sof_ipc_dbg_idle_elem {
+	uint32_t state;		/* SOF_IPC_IDLE_ */
+	uint32_t entries;
+	uint64_t residency_us;	/* time spent in the state */
+	uint32_t early;		/* entries shorter than the state minimum */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* idle statistics of the core - SOF_IPC_TRACE_IDLE_STATS reply */
+struct sof_ipc_dbg_idle_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t core;
+	uint32_t demoted;	/* entries kept shallower by the prediction */
+	uint32_t num_elems;
+	uint32_t reserved;
+	struct sof_ipc_dbg_idle_elem elems[];
+} __attribute__((packed));
+
+/*
+ * Session recording, the record format is in user/session.h
+ */
+
+/* drop the recorded session and start a new one */
+#define SOF_IPC_SESSION_RESTART			(1 << 0)
+
+/* SOF_IPC_TRACE_SESSION request */
+struct sof_ipc_dbg_session_params {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t offset;	/* session bytes read so far */
+	uint32_t flags;		/* SOF_IPC_SESSION_ */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+/*
+ * Whole records following the requested offset - SOF_IPC_TRACE_SESSION
+ * reply. Records overwritten before they were read are skipped and
+ * counted in lost, the session is then incomplete.
+ */
+struct sof_ipc_dbg_session_data {
+	struct sof_ipc_reply rhdr;
+	uint32_t offset;	/* session offset of the first record */
+	uint32_t size;		/* bytes of records in data */
+	uint32_t lost;		/* bytes skipped before offset */
+	uint32_t reserved;
+	uint8_t data[];
+} __attribute__((packed));
+
+/*
+ * Runtime trace filtering
+ */
+
+/* filter element types */
+#define SOF_IPC_TRACE_FILTER_ELEM_CLASS		0	/* id is TRACE_CLASS_ */
+#define SOF_IPC_TRACE_FILTER_ELEM_COMP		1	/* id is component id */
+#define SOF_IPC_TRACE_FILTER_ELEM_RESET		2	/* restore defaults */
+
+/*
+ * Highest LOG_LEVEL_ traced for a class or a component. Component levels
+ * only enable more verbose traces than the class level of the trace.
+ * Errors are always traced.
+ */
+struct sof_ipc_trace_filter_elem {
+	uint32_t type;		/* SOF_IPC_TRACE_FILTER_ELEM_ */
+	uint32_t id;
+	uint32_t level;		/* LOG_LEVEL_ */
+	uint32_t reserved;
+} __attribute__((packed));
+
+/* SOF_IPC_TRACE_FILTER_UPDATE, elements are applied in order */
+struct sof_ipc_trace_filter {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t num_elems;
+	uint32_t reserved[3];
+	struct sof_ipc_trace_filter_elem elems[];
+} __attribute__((packed));
+
 /*
  * Commom debug
  */
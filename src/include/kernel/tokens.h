@@ -30,6 +30,8 @@
 /* buffers */
 #define SOF_TKN_BUF_SIZE			100
 #define SOF_TKN_BUF_CAPS			101
+#define SOF_TKN_BUF_FLAGS			102
+#define SOF_TKN_BUF_GROUP			103
 
 /* DAI */
 /* Token retired with ABI 3.2, do not use for new capabilities
@@ -38,6 +40,8 @@
 #define SOF_TKN_DAI_TYPE			154
 #define SOF_TKN_DAI_INDEX			155
 #define SOF_TKN_DAI_DIRECTION			156
+#define SOF_TKN_DAI_SLOT_MASK			157
+#define SOF_TKN_DAI_CH_MAP			158
 
 /* scheduling */
 #define SOF_TKN_SCHED_PERIOD			200
@@ -46,6 +50,7 @@
 #define SOF_TKN_SCHED_CORE			203
 #define SOF_TKN_SCHED_FRAMES			204
 #define SOF_TKN_SCHED_TIME_DOMAIN		205
+#define SOF_TKN_SCHED_BATCH_PERIODS		206
 
 /* volume */
 #define SOF_TKN_VOLUME_RAMP_STEP_TYPE		250
@@ -63,6 +68,7 @@
 
 /* PCM */
 #define SOF_TKN_PCM_DMAC_CONFIG			353
+#define SOF_TKN_PCM_CH_MAP			354
 
 /* Generic components */
 #define SOF_TKN_COMP_PERIOD_SINK_COUNT		400
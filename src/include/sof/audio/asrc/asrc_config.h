@@ -27,15 +27,23 @@
 #define ASRC_HIFI3	0
 #define ASRC_GENERIC	1
 #endif
+#define ASRC_X86	0
+#elif defined(__AVX2__) || defined(__SSE4_2__)
+/* For GCC with SSE4.2 or AVX2 in host builds */
+#define ASRC_GENERIC	0
+#define ASRC_HIFI3	0
+#define ASRC_X86	1
 #else
 /* For GCC */
 #define ASRC_GENERIC	1
 #define ASRC_HIFI3	0
+#define ASRC_X86	0
 #endif /* XCC */
 #else
 /* Applied when ASRC_AUTOARCH is set to zero */
 #define ASRC_GENERIC	1 /* Enable generic */
 #define ASRC_HIFI3	0 /* Disable HiFi3  */
+#define ASRC_X86	0 /* Disable x86 */
 #endif /* Autoarch */
 
 #endif /* __SOF_AUDIO_ASRC_ASRC_CONFIG_H__ */
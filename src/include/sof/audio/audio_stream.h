@@ -15,12 +15,15 @@
 #define __SOF_AUDIO_AUDIO_STREAM_H__
 
 #include <sof/audio/format.h>
+#include <sof/bit.h>
 #include <sof/debug/panic.h>
 #include <sof/math/numbers.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
+#include <sof/lib/memory.h>
 #include <ipc/stream.h>
 #include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /** \addtogroup audio_stream_api Audio Stream API
@@ -55,6 +58,7 @@ struct audio_stream {
 	enum sof_ipc_frame frame_fmt;	/**< Sample data format */
 	uint32_t rate;		/**< Number of data frames per second [Hz] */
 	uint16_t channels;	/**< Number of samples in each frame */
+	uint16_t active_mask;	/**< Channels read downstream, 0 for all */
 };
 
 /**
@@ -171,10 +175,28 @@ static inline int audio_stream_set_params(struct audio_stream *buffer,
 	buffer->frame_fmt = params->frame_fmt;
 	buffer->rate = params->rate;
 	buffer->channels = params->channels;
+	buffer->active_mask = params->active_mask;
 
 	return 0;
 }
 
+/**
+ * Tells if a channel of the stream is read by its consumer, so it has to
+ * be produced.
+ * @param buffer Buffer.
+ * @param ch Channel.
+ * @return True if the channel is read.
+ */
+static inline bool
+audio_stream_channel_active(const struct audio_stream *buffer, uint32_t ch)
+{
+#if CONFIG_ACTIVE_CHANNELS
+	return !buffer->active_mask || buffer->active_mask & BIT(ch);
+#else
+	return true;
+#endif
+}
+
 /**
  * Verifies the pointer and performs rollover when reached the end of
  * the buffer.
@@ -268,6 +290,71 @@ static inline uint32_t audio_stream_period_bytes(const struct audio_stream *buf,
 	return frames * audio_stream_frame_bytes(buf);
 }
 
+/**
+ * Calculates number of bytes that can be accessed from the pointer without
+ * crossing the end of the buffer.
+ * @param buffer Buffer accessed by the pointer.
+ * @param ptr Read or write pointer, must be within the buffer.
+ * @return Number of bytes till buffer wrap.
+ */
+static inline uint32_t
+audio_stream_bytes_without_wrap(const struct audio_stream *buffer,
+				const void *ptr)
+{
+	return (char *)buffer->end_addr - (char *)ptr;
+}
+
+/**
+ * Calculates number of signed 16-bit samples that can be accessed from
+ * the pointer without crossing the end of the buffer.
+ * @param buffer Buffer accessed by the pointer.
+ * @param ptr Read or write pointer, must be within the buffer.
+ * @return Number of samples till buffer wrap.
+ */
+static inline uint32_t
+audio_stream_samples_without_wrap_s16(const struct audio_stream *buffer,
+				      const void *ptr)
+{
+	return audio_stream_bytes_without_wrap(buffer, ptr) / sizeof(int16_t);
+}
+
+/**
+ * Calculates number of signed 32-bit (or 24-bit in 4 bytes container)
+ * samples that can be accessed from the pointer without crossing the end
+ * of the buffer.
+ * @param buffer Buffer accessed by the pointer.
+ * @param ptr Read or write pointer, must be within the buffer.
+ * @return Number of samples till buffer wrap.
+ */
+static inline uint32_t
+audio_stream_samples_without_wrap_s32(const struct audio_stream *buffer,
+				      const void *ptr)
+{
+	return audio_stream_bytes_without_wrap(buffer, ptr) / sizeof(int32_t);
+}
+
+/**
+ * Calculates number of frames that can be processed before the pointer,
+ * advanced by one frame at a time, crosses the end of the buffer.
+ * @param buffer Buffer accessed by the pointer.
+ * @param ptr Read or write pointer, must be within the buffer.
+ * @return Number of frames till buffer wrap.
+ *
+ * The pointer doesn't have to point to the beginning of a frame, so it
+ * can be used also for a single channel accessed with frame stride.
+ * After the returned number of frames has been processed the pointer
+ * needs to be adjusted with audio_stream_wrap().
+ */
+static inline uint32_t
+audio_stream_frames_without_wrap(const struct audio_stream *buffer,
+				 const void *ptr)
+{
+	uint32_t frame_bytes = audio_stream_frame_bytes(buffer);
+
+	return (audio_stream_bytes_without_wrap(buffer, ptr) +
+		frame_bytes - 1) / frame_bytes;
+}
+
 /**
  * Computes maximum number of frames that can be copied from source buffer
  * to sink buffer, verifying number of available source frames vs. free
@@ -371,51 +458,148 @@ static inline void audio_stream_init(struct audio_stream *buffer,
 }
 
 /**
- * Invalidates (in DSP d-cache) the buffer in range [r_ptr, r_ptr+bytes],
+ * Invalidates (in DSP d-cache) the buffer in range [ptr, ptr+bytes],
  * with rollover if necessary.
  * @param buffer Buffer.
+ * @param ptr Start of the fragment, inside the buffer.
  * @param bytes Size of the fragment to invalidate.
  */
-static inline void audio_stream_invalidate(struct audio_stream *buffer,
-					   uint32_t bytes)
+static inline void audio_stream_invalidate_from(struct audio_stream *buffer,
+						void *ptr, uint32_t bytes)
 {
 	uint32_t head_size = bytes;
 	uint32_t tail_size = 0;
 
+	/* buffer is accessed uncached */
+	if (is_uncached(ptr))
+		return;
+
 	/* check for potential wrap */
-	if ((char *)buffer->r_ptr + bytes > (char *)buffer->end_addr) {
-		head_size = (char *)buffer->end_addr - (char *)buffer->r_ptr;
+	if ((char *)ptr + bytes > (char *)buffer->end_addr) {
+		head_size = (char *)buffer->end_addr - (char *)ptr;
 		tail_size = bytes - head_size;
 	}
 
-	dcache_invalidate_region(buffer->r_ptr, head_size);
+	dcache_invalidate_region(ptr, head_size);
 	if (tail_size)
 		dcache_invalidate_region(buffer->addr, tail_size);
 }
 
 /**
- * Writes back (from DSP d-cache) the buffer in range [w_ptr, w_ptr+bytes],
+ * Writes back (from DSP d-cache) the buffer in range [ptr, ptr+bytes],
  * with rollover if necessary.
  * @param buffer Buffer.
+ * @param ptr Start of the fragment, inside the buffer.
  * @param bytes Size of the fragment to write back.
  */
-static inline void audio_stream_writeback(struct audio_stream *buffer,
-					  uint32_t bytes)
+static inline void audio_stream_writeback_from(struct audio_stream *buffer,
+					       void *ptr, uint32_t bytes)
 {
 	uint32_t head_size = bytes;
 	uint32_t tail_size = 0;
 
+	/* buffer is accessed uncached */
+	if (is_uncached(ptr))
+		return;
+
 	/* check for potential wrap */
-	if ((char *)buffer->w_ptr + bytes > (char *)buffer->end_addr) {
-		head_size = (char *)buffer->end_addr - (char *)buffer->w_ptr;
+	if ((char *)ptr + bytes > (char *)buffer->end_addr) {
+		head_size = (char *)buffer->end_addr - (char *)ptr;
 		tail_size = bytes - head_size;
 	}
 
-	dcache_writeback_region(buffer->w_ptr, head_size);
+	dcache_writeback_region(ptr, head_size);
 	if (tail_size)
 		dcache_writeback_region(buffer->addr, tail_size);
 }
 
+/**
+ * Invalidates (in DSP d-cache) the buffer in range [r_ptr, r_ptr+bytes],
+ * with rollover if necessary.
+ * @param buffer Buffer.
+ * @param bytes Size of the fragment to invalidate.
+ */
+static inline void audio_stream_invalidate(struct audio_stream *buffer,
+					   uint32_t bytes)
+{
+	audio_stream_invalidate_from(buffer, buffer->r_ptr, bytes);
+}
+
+/**
+ * Writes back (from DSP d-cache) the buffer in range [w_ptr, w_ptr+bytes],
+ * with rollover if necessary.
+ * @param buffer Buffer.
+ * @param bytes Size of the fragment to write back.
+ */
+static inline void audio_stream_writeback(struct audio_stream *buffer,
+					  uint32_t bytes)
+{
+	audio_stream_writeback_from(buffer, buffer->w_ptr, bytes);
+}
+
+/**
+ * Copies data between two circular buffers, handling wrap of both.
+ * @param src Read position in source buffer.
+ * @param src_addr Start of source buffer.
+ * @param src_end End of source buffer.
+ * @param dst Write position in destination buffer.
+ * @param dst_addr Start of destination buffer.
+ * @param dst_end End of destination buffer.
+ * @param bytes Number of bytes to copy.
+ * @return Write position in destination buffer after the copied data.
+ */
+static inline void *cir_buf_copy(const void *src, const void *src_addr,
+				 const void *src_end, void *dst,
+				 void *dst_addr, void *dst_end, uint32_t bytes)
+{
+	uint32_t bytes_src;
+	uint32_t bytes_dst;
+	uint32_t bytes_copied;
+	int ret;
+
+	while (bytes) {
+		bytes_src = (char *)src_end - (char *)src;
+		bytes_dst = (char *)dst_end - (char *)dst;
+		bytes_copied = MIN(bytes, MIN(bytes_src, bytes_dst));
+
+		ret = memcpy_s(dst, bytes_dst, src, bytes_copied);
+		assert(!ret);
+
+		bytes -= bytes_copied;
+		src = (char *)src + bytes_copied;
+		dst = (char *)dst + bytes_copied;
+
+		if (src == src_end)
+			src = src_addr;
+		if (dst == dst_end)
+			dst = dst_addr;
+	}
+
+	return dst;
+}
+
+/**
+ * Computes CRC-32 of data in circular buffer, handling wrap.
+ * @param base CRC-32 of preceding data or 0.
+ * @param ptr Read position in buffer.
+ * @param addr Start of buffer.
+ * @param end End of buffer.
+ * @param bytes Number of bytes to checksum.
+ * @return CRC-32 continued over the data.
+ */
+static inline uint32_t cir_buf_crc32(uint32_t base, const void *ptr,
+				     const void *addr, const void *end,
+				     uint32_t bytes)
+{
+	uint32_t head = MIN(bytes, (uint32_t)((char *)end - (char *)ptr));
+
+	base = crc32(base, ptr, head);
+	if (bytes > head)
+		base = crc32(base, addr, bytes - head);
+
+	return base;
+}
+
 /**
  * Copies data from source buffer to sink buffer.
  * @param source Source buffer.
@@ -434,26 +618,66 @@ static inline void audio_stream_copy(const struct audio_stream *source,
 				      (char *)source->r_ptr + ioffset_bytes);
 	void *snk = audio_stream_wrap(sink,
 				      (char *)sink->w_ptr + ooffset_bytes);
-	uint32_t bytes_src;
-	uint32_t bytes_snk;
-	uint32_t bytes_copied;
-	int ret;
 
-	while (bytes) {
-		bytes_src = (char *)source->end_addr - (char *)src;
-		bytes_snk = (char *)sink->end_addr - (char *)snk;
-		bytes_copied = MIN(bytes, MIN(bytes_src, bytes_snk));
+	/* nothing to do for streams sharing memory in-place */
+	if (src == snk)
+		return;
 
-		ret = memcpy_s(snk, bytes_snk, src, bytes_copied);
-		assert(!ret);
+	cir_buf_copy(src, source->addr, source->end_addr,
+		     snk, sink->addr, sink->end_addr, bytes);
+}
 
-		bytes -= bytes_copied;
-		src = (char *)src + bytes_copied;
-		snk = (char *)snk + bytes_copied;
+/**
+ * Writes zeros to the buffer in range [w_ptr, w_ptr+bytes],
+ * with rollover if necessary.
+ * @param buffer Buffer.
+ * @param bytes Size of the fragment to be zeroed.
+ */
+static inline void audio_stream_set_zero(struct audio_stream *buffer,
+					 uint32_t bytes)
+{
+	uint32_t head_size = bytes;
+	uint32_t tail_size = 0;
 
-		src = audio_stream_wrap(source, src);
-		snk = audio_stream_wrap(sink, snk);
+	/* check for potential wrap */
+	if ((char *)buffer->w_ptr + bytes > (char *)buffer->end_addr) {
+		head_size = (char *)buffer->end_addr - (char *)buffer->w_ptr;
+		tail_size = bytes - head_size;
 	}
+
+	bzero(buffer->w_ptr, head_size);
+	if (tail_size)
+		bzero(buffer->addr, tail_size);
+}
+
+/**
+ * Checks whether stream data is all zero.
+ * @param buffer Buffer holding the data.
+ * @param ptr Start of data, must be within the buffer.
+ * @param bytes Number of bytes to check, a multiple of 16-bit samples.
+ * @return True if every sample is zero.
+ */
+static inline bool audio_stream_is_zero(const struct audio_stream *buffer,
+					const void *ptr, uint32_t bytes)
+{
+	const uint16_t *x = ptr;
+	uint32_t n = bytes / sizeof(uint16_t);
+	uint32_t head;
+	uint32_t i;
+
+	while (n) {
+		head = MIN(n, audio_stream_bytes_without_wrap(buffer, x) /
+			   sizeof(uint16_t));
+
+		for (i = 0; i < head; i++)
+			if (x[i])
+				return false;
+
+		n -= head;
+		x = buffer->addr;
+	}
+
+	return true;
 }
 
 #if CONFIG_FORMAT_S16LE
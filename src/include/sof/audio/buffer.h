@@ -12,7 +12,9 @@
 #include <sof/audio/pipeline.h>
 #include <sof/math/numbers.h>
 #include <sof/common.h>
+#include <sof/compiler_attributes.h>
 #include <sof/debug/panic.h>
+#include <sof/debug/session.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
 #include <sof/list.h>
@@ -29,6 +31,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct buffer_group;
 struct comp_dev;
 
 /* buffer tracing */
@@ -65,20 +68,119 @@ struct comp_dev;
 #define BUFF_PARAMS_RATE	BIT(2)
 #define BUFF_PARAMS_CHANNELS	BIT(3)
 
-/* audio component buffer - connects 2 audio components together in pipeline */
-struct comp_buffer {
-	spinlock_t *lock;		/* locking mechanism */
+/*
+ * Indices of a buffer connecting components running on different cores.
+ * Write index is updated only by the producer core and read index only by
+ * the consumer core, so the data flow doesn't need the buffer lock. Indices
+ * run over twice the buffer size to tell a full buffer from an empty one
+ * and have separate cache lines not to be written back over each other.
+ */
+struct buffer_ring {
+	uint32_t w_idx;		/* written by producer */
+	uint8_t pad[PLATFORM_DCACHE_ALIGN - sizeof(uint32_t)];
+	uint32_t r_idx;		/* written by consumer */
+} __aligned(PLATFORM_DCACHE_ALIGN);
+
+#if CONFIG_BUFFER_TAP
+/*
+ * Read-only view of a buffer with its own read position, like a playback
+ * buffer giving the echo reference to a capture component. It sees the data
+ * produced into the buffer without copying it and doesn't hold back the
+ * producer, data older than the buffer size is dropped from the view.
+ */
+struct buffer_tap {
+	struct comp_buffer *buffer;	/* tapped buffer, NULL once freed */
+	struct comp_dev *dev;		/* reading component */
+	uint32_t avail;			/* produced bytes not read yet */
+	struct list_item list;		/* in taps of the buffer */
+};
+#endif
 
+#if CONFIG_PIPELINE_LATENCY
+/*
+ * Latency marker, a frame of the stream followed from its entry into the
+ * pipeline. A buffer holding it counts the bytes still ahead of the frame,
+ * the frame reaches the sink component once they have been consumed.
+ */
+struct latency_marker {
+	uint32_t seq;		/* measurement number, 0 if none */
+	uint32_t offset;	/* bytes ahead of the marked frame */
+	uint64_t stamp;		/* platform timer ticks at entry */
+};
+#endif
+
+/*
+ * audio component buffer - connects 2 audio components together in pipeline
+ *
+ * Stream state written by every produce and consume comes first, read-mostly
+ * configuration and linkage start on their own cache line, so that cache
+ * maintenance of buffers shared between cores touches only the part which
+ * has been changed.
+ */
+struct comp_buffer {
 	/* data buffer */
 	struct audio_stream stream;
 
+	spinlock_t *lock;		/* locking mechanism if inter_core */
+	struct buffer_ring *ring;	/* lock-free indices if inter_core */
+
+	/* digital silence, not tracked for inter_core buffers */
+	uint32_t silence;	/* bytes at the end of avail data being zero */
+	bool silence_next;	/* data of the next produce is zero */
+
 	/* configuration */
-	uint32_t id;
+	uint32_t id __aligned(PLATFORM_DCACHE_ALIGN);
 	uint32_t pipeline_id;
 	uint32_t caps;
 	uint32_t core;
 	bool inter_core; /* true if connected to a comp from another core */
 
+	/* memory set up only from params to reset, shared by group members */
+	struct buffer_group *group;
+
+	/* in-place chain, buffers processed in-place share one memory area */
+	struct comp_buffer *inplace_source;	/* buffer owning our memory */
+	struct comp_buffer *inplace_sink;	/* buffer using our memory */
+
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+	/* notifications sent at the end of pipeline run */
+	struct list_item notify_list;	/* list of pending notifications */
+	void *produce_begin;
+	uint32_t produce_bytes;
+	void *consume_begin;
+	uint32_t consume_bytes;
+	bool notify_sync;	/* listener needs data as soon as produced */
+#endif
+
+#if CONFIG_BUFFER_RESIZE
+	uint32_t tplg_size;	/* worst case size given by topology */
+#endif
+
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+	bool parked;	/* memory moved to LP heap while pipeline is idle */
+#endif
+
+#if CONFIG_BUFFER_TAP
+	struct list_item tap_list;	/* taps reading the buffer */
+#endif
+
+#if CONFIG_PIPELINE_LATENCY
+	struct latency_marker marker;	/* marked frame in the buffer */
+#endif
+
+#if CONFIG_BUFFER_BROADCAST
+	/* broadcast, a reader shares memory of its writer, the first sink
+	 * buffer of their source component, and reads what is produced there
+	 */
+	bool broadcast_reader;		/* reader declared by topology */
+	struct comp_buffer *broadcast;	/* writer of a joined reader */
+	struct list_item broadcast_list; /* readers of writer, or in them */
+#endif
+
+#if CONFIG_SESSION_RECORD
+	struct session_stats session;	/* input signal of host and DAI */
+#endif
+
 	/* connected components */
 	struct comp_dev *source;	/* source component */
 	struct comp_dev *sink;		/* sink component */
@@ -134,17 +236,206 @@ struct buffer_cb_free {
 
 
 /* pipeline buffer creation and destruction */
+/* Buffer memory is accessed through uncached alias if the platform has
+ * one, sparing cache maintenance of buffers touched once per period.
+ * This is a buffer capability, heaps are asked without it.
+ */
+#define BUFFER_CAPS_UNCACHED	BIT(31)
+
+/* capabilities of host and DAI DMA buffers */
+#if CONFIG_DMA_BUFFER_UNCACHED
+#define BUFFER_CAPS_DMA		(SOF_MEM_CAPS_DMA | BUFFER_CAPS_UNCACHED)
+#else
+#define BUFFER_CAPS_DMA		SOF_MEM_CAPS_DMA
+#endif
+
 struct comp_buffer *buffer_alloc(uint32_t size, uint32_t caps, uint32_t align);
 struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc);
 int buffer_set_size(struct comp_buffer *buffer, uint32_t size);
 void buffer_free(struct comp_buffer *buffer);
 
+/* take memory from buffer group when the pipeline is set up */
+int buffer_group_attach(struct comp_buffer *buffer);
+
+/* give memory back to buffer group when the pipeline is reset */
+void buffer_group_detach(struct comp_buffer *buffer);
+
+/* make buffer usable by components running on different cores */
+int buffer_set_inter_core(struct comp_buffer *buffer);
+
+/* let sink use memory of source, sink data is then written over source */
+int buffer_share_inplace(struct comp_buffer *source, struct comp_buffer *sink);
+
+/* give buffer its own memory again */
+int buffer_unshare_inplace(struct comp_buffer *buffer);
+
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+/* move memory of idle buffer to LP heap, keeping its data and positions */
+int buffer_park(struct comp_buffer *buffer);
+
+/* move memory of parked buffer back to heap with its caps */
+int buffer_unpark(struct comp_buffer *buffer);
+#endif
+
+#if CONFIG_BUFFER_COMPACTION
+/* move memory of idle buffer to a lower hole of its heap if there is one,
+ * returns true if the buffer has been moved
+ */
+bool buffer_compact(struct comp_buffer *buffer);
+#endif
+
 /* called by a component after producing data into this buffer */
 void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes);
 
 /* called by a component after consuming data from this buffer */
 void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes);
 
+#if CONFIG_BUFFER_TAP
+/**
+ * Starts reading a buffer through a tap, from the next produced data on.
+ * Tap and buffer have to be on the core of the reading component, whose
+ * pipeline is then run after the producer of the buffer in every tick.
+ * @param tap Tap owned by the reading component.
+ * @param buffer Buffer to read.
+ * @param dev Reading component.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int buffer_tap_attach(struct buffer_tap *tap, struct comp_buffer *buffer,
+		      struct comp_dev *dev);
+
+/**
+ * Stops reading through a tap, also safe once the buffer has been freed.
+ * @param tap Tap of buffer_tap_attach().
+ */
+void buffer_tap_detach(struct buffer_tap *tap);
+
+/**
+ * Gives the unread data of a tap as a stream, for the processing helpers
+ * working on audio_stream. The stream must not be written.
+ * @param tap Attached tap.
+ * @param view Filled with the stream of the buffer at the tap position.
+ */
+static inline void buffer_tap_stream(const struct buffer_tap *tap,
+				     struct audio_stream *view)
+{
+	char *r_ptr;
+
+	*view = tap->buffer->stream;
+
+	r_ptr = (char *)view->w_ptr - tap->avail;
+	if (r_ptr < (char *)view->addr)
+		r_ptr += view->size;
+
+	view->r_ptr = r_ptr;
+	view->avail = tap->avail;
+	view->free = view->size - tap->avail;
+}
+
+/**
+ * Marks data of a tap read.
+ * @param tap Attached tap.
+ * @param bytes Bytes read from the tap stream.
+ */
+static inline void buffer_tap_consume(struct buffer_tap *tap, uint32_t bytes)
+{
+	tap->avail -= MIN(bytes, tap->avail);
+}
+
+/* forgets data seen by the taps of a buffer, its contents have changed */
+static inline void buffer_tap_reset(struct comp_buffer *buffer)
+{
+	struct list_item *tlist;
+
+	list_for_item(tlist, &buffer->tap_list)
+		container_of(tlist, struct buffer_tap, list)->avail = 0;
+}
+#else
+static inline void buffer_tap_reset(struct comp_buffer *buffer) { }
+#endif
+
+#if CONFIG_BUFFER_BROADCAST
+/**
+ * Lets a broadcast reader read the data produced into its writer from
+ * the next produce on. Its memory is released and it uses the writer's.
+ * Both buffers have to be on one core and carry the same stream format.
+ * @param reader Buffer flagged broadcast by topology, joined or not.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int buffer_broadcast_join(struct comp_buffer *reader);
+
+/**
+ * Gives a joined broadcast reader its own memory again, the writer is no
+ * longer held back by it.
+ * @param reader Buffer flagged broadcast by topology, joined or not.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int buffer_broadcast_leave(struct comp_buffer *reader);
+
+/* moves reader, or all readers of writer, to the write position */
+void buffer_broadcast_reset(struct comp_buffer *buffer);
+
+/* tells if the buffer memory is shared by broadcast */
+static inline bool buffer_broadcast_member(const struct comp_buffer *buffer)
+{
+	return buffer->broadcast || !list_is_empty(&buffer->broadcast_list);
+}
+
+/* tells if the buffer reads the data of another one */
+static inline bool buffer_broadcast_joined(const struct comp_buffer *buffer)
+{
+	return buffer->broadcast;
+}
+#else
+static inline void buffer_broadcast_reset(struct comp_buffer *buffer) { }
+static inline bool buffer_broadcast_member(const struct comp_buffer *buffer)
+{
+	return false;
+}
+
+static inline bool buffer_broadcast_joined(const struct comp_buffer *buffer)
+{
+	return false;
+}
+#endif
+
+#if CONFIG_PIPELINE_LATENCY
+/* drops the marked frame of a buffer, its contents have changed */
+static inline void buffer_marker_reset(struct comp_buffer *buffer)
+{
+	buffer->marker.seq = 0;
+}
+#else
+static inline void buffer_marker_reset(struct comp_buffer *buffer) { }
+#endif
+
+/**
+ * Marks data of the next comp_update_buffer_produce() as digital silence,
+ * called by producers which know they have written only zeros. Consumers
+ * can then skip their processing with buffer_is_silent().
+ * @param buffer Buffer instance.
+ */
+static inline void buffer_mark_silence(struct comp_buffer *buffer)
+{
+	buffer->silence_next = true;
+}
+
+/**
+ * Tells whether all available data of the buffer is digital silence.
+ * @param buffer Buffer instance.
+ * @return True if the consumer can take the data as zeros without reading.
+ */
+static inline bool buffer_is_silent(const struct comp_buffer *buffer)
+{
+	return buffer->silence && buffer->silence >= buffer->stream.avail;
+}
+
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+/* sends produce and consume notifications deferred on this core */
+void buffer_notify_flush(void);
+#else
+static inline void buffer_notify_flush(void) { }
+#endif
+
 static inline void buffer_invalidate(struct comp_buffer *buffer, uint32_t bytes)
 {
 	if (!buffer->inter_core)
@@ -161,10 +452,67 @@ static inline void buffer_writeback(struct comp_buffer *buffer, uint32_t bytes)
 	audio_stream_writeback(&buffer->stream, bytes);
 }
 
+static inline uint32_t buffer_ring_add(const struct comp_buffer *buffer,
+				       uint32_t idx, uint32_t bytes)
+{
+	idx += bytes;
+	if (idx >= 2 * buffer->stream.size)
+		idx -= 2 * buffer->stream.size;
+
+	return idx;
+}
+
+static inline uint32_t buffer_ring_sub(const struct comp_buffer *buffer,
+				       uint32_t idx, uint32_t bytes)
+{
+	return idx >= bytes ? idx - bytes : idx + 2 * buffer->stream.size -
+		bytes;
+}
+
+static inline void buffer_ring_reset(struct comp_buffer *buffer)
+{
+	if (!buffer->ring)
+		return;
+
+	buffer->ring->w_idx = 0;
+	buffer->ring->r_idx = 0;
+}
+
+/**
+ * Updates stream pointers seen by the current core from ring indices.
+ * @param buffer Buffer instance.
+ * @return Write index the stream state is based on.
+ */
+static inline uint32_t buffer_ring_sync(struct comp_buffer *buffer)
+{
+	struct audio_stream *stream = &buffer->stream;
+	uint32_t w_idx = buffer->ring->w_idx;
+	uint32_t avail = buffer_ring_sub(buffer, w_idx, buffer->ring->r_idx);
+	uint32_t w_off = w_idx;
+	uint32_t r_off;
+
+	if (w_off >= stream->size)
+		w_off -= stream->size;
+
+	/* producer has overwritten the oldest data */
+	avail = MIN(avail, stream->size);
+
+	r_off = w_off >= avail ? w_off - avail : w_off + stream->size - avail;
+
+	stream->w_ptr = (char *)stream->addr + w_off;
+	stream->r_ptr = (char *)stream->addr + r_off;
+	stream->avail = avail;
+	stream->free = stream->size - avail;
+
+	return w_idx;
+}
+
 /**
  * Locks buffer instance for buffers connecting components
  * running on different cores. Buffer parameters will be invalidated
  * to make sure the latest data can be retrieved.
+ * Buffers with ring indices are not locked, their stream pointers
+ * are refreshed from the indices instead.
  * @param buffer Buffer instance.
  * @param flags IRQ flags.
  */
@@ -173,10 +521,14 @@ static inline void buffer_lock(struct comp_buffer *buffer, uint32_t *flags)
 	if (!buffer->inter_core)
 		return;
 
-	spin_lock_irq(buffer->lock, *flags);
+	if (!buffer->ring)
+		spin_lock_irq(buffer->lock, *flags);
 
 	/* invalidate in case something has changed during our wait */
 	dcache_invalidate_region(buffer, sizeof(*buffer));
+
+	if (buffer->ring)
+		buffer_ring_sync(buffer);
 }
 
 /**
@@ -194,10 +546,41 @@ static inline void buffer_unlock(struct comp_buffer *buffer, uint32_t flags)
 
 	/* save lock pointer to avoid memory access after cache flushing */
 	spinlock_t *lock = buffer->lock;
+	struct buffer_ring *ring = buffer->ring;
 
 	/* wtb and inv to avoid buffer locking in read only situations */
 	dcache_writeback_invalidate_region(buffer, sizeof(*buffer));
 
+	if (!ring)
+		spin_unlock_irq(lock, flags);
+}
+
+/* stream state is kept apart from configuration, see struct comp_buffer */
+#define BUFFER_STREAM_BYTES	offsetof(struct comp_buffer, id)
+
+/**
+ * Unlocks buffer instance after the stream state only has been changed,
+ * like in produce and consume. Only the stream state is flushed, ring
+ * buffers don't flush it at all as every core derives it from the ring
+ * indices on lock.
+ * @param buffer Buffer instance.
+ * @param flags IRQ flags.
+ */
+static inline void buffer_stream_unlock(struct comp_buffer *buffer,
+					uint32_t flags)
+{
+	if (!buffer->inter_core)
+		return;
+
+	/* save lock pointer to avoid memory access after cache flushing */
+	spinlock_t *lock = buffer->lock;
+
+	/* local view of ring stream state, refreshed by the next lock */
+	if (buffer->ring)
+		return;
+
+	dcache_writeback_invalidate_region(buffer, BUFFER_STREAM_BYTES);
+
 	spin_unlock_irq(lock, flags);
 }
 
@@ -217,12 +600,29 @@ static inline void buffer_reset_pos(struct comp_buffer *buffer, void *data)
 
 	buffer_lock(buffer, &flags);
 
+	buffer->silence = 0;
+	buffer->silence_next = false;
+	buffer_tap_reset(buffer);
+	buffer_marker_reset(buffer);
+
+	/* memory of a reader is in use by its writer */
+	if (buffer_broadcast_joined(buffer)) {
+		buffer_broadcast_reset(buffer);
+		buffer_unlock(buffer, flags);
+		return;
+	}
+
 	/* reset rw pointers and avail/free bytes counters */
 	audio_stream_reset(&buffer->stream);
+	buffer_ring_reset(buffer);
 
 	/* clear buffer contents */
 	buffer_zero(buffer);
 
+	/* readers follow their writer */
+	if (buffer_broadcast_member(buffer))
+		buffer_broadcast_reset(buffer);
+
 	buffer_unlock(buffer, flags);
 }
 
@@ -233,6 +633,7 @@ static inline void buffer_init(struct comp_buffer *buffer, uint32_t size,
 
 	/* addr should be set in alloc function */
 	audio_stream_init(&buffer->stream, buffer->stream.addr, size);
+	buffer_ring_reset(buffer);
 }
 
 static inline void buffer_reset_params(struct comp_buffer *buffer, void *data)
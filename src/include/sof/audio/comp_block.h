@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/audio/comp_block.h
+ * \brief Fixed block size adapter for components
+ *
+ * Components whose driver sets comp_driver::block_frames process blocks of
+ * that many frames with comp_ops::process() instead of a period with
+ * comp_ops::copy(). The adapter collects source frames to blocks in the
+ * pipeline task and hands a full block to an EDF task of the component,
+ * which has until the next block is due to process it. The pipeline task
+ * meanwhile moves earlier output to the sink, so it doesn't run the block
+ * processing itself. The output is delayed by two blocks.
+ */
+
+#ifndef __SOF_AUDIO_COMP_BLOCK_H__
+#define __SOF_AUDIO_COMP_BLOCK_H__
+
+#include <sof/audio/audio_stream.h>
+#include <sof/schedule/task.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct comp_dev;
+
+/** \brief Block adapter state of a component. */
+struct comp_block {
+	struct comp_dev *dev;		/**< adapted component */
+	struct audio_stream in[2];	/**< blocks filled and processed */
+	struct audio_stream result;	/**< output of processed block */
+	struct audio_stream out;	/**< output passed to the sink */
+	struct task task;		/**< EDF task processing blocks */
+	uint64_t deadline;		/**< deadline of block in process */
+	uint64_t deadline_ticks;	/**< time to process a block */
+	uint32_t frames;		/**< block frames */
+	int fill;			/**< index of block being filled */
+	bool busy;			/**< in[fill ^ 1] given to the task */
+	int ret;			/**< result of last processing */
+};
+
+#if CONFIG_COMP_BLOCK
+
+/**
+ * Sets up block adapter of prepared component.
+ * @param dev Component device with one source and one sink buffer.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int comp_block_prepare(struct comp_dev *dev);
+
+/**
+ * Cancels block processing and frees the adapter.
+ * @param dev Component device.
+ */
+void comp_block_free(struct comp_dev *dev);
+
+/**
+ * Copies source frames to blocks and processed blocks to sink.
+ * @param dev Component device.
+ * @return 0 if succeeded, error code of the last block processing otherwise.
+ */
+int comp_block_copy(struct comp_dev *dev);
+
+#else
+
+static inline int comp_block_prepare(struct comp_dev *dev) { return -ENOTSUP; }
+static inline void comp_block_free(struct comp_dev *dev) { }
+static inline int comp_block_copy(struct comp_dev *dev) { return -ENOTSUP; }
+
+#endif /* CONFIG_COMP_BLOCK */
+
+#endif /* __SOF_AUDIO_COMP_BLOCK_H__ */
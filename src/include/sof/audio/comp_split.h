@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/audio/comp_split.h
+ * \brief Channel split adapter for components
+ *
+ * Components implementing comp_ops::process_channels() declare their
+ * channels independent, so ranges of channels of a period may be processed
+ * in parallel. The adapter cuts the channels to as many ranges as there
+ * are enabled cores, with at least CONFIG_COMP_CHANNEL_SPLIT_MIN_CHANNELS
+ * channels in each and ranges starting at even channels. The first range
+ * is processed by the owner core straight to the sink, the others are
+ * queued to the other cores as asynchronous IDC messages and processed
+ * to scratch streams, which the owner core merges to the sink once all
+ * of them are done, in the same tick.
+ *
+ * Other cores access the component's private data uncached or through
+ * their own caches, so process_channels() may touch only state of its
+ * channels and components have to keep that state in shared memory.
+ */
+
+#ifndef __SOF_AUDIO_COMP_SPLIT_H__
+#define __SOF_AUDIO_COMP_SPLIT_H__
+
+#include <sof/audio/audio_stream.h>
+#include <errno.h>
+#include <stdint.h>
+
+struct comp_dev;
+
+/** \brief Range of channels processed by one core. */
+struct comp_split_part {
+	struct audio_stream sink;	/**< output, unused by the first range */
+	uint32_t core;			/**< core processing the range */
+	uint32_t first;			/**< first channel of the range */
+	uint32_t count;			/**< channels of the range */
+};
+
+/** \brief Channel split adapter state of a component, in shared memory. */
+struct comp_split {
+	struct comp_dev *dev;		/**< adapted component */
+	struct audio_stream source;	/**< source of the copy in progress */
+	uint32_t frames;		/**< frames of the copy in progress */
+	uint32_t frames_max;		/**< frames fitting scratch streams */
+	uint32_t core_mask;		/**< cores processing other ranges */
+	uint32_t num_parts;		/**< number of channel ranges */
+	struct comp_split_part part[];	/**< channel ranges */
+};
+
+#if CONFIG_COMP_CHANNEL_SPLIT
+
+/**
+ * Sets up channel split of prepared component, if there are enough
+ * channels and cores to split.
+ * @param dev Component device with one source and one sink buffer.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int comp_split_prepare(struct comp_dev *dev);
+
+/**
+ * Frees the channel split adapter.
+ * @param dev Component device.
+ */
+void comp_split_free(struct comp_dev *dev);
+
+/**
+ * Processes available frames with all cores of the split.
+ * @param dev Component device.
+ * @return 0 if succeeded, error code of the first failed range otherwise.
+ */
+int comp_split_copy(struct comp_dev *dev);
+
+/**
+ * Processes a range of the copy in progress, called on its core.
+ * @param dev Component device.
+ * @param part Index of the range.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int comp_split_run(struct comp_dev *dev, uint32_t part);
+
+#else
+
+static inline int comp_split_prepare(struct comp_dev *dev) { return 0; }
+static inline void comp_split_free(struct comp_dev *dev) { }
+static inline int comp_split_copy(struct comp_dev *dev) { return -ENOTSUP; }
+static inline int comp_split_run(struct comp_dev *dev, uint32_t part)
+{
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_COMP_CHANNEL_SPLIT */
+
+#endif /* __SOF_AUDIO_COMP_SPLIT_H__ */
@@ -42,7 +42,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct buffer_tap;
+struct comp_block;
 struct comp_dev;
+struct comp_split;
+struct sof_man_overlay;
 struct sof_ipc_dai_config;
 struct sof_ipc_stream_posn;
 struct dai_hw_params;
@@ -114,6 +118,18 @@ struct dai_hw_params;
  */
 #define COMP_ATTR_COPY_TYPE	0	/**< Comp copy type attribute */
 #define COMP_ATTR_HOST_BUFFER	1	/**< Comp host buffer attribute */
+#define COMP_ATTR_QUALITY	2	/**< Comp processing quality attribute */
+/** @}*/
+
+/** \name Component processing quality levels
+ *  Set as uint32_t COMP_ATTR_QUALITY, a component runs at the cheapest
+ *  level it implements which isn't cheaper than the requested one. The
+ *  level applies from the next copy until the component is reset.
+ *  @{
+ */
+#define COMP_QUALITY_FULL	0	/**< Full processing quality */
+#define COMP_QUALITY_LOW	1	/**< Cheaper processing, lower quality */
+#define COMP_QUALITY_BYPASS	2	/**< Processing bypassed */
 /** @}*/
 
 /** \name Trace macros
@@ -198,6 +214,18 @@ struct dai_hw_params;
 	trace_dev_dbg(TRACE_CLASS_COMP, trace_comp_get_uid, trace_comp_get_id, \
 		      trace_comp_get_subid, comp_p, __e, ##__VA_ARGS__)
 
+/** \brief Trace begin of a timeline span of component device */
+#define comp_timeline_begin(comp_p, __e, ...)				\
+	trace_dev_timeline_begin(TRACE_CLASS_COMP, trace_comp_get_uid,	\
+				 trace_comp_get_id, trace_comp_get_subid, \
+				 comp_p, __e, ##__VA_ARGS__)
+
+/** \brief Trace end of a timeline span of component device */
+#define comp_timeline_end(comp_p, __e, ...)				\
+	trace_dev_timeline_end(TRACE_CLASS_COMP, trace_comp_get_uid,	\
+			       trace_comp_get_id, trace_comp_get_subid,	\
+			       comp_p, __e, ##__VA_ARGS__)
+
 #define comp_perf_info(pcd, comp_p)					\
 	comp_info(comp_p, "perf comp_copy peak plat %lu cpu %lu",	\
 		  (pcd)->plat_delta_peak, (pcd)->cpu_delta_peak)
@@ -246,6 +274,11 @@ struct comp_ops {
 	 * comp_set_drvdata() and later retrieved by comp_get_drvdata().
 	 *
 	 * All parameters should be initialized to their default values.
+	 *
+	 * Components are created at topology load and live until the
+	 * topology is freed, so state needed only while streaming (delay
+	 * lines, filter and feature state) is allocated by params() or
+	 * prepare() and freed by reset() instead.
 	 */
 	struct comp_dev *(*create)(const struct comp_driver *drv,
 				   struct sof_ipc_comp *comp);
@@ -267,6 +300,32 @@ struct comp_ops {
 	int (*params)(struct comp_dev *dev,
 		      struct sof_ipc_stream_params *params);
 
+	/**
+	 * Changes audio stream parameters of a prepared or running
+	 * component in place, without reset and prepare.
+	 * @param dev Component device.
+	 * @param params New audio (PCM) stream parameters.
+	 *
+	 * Optional, streams through components without it can't be
+	 * reconfigured.
+	 */
+	int (*reconfig)(struct comp_dev *dev,
+			struct sof_ipc_stream_params *params);
+
+	/**
+	 * Checks if component processes stream from source to sink
+	 * frame format.
+	 * @param dev Component device.
+	 * @param source Source frame format.
+	 * @param sink Sink frame format.
+	 *
+	 * Optional, used by pipeline format planning. Components without
+	 * it are taken to keep any format unchanged.
+	 */
+	bool (*frame_fmt_supported)(struct comp_dev *dev,
+				    enum sof_ipc_frame source,
+				    enum sof_ipc_frame sink);
+
 	/**
 	 * Fetches hardware stream parameters.
 	 * @param dev Component device.
@@ -314,7 +373,7 @@ struct comp_ops {
 	int (*prepare)(struct comp_dev *dev);
 
 	/**
-	 * Resets component.
+	 * Resets component, called when the stream is freed.
 	 * @param dev Component device.
 	 */
 	int (*reset)(struct comp_dev *dev);
@@ -326,6 +385,42 @@ struct comp_ops {
 	 */
 	int (*copy)(struct comp_dev *dev);
 
+	/**
+	 * Processes frames from source to sink stream, optional.
+	 * @param dev Component device.
+	 * @param source Source stream, read from its read pointer.
+	 * @param sink Sink stream, written from its write pointer.
+	 * @param frames Number of frames to process.
+	 *
+	 * Stream pointers are not updated. Implemented by components with
+	 * one source and one sink whose copy() does nothing else than this
+	 * processing, so the pipeline may run a chain of them block by block
+	 * without passing the samples through the buffers in between.
+	 */
+	int (*process)(struct comp_dev *dev,
+		       const struct audio_stream *source,
+		       struct audio_stream *sink, uint32_t frames);
+
+	/**
+	 * Processes a range of channels from source to sink stream,
+	 * optional.
+	 * @param dev Component device.
+	 * @param source Source stream, read from its read pointer.
+	 * @param sink Sink stream, written from its write pointer.
+	 * @param frames Number of frames to process.
+	 * @param first First channel to process.
+	 * @param count Number of channels to process.
+	 *
+	 * Same as process() for the channels of the range, which are at the
+	 * same positions in both streams. Other channels of the sink are
+	 * not written. Calls for disjoint ranges may run at the same time
+	 * on different cores, see comp_split.h.
+	 */
+	int (*process_channels)(struct comp_dev *dev,
+				const struct audio_stream *source,
+				struct audio_stream *sink, uint32_t frames,
+				uint32_t first, uint32_t count);
+
 	/**
 	 * Retrieves component rendering position.
 	 * @param dev Component device.
@@ -379,6 +474,20 @@ struct comp_ops {
 			  struct timestamp_data *tsd);
 };
 
+/** \name Component driver flags
+ *  @{
+ */
+/** Each sample is read before the sample at the same position is written,
+ *  so source and sink buffer may share memory if their formats match.
+ */
+#define COMP_DRV_INPLACE	BIT(0)
+/** Each sink channel depends only on the source channel at the same
+ *  position, so only the active channels of the sink are needed from the
+ *  source.
+ */
+#define COMP_DRV_CHANNEL_WISE	BIT(1)
+/** @}*/
+
 /**
  * Audio component base driver "class"
  * - used by all other component types.
@@ -386,6 +495,14 @@ struct comp_ops {
 struct comp_driver {
 	uint32_t type;		/**< SOF_COMP_ for driver */
 	uint32_t uid;		/**< Address of uuid_entry */
+	uint32_t flags;		/**< COMP_DRV_ flags */
+	uint32_t block_frames;	/**< frames per comp_ops::process() of a
+				  *  block adapted component, 0 if copy()
+				  *  processes periods, see comp_block.h
+				  */
+	struct sof_man_overlay *overlay;	/**< code overlay mapped while
+						  *  prepared, NULL if none
+						  */
 	struct comp_ops ops;	/**< component operations */
 };
 
@@ -409,11 +526,13 @@ struct comp_dev {
 
 	uint32_t min_sink_bytes;   /**< min free sink buffer size measured in
 				     *  bytes required to run component's
-				     *  processing
+				     *  processing, checked by the pipeline
+				     *  before copy if data driven, 0 if none
 				     */
 	uint32_t min_source_bytes; /**< amount of data measured in bytes
 				     *  available at source buffer required
-				     *  to run component's processing
+				     *  to run component's processing,
+				     *  checked like min_sink_bytes
 				     */
 
 	struct task *task;	/**< component's processing task used only
@@ -431,6 +550,23 @@ struct comp_dev {
 	uint32_t direction;	/**< enum sof_ipc_stream_direction */
 
 	const struct comp_driver *drv;	/**< driver */
+#if CONFIG_COMP_BLOCK
+	struct comp_block *block;	/**< block adapter of component */
+#endif
+#if CONFIG_BUFFER_TAP
+	struct buffer_tap *tap;		/**< buffer read by the component */
+#endif
+#if CONFIG_PIPELINE_LATENCY
+	uint32_t delay_frames;		/**< algorithmic delay in sink frames */
+	uint32_t marker_seq;		/**< last latency marker taken */
+	uint64_t marker_stamp;		/**< entry time of the marker */
+	uint64_t marker_arrival;	/**< time the marker was taken */
+	bool marker_pending;		/**< marker not passed on yet */
+#endif
+	struct comp_split *split;	/**< channel split of component */
+#if CONFIG_COMP_OVERLAYS
+	bool overlay_mapped;		/**< driver overlay is mapped */
+#endif
 
 	/* lists */
 	struct list_item bsource_list;	/**< list of source buffers */
@@ -16,8 +16,12 @@
 #ifndef __SOF_AUDIO_COMPONENT_INT_H__
 #define __SOF_AUDIO_COMPONENT_INT_H__
 
+#include <sof/audio/comp_block.h>
+#include <sof/audio/comp_split.h>
 #include <sof/audio/component.h>
 #include <sof/drivers/idc.h>
+#include <sof/lib/overlay.h>
+#include <sof/lib/scratch.h>
 #include <sof/list.h>
 #include <ipc/topology.h>
 #include <kernel/abi.h>
@@ -30,6 +34,9 @@
 /** \brief Holds list of registered components' drivers */
 struct comp_driver_list {
 	struct list_item list;	/**< list of component drivers */
+#if CONFIG_COMP_LIB_LOAD
+	struct list_item libs;	/**< list of loaded component libraries */
+#endif
 };
 
 /** \brief Retrieves the component device buffer list. */
@@ -40,6 +47,53 @@ struct comp_driver_list {
 /** See comp_ops::new */
 struct comp_dev *comp_new(struct sof_ipc_comp *comp);
 
+#if CONFIG_COMP_LIB_LOAD
+/**
+ * Relocates component library to runtime memory and registers its drivers.
+ * @param lib Library starting with struct sof_comp_lib_hdr.
+ * @param size Library size in bytes.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int comp_lib_load(void *lib, uint32_t size);
+#endif
+
+#if CONFIG_COMP_OVERLAYS
+/**
+ * Maps code overlay of the component driver until comp_overlay_unmap().
+ * @param dev Component device.
+ * @return 0 if succeeded, -EBUSY if another overlay is in use.
+ */
+static inline int comp_overlay_map(struct comp_dev *dev)
+{
+	int ret;
+
+	if (!dev->drv->overlay || dev->overlay_mapped)
+		return 0;
+
+	ret = overlay_map(dev->drv->overlay);
+	if (!ret)
+		dev->overlay_mapped = true;
+
+	return ret;
+}
+
+static inline void comp_overlay_unmap(struct comp_dev *dev)
+{
+	if (!dev->overlay_mapped)
+		return;
+
+	overlay_unmap(dev->drv->overlay);
+	dev->overlay_mapped = false;
+}
+#else
+static inline int comp_overlay_map(struct comp_dev *dev)
+{
+	return 0;
+}
+
+static inline void comp_overlay_unmap(struct comp_dev *dev) { }
+#endif
+
 /** See comp_ops::free */
 static inline void comp_free(struct comp_dev *dev)
 {
@@ -51,6 +105,10 @@ static inline void comp_free(struct comp_dev *dev)
 		rfree(dev->task);
 	}
 
+	comp_block_free(dev);
+	comp_split_free(dev);
+	comp_overlay_unmap(dev);
+
 	dev->drv->ops.free(dev);
 }
 
@@ -64,11 +122,18 @@ static inline void comp_shared_commit(struct comp_dev *dev)
 		platform_shared_commit(dev, sizeof(*dev));
 }
 
+/** Tells if commands to the component are sent to another core */
+static inline bool comp_is_remote(struct comp_dev *dev)
+{
+	return dev->is_shared && !cpu_is_me(dev->comp.core);
+}
+
 /**
- * Parameter init for component on other core.
+ * Parameter init for component on other core. The command is queued,
+ * its result is collected with idc_wait_async() for the component's core.
  * @param dev Component device.
  * @param params Parameters to be set.
- * @return 0 if succeeded, error code otherwise.
+ * @return 0 if queued, error code otherwise.
  */
 static inline int comp_params_remote(struct comp_dev *dev,
 				     struct sof_ipc_stream_params *params)
@@ -76,25 +141,55 @@ static inline int comp_params_remote(struct comp_dev *dev,
 	struct idc_msg msg = { IDC_MSG_PARAMS, IDC_MSG_PARAMS_EXT(dev->comp.id),
 		dev->comp.core, sizeof(*params), params, };
 
-	return idc_send_msg(&msg, IDC_BLOCKING);
+	return idc_send_msg(&msg, IDC_ASYNC);
 }
 
 /** See comp_ops::params */
 static inline int comp_params(struct comp_dev *dev,
 			      struct sof_ipc_stream_params *params)
 {
+	uint32_t owner = alloc_owner_set(ALLOC_OWNER(dev->comp.id));
 	int ret = 0;
 
 	if (dev->drv->ops.params)
-		ret = (dev->is_shared && !cpu_is_me(dev->comp.core)) ?
+		ret = comp_is_remote(dev) ?
 			comp_params_remote(dev, params) :
 			dev->drv->ops.params(dev, params);
 
+	alloc_owner_set(owner);
+
+	comp_shared_commit(dev);
+
+	return ret;
+}
+
+/** See comp_ops::reconfig */
+static inline int comp_reconfig(struct comp_dev *dev,
+				struct sof_ipc_stream_params *params)
+{
+	int ret;
+
+	if (!dev->drv->ops.reconfig || comp_is_remote(dev))
+		return -ENOTSUP;
+
+	ret = dev->drv->ops.reconfig(dev, params);
+
 	comp_shared_commit(dev);
 
 	return ret;
 }
 
+/** See comp_ops::frame_fmt_supported */
+static inline bool comp_frame_fmt_supported(struct comp_dev *dev,
+					    enum sof_ipc_frame source,
+					    enum sof_ipc_frame sink)
+{
+	if (!dev->drv->ops.frame_fmt_supported)
+		return source == sink;
+
+	return dev->drv->ops.frame_fmt_supported(dev, source, sink);
+}
+
 /** See comp_ops::dai_get_hw_params */
 static inline int comp_dai_get_hw_params(struct comp_dev *dev,
 					 struct sof_ipc_stream_params *params,
@@ -125,6 +220,15 @@ static inline int comp_cmd(struct comp_dev *dev, int cmd, void *data,
 		goto out;
 	}
 
+	/* quality level is common to components, see COMP_ATTR_QUALITY */
+	if (cmd == COMP_CMD_SET_VALUE && cdata->cmd == SOF_CTRL_CMD_QUALITY) {
+		if (cdata->num_elems && dev->drv->ops.set_attribute)
+			ret = dev->drv->ops.set_attribute(dev,
+							  COMP_ATTR_QUALITY,
+							  &cdata->chanv[0].value);
+		goto out;
+	}
+
 	if (dev->drv->ops.cmd)
 		ret = dev->drv->ops.cmd(dev, cmd, data, max_data_size);
 
@@ -135,7 +239,8 @@ out:
 }
 
 /**
- * Runs comp_ops::trigger on the core the target component is assigned to.
+ * Queues comp_ops::trigger on the core the target component is assigned to,
+ * result is collected with idc_wait_async().
  */
 static inline int comp_trigger_remote(struct comp_dev *dev, int cmd)
 {
@@ -143,7 +248,7 @@ static inline int comp_trigger_remote(struct comp_dev *dev, int cmd)
 		IDC_MSG_TRIGGER_EXT(dev->comp.id), dev->comp.core, sizeof(cmd),
 		&cmd, };
 
-	return idc_send_msg(&msg, IDC_BLOCKING);
+	return idc_send_msg(&msg, IDC_ASYNC);
 }
 
 /** See comp_ops::trigger */
@@ -153,7 +258,7 @@ static inline int comp_trigger(struct comp_dev *dev, int cmd)
 
 	assert(dev->drv->ops.trigger);
 
-	ret = (dev->is_shared && !cpu_is_me(dev->comp.core)) ?
+	ret = comp_is_remote(dev) ?
 		comp_trigger_remote(dev, cmd) : dev->drv->ops.trigger(dev, cmd);
 
 	comp_shared_commit(dev);
@@ -161,47 +266,99 @@ static inline int comp_trigger(struct comp_dev *dev, int cmd)
 	return ret;
 }
 
-/** Runs comp_ops::prepare on the target component's core */
+/**
+ * Queues comp_ops::prepare on the target component's core, result is
+ * collected with idc_wait_async().
+ */
 static inline int comp_prepare_remote(struct comp_dev *dev)
 {
 	struct idc_msg msg = { IDC_MSG_PREPARE,
 		IDC_MSG_PREPARE_EXT(dev->comp.id), dev->comp.core, };
 
-	return idc_send_msg(&msg, IDC_BLOCKING);
+	return idc_send_msg(&msg, IDC_ASYNC);
 }
 
 /** See comp_ops::prepare */
 static inline int comp_prepare(struct comp_dev *dev)
 {
+	uint32_t owner = alloc_owner_set(ALLOC_OWNER(dev->comp.id));
 	int ret = 0;
 
 	if (dev->drv->ops.prepare)
-		ret = (dev->is_shared && !cpu_is_me(dev->comp.core)) ?
+		ret = comp_is_remote(dev) ?
 			comp_prepare_remote(dev) : dev->drv->ops.prepare(dev);
 
+	/* blocks are set up once the component knows its period */
+	if (!ret && dev->drv->block_frames)
+		ret = comp_block_prepare(dev);
+	else if (!ret && dev->drv->ops.process_channels)
+		ret = comp_split_prepare(dev);
+
+	alloc_owner_set(owner);
+
 	comp_shared_commit(dev);
 
 	return ret;
 }
 
+/* block adapted components are copied by the adapter */
+static inline bool comp_is_block(struct comp_dev *dev)
+{
+#if CONFIG_COMP_BLOCK
+	return dev->block;
+#else
+	return false;
+#endif
+}
+
 /** See comp_ops::copy */
 static inline int comp_copy(struct comp_dev *dev)
 {
+	size_t scratch;
 	int ret = 0;
 
-	assert(dev->drv->ops.copy);
+	assert(dev->drv->ops.copy || dev->drv->block_frames);
 
 	/* copy only if we are the owner of the component */
 	if (cpu_is_me(dev->comp.core)) {
+		comp_timeline_begin(dev, "comp copy");
 		perf_cnt_init(&dev->pcd);
-		ret = dev->drv->ops.copy(dev);
+		scratch = scratch_mark();
+		if (comp_is_block(dev))
+			ret = comp_block_copy(dev);
+		else if (dev->split)
+			ret = comp_split_copy(dev);
+		else
+			ret = dev->drv->ops.copy(dev);
+		/* workspace of the copy is free for the next component */
+		scratch_restore(scratch);
 		perf_cnt_stamp(&dev->pcd, comp_perf_info, dev);
+		comp_timeline_end(dev, "comp copy");
 	}
 	comp_shared_commit(dev);
 
 	return ret;
 }
 
+/** See comp_ops::process */
+static inline int comp_process(struct comp_dev *dev,
+			       const struct audio_stream *source,
+			       struct audio_stream *sink, uint32_t frames)
+{
+	return dev->drv->ops.process(dev, source, sink, frames);
+}
+
+/** See comp_ops::process_channels */
+static inline int comp_process_channels(struct comp_dev *dev,
+					const struct audio_stream *source,
+					struct audio_stream *sink,
+					uint32_t frames, uint32_t first,
+					uint32_t count)
+{
+	return dev->drv->ops.process_channels(dev, source, sink, frames,
+					      first, count);
+}
+
 /** See comp_ops::set_attribute */
 static inline int comp_set_attribute(struct comp_dev *dev, uint32_t type,
 				     void *value)
@@ -235,9 +392,12 @@ static inline int comp_reset(struct comp_dev *dev)
 	int ret = 0;
 
 	if (dev->drv->ops.reset)
-		ret = (dev->is_shared && !cpu_is_me(dev->comp.core)) ?
+		ret = comp_is_remote(dev) ?
 			comp_reset_remote(dev) : dev->drv->ops.reset(dev);
 
+	comp_block_free(dev);
+	comp_split_free(dev);
+
 	comp_shared_commit(dev);
 
 	return ret;
@@ -9,15 +9,39 @@
 #define __SOF_AUDIO_DCBLOCK_DCBLOCK_H__
 
 #include <stdint.h>
+#include <sof/compiler_attributes.h>
 #include <sof/platform.h>
 #include <ipc/stream.h>
 
 struct audio_stream;
 struct comp_dev;
 
+/* Select optimized code variant when xt-xcc compiler is used */
+#if defined __XCC__
+#include <xtensa/config/core-isa.h>
+#if XCHAL_HAVE_HIFI3 == 1
+#define DCBLOCK_GENERIC	0
+#define DCBLOCK_HIFI3	1
+#else
+#define DCBLOCK_GENERIC	1
+#define DCBLOCK_HIFI3	0
+#endif /* XCHAL_HAVE_HIFI3 */
+#else
+/* GCC */
+#define DCBLOCK_GENERIC	1
+#define DCBLOCK_HIFI3	0
+#endif /* __XCC__ */
+
+/**
+ * \brief Filter state of all channels.
+ * Kept as one array per variable so that the state of a channel pair
+ * loads and stores as a single 64 bit word.
+ */
 struct dcblock_state {
-	int32_t x_prev; /**< state variable referring to x[n-1] */
-	int32_t y_prev; /**< state variable referring to y[n-1] */
+	/**< state variables referring to x[n-1] */
+	int32_t x_prev[PLATFORM_MAX_CHANNELS] __aligned(8);
+	/**< state variables referring to y[n-1] */
+	int32_t y_prev[PLATFORM_MAX_CHANNELS] __aligned(8);
 };
 
 /**
@@ -27,15 +51,16 @@ struct dcblock_state {
 typedef void (*dcblock_func)(const struct comp_dev *dev,
 			     const struct audio_stream *source,
 			     const struct audio_stream *sink,
-			     uint32_t frames);
+			     uint32_t frames, uint32_t first,
+			     uint32_t count);
 
 /* DC Blocking Filter component private data */
 struct comp_data {
 	/**< filters state */
-	struct dcblock_state state[PLATFORM_MAX_CHANNELS];
+	struct dcblock_state state;
 
 	/** coefficients for the processing function */
-	int32_t R_coeffs[PLATFORM_MAX_CHANNELS];
+	int32_t R_coeffs[PLATFORM_MAX_CHANNELS] __aligned(8);
 
 	enum sof_ipc_frame source_format;
 	enum sof_ipc_frame sink_format;
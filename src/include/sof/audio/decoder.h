@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/audio/decoder.h
+ * \brief Decoder component and codec library interface
+ *
+ * The decoder component plays compressed streams sent by the host. The
+ * host component moves compressed data into the pipeline like PCM, its
+ * buffers carry SOF_IPC_BUFFER_COMPRESSED with words as frames, and large
+ * host buffers let the host sleep while the stream plays.
+ *
+ * Codecs come from libraries, built in or loaded at run-time, which
+ * register a decoder_codec. The component collects compressed data in a
+ * staging area every LL run and decodes it in an EDF task, a block of PCM
+ * at a time, which the LL runs then pass to the sink a period at a time.
+ */
+
+#ifndef __SOF_AUDIO_DECODER_H__
+#define __SOF_AUDIO_DECODER_H__
+
+#include <sof/list.h>
+#include <user/decoder.h>
+#include <stdint.h>
+
+struct decoder_codec;
+
+/** \brief Codec state of a stream. */
+struct decoder_codec_ctx {
+	const struct decoder_codec *codec;
+	const struct sof_decoder_config *config;	/**< decoded format */
+	void *priv;			/**< codec private data */
+};
+
+/** \brief Codec operations, all but decode() are optional. */
+struct decoder_codec_ops {
+	/** sets a stream up, returns 0 or error code */
+	int (*init)(struct decoder_codec_ctx *ctx);
+
+	/**
+	 * Decodes whole compressed frames from in to interleaved PCM.
+	 * @param ctx Codec state.
+	 * @param in Compressed data.
+	 * @param in_bytes Bytes of compressed data.
+	 * @param consumed Returns bytes taken from in.
+	 * @param out PCM output.
+	 * @param out_frames PCM frames fitting out.
+	 * @param produced Returns PCM frames written to out.
+	 * @return 0 if frames were decoded, -ENODATA if in doesn't hold a
+	 *	   whole frame, -ENOSPC if out can't take the next one, other
+	 *	   error codes stop the stream.
+	 */
+	int (*decode)(struct decoder_codec_ctx *ctx, const uint8_t *in,
+		      uint32_t in_bytes, uint32_t *consumed, void *out,
+		      uint32_t out_frames, uint32_t *produced);
+
+	/** frees what init() set up */
+	void (*free)(struct decoder_codec_ctx *ctx);
+};
+
+/** \brief Codec library. */
+struct decoder_codec {
+	uint32_t id;			/**< SOF_DECODER_CODEC_ */
+	uint32_t frame_bytes_max;	/**< largest compressed frame */
+	uint32_t frames_max;		/**< PCM frames of a compressed frame */
+	const struct decoder_codec_ops *ops;
+	struct list_item list;		/**< in the list of codecs */
+};
+
+/**
+ * Makes a codec available to decoder components prepared from now on.
+ * @param codec Codec, kept until unregistered.
+ * @return 0 if succeeded, -EEXIST if the codec id is already taken.
+ */
+int decoder_codec_register(struct decoder_codec *codec);
+
+/**
+ * Removes a codec, it must not be used by a prepared decoder.
+ * @param codec Registered codec.
+ */
+void decoder_codec_unregister(struct decoder_codec *codec);
+
+#endif /* __SOF_AUDIO_DECODER_H__ */
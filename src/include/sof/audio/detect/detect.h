@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_DETECT_DETECT_H__
+#define __SOF_AUDIO_DETECT_DETECT_H__
+
+#include <sof/audio/kpb.h>
+#include <ipc/control.h>
+#include <user/detect.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct comp_dev;
+struct ipc_msg;
+
+/* analysis frame of 16 ms advanced by 8 ms at KPB rate of 16 kHz */
+#define DETECT_FFT_SIZE		256
+#define DETECT_HOP_SIZE		128
+#define DETECT_BINS		(DETECT_FFT_SIZE / 2 + 1)
+#define DETECT_MEL_BANDS	16
+
+/* log2 energy returned for silence, below log2 of any non zero value */
+#define DETECT_LOG2_ZERO	(-(1 << 24))
+
+/* features of one analysis frame, shared by all detector models */
+struct detect_features {
+	int32_t band[DETECT_MEL_BANDS];	/**< log2 mel band energies, Q8.24 */
+	int32_t energy;			/**< log2 frame energy, Q8.24 */
+	uint32_t frame;			/**< frames since reset */
+};
+
+struct detect_complex {
+	int32_t re;
+	int32_t im;
+};
+
+/* feature front-end state, tables are built once at init */
+struct detect_feature_state {
+	int32_t samples[DETECT_FFT_SIZE];	/**< Q1.31 analysis window */
+	uint32_t fill;				/**< new samples in window */
+
+	int16_t window[DETECT_FFT_SIZE];	/**< Hann window, Q1.15 */
+	struct detect_complex twiddle[DETECT_FFT_SIZE / 2];	/**< Q1.31 */
+	uint8_t bin_band[DETECT_BINS];		/**< rising band of bin */
+	int16_t bin_weight[DETECT_BINS];	/**< rising weight, Q1.15 */
+
+	struct detect_complex fft[DETECT_FFT_SIZE];
+	struct detect_features features;
+};
+
+void detect_feature_init(struct detect_feature_state *fs);
+void detect_feature_reset(struct detect_feature_state *fs);
+
+/* computes features of the window and slides it by DETECT_HOP_SIZE */
+void detect_feature_compute(struct detect_feature_state *fs);
+
+/**
+ * \brief Adds Q1.31 sample to analysis window.
+ * \return true when window is full and features can be computed.
+ */
+static inline bool detect_feature_add(struct detect_feature_state *fs,
+				      int32_t sample)
+{
+	fs->samples[DETECT_FFT_SIZE - DETECT_HOP_SIZE + fs->fill] = sample;
+
+	return ++fs->fill == DETECT_HOP_SIZE;
+}
+
+/* log2 of value in Q8.24, DETECT_LOG2_ZERO for 0 */
+int32_t detect_log2(uint64_t x);
+
+struct detect_model;
+
+/** \brief Detector model fed with shared features. */
+struct detect_model_ops {
+	uint32_t type;	/**< SOF_DETECT_MODEL_ */
+
+	void (*reset)(struct detect_model *model);
+
+	/* returns true when the model detects in this frame */
+	bool (*process)(struct detect_model *model,
+			const struct detect_features *features);
+};
+
+struct detect_model {
+	const struct detect_model_ops *ops;
+	struct sof_detect_model_config config;
+	bool detected;		/**< latched until reset */
+
+	/* model state */
+	int32_t level;		/**< smoothed energy or noise floor */
+	uint32_t count;		/**< frames counted by model */
+
+	/* KPB client drained on detection */
+	struct kpb_client client;
+	struct kpb_event_data event_data;
+
+	struct ipc_msg *msg;	/**< host notification of model */
+};
+
+/** \brief Detector models map. */
+extern const struct detect_model_ops *const detect_model_map[];
+
+/** \brief Number of detector models. */
+extern const size_t detect_model_count;
+
+/**
+ * \brief Retrieves detector model operations.
+ * \param[in] type Model type SOF_DETECT_MODEL_.
+ * \return Pointer to operations or NULL for unknown type.
+ */
+static inline const struct detect_model_ops *detect_get_model(uint32_t type)
+{
+	size_t i;
+
+	for (i = 0; i < detect_model_count; i++) {
+		if (detect_model_map[i]->type == type)
+			return detect_model_map[i];
+	}
+
+	return NULL;
+}
+
+/* detect component private data */
+struct comp_data {
+	struct detect_feature_state *fs;
+	struct detect_model model[SOF_DETECT_MAX_MODELS];
+	uint32_t num_models;
+
+	struct sof_ipc_comp_event event;
+};
+
+#endif /* __SOF_AUDIO_DETECT_DETECT_H__ */
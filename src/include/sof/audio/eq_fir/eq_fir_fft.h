@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_EQ_FIR_EQ_FIR_FFT_H__
+#define __SOF_AUDIO_EQ_FIR_EQ_FIR_FFT_H__
+
+#include <sof/math/fft.h>
+#include <sof/platform.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct audio_stream;
+struct sof_eq_fir_config;
+
+/* Responses longer than EQ_FIR_FFT_MIN_LENGTH taps are convolved in
+ * frequency domain with uniformly partitioned overlap-save. A response is
+ * cut to partitions of EQ_FIR_FFT_BLOCK taps, and every block of as many
+ * frames is transformed once and multiplied with all partitions by the
+ * spectra of the previous blocks. The output is delayed by one block.
+ */
+#define EQ_FIR_FFT_BLOCK_BITS	6
+#define EQ_FIR_FFT_BLOCK	(1 << EQ_FIR_FFT_BLOCK_BITS)
+#define EQ_FIR_FFT_BITS		(EQ_FIR_FFT_BLOCK_BITS + 1)
+#define EQ_FIR_FFT_SIZE		(1 << EQ_FIR_FFT_BITS)
+#define EQ_FIR_FFT_BINS		(EQ_FIR_FFT_SIZE / 2 + 1)
+#define EQ_FIR_FFT_MIN_LENGTH	128
+
+struct eq_fir_fft_channel {
+	int32_t in[EQ_FIR_FFT_SIZE];	/* previous and current input block */
+	int32_t out[EQ_FIR_FFT_BLOCK];	/* output of previous block */
+	const struct icomplex32 *h;	/* spectra of response partitions */
+	struct icomplex32 *fdl;		/* spectra of last input blocks */
+	int partitions;
+	int fdl_pos;			/* partition of current input block */
+	int out_shift;
+};
+
+struct eq_fir_fft {
+	struct fft_plan plan;
+	struct icomplex32 twiddle[EQ_FIR_FFT_SIZE / 2];
+	struct icomplex32 work[EQ_FIR_FFT_SIZE / 2];
+	struct icomplex32 spectrum[EQ_FIR_FFT_BINS];
+	int64_t acc_real[EQ_FIR_FFT_BINS];
+	int64_t acc_imag[EQ_FIR_FFT_BINS];
+	int32_t block[EQ_FIR_FFT_SIZE];
+	struct eq_fir_fft_channel ch[PLATFORM_MAX_CHANNELS];
+	struct icomplex32 *fdl;		/* input spectra of all channels */
+	size_t fdl_size;
+	int nch;
+	int pos;			/* frames of current block */
+	struct icomplex32 spectra[];	/* responses and input spectra */
+};
+
+/* true when a response of config is long enough for frequency domain */
+bool eq_fir_fft_needed(const struct sof_eq_fir_config *config);
+
+/* Sets up frequency domain filters of nch channels from config */
+int eq_fir_fft_new(struct eq_fir_fft **fft, struct sof_eq_fir_config *config,
+		   int nch);
+
+void eq_fir_fft_free(struct eq_fir_fft **fft);
+
+/* clears signal history, filters restart from silence */
+void eq_fir_fft_reset(struct eq_fir_fft *fft);
+
+/* frames of silent input after which signal history is all zero */
+uint32_t eq_fir_fft_flush_frames(const struct eq_fir_fft *fft);
+
+void eq_fir_fft_process(struct eq_fir_fft *fft,
+			const struct audio_stream *source,
+			struct audio_stream *sink, int frames);
+
+#endif /* __SOF_AUDIO_EQ_FIR_EQ_FIR_FFT_H__ */
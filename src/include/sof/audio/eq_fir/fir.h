@@ -41,16 +41,28 @@ void fir_init_delay(struct fir_state_32x16 *fir, int32_t **data);
 #if CONFIG_FORMAT_S16LE
 void eq_fir_s16(struct fir_state_32x16 *fir, const struct audio_stream *source,
 		struct audio_stream *sink, int frames, int nch);
+
+void eq_fir_mc_s16(struct fir_state_32x16 *fir,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames, int nch);
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE
 void eq_fir_s24(struct fir_state_32x16 *fir, const struct audio_stream *source,
 		struct audio_stream *sink, int frames, int nch);
+
+void eq_fir_mc_s24(struct fir_state_32x16 *fir,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames, int nch);
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
 void eq_fir_s32(struct fir_state_32x16 *fir, const struct audio_stream *source,
 		struct audio_stream *sink, int frames, int nch);
+
+void eq_fir_mc_s32(struct fir_state_32x16 *fir,
+		   const struct audio_stream *source,
+		   struct audio_stream *sink, int frames, int nch);
 #endif /* CONFIG_FORMAT_S32LE */
 
 /* The next functions are inlined to optmize execution speed */
@@ -58,4 +58,11 @@
 #endif
 #endif
 
+/* Streams with at least this number of channels are processed with the
+ * frame interleaved multi-channel FIR variant. It passes the interleaved
+ * source and sink data only once instead of once per channel. The HiFi EP
+ * code has no such variant.
+ */
+#define FIR_MC_MIN_CHANNELS	2
+
 #endif /* __SOF_AUDIO_EQ_FIR_FIR_CONFIG_H__ */
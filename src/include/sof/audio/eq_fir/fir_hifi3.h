@@ -46,6 +46,10 @@ void eq_fir_s16_hifi3(struct fir_state_32x16 *fir,
 void eq_fir_2x_s16_hifi3(struct fir_state_32x16 *fir,
 			 const struct audio_stream *source,
 			 struct audio_stream *sink, int frames, int nch);
+
+void eq_fir_mc_s16_hifi3(struct fir_state_32x16 *fir,
+			 const struct audio_stream *source,
+			 struct audio_stream *sink, int frames, int nch);
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE
@@ -56,6 +60,10 @@ void eq_fir_s24_hifi3(struct fir_state_32x16 *fir,
 void eq_fir_2x_s24_hifi3(struct fir_state_32x16 *fir,
 			 const struct audio_stream *source,
 			 struct audio_stream *sink, int frames, int nch);
+
+void eq_fir_mc_s24_hifi3(struct fir_state_32x16 *fir,
+			 const struct audio_stream *source,
+			 struct audio_stream *sink, int frames, int nch);
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
@@ -66,6 +74,10 @@ void eq_fir_s32_hifi3(struct fir_state_32x16 *fir,
 void eq_fir_2x_s32_hifi3(struct fir_state_32x16 *fir,
 			 const struct audio_stream *source,
 			 struct audio_stream *sink, int frames, int nch);
+
+void eq_fir_mc_s32_hifi3(struct fir_state_32x16 *fir,
+			 const struct audio_stream *source,
+			 struct audio_stream *sink, int frames, int nch);
 #endif /* CONFIG_FORMAT_S32LE */
 
 /* Setup circular buffer for FIR input data delay */
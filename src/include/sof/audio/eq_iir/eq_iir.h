@@ -15,6 +15,9 @@
 struct audio_stream;
 struct comp_dev;
 
+/** \brief Number of frames processed at a time by the block IIR. */
+#define EQ_IIR_BLOCK_FRAMES	32
+
 /** \brief Type definition for processing function select return value. */
 typedef void (*eq_iir_func)(const struct comp_dev *dev,
 			    const struct audio_stream *source,
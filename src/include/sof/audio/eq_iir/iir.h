@@ -30,6 +30,7 @@ struct sof_eq_iir_header_df2t;
 #if IIR_AUTOARCH == 0
 #define IIR_GENERIC	1
 #define IIR_HIFI3	0
+#define IIR_X86		0
 #endif
 
 /* Select optimized code variant when xt-xcc compiler is used */
@@ -43,10 +44,18 @@ struct sof_eq_iir_header_df2t;
 #define IIR_GENERIC	1
 #define IIR_HIFI3	0
 #endif /* XCHAL_HAVE_HIFI3 */
+#define IIR_X86		0
 #else
-/* GCC */
+/* GCC, the x86 code replaces only the two channels block version of the
+ * generic code.
+ */
 #define IIR_GENERIC	1
 #define IIR_HIFI3	0
+#if defined(__SSE4_2__)
+#define IIR_X86		1
+#else
+#define IIR_X86		0
+#endif
 #endif /* __XCC__ */
 #endif /* IIR_AUTOARCH */
 
@@ -63,6 +72,13 @@ struct iir_state_df2t {
 
 int32_t iir_df2t(struct iir_state_df2t *iir, int32_t x);
 
+void iir_df2t_block(struct iir_state_df2t *iir, const int32_t *in,
+		    int32_t *out, int frames, int stride);
+
+void iir_df2t_block_2x(struct iir_state_df2t *iir0,
+		       struct iir_state_df2t *iir1, const int32_t *in,
+		       int32_t *out, int frames, int stride);
+
 int iir_init_coef_df2t(struct iir_state_df2t *iir,
 		       struct sof_eq_iir_header_df2t *config);
 
@@ -10,6 +10,7 @@
 
 #include <sof/trace/trace.h>
 #include <user/trace.h>
+#include <config.h>
 #include <stdint.h>
 
 struct comp_buffer;
@@ -25,15 +26,25 @@ struct comp_buffer;
 #define KPB_MAX_BUFFER_SIZE(sw) ((KPB_SAMPLNG_FREQUENCY / 1000) * \
 	(KPB_SAMPLE_CONTAINER_SIZE(sw) / 8) * KPB_MAX_BUFF_TIME * \
 	KPB_NUM_OF_CHANNELS)
-#define KPB_MAX_NO_OF_CLIENTS 2
+#define KPB_MAX_NO_OF_CLIENTS 4 /**< one per detector model */
 #define KPB_NO_OF_HISTORY_BUFFERS 2 /**< no of internal buffers */
 #define KPB_ALLOCATION_STEP 0x100
 #define KPB_NO_OF_MEM_POOLS 3
+/**< bytes taken by one 24 or 32 bit sample in history buffer */
+#if CONFIG_KPB_HISTORY_S24_PACKED
+#define KPB_HB_SAMPLE_BYTES 3
+#elif CONFIG_KPB_HISTORY_S16
+#define KPB_HB_SAMPLE_BYTES 2
+#else
+#define KPB_HB_SAMPLE_BYTES 4
+#endif
 #define KPB_BYTES_TO_FRAMES(bytes, sample_width) \
 	(bytes / ((KPB_SAMPLE_CONTAINER_SIZE(sample_width) / 8) * \
 	KPB_NUM_OF_CHANNELS))
 /**< Defines how much faster draining is in comparison to pipeline copy. */
 #define KPB_DRAIN_NUM_OF_PPL_PERIODS_AT_ONCE 2
+/**< Draining task period in microseconds for unlimited draining speed. */
+#define KPB_DRAIN_INTERVAL_US 1000
 /**< Host buffer shall be at least two times bigger than history buffer. */
 #define HOST_BUFFER_MIN_SIZE(hb) (hb * 2)
 
@@ -110,15 +121,16 @@ struct hb {
 
 struct dd {
 	struct comp_buffer *sink;
-	struct hb *history_buffer;
-	size_t history_depth;
+	struct hb *history_buffer; /**< buffer to continue draining from */
+	size_t read_pos; /**< stream position of the drain read pointer */
 	uint8_t is_draining_active;
 	size_t sample_width;
-	size_t buffered_while_draining;
-	size_t drain_interval;
+	size_t drain_interval; /**< draining task period in microseconds */
 	size_t pb_limit; /**< Period bytes limit */
 	struct comp_dev *dev;
 	bool sync_mode_on;
+	size_t drained; /**< bytes drained so far */
+	uint64_t draining_time_start; /**< draining start time in ticks */
 };
 
 #ifdef UNIT_TEST
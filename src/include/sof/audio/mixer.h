@@ -5,9 +5,195 @@
  * Author: Janusz Jankowski <janusz.jankowski@linux.intel.com>
  */
 
+/**
+ * \file audio/mixer.h
+ * \brief Mixer component header file
+ */
+
 #ifndef __SOF_AUDIO_MIXER_H__
 #define __SOF_AUDIO_MIXER_H__
 
+#include <sof/platform.h>
+#include <ipc/stream.h>
+#include <config.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct audio_stream;
+struct comp_dev;
+
+#define MIXER_GENERIC
+
+#if defined(__XCC__)
+#include <xtensa/config/core-isa.h>
+
+#if XCHAL_HAVE_HIFI3
+#undef MIXER_GENERIC
+#define MIXER_HIFI3
+#endif
+
+#endif
+
+/**
+ * \brief Mixer processing function interface.
+ * \param[in,out] dev Mixer base component device.
+ * \param[in,out] sink Destination stream.
+ * \param[in] sources Array of source streams.
+ * \param[in] count Number of source streams.
+ * \param[in] frames Number of frames to process.
+ */
+typedef void (*mixer_func)(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream **sources, uint32_t count,
+			   uint32_t frames);
+
+/**
+ * \brief Mixer processing function interface with source gains.
+ * \param[in,out] dev Mixer base component device.
+ * \param[in,out] sink Destination stream.
+ * \param[in] sources Array of source streams.
+ * \param[in] gains Array of Q8.16 gains of source streams.
+ * \param[in] count Number of source streams.
+ * \param[in] frames Number of frames to process.
+ */
+typedef void (*mixer_gain_func)(struct comp_dev *dev,
+				struct audio_stream *sink,
+				const struct audio_stream **sources,
+				const int32_t *gains, uint32_t count,
+				uint32_t frames);
+
+#if CONFIG_COMP_MIXER_ASYNC
+/**
+ * \brief Mixer processing function interface for one source mixed ahead
+ *	  of the sink write pointer.
+ * \param[in,out] sink Destination stream.
+ * \param[in] source Source stream.
+ * \param[in] gain Q8.16 gain of source stream.
+ * \param[in] offset Frames after sink write pointer to start at.
+ * \param[in] overlap Frames at offset already mixed by other sources.
+ * \param[in] frames Number of frames to process.
+ */
+typedef void (*mixer_acc_func)(struct audio_stream *sink,
+			       const struct audio_stream *source,
+			       int32_t gain, uint32_t offset,
+			       uint32_t overlap, uint32_t frames);
+#endif
+
+/** \brief Fractional bits of source gain. */
+#define MIXER_GAIN_QY		16
+
+/** \brief Source gain of 0 dB, same Q8.16 format as volume. */
+#define MIXER_GAIN_UNITY	(1 << MIXER_GAIN_QY)
+
+/** \brief Mixer component private data. */
+struct mixer_data {
+	mixer_func mix_func;	/**< mixer processing function */
+	mixer_gain_func mix_gain_func;	/**< processing with source gains */
+
+	/** gain of each source, indexed by order of connection */
+	int32_t gain[PLATFORM_MAX_STREAMS];
+	bool gain_active;	/**< true if any gain is not unity */
+
+#if CONFIG_COMP_MIXER_ASYNC
+	mixer_acc_func acc_func;	/**< mixes one source ahead of sink */
+
+	/** frames mixed after sink write pointer by each source */
+	uint32_t pending[PLATFORM_MAX_STREAMS];
+	uint32_t mixed;	/**< frames after sink write pointer mixed by any */
+#endif
+};
+
+/** \brief Mixer processing functions map. */
+struct mixer_func_map {
+	uint16_t frame_fmt;	/**< frame format */
+	mixer_func func;	/**< mixer processing function */
+};
+
+/** \brief Mixer processing with source gains functions map. */
+struct mixer_gain_func_map {
+	uint16_t frame_fmt;	/**< frame format */
+	mixer_gain_func func;	/**< mixer processing function */
+};
+
+/** \brief Map of formats with dedicated processing functions. */
+extern const struct mixer_func_map mixer_func_map[];
+
+/** \brief Number of processing functions. */
+extern const size_t mixer_func_count;
+
+/** \brief Map of formats with processing with source gains functions. */
+extern const struct mixer_gain_func_map mixer_gain_func_map[];
+
+/** \brief Number of processing with source gains functions. */
+extern const size_t mixer_gain_func_count;
+
+#if CONFIG_COMP_MIXER_ASYNC
+/** \brief Mixer processing of one source ahead of sink functions map. */
+struct mixer_acc_func_map {
+	uint16_t frame_fmt;	/**< frame format */
+	mixer_acc_func func;	/**< mixer processing function */
+};
+
+/** \brief Map of formats with one source processing functions. */
+extern const struct mixer_acc_func_map mixer_acc_func_map[];
+
+/** \brief Number of one source processing functions. */
+extern const size_t mixer_acc_func_count;
+#endif
+
+/**
+ * \brief Retrieves mixer processing function.
+ * \param[in] frame_fmt Sink frame format.
+ * \return Processing function or NULL if format is not supported.
+ */
+static inline mixer_func mixer_get_processing_function(uint16_t frame_fmt)
+{
+	size_t i;
+
+	for (i = 0; i < mixer_func_count; i++) {
+		if (frame_fmt == mixer_func_map[i].frame_fmt)
+			return mixer_func_map[i].func;
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief Retrieves mixer processing with source gains function.
+ * \param[in] frame_fmt Sink frame format.
+ * \return Processing function or NULL if format is not supported.
+ */
+static inline mixer_gain_func mixer_get_gain_function(uint16_t frame_fmt)
+{
+	size_t i;
+
+	for (i = 0; i < mixer_gain_func_count; i++) {
+		if (frame_fmt == mixer_gain_func_map[i].frame_fmt)
+			return mixer_gain_func_map[i].func;
+	}
+
+	return NULL;
+}
+
+#if CONFIG_COMP_MIXER_ASYNC
+/**
+ * \brief Retrieves mixer processing of one source ahead of sink function.
+ * \param[in] frame_fmt Sink frame format.
+ * \return Processing function or NULL if format is not supported.
+ */
+static inline mixer_acc_func mixer_get_acc_function(uint16_t frame_fmt)
+{
+	size_t i;
+
+	for (i = 0; i < mixer_acc_func_count; i++) {
+		if (frame_fmt == mixer_acc_func_map[i].frame_fmt)
+			return mixer_acc_func_map[i].func;
+	}
+
+	return NULL;
+}
+#endif
+
 #ifdef UNIT_TEST
 void sys_comp_mixer_init(void);
 #endif
@@ -23,6 +23,7 @@
 #include <sof/trace/trace.h>
 #include <sof/ut.h>
 #include <user/trace.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 struct comp_buffer;
@@ -43,6 +44,19 @@ struct mux_stream_data {
 	uint8_t reserved[(20 - PLATFORM_MAX_CHANNELS - 1) % 4]; // padding to ensure proper alignment of following instances
 };
 
+/** \brief Output channel of mux_look_up with no source channel. */
+#define MUX_LOOK_UP_NONE 0xff
+
+/**
+ * \brief Source of each output channel, valid if no channel is a mix.
+ *
+ * Demux keeps one table per sink stream, mux one for its sink.
+ */
+struct mux_look_up {
+	uint8_t stream[PLATFORM_MAX_CHANNELS];	/**< source stream index */
+	uint8_t in_ch[PLATFORM_MAX_CHANNELS];	/**< channel of the stream */
+};
+
 typedef void(*demux_func)(const struct comp_dev *dev, struct audio_stream *sink,
 			  const struct audio_stream *source, uint32_t frames,
 			  struct mux_stream_data *data);
@@ -66,6 +80,13 @@ struct comp_data {
 		demux_func demux;
 	};
 
+	/* routing tables used instead of masks if route is set */
+	bool route;
+	struct mux_look_up lookup[MUX_MAX_STREAMS];
+
+	/* sources of mux or sinks of demux by stream, set in prepare */
+	struct comp_buffer *streams[MUX_MAX_STREAMS];
+
 	struct sof_mux_config config;
 };
 
@@ -73,6 +94,8 @@ struct comp_func_map {
 	uint16_t frame_format;
 	mux_func mux_proc_func;
 	demux_func demux_proc_func;
+	mux_func mux_route_func;
+	demux_func demux_route_func;
 };
 
 extern const struct comp_func_map mux_func_map[];
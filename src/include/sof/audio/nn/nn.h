@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_NN_NN_H__
+#define __SOF_AUDIO_NN_NN_H__
+
+#include <ipc/control.h>
+#include <user/nn.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ipc_msg;
+
+/* Select optimized code variant when xt-xcc compiler is used */
+#if defined __XCC__
+#include <xtensa/config/core-isa.h>
+#if XCHAL_HAVE_HIFI3 == 1
+#define NN_GENERIC	0
+#define NN_HIFI3	1
+#else
+#define NN_GENERIC	1
+#define NN_HIFI3	0
+#endif /* XCHAL_HAVE_HIFI3 */
+#else
+/* GCC */
+#define NN_GENERIC	1
+#define NN_HIFI3	0
+#endif /* __XCC__ */
+
+/* layer of a model with its parameters resolved in the blob */
+struct nn_layer {
+	const struct sof_nn_layer *cfg;
+	const void *w;		/**< input weights, int8_t or int16_t */
+	const void *u;		/**< recurrent weights */
+	const int32_t *b;	/**< input bias */
+	const int32_t *bu;	/**< recurrent bias of GRU */
+	const int16_t *lut;	/**< activation or sigmoid table */
+	const int16_t *lut2;	/**< tanh table of recurrent layers */
+	uint32_t in_len;	/**< input time steps */
+	uint32_t out_len;	/**< output time steps */
+	int16_t *state;		/**< recurrent state in arena */
+};
+
+/* Model run over one frame. All run-time memory is taken from a single
+ * arena allocated at prepare, sized by the largest tensor, accumulator
+ * set and recurrent state of the layers.
+ */
+struct nn_model {
+	const struct sof_nn_config *config;
+	struct nn_layer layer[SOF_NN_MAX_LAYERS];
+	uint32_t num_layers;
+
+	uint32_t tensor_size;	/**< elements of each activation tensor */
+	uint32_t acc_size;	/**< accumulators */
+	uint32_t state_size;	/**< elements of all recurrent states */
+	uint32_t row_size;	/**< elements of widened int8 weight row */
+	uint32_t out_size;	/**< elements of the output tensor */
+
+	void *arena;
+	int16_t *tensor[2];	/**< input and output of a layer */
+	int32_t *acc;
+	int16_t *state;
+	int16_t *row;
+};
+
+/**
+ * \brief Multiplies weight matrix by vector into accumulators.
+ * acc[r] += w[r][0..cols) * x[0..cols) for each of the rows, saturated.
+ * \param[in,out] acc Accumulators, one per row.
+ * \param[in] w Weights, rows after each other.
+ * \param[in] x Input vector.
+ * \param[in] rows Number of rows.
+ * \param[in] cols Number of columns.
+ * \param[in] row Scratch of cols elements for variants widening weights.
+ */
+void nn_mac_s16(int32_t *acc, const int16_t *w, const int16_t *x,
+		uint32_t rows, uint32_t cols, int16_t *row);
+
+void nn_mac_s8(int32_t *acc, const int8_t *w, const int16_t *x,
+	       uint32_t rows, uint32_t cols, int16_t *row);
+
+/**
+ * \brief Parses and validates model blob.
+ * \param[out] m Model, refers to the blob until freed.
+ * \param[in] cfg Model blob.
+ * \return 0 on success, -EINVAL for invalid model.
+ */
+int nn_model_init(struct nn_model *m, const struct sof_nn_config *cfg);
+
+/* allocates arena of parsed model */
+int nn_model_prepare(struct nn_model *m);
+
+/* frees arena, the model stays parsed */
+void nn_model_free(struct nn_model *m);
+
+/* clears recurrent state */
+void nn_model_reset(struct nn_model *m);
+
+/* input tensor of config->frames Q1.15 samples */
+static inline int16_t *nn_model_input(struct nn_model *m)
+{
+	return m->tensor[0];
+}
+
+/* runs all layers, returns output tensor of out_size elements */
+const int16_t *nn_model_run(struct nn_model *m);
+
+/* nn component private data */
+struct comp_data {
+	struct sof_nn_config *config;	/**< model blob */
+	struct sof_nn_config *config_new;	/**< blob being received */
+	uint32_t config_new_size;		/**< size of received blob */
+	struct nn_model model;
+	bool detected;			/**< score above threshold */
+
+	struct sof_ipc_comp_event event;
+	struct ipc_msg *msg;
+};
+
+#endif /* __SOF_AUDIO_NN_NN_H__ */
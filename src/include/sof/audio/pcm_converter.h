@@ -15,7 +15,9 @@
 #define __SOF_AUDIO_PCM_CONVERTER_H__
 
 #include <ipc/stream.h>
+#include <ipc/topology.h>
 #include <config.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -48,18 +50,42 @@ typedef void (*pcm_converter_func)(const struct audio_stream *source,
 				   uint32_t ioffset, struct audio_stream *sink,
 				   uint32_t ooffset, uint32_t samples);
 
-/** \brief PCM conversion functions map. */
-struct pcm_func_map {
-	enum sof_ipc_frame source;	/**< source frame format */
-	enum sof_ipc_frame sink;	/**< sink frame format */
-	pcm_converter_func func; /**< PCM conversion function */
-};
-
-/** \brief Map of formats with dedicated conversion functions. */
-extern const struct pcm_func_map pcm_func_map[];
+/** \brief Number of frame formats indexing the conversion table. */
+#define PCM_CONVERTER_FORMATS	(SOF_IPC_FRAME_S24_3LE + 1)
 
-/** \brief Number of conversion functions. */
-extern const uint32_t pcm_func_count;
+/**
+ * \brief Conversion functions indexed by source and sink frame format,
+ *	  NULL where the pair is not supported.
+ */
+extern const pcm_converter_func
+pcm_func_table[PCM_CONVERTER_FORMATS][PCM_CONVERTER_FORMATS];
+
+#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE
+void pcm_convert_s16_to_s24(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples);
+void pcm_convert_s24_to_s16(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples);
+#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE
+void pcm_convert_s16_to_s32(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples);
+void pcm_convert_s32_to_s16(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples);
+#endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE */
+
+#if CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE
+void pcm_convert_s24_to_s32(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples);
+void pcm_convert_s32_to_s24(const struct audio_stream *source,
+			    uint32_t ioffset, struct audio_stream *sink,
+			    uint32_t ooffset, uint32_t samples);
+#endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
 
 /**
  * \brief Retrieves PCM conversion function.
@@ -70,18 +96,67 @@ static inline pcm_converter_func
 pcm_get_conversion_function(enum sof_ipc_frame in,
 			    enum sof_ipc_frame out)
 {
-	uint32_t i;
+	if (in >= PCM_CONVERTER_FORMATS || out >= PCM_CONVERTER_FORMATS)
+		return NULL;
+
+	return pcm_func_table[in][out];
+}
+
+/** \brief Maximum channels of a DMA frame addressed by a channel map. */
+#define PCM_CHMAP_MAX_CHANNELS	15
 
-	for (i = 0; i < pcm_func_count; i++) {
-		if (in != pcm_func_map[i].source)
-			continue;
-		if (out != pcm_func_map[i].sink)
-			continue;
+/** \brief Channel of pcm_chmap.ch filled with silence. */
+#define PCM_CHMAP_SILENCE	0xff
+
+/**
+ * \brief Channel map applied while copying frames, sink channel c is
+ *	  taken from source channel ch[c] converting its format.
+ */
+struct pcm_chmap {
+	uint8_t ch[PCM_CHMAP_MAX_CHANNELS];
+};
+
+/**
+ * \brief Returns number of pipeline channels of SOF_IPC_CH_MAP_ map.
+ * \param[in] map Channel map from IPC.
+ */
+static inline uint32_t pcm_chmap_channels(uint32_t map)
+{
+	uint32_t ch = 0;
 
-		return pcm_func_map[i].func;
-	}
+	while (ch < SOF_IPC_CH_MAP_MAX_CHANNELS && SOF_IPC_CH_MAP_GET(map, ch))
+		ch++;
 
-	return NULL;
+	return ch;
 }
 
+/**
+ * \brief Builds channel map for copies between pipeline and DMA frames.
+ * \param[out] chmap Channel map.
+ * \param[in] map SOF_IPC_CH_MAP_ map from IPC.
+ * \param[in] dma_channels Channels of DMA frame.
+ * \param[in] to_dma True if copied from pipeline to DMA frames.
+ * \return Error code.
+ */
+int pcm_chmap_init(struct pcm_chmap *chmap, uint32_t map,
+		   uint32_t dma_channels, bool to_dma);
+
+/**
+ * \brief Returns true if formats can be converted by pcm_chmap_copy().
+ * \param[in] in Source frame format.
+ * \param[in] out Sink frame format.
+ */
+bool pcm_chmap_supported(enum sof_ipc_frame in, enum sof_ipc_frame out);
+
+/**
+ * \brief Copies frames between streams of different channels and formats.
+ * \param source Source stream, read pointer is not modified.
+ * \param sink Sink stream, write pointer is not modified.
+ * \param frames Number of frames to copy.
+ * \param chmap Channel map built with pcm_chmap_init().
+ */
+void pcm_chmap_copy(const struct audio_stream *source,
+		    struct audio_stream *sink, uint32_t frames,
+		    const struct pcm_chmap *chmap);
+
 #endif /* __SOF_AUDIO_PCM_CONVERTER_H__ */
@@ -12,12 +12,15 @@
 #include <sof/lib/cpu.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/memory.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
 #include <ipc/stream.h>
 #include <ipc/topology.h>
 #include <user/trace.h>
+#include <config.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -84,9 +87,44 @@ struct task;
 #define PPL_DIR_DOWNSTREAM	0
 #define PPL_DIR_UPSTREAM	1
 
+/* pipelines followed upstream when ordering pipeline tasks */
+#define PPL_ORDER_MAX		8
+
+/* pipeline runs averaged when checking the cycles budget */
+#define PPL_BUDGET_WINDOW	64
+
+/* longest scheduling period of a deep buffer pipeline in us */
+#define PPL_BATCH_MAX_PERIOD	100000
+
 #define PPL_POSN_OFFSETS \
 	(MAILBOX_STREAM_SIZE / sizeof(struct sof_ipc_stream_posn))
 
+#if CONFIG_PIPELINE_FUSED_CHAINS
+/* frames processed by all components of a fused chain at once */
+#define PPL_FUSED_BLOCK_FRAMES	16
+
+/* block of the widest frame, stages alternate between two of them */
+#define PPL_FUSED_BLOCK_SIZE \
+	(PPL_FUSED_BLOCK_FRAMES * PLATFORM_MAX_CHANNELS * sizeof(int32_t))
+#endif
+
+/*
+ * Entry of the flattened pipeline copy schedule. Entries are stored in
+ * copy order: pre-order for downstream (capture) pipelines and post-order
+ * for upstream (playback) pipelines. span is the number of entries that
+ * belong to the subtree of comp, placed directly after it (downstream) or
+ * directly before it (upstream). fused is the number of entries after comp
+ * which are processed together with it as one chain and must be skipped.
+ * stop_prev is set upstream when the entry right before is the last source
+ * visited, whose path stop also stops comp.
+ */
+struct pipeline_copy_entry {
+	struct comp_dev *comp;
+	uint32_t span;
+	uint32_t fused;	/* number of following entries run by comp copy */
+	bool stop_prev;	/* stopped along with the previous entry */
+};
+
 /*
  * Audio pipeline.
  */
@@ -95,10 +133,37 @@ struct pipeline {
 
 	/* runtime status */
 	int32_t xrun_bytes;		/* last xrun length */
+#if CONFIG_XRUN_FAST_RECOVERY
+	struct comp_dev *xrun_comp;	/* component reporting last xrun */
+#endif
 	uint32_t status;		/* pipeline status */
 
 	/* scheduling */
 	struct task *pipe_task;		/* pipeline processing task */
+#if CONFIG_PIPELINE_MCPS_BUDGET
+	uint64_t budget_cycles;		/* cycles spent in current window */
+	uint32_t budget_count;		/* runs in current window */
+	uint32_t budget_quality;	/* quality level set to components */
+	bool budget_over;		/* host told about budget overrun */
+	bool budget_done;		/* nothing more to do in this run */
+	struct ipc_msg *budget_msg;	/* budget overrun notification */
+#endif
+
+	/* flattened copy schedule, rebuilt after component state changes */
+	struct pipeline_copy_entry *copy_list;
+	uint32_t copy_list_size;	/* allocated number of entries */
+	uint32_t copy_list_count;	/* number of valid entries */
+	bool copy_list_valid;		/* false if rebuild is required */
+#if CONFIG_PIPELINE_FUSED_CHAINS
+	void *fused_scratch;		/* blocks passed between fused comps */
+#endif
+
+#if CONFIG_PIPELINE_IDLE_LP_MEMORY
+	/* buffers of idle pipeline are parked in LP memory */
+	struct task idle_task;		/* idle timeout, then parks buffers */
+	bool idle_armed;		/* idle_task is scheduled */
+	bool parked;			/* some buffers are parked */
+#endif
 
 	/* component that drives scheduling in this pipe */
 	struct comp_dev *sched_comp;
@@ -109,7 +174,21 @@ struct pipeline {
 
 	/* position update */
 	uint32_t posn_offset;		/* position update array offset*/
+	uint32_t posn_seq;		/* mailbox position sequence */
+	uint32_t posn_periods;		/* periods between mailbox updates */
+	uint32_t posn_count;		/* periods since last mailbox update */
+	struct comp_dev *posn_host;	/* host comp of mailbox updates */
+	bool pause_warm;		/* SOF_PCM_FLAG_PAUSE_WARM of stream */
+
+#if CONFIG_PIPELINE_QOS
+	uint32_t qos;			/* SOF_IPC_STREAM_QOS_ of stream */
+	uint32_t tplg_period;		/* topology period, batched */
+	uint32_t tplg_priority;		/* topology LL priority */
+#endif
 	struct ipc_msg *msg;
+
+	/* started by a group trigger, waiting to be scheduled */
+	struct list_item group_list;
 };
 
 /* static pipeline */
@@ -189,6 +268,12 @@ static inline bool pipeline_is_same_sched_comp(struct pipeline *current,
 	return current->sched_comp == previous->sched_comp;
 }
 
+/* marks flattened copy schedule as outdated */
+static inline void pipeline_copy_list_invalidate(struct pipeline *p)
+{
+	p->copy_list_valid = false;
+}
+
 /* checks if pipeline is scheduled with timer */
 static inline bool pipeline_is_timer_driven(struct pipeline *p)
 {
@@ -201,6 +286,15 @@ static inline bool pipeline_is_this_cpu(struct pipeline *p)
 	return p->ipc_pipe.core == cpu_get_id();
 }
 
+/* MCPS declared in topology as worst case instructions per period */
+static inline uint32_t pipeline_mcps(struct pipeline *p)
+{
+	if (!p->ipc_pipe.period)
+		return 0;
+
+	return ceil_divide(p->ipc_pipe.period_mips, p->ipc_pipe.period);
+}
+
 /* pipeline creation and destruction */
 struct pipeline *pipeline_new(struct sof_ipc_pipe_new *pipe_desc,
 	struct comp_dev *cd);
@@ -218,6 +312,10 @@ int pipeline_complete(struct pipeline *p, struct comp_dev *source,
 int pipeline_params(struct pipeline *p, struct comp_dev *cd,
 		    struct sof_ipc_pcm_params *params);
 
+/* change stream parameters of a prepared or running pipeline in place */
+int pipeline_reconfig(struct pipeline *p, struct comp_dev *cd,
+		      struct sof_ipc_pcm_params *params);
+
 /* prepare the pipeline for usage */
 int pipeline_prepare(struct pipeline *p, struct comp_dev *cd);
 
@@ -230,6 +328,13 @@ void pipeline_cache(struct pipeline *p, struct comp_dev *dev, int cmd);
 /* trigger pipeline - atomic */
 int pipeline_trigger(struct pipeline *p, struct comp_dev *host_cd, int cmd);
 
+/* trigger pipelines of hosts to start or stop in the same LL tick */
+int pipeline_trigger_group(struct comp_dev **hosts, uint32_t count, int cmd);
+
+/* topology image generated from CONFIG_STATIC_PIPELINE_TPLG by the build */
+extern uint8_t static_tplg_image[];
+extern const uint32_t static_tplg_image_size;
+
 /* static pipeline creation */
 int init_static_pipeline(struct ipc *ipc);
 
@@ -241,10 +346,17 @@ void pipeline_schedule_copy(struct pipeline *p, uint64_t start);
 void pipeline_schedule_cancel(struct pipeline *p);
 
 /* get time pipeline timestamps from host to dai */
+/* write position to the pipeline mailbox slot */
+void pipeline_posn_write(struct pipeline *p, struct sof_ipc_stream_posn *posn);
+
 void pipeline_get_timestamp(struct pipeline *p, struct comp_dev *host_dev,
 			    struct sof_ipc_stream_posn *posn);
 
 /* notify host that we have XRUN */
 void pipeline_xrun(struct pipeline *p, struct comp_dev *dev, int32_t bytes);
 
+#ifdef UNIT_TEST
+int pipeline_copy(struct pipeline *p);
+#endif
+
 #endif /* __SOF_AUDIO_PIPELINE_H__ */
@@ -63,6 +63,18 @@ extern const struct comp_func_map func_map[];
  */
 sel_func sel_get_processing_function(struct comp_dev *dev);
 
+/**
+ * \brief Copies all channels unchanged.
+ * Used when source and sink have identical channel configuration, the
+ * copy is skipped when the sink buffer shares the source memory.
+ * \param[in,out] dev Selector base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ */
+void sel_passthrough(struct comp_dev *dev, struct audio_stream *sink,
+		     const struct audio_stream *source, uint32_t frames);
+
 #ifdef UNIT_TEST
 void sys_comp_selector_init(void);
 #endif
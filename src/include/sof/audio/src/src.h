@@ -8,9 +8,13 @@
 #ifndef __SOF_AUDIO_SRC_SRC_H__
 #define __SOF_AUDIO_SRC_SRC_H__
 
+#include <sof/list.h>
+#include <config.h>
 #include <stddef.h>
 #include <stdint.h>
 
+struct sof_src_coef_config;
+
 struct src_param {
 	int fir_s1;
 	int fir_s2;
@@ -23,9 +27,11 @@ struct src_param {
 	int blk_out;
 	int stage1_times;
 	int stage2_times;
-	int idx_in;
-	int idx_out;
+	int fs_in;
+	int fs_out;
 	int nch;
+	struct src_stage *stage1;
+	struct src_stage *stage2;
 };
 
 struct src_stage {
@@ -115,11 +121,36 @@ void src_polyphase_stage_cir(struct src_stage_prm *s);
 void src_polyphase_stage_cir_s16(struct src_stage_prm *s);
 #endif /* CONFIG_FORMAT_S16LE */
 
-int src_buffer_lengths(struct src_param *a, int fs_in, int fs_out, int nch,
-		       int source_frames);
+int src_find_stages(struct src_param *a, int fs_in, int fs_out);
+
+int src_buffer_lengths(struct src_param *a, int nch, int source_frames);
 
 int32_t src_input_rates(void);
 
 int32_t src_output_rates(void);
 
+#if CONFIG_COMP_SRC_COEF_BLOB
+/* Coefficient set loaded at run-time and shared by all SRC instances
+ * converting between the same rates.
+ */
+struct src_coef {
+	struct list_item list;
+	int fs_in;
+	int fs_out;
+	int refs;
+	struct src_stage stage1;
+	struct src_stage stage2;
+	void *coefs;
+};
+
+int src_coef_add(const struct sof_src_coef_config *config,
+		 struct src_coef **coef);
+
+struct src_coef *src_coef_get(int fs_in, int fs_out);
+
+void src_coef_put(struct src_coef *coef);
+
+void src_coef_init(void);
+#endif /* CONFIG_COMP_SRC_COEF_BLOB */
+
 #endif /* __SOF_AUDIO_SRC_SRC_H__ */
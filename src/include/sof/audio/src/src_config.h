@@ -23,6 +23,7 @@
 #define SRC_GENERIC	1
 #define SRC_HIFIEP	0
 #define SRC_HIFI3	0
+#define SRC_X86		0
 #endif
 
 /* Select optimized code variant when xt-xcc compiler is used */
@@ -30,6 +31,7 @@
 #if defined __XCC__
 #include <xtensa/config/core-isa.h>
 #define SRC_GENERIC	0
+#define SRC_X86		0
 #if XCHAL_HAVE_HIFI2EP == 1
 #define SRC_SHORT	1  /* Select 16 bit coefficients to save RAM */
 #define SRC_HIFIEP	1
@@ -47,7 +49,13 @@
 #else
 #define SRC_SHORT	1  /* Use 16 bit filter coefficients for speed */
 #endif
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#define SRC_GENERIC	0
+#define SRC_X86		1
+#else
 #define SRC_GENERIC	1
+#define SRC_X86		0
+#endif
 #define SRC_HIFIEP	0
 #define SRC_HIFI3	0
 #endif
@@ -18,7 +18,6 @@
 
 #include <sof/audio/component.h>
 #include <sof/bit.h>
-#include <sof/schedule/task.h>
 #include <sof/trace/trace.h>
 #include <ipc/stream.h>
 #include <user/trace.h>
@@ -37,6 +36,11 @@ struct sof_ipc_ctrl_value_chan;
 #undef CONFIG_GENERIC
 #endif
 
+#elif defined(__AVX2__) || defined(__SSE4_2__)
+
+#undef CONFIG_GENERIC
+#define VOLUME_X86
+
 #endif
 
 //** \brief Volume gain Qx.y integer x number of bits including sign bit. */
@@ -47,20 +51,10 @@ struct sof_ipc_ctrl_value_chan;
 
 /**
  * \brief Volume ramp update rate in microseconds.
- * Update volume gain value every 1 ms.
+ * Update volume gain value every 125 us of processed frames, the gain
+ * is stepped inside copy() between blocks of this length.
  */
-#define VOL_RAMP_UPDATE_US 1000
-
-/**
- * \brief Macro for volume linear gain ramp step computation
- * Volume gain ramp step as Q1.16 is computed with equation
- * step = VOL_RAMP_STEP_CONST / SOF_TKN_VOLUME_RAMP_STEP_MS. This
- * macro defines as Q1.16 value the constant term
- * VOL_RAMP_UPDATE / 1000.0 for step calculation. The value 1000
- * is used to to convert microseconds to milliseconds.
- */
-#define VOL_RAMP_STEP_CONST \
-	Q_CONVERT_FLOAT(VOL_RAMP_UPDATE_US / 1000.0, VOL_QXY_Y)
+#define VOL_RAMP_UPDATE_US 125
 
 /**
  * \brief Volume maximum value.
@@ -75,6 +69,23 @@ struct sof_ipc_ctrl_value_chan;
 /** \brief Volume minimum value. */
 #define VOL_MIN		0
 
+#if CONFIG_COMP_VOLUME_METER
+/**
+ * \brief Levels of output channels accumulated by processing functions.
+ *
+ * Samples are metered as Q1.23 whatever the format is, sums of squares
+ * are Q2.46 and hold a window of about 2^17 full scale frames.
+ */
+struct vol_meter {
+	int32_t peak[SOF_IPC_MAX_CHANNELS];	/**< peak absolute sample */
+	int64_t sum[SOF_IPC_MAX_CHANNELS];	/**< sum of squared samples */
+	uint32_t frames;			/**< frames in window so far */
+	uint32_t window;			/**< frames per window */
+	int32_t level_peak[SOF_IPC_MAX_CHANNELS]; /**< last window, Q1.31 */
+	int32_t level_rms[SOF_IPC_MAX_CHANNELS]; /**< last window, Q1.31 */
+};
+#endif
+
 /**
  * \brief volume processing function interface
  */
@@ -87,7 +98,6 @@ typedef void (*vol_scale_func)(struct comp_dev *dev, struct audio_stream *sink,
  * Gain amplitude value is between 0 (mute) ... 2^16 (0dB) ... 2^24 (~+48dB).
  */
 struct comp_data {
-	struct task *volwork;		/**< volume scheduled work function */
 	struct sof_ipc_ctrl_value_chan *hvol;	/**< host volume readback */
 	int32_t volume[SOF_IPC_MAX_CHANNELS];	/**< current volume */
 	int32_t tvolume[SOF_IPC_MAX_CHANNELS];	/**< target volume */
@@ -96,17 +106,44 @@ struct comp_data {
 	int32_t vol_min;			/**< minimum volume */
 	int32_t vol_max;			/**< maximum volume */
 	int32_t	vol_ramp_range;			/**< max ramp transition */
+	int32_t ramp_step;			/**< ms per ramp block, Q16 */
+	uint32_t ramp_block_frames;		/**< frames per ramp step */
+	uint32_t ramp_frames_left;		/**< frames until next step */
 	unsigned int channels;			/**< current channels count */
 	bool muted[SOF_IPC_MAX_CHANNELS];	/**< set if channel is muted */
 	bool vol_ramp_active;			/**< set if volume is ramped */
-	bool ramp_started;			/**< control ramp launch */
 	vol_scale_func scale_vol;	/**< volume processing function */
+	vol_scale_func process_vol;	/**< processing without ramp */
+#if CONFIG_COMP_VOLUME_METER
+	struct vol_meter meter;		/**< output levels */
+#endif
 };
 
+/**
+ * \brief Meters output sample of processing functions.
+ * \param[in,out] cd Volume component private data.
+ * \param[in] channel Channel of the sample.
+ * \param[in] x Output sample as Q1.23.
+ */
+static inline void vol_meter_sample(struct comp_data *cd, uint32_t channel,
+				    int32_t x)
+{
+#if CONFIG_COMP_VOLUME_METER
+	struct vol_meter *meter = &cd->meter;
+	int32_t abs_x = x < 0 ? -x : x;
+
+	if (abs_x > meter->peak[channel])
+		meter->peak[channel] = abs_x;
+	meter->sum[channel] += (int64_t)x * x;
+#endif
+}
+
 /** \brief Volume processing functions map. */
 struct comp_func_map {
 	uint16_t frame_fmt;	/**< frame format */
+	uint16_t channels;	/**< channels count, 0 for any */
 	vol_scale_func func;	/**< volume processing function */
+	vol_scale_func masked;	/**< skips channels not read */
 };
 
 /** \brief Map of formats with dedicated processing functions. */
@@ -122,16 +159,38 @@ extern const size_t func_count;
 static inline vol_scale_func vol_get_processing_function(struct comp_dev *dev)
 {
 	struct comp_buffer *sinkb;
+#if CONFIG_ACTIVE_CHANNELS
+	uint32_t all;
+#endif
 	int i;
 
 	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
 				source_list);
 
+#if CONFIG_ACTIVE_CHANNELS
+	all = MASK(sinkb->stream.channels - 1, 0);
+
+	/* consumer doesn't read all channels */
+	if (sinkb->stream.active_mask &&
+	    (sinkb->stream.active_mask & all) != all) {
+		for (i = 0; i < func_count; i++) {
+			if (sinkb->stream.frame_fmt == func_map[i].frame_fmt &&
+			    func_map[i].masked)
+				return func_map[i].masked;
+		}
+	}
+#endif
+
 	/* map the volume function for source and sink buffers */
 	for (i = 0; i < func_count; i++) {
 		if (sinkb->stream.frame_fmt != func_map[i].frame_fmt)
 			continue;
 
+		/* first match, specializations are listed before any count */
+		if (func_map[i].channels &&
+		    func_map[i].channels != sinkb->stream.channels)
+			continue;
+
 		return func_map[i].func;
 	}
 
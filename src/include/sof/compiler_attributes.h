@@ -10,3 +10,9 @@
 #define __aligned(x) __attribute__((__aligned__(x)))
 
 #define __section(x) __attribute__((section(x)))
+
+/* period loop code, kept together to share instruction cache lines */
+#define __hot_text __section(".text.hot")
+
+/* IPC, topology and init code, kept out of the period loop lines */
+#define __cold_text __attribute__((cold)) __section(".text.unlikely")
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_DEBUG_BOOT_PROFILE_H__
+#define __SOF_DEBUG_BOOT_PROFILE_H__
+
+#include <stdint.h>
+
+/* maximum number of boot phases recorded */
+#define BOOT_PROFILE_POINTS	40
+
+/* records start of boot phase id, called by trace_point() */
+void boot_profile_point(uint32_t id);
+
+#endif /* __SOF_DEBUG_BOOT_PROFILE_H__ */
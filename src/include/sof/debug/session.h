@@ -0,0 +1,33 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_DEBUG_SESSION_H__
+#define __SOF_DEBUG_SESSION_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct comp_buffer;
+struct sof_ipc_cmd_hdr;
+struct sof_ipc_dbg_session_data;
+
+/* input signal of the current statistics window of a buffer */
+struct session_stats {
+	uint32_t frames;
+	uint32_t peak;		/* Q1.15 */
+	uint64_t sum_sq;	/* Q2.30 */
+};
+
+/* records received IPC command, called before it is handled */
+void session_record_ipc(struct sof_ipc_cmd_hdr *hdr);
+
+/* adds bytes consumed from sink buffer of host or DAI to statistics */
+void session_record_stats(struct comp_buffer *buffer, uint32_t bytes);
+
+/* fills reply with whole records following session offset */
+int session_read(struct sof_ipc_dbg_session_data *reply, uint32_t offset,
+		 uint32_t max_size, bool restart);
+
+#endif /* __SOF_DEBUG_SESSION_H__ */
@@ -20,6 +20,16 @@
 #define DMIC_UNMUTE_CIC		1	/* Unmute CIC at 1 ms */
 #define DMIC_UNMUTE_FIR		2	/* Unmute FIR at 2 ms */
 
+/* Hardwired log ramp parameters. The first value is the initial gain in
+ * decibels. The second value is the default ramp time.
+ */
+#define LOGRAMP_START_DB Q_CONVERT_FLOAT(-90, DB2LIN_FIXED_INPUT_QY)
+#define LOGRAMP_TIME_MS 400 /* Default ramp time in milliseconds */
+
+/* Limits for ramp time from topology */
+#define LOGRAMP_TIME_MIN_MS 10 /* Min. 10 ms */
+#define LOGRAMP_TIME_MAX_MS 1000 /* Max. 1s */
+
 #if CONFIG_APOLLOLAKE
 #define DMIC_HW_VERSION		1
 #define DMIC_HW_CONTROLLERS	2
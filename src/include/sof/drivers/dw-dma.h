@@ -72,6 +72,8 @@
 #define DW_CHAN_UNMASK(chan)	(DW_CHAN_WRITE_EN(chan) | DW_CHAN(chan))
 
 /* CFG_LO */
+#define DW_CFGL_RELOAD_DST	BIT(31)
+#define DW_CFGL_RELOAD_SRC	BIT(30)
 #define DW_CFGL_DRAIN		BIT(10)
 #define DW_CFGL_FIFO_EMPTY	BIT(9)
 #define DW_CFGL_SUSPEND		BIT(8)
@@ -14,6 +14,7 @@
 
 #include <errno.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define EDMA_CH_CSR                     0x00
 #define EDMA_CH_ES                      0x04
@@ -73,10 +74,29 @@
 #define EDMA_TCD_ATTR_DSIZE_32BYTE	0x0005
 #define EDMA_TCD_ATTR_DSIZE_64BYTE	0x0006
 
+#if CONFIG_IMX_DMA_RING
+#define EDMA_BUFFER_PERIOD_COUNT	CONFIG_IMX_DMA_RING_PERIODS
+#else
 #define EDMA_BUFFER_PERIOD_COUNT	2
+#endif
 
 #define EDMA_TCD_ALIGNMENT		32
 
+/* in-memory TCD, same layout as the channel TCD registers */
+struct edma_tcd {
+	uint32_t saddr;
+	uint16_t soff;
+	uint16_t attr;
+	uint32_t nbytes;
+	uint32_t slast;
+	uint32_t daddr;
+	uint16_t doff;
+	uint16_t citer;
+	uint32_t dlast_sga;
+	uint16_t csr;
+	uint16_t biter;
+};
+
 #define EDMA_HS_GET_IRQ(hs) (((hs) & MASK(8, 0)) >> 0)
 #define EDMA_HS_SET_IRQ(irq) SET_BITS(8, 0, irq)
 #define EDMA_HS_GET_CHAN(hs) (((hs) & MASK(13, 9)) >> 9)
@@ -15,6 +15,7 @@
 #define __SOF_DRIVERS_IDC_H__
 
 #include <platform/drivers/idc.h>
+#include <sof/lib/cpu.h>
 #include <sof/schedule/task.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
@@ -41,6 +42,9 @@
 /** \brief IDC send core power up flag. */
 #define IDC_POWER_UP		2
 
+/** \brief IDC send asynchronous flag, message is queued. */
+#define IDC_ASYNC		3
+
 /** \brief IDC send timeout in microseconds. */
 #define IDC_TIMEOUT	10000
 
@@ -96,12 +100,30 @@
 #define IDC_MSG_RESET		IDC_TYPE(0x8)
 #define IDC_MSG_RESET_EXT(x)	IDC_EXTENSION(x)
 
+/** \brief IDC message queue doorbell. */
+#define IDC_MSG_QUEUE		IDC_TYPE(0x9)
+#define IDC_MSG_QUEUE_EXT	IDC_EXTENSION(0x0)
+
+/** \brief IDC component channel split message. */
+#define IDC_MSG_SPLIT		IDC_TYPE(0xa)
+#define IDC_MSG_SPLIT_EXT(x)	IDC_EXTENSION(x)
+
+/** \brief IDC migratable EDF task queued message. */
+#define IDC_MSG_EDF_STEAL	IDC_TYPE(0xb)
+#define IDC_MSG_EDF_STEAL_EXT	IDC_EXTENSION(0x0)
+
 /** \brief Decodes IDC message type. */
 #define iTS(x)	(((x) >> IDC_TYPE_SHIFT) & IDC_TYPE_MASK)
 
 /** \brief Max IDC message payload size in bytes. */
 #define IDC_MAX_PAYLOAD_SIZE	96
 
+/** \brief Number of queued asynchronous messages per pair of cores. */
+#define IDC_QUEUE_SIZE		8
+
+/** \brief Max payload size in bytes kept inline in a queued message. */
+#define IDC_QUEUE_PAYLOAD_SIZE	4
+
 /** \brief IDC message payload. */
 struct idc_payload {
 	uint8_t data[IDC_MAX_PAYLOAD_SIZE];
@@ -114,6 +136,40 @@ struct idc_msg {
 	uint32_t core;		/**< core id */
 	uint32_t size;		/**< payload size in bytes */
 	void *payload;		/**< pointer to payload data */
+
+	/** called on sender core with the status of an IDC_ASYNC message */
+	void (*complete)(void *data, int status);
+	void *complete_data;	/**< argument of complete callback */
+};
+
+/** \brief Queued IDC message. */
+struct idc_queue_msg {
+	uint32_t header;	/**< header value */
+	uint32_t extension;	/**< extension value */
+	uint32_t size;		/**< payload size in bytes */
+	int32_t status;		/**< execution status set by receiver */
+	void *ext_payload;	/**< payload too big to be inline, or NULL */
+	uint8_t data[IDC_QUEUE_PAYLOAD_SIZE];	/**< inline payload */
+};
+
+/**
+ * \brief Ring of messages sent from one core to another.
+ *
+ * Single producer (source core) moves head forward, single consumer
+ * (target core) moves tail forward after setting the message status,
+ * so no locking is needed. Both are free running counters.
+ */
+struct idc_queue {
+	uint32_t head;		/**< next message to be written by source */
+	uint32_t tail;		/**< next message to be executed by target */
+	struct idc_queue_msg msg[IDC_QUEUE_SIZE];
+};
+
+/** \brief Completion of a queued message, kept on the sender core. */
+struct idc_completion {
+	void (*cb)(void *data, int status);
+	void *data;
+	void *payload;	/**< heap copy of payload, freed on completion */
 };
 
 /** \brief IDC data. */
@@ -122,6 +178,10 @@ struct idc {
 	struct idc_msg received_msg;	/**< received message */
 	struct task idc_task;		/**< IDC processing task */
 	struct idc_payload *payload;
+	struct idc_queue *queue;	/**< [source][target] message queues */
+	uint32_t reaped[PLATFORM_CORE_COUNT];	/**< completed per target */
+	int async_status[PLATFORM_CORE_COUNT];	/**< first async error */
+	struct idc_completion completion[PLATFORM_CORE_COUNT][IDC_QUEUE_SIZE];
 	int irq;
 };
 
@@ -131,6 +191,12 @@ static inline struct idc_payload *idc_payload_get(struct idc *idc,
 	return idc->payload + core;
 }
 
+static inline struct idc_queue *idc_queue_get(struct idc *idc,
+					      uint32_t source, uint32_t target)
+{
+	return idc->queue + source * PLATFORM_CORE_COUNT + target;
+}
+
 void idc_enable_interrupts(int target_core, int source_core);
 
 void idc_free(void);
@@ -19,6 +19,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+struct sof_ipc_dbg_irq_stats;
+
 #define trace_irq(__e)	trace_event(TRACE_CLASS_IRQ, __e)
 #define trace_irq_error(__e, ...) \
 	trace_error(TRACE_CLASS_IRQ,  __e, ##__VA_ARGS__)
@@ -33,6 +35,15 @@ struct irq_child {
 						  */
 };
 
+/**
+ * \brief interrupt handler accounting of one core
+ */
+struct irq_stats {
+	uint32_t count;			/**< handler runs */
+	uint32_t cycles_max;		/**< longest run in core cycles */
+	uint64_t cycles;		/**< core cycles of all runs */
+};
+
 /**
  * \brief interrupt client descriptor
  */
@@ -44,6 +55,9 @@ struct irq_desc {
 					  * interrupt is enabled
 					  */
 	struct list_item irq_list;	/**< to link to other irq_desc */
+#if CONFIG_IRQ_STATS
+	struct irq_stats stats[PLATFORM_CORE_COUNT];	/**< per core */
+#endif
 };
 
 /**
@@ -146,6 +160,31 @@ int interrupt_cascade_register(const struct irq_cascade_tmpl *tmpl);
 struct irq_cascade_desc *interrupt_get_parent(uint32_t irq);
 int interrupt_get_irq(unsigned int irq, const char *cascade);
 
+#if CONFIG_IRQ_STATS
+/**
+ * \brief Runs handler of a child interrupt, accounting it to the core.
+ * \param[in,out] desc Child interrupt descriptor.
+ * \param[in] core Core running the handler.
+ */
+void interrupt_desc_run(struct irq_desc *desc, int core);
+
+/**
+ * \brief Retrieves interrupt accounting of a core.
+ * \param[out] info Reply filled with interrupts fitting in max_size.
+ * \param[in] max_size Size of the reply buffer.
+ * \param[in] core Core of the accounting.
+ * \param[in] reset Clears the accounting once read.
+ * \return 0 if succeeded, error code otherwise.
+ */
+int interrupt_stats_get(struct sof_ipc_dbg_irq_stats *info,
+			uint32_t max_size, int core, bool reset);
+#else
+static inline void interrupt_desc_run(struct irq_desc *desc, int core)
+{
+	desc->handler(desc->handler_arg);
+}
+#endif
+
 static inline void interrupt_set(int irq)
 {
 	platform_interrupt_set(irq);
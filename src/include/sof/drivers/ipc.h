@@ -23,6 +23,7 @@
 #include <ipc/topology.h>
 #include <ipc/trace.h>
 #include <user/trace.h>
+#include <config.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -54,6 +55,9 @@ struct ipc_msg;
 #define COMP_TYPE_BUFFER	2
 #define COMP_TYPE_PIPELINE	3
 
+/* size of component lookup tables, must be a power of 2 */
+#define IPC_COMP_HASH_SIZE	64
+
 /* validates internal non tail structures within IPC command structure */
 #define IPC_IS_SIZE_INVALID(object)					\
 	(object).hdr.size == sizeof(object) ? 0 : 1
@@ -78,6 +82,8 @@ struct ipc_comp_dev {
 
 	/* lists */
 	struct list_item list;		/* list in components */
+	struct ipc_comp_dev *id_next;	/* next in id table slot */
+	struct ipc_comp_dev *ppl_next;	/* next in pipeline table slot */
 };
 
 struct ipc_msg {
@@ -85,6 +91,9 @@ struct ipc_msg {
 	uint32_t tx_size;	/* payload size in bytes */
 	void *tx_data;		/* pointer to payload data */
 	struct list_item list;
+#if CONFIG_IPC_MSG_RATE_LIMIT
+	uint64_t tx_time;	/* timer ticks of last send, 0 if never */
+#endif
 };
 
 struct ipc {
@@ -96,9 +105,24 @@ struct ipc {
 
 	struct list_item msg_list;	/* queue of messages to be sent */
 	bool is_notification_pending;	/* notification is being sent to host */
+#if CONFIG_IPC_MSG_RATE_LIMIT
+	/* sends rate limited messages, each core schedules its own */
+	struct task msg_retry_task[PLATFORM_CORE_COUNT];
+	/* timer ticks of retry scheduled by each core, 0 if none */
+	uint64_t msg_retry[PLATFORM_CORE_COUNT];
+#endif
 
 	struct list_item comp_list;	/* list of component devices */
 
+	/* component devices by id and pipelines by pipeline id */
+	struct ipc_comp_dev *comp_table[IPC_COMP_HASH_SIZE];
+	struct ipc_comp_dev *ppl_table[IPC_COMP_HASH_SIZE];
+
+#if CONFIG_IPC_PIPELINE_PLACEMENT
+	struct list_item placement_list;	/* cores picked for pipelines */
+	uint32_t core_mcps[PLATFORM_CORE_COUNT];	/* declared by pipelines */
+#endif
+
 	/* processing task */
 	struct task ipc_task;
 
@@ -225,6 +249,9 @@ void ipc_schedule_process(struct ipc *ipc);
 
 int ipc_platform_send_msg(struct ipc_msg *msg);
 
+/* sends msg unless its class is rate limited, called with ipc lock held */
+int ipc_msg_tx(struct ipc *ipc, struct ipc_msg *msg);
+
 void ipc_send_queued_msg(void);
 
 void ipc_msg_send(struct ipc_msg *msg, void *data, bool high_priority);
@@ -277,6 +304,17 @@ int ipc_comp_free(struct ipc *ipc, uint32_t comp_id);
 int ipc_buffer_new(struct ipc *ipc, struct sof_ipc_buffer *buffer);
 int ipc_buffer_free(struct ipc *ipc, uint32_t buffer_id);
 
+#if CONFIG_BUFFER_COMPACTION
+/**
+ * \brief Packs buffers of this core with no stream running to the bottom
+ * of their heaps, so free memory joins into large blocks.
+ * @param[in] ipc Global IPC context.
+ */
+void ipc_buffers_compact(struct ipc *ipc);
+#else
+static inline void ipc_buffers_compact(struct ipc *ipc) { }
+#endif
+
 /*
  * IPC Pipeline creation and destruction.
  */
@@ -284,12 +322,41 @@ int ipc_pipeline_new(struct ipc *ipc, struct sof_ipc_pipe_new *pipeline);
 int ipc_pipeline_free(struct ipc *ipc, uint32_t comp_id);
 int ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id);
 
+#if CONFIG_IPC_PIPELINE_PLACEMENT
+/**
+ * \brief Resolves the core of a new topology object.
+ * @param[in] ipc Global IPC context.
+ * @param[in] pipeline_id Pipeline of the object.
+ * @param[in] core Core requested by the host.
+ * @param[in] follow Core taken by a pipeline not placed yet, -1 if any.
+ * @return Core to create the object on.
+ *
+ * SOF_IPC_CORE_AUTO is resolved to the core of the pipeline, which is
+ * picked by load on its first object. Other cores are kept.
+ */
+uint32_t ipc_placement_core(struct ipc *ipc, uint32_t pipeline_id,
+			    uint32_t core, int follow);
+#else
+static inline uint32_t ipc_placement_core(struct ipc *ipc,
+					  uint32_t pipeline_id,
+					  uint32_t core, int follow)
+{
+	return core == SOF_IPC_CORE_AUTO ? PLATFORM_MASTER_CORE_ID : core;
+}
+#endif
+
 /*
  * Pipeline component and buffer connections.
  */
 int ipc_comp_connect(struct ipc *ipc,
 	struct sof_ipc_pipe_comp_connect *connect);
 
+/*
+ * Topology image instantiation, count returns records completed.
+ */
+int ipc_tplg_image_new(struct ipc *ipc, void *image, uint32_t size,
+		       uint32_t *count);
+
 /*
  * Get component by ID.
  */
@@ -317,8 +384,17 @@ struct sof_ipc_cmd_hdr *mailbox_validate(void);
  * specific method.
  *
  * @param hdr Points to the IPC command header.
+ * @return Error code the host is replied with, 0 if replied by the command.
  */
-void ipc_cmd(struct sof_ipc_cmd_hdr *hdr);
+int ipc_cmd(struct sof_ipc_cmd_hdr *hdr);
+
+/**
+ * \brief Runs the IPC command from the inbox right away if it is short
+ * and non blocking (stream trigger or position, volume set) and targets
+ * a component on the current core.
+ * @return true if the command was run and its reply written.
+ */
+bool ipc_cmd_fast(void);
 
 /**
  * \brief IPC message to be processed on other core.
@@ -327,6 +403,14 @@ void ipc_cmd(struct sof_ipc_cmd_hdr *hdr);
  */
 int ipc_process_on_core(uint32_t core);
 
+/**
+ * \brief IPC message to be processed on several other cores at once.
+ * @param[in] core_mask Mask of cores for IPC to be processed on.
+ * @return 0 if successful (replies sent by other cores), first error code
+ *	   otherwise.
+ */
+int ipc_process_on_cores(uint32_t core_mask);
+
 /**
  * \brief Initialise IPC hardware for polling mode.
  * @return 0 if successful error code otherwise.
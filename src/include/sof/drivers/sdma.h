@@ -118,8 +118,14 @@
 #define SDMA_BD_CMD_MASK	MASK(31, 24)
 #define SDMA_BD_CMD(cmd)	SET_BITS(31, 24, cmd)
 
-/* We don't need more than 4 buffer descriptors per channel */
+/* We don't need more than 4 buffer descriptors per channel, unless
+ * DMA ring buffers have more periods
+ */
+#if CONFIG_IMX_DMA_RING && CONFIG_IMX_DMA_RING_PERIODS > 4
+#define SDMA_MAX_BDS		CONFIG_IMX_DMA_RING_PERIODS
+#else
 #define SDMA_MAX_BDS		4
+#endif
 
 #define SDMA_CMD_C0_SET_PM		0x4
 #define SDMA_CMD_C0_SET_DM		0x1
@@ -17,6 +17,10 @@
 #define __SOF_LIB_ALLOC_H__
 
 #include <sof/bit.h>
+#include <sof/common.h>
+#include <sof/compiler_attributes.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/memory.h>
 #include <sof/string.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
@@ -157,6 +161,125 @@ void rfree(void *ptr);
  */
 void *rzalloc_core_sys(int core, size_t bytes);
 
+/** \name Allocation owners
+ *  @{
+ */
+
+/** \brief No owner, allocations aren't attributed. */
+#define ALLOC_OWNER_NONE	0
+
+/** \brief Owner value of a topology object id. */
+#define ALLOC_OWNER(id)		((id) + 1)
+
+/** \brief Topology object id of an owner value. */
+#define ALLOC_OWNER_ID(owner)	((owner) - 1)
+
+#if CONFIG_DEBUG_MEM_OWNER
+/**
+ * Attributes the following freeable allocations of the calling core to an
+ * owner, until another one is set.
+ * @param owner ALLOC_OWNER() of a topology object or ALLOC_OWNER_NONE.
+ * @return Previous owner, to be set back when done.
+ */
+uint32_t alloc_owner_set(uint32_t owner);
+
+/**
+ * Calls fn for every allocation having an owner, with the heap bytes it
+ * takes. Runs with heap locks held, fn must not allocate.
+ * @param fn Function called for each allocation.
+ * @param arg Argument of fn.
+ */
+void alloc_owner_walk(void (*fn)(void *arg, uint32_t owner, uint32_t bytes),
+		      void *arg);
+#else
+static inline uint32_t alloc_owner_set(uint32_t owner)
+{
+	return ALLOC_OWNER_NONE;
+}
+#endif
+
+/** @} */
+
+/** \name Object caches
+ *  @{
+ */
+
+/** \brief Per core free list of the object cache. */
+struct mem_cache_core {
+	void *free_list;	/**< first free object */
+	uint32_t free_count;	/**< number of free objects */
+} __aligned(PLATFORM_DCACHE_ALIGN);
+
+/**
+ * \brief Cache of fixed size objects.
+ *
+ * Objects are carved out of slabs allocated from the given zone and kept
+ * on per core free lists, so allocating and freeing them doesn't take
+ * the global heap lock. Slabs are never returned to the heap, memory of
+ * freed objects is only reused by the same cache. Object freed on another
+ * core than it was allocated on joins the free list of the freeing core.
+ */
+struct mem_cache {
+	uint32_t obj_size;	/**< aligned object size in bytes */
+	uint32_t slab_objs;	/**< number of objects in one slab */
+	enum mem_zone zone;	/**< zone to allocate slabs from */
+	uint32_t flags;		/**< slab flags, see SOF_MEM_FLAG_... */
+	uint32_t caps;		/**< slab capabilities, see SOF_MEM_CAPS_... */
+	struct mem_cache_core core[PLATFORM_CORE_COUNT];
+};
+
+/**
+ * \brief Static initializer of the cache for objects of the given type.
+ * @param type Object type.
+ * @param z Zone, see enum mem_zone (SOF_MEM_ZONE_SYS is not freeable).
+ * @param f Flags, see SOF_MEM_FLAG_...
+ * @param c Capabilities, see SOF_MEM_CAPS_...
+ * @param objs Number of objects allocated at once on refill.
+ */
+#define MEM_CACHE_INIT(type, z, f, c, objs) {				\
+	.obj_size = ALIGN_UP(sizeof(type), PLATFORM_DCACHE_ALIGN),	\
+	.slab_objs = (objs),						\
+	.zone = (z),							\
+	.flags = (f),							\
+	.caps = (c),							\
+}
+
+/**
+ * Creates cache of fixed size objects.
+ * @param zone Zone to allocate slabs from, see enum mem_zone.
+ * @param flags Flags, see SOF_MEM_FLAG_...
+ * @param caps Capabilities, see SOF_MEM_CAPS_...
+ * @param size Object size in bytes.
+ * @param slab_objs Number of objects allocated at once on refill.
+ * @return Pointer to the new cache or NULL if failed.
+ *
+ * @note Caches are never destroyed, created ones live in SOF_MEM_ZONE_SYS.
+ */
+struct mem_cache *mem_cache_create(enum mem_zone zone, uint32_t flags,
+				   uint32_t caps, size_t size,
+				   uint32_t slab_objs);
+
+/**
+ * Allocates object from the cache.
+ * @param cache Object cache.
+ * @return Pointer to the object or NULL if failed.
+ */
+void *mem_cache_alloc(struct mem_cache *cache);
+
+/**
+ * Similar to mem_cache_alloc(), guarantees that returned object is zeroed.
+ */
+void *mem_cache_zalloc(struct mem_cache *cache);
+
+/**
+ * Returns object to the cache.
+ * @param cache Object cache the object has been allocated from.
+ * @param ptr Pointer to the object, NULL is ignored.
+ */
+void mem_cache_free(struct mem_cache *cache, void *ptr);
+
+/** @} */
+
 /** \brief Zeroes memory block.
  * @param ptr Pointer to the memory block.
  * @param size Size of the block in bytes.
@@ -22,4 +22,7 @@
 /* invalidate data */
 #define CACHE_INVALIDATE	1
 
+/* writeback data */
+#define CACHE_WRITEBACK		2
+
 #endif /* __SOF_LIB_CACHE_H__ */
@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/lib/cache_batch.h
+ * \brief Batched data cache maintenance
+ *
+ * Code doing the same data cache operation on several small regions in a
+ * row collects them in a batch instead. Regions are rounded to cache lines
+ * and merged with the ones they overlap or touch, so every line is
+ * maintained once and adjacent regions take a single operation. Once the
+ * merged size reaches CONFIG_CACHE_BATCH_ALL_SIZE, the whole cache is
+ * maintained instead of the regions.
+ *
+ * Operations are deferred until cache_batch_flush(), so a batch has to be
+ * flushed before the data is handed to DMA or another core, or read after
+ * invalidation.
+ */
+
+#ifndef __SOF_LIB_CACHE_BATCH_H__
+#define __SOF_LIB_CACHE_BATCH_H__
+
+#include <sof/lib/cache.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** \brief Separate ranges kept by a batch, it's flushed when they run out */
+#define CACHE_BATCH_RANGES	8
+
+/** \brief Range of cache lines, end is exclusive. */
+struct cache_batch_range {
+	uintptr_t start;
+	uintptr_t end;
+};
+
+/** \brief Batch of one data cache operation. */
+struct cache_batch {
+	int op;			/**< CACHE_WRITEBACK or CACHE_INVALIDATE */
+	uint32_t count;		/**< used ranges */
+	size_t size;		/**< bytes of all ranges */
+	struct cache_batch_range range[CACHE_BATCH_RANGES];
+};
+
+/**
+ * Starts an empty batch.
+ * @param batch Batch, usually on stack.
+ * @param op CACHE_WRITEBACK or CACHE_INVALIDATE.
+ */
+static inline void cache_batch_init(struct cache_batch *batch, int op)
+{
+	batch->op = op;
+	batch->count = 0;
+	batch->size = 0;
+}
+
+/**
+ * Adds a region to the batch.
+ * @param batch Batch.
+ * @param addr Start of the region.
+ * @param size Size of the region in bytes.
+ */
+void cache_batch_add(struct cache_batch *batch, void *addr, size_t size);
+
+/**
+ * Does the operation on all regions of the batch and empties it.
+ * @param batch Batch.
+ */
+void cache_batch_flush(struct cache_batch *batch);
+
+#endif /* __SOF_LIB_CACHE_BATCH_H__ */
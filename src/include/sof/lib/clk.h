@@ -12,6 +12,7 @@
 #include <platform/lib/clk.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
+#include <config.h>
 #include <stdint.h>
 
 struct timer;
@@ -51,6 +52,35 @@ uint64_t clock_ms_to_ticks(int clock, uint64_t ms);
 
 void platform_timer_set_delta(struct timer *timer, uint64_t ns);
 
+/* lowest CPU frequency a running stream holds the governor to */
+#define CLOCK_GOV_FLOOR_NONE	0
+#define CLOCK_GOV_FLOOR_HALF	1	/* half of the maximum frequency */
+#define CLOCK_GOV_FLOOR_MAX	2
+#define CLOCK_GOV_FLOORS	3
+
+#if CONFIG_CLK_GOVERNOR
+/* CPU frequency governor, per core demand in MCPS */
+void clock_gov_pipeline_start(int core, uint32_t mcps);
+
+void clock_gov_pipeline_stop(int core, uint32_t mcps);
+
+void clock_gov_load(int core, uint32_t mcps);
+
+uint32_t clock_gov_core_load(int core);
+
+/* frequency floor, CLOCK_GOV_FLOOR_, held from get to put */
+void clock_gov_floor_get(int core, int floor);
+
+void clock_gov_floor_put(int core, int floor);
+#else
+static inline void clock_gov_pipeline_start(int core, uint32_t mcps) { }
+static inline void clock_gov_pipeline_stop(int core, uint32_t mcps) { }
+static inline void clock_gov_load(int core, uint32_t mcps) { }
+static inline uint32_t clock_gov_core_load(int core) { return 0; }
+static inline void clock_gov_floor_get(int core, int floor) { }
+static inline void clock_gov_floor_put(int core, int floor) { }
+#endif
+
 static inline struct clock_info *clocks_get(void)
 {
 	return sof_get()->clocks;
@@ -55,6 +55,22 @@ static inline int cpu_is_core_enabled(int id)
 	return arch_cpu_is_core_enabled(id);
 }
 
+/* mask of powered cores */
+static inline int cpu_enabled_cores(void)
+{
+	return arch_cpu_enabled_cores();
+}
+
+/*
+ * Data written by one core is read by another only while both run. The
+ * master core writes back its whole cache before powering up another one,
+ * so while it runs alone such writebacks can be skipped.
+ */
+static inline bool cpu_is_multicore_active(void)
+{
+	return cpu_enabled_cores() != 1 << PLATFORM_MASTER_CORE_ID;
+}
+
 #endif
 
 #endif /* __SOF_LIB_CPU_H__ */
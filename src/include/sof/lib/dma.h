@@ -135,6 +135,7 @@ struct dma_sg_config {
 	bool irq_disabled;
 	/* true if configured DMA channel is the scheduling source */
 	bool is_scheduling_source;
+	uint32_t dmac_config;			/* DMA engine specific */
 };
 
 struct dma_chan_status {
@@ -199,6 +200,12 @@ struct dma {
 	atomic_t num_channels_busy; /* number of busy channels */
 	struct dma_chan_data *chan; /* channels array */
 	void *priv_data;
+
+	/* scheduling domain tracking the running scheduling source channels,
+	 * called after a channel is started, stopped or reconfigured
+	 */
+	void (*sched_update)(void *data, struct dma_chan_data *channel);
+	void *sched_data;
 };
 
 struct dma_chan_data {
@@ -291,9 +298,19 @@ static inline struct dma_chan_data *dma_channel_get(struct dma *dma,
 	return chan;
 }
 
+/* lets the scheduling domain follow channel state without scanning */
+static inline void dma_sched_update(struct dma_chan_data *channel)
+{
+	struct dma *dma = channel->dma;
+
+	if (dma->sched_update)
+		dma->sched_update(dma->sched_data, channel);
+}
+
 static inline void dma_channel_put(struct dma_chan_data *channel)
 {
 	channel->dma->ops->channel_put(channel);
+	dma_sched_update(channel);
 
 	platform_shared_commit(channel->dma, sizeof(*channel->dma));
 	platform_shared_commit(channel, sizeof(*channel));
@@ -303,6 +320,8 @@ static inline int dma_start(struct dma_chan_data *channel)
 {
 	int ret = channel->dma->ops->start(channel);
 
+	dma_sched_update(channel);
+
 	platform_shared_commit(channel->dma, sizeof(*channel->dma));
 	platform_shared_commit(channel, sizeof(*channel));
 
@@ -313,6 +332,8 @@ static inline int dma_stop(struct dma_chan_data *channel)
 {
 	int ret = channel->dma->ops->stop(channel);
 
+	dma_sched_update(channel);
+
 	platform_shared_commit(channel->dma, sizeof(*channel->dma));
 	platform_shared_commit(channel, sizeof(*channel));
 
@@ -334,6 +355,8 @@ static inline int dma_pause(struct dma_chan_data *channel)
 {
 	int ret = channel->dma->ops->pause(channel);
 
+	dma_sched_update(channel);
+
 	platform_shared_commit(channel->dma, sizeof(*channel->dma));
 	platform_shared_commit(channel, sizeof(*channel));
 
@@ -344,6 +367,8 @@ static inline int dma_release(struct dma_chan_data *channel)
 {
 	int ret = channel->dma->ops->release(channel);
 
+	dma_sched_update(channel);
+
 	platform_shared_commit(channel->dma, sizeof(*channel->dma));
 	platform_shared_commit(channel, sizeof(*channel));
 
@@ -366,6 +391,8 @@ static inline int dma_set_config(struct dma_chan_data *channel,
 {
 	int ret = channel->dma->ops->set_config(channel, config);
 
+	dma_sched_update(channel);
+
 	platform_shared_commit(channel->dma, sizeof(*channel->dma));
 	platform_shared_commit(channel, sizeof(*channel));
 
@@ -576,8 +603,35 @@ int dma_sg_alloc(struct dma_sg_elem_array *ea,
 		 uint32_t buffer_count, uint32_t buffer_bytes,
 		 uintptr_t dma_buffer_addr, uintptr_t external_addr);
 
+/**
+ * \brief Set SG elements up, reusing already allocated ones
+ *
+ * Elements are only reallocated if their count changes, so repeated
+ * configuration of a restarted stream doesn't go through the allocator.
+ */
+int dma_sg_update(struct dma_sg_elem_array *ea,
+		  enum mem_zone zone,
+		  uint32_t direction,
+		  uint32_t buffer_count, uint32_t buffer_bytes,
+		  uintptr_t dma_buffer_addr, uintptr_t external_addr);
+
 void dma_sg_free(struct dma_sg_elem_array *ea);
 
+/**
+ * \brief Get the number of periods for DMA buffer
+ *
+ * Short periods aren't necessarily aligned to the DMA buffer alignment,
+ * so the count is raised until the whole number of periods is aligned.
+ * This keeps every SG element one period long.
+ *
+ * \param period_bytes Size of one period.
+ * \param period_count Minimum number of periods.
+ * \param align Required buffer size alignment.
+ * \return Number of periods.
+ */
+uint32_t dma_buffer_period_count(uint32_t period_bytes, uint32_t period_count,
+				 uint32_t align);
+
 /**
  * \brief Get the total size of SG buffer
  *
@@ -596,18 +650,25 @@ static inline uint32_t dma_sg_get_size(struct dma_sg_elem_array *ea)
 }
 
 struct audio_stream;
+struct pcm_chmap;
 typedef void (*dma_process)(const struct audio_stream *,
 			    struct audio_stream *, uint32_t);
 
-/* copies data from DMA buffer using provided processing function */
+/* copies data from DMA buffer using provided processing function,
+ * or remapping channels with chmap when it is set
+ */
 void dma_buffer_copy_from(struct comp_buffer *source, uint32_t source_bytes,
 			  struct comp_buffer *sink, uint32_t sink_bytes,
-			  dma_process_func process, uint32_t samples);
+			  dma_process_func process, uint32_t samples,
+			  const struct pcm_chmap *chmap);
 
-/* copies data to DMA buffer using provided processing function */
+/* copies data to DMA buffer using provided processing function,
+ * or remapping channels with chmap when it is set
+ */
 void dma_buffer_copy_to(struct comp_buffer *source, uint32_t source_bytes,
 			struct comp_buffer *sink, uint32_t sink_bytes,
-			dma_process_func process, uint32_t samples);
+			dma_process_func process, uint32_t samples,
+			const struct pcm_chmap *chmap);
 
 /* generic DMA DSP <-> Host copier */
 
@@ -619,6 +680,9 @@ struct dma_copy {
 /* init dma copy context */
 int dma_copy_new(struct dma_copy *dc);
 
+/* init dma copy context for local memory copies */
+int dma_copy_new_local(struct dma_copy *dc);
+
 /* free dma copy context resources */
 static inline void dma_copy_free(struct dma_copy *dc)
 {
@@ -634,11 +698,23 @@ int dma_copy_from_host_nowait(struct dma_copy *dc,
 			      int32_t size);
 
 /* DMA copy data from DSP to host */
+int dma_copy_to_host(struct dma_copy *dc, struct dma_sg_config *host_sg,
+		     int32_t host_offset, void *local_ptr, int32_t size);
 int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	int32_t host_offset, void *local_ptr, int32_t size);
 
 int dma_copy_set_stream_tag(struct dma_copy *dc, uint32_t stream_tag);
 
+/* DMA copy data from DSP memory to DSP memory */
+int dma_copy_local(struct dma_copy *dc, void *dest, void *src, int32_t size);
+
+/* DMA copy data from DSP memory to DSP memory without waiting */
+int dma_copy_local_start(struct dma_copy *dc, void *dest, void *src,
+			 int32_t size);
+
+/* check if one shot DMA copy started on the channel has finished */
+int dma_copy_local_done(struct dma_copy *dc);
+
 static inline const struct dma_info *dma_info_get(void)
 {
 	return sof_get()->dma_info;
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/lib/idle.h
+ * \brief Idle governor API definition
+ */
+
+#ifndef __SOF_LIB_IDLE_H__
+#define __SOF_LIB_IDLE_H__
+
+#include <config.h>
+#include <stdbool.h>
+
+struct sof_ipc_dbg_idle_stats;
+
+/**
+ * \brief Waits for interrupt in the deepest idle state allowed, which pays
+ *	  off its entry and exit before the next LL deadline of the core.
+ * \param[in] level Interrupt level.
+ */
+void platform_idle_enter(int level);
+
+/**
+ * \brief Fills idle state statistics of the core.
+ * \param[out] info Reply with an element for each idle state.
+ * \param[in] core Core to report.
+ * \param[in] reset Clears the statistics after they are read.
+ * \return 0 if successful, error code otherwise.
+ */
+int platform_idle_stats_get(struct sof_ipc_dbg_idle_stats *info, int core,
+			    bool reset);
+
+#if CONFIG_IDLE_GOVERNOR
+/**
+ * \brief Keeps the core out of idle states deeper than state until
+ *	  idle_limit_put(), e.g. while a low latency stream runs.
+ * \param[in] core Core to limit.
+ * \param[in] state Deepest allowed state, SOF_IPC_IDLE_.
+ */
+void idle_limit_get(int core, int state);
+
+/**
+ * \brief Releases a limit of idle_limit_get().
+ * \param[in] core Limited core.
+ * \param[in] state State passed to idle_limit_get().
+ */
+void idle_limit_put(int core, int state);
+#else
+static inline void idle_limit_get(int core, int state) { }
+static inline void idle_limit_put(int core, int state) { }
+#endif
+
+#endif /* __SOF_LIB_IDLE_H__ */
@@ -10,4 +10,11 @@
 
 #include <platform/lib/memory.h>
 
+/* platforms without uncached alias of memory access it through cache */
+#ifndef cache_to_uncache
+#define uncache_to_cache(address)	address
+#define cache_to_uncache(address)	address
+#define is_uncached(address)		0
+#endif
+
 #endif /* __SOF_LIB_MEMORY_H__ */
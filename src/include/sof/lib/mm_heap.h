@@ -21,6 +21,7 @@
 
 struct dma_copy;
 struct dma_sg_config;
+struct sof_ipc_dbg_heap_info;
 
 struct mm_info {
 	uint32_t used;
@@ -31,6 +32,9 @@ struct block_hdr {
 	uint16_t size;		/* size in blocks for continuous allocation */
 	uint16_t used;		/* usage flags for page */
 	void *unaligned_ptr;	/* align ptr */
+#if CONFIG_DEBUG_MEM_OWNER
+	uint32_t owner;		/* ALLOC_OWNER() of first block */
+#endif
 } __packed;
 
 struct block_map {
@@ -42,6 +46,11 @@ struct block_map {
 	uint32_t base;		/* base address of space */
 };
 
+#if CONFIG_HEAP_BANK_PM
+/* max number of power gated SRAM banks in one heap */
+#define MM_HEAP_BANKS	32
+#endif
+
 #define BLOCK_DEF(sz, cnt, hdr) \
 	{.block_size = sz, .count = cnt, .free_count = cnt, .block = hdr, \
 	 .first_free = 0}
@@ -53,8 +62,28 @@ struct mm_heap {
 	uint32_t size;
 	uint32_t caps;
 	struct mm_info info;
+	uint32_t peak_used;	/* high water mark of info.used */
+	uint32_t alloc_fails;	/* failed allocation attempts */
+	spinlock_t lock;	/* protects block maps and info */
+#if CONFIG_HEAP_BANK_PM
+	uint32_t bank_base;	/* first SRAM bank fully inside the heap */
+	uint32_t bank_count;	/* number of banks fully inside the heap */
+	uint32_t bank_powered;	/* mask of powered banks */
+	uint32_t bank_used[MM_HEAP_BANKS];	/* used bytes of each bank */
+#endif
+};
+
+/* address range of the freeable heap, used to find heap of freed ptr */
+struct mm_heap_range {
+	uint32_t start;
+	uint32_t end;
+	struct mm_heap *heap;
 };
 
+#define MM_HEAP_RANGE_COUNT \
+	(PLATFORM_HEAP_SYSTEM_RUNTIME + PLATFORM_HEAP_RUNTIME + \
+	 PLATFORM_HEAP_BUFFER)
+
 /* heap block memory map */
 struct mm {
 	/* system heap - used during init cannot be freed */
@@ -68,7 +97,10 @@ struct mm {
 
 	struct mm_info total;
 	uint32_t heap_trace_updated;	/* updates that can be presented */
-	spinlock_t lock;	/* all allocs and frees are atomic */
+
+	/* freeable heaps sorted by start address */
+	struct mm_heap_range heap_range[MM_HEAP_RANGE_COUNT];
+	uint32_t heap_range_count;
 };
 
 /* Heap save/restore contents and context for PM D0/D3 events */
@@ -82,10 +114,20 @@ void init_heap(struct sof *sof);
 /* frees entire heap (supported for slave core system heap atm) */
 void free_heap(enum mem_zone zone);
 
+#if CONFIG_HEAP_BANK_PM
+/* power gates buffer heap banks without any allocation */
+void heap_gate_free_banks(void);
+#else
+static inline void heap_gate_free_banks(void) { }
+#endif
+
 /* status */
 void heap_trace_all(int force);
 void heap_trace(struct mm_heap *heap, int size);
 
+/* fills snapshot of all heaps for the host, up to max_size bytes */
+int heap_info_get(struct sof_ipc_dbg_heap_info *info, uint32_t max_size);
+
 /* retrieve memory map pointer */
 static inline struct mm *memmap_get(void)
 {
@@ -10,6 +10,7 @@
 
 #include <sof/list.h>
 #include <sof/sof.h>
+#include <sof/spinlock.h>
 #include <stdint.h>
 
 /* notifier target core masks */
@@ -30,8 +31,17 @@ enum notify_id {
 	NOTIFIER_ID_COUNT
 };
 
+/* number of caller hash buckets per notification type, power of 2 */
+#define NOTIFIER_BUCKETS		8
+
+/* maximum number of events queued for one remote core */
+#define NOTIFIER_REMOTE_EVENTS		8
+
 struct notify {
-	struct list_item list[NOTIFIER_ID_COUNT]; /* list of callback handles */
+	/* callback handles registered for any caller */
+	struct list_item list[NOTIFIER_ID_COUNT];
+	/* callback handles registered for a specific caller, hashed by it */
+	struct list_item caller_list[NOTIFIER_ID_COUNT][NOTIFIER_BUCKETS];
 };
 
 struct notify_data {
@@ -41,6 +51,13 @@ struct notify_data {
 	void *data;
 };
 
+/* events for one core, delivered together with a single IDC message */
+struct notify_queue {
+	spinlock_t lock;		/* protects queue from producer cores */
+	uint32_t count;
+	struct notify_data events[NOTIFIER_REMOTE_EVENTS];
+};
+
 #ifdef CLK_SSP
 #define NOTIFIER_CLK_CHANGE_ID(clk) \
 	((clk) == CLK_SSP ? NOTIFIER_ID_SSP_FREQ : NOTIFIER_ID_CPU_FREQ)
@@ -63,9 +80,9 @@ void init_system_notify(struct sof *sof);
 
 void free_system_notify(void);
 
-static inline struct notify_data *notify_data_get(void)
+static inline struct notify_queue *notify_queue_get(void)
 {
-	return sof_get()->notify_data;
+	return sof_get()->notify_queue;
 }
 
 #endif /* __SOF_LIB_NOTIFIER_H__ */
@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_LIB_OVERLAY_H__
+#define __SOF_LIB_OVERLAY_H__
+
+#include <sof/compiler_attributes.h>
+#include <user/manifest.h>
+#include <config.h>
+#include <stddef.h>
+
+#if CONFIG_COMP_OVERLAYS
+
+/* code of overlay name, may only run while the overlay is mapped */
+#define __overlay_text(name) __section(SOF_MAN_OVERLAY_PREFIX #name)
+
+#define OVERLAY(name) (&overlay_##name)
+
+/* overlays of the firmware, linked by the platform linker script */
+extern struct sof_man_overlay overlay_asrc;
+extern struct sof_man_overlay overlay_kwd;	/* KPB and keyword detector */
+extern struct sof_man_overlay overlay_tone;
+
+void overlay_init(void);
+
+/**
+ * \brief Pages overlay code from IMR into the shared SRAM overlay region.
+ * \param[in] overlay Overlay descriptor.
+ * \return 0 on success, -EBUSY while another overlay is in use.
+ */
+int overlay_map(struct sof_man_overlay *overlay);
+
+/* drops user of mapped overlay, region is reused once it has none */
+void overlay_unmap(struct sof_man_overlay *overlay);
+
+#else
+
+#define __overlay_text(name)
+#define OVERLAY(name) NULL
+
+static inline void overlay_init(void) { }
+
+static inline int overlay_map(struct sof_man_overlay *overlay)
+{
+	return 0;
+}
+
+static inline void overlay_unmap(struct sof_man_overlay *overlay) { }
+
+#endif /* CONFIG_COMP_OVERLAYS */
+
+#endif /* __SOF_LIB_OVERLAY_H__ */
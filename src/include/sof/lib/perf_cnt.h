@@ -15,6 +15,13 @@
 #define __SOF_LIB_PERF_CNT_H__
 
 #include <sof/drivers/timer.h>
+#include <sof/lib/pmu.h>
+#include <config.h>
+#include <stdint.h>
+
+/** \brief Number of stamps averaged in one window, power of 2. */
+#define PERF_CNT_WINDOW_SHIFT	6
+#define PERF_CNT_WINDOW		(1 << PERF_CNT_WINDOW_SHIFT)
 
 struct perf_cnt_data {
 	uint64_t plat_ts;
@@ -23,8 +30,53 @@ struct perf_cnt_data {
 	uint64_t plat_delta_peak;
 	uint64_t cpu_delta_last;
 	uint64_t cpu_delta_peak;
+	uint64_t cpu_delta_sum;		/**< sum over current window */
+	uint64_t cpu_delta_avg;		/**< average of last complete window */
+	uint32_t window_count;		/**< stamps in current window */
+#if CONFIG_PERFORMANCE_COUNTERS_PMU
+	uint32_t pmu_ts[PMU_EVENTS];		/**< PMU counters at last stamp */
+	uint32_t pmu_delta_last[PMU_EVENTS];
+	uint64_t pmu_delta_sum[PMU_EVENTS];	/**< sum over current window */
+	uint32_t pmu_delta_avg[PMU_EVENTS];	/**< average of last window */
+#endif
 };
 
+#if CONFIG_PERFORMANCE_COUNTERS_PMU
+/** \brief Initializes PMU counter readings. */
+#define perf_cnt_pmu_init(pcd) pmu_read((pcd)->pmu_ts)
+
+/** \brief Takes deltas of PMU counters since the last stamp. */
+static inline void perf_cnt_pmu_stamp(struct perf_cnt_data *pcd)
+{
+	uint32_t pmu_ts[PMU_EVENTS];
+	int i;
+
+	pmu_read(pmu_ts);
+
+	for (i = 0; i < PMU_EVENTS; i++) {
+		pcd->pmu_delta_last[i] = pmu_ts[i] - pcd->pmu_ts[i];
+		pcd->pmu_delta_sum[i] += pcd->pmu_delta_last[i];
+		pcd->pmu_ts[i] = pmu_ts[i];
+	}
+}
+
+/** \brief Completes PMU averages of the window. */
+static inline void perf_cnt_pmu_average(struct perf_cnt_data *pcd)
+{
+	int i;
+
+	for (i = 0; i < PMU_EVENTS; i++) {
+		pcd->pmu_delta_avg[i] = pcd->pmu_delta_sum[i] >>
+			PERF_CNT_WINDOW_SHIFT;
+		pcd->pmu_delta_sum[i] = 0;
+	}
+}
+#else
+#define perf_cnt_pmu_init(pcd)
+#define perf_cnt_pmu_stamp(pcd)
+#define perf_cnt_pmu_average(pcd)
+#endif
+
 #if CONFIG_PERFORMANCE_COUNTERS
 
 #define perf_cnt_trace(tclass, pcd) \
@@ -41,6 +93,7 @@ struct perf_cnt_data {
 #define perf_cnt_init(pcd) do {						\
 		(pcd)->plat_ts = platform_timer_get(timer_get());	\
 		(pcd)->cpu_ts = arch_timer_get_system(cpu_timer_get());	\
+		perf_cnt_pmu_init(pcd);					\
 	} while (0)
 
 /* Trace macros that can be used as trace_m argument of the perf_cnt_stamp()
@@ -59,8 +112,27 @@ struct perf_cnt_data {
  */
 #define perf_trace_simple(pcd, arg) perf_cnt_trace(arg, pcd)
 
+/** \brief Accumulates last arch delta into the windowed average. */
+#define perf_cnt_average(pcd) do {					\
+		(pcd)->cpu_delta_sum += (pcd)->cpu_delta_last;		\
+		if (++(pcd)->window_count == PERF_CNT_WINDOW) {		\
+			(pcd)->cpu_delta_avg = (pcd)->cpu_delta_sum >>	\
+				PERF_CNT_WINDOW_SHIFT;			\
+			(pcd)->cpu_delta_sum = 0;			\
+			(pcd)->window_count = 0;			\
+			perf_cnt_pmu_average(pcd);			\
+		}							\
+	} while (0)
+
+/** \brief Returns cycles as per mille of the cycles budget. */
+static inline uint32_t perf_cnt_load(uint64_t cycles, uint64_t budget)
+{
+	return budget ? cycles * 1000 / budget : 0;
+}
+
 /** \brief Reads the timers and computes delta to the previous readings.
  *
+ *  Arch deltas are also averaged over windows of PERF_CNT_WINDOW stamps.
  *  If current arch delta exceeds the previous peak value, trace_m is run.
  *  \param pcd Performance counters data.
  *  \param trace_m Trace macro trace_m(pcd, arg).
@@ -72,6 +144,8 @@ struct perf_cnt_data {
 		if ((pcd)->plat_ts) {					  \
 			(pcd)->plat_delta_last = plat_ts - (pcd)->plat_ts;\
 			(pcd)->cpu_delta_last = cpu_ts - (pcd)->cpu_ts;   \
+			perf_cnt_pmu_stamp(pcd);			  \
+			perf_cnt_average(pcd);				  \
 		}							  \
 		(pcd)->plat_ts = plat_ts;				  \
 		(pcd)->cpu_ts = cpu_ts;					  \
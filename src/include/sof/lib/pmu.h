@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/lib/pmu.h
+ * \brief Performance monitor unit header file
+ */
+
+#ifndef __SOF_LIB_PMU_H__
+#define __SOF_LIB_PMU_H__
+
+/** \brief Events counted by the performance monitor, counter n counts
+ *         event n, events without a counter read as zero.
+ */
+enum pmu_event {
+	PMU_EVENT_STALL_DATA = 0,	/**< cycles stalled on data memory */
+	PMU_EVENT_STALL_INSTR,		/**< cycles stalled on instruction fetch */
+	PMU_EVENT_DCACHE_MISS,		/**< data cache misses */
+	PMU_EVENT_ICACHE_MISS,		/**< instruction cache misses */
+	PMU_EVENTS,
+};
+
+#include <arch/lib/pmu.h>
+#include <stdint.h>
+
+/**
+ * \brief Reads counters of all events of the current core.
+ * \param[out] values Counter values, one per event.
+ */
+static inline void pmu_read(uint32_t *values)
+{
+	int i;
+
+	for (i = 0; i < PMU_EVENTS; i++)
+		values[i] = i < ARCH_PMU_COUNTERS ? arch_pmu_read(i) : 0;
+}
+
+#endif /* __SOF_LIB_PMU_H__ */
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/sof/lib/scratch.h
+ * \brief Per-core scratch arena for temporary workspace of components
+ *
+ * Components on a core share one scratch arena for workspace that doesn't
+ * have to persist between periods. A component declares the most it needs
+ * with scratch_reserve() in prepare() and takes workspace with
+ * scratch_alloc() in copy(). Everything taken during a copy is released
+ * when it returns, so the arena only has to fit the largest declaration
+ * instead of the sum of all of them.
+ */
+
+#ifndef __SOF_LIB_SCRATCH_H__
+#define __SOF_LIB_SCRATCH_H__
+
+#include <stddef.h>
+
+/**
+ * Makes sure scratch arena of the current core has at least size bytes.
+ * @param size Most bytes taken with scratch_alloc() in a single copy.
+ * @return 0 if succeeded, error code otherwise.
+ */
+int scratch_reserve(size_t size);
+
+/**
+ * Drops a declaration of scratch_reserve(), the arena of the current core
+ * is freed with the last one.
+ */
+void scratch_release(void);
+
+/**
+ * Takes workspace from scratch arena of the current core, valid until
+ * the copy() it's taken in returns.
+ * @param size Size in bytes.
+ * @return Pointer to workspace or NULL if the arena is exhausted.
+ */
+void *scratch_alloc(size_t size);
+
+/**
+ * Returns current position of scratch arena of the current core.
+ * @return Position to be passed to scratch_restore().
+ */
+size_t scratch_mark(void);
+
+/**
+ * Releases workspace taken since scratch_mark().
+ * @param mark Position returned by scratch_mark().
+ */
+void scratch_restore(size_t mark);
+
+#endif /* __SOF_LIB_SCRATCH_H__ */
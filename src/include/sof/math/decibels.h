@@ -19,4 +19,9 @@
 int32_t exp_fixed(int32_t x); /* Input is Q5.27, output is Q12.20 */
 int32_t db2lin_fixed(int32_t x); /* Input is Q8.24, output is Q12.20 */
 
+/* Fills lin with n linear values of a ramp starting at db and changing by
+ * db_step per sample, input is Q8.24 and output is Q12.20.
+ */
+void db2lin_fixed_block(int32_t db, int32_t db_step, int32_t *lin, int n);
+
 #endif /* __SOF_MATH_DECIBELS_H__ */
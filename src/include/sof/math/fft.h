@@ -0,0 +1,47 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_MATH_FFT_H__
+#define __SOF_MATH_FFT_H__
+
+#include <stdint.h>
+
+/* log2 of the largest real transform size */
+#define FFT_MAX_BITS	12
+
+/* complex Q1.31 value */
+struct icomplex32 {
+	int32_t real;
+	int32_t imag;
+};
+
+/* Real input transform of 2^bits points. The caller provides the twiddle
+ * factors set by fft_plan_init() and a work buffer, both of 2^bits / 2
+ * entries, so that the transforms don't allocate.
+ */
+struct fft_plan {
+	int bits;
+	struct icomplex32 *twiddle;
+	struct icomplex32 *work;
+};
+
+/* Sets up plan for 2^bits points, returns -EINVAL for an unsupported size */
+int fft_plan_init(struct fft_plan *plan, int bits,
+		  struct icomplex32 *twiddle, struct icomplex32 *work);
+
+/* Forward transform of Q1.31 x to the 2^bits / 2 + 1 non-negative
+ * frequency bins of y, scaled by 2^-bits so that it can't overflow.
+ */
+void fft_real(const struct fft_plan *plan, const int32_t *x,
+	      struct icomplex32 *y);
+
+/* Inverse transform of the 2^bits / 2 + 1 bins of x of a real signal to
+ * the 2^bits samples of y. Stages are scaled only as much as the data
+ * needs, so the inverse transform is y[n] * 2^e where e is returned.
+ */
+int fft_real_inverse(const struct fft_plan *plan, const struct icomplex32 *x,
+		     int32_t *y);
+
+#endif /* __SOF_MATH_FFT_H__ */
@@ -71,6 +71,7 @@ int32_t find_max_abs_int32(int32_t vec[], int vec_length);
  */
 int norm_int32(int32_t val);
 
+/* CRC-32 of data, continues checksum of previous parts passed as base */
 uint32_t crc32(uint32_t base, const void *data, uint32_t bytes);
 
 /* merges two 16-bit values into a single 32-bit value */
@@ -10,6 +10,7 @@
 #ifndef __SOF_MATH_TRIG_H__
 #define __SOF_MATH_TRIG_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define PI_DIV2_Q4_28 421657428
@@ -18,4 +19,34 @@
 
 int32_t sin_fixed(int32_t w); /* Input is Q4.28, output is Q1.31 */
 
+/* Fills y with n samples of sine starting at phase w and advancing by
+ * w_step, phases are Q4.28 within 0 .. 2pi and output is Q1.31. Returns
+ * phase of the next sample.
+ */
+int32_t sin_fixed_block(int32_t w, int32_t w_step, int32_t *y, int n);
+
+/* Recursive sine oscillator (coupled form "magic circle"). Even and odd
+ * samples come from two oscillators stepping by 2 * w_step, so that the
+ * two multiplications per sample of each don't wait for the other. y is
+ * sin(w) and x is cos(w - w_step) of their next samples in Q2.30, e is
+ * 2 * sin(w_step) in Q2.30. Rounding errors accumulate slowly, so the
+ * state should be set again from the phase now and then.
+ */
+struct sin_osc {
+	int32_t x[2];
+	int32_t y[2];
+	int32_t e;
+};
+
+/* Sets oscillator to phase w advancing by w_step, Q4.28 within 0 .. 2pi
+ * and 0 .. pi / 2.
+ */
+void sin_osc_init(struct sin_osc *osc, int32_t w, int32_t w_step);
+
+/* Writes n samples of a * sine every stride samples of y, a and output
+ * are Q1.31. With add set the samples are added to y with saturation.
+ */
+void sin_osc_block(struct sin_osc *osc, int32_t a, int32_t *y, int stride,
+		   int n, bool add);
+
 #endif /* __SOF_MATH_TRIG_H__ */
@@ -72,6 +72,15 @@ int probe_point_add(uint32_t count, struct probe_point *probe);
  */
 int probe_point_info(struct sof_ipc_probe_info_params *data, uint32_t max_size);
 
+/*
+ * \brief Get statistics of connected probe points
+ *
+ * param[in,out] data - reply to write data to
+ * param[in] max_size - maximum number of bytes available in data
+ */
+int probe_point_stats(struct sof_ipc_probe_info_params *data,
+		      uint32_t max_size);
+
 /*
  * \brief Remove probe points
  *
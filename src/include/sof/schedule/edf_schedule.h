@@ -8,11 +8,16 @@
 #ifndef __SOF_SCHEDULE_EDF_SCHEDULE_H__
 #define __SOF_SCHEDULE_EDF_SCHEDULE_H__
 
+#include <sof/bit.h>
+#include <sof/list.h>
 #include <sof/schedule/task.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+struct sof_ipc_dbg_stack_info;
+
 /* schedule tracing */
 #define trace_edf_sch(format, ...) \
 	trace_event(TRACE_CLASS_EDF, format, ##__VA_ARGS__)
@@ -28,8 +33,28 @@
 
 #define edf_sch_get_pdata(task) task->priv_data
 
+#define edf_sch_get_deadline(task) \
+	(((struct edf_task_pdata *)edf_sch_get_pdata(task))->deadline)
+
+/* Task flag, task may be run by any enabled core with spare time. It runs
+ * to completion in the context of an EDF task of that core, so it can't
+ * rely on data cached by its own core and has to keep the task and its
+ * data in shared memory. Ignored without CONFIG_SCHEDULE_EDF_STEAL.
+ */
+#define SOF_EDF_TASK_MIGRATABLE	BIT(0)
+
+/* Task flag, task runs to completion in a context shared by all inline
+ * tasks of the core instead of a context of its own, saving the stack and
+ * the context switch between them. Inline tasks don't preempt each other.
+ */
+#define SOF_EDF_TASK_INLINE	BIT(1)
+
 struct edf_task_pdata {
 	void *ctx;
+	struct task *task;
+	struct list_item ctx_list;	/* in list of tasks with contexts */
+	uint64_t deadline;	/* deadline sampled when task was queued */
+	bool requeue;		/* scheduled again while running */
 };
 
 int scheduler_init_edf(void);
@@ -38,4 +63,25 @@ int schedule_task_init_edf(struct task *task, uint32_t uid,
 			   const struct task_ops *ops,
 			   void *data, uint16_t core, uint32_t flags);
 
+uint32_t schedule_edf_num_tasks(void);
+
+/**
+ * \brief Retrieves stack usage of EDF tasks of this core.
+ * \param[out] info Reply filled with stacks fitting in max_size.
+ * \param[in] max_size Size of the reply buffer.
+ * \return 0 if succeeded, error code otherwise.
+ */
+int schedule_edf_stack_info_get(struct sof_ipc_dbg_stack_info *info,
+				uint32_t max_size);
+
+#if CONFIG_SCHEDULE_EDF_STEAL
+/**
+ * \brief Lets this core run migratable tasks of all cores, called when
+ * other core queues one.
+ */
+void schedule_edf_steal(void);
+#else
+static inline void schedule_edf_steal(void) { }
+#endif
+
 #endif /* __SOF_SCHEDULE_EDF_SCHEDULE_H__ */
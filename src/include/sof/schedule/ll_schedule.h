@@ -16,9 +16,12 @@
 #include <sof/schedule/task.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 struct ll_schedule_domain;
+struct ll_task_stats;
+struct sof_ipc_dbg_ll_stats;
 
 /* ll tracing */
 #define trace_ll(format, ...) \
@@ -37,6 +40,7 @@ struct ll_schedule_domain;
 
 struct ll_task_pdata {
 	uint64_t period;
+	struct ll_task_stats *stats;	/* NULL if no statistics slot */
 };
 
 int scheduler_init_ll(struct ll_schedule_domain *domain);
@@ -46,4 +50,10 @@ int schedule_task_init_ll(struct task *task,
 			  enum task_state (*run)(void *data), void *data,
 			  uint16_t core, uint32_t flags);
 
+uint32_t schedule_ll_num_tasks(uint16_t type);
+
+int schedule_ll_stats_get(struct sof_ipc_dbg_ll_stats *info,
+			  uint32_t max_size, uint32_t type, int core,
+			  bool reset);
+
 #endif /* __SOF_SCHEDULE_LL_SCHEDULE_H__ */
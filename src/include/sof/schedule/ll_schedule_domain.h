@@ -14,6 +14,7 @@
 #include <sof/lib/cpu.h>
 #include <sof/lib/clk.h>
 #include <sof/lib/memory.h>
+#include <sof/schedule/schedule.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
@@ -50,8 +51,10 @@ struct ll_schedule_domain {
 	int type;			/**< domain type */
 	int clk;			/**< source clock */
 	bool synchronous;		/**< are tasks should be synchronous */
+	uint64_t due_margin;		/**< ticks a task may run early */
 	void *priv_data;		/**< pointer to private data */
 	bool registered[PLATFORM_CORE_COUNT];		/**< registered cores */
+	uint64_t next_due[PLATFORM_CORE_COUNT];	/**< earliest task start */
 	const struct ll_schedule_domain_ops *ops;	/**< domain ops */
 };
 
@@ -84,6 +87,8 @@ static inline struct ll_schedule_domain *domain_init
 	domain->ops = ops;
 
 	spinlock_init(&domain->lock);
+	spinlock_name(&domain->lock, type == SOF_SCHEDULE_LL_TIMER ?
+		      "ll timer" : "ll dma");
 	atomic_init(&domain->total_num_tasks, 0);
 	atomic_init(&domain->num_clients, 0);
 
@@ -149,6 +154,24 @@ static inline void domain_clear(struct ll_schedule_domain *domain)
 	platform_shared_commit(domain, sizeof(*domain));
 }
 
+/**
+ * \brief Returns earliest start of tasks on all registered cores.
+ * \param[in] domain Pointer to schedule domain.
+ * \return Earliest start, UINT64_MAX if there are no tasks.
+ */
+static inline uint64_t domain_next_due(struct ll_schedule_domain *domain)
+{
+	uint64_t next = UINT64_MAX;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (domain->registered[i] && domain->next_due[i] < next)
+			next = domain->next_due[i];
+	}
+
+	return next;
+}
+
 static inline bool domain_is_pending(struct ll_schedule_domain *domain,
 				     struct task *task)
 {
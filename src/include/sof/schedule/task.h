@@ -53,6 +53,7 @@ struct task {
 	uint32_t uid;		/**< Uuid */
 	uint16_t type;		/**< type of the task (LL or EDF) */
 	uint16_t priority;	/**< priority of the task (used by LL) */
+	uint16_t order;		/**< order within priority (used by LL) */
 	uint16_t core;		/**< execution core */
 	uint16_t flags;		/**< custom flags */
 	enum task_state state;	/**< current state */
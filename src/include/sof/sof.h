@@ -22,7 +22,7 @@ struct ipc;
 struct ll_schedule_domain;
 struct mm;
 struct mn;
-struct notify_data;
+struct notify_queue;
 struct pm_runtime_data;
 struct sa;
 struct timer;
@@ -75,8 +75,8 @@ struct sof {
 	/* runtime power management data */
 	struct pm_runtime_data *prd;
 
-	/* shared notifier data */
-	struct notify_data *notify_data;
+	/* shared notifier queues of remote events */
+	struct notify_queue *notify_queue;
 
 	/* platform dai information */
 	const struct dai_info *dai_info;
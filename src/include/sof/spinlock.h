@@ -16,8 +16,11 @@
 #include <arch/spinlock.h>
 #include <sof/lib/memory.h>
 #include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+struct sof_ipc_dbg_lock_stats;
+
 /*
  * Lock debugging provides a simple interface to debug deadlocks. The rmbox
  * trace output will show an output :-
@@ -144,6 +147,37 @@ extern uint32_t lock_dbg_user[DBG_LOCK_USERS];
 
 #endif
 
+#if CONFIG_DEBUG_LOCK_STATS
+
+/* takes named lock, counting the spin */
+void _spin_lock_stats(spinlock_t *lock);
+
+/* counts hold time of named lock before it's released */
+void _spin_unlock_stats(spinlock_t *lock);
+
+/**
+ * \brief Names initialized lock, so its statistics are recorded.
+ * \param[in,out] lock Lock, counted with other locks of the same name.
+ * \param[in] name Name shorter than SOF_IPC_LOCK_NAME_SIZE.
+ */
+void spinlock_name(spinlock_t *lock, const char *name);
+
+/**
+ * \brief Retrieves statistics of named locks.
+ * \param[out] info Reply filled with names fitting in max_size.
+ * \param[in] max_size Size of the reply buffer.
+ * \param[in] reset Clears the statistics once read.
+ * \return 0 if succeeded, error code otherwise.
+ */
+int spinlock_stats_get(struct sof_ipc_dbg_lock_stats *info,
+		       uint32_t max_size, bool reset);
+
+#else
+
+static inline void spinlock_name(spinlock_t *lock, const char *name) { }
+
+#endif
+
 static inline int _spin_try_lock(spinlock_t *lock, int line)
 {
 	spin_lock_dbg(line);
@@ -159,6 +193,9 @@ static inline void _spinlock_init(spinlock_t *lock, int line)
 #if CONFIG_DEBUG_LOCKS
 	lock->user = line;
 #endif
+#if CONFIG_DEBUG_LOCK_STATS
+	lock->stats = NULL;
+#endif
 }
 
 #define spinlock_init(lock) _spinlock_init(lock, __LINE__)
@@ -170,6 +207,11 @@ static inline void _spin_lock(spinlock_t *lock, int line)
 #if CONFIG_DEBUG_LOCKS
 	spin_lock_log(lock, line);
 	spin_try_lock_dbg(lock, line);
+#elif CONFIG_DEBUG_LOCK_STATS
+	if (lock->stats)
+		_spin_lock_stats(lock);
+	else
+		arch_spin_lock(lock);
 #else
 	arch_spin_lock(lock);
 #endif
@@ -187,6 +229,10 @@ uint32_t _spin_lock_irq(spinlock_t *lock);
 
 static inline void _spin_unlock(spinlock_t *lock, int line)
 {
+#if CONFIG_DEBUG_LOCK_STATS
+	if (lock->stats)
+		_spin_unlock_stats(lock);
+#endif
 	arch_spin_unlock(lock);
 #if CONFIG_DEBUG_LOCKS
 	spin_unlock_dbg(line);
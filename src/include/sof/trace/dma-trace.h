@@ -8,11 +8,15 @@
 #ifndef __SOF_TRACE_DMA_TRACE_H__
 #define __SOF_TRACE_DMA_TRACE_H__
 
+#include <sof/atomic.h>
 #include <sof/lib/dma.h>
+#include <sof/platform.h>
 #include <sof/schedule/task.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
+#include <sof/trace/trace.h>
 #include <ipc/trace.h>
+#include <user/trace.h>
 #include <stdint.h>
 
 struct ipc_msg;
@@ -27,6 +31,35 @@ struct dma_trace_buf {
 	uint32_t avail;		/* avail bytes in buffer */
 };
 
+/* number of records in trace ring of each core, must be a power of 2 */
+#define DTRACE_RING_RECORDS	64
+
+/* ring fill level in records scheduling an early trace work run */
+#define DTRACE_RING_WATERMARK	(DTRACE_RING_RECORDS / 2)
+
+/* record payload in words, fits header and all trace arguments */
+#define DTRACE_RECORD_WORDS \
+	(sizeof(struct log_entry_header) / sizeof(uint32_t) + \
+	 _TRACE_EVENT_MAX_ARGUMENT_COUNT)
+
+struct dtrace_record {
+	uint32_t length;			/* entry size in bytes */
+	uint32_t data[DTRACE_RECORD_WORDS];	/* trace entry */
+};
+
+/* trace ring with a single writer core, drained by the trace work */
+struct dtrace_ring {
+	atomic_t w_idx;			/* free running write index */
+	atomic_t r_idx;			/* free running read index */
+	uint32_t dropped_entries;	/* entries lost on full ring */
+	uint32_t dropped_drained;	/* lost entries already reported */
+#if CONFIG_TRACE_COMPACT
+	uint64_t last_stamp;		/* timestamp of last drained record */
+	uint32_t sync_count;		/* records until absolute timestamp */
+#endif
+	struct dtrace_record records[DTRACE_RING_RECORDS];
+};
+
 struct dma_trace_data {
 	struct dma_sg_config config;
 	struct dma_trace_buf dmatb;
@@ -43,6 +76,7 @@ struct dma_trace_data {
 				   *  copied by dma connected to host
 				   */
 	uint32_t dropped_entries; /* amount of dropped entries */
+	struct dtrace_ring *ring[PLATFORM_CORE_COUNT]; /* per core rings */
 	spinlock_t lock; /* dma trace lock */
 };
 
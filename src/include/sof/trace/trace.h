@@ -18,16 +18,22 @@
 #if !CONFIG_LIBRARY && CONFIG_TRACE
 #include <platform/trace/trace.h>
 #endif
+#if CONFIG_BOOT_PROFILE
+#include <sof/debug/boot_profile.h>
+#endif
 #include <sof/common.h>
 #include <sof/sof.h>
 #include <sof/trace/preproc.h>
+#include <user/trace.h>
 #include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 #if CONFIG_LIBRARY
 #include <stdio.h>
 #endif
 
 struct sof;
+struct sof_ipc_trace_filter_elem;
 struct trace;
 
 /* bootloader trace values */
@@ -53,6 +59,8 @@ struct trace;
 #define TRACE_BOOT_SYS_TRACES		(TRACE_BOOT_SYS + 0x200)
 #define TRACE_BOOT_SYS_NOTIFIER		(TRACE_BOOT_SYS + 0x300)
 #define TRACE_BOOT_SYS_POWER		(TRACE_BOOT_SYS + 0x400)
+#define TRACE_BOOT_SYS_COMP		(TRACE_BOOT_SYS + 0x500)
+#define TRACE_BOOT_SYS_READY		(TRACE_BOOT_SYS + 0x600)
 
 /* platform/device specific codes */
 #define TRACE_BOOT_PLATFORM_ENTRY	(TRACE_BOOT_PLATFORM + 0x100)
@@ -174,6 +182,9 @@ void trace_on(void);
 void trace_off(void);
 void trace_init(struct sof *sof);
 
+bool trace_filter_pass(uint32_t lvl, uint32_t comp_class, uint32_t comp_id);
+int trace_filter_update(const struct sof_ipc_trace_filter_elem *elem);
+
 static inline struct trace *trace_get(void)
 {
 	return sof_get()->trace;
@@ -252,7 +263,14 @@ static inline struct trace *trace_get(void)
 	_log_message(__mbox, _atomic, lvl, class, id_0, id_1,		       \
 		     id_2, format, ##__VA_ARGS__)
 
+#if CONFIG_BOOT_PROFILE
+#define trace_point(x) do {			\
+		platform_trace_point(x);	\
+		boot_profile_point(x);		\
+	} while (0)
+#else
 #define trace_point(x) platform_trace_point(x)
+#endif
 
 #ifndef CONFIG_LIBRARY
 
@@ -294,12 +312,16 @@ _thrown_from_macro_BASE_LOG_in_trace_h
 			((uint32_t)entry, id_0, id_1, id_2, ##__VA_ARGS__); \
 }
 
+/* runtime filter is checked before the entry is built, errors always pass */
 #define __log_message(func_name, lvl, comp_class, id_0, id_1, id_2,	    \
 		      format, ...)					    \
 do {									    \
 	_DECLARE_LOG_ENTRY(lvl, format, comp_class,			    \
 			   PP_NARG(__VA_ARGS__));			    \
-	BASE_LOG(func_name, id_0, id_1, id_2, &log_entry, ##__VA_ARGS__)    \
+	if (lvl == LOG_LEVEL_CRITICAL ||				    \
+	    trace_filter_pass(lvl, comp_class, id_2))			    \
+		BASE_LOG(func_name, id_0, id_1, id_2, &log_entry,	    \
+			 ##__VA_ARGS__)					    \
 } while (0)
 
 #define _log_message(mbox, atomic, level, comp_class, id_0, id_1, id_2,	    \
@@ -349,7 +371,11 @@ do {									    \
 #define trace_warn_atomic_with_ids(class, id_0, id_1, id_2, format, ...) \
 	trace_unused(class, id_0, id_1, id_2, format, ##__VA_ARGS__)
 
+#if CONFIG_BOOT_PROFILE
+#define trace_point(x)  boot_profile_point(x)
+#else
 #define trace_point(x)  do {} while (0)
+#endif
 
 #endif
 
@@ -412,6 +438,21 @@ do {									    \
 	trace_unused(class, id_0, id_1, id_2, format, ##__VA_ARGS__)
 #endif
 
+/* timeline tracing, spans are nested per core */
+#if CONFIG_TRACE_TIMELINE
+#define trace_timeline_begin(class, id_0, id_1, id_2, name, ...)	\
+	_trace_event_with_ids(LOG_LEVEL_INFO, class, id_0, id_1, id_2,	\
+			      TRACE_TIMELINE_BEGIN name, ##__VA_ARGS__)
+#define trace_timeline_end(class, id_0, id_1, id_2, name, ...)		\
+	_trace_event_with_ids(LOG_LEVEL_INFO, class, id_0, id_1, id_2,	\
+			      TRACE_TIMELINE_END name, ##__VA_ARGS__)
+#else
+#define trace_timeline_begin(class, id_0, id_1, id_2, name, ...) \
+	trace_unused(class, id_0, id_1, id_2, name, ##__VA_ARGS__)
+#define trace_timeline_end(class, id_0, id_1, id_2, name, ...) \
+	trace_unused(class, id_0, id_1, id_2, name, ##__VA_ARGS__)
+#endif
+
 /* tracing from device (component, pipeline, dai, ...) */
 
 /** \brief Trace from a device on err level.
@@ -443,4 +484,16 @@ do {									    \
 	tracev_event_with_ids(class, get_uid_m(dev), get_id_m(dev),	      \
 			      get_subid_m(dev), fmt, ##__VA_ARGS__)
 
+/** \brief Begin of a timeline span of a device. */
+#define trace_dev_timeline_begin(class, get_uid_m, get_id_m, get_subid_m,  \
+				 dev, name, ...)			   \
+	trace_timeline_begin(class, get_uid_m(dev), get_id_m(dev),	   \
+			     get_subid_m(dev), name, ##__VA_ARGS__)
+
+/** \brief End of a timeline span of a device. */
+#define trace_dev_timeline_end(class, get_uid_m, get_id_m, get_subid_m,	   \
+			       dev, name, ...)				   \
+	trace_timeline_end(class, get_uid_m(dev), get_id_m(dev),	   \
+			   get_subid_m(dev), name, ##__VA_ARGS__)
+
 #endif /* __SOF_TRACE_TRACE_H__ */
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __USER_DECODER_H__
+#define __USER_DECODER_H__
+
+#include <stdint.h>
+
+/** codecs of compressed streams */
+#define SOF_DECODER_CODEC_MP3	1
+#define SOF_DECODER_CODEC_AAC	2
+
+/**
+ * Configuration of the decoder component, the data of its
+ * sof_ipc_comp_process. The source is a compressed stream from the host,
+ * the sink gets PCM in the format given here.
+ */
+struct sof_decoder_config {
+	uint32_t size;		/**< size of this struct */
+	uint32_t codec;		/**< SOF_DECODER_CODEC_ */
+	uint32_t frame_fmt;	/**< decoded sof_ipc_frame */
+	uint32_t rate;		/**< decoded frames per second */
+	uint32_t channels;	/**< decoded channels */
+
+	/** PCM decoded per run of the decoding task in ms, 0 for default */
+	uint32_t block_ms;
+
+	/** reserved for future use */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+#endif /* __USER_DECODER_H__ */
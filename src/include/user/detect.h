@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __USER_DETECT_H__
+#define __USER_DETECT_H__
+
+#include <stdint.h>
+
+/** maximum number of detector models run by one detect component */
+#define SOF_DETECT_MAX_MODELS	4
+
+/** detector model types */
+#define SOF_DETECT_MODEL_ENERGY	0	/**< smoothed frame energy threshold */
+#define SOF_DETECT_MODEL_VAD	1	/**< energy above tracked noise floor */
+
+/** KPB client id value for models which don't request draining */
+#define SOF_DETECT_NO_KPB_CLIENT	0xffffffff
+
+struct sof_detect_model_config {
+	uint32_t type;		/**< SOF_DETECT_MODEL_ */
+	uint32_t kpb_client;	/**< KPB client drained on detection */
+
+	/** detection threshold, log2 of energy in Q8.24 */
+	int32_t threshold;
+
+	/** energy model: frames before detection is activated
+	 *  vad: frames above threshold needed for detection
+	 */
+	uint32_t frames;
+
+	/** activation right shift of energy model, 0 for default */
+	uint32_t shift;
+
+	/** draining size in ms, 0 for KPB default */
+	uint32_t history_depth;
+
+	/** reserved for future use */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
+/**
+ * Configuration of the detect component. Features are computed once per
+ * analysis frame and shared by all models.
+ */
+struct sof_detect_config {
+	uint32_t size;		/**< size of this struct with models */
+	uint32_t num_models;	/**< number of models following */
+
+	/** reserved for future use */
+	uint32_t reserved[4];
+
+	struct sof_detect_model_config model[];
+} __attribute__((packed));
+
+#endif /* __USER_DETECT_H__ */
@@ -35,8 +35,10 @@ struct sof_detect_test_config {
 	/** default draining size in bytes */
 	uint32_t history_depth;
 
-	/** reserved for future use */
-	uint32_t reserved[1];
+	/** voice activity threshold, detection is skipped while the
+	 * input level stays below it, 0 disables gating
+	 */
+	int32_t vad_threshold;
 } __attribute__((packed));
 
 /** used for binary blob size sanity checks */
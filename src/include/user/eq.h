@@ -14,10 +14,15 @@
 
 #define SOF_EQ_FIR_IDX_SWITCH	0
 
-#define SOF_EQ_FIR_MAX_SIZE 4096 /* Max size allowed for coef data in bytes */
+#define SOF_EQ_FIR_MAX_SIZE 32768 /* Max size allowed for coef data in bytes */
 
 #define SOF_EQ_FIR_MAX_LENGTH 192 /* Max length for individual filter */
 
+/* Max length for a filter longer than 128 taps, that is applied in
+ * frequency domain with one block of 64 frames latency
+ */
+#define SOF_EQ_FIR_FFT_MAX_LENGTH 4096
+
 #define SOF_EQ_FIR_MAX_RESPONSES 8 /* A blob can define max 8 FIR EQs */
 
 /*
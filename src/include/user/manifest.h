@@ -50,7 +50,8 @@ union sof_man_segment_flags {
 		uint32_t readonly:1;
 		uint32_t code:1;
 		uint32_t data:1;
-		uint32_t _rsvd0:2;
+		uint32_t compressed:1;	/* LZ4, unpacked by boot loader */
+		uint32_t _rsvd0:1;
 		uint32_t type:4;	/* MAN_SEGMENT_ */
 		uint32_t _rsvd1:4;
 		uint32_t length:16;	/* of segment in pages */
@@ -218,6 +219,22 @@ struct sof_man_module_manifest {
 	uint32_t text_size;
 };
 
+/*
+ * Code overlay of the base firmware, filled in by rimage. Code of section
+ * SOF_MAN_OVERLAY_PREFIX followed by name is linked at vma in a shared
+ * SRAM region and stored at file_offset after the module segments, which
+ * stay in IMR. Not used by ROM.
+ */
+#define SOF_MAN_OVERLAY_PREFIX		".overlay."
+#define SOF_MAN_OVERLAY_NAME_LEN	12
+
+struct sof_man_overlay {
+	uint8_t name[SOF_MAN_OVERLAY_NAME_LEN];
+	uint32_t vma;
+	uint32_t size;		/* bytes */
+	uint32_t file_offset;
+} __attribute__((packed));
+
 /*
  * Module offset in manifest.
  */
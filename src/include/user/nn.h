@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __USER_NN_H__
+#define __USER_NN_H__
+
+#include <stdint.h>
+
+/** maximum size of a model blob */
+#define SOF_NN_MAX_SIZE		(256 * 1024)
+
+/** maximum number of layers of a model */
+#define SOF_NN_MAX_LAYERS	16
+
+/** maximum number of activation tables of a model */
+#define SOF_NN_MAX_LUTS		4
+
+/** entries of an activation table */
+#define SOF_NN_LUT_SIZE		256
+
+/** activation table index of layers without activation */
+#define SOF_NN_NO_LUT		0xffff
+
+/** layer types */
+#define SOF_NN_LAYER_DENSE	0	/**< fully connected, per time step */
+#define SOF_NN_LAYER_CONV1D	1	/**< 1-D convolution over time */
+#define SOF_NN_LAYER_GRU	2	/**< GRU, reset gate after matmul */
+#define SOF_NN_LAYER_LSTM	3	/**< LSTM without peepholes */
+#define SOF_NN_LAYER_ACT	4	/**< activation table only */
+
+/** what the component does with the model output */
+#define SOF_NN_OUTPUT_AUDIO	0	/**< output tensor is sink audio */
+#define SOF_NN_OUTPUT_SCORE	1	/**< audio passes, score is notified */
+
+/**
+ * Layer of a model. Tensors are int16 matrices of time steps by
+ * features, laid out time step after time step. Weights are int8 or
+ * int16 with their rows in output feature order, biases are int32 in
+ * the scale of the accumulator. The int32 accumulator is shifted right
+ * by shift, rounded and saturated to int16 before the activation.
+ *
+ * Parameters follow the layer in this order, each padded to 4 bytes:
+ * dense:  W[out_ch][in_ch], b[out_ch]
+ * conv1d: W[out_ch][kernel * in_ch], b[out_ch]
+ * gru:    W[3 * out_ch][in_ch], U[3 * out_ch][out_ch], b[3 * out_ch],
+ *	   bu[3 * out_ch] with gates in z, r, n order
+ * lstm:   W[4 * out_ch][in_ch], U[4 * out_ch][out_ch], b[4 * out_ch]
+ *	   with gates in i, f, g, o order
+ * act:    none
+ *
+ * Recurrent layers shift the W accumulator by shift and the U
+ * accumulator by rshift to Q4.11 gate inputs. Their lut is a sigmoid
+ * and lut2 a tanh table, both from Q4.11 to Q1.15. The state and the
+ * output are Q1.15, the LSTM cell is Q4.11. State is kept between
+ * inferences until the stream is restarted.
+ */
+struct sof_nn_layer {
+	uint32_t size;		/**< size of this struct with parameters */
+	uint16_t type;		/**< SOF_NN_LAYER_ */
+	uint16_t weight_bits;	/**< 8 or 16 */
+	uint16_t in_ch;		/**< input features */
+	uint16_t out_ch;	/**< output features or units */
+	uint16_t kernel;	/**< conv1d kernel time steps */
+	uint16_t stride;	/**< conv1d stride in time steps */
+	uint16_t shift;		/**< accumulator right shift */
+	uint16_t rshift;	/**< recurrent accumulator right shift */
+	uint16_t lut;		/**< activation table, SOF_NN_NO_LUT if none */
+	uint16_t lut2;		/**< second table of recurrent layers */
+
+	/** reserved for future use */
+	uint32_t reserved[2];
+
+	uint8_t data[];
+} __attribute__((packed));
+
+/**
+ * Model blob of the nn component. Activation tables of
+ * SOF_NN_LUT_SIZE int16 values follow the header, then the layers.
+ * A table maps int16 input x to entry (x >> 8) + 128 and interpolates
+ * linearly to the next entry.
+ */
+struct sof_nn_config {
+	uint32_t size;		/**< size of the whole blob */
+	uint32_t frames;	/**< frames consumed per inference */
+	uint32_t channel;	/**< source channel fed to the model */
+	uint32_t output;	/**< SOF_NN_OUTPUT_ */
+	uint32_t score_index;	/**< output element compared to threshold */
+	int32_t threshold;	/**< score notified from this value, Q1.15 */
+	uint16_t num_luts;	/**< activation tables */
+	uint16_t num_layers;	/**< layers */
+
+	/** reserved for future use */
+	uint32_t reserved[4];
+
+	uint8_t data[];
+} __attribute__((packed));
+
+#endif /* __USER_NN_H__ */
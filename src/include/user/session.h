@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file include/user/session.h
+ * \brief Session record format, written by the firmware and replayed by
+ * the testbench.
+ *
+ * A session is the byte stream of records read from the firmware with
+ * SOF_IPC_TRACE_SESSION, starting with a SOF_SESSION_START record. A
+ * session file holds it as read, records are in host byte order and
+ * their sizes are multiples of 4 bytes.
+ */
+
+#ifndef __USER_SESSION_H__
+#define __USER_SESSION_H__
+
+#include <stdint.h>
+
+/* record types */
+#define SOF_SESSION_START	0	/* recording started */
+#define SOF_SESSION_IPC		1	/* IPC command received */
+#define SOF_SESSION_STATS	2	/* statistics of an input signal */
+
+/* IPC messages are recorded up to this size, enough for stream params */
+#define SOF_SESSION_IPC_BYTES	128
+
+struct sof_session_rec {
+	uint16_t type;		/* SOF_SESSION_ */
+	uint16_t size;		/* bytes with this header */
+	uint32_t time_us;	/* since the start of the session */
+} __attribute__((packed));
+
+struct sof_session_start {
+	struct sof_session_rec rec;
+	uint32_t abi_version;	/* SOF_ABI_VERSION of the firmware */
+	uint32_t stats_ms;	/* window of the signal statistics */
+} __attribute__((packed));
+
+/* head of the message, its own header tells the full size */
+struct sof_session_ipc {
+	struct sof_session_rec rec;
+	uint8_t data[];		/* starts with struct sof_ipc_cmd_hdr */
+} __attribute__((packed));
+
+/*
+ * Signal a host or DAI component brought into the DSP over a window.
+ * Samples of all channels are taken in Q1.15.
+ */
+struct sof_session_stats {
+	struct sof_session_rec rec;
+	uint32_t comp_id;	/* host or DAI component */
+	uint32_t rate;
+	uint16_t channels;
+	uint16_t peak;		/* largest magnitude, Q1.15 */
+	uint32_t frames;
+	uint64_t sum_sq;	/* sum of squared samples, Q2.30 */
+} __attribute__((packed));
+
+#endif /* __USER_SESSION_H__ */
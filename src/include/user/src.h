@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __USER_SRC_H__
+#define __USER_SRC_H__
+
+#include <stdint.h>
+
+#define SOF_SRC_COEF_MAX_SIZE 16384 /* Max size allowed for a blob in bytes */
+
+#define SOF_SRC_COEF_STAGES 2 /* A blob always defines both stages */
+
+/*
+ * sof_src_coef_config data structure contains this information
+ *     uint32_t size
+ *         This is the number of bytes needed to store the received blob,
+ *         including this header.
+ *     uint32_t source_rate
+ *     uint32_t sink_rate
+ *         The conversion the coefficients are designed for.
+ *     uint16_t coef_bits
+ *         16 or 32, must match the coefficient type of the firmware build.
+ *     struct sof_src_stage_config stage[2]
+ *         Parameters of both stages in the same order and meaning as the
+ *         built-in tables. A one stage conversion sets stage 2 to
+ *         { 0, 0, 1, 1, 1, 1, 1, 0, -1 } with one coefficient of unity gain
+ *         (Q1.14 for 16 bit, Q1.30 for 32 bit coefficients).
+ *     int32_t data[]
+ *         Stage 1 coefficients followed by stage 2 coefficients, filter_length
+ *         of each. 16 bit coefficients of every stage are padded with zeros
+ *         to a multiple of 32 bit words.
+ */
+
+struct sof_src_stage_config {
+	int32_t idm;
+	int32_t odm;
+	int32_t num_of_subfilters;
+	int32_t subfilter_length;
+	int32_t filter_length;
+	int32_t blk_in;
+	int32_t blk_out;
+	int32_t halfband;
+	int32_t shift;
+
+	/* reserved */
+	uint32_t reserved;
+} __attribute__((packed));
+
+struct sof_src_coef_config {
+	uint32_t size;
+	uint32_t source_rate;
+	uint32_t sink_rate;
+	uint16_t coef_bits;
+	uint16_t reserved0;
+
+	/* reserved */
+	uint32_t reserved[4];
+
+	struct sof_src_stage_config stage[SOF_SRC_COEF_STAGES];
+
+	int32_t data[];
+} __attribute__((packed));
+
+#endif /* __USER_SRC_H__ */
@@ -16,5 +16,6 @@
 #define SOF_TONE_IDX_PERIOD		5
 #define SOF_TONE_IDX_REPEATS		6
 #define SOF_TONE_IDX_LIN_RAMP_STEP	7
+#define SOF_TONE_IDX_TONES		8
 
 #endif /* __USER_TONE_H__ */
@@ -95,6 +95,13 @@ struct log_buffer_status {
 
 #define TRACE_ID_LENGTH 12
 
+/*
+ * Text prefixes of timeline events, the begin and end of a span of execution
+ * on the reporting core.
+ */
+#define TRACE_TIMELINE_BEGIN	"timeline begin "
+#define TRACE_TIMELINE_END	"timeline end "
+
 /*
  *  Log entry header.
  *
@@ -111,4 +118,31 @@ struct log_entry_header {
 	uint32_t log_entry_address;	 /* Address of log entry in ELF */
 } __attribute__((packed));
 
+/*
+ * Compact log record, written to the DMA trace instead of the log entry
+ * header and its arguments with CONFIG_TRACE_COMPACT.
+ *
+ * A tag byte is followed by unsigned LEB128 varints: the timestamp, the log
+ * entry id, the uid id, id_0 and id_1 with TRACE_COMPACT_IDS, then the
+ * arguments. The timestamp is the delta to the previous record of the core,
+ * or the absolute value with TRACE_COMPACT_ABS. Entry and uid ids are word
+ * offsets in their ELF sections, the uid id is 0 without uid and the offset
+ * plus 1 otherwise. Records are padded with zero bytes to whole words.
+ */
+#define TRACE_COMPACT_MAGIC		0xa0
+#define TRACE_COMPACT_MAGIC_MASK	0xe0
+#define TRACE_COMPACT_ABS		(1 << 4)
+#define TRACE_COMPACT_IDS		(1 << 3)
+#define TRACE_COMPACT_CORE_MASK		0x7
+
+/* maximum varint size of 32 and 64 bit values */
+#define TRACE_COMPACT_VARINT32_MAX	5
+#define TRACE_COMPACT_VARINT64_MAX	10
+
+/* a core sends an absolute timestamp at least every this many records */
+#define TRACE_COMPACT_SYNC		32
+
+/* longer deltas are sent as absolute timestamps */
+#define TRACE_COMPACT_DELTA_MAX		(1 << 28)
+
 #endif /* __USER_TRACE_H__ */
@@ -16,6 +16,7 @@
 #include <sof/lib/memory.h>
 #include <sof/lib/mm_heap.h>
 #include <sof/lib/notifier.h>
+#include <sof/lib/overlay.h>
 #include <sof/lib/pm_runtime.h>
 #include <sof/platform.h>
 #include <sof/schedule/task.h>
@@ -31,7 +32,7 @@ struct sof *sof_get(void)
 	return &sof;
 }
 
-int master_core_init(int argc, char *argv[], struct sof *sof)
+int __cold_text master_core_init(int argc, char *argv[], struct sof *sof)
 {
 	int err;
 
@@ -63,6 +64,8 @@ int master_core_init(int argc, char *argv[], struct sof *sof)
 	trace_point(TRACE_BOOT_SYS_POWER);
 	pm_runtime_init(sof);
 
+	overlay_init();
+
 	/* init the platform */
 	err = platform_init(sof);
 	if (err < 0)
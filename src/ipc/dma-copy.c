@@ -5,6 +5,7 @@
 // Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
 //         Keyon Jie <yang.jie@linux.intel.com>
 
+#include <sof/audio/component.h>
 #include <sof/drivers/ipc.h>
 #include <sof/lib/dma.h>
 #include <sof/platform.h>
@@ -69,12 +70,45 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	return size;
 }
 
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size)
+{
+	int ret;
+
+	/* tell gateway to copy */
+	ret = dma_copy(dc->chan, size, 0);
+	if (ret < 0)
+		return ret;
+
+	/* bytes copied */
+	return size;
+}
+
+/* Gateway copies use the local buffer the channel was configured with,
+ * so copies of arbitrary DSP memory are not possible.
+ */
+int dma_copy_to_host(struct dma_copy *dc, struct dma_sg_config *host_sg,
+		     int32_t host_offset, void *local_ptr, int32_t size)
+{
+	return -ENOTSUP;
+}
+
+int dma_copy_from_host(struct dma_copy *dc, struct dma_sg_config *host_sg,
+		       int32_t host_offset, void *local_ptr, int32_t size)
+{
+	return -ENOTSUP;
+}
+
 #else
 
-int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
-			    int32_t host_offset, void *local_ptr, int32_t size)
+/* copies up to the end of the host page at host_offset, blocking */
+static int dma_copy_host_page(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size, uint32_t direction)
 {
-	struct dma_trace_data *dmat = dma_trace_data_get();
 	struct dma_sg_config config;
 	struct dma_sg_elem *host_sg_elem;
 	struct dma_sg_elem local_sg_elem;
@@ -90,16 +124,23 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 		return -EINVAL;
 
 	/* set up DMA configuration */
-	config.direction = DMA_DIR_LMEM_TO_HMEM;
+	config.direction = direction;
 	config.src_width = sizeof(uint32_t);
 	config.dest_width = sizeof(uint32_t);
 	config.cyclic = 0;
 	config.irq_disabled = false;
+	config.dmac_config = 0;
 	dma_sg_init(&config.elem_array);
 
 	/* configure local DMA elem */
-	local_sg_elem.dest = host_sg_elem->dest + offset;
-	local_sg_elem.src = (uint32_t)local_ptr;
+	if (direction == DMA_DIR_LMEM_TO_HMEM) {
+		local_sg_elem.dest = host_sg_elem->dest + offset;
+		local_sg_elem.src = (uint32_t)local_ptr;
+	} else {
+		local_sg_elem.dest = (uint32_t)local_ptr;
+		local_sg_elem.src = host_sg_elem->src + offset;
+	}
+
 	if (size >= HOST_PAGE_SIZE - offset)
 		local_sg_elem.size = HOST_PAGE_SIZE - offset;
 	else
@@ -118,12 +159,81 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	if (err < 0)
 		return err;
 
+	/* bytes copied */
+	return local_sg_elem.size;
+}
+
+int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
+			    int32_t host_offset, void *local_ptr, int32_t size)
+{
+	struct dma_trace_data *dmat = dma_trace_data_get();
+	int ret;
+
+	ret = dma_copy_host_page(dc, host_sg, host_offset, local_ptr, size,
+				 DMA_DIR_LMEM_TO_HMEM);
+	if (ret <= 0)
+		return ret;
+
 	ipc_msg_send(dmat->msg, &dmat->posn, false);
 
 	platform_shared_commit(dmat, sizeof(*dmat));
 
 	/* bytes copied */
-	return local_sg_elem.size;
+	return ret;
+}
+
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size)
+{
+	return dma_copy_host_page(dc, host_sg, host_offset, local_ptr, size,
+				  DMA_DIR_HMEM_TO_LMEM);
+}
+
+/* Copy DSP memory to host memory.
+ * Copies any size page by page and waits for completion, no position
+ * update is sent to the host.
+ */
+int dma_copy_to_host(struct dma_copy *dc, struct dma_sg_config *host_sg,
+		     int32_t host_offset, void *local_ptr, int32_t size)
+{
+	int32_t copied = 0;
+	int ret;
+
+	while (copied < size) {
+		ret = dma_copy_host_page(dc, host_sg, host_offset + copied,
+					 (char *)local_ptr + copied,
+					 size - copied, DMA_DIR_LMEM_TO_HMEM);
+		if (ret < 0)
+			return ret;
+
+		copied += ret;
+	}
+
+	return copied;
+}
+
+/* Copy host memory to DSP memory.
+ * Copies any size page by page and waits for completion.
+ */
+int dma_copy_from_host(struct dma_copy *dc, struct dma_sg_config *host_sg,
+		       int32_t host_offset, void *local_ptr, int32_t size)
+{
+	int32_t copied = 0;
+	int ret;
+
+	while (copied < size) {
+		ret = dma_copy_host_page(dc, host_sg, host_offset + copied,
+					 (char *)local_ptr + copied,
+					 size - copied, DMA_DIR_HMEM_TO_LMEM);
+		if (ret < 0)
+			return ret;
+
+		copied += ret;
+	}
+
+	return copied;
 }
 
 #endif
@@ -154,6 +264,119 @@ int dma_copy_new(struct dma_copy *dc)
 	return 0;
 }
 
+int dma_copy_new_local(struct dma_copy *dc)
+{
+	/* request GP DMA in the dir MEM->MEM with shared access */
+	dc->dmac = dma_get(DMA_DIR_MEM_TO_MEM, DMA_CAP_GP_LP | DMA_CAP_GP_HP,
+			   0, DMA_ACCESS_SHARED);
+	if (!dc->dmac) {
+		trace_dma_error("dma_copy_new_local(): dc->dmac = NULL");
+		return -ENODEV;
+	}
+
+	dc->chan = dma_channel_get(dc->dmac, 0);
+	if (!dc->chan) {
+		trace_dma_error("dma_copy_new_local(): dc->chan is NULL");
+		dma_put(dc->dmac);
+		return -ENODEV;
+	}
+
+	return 0;
+}
+
+/* configures single transfer of contiguous block within DSP memory */
+static int dma_copy_local_config(struct dma_copy *dc, void *dest, void *src,
+				 int32_t size)
+{
+	struct dma_sg_config config;
+	struct dma_sg_elem local_sg_elem;
+
+	/* set up DMA configuration */
+	config.direction = DMA_DIR_MEM_TO_MEM;
+	config.src_width = sizeof(uint32_t);
+	config.dest_width = sizeof(uint32_t);
+	config.cyclic = 0;
+	config.irq_disabled = false;
+	config.dmac_config = 0;
+	dma_sg_init(&config.elem_array);
+
+	/* configure local DMA elem */
+	local_sg_elem.dest = (uint32_t)dest;
+	local_sg_elem.src = (uint32_t)src;
+	local_sg_elem.size = size;
+
+	config.elem_array.elems = &local_sg_elem;
+	config.elem_array.count = 1;
+
+	return dma_set_config(dc->chan, &config);
+}
+
+/* Copy DSP memory to DSP memory.
+ * Copies contiguous block in a single transfer and waits for its completion.
+ */
+int dma_copy_local(struct dma_copy *dc, void *dest, void *src, int32_t size)
+{
+	int32_t err;
+
+	if (size <= 0)
+		return 0;
+
+	err = dma_copy_local_config(dc, dest, src, size);
+	if (err < 0)
+		return err;
+
+	err = dma_copy(dc->chan, size, DMA_COPY_ONE_SHOT | DMA_COPY_BLOCKING);
+	if (err < 0)
+		return err;
+
+	/* bytes copied */
+	return size;
+}
+
+/* Copy DSP memory to DSP memory.
+ * Starts single transfer of contiguous block and returns right away, the
+ * caller polls dma_copy_local_done() before using the destination or
+ * starting another transfer on the channel.
+ */
+int dma_copy_local_start(struct dma_copy *dc, void *dest, void *src,
+			 int32_t size)
+{
+	int32_t err;
+
+	if (size <= 0)
+		return 0;
+
+	err = dma_copy_local_config(dc, dest, src, size);
+	if (err < 0)
+		return err;
+
+	err = dma_start(dc->chan);
+	if (err < 0)
+		return err;
+
+	/* bytes in flight */
+	return size;
+}
+
+/* Checks one shot transfer started on the channel, returns 0 and makes
+ * the channel ready for the next transfer once it has finished, -EBUSY
+ * while it still runs.
+ */
+int dma_copy_local_done(struct dma_copy *dc)
+{
+	struct dma_chan_status status;
+	int err;
+
+	err = dma_status(dc->chan, &status, DMA_DIR_MEM_TO_MEM);
+	if (err < 0)
+		return err;
+
+	if (status.state == COMP_STATE_ACTIVE)
+		return -EBUSY;
+
+	return dma_stop(dc->chan);
+}
+
 #if CONFIG_DMA_GW
 
 int dma_copy_set_stream_tag(struct dma_copy *dc, uint32_t stream_tag)
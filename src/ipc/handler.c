@@ -18,21 +18,28 @@
 #include <sof/common.h>
 #include <sof/debug/gdb/gdb.h>
 #include <sof/debug/panic.h>
+#include <sof/debug/session.h>
 #include <sof/drivers/idc.h>
 #include <sof/drivers/interrupt.h>
 #include <sof/drivers/ipc.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
+#include <sof/lib/clk.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/dai.h>
 #include <sof/lib/dma.h>
+#include <sof/lib/idle.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/memory.h>
+#include <sof/lib/mm_heap.h>
+#include <sof/lib/perf_cnt.h>
 #include <sof/lib/pm_runtime.h>
 #include <sof/list.h>
 #include <sof/math/numbers.h>
 #include <sof/platform.h>
+#include <sof/schedule/edf_schedule.h>
+#include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
 #include <sof/spinlock.h>
@@ -113,6 +120,27 @@
 			((struct sof_ipc_cmd_hdr *)tx),			\
 			sizeof(rx))
 
+/* Validates message in place and returns a read-only view of it, follows
+ * above ABI rules without copying. The message copy read by
+ * mailbox_validate() is sized for any message, so fields the sender
+ * doesn't know are zeroed in it. Values needed after a reply is written
+ * over the message must be taken from the view before.
+ */
+#define IPC_VIEW_CMD(type, tx) \
+	((const type *)ipc_cmd_view((struct sof_ipc_cmd_hdr *)(tx),	\
+				    sizeof(type)))
+
+static void *ipc_cmd_view(struct sof_ipc_cmd_hdr *hdr, uint32_t rx_size)
+{
+	if (rx_size > hdr->size) {
+		bzero((char *)hdr + hdr->size, rx_size - hdr->size);
+		trace_ipc("ipc: hdr 0x%x rx (%d) > tx (%d)", hdr->cmd,
+			  rx_size, hdr->size);
+	}
+
+	return hdr;
+}
+
 struct sof_ipc_cmd_hdr *mailbox_validate(void)
 {
 	struct sof_ipc_cmd_hdr *hdr = ipc_get()->comp_data;
@@ -120,6 +148,24 @@ struct sof_ipc_cmd_hdr *mailbox_validate(void)
 	/* read component values from the inbox */
 	mailbox_hostbox_read(hdr, SOF_IPC_MSG_MAX_SIZE, 0, sizeof(*hdr));
 
+	/* compound commands are read from the mailbox when they are run */
+	if (iGS(hdr->cmd) == SOF_IPC_GLB_COMPOUND) {
+		if (hdr->size < sizeof(struct sof_ipc_compound_hdr) ||
+		    hdr->size > MAILBOX_HOSTBOX_SIZE) {
+			trace_ipc_error("ipc: compound msg size 0x%x is invalid",
+					hdr->size);
+			return NULL;
+		}
+
+		mailbox_hostbox_read(hdr + 1,
+				     SOF_IPC_MSG_MAX_SIZE - sizeof(*hdr),
+				     sizeof(*hdr),
+				     sizeof(struct sof_ipc_compound_hdr) -
+				     sizeof(*hdr));
+
+		return hdr;
+	}
+
 	/* validate component header */
 	if (hdr->size > SOF_IPC_MSG_MAX_SIZE) {
 		trace_ipc_error("ipc: msg too big at 0x%x", hdr->size);
@@ -333,6 +379,54 @@ error:
 }
 
 /* free stream resources */
+/* changes rate or format of a prepared or running stream in place */
+static int ipc_stream_pcm_reconfig(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_pcm_params pcm_params;
+	struct ipc_comp_dev *pcm_dev;
+	int ret;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(pcm_params, ipc->comp_data);
+
+	/* get the pcm_dev */
+	pcm_dev = ipc_get_comp_by_id(ipc, pcm_params.comp_id);
+	if (!pcm_dev) {
+		trace_ipc_error("ipc: comp %d not found", pcm_params.comp_id);
+		return -ENODEV;
+	}
+
+	/* check core */
+	if (!cpu_is_me(pcm_dev->core))
+		return ipc_process_on_core(pcm_dev->core);
+
+	trace_ipc("ipc: comp %d -> reconfig", pcm_params.comp_id);
+
+	/* stream has to be set up by params first */
+	if (!pcm_dev->cd->pipeline ||
+	    pcm_dev->cd->state < COMP_STATE_PREPARE) {
+		trace_ipc_error("ipc: comp %d not prepared",
+				pcm_params.comp_id);
+		return -EINVAL;
+	}
+
+	if (IPC_IS_SIZE_INVALID(pcm_params.params)) {
+		IPC_SIZE_ERROR_TRACE(TRACE_CLASS_IPC, pcm_params.params);
+		return -EINVAL;
+	}
+
+	ret = pipeline_reconfig(pcm_dev->cd->pipeline, pcm_dev->cd,
+				&pcm_params);
+	if (ret < 0)
+		trace_ipc_error("ipc: comp %d reconfig failed %d",
+				pcm_params.comp_id, ret);
+
+	platform_shared_commit(pcm_dev, sizeof(*pcm_dev));
+
+	return ret;
+}
+
 static int ipc_stream_pcm_free(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
@@ -366,6 +460,9 @@ static int ipc_stream_pcm_free(uint32_t header)
 	/* reset the pipeline */
 	ret = pipeline_reset(pcm_dev->cd->pipeline, pcm_dev->cd);
 
+	/* memory of the closed stream can be merged with other free blocks */
+	ipc_buffers_compact(ipc);
+
 	platform_shared_commit(pcm_dev, sizeof(*pcm_dev));
 
 	return ret;
@@ -375,17 +472,17 @@ static int ipc_stream_pcm_free(uint32_t header)
 static int ipc_stream_position(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_stream stream;
+	const struct sof_ipc_stream *stream;
 	struct sof_ipc_stream_posn posn;
 	struct ipc_comp_dev *pcm_dev;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(stream, ipc->comp_data);
+	/* validate message with ABI safe method */
+	stream = IPC_VIEW_CMD(struct sof_ipc_stream, ipc->comp_data);
 
 	/* get the pcm_dev */
-	pcm_dev = ipc_get_comp_by_id(ipc, stream.comp_id);
+	pcm_dev = ipc_get_comp_by_id(ipc, stream->comp_id);
 	if (!pcm_dev) {
-		trace_ipc_error("ipc: comp %d not found", stream.comp_id);
+		trace_ipc_error("ipc: comp %d not found", stream->comp_id);
 		return -ENODEV;
 	}
 
@@ -393,22 +490,21 @@ static int ipc_stream_position(uint32_t header)
 	if (!cpu_is_me(pcm_dev->core))
 		return ipc_process_on_core(pcm_dev->core);
 
-	trace_ipc("ipc: comp %d -> position", stream.comp_id);
+	trace_ipc("ipc: comp %d -> position", stream->comp_id);
 
 	memset(&posn, 0, sizeof(posn));
 
 	/* set message fields - TODO; get others */
 	posn.rhdr.hdr.cmd = SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_POSITION |
-			    stream.comp_id;
+			    stream->comp_id;
 	posn.rhdr.hdr.size = sizeof(posn);
-	posn.comp_id = stream.comp_id;
+	posn.comp_id = stream->comp_id;
 
 	/* get the stream positions and timestamps */
 	pipeline_get_timestamp(pcm_dev->cd->pipeline, pcm_dev->cd, &posn);
 
 	/* copy positions to stream region */
-	mailbox_stream_write(pcm_dev->cd->pipeline->posn_offset,
-			     &posn, sizeof(posn));
+	pipeline_posn_write(pcm_dev->cd->pipeline, &posn);
 
 	platform_shared_commit(pcm_dev, sizeof(*pcm_dev));
 
@@ -419,18 +515,18 @@ static int ipc_stream_trigger(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
 	struct ipc_comp_dev *pcm_dev;
-	struct sof_ipc_stream stream;
+	const struct sof_ipc_stream *stream;
 	uint32_t ipc_cmd = iCS(header);
 	uint32_t cmd;
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(stream, ipc->comp_data);
+	/* validate message with ABI safe method */
+	stream = IPC_VIEW_CMD(struct sof_ipc_stream, ipc->comp_data);
 
 	/* get the pcm_dev */
-	pcm_dev = ipc_get_comp_by_id(ipc, stream.comp_id);
+	pcm_dev = ipc_get_comp_by_id(ipc, stream->comp_id);
 	if (!pcm_dev) {
-		trace_ipc_error("ipc: comp %d not found", stream.comp_id);
+		trace_ipc_error("ipc: comp %d not found", stream->comp_id);
 		return -ENODEV;
 	}
 
@@ -438,7 +534,7 @@ static int ipc_stream_trigger(uint32_t header)
 	if (!cpu_is_me(pcm_dev->core))
 		return ipc_process_on_core(pcm_dev->core);
 
-	trace_ipc("ipc: comp %d -> trigger cmd 0x%x", stream.comp_id, ipc_cmd);
+	trace_ipc("ipc: comp %d -> trigger cmd 0x%x", stream->comp_id, ipc_cmd);
 
 	switch (ipc_cmd) {
 	case SOF_IPC_STREAM_TRIG_START:
@@ -465,7 +561,7 @@ static int ipc_stream_trigger(uint32_t header)
 	ret = pipeline_trigger(pcm_dev->cd->pipeline, pcm_dev->cd, cmd);
 	if (ret < 0) {
 		trace_ipc_error("ipc: comp %d trigger 0x%x failed %d",
-				stream.comp_id, ipc_cmd, ret);
+				stream->comp_id, ipc_cmd, ret);
 	}
 
 	platform_shared_commit(pcm_dev, sizeof(*pcm_dev));
@@ -473,6 +569,78 @@ static int ipc_stream_trigger(uint32_t header)
 	return ret;
 }
 
+static int ipc_stream_trigger_group(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_stream_group *group = ipc->comp_data;
+	struct comp_dev *hosts[PLATFORM_MAX_STREAMS];
+	struct ipc_comp_dev *pcm_dev;
+	uint32_t ipc_cmd = iCS(header);
+	uint32_t time_domain = 0;
+	uint32_t core = 0;
+	uint32_t i;
+	int cmd;
+	int ret;
+
+	/* all host components must be in the message */
+	if (group->hdr.size < sizeof(*group) || !group->num_comps ||
+	    group->num_comps > PLATFORM_MAX_STREAMS ||
+	    group->num_comps > (group->hdr.size - sizeof(*group)) /
+	    sizeof(group->comp_id[0])) {
+		trace_ipc_error("ipc: stream group invalid size %d",
+				group->hdr.size);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < group->num_comps; i++) {
+		pcm_dev = ipc_get_comp_by_id(ipc, group->comp_id[i]);
+		if (!pcm_dev || pcm_dev->type != COMP_TYPE_COMPONENT) {
+			trace_ipc_error("ipc: comp %d not found",
+					group->comp_id[i]);
+			return -ENODEV;
+		}
+
+		/* pipelines of a group are scheduled by one LL scheduler */
+		if (i && (pcm_dev->core != core ||
+			  pcm_dev->cd->pipeline->ipc_pipe.time_domain !=
+			  time_domain)) {
+			trace_ipc_error("ipc: comp %d not on core %d scheduler %d",
+					group->comp_id[i], core, time_domain);
+			return -EINVAL;
+		}
+
+		core = pcm_dev->core;
+		time_domain = pcm_dev->cd->pipeline->ipc_pipe.time_domain;
+		hosts[i] = pcm_dev->cd;
+	}
+
+	/* check core */
+	if (!cpu_is_me(core))
+		return ipc_process_on_core(core);
+
+	trace_ipc("ipc: %d comps -> group trigger cmd 0x%x", group->num_comps,
+		  ipc_cmd);
+
+	switch (ipc_cmd) {
+	case SOF_IPC_STREAM_TRIG_GROUP_START:
+		cmd = COMP_TRIGGER_START;
+		break;
+	case SOF_IPC_STREAM_TRIG_GROUP_STOP:
+		cmd = COMP_TRIGGER_STOP;
+		break;
+	default:
+		trace_ipc_error("ipc: invalid group trigger cmd 0x%x", ipc_cmd);
+		return -ENODEV;
+	}
+
+	ret = pipeline_trigger_group(hosts, group->num_comps, cmd);
+	if (ret < 0)
+		trace_ipc_error("ipc: group trigger 0x%x failed %d", ipc_cmd,
+				ret);
+
+	return ret;
+}
+
 static int ipc_glb_stream_message(uint32_t header)
 {
 	uint32_t cmd = iCS(header);
@@ -482,6 +650,8 @@ static int ipc_glb_stream_message(uint32_t header)
 		return ipc_stream_pcm_params(header);
 	case SOF_IPC_STREAM_PCM_FREE:
 		return ipc_stream_pcm_free(header);
+	case SOF_IPC_STREAM_PCM_RECONFIG:
+		return ipc_stream_pcm_reconfig(header);
 	case SOF_IPC_STREAM_TRIG_START:
 	case SOF_IPC_STREAM_TRIG_STOP:
 	case SOF_IPC_STREAM_TRIG_PAUSE:
@@ -489,6 +659,9 @@ static int ipc_glb_stream_message(uint32_t header)
 	case SOF_IPC_STREAM_TRIG_DRAIN:
 	case SOF_IPC_STREAM_TRIG_XRUN:
 		return ipc_stream_trigger(header);
+	case SOF_IPC_STREAM_TRIG_GROUP_START:
+	case SOF_IPC_STREAM_TRIG_GROUP_STOP:
+		return ipc_stream_trigger_group(header);
 	case SOF_IPC_STREAM_POSITION:
 		return ipc_stream_position(header);
 	default:
@@ -536,6 +709,11 @@ static int ipc_glb_dai_message(uint32_t header)
  * PM IPC Operations.
  */
 
+/* size of the ipc component lists, they point into the runtime heap */
+#define IPC_PM_STATE_SIZE(ipc) \
+	(sizeof((ipc)->comp_list) + sizeof((ipc)->comp_table) + \
+	 sizeof((ipc)->ppl_table))
+
 static int ipc_pm_context_size(uint32_t header)
 {
 	struct sof_ipc_pm_ctx pm_ctx;
@@ -544,26 +722,185 @@ static int ipc_pm_context_size(uint32_t header)
 
 	bzero(&pm_ctx, sizeof(pm_ctx));
 
-	/* TODO: calculate the context and size of host buffers required */
+	/* only allocated heap blocks are part of the context */
+	pm_ctx.size = mm_pm_context_size() + IPC_PM_STATE_SIZE(ipc_get());
 
 	/* write the context to the host driver */
-	//mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
+	pm_ctx.hdr.cmd = header;
+	pm_ctx.hdr.size = sizeof(pm_ctx);
+	mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
 
-	return 0;
+	return 1;
+}
+
+/* the context is only consistent when no pipeline runs */
+static bool ipc_pm_pipelines_active(struct ipc *ipc)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	bool active = false;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type == COMP_TYPE_PIPELINE &&
+		    icd->pipeline->status == COMP_STATE_ACTIVE)
+			active = true;
+
+		platform_shared_commit(icd, sizeof(*icd));
+	}
+
+	return active;
+}
+
+#if CONFIG_HOST_PTABLE
+/* Gets the pages of the host context buffer. The descriptors are moved out
+ * of the runtime heap, which is part of the context itself.
+ */
+static int ipc_pm_context_buffer(struct sof_ipc_pm_ctx *pm_ctx,
+				 uint32_t direction,
+				 struct dma_sg_config *sg)
+{
+	struct dma_sg_elem_array elem_array;
+	uint32_t ring_size;
+	uint32_t bytes;
+	int ret;
+
+	ret = ipc_process_host_buffer(ipc_get(), &pm_ctx->buffer, direction,
+				      &elem_array, &ring_size);
+	if (ret < 0)
+		return ret;
+
+	bzero(sg, sizeof(*sg));
+
+	bytes = sizeof(*elem_array.elems) * elem_array.count;
+	sg->elem_array.elems = rmalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+				       SOF_MEM_CAPS_RAM, bytes);
+	if (!sg->elem_array.elems) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	ret = memcpy_s(sg->elem_array.elems, bytes, elem_array.elems, bytes);
+	assert(!ret);
+
+	sg->elem_array.count = elem_array.count;
+
+out:
+	dma_sg_free(&elem_array);
+	return ret;
+}
+
+/* copies the ipc component lists after the heap context */
+static int ipc_pm_state_copy(struct ipc *ipc, struct dma_copy *dc,
+			     struct dma_sg_config *sg, uint32_t offset,
+			     bool save)
+{
+	void *state[] = { &ipc->comp_list, ipc->comp_table, ipc->ppl_table };
+	uint32_t size[] = { sizeof(ipc->comp_list), sizeof(ipc->comp_table),
+			    sizeof(ipc->ppl_table) };
+	int ret;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(state); i++) {
+		if (save) {
+			dcache_writeback_region(state[i], size[i]);
+			ret = dma_copy_to_host(dc, sg, offset, state[i],
+					       size[i]);
+		} else {
+			ret = dma_copy_from_host(dc, sg, offset, state[i],
+						 size[i]);
+			dcache_invalidate_region(state[i], size[i]);
+		}
+
+		if (ret < 0)
+			return ret;
+
+		offset += ret;
+	}
+
+	platform_shared_commit(ipc, sizeof(*ipc));
+
+	return IPC_PM_STATE_SIZE(ipc);
+}
+
+/* Saves or restores the heap blocks in use and the component lists to
+ * the host buffer, so resume does not need the topology to be reloaded.
+ */
+static int ipc_pm_context_copy(struct sof_ipc_pm_ctx *pm_ctx, bool save)
+{
+	struct ipc *ipc = ipc_get();
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	int heap_size;
+	int ret;
+
+	if (save && pm_ctx->buffer.size < mm_pm_context_size() +
+	    IPC_PM_STATE_SIZE(ipc)) {
+		trace_ipc_error("ipc: pm context buffer too small %d",
+				pm_ctx->buffer.size);
+		return -ENOSPC;
+	}
+
+	ret = ipc_pm_context_buffer(pm_ctx, save ? SOF_IPC_STREAM_CAPTURE :
+				    SOF_IPC_STREAM_PLAYBACK, &sg);
+	if (ret < 0)
+		return ret;
+
+	ret = dma_copy_new(&dc);
+	if (ret < 0)
+		goto out;
+
+	heap_size = save ? mm_pm_context_save(&dc, &sg) :
+		mm_pm_context_restore(&dc, &sg);
+	if (heap_size < 0) {
+		ret = heap_size;
+		goto free;
+	}
+
+	ret = ipc_pm_state_copy(ipc, &dc, &sg, heap_size, save);
+	if (ret < 0)
+		goto free;
+
+	pm_ctx->size = heap_size + ret;
+	ret = 0;
+
+free:
+	dma_copy_free(&dc);
+out:
+	rfree(sg.elem_array.elems);
+	return ret;
+}
+#else
+static int ipc_pm_context_copy(struct sof_ipc_pm_ctx *pm_ctx, bool save)
+{
+	return -ENOTSUP;
 }
+#endif
 
-static int ipc_pm_context_save(uint32_t header)
+static int __cold_text ipc_pm_context_save(uint32_t header)
 {
-	//struct sof_ipc_pm_ctx *pm_ctx = _ipc->comp_data;
+	struct sof_ipc_pm_ctx pm_ctx;
+	int ret;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(pm_ctx, ipc_get()->comp_data);
 
 	trace_ipc("ipc: pm -> save");
 
-	/* TODO: check we are inactive - all streams are suspended */
+	/* check we are inactive - all streams are suspended */
+	if (ipc_pm_pipelines_active(ipc_get())) {
+		trace_ipc_error("ipc: pm save with active pipelines");
+		return -EBUSY;
+	}
 
 	/* TODO: mask ALL platform interrupts except DMA */
 
-	/* TODO now save the context - create SG buffer config using */
-	//mm_pm_context_save(struct dma_sg_config *sg);
+	/* now save the context, the host reloads the topology on failure */
+	ret = ipc_pm_context_copy(&pm_ctx, true);
+	if (ret < 0) {
+		trace_ipc_error("ipc: pm context save failed %d", ret);
+		pm_ctx.size = 0;
+	}
 
 	/* mask all DSP interrupts */
 	arch_interrupt_disable_mask(0xffffffff);
@@ -577,32 +914,51 @@ static int ipc_pm_context_save(uint32_t header)
 
 	/* TODO: disable SSP and DMA HW */
 
-	/* TODO: save the context */
-	//reply.entries_no = 0;
-
 	/* write the context to the host driver */
-	//mailbox_hostbox_write(0, pm_ctx, sizeof(*pm_ctx));
+	pm_ctx.hdr.cmd = header;
+	pm_ctx.hdr.size = sizeof(pm_ctx);
+	pm_ctx.num_elems = 0;
+	mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
 
 	ipc_get()->pm_prepare_D3 = 1;
 
-	return 0;
+	return 1;
 }
 
-static int ipc_pm_context_restore(uint32_t header)
+static int __cold_text ipc_pm_context_restore(uint32_t header)
 {
-	//struct sof_ipc_pm_ctx *pm_ctx = _ipc->comp_data;
+	struct sof_ipc_pm_ctx pm_ctx;
+	int ret;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(pm_ctx, ipc_get()->comp_data);
 
 	trace_ipc("ipc: pm -> restore");
 
 	ipc_get()->pm_prepare_D3 = 0;
 
-	/* restore context placeholder */
-	//mailbox_hostbox_write(0, pm_ctx, sizeof(*pm_ctx));
+	/* must come right after boot, before any topology is loaded */
+	if (!list_is_empty(&ipc_get()->comp_list)) {
+		trace_ipc_error("ipc: pm restore with loaded topology");
+		return -EBUSY;
+	}
 
-	return 0;
+	ret = ipc_pm_context_copy(&pm_ctx, false);
+	if (ret < 0) {
+		trace_ipc_error("ipc: pm context restore failed %d", ret);
+		return ret;
+	}
+
+	/* write the context to the host driver */
+	pm_ctx.hdr.cmd = header;
+	pm_ctx.hdr.size = sizeof(pm_ctx);
+	pm_ctx.num_elems = 0;
+	mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
+
+	return 1;
 }
 
-static int ipc_pm_core_enable(uint32_t header)
+static int __cold_text ipc_pm_core_enable(uint32_t header)
 {
 	struct sof_ipc_pm_core_config pm_core_config;
 	int ret = 0;
@@ -672,11 +1028,11 @@ static int ipc_glb_pm_message(uint32_t header)
 	}
 }
 
-#if CONFIG_TRACE
 /*
  * Debug IPC Operations.
  */
-static int ipc_dma_trace_config(uint32_t header)
+#if CONFIG_TRACE
+static int __cold_text ipc_dma_trace_config(uint32_t header)
 {
 #if CONFIG_HOST_PTABLE
 	struct dma_sg_elem_array elem_array;
@@ -736,81 +1092,598 @@ error:
 	return err;
 }
 
-static int ipc_glb_debug_message(uint32_t header)
+static int ipc_trace_filter_update(uint32_t header)
 {
-	uint32_t cmd = iCS(header);
-
-	trace_ipc("ipc: debug cmd 0x%x", cmd);
+	struct sof_ipc_trace_filter *filter = ipc_get()->comp_data;
+	uint32_t i;
+	int ret;
 
-	switch (cmd) {
-	case SOF_IPC_TRACE_DMA_PARAMS:
-	case SOF_IPC_TRACE_DMA_PARAMS_EXT:
-		return ipc_dma_trace_config(header);
-	default:
-		trace_ipc_error("ipc: unknown debug cmd 0x%x", cmd);
+	/* all elements must be in the message */
+	if (filter->hdr.size < sizeof(*filter) ||
+	    filter->num_elems > (filter->hdr.size - sizeof(*filter)) /
+	    sizeof(*filter->elems)) {
+		trace_ipc_error("ipc: trace filter invalid size %d",
+				filter->hdr.size);
 		return -EINVAL;
 	}
-}
-#else
-static int ipc_glb_debug_message(uint32_t header)
-{
-	/* traces are disabled - CONFIG_TRACE is not set */
 
-	return -EINVAL;
+	for (i = 0; i < filter->num_elems; i++) {
+		ret = trace_filter_update(&filter->elems[i]);
+		if (ret < 0) {
+			trace_ipc_error("ipc: trace filter elem %d type %d failed %d",
+					i, filter->elems[i].type, ret);
+			return ret;
+		}
+	}
+
+	return 0;
 }
 #endif
 
-static int ipc_glb_gdb_debug(uint32_t header)
+static int ipc_heap_info(uint32_t header)
 {
-	/* no furher information needs to be extracted form header */
-	(void) header;
+	struct sof_ipc_dbg_heap_info *info = ipc_get()->comp_data;
+	int ret;
 
-#if CONFIG_GDB_DEBUG
-	gdb_init_debug_exception();
-	gdb_init();
-	/* TODO: this asm should be in arch/include/debug/debug.h
-	 * with a generic name and trigger debug exception
-	 */
-	asm volatile("_break 0, 0");
-	return 0;
+	ret = heap_info_get(info, MIN(MAILBOX_HOSTBOX_SIZE,
+				      SOF_IPC_MSG_MAX_SIZE));
+	if (ret < 0) {
+		trace_ipc_error("ipc: heap info failed %d", ret);
+		return ret;
+	}
+
+	/* write data to the outbox */
+	info->rhdr.hdr.cmd = header;
+	info->rhdr.error = 0;
+	mailbox_hostbox_write(0, info, info->rhdr.hdr.size);
+
+	return 1;
+}
+
+#if CONFIG_PERFORMANCE_COUNTERS
+static void ipc_comp_perf_fill(struct sof_ipc_dbg_comp_perf_elem *elem,
+			       struct comp_dev *dev)
+{
+	uint64_t budget;
+
+	/* cycles available to the core in one scheduling period */
+	budget = (uint64_t)clock_get_freq(CLK_CPU(dev->comp.core)) *
+		 dev->period / 1000000;
+
+	elem->comp_id = dev->comp.id;
+	elem->pipeline_id = dev->comp.pipeline_id;
+	elem->core = dev->comp.core;
+	elem->reserved = 0;
+	elem->period = dev->period;
+	elem->cycles_avg = dev->pcd.cpu_delta_avg;
+	elem->cycles_peak = dev->pcd.cpu_delta_peak;
+	elem->load_avg = perf_cnt_load(dev->pcd.cpu_delta_avg, budget);
+	elem->load_peak = perf_cnt_load(dev->pcd.cpu_delta_peak, budget);
+#if CONFIG_PERFORMANCE_COUNTERS_PMU
+	elem->stall_data_avg = dev->pcd.pmu_delta_avg[PMU_EVENT_STALL_DATA];
+	elem->stall_instr_avg = dev->pcd.pmu_delta_avg[PMU_EVENT_STALL_INSTR];
+	elem->dcache_miss_avg = dev->pcd.pmu_delta_avg[PMU_EVENT_DCACHE_MISS];
+	elem->icache_miss_avg = dev->pcd.pmu_delta_avg[PMU_EVENT_ICACHE_MISS];
 #else
-	return -EINVAL;
+	elem->stall_data_avg = 0;
+	elem->stall_instr_avg = 0;
+	elem->dcache_miss_avg = 0;
+	elem->icache_miss_avg = 0;
 #endif
-
 }
 
-#if CONFIG_PROBE
-static inline int ipc_probe_init(uint32_t header)
+static int ipc_comp_perf_info(uint32_t header)
 {
-	struct sof_ipc_probe_dma_add_params *params = ipc_get()->comp_data;
-	int dma_provided = params->num_elems;
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_comp_perf_info *info = ipc->comp_data;
+	struct sof_ipc_dbg_comp_perf_params params;
+	uint32_t max_size = MIN(MAILBOX_HOSTBOX_SIZE, SOF_IPC_MSG_MAX_SIZE);
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
 
-	tracev_ipc("ipc_probe_init()");
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
 
-	if (dma_provided > 1 || dma_provided < 0) {
-		trace_ipc_error("ipc_probe_init(): Invalid amount of extraction DMAs specified = %d",
-				dma_provided);
-		return -EINVAL;
+	info->rhdr.hdr.size = sizeof(*info);
+	info->num_elems = 0;
+	info->total_elems = 0;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_COMPONENT) {
+			platform_shared_commit(icd, sizeof(*icd));
+			continue;
+		}
+
+		/* report as many components as fit in the reply */
+		if (info->total_elems++ >= params.first_elem &&
+		    info->rhdr.hdr.size + sizeof(*info->elems) <= max_size) {
+			ipc_comp_perf_fill(&info->elems[info->num_elems],
+					   icd->cd);
+			info->num_elems++;
+			info->rhdr.hdr.size += sizeof(*info->elems);
+		}
+
+		platform_shared_commit(icd, sizeof(*icd));
 	}
 
-	return probe_init(dma_provided ? params->probe_dma : NULL);
+	/* write data to the outbox */
+	info->rhdr.hdr.cmd = header;
+	info->rhdr.error = 0;
+	mailbox_hostbox_write(0, info, info->rhdr.hdr.size);
+
+	return 1;
 }
+#endif
 
-static inline int ipc_probe_deinit(uint32_t header)
+static int ipc_ll_stats(uint32_t header)
 {
-	tracev_ipc("ipc_probe_deinit()");
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_ll_stats *stats = ipc->comp_data;
+	struct sof_ipc_dbg_ll_stats_params params;
+	int ret;
 
-	return probe_deinit();
-}
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
 
-static inline int ipc_probe_dma_add(uint32_t header)
-{
-	struct sof_ipc_probe_dma_add_params *params = ipc_get()->comp_data;
-	int dmas_count = params->num_elems;
+	ret = schedule_ll_stats_get(stats, MIN(MAILBOX_HOSTBOX_SIZE,
+					       SOF_IPC_MSG_MAX_SIZE),
+				    params.sched_type, params.core,
+				    params.flags & SOF_IPC_LL_STATS_RESET);
+	if (ret < 0) {
+		trace_ipc_error("ipc: ll stats type %d core %d failed %d",
+				params.sched_type, params.core, ret);
+		return ret;
+	}
 
-	tracev_ipc("ipc_probe_dma_add()");
+	/* write data to the outbox */
+	stats->rhdr.hdr.cmd = header;
+	stats->rhdr.error = 0;
+	mailbox_hostbox_write(0, stats, stats->rhdr.hdr.size);
 
-	if (dmas_count > CONFIG_PROBE_DMA_MAX) {
+	return 1;
+}
+
+#if CONFIG_IRQ_STATS
+static int ipc_irq_stats(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_irq_stats *stats = ipc->comp_data;
+	struct sof_ipc_dbg_irq_stats_params params;
+	int ret;
+
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
+
+	ret = interrupt_stats_get(stats, MIN(MAILBOX_HOSTBOX_SIZE,
+					     SOF_IPC_MSG_MAX_SIZE),
+				  params.core,
+				  params.flags & SOF_IPC_IRQ_STATS_RESET);
+	if (ret < 0) {
+		trace_ipc_error("ipc: irq stats core %d failed %d",
+				params.core, ret);
+		return ret;
+	}
+
+	/* write data to the outbox */
+	stats->rhdr.hdr.cmd = header;
+	stats->rhdr.error = 0;
+	mailbox_hostbox_write(0, stats, stats->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+#if CONFIG_IDLE_GOVERNOR
+static int ipc_idle_stats(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_idle_stats *stats = ipc->comp_data;
+	struct sof_ipc_dbg_idle_stats_params params;
+	int ret;
+
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
+
+	ret = platform_idle_stats_get(stats, params.core,
+				      params.flags & SOF_IPC_IDLE_STATS_RESET);
+	if (ret < 0) {
+		trace_ipc_error("ipc: idle stats core %d failed %d",
+				params.core, ret);
+		return ret;
+	}
+
+	/* write data to the outbox */
+	stats->rhdr.hdr.cmd = header;
+	stats->rhdr.error = 0;
+	mailbox_hostbox_write(0, stats, stats->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+#if CONFIG_SESSION_RECORD
+static int ipc_session_read(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_session_data *reply = ipc->comp_data;
+	struct sof_ipc_dbg_session_params params;
+	int ret;
+
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
+
+	ret = session_read(reply, params.offset,
+			   MIN(MAILBOX_HOSTBOX_SIZE, SOF_IPC_MSG_MAX_SIZE),
+			   params.flags & SOF_IPC_SESSION_RESTART);
+	if (ret < 0) {
+		trace_ipc_error("ipc: session read failed %d", ret);
+		return ret;
+	}
+
+	/* write data to the outbox */
+	reply->rhdr.hdr.cmd = header;
+	reply->rhdr.error = 0;
+	mailbox_hostbox_write(0, reply, reply->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+static int ipc_stack_info(uint32_t header)
+{
+	struct sof_ipc_dbg_stack_info *info = ipc_get()->comp_data;
+	int ret;
+
+	ret = schedule_edf_stack_info_get(info, MIN(MAILBOX_HOSTBOX_SIZE,
+						    SOF_IPC_MSG_MAX_SIZE));
+	if (ret < 0) {
+		trace_ipc_error("ipc: stack info failed %d", ret);
+		return ret;
+	}
+
+	/* write data to the outbox */
+	info->rhdr.hdr.cmd = header;
+	info->rhdr.error = 0;
+	mailbox_hostbox_write(0, info, info->rhdr.hdr.size);
+
+	return 1;
+}
+
+#if CONFIG_DEBUG_LOCK_STATS
+static int ipc_lock_stats(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_lock_stats *stats = ipc->comp_data;
+	struct sof_ipc_dbg_lock_stats_params params;
+	int ret;
+
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
+
+	ret = spinlock_stats_get(stats, MIN(MAILBOX_HOSTBOX_SIZE,
+					    SOF_IPC_MSG_MAX_SIZE),
+				 params.flags & SOF_IPC_LOCK_STATS_RESET);
+	if (ret < 0) {
+		trace_ipc_error("ipc: lock stats failed %d", ret);
+		return ret;
+	}
+
+	/* write data to the outbox */
+	stats->rhdr.hdr.cmd = header;
+	stats->rhdr.error = 0;
+	mailbox_hostbox_write(0, stats, stats->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+#if CONFIG_DEBUG_MEM_OWNER
+struct ipc_mem_owner_walk {
+	struct ipc *ipc;
+	struct sof_ipc_dbg_mem_owner_info *info;
+	bool pipelines;
+};
+
+static uint32_t ipc_comp_dev_ppl_id(struct ipc_comp_dev *icd)
+{
+	switch (icd->type) {
+	case COMP_TYPE_COMPONENT:
+		return icd->cd->comp.pipeline_id;
+	case COMP_TYPE_BUFFER:
+		return icd->cb->pipeline_id;
+	default:
+		return icd->pipeline->ipc_pipe.pipeline_id;
+	}
+}
+
+/* adds an allocation to the reported object owning it */
+static void ipc_mem_owner_add(void *arg, uint32_t owner, uint32_t bytes)
+{
+	struct ipc_mem_owner_walk *walk = arg;
+	struct sof_ipc_dbg_mem_owner_elem *elem;
+	struct ipc_comp_dev *icd;
+	uint32_t key;
+	uint32_t i;
+
+	/* objects freed since leave their leaks untracked */
+	icd = ipc_get_comp_by_id(walk->ipc, ALLOC_OWNER_ID(owner));
+	if (!icd)
+		return;
+
+	key = walk->pipelines ? ipc_comp_dev_ppl_id(icd) : icd->id;
+
+	platform_shared_commit(icd, sizeof(*icd));
+
+	for (i = 0; i < walk->info->num_elems; i++) {
+		elem = &walk->info->elems[i];
+		if ((walk->pipelines ? elem->pipeline_id : elem->id) == key) {
+			elem->bytes += bytes;
+			elem->allocs++;
+			return;
+		}
+	}
+}
+
+static int ipc_mem_owner_info(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_mem_owner_info *info = ipc->comp_data;
+	struct sof_ipc_dbg_mem_owner_params params;
+	struct sof_ipc_dbg_mem_owner_elem *elem;
+	uint32_t max_size = MIN(MAILBOX_HOSTBOX_SIZE, SOF_IPC_MSG_MAX_SIZE);
+	struct ipc_mem_owner_walk walk;
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
+
+	walk.ipc = ipc;
+	walk.info = info;
+	walk.pipelines = params.flags & SOF_IPC_MEM_OWNER_PIPELINES;
+
+	info->rhdr.hdr.size = sizeof(*info);
+	info->num_elems = 0;
+	info->total_elems = 0;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (walk.pipelines && icd->type != COMP_TYPE_PIPELINE) {
+			platform_shared_commit(icd, sizeof(*icd));
+			continue;
+		}
+
+		/* report as many objects as fit in the reply */
+		if (info->total_elems++ >= params.first_elem &&
+		    info->rhdr.hdr.size + sizeof(*info->elems) <= max_size) {
+			elem = &info->elems[info->num_elems];
+			elem->id = icd->id;
+			elem->pipeline_id = ipc_comp_dev_ppl_id(icd);
+			elem->type = icd->type == COMP_TYPE_COMPONENT ?
+				SOF_IPC_MEM_OWNER_COMP :
+				icd->type == COMP_TYPE_BUFFER ?
+				SOF_IPC_MEM_OWNER_BUFFER :
+				SOF_IPC_MEM_OWNER_PIPELINE;
+			elem->core = icd->core;
+			elem->bytes = 0;
+			elem->allocs = 0;
+			info->num_elems++;
+			info->rhdr.hdr.size += sizeof(*info->elems);
+		}
+
+		platform_shared_commit(icd, sizeof(*icd));
+	}
+
+	/* sizes come from the heap block headers of the reported objects */
+	alloc_owner_walk(ipc_mem_owner_add, &walk);
+
+	/* write data to the outbox */
+	info->rhdr.hdr.cmd = header;
+	info->rhdr.error = 0;
+	mailbox_hostbox_write(0, info, info->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+#if CONFIG_PIPELINE_LATENCY
+static int ipc_latency_info(uint32_t header)
+{
+	static uint32_t last_seq;
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_dbg_latency_info *info = ipc->comp_data;
+	struct sof_ipc_dbg_latency_params params;
+	struct sof_ipc_dbg_latency_elem *elem;
+	uint32_t max_size = MIN(MAILBOX_HOSTBOX_SIZE, SOF_IPC_MSG_MAX_SIZE);
+	uint64_t ticks_per_ms = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+	struct ipc_comp_dev *icd;
+	struct comp_dev *source;
+	struct comp_dev *cd;
+	struct list_item *clist;
+	uint32_t latency_us;
+	uint32_t seq;
+
+	/* copy message with ABI safe method, reply overwrites it */
+	IPC_COPY_CMD(params, ipc->comp_data);
+
+	if (params.flags & SOF_IPC_LATENCY_MARK) {
+		icd = ipc_get_comp_by_ppl_id(ipc, COMP_TYPE_PIPELINE,
+					     params.pipeline_id);
+		if (!icd) {
+			trace_ipc_error("ipc_latency_info(): pipeline %d not found",
+					params.pipeline_id);
+			return -ENODEV;
+		}
+
+		/* markers only travel through buffers of the IPC core */
+		if (!cpu_is_me(icd->core) || !icd->pipeline->source_comp) {
+			trace_ipc_error("ipc_latency_info(): pipeline %d can't be marked",
+					params.pipeline_id);
+			return -EINVAL;
+		}
+
+		/* the next frame produced by the source is marked */
+		if (!++last_seq)
+			last_seq = 1;
+		source = icd->pipeline->source_comp;
+		source->marker_seq = last_seq;
+		source->marker_stamp = platform_timer_get(timer_get());
+		source->marker_arrival = source->marker_stamp;
+		source->marker_pending = true;
+	}
+
+	seq = params.seq ? params.seq : last_seq;
+
+	info->rhdr.hdr.size = sizeof(*info);
+	info->seq = seq;
+	info->total_us = 0;
+	info->num_elems = 0;
+	info->total_elems = 0;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_COMPONENT ||
+		    !cpu_is_me(icd->core) || !seq ||
+		    icd->cd->marker_seq != seq) {
+			platform_shared_commit(icd, sizeof(*icd));
+			continue;
+		}
+
+		cd = icd->cd;
+		latency_us = (cd->marker_arrival - cd->marker_stamp) * 1000 /
+			ticks_per_ms;
+		info->total_us = MAX(info->total_us, latency_us);
+
+		/* report as many components as fit in the reply */
+		if (info->total_elems++ >= params.first_elem &&
+		    info->rhdr.hdr.size + sizeof(*info->elems) <= max_size) {
+			elem = &info->elems[info->num_elems];
+			elem->comp_id = icd->id;
+			elem->pipeline_id = cd->comp.pipeline_id;
+			elem->latency_us = latency_us;
+			elem->delay_frames = cd->delay_frames;
+			info->num_elems++;
+			info->rhdr.hdr.size += sizeof(*info->elems);
+		}
+
+		platform_shared_commit(icd, sizeof(*icd));
+	}
+
+	/* write data to the outbox */
+	info->rhdr.hdr.cmd = header;
+	info->rhdr.error = 0;
+	mailbox_hostbox_write(0, info, info->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+static int ipc_glb_debug_message(uint32_t header)
+{
+	uint32_t cmd = iCS(header);
+
+	trace_ipc("ipc: debug cmd 0x%x", cmd);
+
+	switch (cmd) {
+#if CONFIG_TRACE
+	case SOF_IPC_TRACE_DMA_PARAMS:
+	case SOF_IPC_TRACE_DMA_PARAMS_EXT:
+		return ipc_dma_trace_config(header);
+	case SOF_IPC_TRACE_FILTER_UPDATE:
+		return ipc_trace_filter_update(header);
+#endif
+	case SOF_IPC_TRACE_HEAP_INFO:
+		return ipc_heap_info(header);
+#if CONFIG_PERFORMANCE_COUNTERS
+	case SOF_IPC_TRACE_COMP_PERF_INFO:
+		return ipc_comp_perf_info(header);
+#endif
+	case SOF_IPC_TRACE_LL_STATS:
+		return ipc_ll_stats(header);
+#if CONFIG_IRQ_STATS
+	case SOF_IPC_TRACE_IRQ_STATS:
+		return ipc_irq_stats(header);
+#endif
+	case SOF_IPC_TRACE_STACK_INFO:
+		return ipc_stack_info(header);
+#if CONFIG_DEBUG_LOCK_STATS
+	case SOF_IPC_TRACE_LOCK_STATS:
+		return ipc_lock_stats(header);
+#endif
+#if CONFIG_DEBUG_MEM_OWNER
+	case SOF_IPC_TRACE_MEM_OWNER_INFO:
+		return ipc_mem_owner_info(header);
+#endif
+#if CONFIG_PIPELINE_LATENCY
+	case SOF_IPC_TRACE_LATENCY:
+		return ipc_latency_info(header);
+#endif
+#if CONFIG_IDLE_GOVERNOR
+	case SOF_IPC_TRACE_IDLE_STATS:
+		return ipc_idle_stats(header);
+#endif
+#if CONFIG_SESSION_RECORD
+	case SOF_IPC_TRACE_SESSION:
+		return ipc_session_read(header);
+#endif
+	default:
+		trace_ipc_error("ipc: unknown debug cmd 0x%x", cmd);
+		return -EINVAL;
+	}
+}
+
+static int ipc_glb_gdb_debug(uint32_t header)
+{
+	/* no furher information needs to be extracted form header */
+	(void) header;
+
+#if CONFIG_GDB_DEBUG
+	gdb_init_debug_exception();
+	gdb_init();
+	/* TODO: this asm should be in arch/include/debug/debug.h
+	 * with a generic name and trigger debug exception
+	 */
+	asm volatile("_break 0, 0");
+	return 0;
+#else
+	return -EINVAL;
+#endif
+
+}
+
+#if CONFIG_PROBE
+static inline int ipc_probe_init(uint32_t header)
+{
+	struct sof_ipc_probe_dma_add_params *params = ipc_get()->comp_data;
+	int dma_provided = params->num_elems;
+
+	tracev_ipc("ipc_probe_init()");
+
+	if (dma_provided > 1 || dma_provided < 0) {
+		trace_ipc_error("ipc_probe_init(): Invalid amount of extraction DMAs specified = %d",
+				dma_provided);
+		return -EINVAL;
+	}
+
+	return probe_init(dma_provided ? params->probe_dma : NULL);
+}
+
+static inline int ipc_probe_deinit(uint32_t header)
+{
+	tracev_ipc("ipc_probe_deinit()");
+
+	return probe_deinit();
+}
+
+static inline int ipc_probe_dma_add(uint32_t header)
+{
+	struct sof_ipc_probe_dma_add_params *params = ipc_get()->comp_data;
+	int dmas_count = params->num_elems;
+
+	tracev_ipc("ipc_probe_dma_add()");
+
+	if (dmas_count > CONFIG_PROBE_DMA_MAX) {
 		trace_ipc_error("ipc_probe_dma_add(): Invalid amount of injection DMAs specified = %d. Max is " META_QUOTE(CONFIG_PROBE_DMA_MAX) ".",
 				dmas_count);
 		return -EINVAL;
@@ -905,6 +1778,9 @@ static int ipc_probe_info(uint32_t header)
 	case SOF_IPC_PROBE_POINT_INFO:
 		ret = probe_point_info(params, SOF_IPC_MSG_MAX_SIZE);
 		break;
+	case SOF_IPC_PROBE_POINT_STATS:
+		ret = probe_point_stats(params, SOF_IPC_MSG_MAX_SIZE);
+		break;
 	default:
 		trace_ipc_error("ipc_probe_info(): Invalid probe INFO command = %u",
 				cmd);
@@ -933,61 +1809,274 @@ static int ipc_probe_info(uint32_t header)
 	return ret;
 }
 
-static int ipc_glb_probe(uint32_t header)
-{
-	uint32_t cmd = iCS(header);
+static int ipc_glb_probe(uint32_t header)
+{
+	uint32_t cmd = iCS(header);
+
+	tracev_ipc("ipc: probe cmd 0x%x", cmd);
+
+	switch (cmd) {
+	case SOF_IPC_PROBE_INIT:
+		return ipc_probe_init(header);
+	case SOF_IPC_PROBE_DEINIT:
+		return ipc_probe_deinit(header);
+	case SOF_IPC_PROBE_DMA_ADD:
+		return ipc_probe_dma_add(header);
+	case SOF_IPC_PROBE_DMA_REMOVE:
+		return ipc_probe_dma_remove(header);
+	case SOF_IPC_PROBE_POINT_ADD:
+		return ipc_probe_point_add(header);
+	case SOF_IPC_PROBE_POINT_REMOVE:
+		return ipc_probe_point_remove(header);
+	case SOF_IPC_PROBE_DMA_INFO:
+	case SOF_IPC_PROBE_POINT_INFO:
+	case SOF_IPC_PROBE_POINT_STATS:
+		return ipc_probe_info(header);
+	default:
+		trace_ipc_error("ipc: unknown probe cmd 0x%x", cmd);
+		return -EINVAL;
+	}
+}
+#else
+static inline int ipc_glb_probe(uint32_t header)
+{
+	trace_ipc_error("ipc_glb_probe(): Probes not enabled by Kconfig.");
+
+	return -EINVAL;
+}
+#endif
+
+/*
+ * Topology IPC Operations.
+ */
+
+#if CONFIG_HOST_PTABLE
+/* copies data from the host pages of a host buffer in one DMA transfer */
+static int ipc_host_data_copy(struct ipc *ipc,
+			      struct sof_ipc_host_buffer *buffer,
+			      void *dest, uint32_t size)
+{
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	uint32_t ring_size;
+	int ret;
+
+	bzero(&sg, sizeof(sg));
+
+	ret = ipc_process_host_buffer(ipc, buffer, SOF_IPC_STREAM_PLAYBACK,
+				      &sg.elem_array, &ring_size);
+	if (ret < 0)
+		return ret;
+
+	ret = dma_copy_new(&dc);
+	if (ret < 0)
+		goto sg;
+
+	ret = dma_copy_from_host(&dc, &sg, 0, dest, size);
+	dma_copy_free(&dc);
+	if (ret < 0)
+		goto sg;
+
+	dcache_invalidate_region(dest, size);
+
+sg:
+	dma_sg_free(&sg.elem_array);
+
+	return ret;
+}
+
+/* copies data to the host pages of a host buffer in one DMA transfer */
+static int ipc_host_data_write(struct ipc *ipc,
+			       struct sof_ipc_host_buffer *buffer,
+			       void *src, uint32_t size)
+{
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	uint32_t ring_size;
+	int ret;
+
+	bzero(&sg, sizeof(sg));
+
+	ret = ipc_process_host_buffer(ipc, buffer, SOF_IPC_STREAM_CAPTURE,
+				      &sg.elem_array, &ring_size);
+	if (ret < 0)
+		return ret;
+
+	ret = dma_copy_new(&dc);
+	if (ret < 0)
+		goto sg;
+
+	dcache_writeback_region(src, size);
+
+	ret = dma_copy_to_host(&dc, &sg, 0, src, size);
+	dma_copy_free(&dc);
+
+sg:
+	dma_sg_free(&sg.elem_array);
+
+	return ret;
+}
+
+/* Copies a whole binary control blob from host pages in one DMA transfer
+ * and passes it to the component as a single fragment, instead of the
+ * host sending it in mailbox sized fragments with an IPC each.
+ */
+static int ipc_comp_set_data_dma(struct ipc *ipc, struct comp_dev *cd,
+				 struct sof_ipc_ctrl_data *data)
+{
+	struct sof_ipc_ctrl_data *cdata;
+	uint32_t size = sizeof(struct sof_abi_hdr) + data->num_elems;
+	int ret;
+
+	trace_ipc("ipc: comp %d blob of %u bytes", data->comp_id,
+		  data->num_elems);
+
+	if (data->msg_index || data->elems_remaining ||
+	    size < data->num_elems || size > data->buffer.size) {
+		trace_ipc_error("ipc: comp %d blob size %u is invalid",
+				data->comp_id, data->num_elems);
+		return -EINVAL;
+	}
+
+	cdata = rballoc(0, SOF_MEM_CAPS_RAM, sizeof(*cdata) + size);
+	if (!cdata)
+		return -ENOMEM;
+
+	ret = memcpy_s(cdata, sizeof(*cdata), data, sizeof(*data));
+	assert(!ret);
+
+	ret = ipc_host_data_copy(ipc, &data->buffer, cdata->data, size);
+	if (ret < 0) {
+		trace_ipc_error("ipc: comp %d blob copy failed %d",
+				data->comp_id, ret);
+		goto out;
+	}
+
+	if (cdata->data->size != data->num_elems) {
+		trace_ipc_error("ipc: comp %d blob header size %u is invalid",
+				data->comp_id, cdata->data->size);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	cdata->rhdr.hdr.size = sizeof(*cdata) + size;
+	ret = comp_cmd(cd, COMP_CMD_SET_DATA, cdata, sizeof(*cdata) + size);
+
+out:
+	rfree(cdata);
+
+	return ret;
+}
+
+/* Gets a whole binary control blob from the component as a single fragment
+ * and copies it to host pages in one DMA transfer, instead of the host
+ * reading it in mailbox sized fragments with an IPC each. The reply is the
+ * message header with num_elems set to the payload bytes copied.
+ */
+static int ipc_comp_get_data_dma(struct ipc *ipc, struct comp_dev *cd,
+				 struct sof_ipc_ctrl_data *data)
+{
+	struct sof_ipc_ctrl_data *cdata;
+	struct sof_ipc_ctrl_data *_data;
+	uint32_t size = sizeof(struct sof_abi_hdr) + data->num_elems;
+	int ret;
+
+	trace_ipc("ipc: comp %d blob read of %u bytes", data->comp_id,
+		  data->num_elems);
+
+	if (data->msg_index || size < data->num_elems ||
+	    size > data->buffer.size) {
+		trace_ipc_error("ipc: comp %d blob size %u is invalid",
+				data->comp_id, data->num_elems);
+		return -EINVAL;
+	}
+
+	cdata = rballoc(0, SOF_MEM_CAPS_RAM, sizeof(*cdata) + size);
+	if (!cdata)
+		return -ENOMEM;
+
+	ret = memcpy_s(cdata, sizeof(*cdata), data, sizeof(*data));
+	assert(!ret);
+
+	/* ABI header of the request selects the blob, like the type of
+	 * detector data
+	 */
+	_data = ipc->comp_data;
+	ret = memcpy_s(cdata->data, size, _data->data,
+		       sizeof(struct sof_abi_hdr));
+	assert(!ret);
+
+	cdata->elems_remaining = 0;
+
+	ret = comp_cmd(cd, COMP_CMD_GET_DATA, cdata, sizeof(*cdata) + size);
+	if (ret < 0)
+		goto out;
 
-	tracev_ipc("ipc: probe cmd 0x%x", cmd);
+	/* blobs shorter than asked for end at their size */
+	cdata->num_elems = MIN(cdata->data->size, data->num_elems);
+	size = sizeof(struct sof_abi_hdr) + cdata->num_elems;
 
-	switch (cmd) {
-	case SOF_IPC_PROBE_INIT:
-		return ipc_probe_init(header);
-	case SOF_IPC_PROBE_DEINIT:
-		return ipc_probe_deinit(header);
-	case SOF_IPC_PROBE_DMA_ADD:
-		return ipc_probe_dma_add(header);
-	case SOF_IPC_PROBE_DMA_REMOVE:
-		return ipc_probe_dma_remove(header);
-	case SOF_IPC_PROBE_POINT_ADD:
-		return ipc_probe_point_add(header);
-	case SOF_IPC_PROBE_POINT_REMOVE:
-		return ipc_probe_point_remove(header);
-	case SOF_IPC_PROBE_DMA_INFO:
-	case SOF_IPC_PROBE_POINT_INFO:
-		return ipc_probe_info(header);
-	default:
-		trace_ipc_error("ipc: unknown probe cmd 0x%x", cmd);
-		return -EINVAL;
+	ret = ipc_host_data_write(ipc, &data->buffer, cdata->data, size);
+	if (ret < 0) {
+		trace_ipc_error("ipc: comp %d blob copy failed %d",
+				data->comp_id, ret);
+		goto out;
 	}
+
+	cdata->rhdr.hdr.size = sizeof(*cdata);
+	ret = memcpy_s(_data, SOF_IPC_MSG_MAX_SIZE, cdata, sizeof(*cdata));
+	assert(!ret);
+
+out:
+	rfree(cdata);
+
+	return ret;
 }
 #else
-static inline int ipc_glb_probe(uint32_t header)
+static int ipc_host_data_copy(struct ipc *ipc,
+			      struct sof_ipc_host_buffer *buffer,
+			      void *dest, uint32_t size)
 {
-	trace_ipc_error("ipc_glb_probe(): Probes not enabled by Kconfig.");
+	return -ENOTSUP;
+}
 
-	return -EINVAL;
+static int ipc_comp_set_data_dma(struct ipc *ipc, struct comp_dev *cd,
+				 struct sof_ipc_ctrl_data *data)
+{
+	return -ENOTSUP;
 }
-#endif
 
-/*
- * Topology IPC Operations.
- */
+static int ipc_comp_get_data_dma(struct ipc *ipc, struct comp_dev *cd,
+				 struct sof_ipc_ctrl_data *data)
+{
+	return -ENOTSUP;
+}
+#endif
 
 /* get/set component values or runtime data */
 static int ipc_comp_value(uint32_t header, uint32_t cmd)
 {
 	struct ipc *ipc = ipc_get();
 	struct ipc_comp_dev *comp_dev;
-	struct sof_ipc_ctrl_data data, *_data = ipc->comp_data;
+	struct sof_ipc_ctrl_data *_data = ipc->comp_data;
+	const struct sof_ipc_ctrl_data *data;
+	uint32_t comp_id;
+	uint32_t ctrl_cmd;
+	uint32_t size;
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(data, ipc->comp_data);
+	/* validate message with ABI safe method */
+	data = IPC_VIEW_CMD(struct sof_ipc_ctrl_data, ipc->comp_data);
+
+	/* the component writes its reply over the message */
+	comp_id = data->comp_id;
+	ctrl_cmd = data->cmd;
+	size = data->rhdr.hdr.size;
 
 	/* get the component */
-	comp_dev = ipc_get_comp_by_id(ipc, data.comp_id);
+	comp_dev = ipc_get_comp_by_id(ipc, comp_id);
 	if (!comp_dev) {
-		trace_ipc_error("ipc: comp %d not found", data.comp_id);
+		trace_ipc_error("ipc: comp %d not found", comp_id);
 		return -ENODEV;
 	}
 
@@ -995,13 +2084,18 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 	if (!cpu_is_me(comp_dev->core))
 		return ipc_process_on_core(comp_dev->core);
 
-	trace_ipc("ipc: comp %d -> cmd %d", data.comp_id, data.cmd);
+	trace_ipc("ipc: comp %d -> cmd %d", comp_id, ctrl_cmd);
 
-	/* get component values */
-	ret = comp_cmd(comp_dev->cd, cmd, _data, SOF_IPC_MSG_MAX_SIZE);
+	/* get component values, large blobs are sent in host pages */
+	if (cmd == COMP_CMD_SET_DATA && data->buffer.size)
+		ret = ipc_comp_set_data_dma(ipc, comp_dev->cd, _data);
+	else if (cmd == COMP_CMD_GET_DATA && data->buffer.size)
+		ret = ipc_comp_get_data_dma(ipc, comp_dev->cd, _data);
+	else
+		ret = comp_cmd(comp_dev->cd, cmd, _data, SOF_IPC_MSG_MAX_SIZE);
 	if (ret < 0) {
-		trace_ipc_error("ipc: comp %d cmd %u failed %d", data.comp_id,
-				data.cmd, ret);
+		trace_ipc_error("ipc: comp %d cmd %u failed %d", comp_id,
+				ctrl_cmd, ret);
 		return ret;
 	}
 
@@ -1010,11 +2104,11 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 	/* write component values to the outbox */
 	if (_data->rhdr.hdr.size <= MAILBOX_HOSTBOX_SIZE &&
 	    _data->rhdr.hdr.size <= SOF_IPC_MSG_MAX_SIZE) {
-		mailbox_hostbox_write(0, _data, data.rhdr.hdr.size);
+		mailbox_hostbox_write(0, _data, size);
 		ret = 1;
 	} else {
 		trace_ipc_error("ipc: comp %d cmd %u returned %d bytes max %d",
-				data.comp_id, data.cmd, _data->rhdr.hdr.size,
+				comp_id, ctrl_cmd, _data->rhdr.hdr.size,
 				MIN(MAILBOX_HOSTBOX_SIZE,
 				    SOF_IPC_MSG_MAX_SIZE));
 		ret = -EINVAL;
@@ -1023,6 +2117,144 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 	return ret;
 }
 
+/* returns the core of the components updated by a batch, checking them all */
+static int ipc_comp_batch_check(struct ipc *ipc,
+				struct sof_ipc_ctrl_batch *batch,
+				uint8_t *elems)
+{
+	struct sof_ipc_ctrl_data *elem;
+	struct ipc_comp_dev *icd;
+	uint32_t offset = 0;
+	int core = -EINVAL;
+	uint32_t i;
+
+	for (i = 0; i < batch->num_elems; i++) {
+		elem = (struct sof_ipc_ctrl_data *)(elems + offset);
+		if (offset + sizeof(*elem) > batch->size ||
+		    elem->rhdr.hdr.size < sizeof(*elem) ||
+		    elem->rhdr.hdr.size > batch->size - offset ||
+		    elem->buffer.size || elem->msg_index ||
+		    elem->elems_remaining ||
+		    (elem->type != SOF_CTRL_TYPE_VALUE_CHAN_SET &&
+		     elem->type != SOF_CTRL_TYPE_VALUE_COMP_SET &&
+		     elem->type != SOF_CTRL_TYPE_DATA_SET)) {
+			trace_ipc_error("ipc: batch update %u is invalid", i);
+			return -EINVAL;
+		}
+
+		icd = ipc_get_comp_by_id(ipc, elem->comp_id);
+		if (!icd || icd->type != COMP_TYPE_COMPONENT) {
+			trace_ipc_error("ipc: batch comp %d not found",
+					elem->comp_id);
+			return -ENODEV;
+		}
+
+		/* one IPC is processed on one core */
+		if (i && icd->core != core) {
+			trace_ipc_error("ipc: batch comp %d is on core %d",
+					elem->comp_id, icd->core);
+			platform_shared_commit(icd, sizeof(*icd));
+			return -EINVAL;
+		}
+
+		core = icd->core;
+		platform_shared_commit(icd, sizeof(*icd));
+
+		offset += ALIGN_UP(elem->rhdr.hdr.size, 4);
+	}
+
+	return core;
+}
+
+/* Applies the control updates of a batch. The LL scheduler of the core
+ * doesn't run until all of them have been applied, so they all take effect
+ * in the same period. All updates are checked first, one rejected by its
+ * component leaves the ones before it applied.
+ */
+static int ipc_comp_batch(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_ctrl_batch batch;
+	struct sof_ipc_ctrl_data *elem;
+	struct ipc_comp_dev *icd;
+	uint8_t *elems;
+	uint32_t offset = 0;
+	uint32_t flags;
+	uint32_t i;
+	int core;
+	int ret = 0;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(batch, ipc->comp_data);
+
+	if (!batch.num_elems)
+		return 0;
+
+	trace_ipc("ipc: batch of %u updates, %u bytes", batch.num_elems,
+		  batch.size);
+
+	/* large batches are copied from host pages */
+	if (batch.buffer.size) {
+		if (batch.size > batch.buffer.size)
+			return -EINVAL;
+
+		elems = rballoc(0, SOF_MEM_CAPS_RAM, batch.size);
+		if (!elems)
+			return -ENOMEM;
+
+		ret = ipc_host_data_copy(ipc, &batch.buffer, elems,
+					 batch.size);
+		if (ret < 0) {
+			trace_ipc_error("ipc: batch copy failed %d", ret);
+			goto out;
+		}
+	} else {
+		if (sizeof(batch) + batch.size > batch.hdr.size)
+			return -EINVAL;
+
+		elems = (uint8_t *)ipc->comp_data + sizeof(batch);
+	}
+
+	core = ipc_comp_batch_check(ipc, &batch, elems);
+	if (core < 0) {
+		ret = core;
+		goto out;
+	}
+
+	if (!cpu_is_me(core)) {
+		ret = ipc_process_on_core(core);
+		goto out;
+	}
+
+	irq_local_disable(flags);
+
+	for (i = 0; i < batch.num_elems; i++) {
+		elem = (struct sof_ipc_ctrl_data *)(elems + offset);
+		icd = ipc_get_comp_by_id(ipc, elem->comp_id);
+
+		ret = comp_cmd(icd->cd, elem->type == SOF_CTRL_TYPE_DATA_SET ?
+			       COMP_CMD_SET_DATA : COMP_CMD_SET_VALUE,
+			       elem, elem->rhdr.hdr.size);
+		platform_shared_commit(icd, sizeof(*icd));
+		if (ret < 0)
+			break;
+
+		offset += ALIGN_UP(elem->rhdr.hdr.size, 4);
+	}
+
+	irq_local_enable(flags);
+
+	if (ret < 0)
+		trace_ipc_error("ipc: batch comp %d update %u failed %d",
+				elem->comp_id, i, ret);
+
+out:
+	if (batch.buffer.size)
+		rfree(elems);
+
+	return ret;
+}
+
 static int ipc_glb_comp_message(uint32_t header)
 {
 	uint32_t cmd = iCS(header);
@@ -1036,16 +2268,18 @@ static int ipc_glb_comp_message(uint32_t header)
 		return ipc_comp_value(header, COMP_CMD_SET_DATA);
 	case SOF_IPC_COMP_GET_DATA:
 		return ipc_comp_value(header, COMP_CMD_GET_DATA);
+	case SOF_IPC_COMP_SET_BATCH:
+		return ipc_comp_batch(header);
 	default:
 		trace_ipc_error("ipc: unknown comp cmd 0x%x", cmd);
 		return -EINVAL;
 	}
 }
 
-static int ipc_glb_tplg_comp_new(uint32_t header)
+static int __cold_text ipc_glb_tplg_comp_new(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_comp comp;
+	struct sof_ipc_comp *comp = ipc->comp_data;
 	struct sof_ipc_comp_reply reply = {
 		.rhdr.hdr = {
 			.cmd = header,
@@ -1054,21 +2288,26 @@ static int ipc_glb_tplg_comp_new(uint32_t header)
 	};
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(comp, ipc->comp_data);
+	/* validate message with ABI safe method, core is updated in it */
+	ipc_cmd_view(&comp->hdr, sizeof(*comp));
+
+	/* core left to the firmware is resolved for the core creating it */
+	comp->core = ipc_placement_core(ipc, comp->pipeline_id, comp->core,
+					-1);
+	reply.core = comp->core;
 
 	/* check core */
-	if (!cpu_is_me(comp.core))
-		return ipc_process_on_core(comp.core);
+	if (!cpu_is_me(comp->core))
+		return ipc_process_on_core(comp->core);
 
-	trace_ipc("ipc: pipe %d comp %d -> new (type %d)", comp.pipeline_id,
-		  comp.id, comp.type);
+	trace_ipc("ipc: pipe %d comp %d -> new (type %d)", comp->pipeline_id,
+		  comp->id, comp->type);
 
 	/* register component */
-	ret = ipc_comp_new(ipc, (struct sof_ipc_comp *)ipc->comp_data);
+	ret = ipc_comp_new(ipc, comp);
 	if (ret < 0) {
 		trace_ipc_error("ipc: pipe %d comp %d creation failed %d",
-				comp.pipeline_id, comp.id, ret);
+				comp->pipeline_id, comp->id, ret);
 		return ret;
 	}
 
@@ -1078,7 +2317,7 @@ static int ipc_glb_tplg_comp_new(uint32_t header)
 	return 1;
 }
 
-static int ipc_glb_tplg_buffer_new(uint32_t header)
+static int __cold_text ipc_glb_tplg_buffer_new(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
 	struct sof_ipc_buffer ipc_buffer;
@@ -1093,6 +2332,13 @@ static int ipc_glb_tplg_buffer_new(uint32_t header)
 	/* copy message with ABI safe method */
 	IPC_COPY_CMD(ipc_buffer, ipc->comp_data);
 
+	ipc_buffer.comp.core = ipc_placement_core(ipc,
+						  ipc_buffer.comp.pipeline_id,
+						  ipc_buffer.comp.core, -1);
+	((struct sof_ipc_buffer *)ipc->comp_data)->comp.core =
+		ipc_buffer.comp.core;
+	reply.core = ipc_buffer.comp.core;
+
 	/* check core */
 	if (!cpu_is_me(ipc_buffer.comp.core))
 		return ipc_process_on_core(ipc_buffer.comp.core);
@@ -1101,7 +2347,7 @@ static int ipc_glb_tplg_buffer_new(uint32_t header)
 		  ipc_buffer.comp.pipeline_id, ipc_buffer.comp.id,
 		  ipc_buffer.size);
 
-	ret = ipc_buffer_new(ipc, (struct sof_ipc_buffer *)ipc->comp_data);
+	ret = ipc_buffer_new(ipc, &ipc_buffer);
 	if (ret < 0) {
 		trace_ipc_error("ipc: pipe %d buffer %d creation failed %d",
 				ipc_buffer.comp.pipeline_id,
@@ -1115,10 +2361,11 @@ static int ipc_glb_tplg_buffer_new(uint32_t header)
 	return 1;
 }
 
-static int ipc_glb_tplg_pipe_new(uint32_t header)
+static int __cold_text ipc_glb_tplg_pipe_new(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
 	struct sof_ipc_pipe_new ipc_pipeline;
+	struct ipc_comp_dev *icd;
 	struct sof_ipc_comp_reply reply = {
 		.rhdr.hdr = {
 			.cmd = header,
@@ -1130,14 +2377,22 @@ static int ipc_glb_tplg_pipe_new(uint32_t header)
 	/* copy message with ABI safe method */
 	IPC_COPY_CMD(ipc_pipeline, ipc->comp_data);
 
+	/* pipeline without objects yet runs where it's scheduled */
+	icd = ipc_get_comp_by_id(ipc, ipc_pipeline.sched_id);
+	ipc_pipeline.core = ipc_placement_core(ipc, ipc_pipeline.pipeline_id,
+					       ipc_pipeline.core,
+					       icd ? icd->core : -1);
+	((struct sof_ipc_pipe_new *)ipc->comp_data)->core = ipc_pipeline.core;
+	reply.core = ipc_pipeline.core;
+
 	/* check core */
 	if (!cpu_is_me(ipc_pipeline.core))
 		return ipc_process_on_core(ipc_pipeline.core);
 
 	trace_ipc("ipc: pipe %d -> new", ipc_pipeline.pipeline_id);
 
-	ret = ipc_pipeline_new(ipc,
-			       (struct sof_ipc_pipe_new *)ipc->comp_data);
+	/* ABI safe copy has fields unknown to the host zeroed */
+	ret = ipc_pipeline_new(ipc, &ipc_pipeline);
 	if (ret < 0) {
 		trace_ipc_error("ipc: pipe %d creation failed %d",
 				ipc_pipeline.pipeline_id, ret);
@@ -1150,7 +2405,7 @@ static int ipc_glb_tplg_pipe_new(uint32_t header)
 	return 1;
 }
 
-static int ipc_glb_tplg_pipe_complete(uint32_t header)
+static int __cold_text ipc_glb_tplg_pipe_complete(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
 	struct sof_ipc_pipe_ready ipc_pipeline;
@@ -1161,7 +2416,7 @@ static int ipc_glb_tplg_pipe_complete(uint32_t header)
 	return ipc_pipeline_complete(ipc, ipc_pipeline.comp_id);
 }
 
-static int ipc_glb_tplg_comp_connect(uint32_t header)
+static int __cold_text ipc_glb_tplg_comp_connect(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
 	struct sof_ipc_pipe_comp_connect connect;
@@ -1173,7 +2428,7 @@ static int ipc_glb_tplg_comp_connect(uint32_t header)
 			(struct sof_ipc_pipe_comp_connect *)ipc->comp_data);
 }
 
-static int ipc_glb_tplg_free(uint32_t header,
+static int __cold_text ipc_glb_tplg_free(uint32_t header,
 		int (*free_func)(struct ipc *ipc, uint32_t id))
 {
 	struct ipc *ipc = ipc_get();
@@ -1196,7 +2451,151 @@ static int ipc_glb_tplg_free(uint32_t header,
 	return ret;
 }
 
-static int ipc_glb_tplg_message(uint32_t header)
+#if CONFIG_HOST_PTABLE
+/* Copies a pre-linked topology image from host pages in one DMA transfer
+ * and instantiates its records without a round trip per object.
+ */
+static int __cold_text ipc_glb_tplg_image_load(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_tplg_image image;
+	struct sof_ipc_tplg_image_reply reply = {
+		.rhdr.hdr = {
+			.cmd = header,
+			.size = sizeof(reply),
+		},
+	};
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	uint32_t ring_size;
+	uint32_t count = 0;
+	char *data;
+	int ret;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(image, ipc->comp_data);
+
+	trace_ipc("ipc: tplg image of %u bytes", image.size);
+
+	if (image.size < sizeof(struct sof_tplg_image_hdr) ||
+	    image.size > image.buffer.size) {
+		trace_ipc_error("ipc: tplg image size %u is invalid",
+				image.size);
+		return -EINVAL;
+	}
+
+	data = rballoc(0, SOF_MEM_CAPS_RAM, image.size);
+	if (!data)
+		return -ENOMEM;
+
+	bzero(&sg, sizeof(sg));
+
+	ret = ipc_process_host_buffer(ipc, &image.buffer,
+				      SOF_IPC_STREAM_PLAYBACK,
+				      &sg.elem_array, &ring_size);
+	if (ret < 0)
+		goto out;
+
+	ret = dma_copy_new(&dc);
+	if (ret < 0)
+		goto sg;
+
+	ret = dma_copy_from_host(&dc, &sg, 0, data, image.size);
+	dma_copy_free(&dc);
+	if (ret < 0) {
+		trace_ipc_error("ipc: tplg image copy failed %d", ret);
+		goto sg;
+	}
+
+	dcache_invalidate_region(data, image.size);
+
+	ret = ipc_tplg_image_new(ipc, data, image.size, &count);
+
+sg:
+	dma_sg_free(&sg.elem_array);
+out:
+	rfree(data);
+
+	reply.rhdr.error = ret < 0 ? ret : 0;
+	reply.count = count;
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+
+	return 1;
+}
+#else
+static int __cold_text ipc_glb_tplg_image_load(uint32_t header)
+{
+	return -ENOTSUP;
+}
+#endif
+
+#if CONFIG_COMP_LIB_LOAD
+/* Copies a component library from host pages and registers its drivers,
+ * sent by the host before the first component using them.
+ */
+static int __cold_text ipc_glb_tplg_lib_load(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_comp_lib lib;
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	uint32_t ring_size;
+	char *data;
+	int ret;
+
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(lib, ipc->comp_data);
+
+	trace_ipc("ipc: comp lib of %u bytes", lib.size);
+
+	if (lib.size < sizeof(struct sof_comp_lib_hdr) ||
+	    lib.size > lib.buffer.size) {
+		trace_ipc_error("ipc: comp lib size %u is invalid", lib.size);
+		return -EINVAL;
+	}
+
+	data = rballoc(0, SOF_MEM_CAPS_RAM, lib.size);
+	if (!data)
+		return -ENOMEM;
+
+	bzero(&sg, sizeof(sg));
+
+	ret = ipc_process_host_buffer(ipc, &lib.buffer,
+				      SOF_IPC_STREAM_PLAYBACK,
+				      &sg.elem_array, &ring_size);
+	if (ret < 0)
+		goto out;
+
+	ret = dma_copy_new(&dc);
+	if (ret < 0)
+		goto sg;
+
+	ret = dma_copy_from_host(&dc, &sg, 0, data, lib.size);
+	dma_copy_free(&dc);
+	if (ret < 0) {
+		trace_ipc_error("ipc: comp lib copy failed %d", ret);
+		goto sg;
+	}
+
+	dcache_invalidate_region(data, lib.size);
+
+	ret = comp_lib_load(data, lib.size);
+
+sg:
+	dma_sg_free(&sg.elem_array);
+out:
+	rfree(data);
+
+	return ret;
+}
+#else
+static int __cold_text ipc_glb_tplg_lib_load(uint32_t header)
+{
+	return -ENOTSUP;
+}
+#endif
+
+static int __cold_text ipc_glb_tplg_message(uint32_t header)
 {
 	uint32_t cmd = iCS(header);
 
@@ -1217,6 +2616,10 @@ static int ipc_glb_tplg_message(uint32_t header)
 		return ipc_glb_tplg_buffer_new(header);
 	case SOF_IPC_TPLG_BUFFER_FREE:
 		return ipc_glb_tplg_free(header, ipc_buffer_free);
+	case SOF_IPC_TPLG_IMAGE_LOAD:
+		return ipc_glb_tplg_image_load(header);
+	case SOF_IPC_TPLG_LIB_LOAD:
+		return ipc_glb_tplg_lib_load(header);
 	default:
 		trace_ipc_error("ipc: unknown tplg header 0x%x", header);
 		return -EINVAL;
@@ -1242,26 +2645,110 @@ static int ipc_glb_test_message(uint32_t header)
  * Global IPC Operations.
  */
 
-void ipc_cmd(struct sof_ipc_cmd_hdr *hdr)
+static int ipc_glb_cmd(struct sof_ipc_cmd_hdr *hdr);
+
+/*
+ * Compound IPC Operations.
+ */
+
+static int ipc_glb_compound(struct sof_ipc_cmd_hdr *hdr)
 {
-	struct sof_ipc_reply reply;
-	uint32_t type = 0;
-	int ret;
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_compound_hdr compound;
+	struct sof_ipc_compound_reply reply = {
+		.rhdr.hdr = {
+			.cmd = SOF_IPC_GLB_REPLY,
+			.size = sizeof(reply),
+		},
+	};
+	struct sof_ipc_reply cmd_reply;
+	struct sof_ipc_cmd_hdr *cmd;
+	uint32_t size = hdr->size - sizeof(compound);
+	uint32_t offset = 0;
+	char *data = NULL;
+	int ret = 0;
+	int err;
 
-	if (!hdr) {
-		trace_ipc_error("ipc: invalid IPC header.");
-		ret = -EINVAL;
+	/* copy message with ABI safe method */
+	IPC_COPY_CMD(compound, ipc->comp_data);
+
+	trace_ipc("ipc: compound of %u commands, %u bytes", compound.count,
+		  size);
+
+	if (!compound.count)
+		goto out;
+
+	/* command replies are written over the host mailbox */
+	data = rballoc(0, SOF_MEM_CAPS_RAM, size);
+	if (!data) {
+		ret = -ENOMEM;
 		goto out;
 	}
 
-	type = iGS(hdr->cmd);
+	mailbox_hostbox_read(data, size, sizeof(compound), size);
+
+	for (; reply.count < compound.count; reply.count++) {
+		cmd = (struct sof_ipc_cmd_hdr *)(data + offset);
+
+		if (size - offset < sizeof(*cmd) ||
+		    cmd->size < sizeof(*cmd) ||
+		    cmd->size > SOF_IPC_MSG_MAX_SIZE ||
+		    cmd->size > size - offset ||
+		    iGS(cmd->cmd) == SOF_IPC_GLB_COMPOUND) {
+			trace_ipc_error("ipc: compound command %u is invalid",
+					reply.count);
+			ret = -EINVAL;
+			break;
+		}
+
+		/* commands are handled from the IPC data like single ones */
+		err = memcpy_s(ipc->comp_data, SOF_IPC_MSG_MAX_SIZE, cmd,
+			       cmd->size);
+		assert(!err);
+		platform_shared_commit(ipc->comp_data, cmd->size);
+
+		ret = ipc_glb_cmd(ipc->comp_data);
+
+		/* reply created by the command or by another core */
+		if (ret > 0) {
+			mailbox_hostbox_read(&cmd_reply, sizeof(cmd_reply), 0,
+					     sizeof(cmd_reply));
+			ret = cmd_reply.error;
+		}
+
+		if (ret < 0) {
+			trace_ipc_error("ipc: compound command %u failed %d",
+					reply.count, ret);
+			break;
+		}
+
+		offset += cmd->size;
+	}
+
+	rfree(data);
+
+out:
+	reply.rhdr.error = ret < 0 ? ret : 0;
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+
+	return 1;
+}
+
+static int ipc_glb_cmd(struct sof_ipc_cmd_hdr *hdr)
+{
+	uint32_t type = iGS(hdr->cmd);
+	int ret;
+
+#if CONFIG_SESSION_RECORD
+	session_record_ipc(hdr);
+#endif
 
 	switch (type) {
 	case SOF_IPC_GLB_REPLY:
 		ret = 0;
 		break;
 	case SOF_IPC_GLB_COMPOUND:
-		ret = -EINVAL;	/* TODO */
+		ret = ipc_glb_compound(hdr);
 		break;
 	case SOF_IPC_GLB_TPLG_MSG:
 		ret = ipc_glb_tplg_message(hdr->cmd);
@@ -1298,6 +2785,28 @@ void ipc_cmd(struct sof_ipc_cmd_hdr *hdr)
 		break;
 	}
 
+	return ret;
+}
+
+int ipc_cmd(struct sof_ipc_cmd_hdr *hdr)
+{
+	struct sof_ipc_reply reply;
+	uint32_t type = 0;
+	int ret;
+
+	if (!hdr) {
+		trace_ipc_error("ipc: invalid IPC header.");
+		ret = -EINVAL;
+		goto out;
+	}
+
+	type = iGS(hdr->cmd);
+
+	trace_timeline_begin(TRACE_CLASS_IPC, 0, -1, -1, "ipc cmd 0x%x",
+			     hdr->cmd);
+	ret = ipc_glb_cmd(hdr);
+	trace_timeline_end(TRACE_CLASS_IPC, 0, -1, -1, "ipc cmd");
+
 	platform_shared_commit(hdr, hdr->size);
 
 out:
@@ -1312,6 +2821,68 @@ out:
 		reply.hdr.size = sizeof(reply);
 		mailbox_hostbox_write(0, &reply, sizeof(reply));
 	}
+
+	return ret < 0 ? ret : 0;
+}
+
+/* component the stream or control command in comp_data is sent to */
+static struct ipc_comp_dev *ipc_fast_cmd_comp(struct ipc *ipc, uint32_t cmd)
+{
+	struct sof_ipc_stream *stream = ipc->comp_data;
+	struct sof_ipc_ctrl_data *data = ipc->comp_data;
+	struct ipc_comp_dev *icd;
+
+	switch (iGS(cmd)) {
+	case SOF_IPC_GLB_STREAM_MSG:
+		switch (iCS(cmd)) {
+		case SOF_IPC_STREAM_TRIG_START:
+		case SOF_IPC_STREAM_TRIG_STOP:
+		case SOF_IPC_STREAM_TRIG_PAUSE:
+		case SOF_IPC_STREAM_TRIG_RELEASE:
+		case SOF_IPC_STREAM_POSITION:
+			return ipc_get_comp_by_id(ipc, stream->comp_id);
+		default:
+			return NULL;
+		}
+	case SOF_IPC_GLB_COMP_MSG:
+		if (iCS(cmd) != SOF_IPC_COMP_SET_VALUE)
+			return NULL;
+
+		/* volume updates only, other controls may be heavy */
+		icd = ipc_get_comp_by_id(ipc, data->comp_id);
+		if (icd && (icd->type != COMP_TYPE_COMPONENT ||
+			    dev_comp_type(icd->cd) != SOF_COMP_VOLUME))
+			icd = NULL;
+
+		return icd;
+	default:
+		return NULL;
+	}
+}
+
+bool ipc_cmd_fast(void)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_cmd_hdr *hdr;
+	struct ipc_comp_dev *icd;
+	bool fast;
+
+	hdr = mailbox_validate();
+	if (!hdr)
+		return false;
+
+	/* commands for other cores need the blocking IDC */
+	icd = ipc_fast_cmd_comp(ipc, hdr->cmd);
+	fast = icd && cpu_is_me(icd->core);
+	if (icd)
+		platform_shared_commit(icd, sizeof(*icd));
+
+	if (fast)
+		ipc_cmd(hdr);
+	else
+		platform_shared_commit(hdr, hdr->size);
+
+	return fast;
 }
 
 void ipc_msg_send(struct ipc_msg *msg, void *data, bool high_priority)
@@ -1330,12 +2901,14 @@ void ipc_msg_send(struct ipc_msg *msg, void *data, bool high_priority)
 
 	/* try to send critical notifications right away */
 	if (high_priority) {
-		ret = ipc_platform_send_msg(msg);
+		ret = ipc_msg_tx(ipc, msg);
 		if (!ret)
 			goto out;
 	}
 
-	/* add to queue unless already there */
+	/* add to queue unless already there, a queued message was just
+	 * updated in place so the host only gets the latest payload
+	 */
 	if (list_is_empty(&msg->list)) {
 		if (high_priority)
 			list_item_prepend(&msg->list, &ipc->msg_list);
@@ -102,6 +102,7 @@ static int ipc_get_page_descriptors(struct dma *dmac, uint8_t *page_table,
 	config.dest_width = sizeof(uint32_t);
 	config.cyclic = 0;
 	config.irq_disabled = false;
+	config.dmac_config = 0;
 	dma_sg_init(&config.elem_array);
 
 	/* set up DMA descriptor */
@@ -8,21 +8,29 @@
 #include <sof/audio/buffer.h>
 #include <sof/audio/component_ext.h>
 #include <sof/audio/pipeline.h>
+#include <sof/bit.h>
 #include <sof/common.h>
 #include <sof/drivers/idc.h>
 #include <sof/drivers/ipc.h>
+#include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
+#include <sof/lib/clk.h>
 #include <sof/lib/cpu.h>
-#include <sof/lib/mailbox.h>
+#include <sof/lib/mm_heap.h>
+#include <sof/lib/uuid.h>
 #include <sof/list.h>
+#include <sof/math/numbers.h>
 #include <sof/platform.h>
+#include <sof/schedule/ll_schedule.h>
+#include <sof/schedule/schedule.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
 #include <ipc/dai.h>
 #include <ipc/header.h>
 #include <ipc/stream.h>
 #include <ipc/topology.h>
+#include <kernel/abi.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -36,17 +44,44 @@
 #define ipc_get_ppl_sink_comp(ipc, ppl_id) \
 	ipc_get_ppl_comp(ipc, ppl_id, PPL_DIR_DOWNSTREAM)
 
+int ipc_process_on_cores(uint32_t core_mask)
+{
+	struct idc_msg msg = { .header = IDC_MSG_IPC, };
+	uint32_t queued = 0;
+	int ret = 0;
+	int err;
+	int i;
+
+	/* queue IDC messages, so the cores process the IPC together */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (!(core_mask & BIT(i)))
+			continue;
+
+		/* check if requested core is enabled */
+		if (!cpu_is_core_enabled(i)) {
+			ret = -EINVAL;
+			break;
+		}
+
+		msg.core = i;
+		ret = idc_send_msg(&msg, IDC_ASYNC);
+		if (ret < 0)
+			break;
+
+		queued |= BIT(i);
+	}
+
+	/* the IPC may be still read by cores it was queued to */
+	err = idc_wait_async(queued);
+
+	return ret < 0 ? ret : err;
+}
+
 int ipc_process_on_core(uint32_t core)
 {
-	struct idc_msg msg = { .header = IDC_MSG_IPC, .core = core, };
 	int ret;
 
-	/* check if requested core is enabled */
-	if (!cpu_is_core_enabled(core))
-		return -EINVAL;
-
-	/* send IDC message */
-	ret = idc_send_msg(&msg, IDC_BLOCKING);
+	ret = ipc_process_on_cores(BIT(core));
 	if (ret < 0)
 		return ret;
 
@@ -56,17 +91,63 @@ int ipc_process_on_core(uint32_t core)
 
 /*
  * Components, buffers and pipelines all use the same set of monotonic ID
- * numbers passed in by the host. They are stored in different lists, hence
- * more than 1 list may need to be searched for the corresponding component.
+ * numbers passed in by the host. Besides the list of all of them, they are
+ * kept in a table indexed by the low bits of the ID, so lookups only walk
+ * the few devices sharing a slot. Pipelines are also indexed by their
+ * pipeline ID.
  */
 
+static inline uint32_t ipc_comp_slot(uint32_t id)
+{
+	return id & (IPC_COMP_HASH_SIZE - 1);
+}
+
+static inline uint32_t ipc_ppl_id(struct ipc_comp_dev *icd)
+{
+	return icd->pipeline->ipc_pipe.pipeline_id;
+}
+
+/* adds new IPC device to the list and lookup tables */
+static void ipc_comp_dev_add(struct ipc *ipc, struct ipc_comp_dev *icd)
+{
+	struct ipc_comp_dev **slot = &ipc->comp_table[ipc_comp_slot(icd->id)];
+
+	icd->id_next = *slot;
+	*slot = icd;
+
+	if (icd->type == COMP_TYPE_PIPELINE) {
+		slot = &ipc->ppl_table[ipc_comp_slot(ipc_ppl_id(icd))];
+		icd->ppl_next = *slot;
+		*slot = icd;
+	}
+
+	list_item_append(&icd->list, &ipc->comp_list);
+}
+
+/* removes IPC device from the list and lookup tables */
+static void ipc_comp_dev_del(struct ipc *ipc, struct ipc_comp_dev *icd)
+{
+	struct ipc_comp_dev **slot = &ipc->comp_table[ipc_comp_slot(icd->id)];
+
+	while (*slot != icd)
+		slot = &(*slot)->id_next;
+	*slot = icd->id_next;
+
+	if (icd->type == COMP_TYPE_PIPELINE) {
+		slot = &ipc->ppl_table[ipc_comp_slot(ipc_ppl_id(icd))];
+		while (*slot != icd)
+			slot = &(*slot)->ppl_next;
+		*slot = icd->ppl_next;
+	}
+
+	list_item_del(&icd->list);
+}
+
 struct ipc_comp_dev *ipc_get_comp_by_id(struct ipc *ipc, uint32_t id)
 {
-	struct ipc_comp_dev *icd;
-	struct list_item *clist;
+	struct ipc_comp_dev *icd = ipc->comp_table[ipc_comp_slot(id)];
 
-	list_for_item(clist, &ipc->comp_list) {
-		icd = container_of(clist, struct ipc_comp_dev, list);
+	for (; icd; icd = icd->id_next) {
 		if (icd->id == id)
 			return icd;
 
@@ -82,6 +163,18 @@ struct ipc_comp_dev *ipc_get_comp_by_ppl_id(struct ipc *ipc, uint16_t type,
 	struct ipc_comp_dev *icd;
 	struct list_item *clist;
 
+	if (type == COMP_TYPE_PIPELINE) {
+		icd = ipc->ppl_table[ipc_comp_slot(ppl_id)];
+		for (; icd; icd = icd->ppl_next) {
+			if (cpu_is_me(icd->core) && ipc_ppl_id(icd) == ppl_id)
+				return icd;
+
+			platform_shared_commit(icd, sizeof(*icd));
+		}
+
+		return NULL;
+	}
+
 	list_for_item(clist, &ipc->comp_list) {
 		icd = container_of(clist, struct ipc_comp_dev, list);
 		if (icd->type != type) {
@@ -172,7 +265,7 @@ static struct ipc_comp_dev *ipc_get_ppl_comp(struct ipc *ipc,
 	return NULL;
 }
 
-int ipc_comp_new(struct ipc *ipc, struct sof_ipc_comp *comp)
+int __cold_text ipc_comp_new(struct ipc *ipc, struct sof_ipc_comp *comp)
 {
 	struct comp_dev *cd;
 	struct ipc_comp_dev *icd;
@@ -206,7 +299,7 @@ int ipc_comp_new(struct ipc *ipc, struct sof_ipc_comp *comp)
 	icd->id = comp->id;
 
 	/* add new component to the list */
-	list_item_append(&icd->list, &ipc->comp_list);
+	ipc_comp_dev_add(ipc, icd);
 
 	platform_shared_commit(icd, sizeof(*icd));
 
@@ -241,13 +334,13 @@ int ipc_comp_free(struct ipc *ipc, uint32_t comp_id)
 
 	icd->cd = NULL;
 
-	list_item_del(&icd->list);
+	ipc_comp_dev_del(ipc, icd);
 	rfree(icd);
 
 	return 0;
 }
 
-int ipc_buffer_new(struct ipc *ipc, struct sof_ipc_buffer *desc)
+int __cold_text ipc_buffer_new(struct ipc *ipc, struct sof_ipc_buffer *desc)
 {
 	struct ipc_comp_dev *ibd;
 	struct comp_buffer *buffer;
@@ -281,7 +374,7 @@ int ipc_buffer_new(struct ipc *ipc, struct sof_ipc_buffer *desc)
 	ibd->id = desc->comp.id;
 
 	/* add new buffer to the list */
-	list_item_append(&ibd->list, &ipc->comp_list);
+	ipc_comp_dev_add(ipc, ibd);
 
 	platform_shared_commit(ibd, sizeof(*ibd));
 
@@ -303,12 +396,38 @@ int ipc_buffer_free(struct ipc *ipc, uint32_t buffer_id)
 
 	/* free buffer and remove from list */
 	buffer_free(ibd->cb);
-	list_item_del(&ibd->list);
+	ipc_comp_dev_del(ipc, ibd);
 	rfree(ibd);
 
 	return 0;
 }
 
+#if CONFIG_BUFFER_COMPACTION
+void ipc_buffers_compact(struct ipc *ipc)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	uint32_t moved = 0;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type == COMP_TYPE_BUFFER && cpu_is_me(icd->core) &&
+		    buffer_compact(icd->cb))
+			moved++;
+
+		platform_shared_commit(icd, sizeof(*icd));
+	}
+
+	if (!moved)
+		return;
+
+	trace_ipc("ipc_buffers_compact(): %u buffers moved", moved);
+
+	/* banks left without allocations can be gated now */
+	heap_gate_free_banks();
+}
+#endif
+
 static int ipc_comp_to_buffer_connect(struct ipc_comp_dev *comp,
 				      struct ipc_comp_dev *buffer)
 {
@@ -324,7 +443,9 @@ static int ipc_comp_to_buffer_connect(struct ipc_comp_dev *comp,
 	if (buffer->core != comp->core) {
 		dcache_invalidate_region(buffer->cb, sizeof(*buffer->cb));
 
-		buffer->cb->inter_core = true;
+		ret = buffer_set_inter_core(buffer->cb);
+		if (ret < 0)
+			return ret;
 
 		if (!comp->cd->is_shared) {
 			comp->cd = comp_make_shared(comp->cd);
@@ -336,7 +457,9 @@ static int ipc_comp_to_buffer_connect(struct ipc_comp_dev *comp,
 	ret = pipeline_connect(comp->cd, buffer->cb,
 			       PPL_CONN_DIR_COMP_TO_BUFFER);
 
-	dcache_writeback_invalidate_region(buffer->cb, sizeof(*buffer->cb));
+	if (cpu_is_multicore_active())
+		dcache_writeback_invalidate_region(buffer->cb,
+						   sizeof(*buffer->cb));
 
 	platform_shared_commit(comp, sizeof(*comp));
 	platform_shared_commit(buffer, sizeof(*buffer));
@@ -359,7 +482,9 @@ static int ipc_buffer_to_comp_connect(struct ipc_comp_dev *buffer,
 	if (buffer->core != comp->core) {
 		dcache_invalidate_region(buffer->cb, sizeof(*buffer->cb));
 
-		buffer->cb->inter_core = true;
+		ret = buffer_set_inter_core(buffer->cb);
+		if (ret < 0)
+			return ret;
 
 		if (!comp->cd->is_shared) {
 			comp->cd = comp_make_shared(comp->cd);
@@ -371,7 +496,9 @@ static int ipc_buffer_to_comp_connect(struct ipc_comp_dev *buffer,
 	ret = pipeline_connect(comp->cd, buffer->cb,
 			       PPL_CONN_DIR_BUFFER_TO_COMP);
 
-	dcache_writeback_invalidate_region(buffer->cb, sizeof(*buffer->cb));
+	if (cpu_is_multicore_active())
+		dcache_writeback_invalidate_region(buffer->cb,
+						   sizeof(*buffer->cb));
 
 	platform_shared_commit(comp, sizeof(*comp));
 	platform_shared_commit(buffer, sizeof(*buffer));
@@ -379,8 +506,8 @@ static int ipc_buffer_to_comp_connect(struct ipc_comp_dev *buffer,
 	return ret;
 }
 
-int ipc_comp_connect(struct ipc *ipc,
-	struct sof_ipc_pipe_comp_connect *connect)
+int __cold_text ipc_comp_connect(struct ipc *ipc,
+				 struct sof_ipc_pipe_comp_connect *connect)
 {
 	struct ipc_comp_dev *icd_source;
 	struct ipc_comp_dev *icd_sink;
@@ -414,13 +541,124 @@ int ipc_comp_connect(struct ipc *ipc,
 	}
 }
 
+#if CONFIG_IPC_PIPELINE_PLACEMENT
+/* core picked for a pipeline, kept while any object of it is created */
+struct ipc_placement {
+	struct list_item list;
+	uint32_t pipeline_id;
+	uint32_t core;
+};
+
+static struct ipc_placement *ipc_placement_get(struct ipc *ipc,
+					       uint32_t pipeline_id)
+{
+	struct ipc_placement *placement;
+	struct list_item *plist;
+
+	list_for_item(plist, &ipc->placement_list) {
+		placement = container_of(plist, struct ipc_placement, list);
+		if (placement->pipeline_id == pipeline_id)
+			return placement;
+	}
+
+	return NULL;
+}
+
+/* Enabled core with the lowest load, the higher of MCPS declared by its
+ * pipelines and measured by the clock governor. Pipelines placed before
+ * their MCPS is declared break the ties.
+ */
+static uint32_t ipc_placement_pick(struct ipc *ipc)
+{
+	uint32_t placed[PLATFORM_CORE_COUNT] = { 0 };
+	struct ipc_placement *placement;
+	uint32_t cores = cpu_enabled_cores();
+	uint32_t best = PLATFORM_MASTER_CORE_ID;
+	uint32_t best_load = UINT32_MAX;
+	struct list_item *plist;
+	uint32_t load;
+	int i;
+
+	list_for_item(plist, &ipc->placement_list) {
+		placement = container_of(plist, struct ipc_placement, list);
+		placed[placement->core]++;
+	}
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (!(cores & BIT(i)))
+			continue;
+
+		load = MAX(ipc->core_mcps[i], clock_gov_core_load(i));
+		if (load < best_load ||
+		    (load == best_load && placed[i] < placed[best])) {
+			best = i;
+			best_load = load;
+		}
+	}
+
+	return best;
+}
+
+uint32_t ipc_placement_core(struct ipc *ipc, uint32_t pipeline_id,
+			    uint32_t core, int follow)
+{
+	struct ipc_placement *placement;
+
+	if (core != SOF_IPC_CORE_AUTO)
+		return core;
+
+	placement = ipc_placement_get(ipc, pipeline_id);
+	if (placement)
+		return placement->core;
+
+	placement = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+			    SOF_MEM_CAPS_RAM, sizeof(*placement));
+	if (!placement) {
+		trace_ipc_error("ipc_placement_core(): alloc failed");
+		return PLATFORM_MASTER_CORE_ID;
+	}
+
+	placement->pipeline_id = pipeline_id;
+	placement->core = follow >= 0 ? follow : ipc_placement_pick(ipc);
+	list_item_append(&placement->list, &ipc->placement_list);
+
+	trace_ipc("ipc_placement_core(): pipe %u on core %u", pipeline_id,
+		  placement->core);
+
+	return placement->core;
+}
+
+static void ipc_placement_add(struct ipc *ipc, struct pipeline *p)
+{
+	ipc->core_mcps[p->ipc_pipe.core] += pipeline_mcps(p);
+}
 
-int ipc_pipeline_new(struct ipc *ipc,
-	struct sof_ipc_pipe_new *pipe_desc)
+static void ipc_placement_remove(struct ipc *ipc, struct pipeline *p)
+{
+	struct ipc_placement *placement;
+	uint32_t core = p->ipc_pipe.core;
+
+	ipc->core_mcps[core] -= MIN(pipeline_mcps(p), ipc->core_mcps[core]);
+
+	placement = ipc_placement_get(ipc, p->ipc_pipe.pipeline_id);
+	if (placement) {
+		list_item_del(&placement->list);
+		rfree(placement);
+	}
+}
+#else
+static inline void ipc_placement_add(struct ipc *ipc, struct pipeline *p) { }
+static inline void ipc_placement_remove(struct ipc *ipc,
+					struct pipeline *p) { }
+#endif
+
+int __cold_text ipc_pipeline_new(struct ipc *ipc,
+				 struct sof_ipc_pipe_new *pipe_desc)
 {
 	struct ipc_comp_dev *ipc_pipe;
 	struct pipeline *pipe;
 	struct ipc_comp_dev *icd;
+	uint32_t owner;
 
 	/* check whether the pipeline already exists */
 	ipc_pipe = ipc_get_comp_by_id(ipc, pipe_desc->comp_id);
@@ -457,8 +695,18 @@ int ipc_pipeline_new(struct ipc *ipc,
 		return -EINVAL;
 	}
 
+	if (pipe_desc->batch_periods > 1 &&
+	    (uint64_t)pipe_desc->period * pipe_desc->batch_periods >
+	    PPL_BATCH_MAX_PERIOD) {
+		trace_ipc_error("ipc_pipeline_new(): invalid batch, period = %u batch_periods = %u",
+				pipe_desc->period, pipe_desc->batch_periods);
+		return -EINVAL;
+	}
+
 	/* create the pipeline */
+	owner = alloc_owner_set(ALLOC_OWNER(pipe_desc->comp_id));
 	pipe = pipeline_new(pipe_desc, icd->cd);
+	alloc_owner_set(owner);
 	if (!pipe) {
 		trace_ipc_error("ipc_pipeline_new(): pipeline_new() failed");
 		return -ENOMEM;
@@ -478,7 +726,8 @@ int ipc_pipeline_new(struct ipc *ipc,
 	ipc_pipe->id = pipe_desc->comp_id;
 
 	/* add new pipeline to the list */
-	list_item_append(&ipc_pipe->list, &ipc->comp_list);
+	ipc_comp_dev_add(ipc, ipc_pipe);
+	ipc_placement_add(ipc, pipe);
 
 	platform_shared_commit(ipc_pipe, sizeof(*ipc_pipe));
 
@@ -499,20 +748,25 @@ int ipc_pipeline_free(struct ipc *ipc, uint32_t comp_id)
 	if (!cpu_is_me(ipc_pipe->core))
 		return ipc_process_on_core(ipc_pipe->core);
 
-	/* free buffer and remove from list */
+	/* remove from list while pipeline id can still be read */
+	ipc_comp_dev_del(ipc, ipc_pipe);
+	ipc_placement_remove(ipc, ipc_pipe->pipeline);
+
+	/* free pipeline, keep it listed if still in use */
 	ret = pipeline_free(ipc_pipe->pipeline);
 	if (ret < 0) {
 		trace_ipc_error("ipc_pipeline_free(): pipeline_free() failed");
+		ipc_comp_dev_add(ipc, ipc_pipe);
+		ipc_placement_add(ipc, ipc_pipe->pipeline);
 		return ret;
 	}
 	ipc_pipe->pipeline = NULL;
-	list_item_del(&ipc_pipe->list);
 	rfree(ipc_pipe);
 
 	return 0;
 }
 
-int ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id)
+int __cold_text ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id)
 {
 	struct ipc_comp_dev *ipc_pipe;
 	uint32_t pipeline_id;
@@ -553,15 +807,121 @@ int ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id)
 	return ret;
 }
 
-int ipc_comp_dai_config(struct ipc *ipc, struct sof_ipc_dai_config *config)
+/* image objects are created in place, so they must belong to this core */
+static int ipc_tplg_image_core(uint32_t core)
+{
+	if (!cpu_is_me(core)) {
+		trace_ipc_error("ipc_tplg_image_new(): object of core %u",
+				core);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int ipc_tplg_image_record(struct ipc *ipc, struct sof_ipc_cmd_hdr *rec)
+{
+	struct sof_ipc_comp *comp = (struct sof_ipc_comp *)rec;
+	struct sof_ipc_buffer *buffer = (struct sof_ipc_buffer *)rec;
+	struct sof_ipc_pipe_new *pipe = (struct sof_ipc_pipe_new *)rec;
+	struct sof_ipc_pipe_ready *ready = (struct sof_ipc_pipe_ready *)rec;
+	int ret;
+
+	switch (rec->cmd & SOF_CMD_TYPE_MASK) {
+	case SOF_IPC_TPLG_COMP_NEW:
+		if (rec->size < sizeof(*comp) +
+		    sizeof(struct sof_ipc_comp_config))
+			return -EINVAL;
+		ret = ipc_tplg_image_core(comp->core);
+		if (ret < 0)
+			return ret;
+		return ipc_comp_new(ipc, comp);
+	case SOF_IPC_TPLG_BUFFER_NEW:
+		if (rec->size < sizeof(*buffer))
+			return -EINVAL;
+		ret = ipc_tplg_image_core(buffer->comp.core);
+		if (ret < 0)
+			return ret;
+		return ipc_buffer_new(ipc, buffer);
+	case SOF_IPC_TPLG_PIPE_NEW:
+		if (rec->size < sizeof(*pipe))
+			return -EINVAL;
+		ret = ipc_tplg_image_core(pipe->core);
+		if (ret < 0)
+			return ret;
+		return ipc_pipeline_new(ipc, pipe);
+	case SOF_IPC_TPLG_COMP_CONNECT:
+		if (rec->size < sizeof(struct sof_ipc_pipe_comp_connect))
+			return -EINVAL;
+		return ipc_comp_connect(ipc,
+				(struct sof_ipc_pipe_comp_connect *)rec);
+	case SOF_IPC_TPLG_PIPE_COMPLETE:
+		if (rec->size < sizeof(*ready))
+			return -EINVAL;
+		return ipc_pipeline_complete(ipc, ready->comp_id);
+	default:
+		return -EINVAL;
+	}
+}
+
+int __cold_text ipc_tplg_image_new(struct ipc *ipc, void *image, uint32_t size,
+				   uint32_t *count)
+{
+	struct sof_tplg_image_hdr *img = image;
+	struct sof_ipc_cmd_hdr *rec;
+	uint32_t offset = sizeof(*img);
+	int ret = 0;
+
+	*count = 0;
+
+	if (size < sizeof(*img) || img->magic != SOF_TPLG_IMAGE_MAGIC ||
+	    img->size != size) {
+		trace_ipc_error("ipc_tplg_image_new(): invalid image header");
+		return -EINVAL;
+	}
+
+	/* records are used in place, their layout must be the same */
+	if (SOF_ABI_VERSION_MAJOR(img->abi) != SOF_ABI_MAJOR ||
+	    SOF_ABI_VERSION_MINOR(img->abi) != SOF_ABI_MINOR) {
+		trace_ipc_error("ipc_tplg_image_new(): image abi 0x%x, firmware abi 0x%x",
+				img->abi, SOF_ABI_VERSION);
+		return -EINVAL;
+	}
+
+	for (; *count < img->count; (*count)++) {
+		rec = (struct sof_ipc_cmd_hdr *)((char *)image + offset);
+
+		if (size - offset < sizeof(*rec) ||
+		    rec->size < sizeof(*rec) ||
+		    rec->size > size - offset ||
+		    rec->size % sizeof(uint32_t) ||
+		    (rec->cmd & SOF_GLB_TYPE_MASK) != SOF_IPC_GLB_TPLG_MSG) {
+			trace_ipc_error("ipc_tplg_image_new(): record %u is invalid",
+					*count);
+			return -EINVAL;
+		}
+
+		ret = ipc_tplg_image_record(ipc, rec);
+		if (ret < 0) {
+			trace_ipc_error("ipc_tplg_image_new(): record %u cmd 0x%x failed %d",
+					*count, rec->cmd, ret);
+			return ret;
+		}
+
+		offset += rec->size;
+	}
+
+	return 0;
+}
+
+int __cold_text ipc_comp_dai_config(struct ipc *ipc,
+				    struct sof_ipc_dai_config *config)
 {
-	bool comp_on_core[PLATFORM_CORE_COUNT] = { false };
 	struct sof_ipc_comp_dai *dai;
-	struct sof_ipc_reply reply;
 	struct ipc_comp_dev *icd;
 	struct list_item *clist;
+	uint32_t core_mask = 0;
 	int ret = -ENODEV;
-	int i;
 
 	/* for each component */
 	list_for_item(clist, &ipc->comp_list) {
@@ -573,7 +933,7 @@ int ipc_comp_dai_config(struct ipc *ipc, struct sof_ipc_dai_config *config)
 		}
 
 		if (!cpu_is_me(icd->core)) {
-			comp_on_core[icd->core] = true;
+			core_mask |= BIT(icd->core);
 			ret = 0;
 			platform_shared_commit(icd, sizeof(*icd));
 			continue;
@@ -602,53 +962,130 @@ int ipc_comp_dai_config(struct ipc *ipc, struct sof_ipc_dai_config *config)
 		return ret;
 	}
 
-	/* message forwarded only by master core */
-	if (!cpu_is_slave(cpu_get_id())) {
-		for (i = 0; i < PLATFORM_CORE_COUNT; ++i) {
-			if (!comp_on_core[i])
-				continue;
+	/* message forwarded only by master core, error of any core is
+	 * replied again by master as the cores reply at the same time
+	 */
+	if (!cpu_is_slave(cpu_get_id()) && core_mask)
+		return ipc_process_on_cores(core_mask);
+
+	return ret;
+}
 
-			ret = ipc_process_on_core(i);
-			if (ret < 0)
-				return ret;
+#if CONFIG_IPC_MSG_RATE_LIMIT
+/* 256ab4ab-59bd-487a-94f9-90ff32c80a4e */
+DECLARE_SOF_UUID("ipc-msg-retry", ipc_msg_retry_uuid, 0x256ab4ab, 0x59bd,
+		 0x487a, 0x94, 0xf9, 0x90, 0xff, 0x32, 0xc8, 0x0a, 0x4e);
 
-			/* check whether IPC failed on slave core */
-			mailbox_hostbox_read(&reply, sizeof(reply), 0,
-					     sizeof(reply));
-			if (reply.error < 0)
-				/* error reply already written */
-				return 1;
+/* Minimum time between sends of a message in ms, 0 if unlimited. Only
+ * periodic position updates are limited, xruns and other events go out
+ * right away.
+ */
+static uint32_t ipc_msg_period(uint32_t header)
+{
+	switch (header & (SOF_GLB_TYPE_MASK | SOF_CMD_TYPE_MASK)) {
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_POSITION:
+		return CONFIG_IPC_MSG_STREAM_PERIOD_MS;
+	case SOF_IPC_GLB_TRACE_MSG | SOF_IPC_TRACE_DMA_POSITION:
+		return CONFIG_IPC_MSG_TRACE_PERIOD_MS;
+	default:
+		return 0;
+	}
+}
+
+static enum task_state ipc_msg_retry_run(void *data)
+{
+	struct ipc *ipc = data;
+	uint32_t flags;
+
+	spin_lock_irq(&ipc->lock, flags);
+	ipc->msg_retry[cpu_get_id()] = 0;
+	platform_shared_commit(ipc, sizeof(*ipc));
+	spin_unlock_irq(&ipc->lock, flags);
+
+	ipc_send_queued_msg();
+
+	return SOF_TASK_STATE_COMPLETED;
+}
+
+/* retries queued messages at time unless an earlier retry is scheduled,
+ * so a limited message isn't left waiting for other IPC traffic. Messages
+ * are sent from any core, so each core uses its own retry task and only
+ * ever touches the LL task list of its own scheduler.
+ */
+static void ipc_msg_retry(struct ipc *ipc, uint64_t now, uint64_t time)
+{
+	uint64_t ticks_per_ms = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+	int core = cpu_get_id();
+
+	if (ipc->msg_retry[core] && ipc->msg_retry[core] <= time)
+		return;
+
+	if (ipc->msg_retry[core])
+		schedule_task_cancel(&ipc->msg_retry_task[core]);
+
+	ipc->msg_retry[core] = time;
+	schedule_task(&ipc->msg_retry_task[core],
+		      (time - now) * 1000 / ticks_per_ms + 1, 0);
+}
+
+int ipc_msg_tx(struct ipc *ipc, struct ipc_msg *msg)
+{
+	uint32_t period = ipc_msg_period(msg->header);
+	uint64_t now = platform_timer_get(timer_get());
+	uint64_t next;
+	int ret;
+
+	/* the message stays queued and keeps being updated in place */
+	if (period && msg->tx_time) {
+		next = msg->tx_time +
+			clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, period);
+		if (now < next) {
+			ipc_msg_retry(ipc, now, next);
+			return -EAGAIN;
 		}
 	}
 
+	ret = ipc_platform_send_msg(msg);
+	if (!ret && period)
+		msg->tx_time = now;
+
 	return ret;
 }
+#else
+int ipc_msg_tx(struct ipc *ipc, struct ipc_msg *msg)
+{
+	return ipc_platform_send_msg(msg);
+}
+#endif
 
 void ipc_send_queued_msg(void)
 {
 	struct ipc *ipc = ipc_get();
 	struct ipc_msg *msg;
+	struct list_item *mlist;
 	uint32_t flags;
 
 	spin_lock_irq(&ipc->lock, flags);
 
-	/* any messages to send ? */
-	if (list_is_empty(&ipc->msg_list))
-		goto out;
+	/* send the first message that is not rate limited */
+	list_for_item(mlist, &ipc->msg_list) {
+		msg = container_of(mlist, struct ipc_msg, list);
 
-	msg = list_first_item(&ipc->msg_list, struct ipc_msg,
-			      list);
-
-	ipc_platform_send_msg(msg);
+		if (ipc_msg_tx(ipc, msg) != -EAGAIN)
+			break;
+	}
 
-out:
 	platform_shared_commit(ipc, sizeof(*ipc));
 
 	spin_unlock_irq(&ipc->lock, flags);
 }
 
-int ipc_init(struct sof *sof)
+int __cold_text ipc_init(struct sof *sof)
 {
+#if CONFIG_IPC_MSG_RATE_LIMIT
+	int i;
+#endif
+
 	trace_ipc("ipc_init()");
 
 	/* init ipc data */
@@ -658,8 +1095,19 @@ int ipc_init(struct sof *sof)
 				      SOF_MEM_CAPS_RAM, SOF_IPC_MSG_MAX_SIZE);
 
 	spinlock_init(&sof->ipc->lock);
+	spinlock_name(&sof->ipc->lock, "ipc");
 	list_init(&sof->ipc->msg_list);
 	list_init(&sof->ipc->comp_list);
+#if CONFIG_IPC_PIPELINE_PLACEMENT
+	list_init(&sof->ipc->placement_list);
+#endif
+#if CONFIG_IPC_MSG_RATE_LIMIT
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		schedule_task_init_ll(&sof->ipc->msg_retry_task[i],
+				      SOF_UUID(ipc_msg_retry_uuid),
+				      SOF_SCHEDULE_LL_TIMER, SOF_TASK_PRI_LOW,
+				      ipc_msg_retry_run, sof->ipc, i, 0);
+#endif
 
 	return platform_ipc_init(sof->ipc);
 }
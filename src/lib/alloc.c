@@ -5,13 +5,17 @@
 // Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
 //         Keyon Jie <yang.jie@linux.intel.com>
 
+#include <sof/bit.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/interrupt.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/mm_heap.h>
+#include <sof/lib/pm_memory.h>
+#include <sof/math/numbers.h>
 #include <sof/spinlock.h>
 #include <sof/string.h>
 #include <ipc/topology.h>
@@ -152,6 +156,39 @@ static void init_heap_map(struct mm_heap *heap, int count)
 	}
 }
 
+/* track high water mark of the heap usage */
+#if CONFIG_DEBUG_MEM_OWNER
+/* owner of the allocations of a core, each core has its own cache line */
+struct alloc_owner {
+	uint32_t owner;
+} __aligned(PLATFORM_DCACHE_ALIGN);
+
+static struct alloc_owner alloc_owner[PLATFORM_CORE_COUNT];
+
+uint32_t alloc_owner_set(uint32_t owner)
+{
+	struct alloc_owner *current = &alloc_owner[cpu_get_id()];
+	uint32_t prev = current->owner;
+
+	current->owner = owner;
+
+	return prev;
+}
+
+static inline void block_set_owner(struct block_hdr *hdr)
+{
+	hdr->owner = alloc_owner[cpu_get_id()].owner;
+}
+#else
+static inline void block_set_owner(struct block_hdr *hdr) { }
+#endif
+
+static inline void heap_update_peak(struct mm_heap *heap)
+{
+	if (heap->info.used > heap->peak_used)
+		heap->peak_used = heap->info.used;
+}
+
 /* allocate from system memory pool */
 static void *rmalloc_sys(uint32_t flags, int caps, int core, size_t bytes)
 {
@@ -159,12 +196,15 @@ static void *rmalloc_sys(uint32_t flags, int caps, int core, size_t bytes)
 	void *ptr;
 	struct mm_heap *cpu_heap;
 	size_t alignment = 0;
+	uint32_t lock_flags;
 
 	/* use the heap dedicated for the selected core */
 	cpu_heap = memmap->system + core;
 	if ((cpu_heap->caps & caps) != caps)
 		panic(SOF_IPC_PANIC_MEM);
 
+	spin_lock_irq(&cpu_heap->lock, lock_flags);
+
 	/* align address to dcache line size */
 	if (cpu_heap->info.used % PLATFORM_DCACHE_ALIGN)
 		alignment = PLATFORM_DCACHE_ALIGN -
@@ -182,6 +222,9 @@ static void *rmalloc_sys(uint32_t flags, int caps, int core, size_t bytes)
 
 	cpu_heap->info.used += bytes;
 	cpu_heap->info.free -= alignment + bytes;
+	heap_update_peak(cpu_heap);
+
+	spin_unlock_irq(&cpu_heap->lock, lock_flags);
 
 	if (flags & SOF_MEM_FLAG_SHARED)
 		ptr = platform_shared_get(ptr, bytes);
@@ -213,6 +256,125 @@ static void *align_ptr(struct mm_heap *heap, uint32_t alignment,
 	return ptr;
 }
 
+#if CONFIG_HEAP_BANK_PM
+/* finds SRAM banks fully inside the heap, all powered at boot */
+static void heap_bank_init(struct mm_heap *heap, int count)
+{
+	uint32_t start;
+	uint32_t end;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		start = ALIGN(heap[i].heap, SRAM_BANK_SIZE);
+		end = ALIGN_DOWN(heap[i].heap + heap[i].size, SRAM_BANK_SIZE);
+
+		heap[i].bank_count = 0;
+		heap[i].bank_powered = 0;
+		bzero(heap[i].bank_used, sizeof(heap[i].bank_used));
+
+		/* only HP SRAM banks can be power gated */
+		if (heap[i].heap < HP_SRAM_BASE ||
+		    heap[i].heap + heap[i].size > HP_SRAM_BASE + HP_SRAM_SIZE ||
+		    end <= start)
+			continue;
+
+		heap[i].bank_base = start;
+		heap[i].bank_count = MIN((end - start) / SRAM_BANK_SIZE,
+					 MM_HEAP_BANKS);
+		heap[i].bank_powered = MASK(heap[i].bank_count - 1, 0);
+	}
+}
+
+/* accounts blocks in the banks they overlap, called with heap lock held,
+ * banks about to be used are powered up first
+ */
+static void heap_bank_use(struct mm_heap *heap, uint32_t addr, uint32_t bytes,
+			  bool used)
+{
+	uint32_t end = addr + bytes;
+	uint32_t bank_start;
+	uint32_t bank_end;
+	uint32_t chunk;
+	int i;
+
+	for (i = 0; i < heap->bank_count; i++) {
+		bank_start = heap->bank_base + i * SRAM_BANK_SIZE;
+		bank_end = bank_start + SRAM_BANK_SIZE;
+
+		if (end <= bank_start || addr >= bank_end)
+			continue;
+
+		chunk = MIN(end, bank_end) - MAX(addr, bank_start);
+
+		if (!used) {
+			heap->bank_used[i] -= chunk;
+			continue;
+		}
+
+		if (!(heap->bank_powered & BIT(i))) {
+			set_power_gate_for_memory_address_range(
+				(void *)bank_start, SRAM_BANK_SIZE, 1);
+			heap->bank_powered |= BIT(i);
+		}
+
+		heap->bank_used[i] += chunk;
+	}
+}
+
+/* drops bank accounting before the block maps are replaced on restore */
+static void heap_bank_reset(struct mm_heap *heap)
+{
+	bzero(heap->bank_used, sizeof(heap->bank_used));
+}
+
+/* Gates powered banks without any allocation. Allocations take the
+ * lowest free blocks first, so free banks gather at the heap end.
+ */
+void heap_gate_free_banks(void)
+{
+	struct mm *memmap = memmap_get();
+	struct mm_heap *heap;
+	uint32_t bank_start;
+	uint32_t flags;
+	int i;
+	int j;
+
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++) {
+		heap = &memmap->buffer[i];
+
+		spin_lock_irq(&heap->lock, flags);
+
+		for (j = 0; j < heap->bank_count; j++) {
+			if (!(heap->bank_powered & BIT(j)) ||
+			    heap->bank_used[j])
+				continue;
+
+			/* no stale line may be written back to gated bank */
+			bank_start = heap->bank_base + j * SRAM_BANK_SIZE;
+			dcache_invalidate_region((void *)bank_start,
+						 SRAM_BANK_SIZE);
+
+			set_power_gate_for_memory_address_range(
+				(void *)bank_start, SRAM_BANK_SIZE, 0);
+			heap->bank_powered &= ~BIT(j);
+		}
+
+		platform_shared_commit(heap, sizeof(*heap));
+
+		spin_unlock_irq(&heap->lock, flags);
+	}
+
+	platform_shared_commit(memmap, sizeof(*memmap));
+}
+#else
+static inline void heap_bank_init(struct mm_heap *heap, int count) { }
+
+static inline void heap_bank_use(struct mm_heap *heap, uint32_t addr,
+				 uint32_t bytes, bool used) { }
+
+static inline void heap_bank_reset(struct mm_heap *heap) { }
+#endif
+
 /* allocate single block */
 static void *alloc_block(struct mm_heap *heap, int level,
 			 uint32_t caps, uint32_t alignment)
@@ -226,13 +388,16 @@ static void *alloc_block(struct mm_heap *heap, int level,
 
 	map->free_count--;
 	ptr = (void *)(map->base + map->first_free * map->block_size);
+	heap_bank_use(heap, (uint32_t)ptr, map->block_size, true);
 	ptr = align_ptr(heap, alignment, ptr, hdr);
 
 	hdr->size = 1;
 	hdr->used = 1;
+	block_set_owner(hdr);
 
 	heap->info.used += map->block_size;
 	heap->info.free -= map->block_size;
+	heap_update_peak(heap);
 
 	/* find next free */
 	for (i = map->first_free; i < map->count; ++i) {
@@ -290,14 +455,17 @@ static void *alloc_cont_blocks(struct mm_heap *heap, int level,
 	map->free_count -= count;
 	ptr = (void *)(map->base + start * map->block_size);
 	unaligned_ptr = ptr;
+	heap_bank_use(heap, (uint32_t)ptr, count * map->block_size, true);
 
 	hdr = &map->block[start];
 	hdr->size = count;
+	block_set_owner(hdr);
 
 	ptr = align_ptr(heap, alignment, ptr, hdr);
 
 	heap->info.used += count * map->block_size;
 	heap->info.free -= count * map->block_size;
+	heap_update_peak(heap);
 	/* update first_free if needed */
 	if (map->first_free == start)
 		/* find first available free block */
@@ -324,48 +492,32 @@ out:
 	return ptr;
 }
 
+/* find freeable heap that ptr belongs to in the sorted address ranges */
 static struct mm_heap *get_heap_from_ptr(void *ptr)
 {
 	struct mm *memmap = memmap_get();
-	struct mm_heap *heap;
-	int i;
-
-	/* find mm_heap that ptr belongs to */
-	heap = memmap->system_runtime + cpu_get_id();
-	if ((uint32_t)ptr >= heap->heap &&
-	    (uint32_t)ptr < heap->heap + heap->size)
-		goto out;
-
-	platform_shared_commit(heap, sizeof(*heap));
-
-	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++) {
-		heap = &memmap->runtime[i];
-
-		if ((uint32_t)ptr >= heap->heap &&
-		    (uint32_t)ptr < heap->heap + heap->size)
-			goto out;
-
-		platform_shared_commit(heap, sizeof(*heap));
-	}
-
-	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++) {
-		heap = &memmap->buffer[i];
-
-		if ((uint32_t)ptr >= heap->heap &&
-		    (uint32_t)ptr < heap->heap + heap->size)
-			goto out;
-
-		platform_shared_commit(heap, sizeof(*heap));
+	struct mm_heap_range *range;
+	struct mm_heap *heap = NULL;
+	int low = 0;
+	int high = memmap->heap_range_count - 1;
+	int mid;
+
+	while (low <= high) {
+		mid = (low + high) / 2;
+		range = &memmap->heap_range[mid];
+
+		if ((uint32_t)ptr < range->start) {
+			high = mid - 1;
+		} else if ((uint32_t)ptr >= range->end) {
+			low = mid + 1;
+		} else {
+			heap = range->heap;
+			break;
+		}
 	}
 
 	platform_shared_commit(memmap, sizeof(*memmap));
 
-	return NULL;
-
-out:
-	platform_shared_commit(heap, sizeof(*heap));
-	platform_shared_commit(memmap, sizeof(*memmap));
-
 	return heap;
 }
 
@@ -431,16 +583,18 @@ static void *get_ptr_from_heap(struct mm_heap *heap, uint32_t flags,
 		break;
 	}
 
+	if (!ptr)
+		heap->alloc_fails++;
+
 	if (ptr && (flags & SOF_MEM_FLAG_SHARED))
 		ptr = platform_shared_get(ptr, bytes);
 
 	return ptr;
 }
 
-/* free block(s) */
-static void free_block(void *ptr)
+/* free block(s), called with heap lock held */
+static void free_block(struct mm_heap *heap, void *ptr)
 {
-	struct mm_heap *heap;
 	struct block_map *block_map = NULL;
 	struct block_hdr *hdr;
 	int i;
@@ -448,13 +602,6 @@ static void free_block(void *ptr)
 	int used_blocks;
 	bool heap_is_full;
 
-	heap = get_heap_from_ptr(ptr);
-	if (!heap) {
-		trace_mem_error("free_block(): invalid heap = %p, cpu = %d",
-				(uintptr_t)ptr, cpu_get_id());
-		return;
-	}
-
 	/* find block that ptr belongs to */
 	for (i = 0; i < heap->blocks; i++) {
 		block_map = &heap->map[i];
@@ -507,11 +654,17 @@ static void free_block(void *ptr)
 		hdr->size = 0;
 		hdr->used = 0;
 		hdr->unaligned_ptr = NULL;
+#if CONFIG_DEBUG_MEM_OWNER
+		hdr->owner = ALLOC_OWNER_NONE;
+#endif
 		block_map->free_count++;
 		heap->info.used -= block_map->block_size;
 		heap->info.free += block_map->block_size;
 	}
 
+	heap_bank_use(heap, block_map->base + block_map->block_size * block,
+		      block_map->block_size * (used_blocks - block), false);
+
 	/* set first free block */
 	if (block < block_map->first_free || heap_is_full)
 		block_map->first_free = block;
@@ -624,6 +777,7 @@ static void *rmalloc_sys_runtime(uint32_t flags, int caps, int core,
 {
 	struct mm *memmap = memmap_get();
 	struct mm_heap *cpu_heap;
+	uint32_t lock_flags;
 	void *ptr;
 
 	/* use the heap dedicated for the selected core */
@@ -631,8 +785,11 @@ static void *rmalloc_sys_runtime(uint32_t flags, int caps, int core,
 	if ((cpu_heap->caps & caps) != caps)
 		panic(SOF_IPC_PANIC_MEM);
 
+	/* core local heap, no contention with other cores allocations */
+	spin_lock_irq(&cpu_heap->lock, lock_flags);
 	ptr = get_ptr_from_heap(cpu_heap, flags, caps, bytes,
 				PLATFORM_DCACHE_ALIGN);
+	spin_unlock_irq(&cpu_heap->lock, lock_flags);
 
 	platform_shared_commit(cpu_heap, sizeof(*cpu_heap));
 	platform_shared_commit(memmap, sizeof(*memmap));
@@ -645,6 +802,8 @@ static void *rmalloc_runtime(uint32_t flags, uint32_t caps, size_t bytes)
 {
 	struct mm *memmap = memmap_get();
 	struct mm_heap *heap;
+	uint32_t lock_flags;
+	void *ptr;
 
 	/* check runtime heap for capabilities */
 	heap = get_heap_from_caps(memmap->runtime, PLATFORM_HEAP_RUNTIME, caps);
@@ -664,12 +823,17 @@ static void *rmalloc_runtime(uint32_t flags, uint32_t caps, size_t bytes)
 
 	platform_shared_commit(memmap, sizeof(*memmap));
 
-	return get_ptr_from_heap(heap, flags, caps, bytes,
-				 PLATFORM_DCACHE_ALIGN);
+	spin_lock_irq(&heap->lock, lock_flags);
+	ptr = get_ptr_from_heap(heap, flags, caps, bytes,
+				PLATFORM_DCACHE_ALIGN);
+	spin_unlock_irq(&heap->lock, lock_flags);
+
+	return ptr;
 }
 
-static void *_malloc_unlocked(enum mem_zone zone, uint32_t flags, uint32_t caps,
-			      size_t bytes)
+/* heap locks are taken by the zone allocators */
+static void *rmalloc_zone(enum mem_zone zone, uint32_t flags, uint32_t caps,
+			  size_t bytes)
 {
 	struct mm *memmap = memmap_get();
 	void *ptr = NULL;
@@ -704,15 +868,9 @@ static void *_malloc_unlocked(enum mem_zone zone, uint32_t flags, uint32_t caps,
 
 void *rmalloc(enum mem_zone zone, uint32_t flags, uint32_t caps, size_t bytes)
 {
-	struct mm *memmap = memmap_get();
-	uint32_t lock_flags;
-	void *ptr = NULL;
-
-	spin_lock_irq(&memmap->lock, lock_flags);
-
-	ptr = _malloc_unlocked(zone, flags, caps, bytes);
+	void *ptr;
 
-	spin_unlock_irq(&memmap->lock, lock_flags);
+	ptr = rmalloc_zone(zone, flags, caps, bytes);
 
 	DEBUG_TRACE_PTR(ptr, bytes, zone, caps, flags);
 	return ptr;
@@ -733,21 +891,132 @@ void *rzalloc(enum mem_zone zone, uint32_t flags, uint32_t caps, size_t bytes)
 
 void *rzalloc_core_sys(int core, size_t bytes)
 {
-	struct mm *memmap = memmap_get();
-	uint32_t flags;
-	void *ptr = NULL;
-
-	spin_lock_irq(&memmap->lock, flags);
+	void *ptr;
 
 	ptr = rmalloc_sys(0, 0, core, bytes);
 	if (ptr)
 		bzero(ptr, bytes);
 
-	spin_unlock_irq(&memmap->lock, flags);
+	return ptr;
+}
+
+/* free object of the cache, link is stored in the object itself */
+struct mem_cache_obj {
+	struct mem_cache_obj *next;
+};
+
+struct mem_cache *mem_cache_create(enum mem_zone zone, uint32_t flags,
+				   uint32_t caps, size_t size,
+				   uint32_t slab_objs)
+{
+	struct mem_cache *cache;
+
+	if (!size || !slab_objs || zone == SOF_MEM_ZONE_BUFFER) {
+		trace_mem_error("mem_cache_create(): invalid zone %d size %u objs %u",
+				zone, size, slab_objs);
+		return NULL;
+	}
+
+	cache = rzalloc(SOF_MEM_ZONE_SYS, SOF_MEM_FLAG_SHARED,
+			SOF_MEM_CAPS_RAM, sizeof(*cache));
+	if (!cache)
+		return NULL;
+
+	cache->obj_size = ALIGN_UP(size, PLATFORM_DCACHE_ALIGN);
+	cache->slab_objs = slab_objs;
+	cache->zone = zone;
+	cache->flags = flags;
+	cache->caps = caps;
+
+	return cache;
+}
+
+/* allocates new slab and puts its objects on the free list */
+static void mem_cache_refill(struct mem_cache *cache,
+			     struct mem_cache_core *cc)
+{
+	struct mem_cache_obj *obj;
+	uint32_t count = cache->slab_objs;
+	char *slab;
+	uint32_t i;
+
+	slab = rmalloc_zone(cache->zone, cache->flags, cache->caps,
+			    count * cache->obj_size);
+	if (!slab && count > 1) {
+		/* no block big enough for the whole slab, get one object */
+		count = 1;
+		slab = rmalloc_zone(cache->zone, cache->flags, cache->caps,
+				    cache->obj_size);
+	}
+
+	if (!slab) {
+		trace_mem_error("mem_cache_refill(): zone %d size %u failed",
+				cache->zone, cache->obj_size);
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		obj = (struct mem_cache_obj *)(slab + i * cache->obj_size);
+		obj->next = cc->free_list;
+		cc->free_list = obj;
+	}
+
+	cc->free_count += count;
+}
+
+void *mem_cache_alloc(struct mem_cache *cache)
+{
+	struct mem_cache_core *cc = &cache->core[cpu_get_id()];
+	struct mem_cache_obj *obj;
+	uint32_t flags;
+
+	irq_local_disable(flags);
+
+	if (!cc->free_list)
+		mem_cache_refill(cache, cc);
+
+	obj = cc->free_list;
+	if (obj) {
+		cc->free_list = obj->next;
+		cc->free_count--;
+	}
+
+	irq_local_enable(flags);
+
+	return obj;
+}
+
+void *mem_cache_zalloc(struct mem_cache *cache)
+{
+	void *ptr;
+
+	ptr = mem_cache_alloc(cache);
+	if (ptr)
+		bzero(ptr, cache->obj_size);
 
 	return ptr;
 }
 
+void mem_cache_free(struct mem_cache *cache, void *ptr)
+{
+	struct mem_cache_core *cc;
+	struct mem_cache_obj *obj = ptr;
+	uint32_t flags;
+
+	/* sanity check - NULL ptrs are fine */
+	if (!ptr)
+		return;
+
+	irq_local_disable(flags);
+
+	cc = &cache->core[cpu_get_id()];
+	obj->next = cc->free_list;
+	cc->free_list = obj;
+	cc->free_count++;
+
+	irq_local_enable(flags);
+}
+
 /* allocates continuous buffers - not for direct use, clients use rballoc() */
 static void *alloc_heap_buffer(struct mm_heap *heap, uint32_t flags,
 			       uint32_t caps, size_t bytes, uint32_t alignment)
@@ -814,6 +1083,9 @@ static void *alloc_heap_buffer(struct mm_heap *heap, uint32_t flags,
 		}
 	}
 
+	if (!ptr)
+		heap->alloc_fails++;
+
 	if (ptr && (flags & SOF_MEM_FLAG_SHARED))
 		ptr = platform_shared_get(ptr, bytes);
 
@@ -827,12 +1099,13 @@ static void *alloc_heap_buffer(struct mm_heap *heap, uint32_t flags,
 	return ptr;
 }
 
-static void *_balloc_unlocked(uint32_t flags, uint32_t caps, size_t bytes,
-			      uint32_t alignment)
+static void *rballoc_heaps(uint32_t flags, uint32_t caps, size_t bytes,
+			   uint32_t alignment)
 {
 	struct mm *memmap = memmap_get();
 	struct mm_heap *heap;
 	unsigned int i, n;
+	uint32_t lock_flags;
 	void *ptr = NULL;
 
 	for (i = 0, n = PLATFORM_HEAP_BUFFER, heap = memmap->buffer;
@@ -843,7 +1116,9 @@ static void *_balloc_unlocked(uint32_t flags, uint32_t caps, size_t bytes,
 		if (!heap)
 			break;
 
+		spin_lock_irq(&heap->lock, lock_flags);
 		ptr = alloc_heap_buffer(heap, flags, caps, bytes, alignment);
+		spin_unlock_irq(&heap->lock, lock_flags);
 		if (ptr)
 			break;
 
@@ -859,24 +1134,20 @@ static void *_balloc_unlocked(uint32_t flags, uint32_t caps, size_t bytes,
 void *rballoc_align(uint32_t flags, uint32_t caps, size_t bytes,
 		    uint32_t alignment)
 {
-	struct mm *memmap = memmap_get();
-	void *ptr = NULL;
-	uint32_t lock_flags;
-
-	spin_lock_irq(&memmap->lock, lock_flags);
-
-	ptr = _balloc_unlocked(flags, caps, bytes, alignment);
+	void *ptr;
 
-	spin_unlock_irq(&memmap->lock, lock_flags);
+	ptr = rballoc_heaps(flags, caps, bytes, alignment);
 
 	DEBUG_TRACE_PTR(ptr, bytes, SOF_MEM_ZONE_BUFFER, caps, flags);
 	return ptr;
 }
 
-static void _rfree_unlocked(void *ptr)
+void rfree(void *ptr)
 {
 	struct mm *memmap = memmap_get();
 	struct mm_heap *cpu_heap;
+	struct mm_heap *heap;
+	uint32_t flags;
 
 	/* sanity check - NULL ptrs are fine */
 	if (!ptr)
@@ -896,45 +1167,40 @@ static void _rfree_unlocked(void *ptr)
 		panic(SOF_IPC_PANIC_MEM);
 	}
 
-	/* free the block */
-	free_block(ptr);
-	memmap->heap_trace_updated = 1;
-
 	platform_shared_commit(cpu_heap, sizeof(*cpu_heap));
-	platform_shared_commit(memmap, sizeof(*memmap));
-}
 
-void rfree(void *ptr)
-{
-	struct mm *memmap = memmap_get();
-	uint32_t flags;
+	heap = get_heap_from_ptr(ptr);
+	if (!heap) {
+		trace_mem_error("rfree(): invalid heap = %p, cpu = %d",
+				(uintptr_t)ptr, cpu_get_id());
+		return;
+	}
+
+	/* free the block under the lock of its heap only */
+	spin_lock_irq(&heap->lock, flags);
+	free_block(heap, ptr);
+	spin_unlock_irq(&heap->lock, flags);
 
-	spin_lock_irq(&memmap->lock, flags);
-	_rfree_unlocked(ptr);
-	spin_unlock_irq(&memmap->lock, flags);
+	memmap->heap_trace_updated = 1;
+
+	platform_shared_commit(memmap, sizeof(*memmap));
 }
 
 void *rrealloc(void *ptr, enum mem_zone zone, uint32_t flags, uint32_t caps,
 	       size_t bytes)
 {
-	struct mm *memmap = memmap_get();
 	void *new_ptr = NULL;
-	uint32_t lock_flags;
 
 	if (!bytes)
 		return new_ptr;
 
-	spin_lock_irq(&memmap->lock, lock_flags);
-
-	new_ptr = _malloc_unlocked(zone, flags, caps, bytes);
+	new_ptr = rmalloc_zone(zone, flags, caps, bytes);
 
 	if (new_ptr && ptr)
 		memcpy_s(new_ptr, bytes, ptr, bytes);
 
 	if (new_ptr)
-		_rfree_unlocked(ptr);
-
-	spin_unlock_irq(&memmap->lock, lock_flags);
+		rfree(ptr);
 
 	DEBUG_TRACE_PTR(ptr, bytes, zone, caps, flags);
 	return new_ptr;
@@ -943,52 +1209,347 @@ void *rrealloc(void *ptr, enum mem_zone zone, uint32_t flags, uint32_t caps,
 void *rbrealloc_align(void *ptr, uint32_t flags, uint32_t caps, size_t bytes,
 		      uint32_t alignment)
 {
-	struct mm *memmap = memmap_get();
 	void *new_ptr = NULL;
-	uint32_t lock_flags;
 
 	if (!bytes)
 		return new_ptr;
 
-	spin_lock_irq(&memmap->lock, lock_flags);
-
-	new_ptr = _balloc_unlocked(flags, caps, bytes, alignment);
+	new_ptr = rballoc_heaps(flags, caps, bytes, alignment);
 
 	if (new_ptr && ptr)
 		memcpy_s(new_ptr, bytes, ptr, bytes);
 
 	if (new_ptr)
-		_rfree_unlocked(ptr);
-
-	spin_unlock_irq(&memmap->lock, lock_flags);
+		rfree(ptr);
 
 	DEBUG_TRACE_PTR(ptr, bytes, SOF_MEM_ZONE_BUFFER, caps, flags);
 	return new_ptr;
 }
 
-/* TODO: all mm_pm_...() routines to be implemented for IMR storage */
-uint32_t mm_pm_context_size(void)
+/* largest run of free blocks in any map, called with heap lock held */
+static uint32_t heap_largest_free(struct mm_heap *heap)
+{
+	struct block_map *map;
+	uint32_t largest = 0;
+	uint32_t run;
+	int i;
+	int j;
+
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+		run = 0;
+
+		if (!map->free_count) {
+			platform_shared_commit(map, sizeof(*map));
+			continue;
+		}
+
+		/* blocks below first_free are all used */
+		for (j = map->first_free; j < map->count; j++) {
+			if (map->block[j].used) {
+				run = 0;
+				continue;
+			}
+
+			run++;
+			largest = MAX(largest, run * map->block_size);
+		}
+
+		platform_shared_commit(map, sizeof(*map));
+	}
+
+	return largest;
+}
+
+static void heap_info_fill(struct sof_ipc_dbg_heap_elem *elem,
+			   struct mm_heap *heap, uint32_t zone, uint32_t id)
 {
+	uint32_t flags;
+
+	spin_lock_irq(&heap->lock, flags);
+
+	elem->zone = zone;
+	elem->id = id;
+	elem->caps = heap->caps;
+	elem->size = heap->size;
+	elem->used = heap->info.used;
+	elem->free = heap->info.free;
+	elem->peak_used = heap->peak_used;
+	elem->alloc_fails = heap->alloc_fails;
+
+	/* system heap is a simple bump allocator without block maps */
+	if (zone == SOF_IPC_HEAP_ZONE_SYS)
+		elem->largest_free = heap->info.free;
+	else
+		elem->largest_free = heap_largest_free(heap);
+
+	spin_unlock_irq(&heap->lock, flags);
+
+	platform_shared_commit(heap, sizeof(*heap));
+}
+
+int heap_info_get(struct sof_ipc_dbg_heap_info *info, uint32_t max_size)
+{
+	struct mm *memmap = memmap_get();
+	struct {
+		struct mm_heap *heap;
+		int count;
+		uint32_t zone;
+	} zones[] = {
+		{ memmap->system, PLATFORM_HEAP_SYSTEM,
+		  SOF_IPC_HEAP_ZONE_SYS },
+		{ memmap->system_runtime, PLATFORM_HEAP_SYSTEM_RUNTIME,
+		  SOF_IPC_HEAP_ZONE_SYS_RUNTIME },
+		{ memmap->runtime, PLATFORM_HEAP_RUNTIME,
+		  SOF_IPC_HEAP_ZONE_RUNTIME },
+		{ memmap->buffer, PLATFORM_HEAP_BUFFER,
+		  SOF_IPC_HEAP_ZONE_BUFFER },
+	};
+	uint32_t i;
+	int j;
+
+	if (max_size < sizeof(*info))
+		return -EINVAL;
+
+	info->rhdr.hdr.size = sizeof(*info);
+	info->num_elems = 0;
+	info->total_elems = 0;
+
+	for (i = 0; i < ARRAY_SIZE(zones); i++) {
+		for (j = 0; j < zones[i].count; j++) {
+			info->total_elems++;
+
+			/* report as many heaps as fit in the reply */
+			if (info->rhdr.hdr.size + sizeof(*info->elems) >
+			    max_size)
+				continue;
+
+			heap_info_fill(&info->elems[info->num_elems],
+				       &zones[i].heap[j], zones[i].zone, j);
+			info->num_elems++;
+			info->rhdr.hdr.size += sizeof(*info->elems);
+		}
+	}
+
+	platform_shared_commit(memmap, sizeof(*memmap));
+
 	return 0;
 }
 
+#if CONFIG_DEBUG_MEM_OWNER
+static void heap_owner_walk(struct mm_heap *heap,
+			    void (*fn)(void *arg, uint32_t owner,
+				       uint32_t bytes),
+			    void *arg)
+{
+	struct block_map *map;
+	struct block_hdr *hdr;
+	uint32_t flags;
+	int i;
+	int j;
+
+	spin_lock_irq(&heap->lock, flags);
+
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+
+		/* first block of an allocation has its size */
+		for (j = 0; j < map->count; j++) {
+			hdr = &map->block[j];
+			if (hdr->used && hdr->size &&
+			    hdr->owner != ALLOC_OWNER_NONE)
+				fn(arg, hdr->owner,
+				   hdr->size * map->block_size);
+		}
+
+		platform_shared_commit(map, sizeof(*map));
+	}
+
+	spin_unlock_irq(&heap->lock, flags);
+
+	platform_shared_commit(heap, sizeof(*heap));
+}
+
+void alloc_owner_walk(void (*fn)(void *arg, uint32_t owner, uint32_t bytes),
+		      void *arg)
+{
+	struct mm *memmap = memmap_get();
+	int i;
+
+	/* system heap isn't freeable, it has no block headers */
+	for (i = 0; i < PLATFORM_HEAP_SYSTEM_RUNTIME; i++)
+		heap_owner_walk(&memmap->system_runtime[i], fn, arg);
+	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++)
+		heap_owner_walk(&memmap->runtime[i], fn, arg);
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++)
+		heap_owner_walk(&memmap->buffer[i], fn, arg);
+
+	platform_shared_commit(memmap, sizeof(*memmap));
+}
+#endif
+
+/* copies one context region to or from the host, only counts its size
+ * when there is no DMA
+ */
+static int pm_ctx_copy(struct dma_copy *dc, struct dma_sg_config *sg,
+		       uint32_t offset, void *ptr, uint32_t size, bool save)
+{
+	int ret;
+
+	if (!dc)
+		return size;
+
+	if (save) {
+		dcache_writeback_region(ptr, size);
+		return dma_copy_to_host(dc, sg, offset, ptr, size);
+	}
+
+	ret = dma_copy_from_host(dc, sg, offset, ptr, size);
+	dcache_invalidate_region(ptr, size);
+
+	return ret;
+}
+
+/* Walks the heap state followed by the runs of used blocks. Free blocks
+ * are skipped, so the context is only as big as the allocations.
+ */
+static int heap_pm_context(struct mm_heap *heap, struct dma_copy *dc,
+			   struct dma_sg_config *sg, uint32_t offset,
+			   bool save)
+{
+	struct block_map *map;
+	uint32_t start = offset;
+	uint32_t run;
+	int ret;
+	int i;
+	int j;
+
+	ret = pm_ctx_copy(dc, sg, offset, &heap->info, sizeof(heap->info),
+			  save);
+	if (ret < 0)
+		return ret;
+	offset += ret;
+
+	ret = pm_ctx_copy(dc, sg, offset, heap->map,
+			  sizeof(*heap->map) * heap->blocks, save);
+	if (ret < 0)
+		return ret;
+	offset += ret;
+
+	if (dc && !save)
+		heap_bank_reset(heap);
+
+	for (i = 0; i < heap->blocks; i++) {
+		map = &heap->map[i];
+
+		ret = pm_ctx_copy(dc, sg, offset, map->block,
+				  sizeof(*map->block) * map->count, save);
+		if (ret < 0)
+			return ret;
+		offset += ret;
+
+		for (j = 0; j < map->count; j += run) {
+			if (!map->block[j].used) {
+				run = 1;
+				continue;
+			}
+
+			for (run = 1; j + run < map->count; run++)
+				if (!map->block[j + run].used)
+					break;
+
+			if (dc && !save)
+				heap_bank_use(heap,
+					      map->base + j * map->block_size,
+					      run * map->block_size, true);
+
+			ret = pm_ctx_copy(dc, sg, offset,
+					  (void *)(map->base +
+						   j * map->block_size),
+					  run * map->block_size, save);
+			if (ret < 0)
+				return ret;
+			offset += ret;
+		}
+
+		platform_shared_commit(map->block,
+				       sizeof(*map->block) * map->count);
+		platform_shared_commit(map, sizeof(*map));
+	}
+
+	platform_shared_commit(heap, sizeof(*heap));
+
+	return offset - start;
+}
+
+/* Walks the heaps holding pipeline, component and buffer state. The system
+ * heaps are rebuilt by every boot and are not part of the context.
+ */
+static int mm_pm_context(struct dma_copy *dc, struct dma_sg_config *sg,
+			 bool save)
+{
+	struct mm *memmap = memmap_get();
+	uint32_t offset = 0;
+	int ret;
+	int i;
+
+	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++) {
+		ret = heap_pm_context(&memmap->runtime[i], dc, sg, offset,
+				      save);
+		if (ret < 0)
+			return ret;
+		offset += ret;
+	}
+
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++) {
+		ret = heap_pm_context(&memmap->buffer[i], dc, sg, offset,
+				      save);
+		if (ret < 0)
+			return ret;
+		offset += ret;
+	}
+
+	platform_shared_commit(memmap, sizeof(*memmap));
+
+	return offset;
+}
+
+uint32_t mm_pm_context_size(void)
+{
+	return mm_pm_context(NULL, NULL, true);
+}
+
 /*
  * Save the DSP memories that are in use the system and modules.
  * All pipeline and modules must be disabled before calling this functions.
  * No allocations are permitted after calling this and before calling restore.
+ * Returns the number of bytes written to the host buffer.
  */
 int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg)
 {
-	return -ENOTSUP;
+	int ret;
+
+	ret = mm_pm_context(dc, sg, true);
+	if (ret < 0)
+		trace_mem_error("mm_pm_context_save() error: %d", ret);
+
+	return ret;
 }
 
 /*
  * Restore the DSP memories to modules and the system.
  * This must be called immediately after booting before any pipeline work.
+ * Returns the number of bytes read from the host buffer.
  */
 int mm_pm_context_restore(struct dma_copy *dc, struct dma_sg_config *sg)
 {
-	return -ENOTSUP;
+	int ret;
+
+	ret = mm_pm_context(dc, sg, false);
+	if (ret < 0)
+		trace_mem_error("mm_pm_context_restore() error: %d", ret);
+
+	return ret;
 }
 
 void free_heap(enum mem_zone zone)
@@ -1069,6 +1630,40 @@ void heap_trace_all(int force) { }
 void heap_trace(struct mm_heap *heap, int size) { }
 #endif
 
+static void init_heap_locks(struct mm_heap *heap, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		spinlock_init(&heap[i].lock);
+		spinlock_name(&heap[i].lock, "heap");
+	}
+}
+
+/* adds heaps to the address range table kept sorted by start address */
+static void init_heap_ranges(struct mm *memmap, struct mm_heap *heap,
+			     int count)
+{
+	struct mm_heap_range *range = memmap->heap_range;
+	int i;
+	int j;
+
+	for (i = 0; i < count; i++) {
+		if (!heap[i].size)
+			continue;
+
+		j = memmap->heap_range_count++;
+		while (j > 0 && range[j - 1].start > heap[i].heap) {
+			range[j] = range[j - 1];
+			j--;
+		}
+
+		range[j].start = heap[i].heap;
+		range[j].end = heap[i].heap + heap[i].size;
+		range[j].heap = &heap[i];
+	}
+}
+
 /* initialise map */
 void init_heap(struct sof *sof)
 {
@@ -1085,6 +1680,8 @@ void init_heap(struct sof *sof)
 
 	init_heap_map(memmap->buffer, PLATFORM_HEAP_BUFFER);
 
+	heap_bank_init(memmap->buffer, PLATFORM_HEAP_BUFFER);
+
 #if CONFIG_DEBUG_BLOCK_FREE
 	write_pattern((struct mm_heap *)&memmap->buffer, PLATFORM_HEAP_BUFFER,
 		      DEBUG_BLOCK_FREE_VALUE_8BIT);
@@ -1092,7 +1689,16 @@ void init_heap(struct sof *sof)
 		      DEBUG_BLOCK_FREE_VALUE_8BIT);
 #endif
 
-	spinlock_init(&memmap->lock);
+	init_heap_locks(memmap->system, PLATFORM_HEAP_SYSTEM);
+	init_heap_locks(memmap->system_runtime, PLATFORM_HEAP_SYSTEM_RUNTIME);
+	init_heap_locks(memmap->runtime, PLATFORM_HEAP_RUNTIME);
+	init_heap_locks(memmap->buffer, PLATFORM_HEAP_BUFFER);
+
+	memmap->heap_range_count = 0;
+	init_heap_ranges(memmap, memmap->system_runtime,
+			 PLATFORM_HEAP_SYSTEM_RUNTIME);
+	init_heap_ranges(memmap, memmap->runtime, PLATFORM_HEAP_RUNTIME);
+	init_heap_ranges(memmap, memmap->buffer, PLATFORM_HEAP_BUFFER);
 
 	platform_shared_commit(memmap, sizeof(*memmap));
 }
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/common.h>
+#include <sof/lib/cache.h>
+#include <sof/lib/cache_batch.h>
+#include <sof/lib/memory.h>
+#include <sof/math/numbers.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void cache_batch_add(struct cache_batch *batch, void *addr, size_t size)
+{
+	struct cache_batch_range *range;
+	uintptr_t start;
+	uintptr_t end;
+	uint32_t i;
+
+	if (!size)
+		return;
+
+	start = ALIGN_DOWN((uintptr_t)addr, PLATFORM_DCACHE_ALIGN);
+	end = ALIGN_UP((uintptr_t)addr + size, PLATFORM_DCACHE_ALIGN);
+
+	/* take over ranges the region overlaps or touches, the grown region
+	 * may reach more of them
+	 */
+	i = 0;
+	while (i < batch->count) {
+		range = &batch->range[i];
+		if (start > range->end || end < range->start) {
+			i++;
+			continue;
+		}
+
+		start = MIN(start, range->start);
+		end = MAX(end, range->end);
+		batch->size -= range->end - range->start;
+		*range = batch->range[--batch->count];
+		i = 0;
+	}
+
+	if (batch->count == CACHE_BATCH_RANGES)
+		cache_batch_flush(batch);
+
+	range = &batch->range[batch->count++];
+	range->start = start;
+	range->end = end;
+	batch->size += end - start;
+}
+
+void cache_batch_flush(struct cache_batch *batch)
+{
+	struct cache_batch_range *range;
+	uint32_t i;
+
+	if (!batch->count)
+		return;
+
+	/* Whole cache is cheaper than many lines. Invalidation writes dirty
+	 * lines back first, data outside the batch may be dirty.
+	 */
+	if (CONFIG_CACHE_BATCH_ALL_SIZE &&
+	    batch->size >= CONFIG_CACHE_BATCH_ALL_SIZE) {
+		if (batch->op == CACHE_WRITEBACK)
+			dcache_writeback_all();
+		else
+			dcache_writeback_invalidate_all();
+	} else {
+		for (i = 0; i < batch->count; i++) {
+			range = &batch->range[i];
+			if (batch->op == CACHE_WRITEBACK)
+				dcache_writeback_region((void *)range->start,
+							range->end -
+							range->start);
+			else
+				dcache_invalidate_region((void *)range->start,
+							 range->end -
+							 range->start);
+		}
+	}
+
+	batch->count = 0;
+	batch->size = 0;
+}
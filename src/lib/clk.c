@@ -9,12 +9,16 @@
 
 #include <sof/drivers/timer.h>
 #include <sof/lib/clk.h>
+#include <sof/lib/cpu.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/notifier.h>
+#include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
+#include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* clock tracing */
@@ -118,3 +122,185 @@ void platform_timer_set_delta(struct timer *timer, uint64_t ns)
 	platform_shared_commit(clk_info, sizeof(*clk_info));
 	platform_shared_commit(timer, sizeof(*timer));
 }
+
+#if CONFIG_CLK_GOVERNOR
+/* measurement windows kept at max frequency after a pipeline start */
+#define CLK_GOV_BOOST_WINDOWS	2
+
+/* demand of each core, every entry is written only by its own core */
+struct clock_gov {
+	uint32_t declared_mcps[PLATFORM_CORE_COUNT];	/* running pipelines */
+	uint32_t measured_mcps[PLATFORM_CORE_COUNT];	/* last LL window */
+	uint32_t boost[PLATFORM_CORE_COUNT];		/* windows left at max */
+
+	/* streams holding each frequency floor */
+	uint16_t floor_refs[PLATFORM_CORE_COUNT][CLOCK_GOV_FLOORS];
+};
+
+/* demand of all cores is needed by each of them, so it lives in shared
+ * memory
+ */
+static SHARED_DATA struct clock_gov clk_gov;
+
+static struct clock_gov *clock_gov_get(void)
+{
+	return platform_shared_get(&clk_gov, sizeof(clk_gov));
+}
+
+/* highest demand of all cores in Hz including headroom, returns UINT32_MAX
+ * while any core is boosted
+ */
+static uint32_t clock_gov_demand(struct clock_gov *gov)
+{
+	uint64_t mcps = 0;
+	uint64_t hz;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (gov->boost[i])
+			return UINT32_MAX;
+
+		mcps = MAX(mcps, MAX(gov->declared_mcps[i],
+				     gov->measured_mcps[i]));
+	}
+
+	hz = mcps * 1000000 * (100 + CONFIG_CLK_GOVERNOR_HEADROOM) / 100;
+
+	return MIN(hz, UINT32_MAX);
+}
+
+/* highest frequency floor held on any core */
+static int clock_gov_floor(struct clock_gov *gov)
+{
+	int floor = CLOCK_GOV_FLOOR_NONE;
+	int i;
+	int j;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		for (j = floor + 1; j < CLOCK_GOV_FLOORS; j++)
+			if (gov->floor_refs[i][j])
+				floor = j;
+
+	return floor;
+}
+
+/* Sets the lowest CPU frequency meeting the demand. Frequency is raised at
+ * once, but lowered only by one step per measurement window unless there is
+ * no demand at all, so a single light window doesn't drop it too far.
+ */
+static void clock_gov_update(struct clock_gov *gov, bool window)
+{
+	int clock = CLK_CPU(cpu_get_id());
+	struct clock_info *clk_info = clocks_get() + clock;
+	uint32_t demand = clock_gov_demand(gov);
+	uint32_t max = clk_info->freqs[clk_info->freqs_num - 1].freq;
+	uint32_t cur = clk_info->current_freq_idx;
+	uint32_t idx;
+
+	switch (clock_gov_floor(gov)) {
+	case CLOCK_GOV_FLOOR_MAX:
+		demand = max;
+		break;
+	case CLOCK_GOV_FLOOR_HALF:
+		demand = MAX(demand, max / 2);
+		break;
+	default:
+		break;
+	}
+
+	idx = clock_get_nearest_freq_idx(clk_info->freqs, clk_info->freqs_num,
+					 demand);
+
+	if (idx < cur && demand)
+		idx = window ? cur - 1 : cur;
+
+	platform_shared_commit(clk_info, sizeof(*clk_info));
+
+	if (idx == cur)
+		return;
+
+	tracev_clk("clock_gov_update() clock %d demand %u idx %u -> %u",
+		   clock, demand, cur, idx);
+
+	clock_set_freq(clock, clk_info->freqs[idx].freq);
+}
+
+/* new pipeline has no measured load yet, so run at max frequency for
+ * a couple of windows before following the measurements
+ */
+void clock_gov_pipeline_start(int core, uint32_t mcps)
+{
+	struct clock_gov *gov = clock_gov_get();
+
+	gov->declared_mcps[core] += mcps;
+	gov->boost[core] = CLK_GOV_BOOST_WINDOWS;
+
+	clock_gov_update(gov, false);
+
+	platform_shared_commit(gov, sizeof(*gov));
+}
+
+/* measured load still includes the stopped pipeline, so the frequency is
+ * only lowered on the next measurement window
+ */
+void clock_gov_pipeline_stop(int core, uint32_t mcps)
+{
+	struct clock_gov *gov = clock_gov_get();
+
+	gov->declared_mcps[core] -= MIN(mcps, gov->declared_mcps[core]);
+
+	platform_shared_commit(gov, sizeof(*gov));
+}
+
+/* measured LL load of the core, reported after each window and with zero
+ * when the core has no more LL tasks, which also ends its boost
+ */
+void clock_gov_load(int core, uint32_t mcps)
+{
+	struct clock_gov *gov = clock_gov_get();
+
+	gov->measured_mcps[core] = mcps;
+	if (!mcps)
+		gov->boost[core] = 0;
+	else if (gov->boost[core])
+		gov->boost[core]--;
+
+	clock_gov_update(gov, true);
+
+	platform_shared_commit(gov, sizeof(*gov));
+}
+
+/* floor is applied at once, so a stream starts on the clock it needs */
+void clock_gov_floor_get(int core, int floor)
+{
+	struct clock_gov *gov = clock_gov_get();
+
+	gov->floor_refs[core][floor]++;
+
+	clock_gov_update(gov, false);
+
+	platform_shared_commit(gov, sizeof(*gov));
+}
+
+/* frequency follows the load down from the next measurement window */
+void clock_gov_floor_put(int core, int floor)
+{
+	struct clock_gov *gov = clock_gov_get();
+
+	if (gov->floor_refs[core][floor])
+		gov->floor_refs[core][floor]--;
+
+	platform_shared_commit(gov, sizeof(*gov));
+}
+
+/* LL load of the core measured over the last window */
+uint32_t clock_gov_core_load(int core)
+{
+	struct clock_gov *gov = clock_gov_get();
+	uint32_t mcps = gov->measured_mcps[core];
+
+	platform_shared_commit(gov, sizeof(*gov));
+
+	return mcps;
+}
+#endif /* CONFIG_CLK_GOVERNOR */
@@ -7,10 +7,12 @@
 #include <sof/atomic.h>
 #include <sof/audio/audio_stream.h>
 #include <sof/audio/buffer.h>
+#include <sof/audio/pcm_converter.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/memory.h>
+#include <sof/math/numbers.h>
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
 #include <ipc/topology.h>
@@ -146,18 +148,16 @@ void dma_put(struct dma *dma)
 	spin_unlock(&dma->lock);
 }
 
-int dma_sg_alloc(struct dma_sg_elem_array *elem_array,
-		 enum mem_zone zone,
-		 uint32_t direction,
-		 uint32_t buffer_count, uint32_t buffer_bytes,
-		 uintptr_t dma_buffer_addr, uintptr_t external_addr)
+static void dma_sg_fill(struct dma_sg_elem_array *elem_array,
+			uint32_t direction,
+			uint32_t buffer_count, uint32_t buffer_bytes,
+			uintptr_t dma_buffer_addr, uintptr_t external_addr)
 {
 	int i;
 
-	elem_array->elems = rzalloc(zone, 0, SOF_MEM_CAPS_RAM,
-				    sizeof(struct dma_sg_elem) * buffer_count);
-	if (!elem_array->elems)
-		return -ENOMEM;
+	/* DMA takes buffers accessed uncached at their cached address */
+	if (is_uncached(dma_buffer_addr))
+		dma_buffer_addr = uncache_to_cache(dma_buffer_addr);
 
 	for (i = 0; i < buffer_count; i++) {
 		elem_array->elems[i].size = buffer_bytes;
@@ -177,6 +177,40 @@ int dma_sg_alloc(struct dma_sg_elem_array *elem_array,
 		dma_buffer_addr += buffer_bytes;
 	}
 	elem_array->count = buffer_count;
+}
+
+int dma_sg_alloc(struct dma_sg_elem_array *elem_array,
+		 enum mem_zone zone,
+		 uint32_t direction,
+		 uint32_t buffer_count, uint32_t buffer_bytes,
+		 uintptr_t dma_buffer_addr, uintptr_t external_addr)
+{
+	elem_array->elems = rzalloc(zone, 0, SOF_MEM_CAPS_RAM,
+				    sizeof(struct dma_sg_elem) * buffer_count);
+	if (!elem_array->elems)
+		return -ENOMEM;
+
+	dma_sg_fill(elem_array, direction, buffer_count, buffer_bytes,
+		    dma_buffer_addr, external_addr);
+	return 0;
+}
+
+int dma_sg_update(struct dma_sg_elem_array *elem_array,
+		  enum mem_zone zone,
+		  uint32_t direction,
+		  uint32_t buffer_count, uint32_t buffer_bytes,
+		  uintptr_t dma_buffer_addr, uintptr_t external_addr)
+{
+	/* elements can be reused if there are as many as needed */
+	if (elem_array->count != buffer_count) {
+		dma_sg_free(elem_array);
+		return dma_sg_alloc(elem_array, zone, direction, buffer_count,
+				    buffer_bytes, dma_buffer_addr,
+				    external_addr);
+	}
+
+	dma_sg_fill(elem_array, direction, buffer_count, buffer_bytes,
+		    dma_buffer_addr, external_addr);
 	return 0;
 }
 
@@ -186,17 +220,36 @@ void dma_sg_free(struct dma_sg_elem_array *elem_array)
 	dma_sg_init(elem_array);
 }
 
+uint32_t dma_buffer_period_count(uint32_t period_bytes, uint32_t period_count,
+				 uint32_t align)
+{
+	/* smallest number of periods giving aligned size */
+	uint32_t step = align / gcd(period_bytes, align);
+
+	return ceil_divide(period_count, step) * step;
+}
+
 void dma_buffer_copy_from(struct comp_buffer *source, uint32_t source_bytes,
 			  struct comp_buffer *sink, uint32_t sink_bytes,
-			  dma_process_func process, uint32_t samples)
+			  dma_process_func process, uint32_t samples,
+			  const struct pcm_chmap *chmap)
 {
 	struct audio_stream *istream = &source->stream;
 
 	/* source buffer contains data copied by DMA */
 	audio_stream_invalidate(istream, source_bytes);
 
+	/* paused or muted streams, the data flow skips processing of these */
+	if (audio_stream_is_zero(istream, istream->r_ptr, source_bytes))
+		buffer_mark_silence(sink);
+
 	/* process data */
-	process(istream, 0, &sink->stream, 0, samples);
+	if (chmap)
+		pcm_chmap_copy(istream, &sink->stream,
+			       source_bytes / audio_stream_frame_bytes(istream),
+			       chmap);
+	else
+		process(istream, 0, &sink->stream, 0, samples);
 
 	buffer_writeback(sink, sink_bytes);
 
@@ -208,14 +261,20 @@ void dma_buffer_copy_from(struct comp_buffer *source, uint32_t source_bytes,
 
 void dma_buffer_copy_to(struct comp_buffer *source, uint32_t source_bytes,
 			struct comp_buffer *sink, uint32_t sink_bytes,
-			dma_process_func process, uint32_t samples)
+			dma_process_func process, uint32_t samples,
+			const struct pcm_chmap *chmap)
 {
 	struct audio_stream *ostream = &sink->stream;
 
 	buffer_invalidate(source, source_bytes);
 
 	/* process data */
-	process(&source->stream, 0, ostream, 0, samples);
+	if (chmap)
+		pcm_chmap_copy(&source->stream, ostream,
+			       sink_bytes / audio_stream_frame_bytes(ostream),
+			       chmap);
+	else
+		process(&source->stream, 0, ostream, 0, samples);
 
 	/* sink buffer contains data meant to copied to DMA */
 	audio_stream_writeback(ostream, sink_bytes);
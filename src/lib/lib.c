@@ -17,15 +17,25 @@ void *memcpy(void *dest, const void *src, size_t n)
 	return dest;
 }
 
-/* generic memset */
+/* generic memset, fills whole words between unaligned ends */
 void *memset(void *s, int c, size_t n)
 {
 	uint8_t *d8 = s;
 	uint8_t v = c;
-	int i;
+	uint32_t v32 = v * 0x01010101;
+	uint32_t *d32;
 
-	for (i = 0; i <	n; i++)
-		d8[i] = v;
+	while (n && ((uintptr_t)d8 & (sizeof(uint32_t) - 1))) {
+		*d8++ = v;
+		n--;
+	}
+
+	for (d32 = (uint32_t *)d8; n >= sizeof(uint32_t);
+	     n -= sizeof(uint32_t))
+		*d32++ = v32;
+
+	for (d8 = (uint8_t *)d32; n; n--)
+		*d8++ = v;
 
 	return s;
 }
@@ -14,7 +14,10 @@
 #include <sof/lib/notifier.h>
 #include <sof/list.h>
 #include <sof/sof.h>
+#include <sof/spinlock.h>
 #include <ipc/topology.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #define trace_notifier(__e, ...) \
 	trace_event(TRACE_CLASS_NOTIFIER, __e, ##__VA_ARGS__)
@@ -23,7 +26,7 @@
 #define trace_notifier_error(__e, ...) \
 	trace_error(TRACE_CLASS_NOTIFIER, __e, ##__VA_ARGS__)
 
-static SHARED_DATA struct notify_data notify_data[PLATFORM_CORE_COUNT];
+static SHARED_DATA struct notify_queue notify_queue[PLATFORM_CORE_COUNT];
 
 struct callback_handle {
 	void *receiver;
@@ -32,6 +35,23 @@ struct callback_handle {
 	struct list_item list;
 };
 
+static struct mem_cache handle_cache =
+	MEM_CACHE_INIT(struct callback_handle, SOF_MEM_ZONE_SYS_RUNTIME, 0,
+		       SOF_MEM_CAPS_RAM, 8);
+
+/* list of handles registered for the given caller */
+static struct list_item *notifier_caller_list(struct notify *notify,
+					      enum notify_id type,
+					      const void *caller)
+{
+	uintptr_t key = (uintptr_t)caller;
+
+	/* callers are at least word aligned objects, so skip the low bits */
+	key = (key >> 2) ^ (key >> 8);
+
+	return &notify->caller_list[type][key & (NOTIFIER_BUCKETS - 1)];
+}
+
 int notifier_register(void *receiver, void *caller, enum notify_id type,
 		      void (*cb)(void *arg, enum notify_id type, void *data))
 {
@@ -40,8 +60,7 @@ int notifier_register(void *receiver, void *caller, enum notify_id type,
 
 	assert(type >= NOTIFIER_ID_CPU_FREQ && type < NOTIFIER_ID_COUNT);
 
-	handle = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-			 sizeof(*handle));
+	handle = mem_cache_zalloc(&handle_cache);
 
 	if (!handle) {
 		trace_notifier_error("notifier_register(): callback handle allocation failed.");
@@ -52,18 +71,38 @@ int notifier_register(void *receiver, void *caller, enum notify_id type,
 	handle->caller = caller;
 	handle->cb = cb;
 
-	list_item_prepend(&handle->list, &notify->list[type]);
+	/* handles for a specific caller are only visited by its events */
+	if (caller)
+		list_item_prepend(&handle->list,
+				  notifier_caller_list(notify, type, caller));
+	else
+		list_item_prepend(&handle->list, &notify->list[type]);
 
 	return 0;
 }
 
-void notifier_unregister(void *receiver, void *caller, enum notify_id type)
+static void notifier_unregister_list(struct list_item *list, void *receiver,
+				     void *caller)
 {
-	struct notify *notify = *arch_notify_get();
 	struct list_item *wlist;
 	struct list_item *tlist;
 	struct callback_handle *handle;
 
+	list_for_item_safe(wlist, tlist, list) {
+		handle = container_of(wlist, struct callback_handle, list);
+		if ((!receiver || handle->receiver == receiver) &&
+		    (!caller || handle->caller == caller)) {
+			list_item_del(&handle->list);
+			mem_cache_free(&handle_cache, handle);
+		}
+	}
+}
+
+void notifier_unregister(void *receiver, void *caller, enum notify_id type)
+{
+	struct notify *notify = *arch_notify_get();
+	int i;
+
 	assert(type >= NOTIFIER_ID_CPU_FREQ && type < NOTIFIER_ID_COUNT);
 
 	/*
@@ -76,14 +115,18 @@ void notifier_unregister(void *receiver, void *caller, enum notify_id type)
 	 * Event consumer might unregister from all callers by passing caller
 	 * NULL
 	 */
-	list_for_item_safe(wlist, tlist, &notify->list[type]) {
-		handle = container_of(wlist, struct callback_handle, list);
-		if ((!receiver || handle->receiver == receiver) &&
-		    (!caller || handle->caller == caller)) {
-			list_item_del(&handle->list);
-			rfree(handle);
-		}
+	if (caller) {
+		notifier_unregister_list(notifier_caller_list(notify, type,
+							      caller),
+					 receiver, caller);
+		return;
 	}
+
+	notifier_unregister_list(&notify->list[type], receiver, NULL);
+
+	for (i = 0; i < NOTIFIER_BUCKETS; i++)
+		notifier_unregister_list(&notify->caller_list[type][i],
+					 receiver, NULL);
 }
 
 void notifier_unregister_all(void *receiver, void *caller)
@@ -94,70 +137,124 @@ void notifier_unregister_all(void *receiver, void *caller)
 		notifier_unregister(receiver, caller, i);
 }
 
-static void notifier_notify(const void *caller, enum notify_id type, void *data)
+static void notifier_notify_list(struct list_item *list, const void *caller,
+				 enum notify_id type, void *data)
 {
-	struct notify *notify = *arch_notify_get();
 	struct list_item *wlist;
 	struct list_item *tlist;
 	struct callback_handle *handle;
 
-	/* iterate through notifiers and send event to
-	 * interested clients
-	 */
-	list_for_item_safe(wlist, tlist, &notify->list[type]) {
+	list_for_item_safe(wlist, tlist, list) {
 		handle = container_of(wlist, struct callback_handle, list);
 		if (!caller || !handle->caller || handle->caller == caller)
 			handle->cb(handle->receiver, type, data);
 	}
 }
 
-void notifier_notify_remote(void)
+static void notifier_notify(const void *caller, enum notify_id type, void *data)
 {
 	struct notify *notify = *arch_notify_get();
-	struct notify_data *notify_data = notify_data_get() + cpu_get_id();
+	int i;
 
-	if (!list_is_empty(&notify->list[notify_data->type])) {
-		dcache_invalidate_region(notify_data->data,
-					 notify_data->data_size);
-		notifier_notify(notify_data->caller, notify_data->type,
-				notify_data->data);
+	/* iterate through notifiers and send event to
+	 * interested clients, events with caller only visit its own bucket
+	 */
+	if (caller) {
+		notifier_notify_list(notifier_caller_list(notify, type, caller),
+				     caller, type, data);
+	} else {
+		for (i = 0; i < NOTIFIER_BUCKETS; i++)
+			notifier_notify_list(&notify->caller_list[type][i],
+					     NULL, type, data);
+	}
+
+	notifier_notify_list(&notify->list[type], caller, type, data);
+}
+
+void notifier_notify_remote(void)
+{
+	struct notify_queue *queue = notify_queue_get() + cpu_get_id();
+	struct notify_data events[NOTIFIER_REMOTE_EVENTS];
+	uint32_t count;
+	uint32_t flags;
+	uint32_t i;
+
+	/* take all queued events, newer ones will come with next message */
+	spin_lock_irq(&queue->lock, flags);
+
+	count = queue->count;
+	for (i = 0; i < count; i++)
+		events[i] = queue->events[i];
+	queue->count = 0;
+
+	platform_shared_commit(queue, sizeof(*queue));
+
+	spin_unlock_irq(&queue->lock, flags);
+
+	for (i = 0; i < count; i++) {
+		dcache_invalidate_region(events[i].data, events[i].data_size);
+		notifier_notify(events[i].caller, events[i].type,
+				events[i].data);
+	}
+}
+
+static void notifier_event_remote(int core, const void *caller,
+				  enum notify_id type, void *data,
+				  uint32_t data_size)
+{
+	struct notify_queue *queue = notify_queue_get() + core;
+	struct idc_msg notify_msg = { IDC_MSG_NOTIFY, IDC_MSG_NOTIFY_EXT };
+	struct notify_data *event;
+	uint32_t flags;
+	bool send;
+
+	/* NOTE: for transcore events, payload has to
+	 * be allocated on heap, not on stack
+	 */
+	dcache_writeback_region(data, data_size);
+
+	spin_lock_irq(&queue->lock, flags);
+
+	if (queue->count == NOTIFIER_REMOTE_EVENTS) {
+		platform_shared_commit(queue, sizeof(*queue));
+		spin_unlock_irq(&queue->lock, flags);
+		trace_notifier_error("notifier_event(): core %d queue full, type %d dropped",
+				     core, type);
+		return;
 	}
 
-	platform_shared_commit(notify_data, sizeof(*notify_data));
+	event = &queue->events[queue->count];
+	event->caller = caller;
+	event->type = type;
+	event->data = data;
+	event->data_size = data_size;
+
+	/* events queued before the core handles the message go with it */
+	send = !queue->count++;
+
+	platform_shared_commit(queue, sizeof(*queue));
+
+	spin_unlock_irq(&queue->lock, flags);
+
+	if (send) {
+		notify_msg.core = core;
+		idc_send_msg(&notify_msg, IDC_ASYNC);
+	}
 }
 
 void notifier_event(const void *caller, enum notify_id type, uint32_t core_mask,
 		    void *data, uint32_t data_size)
 {
-	struct notify_data *notify_data;
-	struct idc_msg notify_msg = { IDC_MSG_NOTIFY, IDC_MSG_NOTIFY_EXT };
 	int i;
 
 	/* notify selected targets */
 	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
 		if (core_mask & NOTIFIER_TARGET_CORE_MASK(i)) {
-			if (i == cpu_get_id()) {
+			if (i == cpu_get_id())
 				notifier_notify(caller, type, data);
-			} else if (cpu_is_core_enabled(i)) {
-				notify_msg.core = i;
-				notify_data = notify_data_get() + i;
-				notify_data->caller = caller;
-				notify_data->type = type;
-
-				/* NOTE: for transcore events, payload has to
-				 * be allocated on heap, not on stack
-				 */
-				notify_data->data = data;
-				notify_data->data_size = data_size;
-
-				dcache_writeback_region(notify_data->data,
-							data_size);
-
-				platform_shared_commit(notify_data,
-						       sizeof(*notify_data));
-
-				idc_send_msg(&notify_msg, IDC_NON_BLOCKING);
-			}
+			else if (cpu_is_core_enabled(i))
+				notifier_event_remote(i, caller, type, data,
+						      data_size);
 		}
 	}
 }
@@ -166,15 +263,27 @@ void init_system_notify(struct sof *sof)
 {
 	struct notify **notify = arch_notify_get();
 	int i;
+	int j;
 	*notify = rzalloc(SOF_MEM_ZONE_SYS, 0, SOF_MEM_CAPS_RAM,
 			  sizeof(**notify));
 
-	for (i = NOTIFIER_ID_CPU_FREQ; i < NOTIFIER_ID_COUNT; i++)
+	for (i = NOTIFIER_ID_CPU_FREQ; i < NOTIFIER_ID_COUNT; i++) {
 		list_init(&(*notify)->list[i]);
 
-	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID)
-		sof->notify_data = platform_shared_get(notify_data,
-						       sizeof(notify_data));
+		for (j = 0; j < NOTIFIER_BUCKETS; j++)
+			list_init(&(*notify)->caller_list[i][j]);
+	}
+
+	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID) {
+		sof->notify_queue = platform_shared_get(notify_queue,
+							sizeof(notify_queue));
+
+		for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+			spinlock_init(&sof->notify_queue[i].lock);
+
+		platform_shared_commit(sof->notify_queue,
+				       sizeof(notify_queue));
+	}
 }
 
 void free_system_notify(void)
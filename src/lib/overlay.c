@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/lib/cache.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/overlay.h>
+#include <sof/platform.h>
+#include <sof/spinlock.h>
+#include <sof/string.h>
+#include <sof/trace/trace.h>
+#include <user/manifest.h>
+#include <user/trace.h>
+#include <errno.h>
+#include <stdint.h>
+
+#define trace_overlay(__e, ...) \
+	trace_event(TRACE_CLASS_MEM, __e, ##__VA_ARGS__)
+#define trace_overlay_error(__e, ...) \
+	trace_error(TRACE_CLASS_MEM, __e, ##__VA_ARGS__)
+
+/* the ROM copies the image to IMR with the manifest at its base, like the
+ * boot loader reads segments from there
+ */
+#define OVERLAY_IMR_BASE (IMR_BOOT_LDR_MANIFEST_BASE - SOF_MAN_ELF_TEXT_OFFSET)
+
+/* descriptor of overlay ovl, rimage fills in where its code is */
+#define DECLARE_OVERLAY(ovl)						\
+	__section(".overlay_table") struct sof_man_overlay overlay_##ovl = { \
+		.name = #ovl,						\
+	}
+
+/* overlays of components compiled out stay empty */
+DECLARE_OVERLAY(asrc);
+DECLARE_OVERLAY(kwd);
+DECLARE_OVERLAY(tone);
+
+/* overlay in the shared SRAM region, pipelines on any core may map it */
+struct overlay_region {
+	spinlock_t lock;
+	struct sof_man_overlay *mapped;
+	uint32_t users;
+};
+
+static SHARED_DATA struct overlay_region overlay_region;
+
+static struct overlay_region *overlay_region_get(void)
+{
+	return platform_shared_get(&overlay_region, sizeof(overlay_region));
+}
+
+void overlay_init(void)
+{
+	struct overlay_region *region = overlay_region_get();
+
+	spinlock_init(&region->lock);
+	region->mapped = NULL;
+	region->users = 0;
+
+	platform_shared_commit(region, sizeof(*region));
+}
+
+int overlay_map(struct sof_man_overlay *overlay)
+{
+	struct overlay_region *region = overlay_region_get();
+	void *vma = (void *)overlay->vma;
+	void *lma = (void *)(OVERLAY_IMR_BASE + overlay->file_offset);
+	uint32_t flags;
+	int ret = 0;
+
+	/* nothing of it was linked in */
+	if (!overlay->size)
+		return 0;
+
+	spin_lock_irq(&region->lock, flags);
+
+	if (region->mapped != overlay) {
+		if (region->users) {
+			trace_overlay_error("overlay_map() error: region busy with 0x%x, %u users",
+					    region->mapped->file_offset,
+					    region->users);
+			ret = -EBUSY;
+			goto unlock;
+		}
+
+		trace_overlay("overlay_map() 0x%x size %u",
+			      overlay->file_offset, overlay->size);
+
+		dcache_invalidate_region(lma, overlay->size);
+		memcpy_s(vma, overlay->size, lma, overlay->size);
+		dcache_writeback_region(vma, overlay->size);
+
+		region->mapped = overlay;
+	}
+
+	region->users++;
+
+	/* this core may still have code of a former overlay cached */
+	icache_invalidate_region(vma, overlay->size);
+
+unlock:
+	platform_shared_commit(region, sizeof(*region));
+
+	spin_unlock_irq(&region->lock, flags);
+
+	return ret;
+}
+
+void overlay_unmap(struct sof_man_overlay *overlay)
+{
+	struct overlay_region *region = overlay_region_get();
+	uint32_t flags;
+
+	if (!overlay->size)
+		return;
+
+	spin_lock_irq(&region->lock, flags);
+
+	if (region->mapped == overlay && region->users)
+		region->users--;
+
+	platform_shared_commit(region, sizeof(*region));
+
+	spin_unlock_irq(&region->lock, flags);
+}
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/common.h>
+#include <sof/drivers/interrupt.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/scratch.h>
+#include <sof/platform.h>
+#include <sof/trace/trace.h>
+#include <ipc/topology.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* workspace is aligned for 64-bit accumulators */
+#define SCRATCH_ALIGN	8
+
+/* scratch arena of a core, each core has its own cache line */
+struct scratch_arena {
+	void *base;
+	size_t size;
+	size_t used;
+	uint32_t users;		/* prepared components that declared size */
+} __aligned(PLATFORM_DCACHE_ALIGN);
+
+static struct scratch_arena scratch[PLATFORM_CORE_COUNT];
+
+int scratch_reserve(size_t size)
+{
+	struct scratch_arena *arena = &scratch[cpu_get_id()];
+	uint32_t flags;
+	void *old;
+	void *base;
+
+	size = ALIGN_UP(size, SCRATCH_ALIGN);
+
+	if (size > arena->size) {
+		/* the arena can't move under workspace in use */
+		if (arena->used)
+			return -EBUSY;
+
+		base = rballoc(0, SOF_MEM_CAPS_RAM, size);
+		if (!base) {
+			trace_error(TRACE_CLASS_MEM, "scratch_reserve() error: no memory for %u bytes",
+				    (uint32_t)size);
+			return -ENOMEM;
+		}
+
+		/* low latency tasks preempt prepare() */
+		irq_local_disable(flags);
+		old = arena->base;
+		arena->base = base;
+		arena->size = size;
+		irq_local_enable(flags);
+
+		rfree(old);
+	}
+
+	arena->users++;
+
+	return 0;
+}
+
+void scratch_release(void)
+{
+	struct scratch_arena *arena = &scratch[cpu_get_id()];
+	uint32_t flags;
+	void *old;
+
+	if (!arena->users || --arena->users)
+		return;
+
+	irq_local_disable(flags);
+	old = arena->base;
+	arena->base = NULL;
+	arena->size = 0;
+	arena->used = 0;
+	irq_local_enable(flags);
+
+	rfree(old);
+}
+
+void *scratch_alloc(size_t size)
+{
+	struct scratch_arena *arena = &scratch[cpu_get_id()];
+	void *ptr;
+
+	size = ALIGN_UP(size, SCRATCH_ALIGN);
+	if (size > arena->size - arena->used)
+		return NULL;
+
+	ptr = (char *)arena->base + arena->used;
+	arena->used += size;
+
+	return ptr;
+}
+
+size_t scratch_mark(void)
+{
+	return scratch[cpu_get_id()].used;
+}
+
+void scratch_restore(size_t mark)
+{
+	scratch[cpu_get_id()].used = mark;
+}
@@ -6,6 +6,7 @@
 
 #include <sof/audio/format.h>
 #include <sof/math/decibels.h>
+#include <sof/math/numbers.h>
 #include <stdint.h>
 
 #define ONE_Q20         Q_CONVERT_FLOAT(1.0, 20)	  /* Use Q12.20 */
@@ -14,6 +15,12 @@
 #define MINUS_TWO_Q27   Q_CONVERT_FLOAT(-2.0, 27)	  /* Use Q5.27 */
 #define LOG10_DIV20_Q27 Q_CONVERT_FLOAT(0.1151292546, 27) /* Use Q5.27 */
 
+/* Ramp values between exact conversions in db2lin_fixed_block() */
+#define DB2LIN_BLOCK_EXACT 32
+
+/* Q12.32 level below which db2lin_fixed_block() converts every value */
+#define DB2LIN_BLOCK_LOW ((int64_t)Q_CONVERT_FLOAT(0.001, 20) << 12)
+
 /* Exponent function for small values of x. This function calculates
  * fairly accurately exponent for x in range -2.0 .. +2.0. The iteration
  * uses first 11 terms of Taylor series approximation for exponent
@@ -115,3 +122,41 @@ int32_t exp_fixed(int32_t x)
 
 	return y;
 }
+
+/* Multiplies Q12.32 value by Q12.20 ratio in two halves to not overflow */
+static inline int64_t db2lin_ratio_mult(int64_t y, int32_t ratio)
+{
+	return (((y >> 16) * ratio) >> 4) + (((y & 0xffff) * ratio) >> 20);
+}
+
+/* Decibels ramp to linear conversion: Constant step in decibels is a
+ * constant ratio of linear values, so the ramp is computed with one
+ * multiplication per value. The value is kept with 12 more fractional
+ * bits than the output for low levels to follow small steps, and it is
+ * computed exactly with db2lin_fixed() every DB2LIN_BLOCK_EXACT values to
+ * keep the error of the ratio from accumulating. Values below -60 dB are
+ * all computed exactly since rounding of a small start value would be
+ * scaled up by the ratio. For steps up to 1 dB the difference to
+ * db2lin_fixed() stays below 0.02 dB.
+ *
+ * Input is Q8.24 (max 128.0)
+ * output is Q12.20 (max 2048.0)
+ */
+
+void db2lin_fixed_block(int32_t db, int32_t db_step, int32_t *lin, int n)
+{
+	int32_t ratio = db2lin_fixed(db_step);
+	int64_t y = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (!(i % DB2LIN_BLOCK_EXACT) || y < DB2LIN_BLOCK_LOW)
+			y = (int64_t)db2lin_fixed(sat_int32((int64_t)db +
+						  (int64_t)i * db_step)) << 12;
+		else
+			y = MIN(db2lin_ratio_mult(y, ratio),
+				(int64_t)INT32_MAX << 12);
+
+		lin[i] = (int32_t)Q_SHIFT_RND(y, 32, 20);
+	}
+}
@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Fixed point FFT for real signals. A real transform of N points is done as
+ * a complex transform of N / 2 points of the even and odd samples packed as
+ * real and imaginary parts, followed by a split step to the N / 2 + 1 bins.
+ * The complex transform is radix-2 decimation in time on bit reversed data.
+ */
+
+#include <sof/audio/format.h>
+#include <sof/math/fft.h>
+#include <sof/math/trig.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* magnitude bits of x, one's complement keeps it in 31 bits */
+#define FFT_ABS(x)	((uint32_t)((x) ^ ((x) >> 31)))
+
+/* butterfly inputs below this can't overflow with the twiddle gain */
+#define FFT_HEADROOM	(1u << 29)
+
+int fft_plan_init(struct fft_plan *plan, int bits,
+		  struct icomplex32 *twiddle, struct icomplex32 *work)
+{
+	int n = 1 << (bits - 1);
+	int32_t w;
+	int k;
+
+	if (bits < 2 || bits > FFT_MAX_BITS)
+		return -EINVAL;
+
+	plan->bits = bits;
+	plan->twiddle = twiddle;
+	plan->work = work;
+
+	/* exp(-j 2pi k / 2^bits) for k < 2^bits / 2, phase in Q4.28 */
+	for (k = 0; k < n; k++) {
+		w = ((int64_t)PI_MUL2_Q4_28 * k) >> bits;
+		twiddle[k].real = sin_fixed(w + PI_DIV2_Q4_28);
+		twiddle[k].imag = -sin_fixed(w);
+	}
+
+	return 0;
+}
+
+/* right shift that brings peak below the headroom limit */
+static inline int fft_headroom(uint32_t peak)
+{
+	int shift = 0;
+
+	while (peak >= FFT_HEADROOM) {
+		peak >>= 1;
+		shift++;
+	}
+
+	return shift;
+}
+
+static void fft_bit_reverse(struct icomplex32 *x, int bits)
+{
+	struct icomplex32 t;
+	int n = 1 << bits;
+	int i;
+	int j;
+	int k;
+
+	for (i = 0, j = 0; i < n; i++) {
+		if (i < j) {
+			t = x[i];
+			x[i] = x[j];
+			x[j] = t;
+		}
+
+		/* next j in bit reversed order */
+		k = n >> 1;
+		while (j & k) {
+			j ^= k;
+			k >>= 1;
+		}
+		j |= k;
+	}
+}
+
+/* Complex transform of 2^bits points in place with twiddle factors of a
+ * transform twice the size. The forward transform halves every stage. The
+ * inverse uses conjugate twiddles and shifts a stage only as much as peak
+ * of its input needs, the sum of the shifts is returned.
+ */
+static int fft_complex(struct icomplex32 *x, int bits,
+		       const struct icomplex32 *twiddle, uint32_t peak,
+		       bool inverse)
+{
+	struct icomplex32 *a;
+	struct icomplex32 *b;
+	int n = 1 << bits;
+	int stride = n;
+	int shift = 1;
+	int exp = 0;
+	int half;
+	int64_t tr;
+	int64_t ti;
+	int64_t ar;
+	int64_t ai;
+	int32_t wr;
+	int32_t wi;
+	int i;
+	int k;
+
+	fft_bit_reverse(x, bits);
+
+	for (half = 1; half < n; half <<= 1, stride >>= 1) {
+		if (inverse) {
+			shift = fft_headroom(peak);
+			exp += shift;
+			peak = 0;
+		}
+
+		for (k = 0; k < half; k++) {
+			wr = twiddle[k * stride].real;
+			wi = inverse ? -twiddle[k * stride].imag :
+				       twiddle[k * stride].imag;
+
+			for (i = k; i < n; i += half << 1) {
+				a = &x[i];
+				b = &x[i + half];
+				tr = ((int64_t)b->real * wr -
+				      (int64_t)b->imag * wi) >> 31;
+				ti = ((int64_t)b->real * wi +
+				      (int64_t)b->imag * wr) >> 31;
+				ar = a->real;
+				ai = a->imag;
+				a->real = (ar + tr) >> shift;
+				a->imag = (ai + ti) >> shift;
+				b->real = (ar - tr) >> shift;
+				b->imag = (ai - ti) >> shift;
+				if (inverse)
+					peak |= FFT_ABS(a->real) |
+						FFT_ABS(a->imag) |
+						FFT_ABS(b->real) |
+						FFT_ABS(b->imag);
+			}
+		}
+	}
+
+	return exp;
+}
+
+void fft_real(const struct fft_plan *plan, const int32_t *x,
+	      struct icomplex32 *y)
+{
+	struct icomplex32 *z = plan->work;
+	const struct icomplex32 *w;
+	int bits = plan->bits - 1;
+	int n = 1 << bits;
+	int64_t sr;
+	int64_t si;
+	int64_t dr;
+	int64_t di;
+	int64_t pr;
+	int64_t pi;
+	int k;
+
+	/* halved so that packed pairs stay within unit magnitude */
+	for (k = 0; k < n; k++) {
+		z[k].real = x[2 * k] >> 1;
+		z[k].imag = x[2 * k + 1] >> 1;
+	}
+
+	fft_complex(z, bits, plan->twiddle, 0, false);
+
+	y[0].real = sat_int32((int64_t)z[0].real + z[0].imag);
+	y[0].imag = 0;
+	y[n].real = sat_int32((int64_t)z[0].real - z[0].imag);
+	y[n].imag = 0;
+
+	/* X[k] = (S - j W^k D) / 2 of Z[k] and conj(Z[n - k]) */
+	for (k = 1; k < n; k++) {
+		w = &plan->twiddle[k];
+		sr = (int64_t)z[k].real + z[n - k].real;
+		si = (int64_t)z[k].imag - z[n - k].imag;
+		dr = (int64_t)z[k].real - z[n - k].real;
+		di = (int64_t)z[k].imag + z[n - k].imag;
+		pr = (w->real * dr - w->imag * di) >> 31;
+		pi = (w->real * di + w->imag * dr) >> 31;
+		y[k].real = sat_int32((sr + pi) >> 1);
+		y[k].imag = sat_int32((si - pr) >> 1);
+	}
+}
+
+int fft_real_inverse(const struct fft_plan *plan, const struct icomplex32 *x,
+		     int32_t *y)
+{
+	struct icomplex32 *z = plan->work;
+	const struct icomplex32 *w;
+	int bits = plan->bits - 1;
+	int n = 1 << bits;
+	uint32_t peak = 0;
+	int shift = 0;
+	int64_t ar;
+	int64_t ai;
+	int64_t br;
+	int64_t bi;
+	int64_t sr;
+	int64_t si;
+	int64_t dr;
+	int64_t di;
+	int64_t qr;
+	int64_t qi;
+	int exp;
+	int k;
+
+	for (k = 0; k <= n; k++)
+		peak |= FFT_ABS(x[k].real) | FFT_ABS(x[k].imag);
+
+	if (!peak) {
+		for (k = 0; k < 2 * n; k++)
+			y[k] = 0;
+		return 0;
+	}
+
+	/* normalize bins to headroom limit, scaling up small ones */
+	shift = fft_headroom(peak);
+	while (peak < FFT_HEADROOM >> 1) {
+		peak <<= 1;
+		shift--;
+	}
+
+	/* Z[k] = (S + j conj(W^k) D) / 2 of X[k] and conj(X[n - k]) */
+	peak = 0;
+	for (k = 0; k < n; k++) {
+		w = &plan->twiddle[k];
+		ar = x[k].real;
+		ai = x[k].imag;
+		br = x[n - k].real;
+		bi = -(int64_t)x[n - k].imag;
+		if (shift > 0) {
+			ar >>= shift;
+			ai >>= shift;
+			br >>= shift;
+			bi >>= shift;
+		} else {
+			ar <<= -shift;
+			ai <<= -shift;
+			br <<= -shift;
+			bi <<= -shift;
+		}
+
+		sr = ar + br;
+		si = ai + bi;
+		dr = ar - br;
+		di = ai - bi;
+		qr = (w->real * dr + w->imag * di) >> 31;
+		qi = (w->real * di - w->imag * dr) >> 31;
+		z[k].real = (sr - qi) >> 1;
+		z[k].imag = (si + qr) >> 1;
+		peak |= FFT_ABS(z[k].real) | FFT_ABS(z[k].imag);
+	}
+
+	exp = fft_complex(z, bits, plan->twiddle, peak, true);
+
+	for (k = 0; k < n; k++) {
+		y[2 * k] = z[k].real;
+		y[2 * k + 1] = z[k].imag;
+	}
+
+	/* the complex transform lacks the 1 / n of the inverse */
+	return exp + shift - bits;
+}
@@ -8,6 +8,7 @@
 
 #include <sof/audio/format.h>
 #include <sof/math/trig.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #define SINE_C_Q20 341782638 /* 2*SINE_NQUART/pi in Q12.20 */
@@ -550,7 +551,7 @@ static inline int32_t sine_lookup(int idx)
 }
 
 /* Compute fixed point sine with table lookup and interpolation */
-int32_t sin_fixed(int32_t w)
+static inline int32_t sin_fixed_inline(int32_t w)
 {
 	int idx;
 	int32_t frac;
@@ -574,3 +575,105 @@ int32_t sin_fixed(int32_t w)
 
 	return (int32_t)sine;
 }
+
+int32_t sin_fixed(int32_t w)
+{
+	return sin_fixed_inline(w);
+}
+
+/* Compute fixed point sine for phases of a constant frequency tone, without
+ * a call per sample. Phase wraps as in the tone generator.
+ */
+int32_t sin_fixed_block(int32_t w, int32_t w_step, int32_t *y, int n)
+{
+	int64_t next;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		y[i] = sin_fixed_inline(w);
+
+		next = (int64_t)w + w_step;
+		w = next > PI_MUL2_Q4_28 ?
+			(int32_t)(next - PI_MUL2_Q4_28) : (int32_t)next;
+	}
+
+	return w;
+}
+
+/* wraps phase to 0 .. 2pi */
+static inline int32_t sin_phase_wrap(int64_t w)
+{
+	if (w > PI_MUL2_Q4_28)
+		return w - PI_MUL2_Q4_28;
+	if (w < 0)
+		return w + PI_MUL2_Q4_28;
+
+	return w;
+}
+
+void sin_osc_init(struct sin_osc *osc, int32_t w, int32_t w_step)
+{
+	int64_t w_x = (int64_t)w - w_step + PI_DIV2_Q4_28;
+	int i;
+
+	/* sine in Q1.31 is twice the sine in Q2.30 */
+	osc->e = sin_fixed_inline(w_step);
+
+	for (i = 0; i < 2; i++) {
+		osc->y[i] = Q_SHIFT_RND((int64_t)sin_fixed_inline(w), 31, 30);
+		osc->x[i] = Q_SHIFT_RND((int64_t)
+					sin_fixed_inline(sin_phase_wrap(w_x)),
+					31, 30);
+
+		/* odd samples oscillator */
+		w = sin_phase_wrap((int64_t)w + w_step);
+		w_x = sin_phase_wrap(w_x + w_step);
+	}
+}
+
+/* one sample of amplitude a from oscillator state x, y */
+static inline void sin_osc_step(int32_t *x, int32_t *y, int32_t e,
+				int32_t a, int32_t *out, bool add)
+{
+	int64_t sample;
+
+	/* Q2.30 x Q1.31 -> Q1.31 */
+	sample = q_multsr_32x32(*y, a, Q_SHIFT_BITS_64(30, 31, 31));
+	*out = add ? sat_int32(*out + sample) : sat_int32(sample);
+
+	/* rotation has determinant one, x and y keep unit amplitude */
+	*x -= (int32_t)q_multsr_32x32(e, *y, Q_SHIFT_BITS_64(30, 30, 30));
+	*y += (int32_t)q_multsr_32x32(e, *x, Q_SHIFT_BITS_64(30, 30, 30));
+}
+
+void sin_osc_block(struct sin_osc *osc, int32_t a, int32_t *y, int stride,
+		   int n, bool add)
+{
+	int32_t x0 = osc->x[0];
+	int32_t y0 = osc->y[0];
+	int32_t x1 = osc->x[1];
+	int32_t y1 = osc->y[1];
+	int32_t e = osc->e;
+	int i;
+
+	for (i = 0; i < n - 1; i += 2) {
+		sin_osc_step(&x0, &y0, e, a, y, add);
+		sin_osc_step(&x1, &y1, e, a, y + stride, add);
+		y += 2 * stride;
+	}
+
+	/* odd sample, the other oscillator continues */
+	if (i < n) {
+		sin_osc_step(&x0, &y0, e, a, y, add);
+		osc->x[0] = x1;
+		osc->y[0] = y1;
+		osc->x[1] = x0;
+		osc->y[1] = y0;
+		return;
+	}
+
+	osc->x[0] = x0;
+	osc->y[0] = y0;
+	osc->x[1] = x1;
+	osc->y[1] = y1;
+}
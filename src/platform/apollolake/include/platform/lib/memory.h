@@ -122,6 +122,10 @@
 #define LOG_ENTRY_ELF_BASE	0x20000000
 #define LOG_ENTRY_ELF_SIZE	0x2000000
 
+/* load addresses of code overlays, rimage stores them after the image */
+#define OVERLAY_ELF_BASE	0x22000000
+#define OVERLAY_ELF_SIZE	0x100000
+
 /*
  * The HP SRAM Region Apollolake is organised like this :-
  * +--------------------------------------------------------------------------+
@@ -17,6 +17,8 @@ struct idc_msg;
 static inline int idc_send_msg(struct idc_msg *msg,
 			       uint32_t mode) { return 0; }
 
+static inline int idc_wait_async(uint32_t core_mask) { return 0; }
+
 static inline int idc_init(void) { return 0; }
 
 #endif /* __PLATFORM_DRIVERS_IDC_H__ */
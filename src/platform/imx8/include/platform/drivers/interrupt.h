@@ -77,6 +77,16 @@
  */
 int irqstr_get_sof_int(int irqstr_int);
 
+/* irqstr_set_hot() - Dispatch an IRQ_STEER interrupt on the fast path
+ * @irqstr_int Shared IRQ_STEER interrupt
+ *
+ * Frequent interrupts, like the audio DMA ones, skip the lookup of their
+ * handler as long as a single handler is registered for them.
+ *
+ * Return: 0 on success, negative error otherwise
+ */
+int irqstr_set_hot(int irqstr_int);
+
 #if defined CONFIG_IMX8
 #define IRQSTR_BASE_ADDR	0x510A0000
 #elif defined CONFIG_IMX8X
@@ -59,6 +59,11 @@ int dmac_init(struct sof *sof)
 	for (i = 0; i < ARRAY_SIZE(dma); i++)
 		spinlock_init(&dma[i].lock);
 
+	/* EDMA channel interrupts pace the audio, dispatch them first */
+	for (i = 0; i < ARRAY_SIZE(edma0_ints); i++)
+		if (edma0_ints[i])
+			irqstr_set_hot(edma0_ints[i]);
+
 	platform_shared_commit(dma, sizeof(*dma));
 
 	sof->dma_info = &lib_dma;
@@ -145,6 +145,13 @@ int platform_boot_complete(uint32_t boot_message)
 	mailbox_dspbox_write(mb_offset, &user_abi_version,
 			     user_abi_version.ext_hdr.hdr.size);
 
+#if CONFIG_BOOT_PROFILE
+	mb_offset = mb_offset + user_abi_version.ext_hdr.hdr.size;
+
+	mailbox_dspbox_write(mb_offset, &boot_profile,
+			     boot_profile.ext_hdr.hdr.size);
+#endif
+
 	/* now interrupt host to tell it we are done booting */
 	imx_mu_xcr_rmw(IMX_MU_xCR_GIRn(1), 0);
 
@@ -197,12 +204,6 @@ int platform_init(struct sof *sof)
 	if (ret < 0)
 		return -ENODEV;
 
-#if CONFIG_TRACE
-	/* Initialize DMA for Trace*/
-	trace_point(TRACE_BOOT_PLATFORM_DMA_TRACE);
-	dma_trace_init_complete(sof->dmat);
-#endif
-
 	/* show heap status */
 	heap_trace_all(1);
 
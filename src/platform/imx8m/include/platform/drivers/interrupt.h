@@ -87,6 +87,16 @@
  */
 int irqstr_get_sof_int(int irqstr_int);
 
+/* irqstr_set_hot() - Dispatch an IRQ_STEER interrupt on the fast path
+ * @irqstr_int Shared IRQ_STEER interrupt
+ *
+ * Frequent interrupts, like the audio DMA ones, skip the lookup of their
+ * handler as long as a single handler is registered for them.
+ *
+ * Return: 0 on success, negative error otherwise
+ */
+int irqstr_set_hot(int irqstr_int);
+
 #define IRQSTR_BASE_ADDR	0x30A80000
 
 /* The MASK, SET (unused) and STATUS registers are 160-bit registers
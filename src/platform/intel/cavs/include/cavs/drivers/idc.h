@@ -19,12 +19,16 @@ struct idc_msg;
 
 int idc_send_msg(struct idc_msg *msg, uint32_t mode);
 
+int idc_wait_async(uint32_t core_mask);
+
 int idc_init(void);
 
 #else
 
 static inline int idc_send_msg(struct idc_msg *msg, uint32_t mode) { return 0; }
 
+static inline int idc_wait_async(uint32_t core_mask) { return 0; }
+
 static inline int idc_init(void) { return 0; }
 
 #endif
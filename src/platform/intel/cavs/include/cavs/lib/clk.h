@@ -22,6 +22,7 @@
 #include <sof/lib/io.h>
 #include <sof/lib/memory.h>
 #include <sof/lib/shim.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 struct sof;
@@ -44,7 +45,7 @@ extern const uint32_t cpu_freq_status_mask[];
 void platform_clock_init(struct sof *sof);
 
 #if CONFIG_CAVS_USE_LPRO_IN_WAITI
-void platform_clock_on_waiti(void);
+void platform_clock_on_waiti(bool lpro);
 void platform_clock_on_wakeup(void);
 #endif
 
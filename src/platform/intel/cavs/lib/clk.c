@@ -93,13 +93,14 @@ void platform_clock_on_wakeup(void)
 	}
 }
 
-void platform_clock_on_waiti(void)
+void platform_clock_on_waiti(bool lpro)
 {
 	int freq_idx = get_cpu_current_freq_idx();
 
 	*cache_to_uncache(&active_freq_idx) = freq_idx;
 
-	if (freq_idx != CPU_LPRO_FREQ_IDX) {
+	/* short waits keep the active clock, it's restored on wake up */
+	if (lpro && freq_idx != CPU_LPRO_FREQ_IDX) {
 		/* LPRO requests are fast, but requests for other ROs
 		 * can take a lot of time. That's why it's better to
 		 * not release active clock just for waiti,
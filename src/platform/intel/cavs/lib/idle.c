@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Idle governor choosing the idle state of each wait for interrupt */
+
+#include <arch/lib/wait.h>
+#include <cavs/lps_wait.h>
+#include <sof/common.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/idle.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/pm_runtime.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <sof/schedule/ll_schedule_domain.h>
+#include <ipc/trace.h>
+#include <config.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct idle_state_stats {
+	uint32_t entries;
+	uint32_t early;
+	uint64_t residency;	/* in platform timer ticks */
+};
+
+struct idle_stats {
+	uint32_t demoted;
+	struct idle_state_stats state[SOF_IPC_IDLE_STATES];
+};
+
+static SHARED_DATA struct idle_stats idle_stats[PLATFORM_CORE_COUNT];
+
+/* streams limiting each core to each state */
+struct idle_limits {
+	uint16_t refs[SOF_IPC_IDLE_STATES];
+};
+
+static SHARED_DATA struct idle_limits idle_limits[PLATFORM_CORE_COUNT];
+
+/* minimum of states the platform doesn't have */
+#define IDLE_STATE_UNUSED	UINT32_MAX
+
+/* idle time needed to pay off the entry and exit of each state in us */
+static const uint32_t idle_min_us[SOF_IPC_IDLE_STATES] = {
+	[SOF_IPC_IDLE_WAITI] = 0,
+#if CONFIG_CAVS_USE_LPRO_IN_WAITI
+	[SOF_IPC_IDLE_CLK_GATE] = CONFIG_IDLE_CLK_GATE_MIN_US,
+#else
+	[SOF_IPC_IDLE_CLK_GATE] = IDLE_STATE_UNUSED,
+#endif
+#if CONFIG_CAVS_LPS
+	[SOF_IPC_IDLE_LPS] = CONFIG_IDLE_LPS_MIN_US,
+#else
+	[SOF_IPC_IDLE_LPS] = IDLE_STATE_UNUSED,
+#endif
+};
+
+/* deepest state available now, D0i3 only once the host has allowed it */
+static int idle_state_supported(void)
+{
+#if CONFIG_CAVS_LPS
+	if (!pm_runtime_is_active(PM_RUNTIME_DSP, PLATFORM_MASTER_CORE_ID))
+		return SOF_IPC_IDLE_LPS;
+#endif
+#if CONFIG_CAVS_USE_LPRO_IN_WAITI
+	return SOF_IPC_IDLE_CLK_GATE;
+#else
+	return SOF_IPC_IDLE_WAITI;
+#endif
+}
+
+/* deepest state allowed now, also by the streams running on the core */
+static int idle_state_allowed(int core)
+{
+	struct idle_limits *limits;
+	int allowed = idle_state_supported();
+	int state;
+
+	limits = platform_shared_get(&idle_limits[core], sizeof(*limits));
+
+	for (state = SOF_IPC_IDLE_WAITI; state < allowed; state++)
+		if (limits->refs[state])
+			break;
+
+	platform_shared_commit(limits, sizeof(*limits));
+
+	return state;
+}
+
+void idle_limit_get(int core, int state)
+{
+	struct idle_limits *limits;
+
+	limits = platform_shared_get(&idle_limits[core], sizeof(*limits));
+	limits->refs[state]++;
+	platform_shared_commit(limits, sizeof(*limits));
+}
+
+void idle_limit_put(int core, int state)
+{
+	struct idle_limits *limits;
+
+	limits = platform_shared_get(&idle_limits[core], sizeof(*limits));
+	if (limits->refs[state])
+		limits->refs[state]--;
+	platform_shared_commit(limits, sizeof(*limits));
+}
+
+/*
+ * EDF tasks are queued to run at once, so the core only idles when none is
+ * ready and the next LL task of the core is the next known deadline.
+ */
+static uint64_t idle_next_due(int core)
+{
+	struct ll_schedule_domain *domain[] = {
+		timer_domain_get(), dma_domain_get()
+	};
+	uint64_t next = UINT64_MAX;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(domain); i++) {
+		if (!domain[i])
+			continue;
+
+		if (domain[i]->registered[core])
+			next = MIN(next, domain[i]->next_due[core]);
+
+		platform_shared_commit(domain[i], sizeof(*domain[i]));
+	}
+
+	return next;
+}
+
+static void idle_wait(int state, int level)
+{
+	switch (state) {
+#if CONFIG_CAVS_LPS
+	case SOF_IPC_IDLE_LPS:
+		lps_wait_for_interrupt(level);
+		break;
+#endif
+#if CONFIG_CAVS_USE_LPRO_IN_WAITI
+	case SOF_IPC_IDLE_CLK_GATE:
+		platform_clock_on_waiti(true);
+		arch_wait_for_interrupt(level);
+		break;
+#endif
+	default:
+#if CONFIG_CAVS_USE_LPRO_IN_WAITI
+		platform_clock_on_waiti(false);
+#endif
+		arch_wait_for_interrupt(level);
+		break;
+	}
+}
+
+void platform_idle_enter(int level)
+{
+	uint64_t ticks_per_us = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) /
+		1000;
+	uint64_t start = platform_timer_get(timer_get());
+	uint64_t next = idle_next_due(cpu_get_id());
+	uint64_t predicted = next > start ? next - start : 0;
+	int allowed = idle_state_allowed(cpu_get_id());
+	struct idle_stats *stats;
+	uint64_t residency;
+	bool demoted = false;
+	int state;
+
+	stats = platform_shared_get(&idle_stats[cpu_get_id()], sizeof(*stats));
+
+	/* deepest state the predicted idle time pays off */
+	for (state = allowed; state > SOF_IPC_IDLE_WAITI; state--) {
+		if (idle_min_us[state] == IDLE_STATE_UNUSED)
+			continue;
+		if (predicted >= idle_min_us[state] * ticks_per_us)
+			break;
+		demoted = true;
+	}
+
+	if (demoted)
+		stats->demoted++;
+
+	idle_wait(state, level);
+
+	residency = platform_timer_get(timer_get()) - start;
+	stats->state[state].entries++;
+	stats->state[state].residency += residency;
+	if (residency < idle_min_us[state] * ticks_per_us)
+		stats->state[state].early++;
+
+	platform_shared_commit(stats, sizeof(*stats));
+}
+
+int platform_idle_stats_get(struct sof_ipc_dbg_idle_stats *info, int core,
+			    bool reset)
+{
+	uint64_t ticks_per_ms = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+	struct sof_ipc_dbg_idle_elem *elem;
+	struct idle_stats *stats;
+	int i;
+
+	if (core < 0 || core >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	stats = platform_shared_get(&idle_stats[core], sizeof(*stats));
+
+	info->rhdr.hdr.size = sizeof(*info) +
+		SOF_IPC_IDLE_STATES * sizeof(*elem);
+	info->core = core;
+	info->demoted = stats->demoted;
+	info->num_elems = SOF_IPC_IDLE_STATES;
+	info->reserved = 0;
+
+	for (i = 0; i < SOF_IPC_IDLE_STATES; i++) {
+		elem = &info->elems[i];
+		elem->state = i;
+		elem->entries = stats->state[i].entries;
+		elem->residency_us = stats->state[i].residency * 1000 /
+			ticks_per_ms;
+		elem->early = stats->state[i].early;
+		elem->reserved = 0;
+	}
+
+	/* an idle exit of the core racing with the reset may be lost */
+	if (reset) {
+		stats->demoted = 0;
+		for (i = 0; i < SOF_IPC_IDLE_STATES; i++)
+			stats->state[i] = (struct idle_state_stats){ 0 };
+	}
+
+	platform_shared_commit(stats, sizeof(*stats));
+
+	return 0;
+}
@@ -180,7 +180,8 @@ void set_power_gate_for_memory_address_range(void *ptr,
 		ptr = (void *)ALIGN((uintptr_t)ptr, SRAM_BANK_SIZE);
 
 	if ((uintptr_t)end_ptr % SRAM_BANK_SIZE)
-		end_ptr = (void *)ALIGN_DOWN((uintptr_t)ptr, SRAM_BANK_SIZE);
+		end_ptr = (void *)ALIGN_DOWN((uintptr_t)end_ptr,
+					      SRAM_BANK_SIZE);
 
 	/* return if no full bank could be found for enabled gate control */
 	if ((char *)end_ptr - (char *)ptr < SRAM_BANK_SIZE) {
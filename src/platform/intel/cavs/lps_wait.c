@@ -39,7 +39,7 @@ struct lpsram_header {
 #define LPS_POWER_FLOW_D0I3_D0		0
 
 #define LPS_BOOT_STACK_SIZE		4096
-#define PG_TASK_STACK_SIZE		4096
+#define PG_TASK_STACK_SIZE		CONFIG_CAVS_LPS_TASK_STACK_SIZE
 
 __aligned(PLATFORM_DCACHE_ALIGN) uint8_t lps_boot_stack[LPS_BOOT_STACK_SIZE];
 __aligned(PLATFORM_DCACHE_ALIGN) lps_ctx lps_restore;
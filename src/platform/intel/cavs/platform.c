@@ -27,6 +27,7 @@
 #include <sof/lib/cpu.h>
 #include <sof/lib/dai.h>
 #include <sof/lib/dma.h>
+#include <sof/lib/idle.h>
 #include <sof/lib/io.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/memory.h>
@@ -311,6 +312,13 @@ int platform_boot_complete(uint32_t boot_message)
 	mailbox_dspbox_write(mb_offset, &user_abi_version,
 			     user_abi_version.ext_hdr.hdr.size);
 
+#if CONFIG_BOOT_PROFILE
+	mb_offset = mb_offset + user_abi_version.ext_hdr.hdr.size;
+
+	mailbox_dspbox_write(mb_offset, &boot_profile,
+			     boot_profile.ext_hdr.hdr.size);
+#endif
+
 	/* tell host we are ready */
 #if CAVS_VERSION == CAVS_VERSION_1_5
 	ipc_write(IPC_DIPCIE, SRAM_WINDOW_HOST_OFFSET(0) >> 12);
@@ -506,10 +514,6 @@ int platform_init(struct sof *sof)
 	ret = spi_probe(spi_dev);
 	if (ret < 0)
 		return ret;
-#elif CONFIG_TRACE
-	/* Initialize DMA for Trace*/
-	trace_point(TRACE_BOOT_PLATFORM_DMA_TRACE);
-	dma_trace_init_complete(sof->dmat);
 #endif
 
 	/* show heap status */
@@ -520,8 +524,11 @@ int platform_init(struct sof *sof)
 
 void platform_wait_for_interrupt(int level)
 {
+#if CONFIG_IDLE_GOVERNOR
+	platform_idle_enter(level);
+#else
 #if CONFIG_CAVS_USE_LPRO_IN_WAITI
-	platform_clock_on_waiti();
+	platform_clock_on_waiti(true);
 #endif
 #if (CONFIG_CAVS_LPS)
 	if (pm_runtime_is_active(PM_RUNTIME_DSP, PLATFORM_MASTER_CORE_ID))
@@ -531,4 +538,5 @@ void platform_wait_for_interrupt(int level)
 #else
 	arch_wait_for_interrupt(level);
 #endif
+#endif
 }
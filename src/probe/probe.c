@@ -12,9 +12,11 @@
 #include <sof/trace/trace.h>
 #include <user/trace.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/cache_batch.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/notifier.h>
 #include <sof/lib/uuid.h>
+#include <sof/math/numbers.h>
 #include <ipc/topology.h>
 #include <sof/drivers/ipc.h>
 #include <sof/drivers/timer.h>
@@ -37,6 +39,14 @@ DECLARE_SOF_UUID("probe-task", probe_task_uuid, 0x2f0b1901, 0xcac0, 0x4b87,
 #define PROBE_POINT_INVALID	0xFFFFFFFF
 
 #define PROBE_BUFFER_LOCAL_SIZE		8192
+
+#if CONFIG_PROBE_INJECT_PREBUFFER
+#define PROBE_INJECT_BUFFER_SIZE	CONFIG_PROBE_INJECT_BUFFER_SIZE
+/* ring level at which injection starts */
+#define PROBE_INJECT_PREFETCH		(PROBE_INJECT_BUFFER_SIZE / 2)
+#else
+#define PROBE_INJECT_BUFFER_SIZE	PROBE_BUFFER_LOCAL_SIZE
+#endif
 #define DMA_ELEM_SIZE		32
 
 /**
@@ -60,7 +70,23 @@ struct probe_dma_ext {
 	struct dma_sg_config config;	/**< DMA SG config */
 	struct probe_dma_buf dmapb;	/**< DMA buffer pointer */
 	struct dma_copy dc;		/**< DMA copy */
+	uint32_t underruns;		/**< injection underruns */
+	uint32_t underrun_bytes;	/**< silence injected on underruns */
+#if CONFIG_PROBE_INJECT_PREBUFFER
+	bool primed;			/**< ring prefetched, injection runs */
+#endif
+};
+
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+/**
+ * Buffer region produced but not extracted yet
+ */
+struct probe_pending {
+	struct comp_buffer *buffer;	/**< monitored buffer */
+	uintptr_t start;		/**< first byte of region */
+	uint32_t size;			/**< region size */
 };
+#endif
 
 /**
  * Probe main struct
@@ -69,8 +95,21 @@ struct probe_pdata {
 	struct probe_dma_ext ext_dma;				  /**< extraction DMA */
 	struct probe_dma_ext inject_dma[CONFIG_PROBE_DMA_MAX];	  /**< injection DMA */
 	struct probe_point probe_points[CONFIG_PROBE_POINTS_MAX]; /**< probe points */
+	struct probe_point_stats stats[CONFIG_PROBE_POINTS_MAX];  /**< probe points stats */
 	struct probe_data_packet header;			  /**< data packet header */
 	struct task dmap_work;					  /**< probe task */
+#if CONFIG_PROBE_EXTRACT_AGGREGATE
+	uintptr_t frame_ptr;		/**< header of open frame, 0 if none */
+	uint32_t frame_size;		/**< size of chunks in open frame */
+	uint64_t frame_timestamp;	/**< timestamp of first chunk */
+#endif
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+	struct dma_copy local_dc;	/**< DMA moving probed data */
+	/**< regions waiting for extraction */
+	struct probe_pending pending[CONFIG_PROBE_POINTS_MAX];
+	uint32_t dma_point;	/**< probe point of DMA transfer in flight */
+	uint32_t dma_size;	/**< bytes of DMA transfer in flight */
+#endif
 };
 
 /**
@@ -110,14 +149,16 @@ static int probe_dma_buffer_init(struct probe_dma_buf *buffer, uint32_t size,
  *	  size and specific channel.
  * \param[out] probe DMA.
  * \param[in] direction.
+ * \param[in] DMA buffer size.
  * \return 0 on success, error code otherwise.
  */
-static int probe_dma_init(struct probe_dma_ext *dma, uint32_t direction)
+static int probe_dma_init(struct probe_dma_ext *dma, uint32_t direction,
+			  uint32_t size)
 {
 	struct dma_sg_config config;
 	uint32_t elem_addr, addr_align;
 	const uint32_t elem_size = sizeof(uint64_t) * DMA_ELEM_SIZE;
-	const uint32_t elem_num = PROBE_BUFFER_LOCAL_SIZE / elem_size;
+	const uint32_t elem_num = size / elem_size;
 	int err = 0;
 
 	/* request DMA in the dir LMEM->HMEM with shared access */
@@ -135,7 +176,7 @@ static int probe_dma_init(struct probe_dma_ext *dma, uint32_t direction)
 		return err;
 
 	/* initialize dma buffer */
-	err = probe_dma_buffer_init(&dma->dmapb, PROBE_BUFFER_LOCAL_SIZE, addr_align);
+	err = probe_dma_buffer_init(&dma->dmapb, size, addr_align);
 	if (err < 0)
 		return err;
 
@@ -149,6 +190,7 @@ static int probe_dma_init(struct probe_dma_ext *dma, uint32_t direction)
 	config.src_width = sizeof(uint32_t);
 	config.dest_width = sizeof(uint32_t);
 	config.cyclic = 0;
+	config.dmac_config = 0;
 
 	err = dma_sg_alloc(&config.elem_array, SOF_MEM_ZONE_RUNTIME,
 			   config.direction, elem_num, elem_size, elem_addr, 0);
@@ -161,6 +203,11 @@ static int probe_dma_init(struct probe_dma_ext *dma, uint32_t direction)
 
 	dma_sg_free(&config.elem_array);
 
+	dma->underruns = 0;
+	dma->underrun_bytes = 0;
+#if CONFIG_PROBE_INJECT_PREBUFFER
+	dma->primed = false;
+#endif
 
 	return 0;
 }
@@ -191,33 +238,140 @@ static int probe_dma_deinit(struct probe_dma_ext *dma)
 	return 0;
 }
 
+/**
+ * \brief Copy data to probe buffer at given position.
+ * \param[in] probe DMA buffer.
+ * \param[in,out] position in probe buffer, updated past the data.
+ * \param[in] data pointer.
+ * \param[in] size.
+ * \return 0 on success, error code otherwise.
+ */
+static int pbuffer_write(struct probe_dma_buf *pbuf, uintptr_t *ptr,
+			 const void *data, uint32_t bytes)
+{
+	uint32_t head;
+	uint32_t tail;
+
+	/* check if it will not exceed end_addr */
+	if (pbuf->end_addr - *ptr < bytes) {
+		head = pbuf->end_addr - *ptr;
+		tail = bytes - head;
+	} else {
+		head = bytes;
+		tail = 0;
+	}
+
+	/* copy data to probe buffer */
+	if (memcpy_s((void *)*ptr, pbuf->end_addr - *ptr, data, head)) {
+		trace_probe_error("pbuffer_write(): memcpy_s() failed");
+		return -EINVAL;
+	}
+	dcache_writeback_region((void *)*ptr, head);
+
+	/* buffer ended so needs to do a second copy */
+	if (tail) {
+		*ptr = pbuf->addr;
+		if (memcpy_s((void *)*ptr, pbuf->size,
+			     (const char *)data + head, tail)) {
+			trace_probe_error("pbuffer_write(): memcpy_s() failed");
+			return -EINVAL;
+		}
+		dcache_writeback_region((void *)*ptr, tail);
+		*ptr += tail;
+	} else {
+		*ptr += head;
+		if (*ptr == pbuf->end_addr)
+			*ptr = pbuf->addr;
+	}
+
+	return 0;
+}
+
+#if CONFIG_PROBE_EXTRACT_AGGREGATE
+/**
+ * \brief Complete header of open extraction frame, so it can be sent.
+ * \return 0 on success, error code otherwise.
+ */
+static int probe_frame_close(struct probe_pdata *_probe)
+{
+	struct probe_frame_header header;
+	uintptr_t ptr = _probe->frame_ptr;
+
+	if (!ptr)
+		return 0;
+
+	header.sync_word = PROBE_EXTRACT_FRAME_SYNC_WORD;
+	header.frame_size = _probe->frame_size;
+	header.timestamp_low = (uint32_t)_probe->frame_timestamp;
+	header.timestamp_high = (uint32_t)(_probe->frame_timestamp >> 32);
+	header.checksum = 0;
+	header.checksum = crc32(0, &header, sizeof(header));
+
+	_probe->frame_ptr = 0;
+
+	return pbuffer_write(&_probe->ext_dma.dmapb, &ptr, &header,
+			     sizeof(header));
+}
+#endif
+
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+static void probe_pending_copy(struct probe_pdata *_probe);
+#endif
+
 /*
  * \brief Probe task for extraction.
  *
- * Copy extraction probes data to host if available.
+ * Copy extraction probes data to host if available, as much as the DMA
+ * can take now, the rest stays in probe buffer for next run.
  * Return err if dma copy failed.
  */
 static enum task_state probe_task(void *data)
 {
 	struct probe_pdata *_probe = probe_get();
+	struct probe_dma_buf *pbuf = &_probe->ext_dma.dmapb;
+	uint32_t avail = 0;
+	uint32_t free_bytes = 0;
+	uint32_t copy_bytes;
 	int err;
 
-	if (_probe->ext_dma.dmapb.avail > 0)
-		err = dma_copy_to_host_nowait(&_probe->ext_dma.dc,
-					      &_probe->ext_dma.config, 0,
-					       (void *)_probe->ext_dma.dmapb.r_ptr,
-					       _probe->ext_dma.dmapb.avail);
-	else
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+	/* move data recorded by produce callbacks */
+	probe_pending_copy(_probe);
+#endif
+
+#if CONFIG_PROBE_EXTRACT_AGGREGATE
+	/* chunks gathered until now are sent in one frame */
+	err = probe_frame_close(_probe);
+	if (err < 0)
+		return err;
+#endif
+
+	if (!pbuf->avail)
+		return SOF_TASK_STATE_RESCHEDULE;
+
+	err = dma_get_data_size(_probe->ext_dma.dc.chan, &avail, &free_bytes);
+	if (err < 0) {
+		trace_probe_error("probe_task(): dma_get_data_size() failed.");
+		return err;
+	}
+
+	copy_bytes = MIN(pbuf->avail, free_bytes);
+	if (!copy_bytes)
 		return SOF_TASK_STATE_RESCHEDULE;
 
+	err = dma_copy_to_host_nowait(&_probe->ext_dma.dc,
+				      &_probe->ext_dma.config, 0,
+				      (void *)pbuf->r_ptr, copy_bytes);
 	if (err < 0) {
 		trace_probe_error("probe_task(): dma_copy_to_host_nowait() failed.");
 		return err;
 	}
 
-	/* buffer data sent, set read pointer and clear avail bytes */
-	_probe->ext_dma.dmapb.r_ptr = _probe->ext_dma.dmapb.w_ptr;
-	_probe->ext_dma.dmapb.avail = 0;
+	/* data sent, update read pointer and avail bytes */
+	pbuf->r_ptr += copy_bytes;
+	if (pbuf->r_ptr >= pbuf->end_addr)
+		pbuf->r_ptr -= pbuf->size;
+	pbuf->avail -= copy_bytes;
 
 	return SOF_TASK_STATE_RESCHEDULE;
 }
@@ -253,7 +407,8 @@ int probe_init(struct probe_dma *probe_dma)
 		_probe->ext_dma.stream_tag = probe_dma->stream_tag;
 		_probe->ext_dma.dma_buffer_size = probe_dma->dma_buffer_size;
 
-		err = probe_dma_init(&_probe->ext_dma, DMA_DIR_LMEM_TO_HMEM);
+		err = probe_dma_init(&_probe->ext_dma, DMA_DIR_LMEM_TO_HMEM,
+				     PROBE_BUFFER_LOCAL_SIZE);
 		if (err < 0) {
 			trace_probe_error("probe_init(): probe_dma_init() failed");
 			_probe->ext_dma.stream_tag = PROBE_DMA_INVALID;
@@ -271,6 +426,14 @@ int probe_init(struct probe_dma *probe_dma)
 				      SOF_UUID(probe_task_uuid),
 				      SOF_SCHEDULE_LL_TIMER, SOF_TASK_PRI_LOW,
 				      probe_task, _probe, 0, 0);
+
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+		err = dma_copy_new_local(&_probe->local_dc);
+		if (err < 0) {
+			trace_probe_error("probe_init(): dma_copy_new_local() failed");
+			return err;
+		}
+#endif
 	} else {
 		tracev_probe("\tno extraction DMA setup");
 
@@ -324,6 +487,13 @@ int probe_deinit(void)
 		err = probe_dma_deinit(&_probe->ext_dma);
 		if (err < 0)
 			return err;
+
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+		if (_probe->dma_size)
+			dma_stop(_probe->local_dc.chan);
+		dma_copy_free(&_probe->local_dc);
+		dma_put(_probe->local_dc.dmac);
+#endif
 	}
 
 	sof_get()->probe = NULL;
@@ -387,7 +557,8 @@ int probe_dma_add(uint32_t count, struct probe_dma *probe_dma)
 			probe_dma[i].dma_buffer_size;
 
 		err = probe_dma_init(&_probe->inject_dma[first_free],
-				     DMA_DIR_HMEM_TO_LMEM);
+				     DMA_DIR_HMEM_TO_LMEM,
+				     PROBE_INJECT_BUFFER_SIZE);
 		if (err < 0) {
 			trace_probe_error("probe_dma_add(): probe_dma_init() failed");
 			_probe->inject_dma[first_free].stream_tag =
@@ -417,16 +588,20 @@ int probe_dma_info(struct sof_ipc_probe_info_params *data, uint32_t max_size)
 
 	/* search all injection DMAs to send them in reply */
 	while (i < CONFIG_PROBE_DMA_MAX &&
-	       data->rhdr.hdr.size + sizeof(struct probe_dma) < max_size) {
+	       data->rhdr.hdr.size + sizeof(struct probe_dma_info) < max_size) {
 		/* save it if valid */
 		if (_probe->inject_dma[i].stream_tag != PROBE_DMA_INVALID) {
 			data->probe_dma[j].stream_tag =
 				_probe->inject_dma[i].stream_tag;
 			data->probe_dma[j].dma_buffer_size =
 				_probe->inject_dma[i].dma_buffer_size;
+			data->probe_dma[j].underruns =
+				_probe->inject_dma[i].underruns;
+			data->probe_dma[j].underrun_bytes =
+				_probe->inject_dma[i].underrun_bytes;
 			j++;
 			/* and increase reply header size */
-			data->rhdr.hdr.size += sizeof(struct probe_dma);
+			data->rhdr.hdr.size += sizeof(struct probe_dma_info);
 		}
 
 		i++;
@@ -496,46 +671,19 @@ int probe_dma_remove(uint32_t count, uint32_t *stream_tag)
  * \param[in] size.
  * \return 0 on success, error code otherwise.
  */
-static int copy_to_pbuffer(struct probe_dma_buf *pbuf, void *data,
+static int copy_to_pbuffer(struct probe_dma_buf *pbuf, const void *data,
 			   uint32_t bytes)
 {
-	uint32_t head;
-	uint32_t tail;
+	int ret;
 
 	if (bytes == 0)
 		return 0;
 
-	/* check if it will not exceed end_addr */
-	if ((char *)pbuf->end_addr - (char *)pbuf->w_ptr < bytes) {
-		head = (char *)pbuf->end_addr - (char *)pbuf->w_ptr;
-		tail = bytes - head;
-	} else {
-		head = bytes;
-		tail = 0;
-	}
-
-	/* copy data to probe buffer */
-	if (memcpy_s((void *)pbuf->w_ptr, pbuf->end_addr - pbuf->w_ptr, data, head)) {
-		trace_probe_error("copy_to_pbuffer(): memcpy_s() failed");
-		return -EINVAL;
-	}
-	dcache_writeback_region((void *)pbuf->w_ptr, head);
-
-	/* buffer ended so needs to do a second copy */
-	if (tail) {
-		pbuf->w_ptr = pbuf->addr;
-		if (memcpy_s((void *)pbuf->w_ptr, (char *)pbuf->end_addr - (char *)pbuf->w_ptr,
-			     (char *)data + head, tail)) {
-			trace_probe_error("copy_to_pbuffer(): memcpy_s() failed");
-			return -EINVAL;
-		}
-		dcache_writeback_region((void *)pbuf->w_ptr, tail);
-		pbuf->w_ptr = pbuf->w_ptr + tail;
-	} else {
-		pbuf->w_ptr = pbuf->w_ptr + head;
-	}
+	ret = pbuffer_write(pbuf, &pbuf->w_ptr, data, bytes);
+	if (ret < 0)
+		return ret;
 
-	pbuf->avail = (uintptr_t)pbuf->avail + bytes;
+	pbuf->avail += bytes;
 
 	return 0;
 }
@@ -597,16 +745,135 @@ static int copy_from_pbuffer(struct probe_dma_buf *pbuf, void *data,
 	return 0;
 }
 
+/**
+ * \brief Check if injection DMA has data for transaction and account
+ *	  underruns otherwise.
+ * \param[in,out] injection DMA.
+ * \param[in,out] stats of probe point.
+ * \param[in] transaction size.
+ * \return true if data can be injected, false if silence should be.
+ */
+static bool probe_inject_ready(struct probe_dma_ext *dma,
+			       struct probe_point_stats *stats, uint32_t bytes)
+{
+#if CONFIG_PROBE_INJECT_PREBUFFER
+	/* consume nothing until ring is prefetched */
+	if (!dma->primed) {
+		if (dma->dmapb.avail < PROBE_INJECT_PREFETCH) {
+			/* refill after underrun, not the initial preroll */
+			if (dma->underruns) {
+				dma->underrun_bytes += bytes;
+				stats->dropped_bytes += bytes;
+			}
+			return false;
+		}
+
+		dma->primed = true;
+	}
+#endif
+
+	if (dma->dmapb.avail >= bytes) {
+		stats->bytes += bytes;
+		return true;
+	}
+
+	dma->underruns++;
+	dma->underrun_bytes += bytes;
+	stats->drops++;
+	stats->dropped_bytes += bytes;
+
+#if CONFIG_PROBE_INJECT_PREBUFFER
+	dma->primed = false;
+#endif
+
+	return false;
+}
+
+#if CONFIG_PROBE_EXTRACT_AGGREGATE
+/**
+ * \brief Space taken in probe buffer by extraction of given data size.
+ * \param[in] data size.
+ * \return size in bytes.
+ */
+static uint32_t probe_ext_size(uint32_t size)
+{
+	struct probe_pdata *_probe = probe_get();
+	uint32_t bytes = sizeof(struct probe_chunk_header) + ALIGN_UP(size, 4);
+
+	/* first chunk opens new frame */
+	if (!_probe->frame_ptr)
+		bytes += sizeof(struct probe_frame_header);
+
+	return bytes;
+}
+
+/**
+ * \brief Open extraction frame if needed, generate chunk header
+ *	  and copy it to probe buffer.
+ * \param[in] component buffer pointer.
+ * \param[in] data start in component buffer.
+ * \param[in] data size.
+ * \param[in] audio format.
+ * \return 0 on success, error code otherwise.
+ */
+static int probe_gen_header(struct comp_buffer *buffer, uintptr_t start,
+			    uint32_t size, uint32_t format)
+{
+	struct probe_pdata *_probe = probe_get();
+	struct probe_dma_buf *pbuf = &_probe->ext_dma.dmapb;
+	struct probe_frame_header frame = { 0 };
+	struct probe_chunk_header chunk;
+	int ret;
+
+	/* reserve frame header, it is completed before sending */
+	if (!_probe->frame_ptr) {
+		_probe->frame_ptr = pbuf->w_ptr;
+		_probe->frame_size = 0;
+		_probe->frame_timestamp = platform_timer_get(timer_get());
+
+		ret = copy_to_pbuffer(pbuf, &frame, sizeof(frame));
+		if (ret < 0)
+			return ret;
+	}
+
+	chunk.buffer_id = buffer->id;
+	chunk.format = format;
+	chunk.data_size_bytes = size;
+
+	_probe->frame_size += sizeof(chunk) + ALIGN_UP(size, 4);
+
+	return copy_to_pbuffer(pbuf, &chunk, sizeof(chunk));
+}
+
+/**
+ * \brief Pad chunk data to 4 bytes.
+ * \param[in] data size.
+ * \return 0 on success, error code otherwise.
+ */
+static int probe_gen_padding(uint32_t size)
+{
+	const uint32_t padding = 0;
+
+	return copy_to_pbuffer(&probe_get()->ext_dma.dmapb, &padding,
+			       ALIGN_UP(size, 4) - size);
+}
+#else
+static uint32_t probe_ext_size(uint32_t size)
+{
+	return sizeof(struct probe_data_packet) + size;
+}
+
 /**
  * \brief Generate probe data packet header, update timestamp, calc crc
  *	  and copy data to probe buffer.
  * \param[in] component buffer pointer.
+ * \param[in] data start in component buffer.
  * \param[in] data size.
  * \param[in] audio format.
  * \return 0 on success, error code otherwise.
  */
-static int probe_gen_header(struct comp_buffer *buffer, uint32_t size,
-			    uint32_t format)
+static int probe_gen_header(struct comp_buffer *buffer, uintptr_t start,
+			    uint32_t size, uint32_t format)
 {
 	struct probe_pdata *_probe = probe_get();
 	struct probe_data_packet *header;
@@ -626,6 +893,10 @@ static int probe_gen_header(struct comp_buffer *buffer, uint32_t size,
 
 	/* calc crc to check validation by probe parse app */
 	crc = crc32(0, header, sizeof(*header));
+#if CONFIG_PROBE_EXTRACT_CHECKSUM_DATA
+	crc = cir_buf_crc32(crc, (void *)start, buffer->stream.addr,
+			    buffer->stream.end_addr, size);
+#endif
 	header->checksum = crc;
 
 	dcache_writeback_region(header, sizeof(*header));
@@ -634,6 +905,68 @@ static int probe_gen_header(struct comp_buffer *buffer, uint32_t size,
 			       sizeof(struct probe_data_packet));
 }
 
+static int probe_gen_padding(uint32_t size)
+{
+	return 0;
+}
+#endif
+
+/**
+ * \brief Check if extraction of given data size fits in probe buffer,
+ *	  try to send buffered data first if it doesn't.
+ * \param[in] data size.
+ * \return true if data fits.
+ */
+static bool probe_ext_fits(uint32_t size)
+{
+	struct probe_dma_buf *pbuf = &probe_get()->ext_dma.dmapb;
+
+	if (pbuf->size - pbuf->avail >= probe_ext_size(size))
+		return true;
+
+	probe_task(NULL);
+
+	return pbuf->size - pbuf->avail >= probe_ext_size(size);
+}
+
+/**
+ * \brief Copy buffer region to probe buffer, handling buffer wrap.
+ * \param[in] component buffer pointer.
+ * \param[in] first byte of region.
+ * \param[in] region size.
+ * \return 0 on success, error code otherwise.
+ */
+static int probe_buffer_copy(struct comp_buffer *buffer, uintptr_t start,
+			     uint32_t size)
+{
+	struct probe_dma_buf *pbuf = &probe_get()->ext_dma.dmapb;
+	uintptr_t w_ptr = pbuf->w_ptr;
+	uint32_t head = size;
+
+	if (size == 0)
+		return 0;
+
+	/* both buffers may wrap, copy between the rings directly */
+	pbuf->w_ptr = (uintptr_t)cir_buf_copy((void *)start,
+					      buffer->stream.addr,
+					      buffer->stream.end_addr,
+					      (void *)w_ptr,
+					      (void *)pbuf->addr,
+					      (void *)pbuf->end_addr, size);
+
+	/* probe buffer is read by DMA */
+	if (size > pbuf->end_addr - w_ptr)
+		head = pbuf->end_addr - w_ptr;
+
+	dcache_writeback_region((void *)w_ptr, head);
+	if (size > head)
+		dcache_writeback_region((void *)pbuf->addr, size - head);
+
+	pbuf->avail += size;
+
+	return 0;
+}
+
 /**
  * \brief Generate description of audio format for extraction probes.
  * \param[in] frame_fmt.
@@ -668,6 +1001,10 @@ static uint32_t probe_gen_format(uint32_t frame_fmt, uint32_t rate,
 		container_bytes = 4;
 		float_fmt = 1;
 		break;
+	case SOF_IPC_FRAME_S24_3LE:
+		valid_bytes = 3;
+		container_bytes = 3;
+		break;
 	default:
 		trace_probe_error("probe_gen_format(): Invalid frame format specified = 0x%08x",
 				  frame_fmt);
@@ -735,10 +1072,250 @@ static uint32_t probe_gen_format(uint32_t frame_fmt, uint32_t rate,
 	return format;
 }
 
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+/**
+ * \brief Record buffer region produced for extraction probe point.
+ * \param[in] probe main struct.
+ * \param[in] probe point index.
+ * \param[in] buffer transaction.
+ */
+static void probe_pending_add(struct probe_pdata *_probe, uint32_t i,
+			      struct buffer_cb_transact *cb_data)
+{
+	struct probe_pending *pending = &_probe->pending[i];
+	struct probe_point_stats *stats = &_probe->stats[i];
+	struct comp_buffer *buffer = cb_data->buffer;
+	uint32_t queued = pending->size;
+
+	/* region DMA is still moving is older than recorded data */
+	if (_probe->dma_size && _probe->dma_point == i)
+		queued += _probe->dma_size;
+
+	/* producer has already overwritten the oldest recorded data */
+	if (queued + cb_data->transaction_amount > buffer->stream.size) {
+		stats->drops++;
+		stats->dropped_bytes += pending->size;
+		pending->size = 0;
+	}
+
+	if (!pending->size) {
+		pending->buffer = buffer;
+		pending->start = (uintptr_t)cb_data->transaction_begin_address;
+	}
+
+	/* regions of consecutive produces are contiguous */
+	pending->size += cb_data->transaction_amount;
+}
+
+/**
+ * \brief Start moving buffer region to probe buffer by DMA. Region is
+ *	  split by buffer and probe buffer wrap into scatter-gather elements.
+ *	  Probe buffer pointers are moved by probe_buffer_dma_done() once the
+ *	  transfer has finished, nothing else is written to probe buffer
+ *	  until then.
+ * \param[in] component buffer pointer.
+ * \param[in] first byte of region.
+ * \param[in] region size.
+ * \return 0 on success, error code otherwise.
+ */
+static int probe_buffer_dma(struct comp_buffer *buffer, uintptr_t start,
+			    uint32_t size)
+{
+	struct probe_pdata *_probe = probe_get();
+	struct probe_dma_buf *pbuf = &_probe->ext_dma.dmapb;
+	uintptr_t end = (uintptr_t)buffer->stream.end_addr;
+	struct dma_sg_elem elems[3];
+	struct dma_sg_config config;
+	struct cache_batch batch;
+	uintptr_t dest = pbuf->w_ptr;
+	uint32_t left = size;
+	uint32_t bytes;
+	uint32_t i = 0;
+	int err;
+
+	/* producer might have left data in cache */
+	cache_batch_init(&batch, CACHE_WRITEBACK);
+
+	/* each of both buffers wraps at most once */
+	while (left) {
+		bytes = MIN(left, MIN(end - start, pbuf->end_addr - dest));
+
+		cache_batch_add(&batch, (void *)start, bytes);
+
+		/* dirty lines evicted later would overwrite DMA data */
+		dcache_writeback_invalidate_region((void *)dest, bytes);
+
+		elems[i].src = start;
+		elems[i].dest = dest;
+		elems[i].size = bytes;
+		i++;
+
+		start += bytes;
+		if (start == end)
+			start = (uintptr_t)buffer->stream.addr;
+		dest += bytes;
+		if (dest == pbuf->end_addr)
+			dest = pbuf->addr;
+		left -= bytes;
+	}
+
+	cache_batch_flush(&batch);
+
+	config.direction = DMA_DIR_MEM_TO_MEM;
+	config.src_width = sizeof(uint32_t);
+	config.dest_width = sizeof(uint32_t);
+	config.cyclic = 0;
+	config.irq_disabled = false;
+	config.dmac_config = 0;
+	config.elem_array.elems = elems;
+	config.elem_array.count = i;
+
+	err = dma_set_config(_probe->local_dc.chan, &config);
+	if (err < 0)
+		return err;
+
+	err = dma_start(_probe->local_dc.chan);
+	if (err < 0)
+		return err;
+
+	_probe->dma_size = size;
+
+	return 0;
+}
+
+/**
+ * \brief Complete DMA transfer started by probe_buffer_dma(), data of
+ *	  failed transfer is replaced by silence to keep the stream framing.
+ * \param[in] probe main struct.
+ * \return 0 on success, -EBUSY while the transfer runs.
+ */
+static int probe_buffer_dma_done(struct probe_pdata *_probe)
+{
+	struct probe_dma_buf *pbuf = &_probe->ext_dma.dmapb;
+	struct probe_point_stats *stats = &_probe->stats[_probe->dma_point];
+	uint32_t size = _probe->dma_size;
+	uint32_t bytes;
+	int ret;
+
+	ret = dma_copy_local_done(&_probe->local_dc);
+	if (ret == -EBUSY)
+		return ret;
+
+	if (ret < 0) {
+		trace_probe_error("probe_buffer_dma_done(): DMA copy failed");
+		dma_stop(_probe->local_dc.chan);
+		stats->drops++;
+		stats->dropped_bytes += size;
+	} else {
+		stats->bytes += size;
+	}
+
+	_probe->dma_size = 0;
+
+	/* probe buffer wraps at most once */
+	while (size) {
+		bytes = MIN(size, pbuf->end_addr - pbuf->w_ptr);
+
+		if (ret < 0) {
+			bzero((void *)pbuf->w_ptr, bytes);
+			dcache_writeback_region((void *)pbuf->w_ptr, bytes);
+		} else {
+			/* drop lines the core may have fetched meanwhile */
+			dcache_invalidate_region((void *)pbuf->w_ptr, bytes);
+		}
+
+		pbuf->w_ptr += bytes;
+		if (pbuf->w_ptr == pbuf->end_addr)
+			pbuf->w_ptr = pbuf->addr;
+		pbuf->avail += bytes;
+		size -= bytes;
+	}
+
+	/* DMA moves whole words only, so no padding follows */
+	return 0;
+}
+
+/**
+ * \brief Extract regions recorded by produce callbacks, data is moved
+ *	  by DMA unless its alignment doesn't fit DMA width. The task starts
+ *	  one DMA transfer and completes it on its next run, points are
+ *	  served round robin after the last one moved by DMA.
+ * \param[in] probe main struct.
+ */
+static void probe_pending_copy(struct probe_pdata *_probe)
+{
+	struct probe_dma_buf *pbuf = &_probe->ext_dma.dmapb;
+	struct probe_pending *pending;
+	struct probe_point_stats *stats;
+	struct comp_buffer *buffer;
+	uint32_t format;
+	uint32_t size;
+	uint32_t i;
+	uint32_t j;
+	int ret;
+
+	/* data recorded later goes behind the region DMA is moving */
+	if (_probe->dma_size) {
+		ret = probe_buffer_dma_done(_probe);
+		if (ret == -EBUSY)
+			return;
+		if (ret < 0)
+			goto err;
+	}
+
+	for (j = 1; j <= CONFIG_PROBE_POINTS_MAX; j++) {
+		i = (_probe->dma_point + j) % CONFIG_PROBE_POINTS_MAX;
+		pending = &_probe->pending[i];
+		stats = &_probe->stats[i];
+		size = pending->size;
+		if (!size)
+			continue;
+
+		pending->size = 0;
+		buffer = pending->buffer;
+
+		if (pbuf->size - pbuf->avail < probe_ext_size(size)) {
+			stats->drops++;
+			stats->dropped_bytes += size;
+			continue;
+		}
+
+		format = probe_gen_format(buffer->stream.frame_fmt,
+					  buffer->stream.rate,
+					  buffer->stream.channels);
+		ret = probe_gen_header(buffer, pending->start, size, format);
+		if (ret < 0)
+			goto err;
+
+		if (!((pending->start | size | pbuf->w_ptr) &
+		      (sizeof(uint32_t) - 1)) &&
+		    !probe_buffer_dma(buffer, pending->start, size)) {
+			_probe->dma_point = i;
+			return;
+		}
+
+		ret = probe_buffer_copy(buffer, pending->start, size);
+		if (ret < 0)
+			goto err;
+
+		ret = probe_gen_padding(size);
+		if (ret < 0)
+			goto err;
+
+		stats->bytes += size;
+	}
+
+	return;
+err:
+	trace_probe_error("probe_pending_copy(): failed to extract data");
+}
+#endif
+
 /**
  * \brief General extraction probe callback, called from buffer produce.
  *	  It will search for probe point connected to this buffer.
  *	  Extraction probe: generate format, header and copy data to probe buffer.
+ *	  With PROBE_EXTRACT_ZERO_COPY, only produced region is recorded.
  *	  Injection probe: find corresponding DMA, check avail data, copy data,
  *	  update pointers and request more data from host if needed.
  * \param[in] arg pointer (not used).
@@ -750,13 +1327,13 @@ static void probe_cb_produce(void *arg, enum notify_id type, void *data)
 	struct probe_pdata *_probe = probe_get();
 	struct buffer_cb_transact *cb_data = data;
 	struct comp_buffer *buffer = cb_data->buffer;
+	struct probe_point_stats *stats;
 	struct probe_dma_ext *dma;
 	uint32_t buffer_id;
 	uint32_t head, tail;
 	uint32_t free_bytes = 0;
 	int32_t copy_bytes = 0;
 	uint32_t ret, i, j;
-	uint32_t format;
 
 	buffer_id = buffer->id;
 
@@ -771,44 +1348,49 @@ static void probe_cb_produce(void *arg, enum notify_id type, void *data)
 		return;
 	}
 
+	stats = &_probe->stats[i];
+
 	if (_probe->probe_points[i].purpose == PROBE_PURPOSE_EXTRACTION) {
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+		/* only record position, data is moved by DMA in probe task */
+		probe_pending_add(_probe, i, cb_data);
+#else
+		uintptr_t begin;
+		uint32_t format;
+
+		/* drop data rather than overwrite what wasn't sent yet */
+		if (!probe_ext_fits(cb_data->transaction_amount)) {
+			stats->drops++;
+			stats->dropped_bytes += cb_data->transaction_amount;
+			return;
+		}
+
 		format = probe_gen_format(buffer->stream.frame_fmt,
 					  buffer->stream.rate,
 					  buffer->stream.channels);
-		ret = probe_gen_header(buffer,
+		begin = (uintptr_t)cb_data->transaction_begin_address;
+		ret = probe_gen_header(buffer, begin,
 				       cb_data->transaction_amount,
 				       format);
 		if (ret < 0)
 			goto err;
 
-		/* check if transaction amount exceeds component buffer end addr */
-		/* if yes: divide copying into two stages, head and tail */
-		if ((char *)cb_data->transaction_begin_address +
-		    cb_data->transaction_amount > (char *)buffer->stream.end_addr) {
-			head = (uintptr_t)buffer->stream.end_addr -
-			       (uintptr_t)cb_data->transaction_begin_address;
-			tail = (uintptr_t)cb_data->transaction_amount - head;
-			ret = copy_to_pbuffer(&_probe->ext_dma.dmapb,
-					      cb_data->transaction_begin_address,
-					      head);
-			if (ret < 0)
-				goto err;
+		ret = probe_buffer_copy(buffer, begin,
+					cb_data->transaction_amount);
+		if (ret < 0)
+			goto err;
+
+		ret = probe_gen_padding(cb_data->transaction_amount);
+		if (ret < 0)
+			goto err;
+
+		stats->bytes += cb_data->transaction_amount;
 
-			ret = copy_to_pbuffer(&_probe->ext_dma.dmapb,
-					      buffer->stream.addr, tail);
-			if (ret < 0)
-				goto err;
-		} else {
-			ret = copy_to_pbuffer(&_probe->ext_dma.dmapb,
-					      cb_data->transaction_begin_address,
-					      cb_data->transaction_amount);
-			if (ret < 0)
-				goto err;
-		}
 		/* check if more than 75% of buffer size is already used */
 		if (_probe->ext_dma.dmapb.size - _probe->ext_dma.dmapb.avail <
 		    _probe->ext_dma.dmapb.size >> 2)
 			probe_task(NULL);
+#endif
 	} else {
 		/* search for DMA used by this probe point */
 		for (j = 0; j < CONFIG_PROBE_DMA_MAX; j++) {
@@ -841,7 +1423,17 @@ static void probe_cb_produce(void *arg, enum notify_id type, void *data)
 			head = (char *)cb_data->buffer->stream.end_addr -
 				(char *)cb_data->transaction_begin_address;
 			tail = cb_data->transaction_amount - head;
+		} else {
+			head = cb_data->transaction_amount;
+			tail = 0;
+		}
 
+		/* missing data is injected as silence */
+		if (!probe_inject_ready(dma, stats,
+					cb_data->transaction_amount)) {
+			memset(cb_data->transaction_begin_address, 0, head);
+			memset(cb_data->buffer->stream.addr, 0, tail);
+		} else if (tail) {
 			ret = copy_from_pbuffer(&dma->dmapb,
 						cb_data->transaction_begin_address, head);
 			if (ret < 0)
@@ -854,7 +1446,7 @@ static void probe_cb_produce(void *arg, enum notify_id type, void *data)
 		} else {
 			ret = copy_from_pbuffer(&dma->dmapb,
 						cb_data->transaction_begin_address,
-						cb_data->transaction_amount);
+						head);
 			if (ret < 0)
 				goto err;
 		}
@@ -1017,6 +1609,10 @@ int probe_point_add(uint32_t count, struct probe_point *probe)
 
 				return -EBUSY;
 			}
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+			/* data is injected as soon as it is produced */
+			dev->cb->notify_sync = true;
+#endif
 		} else if (probe[i].purpose == PROBE_PURPOSE_EXTRACTION) {
 			for (j = 0; j < CONFIG_PROBE_POINTS_MAX; j++) {
 				if (_probe->probe_points[j].stream_tag != PROBE_DMA_INVALID &&
@@ -1037,6 +1633,14 @@ int probe_point_add(uint32_t count, struct probe_point *probe)
 		_probe->probe_points[first_free].stream_tag =
 			probe[i].stream_tag;
 
+		bzero(&_probe->stats[first_free],
+		      sizeof(_probe->stats[first_free]));
+		_probe->stats[first_free].buffer_id = probe[i].buffer_id;
+		_probe->stats[first_free].purpose = probe[i].purpose;
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+		_probe->pending[first_free].size = 0;
+#endif
+
 		notifier_register(_probe, dev->cb, NOTIFIER_ID_BUFFER_PRODUCE,
 				  &probe_cb_produce);
 		notifier_register(_probe, dev->cb, NOTIFIER_ID_BUFFER_FREE,
@@ -1083,6 +1687,40 @@ int probe_point_info(struct sof_ipc_probe_info_params *data, uint32_t max_size)
 	return 1;
 }
 
+int probe_point_stats(struct sof_ipc_probe_info_params *data,
+		      uint32_t max_size)
+{
+	struct probe_pdata *_probe = probe_get();
+	uint32_t i = 0;
+	uint32_t j = 0;
+
+	tracev_probe("probe_point_stats()");
+
+	if (!_probe) {
+		trace_probe_error("probe_point_stats(): Not initialized.");
+
+		return -EINVAL;
+	}
+
+	data->rhdr.hdr.size = sizeof(*data);
+	/* search for all probe points to send their stats in reply */
+	while (i < CONFIG_PROBE_POINTS_MAX &&
+	       data->rhdr.hdr.size + sizeof(struct probe_point_stats) <
+	       max_size) {
+		if (_probe->probe_points[i].stream_tag != PROBE_POINT_INVALID) {
+			data->probe_point_stats[j] = _probe->stats[i];
+			j++;
+			data->rhdr.hdr.size += sizeof(struct probe_point_stats);
+		}
+
+		i++;
+	}
+
+	data->num_elems = j;
+
+	return 1;
+}
+
 int probe_point_remove(uint32_t count, uint32_t *buffer_id)
 {
 	struct probe_pdata *_probe = probe_get();
@@ -1109,10 +1747,18 @@ int probe_point_remove(uint32_t count, uint32_t *buffer_id)
 							    NOTIFIER_ID_BUFFER_PRODUCE);
 					notifier_unregister(_probe, dev->cb,
 							    NOTIFIER_ID_BUFFER_FREE);
+#if CONFIG_BUFFER_DEFERRED_NOTIFY
+					if (_probe->probe_points[j].purpose ==
+					    PROBE_PURPOSE_INJECTION)
+						dev->cb->notify_sync = false;
+#endif
 				}
 
 				_probe->probe_points[j].stream_tag =
 					PROBE_POINT_INVALID;
+#if CONFIG_PROBE_EXTRACT_ZERO_COPY
+				_probe->pending[j].size = 0;
+#endif
 			}
 		}
 	}
@@ -9,6 +9,7 @@
 #include <sof/drivers/interrupt.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/clk.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/memory.h>
@@ -23,11 +24,14 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct dma_domain;
+
 struct dma_domain_data {
 	int irq;
 	struct pipeline_task *task;
 	void (*handler)(void *arg);
 	void *arg;
+	struct dma_domain *dma_domain;
 };
 
 struct dma_domain {
@@ -45,6 +49,56 @@ struct dma_domain {
 
 const struct ll_schedule_domain_ops dma_multi_chan_domain_ops;
 
+#if CONFIG_DMA_DOMAIN_IRQ_COALESCE_US
+/**
+ * \brief Checks if all channels running on the core have completed.
+ * \param[in,out] dma_domain Pointer to DMA domain.
+ * \param[in] core Core owning the channels.
+ * \return True if none of the channels is still transferring its period.
+ */
+static bool dma_multi_chan_domain_all_done(struct dma_domain *dma_domain,
+					   int core)
+{
+	struct dma *dmas = dma_domain->dma_array;
+	int i;
+	int j;
+
+	for (i = 0; i < dma_domain->num_dma; ++i) {
+		for (j = 0; j < dmas[i].plat_data.channels; ++j) {
+			if ((dma_domain->channel_mask[i][core] & BIT(j)) &&
+			    !dma_interrupt(&dmas[i].chan[j],
+					   DMA_IRQ_STATUS_GET))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * \brief Waits shortly for completions of the other channels of the core.
+ * \param[in,out] dma_domain Pointer to DMA domain.
+ *
+ * Channels completing within the window are handled by the run of the
+ * interrupt that came first, which clears their interrupts, instead of
+ * each entering the handler and running the scheduler on its own.
+ */
+static void dma_multi_chan_domain_coalesce(struct dma_domain *dma_domain)
+{
+	uint64_t end = platform_timer_get(timer_get()) +
+		clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1) *
+		CONFIG_DMA_DOMAIN_IRQ_COALESCE_US / 1000;
+	int core = cpu_get_id();
+
+	while (!dma_multi_chan_domain_all_done(dma_domain, core) &&
+	       platform_timer_get(timer_get()) < end)
+		;
+}
+#else
+static inline void
+dma_multi_chan_domain_coalesce(struct dma_domain *dma_domain) { }
+#endif
+
 /**
  * \brief Generic DMA interrupt handler.
  * \param[in,out] data Pointer to DMA domain data.
@@ -53,7 +107,9 @@ static void dma_multi_chan_domain_irq_handler(void *data)
 {
 	struct dma_domain_data *domain_data = data;
 
-	/* just call registered handler */
+	dma_multi_chan_domain_coalesce(domain_data->dma_domain);
+
+	/* call registered handler */
 	domain_data->handler(domain_data->arg);
 
 	platform_shared_commit(domain_data, sizeof(*domain_data));
@@ -361,10 +417,12 @@ struct ll_schedule_domain *dma_multi_chan_domain_init(struct dma *dma_array,
 	/* retrieve IRQ numbers for each DMA channel */
 	for (i = 0; i < num_dma; ++i) {
 		dma = &dma_array[i];
-		for (j = 0; j < dma->plat_data.channels; ++j)
+		for (j = 0; j < dma->plat_data.channels; ++j) {
 			dma_domain->data[i][j].irq = interrupt_get_irq(
 				dma_chan_irq(dma, j),
 				dma_chan_irq_name(dma, j));
+			dma_domain->data[i][j].dma_domain = dma_domain;
+		}
 	}
 
 	ll_sch_domain_set_pdata(domain, dma_domain);
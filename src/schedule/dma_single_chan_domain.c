@@ -18,6 +18,7 @@
 #include <sof/schedule/ll_schedule_domain.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
+#include <sof/spinlock.h>
 #include <ipc/topology.h>
 #include <errno.h>
 #include <stdbool.h>
@@ -39,6 +40,14 @@ struct dma_domain {
 	uint32_t owner;		/* core owning the scheduling channel */
 	bool channel_changed;	/* true if we needed to re-register */
 
+	/* running scheduling source channels, min-heap ordered by period */
+	spinlock_t lock;
+	struct dma_chan_data **heap;
+	uint32_t heap_count;
+	uint32_t *heap_pos;	/* heap position + 1 by channel, 0 if absent */
+	uint32_t *chan_base;	/* number of the first channel of each DMA */
+	uint32_t num_chan;	/* number of channels of all DMAs */
+
 	/* data per core */
 	struct dma_domain_data data[PLATFORM_CORE_COUNT];
 };
@@ -49,6 +58,112 @@ static void dma_single_chan_domain_enable(struct ll_schedule_domain *domain,
 					  int core);
 static void dma_domain_changed(void *arg, enum notify_id type, void *data);
 
+/* number of the channel within all channels of the domain */
+static uint32_t dma_domain_chan_id(struct dma_domain *dma_domain,
+				   struct dma_chan_data *channel)
+{
+	return dma_domain->chan_base[channel->dma - dma_domain->dma_array] +
+		channel->index;
+}
+
+static void dma_domain_heap_set(struct dma_domain *dma_domain, uint32_t pos,
+				struct dma_chan_data *channel)
+{
+	dma_domain->heap[pos] = channel;
+	dma_domain->heap_pos[dma_domain_chan_id(dma_domain, channel)] = pos + 1;
+}
+
+/* moves the entry at pos up or down until the heap is ordered again */
+static void dma_domain_heap_fix(struct dma_domain *dma_domain, uint32_t pos)
+{
+	struct dma_chan_data **heap = dma_domain->heap;
+	struct dma_chan_data *channel = heap[pos];
+	uint32_t child;
+
+	while (pos && heap[(pos - 1) / 2]->period > channel->period) {
+		dma_domain_heap_set(dma_domain, pos, heap[(pos - 1) / 2]);
+		pos = (pos - 1) / 2;
+	}
+
+	for (;;) {
+		child = 2 * pos + 1;
+		if (child >= dma_domain->heap_count)
+			break;
+		if (child + 1 < dma_domain->heap_count &&
+		    heap[child + 1]->period < heap[child]->period)
+			child++;
+		if (heap[child]->period >= channel->period)
+			break;
+		dma_domain_heap_set(dma_domain, pos, heap[child]);
+		pos = child;
+	}
+
+	dma_domain_heap_set(dma_domain, pos, channel);
+}
+
+static void dma_domain_heap_remove(struct dma_domain *dma_domain,
+				   struct dma_chan_data *channel)
+{
+	uint32_t id = dma_domain_chan_id(dma_domain, channel);
+	uint32_t pos = dma_domain->heap_pos[id];
+
+	if (!pos)
+		return;
+
+	dma_domain->heap_pos[id] = 0;
+	if (--pos == --dma_domain->heap_count)
+		return;
+
+	dma_domain->heap[pos] = dma_domain->heap[dma_domain->heap_count];
+	dma_domain_heap_fix(dma_domain, pos);
+}
+
+/* channels may stop without the DMA wrappers, e.g. at end of transfer */
+static bool dma_domain_chan_running(struct dma_chan_data *channel)
+{
+	return channel->status == COMP_STATE_ACTIVE &&
+		channel->is_scheduling_source;
+}
+
+/**
+ * \brief Updates the running channels after a channel state change.
+ * \param[in,out] data Pointer to DMA domain.
+ * \param[in,out] channel Pointer to DMA channel.
+ *
+ * Called by the DMA wrappers, so the scheduling channel is found without
+ * scanning all channels on every stream start and stop.
+ */
+static void dma_domain_chan_update(void *data, struct dma_chan_data *channel)
+{
+	struct dma_domain *dma_domain = data;
+	uint32_t id = dma_domain_chan_id(dma_domain, channel);
+	uint32_t flags;
+
+	spin_lock_irq(&dma_domain->lock, flags);
+
+	if (!dma_domain_chan_running(channel)) {
+		dma_domain_heap_remove(dma_domain, channel);
+	} else if (dma_domain->heap_pos[id]) {
+		/* period may have changed */
+		dma_domain_heap_fix(dma_domain, dma_domain->heap_pos[id] - 1);
+	} else {
+		dma_domain->heap_count++;
+		dma_domain_heap_set(dma_domain, dma_domain->heap_count - 1,
+				    channel);
+		dma_domain_heap_fix(dma_domain, dma_domain->heap_count - 1);
+	}
+
+	platform_shared_commit(dma_domain->heap, sizeof(*dma_domain->heap) *
+			       dma_domain->num_chan);
+	platform_shared_commit(dma_domain->heap_pos,
+			       sizeof(*dma_domain->heap_pos) *
+			       dma_domain->num_chan);
+
+	spin_unlock_irq(&dma_domain->lock, flags);
+
+	platform_shared_commit(dma_domain, sizeof(*dma_domain));
+}
+
 /**
  * \brief Retrieves DMA channel with lowest period.
  * \param[in,out] dma_domain Pointer to DMA domain.
@@ -56,43 +171,33 @@ static void dma_domain_changed(void *arg, enum notify_id type, void *data);
  */
 static struct dma_chan_data *dma_chan_min_period(struct dma_domain *dma_domain)
 {
-	struct dma *dmas = dma_domain->dma_array;
 	struct dma_chan_data *channel = NULL;
-	int i;
-	int j;
+	uint32_t flags;
 
 	/* get currently registered channel if exists */
 	if (dma_domain->owner != DMA_DOMAIN_OWNER_INVALID &&
 	    dma_domain->data[dma_domain->owner].channel)
 		channel = dma_domain->data[dma_domain->owner].channel;
 
-	for (i = 0; i < dma_domain->num_dma; ++i) {
-		/* DMA not probed */
-		if (!dmas[i].sref)
-			continue;
-
-		for (j = 0; j < dmas[i].plat_data.channels; ++j) {
-			/* channel not set as scheduling source */
-			if (!dma_is_scheduling_source(&dmas[i].chan[j]))
-				continue;
+	spin_lock_irq(&dma_domain->lock, flags);
 
-			/* channel not running */
-			if (dmas[i].chan[j].status != COMP_STATE_ACTIVE)
-				continue;
+	/* drop channels stopped behind the wrappers' back */
+	while (dma_domain->heap_count &&
+	       !dma_domain_chan_running(dma_domain->heap[0]))
+		dma_domain_heap_remove(dma_domain, dma_domain->heap[0]);
 
-			/* bigger period */
-			if (channel &&
-			    channel->period <= dmas[i].chan[j].period)
-				continue;
+	/* running channel with lower period */
+	if (dma_domain->heap_count &&
+	    (!channel || channel->period > dma_domain->heap[0]->period))
+		channel = dma_domain->heap[0];
 
-			channel = &dmas[i].chan[j];
-		}
-
-		platform_shared_commit(dmas[i].chan, sizeof(*dmas[i].chan) *
-				       dmas[i].plat_data.channels);
-	}
+	platform_shared_commit(dma_domain->heap, sizeof(*dma_domain->heap) *
+			       dma_domain->num_chan);
+	platform_shared_commit(dma_domain->heap_pos,
+			       sizeof(*dma_domain->heap_pos) *
+			       dma_domain->num_chan);
 
-	platform_shared_commit(dmas, sizeof(*dmas) * dma_domain->num_dma);
+	spin_unlock_irq(&dma_domain->lock, flags);
 
 	return channel;
 }
@@ -259,46 +364,31 @@ out:
 
 /**
  * \brief Checks if any DMA channel is running on current core.
- * \param[in,out] dmas Array of possible DMAs.
- * \param[in] num Number of DMAs in the array.
+ * \param[in,out] dma_domain Pointer to DMA domain.
  * \return True if any DMA channel is running, false otherwise.
  */
-static bool dma_chan_is_any_running(struct dma *dmas, uint32_t num)
+static bool dma_chan_is_any_running(struct dma_domain *dma_domain)
 {
+	struct dma_chan_data *channel;
 	int core = cpu_get_id();
 	bool ret = false;
+	uint32_t flags;
 	int i;
-	int j;
-
-	for (i = 0; i < num; ++i) {
-		/* DMA not probed */
-		if (!dmas[i].sref)
-			continue;
-
-		for (j = 0; j < dmas[i].plat_data.channels; ++j) {
-			/* channel not set as scheduling source */
-			if (!dma_is_scheduling_source(&dmas[i].chan[j]))
-				continue;
-
-			/* channel owned by different core */
-			if (core != dmas[i].chan[j].core)
-				continue;
-
-			if (dmas[i].chan[j].status == COMP_STATE_ACTIVE) {
-				platform_shared_commit(dmas[i].chan,
-						sizeof(*dmas[i].chan) *
-						dmas[i].plat_data.channels);
-				ret = true;
-				goto out;
-			}
-		}
 
-		platform_shared_commit(dmas[i].chan, sizeof(*dmas[i].chan) *
-				       dmas[i].plat_data.channels);
+	spin_lock_irq(&dma_domain->lock, flags);
+
+	for (i = 0; i < dma_domain->heap_count; i++) {
+		channel = dma_domain->heap[i];
+		if (channel->core == core && dma_domain_chan_running(channel)) {
+			ret = true;
+			break;
+		}
 	}
 
-out:
-	platform_shared_commit(dmas, sizeof(*dmas) * num);
+	platform_shared_commit(dma_domain->heap, sizeof(*dma_domain->heap) *
+			       dma_domain->num_chan);
+
+	spin_unlock_irq(&dma_domain->lock, flags);
 
 	return ret;
 }
@@ -315,7 +405,6 @@ static void dma_domain_unregister_owner(struct ll_schedule_domain *domain,
 					struct dma_domain_data *data)
 {
 	struct dma_domain *dma_domain = ll_sch_domain_get_pdata(domain);
-	struct dma *dmas = dma_domain->dma_array;
 	struct dma_chan_data *channel;
 	int core = cpu_get_id();
 
@@ -346,7 +435,7 @@ static void dma_domain_unregister_owner(struct ll_schedule_domain *domain,
 	dma_domain_notify_change(channel);
 
 	/* check if there is another channel running */
-	if (dma_chan_is_any_running(dmas, dma_domain->num_dma)) {
+	if (dma_chan_is_any_running(dma_domain)) {
 		trace_ll("dma_domain_unregister_owner(): "
 			 "some channel is still running, registering again");
 
@@ -371,7 +460,6 @@ static void dma_single_chan_domain_unregister(struct ll_schedule_domain *domain,
 {
 	struct dma_domain *dma_domain = ll_sch_domain_get_pdata(domain);
 	struct pipeline_task *pipe_task = pipeline_task_get(task);
-	struct dma *dmas = dma_domain->dma_array;
 	int core = cpu_get_id();
 	struct dma_domain_data *data = &dma_domain->data[core];
 
@@ -392,7 +480,7 @@ static void dma_single_chan_domain_unregister(struct ll_schedule_domain *domain,
 	}
 
 	/* some channel still running, so return */
-	if (dma_chan_is_any_running(dmas, dma_domain->num_dma))
+	if (dma_chan_is_any_running(dma_domain))
 		goto out;
 
 	/* no more transfers scheduled on this core */
@@ -476,6 +564,12 @@ static void dma_single_chan_domain_set(struct ll_schedule_domain *domain,
 		domain->last_tick = domain->last_tick ? ticks : start;
 	}
 
+	/* interrupts come on the channel's own grid, so a task is due at
+	 * the interrupt nearest to its start rather than the one after it
+	 */
+	domain->due_margin = domain->ticks_per_ms * data->channel->period /
+		2000;
+
 out:
 	platform_shared_commit(dma_domain, sizeof(*dma_domain));
 }
@@ -508,7 +602,8 @@ out:
 static bool dma_single_chan_domain_is_pending(struct ll_schedule_domain *domain,
 					      struct task *task)
 {
-	return task->start <= platform_timer_get(timer_get());
+	return task->start <= platform_timer_get(timer_get()) +
+		domain->due_margin;
 }
 
 /**
@@ -560,6 +655,8 @@ struct ll_schedule_domain *dma_single_chan_domain_init(struct dma *dma_array,
 {
 	struct ll_schedule_domain *domain;
 	struct dma_domain *dma_domain;
+	uint32_t num_chan = 0;
+	int i;
 
 	trace_ll("dma_single_chan_domain_init(): num_dma %d, clk %d", num_dma,
 		 clk);
@@ -572,6 +669,32 @@ struct ll_schedule_domain *dma_single_chan_domain_init(struct dma *dma_array,
 	dma_domain->dma_array = dma_array;
 	dma_domain->num_dma = num_dma;
 	dma_domain->owner = DMA_DOMAIN_OWNER_INVALID;
+	spinlock_init(&dma_domain->lock);
+
+	/* running channels are tracked through the DMA wrappers */
+	dma_domain->chan_base = rzalloc(SOF_MEM_ZONE_SYS, SOF_MEM_FLAG_SHARED,
+					SOF_MEM_CAPS_RAM,
+					sizeof(*dma_domain->chan_base) *
+					num_dma);
+	for (i = 0; i < num_dma; i++) {
+		dma_domain->chan_base[i] = num_chan;
+		num_chan += dma_array[i].plat_data.channels;
+		dma_array[i].sched_update = dma_domain_chan_update;
+		dma_array[i].sched_data = dma_domain;
+	}
+
+	dma_domain->num_chan = num_chan;
+	dma_domain->heap = rzalloc(SOF_MEM_ZONE_SYS, SOF_MEM_FLAG_SHARED,
+				   SOF_MEM_CAPS_RAM,
+				   sizeof(*dma_domain->heap) * num_chan);
+	dma_domain->heap_pos = rzalloc(SOF_MEM_ZONE_SYS, SOF_MEM_FLAG_SHARED,
+				       SOF_MEM_CAPS_RAM,
+				       sizeof(*dma_domain->heap_pos) *
+				       num_chan);
+
+	platform_shared_commit(dma_array, sizeof(*dma_array) * num_dma);
+	platform_shared_commit(dma_domain->chan_base,
+			       sizeof(*dma_domain->chan_base) * num_dma);
 
 	ll_sch_domain_set_pdata(domain, dma_domain);
 
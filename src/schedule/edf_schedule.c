@@ -7,40 +7,112 @@
 
 #include <sof/common.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/idc.h>
 #include <sof/drivers/interrupt.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/clk.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/uuid.h>
 #include <sof/list.h>
 #include <sof/platform.h>
 #include <sof/schedule/edf_schedule.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
 #include <sof/sof.h>
+#include <sof/spinlock.h>
 #include <ipc/topology.h>
+#include <ipc/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+/* migratable tasks of all cores sorted by deadline */
+struct edf_steal_queue {
+	spinlock_t lock;
+	struct list_item list;
+};
+
 struct edf_schedule_data {
-	struct list_item list;	/* list of tasks in priority queue */
+	struct list_item list;	/* list of tasks sorted by deadline */
 	uint32_t clock;
 	int irq;
+	struct task *current;	/* task running or last run */
+	void *inline_ctx;	/* context shared by inline tasks */
+	struct list_item ctx_list;	/* tasks with contexts of their own */
+#if CONFIG_SCHEDULE_EDF_STEAL
+	struct edf_steal_queue *steal;	/* queue shared by all cores */
+	struct task steal_task;	/* runs migratable tasks on this core */
+#endif
 };
 
+#if CONFIG_SCHEDULE_EDF_STEAL
+/* 0c3a8e1d-7b5f-4d26-9e4a-f1b2c3d4e5a6 */
+DECLARE_SOF_UUID("edf-steal", edf_steal_task_uuid, 0x0c3a8e1d, 0x7b5f,
+		 0x4d26, 0x9e, 0x4a, 0xf1, 0xb2, 0xc3, 0xd4, 0xe5, 0xa6);
+
+static SHARED_DATA struct edf_steal_queue edf_steal_queue;
+#endif
+
 const struct scheduler_ops schedule_edf_ops;
 
+static struct mem_cache edf_pdata_cache =
+	MEM_CACHE_INIT(struct edf_task_pdata, SOF_MEM_ZONE_SYS_RUNTIME, 0,
+		       SOF_MEM_CAPS_RAM, 4);
+
 static void schedule_edf_task_complete(void *data, struct task *task);
 static void schedule_edf_task_running(void *data, struct task *task);
 static void schedule_edf(void *data);
 
 static void schedule_edf_task_run(struct task *task, void *data)
 {
+	enum task_state state;
+
 	while (1) {
 		/* execute task run function and remove task from the list
 		 * only if completed
 		 */
-		if (task_run(task) == SOF_TASK_STATE_COMPLETED)
+		trace_timeline_begin(TRACE_CLASS_EDF, task->uid, -1, -1,
+				     "edf task");
+		state = task_run(task);
+		trace_timeline_end(TRACE_CLASS_EDF, task->uid, -1, -1,
+				   "edf task");
+
+		if (state == SOF_TASK_STATE_COMPLETED)
+			schedule_edf_task_complete(data, task);
+
+		/* find new task for execution */
+		schedule_edf(data);
+	}
+}
+
+static inline bool edf_task_is_inline(struct task *task)
+{
+	return task->flags & SOF_EDF_TASK_INLINE;
+}
+
+/* Entry of the context shared by inline tasks. Inline task picked by the
+ * scheduler while another one runs here is run after it, so they never
+ * preempt each other and the context isn't switched between them.
+ */
+static void schedule_edf_inline_run(void *data)
+{
+	struct edf_schedule_data *edf_sch = data;
+	enum task_state state;
+	struct task *task;
+
+	while (1) {
+		task = edf_sch->current;
+
+		trace_timeline_begin(TRACE_CLASS_EDF, task->uid, -1, -1,
+				     "edf task");
+		state = task_run(task);
+		trace_timeline_end(TRACE_CLASS_EDF, task->uid, -1, -1,
+				   "edf task");
+
+		if (state == SOF_TASK_STATE_COMPLETED)
 			schedule_edf_task_complete(data, task);
 
 		/* find new task for execution */
@@ -51,38 +123,24 @@ static void schedule_edf_task_run(struct task *task, void *data)
 static void edf_scheduler_run(void *data)
 {
 	struct edf_schedule_data *edf_sch = data;
-	uint64_t deadline_next = SOF_TASK_DEADLINE_IDLE;
 	struct task *task_next = NULL;
 	struct list_item *tlist;
 	struct task *task;
-	uint64_t deadline;
 	uint32_t flags;
 
 	tracev_edf_sch("edf_scheduler_run()");
 
 	irq_local_disable(flags);
 
-	/* find next task to run */
+	/* list is sorted, so the first runnable task has earliest deadline */
 	list_for_item(tlist, &edf_sch->list) {
 		task = container_of(tlist, struct task, list);
 
-		if (task->state != SOF_TASK_STATE_QUEUED &&
-		    task->state != SOF_TASK_STATE_RUNNING)
-			continue;
-
-		deadline = task_get_deadline(task);
-
-		if (deadline == SOF_TASK_DEADLINE_NOW) {
-			/* task needs to be scheduled ASAP */
+		if (task->state == SOF_TASK_STATE_QUEUED ||
+		    task->state == SOF_TASK_STATE_RUNNING) {
 			task_next = task;
 			break;
 		}
-
-		/* get earliest deadline */
-		if (deadline <= deadline_next) {
-			deadline_next = deadline;
-			task_next = task;
-		}
 	}
 
 	irq_local_enable(flags);
@@ -93,19 +151,247 @@ static void edf_scheduler_run(void *data)
 	schedule_edf_task_running(data, task_next);
 }
 
+/**
+ * \brief Inserts task into the list sorted by deadline.
+ *
+ * Task goes before the ones with the same deadline, so the latest queued
+ * task wins, except for SOF_TASK_DEADLINE_NOW tasks which are run in the
+ * order they were queued.
+ * \param[in,out] list List of tasks.
+ * \param[in,out] task Task to be inserted.
+ * \return True if task has been inserted at the head of the list.
+ */
+static bool edf_sch_list_insert(struct list_item *list, struct task *task)
+{
+	uint64_t deadline = edf_sch_get_deadline(task);
+	struct list_item *tlist;
+	struct task *curr;
+
+	list_for_item(tlist, list) {
+		curr = container_of(tlist, struct task, list);
+
+		if (deadline == SOF_TASK_DEADLINE_NOW ?
+		    edf_sch_get_deadline(curr) > deadline :
+		    edf_sch_get_deadline(curr) >= deadline)
+			break;
+	}
+
+	/* insert before tlist, at the tail if nothing found */
+	list_item_append(&task->list, tlist);
+
+	return list->next == &task->list;
+}
+
+#if CONFIG_SCHEDULE_EDF_STEAL
+static inline bool edf_task_is_migratable(struct task *task)
+{
+	return task->flags & SOF_EDF_TASK_MIGRATABLE;
+}
+
+/* runs migratable tasks of all cores till none is left */
+static enum task_state edf_steal_run(void *data)
+{
+	struct edf_steal_queue *queue = data;
+	struct edf_task_pdata *edf_pdata;
+	enum task_state state;
+	struct task *task;
+	uint32_t flags;
+
+	for (;;) {
+		spin_lock_irq(&queue->lock, flags);
+
+		if (list_is_empty(&queue->list)) {
+			spin_unlock_irq(&queue->lock, flags);
+			break;
+		}
+
+		task = list_first_item(&queue->list, struct task, list);
+		list_item_del(&task->list);
+		task->state = SOF_TASK_STATE_RUNNING;
+
+		spin_unlock_irq(&queue->lock, flags);
+
+		trace_timeline_begin(TRACE_CLASS_EDF, task->uid, -1, -1,
+				     "edf task");
+		state = task_run(task);
+		trace_timeline_end(TRACE_CLASS_EDF, task->uid, -1, -1,
+				   "edf task");
+
+		edf_pdata = edf_sch_get_pdata(task);
+
+		spin_lock_irq(&queue->lock, flags);
+
+		if (state == SOF_TASK_STATE_COMPLETED)
+			task_complete(task);
+
+		if (state != SOF_TASK_STATE_COMPLETED || edf_pdata->requeue) {
+			edf_pdata->requeue = false;
+			edf_sch_get_deadline(task) = task_get_deadline(task);
+			edf_sch_list_insert(&queue->list, task);
+			task->state = SOF_TASK_STATE_QUEUED;
+		} else {
+			task->state = SOF_TASK_STATE_COMPLETED;
+		}
+
+		spin_unlock_irq(&queue->lock, flags);
+	}
+
+	return SOF_TASK_STATE_COMPLETED;
+}
+
+/* steal task runs with the deadline of the first migratable task */
+static uint64_t edf_steal_deadline(void *data)
+{
+	struct edf_steal_queue *queue = data;
+	uint64_t deadline = SOF_TASK_DEADLINE_ALMOST_IDLE;
+	uint32_t flags;
+
+	spin_lock_irq(&queue->lock, flags);
+
+	if (!list_is_empty(&queue->list))
+		deadline = edf_sch_get_deadline(list_first_item(&queue->list,
+								struct task,
+								list));
+
+	spin_unlock_irq(&queue->lock, flags);
+
+	return deadline;
+}
+
+static const struct task_ops edf_steal_ops = {
+	.run		= edf_steal_run,
+	.get_deadline	= edf_steal_deadline,
+};
+
+void schedule_edf_steal(void)
+{
+	struct edf_schedule_data *edf_sch =
+		scheduler_get_data(SOF_SCHEDULE_EDF);
+
+	/* already queued task will find the new work anyway */
+	if (edf_sch->steal_task.state != SOF_TASK_STATE_QUEUED)
+		schedule_task(&edf_sch->steal_task, 0, 0);
+}
+
+/* Queues migratable task for the first core having time to run it. All
+ * enabled cores are woken up, those with nothing earlier to do race for it.
+ */
+static void edf_steal_queue_task(struct edf_schedule_data *edf_sch,
+				 struct task *task)
+{
+	struct edf_steal_queue *queue = edf_sch->steal;
+	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
+	struct idc_msg msg = { IDC_MSG_EDF_STEAL, IDC_MSG_EDF_STEAL_EXT, };
+	uint32_t cores = cpu_enabled_cores();
+	int core = cpu_get_id();
+	uint32_t flags;
+	int i;
+
+	spin_lock_irq(&queue->lock, flags);
+
+	switch (task->state) {
+	case SOF_TASK_STATE_QUEUED:
+		spin_unlock_irq(&queue->lock, flags);
+		return;
+	case SOF_TASK_STATE_RUNNING:
+		/* core running it queues it again once completed */
+		edf_pdata->requeue = true;
+		spin_unlock_irq(&queue->lock, flags);
+		return;
+	default:
+		edf_sch_get_deadline(task) = task_get_deadline(task);
+		edf_sch_list_insert(&queue->list, task);
+		task->state = SOF_TASK_STATE_QUEUED;
+		break;
+	}
+
+	spin_unlock_irq(&queue->lock, flags);
+
+	schedule_edf_steal();
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (i == core || !(cores & BIT(i)))
+			continue;
+
+		msg.core = i;
+		idc_send_msg(&msg, IDC_ASYNC);
+	}
+}
+
+static void edf_steal_cancel(struct edf_schedule_data *edf_sch,
+			     struct task *task)
+{
+	struct edf_steal_queue *queue = edf_sch->steal;
+	uint32_t flags;
+
+	spin_lock_irq(&queue->lock, flags);
+
+	if (task->state == SOF_TASK_STATE_QUEUED) {
+		task->state = SOF_TASK_STATE_CANCEL;
+		list_item_del(&task->list);
+	}
+
+	spin_unlock_irq(&queue->lock, flags);
+}
+
+static int edf_steal_init(struct edf_schedule_data *edf_sch)
+{
+	edf_sch->steal = platform_shared_get(&edf_steal_queue,
+					     sizeof(edf_steal_queue));
+
+	/* slave cores are started later and find the queue ready */
+	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID) {
+		spinlock_init(&edf_sch->steal->lock);
+		list_init(&edf_sch->steal->list);
+	}
+
+	return schedule_task_init_edf(&edf_sch->steal_task,
+				      SOF_UUID(edf_steal_task_uuid),
+				      &edf_steal_ops, edf_sch->steal,
+				      cpu_get_id(), 0);
+}
+#else
+static inline bool edf_task_is_migratable(struct task *task)
+{
+	return false;
+}
+
+static inline void edf_steal_queue_task(struct edf_schedule_data *edf_sch,
+					struct task *task) { }
+static inline void edf_steal_cancel(struct edf_schedule_data *edf_sch,
+				    struct task *task) { }
+static inline int edf_steal_init(struct edf_schedule_data *edf_sch)
+{
+	return 0;
+}
+#endif /* CONFIG_SCHEDULE_EDF_STEAL */
+
 static void schedule_edf_task(void *data, struct task *task, uint64_t start,
 			      uint64_t period)
 {
 	struct edf_schedule_data *edf_sch = data;
+	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint64_t ticks_per_ms;
 	uint64_t current;
 	uint32_t flags;
+	bool first;
+
+	if (edf_task_is_migratable(task)) {
+		edf_steal_queue_task(edf_sch, task);
+		return;
+	}
 
 	irq_local_disable(flags);
 
+	/* queued again once it completes, so the request isn't lost */
+	if (task->state == SOF_TASK_STATE_RUNNING) {
+		edf_pdata->requeue = true;
+		irq_local_enable(flags);
+		return;
+	}
+
 	/* not enough MCPS to complete */
-	if (task->state == SOF_TASK_STATE_QUEUED ||
-	    task->state == SOF_TASK_STATE_RUNNING) {
+	if (task->state == SOF_TASK_STATE_QUEUED) {
 		trace_edf_sch_error
 			("schedule_edf_task(), task already queued or running %d",
 			 task->state);
@@ -122,21 +408,30 @@ static void schedule_edf_task(void *data, struct task *task, uint64_t start,
 	task->start = start ? task->start + ticks_per_ms * start / 1000 :
 		current;
 
-	/* add task to the list */
-	list_item_append(&task->list, &edf_sch->list);
+	/* deadline is sampled once, it only defines position in the list */
+	edf_sch_get_deadline(task) = task_get_deadline(task);
+
+	first = edf_sch_list_insert(&edf_sch->list, task);
 
 	task->state = SOF_TASK_STATE_QUEUED;
 
 	irq_local_enable(flags);
 
-	schedule_edf(data);
+	/* head of the list is already running and will reschedule when
+	 * done, so there is no point in interrupting it
+	 */
+	if (first)
+		schedule_edf(data);
 }
 
 int schedule_task_init_edf(struct task *task, uint32_t uid,
 			   const struct task_ops *ops,
 			   void *data, uint16_t core, uint32_t flags)
 {
+	struct edf_schedule_data *edf_sch =
+		scheduler_get_data(SOF_SCHEDULE_EDF);
 	struct edf_task_pdata *edf_pdata = NULL;
+	uint32_t irq_flags;
 	int ret = 0;
 
 	ret = schedule_task_init(task, uid, SOF_SCHEDULE_EDF, 0, ops->run, data,
@@ -147,8 +442,21 @@ int schedule_task_init_edf(struct task *task, uint32_t uid,
 	if (edf_sch_get_pdata(task))
 		return -EEXIST;
 
-	edf_pdata = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-			    sizeof(*edf_pdata));
+	/* migratable tasks run in the context of steal task of any core */
+	if (edf_task_is_migratable(task)) {
+		edf_pdata = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME,
+				    SOF_MEM_FLAG_SHARED, SOF_MEM_CAPS_RAM,
+				    sizeof(*edf_pdata));
+		if (!edf_pdata)
+			return -ENOMEM;
+
+		edf_sch_set_pdata(task, edf_pdata);
+		task->ops.complete = ops->complete;
+		task->ops.get_deadline = ops->get_deadline;
+		return 0;
+	}
+
+	edf_pdata = mem_cache_zalloc(&edf_pdata_cache);
 	if (!edf_pdata) {
 		trace_edf_sch_error("schedule_task_init_edf(): alloc failed");
 		return -ENOMEM;
@@ -159,13 +467,23 @@ int schedule_task_init_edf(struct task *task, uint32_t uid,
 	task->ops.complete = ops->complete;
 	task->ops.get_deadline = ops->get_deadline;
 
+	/* inline tasks run in the context shared by them */
+	if (edf_task_is_inline(task))
+		goto out;
+
 	if (task_context_alloc(&edf_pdata->ctx) < 0)
 		goto error;
 	if (task_context_init(edf_pdata->ctx, &schedule_edf_task_run,
-			      task, scheduler_get_data(SOF_SCHEDULE_EDF),
-			      task->core, NULL, 0) < 0)
+			      task, edf_sch, task->core, NULL, 0) < 0)
 		goto error;
 
+	/* stacks are reported by the core running the task */
+	edf_pdata->task = task;
+	irq_local_disable(irq_flags);
+	list_item_append(&edf_pdata->ctx_list, &edf_sch->ctx_list);
+	irq_local_enable(irq_flags);
+
+out:
 	/* flush for slave core */
 	if (cpu_is_slave(task->core))
 		dcache_writeback_invalidate_region(edf_pdata,
@@ -176,13 +494,14 @@ error:
 	trace_edf_sch_error("schedule_task_init_edf(): init context failed");
 	if (edf_pdata->ctx)
 		task_context_free(edf_pdata->ctx);
-	rfree(edf_pdata);
+	mem_cache_free(&edf_pdata_cache, edf_pdata);
 	edf_sch_set_pdata(task, NULL);
 	return -EINVAL;
 }
 
 static void schedule_edf_task_running(void *data, struct task *task)
 {
+	struct edf_schedule_data *edf_sch = data;
 	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint32_t flags;
 
@@ -190,14 +509,18 @@ static void schedule_edf_task_running(void *data, struct task *task)
 
 	irq_local_disable(flags);
 
-	task_context_set(edf_pdata->ctx);
+	task_context_set(edf_task_is_inline(task) ? edf_sch->inline_ctx :
+			 edf_pdata->ctx);
 	task->state = SOF_TASK_STATE_RUNNING;
+	((struct edf_schedule_data *)data)->current = task;
 
 	irq_local_enable(flags);
 }
 
 static void schedule_edf_task_complete(void *data, struct task *task)
 {
+	struct edf_schedule_data *edf_sch = data;
+	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint32_t flags;
 
 	tracev_edf_sch("schedule_edf_task_complete()");
@@ -206,9 +529,17 @@ static void schedule_edf_task_complete(void *data, struct task *task)
 
 	task_complete(task);
 
-	task->state = SOF_TASK_STATE_COMPLETED;
 	list_item_del(&task->list);
 
+	if (edf_pdata->requeue) {
+		edf_pdata->requeue = false;
+		edf_sch_get_deadline(task) = task_get_deadline(task);
+		edf_sch_list_insert(&edf_sch->list, task);
+		task->state = SOF_TASK_STATE_QUEUED;
+	} else {
+		task->state = SOF_TASK_STATE_COMPLETED;
+	}
+
 	irq_local_enable(flags);
 }
 
@@ -218,6 +549,11 @@ static void schedule_edf_task_cancel(void *data, struct task *task)
 
 	tracev_edf_sch("schedule_edf_task_cancel()");
 
+	if (edf_task_is_migratable(task)) {
+		edf_steal_cancel(data, task);
+		return;
+	}
+
 	irq_local_disable(flags);
 
 	/* cancel and delete only if queued */
@@ -233,14 +569,31 @@ static void schedule_edf_task_free(void *data, struct task *task)
 {
 	struct edf_task_pdata *edf_pdata = edf_sch_get_pdata(task);
 	uint32_t flags;
+	uint32_t size;
+	uint32_t used;
 
 	irq_local_disable(flags);
 
 	task->state = SOF_TASK_STATE_FREE;
 
-	task_context_free(edf_pdata->ctx);
+	if (edf_task_is_migratable(task)) {
+		rfree(edf_pdata);
+		edf_sch_set_pdata(task, NULL);
+		irq_local_enable(flags);
+		return;
+	}
+
+	/* inline tasks have no context */
+	if (edf_pdata->ctx) {
+		used = task_context_stack_used(edf_pdata->ctx, &size);
+		trace_edf_sch("schedule_edf_task_free() task 0x%x used %u of %u bytes of stack",
+			      task->uid, used, size);
+
+		list_item_del(&edf_pdata->ctx_list);
+		task_context_free(edf_pdata->ctx);
+	}
 	edf_pdata->ctx = NULL;
-	rfree(edf_pdata);
+	mem_cache_free(&edf_pdata_cache, edf_pdata);
 	edf_sch_set_pdata(task, NULL);
 
 	irq_local_enable(flags);
@@ -255,6 +608,7 @@ int scheduler_init_edf(void)
 	edf_sch = rzalloc(SOF_MEM_ZONE_SYS, 0, SOF_MEM_CAPS_RAM,
 			  sizeof(*edf_sch));
 	list_init(&edf_sch->list);
+	list_init(&edf_sch->ctx_list);
 	edf_sch->clock = PLATFORM_DEFAULT_CLOCK;
 
 	scheduler_init(SOF_SCHEDULE_EDF, &schedule_edf_ops, edf_sch);
@@ -268,9 +622,94 @@ int scheduler_init_edf(void)
 	if (edf_sch->irq < 0)
 		return edf_sch->irq;
 
+	/* context shared by inline tasks of this core */
+	if (task_context_alloc(&edf_sch->inline_ctx) < 0)
+		return -ENOMEM;
+	if (task_context_init(edf_sch->inline_ctx, &schedule_edf_inline_run,
+			      edf_sch, NULL, cpu_get_id(), NULL, 0) < 0)
+		return -EINVAL;
+
 	interrupt_register(edf_sch->irq, edf_scheduler_run, edf_sch);
 	interrupt_enable(edf_sch->irq, edf_sch);
 
+	return edf_steal_init(edf_sch);
+}
+
+/* number of tasks scheduled on this core, besides the main task */
+uint32_t schedule_edf_num_tasks(void)
+{
+	struct edf_schedule_data *edf_sch =
+		scheduler_get_data(SOF_SCHEDULE_EDF);
+	struct task *main_task = *task_main_get();
+	struct list_item *tlist;
+	uint32_t num_tasks = 0;
+	uint32_t flags;
+
+	if (!edf_sch)
+		return 0;
+
+	irq_local_disable(flags);
+
+	list_for_item(tlist, &edf_sch->list) {
+		if (container_of(tlist, struct task, list) != main_task)
+			num_tasks++;
+	}
+
+	irq_local_enable(flags);
+
+	return num_tasks;
+}
+
+/* adds stack of a context to the reply, if it fits */
+static void edf_stack_elem_add(struct sof_ipc_dbg_stack_info *info,
+			       uint32_t max_size, uint32_t uid, void *ctx)
+{
+	struct sof_ipc_dbg_stack_elem *elem = &info->elems[info->num_elems];
+	uint32_t size;
+
+	info->total_elems++;
+
+	if (info->rhdr.hdr.size + sizeof(*elem) > max_size)
+		return;
+
+	elem->uid = uid;
+	elem->peak_used = task_context_stack_used(ctx, &size);
+	elem->size = size;
+	info->num_elems++;
+	info->rhdr.hdr.size += sizeof(*elem);
+}
+
+int schedule_edf_stack_info_get(struct sof_ipc_dbg_stack_info *info,
+				uint32_t max_size)
+{
+	struct edf_schedule_data *edf_sch =
+		scheduler_get_data(SOF_SCHEDULE_EDF);
+	struct edf_task_pdata *edf_pdata;
+	struct list_item *clist;
+	uint32_t flags;
+
+	if (!edf_sch)
+		return -ENODEV;
+
+	info->rhdr.hdr.size = sizeof(*info);
+	info->core = cpu_get_id();
+	info->num_elems = 0;
+	info->total_elems = 0;
+
+	irq_local_disable(flags);
+
+	/* context shared by inline tasks is reported with uid 0 */
+	edf_stack_elem_add(info, max_size, 0, edf_sch->inline_ctx);
+
+	list_for_item(clist, &edf_sch->ctx_list) {
+		edf_pdata = container_of(clist, struct edf_task_pdata,
+					 ctx_list);
+		edf_stack_elem_add(info, max_size, edf_pdata->task->uid,
+				   edf_pdata->ctx);
+	}
+
+	irq_local_enable(flags);
+
 	return 0;
 }
 
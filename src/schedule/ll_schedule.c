@@ -17,6 +17,7 @@
 #include <sof/lib/notifier.h>
 #include <sof/lib/perf_cnt.h>
 #include <sof/list.h>
+#include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/ll_schedule_domain.h>
@@ -24,12 +25,34 @@
 #include <sof/schedule/task.h>
 #include <sof/spinlock.h>
 #include <ipc/topology.h>
+#include <ipc/trace.h>
 #include <config.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+/* number of LL scheduler types */
+#define LL_SCHEDULE_TYPES	(SOF_SCHEDULE_COUNT - SOF_SCHEDULE_LL_TIMER)
+
+/* statistics of one task, all times in domain ticks */
+struct ll_task_stats {
+	struct task *task;	/* owner task, NULL if the slot is free */
+	uint32_t uid;		/* owner task uuid */
+	uint32_t period;	/* owner task period in us */
+	uint32_t overruns;	/* runs longer than the task period */
+	uint32_t exec_peak;	/* longest run */
+};
+
+/* statistics of one scheduler instance, all times in domain ticks */
+struct ll_schedule_stats {
+	spinlock_t lock;		/* taken by the owner core on updates */
+	uint32_t lateness[SOF_IPC_LL_STATS_BUCKETS];	/* tick start delay */
+	uint32_t exec[SOF_IPC_LL_STATS_BUCKETS];	/* tick run time */
+	uint32_t overruns;				/* all task overruns */
+	struct ll_task_stats tasks[SOF_IPC_LL_STATS_TASKS];
+};
+
 /* one instance of data allocated per core */
 struct ll_schedule_data {
 	struct list_item tasks;			/* list of ll tasks */
@@ -38,20 +61,119 @@ struct ll_schedule_data {
 	struct perf_cnt_data pcd;
 #endif
 	struct ll_schedule_domain *domain;	/* scheduling domain */
+	struct ll_schedule_stats *stats;	/* scheduling statistics */
+#if CONFIG_CLK_GOVERNOR
+	uint64_t gov_window_start;		/* start of load window */
+	uint32_t gov_mcps;			/* load of last window */
+	bool gov_busy;				/* load reported to governor */
+#endif
 };
 
+/* statistics are read by the IPC core, so they live in shared memory and
+ * are accessed under their lock through the uncached alias
+ */
+static SHARED_DATA struct ll_schedule_stats
+	ll_stats[LL_SCHEDULE_TYPES][PLATFORM_CORE_COUNT];
+
 const struct scheduler_ops schedule_ll_ops;
 
+static struct mem_cache ll_pdata_cache =
+	MEM_CACHE_INIT(struct ll_task_pdata, SOF_MEM_ZONE_SYS_RUNTIME, 0,
+		       SOF_MEM_CAPS_RAM, 8);
+
 #define perf_ll_sched_trace(pcd, ll_sched)			\
 	trace_ll("perf ll_work peak plat %lu cpu %lu",		\
 		 (pcd)->plat_delta_peak, (pcd)->cpu_delta_peak)
 
-static bool schedule_ll_is_pending(struct ll_schedule_data *sch)
+static struct ll_schedule_stats *schedule_ll_stats(uint16_t type, int core)
+{
+	struct ll_schedule_stats *stats =
+		&ll_stats[type - SOF_SCHEDULE_LL_TIMER][core];
+
+	return platform_shared_get(stats, sizeof(*stats));
+}
+
+/* log2 histogram bucket, 0 is kept for zero values */
+static uint32_t schedule_ll_stats_bucket(uint64_t value)
+{
+	if (!value)
+		return 0;
+
+	if (value >> 32)
+		return SOF_IPC_LL_STATS_BUCKETS - 1;
+
+	return MIN(32 - __builtin_clz((uint32_t)value),
+		   SOF_IPC_LL_STATS_BUCKETS - 1);
+}
+
+static void schedule_ll_stats_task(struct ll_schedule_data *sch,
+				   struct task *task, uint64_t exec)
+{
+	struct ll_task_pdata *pdata = ll_sch_get_pdata(task);
+	struct ll_task_stats *stats = pdata->stats;
+	uint64_t period = sch->domain->ticks_per_ms * pdata->period / 1000;
+
+	spin_lock(&sch->stats->lock);
+
+	if (exec > period)
+		sch->stats->overruns++;
+
+	if (stats) {
+		if (exec > period)
+			stats->overruns++;
+
+		stats->exec_peak = MAX(stats->exec_peak,
+				       MIN(exec, UINT32_MAX));
+	}
+
+	spin_unlock(&sch->stats->lock);
+}
+
+static void schedule_ll_stats_slot_get(struct ll_schedule_data *sch,
+				       struct task *task)
+{
+	struct ll_task_pdata *pdata = ll_sch_get_pdata(task);
+	struct ll_task_stats *stats;
+	int i;
+
+	spin_lock(&sch->stats->lock);
+
+	if (pdata->stats) {
+		pdata->stats->period = pdata->period;
+		goto out;
+	}
+
+	/* tasks without a free slot are still counted in the totals */
+	for (i = 0; i < SOF_IPC_LL_STATS_TASKS; i++) {
+		stats = &sch->stats->tasks[i];
+		if (!stats->task) {
+			stats->task = task;
+			stats->uid = task->uid;
+			stats->period = pdata->period;
+			stats->overruns = 0;
+			stats->exec_peak = 0;
+			pdata->stats = stats;
+			break;
+		}
+	}
+
+out:
+	spin_unlock(&sch->stats->lock);
+}
+
+static bool __hot_text schedule_ll_is_pending(struct ll_schedule_data *sch)
 {
 	struct list_item *tlist;
 	struct task *task;
+	uint64_t next_due = sch->domain->next_due[cpu_get_id()];
 	uint32_t pending_count = 0;
 
+	/* asynchronous domains can't have a task pending before its start */
+	if (!sch->domain->synchronous &&
+	    platform_timer_get(timer_get()) + sch->domain->due_margin <
+	    next_due)
+		return false;
+
 	/* mark each valid task as pending */
 	list_for_item(tlist, &sch->tasks) {
 		task = container_of(tlist, struct task, list);
@@ -79,24 +201,34 @@ static void schedule_ll_task_update_start(struct ll_schedule_data *sch,
 		task->start = next + last_tick;
 }
 
-static void schedule_ll_tasks_execute(struct ll_schedule_data *sch,
-				      uint64_t last_tick)
+static uint64_t schedule_ll_tasks_execute(struct ll_schedule_data *sch,
+					  uint64_t last_tick)
 {
 	struct list_item *wlist;
 	struct list_item *tlist;
 	struct task *task;
 	int cpu = cpu_get_id();
+	uint64_t next_due = UINT64_MAX;
+	uint64_t start;
+	uint64_t end;
 
 	/* check each task in the list for pending */
 	list_for_item_safe(wlist, tlist, &sch->tasks) {
 		task = container_of(wlist, struct task, list);
 
 		/* run task if its pending and remove from the list */
-		if (task->state != SOF_TASK_STATE_PENDING)
+		if (task->state != SOF_TASK_STATE_PENDING) {
+			next_due = MIN(next_due, task->start);
 			continue;
+		}
+
+		start = platform_timer_get(timer_get());
 
 		task->state = task_run(task);
 
+		end = platform_timer_get(timer_get());
+		schedule_ll_stats_task(sch, task, end - start);
+
 		/* do we need to reschedule this task */
 		if (task->state == SOF_TASK_STATE_COMPLETED) {
 			list_item_del(&task->list);
@@ -113,21 +245,116 @@ static void schedule_ll_tasks_execute(struct ll_schedule_data *sch,
 		} else {
 			/* update task's start time */
 			schedule_ll_task_update_start(sch, task, last_tick);
+			next_due = MIN(next_due, task->start);
 		}
 	}
 
 	platform_shared_commit(sch->domain, sizeof(*sch->domain));
+
+	return next_due;
+}
+
+#if CONFIG_CLK_GOVERNOR
+/* reports load of all LL schedulers of this core to the clock governor */
+static void schedule_ll_gov_report(void)
+{
+	struct ll_schedule_data *sch;
+	uint32_t mcps = 0;
+	int type;
+
+	for (type = SOF_SCHEDULE_LL_TIMER; type < SOF_SCHEDULE_COUNT; type++) {
+		sch = scheduler_get_data(type);
+		if (sch)
+			mcps += sch->gov_mcps;
+	}
+
+	clock_gov_load(cpu_get_id(), mcps);
+}
+
+/* Converts the averaged cycles of each completed perf counters window into
+ * MCPS over the wall time of the window. Idle scheduler reports zero load
+ * once, so the governor doesn't wait for windows which never come.
+ */
+static void schedule_ll_gov_update(struct ll_schedule_data *sch, uint64_t now)
+{
+	uint64_t cycles;
+	uint64_t elapsed;
+
+	if (!atomic_read(&sch->num_tasks)) {
+		if (!sch->gov_busy)
+			return;
+
+		sch->gov_busy = false;
+		sch->gov_window_start = 0;
+		sch->gov_mcps = 0;
+		schedule_ll_gov_report();
+		return;
+	}
+
+	sch->gov_busy = true;
+
+	/* only at the end of a window */
+	if (sch->pcd.window_count)
+		return;
+
+	/* first window has no known start */
+	if (sch->gov_window_start && now > sch->gov_window_start) {
+		cycles = sch->pcd.cpu_delta_avg << PERF_CNT_WINDOW_SHIFT;
+		elapsed = (now - sch->gov_window_start) * 1000;
+		sch->gov_mcps = (cycles * sch->domain->ticks_per_ms +
+				 elapsed - 1) / elapsed;
+		schedule_ll_gov_report();
+	}
+
+	sch->gov_window_start = now;
+}
+#else
+static inline void schedule_ll_gov_update(struct ll_schedule_data *sch,
+					  uint64_t now) { }
+#endif
+
+/* Asynchronous domains wake up only the cores with a task due next tick,
+ * unless cores are kept ticking together. The domain interrupt is one
+ * source unmasked on every client, so all cores enabled for a tick start
+ * their runs from the same interrupt, late only by their own latency.
+ */
+static bool schedule_ll_client_due(struct ll_schedule_domain *domain,
+				   int core)
+{
+	return domain->synchronous ||
+		IS_ENABLED(CONFIG_SCHEDULE_LL_SYNC_TICK) ||
+		domain->next_due[core] <= domain->last_tick +
+		domain->due_margin;
 }
 
 static void schedule_ll_clients_enable(struct ll_schedule_data *sch)
 {
+	struct ll_schedule_domain *domain = sch->domain;
+	uint64_t next_due = UINT64_MAX;
+	int first = -1;
+	int enabled = 0;
 	int i;
 
 	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
-		if (sch->domain->registered[i]) {
-			atomic_add(&sch->domain->num_clients, 1);
-			domain_enable(sch->domain, i);
+		if (!domain->registered[i])
+			continue;
+
+		if (domain->next_due[i] < next_due || first < 0) {
+			next_due = domain->next_due[i];
+			first = i;
 		}
+
+		if (schedule_ll_client_due(domain, i)) {
+			atomic_add(&domain->num_clients, 1);
+			domain_enable(domain, i);
+			enabled++;
+		}
+	}
+
+	/* keep one client ticking to reschedule the others when due */
+	if (!enabled && first >= 0) {
+		atomic_add(&domain->num_clients, 1);
+		domain_enable(domain, first);
 	}
 }
 
@@ -142,11 +369,15 @@ static void schedule_ll_clients_reschedule(struct ll_schedule_data *sch)
 	platform_shared_commit(sch->domain, sizeof(*sch->domain));
 }
 
-static void schedule_ll_tasks_run(void *data)
+static void __hot_text schedule_ll_tasks_run(void *data)
 {
 	struct ll_schedule_data *sch = data;
+	uint64_t next_due = UINT64_MAX;
+	bool executed = false;
 	uint32_t num_clients;
 	uint64_t last_tick;
+	uint64_t start;
+	uint64_t delta;
 	uint32_t flags;
 
 	domain_disable(sch->domain, cpu_get_id());
@@ -169,22 +400,46 @@ static void schedule_ll_tasks_run(void *data)
 
 	spin_unlock(&sch->domain->lock);
 
+	/* how late is this tick comparing to the programmed one */
+	start = platform_timer_get(timer_get());
+	delta = start > last_tick ? start - last_tick : 0;
+	spin_lock(&sch->stats->lock);
+	sch->stats->lateness[schedule_ll_stats_bucket(delta)]++;
+	spin_unlock(&sch->stats->lock);
+
+	trace_timeline_begin(TRACE_CLASS_SCHEDULE_LL, 0, -1, -1,
+			     "ll tick late %u", (uint32_t)delta);
 	perf_cnt_init(&sch->pcd);
 
 	/* run tasks if there are any pending */
-	if (schedule_ll_is_pending(sch))
-		schedule_ll_tasks_execute(sch, last_tick);
+	if (schedule_ll_is_pending(sch)) {
+		next_due = schedule_ll_tasks_execute(sch, last_tick);
+		executed = true;
+	}
 
 	perf_cnt_stamp(&sch->pcd, perf_ll_sched_trace, sch);
+	trace_timeline_end(TRACE_CLASS_SCHEDULE_LL, 0, -1, -1, "ll tick");
+
+	delta = platform_timer_get(timer_get()) - start;
+	spin_lock(&sch->stats->lock);
+	sch->stats->exec[schedule_ll_stats_bucket(delta)]++;
+	spin_unlock(&sch->stats->lock);
 
 	spin_lock(&sch->domain->lock);
 
+	/* tasks that didn't run have kept their start */
+	if (executed)
+		sch->domain->next_due[cpu_get_id()] = next_due;
+
 	/* reschedule only if all clients are done */
 	if (!num_clients)
 		schedule_ll_clients_reschedule(sch);
 
 	spin_unlock(&sch->domain->lock);
 
+	/* clock changes notify the domain, so done without its lock */
+	schedule_ll_gov_update(sch, start);
+
 	irq_local_enable(flags);
 }
 
@@ -204,6 +459,9 @@ static int schedule_ll_domain_set(struct ll_schedule_data *sch,
 
 	spin_lock(&sch->domain->lock);
 
+	/* new task start isn't known yet, so the next tick has to run */
+	sch->domain->next_due[core] = 0;
+
 	if (atomic_add(&sch->num_tasks, 1) == 1)
 		sch->domain->registered[core] = true;
 
@@ -261,13 +519,15 @@ static void schedule_ll_task_insert(struct task *task, struct list_item *tasks)
 	struct list_item *tlist;
 	struct task *curr_task;
 
-	/* tasks are added into the list from highest to lowest priority
-	 * and tasks with the same priority should be served on
-	 * a first-come-first-serve basis
+	/* tasks are added into the list from highest to lowest priority,
+	 * then by order, and tasks with the same priority and order should
+	 * be served on a first-come-first-serve basis
 	 */
 	list_for_item(tlist, tasks) {
 		curr_task = container_of(tlist, struct task, list);
-		if (task->priority < curr_task->priority) {
+		if (task->priority < curr_task->priority ||
+		    (task->priority == curr_task->priority &&
+		     task->order < curr_task->order)) {
 			list_item_append(&task->list, &curr_task->list);
 			return;
 		}
@@ -307,6 +567,8 @@ static void schedule_ll_task(void *data, struct task *task, uint64_t start,
 
 	pdata->period = period;
 
+	schedule_ll_stats_slot_get(sch, task);
+
 	/* insert task into the list */
 	schedule_ll_task_insert(task, &sch->tasks);
 
@@ -345,8 +607,7 @@ int schedule_task_init_ll(struct task *task,
 	if (ll_sch_get_pdata(task))
 		return -EEXIST;
 
-	ll_pdata = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-			   sizeof(*ll_pdata));
+	ll_pdata = mem_cache_zalloc(&ll_pdata_cache);
 
 	if (!ll_pdata) {
 		trace_ll_error("schedule_task_init_ll(): alloc failed");
@@ -360,6 +621,7 @@ int schedule_task_init_ll(struct task *task,
 
 static void schedule_ll_task_free(void *data, struct task *task)
 {
+	struct ll_schedule_data *sch = data;
 	struct ll_task_pdata *ll_pdata;
 	uint32_t flags;
 
@@ -368,7 +630,12 @@ static void schedule_ll_task_free(void *data, struct task *task)
 	/* release the resources */
 	task->state = SOF_TASK_STATE_FREE;
 	ll_pdata = ll_sch_get_pdata(task);
-	rfree(ll_pdata);
+	if (ll_pdata->stats) {
+		spin_lock(&sch->stats->lock);
+		ll_pdata->stats->task = NULL;
+		spin_unlock(&sch->stats->lock);
+	}
+	mem_cache_free(&ll_pdata_cache, ll_pdata);
 	ll_sch_set_pdata(task, NULL);
 
 	irq_local_enable(flags);
@@ -392,6 +659,8 @@ static void schedule_ll_task_cancel(void *data, struct task *task)
 		/* found it */
 		if (curr_task == task) {
 			schedule_ll_domain_clear(sch, task);
+			schedule_ll_gov_update(sch,
+					       platform_timer_get(timer_get()));
 			break;
 		}
 	}
@@ -427,6 +696,10 @@ static void reschedule_ll_task(void *data, struct task *task, uint64_t start)
 		if (curr_task == task) {
 			/* set start time */
 			task->start = time;
+			spin_lock(&sch->domain->lock);
+			sch->domain->next_due[cpu_get_id()] =
+				MIN(sch->domain->next_due[cpu_get_id()], time);
+			spin_unlock(&sch->domain->lock);
 			goto out;
 		}
 	}
@@ -473,6 +746,11 @@ static void ll_scheduler_recalculate_tasks(struct ll_schedule_data *sch,
 			current + sch->domain->ticks_per_ms * delta_ms :
 			current + (sch->domain->ticks_per_ms >> 3);
 	}
+
+	/* start times moved, let the next tick find the earliest one */
+	spin_lock(&sch->domain->lock);
+	sch->domain->next_due[cpu_get_id()] = 0;
+	spin_unlock(&sch->domain->lock);
 }
 
 static void ll_scheduler_notify(void *arg, enum notify_id type, void *data)
@@ -503,6 +781,8 @@ int scheduler_init_ll(struct ll_schedule_domain *domain)
 	list_init(&sch->tasks);
 	atomic_init(&sch->num_tasks, 0);
 	sch->domain = domain;
+	sch->stats = schedule_ll_stats(domain->type, cpu_get_id());
+	spinlock_init(&sch->stats->lock);
 
 	/* notification of clock changes */
 	notifier_register(sch, NULL, NOTIFIER_CLK_CHANGE_ID(domain->clk),
@@ -515,6 +795,98 @@ int scheduler_init_ll(struct ll_schedule_domain *domain)
 	return 0;
 }
 
+/* number of tasks scheduled on this core by the given LL scheduler */
+uint32_t schedule_ll_num_tasks(uint16_t type)
+{
+	struct ll_schedule_data *sch = scheduler_get_data(type);
+
+	return sch ? atomic_read(&sch->num_tasks) : 0;
+}
+
+int schedule_ll_stats_get(struct sof_ipc_dbg_ll_stats *info,
+			  uint32_t max_size, uint32_t type, int core,
+			  bool reset)
+{
+	struct ll_schedule_stats *stats;
+	struct ll_task_stats *tstats;
+	struct ll_schedule_domain *domain;
+	uint32_t flags;
+	int i;
+
+	if (max_size < sizeof(*info) || core < 0 ||
+	    core >= PLATFORM_CORE_COUNT)
+		return -EINVAL;
+
+	switch (type) {
+	case SOF_SCHEDULE_LL_TIMER:
+		domain = timer_domain_get();
+		break;
+	case SOF_SCHEDULE_LL_DMA:
+		domain = dma_domain_get();
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (!domain)
+		return -ENODEV;
+
+	/* the owner core keeps updating them, so read a consistent copy
+	 * of the latest values under their lock
+	 */
+	stats = schedule_ll_stats(type, core);
+	spin_lock_irq(&stats->lock, flags);
+
+	info->rhdr.hdr.size = sizeof(*info);
+	info->sched_type = type;
+	info->core = core;
+	info->ticks_per_ms = domain->ticks_per_ms;
+	info->overruns = stats->overruns;
+	info->num_tasks = 0;
+
+	for (i = 0; i < SOF_IPC_LL_STATS_BUCKETS; i++) {
+		info->lateness[i] = stats->lateness[i];
+		info->exec[i] = stats->exec[i];
+	}
+
+	for (i = 0; i < SOF_IPC_LL_STATS_TASKS; i++) {
+		tstats = &stats->tasks[i];
+
+		/* report as many tasks as fit in the reply */
+		if (!tstats->task ||
+		    info->rhdr.hdr.size + sizeof(*info->tasks) > max_size)
+			continue;
+
+		info->tasks[info->num_tasks].uid = tstats->uid;
+		info->tasks[info->num_tasks].period = tstats->period;
+		info->tasks[info->num_tasks].overruns = tstats->overruns;
+		info->tasks[info->num_tasks].exec_peak = tstats->exec_peak;
+		info->num_tasks++;
+		info->rhdr.hdr.size += sizeof(*info->tasks);
+	}
+
+	if (reset) {
+		stats->overruns = 0;
+
+		for (i = 0; i < SOF_IPC_LL_STATS_BUCKETS; i++) {
+			stats->lateness[i] = 0;
+			stats->exec[i] = 0;
+		}
+
+		for (i = 0; i < SOF_IPC_LL_STATS_TASKS; i++) {
+			stats->tasks[i].overruns = 0;
+			stats->tasks[i].exec_peak = 0;
+		}
+	}
+
+	platform_shared_commit(stats, sizeof(*stats));
+	spin_unlock_irq(&stats->lock, flags);
+
+	platform_shared_commit(domain, sizeof(*domain));
+
+	return 0;
+}
+
 const struct scheduler_ops schedule_ll_ops = {
 	.schedule_task		= schedule_ll_task,
 	.schedule_task_free	= schedule_ll_task_free,
@@ -27,6 +27,7 @@ int schedule_task_init(struct task *task,
 	task->uid = uid;
 	task->type = type;
 	task->priority = priority;
+	task->order = 0;
 	task->core = core;
 	task->flags = flags;
 	task->state = SOF_TASK_STATE_INIT;
@@ -23,12 +23,13 @@
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
 #include <sof/sof.h>
+#include <sof/trace/trace.h>
 #include <ipc/topology.h>
 #include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#if STATIC_PIPE
+#if CONFIG_STATIC_PIPELINE
 #include <sof/audio/pipeline.h>
 #include <ipc/trace.h>
 #endif
@@ -100,6 +101,7 @@ int task_main_start(struct sof *sof)
 	int ret;
 
 	/* init default audio components */
+	trace_point(TRACE_BOOT_SYS_COMP);
 	sys_comp_init(sof);
 
 	/* init self-registered modules */
@@ -108,13 +110,14 @@ int task_main_start(struct sof *sof)
 	/* init pipeline position offsets */
 	pipeline_posn_init(sof);
 
-#if STATIC_PIPE
-	/* init static pipeline */
+#if CONFIG_STATIC_PIPELINE
+	/* instantiate topology built into the firmware */
 	ret = init_static_pipeline(sof->ipc);
 	if (ret < 0)
 		panic(SOF_IPC_PANIC_TASK);
 #endif
 	/* let host know DSP boot is complete */
+	trace_point(TRACE_BOOT_SYS_READY);
 	ret = platform_boot_complete(0);
 	if (ret < 0)
 		return ret;
@@ -4,6 +4,7 @@
 //
 // Author: Tomasz Lauda <tomasz.lauda@linux.intel.com>
 
+#include <sof/atomic.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cpu.h>
@@ -13,6 +14,7 @@
 #include <sof/schedule/ll_schedule_domain.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
+#include <sof/spinlock.h>
 #include <ipc/topology.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -38,6 +40,36 @@ static inline void timer_report_delay(int id, uint64_t delay)
 	(void)ll_delay_us;
 }
 
+/**
+ * \brief Brings back timer armed past idle ticks.
+ *
+ * Newly scheduled task starts from the armed tick, so if the timer was
+ * moved further because no task was due, it's set to the first tick
+ * after current time again.
+ * \param[in,out] domain Pointer to schedule domain.
+ */
+static void timer_domain_pull_in(struct ll_schedule_domain *domain)
+{
+	struct timer_domain *timer_domain = ll_sch_domain_get_pdata(domain);
+	uint64_t period = domain->ticks_per_ms * timer_domain->timeout / 1000;
+	uint64_t current = platform_timer_get(timer_domain->timer);
+	uint64_t ticks;
+
+	spin_lock(&domain->lock);
+
+	if (atomic_read(&domain->total_num_tasks) &&
+	    domain->last_tick > current + period) {
+		ticks = domain->last_tick -
+			(domain->last_tick - current) / period * period;
+		domain->last_tick = platform_timer_set(timer_domain->timer,
+						       ticks);
+	}
+
+	platform_shared_commit(domain, sizeof(*domain));
+
+	spin_unlock(&domain->lock);
+}
+
 static int timer_domain_register(struct ll_schedule_domain *domain,
 				 uint64_t period, struct task *task,
 				 void (*handler)(void *arg), void *arg)
@@ -48,6 +80,9 @@ static int timer_domain_register(struct ll_schedule_domain *domain,
 
 	tracev_ll("timer_domain_register()");
 
+	/* new task starts from the armed tick */
+	timer_domain_pull_in(domain);
+
 	/* tasks already registered on this core */
 	if (timer_domain->arg[core])
 		goto out;
@@ -109,10 +144,20 @@ static void timer_domain_disable(struct ll_schedule_domain *domain, int core)
 static void timer_domain_set(struct ll_schedule_domain *domain, uint64_t start)
 {
 	struct timer_domain *timer_domain = ll_sch_domain_get_pdata(domain);
-	uint64_t ticks_req = domain->ticks_per_ms * timer_domain->timeout /
-			     1000 + start;
+	uint64_t period = domain->ticks_per_ms * timer_domain->timeout / 1000;
+	uint64_t ticks_req = period + start;
+	uint64_t next_due = domain_next_due(domain);
 	uint64_t ticks_set;
 
+	/* task with period shorter than the tick is due before it, while
+	 * ticks in which no task is due are skipped keeping the tick grid
+	 */
+	if (next_due > start && next_due < ticks_req)
+		ticks_req = next_due;
+	else if (next_due != UINT64_MAX && next_due > ticks_req)
+		ticks_req += (next_due - ticks_req + period - 1) / period *
+			period;
+
 	ticks_set = platform_timer_set(timer_domain->timer, ticks_req);
 
 	/* Was timer set to the value we requested? If no it means some
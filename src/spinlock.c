@@ -4,11 +4,132 @@
 //
 // Author: Tomasz Lauda <tomasz.lauda@linux.intel.com>
 
+#include <sof/debug/panic.h>
 #include <sof/drivers/interrupt.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/memory.h>
 #include <sof/spinlock.h>
+#include <sof/string.h>
+#include <ipc/trace.h>
 #include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+#if CONFIG_DEBUG_LOCK_STATS
+/* Statistics are updated by the holder of the lock, so locks sharing a
+ * name and held on several cores at once may lose some of the counts.
+ */
+struct lock_stats {
+	spinlock_t lock;	/* protects names, isn't named itself */
+	uint32_t count;		/* names in use */
+	struct sof_ipc_dbg_lock_elem elem[CONFIG_DEBUG_LOCK_STATS_NAMES];
+};
+
+static SHARED_DATA struct lock_stats lock_stats;
+
+static struct lock_stats *lock_stats_get(void)
+{
+	return platform_shared_get(&lock_stats, sizeof(lock_stats));
+}
+
+void _spin_lock_stats(spinlock_t *lock)
+{
+	struct sof_ipc_dbg_lock_elem *stats = lock->stats;
+	uint32_t start = arch_timer_get_cycles();
+	uint32_t spin;
+
+	if (!arch_try_lock(lock)) {
+		arch_spin_lock(lock);
+
+		spin = arch_timer_get_cycles() - start;
+		stats->contended++;
+		stats->spin_cycles += spin;
+		if (spin > stats->spin_max)
+			stats->spin_max = spin;
+	}
+
+	stats->acquires++;
+	lock->hold_start = arch_timer_get_cycles();
+}
+
+void _spin_unlock_stats(spinlock_t *lock)
+{
+	struct sof_ipc_dbg_lock_elem *stats = lock->stats;
+	uint32_t hold = arch_timer_get_cycles() - lock->hold_start;
+
+	if (hold > stats->hold_max)
+		stats->hold_max = hold;
+}
+
+void spinlock_name(spinlock_t *lock, const char *name)
+{
+	struct lock_stats *ls = lock_stats_get();
+	struct sof_ipc_dbg_lock_elem *elem = NULL;
+	uint32_t flags;
+	uint32_t i;
+	int ret;
+
+	assert(rstrlen(name) < SOF_IPC_LOCK_NAME_SIZE);
+
+	spin_lock_irq(&ls->lock, flags);
+
+	for (i = 0; i < ls->count; i++) {
+		if (!rstrcmp(ls->elem[i].name, name)) {
+			elem = &ls->elem[i];
+			break;
+		}
+	}
+
+	if (!elem && ls->count < CONFIG_DEBUG_LOCK_STATS_NAMES) {
+		elem = &ls->elem[ls->count++];
+		ret = memcpy_s(elem->name, sizeof(elem->name), name,
+			       rstrlen(name) + 1);
+		assert(!ret);
+	}
+
+	lock->stats = elem;
+
+	spin_unlock_irq(&ls->lock, flags);
+}
+
+int spinlock_stats_get(struct sof_ipc_dbg_lock_stats *info,
+		       uint32_t max_size, bool reset)
+{
+	struct lock_stats *ls = lock_stats_get();
+	struct sof_ipc_dbg_lock_elem *elem;
+	uint32_t flags;
+	uint32_t i;
+
+	spin_lock_irq(&ls->lock, flags);
+
+	info->rhdr.hdr.size = sizeof(*info);
+	info->num_elems = 0;
+	info->total_elems = ls->count;
+
+	for (i = 0; i < ls->count; i++) {
+		elem = &ls->elem[i];
+
+		/* report as many names as fit in the reply */
+		if (info->rhdr.hdr.size + sizeof(*elem) <= max_size) {
+			info->elems[info->num_elems++] = *elem;
+			info->rhdr.hdr.size += sizeof(*elem);
+		}
+
+		if (reset) {
+			elem->acquires = 0;
+			elem->contended = 0;
+			elem->spin_cycles = 0;
+			elem->spin_max = 0;
+			elem->hold_max = 0;
+		}
+	}
+
+	spin_unlock_irq(&ls->lock, flags);
+
+	return 0;
+}
+#endif
+
 uint32_t _spin_lock_irq(spinlock_t *lock)
 {
 	uint32_t flags;
@@ -5,8 +5,10 @@
 // Author: Yan Wang <yan.wang@linux.intel.com>
 
 #include <sof/audio/buffer.h>
+#include <sof/bit.h>
 #include <sof/common.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/interrupt.h>
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
@@ -22,6 +24,7 @@
 #include <sof/spinlock.h>
 #include <sof/string.h>
 #include <sof/trace/dma-trace.h>
+#include <sof/trace/trace.h>
 #include <ipc/topology.h>
 #include <ipc/trace.h>
 #include <config.h>
@@ -36,6 +39,7 @@ DECLARE_SOF_UUID("dma-trace-task", dma_trace_task_uuid, 0x2b972272, 0xc5b1,
 static int dma_trace_get_avail_data(struct dma_trace_data *d,
 				    struct dma_trace_buf *buffer,
 				    int avail);
+static void dtrace_ring_drain(struct dma_trace_data *d);
 
 static enum task_state trace_work(void *data)
 {
@@ -43,10 +47,25 @@ static enum task_state trace_work(void *data)
 	struct dma_trace_buf *buffer = &d->dmatb;
 	struct dma_sg_config *config = &d->config;
 	unsigned long flags;
-	uint32_t avail = buffer->avail;
+	uint32_t dropped_entries;
+	uint32_t avail;
 	int32_t size;
 	uint32_t overflow;
 
+	/* move entries gathered by all cores since last run */
+	spin_lock_irq(&d->lock, flags);
+	dtrace_ring_drain(d);
+	dropped_entries = d->dropped_entries;
+	d->dropped_entries = 0;
+	spin_unlock_irq(&d->lock, flags);
+
+	/* logged to the ring, so it is sent on the next run */
+	if (dropped_entries)
+		trace_error(0, "trace_work(): number of dropped logs = %u",
+			    dropped_entries);
+
+	avail = buffer->avail;
+
 	/* make sure we don't write more than buffer */
 	if (avail > DMA_TRACE_LOCAL_SIZE) {
 		overflow = avail - DMA_TRACE_LOCAL_SIZE;
@@ -180,6 +199,20 @@ static int dma_trace_buffer_init(struct dma_trace_data *d)
 	struct dma_trace_buf *buffer = &d->dmatb;
 	void *buf;
 	unsigned int flags;
+	int i;
+
+	/* rings are kept over buffer reinitialisation */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		if (d->ring[i])
+			continue;
+
+		d->ring[i] = rzalloc(SOF_MEM_ZONE_RUNTIME, SOF_MEM_FLAG_SHARED,
+				     SOF_MEM_CAPS_RAM, sizeof(*d->ring[i]));
+		if (!d->ring[i]) {
+			trace_buffer_error("dma_trace_buffer_init(): ring alloc failed");
+			return -ENOMEM;
+		}
+	}
 
 	/* allocate new buffer */
 	buf = rballoc(0, SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
@@ -195,6 +228,12 @@ static int dma_trace_buffer_init(struct dma_trace_data *d)
 	/* initialise the DMA buffer, whole sequence in section */
 	spin_lock_irq(&d->lock, flags);
 
+#if CONFIG_TRACE_COMPACT
+	/* first record of each core in the new buffer has a full timestamp */
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		d->ring[i]->sync_count = 0;
+#endif
+
 	buffer->addr  = buf;
 	buffer->size = DMA_TRACE_LOCAL_SIZE;
 	buffer->w_ptr = buffer->addr;
@@ -232,6 +271,7 @@ static int dma_trace_start(struct dma_trace_data *d)
 	config.src_width = sizeof(uint32_t);
 	config.dest_width = sizeof(uint32_t);
 	config.cyclic = 0;
+	config.dmac_config = 0;
 
 	err = dma_sg_alloc(&config.elem_array, SOF_MEM_ZONE_SYS,
 			   config.direction,
@@ -304,6 +344,13 @@ int dma_trace_enable(struct dma_trace_data *d)
 {
 	int err;
 
+	/* DMA copy context is set up on first use, not to delay boot */
+	if (!d->dc.dmac) {
+		err = dma_trace_init_complete(d);
+		if (err < 0)
+			goto out;
+	}
+
 	/* initialize dma trace buffer */
 	err = dma_trace_buffer_init(d);
 	if (err < 0)
@@ -339,6 +386,7 @@ void dma_trace_flush(void *t)
 {
 	struct dma_trace_data *trace_data = dma_trace_data_get();
 	struct dma_trace_buf *buffer = NULL;
+	unsigned long flags;
 	uint32_t avail;
 	int32_t size;
 	int32_t wrap_count;
@@ -349,6 +397,11 @@ void dma_trace_flush(void *t)
 		return;
 	}
 
+	/* pick up entries still waiting in the rings */
+	spin_lock_irq(&trace_data->lock, flags);
+	dtrace_ring_drain(trace_data);
+	spin_unlock_irq(&trace_data->lock, flags);
+
 	buffer = &trace_data->dmatb;
 	avail = buffer->avail;
 
@@ -394,7 +447,8 @@ void dma_trace_on(void)
 {
 	struct dma_trace_data *trace_data = dma_trace_data_get();
 
-	if (trace_data->enabled) {
+	/* nothing to resume if host has not set trace up yet */
+	if (trace_data->enabled || !trace_data->dc.dmac) {
 		platform_shared_commit(trace_data, sizeof(*trace_data));
 		return;
 	}
@@ -444,109 +498,247 @@ static int dtrace_calc_buf_overflow(struct dma_trace_buf *buffer,
 	return overflow;
 }
 
-static void dtrace_add_event(const char *e, uint32_t length)
+/* copies entry to DMA trace buffer, call with lock held */
+static void dtrace_add_event(struct dma_trace_data *trace_data,
+			     const uint32_t *e, uint32_t length)
 {
-	struct dma_trace_data *trace_data = dma_trace_data_get();
 	struct dma_trace_buf *buffer = &trace_data->dmatb;
-	uint32_t margin;
-	uint32_t overflow = 0;
-	int ret;
+	uint32_t *dst = buffer->w_ptr;
+	uint32_t i;
 
-	margin = dtrace_calc_buf_margin(buffer);
-	overflow = dtrace_calc_buf_overflow(buffer, length);
-
-	/* tracing dropped entries */
-	if (trace_data->dropped_entries) {
-		if (!overflow) {
-			/*
-			 * if any dropped entries have appeared and there
-			 * is not any overflow, their amount will be logged
-			 */
-			uint32_t tmp_dropped_entries =
-				trace_data->dropped_entries;
-			trace_data->dropped_entries = 0;
-			/*
-			 * this trace_error invocation causes recursion,
-			 * so after it we have to recalculate margin and
-			 * overflow
-			 */
-			trace_error(0, "dtrace_add_event(): number of dropped logs = %u",
-				    tmp_dropped_entries);
-			margin = dtrace_calc_buf_margin(buffer);
-			overflow = dtrace_calc_buf_overflow(buffer, length);
-		}
+	/* if there is not enough memory for new log, we drop it */
+	if (dtrace_calc_buf_overflow(buffer, length)) {
+		trace_data->dropped_entries++;
+		return;
 	}
 
-	/* checking overflow */
-	if (!overflow) {
-		/* check for buffer wrap */
-		if (margin > length) {
-			/* no wrap */
-			dcache_invalidate_region(buffer->w_ptr, length);
-			ret = memcpy_s(buffer->w_ptr, length, e, length);
-			assert(!ret);
-			dcache_writeback_region(buffer->w_ptr, length);
-			buffer->w_ptr = (char *)buffer->w_ptr + length;
-		} else {
-			/* data is bigger than remaining margin so we wrap */
-			dcache_invalidate_region(buffer->w_ptr, margin);
-			ret = memcpy_s(buffer->w_ptr, margin, e, margin);
-			assert(!ret);
-			dcache_writeback_region(buffer->w_ptr, margin);
-			buffer->w_ptr = buffer->addr;
-
-			dcache_invalidate_region(buffer->w_ptr,
-						 length - margin);
-			ret = memcpy_s(buffer->w_ptr, length - margin,
-				       e + margin, length - margin);
-			assert(!ret);
-			dcache_writeback_region(buffer->w_ptr,
-						length - margin);
-			buffer->w_ptr = (char *)buffer->w_ptr + length - margin;
+	/* entries and buffer are word aligned, so wrap is too */
+	for (i = 0; i < length / sizeof(uint32_t); i++) {
+		*dst++ = e[i];
+		if (dst == buffer->end_addr)
+			dst = buffer->addr;
+	}
+
+	buffer->w_ptr = dst;
+	buffer->avail += length;
+	trace_data->posn.messages++;
+}
+
+#if CONFIG_TRACE_COMPACT
+
+/* compact record size in words, a tag and the varints of a full entry */
+#define DTRACE_COMPACT_WORDS \
+	(ALIGN_UP(1 + TRACE_COMPACT_VARINT64_MAX + \
+		  (4 + _TRACE_EVENT_MAX_ARGUMENT_COUNT) * \
+		  TRACE_COMPACT_VARINT32_MAX, sizeof(uint32_t)) / \
+	 sizeof(uint32_t))
+
+#define DTRACE_ID_INVALID	MASK(TRACE_ID_LENGTH - 1, 0)
+
+static uint8_t *dtrace_varint(uint8_t *dst, uint64_t value)
+{
+	while (value >= 0x80) {
+		*dst++ = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+
+	*dst++ = value;
+
+	return dst;
+}
+
+/* encodes drained record of the ring, returns compact size in bytes */
+static uint32_t dtrace_compact(struct dtrace_ring *ring,
+			       const struct dtrace_record *record,
+			       uint32_t *compact)
+{
+	const struct log_entry_header *header =
+		(const struct log_entry_header *)record->data;
+	const uint32_t *params = record->data +
+		sizeof(*header) / sizeof(uint32_t);
+	uint32_t params_num = (record->length - sizeof(*header)) /
+		sizeof(uint32_t);
+	uint64_t stamp = header->timestamp;
+	uint64_t delta = stamp - ring->last_stamp;
+	uint8_t *dst = (uint8_t *)compact;
+	uint8_t tag;
+	uint32_t i;
+
+	tag = TRACE_COMPACT_MAGIC | (header->core_id & TRACE_COMPACT_CORE_MASK);
+
+	/* records of nested events can be stamped out of order */
+	if (!ring->sync_count || stamp < ring->last_stamp ||
+	    delta >= TRACE_COMPACT_DELTA_MAX) {
+		tag |= TRACE_COMPACT_ABS;
+		delta = stamp;
+		ring->sync_count = TRACE_COMPACT_SYNC;
+	}
+
+	ring->sync_count--;
+	ring->last_stamp = stamp;
+
+	if (header->id_0 != DTRACE_ID_INVALID ||
+	    header->id_1 != DTRACE_ID_INVALID)
+		tag |= TRACE_COMPACT_IDS;
+
+	*dst++ = tag;
+	dst = dtrace_varint(dst, delta);
+	dst = dtrace_varint(dst, (header->log_entry_address -
+				  LOG_ENTRY_ELF_BASE) / sizeof(uint32_t));
+	dst = dtrace_varint(dst, header->uid ? (header->uid -
+			    UUID_ENTRY_ELF_BASE) / sizeof(uint32_t) + 1 : 0);
+
+	if (tag & TRACE_COMPACT_IDS) {
+		dst = dtrace_varint(dst, header->id_0);
+		dst = dtrace_varint(dst, header->id_1);
+	}
+
+	for (i = 0; i < params_num; i++)
+		dst = dtrace_varint(dst, params[i]);
+
+	/* DMA trace buffer is word aligned */
+	while ((dst - (uint8_t *)compact) % sizeof(uint32_t))
+		*dst++ = 0;
+
+	return dst - (uint8_t *)compact;
+}
+
+/* copies drained record to DMA trace buffer, call with lock held */
+static void dtrace_add_record(struct dma_trace_data *d,
+			      struct dtrace_ring *ring,
+			      const struct dtrace_record *record)
+{
+	uint32_t compact[DTRACE_COMPACT_WORDS];
+
+	dtrace_add_event(d, compact, dtrace_compact(ring, record, compact));
+}
+
+#else
+
+static void dtrace_add_record(struct dma_trace_data *d,
+			      struct dtrace_ring *ring,
+			      const struct dtrace_record *record)
+{
+	dtrace_add_event(d, record->data, record->length);
+}
+
+#endif
+
+/* moves entries of all rings to DMA trace buffer, call with lock held */
+static void dtrace_ring_drain(struct dma_trace_data *d)
+{
+	struct dma_trace_buf *buffer = &d->dmatb;
+	struct dtrace_record *record;
+	struct dtrace_ring *ring;
+	char *w_ptr = buffer->w_ptr;
+	uint32_t dropped_entries;
+	uint32_t r_idx;
+	uint32_t w_idx;
+	int i;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		ring = d->ring[i];
+		if (!ring)
+			continue;
+
+		w_idx = atomic_read(&ring->w_idx);
+
+		for (r_idx = atomic_read(&ring->r_idx); r_idx != w_idx;
+		     r_idx++) {
+			record = &ring->records[r_idx &
+						(DTRACE_RING_RECORDS - 1)];
+			dtrace_add_record(d, ring, record);
 		}
 
-		buffer->avail += length;
-		trace_data->posn.messages++;
-	} else {
-		/* if there is not enough memory for new log, we drop it */
-		trace_data->dropped_entries++;
+		/* releases drained records to the writer core */
+		atomic_add(&ring->r_idx, w_idx - atomic_read(&ring->r_idx));
+
+		/* only writer core updates the counter of dropped entries */
+		dropped_entries = ring->dropped_entries;
+		d->dropped_entries += dropped_entries - ring->dropped_drained;
+		ring->dropped_drained = dropped_entries;
 	}
 
-	platform_shared_commit(trace_data, sizeof(*trace_data));
+	/* single writeback of the whole batch */
+	if ((char *)buffer->w_ptr < w_ptr) {
+		dcache_writeback_region(w_ptr,
+					(char *)buffer->end_addr - w_ptr);
+		dcache_writeback_region(buffer->addr, (char *)buffer->w_ptr -
+					(char *)buffer->addr);
+	} else if ((char *)buffer->w_ptr > w_ptr) {
+		dcache_writeback_region(w_ptr, (char *)buffer->w_ptr - w_ptr);
+	}
+
+	platform_shared_commit(d, sizeof(*d));
 }
 
-void dtrace_event(const char *e, uint32_t length)
+/* returns ring of current core if entry can be traced */
+static struct dtrace_ring *dtrace_ring_get(struct dma_trace_data *trace_data,
+					   uint32_t length)
 {
-	struct dma_trace_data *trace_data = dma_trace_data_get();
-	struct dma_trace_buf *buffer = NULL;
-	unsigned long flags;
+	if (!trace_data || !trace_data->dmatb.addr || length == 0 ||
+	    length > DTRACE_RECORD_WORDS * sizeof(uint32_t))
+		return NULL;
 
-	if (!trace_data || !trace_data->dmatb.addr ||
-	    length > DMA_TRACE_LOCAL_SIZE / 8 || length == 0) {
-		platform_shared_commit(trace_data, sizeof(*trace_data));
-		return;
+	return trace_data->ring[cpu_get_id()];
+}
+
+/* stores entry in ring of current core, returns ring fill in records */
+static uint32_t dtrace_ring_add(struct dtrace_ring *ring, const char *e,
+				uint32_t length)
+{
+	const uint32_t *src = (const uint32_t *)e;
+	struct dtrace_record *record;
+	uint32_t flags;
+	uint32_t w_idx;
+	uint32_t fill;
+	uint32_t i;
+
+	/* single writer, only nested events on this core can interfere */
+	irq_local_disable(flags);
+
+	w_idx = atomic_read(&ring->w_idx);
+	fill = w_idx - atomic_read(&ring->r_idx);
+
+	if (fill < DTRACE_RING_RECORDS) {
+		record = &ring->records[w_idx & (DTRACE_RING_RECORDS - 1)];
+		record->length = length;
+		for (i = 0; i < length / sizeof(uint32_t); i++)
+			record->data[i] = src[i];
+
+		/* publish record to trace work */
+		atomic_add(&ring->w_idx, 1);
+		fill++;
+	} else {
+		ring->dropped_entries++;
 	}
 
-	buffer = &trace_data->dmatb;
+	irq_local_enable(flags);
 
-	spin_lock_irq(&trace_data->lock, flags);
-	dtrace_add_event(e, length);
+	return fill;
+}
 
-	/* if DMA trace copying is working or slave core
-	 * don't check if local buffer is half full
-	 */
-	if (trace_data->copy_in_progress ||
-	    cpu_get_id() != PLATFORM_MASTER_CORE_ID) {
+void dtrace_event(const char *e, uint32_t length)
+{
+	struct dma_trace_data *trace_data = dma_trace_data_get();
+	struct dtrace_ring *ring;
+	uint32_t fill;
+
+	ring = dtrace_ring_get(trace_data, length);
+	if (!ring) {
 		platform_shared_commit(trace_data, sizeof(*trace_data));
-		spin_unlock_irq(&trace_data->lock, flags);
 		return;
 	}
 
-	spin_unlock_irq(&trace_data->lock, flags);
+	fill = dtrace_ring_add(ring, e, length);
 
-	/* schedule copy now if buffer > 50% full */
-	if (trace_data->enabled &&
-	    buffer->avail >= (DMA_TRACE_LOCAL_SIZE / 2)) {
+	/* trace work drains rings of all cores, so only master core
+	 * schedules copy now if its ring crossed the watermark and
+	 * DMA trace copying isn't already working
+	 */
+	if (trace_data->enabled && !trace_data->copy_in_progress &&
+	    fill >= DTRACE_RING_WATERMARK &&
+	    cpu_get_id() == PLATFORM_MASTER_CORE_ID) {
 		reschedule_task(&trace_data->dmat_work,
 				DMA_TRACE_RESCHEDULE_TIME);
 		/* reschedule should not be interrupted
@@ -561,12 +753,11 @@ void dtrace_event(const char *e, uint32_t length)
 void dtrace_event_atomic(const char *e, uint32_t length)
 {
 	struct dma_trace_data *trace_data = dma_trace_data_get();
+	struct dtrace_ring *ring;
 
-	if (!trace_data || !trace_data->dmatb.addr ||
-	    length > DMA_TRACE_LOCAL_SIZE / 8 || length == 0) {
-		platform_shared_commit(trace_data, sizeof(*trace_data));
-		return;
-	}
+	ring = dtrace_ring_get(trace_data, length);
+	if (ring)
+		dtrace_ring_add(ring, e, length);
 
-	dtrace_add_event(e, length);
+	platform_shared_commit(trace_data, sizeof(*trace_data));
 }
@@ -12,6 +12,7 @@
 #include <sof/lib/cpu.h>
 #include <sof/lib/mailbox.h>
 #include <sof/lib/memory.h>
+#include <sof/math/numbers.h>
 #include <sof/platform.h>
 #include <sof/string.h>
 #include <sof/sof.h>
@@ -20,12 +21,31 @@
 #include <sof/trace/preproc.h>
 #include <sof/trace/trace.h>
 #include <ipc/topology.h>
+#include <ipc/trace.h>
 #include <user/trace.h>
+#include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+/* number of filtered trace classes, class is kept in high 8 bits */
+#define TRACE_CLASS_COUNT	64
+#define TRACE_CLASS_SHIFT	24
+
+/* maximum number of components with own trace level */
+#define TRACE_FILTER_COMP_COUNT	8
+
+struct trace_filter_comp {
+	uint32_t comp_id;
+	uint32_t level;	/* highest traced level */
+};
+
 struct trace {
 	uint32_t pos ;	/* trace position */
 	uint32_t enable;
+	uint32_t comp_count;	/* components with own trace level */
+	uint32_t comp_level;	/* highest level of all components */
+	struct trace_filter_comp comp[TRACE_FILTER_COMP_COUNT];
+	uint8_t class_level[TRACE_CLASS_COUNT];	/* highest traced level */
 	spinlock_t lock; /* locking mechanism */
 };
 
@@ -67,27 +87,32 @@ static void put_header(uint32_t *dst, uint32_t id_0,
 static void mtrace_event(const char *data, uint32_t length)
 {
 	struct trace *trace = trace_get();
-	volatile char *t;
+	const uint32_t *src = (const uint32_t *)data;
+	uint32_t *t;
 	uint32_t i, available;
 
-	available = MAILBOX_TRACE_SIZE - trace->pos;
+	/* entries, position and mailbox size are word aligned */
+	available = (MAILBOX_TRACE_SIZE - trace->pos) / sizeof(uint32_t);
+	length /= sizeof(uint32_t);
 
-	t = (volatile char *)(MAILBOX_TRACE_BASE);
+	t = (uint32_t *)(MAILBOX_TRACE_BASE + trace->pos);
 
 	/* write until we run out of space */
 	for (i = 0; i < available && i < length; i++)
-		t[trace->pos + i] = data[i];
+		t[i] = src[i];
 
-	dcache_writeback_region((void *)&t[trace->pos], i);
-	trace->pos += length;
+	dcache_writeback_region(t, i * sizeof(uint32_t));
+	trace->pos += i * sizeof(uint32_t);
 
 	/* if there was more data than space available, wrap back */
 	if (length > available) {
+		t = (uint32_t *)MAILBOX_TRACE_BASE;
+
 		for (i = 0; i < length - available; i++)
-			t[i] = data[available + i];
+			t[i] = src[available + i];
 
-		dcache_writeback_region((void *)t, i);
-		trace->pos = i;
+		dcache_writeback_region(t, i * sizeof(uint32_t));
+		trace->pos = i * sizeof(uint32_t);
 	}
 
 	platform_shared_commit(trace, sizeof(*trace));
@@ -206,6 +231,112 @@ _TRACE_EVENT_NTH_IMPL_GROUP(3)
  */
 _TRACE_EVENT_NTH_IMPL_GROUP(4)
 
+/* called at the trace call site, before the entry is built */
+bool trace_filter_pass(uint32_t lvl, uint32_t comp_class, uint32_t comp_id)
+{
+	struct trace *trace = trace_get();
+	uint32_t class_idx = comp_class >> TRACE_CLASS_SHIFT;
+	bool pass = false;
+	int i;
+
+	if (class_idx >= TRACE_CLASS_COUNT ||
+	    lvl <= trace->class_level[class_idx]) {
+		pass = true;
+	} else if (lvl <= trace->comp_level) {
+		for (i = 0; i < trace->comp_count; i++) {
+			if (trace->comp[i].comp_id == comp_id) {
+				pass = lvl <= trace->comp[i].level;
+				break;
+			}
+		}
+	}
+
+	platform_shared_commit(trace, sizeof(*trace));
+
+	return pass;
+}
+
+static void trace_filter_reset(struct trace *trace)
+{
+	int i;
+
+	for (i = 0; i < TRACE_CLASS_COUNT; i++)
+		trace->class_level[i] = LOG_LEVEL_VERBOSE;
+
+	trace->comp_count = 0;
+	trace->comp_level = LOG_LEVEL_CRITICAL;
+}
+
+static int trace_filter_comp_set(struct trace *trace, uint32_t comp_id,
+				 uint32_t level)
+{
+	int i;
+
+	for (i = 0; i < trace->comp_count; i++)
+		if (trace->comp[i].comp_id == comp_id)
+			break;
+
+	if (level == LOG_LEVEL_CRITICAL) {
+		/* remove component level, keep entries packed */
+		if (i < trace->comp_count)
+			trace->comp[i] = trace->comp[--trace->comp_count];
+	} else if (i < trace->comp_count) {
+		trace->comp[i].level = level;
+	} else if (trace->comp_count < TRACE_FILTER_COMP_COUNT) {
+		trace->comp[i].comp_id = comp_id;
+		trace->comp[i].level = level;
+		trace->comp_count++;
+	} else {
+		return -ENOSPC;
+	}
+
+	/* recalculate level allowing search of component levels */
+	trace->comp_level = LOG_LEVEL_CRITICAL;
+	for (i = 0; i < trace->comp_count; i++)
+		trace->comp_level = MAX(trace->comp_level,
+					trace->comp[i].level);
+
+	return 0;
+}
+
+int trace_filter_update(const struct sof_ipc_trace_filter_elem *elem)
+{
+	struct trace *trace = trace_get();
+	uint32_t class_idx = elem->id >> TRACE_CLASS_SHIFT;
+	uint32_t level;
+	uint32_t flags;
+	int ret = 0;
+
+	/* errors are always traced */
+	level = MIN(MAX(elem->level, LOG_LEVEL_CRITICAL), LOG_LEVEL_VERBOSE);
+
+	spin_lock_irq(&trace->lock, flags);
+
+	switch (elem->type) {
+	case SOF_IPC_TRACE_FILTER_ELEM_CLASS:
+		if (class_idx < TRACE_CLASS_COUNT)
+			trace->class_level[class_idx] = level;
+		else
+			ret = -EINVAL;
+		break;
+	case SOF_IPC_TRACE_FILTER_ELEM_COMP:
+		ret = trace_filter_comp_set(trace, elem->id, level);
+		break;
+	case SOF_IPC_TRACE_FILTER_ELEM_RESET:
+		trace_filter_reset(trace);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	platform_shared_commit(trace, sizeof(*trace));
+
+	spin_unlock_irq(&trace->lock, flags);
+
+	return ret;
+}
+
 void trace_flush(void)
 {
 	struct trace *trace = trace_get();
@@ -263,6 +394,7 @@ void trace_init(struct sof *sof)
 			     SOF_MEM_CAPS_RAM, sizeof(*sof->trace));
 	sof->trace->enable = 1;
 	sof->trace->pos = 0;
+	trace_filter_reset(sof->trace);
 	spinlock_init(&sof->trace->lock);
 
 	platform_shared_commit(sof->trace, sizeof(*sof->trace));
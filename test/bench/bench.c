@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Micro-benchmark of the audio processing kernels on synthetic rings */
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/component.h>
+#include <sof/debug/panic.h>
+#include <sof/trace/trace.h>
+#include <ipc/stream.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+
+#if defined __XTENSA__
+#include <xtensa/hal.h>
+#elif defined __x86_64__ || defined __i386__
+#include <x86intrin.h>
+#include <time.h>
+#else
+#include <time.h>
+#endif
+
+/* default number of timed runs of each case */
+#define BENCH_ITERATIONS	100
+
+/* default clock used to convert between cycles and time */
+#define BENCH_CPU_MHZ		400
+
+static const struct bench_kernel *kernels[] = {
+#if CONFIG_COMP_MIXER
+	&bench_mixer,
+#endif
+#if CONFIG_COMP_VOLUME
+	&bench_volume,
+#endif
+	&bench_pcm,
+#if CONFIG_COMP_MUX
+	&bench_mux,
+#endif
+#if CONFIG_COMP_DCBLOCK
+	&bench_dcblock,
+#endif
+#if CONFIG_COMP_FIR
+	&bench_fir,
+#endif
+#if CONFIG_COMP_IIR
+	&bench_iir,
+	&bench_iir_block,
+#endif
+#if CONFIG_COMP_SRC
+	&bench_src_2_1,
+	&bench_src_1_2,
+#endif
+#if CONFIG_COMP_ASRC
+	&bench_asrc,
+#endif
+	&bench_sin,
+	&bench_sin_block,
+	&bench_sin_osc,
+	&bench_db2lin,
+	&bench_db2lin_block,
+	&bench_crc32,
+};
+
+static const enum sof_ipc_frame formats[] = {
+#if CONFIG_FORMAT_S16LE
+	SOF_IPC_FRAME_S16_LE,
+#endif
+#if CONFIG_FORMAT_S24LE
+	SOF_IPC_FRAME_S24_4LE,
+#endif
+#if CONFIG_FORMAT_S32LE
+	SOF_IPC_FRAME_S32_LE,
+#endif
+#if CONFIG_FORMAT_FLOAT
+	SOF_IPC_FRAME_FLOAT,
+#endif
+#if CONFIG_FORMAT_S24_3LE
+	SOF_IPC_FRAME_S24_3LE,
+#endif
+};
+
+static const int channels[] = { 1, 2, 4, 8 };
+static const int frames[] = { 48, 192 };
+
+/* ring wrap position as a divisor of the block, 0 for no wrap */
+static const int wraps[] = { 0, 2, 4 };
+
+struct bench_time {
+	uint64_t ns;
+	uint64_t cycles;
+};
+
+static int cpu_mhz = BENCH_CPU_MHZ;
+
+/* zero cycle count means the platform has no cycle counter */
+static void bench_time_now(struct bench_time *t)
+{
+#if defined __XTENSA__
+	t->cycles = xthal_get_ccount();
+	t->ns = 0;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	t->ns = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#if defined __x86_64__ || defined __i386__
+	t->cycles = __rdtsc();
+#else
+	t->cycles = 0;
+#endif
+#endif
+}
+
+static void bench_time_diff(struct bench_time *sum,
+			    const struct bench_time *start,
+			    const struct bench_time *end)
+{
+#if defined __XTENSA__
+	/* the cycle counter is 32 bit and wraps */
+	uint32_t cycles = (uint32_t)end->cycles - (uint32_t)start->cycles;
+
+	sum->cycles += cycles;
+	sum->ns += (uint64_t)cycles * 1000 / cpu_mhz;
+#else
+	sum->ns += end->ns - start->ns;
+	if (end->cycles)
+		sum->cycles += end->cycles - start->cycles;
+	else
+		sum->cycles += (end->ns - start->ns) * cpu_mhz / 1000;
+#endif
+}
+
+#if CONFIG_LIBRARY
+/* host library hooks otherwise provided by the testbench */
+int test_bench_trace;
+
+char *get_trace_class(uint32_t trace_class)
+{
+	return "bench";
+}
+
+void __panic(uint32_t p, char *filename, uint32_t linenum)
+{
+	abort();
+}
+#endif
+
+static const char *bench_fmt_name(enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return "s16";
+	case SOF_IPC_FRAME_S24_4LE:
+		return "s24";
+	case SOF_IPC_FRAME_S32_LE:
+		return "s32";
+	case SOF_IPC_FRAME_FLOAT:
+		return "float";
+	case SOF_IPC_FRAME_S24_3LE:
+		return "s24_3";
+	default:
+		return "?";
+	}
+}
+
+/* fills ring with a deterministic pattern in the range of its format */
+static void bench_case_run(const struct bench_kernel *k,
+			   const struct bench_case *c, int iterations)
+{
+	struct bench_rings rings;
+	struct bench_time start;
+	struct bench_time end;
+	struct bench_time sum = { 0 };
+	uint64_t min_cycles = UINT64_MAX;
+	uint64_t cycles;
+	double samples;
+	void *state;
+	int i;
+
+	state = k->prepare(c);
+	if (!state)
+		return;
+
+	if (bench_rings_init(&rings, c, k->num_sources) < 0) {
+		fprintf(stderr, "error: no memory for rings\n");
+		k->free(state);
+		return;
+	}
+
+	/* warm up caches and filter state */
+	k->run(state, &rings, c);
+
+	for (i = 0; i < iterations; i++) {
+		cycles = sum.cycles;
+		bench_time_now(&start);
+		k->run(state, &rings, c);
+		bench_time_now(&end);
+		bench_time_diff(&sum, &start, &end);
+		if (sum.cycles - cycles < min_cycles)
+			min_cycles = sum.cycles - cycles;
+	}
+
+	samples = (double)c->frames * c->channels;
+
+	printf("%-9s %-5s %-5s ch %d frames %3d wrap %3d ns/sample %8.2f cycles/sample %8.2f min %8.2f\n",
+	       k->name, bench_fmt_name(c->source_fmt),
+	       bench_fmt_name(c->sink_fmt), c->channels, c->frames,
+	       c->wrap, (double)sum.ns / iterations / samples,
+	       (double)sum.cycles / iterations / samples,
+	       (double)min_cycles / samples);
+
+	bench_rings_free(&rings);
+	k->free(state);
+}
+
+/* runs one format pair over the channel, size and wrap matrix */
+static void bench_format_run(const struct bench_kernel *k,
+			     struct bench_case *c, int iterations)
+{
+	int n, b, w;
+
+	for (n = 0; n < ARRAY_SIZE(channels); n++) {
+		for (b = 0; b < ARRAY_SIZE(frames); b++) {
+			for (w = 0; w < ARRAY_SIZE(wraps); w++) {
+				c->channels = channels[n];
+				c->frames = frames[b];
+				c->wrap = wraps[w] ? frames[b] / wraps[w] : 0;
+				bench_case_run(k, c, iterations);
+			}
+		}
+	}
+}
+
+static void bench_kernel_run(const struct bench_kernel *k, int iterations)
+{
+	struct bench_case c;
+	int f, s;
+
+	for (f = 0; f < ARRAY_SIZE(formats); f++) {
+		for (s = 0; s < ARRAY_SIZE(formats); s++) {
+			/* converters run format pairs, others one format */
+			if ((s != f) != k->convert)
+				continue;
+
+			c.source_fmt = formats[f];
+			c.sink_fmt = formats[s];
+			bench_format_run(k, &c, iterations);
+		}
+	}
+}
+
+static void print_usage(char *executable)
+{
+	int i;
+
+	printf("Usage: %s [-k kernel] [-i iterations] [-m mhz]\n\n",
+	       executable);
+	printf("Options:\n");
+	printf("  -k kernel      run only the named kernel\n");
+	printf("  -i iterations  timed runs of each case (default %d)\n",
+	       BENCH_ITERATIONS);
+	printf("  -m mhz         clock for cycle and time conversion (default %d)\n",
+	       BENCH_CPU_MHZ);
+	printf("  -h             print this help\n\n");
+	printf("Kernels:");
+	for (i = 0; i < ARRAY_SIZE(kernels); i++)
+		printf(" %s", kernels[i]->name);
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *name = NULL;
+	int iterations = BENCH_ITERATIONS;
+	int option;
+	int i;
+
+	while ((option = getopt(argc, argv, "hk:i:m:")) != -1) {
+		switch (option) {
+		case 'k':
+			name = optarg;
+			break;
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		case 'm':
+			cpu_mhz = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			print_usage(argv[0]);
+			return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (iterations < 1 || cpu_mhz < 1) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(kernels); i++) {
+		if (name && strcmp(name, kernels[i]->name))
+			continue;
+
+		bench_kernel_run(kernels[i], iterations);
+	}
+
+	return EXIT_SUCCESS;
+}
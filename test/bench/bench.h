@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <sof/audio/audio_stream.h>
+#include <ipc/stream.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* max number of source rings given to a kernel */
+#define BENCH_MAX_SOURCES	4
+
+/* sink rings are sized for kernels producing more frames than consumed */
+#define BENCH_MAX_RATIO		2
+
+/* one point of the benchmark matrix */
+struct bench_case {
+	enum sof_ipc_frame source_fmt;
+	enum sof_ipc_frame sink_fmt;
+	int channels;
+	int frames;
+	int wrap;	/* frames until rings wrap, 0 for no wrap */
+};
+
+/* synthetic rings prepared for each case */
+struct bench_rings {
+	struct audio_stream source[BENCH_MAX_SOURCES];
+	struct audio_stream sink;
+};
+
+/* processing kernel under test */
+struct bench_kernel {
+	const char *name;
+	int num_sources;	/* source rings used by the kernel */
+	bool convert;		/* sink format may differ from source */
+
+	/* returns kernel state or NULL when the case is not supported */
+	void *(*prepare)(const struct bench_case *c);
+
+	/* processes c->frames frames from the source rings to the sink */
+	void (*run)(void *state, struct bench_rings *r,
+		    const struct bench_case *c);
+
+	void (*free)(void *state);
+};
+
+/* zero initialised component device used by kernels taking one */
+struct comp_dev *bench_comp_new(void *drvdata);
+void bench_comp_free(struct comp_dev *dev);
+
+/* allocates filled source rings and an empty sink ring for the case */
+int bench_rings_init(struct bench_rings *r, const struct bench_case *c,
+		     int num_sources);
+void bench_rings_free(struct bench_rings *r);
+
+extern const struct bench_kernel bench_mixer;
+extern const struct bench_kernel bench_volume;
+extern const struct bench_kernel bench_pcm;
+extern const struct bench_kernel bench_mux;
+extern const struct bench_kernel bench_dcblock;
+extern const struct bench_kernel bench_fir;
+extern const struct bench_kernel bench_iir;
+extern const struct bench_kernel bench_iir_block;
+extern const struct bench_kernel bench_src_2_1;
+extern const struct bench_kernel bench_src_1_2;
+extern const struct bench_kernel bench_asrc;
+extern const struct bench_kernel bench_sin;
+extern const struct bench_kernel bench_sin_block;
+extern const struct bench_kernel bench_sin_osc;
+extern const struct bench_kernel bench_db2lin;
+extern const struct bench_kernel bench_db2lin_block;
+extern const struct bench_kernel bench_crc32;
+
+#endif /* __BENCH_H__ */
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/asrc/asrc_farrow.h>
+#include <sof/audio/component.h>
+#include <sof/audio/format.h>
+#include <sof/platform.h>
+#include <stdlib.h>
+#include "bench.h"
+
+/* rates of a typical 48 kHz to 44.1 kHz conversion */
+#define BENCH_ASRC_FS_PRIM	48000
+#define BENCH_ASRC_FS_SEC	44100
+
+struct asrc_bench {
+	struct comp_dev *dev;
+	struct asrc_farrow *obj;
+	int bits;
+};
+
+static void asrc_free(void *state)
+{
+	struct asrc_bench *ab = state;
+
+	free(ab->obj);
+	bench_comp_free(ab->dev);
+	free(ab);
+}
+
+static void *asrc_prepare(const struct bench_case *c)
+{
+	struct asrc_bench *ab;
+	int size;
+	int ret;
+
+	if (c->channels > PLATFORM_MAX_CHANNELS)
+		return NULL;
+
+	ab = calloc(1, sizeof(*ab));
+	if (!ab)
+		return NULL;
+
+	switch (c->source_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		ab->bits = 16;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+	case SOF_IPC_FRAME_S32_LE:
+		ab->bits = 32;
+		break;
+	default:
+		goto err;
+	}
+
+	ab->dev = bench_comp_new(NULL);
+	if (!ab->dev)
+		goto err;
+
+	ret = asrc_get_required_size(ab->dev, &size, c->channels, ab->bits);
+	if (ret)
+		goto err;
+
+	ab->obj = calloc(1, size);
+	if (!ab->obj)
+		goto err;
+
+	ret = asrc_initialise(ab->dev, ab->obj, c->channels,
+			      BENCH_ASRC_FS_PRIM, BENCH_ASRC_FS_SEC,
+			      ASRC_IOF_INTERLEAVED, ASRC_IOF_INTERLEAVED,
+			      ASRC_BM_LINEAR, c->frames * BENCH_MAX_RATIO,
+			      ab->bits, ASRC_CM_FEEDBACK, ASRC_OM_PUSH);
+	if (ret)
+		goto err;
+
+	ret = asrc_update_drift(ab->dev, ab->obj, Q_CONVERT_FLOAT(1.0, 30));
+	if (ret)
+		goto err;
+
+	return ab;
+
+err:
+	asrc_free(ab);
+	return NULL;
+}
+
+/* The Farrow filter works on linear buffers, the ASRC component copies
+ * the rings to them, so the ring start is used here and wrap is ignored.
+ */
+static void asrc_run(void *state, struct bench_rings *r,
+		     const struct bench_case *c)
+{
+	struct asrc_bench *ab = state;
+	uint8_t *ibuf[PLATFORM_MAX_CHANNELS];
+	uint8_t *obuf[PLATFORM_MAX_CHANNELS];
+	int sample_bytes = ab->bits / 8;
+	int frames = 0;
+	int idx = 0;
+	int i;
+
+	for (i = 0; i < c->channels; i++) {
+		ibuf[i] = (uint8_t *)r->source[0].addr + i * sample_bytes;
+		obuf[i] = (uint8_t *)r->sink.addr + i * sample_bytes;
+	}
+
+	if (ab->bits == 16)
+		asrc_process_push16(ab->dev, ab->obj, (int16_t **)ibuf,
+				    c->frames, (int16_t **)obuf, &frames,
+				    &idx, 0);
+	else
+		asrc_process_push32(ab->dev, ab->obj, (int32_t **)ibuf,
+				    c->frames, (int32_t **)obuf, &frames,
+				    &idx, 0);
+}
+
+const struct bench_kernel bench_asrc = {
+	.name = "asrc",
+	.num_sources = 1,
+	.prepare = asrc_prepare,
+	.run = asrc_run,
+	.free = asrc_free,
+};
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/dcblock/dcblock.h>
+#include <sof/audio/format.h>
+#include <stdlib.h>
+#include "bench.h"
+
+/* pole radius of a typical DC blocker in Q2.30 */
+#define BENCH_DCBLOCK_R	Q_CONVERT_FLOAT(0.98, 30)
+
+static void *dcblock_prepare(const struct bench_case *c)
+{
+	struct comp_data *cd;
+	struct comp_dev *dev;
+	dcblock_func func;
+	int i;
+
+	func = dcblock_find_func(c->source_fmt);
+	if (!func)
+		return NULL;
+
+	cd = calloc(1, sizeof(*cd));
+	if (!cd)
+		return NULL;
+
+	cd->dcblock_func = func;
+	cd->source_format = c->source_fmt;
+	cd->sink_format = c->sink_fmt;
+	for (i = 0; i < c->channels; i++)
+		cd->R_coeffs[i] = BENCH_DCBLOCK_R;
+
+	dev = bench_comp_new(cd);
+	if (!dev)
+		free(cd);
+
+	return dev;
+}
+
+static void dcblock_run(void *state, struct bench_rings *r,
+			const struct bench_case *c)
+{
+	struct comp_dev *dev = state;
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	cd->dcblock_func(dev, &r->source[0], &r->sink, c->frames, 0,
+			 r->sink.channels);
+}
+
+static void dcblock_free(void *state)
+{
+	struct comp_dev *dev = state;
+
+	free(comp_get_drvdata(dev));
+	bench_comp_free(dev);
+}
+
+const struct bench_kernel bench_dcblock = {
+	.name = "dcblock",
+	.num_sources = 1,
+	.prepare = dcblock_prepare,
+	.run = dcblock_run,
+	.free = dcblock_free,
+};
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/eq_fir/fir_config.h>
+#include <sof/platform.h>
+#include <user/eq.h>
+#include <stdlib.h>
+#include "bench.h"
+
+#if FIR_GENERIC
+#include <sof/audio/eq_fir/fir.h>
+#endif
+#if FIR_HIFIEP
+#include <sof/audio/eq_fir/fir_hifi2ep.h>
+#endif
+#if FIR_HIFI3
+#include <sof/audio/eq_fir/fir_hifi3.h>
+#endif
+
+/* filter length of a typical speaker equalizer */
+#define BENCH_FIR_TAPS	64
+
+typedef void (*fir_func)(struct fir_state_32x16 fir[],
+			 const struct audio_stream *source,
+			 struct audio_stream *sink, int frames, int nch);
+
+/* kernel variants picked the same way as by the EQ FIR component */
+struct fir_func_map {
+	enum sof_ipc_frame fmt;
+	fir_func func;		/* for less than FIR_MC_MIN_CHANNELS */
+	fir_func func_mc;
+};
+
+static const struct fir_func_map fir_func_map[] = {
+#if FIR_HIFI3
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, eq_fir_2x_s16_hifi3, eq_fir_mc_s16_hifi3 },
+#endif
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, eq_fir_2x_s24_hifi3, eq_fir_mc_s24_hifi3 },
+#endif
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, eq_fir_2x_s32_hifi3, eq_fir_mc_s32_hifi3 },
+#endif
+#elif FIR_HIFIEP
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, eq_fir_2x_s16_hifiep, eq_fir_2x_s16_hifiep },
+#endif
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, eq_fir_2x_s24_hifiep, eq_fir_2x_s24_hifiep },
+#endif
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, eq_fir_2x_s32_hifiep, eq_fir_2x_s32_hifiep },
+#endif
+#else
+#if CONFIG_FORMAT_S16LE
+	{ SOF_IPC_FRAME_S16_LE, eq_fir_s16, eq_fir_mc_s16 },
+#endif
+#if CONFIG_FORMAT_S24LE
+	{ SOF_IPC_FRAME_S24_4LE, eq_fir_s24, eq_fir_mc_s24 },
+#endif
+#if CONFIG_FORMAT_S32LE
+	{ SOF_IPC_FRAME_S32_LE, eq_fir_s32, eq_fir_mc_s32 },
+#endif
+#endif
+};
+
+struct fir_bench {
+	struct fir_state_32x16 fir[PLATFORM_MAX_CHANNELS];
+	struct sof_eq_fir_coef_data *config;
+	int32_t *delay;
+	fir_func func;
+};
+
+static void fir_free(void *state)
+{
+	struct fir_bench *fb = state;
+
+	free(fb->delay);
+	free(fb->config);
+	free(fb);
+}
+
+static void *fir_prepare(const struct bench_case *c)
+{
+	struct fir_bench *fb;
+	int32_t *delay;
+	int size;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(fir_func_map); i++)
+		if (fir_func_map[i].fmt == c->source_fmt)
+			break;
+
+	if (i == ARRAY_SIZE(fir_func_map) || c->channels > PLATFORM_MAX_CHANNELS)
+		return NULL;
+
+	fb = calloc(1, sizeof(*fb));
+	if (!fb)
+		return NULL;
+
+	fb->func = c->channels >= FIR_MC_MIN_CHANNELS ?
+		fir_func_map[i].func_mc : fir_func_map[i].func;
+
+	/* unit impulse in the middle of the response */
+	fb->config = calloc(1, sizeof(*fb->config) +
+			    BENCH_FIR_TAPS * sizeof(int16_t));
+	if (!fb->config)
+		goto err;
+
+	fb->config->length = BENCH_FIR_TAPS;
+	fb->config->coef[BENCH_FIR_TAPS / 2] = INT16_MAX;
+
+	size = fir_delay_size(fb->config);
+	if (size < 0)
+		goto err;
+
+	fb->delay = calloc(c->channels, size);
+	if (!fb->delay)
+		goto err;
+
+	delay = fb->delay;
+	for (i = 0; i < c->channels; i++) {
+		if (fir_init_coef(&fb->fir[i], fb->config) < 0)
+			goto err;
+
+		fir_init_delay(&fb->fir[i], &delay);
+	}
+
+	return fb;
+
+err:
+	fir_free(fb);
+	return NULL;
+}
+
+static void fir_run(void *state, struct bench_rings *r,
+		    const struct bench_case *c)
+{
+	struct fir_bench *fb = state;
+
+	fb->func(fb->fir, &r->source[0], &r->sink, c->frames, c->channels);
+}
+
+const struct bench_kernel bench_fir = {
+	.name = "fir",
+	.num_sources = 1,
+	.prepare = fir_prepare,
+	.run = fir_run,
+	.free = fir_free,
+};
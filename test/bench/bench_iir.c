@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/eq_iir/iir.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <user/eq.h>
+#include <stdlib.h>
+#include "bench.h"
+
+/* sections of a typical speaker equalizer */
+#define BENCH_IIR_BIQUADS	4
+
+struct iir_bench {
+	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS];
+	struct sof_eq_iir_header_df2t *config;
+	int64_t *delay;
+};
+
+static void iir_free(void *state)
+{
+	struct iir_bench *ib = state;
+
+	free(ib->delay);
+	free(ib->config);
+	free(ib);
+}
+
+/* series of mild low shelf biquads, stable and near unity gain */
+static void iir_init_biquads(int32_t *coef)
+{
+	int i;
+
+	for (i = 0; i < BENCH_IIR_BIQUADS; i++) {
+		coef[0] = Q_CONVERT_FLOAT(-0.81, 30);	/* a2 */
+		coef[1] = Q_CONVERT_FLOAT(1.8, 30);	/* a1 */
+		coef[2] = Q_CONVERT_FLOAT(0.0025, 30);	/* b2 */
+		coef[3] = Q_CONVERT_FLOAT(0.005, 30);	/* b1 */
+		coef[4] = Q_CONVERT_FLOAT(0.0025, 30);	/* b0 */
+		coef[5] = 0;				/* shift */
+		coef[6] = Q_CONVERT_FLOAT(1.0, 14);	/* gain */
+		coef += SOF_EQ_IIR_NBIQUAD_DF2T;
+	}
+}
+
+static void *iir_prepare(const struct bench_case *c)
+{
+	struct iir_bench *ib;
+	int64_t *delay;
+	int size;
+	int i;
+
+	if (c->channels > PLATFORM_MAX_CHANNELS)
+		return NULL;
+
+	ib = calloc(1, sizeof(*ib));
+	if (!ib)
+		return NULL;
+
+	ib->config = calloc(1, sizeof(*ib->config) + BENCH_IIR_BIQUADS *
+			    SOF_EQ_IIR_NBIQUAD_DF2T * sizeof(int32_t));
+	if (!ib->config)
+		goto err;
+
+	ib->config->num_sections = BENCH_IIR_BIQUADS;
+	ib->config->num_sections_in_series = BENCH_IIR_BIQUADS;
+	/* biquads follow the packed header */
+	iir_init_biquads((int32_t *)(ib->config + 1));
+
+	size = iir_delay_size_df2t(ib->config);
+	if (size < 0)
+		goto err;
+
+	ib->delay = calloc(c->channels, size);
+	if (!ib->delay)
+		goto err;
+
+	delay = ib->delay;
+	for (i = 0; i < c->channels; i++) {
+		iir_init_coef_df2t(&ib->iir[i], ib->config);
+		iir_init_delay_df2t(&ib->iir[i], &delay);
+	}
+
+	return ib;
+
+err:
+	iir_free(ib);
+	return NULL;
+}
+
+static void *iir_sample_prepare(const struct bench_case *c)
+{
+	switch (c->source_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+	case SOF_IPC_FRAME_S24_4LE:
+	case SOF_IPC_FRAME_S32_LE:
+		return iir_prepare(c);
+	default:
+		return NULL;
+	}
+}
+
+/* sample by sample filter as in the EQ IIR component before blocks */
+static void iir_sample_run(void *state, struct bench_rings *r,
+			   const struct bench_case *c)
+{
+	struct iir_bench *ib = state;
+	struct audio_stream *source = &r->source[0];
+	struct audio_stream *sink = &r->sink;
+	int nch = c->channels;
+	int32_t tmp;
+	int16_t *x16;
+	int16_t *y16;
+	int32_t *x;
+	int32_t *y;
+	int idx;
+	int ch;
+	int i;
+
+	for (ch = 0; ch < nch; ch++) {
+		idx = ch;
+		for (i = 0; i < c->frames; i++) {
+			switch (c->source_fmt) {
+			case SOF_IPC_FRAME_S16_LE:
+				x16 = audio_stream_read_frag_s16(source, idx);
+				y16 = audio_stream_write_frag_s16(sink, idx);
+				tmp = iir_df2t(&ib->iir[ch], *x16 << 16);
+				*y16 = sat_int16(Q_SHIFT_RND(tmp, 31, 15));
+				break;
+			case SOF_IPC_FRAME_S24_4LE:
+				x = audio_stream_read_frag_s32(source, idx);
+				y = audio_stream_write_frag_s32(sink, idx);
+				tmp = iir_df2t(&ib->iir[ch], *x << 8);
+				*y = sat_int24(Q_SHIFT_RND(tmp, 31, 23));
+				break;
+			default:
+				x = audio_stream_read_frag_s32(source, idx);
+				y = audio_stream_write_frag_s32(sink, idx);
+				*y = iir_df2t(&ib->iir[ch], *x);
+				break;
+			}
+			idx += nch;
+		}
+	}
+}
+
+static void *iir_block_prepare(const struct bench_case *c)
+{
+	if (c->source_fmt != SOF_IPC_FRAME_S32_LE)
+		return NULL;
+
+	return iir_prepare(c);
+}
+
+/* block filter over the ring spans between wraps */
+static void iir_block_run(void *state, struct bench_rings *r,
+			  const struct bench_case *c)
+{
+	struct iir_bench *ib = state;
+	struct audio_stream *source = &r->source[0];
+	struct audio_stream *sink = &r->sink;
+	int32_t *x = source->r_ptr;
+	int32_t *y = sink->w_ptr;
+	int frames = c->frames;
+	int nch = c->channels;
+	int n;
+	int ch;
+
+	while (frames) {
+		n = MIN(audio_stream_frames_without_wrap(source, x),
+			audio_stream_frames_without_wrap(sink, y));
+		n = MIN(n, frames);
+		for (ch = 0; ch < nch; ch++)
+			iir_df2t_block(&ib->iir[ch], x + ch, y + ch, n, nch);
+
+		x = audio_stream_wrap(source, x + n * nch);
+		y = audio_stream_wrap(sink, y + n * nch);
+		frames -= n;
+	}
+}
+
+const struct bench_kernel bench_iir = {
+	.name = "iir",
+	.num_sources = 1,
+	.prepare = iir_sample_prepare,
+	.run = iir_sample_run,
+	.free = iir_free,
+};
+
+const struct bench_kernel bench_iir_block = {
+	.name = "iir_block",
+	.num_sources = 1,
+	.prepare = iir_block_prepare,
+	.run = iir_block_run,
+	.free = iir_free,
+};
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Sine and decibel conversions of the tone generator and gain ramps,
+ * computed per sample, with the block functions and the recursive
+ * oscillator, and checksum of probe data. Results are written to the sink
+ * ring so the compiler can not drop the calls.
+ */
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/format.h>
+#include <sof/math/decibels.h>
+#include <sof/math/numbers.h>
+#include <sof/math/trig.h>
+#include <stdint.h>
+#include "bench.h"
+
+/* 997 Hz at 48 kHz in Q4.28 */
+#define BENCH_SIN_STEP	Q_CONVERT_FLOAT(0.1305070, 28)
+
+/* fade in from -40 dB in 0.1 dB steps in Q8.24 */
+#define BENCH_DB_START	Q_CONVERT_FLOAT(-40.0, 24)
+#define BENCH_DB_STEP	Q_CONVERT_FLOAT(0.1, 24)
+
+/* dummy state, kernels only need contiguous 32 bit sink samples */
+static int math_state;
+
+static void *math_prepare(const struct bench_case *c)
+{
+	if (c->sink_fmt != SOF_IPC_FRAME_S32_LE || c->wrap)
+		return NULL;
+
+	return &math_state;
+}
+
+static void sin_run(void *state, struct bench_rings *r,
+		    const struct bench_case *c)
+{
+	int32_t *y = r->sink.w_ptr;
+	int32_t w = 0;
+	int64_t next;
+	int n = c->frames * c->channels;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		y[i] = sin_fixed(w);
+
+		next = (int64_t)w + BENCH_SIN_STEP;
+		w = next > PI_MUL2_Q4_28 ?
+			(int32_t)(next - PI_MUL2_Q4_28) : (int32_t)next;
+	}
+}
+
+static void sin_block_run(void *state, struct bench_rings *r,
+			  const struct bench_case *c)
+{
+	sin_fixed_block(0, BENCH_SIN_STEP, r->sink.w_ptr,
+			c->frames * c->channels);
+}
+
+static void sin_osc_run(void *state, struct bench_rings *r,
+			const struct bench_case *c)
+{
+	struct sin_osc osc;
+
+	sin_osc_init(&osc, 0, BENCH_SIN_STEP);
+	sin_osc_block(&osc, INT32_MAX, r->sink.w_ptr, 1,
+		      c->frames * c->channels, false);
+}
+
+static void db2lin_run(void *state, struct bench_rings *r,
+		       const struct bench_case *c)
+{
+	int32_t *lin = r->sink.w_ptr;
+	int n = c->frames * c->channels;
+	int i;
+
+	for (i = 0; i < n; i++)
+		lin[i] = db2lin_fixed(BENCH_DB_START + i * BENCH_DB_STEP);
+}
+
+static void db2lin_block_run(void *state, struct bench_rings *r,
+			     const struct bench_case *c)
+{
+	db2lin_fixed_block(BENCH_DB_START, BENCH_DB_STEP, r->sink.w_ptr,
+			   c->frames * c->channels);
+}
+
+static void *crc32_prepare(const struct bench_case *c)
+{
+	return &math_state;
+}
+
+static void crc32_run(void *state, struct bench_rings *r,
+		      const struct bench_case *c)
+{
+	struct audio_stream *source = &r->source[0];
+	uint32_t *crc = r->sink.w_ptr;
+
+	*crc = cir_buf_crc32(0, source->r_ptr, source->addr, source->end_addr,
+			     audio_stream_period_bytes(source, c->frames));
+}
+
+static void math_free(void *state)
+{
+}
+
+const struct bench_kernel bench_sin = {
+	.name = "sin",
+	.num_sources = 1,
+	.prepare = math_prepare,
+	.run = sin_run,
+	.free = math_free,
+};
+
+const struct bench_kernel bench_sin_block = {
+	.name = "sin_block",
+	.num_sources = 1,
+	.prepare = math_prepare,
+	.run = sin_block_run,
+	.free = math_free,
+};
+
+const struct bench_kernel bench_sin_osc = {
+	.name = "sin_osc",
+	.num_sources = 1,
+	.prepare = math_prepare,
+	.run = sin_osc_run,
+	.free = math_free,
+};
+
+const struct bench_kernel bench_db2lin = {
+	.name = "db2lin",
+	.num_sources = 1,
+	.prepare = math_prepare,
+	.run = db2lin_run,
+	.free = math_free,
+};
+
+const struct bench_kernel bench_db2lin_block = {
+	.name = "db2lin_blk",
+	.num_sources = 1,
+	.prepare = math_prepare,
+	.run = db2lin_block_run,
+	.free = math_free,
+};
+
+const struct bench_kernel bench_crc32 = {
+	.name = "crc32",
+	.num_sources = 1,
+	.prepare = crc32_prepare,
+	.run = crc32_run,
+	.free = math_free,
+};
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/mixer.h>
+#include <stddef.h>
+#include "bench.h"
+
+static void *mixer_prepare(const struct bench_case *c)
+{
+	int i;
+
+	for (i = 0; i < mixer_func_count; i++)
+		if (mixer_func_map[i].frame_fmt == c->source_fmt)
+			return bench_comp_new((void *)&mixer_func_map[i]);
+
+	return NULL;
+}
+
+static void mixer_run(void *state, struct bench_rings *r,
+		      const struct bench_case *c)
+{
+	struct comp_dev *dev = state;
+	const struct mixer_func_map *map = comp_get_drvdata(dev);
+	const struct audio_stream *sources[BENCH_MAX_SOURCES];
+	int i;
+
+	for (i = 0; i < BENCH_MAX_SOURCES; i++)
+		sources[i] = &r->source[i];
+
+	map->func(dev, &r->sink, sources, BENCH_MAX_SOURCES, c->frames);
+}
+
+static void mixer_free(void *state)
+{
+	bench_comp_free(state);
+}
+
+const struct bench_kernel bench_mixer = {
+	.name = "mixer",
+	.num_sources = BENCH_MAX_SOURCES,
+	.prepare = mixer_prepare,
+	.run = mixer_run,
+	.free = mixer_free,
+};
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/mux.h>
+#include <sof/bit.h>
+#include <stdlib.h>
+#include "bench.h"
+
+/* every source stream feeds an equal share of the output channels */
+static void *mux_prepare(const struct bench_case *c)
+{
+	struct mux_stream_data *data;
+	struct comp_data *cd;
+	struct comp_dev *dev;
+	int i;
+	int j;
+
+	cd = calloc(1, sizeof(*cd) +
+		    MUX_MAX_STREAMS * sizeof(struct mux_stream_data));
+	if (!cd)
+		return NULL;
+
+	cd->config.frame_format = c->source_fmt;
+	cd->config.num_channels = c->channels;
+	cd->config.num_streams = MUX_MAX_STREAMS;
+
+	for (j = 0; j < MUX_MAX_STREAMS; j++) {
+		data = &cd->config.streams[j];
+		data->num_channels = c->channels;
+		for (i = 0; i < c->channels; i++)
+			if (i % MUX_MAX_STREAMS == j)
+				data->mask[i] = BIT(i);
+	}
+
+	dev = bench_comp_new(cd);
+	if (!dev) {
+		free(cd);
+		return NULL;
+	}
+
+	cd->mux = mux_get_processing_function(dev);
+	if (!cd->mux) {
+		free(cd);
+		bench_comp_free(dev);
+		return NULL;
+	}
+
+	return dev;
+}
+
+static void mux_run(void *state, struct bench_rings *r,
+		    const struct bench_case *c)
+{
+	struct comp_dev *dev = state;
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct audio_stream *sources[MUX_MAX_STREAMS];
+	int i;
+
+	for (i = 0; i < MUX_MAX_STREAMS; i++)
+		sources[i] = &r->source[i];
+
+	cd->mux(dev, &r->sink, sources, c->frames, cd->config.streams);
+}
+
+static void mux_free(void *state)
+{
+	struct comp_dev *dev = state;
+
+	free(comp_get_drvdata(dev));
+	bench_comp_free(dev);
+}
+
+const struct bench_kernel bench_mux = {
+	.name = "mux",
+	.num_sources = MUX_MAX_STREAMS,
+	.prepare = mux_prepare,
+	.run = mux_run,
+	.free = mux_free,
+};
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/pcm_converter.h>
+#include <stdbool.h>
+#include "bench.h"
+
+static void *pcm_prepare(const struct bench_case *c)
+{
+	if (!pcm_get_conversion_function(c->source_fmt, c->sink_fmt))
+		return NULL;
+
+	return (void *)&pcm_func_table[c->source_fmt][c->sink_fmt];
+}
+
+static void pcm_run(void *state, struct bench_rings *r,
+		    const struct bench_case *c)
+{
+	const pcm_converter_func *func = state;
+
+	(*func)(&r->source[0], 0, &r->sink, 0, c->frames * c->channels);
+}
+
+static void pcm_free(void *state)
+{
+}
+
+const struct bench_kernel bench_pcm = {
+	.name = "pcm",
+	.num_sources = 1,
+	.convert = true,
+	.prepare = pcm_prepare,
+	.run = pcm_run,
+	.free = pcm_free,
+};
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Synthetic rings and devices shared by the kernel benchmarks and the
+ * cmocka performance tests.
+ */
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/component.h>
+#include <ipc/stream.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+
+static struct comp_driver bench_drv = {
+	.type = SOF_COMP_NONE,
+};
+
+struct comp_dev *bench_comp_new(void *drvdata)
+{
+	struct comp_dev *dev = calloc(1, sizeof(*dev));
+
+	if (!dev)
+		return NULL;
+
+	dev->drv = &bench_drv;
+	list_init(&dev->bsource_list);
+	list_init(&dev->bsink_list);
+	comp_set_drvdata(dev, drvdata);
+
+	return dev;
+}
+
+void bench_comp_free(struct comp_dev *dev)
+{
+	free(dev);
+}
+
+static void bench_stream_fill(struct audio_stream *s)
+{
+	uint32_t samples = s->size / audio_stream_sample_bytes(s);
+	uint32_t seed = 0x12345678;
+	int16_t *x16 = s->addr;
+	int32_t *x32 = s->addr;
+	float *xf = s->addr;
+	uint8_t *x8 = s->addr;
+	uint32_t i;
+
+	for (i = 0; i < samples; i++) {
+		seed = seed * 1664525 + 1013904223;
+		switch (s->frame_fmt) {
+		case SOF_IPC_FRAME_S16_LE:
+			x16[i] = (int16_t)(seed >> 16);
+			break;
+		case SOF_IPC_FRAME_S24_4LE:
+			x32[i] = (int32_t)seed >> 8;
+			break;
+		case SOF_IPC_FRAME_FLOAT:
+			xf[i] = (float)(int32_t)seed / 4294967296.0f;
+			break;
+		case SOF_IPC_FRAME_S24_3LE:
+			x8[3 * i] = seed >> 8;
+			x8[3 * i + 1] = seed >> 16;
+			x8[3 * i + 2] = seed >> 24;
+			break;
+		default:
+			x32[i] = (int32_t)seed;
+			break;
+		}
+	}
+}
+
+/* sets up a ring of block frames with its pointers wrap frames from end */
+static int bench_stream_init(struct audio_stream *s, enum sof_ipc_frame fmt,
+			     int nch, int block, int wrap)
+{
+	uint32_t frame_bytes;
+	uint32_t size;
+	void *addr;
+
+	s->frame_fmt = fmt;
+	s->channels = nch;
+	s->rate = 48000;
+	frame_bytes = audio_stream_frame_bytes(s);
+
+	/* ring holds two blocks so every wrap position fits */
+	size = 2 * block * frame_bytes;
+	addr = malloc(size);
+	if (!addr)
+		return -ENOMEM;
+
+	audio_stream_init(s, addr, size);
+	bench_stream_fill(s);
+
+	if (wrap) {
+		s->r_ptr = (char *)s->end_addr - wrap * frame_bytes;
+		s->w_ptr = s->r_ptr;
+	}
+
+	s->avail = block * frame_bytes;
+	s->free = size - s->avail;
+
+	return 0;
+}
+
+void bench_rings_free(struct bench_rings *r)
+{
+	int i;
+
+	for (i = 0; i < BENCH_MAX_SOURCES; i++)
+		free(r->source[i].addr);
+
+	free(r->sink.addr);
+}
+
+int bench_rings_init(struct bench_rings *r, const struct bench_case *c,
+			    int num_sources)
+{
+	int wrap = c->wrap;
+	int ret;
+	int i;
+
+	memset(r, 0, sizeof(*r));
+
+	for (i = 0; i < num_sources; i++) {
+		ret = bench_stream_init(&r->source[i], c->source_fmt,
+					c->channels, c->frames, wrap);
+		if (ret < 0)
+			goto err;
+	}
+
+	ret = bench_stream_init(&r->sink, c->sink_fmt, c->channels,
+				c->frames * BENCH_MAX_RATIO,
+				wrap * BENCH_MAX_RATIO);
+	if (ret < 0)
+		goto err;
+
+	/* the sink is written, not read */
+	r->sink.avail = 0;
+	r->sink.free = r->sink.size;
+
+	return 0;
+
+err:
+	bench_rings_free(r);
+	return ret;
+}
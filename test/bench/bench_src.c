@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/src/src_config.h>
+#include <sof/audio/src/src.h>
+#include <stdlib.h>
+#include "bench.h"
+
+/* filter length of the 2:1 and 1:2 default SRC coefficients */
+#define BENCH_SRC_TAPS	40
+
+#if SRC_SHORT
+#define BENCH_SRC_ONE	INT16_MAX
+static int16_t src_coefs[BENCH_SRC_TAPS];
+#else
+#define BENCH_SRC_ONE	INT32_MAX
+static int32_t src_coefs[BENCH_SRC_TAPS];
+#endif
+
+/* stage shapes of the same default SRC coefficients */
+static struct src_stage src_stage_2_1 = {
+	1, 0, 1, 40, 40, 2, 1, 0, 1, src_coefs
+};
+
+static struct src_stage src_stage_1_2 = {
+	0, 1, 2, 20, 40, 1, 2, 0, 0, src_coefs
+};
+
+struct src_bench {
+	struct src_stage *stage;
+	struct src_state state;
+	int32_t *delay;
+	void (*func)(struct src_stage_prm *s);
+	int shift;
+};
+
+static void *src_prepare(const struct bench_case *c, struct src_stage *stage)
+{
+	struct src_bench *sb;
+	int fir_size;
+	int out_size;
+
+	sb = calloc(1, sizeof(*sb));
+	if (!sb)
+		return NULL;
+
+	switch (c->source_fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+		sb->func = src_polyphase_stage_cir_s16;
+		break;
+#endif
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+		sb->func = src_polyphase_stage_cir;
+		sb->shift = 8;
+		break;
+#endif
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+		sb->func = src_polyphase_stage_cir;
+		break;
+#endif
+	default:
+		free(sb);
+		return NULL;
+	}
+
+	/* one passing tap per subfilter */
+	src_coefs[0] = BENCH_SRC_ONE;
+	src_coefs[BENCH_SRC_TAPS / 2] = BENCH_SRC_ONE;
+
+	/* delay line lengths as computed by the SRC component */
+	fir_size = c->channels * (stage->subfilter_length +
+		(stage->num_of_subfilters - 1) * stage->idm + stage->blk_in);
+	out_size = c->channels * (1 + (stage->num_of_subfilters - 1) *
+		stage->odm);
+
+	sb->delay = calloc(fir_size + out_size, sizeof(int32_t));
+	if (!sb->delay) {
+		free(sb);
+		return NULL;
+	}
+
+	sb->stage = stage;
+	sb->state.fir_delay_size = fir_size;
+	sb->state.out_delay_size = out_size;
+	sb->state.fir_delay = sb->delay;
+	sb->state.out_delay = sb->delay + fir_size;
+	sb->state.fir_wp = &sb->state.fir_delay[fir_size - 1];
+	sb->state.out_rp = sb->state.out_delay;
+
+	return sb;
+}
+
+static void *src_2_1_prepare(const struct bench_case *c)
+{
+	return src_prepare(c, &src_stage_2_1);
+}
+
+static void *src_1_2_prepare(const struct bench_case *c)
+{
+	return src_prepare(c, &src_stage_1_2);
+}
+
+static void src_run(void *state, struct bench_rings *r,
+		    const struct bench_case *c)
+{
+	struct src_bench *sb = state;
+	struct src_stage_prm s;
+
+	s.nch = c->channels;
+	s.times = c->frames / sb->stage->blk_in;
+	s.x_rptr = r->source[0].r_ptr;
+	s.x_end_addr = r->source[0].end_addr;
+	s.x_size = r->source[0].size;
+	s.y_wptr = r->sink.w_ptr;
+	s.y_addr = r->sink.addr;
+	s.y_end_addr = r->sink.end_addr;
+	s.y_size = r->sink.size;
+	s.shift = sb->shift;
+	s.state = &sb->state;
+	s.stage = sb->stage;
+
+	sb->func(&s);
+}
+
+static void src_free(void *state)
+{
+	struct src_bench *sb = state;
+
+	free(sb->delay);
+	free(sb);
+}
+
+const struct bench_kernel bench_src_2_1 = {
+	.name = "src_2_1",
+	.num_sources = 1,
+	.prepare = src_2_1_prepare,
+	.run = src_run,
+	.free = src_free,
+};
+
+const struct bench_kernel bench_src_1_2 = {
+	.name = "src_1_2",
+	.num_sources = 1,
+	.prepare = src_1_2_prepare,
+	.run = src_run,
+	.free = src_free,
+};
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/volume.h>
+#include <stdlib.h>
+#include "bench.h"
+
+/* about -6 dB in Q8.16 */
+#define BENCH_VOLUME	(VOL_ZERO_DB / 2)
+
+static void *volume_prepare(const struct bench_case *c)
+{
+	struct comp_data *cd;
+	struct comp_dev *dev;
+	int i;
+
+	/* the function volume would pick for the channels count */
+	for (i = 0; i < func_count; i++)
+		if (func_map[i].frame_fmt == c->source_fmt &&
+		    (!func_map[i].channels ||
+		     func_map[i].channels == c->channels))
+			break;
+
+	if (i == func_count)
+		return NULL;
+
+	cd = calloc(1, sizeof(*cd));
+	if (!cd)
+		return NULL;
+
+	cd->scale_vol = func_map[i].func;
+	cd->channels = c->channels;
+	for (i = 0; i < c->channels; i++)
+		cd->volume[i] = BENCH_VOLUME;
+
+	dev = bench_comp_new(cd);
+	if (!dev)
+		free(cd);
+
+	return dev;
+}
+
+static void volume_run(void *state, struct bench_rings *r,
+		       const struct bench_case *c)
+{
+	struct comp_dev *dev = state;
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	cd->scale_vol(dev, &r->sink, &r->source[0], c->frames);
+}
+
+static void volume_free(void *state)
+{
+	struct comp_dev *dev = state;
+
+	free(comp_get_drvdata(dev));
+	bench_comp_free(dev);
+}
+
+const struct bench_kernel bench_volume = {
+	.name = "volume",
+	.num_sources = 1,
+	.prepare = volume_prepare,
+	.run = volume_run,
+	.free = volume_free,
+};
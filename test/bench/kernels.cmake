@@ -0,0 +1,91 @@
+# SPDX-License-Identifier: BSD-3-Clause
+
+# Kernel benchmark descriptors and the audio sources they run, shared by
+# kernel_bench and the cmocka performance tests. Variant sources select
+# their code for the target core themselves.
+
+set(bench_dir ${PROJECT_SOURCE_DIR}/test/bench)
+set(audio_dir ${PROJECT_SOURCE_DIR}/src/audio)
+set(math_dir ${PROJECT_SOURCE_DIR}/src/math)
+
+set(bench_kernel_sources
+	${bench_dir}/bench_ring.c
+	${bench_dir}/bench_pcm.c
+	${bench_dir}/bench_math.c
+	${audio_dir}/pcm_converter/pcm_converter.c
+	${audio_dir}/pcm_converter/pcm_converter_generic.c
+	${audio_dir}/pcm_converter/pcm_converter_hifi3.c
+	${math_dir}/trig.c
+	${math_dir}/decibels.c
+	${math_dir}/numbers.c
+)
+
+if(CONFIG_COMP_MIXER)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_mixer.c
+		${audio_dir}/mixer/mixer_generic.c
+		${audio_dir}/mixer/mixer_hifi3.c
+	)
+endif()
+
+if(CONFIG_COMP_VOLUME)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_volume.c
+		${audio_dir}/volume/volume_generic.c
+		${audio_dir}/volume/volume_hifi3.c
+		${audio_dir}/volume/volume_x86.c
+	)
+endif()
+
+if(CONFIG_COMP_MUX)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_mux.c
+		${audio_dir}/mux/mux_generic.c
+	)
+endif()
+
+if(CONFIG_COMP_DCBLOCK)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_dcblock.c
+		${audio_dir}/dcblock/dcblock_generic.c
+	)
+endif()
+
+if(CONFIG_COMP_FIR)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_fir.c
+		${audio_dir}/eq_fir/fir.c
+		${audio_dir}/eq_fir/fir_hifi2ep.c
+		${audio_dir}/eq_fir/fir_hifi3.c
+	)
+endif()
+
+if(CONFIG_COMP_IIR)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_iir.c
+		${audio_dir}/eq_iir/iir.c
+		${audio_dir}/eq_iir/iir_generic.c
+		${audio_dir}/eq_iir/iir_hifi3.c
+		${audio_dir}/eq_iir/iir_x86.c
+	)
+endif()
+
+if(CONFIG_COMP_SRC)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_src.c
+		${audio_dir}/src/src_generic.c
+		${audio_dir}/src/src_hifi2ep.c
+		${audio_dir}/src/src_hifi3.c
+		${audio_dir}/src/src_x86.c
+	)
+endif()
+
+if(CONFIG_COMP_ASRC)
+	list(APPEND bench_kernel_sources
+		${bench_dir}/bench_asrc.c
+		${audio_dir}/asrc/asrc_farrow.c
+		${audio_dir}/asrc/asrc_farrow_generic.c
+		${audio_dir}/asrc/asrc_farrow_hifi3.c
+		${audio_dir}/asrc/asrc_farrow_x86.c
+	)
+endif()
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/drivers/ipc.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+static struct comp_buffer *test_ring_buffer_new(uint32_t size)
+{
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = size
+	};
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+	assert_int_equal(buffer_set_inter_core(buf), 0);
+	assert_non_null(buf->ring);
+
+	return buf;
+}
+
+static void test_audio_buffer_ring_produce_consume(void **state)
+{
+	struct comp_buffer *buf = test_ring_buffer_new(16);
+
+	(void)state;
+
+	comp_update_buffer_produce(buf, 10);
+	assert_int_equal(buf->ring->w_idx, 10);
+	assert_int_equal(buf->ring->r_idx, 0);
+	assert_int_equal(buf->stream.avail, 10);
+	assert_int_equal(buf->stream.free, 6);
+
+	comp_update_buffer_consume(buf, 4);
+	assert_int_equal(buf->ring->r_idx, 4);
+	assert_int_equal(buf->stream.avail, 6);
+
+	/* wrap, indices run over twice the buffer size */
+	comp_update_buffer_produce(buf, 10);
+	assert_int_equal(buf->ring->w_idx, 20);
+	assert_int_equal(buf->stream.avail, 16);
+	assert_int_equal(buf->stream.free, 0);
+	assert_ptr_equal(buf->stream.w_ptr, buf->stream.r_ptr);
+	assert_ptr_equal(buf->stream.w_ptr, (char *)buf->stream.addr + 4);
+
+	comp_update_buffer_consume(buf, 16);
+	assert_int_equal(buf->ring->r_idx, 20);
+	assert_int_equal(buf->stream.avail, 0);
+	assert_int_equal(buf->stream.free, 16);
+
+	/* both indices wrap back to the first half */
+	comp_update_buffer_produce(buf, 14);
+	assert_int_equal(buf->ring->w_idx, 2);
+	comp_update_buffer_consume(buf, 14);
+	assert_int_equal(buf->ring->r_idx, 2);
+	assert_int_equal(buf->stream.avail, 0);
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_ring_remote_update(void **state)
+{
+	struct comp_buffer *buf = test_ring_buffer_new(16);
+	uint32_t flags = 0;
+
+	(void)state;
+
+	/* other core has produced 12 bytes and consumed 8 of them */
+	buf->ring->w_idx = 12;
+	buf->ring->r_idx = 8;
+
+	buffer_lock(buf, &flags);
+
+	assert_int_equal(buf->stream.avail, 4);
+	assert_int_equal(buf->stream.free, 12);
+	assert_ptr_equal(buf->stream.w_ptr, (char *)buf->stream.addr + 12);
+	assert_ptr_equal(buf->stream.r_ptr, (char *)buf->stream.addr + 8);
+
+	buffer_unlock(buf, flags);
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_ring_overrun(void **state)
+{
+	struct comp_buffer *buf = test_ring_buffer_new(16);
+
+	(void)state;
+
+	comp_update_buffer_produce(buf, 12);
+	comp_update_buffer_produce(buf, 8);
+
+	/* the oldest data are lost, buffer is full from the write pointer */
+	assert_int_equal(buf->stream.avail, 16);
+	assert_ptr_equal(buf->stream.r_ptr, buf->stream.w_ptr);
+
+	/* consumer continues after the overwritten data */
+	comp_update_buffer_consume(buf, 6);
+	assert_int_equal(buf->ring->r_idx, 10);
+	assert_int_equal(buf->stream.avail, 10);
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_ring_reset(void **state)
+{
+	struct comp_buffer *buf = test_ring_buffer_new(16);
+
+	(void)state;
+
+	comp_update_buffer_produce(buf, 10);
+	comp_update_buffer_consume(buf, 2);
+
+	buffer_reset_pos(buf, NULL);
+
+	assert_int_equal(buf->ring->w_idx, 0);
+	assert_int_equal(buf->ring->r_idx, 0);
+	assert_int_equal(buf->stream.avail, 0);
+
+	buffer_free(buf);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_buffer_ring_produce_consume),
+		cmocka_unit_test(test_audio_buffer_ring_remote_update),
+		cmocka_unit_test(test_audio_buffer_ring_overrun),
+		cmocka_unit_test(test_audio_buffer_ring_reset),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/drivers/ipc.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+static struct sof_ipc_buffer test_buf_desc = {
+	.size = 256
+};
+
+static void test_audio_buffer_silence_marked(void **state)
+{
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	(void)state;
+
+	assert_non_null(buf);
+
+	buffer_mark_silence(buf);
+	comp_update_buffer_produce(buf, 64);
+	assert_true(buffer_is_silent(buf));
+
+	/* silence continues */
+	buffer_mark_silence(buf);
+	comp_update_buffer_produce(buf, 64);
+	assert_true(buffer_is_silent(buf));
+
+	comp_update_buffer_consume(buf, 96);
+	assert_true(buffer_is_silent(buf));
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_silence_ended(void **state)
+{
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	(void)state;
+
+	assert_non_null(buf);
+
+	buffer_mark_silence(buf);
+	comp_update_buffer_produce(buf, 64);
+
+	/* data not marked ends silence */
+	comp_update_buffer_produce(buf, 64);
+	assert_false(buffer_is_silent(buf));
+
+	comp_update_buffer_consume(buf, 128);
+	assert_false(buffer_is_silent(buf));
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_silence_after_data(void **state)
+{
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	(void)state;
+
+	assert_non_null(buf);
+
+	comp_update_buffer_produce(buf, 64);
+	buffer_mark_silence(buf);
+	comp_update_buffer_produce(buf, 64);
+
+	/* silent only once the earlier data is consumed */
+	assert_false(buffer_is_silent(buf));
+	comp_update_buffer_consume(buf, 32);
+	assert_false(buffer_is_silent(buf));
+	comp_update_buffer_consume(buf, 32);
+	assert_true(buffer_is_silent(buf));
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_silence_mark_not_produced(void **state)
+{
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	(void)state;
+
+	assert_non_null(buf);
+
+	/* mark doesn't carry over an empty produce */
+	buffer_mark_silence(buf);
+	comp_update_buffer_produce(buf, 0);
+	comp_update_buffer_produce(buf, 64);
+	assert_false(buffer_is_silent(buf));
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_silence_is_zero_with_wrap(void **state)
+{
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+	int16_t *data;
+
+	(void)state;
+
+	assert_non_null(buf);
+
+	data = buf->stream.addr;
+	buffer_zero(buf);
+
+	/* checked from the last 4 bytes over the wrap */
+	assert_true(audio_stream_is_zero(&buf->stream, data + 126, 8));
+
+	data[1] = 1;
+	assert_false(audio_stream_is_zero(&buf->stream, data + 126, 8));
+	assert_true(audio_stream_is_zero(&buf->stream, data + 126, 6));
+
+	buffer_free(buf);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_buffer_silence_marked),
+		cmocka_unit_test(test_audio_buffer_silence_ended),
+		cmocka_unit_test(test_audio_buffer_silence_after_data),
+		cmocka_unit_test(test_audio_buffer_silence_mark_not_produced),
+		cmocka_unit_test(test_audio_buffer_silence_is_zero_with_wrap),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -58,11 +58,91 @@ static void test_audio_buffer_write_fill_10_bytes_and_write_5(void **state)
 	buffer_free(buf);
 }
 
+static void test_audio_buffer_samples_without_wrap(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 16
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+
+	int16_t *ptr = (int16_t *)buf->stream.addr + 5;
+
+	assert_int_equal(audio_stream_bytes_without_wrap(&buf->stream, ptr),
+			 6);
+	assert_int_equal(audio_stream_samples_without_wrap_s16(&buf->stream,
+							       ptr), 3);
+	assert_int_equal(audio_stream_samples_without_wrap_s32(&buf->stream,
+							       ptr), 1);
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_frames_without_wrap(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 24
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+
+	buf->stream.frame_fmt = SOF_IPC_FRAME_S16_LE;
+	buf->stream.channels = 2;
+
+	/* second channel of the second frame, frames have 4 bytes */
+	int16_t *ptr = (int16_t *)buf->stream.addr + 3;
+
+	assert_int_equal(audio_stream_frames_without_wrap(&buf->stream, ptr),
+			 5);
+
+	/* processing 5 frames with frame stride ends up right after wrap */
+	ptr = audio_stream_wrap(&buf->stream, ptr + 5 * 2);
+	assert_ptr_equal(ptr, (int16_t *)buf->stream.addr + 1);
+
+	buffer_free(buf);
+}
+
+static void test_audio_buffer_set_zero_with_wrap(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 8
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+	uint8_t bytes[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	uint8_t ref[8] = {0, 0, 3, 4, 5, 0, 0, 0};
+
+	assert_non_null(buf);
+
+	memcpy_s(buf->stream.addr, test_buf_desc.size, &bytes, 8);
+	buf->stream.w_ptr = (char *)buf->stream.addr + 5;
+
+	/* zeroes to the end and continues from the start */
+	audio_stream_set_zero(&buf->stream, 5);
+
+	assert_int_equal(memcmp(buf->stream.addr, &ref, 8), 0);
+
+	buffer_free(buf);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test
-			(test_audio_buffer_write_fill_10_bytes_and_write_5)
+			(test_audio_buffer_write_fill_10_bytes_and_write_5),
+		cmocka_unit_test(test_audio_buffer_samples_without_wrap),
+		cmocka_unit_test(test_audio_buffer_frames_without_wrap),
+		cmocka_unit_test(test_audio_buffer_set_zero_with_wrap),
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
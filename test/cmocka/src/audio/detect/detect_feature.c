@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/detect/detect.h>
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define DETECT_TEST_RATE	16000
+#define DETECT_TEST_SAMPLES	2048
+
+static struct detect_feature_state fs;
+
+static int detect_feed_tone(double freq)
+{
+	int32_t s;
+	int frames = 0;
+	int i;
+
+	detect_feature_reset(&fs);
+
+	for (i = 0; i < DETECT_TEST_SAMPLES; i++) {
+		s = (int32_t)(0.5 * INT32_MAX *
+			      sin(2 * M_PI * freq * i / DETECT_TEST_RATE));
+		if (detect_feature_add(&fs, s)) {
+			detect_feature_compute(&fs);
+			frames++;
+		}
+	}
+
+	return frames;
+}
+
+static int detect_max_band(void)
+{
+	int max = 0;
+	int b;
+
+	for (b = 1; b < DETECT_MEL_BANDS; b++)
+		if (fs.features.band[b] > fs.features.band[max])
+			max = b;
+
+	return max;
+}
+
+static void test_audio_detect_log2_error_below_0_01(void **state)
+{
+	(void)state;
+
+	uint64_t x;
+	double err;
+
+	assert_int_equal(detect_log2(0), DETECT_LOG2_ZERO);
+
+	for (x = 1; x < (1ULL << 62); x = x * 3 / 2 + 1) {
+		err = detect_log2(x) / 16777216.0 - log2((double)x);
+		assert_true(fabs(err) < 0.01);
+	}
+}
+
+static void test_audio_detect_tone_peaks_in_its_mel_band(void **state)
+{
+	(void)state;
+
+	/* 250 Hz, 1 kHz and 4 kHz are bins 4, 16 and 64 which are
+	 * band peaks at mel edges 2, 6 and 13
+	 */
+	assert_int_equal(detect_feed_tone(250), 16);
+	assert_int_equal(detect_max_band(), 1);
+
+	detect_feed_tone(1000);
+	assert_int_equal(detect_max_band(), 5);
+
+	detect_feed_tone(4000);
+	assert_int_equal(detect_max_band(), 12);
+}
+
+static void test_audio_detect_silence_has_zero_energy(void **state)
+{
+	(void)state;
+
+	int i;
+
+	detect_feed_tone(1000);
+
+	for (i = 0; i < DETECT_FFT_SIZE; i++)
+		if (detect_feature_add(&fs, 0))
+			detect_feature_compute(&fs);
+
+	assert_int_equal(fs.features.energy, DETECT_LOG2_ZERO);
+}
+
+static int setup(void **state)
+{
+	(void)state;
+
+	detect_feature_init(&fs);
+
+	return 0;
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_detect_log2_error_below_0_01),
+		cmocka_unit_test(test_audio_detect_tone_peaks_in_its_mel_band),
+		cmocka_unit_test(test_audio_detect_silence_has_zero_energy),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup, NULL);
+}
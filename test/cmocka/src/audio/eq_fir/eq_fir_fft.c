@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/eq_fir/eq_fir_fft.h>
+#include <user/eq.h>
+
+#define TAPS		1000
+#define CHANNELS	2
+#define FRAMES		(8 * EQ_FIR_FFT_BLOCK + TAPS)
+
+/* allowed errors relative to full scale, -144 dBFS and half an LSB */
+#define S32_ERROR	(1.0 / (1 << 24))
+#define S16_ERROR	(0.5 / (1 << 15))
+
+/* config with one response of TAPS, channel 0 filtered, 1 bypassed */
+struct eq_fir_fft_blob {
+	struct sof_eq_fir_config config;
+	int16_t assign[2];
+	struct sof_eq_fir_coef_data coef;
+	int16_t taps[TAPS];
+} __attribute__((packed));
+
+static struct eq_fir_fft_blob blob;
+static double in[FRAMES][CHANNELS];
+static int32_t in_s32[FRAMES * CHANNELS];
+static int32_t out_s32[FRAMES * CHANNELS];
+static int16_t in_s16[FRAMES * CHANNELS];
+static int16_t out_s16[FRAMES * CHANNELS];
+
+static uint32_t rand_next(uint32_t *seed)
+{
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed;
+}
+
+/* decaying noise response and noise input at -20 dBFS */
+static void fill(void)
+{
+	uint32_t seed = 0x2468ace0;
+	int ch;
+	int i;
+
+	blob.config.size = sizeof(blob);
+	blob.config.channels_in_config = CHANNELS;
+	blob.config.number_of_responses = 1;
+	blob.assign[0] = 0;
+	blob.assign[1] = -1;
+	blob.coef.length = TAPS;
+	blob.coef.out_shift = 0;
+
+	for (i = 0; i < TAPS; i++)
+		blob.taps[i] = (int16_t)((int32_t)rand_next(&seed) >> 22) *
+			(TAPS - i) / TAPS;
+
+	for (i = 0; i < FRAMES; i++) {
+		for (ch = 0; ch < CHANNELS; ch++)
+			in[i][ch] = 0.1 * (int32_t)rand_next(&seed) /
+				2147483648.0;
+	}
+}
+
+/* direct convolution of channel ch delayed by a block, full scale is 1 */
+static double reference(int frame, int ch)
+{
+	double y = 0.0;
+	int n = frame - EQ_FIR_FFT_BLOCK;
+	int k;
+
+	if (n < 0)
+		return 0.0;
+
+	if (blob.assign[ch] < 0)
+		return in[n][ch];
+
+	for (k = 0; k < TAPS && k <= n; k++)
+		y += in[n - k][ch] * blob.taps[k] / 32768.0;
+
+	return y;
+}
+
+static void stream_init(struct audio_stream *stream, void *data,
+			enum sof_ipc_frame fmt, size_t size)
+{
+	memset(stream, 0, sizeof(*stream));
+	stream->addr = data;
+	stream->end_addr = (char *)data + size;
+	stream->r_ptr = data;
+	stream->w_ptr = data;
+	stream->size = size;
+	stream->frame_fmt = fmt;
+	stream->channels = CHANNELS;
+}
+
+/* processes the input in uneven chunks to cross block boundaries */
+static void run(enum sof_ipc_frame fmt, void *x, void *y, size_t size)
+{
+	struct audio_stream source;
+	struct audio_stream sink;
+	struct eq_fir_fft *fft;
+	int frames = FRAMES;
+	int n;
+
+	stream_init(&source, x, fmt, size);
+	stream_init(&sink, y, fmt, size);
+
+	assert_true(eq_fir_fft_needed(&blob.config));
+	assert_int_equal(eq_fir_fft_new(&fft, &blob.config, CHANNELS), 0);
+
+	while (frames) {
+		n = MIN(frames, 48);
+		eq_fir_fft_process(fft, &source, &sink, n);
+		source.r_ptr = (char *)source.r_ptr +
+			n * audio_stream_frame_bytes(&source);
+		sink.w_ptr = (char *)sink.w_ptr +
+			n * audio_stream_frame_bytes(&sink);
+		frames -= n;
+	}
+
+	eq_fir_fft_free(&fft);
+	assert_null(fft);
+}
+
+static void test_eq_fir_fft_s32(void **state)
+{
+	double err;
+	int ch;
+	int i;
+
+	(void)state;
+
+	fill();
+	for (i = 0; i < FRAMES; i++) {
+		for (ch = 0; ch < CHANNELS; ch++)
+			in_s32[i * CHANNELS + ch] = lround(in[i][ch] *
+							   2147483648.0);
+	}
+
+	/* reference uses the quantized input */
+	for (i = 0; i < FRAMES; i++) {
+		for (ch = 0; ch < CHANNELS; ch++)
+			in[i][ch] = in_s32[i * CHANNELS + ch] / 2147483648.0;
+	}
+
+	run(SOF_IPC_FRAME_S32_LE, in_s32, out_s32, sizeof(out_s32));
+
+	for (i = 0; i < FRAMES; i++) {
+		for (ch = 0; ch < CHANNELS; ch++) {
+			err = fabs(out_s32[i * CHANNELS + ch] / 2147483648.0 -
+				   reference(i, ch));
+			if (err > S32_ERROR)
+				fail_msg("frame %d channel %d error %g\n", i,
+					 ch, err);
+		}
+	}
+}
+
+static void test_eq_fir_fft_s16(void **state)
+{
+	double err;
+	int ch;
+	int i;
+
+	(void)state;
+
+	fill();
+	for (i = 0; i < FRAMES; i++) {
+		for (ch = 0; ch < CHANNELS; ch++) {
+			in_s16[i * CHANNELS + ch] = lround(in[i][ch] * 32768.0);
+			in[i][ch] = in_s16[i * CHANNELS + ch] / 32768.0;
+		}
+	}
+
+	run(SOF_IPC_FRAME_S16_LE, in_s16, out_s16, sizeof(out_s16));
+
+	/* output is rounded to 16 bits, so half an LSB plus the engine */
+	for (i = 0; i < FRAMES; i++) {
+		for (ch = 0; ch < CHANNELS; ch++) {
+			err = fabs(out_s16[i * CHANNELS + ch] / 32768.0 -
+				   reference(i, ch));
+			if (err > S16_ERROR + S32_ERROR)
+				fail_msg("frame %d channel %d error %g\n", i,
+					 ch, err);
+		}
+	}
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_eq_fir_fft_s32),
+		cmocka_unit_test(test_eq_fir_fft_s16),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
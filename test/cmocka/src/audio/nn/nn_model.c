@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/nn/nn.h>
+#include <user/nn.h>
+
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define NN_TEST_BLOB_SIZE	4096
+#define NN_TEST_SIGMOID		0
+#define NN_TEST_TANH		1
+#define NN_TEST_RELU		2
+
+/* blob under construction, aligned like an allocated one */
+static union {
+	struct sof_nn_config config;
+	uint8_t bytes[NN_TEST_BLOB_SIZE];
+	uint32_t align;
+} blob;
+
+static struct nn_model model;
+
+static void nn_test_blob_init(uint32_t frames, uint32_t output)
+{
+	int16_t *lut;
+	double x;
+	int i;
+
+	memset(&blob, 0, sizeof(blob));
+	blob.config.frames = frames;
+	blob.config.output = output;
+	blob.config.num_luts = 3;
+	blob.config.size = sizeof(blob.config) +
+			   3 * SOF_NN_LUT_SIZE * sizeof(int16_t);
+
+	/* Q4.11 input tables of recurrent layers, Q1.15 output */
+	lut = (int16_t *)blob.config.data;
+	for (i = 0; i < SOF_NN_LUT_SIZE; i++) {
+		x = (double)(i - SOF_NN_LUT_SIZE / 2) * 256 / (1 << 11);
+		lut[NN_TEST_SIGMOID * SOF_NN_LUT_SIZE + i] =
+			fmin(32767, round(32768 / (1 + exp(-x))));
+		lut[NN_TEST_TANH * SOF_NN_LUT_SIZE + i] =
+			fmax(-32768, fmin(32767, round(32768 * tanh(x))));
+		lut[NN_TEST_RELU * SOF_NN_LUT_SIZE + i] =
+			i < SOF_NN_LUT_SIZE / 2 ? 0 :
+			(i - SOF_NN_LUT_SIZE / 2) * 256;
+	}
+}
+
+/* appends layer with room for its parameters, returns them */
+static void *nn_test_layer_add(uint16_t type, uint16_t in_ch,
+			       uint16_t out_ch, uint32_t param_size)
+{
+	struct sof_nn_layer *l =
+		(struct sof_nn_layer *)(blob.bytes + blob.config.size);
+
+	l->size = sizeof(*l) + param_size;
+	l->type = type;
+	l->weight_bits = 16;
+	l->in_ch = in_ch;
+	l->out_ch = out_ch;
+	l->lut = SOF_NN_NO_LUT;
+	l->lut2 = SOF_NN_NO_LUT;
+
+	blob.config.size += l->size;
+	blob.config.num_layers++;
+
+	return l->data;
+}
+
+static struct sof_nn_layer *nn_test_last_layer(void *params)
+{
+	return (struct sof_nn_layer *)((uint8_t *)params -
+				       offsetof(struct sof_nn_layer, data));
+}
+
+static const int16_t *nn_test_run(const int16_t *in, uint32_t frames)
+{
+	assert_int_equal(nn_model_init(&model, &blob.config), 0);
+	assert_int_equal(nn_model_prepare(&model), 0);
+
+	memcpy(nn_model_input(&model), in, frames * sizeof(int16_t));
+
+	return nn_model_run(&model);
+}
+
+static int teardown(void **state)
+{
+	(void)state;
+
+	nn_model_free(&model);
+
+	return 0;
+}
+
+static void test_audio_nn_dense_rounds_and_saturates(void **state)
+{
+	(void)state;
+
+	const int16_t in[4] = { 100, -7, 30000, -30000 };
+	const int16_t *out;
+	int16_t *w;
+	int32_t *b;
+
+	nn_test_blob_init(4, SOF_NN_OUTPUT_SCORE);
+
+	/* two outputs per time step, 3x + 1 and -x, halved */
+	w = nn_test_layer_add(SOF_NN_LAYER_DENSE, 1, 2, 2 * 2 + 2 * 4);
+	w[0] = 3;
+	w[1] = -1;
+	b = (int32_t *)(w + 2);
+	b[0] = 1;
+	b[1] = 0;
+	nn_test_last_layer(w)->shift = 1;
+
+	out = nn_test_run(in, 4);
+
+	assert_int_equal(model.out_size, 8);
+	assert_int_equal(out[0], 151);
+	assert_int_equal(out[1], -50);
+	assert_int_equal(out[2], -10);
+	assert_int_equal(out[3], 4);
+	assert_int_equal(out[4], INT16_MAX);
+	assert_int_equal(out[5], -15000);
+	assert_int_equal(out[6], INT16_MIN);
+	assert_int_equal(out[7], 15000);
+}
+
+static void test_audio_nn_conv1d_s8_with_activation(void **state)
+{
+	(void)state;
+
+	const int16_t in[8] = { 1, 2, 3, 4, -5, -6, -7, -8 };
+	const int16_t *out;
+	int8_t *w;
+	int32_t *b;
+
+	nn_test_blob_init(8, SOF_NN_OUTPUT_SCORE);
+
+	/* sums of windows of three samples advanced by two */
+	w = nn_test_layer_add(SOF_NN_LAYER_CONV1D, 1, 1, 4 + 4);
+	w[0] = 1;
+	w[1] = 1;
+	w[2] = 1;
+	b = (int32_t *)(w + 4);
+	b[0] = 0;
+	nn_test_last_layer(w)->weight_bits = 8;
+	nn_test_last_layer(w)->kernel = 3;
+	nn_test_last_layer(w)->stride = 2;
+
+	nn_test_last_layer(nn_test_layer_add(SOF_NN_LAYER_ACT, 1, 1, 0))->lut =
+		NN_TEST_RELU;
+
+	out = nn_test_run(in, 8);
+
+	assert_int_equal(model.out_size, 3);
+	assert_int_equal(out[0], 6);
+	assert_int_equal(out[1], 2);
+	assert_int_equal(out[2], 0);
+}
+
+static double nn_test_sigmoid(double x)
+{
+	return 1 / (1 + exp(-x));
+}
+
+static void test_audio_nn_gru_error_below_0_01(void **state)
+{
+	(void)state;
+
+	const int units = 2;
+	int16_t in[16];
+	const int16_t *out;
+	struct sof_nn_layer *l;
+	double wx[6] = { 0.5, -0.25, 1.0, -0.5, 0.75, 1.5 };
+	double wh[6][2] = {
+		{ 0.25, -0.5 }, { 0.5, 0.25 }, { -0.25, 0.125 },
+		{ 0.375, -0.25 }, { 1.0, -0.75 }, { 0.5, 0.5 },
+	};
+	double h[2] = { 0, 0 };
+	double hn[2];
+	double z;
+	double r;
+	double n;
+	double x;
+	int16_t *w;
+	int16_t *u;
+	int32_t *b;
+	int t;
+	int i;
+	int j;
+
+	nn_test_blob_init(16, SOF_NN_OUTPUT_SCORE);
+
+	w = nn_test_layer_add(SOF_NN_LAYER_GRU, 1, units,
+			      6 * 2 + 12 * 2 + 2 * 6 * 4);
+	u = w + 6;
+	b = (int32_t *)(u + 12);
+
+	/* Q1.15 input by Q2.13 weights to Q4.11 is a shift by 17 */
+	for (i = 0; i < 6; i++) {
+		w[i] = wx[i] * (1 << 13);
+		for (j = 0; j < units; j++)
+			u[i * units + j] = wh[i][j] * (1 << 13);
+		b[i] = 0;
+		b[6 + i] = 0;
+	}
+
+	l = nn_test_last_layer(w);
+	l->shift = 17;
+	l->rshift = 17;
+	l->lut = NN_TEST_SIGMOID;
+	l->lut2 = NN_TEST_TANH;
+
+	for (t = 0; t < 16; t++)
+		in[t] = 32767 * sin(t * 0.7);
+
+	out = nn_test_run(in, 16);
+
+	for (t = 0; t < 16; t++) {
+		x = in[t] / 32768.0;
+
+		for (j = 0; j < units; j++) {
+			z = nn_test_sigmoid(wx[j] * x + wh[j][0] * h[0] +
+					    wh[j][1] * h[1]);
+			r = nn_test_sigmoid(wx[units + j] * x +
+					    wh[units + j][0] * h[0] +
+					    wh[units + j][1] * h[1]);
+			n = tanh(wx[2 * units + j] * x +
+				 r * (wh[2 * units + j][0] * h[0] +
+				      wh[2 * units + j][1] * h[1]));
+			hn[j] = (1 - z) * n + z * h[j];
+		}
+
+		for (j = 0; j < units; j++) {
+			h[j] = hn[j];
+			assert_true(fabs(out[t * units + j] / 32768.0 - h[j]) <
+				    0.01);
+		}
+	}
+}
+
+static void test_audio_nn_lstm_error_below_0_01(void **state)
+{
+	(void)state;
+
+	int16_t in[16];
+	const int16_t *out;
+	struct sof_nn_layer *l;
+	double wx[4] = { 0.5, 1.0, -1.5, 0.75 };
+	double wh[4] = { 0.25, -0.5, 1.0, 0.5 };
+	double h = 0;
+	double c = 0;
+	double x;
+	int16_t *w;
+	int32_t *b;
+	int t;
+	int i;
+
+	nn_test_blob_init(16, SOF_NN_OUTPUT_SCORE);
+
+	w = nn_test_layer_add(SOF_NN_LAYER_LSTM, 1, 1, 4 * 2 + 4 * 2 + 4 * 4);
+	b = (int32_t *)(w + 8);
+
+	for (i = 0; i < 4; i++) {
+		w[i] = wx[i] * (1 << 13);
+		w[4 + i] = wh[i] * (1 << 13);
+		b[i] = 0;
+	}
+
+	l = nn_test_last_layer(w);
+	l->shift = 17;
+	l->rshift = 17;
+	l->lut = NN_TEST_SIGMOID;
+	l->lut2 = NN_TEST_TANH;
+
+	for (t = 0; t < 16; t++)
+		in[t] = 32767 * cos(t * 0.4);
+
+	out = nn_test_run(in, 16);
+
+	for (t = 0; t < 16; t++) {
+		x = in[t] / 32768.0;
+
+		c = nn_test_sigmoid(wx[1] * x + wh[1] * h) * c +
+		    nn_test_sigmoid(wx[0] * x + wh[0] * h) *
+		    tanh(wx[2] * x + wh[2] * h);
+		h = nn_test_sigmoid(wx[3] * x + wh[3] * h) * tanh(c);
+
+		assert_true(fabs(out[t] / 32768.0 - h) < 0.01);
+	}
+}
+
+static void test_audio_nn_invalid_model_rejected(void **state)
+{
+	(void)state;
+
+	int16_t *w;
+
+	nn_test_blob_init(4, SOF_NN_OUTPUT_AUDIO);
+	w = nn_test_layer_add(SOF_NN_LAYER_DENSE, 1, 1, 2 * 2 + 4);
+	assert_int_equal(nn_model_init(&model, &blob.config), 0);
+
+	/* parameters cut short */
+	nn_test_last_layer(w)->size -= 4;
+	blob.config.size -= 4;
+	assert_int_equal(nn_model_init(&model, &blob.config), -EINVAL);
+
+	/* audio output of different length than input */
+	nn_test_blob_init(4, SOF_NN_OUTPUT_AUDIO);
+	nn_test_layer_add(SOF_NN_LAYER_DENSE, 1, 2, 2 * 2 + 2 * 4);
+	assert_int_equal(nn_model_init(&model, &blob.config), -EINVAL);
+
+	/* unknown activation table */
+	nn_test_blob_init(4, SOF_NN_OUTPUT_AUDIO);
+	w = nn_test_layer_add(SOF_NN_LAYER_DENSE, 1, 1, 2 * 2 + 4);
+	nn_test_last_layer(w)->lut = 3;
+	assert_int_equal(nn_model_init(&model, &blob.config), -EINVAL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_teardown(test_audio_nn_dense_rounds_and_saturates,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_nn_conv1d_s8_with_activation,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_nn_gru_error_below_0_01,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_nn_lstm_error_below_0_01,
+					  teardown),
+		cmocka_unit_test(test_audio_nn_invalid_model_rejected),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
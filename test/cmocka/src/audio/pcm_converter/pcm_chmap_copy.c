@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/pcm_converter.h>
+#include <ipc/topology.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_FRAMES	5
+
+/* ring of whole frames with pointers at start frame so the copy wraps */
+static void test_stream_init(struct audio_stream *s, enum sof_ipc_frame fmt,
+			     uint32_t channels, void *addr, uint32_t start)
+{
+	s->frame_fmt = fmt;
+	s->channels = channels;
+	audio_stream_init(s, addr,
+			  TEST_FRAMES * audio_stream_frame_bytes(s));
+	s->r_ptr = (char *)addr + start * audio_stream_frame_bytes(s);
+	s->w_ptr = s->r_ptr;
+}
+
+/* picks DMA channels 3 and 0 of a 4 channel S32 frame into S16 stereo */
+static void test_audio_pcm_chmap_extract_from_dma(void **state)
+{
+	(void)state;
+
+	int32_t dma[TEST_FRAMES * 4];
+	int16_t local[TEST_FRAMES * 2];
+	struct audio_stream source;
+	struct audio_stream sink;
+	struct pcm_chmap chmap;
+	int f;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(dma); i++)
+		dma[i] = (i + 1) << 16;
+
+	assert_int_equal(pcm_chmap_init(&chmap, 0x14, 4, false), 0);
+	assert_int_equal(pcm_chmap_channels(0x14), 2);
+
+	test_stream_init(&source, SOF_IPC_FRAME_S32_LE, 4, dma, 2);
+	test_stream_init(&sink, SOF_IPC_FRAME_S16_LE, 2, local, 4);
+
+	pcm_chmap_copy(&source, &sink, TEST_FRAMES, &chmap);
+
+	for (i = 0; i < TEST_FRAMES; i++) {
+		f = (i + 2) % TEST_FRAMES;
+		assert_int_equal(local[((i + 4) % TEST_FRAMES) * 2],
+				 f * 4 + 4);
+		assert_int_equal(local[((i + 4) % TEST_FRAMES) * 2 + 1],
+				 f * 4 + 1);
+	}
+}
+
+/* places S24 stereo on DMA channels 2 and 1 with the others silent */
+static void test_audio_pcm_chmap_place_to_dma(void **state)
+{
+	(void)state;
+
+	int32_t local[TEST_FRAMES * 2];
+	int32_t dma[TEST_FRAMES * 3];
+	struct audio_stream source;
+	struct audio_stream sink;
+	struct pcm_chmap chmap;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(local); i++)
+		local[i] = i + 1;
+	for (i = 0; i < ARRAY_SIZE(dma); i++)
+		dma[i] = -1;
+
+	assert_int_equal(pcm_chmap_init(&chmap, 0x23, 3, true), 0);
+
+	test_stream_init(&source, SOF_IPC_FRAME_S24_4LE, 2, local, 0);
+	test_stream_init(&sink, SOF_IPC_FRAME_S24_4LE, 3, dma, 3);
+
+	pcm_chmap_copy(&source, &sink, TEST_FRAMES, &chmap);
+
+	for (i = 0; i < TEST_FRAMES; i++) {
+		assert_int_equal(dma[((i + 3) % TEST_FRAMES) * 3], 0);
+		assert_int_equal(dma[((i + 3) % TEST_FRAMES) * 3 + 1],
+				 i * 2 + 2);
+		assert_int_equal(dma[((i + 3) % TEST_FRAMES) * 3 + 2],
+				 i * 2 + 1);
+	}
+}
+
+static void test_audio_pcm_chmap_init_rejects_invalid(void **state)
+{
+	(void)state;
+
+	struct pcm_chmap chmap;
+
+	/* empty map */
+	assert_int_equal(pcm_chmap_init(&chmap, 0, 2, false), -EINVAL);
+	/* DMA channel 2 of a stereo frame */
+	assert_int_equal(pcm_chmap_init(&chmap, 0x31, 2, false), -EINVAL);
+	/* two channels written to one DMA channel */
+	assert_int_equal(pcm_chmap_init(&chmap, 0x11, 2, true), -EINVAL);
+	/* but may be read from one */
+	assert_int_equal(pcm_chmap_init(&chmap, 0x11, 2, false), 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_pcm_chmap_extract_from_dma),
+		cmocka_unit_test(test_audio_pcm_chmap_place_to_dma),
+		cmocka_unit_test(test_audio_pcm_chmap_init_rejects_invalid),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
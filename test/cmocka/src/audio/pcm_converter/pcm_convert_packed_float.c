@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/pcm_converter.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#define TEST_SAMPLES	12
+
+/* packed ring of whole samples with pointers in the middle so the
+ * conversion wraps
+ */
+static void test_stream_init(struct audio_stream *s, enum sof_ipc_frame fmt,
+			     void *addr, uint32_t samples, uint32_t start)
+{
+	s->frame_fmt = fmt;
+	s->channels = 1;
+	audio_stream_init(s, addr, samples * get_sample_bytes(fmt));
+	s->r_ptr = (char *)addr + start * get_sample_bytes(fmt);
+	s->w_ptr = s->r_ptr;
+}
+
+static void test_audio_pcm_convert_s32_s24_3le_round_trip(void **state)
+{
+	(void)state;
+
+	int32_t in[TEST_SAMPLES];
+	int32_t out[TEST_SAMPLES];
+	uint8_t packed[TEST_SAMPLES * 3];
+	struct audio_stream s32_in;
+	struct audio_stream s24_3;
+	struct audio_stream s32_out;
+	pcm_converter_func to_packed =
+		pcm_get_conversion_function(SOF_IPC_FRAME_S32_LE,
+					    SOF_IPC_FRAME_S24_3LE);
+	pcm_converter_func from_packed =
+		pcm_get_conversion_function(SOF_IPC_FRAME_S24_3LE,
+					    SOF_IPC_FRAME_S32_LE);
+	int i;
+
+	assert_non_null(to_packed);
+	assert_non_null(from_packed);
+
+	for (i = 0; i < TEST_SAMPLES; i++)
+		in[i] = (int32_t)(0x9e3779b9u * (i + 1)) & ~0xff;
+	in[0] = INT32_MAX;
+	in[1] = INT32_MIN;
+
+	test_stream_init(&s32_in, SOF_IPC_FRAME_S32_LE, in, TEST_SAMPLES, 0);
+	test_stream_init(&s24_3, SOF_IPC_FRAME_S24_3LE, packed, TEST_SAMPLES,
+			 TEST_SAMPLES - 5);
+	test_stream_init(&s32_out, SOF_IPC_FRAME_S32_LE, out, TEST_SAMPLES, 0);
+
+	to_packed(&s32_in, 0, &s24_3, 0, TEST_SAMPLES);
+	from_packed(&s24_3, 0, &s32_out, 0, TEST_SAMPLES);
+
+	/* positive full scale saturates to the largest 24 bit value */
+	assert_int_equal(out[0], INT32_MAX & ~0xff);
+	for (i = 1; i < TEST_SAMPLES; i++)
+		assert_int_equal(out[i], in[i]);
+}
+
+/* packs words of four samples, starting and wrapping between them */
+static void test_audio_pcm_convert_s24_s24_3le_words(void **state)
+{
+	(void)state;
+
+	int32_t in[TEST_SAMPLES];
+	int32_t out[TEST_SAMPLES];
+	uint32_t packed[TEST_SAMPLES * 3 / sizeof(uint32_t)];
+	uint8_t *bytes = (uint8_t *)packed;
+	struct audio_stream s24_in;
+	struct audio_stream s24_3;
+	struct audio_stream s24_out;
+	pcm_converter_func to_packed =
+		pcm_get_conversion_function(SOF_IPC_FRAME_S24_4LE,
+					    SOF_IPC_FRAME_S24_3LE);
+	pcm_converter_func from_packed =
+		pcm_get_conversion_function(SOF_IPC_FRAME_S24_3LE,
+					    SOF_IPC_FRAME_S24_4LE);
+	uint32_t j;
+	int i;
+
+	assert_non_null(to_packed);
+	assert_non_null(from_packed);
+
+	for (i = 0; i < TEST_SAMPLES; i++)
+		in[i] = (int32_t)(0x9e3779b9u * (i + 1)) >> 8;
+
+	test_stream_init(&s24_in, SOF_IPC_FRAME_S24_4LE, in, TEST_SAMPLES, 0);
+	test_stream_init(&s24_3, SOF_IPC_FRAME_S24_3LE, packed, TEST_SAMPLES,
+			 3);
+	test_stream_init(&s24_out, SOF_IPC_FRAME_S24_4LE, out, TEST_SAMPLES,
+			 0);
+
+	to_packed(&s24_in, 0, &s24_3, 0, TEST_SAMPLES);
+
+	for (i = 0; i < TEST_SAMPLES; i++) {
+		j = (i + 3) % TEST_SAMPLES * 3;
+		assert_int_equal(bytes[j] | bytes[j + 1] << 8 |
+				 bytes[j + 2] << 16, in[i] & 0xffffff);
+	}
+
+	from_packed(&s24_3, 0, &s24_out, 0, TEST_SAMPLES);
+
+	for (i = 0; i < TEST_SAMPLES; i++)
+		assert_int_equal(out[i], in[i]);
+}
+
+static void test_audio_pcm_convert_float_to_s16_saturates(void **state)
+{
+	(void)state;
+
+	float in[] = { 0.5f, -0.25f, 1.5f, -2.0f, 1e20f, 0.0f };
+	int16_t ref[] = { 16384, -8192, INT16_MAX, INT16_MIN, INT16_MAX, 0 };
+	int16_t out[ARRAY_SIZE(in)];
+	struct audio_stream f;
+	struct audio_stream s16;
+	pcm_converter_func func =
+		pcm_get_conversion_function(SOF_IPC_FRAME_FLOAT,
+					    SOF_IPC_FRAME_S16_LE);
+	int i;
+
+	assert_non_null(func);
+
+	test_stream_init(&f, SOF_IPC_FRAME_FLOAT, in, ARRAY_SIZE(in), 0);
+	test_stream_init(&s16, SOF_IPC_FRAME_S16_LE, out, ARRAY_SIZE(out), 3);
+
+	func(&f, 0, &s16, 0, ARRAY_SIZE(in));
+
+	for (i = 0; i < ARRAY_SIZE(in); i++)
+		assert_int_equal(out[(i + 3) % ARRAY_SIZE(out)], ref[i]);
+}
+
+static void test_audio_pcm_convert_unsupported_pair_is_null(void **state)
+{
+	(void)state;
+
+	assert_null(pcm_get_conversion_function(SOF_IPC_FRAME_FLOAT,
+						SOF_IPC_FRAME_S24_3LE));
+	assert_null(pcm_get_conversion_function(PCM_CONVERTER_FORMATS,
+						SOF_IPC_FRAME_S16_LE));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test
+			(test_audio_pcm_convert_s32_s24_3le_round_trip),
+		cmocka_unit_test
+			(test_audio_pcm_convert_s24_s24_3le_words),
+		cmocka_unit_test
+			(test_audio_pcm_convert_float_to_s16_saturates),
+		cmocka_unit_test
+			(test_audio_pcm_convert_unsupported_pair_is_null),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/* Kernel cycle counts on HiFi3 cores as measured by kernel_perf on
+ * xt-run. A case missing here is only reported. To add or update entries
+ * build with -DPERF_RECORD=ON and copy the entries the test prints.
+ */
+static const struct perf_baseline perf_baseline[] = {
+	{ NULL, 0 },
+};
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Cycle count regression tests of the processing kernels. Each case runs
+ * on the instruction set simulator and fails when it takes more cycles
+ * than the checked-in baseline of the core allows. Cases without a
+ * baseline only report their cycles until one is recorded. Built with
+ * PERF_RECORD the cases only print their baseline entries.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+#include <sof/common.h>
+#include <ipc/stream.h>
+#include <xtensa/hal.h>
+#include "bench.h"
+#include "perf.h"
+
+#if defined __XCC__
+#include <xtensa/config/core-isa.h>
+#endif
+
+#if XCHAL_HAVE_HIFI3
+#include "baseline_hifi3.h"
+#elif XCHAL_HAVE_HIFI2EP
+#include "baseline_hifi2ep.h"
+#else
+#include "baseline_generic.h"
+#endif
+
+/* timed runs of each case, the simulator is deterministic so the
+ * minimum only hides the cold cache of the first run
+ */
+#define PERF_RUNS	3
+
+struct perf_case {
+	const char *name;
+	const struct bench_kernel *kernel;
+	struct bench_case c;
+};
+
+#define PERF_CASE(n, k, in, out) \
+	{ n, &k, { SOF_IPC_FRAME_ ## in, SOF_IPC_FRAME_ ## out, 2, 48, 24 } }
+
+/* Stereo 1 ms blocks at 48 kHz with the rings wrapping mid block. Cases
+ * of formats left out of the build are skipped.
+ */
+static struct perf_case perf_cases[] = {
+#if CONFIG_COMP_VOLUME
+	PERF_CASE("volume_s16", bench_volume, S16_LE, S16_LE),
+	PERF_CASE("volume_s24", bench_volume, S24_4LE, S24_4LE),
+	PERF_CASE("volume_s32", bench_volume, S32_LE, S32_LE),
+#endif
+#if CONFIG_COMP_MIXER
+	PERF_CASE("mixer_s16", bench_mixer, S16_LE, S16_LE),
+	PERF_CASE("mixer_s24", bench_mixer, S24_4LE, S24_4LE),
+	PERF_CASE("mixer_s32", bench_mixer, S32_LE, S32_LE),
+#endif
+#if CONFIG_COMP_MUX
+	PERF_CASE("mux_s16", bench_mux, S16_LE, S16_LE),
+	PERF_CASE("mux_s32", bench_mux, S32_LE, S32_LE),
+#endif
+	PERF_CASE("pcm_s16_s32", bench_pcm, S16_LE, S32_LE),
+	PERF_CASE("pcm_s32_s16", bench_pcm, S32_LE, S16_LE),
+	PERF_CASE("pcm_s24_s32", bench_pcm, S24_4LE, S32_LE),
+	PERF_CASE("pcm_s32_s24", bench_pcm, S32_LE, S24_4LE),
+#if CONFIG_COMP_DCBLOCK
+	PERF_CASE("dcblock_s24", bench_dcblock, S24_4LE, S24_4LE),
+#endif
+#if CONFIG_COMP_FIR
+	PERF_CASE("fir_s16", bench_fir, S16_LE, S16_LE),
+	PERF_CASE("fir_s24", bench_fir, S24_4LE, S24_4LE),
+	PERF_CASE("fir_s32", bench_fir, S32_LE, S32_LE),
+#endif
+#if CONFIG_COMP_IIR
+	PERF_CASE("iir_s32", bench_iir, S32_LE, S32_LE),
+	PERF_CASE("iir_block_s32", bench_iir_block, S32_LE, S32_LE),
+#endif
+#if CONFIG_COMP_SRC
+	PERF_CASE("src_2_1_s16", bench_src_2_1, S16_LE, S16_LE),
+	PERF_CASE("src_2_1_s32", bench_src_2_1, S32_LE, S32_LE),
+	PERF_CASE("src_1_2_s32", bench_src_1_2, S32_LE, S32_LE),
+#endif
+#if CONFIG_COMP_ASRC
+	PERF_CASE("asrc_s16", bench_asrc, S16_LE, S16_LE),
+	PERF_CASE("asrc_s32", bench_asrc, S32_LE, S32_LE),
+#endif
+};
+
+static const struct perf_baseline *perf_find_baseline(const char *name)
+{
+	const struct perf_baseline *b;
+
+	for (b = perf_baseline; b->name; b++)
+		if (!strcmp(b->name, name))
+			return b;
+
+	return NULL;
+}
+
+static uint32_t perf_run(const struct perf_case *pc, void *state,
+			 struct bench_rings *rings)
+{
+	uint32_t min = UINT32_MAX;
+	uint32_t start;
+	uint32_t cycles;
+	int i;
+
+	for (i = 0; i < PERF_RUNS; i++) {
+		start = xthal_get_ccount();
+		pc->kernel->run(state, rings, &pc->c);
+		cycles = xthal_get_ccount() - start;
+		if (cycles < min)
+			min = cycles;
+	}
+
+	return min;
+}
+
+static void test_kernel_perf(void **state)
+{
+	const struct perf_case *pc = *state;
+	const struct perf_baseline *b;
+	struct bench_rings rings;
+	void *kernel_state;
+	uint32_t limit;
+	uint32_t cycles;
+
+	kernel_state = pc->kernel->prepare(&pc->c);
+	if (!kernel_state)
+		skip();
+
+	assert_int_equal(bench_rings_init(&rings, &pc->c,
+					  pc->kernel->num_sources), 0);
+
+	cycles = perf_run(pc, kernel_state, &rings);
+
+	bench_rings_free(&rings);
+	pc->kernel->free(kernel_state);
+
+#if PERF_RECORD
+	print_message("\t{ \"%s\", %u },\n", pc->name, cycles);
+	return;
+#endif
+
+	print_message("perf: %s %u\n", pc->name, cycles);
+
+	b = perf_find_baseline(pc->name);
+	if (!b) {
+		print_message("perf: %s has no baseline, record it\n",
+			      pc->name);
+		return;
+	}
+
+	limit = (uint64_t)b->cycles * (100 + PERF_TOLERANCE_PCT) / 100;
+	if (cycles > limit)
+		fail_msg("%s takes %u cycles, baseline %u allows %u",
+			 pc->name, cycles, b->cycles, limit);
+
+	if ((uint64_t)cycles * 100 < (uint64_t)b->cycles *
+	    (100 - PERF_TOLERANCE_PCT))
+		print_message("perf: %s improved from %u, update baseline\n",
+			      pc->name, b->cycles);
+}
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(perf_cases)];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(perf_cases); i++) {
+		tests[i].name = perf_cases[i].name;
+		tests[i].test_func = test_kernel_perf;
+		tests[i].initial_state = &perf_cases[i];
+		tests[i].setup_func = NULL;
+		tests[i].teardown_func = NULL;
+	}
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __TEST_PERF_H__
+#define __TEST_PERF_H__
+
+#include <stdint.h>
+
+/* Allowed cycle count growth over the baseline in percent */
+#ifndef PERF_TOLERANCE_PCT
+#define PERF_TOLERANCE_PCT	5
+#endif
+
+/* Checked-in cycle count of one kernel case on one core. The table of
+ * each core ends with an entry having NULL name.
+ */
+struct perf_baseline {
+	const char *name;
+	uint32_t cycles;
+};
+
+#endif /* __TEST_PERF_H__ */
@@ -224,6 +224,37 @@ static void test_audio_pipeline_complete_connect_upstream_other_pipeline
 	assert_ptr_equal(test_data->first, result.source_comp);
 }
 
+/*Test copy schedule allocation covering whole pipeline*/
+static void test_audio_pipeline_complete_copy_list_size(void **state)
+{
+	struct pipeline_connect_data *test_data = *state;
+	struct pipeline result = test_data->p;
+	struct sof_ipc_comp *comp;
+
+	cleanup_test_data(test_data);
+
+	/*Connecting first comp to second*/
+	comp = dev_comp(test_data->second);
+	comp->pipeline_id = PIPELINE_ID_SAME;
+	list_item_append(&test_data->b1->source_list,
+			 &test_data->first->bsink_list);
+	list_item_append(&test_data->b1->sink_list,
+			 &test_data->second->bsource_list);
+	test_data->b1->source = test_data->first;
+	test_data->b1->sink = test_data->second;
+
+	/*Testing component*/
+	int error_code = pipeline_complete(&result, test_data->first,
+					   test_data->second);
+
+	assert_int_equal(error_code, 0);
+	assert_non_null(result.copy_list);
+	assert_int_equal(result.copy_list_size, 2);
+	assert_false(result.copy_list_valid);
+
+	free(result.copy_list);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
@@ -254,6 +285,9 @@ int main(void)
 		cmocka_unit_test(
 		test_audio_pipeline_complete_connect_upstream_other_pipeline
 		),
+		cmocka_unit_test(
+		test_audio_pipeline_complete_copy_list_size
+		),
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component_ext.h>
+#include <sof/audio/pipeline.h>
+#include "pipeline_mocks.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <malloc.h>
+#include <cmocka.h>
+
+#define PIPELINE_ID	1
+
+/* Playback graph, two hosts mixed into one DAI:
+ *
+ *	host0 -> b0 -\
+ *		      mixer -> b2 -> dai
+ *	host1 -> b1 -/
+ *
+ * Capture graph, one DAI split into two hosts:
+ *
+ *	       /- b0 -> host0
+ *	dai -> demux
+ *	       \- b1 -> host1
+ *
+ * pipeline_connect() prepends buffers, so host1 is visited before host0.
+ */
+enum test_comp_id {
+	TEST_HOST0,
+	TEST_HOST1,
+	TEST_MIX,
+	TEST_DAI,
+	TEST_COMPS,
+};
+
+struct test_data {
+	struct pipeline p;
+	struct comp_dev comps[TEST_COMPS];
+	struct comp_buffer buffers[TEST_COMPS - 1];
+	int copy_ret[TEST_COMPS];	/* returned by copy of each comp */
+	int copied[TEST_COMPS];		/* copy order, -1 if not copied */
+	int copy_count;
+};
+
+static struct test_data *test_data;
+
+static int test_copy(struct comp_dev *dev)
+{
+	int id = dev_comp_id(dev);
+
+	test_data->copied[id] = test_data->copy_count++;
+
+	return test_data->copy_ret[id];
+}
+
+static const struct comp_driver test_drv = {
+	.ops = {
+		.copy = test_copy,
+	},
+};
+
+static void test_connect(struct comp_dev *source, struct comp_buffer *buffer,
+			 struct comp_dev *sink)
+{
+	list_init(&buffer->source_list);
+	list_init(&buffer->sink_list);
+	pipeline_connect(source, buffer, PPL_CONN_DIR_COMP_TO_BUFFER);
+	pipeline_connect(sink, buffer, PPL_CONN_DIR_BUFFER_TO_COMP);
+}
+
+static int setup(void **state)
+{
+	struct comp_dev *dev;
+	int i;
+
+	test_data = calloc(sizeof(*test_data), 1);
+	if (!test_data)
+		return -ENOMEM;
+
+	for (i = 0; i < TEST_COMPS; i++) {
+		dev = &test_data->comps[i];
+		dev_comp(dev)->id = i;
+		dev_comp(dev)->pipeline_id = PIPELINE_ID;
+		dev->state = COMP_STATE_ACTIVE;
+		dev->drv = &test_drv;
+		list_init(&dev->bsource_list);
+		list_init(&dev->bsink_list);
+		test_data->copied[i] = -1;
+	}
+
+	test_data->p.ipc_pipe.pipeline_id = PIPELINE_ID;
+
+	*state = test_data;
+
+	return 0;
+}
+
+static int teardown(void **state)
+{
+	free(test_data->p.copy_list);
+	free(test_data);
+
+	return 0;
+}
+
+static void test_playback_graph(struct test_data *td)
+{
+	struct comp_dev *comps = td->comps;
+
+	test_connect(&comps[TEST_HOST0], &td->buffers[0], &comps[TEST_MIX]);
+	test_connect(&comps[TEST_HOST1], &td->buffers[1], &comps[TEST_MIX]);
+	test_connect(&comps[TEST_MIX], &td->buffers[2], &comps[TEST_DAI]);
+
+	comps[TEST_HOST0].direction = SOF_IPC_STREAM_PLAYBACK;
+	td->p.source_comp = &comps[TEST_HOST0];
+	td->p.sink_comp = &comps[TEST_DAI];
+}
+
+static void test_capture_graph(struct test_data *td)
+{
+	struct comp_dev *comps = td->comps;
+
+	test_connect(&comps[TEST_DAI], &td->buffers[2], &comps[TEST_MIX]);
+	test_connect(&comps[TEST_MIX], &td->buffers[0], &comps[TEST_HOST0]);
+	test_connect(&comps[TEST_MIX], &td->buffers[1], &comps[TEST_HOST1]);
+
+	comps[TEST_DAI].direction = SOF_IPC_STREAM_CAPTURE;
+	td->p.source_comp = &comps[TEST_DAI];
+	td->p.sink_comp = &comps[TEST_HOST0];
+}
+
+/* copies with the recursive walk and then with the flattened schedule,
+ * checking both copy the components in the expected order
+ */
+static void test_copy_check(struct test_data *td, const int *expected)
+{
+	int i;
+
+	td->p.copy_list = NULL;
+	pipeline_copy_list_invalidate(&td->p);
+	assert_true(pipeline_copy(&td->p) >= 0);
+	assert_false(td->p.copy_list_valid);
+	for (i = 0; i < TEST_COMPS; i++)
+		assert_int_equal(td->copied[i], expected[i]);
+
+	for (i = 0; i < TEST_COMPS; i++)
+		td->copied[i] = -1;
+	td->copy_count = 0;
+
+	td->p.copy_list = calloc(sizeof(*td->p.copy_list), TEST_COMPS);
+	td->p.copy_list_size = TEST_COMPS;
+	assert_true(pipeline_copy(&td->p) >= 0);
+	assert_true(td->p.copy_list_valid);
+	for (i = 0; i < TEST_COMPS; i++)
+		assert_int_equal(td->copied[i], expected[i]);
+}
+
+static void test_pipeline_copy_fan_in(void **state)
+{
+	struct test_data *td = *state;
+	const int expected[TEST_COMPS] = { 1, 0, 2, 3 };
+
+	test_playback_graph(td);
+	test_copy_check(td, expected);
+}
+
+/* the mixer is still fed by the source visited last */
+static void test_pipeline_copy_fan_in_first_stop(void **state)
+{
+	struct test_data *td = *state;
+	const int expected[TEST_COMPS] = { 1, 0, 2, 3 };
+
+	test_playback_graph(td);
+	td->copy_ret[TEST_HOST1] = PPL_STATUS_PATH_STOP;
+	test_copy_check(td, expected);
+}
+
+/* stop of the source visited last stops the path down to the DAI */
+static void test_pipeline_copy_fan_in_last_stop(void **state)
+{
+	struct test_data *td = *state;
+	const int expected[TEST_COMPS] = { 1, 0, -1, -1 };
+
+	test_playback_graph(td);
+	td->copy_ret[TEST_HOST0] = PPL_STATUS_PATH_STOP;
+	test_copy_check(td, expected);
+}
+
+static void test_pipeline_copy_fan_out_stop(void **state)
+{
+	struct test_data *td = *state;
+	const int expected[TEST_COMPS] = { -1, -1, 1, 0 };
+
+	test_capture_graph(td);
+	td->copy_ret[TEST_MIX] = PPL_STATUS_PATH_STOP;
+	test_copy_check(td, expected);
+}
+
+/* stop of one sink doesn't stop the other one */
+static void test_pipeline_copy_fan_out_sink_stop(void **state)
+{
+	struct test_data *td = *state;
+	const int expected[TEST_COMPS] = { 3, 2, 1, 0 };
+
+	test_capture_graph(td);
+	td->copy_ret[TEST_HOST1] = PPL_STATUS_PATH_STOP;
+	test_copy_check(td, expected);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(test_pipeline_copy_fan_in,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_pipeline_copy_fan_in_first_stop,
+			 setup, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_pipeline_copy_fan_in_last_stop,
+			 setup, teardown),
+		cmocka_unit_test_setup_teardown(test_pipeline_copy_fan_out_stop,
+						setup, teardown),
+		cmocka_unit_test_setup_teardown
+			(test_pipeline_copy_fan_out_sink_stop,
+			 setup, teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -63,11 +63,28 @@ static void test_audio_pipeline_new_ipc_data_coppy(void **state)
 	sizeof(struct sof_ipc_pipe_new));
 }
 
+static void test_audio_pipeline_new_batch_periods(void **state)
+{
+	struct pipeline_new_setup_data *test_data = *state;
+	struct sof_ipc_pipe_new pipe_desc = test_data->ipc_data;
+
+	pipe_desc.period = 1000;
+	pipe_desc.batch_periods = 10;
+
+	/*Deep buffer pipeline is scheduled once per batch*/
+	struct pipeline *result = pipeline_new(&pipe_desc,
+	test_data->comp_data);
+
+	assert_non_null(result);
+	assert_int_equal(result->ipc_pipe.period, 10000);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test(test_audio_pipeline_pipeline_new_creation),
 		cmocka_unit_test(test_audio_pipeline_new_ipc_data_coppy),
+		cmocka_unit_test(test_audio_pipeline_new_batch_periods),
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
@@ -5,6 +5,7 @@
 // Author: Lech Betlej <lech.betlej@linux.intel.com>
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <setjmp.h>
 #include <stdint.h>
@@ -31,6 +32,7 @@ struct sel_test_parameters {
 	uint32_t sink_format;
 	void (*verify)(struct comp_dev *dev, struct audio_stream *sink,
 		       struct audio_stream *source);
+	bool passthrough;
 };
 
 static int setup(void **state)
@@ -59,7 +61,9 @@ static int setup(void **state)
 	cd->config.out_channels_count = parameters->out_channels;
 	cd->config.sel_channel = parameters->sel_channel;
 
-	cd->sel_func = sel_get_processing_function(sel_state->dev);
+	/* selector_prepare() picks passthrough for identity configuration */
+	cd->sel_func = parameters->passthrough ? sel_passthrough :
+		sel_get_processing_function(sel_state->dev);
 
 	/* allocate new sink buffer */
 	sel_state->sink = test_malloc(sizeof(*sel_state->sink));
@@ -292,6 +296,8 @@ static struct sel_test_parameters parameters[] = {
 	{ 4, 4, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_4ch_to_4ch },
 	{ 2, 1, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_Xch_to_1ch },
 	{ 4, 1, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_Xch_to_1ch },
+	{ 2, 2, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_2ch_to_2ch, true },
+	{ 4, 4, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_4ch_to_4ch, true },
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
 	{ 2, 1, 0, 16, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_Xch_to_1ch },
@@ -302,6 +308,8 @@ static struct sel_test_parameters parameters[] = {
 	{ 4, 4, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_4ch_to_4ch },
 	{ 2, 1, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_Xch_to_1ch },
 	{ 4, 1, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_Xch_to_1ch },
+	{ 2, 2, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_2ch_to_2ch, true },
+	{ 4, 4, 0, 48, 1, SOF_IPC_FRAME_S32_LE, SOF_IPC_FRAME_S32_LE, verify_s32le_4ch_to_4ch, true },
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 };
 
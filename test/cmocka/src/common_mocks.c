@@ -6,9 +6,11 @@
 // Author: Karol Trzcinski <karolx.trzcinski@linux.intel.com>
 
 #include <errno.h>
+#include <sof/audio/comp_block.h>
 #include <sof/lib/alloc.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/mm_heap.h>
+#include <sof/lib/scratch.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stddef.h>
@@ -51,6 +53,23 @@ void WEAK rfree(void *ptr)
 	free(ptr);
 }
 
+void WEAK *mem_cache_alloc(struct mem_cache *cache)
+{
+	return malloc(cache->obj_size);
+}
+
+void WEAK *mem_cache_zalloc(struct mem_cache *cache)
+{
+	return calloc(cache->obj_size, 1);
+}
+
+void WEAK mem_cache_free(struct mem_cache *cache, void *ptr)
+{
+	(void)cache;
+
+	free(ptr);
+}
+
 int WEAK memcpy_s(void *dest, size_t dest_size,
 		  const void *src, size_t src_size)
 {
@@ -102,3 +121,33 @@ uint64_t WEAK arch_timer_get_system(struct timer *timer)
 	return 0;
 }
 
+#if CONFIG_COMP_BLOCK
+int WEAK comp_block_prepare(struct comp_dev *dev)
+{
+	(void)dev;
+
+	return 0;
+}
+
+void WEAK comp_block_free(struct comp_dev *dev)
+{
+	(void)dev;
+}
+
+int WEAK comp_block_copy(struct comp_dev *dev)
+{
+	(void)dev;
+
+	return 0;
+}
+#endif
+
+size_t WEAK scratch_mark(void)
+{
+	return 0;
+}
+
+void WEAK scratch_restore(size_t mark)
+{
+	(void)mark;
+}
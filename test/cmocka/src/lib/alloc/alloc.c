@@ -20,7 +20,8 @@
 enum test_type {
 	TEST_BULK = 0,
 	TEST_ZERO,
-	TEST_IMMEDIATE_FREE
+	TEST_IMMEDIATE_FREE,
+	TEST_CACHE
 };
 
 struct test_case {
@@ -209,6 +210,19 @@ static struct test_case test_cases[] = {
 		  2, TEST_BULK, "rballoc_dma"),
 	TEST_CASE(2048, SOF_MEM_ZONE_BUFFER, SOF_MEM_CAPS_RAM |
 		  SOF_MEM_CAPS_DMA, 100, TEST_IMMEDIATE_FREE, "rballoc_dma"),
+
+	/*
+	 * mem_cache tests
+	 */
+
+	TEST_CASE(4,   SOF_MEM_ZONE_SYS_RUNTIME, SOF_MEM_CAPS_RAM, 2,
+		  TEST_CACHE, "mem_cache"),
+	TEST_CASE(40,  SOF_MEM_ZONE_SYS_RUNTIME, SOF_MEM_CAPS_RAM, 16,
+		  TEST_CACHE, "mem_cache"),
+	TEST_CASE(4,   SOF_MEM_ZONE_RUNTIME, SOF_MEM_CAPS_RAM, 2,
+		  TEST_CACHE, "mem_cache"),
+	TEST_CASE(256, SOF_MEM_ZONE_RUNTIME, SOF_MEM_CAPS_RAM, 16,
+		  TEST_CACHE, "mem_cache"),
 };
 
 static int setup(void **state)
@@ -313,6 +327,42 @@ static void test_lib_alloc_zero(struct test_case *tc)
 	free(all_mem);
 }
 
+static void test_lib_alloc_cache(struct test_case *tc)
+{
+	void **all_mem = malloc(sizeof(void *) * tc->alloc_num);
+	struct mem_cache *cache;
+	int i;
+	int j;
+
+	cache = mem_cache_create(tc->alloc_zone, 0, tc->alloc_caps,
+				 tc->alloc_size, 4);
+	assert_non_null(cache);
+
+	for (i = 0; i < tc->alloc_num; ++i) {
+		char *mem = mem_cache_zalloc(cache);
+
+		assert_non_null(mem);
+		all_mem[i] = mem;
+
+		for (j = 0; j < tc->alloc_size; ++j)
+			assert_int_equal(mem[j], 0);
+
+		/* objects must not overlap */
+		for (j = 0; j < i; ++j)
+			assert_true(labs((char *)all_mem[j] - mem) >=
+				    tc->alloc_size);
+	}
+
+	for (i = 0; i < tc->alloc_num; ++i)
+		mem_cache_free(cache, all_mem[i]);
+
+	/* the last freed object is reused first */
+	assert_ptr_equal(mem_cache_alloc(cache),
+			 all_mem[tc->alloc_num - 1]);
+
+	free(all_mem);
+}
+
 static void test_lib_alloc(void **state)
 {
 	struct test_case *tc = *((struct test_case **)state);
@@ -329,6 +379,10 @@ static void test_lib_alloc(void **state)
 	case TEST_IMMEDIATE_FREE:
 		test_lib_alloc_immediate_free(tc);
 		break;
+
+	case TEST_CACHE:
+		test_lib_alloc_cache(tc);
+		break;
 	}
 }
 
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Allocator benchmark replaying the allocation traces of topology load and
+ * unload and stream start and stop. Reports the cycles taken by each call,
+ * peak usage and the largest free block of the runtime and buffer heaps
+ * after every round, so allocator changes can be compared on the same
+ * traces. A trace fails when any of its allocations fails.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <sof/sof.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/mm_heap.h>
+#include <sof/math/numbers.h>
+#include <ipc/header.h>
+#include <ipc/topology.h>
+#include <ipc/trace.h>
+#include <xtensa/hal.h>
+#include "alloc_traces.h"
+
+/* heap snapshot, room for more heaps than any platform has */
+#define BENCH_MAX_HEAPS		16
+
+struct bench_latency {
+	uint32_t calls;
+	uint64_t cycles;
+	uint32_t max;
+};
+
+/* usage of one zone summed over its heaps */
+struct bench_zone {
+	uint32_t used;
+	uint32_t largest_free;	/* largest of any heap of the zone */
+};
+
+struct bench_result {
+	struct bench_latency alloc;
+	struct bench_latency free;
+	uint32_t peak_used;	/* runtime and buffer zones together */
+	uint32_t min_largest_free;	/* buffer zone over the whole trace */
+	uint32_t fails;
+};
+
+static void *bench_ptr[ALLOC_TRACE_INSTANCES * ALLOC_TRACE_SLOTS];
+
+static int setup(void **state)
+{
+	platform_init_memmap(sof_get());
+	init_heap(sof_get());
+
+	return 0;
+}
+
+static void bench_latency_add(struct bench_latency *l, uint32_t cycles)
+{
+	l->calls++;
+	l->cycles += cycles;
+	l->max = MAX(l->max, cycles);
+}
+
+static uint32_t bench_latency_avg(const struct bench_latency *l)
+{
+	return l->calls ? l->cycles / l->calls : 0;
+}
+
+static void bench_zone_get(uint32_t zone, struct bench_zone *z)
+{
+	uint8_t buf[sizeof(struct sof_ipc_dbg_heap_info) + BENCH_MAX_HEAPS *
+		    sizeof(struct sof_ipc_dbg_heap_elem)];
+	struct sof_ipc_dbg_heap_info *info = (void *)buf;
+	struct sof_ipc_dbg_heap_elem *elem;
+	int i;
+
+	assert_int_equal(heap_info_get(info, sizeof(buf)), 0);
+
+	z->used = 0;
+	z->largest_free = 0;
+
+	for (i = 0; i < info->num_elems; i++) {
+		elem = &info->elems[i];
+		if (elem->zone != zone)
+			continue;
+
+		z->used += elem->used;
+		z->largest_free = MAX(z->largest_free, elem->largest_free);
+	}
+}
+
+static void bench_op(const struct alloc_trace_step *step,
+		     const struct alloc_trace_op *op, struct bench_result *r)
+{
+	void **ptr = &bench_ptr[step->instance * ALLOC_TRACE_SLOTS + op->slot];
+	uint32_t size = op->size;
+	uint32_t start;
+	uint32_t cycles;
+
+	switch (op->type) {
+	case ALLOC_TRACE_RZALLOC:
+		start = xthal_get_ccount();
+		*ptr = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			       size);
+		cycles = xthal_get_ccount() - start;
+		break;
+	case ALLOC_TRACE_RBALLOC:
+		size = ALIGN_UP(size * step->buffer_pct / 100, op->align);
+		start = xthal_get_ccount();
+		*ptr = rballoc_align(0, SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+				     size, op->align);
+		cycles = xthal_get_ccount() - start;
+		break;
+	default:
+		/* freeing after a failed allocation is a no-op */
+		start = xthal_get_ccount();
+		rfree(*ptr);
+		cycles = xthal_get_ccount() - start;
+		*ptr = NULL;
+		bench_latency_add(&r->free, cycles);
+		return;
+	}
+
+	bench_latency_add(&r->alloc, cycles);
+
+	if (!*ptr) {
+		print_message("alloc_bench: %s instance %u slot %u of %u bytes failed\n",
+			      step->name, step->instance, op->slot, size);
+		r->fails++;
+	}
+}
+
+static void test_alloc_bench(void **state)
+{
+	const struct alloc_trace *trace = *state;
+	const struct alloc_trace_step *step;
+	struct bench_result r = { .min_largest_free = UINT32_MAX };
+	struct bench_zone runtime;
+	struct bench_zone buffer;
+	uint32_t round_runtime_free;
+	uint32_t round_buffer_free;
+	uint32_t round_peak;
+	uint32_t round;
+	int i;
+	int j;
+
+	for (round = 0; round < trace->rounds; round++) {
+		round_runtime_free = UINT32_MAX;
+		round_buffer_free = UINT32_MAX;
+		round_peak = 0;
+
+		for (i = 0; i < trace->num_steps; i++) {
+			step = &trace->steps[i];
+			for (j = 0; j < step->num_ops; j++)
+				bench_op(step, &step->ops[j], &r);
+
+			bench_zone_get(SOF_IPC_HEAP_ZONE_RUNTIME, &runtime);
+			bench_zone_get(SOF_IPC_HEAP_ZONE_BUFFER, &buffer);
+
+			round_peak = MAX(round_peak,
+					 runtime.used + buffer.used);
+			round_runtime_free = MIN(round_runtime_free,
+						 runtime.largest_free);
+			round_buffer_free = MIN(round_buffer_free,
+						buffer.largest_free);
+		}
+
+		/* a shrinking largest free block over rounds of the same
+		 * steps is fragmentation
+		 */
+		print_message("alloc_bench: %s round %u peak used %u, largest free runtime %u buffer %u\n",
+			      trace->name, round, round_peak,
+			      round_runtime_free, round_buffer_free);
+
+		r.peak_used = MAX(r.peak_used, round_peak);
+		r.min_largest_free = MIN(r.min_largest_free,
+					 round_buffer_free);
+	}
+
+	print_message("alloc_bench: %s alloc avg %u max %u cycles, free avg %u max %u cycles\n",
+		      trace->name, bench_latency_avg(&r.alloc), r.alloc.max,
+		      bench_latency_avg(&r.free), r.free.max);
+	print_message("alloc_bench: %s peak used %u, smallest largest free buffer block %u\n",
+		      trace->name, r.peak_used, r.min_largest_free);
+
+	if (r.fails)
+		fail_msg("%s has %u failed allocations", trace->name, r.fails);
+}
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(alloc_traces)];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(alloc_traces); i++) {
+		tests[i].name = alloc_traces[i].name;
+		tests[i].test_func = test_alloc_bench;
+		tests[i].initial_state = (void *)&alloc_traces[i];
+		tests[i].setup_func = NULL;
+		tests[i].teardown_func = NULL;
+	}
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup, NULL);
+}
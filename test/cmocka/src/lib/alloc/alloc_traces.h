@@ -0,0 +1,174 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/* Allocation traces replayed by alloc_bench. Each segment is the sequence
+ * of rzalloc(), rballoc_align() and rfree() calls of one firmware event,
+ * in call order and with the object sizes of a cAVS build. Audio buffer
+ * sizes are for 1 ms of stereo S32_LE at 48 kHz and are scaled by the
+ * step replaying the segment for other rates and channels.
+ */
+
+#ifndef __ALLOC_TRACES_H__
+#define __ALLOC_TRACES_H__
+
+#include <sof/common.h>
+#include <sof/lib/alloc.h>
+#include <stdint.h>
+
+/* pointer slots of one pipeline instance of a trace */
+#define ALLOC_TRACE_SLOTS	32
+#define ALLOC_TRACE_INSTANCES	4
+
+enum alloc_trace_type {
+	ALLOC_TRACE_RZALLOC,	/* rzalloc() of runtime zone */
+	ALLOC_TRACE_RBALLOC,	/* rballoc_align() of DMA capable buffer */
+	ALLOC_TRACE_RFREE,
+};
+
+struct alloc_trace_op {
+	enum alloc_trace_type type;
+	uint32_t slot;		/* pointer slot within the instance */
+	uint32_t size;
+	uint32_t align;
+};
+
+#define RZALLOC(s, bytes) \
+	{ .type = ALLOC_TRACE_RZALLOC, .slot = (s), .size = (bytes) }
+#define RBALLOC(s, bytes, a) \
+	{ .type = ALLOC_TRACE_RBALLOC, .slot = (s), .size = (bytes), \
+	  .align = (a) }
+#define RFREE(s) \
+	{ .type = ALLOC_TRACE_RFREE, .slot = (s) }
+
+/* host -> volume -> dai pipeline created by the topology */
+static const struct alloc_trace_op tplg_load[] = {
+	RZALLOC(0, 192),		/* struct pipeline */
+	RZALLOC(1, 32),			/* ipc_comp_dev of pipeline */
+	RZALLOC(2, 224),		/* host comp_dev */
+	RZALLOC(3, 256),		/* host_data */
+	RZALLOC(4, 32),			/* ipc_comp_dev of host */
+	RZALLOC(5, 224),		/* volume comp_dev */
+	RZALLOC(6, 512),		/* volume comp_data */
+	RZALLOC(7, 32),			/* ipc_comp_dev of volume */
+	RZALLOC(8, 224),		/* dai comp_dev */
+	RZALLOC(9, 448),		/* dai_data */
+	RZALLOC(10, 32),		/* ipc_comp_dev of dai */
+	RZALLOC(11, 160),		/* comp_buffer host -> volume */
+	RBALLOC(12, 3840, 64),		/* its audio data, 2 periods */
+	RZALLOC(13, 32),		/* ipc_comp_dev of buffer */
+	RZALLOC(14, 160),		/* comp_buffer volume -> dai */
+	RBALLOC(15, 3840, 64),
+	RZALLOC(16, 32),
+	RZALLOC(17, 96),		/* pipeline task */
+};
+
+/* pipeline_free() and ipc_comp_free() order */
+static const struct alloc_trace_op tplg_unload[] = {
+	RFREE(2), RFREE(3), RFREE(4),
+	RFREE(5), RFREE(6), RFREE(7),
+	RFREE(8), RFREE(9), RFREE(10),
+	RFREE(12), RFREE(11), RFREE(13),
+	RFREE(15), RFREE(14), RFREE(16),
+	RFREE(17), RFREE(0), RFREE(1),
+};
+
+/* PCM params and start, host and dai DMA set up */
+static const struct alloc_trace_op stream_start[] = {
+	RBALLOC(20, 7680, 128),		/* host DMA buffer, 4 periods */
+	RZALLOC(21, 48),		/* host local SG elems */
+	RZALLOC(22, 256),		/* host position ipc_msg */
+	RBALLOC(23, 3840, 128),		/* dai DMA buffer */
+	RZALLOC(24, 48),		/* dai SG elems */
+	RZALLOC(25, 64),		/* pipeline posn message */
+};
+
+static const struct alloc_trace_op stream_stop[] = {
+	RFREE(21), RFREE(20),
+	RFREE(24), RFREE(23),
+	RFREE(25), RFREE(22),
+};
+
+struct alloc_trace_step {
+	const struct alloc_trace_op *ops;
+	uint32_t num_ops;
+	uint32_t instance;	/* pipeline instance the slots belong to */
+	uint32_t buffer_pct;	/* audio buffer size in percent */
+	const char *name;
+};
+
+#define STEP(seg, inst, pct) \
+	{ seg, ARRAY_SIZE(seg), inst, pct, #seg }
+
+struct alloc_trace {
+	const char *name;
+	const struct alloc_trace_step *steps;
+	uint32_t num_steps;
+	uint32_t rounds;	/* times all steps are replayed */
+};
+
+/* topology reloaded without streams */
+static const struct alloc_trace_step trace_tplg_reload[] = {
+	STEP(tplg_load, 0, 100),
+	STEP(tplg_unload, 0, 100),
+};
+
+/* one stream started and stopped on a loaded topology */
+static const struct alloc_trace_step trace_stream_restart[] = {
+	STEP(tplg_load, 0, 100),
+	STEP(stream_start, 0, 100),
+	STEP(stream_stop, 0, 100),
+	STEP(stream_start, 0, 100),
+	STEP(stream_stop, 0, 100),
+	STEP(tplg_unload, 0, 100),
+};
+
+/* stereo 48 kHz and 6 channel 32 kHz streams overlapping, the first one
+ * restarted at 44.1 kHz while the other one runs
+ */
+static const struct alloc_trace_step trace_stream_overlap[] = {
+	STEP(tplg_load, 0, 100),
+	STEP(tplg_load, 1, 150),
+	STEP(stream_start, 0, 100),
+	STEP(stream_start, 1, 150),
+	STEP(stream_stop, 0, 100),
+	STEP(stream_start, 0, 92),
+	STEP(stream_stop, 1, 150),
+	STEP(stream_start, 1, 150),
+	STEP(stream_stop, 0, 92),
+	STEP(stream_stop, 1, 150),
+	STEP(tplg_unload, 0, 100),
+	STEP(tplg_unload, 1, 150),
+};
+
+/* topologies of other sizes loaded and unloaded around a running stream */
+static const struct alloc_trace_step trace_tplg_churn[] = {
+	STEP(tplg_load, 0, 100),
+	STEP(stream_start, 0, 100),
+	STEP(tplg_load, 1, 150),
+	STEP(stream_start, 1, 150),
+	STEP(tplg_load, 2, 50),
+	STEP(stream_stop, 1, 150),
+	STEP(tplg_unload, 1, 150),
+	STEP(stream_start, 2, 50),
+	STEP(tplg_load, 3, 200),
+	STEP(stream_stop, 2, 50),
+	STEP(tplg_unload, 2, 50),
+	STEP(stream_start, 3, 200),
+	STEP(stream_stop, 3, 200),
+	STEP(tplg_unload, 3, 200),
+	STEP(stream_stop, 0, 100),
+	STEP(tplg_unload, 0, 100),
+};
+
+#define TRACE(n, r) { #n, n, ARRAY_SIZE(n), r }
+
+static const struct alloc_trace alloc_traces[] = {
+	TRACE(trace_tplg_reload, 32),
+	TRACE(trace_stream_restart, 32),
+	TRACE(trace_stream_overlap, 16),
+	TRACE(trace_tplg_churn, 16),
+};
+
+#endif /* __ALLOC_TRACES_H__ */
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/audio/format.h>
+#include <sof/math/decibels.h>
+
+#define BLOCK_SAMPLES 256
+
+/* Allowed difference to db2lin_fixed(), levels below -60 dB are exact */
+#define CMP_TOLERANCE_DB 0.02
+
+static void ramp_check(double db_start, double db_step)
+{
+	int32_t lin[BLOCK_SAMPLES];
+	int32_t db = Q_CONVERT_FLOAT(db_start, 24);
+	int32_t step = Q_CONVERT_FLOAT(db_step, 24);
+	int32_t ref;
+	double diff;
+	int i;
+
+	db2lin_fixed_block(db, step, lin, BLOCK_SAMPLES);
+
+	for (i = 0; i < BLOCK_SAMPLES; i++) {
+		ref = db2lin_fixed(db + i * step);
+
+		if (ref < Q_CONVERT_FLOAT(0.001, 20)) {
+			assert_int_equal(lin[i], ref);
+			continue;
+		}
+
+		diff = fabs(20.0 * log10((double)lin[i] / ref));
+		if (diff > CMP_TOLERANCE_DB)
+			printf("%s: diff at %d = %.4f dB\n", __func__, i, diff);
+
+		assert_true(diff <= CMP_TOLERANCE_DB);
+	}
+}
+
+static void test_math_decibels_db2lin_fixed_block_fade_in(void **state)
+{
+	(void)state;
+
+	ramp_check(-120.0, 0.5);
+}
+
+static void test_math_decibels_db2lin_fixed_block_fade_out(void **state)
+{
+	(void)state;
+
+	ramp_check(10.0, -0.5);
+}
+
+static void test_math_decibels_db2lin_fixed_block_fine_step(void **state)
+{
+	(void)state;
+
+	ramp_check(-70.0, 0.01);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test
+			(test_math_decibels_db2lin_fixed_block_fade_in),
+		cmocka_unit_test
+			(test_math_decibels_db2lin_fixed_block_fade_out),
+		cmocka_unit_test
+			(test_math_decibels_db2lin_fixed_block_fine_step)
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <errno.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/math/fft.h>
+
+#define FFT_SIZE_MAX	(1 << FFT_MAX_BITS)
+
+/* allowed errors relative to full scale */
+#define FORWARD_ERROR	(1.0 / (1 << 22))
+#define INVERSE_ERROR	(1.0 / (1 << 16))
+
+static struct icomplex32 twiddle[FFT_SIZE_MAX / 2];
+static struct icomplex32 work[FFT_SIZE_MAX / 2];
+static struct icomplex32 spectrum[FFT_SIZE_MAX / 2 + 1];
+static int32_t in[FFT_SIZE_MAX];
+static int32_t out[FFT_SIZE_MAX];
+
+/* noise of amplitude a with a tone at bin 3 */
+static void fill(int n, double a)
+{
+	uint32_t seed = 0x12345678;
+	double x;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		seed = seed * 1664525 + 1013904223;
+		x = 0.5 * (int32_t)seed / 2147483648.0 +
+			0.5 * cos(2.0 * M_PI * 3 * i / n);
+		in[i] = (int32_t)(a * x * 2147483647.0);
+	}
+}
+
+static void test_forward(int bits, double a)
+{
+	struct fft_plan plan;
+	int n = 1 << bits;
+	double re;
+	double im;
+	int i;
+	int k;
+
+	assert_int_equal(fft_plan_init(&plan, bits, twiddle, work), 0);
+
+	fill(n, a);
+	fft_real(&plan, in, spectrum);
+
+	for (k = 0; k <= n / 2; k++) {
+		re = 0.0;
+		im = 0.0;
+		for (i = 0; i < n; i++) {
+			re += in[i] * cos(2.0 * M_PI * k * i / n);
+			im -= in[i] * sin(2.0 * M_PI * k * i / n);
+		}
+
+		assert_true(fabs(spectrum[k].real - re / n) <
+			    FORWARD_ERROR * 2147483648.0);
+		assert_true(fabs(spectrum[k].imag - im / n) <
+			    FORWARD_ERROR * 2147483648.0);
+	}
+}
+
+static void test_inverse(int bits, double a)
+{
+	struct fft_plan plan;
+	int n = 1 << bits;
+	double y;
+	int exp;
+	int i;
+
+	assert_int_equal(fft_plan_init(&plan, bits, twiddle, work), 0);
+
+	fill(n, a);
+	fft_real(&plan, in, spectrum);
+	exp = fft_real_inverse(&plan, spectrum, out);
+
+	/* spectrum is scaled by 1 / n */
+	for (i = 0; i < n; i++) {
+		y = ldexp(out[i], exp + bits);
+		assert_true(fabs(y - in[i]) < INVERSE_ERROR * 2147483648.0);
+	}
+}
+
+static void test_math_fft_forward_128(void **state)
+{
+	(void)state;
+
+	test_forward(7, 1.0);
+}
+
+static void test_math_fft_forward_4096(void **state)
+{
+	(void)state;
+
+	test_forward(12, 1.0);
+}
+
+static void test_math_fft_inverse_128(void **state)
+{
+	(void)state;
+
+	test_inverse(7, 1.0);
+}
+
+static void test_math_fft_inverse_4096(void **state)
+{
+	(void)state;
+
+	test_inverse(12, 1.0);
+}
+
+static void test_math_fft_inverse_small_signal(void **state)
+{
+	(void)state;
+
+	test_inverse(10, 1.0 / 65536);
+}
+
+static void test_math_fft_bad_size(void **state)
+{
+	(void)state;
+
+	struct fft_plan plan;
+
+	assert_int_equal(fft_plan_init(&plan, FFT_MAX_BITS + 1, twiddle,
+				       work), -EINVAL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_fft_forward_128),
+		cmocka_unit_test(test_math_fft_forward_4096),
+		cmocka_unit_test(test_math_fft_inverse_128),
+		cmocka_unit_test(test_math_fft_inverse_4096),
+		cmocka_unit_test(test_math_fft_inverse_small_signal),
+		cmocka_unit_test(test_math_fft_bad_size),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
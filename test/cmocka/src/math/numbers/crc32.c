@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/math/numbers.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+static void test_math_numbers_crc32_for_check_string_equals_cbf43926
+	(void **state)
+{
+	(void)state;
+
+	const char str[] = "123456789";
+
+	assert_int_equal(crc32(0, str, sizeof(str) - 1), 0xCBF43926);
+}
+
+static void test_math_numbers_crc32_continued_equals_whole(void **state)
+{
+	(void)state;
+
+	uint8_t data[100];
+	uint32_t crc;
+	int i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 37 + 5;
+
+	crc = crc32(0, data, 33);
+	crc = crc32(crc, data + 33, sizeof(data) - 33);
+
+	assert_int_equal(crc, crc32(0, data, sizeof(data)));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test
+			(test_math_numbers_crc32_for_check_string_equals_cbf43926),
+		cmocka_unit_test
+			(test_math_numbers_crc32_continued_equals_whole)
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <sof/audio/format.h>
+#include <sof/math/trig.h>
+
+#define BLOCK_SAMPLES 480
+
+/* 997 Hz at 48 kHz */
+#define STEP_Q4_28 Q_CONVERT_FLOAT(2.0 * 3.1415926536 * 997.0 / 48000.0, 28)
+
+static void test_math_trig_sin_fixed_block_equals_sin_fixed(void **state)
+{
+	(void)state;
+
+	int32_t y[BLOCK_SAMPLES];
+	int32_t w = 0;
+	int32_t w_next;
+	int64_t next;
+	int i;
+
+	w_next = sin_fixed_block(w, STEP_Q4_28, y, BLOCK_SAMPLES);
+
+	for (i = 0; i < BLOCK_SAMPLES; i++) {
+		assert_int_equal(y[i], sin_fixed(w));
+
+		next = (int64_t)w + STEP_Q4_28;
+		w = next > PI_MUL2_Q4_28 ?
+			(int32_t)(next - PI_MUL2_Q4_28) : (int32_t)next;
+	}
+
+	assert_int_equal(w_next, w);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test
+			(test_math_trig_sin_fixed_block_equals_sin_fixed)
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <sof/audio/format.h>
+#include <sof/math/trig.h>
+
+#define BLOCK_SAMPLES	480
+#define PERIOD_SAMPLES	48
+#define NCH		2
+
+/* 997 Hz at 48 kHz */
+#define STEP		(2.0 * M_PI * 997.0 / 48000.0)
+
+/* -20 dB */
+#define AMPLITUDE	0.1
+
+/* oscillator is set again from phase every 1 ms period as in tone, the
+ * step error accumulated over that stays below 2^-16
+ */
+#define MAX_ERROR	(1.0 / (1 << 16))
+
+static void test_math_trig_sin_osc_follows_sine(void **state)
+{
+	(void)state;
+
+	int32_t y[BLOCK_SAMPLES * NCH];
+	struct sin_osc osc;
+	double w0 = 1.0;
+	double err;
+	double max_err = 0;
+	int i;
+
+	/* second channel is left untouched */
+	for (i = 0; i < BLOCK_SAMPLES; i++)
+		y[i * NCH + 1] = -1;
+
+	for (i = 0; i < BLOCK_SAMPLES; i += PERIOD_SAMPLES) {
+		sin_osc_init(&osc,
+			     Q_CONVERT_FLOAT(fmod(w0 + i * STEP, 2 * M_PI), 28),
+			     Q_CONVERT_FLOAT(STEP, 28));
+		sin_osc_block(&osc, Q_CONVERT_FLOAT(AMPLITUDE, 31),
+			      y + i * NCH, NCH, PERIOD_SAMPLES, false);
+	}
+
+	for (i = 0; i < BLOCK_SAMPLES; i++) {
+		err = fabs(Q_CONVERT_QTOF(y[i * NCH], 31) -
+			   AMPLITUDE * sin(w0 + i * STEP));
+		max_err = err > max_err ? err : max_err;
+		assert_int_equal(y[i * NCH + 1], -1);
+	}
+
+	assert_true(max_err < MAX_ERROR * AMPLITUDE);
+}
+
+static void test_math_trig_sin_osc_adds_tones(void **state)
+{
+	(void)state;
+
+	int32_t y[PERIOD_SAMPLES];
+	struct sin_osc osc1;
+	struct sin_osc osc2;
+	double err;
+	int i;
+
+	sin_osc_init(&osc1, 0, Q_CONVERT_FLOAT(STEP, 28));
+	sin_osc_init(&osc2, 0, Q_CONVERT_FLOAT(2 * STEP, 28));
+
+	/* full scale halves sum up without overflow */
+	sin_osc_block(&osc1, INT32_MAX / 2, y, 1, PERIOD_SAMPLES, false);
+	sin_osc_block(&osc2, INT32_MAX / 2, y, 1, PERIOD_SAMPLES, true);
+
+	for (i = 0; i < PERIOD_SAMPLES; i++) {
+		err = fabs(Q_CONVERT_QTOF(y[i], 31) -
+			   0.5 * (sin(i * STEP) + sin(2 * i * STEP)));
+		assert_true(err < MAX_ERROR);
+	}
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_trig_sin_osc_follows_sine),
+		cmocka_unit_test(test_math_trig_sin_osc_adds_tones),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Platform of the scheduler benchmark. Time is virtual and advanced by the
+ * benchmark, the EDF interrupt and task contexts are never switched to.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <sof/drivers/idc.h>
+#include <sof/drivers/interrupt.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/cpu.h>
+#include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
+#include <sof/sof.h>
+#include <config.h>
+
+#include <mock_trace.h>
+
+#include "sched_bench.h"
+
+TRACE_IMPL()
+
+static struct sof sof;
+static struct schedulers *schedulers;
+static struct task *main_task;
+
+/* contexts are only compared and never switched to */
+static int bench_ctx;
+
+uint64_t bench_now;
+struct bench_irq bench_edf_irq;
+
+struct sof *sof_get(void)
+{
+	return &sof;
+}
+
+struct schedulers **arch_schedulers_get(void)
+{
+	return &schedulers;
+}
+
+uint64_t platform_timer_get(struct timer *timer)
+{
+	(void)timer;
+
+	return bench_now;
+}
+
+uint64_t clock_ms_to_ticks(int clock, uint64_t ms)
+{
+	(void)clock;
+
+	return BENCH_TICKS_PER_MS * ms;
+}
+
+#if CONFIG_CLK_GOVERNOR
+void clock_gov_load(int core, uint32_t mcps)
+{
+	(void)core;
+	(void)mcps;
+}
+#endif
+
+#if CONFIG_SMP
+int arch_cpu_enabled_cores(void)
+{
+	return 1 << PLATFORM_MASTER_CORE_ID;
+}
+
+int idc_send_msg(struct idc_msg *msg, uint32_t mode)
+{
+	(void)msg;
+	(void)mode;
+
+	return 0;
+}
+#endif
+
+int interrupt_get_irq(unsigned int irq, const char *cascade)
+{
+	(void)cascade;
+
+	return irq;
+}
+
+int interrupt_register(uint32_t irq, void (*handler)(void *arg), void *arg)
+{
+	bench_edf_irq.handler = handler;
+	bench_edf_irq.arg = arg;
+
+	return 0;
+}
+
+void interrupt_unregister(uint32_t irq, const void *arg)
+{
+	(void)irq;
+	(void)arg;
+
+	bench_edf_irq.handler = NULL;
+}
+
+uint32_t interrupt_enable(uint32_t irq, void *arg)
+{
+	(void)irq;
+	(void)arg;
+
+	return 0;
+}
+
+uint32_t interrupt_disable(uint32_t irq, void *arg)
+{
+	(void)irq;
+	(void)arg;
+
+	return 0;
+}
+
+/* the benchmark runs the handler itself, so only requests are counted */
+void platform_interrupt_set(uint32_t irq)
+{
+	(void)irq;
+
+	bench_edf_irq.requests++;
+}
+
+struct task **task_main_get(void)
+{
+	return &main_task;
+}
+
+void task_main_init(void)
+{
+}
+
+void task_main_free(void)
+{
+}
+
+volatile void *task_context_get(void)
+{
+	return NULL;
+}
+
+void task_context_set(void *task_ctx)
+{
+	(void)task_ctx;
+}
+
+int task_context_alloc(void **task_ctx)
+{
+	*task_ctx = &bench_ctx;
+
+	return 0;
+}
+
+int task_context_init(void *task_ctx, void *entry, void *arg0, void *arg1,
+		      int task_core, void *stack, int stack_size)
+{
+	(void)task_ctx;
+	(void)entry;
+	(void)arg0;
+	(void)arg1;
+	(void)task_core;
+	(void)stack;
+	(void)stack_size;
+
+	return 0;
+}
+
+uint32_t task_context_stack_used(void *task_ctx, uint32_t *size)
+{
+	(void)task_ctx;
+
+	*size = 0;
+
+	return 0;
+}
+
+void task_context_free(void *task_ctx)
+{
+	(void)task_ctx;
+}
@@ -0,0 +1,387 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Scheduler benchmark running the LL and EDF schedulers with 1 to 256 tasks
+ * of mixed periods, priorities and deadlines. LL tasks are ticked by a mock
+ * timer domain every 1 ms of virtual time, EDF tasks are picked by running
+ * the scheduler interrupt handler and completed in deadline order. Reports
+ * the cycles taken by scheduling and cancelling a task, by each tick and
+ * each EDF pick and completion. The LL tick masks interrupts right after
+ * disabling its domain, so that is where its interrupts off time starts,
+ * while scheduling and cancelling mask them for the whole call.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+#include <sof/common.h>
+#include <sof/lib/clk.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <sof/schedule/edf_schedule.h>
+#include <sof/schedule/ll_schedule.h>
+#include <sof/schedule/ll_schedule_domain.h>
+#include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
+#include <xtensa/hal.h>
+#include "sched_bench.h"
+
+#define BENCH_MAX_TASKS		256
+#define BENCH_TICK_US		1000
+#define BENCH_TICKS		100
+
+/* deadlines are spread over this many ms of virtual time */
+#define BENCH_DEADLINE_MS	10
+
+/* odd stride, so tasks are cancelled in a different order than scheduled */
+#define BENCH_CANCEL_STRIDE	37
+
+struct bench_latency {
+	uint32_t calls;
+	uint64_t cycles;
+	uint32_t max;
+};
+
+struct bench_result {
+	struct bench_latency insert;
+	struct bench_latency cancel;
+	struct bench_latency tick;	/* LL tick or EDF pick */
+	struct bench_latency masked;	/* LL tick with interrupts off */
+	struct bench_latency complete;	/* EDF completion */
+	uint32_t runs;
+};
+
+struct bench_task {
+	struct task task;
+	uint64_t period;	/* LL period in us */
+	uint64_t deadline;	/* EDF deadline */
+	uint32_t runs;
+};
+
+struct bench_case {
+	const char *name;
+	uint16_t type;
+	uint32_t num_tasks;
+};
+
+/* LL domain ticking on the virtual timer */
+struct bench_domain {
+	void (*handler)(void *arg);
+	void *arg;
+	uint32_t masked;	/* ccount when the tick disabled the domain */
+};
+
+static const uint32_t bench_periods[] = { 1000, 2000, 4000, 10000 };
+
+static struct bench_domain bench_domain;
+static struct bench_task bench_tasks[BENCH_MAX_TASKS];
+static uint32_t bench_seed;
+
+static int bench_domain_register(struct ll_schedule_domain *domain,
+				 uint64_t period, struct task *task,
+				 void (*handler)(void *arg), void *arg)
+{
+	bench_domain.handler = handler;
+	bench_domain.arg = arg;
+
+	return 0;
+}
+
+static void bench_domain_unregister(struct ll_schedule_domain *domain,
+				    struct task *task, uint32_t num_tasks)
+{
+	if (!num_tasks)
+		bench_domain.handler = NULL;
+}
+
+static void bench_domain_disable(struct ll_schedule_domain *domain, int core)
+{
+	bench_domain.masked = xthal_get_ccount();
+}
+
+static void bench_domain_set(struct ll_schedule_domain *domain, uint64_t start)
+{
+	domain->last_tick = start + domain->ticks_per_ms * BENCH_TICK_US / 1000;
+}
+
+static bool bench_domain_is_pending(struct ll_schedule_domain *domain,
+				    struct task *task)
+{
+	return task->start <= bench_now;
+}
+
+static const struct ll_schedule_domain_ops bench_domain_ops = {
+	.domain_register	= bench_domain_register,
+	.domain_unregister	= bench_domain_unregister,
+	.domain_disable		= bench_domain_disable,
+	.domain_set		= bench_domain_set,
+	.domain_is_pending	= bench_domain_is_pending,
+};
+
+static enum task_state bench_task_run(void *data)
+{
+	struct bench_task *bt = data;
+
+	bt->runs++;
+
+	return SOF_TASK_STATE_RESCHEDULE;
+}
+
+static uint64_t bench_task_deadline(void *data)
+{
+	struct bench_task *bt = data;
+
+	return bt->deadline;
+}
+
+static const struct task_ops bench_edf_ops = {
+	.run		= bench_task_run,
+	.get_deadline	= bench_task_deadline,
+};
+
+/* same task mix for every run of a case */
+static uint32_t bench_rand(void)
+{
+	bench_seed = bench_seed * 1103515245 + 12345;
+
+	return bench_seed >> 16;
+}
+
+static void bench_latency_add(struct bench_latency *l, uint32_t cycles)
+{
+	l->calls++;
+	l->cycles += cycles;
+	l->max = MAX(l->max, cycles);
+}
+
+static uint32_t bench_latency_avg(const struct bench_latency *l)
+{
+	return l->calls ? l->cycles / l->calls : 0;
+}
+
+static int setup(void **state)
+{
+	struct ll_schedule_domain *domain;
+
+	domain = domain_init(SOF_SCHEDULE_LL_TIMER, PLATFORM_DEFAULT_CLOCK,
+			     false, &bench_domain_ops);
+	sof_get()->platform_timer_domain = domain;
+
+	scheduler_init_ll(domain);
+
+	return scheduler_init_edf();
+}
+
+static void bench_cancel(const struct bench_case *c, struct bench_result *r)
+{
+	struct bench_task *bt;
+	uint32_t start;
+	int i;
+
+	for (i = 0; i < c->num_tasks; i++) {
+		bt = &bench_tasks[i * BENCH_CANCEL_STRIDE % c->num_tasks];
+
+		start = xthal_get_ccount();
+		schedule_task_cancel(&bt->task);
+		bench_latency_add(&r->cancel, xthal_get_ccount() - start);
+	}
+
+	for (i = 0; i < c->num_tasks; i++)
+		schedule_task_free(&bench_tasks[i].task);
+}
+
+static void bench_ll(const struct bench_case *c, struct bench_result *r)
+{
+	struct ll_schedule_domain *domain = timer_domain_get();
+	struct bench_task *bt;
+	uint32_t start;
+	uint32_t end;
+	uint64_t offset;
+	int i;
+
+	for (i = 0; i < c->num_tasks; i++) {
+		bt = &bench_tasks[i];
+		bt->runs = 0;
+		assert_int_equal(schedule_task_init_ll(&bt->task, i,
+						       SOF_SCHEDULE_LL_TIMER,
+						       bench_rand() %
+						       (SOF_TASK_PRI_LOW + 1),
+						       bench_task_run, bt, 0,
+						       0), 0);
+	}
+
+	/* tasks of the same period start in different ticks */
+	for (i = 0; i < c->num_tasks; i++) {
+		bt = &bench_tasks[i];
+		bt->period = bench_periods[bench_rand() %
+					   ARRAY_SIZE(bench_periods)];
+		offset = bench_rand() % (bt->period / BENCH_TICK_US) *
+			BENCH_TICK_US;
+
+		start = xthal_get_ccount();
+		schedule_task(&bt->task, offset, bt->period);
+		bench_latency_add(&r->insert, xthal_get_ccount() - start);
+	}
+
+	for (i = 0; i < BENCH_TICKS; i++) {
+		assert_non_null(bench_domain.handler);
+
+		bench_now = domain->last_tick;
+
+		start = xthal_get_ccount();
+		bench_domain.handler(bench_domain.arg);
+		end = xthal_get_ccount();
+
+		bench_latency_add(&r->tick, end - start);
+		bench_latency_add(&r->masked, end - bench_domain.masked);
+	}
+
+	/* phase offsets may cost a task one run within the benchmark */
+	for (i = 0; i < c->num_tasks; i++) {
+		bt = &bench_tasks[i];
+		assert_true(bt->runs + 1 >=
+			    BENCH_TICKS * BENCH_TICK_US / bt->period);
+		r->runs += bt->runs;
+	}
+
+	bench_cancel(c, r);
+}
+
+static void bench_edf_queue(const struct bench_case *c,
+			    struct bench_result *r)
+{
+	struct bench_task *bt;
+	uint32_t start;
+	int i;
+
+	for (i = 0; i < c->num_tasks; i++) {
+		bt = &bench_tasks[i];
+
+		/* every eighth task is due at once, others at a random us */
+		bt->deadline = bench_rand() % 8 ? bench_now +
+			bench_rand() % (BENCH_DEADLINE_MS * 1000) *
+			BENCH_TICKS_PER_MS / 1000 : SOF_TASK_DEADLINE_NOW;
+
+		start = xthal_get_ccount();
+		schedule_task(&bt->task, 0, 0);
+		bench_latency_add(&r->insert, xthal_get_ccount() - start);
+	}
+}
+
+static struct bench_task *bench_edf_running(const struct bench_case *c)
+{
+	int i;
+
+	for (i = 0; i < c->num_tasks; i++) {
+		if (bench_tasks[i].task.state == SOF_TASK_STATE_RUNNING)
+			return &bench_tasks[i];
+	}
+
+	return NULL;
+}
+
+static void bench_edf(const struct bench_case *c, struct bench_result *r)
+{
+	struct bench_task *bt;
+	uint64_t deadline = 0;
+	uint32_t start;
+	int i;
+
+	for (i = 0; i < c->num_tasks; i++) {
+		bt = &bench_tasks[i];
+		bt->runs = 0;
+		assert_int_equal(schedule_task_init_edf(&bt->task, i,
+							&bench_edf_ops, bt, 0,
+							0), 0);
+	}
+
+	bench_edf_queue(c, r);
+
+	/* interrupt handler picks the earliest deadline, which completes */
+	for (i = 0; i < c->num_tasks; i++) {
+		start = xthal_get_ccount();
+		bench_edf_irq.handler(bench_edf_irq.arg);
+		bench_latency_add(&r->tick, xthal_get_ccount() - start);
+
+		bt = bench_edf_running(c);
+		assert_non_null(bt);
+		assert_true(bt->deadline >= deadline);
+		deadline = bt->deadline;
+		bt->runs++;
+		r->runs++;
+
+		start = xthal_get_ccount();
+		schedule_task_complete(&bt->task);
+		bench_latency_add(&r->complete, xthal_get_ccount() - start);
+	}
+
+	/* queued again to be cancelled */
+	bench_edf_queue(c, r);
+
+	bench_cancel(c, r);
+}
+
+static void test_sched_bench(void **state)
+{
+	const struct bench_case *c = *state;
+	struct bench_result r = { 0 };
+
+	bench_seed = c->num_tasks;
+	bench_now = 0;
+
+	if (c->type == SOF_SCHEDULE_EDF)
+		bench_edf(c, &r);
+	else
+		bench_ll(c, &r);
+
+	print_message("sched_bench: %s insert avg %u max %u cycles, cancel avg %u max %u cycles\n",
+		      c->name, bench_latency_avg(&r.insert), r.insert.max,
+		      bench_latency_avg(&r.cancel), r.cancel.max);
+
+	if (c->type == SOF_SCHEDULE_EDF) {
+		print_message("sched_bench: %s pick avg %u max %u cycles, complete avg %u max %u cycles\n",
+			      c->name, bench_latency_avg(&r.tick), r.tick.max,
+			      bench_latency_avg(&r.complete),
+			      r.complete.max);
+		return;
+	}
+
+	print_message("sched_bench: %s tick avg %u max %u cycles, irq off avg %u max %u cycles, %u cycles per task run\n",
+		      c->name, bench_latency_avg(&r.tick), r.tick.max,
+		      bench_latency_avg(&r.masked), r.masked.max,
+		      (uint32_t)(r.tick.cycles / MAX(r.runs, 1)));
+}
+
+static const struct bench_case bench_cases[] = {
+	{ "ll_1_task", SOF_SCHEDULE_LL_TIMER, 1 },
+	{ "ll_4_tasks", SOF_SCHEDULE_LL_TIMER, 4 },
+	{ "ll_16_tasks", SOF_SCHEDULE_LL_TIMER, 16 },
+	{ "ll_64_tasks", SOF_SCHEDULE_LL_TIMER, 64 },
+	{ "ll_256_tasks", SOF_SCHEDULE_LL_TIMER, 256 },
+	{ "edf_1_task", SOF_SCHEDULE_EDF, 1 },
+	{ "edf_4_tasks", SOF_SCHEDULE_EDF, 4 },
+	{ "edf_16_tasks", SOF_SCHEDULE_EDF, 16 },
+	{ "edf_64_tasks", SOF_SCHEDULE_EDF, 64 },
+	{ "edf_256_tasks", SOF_SCHEDULE_EDF, 256 },
+};
+
+int main(void)
+{
+	struct CMUnitTest tests[ARRAY_SIZE(bench_cases)];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(bench_cases); i++) {
+		tests[i].name = bench_cases[i].name;
+		tests[i].test_func = test_sched_bench;
+		tests[i].initial_state = (void *)&bench_cases[i];
+		tests[i].setup_func = NULL;
+		tests[i].teardown_func = NULL;
+	}
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup, NULL);
+}
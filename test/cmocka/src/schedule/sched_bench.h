@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SCHED_BENCH_H__
+#define __SCHED_BENCH_H__
+
+#include <stdint.h>
+
+/* virtual platform timer, 38.4 MHz like the cAVS XTAL */
+#define BENCH_TICKS_PER_MS	38400
+
+/* EDF scheduler interrupt, run by the benchmark instead of the core */
+struct bench_irq {
+	void (*handler)(void *arg);
+	void *arg;
+	uint32_t requests;
+};
+
+/* time returned by platform_timer_get() */
+extern uint64_t bench_now;
+
+extern struct bench_irq bench_edf_irq;
+
+#endif /* __SCHED_BENCH_H__ */
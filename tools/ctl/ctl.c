@@ -20,6 +20,8 @@
 #define BUFFER_SIZE_OFFSET	1
 #define BUFFER_ABI_OFFSET	2
 
+#define BATCH_LINE_LEN		512
+
 struct ctl_data {
 	/* the input file name */
 	char *input_file;
@@ -63,6 +65,7 @@ static void usage(char *name)
 	fprintf(stdout, " [-s <data>]\n");
 	fprintf(stdout, "\t %s [-D <device>] [-n <control id>]", name);
 	fprintf(stdout, " [-s <data>]\n");
+	fprintf(stdout, "\t %s [-D <device>] -B <batch file>\n", name);
 	fprintf(stdout, "\t %s -g <size>\n", name);
 	fprintf(stdout, "\t %s -h\n", name);
 	fprintf(stdout, "\nWhere:\n");
@@ -77,6 +80,7 @@ static void usage(char *name)
 	fprintf(stdout, " -r no abi header for the input file, or not dumping abi header for get.\n");
 	fprintf(stdout, " -o specify the output file.\n");
 	fprintf(stdout, " -t specify the component specified type.\n");
+	fprintf(stdout, " -B set the controls listed in a file, a line per control with the data file followed by the control name or id\n");
 }
 
 static void header_init(struct ctl_data *ctl_data)
@@ -499,11 +503,152 @@ static int ctl_set_get(struct ctl_data *ctl_data)
 	}
 }
 
+/* parses a batch file line: <data file> <control name or numid> */
+static int batch_parse_line(struct ctl_data *ctl_data, char *line)
+{
+	char *file;
+	char *cname;
+	char *end;
+
+	file = strtok_r(line, " \t\n", &end);
+	if (!file || file[0] == '#')
+		return 0;
+
+	cname = end + strspn(end, " \t");
+	cname[strcspn(cname, "\n")] = '\0';
+	if (!cname[0]) {
+		fprintf(stderr, "Error: no control for %s.\n", file);
+		return -EINVAL;
+	}
+
+	ctl_data->input_file = strdup(file);
+	if (strspn(cname, "0123456789") == strlen(cname)) {
+		ctl_data->cname = malloc(strlen(cname) + sizeof("numid="));
+		if (ctl_data->cname)
+			sprintf(ctl_data->cname, "numid=%s", cname);
+	} else {
+		ctl_data->cname = strdup(cname);
+	}
+
+	if (!ctl_data->input_file || !ctl_data->cname)
+		return -ENOMEM;
+
+	return 1;
+}
+
+/*
+ * Sets the controls of a batch file. All data files are read and all
+ * controls are looked up before any of them is written, and the writes are
+ * then done back to back so the tuning is not left half applied by a bad
+ * file.
+ */
+static int ctl_batch(struct ctl_data *defaults, const char *batch_file)
+{
+	char line[BATCH_LINE_LEN];
+	struct ctl_data *ctls = NULL;
+	struct ctl_data *ctl_data;
+	int num_ctls = 0;
+	int ready = 0;
+	int ret = 0;
+	int n;
+	int i;
+	FILE *fh;
+
+	fh = fopen(batch_file, "r");
+	if (!fh) {
+		fprintf(stderr, "error: %s\n", strerror(errno));
+		return -errno;
+	}
+
+	while (fgets(line, sizeof(line), fh)) {
+		ctl_data = realloc(ctls, (num_ctls + 1) * sizeof(*ctls));
+		if (!ctl_data) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		ctls = ctl_data;
+		ctl_data = &ctls[num_ctls];
+		*ctl_data = *defaults;
+		ctl_data->set = true;
+		ctl_data->input_file = NULL;
+		ctl_data->cname = NULL;
+
+		ret = batch_parse_line(ctl_data, line);
+		if (ret < 0) {
+			num_ctls++;
+			break;
+		}
+
+		num_ctls += ret;
+	}
+
+	fclose(fh);
+
+	/* read all data before any control is written */
+	for (i = 0; !ret && i < num_ctls; i++) {
+		ctl_data = &ctls[i];
+		ctl_data->in_fd = open(ctl_data->input_file, O_RDONLY);
+		if (ctl_data->in_fd <= 0) {
+			fprintf(stderr, "error: %s: %s\n",
+				ctl_data->input_file, strerror(errno));
+			ret = -EINVAL;
+			break;
+		}
+
+		ret = ctl_setup(ctl_data);
+		if (ret < 0 || !ctl_data->buffer) {
+			fprintf(stderr, "Error: control %s setup failed.\n",
+				ctl_data->cname);
+			close(ctl_data->in_fd);
+			ret = -EINVAL;
+			break;
+		}
+
+		ready++;
+
+		/* the data file is closed once read */
+		n = read_setup(ctl_data);
+		if (n < 1) {
+			fprintf(stderr, "Error: failed data read from %s.\n",
+				ctl_data->input_file);
+			ret = -EINVAL;
+			break;
+		}
+
+		ctl_data->buffer[BUFFER_SIZE_OFFSET] = n * sizeof(unsigned int);
+	}
+
+	for (i = 0; !ret && i < num_ctls; i++) {
+		ctl_data = &ctls[i];
+		ret = snd_ctl_elem_tlv_write(ctl_data->ctl, ctl_data->id,
+					     ctl_data->buffer);
+		if (ret < 0)
+			fprintf(stderr, "Error: failed TLV write of %s (%d)\n",
+				ctl_data->cname, ret);
+	}
+
+	if (!ret)
+		fprintf(stdout, "Applied %d controls into device %s.\n",
+			num_ctls, defaults->dev);
+
+	for (i = 0; i < num_ctls; i++) {
+		if (i < ready)
+			ctl_free(&ctls[i]);
+		free(ctls[i].input_file);
+		free(ctls[i].cname);
+	}
+	free(ctls);
+
+	return ret;
+}
+
 int main(int argc, char *argv[])
 {
 	char *input_file = NULL;
 	char *output_file = NULL;
 	struct ctl_data *ctl_data;
+	char *batch_file = NULL;
 	char nname[256];
 	int ret = 0;
 	int n = 0;
@@ -522,7 +667,7 @@ int main(int argc, char *argv[])
 
 	ctl_data->dev = "hw:0";
 
-	while ((opt = getopt(argc, argv, "hD:c:s:n:o:t:g:br")) != -1) {
+	while ((opt = getopt(argc, argv, "hD:c:s:n:o:t:g:brB:")) != -1) {
 		switch (opt) {
 		case 'D':
 			ctl_data->dev = optarg;
@@ -555,6 +700,9 @@ int main(int argc, char *argv[])
 			ctl_data->print_abi_header = true;
 			ctl_data->print_abi_size = atoi(optarg);
 			break;
+		case 'B':
+			batch_file = optarg;
+			break;
 		case 'h':
 		/* pass through */
 		default:
@@ -587,6 +735,12 @@ int main(int argc, char *argv[])
 		goto out_fd_close;
 	}
 
+	/* set the controls of a batch file */
+	if (batch_file) {
+		ret = ctl_batch(ctl_data, batch_file);
+		goto out_fd_close;
+	}
+
 	/* The control need to be defined. */
 	if (!ctl_data->cname) {
 		fprintf(stderr, "Error: No control was requested.\n");
@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* IPC latency benchmark - records, replays and times IPC sequences */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include "fuzzer.h"
+#include <ipc/header.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+
+/* max number of host PCM components used for stream benchmarks */
+#define BENCH_MAX_PCMS		16
+
+/* timing of one IPC message in ns */
+struct bench_sample {
+	uint64_t dsp;		/* doorbell until DSP reply interrupt */
+	uint64_t mbox;		/* mailbox copies for message and reply */
+	uint64_t rtt;		/* send start until reply has been read */
+};
+
+/* samples of one IPC command type */
+struct bench_cmd {
+	uint32_t cmd;
+	unsigned int count;
+	unsigned int size;
+	struct bench_sample *samples;
+};
+
+struct fuzz_bench {
+	struct bench_cmd *cmds;
+	unsigned int num_cmds;
+
+	/* host components found in the sequence, used for triggers */
+	uint32_t pcm_ids[BENCH_MAX_PCMS];
+	unsigned int num_pcms;
+
+	FILE *record_file;	/* sent messages are recorded here */
+};
+
+/* recorded message header, payload of msg_size bytes follows */
+struct bench_record {
+	uint32_t header;
+	uint32_t msg_size;
+	uint32_t reply_size;
+};
+
+int fuzzer_bench_init(struct fuzz *fuzzer, const char *record_filename)
+{
+	struct fuzz_bench *bench;
+
+	bench = calloc(1, sizeof(*bench));
+	if (!bench)
+		return -ENOMEM;
+
+	if (record_filename) {
+		bench->record_file = fopen(record_filename, "wb");
+		if (!bench->record_file) {
+			fprintf(stderr, "error: opening record file %s\n",
+				record_filename);
+			free(bench);
+			return -errno;
+		}
+	}
+
+	fuzzer->bench = bench;
+
+	return 0;
+}
+
+void fuzzer_bench_free(struct fuzz *fuzzer)
+{
+	struct fuzz_bench *bench = fuzzer->bench;
+	unsigned int i;
+
+	if (!bench)
+		return;
+
+	if (bench->record_file)
+		fclose(bench->record_file);
+
+	for (i = 0; i < bench->num_cmds; i++)
+		free(bench->cmds[i].samples);
+
+	free(bench->cmds);
+	free(bench);
+	fuzzer->bench = NULL;
+}
+
+static struct bench_cmd *bench_get_cmd(struct fuzz_bench *bench, uint32_t cmd)
+{
+	struct bench_cmd *cmds;
+	unsigned int i;
+
+	for (i = 0; i < bench->num_cmds; i++)
+		if (bench->cmds[i].cmd == cmd)
+			return &bench->cmds[i];
+
+	cmds = realloc(bench->cmds, sizeof(*cmds) * (bench->num_cmds + 1));
+	if (!cmds)
+		return NULL;
+
+	bench->cmds = cmds;
+	memset(&cmds[bench->num_cmds], 0, sizeof(*cmds));
+	cmds[bench->num_cmds].cmd = cmd;
+
+	return &cmds[bench->num_cmds++];
+}
+
+/* remembers host components so their streams can be triggered */
+static void bench_find_pcm(struct fuzz_bench *bench, struct ipc_msg *msg)
+{
+	struct sof_ipc_comp *comp = msg->msg_data;
+
+	if (msg->header != (SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW) ||
+	    msg->msg_size < sizeof(*comp) || comp->type != SOF_COMP_HOST ||
+	    bench->num_pcms >= BENCH_MAX_PCMS)
+		return;
+
+	bench->pcm_ids[bench->num_pcms++] = comp->id;
+}
+
+static void bench_record_msg(struct fuzz_bench *bench, struct ipc_msg *msg)
+{
+	struct bench_record rec = {
+		.header = msg->header,
+		.msg_size = msg->msg_size,
+		.reply_size = msg->reply_size,
+	};
+
+	if (fwrite(&rec, sizeof(rec), 1, bench->record_file) != 1 ||
+	    fwrite(msg->msg_data, msg->msg_size, 1,
+		   bench->record_file) != 1)
+		fprintf(stderr, "error: recording IPC 0x%x\n", msg->header);
+}
+
+/* called after the reply of each message sent has been read */
+void fuzzer_bench_record(struct fuzz *fuzzer, uint64_t end)
+{
+	struct fuzz_bench *bench = fuzzer->bench;
+	struct fuzz_ipc_time *t = &fuzzer->ipc_time;
+	struct bench_sample *samples;
+	struct bench_cmd *cmd;
+
+	bench_find_pcm(bench, &fuzzer->msg);
+
+	if (bench->record_file)
+		bench_record_msg(bench, &fuzzer->msg);
+
+	cmd = bench_get_cmd(bench, fuzzer->msg.header &
+			    (SOF_GLB_TYPE_MASK | SOF_CMD_TYPE_MASK));
+	if (!cmd)
+		return;
+
+	if (cmd->count == cmd->size) {
+		cmd->size = cmd->size ? cmd->size * 2 : 16;
+		samples = realloc(cmd->samples,
+				  sizeof(*samples) * cmd->size);
+		if (!samples)
+			return;
+		cmd->samples = samples;
+	}
+
+	cmd->samples[cmd->count].dsp = t->reply > t->doorbell ?
+		t->reply - t->doorbell : 0;
+	cmd->samples[cmd->count].mbox = t->mbox;
+	cmd->samples[cmd->count].rtt = end - t->start;
+	cmd->count++;
+}
+
+/* sends the messages of a recorded sequence in order */
+int fuzzer_bench_replay(struct fuzz *fuzzer, const char *replay_filename)
+{
+	struct bench_record rec;
+	FILE *file;
+	int ret = 0;
+
+	file = fopen(replay_filename, "rb");
+	if (!file) {
+		fprintf(stderr, "error: opening replay file %s\n",
+			replay_filename);
+		return -errno;
+	}
+
+	while (fread(&rec, sizeof(rec), 1, file) == 1) {
+		if (rec.msg_size > SOF_IPC_MSG_MAX_SIZE ||
+		    rec.reply_size > SOF_IPC_MSG_MAX_SIZE ||
+		    fread(fuzzer->msg.msg_data, rec.msg_size, 1, file) != 1) {
+			fprintf(stderr, "error: corrupt replay file %s\n",
+				replay_filename);
+			ret = -EINVAL;
+			break;
+		}
+
+		fuzzer->msg.header = rec.header;
+		fuzzer->msg.msg_size = rec.msg_size;
+		fuzzer->msg.reply_size = rec.reply_size;
+
+		ret = fuzzer_send_msg(fuzzer);
+		if (ret < 0)
+			fprintf(stderr, "error: message tx failed\n");
+	}
+
+	fclose(file);
+	return ret;
+}
+
+static int bench_trigger(struct fuzz *fuzzer, uint32_t comp_id, uint32_t cmd)
+{
+	struct sof_ipc_stream stream;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.hdr.cmd = SOF_IPC_GLB_STREAM_MSG | cmd;
+	stream.hdr.size = sizeof(stream);
+	stream.comp_id = comp_id;
+
+	fuzzer->msg.header = stream.hdr.cmd;
+	memcpy(fuzzer->msg.msg_data, &stream, sizeof(stream));
+	fuzzer->msg.msg_size = sizeof(stream);
+	fuzzer->msg.reply_size = sizeof(struct sof_ipc_reply);
+
+	return fuzzer_send_msg(fuzzer);
+}
+
+/* starts and stops the stream of every host component */
+int fuzzer_bench_streams(struct fuzz *fuzzer, int iterations)
+{
+	struct fuzz_bench *bench = fuzzer->bench;
+	unsigned int i;
+	int n;
+
+	for (n = 0; n < iterations; n++) {
+		for (i = 0; i < bench->num_pcms; i++) {
+			bench_trigger(fuzzer, bench->pcm_ids[i],
+				      SOF_IPC_STREAM_TRIG_START);
+			bench_trigger(fuzzer, bench->pcm_ids[i],
+				      SOF_IPC_STREAM_TRIG_STOP);
+		}
+	}
+
+	return 0;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* prints min, percentiles, max and mean of one timing in us */
+static void bench_report_dist(FILE *out, const char *name,
+			      struct bench_cmd *cmd, size_t offset,
+			      uint64_t *values)
+{
+	uint64_t sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < cmd->count; i++) {
+		values[i] = *(uint64_t *)((char *)&cmd->samples[i] + offset);
+		sum += values[i];
+	}
+
+	qsort(values, cmd->count, sizeof(*values), bench_cmp);
+
+	fprintf(out, "  %-5s min %8.1f p50 %8.1f p95 %8.1f p99 %8.1f max %8.1f mean %8.1f\n",
+		name, values[0] / 1000.0,
+		values[cmd->count * 50 / 100] / 1000.0,
+		values[cmd->count * 95 / 100] / 1000.0,
+		values[cmd->count * 99 / 100] / 1000.0,
+		values[cmd->count - 1] / 1000.0,
+		(double)sum / cmd->count / 1000.0);
+}
+
+void fuzzer_bench_report(struct fuzz *fuzzer, FILE *out)
+{
+	struct fuzz_bench *bench = fuzzer->bench;
+	struct bench_cmd *cmd;
+	uint64_t *values;
+	unsigned int i;
+
+	fprintf(out, "IPC latency in us (dsp: doorbell to reply, mbox: mailbox copies, rtt: round trip)\n");
+
+	for (i = 0; i < bench->num_cmds; i++) {
+		cmd = &bench->cmds[i];
+		if (!cmd->count)
+			continue;
+
+		values = malloc(sizeof(*values) * cmd->count);
+		if (!values)
+			return;
+
+		fprintf(out, "cmd 0x%8.8x count %u\n", cmd->cmd, cmd->count);
+		bench_report_dist(out, "dsp", cmd,
+				  offsetof(struct bench_sample, dsp), values);
+		bench_report_dist(out, "mbox", cmd,
+				  offsetof(struct bench_sample, mbox), values);
+		bench_report_dist(out, "rtt", cmd,
+				  offsetof(struct bench_sample, rtt), values);
+
+		free(values);
+	}
+}
@@ -11,6 +11,8 @@
 #define __FUZZER_H__
 
 #include <stdint.h>
+#include <stdio.h>
+#include <time.h>
 
 #define DEBUG_MSG_LEN 512
 
@@ -72,6 +74,16 @@ struct ipc_msg {
 	unsigned int reply_size;
 };
 
+/* timestamps of the IPC message in flight in ns, used for benchmarks */
+struct fuzz_ipc_time {
+	uint64_t start;		/* message send started */
+	uint64_t doorbell;	/* message in mailbox and doorbell rung */
+	uint64_t reply;		/* DSP reply interrupt received */
+	uint64_t mbox;		/* time spent copying mailbox data */
+};
+
+struct fuzz_bench;
+
 /* platform description */
 struct fuzz_platform {
 	const char *name;
@@ -107,6 +119,10 @@ struct fuzz {
 	/* ipc mutex */
 	pthread_mutex_t ipc_mutex;
 
+	/* benchmark, NULL when not benchmarking */
+	struct fuzz_bench *bench;
+	struct fuzz_ipc_time ipc_time;
+
 	FILE *tplg_file;
 
 	void *platform_data; /* core does not touch this */
@@ -133,21 +149,43 @@ int fuzzer_send_msg(struct fuzz *fuzzer);
 /* topology */
 int parse_tplg(struct fuzz *fuzzer, char *tplg_filename);
 
+/* benchmark */
+int fuzzer_bench_init(struct fuzz *fuzzer, const char *record_filename);
+void fuzzer_bench_record(struct fuzz *fuzzer, uint64_t end);
+int fuzzer_bench_replay(struct fuzz *fuzzer, const char *replay_filename);
+int fuzzer_bench_streams(struct fuzz *fuzzer, int iterations);
+void fuzzer_bench_report(struct fuzz *fuzzer, FILE *out);
+void fuzzer_bench_free(struct fuzz *fuzzer);
+
+static inline uint64_t fuzzer_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 /* Convenience platform ops */
 static inline void fuzzer_mailbox_read(struct fuzz *fuzzer,
 				       struct mailbox *mailbox, int offset,
 				       void *dest, size_t bytes)
 {
+	uint64_t start = fuzzer_now_ns();
+
 	fuzzer->platform->mailbox_read(fuzzer, mailbox->offset + offset,
 				       dest, bytes);
+	fuzzer->ipc_time.mbox += fuzzer_now_ns() - start;
 }
 
 static inline void fuzzer_mailbox_write(struct fuzz *fuzzer,
 				       struct mailbox *mailbox, int offset,
 				       void *src, size_t bytes)
 {
+	uint64_t start = fuzzer_now_ns();
+
 	fuzzer->platform->mailbox_write(fuzzer, mailbox->offset + offset,
 				       src, bytes);
+	fuzzer->ipc_time.mbox += fuzzer_now_ns() - start;
 }
 
 static inline void fuzzer_fw_ready(struct fuzz *fuzzer)
@@ -86,6 +86,10 @@ static void usage(char *name)
 	fprintf(stdout, "Usage %s -p platform <option(s)>\n", name);
 	fprintf(stdout, "		-t topology file\n");
 	fprintf(stdout, "		-p platform name\n");
+	fprintf(stdout, "		-b benchmark IPC latency\n");
+	fprintf(stdout, "		-w record sent IPCs to file\n");
+	fprintf(stdout, "		-r replay IPCs from file instead of topology\n");
+	fprintf(stdout, "		-n stream start/stop iterations when benchmarking\n");
 	fprintf(stdout, "		supported platforms: ");
 	for (i = 0; i < ARRAY_SIZE(platform); i++)
 		fprintf(stdout, "%s ", platform[i]->name);
@@ -204,6 +208,8 @@ void fuzzer_ipc_msg_reply(struct fuzz *fuzzer, struct mailbox *mailbox)
 {
 	int ret;
 
+	fuzzer->ipc_time.reply = fuzzer_now_ns();
+
 	ret = fuzzer->platform->get_reply(fuzzer, &fuzzer->msg);
 	if (ret < 0)
 		fprintf(stderr, "error: incorrect DSP reply\n");
@@ -233,6 +239,9 @@ int fuzzer_send_msg(struct fuzz *fuzzer)
 
 	ipc_dump(&fuzzer->msg);
 
+	memset(&fuzzer->ipc_time, 0, sizeof(fuzzer->ipc_time));
+	fuzzer->ipc_time.start = fuzzer_now_ns();
+
 	/* send msg */
 	ret = fuzzer->platform->send_msg(fuzzer, &fuzzer->msg);
 	if (ret < 0) {
@@ -240,6 +249,8 @@ int fuzzer_send_msg(struct fuzz *fuzzer)
 		return ret;
 	}
 
+	fuzzer->ipc_time.doorbell = fuzzer_now_ns();
+
 	/* wait for ipc reply */
 	gettimeofday(&tp, NULL);
 	timeout.tv_sec  = tp.tv_sec;
@@ -267,6 +278,9 @@ int fuzzer_send_msg(struct fuzz *fuzzer)
 
 	pthread_mutex_unlock(&ipc_mutex);
 
+	if (fuzzer->bench)
+		fuzzer_bench_record(fuzzer, fuzzer_now_ns());
+
 	/*
 	 * sleep for 5 ms before continuing sending the next message.
 	 * This helps with the condition signaling. Without this,
@@ -285,11 +299,15 @@ int main(int argc, char *argv[])
 	char opt;
 	char *topology_file;
 	char *platform_name = NULL;
+	char *record_file = NULL;
+	char *replay_file = NULL;
+	int bench = 0;
+	int iterations = 1;
 	int i, j;
 	int regions = 0;
 
 	/* parse arguments */
-	while ((opt = getopt(argc, argv, "ht:p:")) != -1) {
+	while ((opt = getopt(argc, argv, "ht:p:bw:r:n:")) != -1) {
 		switch (opt) {
 		case 't':
 			topology_file = optarg;
@@ -297,6 +315,18 @@ int main(int argc, char *argv[])
 		case 'p':
 			platform_name = optarg;
 			break;
+		case 'b':
+			bench = 1;
+			break;
+		case 'w':
+			record_file = optarg;
+			break;
+		case 'r':
+			replay_file = optarg;
+			break;
+		case 'n':
+			iterations = atoi(optarg);
+			break;
 		case 'h':
 			usage(argv[0]);
 			exit(0);
@@ -343,11 +373,29 @@ int main(int argc, char *argv[])
 	fuzzer.msg.msg_data = malloc(SOF_IPC_MSG_MAX_SIZE);
 	fuzzer.msg.reply_data = malloc(SOF_IPC_MSG_MAX_SIZE);
 
-	/* load topology */
-	ret = parse_tplg(&fuzzer, topology_file);
+	/* benchmarks and recordings time every IPC sent */
+	fuzzer.bench = NULL;
+	if (bench || record_file) {
+		ret = fuzzer_bench_init(&fuzzer, record_file);
+		if (ret < 0)
+			exit(EXIT_FAILURE);
+	}
+
+	/* load topology or replay a recorded IPC sequence */
+	if (replay_file)
+		ret = fuzzer_bench_replay(&fuzzer, replay_file);
+	else
+		ret = parse_tplg(&fuzzer, topology_file);
 	if (ret < 0)
 		exit(EXIT_FAILURE);
 
+	if (bench) {
+		fuzzer_bench_streams(&fuzzer, iterations);
+		fuzzer_bench_report(&fuzzer, stdout);
+	}
+
+	fuzzer_bench_free(&fuzzer);
+
 	/* all done - now free platform */
 	platform[i]->free(&fuzzer);
 	return 0;
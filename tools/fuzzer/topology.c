@@ -233,7 +233,7 @@ int load_pga(void *dev, int comp_id, int pipeline_id,
 int load_pipeline(void *dev, int comp_id, int pipeline_id,
 		  struct snd_soc_tplg_dapm_widget *widget, int sched_id)
 {
-	struct sof_ipc_pipe_new pipeline;
+	struct sof_ipc_pipe_new pipeline = {0};
 	struct fuzz *fuzzer = (struct fuzz *)dev;
 	struct sof_ipc_comp_reply r;
 	int ret;
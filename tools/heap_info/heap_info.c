@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/*
+ * Decodes SOF_IPC_TRACE_HEAP_INFO reply saved to a file and prints
+ * usage, high water mark and fragmentation of every firmware heap.
+ *
+ * Usage: ./sof-heap-info -i heap_info.bin
+ *
+ */
+
+#include <ipc/header.h>
+#include <ipc/trace.h>
+#include <sof/common.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define APP_NAME "sof-heap-info"
+
+static const char * const zone_names[] = {
+	[SOF_IPC_HEAP_ZONE_SYS] = "sys",
+	[SOF_IPC_HEAP_ZONE_SYS_RUNTIME] = "sys_rt",
+	[SOF_IPC_HEAP_ZONE_RUNTIME] = "runtime",
+	[SOF_IPC_HEAP_ZONE_BUFFER] = "buffer",
+};
+
+static void usage(void)
+{
+	fprintf(stdout, "Usage %s <option(s)>\n\n", APP_NAME);
+	fprintf(stdout, "%s:\t -i file\tDecode heap info reply from file\n",
+		APP_NAME);
+	fprintf(stdout, "%s:\t -h \t\tHelp, usage info\n", APP_NAME);
+	exit(0);
+}
+
+/* fragmentation in percent, 0 when all free space is contiguous */
+static unsigned int fragmentation(const struct sof_ipc_dbg_heap_elem *elem)
+{
+	if (!elem->free)
+		return 0;
+
+	return 100 - (uint64_t)elem->largest_free * 100 / elem->free;
+}
+
+static void print_elem(const struct sof_ipc_dbg_heap_elem *elem)
+{
+	const char *zone = "unknown";
+
+	if (elem->zone < ARRAY_SIZE(zone_names))
+		zone = zone_names[elem->zone];
+
+	fprintf(stdout, "%-8s %2u 0x%08x %8u %8u %8u %8u %8u %5u%% %6u\n",
+		zone, elem->id, elem->caps, elem->size, elem->used,
+		elem->free, elem->peak_used, elem->largest_free,
+		fragmentation(elem), elem->alloc_fails);
+}
+
+static int decode(const char *file)
+{
+	struct sof_ipc_dbg_heap_info *info;
+	FILE *fd;
+	size_t size;
+	uint32_t i;
+	int ret = 0;
+
+	fd = fopen(file, "rb");
+	if (!fd) {
+		fprintf(stderr, "error: unable to open file %s, error %d\n",
+			file, errno);
+		return -errno;
+	}
+
+	info = calloc(1, SOF_IPC_MSG_MAX_SIZE);
+	if (!info) {
+		fclose(fd);
+		return -ENOMEM;
+	}
+
+	size = fread(info, 1, SOF_IPC_MSG_MAX_SIZE, fd);
+	fclose(fd);
+
+	if (size < sizeof(*info) || info->rhdr.hdr.size > size ||
+	    info->num_elems * sizeof(info->elems[0]) + sizeof(*info) >
+	    info->rhdr.hdr.size) {
+		fprintf(stderr, "error: %s is not a valid heap info reply\n",
+			file);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	if (info->rhdr.error) {
+		fprintf(stderr, "error: firmware returned %d\n",
+			info->rhdr.error);
+		ret = info->rhdr.error;
+		goto out;
+	}
+
+	fprintf(stdout, "%-8s %2s %-10s %8s %8s %8s %8s %8s %6s %6s\n",
+		"zone", "id", "caps", "size", "used", "free", "peak",
+		"largest", "frag", "fails");
+
+	for (i = 0; i < info->num_elems; i++)
+		print_elem(&info->elems[i]);
+
+	if (info->num_elems < info->total_elems)
+		fprintf(stdout, "%s: %u of %u heaps didn't fit in the reply\n",
+			APP_NAME, info->total_elems - info->num_elems,
+			info->total_elems);
+
+out:
+	free(info);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	int ret = 0;
+
+	while ((opt = getopt(argc, argv, "hi:")) != -1) {
+		switch (opt) {
+		case 'i':
+			ret = decode(optarg);
+			break;
+		case 'h':
+		default:
+			usage();
+		}
+	}
+
+	return ret ? EXIT_FAILURE : 0;
+}
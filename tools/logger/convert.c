@@ -22,7 +22,8 @@
 #define TRACE_MAX_PARAMS_COUNT		4
 #define TRACE_MAX_TEXT_LEN		1024
 #define TRACE_MAX_FILENAME_LEN		128
-#define TRACE_MAX_IDS_STR		10
+/* space, two ints with sign and dot separator */
+#define TRACE_MAX_IDS_STR		25
 #define TRACE_IDS_MASK			((1 << TRACE_ID_LENGTH) - 1)
 #define INVALID_TRACE_ID		(-1 & TRACE_IDS_MASK)
 
@@ -349,7 +350,7 @@ static void print_entry_params(FILE *out_fd,
 			ids,
 			to_usecs(dma_log->timestamp, clock),
 			dt,
-			format_file_name(entry->file_name, raw_output),
+			entry->file_name,
 			entry->header.line_idx);
 	} else {
 		/* timestamp */
@@ -372,7 +373,7 @@ static void print_entry_params(FILE *out_fd,
 
 		/* location */
 		fprintf(out_fd, "%24s:%-4u  ",
-			format_file_name(entry->file_name, raw_output),
+			entry->file_name,
 			entry->header.line_idx);
 
 		/* level name */
@@ -406,145 +407,350 @@ static void print_entry_params(FILE *out_fd,
 	}
 	free_proc_ldc_entry(&proc_entry);
 	fprintf(out_fd, "%s\n", use_colors ? KNRM : "");
-	fflush(out_fd);
 }
 
-static int fetch_entry(const struct convert_config *config,
-	uint32_t base_address, uint32_t data_offset,
-	const struct log_entry_header *dma_log, uint64_t *last_timestamp)
+/* formats entry text with its parameters, truncated to size */
+static void format_entry_text(char *buf, size_t size,
+			      const struct proc_ldc_entry *pe)
+{
+	switch (pe->header.params_num) {
+	case 0:
+		snprintf(buf, size, "%s", pe->text);
+		break;
+	case 1:
+		snprintf(buf, size, pe->text, pe->params[0]);
+		break;
+	case 2:
+		snprintf(buf, size, pe->text, pe->params[0], pe->params[1]);
+		break;
+	case 3:
+		snprintf(buf, size, pe->text, pe->params[0], pe->params[1],
+			 pe->params[2]);
+		break;
+	case 4:
+		snprintf(buf, size, pe->text, pe->params[0], pe->params[1],
+			 pe->params[2], pe->params[3]);
+		break;
+	}
+}
+
+static void print_json_string(FILE *out_fd, const char *str)
 {
-	struct ldc_entry entry;
-	uint32_t entry_offset;
+	fputc('"', out_fd);
 
-	int ret;
+	for (; *str; str++) {
+		switch (*str) {
+		case '"':
+			fputs("\\\"", out_fd);
+			break;
+		case '\\':
+			fputs("\\\\", out_fd);
+			break;
+		default:
+			if ((unsigned char)*str < 0x20)
+				fprintf(out_fd, "\\u%04x", *str);
+			else
+				fputc(*str, out_fd);
+			break;
+		}
+	}
+
+	fputc('"', out_fd);
+}
+
+/* entry text with parameters substituted, without colors */
+static void get_entry_text(const struct convert_config *config,
+			   const struct ldc_entry *entry,
+			   char *text, size_t size)
+{
+	struct proc_ldc_entry proc_entry;
+
+	process_params(&proc_entry, entry, config->uids_dict, 0);
+	format_entry_text(text, size, &proc_entry);
+	free_proc_ldc_entry(&proc_entry);
+}
+
+static void print_entry_json(const struct convert_config *config,
+			     const struct log_entry_header *dma_log,
+			     const struct ldc_entry *entry,
+			     uint64_t last_timestamp)
+{
+	double dt = to_usecs(dma_log->timestamp - last_timestamp,
+			     config->clock);
+	char text[TRACE_MAX_TEXT_LEN * 2];
+	FILE *out_fd = config->out_fd;
+
+	get_entry_text(config, entry, text, sizeof(text));
+
+	fprintf(out_fd, "{\"timestamp\": %.6f, \"delta\": ",
+		to_usecs(dma_log->timestamp, config->clock));
+	if (dt < 0 || dt > 1000.0 * 1000.0 * 1000.0)
+		fprintf(out_fd, "null");
+	else
+		fprintf(out_fd, "%.6f", dt);
+
+	fprintf(out_fd, ", \"core\": %u, \"level\": %u, \"component\": ",
+		dma_log->core_id, entry->header.level);
+	print_json_string(out_fd,
+			  get_component_name(config->uids_dict,
+					     entry->header.component_class,
+					     dma_log->uid));
 
-	entry.file_name = NULL;
-	entry.text = NULL;
-	entry.params = NULL;
+	if (dma_log->id_0 != INVALID_TRACE_ID &&
+	    dma_log->id_1 != INVALID_TRACE_ID)
+		fprintf(out_fd, ", \"id_0\": %u, \"id_1\": %u",
+			dma_log->id_0 & TRACE_IDS_MASK,
+			dma_log->id_1 & TRACE_IDS_MASK);
+
+	fprintf(out_fd, ", \"file\": ");
+	print_json_string(out_fd, entry->file_name);
+	fprintf(out_fd, ", \"line\": %u, \"text\": ", entry->header.line_idx);
+	print_json_string(out_fd, text);
+	fprintf(out_fd, "}\n");
+}
 
-	/* evaluate entry offset in input file */
-	entry_offset = dma_log->log_entry_address - base_address;
+/*
+ * Chrome trace event, timeline spans are begin and end events of the thread
+ * of the reporting core and all other entries are instant events.
+ */
+static void print_entry_timeline(const struct convert_config *config,
+				 const struct log_entry_header *dma_log,
+				 const struct ldc_entry *entry)
+{
+	char text[TRACE_MAX_TEXT_LEN * 2];
+	char name[TRACE_MAX_TEXT_LEN * 2 + 64];
+	FILE *out_fd = config->out_fd;
+	const char *phase = "i";
+	const char *event = text;
+	char ids[TRACE_MAX_IDS_STR];
 
-	/* set file position to beginning of processed entry */
-	fseek(config->ldc_fd, entry_offset + data_offset, SEEK_SET);
+	get_entry_text(config, entry, text, sizeof(text));
 
-	/* fetching elf header params */
-	ret = fread(&entry.header, sizeof(entry.header), 1, config->ldc_fd);
-	if (!ret) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	if (!strncmp(text, TRACE_TIMELINE_BEGIN,
+		     strlen(TRACE_TIMELINE_BEGIN))) {
+		phase = "B";
+		event = text + strlen(TRACE_TIMELINE_BEGIN);
+	} else if (!strncmp(text, TRACE_TIMELINE_END,
+			    strlen(TRACE_TIMELINE_END))) {
+		phase = "E";
+		event = text + strlen(TRACE_TIMELINE_END);
 	}
-	if (entry.header.file_name_len > TRACE_MAX_FILENAME_LEN) {
-		log_err(config->out_fd,
-			"Invalid filename length or ldc file does not match firmware\n");
-		ret = -EINVAL;
-		goto out;
+
+	if (dma_log->id_0 != INVALID_TRACE_ID &&
+	    dma_log->id_1 != INVALID_TRACE_ID)
+		snprintf(ids, sizeof(ids), " %d.%d",
+			 (dma_log->id_0 & TRACE_IDS_MASK),
+			 (dma_log->id_1 & TRACE_IDS_MASK));
+	else
+		ids[0] = '\0';
+
+	snprintf(name, sizeof(name), "%s%s: %s",
+		 get_component_name(config->uids_dict,
+				    entry->header.component_class,
+				    dma_log->uid),
+		 ids, event);
+
+	fprintf(out_fd, ",\n{\"name\": ");
+	print_json_string(out_fd, name);
+	fprintf(out_fd, ", \"ph\": \"%s\", \"ts\": %.3f, \"pid\": 0, \"tid\": %u%s}",
+		phase, to_usecs(dma_log->timestamp, config->clock),
+		dma_log->core_id, *phase == 'i' ? ", \"s\": \"t\"" : "");
+}
+
+/* trace record as read, to be decoded later with the same ldc file */
+static void print_entry_binary(const struct convert_config *config,
+			       const struct log_entry_header *dma_log,
+			       const struct ldc_entry *entry)
+{
+	uint32_t params_num = entry->header.params_num;
+
+	if (fwrite(dma_log, sizeof(*dma_log), 1, config->out_fd) != 1 ||
+	    fwrite(entry->params, sizeof(uint32_t), params_num,
+		   config->out_fd) != params_num)
+		log_err(NULL, "Failed to write trace record.\n");
+}
+
+static void print_entry(const struct convert_config *config,
+			const struct log_entry_header *dma_log,
+			const struct ldc_entry *dict_entry, uint32_t *params,
+			uint64_t *last_timestamp)
+{
+	struct ldc_entry entry = *dict_entry;
+
+	entry.params = params;
+
+	switch (config->output_format) {
+	case OUTPUT_JSON:
+		print_entry_json(config, dma_log, &entry, *last_timestamp);
+		break;
+	case OUTPUT_BINARY:
+		print_entry_binary(config, dma_log, &entry);
+		break;
+	case OUTPUT_TIMELINE:
+		print_entry_timeline(config, dma_log, &entry);
+		break;
+	default:
+		print_entry_params(config->out_fd, config->uids_dict,
+				   dma_log, &entry, *last_timestamp,
+				   config->clock, config->use_colors,
+				   config->raw_output);
+		break;
 	}
-	entry.file_name = (char *)malloc(entry.header.file_name_len);
 
-	if (!entry.file_name) {
+	*last_timestamp = dma_log->timestamp;
+}
+
+/* log entries section of the ldc file, loaded once and indexed on use */
+struct ldc_dict {
+	uint8_t *data;
+	uint32_t base_address;
+	uint32_t data_length;
+	struct ldc_entry **index;	/* decoded entries by word offset */
+};
+
+static int ldc_dict_load(struct convert_config *config,
+			 const struct snd_sof_logs_header *snd)
+{
+	struct ldc_dict *dict;
+
+	dict = calloc(1, sizeof(*dict));
+	if (!dict)
+		return -ENOMEM;
+
+	dict->base_address = snd->base_address;
+	dict->data_length = snd->data_length;
+	dict->data = malloc(snd->data_length);
+	dict->index = calloc(snd->data_length / sizeof(uint32_t) + 1,
+			     sizeof(*dict->index));
+	config->ldc_dict = dict;
+	if (!dict->data || !dict->index) {
 		log_err(config->out_fd,
-			"can't allocate %d byte for entry.file_name\n",
-			entry.header.file_name_len);
-		ret = -ENOMEM;
-		goto out;
+			"failed to alloc memory for log entries.\n");
+		return -ENOMEM;
 	}
 
-	ret = fread(entry.file_name, sizeof(char), entry.header.file_name_len,
-		config->ldc_fd);
-	if (ret != entry.header.file_name_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	fseek(config->ldc_fd, snd->data_offset, SEEK_SET);
+	if (fread(dict->data, snd->data_length, 1, config->ldc_fd) != 1) {
+		log_err(config->out_fd,
+			"failed to read log entries from %s.\n",
+			config->ldc_file);
+		return ferror(config->ldc_fd) ? -ferror(config->ldc_fd) :
+			-EINVAL;
 	}
 
-	/* fetching text */
-	if (entry.header.text_len > TRACE_MAX_TEXT_LEN) {
+	return 0;
+}
+
+static void ldc_dict_free(struct convert_config *config)
+{
+	struct ldc_dict *dict = config->ldc_dict;
+	uint32_t i;
+
+	if (!dict)
+		return;
+
+	if (dict->index)
+		for (i = 0; i <= dict->data_length / sizeof(uint32_t); i++)
+			free(dict->index[i]);
+
+	free(dict->index);
+	free(dict->data);
+	free(dict);
+	config->ldc_dict = NULL;
+}
+
+/* returns the dictionary entry of a valid record address, decoded once */
+static const struct ldc_entry *ldc_dict_get(const struct convert_config *config,
+					    uint32_t address)
+{
+	struct ldc_dict *dict = config->ldc_dict;
+	uint32_t offset = address - dict->base_address;
+	struct ldc_entry_header header;
+	struct ldc_entry *entry;
+	const uint8_t *src;
+	char *file_name;
+
+	entry = dict->index[offset / sizeof(uint32_t)];
+	if (entry)
+		return entry;
+
+	if (offset + sizeof(header) > dict->data_length) {
 		log_err(config->out_fd,
-			"Invalid text length.\n");
-		ret = -EINVAL;
-		goto out;
+			"Invalid entry address or ldc file does not match firmware\n");
+		return NULL;
 	}
-	entry.text = (char *)malloc(entry.header.text_len);
-	if (!entry.text) {
+
+	src = dict->data + offset;
+	memcpy(&header, src, sizeof(header));
+	src += sizeof(header);
+
+	if (header.file_name_len > TRACE_MAX_FILENAME_LEN) {
 		log_err(config->out_fd,
-			"can't allocate %d byte for entry.text\n",
-			entry.header.text_len);
-		ret = -ENOMEM;
-		goto out;
+			"Invalid filename length or ldc file does not match firmware\n");
+		return NULL;
 	}
-	ret = fread(entry.text, sizeof(char), entry.header.text_len, config->ldc_fd);
-	if (ret != entry.header.text_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	if (header.text_len > TRACE_MAX_TEXT_LEN) {
+		log_err(config->out_fd,
+			"Invalid text length.\n");
+		return NULL;
 	}
-
-	/* fetching entry params from dma dump */
-	if (entry.header.params_num > TRACE_MAX_PARAMS_COUNT) {
+	if (header.params_num > TRACE_MAX_PARAMS_COUNT) {
 		log_err(config->out_fd,
 			"Invalid number of parameters.\n");
-		ret = -EINVAL;
-		goto out;
+		return NULL;
 	}
-	entry.params = (uint32_t *)malloc(sizeof(uint32_t) *
-		entry.header.params_num);
-	if (!entry.params) {
+	if (offset + sizeof(header) + header.file_name_len + header.text_len >
+	    dict->data_length) {
 		log_err(config->out_fd,
-			"can't allocate %d byte for entry.params\n",
-			(int)(sizeof(uint32_t) * entry.header.params_num));
-		ret = -ENOMEM;
-		goto out;
-	}
-
-	if (config->serial_fd < 0) {
-		ret = fread(entry.params, sizeof(uint32_t),
-			    entry.header.params_num, config->in_fd);
-		if (ret != entry.header.params_num) {
-			ret = -ferror(config->in_fd);
-			goto out;
-		}
-	} else {
-		size_t size = sizeof(uint32_t) * entry.header.params_num;
-		uint8_t *n;
-
-		for (n = (uint8_t *)entry.params; size;
-		     n += ret, size -= ret) {
-			ret = read(config->serial_fd, n, size);
-			if (ret < 0) {
-				ret = -errno;
-				goto out;
-			}
-			if (ret != size)
-				log_err(config->out_fd,
-					"Partial read of %u bytes of %lu.\n",
-					ret, size);
-		}
+			"Invalid entry length or ldc file does not match firmware\n");
+		return NULL;
 	}
 
-	/* printing entry content */
-	print_entry_params(config->out_fd,
-			   config->uids_dict,
-			   dma_log, &entry, *last_timestamp,
-			   config->clock, config->use_colors,
-			   config->raw_output);
-	*last_timestamp = dma_log->timestamp;
+	/* strings are kept terminated just after the entry */
+	entry = malloc(sizeof(*entry) + header.file_name_len +
+		       header.text_len + 2);
+	if (!entry) {
+		log_err(config->out_fd,
+			"can't allocate memory for log entry\n");
+		return NULL;
+	}
 
-	/* set f_ldc file position to the beginning */
-	rewind(config->ldc_fd);
+	entry->header = header;
+	entry->params = NULL;
 
-	ret = 0;
-out:
-	/* free alocated memory */
-	free(entry.params);
-	free(entry.text);
-	free(entry.file_name);
+	file_name = (char *)(entry + 1);
+	memcpy(file_name, src, header.file_name_len);
+	file_name[header.file_name_len] = '\0';
+	src += header.file_name_len;
 
-	return ret;
+	entry->text = file_name + header.file_name_len + 1;
+	memcpy(entry->text, src, header.text_len);
+	entry->text[header.text_len] = '\0';
+
+	/* formatted once, the name is printed as it is for each record */
+	entry->file_name = format_file_name(file_name, config->raw_output);
+
+	dict->index[offset / sizeof(uint32_t)] = entry;
+
+	return entry;
+}
+
+/* checks if a record address points to an entry of the ldc file */
+static int entry_address_valid(const struct snd_sof_logs_header *snd,
+			       uint32_t address)
+{
+	return address >= snd->base_address &&
+	       address <= snd->base_address + snd->data_length &&
+	       !((address - snd->base_address) % sizeof(uint32_t));
 }
 
 static int serial_read(const struct convert_config *config,
 	struct snd_sof_logs_header *snd, uint64_t *last_timestamp)
 {
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	const struct ldc_entry *entry;
 	struct log_entry_header dma_log;
+	size_t size;
 	size_t len;
 	uint8_t *n;
 	int ret;
@@ -564,8 +770,7 @@ static int serial_read(const struct convert_config *config,
 	}
 
 	/* Skip all trace_point() values, although this test isn't 100% reliable */
-	while ((dma_log.log_entry_address < snd->base_address) ||
-	       dma_log.log_entry_address > snd->base_address + snd->data_length) {
+	while (!entry_address_valid(snd, dma_log.log_entry_address)) {
 		/*
 		 * 8 characters and a '\n' come from the serial port, append a
 		 * '\0'
@@ -590,21 +795,303 @@ static int serial_read(const struct convert_config *config,
 		}
 	}
 
-	/* fetching entry from elf dump */
-	return fetch_entry(config, snd->base_address, snd->data_offset,
-			   &dma_log, last_timestamp);
+	/* fetching entry from the dictionary */
+	entry = ldc_dict_get(config, dma_log.log_entry_address);
+	if (!entry)
+		return -EINVAL;
+
+	/* entry params follow the record header */
+	size = sizeof(uint32_t) * entry->header.params_num;
+	for (n = (uint8_t *)params; size; n += ret, size -= ret) {
+		ret = read(config->serial_fd, n, size);
+		if (ret < 0)
+			return -errno;
+		if (ret != size)
+			log_err(config->out_fd,
+				"Partial read of %u bytes of %lu.\n",
+				ret, size);
+	}
+
+	print_entry(config, &dma_log, entry, params, last_timestamp);
+	fflush(config->out_fd);
+
+	return 0;
+}
+
+/* trace input is read in large blocks rather than record by record */
+#define TRACE_READ_BUF_SIZE	(64 * 1024)
+
+struct trace_reader {
+	FILE *fd;
+	int follow;	/* wait for more data at the end of input */
+	uint8_t *buf;
+	size_t head;	/* first byte not consumed yet */
+	size_t tail;	/* end of data in buf */
+};
+
+/* makes size bytes available from head, -ENODATA at the end of input */
+static int trace_reader_fill(struct trace_reader *reader, FILE *out_fd,
+			     size_t size)
+{
+	ssize_t ret;
+
+	while (reader->tail - reader->head < size) {
+		if (reader->head) {
+			memmove(reader->buf, reader->buf + reader->head,
+				reader->tail - reader->head);
+			reader->tail -= reader->head;
+			reader->head = 0;
+		}
+
+		/* output what has been decoded before waiting for input */
+		fflush(out_fd);
+
+		ret = read(fileno(reader->fd), reader->buf + reader->tail,
+			   TRACE_READ_BUF_SIZE - reader->tail);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+
+		if (!ret) {
+			if (!reader->follow)
+				return -ENODATA;
+
+			freopen(NULL, "r", reader->fd);
+			continue;
+		}
+
+		reader->tail += ret;
+	}
+
+	return 0;
+}
+
+/* decodes and prints the full record at head of the input */
+static int record_read(const struct convert_config *config,
+		       const struct snd_sof_logs_header *snd,
+		       struct trace_reader *reader, uint64_t *last_timestamp)
+{
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	struct log_entry_header dma_log;
+	const struct ldc_entry *entry;
+	size_t params_size;
+	int ret;
+
+	/* getting entry parameters from dma dump */
+	ret = trace_reader_fill(reader, config->out_fd, sizeof(dma_log));
+	if (ret)
+		return ret;
+
+	memcpy(&dma_log, reader->buf + reader->head, sizeof(dma_log));
+
+	/* checking if received trace address is located in
+	 * entry section in elf file.
+	 */
+	if (!entry_address_valid(snd, dma_log.log_entry_address)) {
+		/* in case the address is not correct input should be
+		 * move forward by one DWORD, not entire struct dma_log
+		 */
+		reader->head += sizeof(uint32_t);
+		return 0;
+	}
+
+	/* fetching entry from the dictionary */
+	entry = ldc_dict_get(config, dma_log.log_entry_address);
+	if (!entry)
+		return -EINVAL;
+
+	/* entry params follow the record header */
+	params_size = sizeof(uint32_t) * entry->header.params_num;
+	ret = trace_reader_fill(reader, config->out_fd,
+				sizeof(dma_log) + params_size);
+	if (ret)
+		return ret;
+
+	memcpy(params, reader->buf + reader->head + sizeof(dma_log),
+	       params_size);
+	reader->head += sizeof(dma_log) + params_size;
+
+	print_entry(config, &dma_log, entry, params, last_timestamp);
+
+	return 0;
+}
+
+/* bytes of a compact record being decoded */
+struct compact_cursor {
+	const uint8_t *pos;
+	const uint8_t *end;
+};
+
+/* decodes an unsigned LEB128 value, -ENODATA if it isn't complete yet */
+static int compact_varint(struct compact_cursor *cur, uint64_t *value,
+			  int max_size)
+{
+	int i;
+
+	*value = 0;
+
+	for (i = 0; i < max_size; i++) {
+		if (cur->pos == cur->end)
+			return -ENODATA;
+
+		*value |= (uint64_t)(*cur->pos & 0x7f) << (7 * i);
+		if (!(*cur->pos++ & 0x80))
+			return 0;
+	}
+
+	return -EBADMSG;
+}
+
+static int compact_varint32(struct compact_cursor *cur, uint32_t *value)
+{
+	uint64_t v;
+	int ret;
+
+	ret = compact_varint(cur, &v, TRACE_COMPACT_VARINT32_MAX);
+	if (!ret && v > UINT32_MAX)
+		return -EBADMSG;
+
+	*value = v;
+
+	return ret;
+}
+
+/*
+ * Decodes a compact record into a full one. Returns -ENODATA if the record
+ * isn't complete and -EBADMSG if the bytes aren't a valid record.
+ */
+static int compact_decode(const struct convert_config *config,
+			  const struct snd_sof_logs_header *snd,
+			  struct compact_cursor *cur, const uint64_t *stamps,
+			  struct log_entry_header *dma_log,
+			  const struct ldc_entry **entry, uint32_t *params)
+{
+	uint32_t entry_id;
+	uint32_t uid_id;
+	uint32_t id = INVALID_TRACE_ID;
+	uint64_t stamp;
+	uint8_t tag;
+	int ret;
+	int i;
+
+	if (cur->pos == cur->end)
+		return -ENODATA;
+
+	tag = *cur->pos++;
+	if ((tag & TRACE_COMPACT_MAGIC_MASK) != TRACE_COMPACT_MAGIC)
+		return -EBADMSG;
+
+	ret = compact_varint(cur, &stamp, TRACE_COMPACT_VARINT64_MAX);
+	if (!ret)
+		ret = compact_varint32(cur, &entry_id);
+	if (!ret)
+		ret = compact_varint32(cur, &uid_id);
+	if (ret)
+		return ret;
+
+	dma_log->core_id = tag & TRACE_COMPACT_CORE_MASK;
+	dma_log->timestamp = tag & TRACE_COMPACT_ABS ? stamp :
+		stamps[dma_log->core_id] + stamp;
+	dma_log->log_entry_address = snd->base_address +
+		entry_id * sizeof(uint32_t);
+	dma_log->uid = uid_id ? config->uids_dict->base_address +
+		(uid_id - 1) * sizeof(uint32_t) : 0;
+
+	if (!entry_address_valid(snd, dma_log->log_entry_address))
+		return -EBADMSG;
+
+	dma_log->id_0 = id;
+	dma_log->id_1 = id;
+	if (tag & TRACE_COMPACT_IDS) {
+		ret = compact_varint32(cur, &id);
+		dma_log->id_0 = id;
+		if (!ret)
+			ret = compact_varint32(cur, &id);
+		dma_log->id_1 = id;
+		if (ret)
+			return ret;
+	}
+
+	*entry = ldc_dict_get(config, dma_log->log_entry_address);
+	if (!*entry)
+		return -EINVAL;
+
+	for (i = 0; i < (*entry)->header.params_num; i++) {
+		ret = compact_varint32(cur, &params[i]);
+		if (ret)
+			return ret;
+	}
+
+	/* records are padded to whole words */
+	while (cur->pos != cur->end && !*cur->pos)
+		cur->pos++;
+
+	return 0;
+}
+
+/* decodes and prints the compact record at head of the input */
+static int compact_record_read(const struct convert_config *config,
+			       const struct snd_sof_logs_header *snd,
+			       struct trace_reader *reader, uint64_t *stamps,
+			       uint64_t *last_timestamp)
+{
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	struct log_entry_header dma_log;
+	const struct ldc_entry *entry;
+	struct compact_cursor cur;
+	int ret;
+
+	/* record size is only known once decoded, so it's retried */
+	for (;;) {
+		cur.pos = reader->buf + reader->head;
+		cur.end = reader->buf + reader->tail;
+
+		ret = compact_decode(config, snd, &cur, stamps, &dma_log,
+				     &entry, params);
+		if (ret != -ENODATA)
+			break;
+
+		ret = trace_reader_fill(reader, config->out_fd,
+					reader->tail - reader->head + 1);
+		if (ret)
+			return ret;
+	}
+
+	/* input is moved forward by one byte to find the next record */
+	if (ret == -EBADMSG) {
+		reader->head++;
+		return 0;
+	}
+
+	if (ret)
+		return ret;
+
+	reader->head = cur.pos - reader->buf;
+	stamps[dma_log.core_id] = dma_log.timestamp;
+
+	print_entry(config, &dma_log, entry, params, last_timestamp);
+
+	return 0;
 }
 
 static int logger_read(const struct convert_config *config,
 	struct snd_sof_logs_header *snd)
 {
-	struct log_entry_header dma_log;
-	int ret = 0;
+	uint64_t stamps[TRACE_COMPACT_CORE_MASK + 1] = { 0 };
+	struct trace_reader reader;
 	uint64_t last_timestamp = 0;
+	int ret = 0;
 
-	if (!config->raw_output)
+	if (config->output_format == OUTPUT_TEXT && !config->raw_output)
 		print_table_header(config->out_fd);
 
+	/* events follow, the closing bracket is optional for the viewers */
+	if (config->output_format == OUTPUT_TIMELINE)
+		fprintf(config->out_fd,
+			"[{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \"DSP\"}}");
+
 	if (config->serial_fd >= 0)
 		/* Wait for CTRL-C */
 		for (;;) {
@@ -613,38 +1100,34 @@ static int logger_read(const struct convert_config *config,
 				return ret;
 		}
 
-	while (!ferror(config->in_fd)) {
-		/* getting entry parameters from dma dump */
-		ret = fread(&dma_log, sizeof(dma_log), 1, config->in_fd);
-		if (!ret) {
-			if (config->trace && !ferror(config->in_fd)) {
-				freopen(NULL, "r", config->in_fd);
-				continue;
-			}
+	reader.fd = config->in_fd;
+	reader.follow = config->trace;
+	reader.head = 0;
+	reader.tail = 0;
+	reader.buf = malloc(TRACE_READ_BUF_SIZE);
+	if (!reader.buf) {
+		log_err(config->out_fd,
+			"failed to alloc memory for trace input.\n");
+		return -ENOMEM;
+	}
 
-			return -ferror(config->in_fd);
-		}
+	do {
+		if (config->compact)
+			ret = compact_record_read(config, snd, &reader, stamps,
+						  &last_timestamp);
+		else
+			ret = record_read(config, snd, &reader,
+					  &last_timestamp);
+	} while (!ret);
 
-		/* checking if received trace address is located in
-		 * entry section in elf file.
-		 */
-		if ((dma_log.log_entry_address < snd->base_address) ||
-			dma_log.log_entry_address > snd->base_address + snd->data_length) {
-			/* in case the address is not correct input fd should be
-			 * move forward by one DWORD, not entire struct dma_log
-			 */
-			fseek(config->in_fd, -(sizeof(dma_log) - sizeof(uint32_t)), SEEK_CUR);
-			continue;
-		}
+	if (config->output_format == OUTPUT_TIMELINE)
+		fprintf(config->out_fd, "\n]\n");
 
-		/* fetching entry from elf dump */
-		ret = fetch_entry(config, snd->base_address, snd->data_offset,
-				  &dma_log, &last_timestamp);
-		if (ret)
-			break;
-	}
+	fflush(config->out_fd);
+	free(reader.buf);
 
-	return ret;
+	/* a partial record at the end of input is dropped */
+	return ret == -ENODATA ? 0 : ret;
 }
 
 /* fw verification */
@@ -823,5 +1306,11 @@ int convert(struct convert_config *config)
 	if (config->dump_ldc)
 		return dump_ldc_info(config, &snd);
 
-	return logger_read(config, &snd);
+	ret = ldc_dict_load(config, &snd);
+	if (!ret)
+		ret = logger_read(config, &snd);
+
+	ldc_dict_free(config);
+
+	return ret;
 }
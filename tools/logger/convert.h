@@ -20,6 +20,16 @@
 #define KYEL	"\x1B[33m"
 #define KBLU	"\x1B[34m"
 
+/* how decoded trace entries are written to out_fd */
+enum output_format {
+	OUTPUT_TEXT,	/* formatted table, or less formatted with raw_output */
+	OUTPUT_JSON,	/* one JSON object per line */
+	OUTPUT_BINARY,	/* validated trace records for later decoding */
+	OUTPUT_TIMELINE,	/* Chrome trace / Perfetto JSON of each core */
+};
+
+struct ldc_dict;
+
 struct convert_config {
 	const char *out_file;
 	const char *in_file;
@@ -37,7 +47,10 @@ struct convert_config {
 	int serial_fd;
 	int raw_output;
 	int dump_ldc;
+	enum output_format output_format;
+	int compact;	/* DMA trace has compact records */
 	struct snd_sof_uids_header *uids_dict;
+	struct ldc_dict *ldc_dict;
 };
 
 int convert(struct convert_config *config);
@@ -52,6 +52,14 @@ static void usage(void)
 		"chained log processors\n",
 		APP_NAME);
 	fprintf(stdout, "%s:\t -d\t\t\tDump ldc information\n", APP_NAME);
+	fprintf(stdout, "%s:\t -j\t\t\tOutput one JSON object per entry\n",
+		APP_NAME);
+	fprintf(stdout, "%s:\t -b\t\t\tOutput binary trace records to be "
+		"decoded later with -i\n", APP_NAME);
+	fprintf(stdout, "%s:\t -T\t\t\tOutput timeline in Chrome trace "
+		"JSON for Perfetto\n", APP_NAME);
+	fprintf(stdout, "%s:\t -z\t\t\tDecode compact DMA trace records "
+		"of CONFIG_TRACE_COMPACT\n", APP_NAME);
 	exit(0);
 }
 
@@ -157,8 +165,12 @@ int main(int argc, char *argv[])
 	config.serial_fd = -EINVAL;
 	config.raw_output = 0;
 	config.dump_ldc = 0;
+	config.output_format = OUTPUT_TEXT;
+	config.compact = 0;
+	config.uids_dict = NULL;
+	config.ldc_dict = NULL;
 
-	while ((opt = getopt(argc, argv, "ho:i:l:ps:c:u:tev:rd")) != -1) {
+	while ((opt = getopt(argc, argv, "ho:i:l:ps:c:u:tev:rdjbTz")) != -1) {
 		switch (opt) {
 		case 'o':
 			config.out_file = optarg;
@@ -202,6 +214,18 @@ int main(int argc, char *argv[])
 		case 'd':
 			config.dump_ldc = 1;
 			break;
+		case 'j':
+			config.output_format = OUTPUT_JSON;
+			break;
+		case 'b':
+			config.output_format = OUTPUT_BINARY;
+			break;
+		case 'T':
+			config.output_format = OUTPUT_TIMELINE;
+			break;
+		case 'z':
+			config.compact = 1;
+			break;
 		case 'h':
 		default: /* '?' */
 			usage();
@@ -271,7 +295,8 @@ int main(int argc, char *argv[])
 			goto out;
 		}
 	}
-	if (isatty(fileno(config.out_fd)) != 1)
+	if (isatty(fileno(config.out_fd)) != 1 ||
+	    config.output_format != OUTPUT_TEXT)
 		config.use_colors = 0;
 
 	ret = -convert(&config);
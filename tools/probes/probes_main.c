@@ -9,6 +9,10 @@
  * with extra headers. This app will read the resulting file,
  * strip the headers and create wave files for each extracted buffer.
  *
+ * Data is expected either as separate packets, one for each buffer
+ * update, or as frames aggregating chunks of several buffers behind
+ * one header, when firmware is built with PROBE_EXTRACT_AGGREGATE.
+ *
  * Usage to parse data and create wave files: ./sof-probes -p data.bin
  *
  */
@@ -45,7 +49,9 @@ struct wave_files {
 enum p_state {
 	READY = 0,		/**< At this stage app is looking for a SYNC word */
 	SYNC,			/**< SYNC received, copying data */
-	CHECK			/**< Check crc and save packet if valid */
+	CHECK,			/**< Check crc and save packet if valid */
+	FRAME_SYNC,		/**< Frame SYNC received, copying header */
+	FRAME_CHECK		/**< Frame copied, save its chunks */
 };
 
 static uint32_t sample_rate[] = {
@@ -166,6 +172,12 @@ int validate_data_packet(struct probe_data_packet *data_packet)
 	received_crc = data_packet->checksum;
 	data_packet->checksum = 0;
 	calc_crc = crc32(0, (char *)data_packet, sizeof(*data_packet));
+	if (received_crc == calc_crc)
+		return 0;
+
+	/* firmware may checksum data following the header too */
+	calc_crc = crc32(calc_crc, (char *)data_packet->data,
+			 data_packet->data_size_bytes);
 
 	if (received_crc == calc_crc) {
 		return 0;
@@ -176,11 +188,60 @@ int validate_data_packet(struct probe_data_packet *data_packet)
 	}
 }
 
+int validate_frame_header(struct probe_frame_header *frame)
+{
+	uint32_t received_crc;
+	uint32_t calc_crc;
+
+	received_crc = frame->checksum;
+	frame->checksum = 0;
+	calc_crc = crc32(0, (char *)frame, sizeof(*frame));
+
+	if (received_crc != calc_crc) {
+		fprintf(stderr, "error: frame header not valid: crc32: %d/%d\n",
+			calc_crc, received_crc);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+void parse_frame(struct wave_files *files, struct probe_frame_header *frame)
+{
+	struct probe_chunk_header *chunk;
+	char *ptr = (char *)(frame + 1);
+	char *end = ptr + frame->frame_size;
+	int file;
+
+	/* each chunk holds data of one buffer, padded to 4 bytes */
+	while (ptr + sizeof(*chunk) <= end) {
+		chunk = (struct probe_chunk_header *)ptr;
+		if (chunk->data_size_bytes > end - ptr - sizeof(*chunk)) {
+			fprintf(stderr, "error: chunk of buffer %d exceeds frame\n",
+				chunk->buffer_id);
+			return;
+		}
+
+		file = get_buffer_file(files, chunk->buffer_id);
+		if (file < 0)
+			file = init_wave(files, chunk->buffer_id,
+					 chunk->format);
+
+		fwrite(chunk->data, 1, chunk->data_size_bytes,
+		       files[file].fd);
+		files[file].size += chunk->data_size_bytes;
+
+		ptr += sizeof(*chunk) + ((chunk->data_size_bytes + 3) & ~3);
+	}
+}
+
 void parse_data(char *file_in)
 {
 	FILE *fd_in;
 	struct wave_files files[FILES_LIMIT];
 	struct probe_data_packet *packet;
+	struct probe_frame_header *frame;
+	struct probe_frame_header *new_frame;
 	uint32_t data[DATA_READ_LIMIT];
 	uint32_t total_data_to_copy = 0;
 	uint32_t data_to_copy = 0;
@@ -205,6 +266,14 @@ void parse_data(char *file_in)
 		fclose(fd_in);
 		exit(0);
 	}
+	frame = malloc(PACKET_MAX_SIZE);
+	if (!frame) {
+		fprintf(stderr, "error: allocation failed, err %d\n",
+			errno);
+		free(packet);
+		fclose(fd_in);
+		exit(0);
+	}
 	memset(&data, 0, sizeof(uint32_t) * DATA_READ_LIMIT);
 	memset(&files, 0, sizeof(struct wave_files) * FILES_LIMIT);
 
@@ -213,14 +282,9 @@ void parse_data(char *file_in)
 		i = fread(&data, sizeof(uint32_t), DATA_READ_LIMIT, fd_in);
 		/* processing all loaded bytes */
 		for (j = 0; j < i; j++) {
-			/* SYNC received */
-			if (data[j] == PROBE_EXTRACT_SYNC_WORD) {
-				if (state != READY) {
-					fprintf(stderr, "error: wrong state %d, err %d\n",
-						state, errno);
-					free(packet);
-					exit(0);
-				}
+			/* SYNC received, data may contain sync pattern too */
+			if (state == READY &&
+			    data[j] == PROBE_EXTRACT_SYNC_WORD) {
 				memset(packet, 0, PACKET_MAX_SIZE);
 				/* request to copy full data packet */
 				total_data_to_copy = sizeof(struct probe_data_packet) /
@@ -228,6 +292,15 @@ void parse_data(char *file_in)
 				/* probe_data_packet forced to align 4 */
 				w_ptr = __builtin_assume_aligned((uint32_t *)packet, 4);
 				state = SYNC;
+			} else if (state == READY &&
+				   data[j] == PROBE_EXTRACT_FRAME_SYNC_WORD) {
+				memset(frame, 0, sizeof(*frame));
+				/* request to copy frame header */
+				total_data_to_copy = sizeof(*frame) /
+					sizeof(uint32_t);
+				/* probe_frame_header forced to align 4 */
+				w_ptr = __builtin_assume_aligned((uint32_t *)frame, 4);
+				state = FRAME_SYNC;
 			}
 			/* data copying section */
 			if (total_data_to_copy > 0) {
@@ -284,6 +357,39 @@ void parse_data(char *file_in)
 					}
 					state = READY;
 					break;
+				case FRAME_SYNC:
+					/* FRAME_SYNC -> FRAME_CHECK */
+					/* request to copy all chunks of frame */
+					if (validate_frame_header(frame) < 0 ||
+					    !frame->frame_size) {
+						state = READY;
+						break;
+					}
+					total_data_to_copy = frame->frame_size /
+							     sizeof(uint32_t);
+					if (frame->frame_size > PACKET_MAX_SIZE -
+					    sizeof(*frame)) {
+						new_frame = realloc(frame,
+								    sizeof(*frame) +
+								    frame->frame_size);
+						if (!new_frame) {
+							fprintf(stderr, "error: allocation failed, err %d\n",
+								errno);
+							free(frame);
+							free(packet);
+							fclose(fd_in);
+							exit(1);
+						}
+						frame = new_frame;
+					}
+					w_ptr = __builtin_assume_aligned((uint32_t *)(frame + 1), 4);
+					state = FRAME_CHECK;
+					break;
+				case FRAME_CHECK:
+					/* FRAME_CHECK -> READY */
+					parse_frame(files, frame);
+					state = READY;
+					break;
 				}
 			}
 		}
@@ -291,6 +397,7 @@ void parse_data(char *file_in)
 
 	/* all done, can close files */
 	finalize_wave_files(files);
+	free(frame);
 	free(packet);
 	fclose(fd_in);
 	fprintf(stdout, "%s:\t done\n", APP_NAME);
@@ -32,6 +32,21 @@ void rfree(void *ptr)
 	free(ptr);
 }
 
+void *mem_cache_alloc(struct mem_cache *cache)
+{
+	return malloc(cache->obj_size);
+}
+
+void *mem_cache_zalloc(struct mem_cache *cache)
+{
+	return calloc(cache->obj_size, 1);
+}
+
+void mem_cache_free(struct mem_cache *cache, void *ptr)
+{
+	free(ptr);
+}
+
 void *rballoc_align(uint32_t flags, uint32_t caps, size_t bytes,
 		    uint32_t alignment)
 {
@@ -23,6 +23,28 @@
 #include "testbench/common_test.h"
 #include <tplg_parser/topology.h>
 
+/* shared library look up table */
+struct shared_lib_table lib_table[NUM_WIDGETS_SUPPORTED] = {
+	{"file", "", SOF_COMP_HOST, 0, NULL}, /* File must be first */
+	{"volume", "libsof_volume.so", SOF_COMP_VOLUME, 0, NULL},
+	{"src", "libsof_src.so", SOF_COMP_SRC, 0, NULL},
+	{"asrc", "libsof_asrc.so", SOF_COMP_ASRC, 0, NULL},
+	{"eq-fir", "libsof_eq-fir.so", SOF_COMP_EQ_FIR, 0, NULL},
+	{"eq-iir", "libsof_eq-iir.so", SOF_COMP_EQ_IIR, 0, NULL},
+	{"dcblock", "libsof_dcblock.so", SOF_COMP_DCBLOCK, 0, NULL}
+};
+
+/* main firmware context, shared by the testbench and engine pipelines */
+static struct sof sof;
+
+/* compatible variables, not used */
+intptr_t _comp_init_start, _comp_init_end;
+
+struct sof *sof_get()
+{
+	return &sof;
+}
+
 /* testbench helper functions for pipeline setup and trigger */
 
 int tb_pipeline_setup(struct sof *sof)
@@ -161,6 +183,39 @@ int tb_pipeline_params(struct ipc *ipc, struct sof_ipc_pipe_new *ipc_pipe,
 	return ret;
 }
 
+/* free components, buffers and pipelines with ids in a range */
+void tb_free_comps(struct ipc *ipc, uint32_t first_id, uint32_t last_id)
+{
+	struct list_item *clist;
+	struct list_item *temp;
+	struct ipc_comp_dev *icd = NULL;
+
+	list_for_item_safe(clist, temp, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->id < first_id || icd->id > last_id)
+			continue;
+
+		switch (icd->type) {
+		case COMP_TYPE_COMPONENT:
+			comp_free(icd->cd);
+			list_item_del(&icd->list);
+			rfree(icd);
+			break;
+		case COMP_TYPE_BUFFER:
+			rfree(icd->cb->stream.addr);
+			rfree(icd->cb);
+			list_item_del(&icd->list);
+			rfree(icd);
+			break;
+		default:
+			rfree(icd->pipeline);
+			list_item_del(&icd->list);
+			rfree(icd);
+			break;
+		}
+	}
+}
+
 /* getindex of shared library from table */
 int get_index_by_name(char *comp_type, struct shared_lib_table *lib_table)
 {
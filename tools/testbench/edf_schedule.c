@@ -10,6 +10,7 @@
 #include <sof/schedule/edf_schedule.h>
 #include <sof/lib/wait.h>
 #include <stdlib.h>
+#include <pthread.h>
 
  /* scheduler testbench definition */
 
@@ -22,9 +23,14 @@ struct scheduler_ops schedule_edf_ops;
 
 static struct edf_schedule_data *sch;
 
+/* pipelines can be run from several testbench threads */
+static pthread_mutex_t sch_lock = PTHREAD_MUTEX_INITIALIZER;
+
 static void schedule_edf_task_complete(struct task *task)
 {
+	pthread_mutex_lock(&sch_lock);
 	list_item_del(&task->list);
+	pthread_mutex_unlock(&sch_lock);
 	task->state = SOF_TASK_STATE_COMPLETED;
 }
 
@@ -34,7 +40,9 @@ static void schedule_edf_task(void *data, struct task *task, uint64_t start,
 {
 	struct edf_schedule_data *sch = data;
 	(void)period;
+	pthread_mutex_lock(&sch_lock);
 	list_item_prepend(&task->list, &sch->list);
+	pthread_mutex_unlock(&sch_lock);
 	task->state = SOF_TASK_STATE_QUEUED;
 
 	if (task->ops.run)
@@ -90,7 +98,9 @@ static void schedule_edf_task_cancel(void *data, struct task *task)
 	if (task->state == SOF_TASK_STATE_QUEUED) {
 		/* delete task */
 		task->state = SOF_TASK_STATE_CANCEL;
+		pthread_mutex_lock(&sch_lock);
 		list_item_del(&task->list);
+		pthread_mutex_unlock(&sch_lock);
 	}
 }
 
@@ -0,0 +1,305 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Pipeline engine library, topologies processing streams of an application */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sof/drivers/ipc.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include "testbench/common_test.h"
+#include <tplg_parser/topology.h>
+#include "testbench/engine.h"
+#include "testbench/file.h"
+#include "testbench/ring.h"
+#include "testbench/trace.h"
+
+#define TB_ENGINE_RING_PERIODS	4
+#define TB_ENGINE_NAME_LEN	32
+
+struct tb_engine {
+	struct testbench_prm tp;
+	char pipeline[DEBUG_MSG_LEN];
+	struct pipeline *p;
+	struct comp_dev *cd;
+	struct file_comp_data *frcd;
+	struct file_comp_data *fwcd;
+	struct tb_ring *in;
+	struct tb_ring *out;
+	uint32_t frame_bytes;
+	uint32_t period_ns;
+
+	/* ids of the components, buffers and pipelines of the topology */
+	uint32_t first_id;
+	uint32_t last_id;
+
+	int rt_priority;
+	pthread_t thread;
+	atomic_bool running;
+};
+
+/* the firmware context and topology parser are shared by all engines */
+static pthread_mutex_t engine_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool engine_ready;
+static uint32_t engine_count;
+
+static uint32_t tb_engine_max_id(void)
+{
+	struct list_item *clist;
+	uint32_t id = 0;
+
+	list_for_item(clist, &sof_get()->ipc->comp_list)
+		id = MAX(id, container_of(clist, struct ipc_comp_dev,
+					  list)->id);
+
+	return id;
+}
+
+/* ring of a stream holding the given number of its periods */
+static int tb_engine_ring_alloc(struct tb_engine *engine,
+				struct tb_ring *ring, uint32_t rate,
+				uint32_t periods)
+{
+	uint32_t frames = (uint64_t)rate * engine->p->ipc_pipe.period /
+		1000000 + 1;
+
+	return tb_ring_alloc(ring, (size_t)periods * frames *
+			     engine->frame_bytes);
+}
+
+/* loads the topology with its endpoints reading and writing the rings */
+static int tb_engine_load(struct tb_engine *engine,
+			  const struct tb_engine_config *config)
+{
+	struct testbench_prm *tp = &engine->tp;
+	struct ipc *ipc = sof_get()->ipc;
+	struct ipc_comp_dev *pcm_dev;
+	struct sof_ipc_pipe_new *ipc_pipe;
+	uint32_t periods = config->ring_periods ? config->ring_periods :
+		TB_ENGINE_RING_PERIODS;
+	int ret;
+
+	engine->first_id = tb_engine_max_id() + 1;
+
+	ret = parse_topology(sof_get(), lib_table, tp, engine->pipeline);
+	engine->last_id = tb_engine_max_id();
+	if (ret < 0) {
+		fprintf(stderr, "error: parsing topology %s\n", tp->tplg_file);
+		return -EINVAL;
+	}
+
+	pcm_dev = ipc_get_comp_by_id(ipc, tp->fw_id);
+	engine->fwcd = comp_get_drvdata(pcm_dev->cd);
+	pcm_dev = ipc_get_comp_by_id(ipc, tp->fr_id);
+	engine->frcd = comp_get_drvdata(pcm_dev->cd);
+
+	pcm_dev = ipc_get_comp_by_id(ipc, tp->sched_id);
+	engine->cd = pcm_dev->cd;
+	engine->p = pcm_dev->cd->pipeline;
+	ipc_pipe = &engine->p->ipc_pipe;
+
+	if (!tp->fs_in)
+		tp->fs_in = ipc_pipe->period * ipc_pipe->frames_per_sched;
+
+	if (!tp->fs_out)
+		tp->fs_out = ipc_pipe->period * ipc_pipe->frames_per_sched;
+
+	engine->period_ns = ipc_pipe->period * 1000;
+	engine->frame_bytes = tp->channels *
+		(tp->frame_fmt == SOF_IPC_FRAME_S16_LE ? 2 : 4);
+
+	if (tb_engine_ring_alloc(engine, engine->in, tp->fs_in, periods) < 0 ||
+	    tb_engine_ring_alloc(engine, engine->out, tp->fs_out, periods) < 0)
+		return -ENOMEM;
+
+	return tb_pipeline_start(ipc, ipc_pipe, tp);
+}
+
+struct tb_engine *tb_engine_new(const char *tplg_file,
+				const struct tb_engine_config *config)
+{
+	char name[TB_ENGINE_NAME_LEN];
+	struct tb_engine *engine;
+	int ret = 0;
+
+	if (!config->channels)
+		return NULL;
+
+	engine = calloc(1, sizeof(*engine));
+	if (!engine)
+		return NULL;
+
+	engine->tp.tplg_file = strdup(tplg_file);
+	engine->tp.fs_in = config->rate;
+	engine->tp.fs_out = config->rate;
+	engine->tp.channels = config->channels;
+	engine->tp.frame_fmt = config->frame_fmt;
+	engine->rt_priority = config->rt_priority;
+	atomic_init(&engine->running, false);
+
+	pthread_mutex_lock(&engine_lock);
+
+	if (!engine_ready) {
+		tb_enable_trace(false);
+		ret = tb_pipeline_setup(sof_get());
+		engine_ready = !ret;
+	}
+
+	/* file components of the topology find the rings by name */
+	snprintf(name, sizeof(name), TB_RING_PREFIX "in%u", engine_count);
+	engine->in = tb_ring_new(name);
+	snprintf(name, sizeof(name), TB_RING_PREFIX "out%u", engine_count);
+	engine->out = tb_ring_new(name);
+	engine_count++;
+
+	if (!ret && engine->tp.tplg_file && engine->in && engine->out) {
+		engine->tp.input_file = engine->in->name;
+		engine->tp.output_file = engine->out->name;
+		ret = tb_engine_load(engine, config);
+	} else {
+		ret = -ENOMEM;
+	}
+
+	pthread_mutex_unlock(&engine_lock);
+
+	if (ret < 0) {
+		tb_engine_free(engine);
+		return NULL;
+	}
+
+	return engine;
+}
+
+void tb_engine_free(struct tb_engine *engine)
+{
+	tb_engine_stop(engine);
+
+	pthread_mutex_lock(&engine_lock);
+
+	if (engine->p) {
+		pipeline_trigger(engine->p, engine->cd, COMP_TRIGGER_STOP);
+		pipeline_reset(engine->p, engine->cd);
+	}
+
+	if (engine->last_id)
+		tb_free_comps(sof_get()->ipc, engine->first_id,
+			      engine->last_id);
+
+	pthread_mutex_unlock(&engine_lock);
+
+	if (engine->in)
+		tb_ring_free(engine->in);
+	if (engine->out)
+		tb_ring_free(engine->out);
+	free(engine->tp.tplg_file);
+	free(engine);
+}
+
+void tb_engine_process(struct tb_engine *engine)
+{
+	pipeline_schedule_copy(engine->p, 0);
+}
+
+/* copies the pipeline on period boundaries of the monotonic clock */
+static void *tb_engine_ll(void *arg)
+{
+	struct tb_engine *engine = arg;
+	struct timespec next;
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	while (atomic_load_explicit(&engine->running, memory_order_relaxed)) {
+		tb_engine_process(engine);
+
+		next.tv_nsec += engine->period_ns;
+		while (next.tv_nsec >= 1000000000) {
+			next.tv_nsec -= 1000000000;
+			next.tv_sec++;
+		}
+
+		/* a late period is not caught up with a burst of copies */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (now.tv_sec > next.tv_sec ||
+		    (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec))
+			next = now;
+
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+	}
+
+	return NULL;
+}
+
+int tb_engine_start(struct tb_engine *engine)
+{
+	struct sched_param param = {
+		.sched_priority = engine->rt_priority,
+	};
+	pthread_attr_t attr;
+	int ret = EPERM;
+
+	if (atomic_load(&engine->running))
+		return -EBUSY;
+
+	atomic_store(&engine->running, true);
+
+	if (engine->rt_priority > 0) {
+		pthread_attr_init(&attr);
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &param);
+		ret = pthread_create(&engine->thread, &attr, tb_engine_ll,
+				     engine);
+		pthread_attr_destroy(&attr);
+	}
+
+	/* default policy without priority or permission for SCHED_FIFO */
+	if (ret == EPERM) {
+		if (engine->rt_priority > 0)
+			fprintf(stderr, "warning: no permission for SCHED_FIFO, LL thread runs with default policy\n");
+		ret = pthread_create(&engine->thread, NULL, tb_engine_ll,
+				     engine);
+	}
+
+	if (ret) {
+		atomic_store(&engine->running, false);
+		return -ret;
+	}
+
+	return 0;
+}
+
+void tb_engine_stop(struct tb_engine *engine)
+{
+	if (!atomic_exchange(&engine->running, false))
+		return;
+
+	pthread_join(engine->thread, NULL);
+}
+
+size_t tb_engine_push(struct tb_engine *engine, const void *data,
+		      size_t bytes)
+{
+	return tb_ring_write(engine->in, data,
+			     bytes - bytes % engine->frame_bytes);
+}
+
+size_t tb_engine_pull(struct tb_engine *engine, void *data, size_t bytes)
+{
+	return tb_ring_read(engine->out, data,
+			    bytes - bytes % engine->frame_bytes);
+}
+
+uint32_t tb_engine_xruns(struct tb_engine *engine)
+{
+	return engine->frcd->fs.xruns + engine->fwcd->fs.xruns;
+}
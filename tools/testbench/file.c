@@ -5,10 +5,14 @@
 /* file component for reading/writing pcm samples to/from a file */
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sof/sof.h>
 #include <sof/list.h>
 #include <sof/audio/stream.h>
@@ -20,6 +24,7 @@
 #include <ipc/stream.h>
 #include "testbench/common_test.h"
 #include "testbench/file.h"
+#include "testbench/wave.h"
 
 static const struct comp_driver comp_file_dai;
 static const struct comp_driver comp_file_host;
@@ -40,7 +45,7 @@ static inline void buffer_check_wrap_16(int16_t **ptr, int16_t *end,
 
 /*
  * Read 32-bit samples from file
- * currently only supports txt files
+ * text files only, raw and wav files are read in spans
  */
 static int read_samples_32(struct comp_dev *dev,
 			   const struct audio_stream *sink,
@@ -67,46 +72,19 @@ static int read_samples_32(struct comp_dev *dev,
 			/* copy sample per channel */
 			for (i = 0; i < nch; i++) {
 				/* read sample from file */
-				switch (cd->fs.f_format) {
-				/* text input file */
-				case FILE_TEXT:
-					if (fmt == SOF_IPC_FRAME_S32_LE)
-						ret = fscanf(cd->fs.rfh, "%d",
-							     dest);
-
-					/* mask bits if 24-bit samples */
-					if (fmt == SOF_IPC_FRAME_S24_4LE) {
-						ret = fscanf(cd->fs.rfh, "%d",
-							     &sample);
-						*dest = sample & 0x00ffffff;
-					}
-					/* quit if eof is reached */
-					if (ret == EOF) {
-						cd->fs.reached_eof = 1;
-						goto quit;
-					}
-					break;
-
-				/* raw input file */
-				default:
-					if (fmt == SOF_IPC_FRAME_S32_LE)
-						ret = fread(dest,
-							    sizeof(int32_t),
-							    1, cd->fs.rfh);
-
-					/* mask bits if 24-bit samples */
-					if (fmt == SOF_IPC_FRAME_S24_4LE) {
-						ret = fread(&sample,
-							    sizeof(int32_t),
-							    1, cd->fs.rfh);
-						*dest = sample & 0x00ffffff;
-					}
-					/* quit if eof is reached */
-					if (ret != 1) {
-						cd->fs.reached_eof = 1;
-						goto quit;
-					}
-					break;
+				if (fmt == SOF_IPC_FRAME_S32_LE)
+					ret = fscanf(cd->fs.rfh, "%d", dest);
+
+				/* mask bits if 24-bit samples */
+				if (fmt == SOF_IPC_FRAME_S24_4LE) {
+					ret = fscanf(cd->fs.rfh, "%d",
+						     &sample);
+					*dest = sample & 0x00ffffff;
+				}
+				/* quit if eof is reached */
+				if (ret == EOF) {
+					cd->fs.reached_eof = 1;
+					goto quit;
 				}
 				dest++;
 				n_samples++;
@@ -122,7 +100,7 @@ quit:
 
 /*
  * Read 16-bit samples from file
- * currently only supports txt files
+ * text files only, raw and wav files are read in spans
  */
 static int read_samples_16(struct comp_dev *dev,
 			   const struct audio_stream *sink,
@@ -145,25 +123,10 @@ static int read_samples_16(struct comp_dev *dev,
 
 			/* copy sample per channel */
 			for (i = 0; i < nch; i++) {
-				switch (cd->fs.f_format) {
-				/* text input file */
-				case FILE_TEXT:
-					ret = fscanf(cd->fs.rfh, "%hd", dest);
-					if (ret == EOF) {
-						cd->fs.reached_eof = 1;
-						goto quit;
-					}
-					break;
-
-				/* rw pcm input file */
-				default:
-					ret = fread(dest, sizeof(int16_t), 1,
-						    cd->fs.rfh);
-					if (ret != 1) {
-						cd->fs.reached_eof = 1;
-						goto quit;
-					}
-					break;
+				ret = fscanf(cd->fs.rfh, "%hd", dest);
+				if (ret == EOF) {
+					cd->fs.reached_eof = 1;
+					goto quit;
 				}
 
 				dest++;
@@ -181,7 +144,7 @@ quit:
 
 /*
  * Write 16-bit samples from file
- * currently only supports txt files
+ * text files only, raw and wav files are written in spans
  */
 static int write_samples_16(struct comp_dev *dev, struct audio_stream *source,
 			    int n, int nch)
@@ -203,24 +166,9 @@ static int write_samples_16(struct comp_dev *dev, struct audio_stream *source,
 
 			/* copy sample per channel */
 			for (i = 0; i < nch; i++) {
-				switch (cd->fs.f_format) {
-				/* text output file */
-				case FILE_TEXT:
-					ret = fprintf(cd->fs.wfh,
-						      "%d\n", *src);
-					if (ret < 0)
-						goto quit;
-					break;
-
-				/* raw pcm output file */
-				default:
-					ret = fwrite(src,
-						     sizeof(int16_t),
-						     1, cd->fs.wfh);
-					if (ret != 1)
-						goto quit;
-					break;
-				}
+				ret = fprintf(cd->fs.wfh, "%d\n", *src);
+				if (ret < 0)
+					goto quit;
 
 				src++;
 				n_samples++;
@@ -236,7 +184,7 @@ quit:
 
 /*
  * Write 32-bit samples from file
- * currently only supports txt files
+ * text files only, raw and wav files are written in spans
  */
 static int write_samples_32(struct comp_dev *dev, struct audio_stream *source,
 			    int n, int fmt, int nch)
@@ -259,39 +207,16 @@ static int write_samples_32(struct comp_dev *dev, struct audio_stream *source,
 
 			/* copy sample per channel */
 			for (i = 0; i < nch; i++) {
-				switch (cd->fs.f_format) {
-				/* text output file */
-				case FILE_TEXT:
-					if (fmt == SOF_IPC_FRAME_S32_LE)
-						ret = fprintf(cd->fs.wfh,
-							      "%d\n", *src);
-					if (fmt == SOF_IPC_FRAME_S24_4LE) {
-						sample = *src << 8;
-						ret = fprintf(cd->fs.wfh,
-							      "%d\n",
-							      sample >> 8);
-					}
-					if (ret < 0)
-						goto quit;
-					break;
-
-				/* raw pcm output file */
-				default:
-					if (fmt == SOF_IPC_FRAME_S32_LE)
-						ret = fwrite(src,
-							     sizeof(int32_t),
-							     1, cd->fs.wfh);
-					if (fmt == SOF_IPC_FRAME_S24_4LE) {
-						sample = *src << 8;
-						sample >>= 8;
-						ret = fwrite(&sample,
-							     sizeof(int32_t),
-							     1, cd->fs.wfh);
-					}
-					if (ret != 1)
-						goto quit;
-					break;
+				if (fmt == SOF_IPC_FRAME_S32_LE)
+					ret = fprintf(cd->fs.wfh, "%d\n",
+						      *src);
+				if (fmt == SOF_IPC_FRAME_S24_4LE) {
+					sample = *src << 8;
+					ret = fprintf(cd->fs.wfh, "%d\n",
+						      sample >> 8);
 				}
+				if (ret < 0)
+					goto quit;
 
 				/* increment read pointer */
 				src++;
@@ -308,6 +233,115 @@ quit:
 	return n_samples;
 }
 
+/*
+ * Copy samples from the mapped input file to the sink in contiguous spans.
+ * 24-bit samples are masked like in text files, and wav files store them
+ * left justified in 32-bit containers.
+ */
+static int read_samples_span(struct comp_dev *dev,
+			     const struct audio_stream *sink,
+			     int n, int fmt, int nch)
+{
+	struct file_comp_data *cd = comp_get_drvdata(dev);
+	uint32_t sample_bytes = audio_stream_sample_bytes(sink);
+	uint32_t frame_bytes = sample_bytes * nch;
+	size_t avail = cd->fs.rend - cd->fs.rpos;
+	size_t bytes = (size_t)n * sample_bytes;
+	uint8_t *dest = sink->w_ptr;
+	int shift = cd->fs.f_format == FILE_WAV ? 8 : 0;
+	int32_t *s;
+	size_t span;
+	size_t i;
+
+	/* same as in text files eof is reached on the first failed read */
+	if (avail < frame_bytes) {
+		cd->fs.reached_eof = 1;
+		return 0;
+	}
+
+	if (bytes > avail)
+		bytes = avail - avail % frame_bytes;
+
+	n = bytes / sample_bytes;
+
+	while (bytes) {
+		span = MIN(bytes, (size_t)((uint8_t *)sink->end_addr - dest));
+		memcpy(dest, cd->fs.map + cd->fs.rpos, span);
+
+		if (fmt == SOF_IPC_FRAME_S24_4LE) {
+			s = (int32_t *)dest;
+			for (i = 0; i < span / sizeof(*s); i++)
+				s[i] = (s[i] >> shift) & 0x00ffffff;
+		}
+
+		cd->fs.rpos += span;
+		bytes -= span;
+		dest = audio_stream_wrap(sink, dest + span);
+	}
+
+	return n;
+}
+
+/* writes 24-bit samples sign extended or left justified for wav */
+static size_t write_s24_span(struct file_comp_data *cd, int32_t *src,
+			     size_t samples)
+{
+	int32_t tmp[256];
+	size_t written = 0;
+	size_t count;
+	size_t i;
+
+	while (written < samples) {
+		count = MIN(samples - written, ARRAY_SIZE(tmp));
+		for (i = 0; i < count; i++) {
+			tmp[i] = src[written + i] << 8;
+			if (cd->fs.f_format != FILE_WAV)
+				tmp[i] >>= 8;
+		}
+
+		i = fwrite(tmp, sizeof(*tmp), count, cd->fs.wfh);
+		written += i;
+		if (i != count)
+			break;
+	}
+
+	return written;
+}
+
+/* Write samples from the source to the output file in contiguous spans */
+static int write_samples_span(struct comp_dev *dev,
+			      struct audio_stream *source, int n, int fmt)
+{
+	struct file_comp_data *cd = comp_get_drvdata(dev);
+	uint32_t sample_bytes = audio_stream_sample_bytes(source);
+	uint8_t *src = source->r_ptr;
+	size_t samples = n;
+	size_t written = 0;
+	size_t span;
+	size_t ret;
+
+	while (written < samples) {
+		span = MIN(samples - written,
+			   (size_t)((uint8_t *)source->end_addr - src) /
+			   sample_bytes);
+
+		if (fmt == SOF_IPC_FRAME_S24_4LE)
+			ret = write_s24_span(cd, (int32_t *)src, span);
+		else
+			ret = fwrite(src, sample_bytes, span, cd->fs.wfh);
+
+		written += ret;
+		if (ret != span)
+			break;
+
+		src = audio_stream_wrap(source, src + span * sample_bytes);
+	}
+
+	cd->fs.wbytes += written * sample_bytes;
+
+	return written;
+}
+
 /* function for processing 32-bit samples */
 static int file_s32_default(struct comp_dev *dev, struct audio_stream *sink,
 			    struct audio_stream *source, uint32_t frames)
@@ -320,14 +354,24 @@ static int file_s32_default(struct comp_dev *dev, struct audio_stream *sink,
 	case FILE_READ:
 		/* read samples */
 		nch = sink->channels;
-		n_samples = read_samples_32(dev, sink, frames * nch,
-					    SOF_IPC_FRAME_S32_LE, nch);
+		if (cd->fs.f_format == FILE_TEXT)
+			n_samples = read_samples_32(dev, sink, frames * nch,
+						    SOF_IPC_FRAME_S32_LE, nch);
+		else
+			n_samples = read_samples_span(dev, sink, frames * nch,
+						      SOF_IPC_FRAME_S32_LE,
+						      nch);
 		break;
 	case FILE_WRITE:
 		/* write samples */
 		nch = source->channels;
-		n_samples = write_samples_32(dev, source, frames * nch,
-					     SOF_IPC_FRAME_S32_LE, nch);
+		if (cd->fs.f_format == FILE_TEXT)
+			n_samples = write_samples_32(dev, source, frames * nch,
+						     SOF_IPC_FRAME_S32_LE, nch);
+		else
+			n_samples = write_samples_span(dev, source,
+						       frames * nch,
+						       SOF_IPC_FRAME_S32_LE);
 		break;
 	default:
 		/* TODO: duplex mode */
@@ -350,12 +394,24 @@ static int file_s16(struct comp_dev *dev, struct audio_stream *sink,
 	case FILE_READ:
 		/* read samples */
 		nch = sink->channels;
-		n_samples = read_samples_16(dev, sink, frames * nch, nch);
+		if (cd->fs.f_format == FILE_TEXT)
+			n_samples = read_samples_16(dev, sink, frames * nch,
+						    nch);
+		else
+			n_samples = read_samples_span(dev, sink, frames * nch,
+						      SOF_IPC_FRAME_S16_LE,
+						      nch);
 		break;
 	case FILE_WRITE:
 		/* write samples */
 		nch = source->channels;
-		n_samples = write_samples_16(dev, source, frames * nch, nch);
+		if (cd->fs.f_format == FILE_TEXT)
+			n_samples = write_samples_16(dev, source, frames * nch,
+						     nch);
+		else
+			n_samples = write_samples_span(dev, source,
+						       frames * nch,
+						       SOF_IPC_FRAME_S16_LE);
 		break;
 	default:
 		/* TODO: duplex mode */
@@ -378,14 +434,26 @@ static int file_s24(struct comp_dev *dev, struct audio_stream *sink,
 	case FILE_READ:
 		/* read samples */
 		nch = sink->channels;
-		n_samples = read_samples_32(dev, sink, frames * nch,
-					    SOF_IPC_FRAME_S24_4LE, nch);
+		if (cd->fs.f_format == FILE_TEXT)
+			n_samples = read_samples_32(dev, sink, frames * nch,
+						    SOF_IPC_FRAME_S24_4LE,
+						    nch);
+		else
+			n_samples = read_samples_span(dev, sink, frames * nch,
+						      SOF_IPC_FRAME_S24_4LE,
+						      nch);
 		break;
 	case FILE_WRITE:
 		/* write samples */
 		nch = source->channels;
-		n_samples = write_samples_32(dev, source, frames * nch,
-					     SOF_IPC_FRAME_S24_4LE, nch);
+		if (cd->fs.f_format == FILE_TEXT)
+			n_samples = write_samples_32(dev, source, frames * nch,
+						     SOF_IPC_FRAME_S24_4LE,
+						     nch);
+		else
+			n_samples = write_samples_span(dev, source,
+						       frames * nch,
+						       SOF_IPC_FRAME_S24_4LE);
 		break;
 	default:
 		/* TODO: duplex mode */
@@ -400,12 +468,135 @@ static enum file_format get_file_format(char *filename)
 {
 	char *ext = strrchr(filename, '.');
 
-	if (!strcmp(ext, ".txt"))
+	if (!strncmp(filename, TB_RING_PREFIX, strlen(TB_RING_PREFIX)))
+		return FILE_RING;
+
+	if (ext && !strcmp(ext, ".txt"))
 		return FILE_TEXT;
 
+	if (ext && !strcmp(ext, ".wav"))
+		return FILE_WAV;
+
 	return FILE_RAW;
 }
 
+/* finds the format and sample data of a mapped wav file */
+static int file_parse_wav(struct file_state *fs)
+{
+	struct riff_chunk *riff = (struct riff_chunk *)fs->map;
+	struct chunk_header *chunk;
+	struct fmt_subchunk *fmt = NULL;
+	size_t pos = sizeof(*riff);
+
+	if (fs->map_size < sizeof(*riff) || riff->chunk_id != HEADER_RIFF ||
+	    riff->format != HEADER_WAVE)
+		return -EINVAL;
+
+	while (pos + sizeof(*chunk) <= fs->map_size) {
+		chunk = (struct chunk_header *)(fs->map + pos);
+
+		switch (chunk->chunk_id) {
+		case HEADER_FMT:
+			if (pos + sizeof(*fmt) > fs->map_size)
+				return -EINVAL;
+			fmt = (struct fmt_subchunk *)chunk;
+			break;
+		case HEADER_DATA:
+			if (!fmt)
+				return -EINVAL;
+
+			if (fmt->audio_format != WAVE_FORMAT_PCM &&
+			    fmt->audio_format != WAVE_FORMAT_EXTENSIBLE)
+				return -EINVAL;
+
+			fs->wav_rate = fmt->sample_rate;
+			fs->wav_channels = fmt->num_channels;
+			fs->wav_sample_bytes = fmt->num_channels ?
+				fmt->block_align / fmt->num_channels : 0;
+
+			fs->rpos = pos + sizeof(*chunk);
+			fs->rend = MIN(fs->rpos + chunk->chunk_size,
+				       fs->map_size);
+			return 0;
+		default:
+			break;
+		}
+
+		/* chunks are word aligned */
+		pos += sizeof(*chunk) + chunk->chunk_size +
+			(chunk->chunk_size & 1);
+	}
+
+	return -EINVAL;
+}
+
+/* maps raw or wav input file so samples can be copied in spans */
+static int file_map_input(struct file_state *fs)
+{
+	struct stat st;
+	int fd = fileno(fs->rfh);
+
+	if (fstat(fd, &st) < 0)
+		return -errno;
+
+	fs->map_size = st.st_size;
+	fs->rpos = 0;
+	fs->rend = fs->map_size;
+
+	/* empty file is at eof already */
+	if (!fs->map_size)
+		return fs->f_format == FILE_WAV ? -EINVAL : 0;
+
+	fs->map = mmap(NULL, fs->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (fs->map == MAP_FAILED) {
+		fs->map = NULL;
+		return -errno;
+	}
+
+	/* whole file is going to be read sequentially */
+	madvise(fs->map, fs->map_size, MADV_SEQUENTIAL);
+
+	if (fs->f_format == FILE_WAV)
+		return file_parse_wav(fs);
+
+	return 0;
+}
+
+/* Writes wav header for the samples written so far. Header is written
+ * in prepare and updated with the data size when the file is closed.
+ * 24-bit samples are stored left justified in 32-bit containers.
+ */
+static int file_write_wav_header(struct file_comp_data *cd)
+{
+	struct wave header;
+	long pos = ftell(cd->fs.wfh);
+
+	memset(&header, 0, sizeof(header));
+	header.riff.chunk_id = HEADER_RIFF;
+	header.riff.chunk_size = sizeof(header) - 8 + cd->fs.wbytes;
+	header.riff.format = HEADER_WAVE;
+	header.fmt.subchunk_id = HEADER_FMT;
+	header.fmt.subchunk_size = 16;
+	header.fmt.audio_format = WAVE_FORMAT_PCM;
+	header.fmt.num_channels = cd->channels;
+	header.fmt.sample_rate = cd->rate;
+	header.fmt.bits_per_sample = cd->sample_container_bytes * 8;
+	header.fmt.block_align = cd->channels * cd->sample_container_bytes;
+	header.fmt.byte_rate = cd->rate * header.fmt.block_align;
+	header.data.subchunk_id = HEADER_DATA;
+	header.data.subchunk_size = cd->fs.wbytes;
+
+	if (fseek(cd->fs.wfh, 0, SEEK_SET) < 0 ||
+	    fwrite(&header, sizeof(header), 1, cd->fs.wfh) != 1)
+		return -EIO;
+
+	/* header placeholder leaves position after it */
+	if (pos > (long)sizeof(header))
+		fseek(cd->fs.wfh, pos, SEEK_SET);
+
+	return 0;
+}
+
 static struct comp_dev *file_new(const struct comp_driver *drv,
 				 struct sof_ipc_comp *comp)
 {
@@ -457,6 +648,21 @@ static struct comp_dev *file_new(const struct comp_driver *drv,
 	cd->channels = ipc_file->channels;
 	cd->frame_fmt = ipc_file->frame_fmt;
 
+	/* engine endpoints exchange samples with the application */
+	if (cd->fs.f_format == FILE_RING) {
+		cd->fs.ring = tb_ring_find(cd->fs.fn);
+		if (!cd->fs.ring) {
+			fprintf(stderr, "error: no ring %s\n", cd->fs.fn);
+			free(cd->fs.fn);
+			free(cd);
+			free(dev);
+			return NULL;
+		}
+
+		dev->state = COMP_STATE_READY;
+		return dev;
+	}
+
 	/* open file handle(s) depending on mode */
 	switch (cd->fs.mode) {
 	case FILE_READ:
@@ -467,6 +673,17 @@ static struct comp_dev *file_new(const struct comp_driver *drv,
 			free(dev);
 			return NULL;
 		}
+
+		if (cd->fs.f_format != FILE_TEXT &&
+		    file_map_input(&cd->fs) < 0) {
+			fprintf(stderr, "error: mapping file %s\n", cd->fs.fn);
+			if (cd->fs.map)
+				munmap(cd->fs.map, cd->fs.map_size);
+			fclose(cd->fs.rfh);
+			free(cd);
+			free(dev);
+			return NULL;
+		}
 		break;
 	case FILE_WRITE:
 		cd->fs.wfh = fopen(cd->fs.fn, "w");
@@ -496,10 +713,18 @@ static void file_free(struct comp_dev *dev)
 
 	comp_dbg(dev, "file_free()");
 
-	if (cd->fs.mode == FILE_READ)
+	if (cd->fs.f_format == FILE_RING) {
+		/* the ring belongs to the engine */
+	} else if (cd->fs.mode == FILE_READ) {
+		if (cd->fs.map)
+			munmap(cd->fs.map, cd->fs.map_size);
 		fclose(cd->fs.rfh);
-	else
+	} else {
+		if (cd->fs.f_format == FILE_WAV &&
+		    file_write_wav_header(cd) < 0)
+			fprintf(stderr, "error: wav header %s\n", cd->fs.fn);
 		fclose(cd->fs.wfh);
+	}
 
 	free(cd->fs.fn);
 	free(cd);
@@ -580,6 +805,62 @@ static int file_cmd(struct comp_dev *dev, int cmd, void *data,
  * copy and process stream samples
  * returns the number of bytes copied
  */
+/*
+ * Copies a period from the ring of an engine input or all available data to
+ * the ring of an output. Input missing from the ring is replaced by silence
+ * and output not fitting in it is dropped, so the pipeline keeps its timing
+ * like with a real device. The ring carries the samples of the stream as is.
+ */
+static int file_ring_copy(struct comp_dev *dev, struct comp_buffer *buffer)
+{
+	struct file_comp_data *cd = comp_get_drvdata(dev);
+	struct audio_stream *stream = &buffer->stream;
+	uint32_t frame_bytes = audio_stream_frame_bytes(stream);
+	uint32_t bytes;
+	uint32_t left;
+	uint8_t *ptr;
+	size_t span;
+	size_t done;
+	bool xrun = false;
+
+	if (cd->fs.mode == FILE_READ) {
+		bytes = MIN(dev->frames, stream->free / frame_bytes) *
+			frame_bytes;
+		ptr = stream->w_ptr;
+	} else {
+		bytes = stream->avail - stream->avail % frame_bytes;
+		ptr = stream->r_ptr;
+	}
+
+	for (left = bytes; left; left -= span) {
+		span = MIN(left, (size_t)((uint8_t *)stream->end_addr - ptr));
+		if (cd->fs.mode == FILE_READ) {
+			done = tb_ring_read(cd->fs.ring, ptr, span);
+			memset(ptr + done, 0, span - done);
+		} else {
+			done = tb_ring_write(cd->fs.ring, ptr, span);
+		}
+
+		xrun |= done < span;
+		ptr = audio_stream_wrap(stream, ptr + span);
+	}
+
+	if (xrun)
+		cd->fs.xruns++;
+
+	if (!bytes)
+		return 0;
+
+	if (cd->fs.mode == FILE_READ)
+		comp_update_buffer_produce(buffer, bytes);
+	else
+		comp_update_buffer_consume(buffer, bytes);
+
+	cd->fs.n += bytes / cd->sample_container_bytes;
+
+	return bytes / cd->sample_container_bytes;
+}
+
 static int file_copy(struct comp_dev *dev)
 {
 	struct comp_buffer *buffer;
@@ -589,6 +870,18 @@ static int file_copy(struct comp_dev *dev)
 	int bytes = cd->sample_container_bytes;
 	int ret = 0;
 
+	if (cd->fs.f_format == FILE_RING) {
+		if (cd->fs.mode == FILE_READ)
+			buffer = list_first_item(&dev->bsink_list,
+						 struct comp_buffer,
+						 source_list);
+		else
+			buffer = list_first_item(&dev->bsource_list,
+						 struct comp_buffer, sink_list);
+
+		return file_ring_copy(dev, buffer);
+	}
+
 	switch (cd->fs.mode) {
 	case FILE_READ:
 		/* file component sink buffer */
@@ -668,6 +961,30 @@ static int file_prepare(struct comp_dev *dev)
 	else
 		cd->sample_container_bytes = 4;
 
+	/* wav samples are copied as is so formats must match */
+	if (cd->fs.f_format == FILE_WAV) {
+		if (cd->fs.mode == FILE_WRITE) {
+			cd->fs.wbytes = 0;
+			ret = file_write_wav_header(cd);
+			if (ret < 0) {
+				fprintf(stderr, "error: wav header %s\n",
+					cd->fs.fn);
+				return ret;
+			}
+		} else if (cd->fs.wav_channels != stream->channels ||
+			   cd->fs.wav_sample_bytes !=
+			   cd->sample_container_bytes) {
+			fprintf(stderr, "error: %s has %u channels of %u bytes, stream needs %u of %u\n",
+				cd->fs.fn, cd->fs.wav_channels,
+				cd->fs.wav_sample_bytes, stream->channels,
+				cd->sample_container_bytes);
+			return -EINVAL;
+		} else if (cd->fs.wav_rate != cd->rate) {
+			fprintf(stderr, "warning: %s rate %u differs from %u\n",
+				cd->fs.fn, cd->fs.wav_rate, cd->rate);
+		}
+	}
+
 	/* calculate period size based on config */
 	cd->period_bytes = dev->frames * cd->sample_container_bytes *
 		stream->channels;
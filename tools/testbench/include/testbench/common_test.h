@@ -25,6 +25,7 @@ struct testbench_prm {
 	char *input_file; /* input file name */
 	char *output_file; /* output file name */
 	char *bits_in; /* input bit format */
+	char *batch_file; /* file listing jobs to run */
 	/*
 	 * input and output sample rate parameters
 	 * By default, these are calculated from pipeline frames_per_sched
@@ -38,6 +39,12 @@ struct testbench_prm {
 	int fw_id;
 	int sched_id;
 	enum sof_ipc_frame frame_fmt;
+	int profile; /* profile component copies */
+	char *profile_file; /* profile CSV output file */
+	uint32_t host_mhz; /* host clock used for MCPS */
+	uint32_t dsp_mhz; /* simulated DSP clock, 0 runs at host speed */
+	char *cost_file; /* simulation component cycle costs */
+	char *session_file; /* recorded session to replay */
 };
 
 struct shared_lib_table {
@@ -50,6 +57,8 @@ struct shared_lib_table {
 
 extern int debug;
 
+extern struct shared_lib_table lib_table[NUM_WIDGETS_SUPPORTED];
+
 int edf_scheduler_init(void);
 
 void sys_comp_file_init(void);
@@ -64,6 +73,8 @@ int tb_pipeline_start(struct ipc *ipc, struct sof_ipc_pipe_new *ipc_pipe,
 int tb_pipeline_params(struct ipc *ipc, struct sof_ipc_pipe_new *ipc_pipe,
 		       struct testbench_prm *tp);
 
+void tb_free_comps(struct ipc *ipc, uint32_t first_id, uint32_t last_id);
+
 void debug_print(char *message);
 
 int get_index_by_name(char *comp_name,
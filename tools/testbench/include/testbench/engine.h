@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/*
+ * Pipeline engine library. Runs the topologies of the testbench in an
+ * application, like an audio server processing streams for a device without
+ * a DSP. The application pushes PCM to the input of a topology and pulls the
+ * processed PCM from its output, both through lock-free rings, while the LL
+ * thread of the engine copies the pipeline every period. The samples are in
+ * the frame format of the stream, interleaved.
+ */
+
+#ifndef _ENGINE_H
+#define _ENGINE_H
+
+#include <ipc/stream.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct tb_engine;
+
+struct tb_engine_config {
+	uint32_t rate;		/* 0 takes the rate of the pipeline */
+	uint32_t channels;
+	enum sof_ipc_frame frame_fmt;
+	uint32_t ring_periods;	/* input and output ring length */
+	int rt_priority;	/* SCHED_FIFO priority of the LL thread */
+};
+
+/* loads a topology and starts its pipeline, NULL if it can't be loaded */
+struct tb_engine *tb_engine_new(const char *tplg_file,
+				const struct tb_engine_config *config);
+
+/* stops the pipeline and frees its components */
+void tb_engine_free(struct tb_engine *engine);
+
+/*
+ * Starts the LL thread copying the pipeline every period. Without the
+ * SCHED_FIFO permission the thread runs with the default policy.
+ */
+int tb_engine_start(struct tb_engine *engine);
+
+void tb_engine_stop(struct tb_engine *engine);
+
+/* copies one period from the thread of the caller instead of the LL one */
+void tb_engine_process(struct tb_engine *engine);
+
+/* writes whole frames to the input, returns the bytes taken */
+size_t tb_engine_push(struct tb_engine *engine, const void *data,
+		      size_t bytes);
+
+/* reads whole frames from the output, returns the bytes read */
+size_t tb_engine_pull(struct tb_engine *engine, void *data, size_t bytes);
+
+/* periods the input ran dry or the output overflowed */
+uint32_t tb_engine_xruns(struct tb_engine *engine);
+
+#endif
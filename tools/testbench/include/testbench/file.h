@@ -11,6 +11,8 @@
 #ifndef _FILE_H
 #define _FILE_H
 
+#include "testbench/ring.h"
+
 /* file component modes */
 enum file_mode {
 	FILE_READ = 0,
@@ -21,6 +23,8 @@ enum file_mode {
 enum file_format {
 	FILE_TEXT = 0,
 	FILE_RAW,
+	FILE_WAV,
+	FILE_RING,	/* engine ring, names start with TB_RING_PREFIX */
 };
 
 /* file component state */
@@ -31,6 +35,22 @@ struct file_state {
 	int n;
 	enum file_mode mode;
 	enum file_format f_format;
+
+	/* raw and wav input is mapped and copied in contiguous spans */
+	uint8_t *map;
+	size_t map_size;
+	size_t rpos;		/* read position in map */
+	size_t rend;		/* end of sample data in map */
+
+	/* wav input format, checked against the stream in prepare */
+	uint32_t wav_rate;
+	uint16_t wav_channels;
+	uint16_t wav_sample_bytes;
+
+	size_t wbytes;		/* sample bytes written to output */
+
+	struct tb_ring *ring;	/* ring of an engine endpoint */
+	uint32_t xruns;		/* periods the ring couldn't fully take */
 };
 
 /* file comp data */
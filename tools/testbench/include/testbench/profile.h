@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <stdio.h>
+#include <sof/sof.h>
+#include <sof/audio/pipeline.h>
+#include "testbench/common_test.h"
+
+int tb_profile_start(struct sof *sof);
+
+void tb_profile_stop(void);
+
+void tb_profile_report(FILE *out, struct shared_lib_table *lib_table,
+		       uint32_t host_mhz);
+
+int tb_profile_write_csv(const char *filename,
+			 struct shared_lib_table *lib_table,
+			 uint32_t host_mhz);
+
+void tb_profile_free(void);
+
+int tb_profile_set_cost(struct shared_lib_table *lib_table, const char *comp,
+			uint64_t cycles);
+
+uint64_t tb_profile_cycles(struct pipeline *p, uint32_t host_mhz);
+
+#endif
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef _RING_H
+#define _RING_H
+
+#include <sof/list.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* name prefix of file components reading or writing a ring */
+#define TB_RING_PREFIX	"ring:"
+
+/*
+ * Lock-free byte ring between one producer and one consumer thread, like
+ * an application pushing PCM and the LL thread of the engine taking it.
+ * Positions only grow and are published with release stores, so neither
+ * side ever waits for the other.
+ */
+struct tb_ring {
+	char *name;		/* file name of the endpoint using the ring */
+	uint8_t *data;
+	size_t size;
+	atomic_size_t head;	/* bytes written, only the producer stores */
+	atomic_size_t tail;	/* bytes read, only the consumer stores */
+	struct list_item list;	/* in the list of rings */
+};
+
+struct tb_ring *tb_ring_new(const char *name);
+
+/* sets the ring size before any use, the stream format may come later */
+int tb_ring_alloc(struct tb_ring *ring, size_t size);
+
+void tb_ring_free(struct tb_ring *ring);
+
+/* finds the ring of a file component name, NULL if there isn't any */
+struct tb_ring *tb_ring_find(const char *name);
+
+static inline size_t tb_ring_avail(struct tb_ring *ring)
+{
+	return atomic_load_explicit(&ring->head, memory_order_acquire) -
+		atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+static inline size_t tb_ring_free_bytes(struct tb_ring *ring)
+{
+	return ring->size -
+		(atomic_load_explicit(&ring->head, memory_order_relaxed) -
+		 atomic_load_explicit(&ring->tail, memory_order_acquire));
+}
+
+/* producer side, returns the bytes written */
+size_t tb_ring_write(struct tb_ring *ring, const void *data, size_t bytes);
+
+/* consumer side, returns the bytes read */
+size_t tb_ring_read(struct tb_ring *ring, void *data, size_t bytes);
+
+#endif
@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef _SESSION_H
+#define _SESSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <ipc/stream.h>
+
+/* input signal statistics of a window */
+struct tb_session_window {
+	uint32_t rate;
+	uint32_t channels;
+	uint32_t frames;
+	uint32_t peak;		/* Q1.15 */
+	uint64_t sum_sq;	/* Q2.30 */
+};
+
+/* stream started or stopped */
+struct tb_session_event {
+	uint32_t time_us;
+	bool running;
+};
+
+/* PCM of a recorded session, identified by its host component */
+struct tb_session_stream {
+	uint32_t comp_id;
+	uint32_t pipeline_id;
+	uint32_t direction;	/* enum sof_ipc_stream_direction */
+	uint32_t rate;
+	uint32_t channels;
+
+	struct tb_session_event *events;
+	unsigned int num_events;
+
+	struct tb_session_window *windows;
+	unsigned int num_windows;
+};
+
+int tb_session_load(const char *filename);
+
+/* streams in the order their params were first set */
+unsigned int tb_session_num_streams(void);
+
+struct tb_session_stream *tb_session_stream(unsigned int index);
+
+/* time of the last record */
+uint32_t tb_session_end_us(void);
+
+bool tb_session_running(struct tb_session_stream *stream, uint64_t time_us);
+
+/* writes raw input with the recorded signal levels of the stream */
+int tb_session_write_input(struct tb_session_stream *stream,
+			   const char *filename, uint32_t rate,
+			   uint32_t channels, enum sof_ipc_frame frame_fmt);
+
+void tb_session_free(void);
+
+#endif
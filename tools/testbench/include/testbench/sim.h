@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef _SIM_H
+#define _SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "testbench/common_test.h"
+
+/* max number of simulated DSP cores */
+#define TB_SIM_CORES	8
+
+int tb_sim_init(uint32_t dsp_mhz, uint32_t tick_us);
+
+int tb_sim_load_costs(const char *filename,
+		      struct shared_lib_table *lib_table);
+
+void tb_sim_tick_start(uint64_t time_us);
+
+/* start of the current tick, false if the simulation isn't running */
+bool tb_sim_time(uint64_t *time_us);
+
+bool tb_sim_ll_run(uint32_t core, uint64_t cycles);
+
+void tb_sim_tick_end(void);
+
+void tb_sim_report(FILE *out);
+
+void tb_sim_free(void);
+
+#endif
@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef _WAVE_H
+#define _WAVE_H
+
+#include <stdint.h>
+
+#define HEADER_RIFF 0x46464952	/**< ASCII "RIFF" */
+#define HEADER_WAVE 0x45564157	/**< ASCII "WAVE" */
+#define HEADER_FMT  0x20746d66	/**< ASCII "fmt " */
+#define HEADER_DATA 0x61746164	/**< ASCII "data" */
+
+#define WAVE_FORMAT_PCM		0x0001
+#define WAVE_FORMAT_EXTENSIBLE	0xfffe
+
+struct riff_chunk {
+	uint32_t chunk_id;
+	uint32_t chunk_size;
+	uint32_t format;
+};
+
+struct chunk_header {
+	uint32_t chunk_id;
+	uint32_t chunk_size;
+};
+
+struct fmt_subchunk {
+	uint32_t subchunk_id;
+	uint32_t subchunk_size;
+	uint16_t audio_format;
+	uint16_t num_channels;
+	uint32_t sample_rate;
+	uint32_t byte_rate;
+	uint16_t block_align;
+	uint16_t bits_per_sample;
+};
+
+struct data_subchunk {
+	uint32_t subchunk_id;
+	uint32_t subchunk_size;
+};
+
+struct wave {
+	struct riff_chunk riff;
+	struct fmt_subchunk fmt;
+	struct data_subchunk data;
+};
+
+#endif
@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Per component copy profiling. Copy operation of every component is
+ * wrapped with a timer while the pipeline runs, comp_copy() itself is
+ * inlined into the firmware library and can't be hooked directly.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sof/audio/component.h>
+#include <sof/audio/pipeline.h>
+#include <sof/drivers/ipc.h>
+#include <sof/list.h>
+#include "testbench/common_test.h"
+#include "testbench/profile.h"
+
+/* profiled component, its driver copy has copy op replaced */
+struct tb_comp_prof {
+	struct comp_driver drv;
+	const struct comp_driver *orig;
+	struct comp_dev *dev;
+
+	uint64_t *samples;	/* time of each copy in ns */
+	uint32_t count;
+	uint32_t size;
+
+	uint64_t cost;		/* cycles per copy from table, 0 measures */
+	uint32_t sim_count;	/* copies already charged by simulation */
+
+	struct list_item list;
+};
+
+static struct list_item prof_list = { &prof_list, &prof_list };
+
+static uint64_t tb_profile_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int tb_profile_copy(struct comp_dev *dev)
+{
+	struct tb_comp_prof *prof = container_of(dev->drv,
+						 struct tb_comp_prof, drv);
+	uint64_t *samples;
+	uint64_t tic;
+	int ret;
+
+	tic = tb_profile_now();
+	ret = prof->orig->ops.copy(dev);
+	tic = tb_profile_now() - tic;
+
+	if (prof->count == prof->size) {
+		prof->size = prof->size ? prof->size * 2 : 1024;
+		samples = realloc(prof->samples,
+				  sizeof(*samples) * prof->size);
+		if (!samples)
+			return ret;
+		prof->samples = samples;
+	}
+
+	prof->samples[prof->count++] = tic;
+
+	return ret;
+}
+
+int tb_profile_start(struct sof *sof)
+{
+	struct tb_comp_prof *prof;
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+
+	list_for_item(clist, &sof->ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_COMPONENT)
+			continue;
+
+		prof = calloc(1, sizeof(*prof));
+		if (!prof)
+			return -ENOMEM;
+
+		prof->orig = icd->cd->drv;
+		prof->drv = *prof->orig;
+		prof->drv.ops.copy = tb_profile_copy;
+		prof->dev = icd->cd;
+		icd->cd->drv = &prof->drv;
+
+		list_item_append(&prof->list, &prof_list);
+	}
+
+	return 0;
+}
+
+/* gives the original drivers back to the components */
+void tb_profile_stop(void)
+{
+	struct tb_comp_prof *prof;
+	struct list_item *clist;
+
+	list_for_item(clist, &prof_list) {
+		prof = container_of(clist, struct tb_comp_prof, list);
+		prof->dev->drv = prof->orig;
+	}
+}
+
+void tb_profile_free(void)
+{
+	struct tb_comp_prof *prof;
+	struct list_item *clist;
+	struct list_item *temp;
+
+	list_for_item_safe(clist, temp, &prof_list) {
+		prof = container_of(clist, struct tb_comp_prof, list);
+		list_item_del(&prof->list);
+		free(prof->samples);
+		free(prof);
+	}
+}
+
+static const char *tb_profile_name(struct tb_comp_prof *prof,
+				   struct shared_lib_table *lib_table)
+{
+	int index;
+
+	switch (dev_comp_type(prof->dev)) {
+	case SOF_COMP_FILEREAD:
+	case SOF_COMP_FILEWRITE:
+		return "file";
+	default:
+		index = get_index_by_type(dev_comp_type(prof->dev),
+					  lib_table);
+		return index < 0 ? "unknown" : lib_table[index].comp_name;
+	}
+}
+
+/* Sets a fixed cost for copies of components matching the id or name,
+ * returns the number of components matched.
+ */
+int tb_profile_set_cost(struct shared_lib_table *lib_table, const char *comp,
+			uint64_t cycles)
+{
+	struct tb_comp_prof *prof;
+	struct list_item *clist;
+	char *end;
+	long id = strtol(comp, &end, 0);
+	int count = 0;
+
+	list_for_item(clist, &prof_list) {
+		prof = container_of(clist, struct tb_comp_prof, list);
+		if ((!*end && dev_comp_id(prof->dev) == id) ||
+		    !strcmp(comp, tb_profile_name(prof, lib_table))) {
+			prof->cost = cycles;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/* cycles of the pipeline copies made since the previous call, measured
+ * copies are converted with the host clock
+ */
+uint64_t tb_profile_cycles(struct pipeline *p, uint32_t host_mhz)
+{
+	struct tb_comp_prof *prof;
+	struct list_item *clist;
+	uint64_t cycles = 0;
+
+	list_for_item(clist, &prof_list) {
+		prof = container_of(clist, struct tb_comp_prof, list);
+		if (prof->dev->pipeline != p)
+			continue;
+
+		for (; prof->sim_count < prof->count; prof->sim_count++)
+			cycles += prof->cost ? prof->cost :
+				prof->samples[prof->sim_count] * host_mhz /
+				1000;
+	}
+
+	return cycles;
+}
+
+static int tb_profile_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+struct tb_prof_stats {
+	uint64_t total;
+	double avg;
+	uint64_t p99;
+	double mcps;
+};
+
+/* MCPS is the host cycles per second of audio at the pipeline period */
+static void tb_profile_stats(struct tb_comp_prof *prof, uint32_t host_mhz,
+			     struct tb_prof_stats *stats)
+{
+	uint32_t period = prof->dev->pipeline->ipc_pipe.period;
+	uint32_t i;
+
+	memset(stats, 0, sizeof(*stats));
+	if (!prof->count)
+		return;
+
+	for (i = 0; i < prof->count; i++)
+		stats->total += prof->samples[i];
+
+	qsort(prof->samples, prof->count, sizeof(*prof->samples),
+	      tb_profile_cmp);
+
+	stats->avg = (double)stats->total / prof->count;
+	stats->p99 = prof->samples[prof->count * 99 / 100];
+	if (period)
+		stats->mcps = stats->avg * host_mhz / period / 1000;
+}
+
+void tb_profile_report(FILE *out, struct shared_lib_table *lib_table,
+		       uint32_t host_mhz)
+{
+	struct tb_prof_stats stats;
+	struct tb_comp_prof *prof;
+	struct list_item *clist;
+
+	fprintf(out, "Component copy profile, MCPS at %u MHz host clock:\n",
+		host_mhz);
+	fprintf(out, "%-5s %-8s %8s %12s %10s %10s %8s\n", "id", "comp",
+		"copies", "total us", "avg us", "p99 us", "MCPS");
+
+	list_for_item(clist, &prof_list) {
+		prof = container_of(clist, struct tb_comp_prof, list);
+		tb_profile_stats(prof, host_mhz, &stats);
+
+		fprintf(out, "%-5u %-8s %8u %12.1f %10.2f %10.2f %8.2f\n",
+			dev_comp_id(prof->dev),
+			tb_profile_name(prof, lib_table), prof->count,
+			stats.total / 1000.0, stats.avg / 1000,
+			stats.p99 / 1000.0, stats.mcps);
+	}
+}
+
+/* CSV output for regression tracking */
+int tb_profile_write_csv(const char *filename,
+			 struct shared_lib_table *lib_table,
+			 uint32_t host_mhz)
+{
+	struct tb_prof_stats stats;
+	struct tb_comp_prof *prof;
+	struct list_item *clist;
+	FILE *out;
+
+	out = fopen(filename, "w");
+	if (!out) {
+		fprintf(stderr, "error: opening profile file %s\n", filename);
+		return -errno;
+	}
+
+	fprintf(out, "id,comp,period_us,copies,total_ns,avg_ns,p99_ns,mcps\n");
+
+	list_for_item(clist, &prof_list) {
+		prof = container_of(clist, struct tb_comp_prof, list);
+		tb_profile_stats(prof, host_mhz, &stats);
+
+		fprintf(out, "%u,%s,%u,%u,%lu,%.1f,%lu,%.3f\n",
+			dev_comp_id(prof->dev),
+			tb_profile_name(prof, lib_table),
+			prof->dev->pipeline->ipc_pipe.period, prof->count,
+			(unsigned long)stats.total, stats.avg,
+			(unsigned long)stats.p99, stats.mcps);
+	}
+
+	fclose(out);
+
+	return 0;
+}
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/common.h>
+#include <sof/math/numbers.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testbench/ring.h"
+
+/* rings are looked up by name when file components are created */
+static struct list_item ring_list = { &ring_list, &ring_list };
+static pthread_mutex_t ring_lock = PTHREAD_MUTEX_INITIALIZER;
+
+struct tb_ring *tb_ring_new(const char *name)
+{
+	struct tb_ring *ring;
+
+	ring = calloc(1, sizeof(*ring));
+	if (!ring)
+		return NULL;
+
+	ring->name = strdup(name);
+	if (!ring->name) {
+		free(ring);
+		return NULL;
+	}
+
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+
+	pthread_mutex_lock(&ring_lock);
+	list_item_append(&ring->list, &ring_list);
+	pthread_mutex_unlock(&ring_lock);
+
+	return ring;
+}
+
+int tb_ring_alloc(struct tb_ring *ring, size_t size)
+{
+	if (!size)
+		return -EINVAL;
+
+	ring->data = malloc(size);
+	if (!ring->data)
+		return -ENOMEM;
+
+	ring->size = size;
+
+	return 0;
+}
+
+void tb_ring_free(struct tb_ring *ring)
+{
+	pthread_mutex_lock(&ring_lock);
+	list_item_del(&ring->list);
+	pthread_mutex_unlock(&ring_lock);
+
+	free(ring->name);
+	free(ring->data);
+	free(ring);
+}
+
+struct tb_ring *tb_ring_find(const char *name)
+{
+	struct tb_ring *found = NULL;
+	struct list_item *rlist;
+	struct tb_ring *ring;
+
+	pthread_mutex_lock(&ring_lock);
+	list_for_item(rlist, &ring_list) {
+		ring = container_of(rlist, struct tb_ring, list);
+		if (!strcmp(ring->name, name)) {
+			found = ring;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&ring_lock);
+
+	return found;
+}
+
+size_t tb_ring_write(struct tb_ring *ring, const void *data, size_t bytes)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t pos = head % ring->size;
+	size_t span;
+
+	bytes = MIN(bytes, tb_ring_free_bytes(ring));
+	span = MIN(bytes, ring->size - pos);
+
+	memcpy(ring->data + pos, data, span);
+	memcpy(ring->data, (const uint8_t *)data + span, bytes - span);
+
+	/* data is visible to the consumer before the new head */
+	atomic_store_explicit(&ring->head, head + bytes, memory_order_release);
+
+	return bytes;
+}
+
+size_t tb_ring_read(struct tb_ring *ring, void *data, size_t bytes)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	size_t pos = tail % ring->size;
+	size_t span;
+
+	bytes = MIN(bytes, tb_ring_avail(ring));
+	span = MIN(bytes, ring->size - pos);
+
+	memcpy(data, ring->data + pos, span);
+	memcpy((uint8_t *)data + span, ring->data, bytes - span);
+
+	/* space is given back only after the data has been copied */
+	atomic_store_explicit(&ring->tail, tail + bytes, memory_order_release);
+
+	return bytes;
+}
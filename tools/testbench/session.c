@@ -0,0 +1,486 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Replay of a session recorded by the firmware. Streams are found from
+ * the recorded PCM params and triggers, the recorded statistics of their
+ * input signal are turned into input of the same level, so the session
+ * runs on the simulated timeline with the timing and load of the device.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sof/math/numbers.h>
+#include <ipc/header.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <kernel/abi.h>
+#include <user/session.h>
+#include "testbench/session.h"
+
+/* pipeline of a component, to match DAI statistics to capture streams */
+struct tb_session_comp {
+	uint32_t id;
+	uint32_t pipeline_id;
+};
+
+struct tb_session {
+	struct tb_session_stream *streams;
+	unsigned int num_streams;
+	struct tb_session_comp *comps;
+	unsigned int num_comps;
+	uint32_t end_us;
+};
+
+static struct tb_session session;
+
+/* grows array by one zeroed element, returns it */
+static void *tb_session_grow(void **array, unsigned int *count, size_t size)
+{
+	char *grown = realloc(*array, size * (*count + 1));
+
+	if (!grown)
+		return NULL;
+
+	*array = grown;
+	memset(grown + size * *count, 0, size);
+
+	return grown + size * (*count)++;
+}
+
+static struct tb_session_stream *tb_session_find(uint32_t comp_id)
+{
+	unsigned int i;
+
+	for (i = 0; i < session.num_streams; i++) {
+		if (session.streams[i].comp_id == comp_id)
+			return &session.streams[i];
+	}
+
+	return NULL;
+}
+
+static uint32_t tb_session_comp_pipeline(uint32_t comp_id)
+{
+	unsigned int i;
+
+	for (i = 0; i < session.num_comps; i++) {
+		if (session.comps[i].id == comp_id)
+			return session.comps[i].pipeline_id;
+	}
+
+	return UINT32_MAX;
+}
+
+static int tb_session_comp_new(const uint8_t *data, uint32_t bytes)
+{
+	const struct sof_ipc_comp *comp = (const struct sof_ipc_comp *)data;
+	struct tb_session_comp *c;
+
+	if (bytes < sizeof(*comp))
+		return -EINVAL;
+
+	c = tb_session_grow((void **)&session.comps, &session.num_comps,
+			    sizeof(*c));
+	if (!c)
+		return -ENOMEM;
+
+	c->id = comp->id;
+	c->pipeline_id = comp->pipeline_id;
+
+	return 0;
+}
+
+static int tb_session_params(const uint8_t *data, uint32_t bytes)
+{
+	const struct sof_ipc_pcm_params *pcm =
+		(const struct sof_ipc_pcm_params *)data;
+	struct tb_session_stream *stream;
+
+	if (bytes < offsetof(struct sof_ipc_pcm_params, params.chmap))
+		return -EINVAL;
+
+	stream = tb_session_find(pcm->comp_id);
+	if (!stream) {
+		stream = tb_session_grow((void **)&session.streams,
+					 &session.num_streams,
+					 sizeof(*stream));
+		if (!stream)
+			return -ENOMEM;
+
+		stream->comp_id = pcm->comp_id;
+		stream->pipeline_id = tb_session_comp_pipeline(pcm->comp_id);
+	}
+
+	/* params of a stream reopened later replace the earlier ones */
+	stream->direction = pcm->params.direction;
+	stream->rate = pcm->params.rate;
+	stream->channels = pcm->params.channels;
+
+	return 0;
+}
+
+static int tb_session_event(uint32_t comp_id, uint32_t time_us,
+			    bool running)
+{
+	struct tb_session_stream *stream = tb_session_find(comp_id);
+	struct tb_session_event *event;
+
+	/* streams started without params failed on the device */
+	if (!stream)
+		return 0;
+
+	event = tb_session_grow((void **)&stream->events, &stream->num_events,
+				sizeof(*event));
+	if (!event)
+		return -ENOMEM;
+
+	event->time_us = time_us;
+	event->running = running;
+
+	return 0;
+}
+
+static int tb_session_trigger(const uint8_t *data, uint32_t bytes,
+			      uint32_t time_us, bool running)
+{
+	const struct sof_ipc_stream *stream =
+		(const struct sof_ipc_stream *)data;
+
+	if (bytes < sizeof(*stream))
+		return -EINVAL;
+
+	return tb_session_event(stream->comp_id, time_us, running);
+}
+
+static int tb_session_group(const uint8_t *data, uint32_t bytes,
+			    uint32_t time_us, bool running)
+{
+	const struct sof_ipc_stream_group *group =
+		(const struct sof_ipc_stream_group *)data;
+	uint32_t i;
+	int ret;
+
+	if (bytes < sizeof(*group))
+		return -EINVAL;
+
+	/* components past the recorded part of the message are lost */
+	for (i = 0; i < group->num_comps &&
+	     sizeof(*group) + (i + 1) * sizeof(uint32_t) <= bytes; i++) {
+		ret = tb_session_event(group->comp_id[i], time_us, running);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int tb_session_ipc(const struct sof_session_ipc *rec)
+{
+	const struct sof_ipc_cmd_hdr *hdr =
+		(const struct sof_ipc_cmd_hdr *)rec->data;
+	uint32_t bytes = rec->rec.size - sizeof(rec->rec);
+	uint32_t time_us = rec->rec.time_us;
+
+	if (bytes < sizeof(*hdr))
+		return -EINVAL;
+
+	bytes = MIN(bytes, hdr->size);
+
+	switch (hdr->cmd) {
+	case SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW:
+		return tb_session_comp_new(rec->data, bytes);
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_PCM_PARAMS:
+		return tb_session_params(rec->data, bytes);
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_TRIG_START:
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_TRIG_RELEASE:
+		return tb_session_trigger(rec->data, bytes, time_us, true);
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_TRIG_STOP:
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_TRIG_PAUSE:
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_TRIG_XRUN:
+		return tb_session_trigger(rec->data, bytes, time_us, false);
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_TRIG_GROUP_START:
+		return tb_session_group(rec->data, bytes, time_us, true);
+	case SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_TRIG_GROUP_STOP:
+		return tb_session_group(rec->data, bytes, time_us, false);
+	default:
+		return 0;
+	}
+}
+
+/* statistics of host input belong to its stream, of DAI input to the
+ * stream of the same pipeline
+ */
+static int tb_session_stats(const struct sof_session_stats *rec)
+{
+	struct tb_session_stream *stream = tb_session_find(rec->comp_id);
+	struct tb_session_window *window;
+	uint32_t pipeline_id;
+	unsigned int i;
+
+	if (rec->rec.size < sizeof(*rec))
+		return -EINVAL;
+
+	pipeline_id = tb_session_comp_pipeline(rec->comp_id);
+	for (i = 0; !stream && i < session.num_streams; i++) {
+		if (session.streams[i].pipeline_id == pipeline_id &&
+		    pipeline_id != UINT32_MAX)
+			stream = &session.streams[i];
+	}
+
+	if (!stream || !rec->frames || !rec->channels)
+		return 0;
+
+	window = tb_session_grow((void **)&stream->windows,
+				 &stream->num_windows, sizeof(*window));
+	if (!window)
+		return -ENOMEM;
+
+	window->rate = rec->rate;
+	window->channels = rec->channels;
+	window->frames = rec->frames;
+	window->peak = rec->peak;
+	window->sum_sq = rec->sum_sq;
+
+	return 0;
+}
+
+static int tb_session_parse(const uint8_t *data, size_t size)
+{
+	const struct sof_session_start *start =
+		(const struct sof_session_start *)data;
+	const struct sof_session_rec *rec;
+	size_t offset;
+	int ret = 0;
+
+	if (size < sizeof(*start) || start->rec.type != SOF_SESSION_START) {
+		fprintf(stderr, "error: session doesn't begin with its start, it's incomplete\n");
+		return -EINVAL;
+	}
+
+	if (SOF_ABI_VERSION_INCOMPATIBLE(SOF_ABI_VERSION, start->abi_version))
+		fprintf(stderr, "warning: session recorded with ABI %u.%u\n",
+			SOF_ABI_VERSION_MAJOR(start->abi_version),
+			SOF_ABI_VERSION_MINOR(start->abi_version));
+
+	for (offset = 0; offset < size && !ret; offset += rec->size) {
+		rec = (const struct sof_session_rec *)(data + offset);
+		if (size - offset < sizeof(*rec) || rec->size < sizeof(*rec) ||
+		    rec->size > size - offset || rec->size % 4) {
+			fprintf(stderr, "error: corrupt session at %zu\n",
+				offset);
+			return -EINVAL;
+		}
+
+		session.end_us = rec->time_us;
+
+		switch (rec->type) {
+		case SOF_SESSION_IPC:
+			ret = tb_session_ipc((const void *)rec);
+			break;
+		case SOF_SESSION_STATS:
+			ret = tb_session_stats((const void *)rec);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (ret < 0)
+		fprintf(stderr, "error: session record at %zu\n",
+			offset - rec->size);
+
+	return ret;
+}
+
+int tb_session_load(const char *filename)
+{
+	uint8_t *data;
+	FILE *file;
+	long size;
+	int ret;
+
+	file = fopen(filename, "rb");
+	if (!file) {
+		fprintf(stderr, "error: opening session %s\n", filename);
+		return -EINVAL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size < 0) {
+		fclose(file);
+		return -EINVAL;
+	}
+
+	data = malloc(size);
+	if (!data) {
+		fclose(file);
+		return -ENOMEM;
+	}
+
+	if (fread(data, 1, size, file) != (size_t)size)
+		ret = -EIO;
+	else
+		ret = tb_session_parse(data, size);
+
+	free(data);
+	fclose(file);
+
+	return ret;
+}
+
+unsigned int tb_session_num_streams(void)
+{
+	return session.num_streams;
+}
+
+struct tb_session_stream *tb_session_stream(unsigned int index)
+{
+	return index < session.num_streams ? &session.streams[index] : NULL;
+}
+
+uint32_t tb_session_end_us(void)
+{
+	return session.end_us;
+}
+
+bool tb_session_running(struct tb_session_stream *stream, uint64_t time_us)
+{
+	bool running = false;
+	unsigned int i;
+
+	for (i = 0; i < stream->num_events; i++) {
+		if (stream->events[i].time_us > time_us)
+			break;
+
+		running = stream->events[i].running;
+	}
+
+	return running;
+}
+
+/* time the stream runs until the end of the session */
+static uint64_t tb_session_running_us(struct tb_session_stream *stream)
+{
+	uint64_t total = 0;
+	uint64_t since = 0;
+	bool running = false;
+	unsigned int i;
+
+	for (i = 0; i < stream->num_events; i++) {
+		if (stream->events[i].running && !running)
+			since = stream->events[i].time_us;
+		else if (!stream->events[i].running && running)
+			total += stream->events[i].time_us - since;
+
+		running = stream->events[i].running;
+	}
+
+	if (running)
+		total += session.end_us - since;
+
+	return total;
+}
+
+static int tb_session_write_frames(FILE *file, uint64_t frames,
+				   uint32_t channels,
+				   enum sof_ipc_frame frame_fmt, double amp,
+				   uint32_t *seed)
+{
+	uint64_t n = frames * channels;
+	int32_t s32;
+	int16_t s16;
+	double x;
+
+	for (; n; n--) {
+		/* uniform noise, its RMS is amplitude / sqrt(3) */
+		*seed = *seed * 1664525 + 1013904223;
+		x = amp * (2.0 * *seed / 4294967296.0 - 1.0);
+
+		switch (frame_fmt) {
+		case SOF_IPC_FRAME_S16_LE:
+			s16 = lround(x);
+			if (fwrite(&s16, sizeof(s16), 1, file) != 1)
+				return -EIO;
+			break;
+		case SOF_IPC_FRAME_S24_4LE:
+			s32 = lround(x * 256);
+			if (fwrite(&s32, sizeof(s32), 1, file) != 1)
+				return -EIO;
+			break;
+		case SOF_IPC_FRAME_S32_LE:
+			s32 = lround(MIN(x * 65536, (double)INT32_MAX));
+			if (fwrite(&s32, sizeof(s32), 1, file) != 1)
+				return -EIO;
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+int tb_session_write_input(struct tb_session_stream *stream,
+			   const char *filename, uint32_t rate,
+			   uint32_t channels, enum sof_ipc_frame frame_fmt)
+{
+	struct tb_session_window *w;
+	uint32_t seed = stream->comp_id + 1;
+	uint64_t frames;
+	double rms;
+	double amp;
+	unsigned int i;
+	FILE *file;
+	int ret = 0;
+
+	file = fopen(filename, "wb");
+	if (!file) {
+		fprintf(stderr, "error: opening session input %s\n", filename);
+		return -EINVAL;
+	}
+
+	/* silence for the running time if the input wasn't recorded */
+	if (!stream->num_windows)
+		ret = tb_session_write_frames(file,
+					      tb_session_running_us(stream) *
+					      rate / 1000000, channels,
+					      frame_fmt, 0, &seed);
+
+	for (i = 0; i < stream->num_windows && !ret; i++) {
+		w = &stream->windows[i];
+		frames = (uint64_t)w->frames * rate / w->rate;
+		rms = sqrt((double)w->sum_sq / w->frames / w->channels);
+		amp = MIN(rms * sqrt(3), (double)w->peak);
+
+		ret = tb_session_write_frames(file, frames, channels,
+					      frame_fmt, amp, &seed);
+	}
+
+	if (ret < 0)
+		fprintf(stderr, "error: writing session input %s\n", filename);
+
+	fclose(file);
+
+	return ret;
+}
+
+void tb_session_free(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < session.num_streams; i++) {
+		free(session.streams[i].events);
+		free(session.streams[i].windows);
+	}
+
+	free(session.streams);
+	free(session.comps);
+	memset(&session, 0, sizeof(session));
+}
@@ -0,0 +1,271 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Simulated DSP timeline. Pipelines are run on LL ticks of simulated time
+ * and their copies are charged to the cores they are assigned to, using
+ * measured or table based cycle costs. EDF tasks from the cost table get
+ * the cycles left over by LL and are checked against their deadlines.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testbench/profile.h"
+#include "testbench/sim.h"
+
+/* background EDF task, e.g. KPB draining */
+struct tb_sim_edf {
+	uint32_t core;
+	uint32_t period;	/* release period in us */
+	uint64_t cycles;	/* cycles per release */
+	uint64_t remaining;	/* cycles left of the current release */
+	uint64_t deadline;	/* of the current release in us */
+	uint32_t releases;
+	uint32_t misses;
+};
+
+struct tb_sim_core {
+	uint64_t ll_cycles;	/* LL cycles run on the current tick */
+	uint64_t backlog;	/* LL cycles overrunning to the next tick */
+	uint64_t ll_total;
+	uint64_t edf_total;
+	uint32_t overruns;	/* ticks with LL work over the budget */
+	uint64_t ll_peak;	/* highest LL load of a tick */
+};
+
+struct tb_sim {
+	uint32_t dsp_mhz;
+	uint32_t tick_us;
+	uint64_t budget;	/* cycles per tick */
+	uint64_t time;		/* start of the current tick in us */
+	uint64_t ticks;
+
+	struct tb_sim_core cores[TB_SIM_CORES];
+
+	struct tb_sim_edf *edf;
+	unsigned int num_edf;
+};
+
+static struct tb_sim sim;
+
+int tb_sim_init(uint32_t dsp_mhz, uint32_t tick_us)
+{
+	if (!dsp_mhz || !tick_us)
+		return -EINVAL;
+
+	sim.dsp_mhz = dsp_mhz;
+	sim.tick_us = tick_us;
+	sim.budget = (uint64_t)dsp_mhz * tick_us;
+
+	return 0;
+}
+
+static int tb_sim_add_edf(uint32_t core, uint32_t period, uint64_t cycles)
+{
+	struct tb_sim_edf *edf;
+
+	if (core >= TB_SIM_CORES || !period)
+		return -EINVAL;
+
+	edf = realloc(sim.edf, sizeof(*edf) * (sim.num_edf + 1));
+	if (!edf)
+		return -ENOMEM;
+
+	sim.edf = edf;
+	edf = &sim.edf[sim.num_edf++];
+	memset(edf, 0, sizeof(*edf));
+	edf->core = core;
+	edf->period = period;
+	edf->cycles = cycles;
+
+	return 0;
+}
+
+/*
+ * Cost table has an entry per line:
+ *   <comp id or name> <cycles per copy>
+ *   edf <core> <period us> <cycles per period>
+ * Components without an entry are charged their measured copy time.
+ */
+int tb_sim_load_costs(const char *filename,
+		      struct shared_lib_table *lib_table)
+{
+	char line[DEBUG_MSG_LEN];
+	char comp[DEBUG_MSG_LEN];
+	unsigned long long cycles;
+	uint32_t core, period;
+	FILE *file;
+	int ret = 0;
+	int n = 0;
+
+	file = fopen(filename, "r");
+	if (!file) {
+		fprintf(stderr, "error: opening cost table %s\n", filename);
+		return -EINVAL;
+	}
+
+	while (fgets(line, sizeof(line), file)) {
+		n++;
+		if (sscanf(line, "%255s", comp) != 1 || comp[0] == '#')
+			continue;
+
+		if (!strcmp(comp, "edf")) {
+			if (sscanf(line, "edf %u %u %llu", &core, &period,
+				   &cycles) != 3 ||
+			    tb_sim_add_edf(core, period, cycles) < 0)
+				ret = -EINVAL;
+		} else if (sscanf(line, "%*s %llu", &cycles) != 1) {
+			ret = -EINVAL;
+		} else if (!tb_profile_set_cost(lib_table, comp, cycles)) {
+			fprintf(stderr, "warning: cost table line %d, no component %s\n",
+				n, comp);
+		}
+
+		if (ret < 0) {
+			fprintf(stderr, "error: cost table line %d\n", n);
+			break;
+		}
+	}
+
+	fclose(file);
+	return ret;
+}
+
+void tb_sim_tick_start(uint64_t time_us)
+{
+	struct tb_sim_edf *edf;
+	unsigned int i;
+
+	sim.time = time_us;
+
+	/* release EDF tasks, work left from the last release missed it */
+	for (i = 0; i < sim.num_edf; i++) {
+		edf = &sim.edf[i];
+		if (time_us % edf->period)
+			continue;
+
+		if (edf->remaining)
+			edf->misses++;
+
+		edf->remaining = edf->cycles;
+		edf->deadline = time_us + edf->period;
+		edf->releases++;
+	}
+}
+
+bool tb_sim_time(uint64_t *time_us)
+{
+	*time_us = sim.time;
+
+	return sim.tick_us;
+}
+
+/* charges LL work to the core, returns false if it overruns the tick */
+bool tb_sim_ll_run(uint32_t core, uint64_t cycles)
+{
+	struct tb_sim_core *c = &sim.cores[core % TB_SIM_CORES];
+
+	c->ll_cycles += cycles;
+
+	return c->backlog + c->ll_cycles <= sim.budget;
+}
+
+/* finds the EDF task of the core with the earliest deadline */
+static struct tb_sim_edf *tb_sim_edf_next(uint32_t core)
+{
+	struct tb_sim_edf *next = NULL;
+	unsigned int i;
+
+	for (i = 0; i < sim.num_edf; i++) {
+		if (sim.edf[i].core != core || !sim.edf[i].remaining)
+			continue;
+
+		if (!next || sim.edf[i].deadline < next->deadline)
+			next = &sim.edf[i];
+	}
+
+	return next;
+}
+
+void tb_sim_tick_end(void)
+{
+	struct tb_sim_core *c;
+	struct tb_sim_edf *edf;
+	uint64_t used, left, run;
+	uint32_t core;
+
+	for (core = 0; core < TB_SIM_CORES; core++) {
+		c = &sim.cores[core];
+
+		/* LL runs first, late LL work delays the next tick */
+		used = c->backlog + c->ll_cycles;
+		c->ll_total += c->ll_cycles;
+		if (c->ll_cycles > c->ll_peak)
+			c->ll_peak = c->ll_cycles;
+
+		if (used > sim.budget) {
+			c->overruns++;
+			c->backlog = used - sim.budget;
+			c->ll_cycles = 0;
+			continue;
+		}
+
+		c->backlog = 0;
+		c->ll_cycles = 0;
+		left = sim.budget - used;
+
+		/* EDF tasks get what is left in the order of deadlines */
+		while (left && (edf = tb_sim_edf_next(core))) {
+			run = MIN(left, edf->remaining);
+			edf->remaining -= run;
+			c->edf_total += run;
+			left -= run;
+		}
+	}
+
+	sim.ticks++;
+}
+
+void tb_sim_report(FILE *out)
+{
+	struct tb_sim_core *c;
+	struct tb_sim_edf *edf;
+	uint64_t total = sim.ticks * sim.budget;
+	uint32_t core;
+	unsigned int i;
+
+	if (!total)
+		return;
+
+	fprintf(out, "Simulated %.3f s at %u MHz, LL tick %u us\n",
+		(double)sim.ticks * sim.tick_us / 1e6, sim.dsp_mhz,
+		sim.tick_us);
+	fprintf(out, "%-5s %8s %8s %8s %10s %10s\n", "core", "LL %",
+		"EDF %", "idle %", "LL peak %", "overruns");
+
+	for (core = 0; core < TB_SIM_CORES; core++) {
+		c = &sim.cores[core];
+		if (!c->ll_total && !c->edf_total)
+			continue;
+
+		fprintf(out, "%-5u %8.2f %8.2f %8.2f %10.2f %10u\n", core,
+			100.0 * c->ll_total / total,
+			100.0 * c->edf_total / total,
+			100.0 - 100.0 * (c->ll_total + c->edf_total) / total,
+			100.0 * c->ll_peak / sim.budget, c->overruns);
+	}
+
+	for (i = 0; i < sim.num_edf; i++) {
+		edf = &sim.edf[i];
+		fprintf(out, "EDF task %u core %u period %u us: %u releases, %u deadline misses%s\n",
+			i, edf->core, edf->period, edf->releases, edf->misses,
+			edf->remaining ? ", unfinished" : "");
+	}
+}
+
+void tb_sim_free(void)
+{
+	free(sim.edf);
+	memset(&sim, 0, sizeof(sim));
+}
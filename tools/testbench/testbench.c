@@ -9,34 +9,45 @@
 #include <sof/list.h>
 #include <getopt.h>
 #include <dlfcn.h>
+#include <pthread.h>
 #include "testbench/common_test.h"
 #include <tplg_parser/topology.h>
 #include "testbench/trace.h"
 #include "testbench/file.h"
+#include "testbench/profile.h"
+#include "testbench/sim.h"
+#include "testbench/session.h"
 
 #define TESTBENCH_NCH 2 /* Stereo */
+#define TESTBENCH_HOST_MHZ 1000 /* host clock assumed for MCPS */
+#define TESTBENCH_LINE_LEN 1024 /* max batch file line length */
 
-/* shared library look up table */
-struct shared_lib_table lib_table[NUM_WIDGETS_SUPPORTED] = {
-	{"file", "", SOF_COMP_HOST, 0, NULL}, /* File must be first */
-	{"volume", "libsof_volume.so", SOF_COMP_VOLUME, 0, NULL},
-	{"src", "libsof_src.so", SOF_COMP_SRC, 0, NULL},
-	{"asrc", "libsof_asrc.so", SOF_COMP_ASRC, 0, NULL},
-	{"eq-fir", "libsof_eq-fir.so", SOF_COMP_EQ_FIR, 0, NULL},
-	{"eq-iir", "libsof_eq-iir.so", SOF_COMP_EQ_IIR, 0, NULL},
-	{"dcblock", "libsof_dcblock.so", SOF_COMP_DCBLOCK, 0, NULL}
+/* one topology with its input and output files */
+struct tb_job {
+	struct testbench_prm tp;
+	char pipeline[DEBUG_MSG_LEN];
+	struct pipeline *p;
+	struct comp_dev *cd;
+	struct file_comp_data *frcd;
+	struct file_comp_data *fwcd;
+	double toc;	/* EOF time in seconds */
+	int done;
+
+	/* simulation */
+	uint64_t next_us;	/* next period start */
+	uint32_t xruns;		/* periods finished after the LL tick */
+	struct tb_session_stream *stream;	/* replayed session stream */
 };
 
-/* main firmware context */
-static struct sof sof;
+/* worker thread, runs every num_workers job starting from index */
+struct tb_worker {
+	pthread_t thread;
+	int index;
+};
 
-/* compatible variables, not used */
-intptr_t _comp_init_start, _comp_init_end;
-
-struct sof *sof_get()
-{
-	return &sof;
-}
+static struct tb_job *jobs;
+static int num_jobs;
+static int num_workers = 1;
 
 /*
  * Parse shared library from user input
@@ -82,6 +93,32 @@ static int parse_libraries(char *libs)
 	return 0;
 }
 
+/* monotonic wall time in seconds, threads make clock() unusable */
+static double tb_time_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* adds a job using the common parameters */
+static struct tb_job *tb_job_add(struct testbench_prm *tp)
+{
+	struct tb_job *job;
+
+	job = realloc(jobs, sizeof(*jobs) * (num_jobs + 1));
+	if (!job)
+		return NULL;
+
+	jobs = job;
+	job = &jobs[num_jobs++];
+	memset(job, 0, sizeof(*job));
+	job->tp = *tp;
+
+	return job;
+}
+
 /* print usage for testbench */
 static void print_usage(char *executable)
 {
@@ -93,36 +130,21 @@ static void print_usage(char *executable)
 	printf("%s -i in.txt -o out.txt -t test.tplg ", executable);
 	printf("-r 48000 -R 96000 ");
 	printf("-b S16_LE -a vol=libsof_volume.so\n");
-}
-
-/* free components */
-static void free_comps(void)
-{
-	struct list_item *clist;
-	struct list_item *temp;
-	struct ipc_comp_dev *icd = NULL;
-
-	list_for_item_safe(clist, temp, &sof.ipc->comp_list) {
-		icd = container_of(clist, struct ipc_comp_dev, list);
-		switch (icd->type) {
-		case COMP_TYPE_COMPONENT:
-			comp_free(icd->cd);
-			list_item_del(&icd->list);
-			rfree(icd);
-			break;
-		case COMP_TYPE_BUFFER:
-			rfree(icd->cb->stream.addr);
-			rfree(icd->cb);
-			list_item_del(&icd->list);
-			rfree(icd);
-			break;
-		default:
-			rfree(icd->pipeline);
-			list_item_del(&icd->list);
-			rfree(icd);
-			break;
-		}
-	}
+	printf("Profiling: -p prints per component copy time, ");
+	printf("-c <csv_file> also writes it as CSV, ");
+	printf("-m <host_mhz> sets host clock for MCPS (default %d)\n",
+	       TESTBENCH_HOST_MHZ);
+	printf("Batch: -B <batch_file> runs a job per line in format ");
+	printf("\"<tplg_file> <input_file> <output_file>\" instead of ");
+	printf("-t, -i and -o, -T <threads> runs the pipelines on ");
+	printf("worker threads\n");
+	printf("Simulation: -s <dsp_mhz> runs pipelines on simulated LL ");
+	printf("ticks and reports core load and xruns, ");
+	printf("-C <cost_file> sets component cycles and EDF tasks\n");
+	printf("Replay: -S <session_file> with -s runs the jobs on the ");
+	printf("timeline of a recorded session, each job takes the ");
+	printf("input and triggers of the next recorded stream, -i is ");
+	printf("optional\n");
 }
 
 static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
@@ -130,7 +152,7 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 	int option = 0;
 	int ret = 0;
 
-	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:")) != -1) {
+	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:pc:m:B:T:s:C:S:")) != -1) {
 		switch (option) {
 		/* input sample file */
 		case 'i':
@@ -168,6 +190,49 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 			tp->fs_out = atoi(optarg);
 			break;
 
+		/* profile component copies */
+		case 'p':
+			tp->profile = 1;
+			break;
+
+		/* profile output file */
+		case 'c':
+			tp->profile = 1;
+			tp->profile_file = strdup(optarg);
+			break;
+
+		/* host clock for MCPS */
+		case 'm':
+			tp->host_mhz = atoi(optarg);
+			break;
+
+		/* batch file with a job per line */
+		case 'B':
+			tp->batch_file = strdup(optarg);
+			break;
+
+		/* number of worker threads */
+		case 'T':
+			num_workers = atoi(optarg);
+			if (num_workers < 1)
+				num_workers = 1;
+			break;
+
+		/* simulated DSP clock */
+		case 's':
+			tp->dsp_mhz = atoi(optarg);
+			break;
+
+		/* simulation cost table */
+		case 'C':
+			tp->cost_file = strdup(optarg);
+			break;
+
+		/* recorded session to replay */
+		case 'S':
+			tp->session_file = strdup(optarg);
+			break;
+
 		/* enable debug prints */
 		case 'd':
 			debug = 1;
@@ -185,18 +250,330 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 	}
 }
 
-int main(int argc, char **argv)
+/* load the topology of a job and start its scheduling pipeline */
+static int tb_job_load(struct tb_job *job)
 {
-	struct testbench_prm tp;
+	struct testbench_prm *tp = &job->tp;
 	struct ipc_comp_dev *pcm_dev;
-	struct pipeline *p;
 	struct sof_ipc_pipe_new *ipc_pipe;
-	struct comp_dev *cd;
-	struct file_comp_data *frcd, *fwcd;
-	char pipeline[DEBUG_MSG_LEN];
-	clock_t tic, toc;
+
+	/* parse topology file and create pipeline */
+	if (parse_topology(sof_get(), lib_table, tp, job->pipeline) < 0) {
+		fprintf(stderr, "error: parsing topology %s\n", tp->tplg_file);
+		return -EINVAL;
+	}
+
+	/* Get pointers to fileread and filewrite */
+	pcm_dev = ipc_get_comp_by_id(sof_get()->ipc, tp->fw_id);
+	job->fwcd = comp_get_drvdata(pcm_dev->cd);
+	pcm_dev = ipc_get_comp_by_id(sof_get()->ipc, tp->fr_id);
+	job->frcd = comp_get_drvdata(pcm_dev->cd);
+
+	/* Run pipeline until EOF from fileread */
+	pcm_dev = ipc_get_comp_by_id(sof_get()->ipc, tp->sched_id);
+	job->cd = pcm_dev->cd;
+	job->p = pcm_dev->cd->pipeline;
+	ipc_pipe = &job->p->ipc_pipe;
+
+	/* input and output sample rate */
+	if (!tp->fs_in)
+		tp->fs_in = ipc_pipe->period * ipc_pipe->frames_per_sched;
+
+	if (!tp->fs_out)
+		tp->fs_out = ipc_pipe->period * ipc_pipe->frames_per_sched;
+
+	/* set pipeline params and trigger start */
+	if (tb_pipeline_start(sof_get()->ipc, ipc_pipe, tp) < 0) {
+		fprintf(stderr, "error: pipeline params\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Worker runs one period of each of its pipelines in turn until all of
+ * them have reached EOF, like a DSP core scheduling several pipelines.
+ */
+static void *tb_worker_run(void *arg)
+{
+	struct tb_worker *worker = arg;
+	struct tb_job *job;
+	int active = 1;
+	int i;
+
+	while (active) {
+		active = 0;
+		for (i = worker->index; i < num_jobs; i += num_workers) {
+			job = &jobs[i];
+			if (job->done)
+				continue;
+
+			pipeline_schedule_copy(job->p, 0);
+
+			if (job->frcd->fs.reached_eof) {
+				job->toc = tb_time_now();
+				job->done = 1;
+			} else {
+				active = 1;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static int tb_run_jobs(void)
+{
+	struct tb_worker *workers;
+	int ret = 0;
+	int i;
+
+	if (num_workers > num_jobs)
+		num_workers = num_jobs;
+
+	/* single worker runs in the main thread */
+	if (num_workers == 1) {
+		struct tb_worker worker = { .index = 0 };
+
+		tb_worker_run(&worker);
+		return 0;
+	}
+
+	workers = calloc(num_workers, sizeof(*workers));
+	if (!workers)
+		return -ENOMEM;
+
+	for (i = 0; i < num_workers; i++) {
+		workers[i].index = i;
+		ret = pthread_create(&workers[i].thread, NULL, tb_worker_run,
+				     &workers[i]);
+		if (ret) {
+			fprintf(stderr, "error: creating worker %d\n", i);
+			break;
+		}
+	}
+
+	/* worker creation failed, wait for the running ones */
+	num_workers = i;
+	for (i = 0; i < num_workers; i++)
+		pthread_join(workers[i].thread, NULL);
+
+	free(workers);
+
+	return ret ? -ret : 0;
+}
+
+/* Runs the pipelines on simulated LL ticks of the shortest pipeline
+ * period. Each pipeline is copied on the first tick of its period and
+ * the cycles of its copies are charged to the core of the pipeline.
+ */
+static int tb_sim_run_jobs(struct testbench_prm *tp)
+{
+	struct sof_ipc_pipe_new *ipc_pipe;
+	struct tb_job *job;
+	uint32_t tick = UINT32_MAX;
+	uint64_t time;
+	int active = 1;
+	int i;
+
+	for (i = 0; i < num_jobs; i++)
+		tick = MIN(tick, jobs[i].p->ipc_pipe.period);
+
+	if (tb_sim_init(tp->dsp_mhz, tick) < 0)
+		return -EINVAL;
+
+	if (tp->cost_file && tb_sim_load_costs(tp->cost_file, lib_table) < 0)
+		return -EINVAL;
+
+	for (time = 0; active; time += tick) {
+		active = 0;
+		tb_sim_tick_start(time);
+
+		for (i = 0; i < num_jobs; i++) {
+			job = &jobs[i];
+			if (job->done)
+				continue;
+
+			active = 1;
+			ipc_pipe = &job->p->ipc_pipe;
+			if (job->next_us > time)
+				continue;
+
+			/* stopped streams wait for their next trigger */
+			if (job->stream &&
+			    !tb_session_running(job->stream, time)) {
+				job->next_us = time;
+				if (time > tb_session_end_us()) {
+					job->toc = tb_time_now();
+					job->done = 1;
+				}
+				continue;
+			}
+
+			job->next_us += ipc_pipe->period;
+			pipeline_schedule_copy(job->p, 0);
+
+			if (!tb_sim_ll_run(ipc_pipe->core,
+					   tb_profile_cycles(job->p,
+							     tp->host_mhz)))
+				job->xruns++;
+
+			if (job->frcd->fs.reached_eof) {
+				job->toc = tb_time_now();
+				job->done = 1;
+			}
+		}
+
+		tb_sim_tick_end();
+	}
+
+	return 0;
+}
+
+static void tb_job_summary(struct tb_job *job, double tic)
+{
+	struct testbench_prm *tp = &job->tp;
 	double c_realtime, t_exec;
-	int n_in, n_out, ret;
+	int n_in, n_out;
+
+	n_in = job->frcd->fs.n;
+	n_out = job->fwcd->fs.n;
+	t_exec = job->toc - tic;
+	c_realtime = (double)n_out / TESTBENCH_NCH / tp->fs_out / t_exec;
+
+	printf("==========================================================\n");
+	printf("		           Test Summary\n");
+	printf("==========================================================\n");
+	printf("Test Pipeline:\n");
+	printf("%s\n", job->pipeline);
+	printf("Input bit format: %s\n", tp->bits_in);
+	printf("Input sample rate: %d\n", tp->fs_in);
+	printf("Output sample rate: %d\n", tp->fs_out);
+	printf("Output written to file: \"%s\"\n", tp->output_file);
+	printf("Input sample count: %d\n", n_in);
+	printf("Output sample count: %d\n", n_out);
+	printf("Total execution time: %.2f us, %.2f x realtime\n",
+	       1e3 * t_exec, c_realtime);
+	if (tp->dsp_mhz)
+		printf("Simulated xruns: %u\n", job->xruns);
+	if (job->stream)
+		printf("Replayed session stream: comp %u, %u triggers, %u stats windows\n",
+		       job->stream->comp_id, job->stream->num_events,
+		       job->stream->num_windows);
+}
+
+/* Batch file has one job per line: <tplg_file> <input_file> <output_file>
+ * and other parameters are taken from the command line.
+ */
+static int tb_parse_batch(struct testbench_prm *tp)
+{
+	char line[TESTBENCH_LINE_LEN];
+	char *tplg, *in, *out, *save;
+	struct tb_job *job;
+	FILE *batch;
+
+	batch = fopen(tp->batch_file, "r");
+	if (!batch) {
+		fprintf(stderr, "error: opening batch file %s\n",
+			tp->batch_file);
+		return -EINVAL;
+	}
+
+	while (fgets(line, sizeof(line), batch)) {
+		tplg = strtok_r(line, " \t\n", &save);
+		if (!tplg || tplg[0] == '#')
+			continue;
+
+		in = strtok_r(NULL, " \t\n", &save);
+		out = strtok_r(NULL, " \t\n", &save);
+		if (!in || !out) {
+			fprintf(stderr, "error: batch job %d needs topology, input and output files\n",
+				num_jobs);
+			fclose(batch);
+			return -EINVAL;
+		}
+
+		job = tb_job_add(tp);
+		if (!job) {
+			fclose(batch);
+			return -ENOMEM;
+		}
+
+		job->tp.tplg_file = strdup(tplg);
+		job->tp.input_file = strdup(in);
+		job->tp.output_file = strdup(out);
+	}
+
+	fclose(batch);
+
+	return num_jobs ? 0 : -EINVAL;
+}
+
+/* Jobs take the recorded streams in order, with their rate and channels
+ * and input synthesized from the recorded signal levels.
+ */
+static int tb_session_map_jobs(struct testbench_prm *tp)
+{
+	struct tb_session_stream *stream;
+	struct testbench_prm *jtp;
+	char *input;
+	uint32_t rate;
+	int i;
+
+	if (tb_session_load(tp->session_file) < 0) {
+		fprintf(stderr, "error: loading session %s\n",
+			tp->session_file);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < num_jobs; i++) {
+		jtp = &jobs[i].tp;
+		stream = tb_session_stream(i);
+		if (!stream) {
+			if (jtp->input_file)
+				continue;
+
+			fprintf(stderr, "error: no session stream or input for job %d\n",
+				i);
+			return -EINVAL;
+		}
+
+		/* capture input comes from the DAI, at the rate recorded */
+		if (stream->direction == SOF_IPC_STREAM_PLAYBACK) {
+			jtp->fs_in = stream->rate;
+		} else {
+			jtp->fs_out = stream->rate;
+			if (stream->num_windows)
+				jtp->fs_in = stream->windows[0].rate;
+		}
+
+		jtp->channels = stream->channels;
+		rate = jtp->fs_in ? jtp->fs_in : stream->rate;
+
+		input = malloc(strlen(jtp->output_file) +
+			       sizeof(".session.raw"));
+		if (!input)
+			return -ENOMEM;
+
+		sprintf(input, "%s.session.raw", jtp->output_file);
+		free(jtp->input_file);
+		jtp->input_file = input;
+		jobs[i].stream = stream;
+
+		if (tb_session_write_input(stream, input, rate, jtp->channels,
+					   jtp->frame_fmt) < 0)
+			return -EINVAL;
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct testbench_prm tp;
+	struct tb_job *job;
+	double tic;
+	int ret;
 	int i;
 
 	/* initialize input and output sample rates, files, etc. */
@@ -205,101 +582,136 @@ int main(int argc, char **argv)
 	tp.bits_in = 0;
 	tp.input_file = NULL;
 	tp.output_file = NULL;
+	tp.tplg_file = NULL;
+	tp.batch_file = NULL;
 	tp.channels = TESTBENCH_NCH;
+	tp.profile = 0;
+	tp.profile_file = NULL;
+	tp.host_mhz = TESTBENCH_HOST_MHZ;
+	tp.dsp_mhz = 0;
+	tp.cost_file = NULL;
+	tp.session_file = NULL;
 
 	/* command line arguments*/
 	parse_input_args(argc, argv, &tp);
 
 	/* check args */
-	if (!tp.tplg_file || !tp.input_file || !tp.output_file || !tp.bits_in) {
+	if (!tp.bits_in || (tp.session_file && !tp.dsp_mhz) ||
+	    (!tp.batch_file && (!tp.tplg_file || !tp.output_file ||
+	    (!tp.input_file && !tp.session_file)))) {
 		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
-	/* initialize ipc and scheduler */
-	if (tb_pipeline_setup(&sof) < 0) {
-		fprintf(stderr, "error: pipeline init\n");
-		exit(EXIT_FAILURE);
+	/* jobs from the batch file or a single job from the arguments */
+	if (tp.batch_file) {
+		if (tb_parse_batch(&tp) < 0) {
+			fprintf(stderr, "error: parsing batch file\n");
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		job = tb_job_add(&tp);
+		if (!job)
+			exit(EXIT_FAILURE);
+		job->tp.tplg_file = strdup(tp.tplg_file);
+		job->tp.input_file = tp.input_file ? strdup(tp.input_file) :
+			NULL;
+		job->tp.output_file = strdup(tp.output_file);
 	}
 
-	/* parse topology file and create pipeline */
-	if (parse_topology(&sof, lib_table, &tp, pipeline) < 0) {
-		fprintf(stderr, "error: parsing topology\n");
+	if (tp.session_file && tb_session_map_jobs(&tp) < 0) {
+		fprintf(stderr, "error: replaying session\n");
 		exit(EXIT_FAILURE);
 	}
 
-	/* Get pointers to fileread and filewrite */
-	pcm_dev = ipc_get_comp_by_id(sof.ipc, tp.fw_id);
-	fwcd = comp_get_drvdata(pcm_dev->cd);
-	pcm_dev = ipc_get_comp_by_id(sof.ipc, tp.fr_id);
-	frcd = comp_get_drvdata(pcm_dev->cd);
-
-	/* Run pipeline until EOF from fileread */
-	pcm_dev = ipc_get_comp_by_id(sof.ipc, tp.sched_id);
-	p = pcm_dev->cd->pipeline;
-	ipc_pipe = &p->ipc_pipe;
-
-	/* input and output sample rate */
-	if (!tp.fs_in)
-		tp.fs_in = ipc_pipe->period * ipc_pipe->frames_per_sched;
+	/* initialize ipc and scheduler */
+	if (tb_pipeline_setup(sof_get()) < 0) {
+		fprintf(stderr, "error: pipeline init\n");
+		exit(EXIT_FAILURE);
+	}
 
-	if (!tp.fs_out)
-		tp.fs_out = ipc_pipe->period * ipc_pipe->frames_per_sched;
+	/* all topologies are loaded into the same firmware context */
+	for (i = 0; i < num_jobs; i++) {
+		if (tb_job_load(&jobs[i]) < 0)
+			exit(EXIT_FAILURE);
+	}
 
-	/* set pipeline params and trigger start */
-	if (tb_pipeline_start(sof.ipc, ipc_pipe, &tp) < 0) {
-		fprintf(stderr, "error: pipeline params\n");
+	/* simulation charges cycles of the profiled copies */
+	if ((tp.profile || tp.dsp_mhz) && tb_profile_start(sof_get()) < 0) {
+		fprintf(stderr, "error: profile init\n");
 		exit(EXIT_FAILURE);
 	}
 
-	cd = pcm_dev->cd;
 	tb_enable_trace(false); /* reduce trace output */
-	tic = clock();
+	tic = tb_time_now();
 
-	while (frcd->fs.reached_eof == 0)
-		pipeline_schedule_copy(p, 0);
-
-	if (!frcd->fs.reached_eof)
-		printf("warning: possible pipeline xrun\n");
-
-	/* reset and free pipeline */
-	toc = clock();
-	tb_enable_trace(true);
-	pipeline_trigger(p, cd, COMP_TRIGGER_STOP);
-	ret = pipeline_reset(p, cd);
+	if (tp.dsp_mhz)
+		ret = tb_sim_run_jobs(&tp);
+	else
+		ret = tb_run_jobs();
 	if (ret < 0) {
-		fprintf(stderr, "error: pipeline reset\n");
+		fprintf(stderr, "error: running pipelines\n");
 		exit(EXIT_FAILURE);
 	}
 
-	n_in = frcd->fs.n;
-	n_out = fwcd->fs.n;
-	t_exec = (double)(toc - tic) / CLOCKS_PER_SEC;
-	c_realtime = (double)n_out / TESTBENCH_NCH / tp.fs_out / t_exec;
-
-	/* free all components/buffers in pipeline */
-	free_comps();
+	/* reset and free pipelines */
+	tb_enable_trace(true);
+	if (tp.profile || tp.dsp_mhz)
+		tb_profile_stop();
+
+	for (i = 0; i < num_jobs; i++) {
+		job = &jobs[i];
+		if (!job->frcd->fs.reached_eof)
+			printf("warning: possible pipeline xrun\n");
+
+		pipeline_trigger(job->p, job->cd, COMP_TRIGGER_STOP);
+		ret = pipeline_reset(job->p, job->cd);
+		if (ret < 0) {
+			fprintf(stderr, "error: pipeline reset\n");
+			exit(EXIT_FAILURE);
+		}
+	}
 
 	/* print test summary */
-	printf("==========================================================\n");
-	printf("		           Test Summary\n");
-	printf("==========================================================\n");
-	printf("Test Pipeline:\n");
-	printf("%s\n", pipeline);
-	printf("Input bit format: %s\n", tp.bits_in);
-	printf("Input sample rate: %d\n", tp.fs_in);
-	printf("Output sample rate: %d\n", tp.fs_out);
-	printf("Output written to file: \"%s\"\n", tp.output_file);
-	printf("Input sample count: %d\n", n_in);
-	printf("Output sample count: %d\n", n_out);
-	printf("Total execution time: %.2f us, %.2f x realtime\n",
-	       1e3 * t_exec, c_realtime);
+	for (i = 0; i < num_jobs; i++)
+		tb_job_summary(&jobs[i], tic);
+
+	/* profile refers to the components so report it before freeing */
+	if (tp.profile) {
+		tb_profile_report(stdout, lib_table, tp.host_mhz);
+		if (tp.profile_file)
+			tb_profile_write_csv(tp.profile_file, lib_table,
+					     tp.host_mhz);
+	}
+
+	if (tp.dsp_mhz) {
+		tb_sim_report(stdout);
+		tb_sim_free();
+	}
+
+	if (tp.profile || tp.dsp_mhz)
+		tb_profile_free();
+
+	/* free all components/buffers in pipeline */
+	tb_free_comps(sof_get()->ipc, 0, UINT32_MAX);
 
 	/* free all other data */
+	for (i = 0; i < num_jobs; i++) {
+		free(jobs[i].tp.input_file);
+		free(jobs[i].tp.tplg_file);
+		free(jobs[i].tp.output_file);
+	}
+	free(jobs);
+
 	free(tp.bits_in);
 	free(tp.input_file);
 	free(tp.tplg_file);
 	free(tp.output_file);
+	free(tp.batch_file);
+	free(tp.profile_file);
+	free(tp.cost_file);
+	free(tp.session_file);
+	tb_session_free();
 
 	/* close shared library objects */
 	for (i = 0; i < NUM_WIDGETS_SUPPORTED; i++) {
@@ -7,8 +7,33 @@
 //         Rander Wang <rander.wang@intel.com>
 //         Janusz Jankowski <janusz.jankowski@linux.intel.com>
 
+#include <sof/drivers/timer.h>
+#include <sof/lib/clk.h>
+#include <time.h>
+#include "testbench/sim.h"
 #include "testbench/timer.h"
 
+/* Platform timer ticks are microseconds of simulated time while the
+ * pipelines run on the simulated timeline, of host time otherwise.
+ */
+uint64_t platform_timer_get(struct timer *timer)
+{
+	struct timespec ts;
+	uint64_t time_us;
+
+	if (tb_sim_time(&time_us))
+		return time_us;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t clock_ms_to_ticks(int clock, uint64_t ms)
+{
+	return ms * 1000;
+}
+
 void platform_host_timestamp(struct comp_dev *host,
 			     struct sof_ipc_stream_posn *posn)
 {
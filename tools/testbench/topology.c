@@ -20,7 +20,10 @@
 
 FILE *file;
 char pipeline_string[DEBUG_MSG_LEN];
-struct shared_lib_table *lib_table;
+
+/* ids continue over all topologies loaded into the testbench */
+static int next_comp_id;
+static int next_pipeline_id;
 
 const struct sof_dai_types sof_dais[] = {
 	{"SSP", SOF_DAI_INTEL_SSP},
@@ -672,7 +675,8 @@ int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 
 	struct comp_info *temp_comp_list = NULL;
 	char message[DEBUG_MSG_LEN];
-	int next_comp_id = 0;
+	int pipeline_id_base = next_pipeline_id;
+	int pipeline_id;
 	int num_comps = 0;
 	int i;
 	int ret = 0;
@@ -686,7 +690,7 @@ int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 		return -EINVAL;
 	}
 
-	lib_table = library_table;
+	pipeline_string[0] = '\0';
 
 	/* file size */
 	fseek(file, 0, SEEK_END);
@@ -727,11 +731,15 @@ int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 			temp_comp_list = (struct comp_info *)
 					 realloc(temp_comp_list, size);
 
+			pipeline_id = pipeline_id_base + hdr->index;
+			if (pipeline_id >= next_pipeline_id)
+				next_pipeline_id = pipeline_id + 1;
+
 			for (i = (num_comps - hdr->count); i < num_comps; i++) {
 				ret = load_widget(sof, SOF_DEV,
 						  temp_comp_list,
 						  next_comp_id++, i,
-						  hdr->index, tp, &tp->sched_id,
+						  pipeline_id, tp, &tp->sched_id,
 						  file);
 				if (ret < 0) {
 					printf("error: loading widget\n");
@@ -743,7 +751,8 @@ int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 		/* set up component connections from pipeline graph */
 		case SND_SOC_TPLG_TYPE_DAPM_GRAPH:
 			if (load_graph(sof, temp_comp_list, hdr->count,
-				       num_comps, hdr->index) < 0) {
+				       num_comps,
+				       pipeline_id_base + hdr->index) < 0) {
 				fprintf(stderr, "error: pipeline graph\n");
 				return -EINVAL;
 			}
@@ -26,6 +26,54 @@ define(`W_BUFFER',
 `	]'
 `}')
 
+dnl W_BUFFER_GROUP(name, size, capabilities, group)
+dnl Buffers of the same group share memory allocated only while one of
+dnl their pipelines is set up, so the pipelines must never run together.
+define(`W_BUFFER_GROUP',
+`SectionVendorTuples."'N_BUFFER($1)`_tuples" {'
+`	tokens "sof_buffer_tokens"'
+`	tuples."word" {'
+`		SOF_TKN_BUF_SIZE'	STR($2)
+`		SOF_TKN_BUF_CAPS'	STR($3)
+`		SOF_TKN_BUF_GROUP'	STR($4)
+`	}'
+`}'
+`SectionData."'N_BUFFER($1)`_data" {'
+`	tuples "'N_BUFFER($1)`_tuples"'
+`}'
+`SectionWidget."'N_BUFFER($1)`" {'
+`	index "'PIPELINE_ID`"'
+`	type "buffer"'
+`	no_pm "true"'
+`	data ['
+`		"'N_BUFFER($1)`_data"'
+`	]'
+`}')
+
+dnl W_BUFFER_BROADCAST(name, size, capabilities)
+dnl Reads the data produced into the first buffer of the source component
+dnl without a copy, e.g. to feed a recorder and a detector from one stream.
+define(`W_BUFFER_BROADCAST',
+`SectionVendorTuples."'N_BUFFER($1)`_tuples" {'
+`	tokens "sof_buffer_tokens"'
+`	tuples."word" {'
+`		SOF_TKN_BUF_SIZE'	STR($2)
+`		SOF_TKN_BUF_CAPS'	STR($3)
+`		SOF_TKN_BUF_FLAGS'	"2"
+`	}'
+`}'
+`SectionData."'N_BUFFER($1)`_data" {'
+`	tuples "'N_BUFFER($1)`_tuples"'
+`}'
+`SectionWidget."'N_BUFFER($1)`" {'
+`	index "'PIPELINE_ID`"'
+`	type "buffer"'
+`	no_pm "true"'
+`	data ['
+`		"'N_BUFFER($1)`_data"'
+`	]'
+`}')
+
 dnl COMP_BUFFER_SIZE( num_periods, sample_size, channels, fmames)
 define(`COMP_BUFFER_SIZE', `eval(`$1 * $2 * $3 * $4')')
 
@@ -12,6 +12,8 @@
 SectionVendorTokens."sof_buffer_tokens" {
 	SOF_TKN_BUF_SIZE			"100"
 	SOF_TKN_BUF_CAPS			"101"
+	SOF_TKN_BUF_FLAGS			"102"
+	SOF_TKN_BUF_GROUP			"103"
 }
 
 SectionVendorTokens."sof_dai_tokens" {
@@ -20,6 +22,8 @@ SectionVendorTokens."sof_dai_tokens" {
 	SOF_TKN_DAI_TYPE			"154"
 	SOF_TKN_DAI_INDEX			"155"
 	SOF_TKN_DAI_DIRECTION			"156"
+	SOF_TKN_DAI_SLOT_MASK			"157"
+	SOF_TKN_DAI_CH_MAP			"158"
 }
 
 SectionVendorTokens."sof_sched_tokens" {
@@ -50,6 +54,7 @@ SectionVendorTokens."sof_asrc_tokens" {
 
 SectionVendorTokens."sof_pcm_tokens" {
 	SOF_TKN_PCM_DMAC_CONFIG			"353"
+	SOF_TKN_PCM_CH_MAP			"354"
 }
 
 SectionVendorTokens."sof_comp_tokens" {
@@ -0,0 +1,398 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Memory and MCPS estimate of the components of a topology */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "cost.h"
+
+/* KPB keeps 2100 ms of 2 channel 16 kHz history, see sof/audio/kpb.h */
+#define COST_KPB_HISTORY_BYTES(sample_bytes) (16 * (sample_bytes) * 2100 * 2)
+
+/* copy period assumed for pipelines without one, in us */
+#define COST_DEFAULT_PERIOD	1000
+
+/*
+ * Default costs are rough estimates for HiFi3 class cores, they are meant to
+ * be replaced with numbers measured by test/bench/kernel_bench (-t option).
+ */
+static struct cost_entry cost_table[] = {
+	/* name		s16	s24	s32	priv	state	copy */
+	{ "host",	{ 1,	1,	1 },	256,	0,	2000 },
+	{ "dai",	{ 1,	1,	1 },	256,	0,	2000 },
+	{ "volume",	{ 3,	4,	4 },	512,	0,	500 },
+	{ "mixer",	{ 2,	3,	3 },	128,	0,	300 },
+	{ "mux",	{ 2,	2,	2 },	256,	0,	300 },
+	{ "src",	{ 40,	50,	50 },	512,	3072,	1000 },
+	{ "asrc",	{ 60,	70,	70 },	1024,	2048,	1500 },
+	{ "fir",	{ 20,	24,	24 },	256,	1024,	500 },
+	{ "iir",	{ 12,	14,	14 },	256,	64,	500 },
+	{ "dcblock",	{ 3,	4,	4 },	64,	16,	200 },
+	{ "selector",	{ 1,	1,	1 },	64,	0,	200 },
+	{ "kpb",	{ 2,	2,	2 },	512,	0,	1000 },
+	{ "keyword",	{ 20,	20,	20 },	512,	0,	1000 },
+	{ "tone",	{ 10,	10,	10 },	256,	0,	300 },
+	{ "buffer",	{ 0,	0,	0 },	64,	0,	0 },
+	{ "unknown",	{ 5,	5,	5 },	256,	0,	500 },
+};
+
+static struct cost_entry *cost_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cost_table); i++)
+		if (!strcmp(cost_table[i].name, name))
+			return &cost_table[i];
+
+	return NULL;
+}
+
+static const char *cost_kind(enum sof_comp_type type)
+{
+	switch (type) {
+	case SOF_COMP_HOST:
+	case SOF_COMP_SG_HOST:
+		return "host";
+	case SOF_COMP_DAI:
+	case SOF_COMP_SG_DAI:
+		return "dai";
+	case SOF_COMP_VOLUME:
+		return "volume";
+	case SOF_COMP_MIXER:
+		return "mixer";
+	case SOF_COMP_MUX:
+	case SOF_COMP_DEMUX:
+		return "mux";
+	case SOF_COMP_SRC:
+		return "src";
+	case SOF_COMP_ASRC:
+		return "asrc";
+	case SOF_COMP_EQ_FIR:
+		return "fir";
+	case SOF_COMP_EQ_IIR:
+		return "iir";
+	case SOF_COMP_DCBLOCK:
+		return "dcblock";
+	case SOF_COMP_SELECTOR:
+		return "selector";
+	case SOF_COMP_KPB:
+		return "kpb";
+	case SOF_COMP_KEYWORD_DETECT:
+		return "keyword";
+	case SOF_COMP_TONE:
+		return "tone";
+	default:
+		return "unknown";
+	}
+}
+
+static int cost_fmt_index(enum sof_ipc_frame fmt)
+{
+	switch (fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		return 0;
+	case SOF_IPC_FRAME_S24_4LE:
+		return 1;
+	default:
+		return 2;
+	}
+}
+
+static int cost_fmt_bytes(enum sof_ipc_frame fmt)
+{
+	return fmt == SOF_IPC_FRAME_S16_LE ? 2 : 4;
+}
+
+static struct cost_comp *cost_comp_new(struct cost_config *cost,
+				       const char *name, uint32_t id,
+				       uint32_t pipeline_id)
+{
+	struct cost_comp *comps;
+	struct cost_comp *c;
+
+	comps = realloc(cost->comps, sizeof(*comps) * (cost->num_comps + 1));
+	if (!comps)
+		return NULL;
+
+	cost->comps = comps;
+	c = &comps[cost->num_comps];
+	memset(c, 0, sizeof(*c));
+
+	c->name = strdup(name);
+	if (!c->name)
+		return NULL;
+
+	c->id = id;
+	c->pipeline_id = pipeline_id;
+	cost->num_comps++;
+
+	return c;
+}
+
+int cost_add_comp(struct cost_config *cost, const char *name,
+		  const struct sof_ipc_comp *comp,
+		  const struct sof_ipc_comp_config *config,
+		  uint32_t rate, uint32_t data_bytes)
+{
+	struct cost_comp *c;
+
+	c = cost_comp_new(cost, name, comp->id, comp->pipeline_id);
+	if (!c)
+		return -ENOMEM;
+
+	c->entry = cost_find(cost_kind(comp->type));
+	c->fmt = config->frame_fmt;
+	c->rate = rate ? rate : cost->rate;
+
+	/* configuration blobs are kept by the component */
+	c->mem_runtime = c->entry->priv_bytes +
+		c->entry->state_bytes * cost->channels + data_bytes;
+
+	/* history is allocated from the buffer heap */
+	if (comp->type == SOF_COMP_KPB)
+		c->mem_buffer = COST_KPB_HISTORY_BYTES(cost_fmt_bytes(c->fmt));
+
+	return 0;
+}
+
+int cost_add_buffer(struct cost_config *cost, const char *name,
+		    const struct sof_ipc_buffer *buffer)
+{
+	struct cost_comp *c;
+
+	c = cost_comp_new(cost, name, buffer->comp.id,
+			  buffer->comp.pipeline_id);
+	if (!c)
+		return -ENOMEM;
+
+	c->entry = cost_find("buffer");
+	c->mem_runtime = c->entry->priv_bytes;
+	c->mem_buffer = buffer->size;
+	c->group = buffer->group;
+
+	return 0;
+}
+
+int cost_add_pipe(struct cost_config *cost,
+		  const struct sof_ipc_pipe_new *pipe)
+{
+	struct cost_pipe *pipes;
+	struct cost_pipe *p;
+
+	pipes = realloc(cost->pipes, sizeof(*pipes) * (cost->num_pipes + 1));
+	if (!pipes)
+		return -ENOMEM;
+
+	cost->pipes = pipes;
+	p = &pipes[cost->num_pipes++];
+	p->pipeline_id = pipe->pipeline_id;
+	p->core = pipe->core;
+	p->period = pipe->period ? pipe->period : COST_DEFAULT_PERIOD;
+	p->period_mips = pipe->period_mips;
+
+	return 0;
+}
+
+/* each line is: name s16 s24 s32 [priv state copy] */
+int cost_table_load(const char *filename)
+{
+	struct cost_entry in;
+	struct cost_entry *e;
+	char line[256];
+	FILE *file;
+	int line_num = 0;
+	int ret = 0;
+	int n;
+
+	file = fopen(filename, "r");
+	if (!file) {
+		fprintf(stderr, "error: opening cost table %s\n", filename);
+		return -errno;
+	}
+
+	while (fgets(line, sizeof(line), file)) {
+		line_num++;
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		n = sscanf(line, "%15s %lf %lf %lf %u %u %u", in.name,
+			   &in.cycles[0], &in.cycles[1], &in.cycles[2],
+			   &in.priv_bytes, &in.state_bytes, &in.copy_cycles);
+		e = n >= 4 ? cost_find(in.name) : NULL;
+		if (!e) {
+			fprintf(stderr, "error: %s:%d invalid cost entry\n",
+				filename, line_num);
+			ret = -EINVAL;
+			break;
+		}
+
+		memcpy(e->cycles, in.cycles, sizeof(e->cycles));
+		if (n >= 5)
+			e->priv_bytes = in.priv_bytes;
+		if (n >= 6)
+			e->state_bytes = in.state_bytes;
+		if (n >= 7)
+			e->copy_cycles = in.copy_cycles;
+	}
+
+	fclose(file);
+	return ret;
+}
+
+static struct cost_pipe *cost_get_pipe(struct cost_config *cost,
+				       uint32_t pipeline_id)
+{
+	int i;
+
+	for (i = 0; i < cost->num_pipes; i++)
+		if (cost->pipes[i].pipeline_id == pipeline_id)
+			return &cost->pipes[i];
+
+	return NULL;
+}
+
+static double cost_comp_mcps(struct cost_config *cost,
+			     const struct cost_comp *c, uint32_t period)
+{
+	const struct cost_entry *e = c->entry;
+	double samples = (double)c->rate * cost->channels;
+
+	return (e->cycles[cost_fmt_index(c->fmt)] * samples +
+		(double)e->copy_cycles * 1000000 / period) / 1000000;
+}
+
+/* shared buffers count once with the size of the largest of the group */
+static uint32_t cost_buffer_total(struct cost_config *cost)
+{
+	uint32_t total = 0;
+	uint32_t max;
+	int i, j;
+
+	for (i = 0; i < cost->num_comps; i++) {
+		if (!cost->comps[i].group) {
+			total += cost->comps[i].mem_buffer;
+			continue;
+		}
+
+		/* only the first buffer of a group adds it */
+		for (j = 0; j < i; j++)
+			if (cost->comps[j].group == cost->comps[i].group)
+				break;
+		if (j < i)
+			continue;
+
+		max = 0;
+		for (j = i; j < cost->num_comps; j++)
+			if (cost->comps[j].group == cost->comps[i].group &&
+			    cost->comps[j].mem_buffer > max)
+				max = cost->comps[j].mem_buffer;
+		total += max;
+	}
+
+	return total;
+}
+
+static int cost_check(FILE *out, const char *name, double used,
+		      double available, const char *unit)
+{
+	double pct = available ? used * 100 / available : 0;
+
+	fprintf(out, "%-16s %10.2f of %10.2f %s (%3.0f%%)\n", name, used,
+		available, unit, pct);
+
+	if (used <= available)
+		return 0;
+
+	fprintf(out, "warning: %s oversubscribed by %.2f %s\n", name,
+		used - available, unit);
+	return 1;
+}
+
+int cost_report(struct cost_config *cost, FILE *out)
+{
+	double core_mcps[COST_MAX_CORES] = { 0 };
+	uint32_t mem_runtime = 0;
+	uint32_t mem_buffer;
+	struct cost_pipe *p;
+	struct cost_comp *c;
+	char name[32];
+	uint32_t period;
+	uint32_t core;
+	double mcps;
+	int warnings = 0;
+	int i;
+
+	fprintf(out, "Estimate at %u Hz, %u channels, %u MHz cores\n\n",
+		cost->rate, cost->channels, cost->cpu_mhz);
+	fprintf(out, "%-4s %-4s %-32s %-8s %10s %10s %10s\n", "PIPE", "CORE",
+		"WIDGET", "KIND", "MCPS", "RUNTIME", "BUFFER");
+
+	for (i = 0; i < cost->num_comps; i++) {
+		c = &cost->comps[i];
+		p = cost_get_pipe(cost, c->pipeline_id);
+		period = p ? p->period : COST_DEFAULT_PERIOD;
+		core = p ? p->core : 0;
+
+		mcps = cost_comp_mcps(cost, c, period);
+		mem_runtime += c->mem_runtime;
+
+		if (core >= COST_MAX_CORES) {
+			fprintf(out, "warning: %s on invalid core %u\n",
+				c->name, core);
+			warnings++;
+		} else {
+			core_mcps[core] += mcps;
+		}
+
+		fprintf(out, "%-4u %-4u %-32s %-8s %10.2f %10u %10u\n",
+			c->pipeline_id, core, c->name, c->entry->name, mcps,
+			c->mem_runtime, c->mem_buffer);
+	}
+
+	/* declared load of the pipelines for comparison with the estimate */
+	fprintf(out, "\n%-4s %-4s %10s %10s\n", "PIPE", "CORE", "PERIOD",
+		"DECLARED");
+	for (i = 0; i < cost->num_pipes; i++) {
+		p = &cost->pipes[i];
+		fprintf(out, "%-4u %-4u %10u %10.2f\n", p->pipeline_id,
+			p->core, p->period, (double)p->period_mips / p->period);
+	}
+
+	fprintf(out, "\n");
+	for (i = 0; i < COST_MAX_CORES; i++) {
+		if (!core_mcps[i])
+			continue;
+
+		sprintf(name, "core %d", i);
+		warnings += cost_check(out, name, core_mcps[i], cost->cpu_mhz,
+				       "MCPS");
+	}
+
+	mem_buffer = cost_buffer_total(cost);
+	warnings += cost_check(out, "runtime heap", mem_runtime,
+			       cost->heap_runtime, "bytes");
+	warnings += cost_check(out, "buffer heap", mem_buffer,
+			       cost->heap_buffer, "bytes");
+
+	return warnings;
+}
+
+void cost_free(struct cost_config *cost)
+{
+	int i;
+
+	for (i = 0; i < cost->num_comps; i++)
+		free(cost->comps[i].name);
+
+	free(cost->comps);
+	free(cost->pipes);
+	cost->comps = NULL;
+	cost->pipes = NULL;
+	cost->num_comps = 0;
+	cost->num_pipes = 0;
+}
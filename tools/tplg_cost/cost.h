@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __TPLG_COST_H__
+#define __TPLG_COST_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+/* max number of cores reported */
+#define COST_MAX_CORES		8
+
+/* max length of a cost table name */
+#define COST_NAME_LEN		16
+
+/* per kernel cost, cycles of each sample of each channel by format */
+struct cost_entry {
+	char name[COST_NAME_LEN];
+	double cycles[3];	/* s16, s24, s32 */
+	uint32_t priv_bytes;	/* private data independent of channels */
+	uint32_t state_bytes;	/* filter state and delay lines per channel */
+	uint32_t copy_cycles;	/* fixed overhead of each copy */
+};
+
+/* estimate of one component or buffer of the topology */
+struct cost_comp {
+	char *name;
+	const struct cost_entry *entry;
+	uint32_t id;
+	uint32_t pipeline_id;
+	enum sof_ipc_frame fmt;
+	uint32_t rate;		/* highest rate processed */
+	uint32_t mem_runtime;	/* private data and state in bytes */
+	uint32_t mem_buffer;	/* audio buffers in bytes */
+	uint32_t group;		/* buffer sharing group, 0 for none */
+};
+
+/* estimate of one pipeline, its components share the same core */
+struct cost_pipe {
+	uint32_t pipeline_id;
+	uint32_t core;
+	uint32_t period;	/* in us */
+	uint32_t period_mips;	/* declared worst case instructions */
+};
+
+struct cost_config {
+	uint32_t rate;		/* stream rate assumed where topology has none */
+	uint32_t channels;	/* stream channels assumed */
+	uint32_t cpu_mhz;	/* core budget */
+	uint32_t heap_runtime;	/* runtime heap size in bytes */
+	uint32_t heap_buffer;	/* buffer heap size in bytes */
+
+	FILE *tplg_file;
+
+	struct cost_comp *comps;
+	unsigned int num_comps;
+	struct cost_pipe *pipes;
+	unsigned int num_pipes;
+};
+
+/* estimates and records one component of the topology */
+int cost_add_comp(struct cost_config *cost, const char *name,
+		  const struct sof_ipc_comp *comp,
+		  const struct sof_ipc_comp_config *config,
+		  uint32_t rate, uint32_t data_bytes);
+int cost_add_buffer(struct cost_config *cost, const char *name,
+		    const struct sof_ipc_buffer *buffer);
+int cost_add_pipe(struct cost_config *cost,
+		  const struct sof_ipc_pipe_new *pipe);
+
+/* overrides cost table entries from a file */
+int cost_table_load(const char *filename);
+
+/* sums the estimates and prints them, returns number of warnings */
+int cost_report(struct cost_config *cost, FILE *out);
+
+void cost_free(struct cost_config *cost);
+
+int parse_tplg(struct cost_config *cost, const char *tplg_filename);
+
+#endif
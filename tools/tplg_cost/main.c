@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Static memory and MCPS estimate of a topology before it is deployed */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "cost.h"
+
+/* defaults match cannonlake heaps and clock */
+#define COST_DEFAULT_RATE		48000
+#define COST_DEFAULT_CHANNELS		2
+#define COST_DEFAULT_CPU_MHZ		400
+#define COST_DEFAULT_HEAP_RUNTIME	61440
+#define COST_DEFAULT_HEAP_BUFFER	0x50000
+
+static void usage(char *name)
+{
+	fprintf(stdout, "Usage: %s [options] topology.tplg\n\n", name);
+	fprintf(stdout, "Options:\n");
+	fprintf(stdout, "  -r rate      stream rate in Hz (default %d)\n",
+		COST_DEFAULT_RATE);
+	fprintf(stdout, "  -c channels  stream channels (default %d)\n",
+		COST_DEFAULT_CHANNELS);
+	fprintf(stdout, "  -m mhz       clock of each core (default %d)\n",
+		COST_DEFAULT_CPU_MHZ);
+	fprintf(stdout, "  -R bytes     runtime heap size (default %d)\n",
+		COST_DEFAULT_HEAP_RUNTIME);
+	fprintf(stdout, "  -B bytes     buffer heap size (default %d)\n",
+		COST_DEFAULT_HEAP_BUFFER);
+	fprintf(stdout, "  -t file      cost table overrides, lines of\n");
+	fprintf(stdout, "               name s16 s24 s32 [priv state copy]\n");
+	fprintf(stdout, "               cycles per sample and bytes\n");
+	fprintf(stdout, "  -h           print this help\n\n");
+	fprintf(stdout, "Exits with 2 when a core or heap is oversubscribed.\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct cost_config cost;
+	int option;
+	int ret;
+
+	memset(&cost, 0, sizeof(cost));
+	cost.rate = COST_DEFAULT_RATE;
+	cost.channels = COST_DEFAULT_CHANNELS;
+	cost.cpu_mhz = COST_DEFAULT_CPU_MHZ;
+	cost.heap_runtime = COST_DEFAULT_HEAP_RUNTIME;
+	cost.heap_buffer = COST_DEFAULT_HEAP_BUFFER;
+
+	while ((option = getopt(argc, argv, "hr:c:m:R:B:t:")) != -1) {
+		switch (option) {
+		case 'r':
+			cost.rate = atoi(optarg);
+			break;
+		case 'c':
+			cost.channels = atoi(optarg);
+			break;
+		case 'm':
+			cost.cpu_mhz = atoi(optarg);
+			break;
+		case 'R':
+			cost.heap_runtime = strtoul(optarg, NULL, 0);
+			break;
+		case 'B':
+			cost.heap_buffer = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			if (cost_table_load(optarg) < 0)
+				return EXIT_FAILURE;
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (optind != argc - 1 || !cost.rate || !cost.channels ||
+	    !cost.cpu_mhz) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	ret = parse_tplg(&cost, argv[optind]);
+	if (ret < 0) {
+		fprintf(stderr, "error: parsing topology %s\n", argv[optind]);
+		cost_free(&cost);
+		return EXIT_FAILURE;
+	}
+
+	ret = cost_report(&cost, stdout);
+	cost_free(&cost);
+
+	return ret ? 2 : EXIT_SUCCESS;
+}
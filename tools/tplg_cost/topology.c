@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Topology loader collecting the components to be estimated */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include "cost.h"
+#include <ipc/topology.h>
+#include <ipc/stream.h>
+#include <tplg_parser/topology.h>
+
+const struct sof_dai_types sof_dais[] = {
+	{"SSP", SOF_DAI_INTEL_SSP},
+	{"HDA", SOF_DAI_INTEL_HDA},
+	{"DMIC", SOF_DAI_INTEL_DMIC},
+};
+
+/* find dai type */
+enum sof_ipc_dai_type find_dai(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sof_dais); i++) {
+		if (strcmp(name, sof_dais[i].name) == 0)
+			return sof_dais[i].type;
+	}
+
+	return SOF_DAI_INTEL_NONE;
+}
+
+int find_widget(struct comp_info *temp_comp_list, int count, char *name)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (!strcmp(temp_comp_list[i].name, name))
+			return temp_comp_list[i].id;
+	}
+
+	return -EINVAL;
+}
+
+/* reads widget controls, returns size of their configuration blobs */
+static int load_controls(struct cost_config *cost,
+			 struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct snd_soc_tplg_bytes_control *bytes_ctl;
+	struct snd_soc_tplg_ctl_hdr *ctl;
+	char *priv_data;
+	int bytes = 0;
+	int ret;
+	int i;
+
+	for (i = 0; i < widget->num_kcontrols; i++) {
+		ret = tplg_load_one_control(&ctl, &priv_data,
+					    cost->tplg_file);
+		if (ret < 0) {
+			fprintf(stderr, "error: loading controls\n");
+			return ret;
+		}
+
+		if (ctl->ops.info == SND_SOC_TPLG_CTL_BYTES) {
+			bytes_ctl = (struct snd_soc_tplg_bytes_control *)ctl;
+			bytes += bytes_ctl->priv.size;
+		}
+
+		free(ctl);
+		free(priv_data);
+	}
+
+	return bytes;
+}
+
+/* adds a component with the blobs of its controls */
+static int add_comp(struct cost_config *cost,
+		    struct snd_soc_tplg_dapm_widget *widget,
+		    const struct sof_ipc_comp *comp,
+		    const struct sof_ipc_comp_config *config, uint32_t rate)
+{
+	int bytes;
+
+	bytes = load_controls(cost, widget);
+	if (bytes < 0)
+		return bytes;
+
+	return cost_add_comp(cost, widget->name, comp, config, rate, bytes);
+}
+
+/* load buffer DAPM widget */
+int load_buffer(void *dev, int comp_id, int pipeline_id,
+		struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_buffer buffer = {0};
+	int ret;
+
+	ret = tplg_load_buffer(comp_id, pipeline_id, widget->priv.size,
+			       &buffer, cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	ret = load_controls(cost, widget);
+	if (ret < 0)
+		return ret;
+
+	return cost_add_buffer(cost, widget->name, &buffer);
+}
+
+int load_aif_in_out(void *dev, int comp_id, int pipeline_id,
+		    struct snd_soc_tplg_dapm_widget *widget, int dir, void *tp)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_comp_host host = {0};
+	int ret;
+
+	ret = tplg_load_pcm(comp_id, pipeline_id, widget->priv.size, dir,
+			    &host, cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(cost, widget, &host.comp, &host.config, 0);
+}
+
+int load_dai_in_out(void *dev, int comp_id, int pipeline_id,
+		    struct snd_soc_tplg_dapm_widget *widget, int dir, void *tp)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_comp_dai comp_dai = {0};
+	int ret;
+
+	ret = tplg_load_dai(comp_id, pipeline_id, widget->priv.size,
+			    &comp_dai, cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(cost, widget, &comp_dai.comp, &comp_dai.config, 0);
+}
+
+/* load pga dapm widget */
+int load_pga(void *dev, int comp_id, int pipeline_id,
+	     struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_comp_volume volume = {0};
+	int ret;
+
+	ret = tplg_load_pga(comp_id, pipeline_id, widget->priv.size, &volume,
+			    cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(cost, widget, &volume.comp, &volume.config, 0);
+}
+
+/* load scheduler dapm widget */
+int load_pipeline(void *dev, int comp_id, int pipeline_id,
+		  struct snd_soc_tplg_dapm_widget *widget, int sched_id)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_pipe_new pipeline = {0};
+	int ret;
+
+	ret = tplg_load_pipeline(comp_id, pipeline_id, widget->priv.size,
+				 &pipeline, cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	ret = load_controls(cost, widget);
+	if (ret < 0)
+		return ret;
+
+	return cost_add_pipe(cost, &pipeline);
+}
+
+/* converters cost is estimated at the higher of their rates */
+static uint32_t max_rate(uint32_t a, uint32_t b)
+{
+	return a > b ? a : b;
+}
+
+/* load src dapm widget */
+int load_src(void *dev, int comp_id, int pipeline_id,
+	     struct snd_soc_tplg_dapm_widget *widget, void *params)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_comp_src src = {0};
+	int ret;
+
+	ret = tplg_load_src(comp_id, pipeline_id, widget->priv.size, &src,
+			    cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(cost, widget, &src.comp, &src.config,
+			max_rate(max_rate(src.source_rate, src.sink_rate),
+				 cost->rate));
+}
+
+/* load asrc dapm widget */
+int load_asrc(void *dev, int comp_id, int pipeline_id,
+	      struct snd_soc_tplg_dapm_widget *widget, void *params)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_comp_asrc asrc = {0};
+	int ret;
+
+	ret = tplg_load_asrc(comp_id, pipeline_id, widget->priv.size, &asrc,
+			     cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(cost, widget, &asrc.comp, &asrc.config,
+			max_rate(max_rate(asrc.source_rate, asrc.sink_rate),
+				 cost->rate));
+}
+
+/* load mixer dapm widget */
+int load_mixer(void *dev, int comp_id, int pipeline_id,
+	       struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_comp_mixer mixer = {0};
+	int ret;
+
+	ret = tplg_load_mixer(comp_id, pipeline_id, widget->priv.size, &mixer,
+			      cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(cost, widget, &mixer.comp, &mixer.config, 0);
+}
+
+/* load effect dapm widget */
+int load_process(void *dev, int comp_id, int pipeline_id,
+		 struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct cost_config *cost = dev;
+	struct sof_ipc_comp_process process = {0};
+	int ret;
+
+	ret = tplg_load_process(comp_id, pipeline_id, widget->priv.size,
+				&process, cost->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(cost, widget, &process.comp, &process.config, 0);
+}
+
+/* parse topology file and collect its widgets */
+int parse_tplg(struct cost_config *cost, const char *tplg_filename)
+{
+	struct snd_soc_tplg_hdr hdr;
+	struct comp_info *temp_comp_list = NULL;
+	struct comp_info *comp_list;
+	int next_comp_id = 0, num_comps = 0;
+	int sched_id = 0;
+	size_t file_size;
+	int ret = 0;
+	int i;
+
+	cost->tplg_file = fopen(tplg_filename, "rb");
+	if (!cost->tplg_file) {
+		fprintf(stderr, "error: opening topology file %s\n",
+			tplg_filename);
+		return -errno;
+	}
+
+	fseek(cost->tplg_file, 0, SEEK_END);
+	file_size = ftell(cost->tplg_file);
+	fseek(cost->tplg_file, 0, SEEK_SET);
+
+	while (ftell(cost->tplg_file) < file_size) {
+		if (fread(&hdr, sizeof(hdr), 1, cost->tplg_file) != 1) {
+			fprintf(stderr, "error: reading topology header\n");
+			ret = -EINVAL;
+			break;
+		}
+
+		/* only widgets are estimated, graph and controls skipped */
+		if (hdr.type != SND_SOC_TPLG_TYPE_DAPM_WIDGET) {
+			fseek(cost->tplg_file, hdr.payload_size, SEEK_CUR);
+			continue;
+		}
+
+		comp_list = realloc(temp_comp_list, sizeof(*comp_list) *
+				    (num_comps + hdr.count));
+		if (!comp_list) {
+			ret = -ENOMEM;
+			break;
+		}
+		temp_comp_list = comp_list;
+		memset(&comp_list[num_comps], 0,
+		       sizeof(*comp_list) * hdr.count);
+
+		for (i = num_comps; i < num_comps + hdr.count; i++) {
+			ret = load_widget(cost, SOF_DEV, temp_comp_list,
+					  next_comp_id++, i, hdr.index, NULL,
+					  &sched_id, cost->tplg_file);
+			if (ret < 0) {
+				fprintf(stderr, "error: loading widget\n");
+				num_comps = i + 1;
+				goto out;
+			}
+		}
+		num_comps += hdr.count;
+	}
+
+out:
+	for (i = 0; i < num_comps; i++)
+		free(temp_comp_list[i].name);
+
+	free(temp_comp_list);
+	fclose(cost->tplg_file);
+	cost->tplg_file = NULL;
+
+	return ret;
+}
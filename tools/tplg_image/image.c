@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Lays out topology records as loaded by SOF_IPC_TPLG_IMAGE_LOAD */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <kernel/abi.h>
+#include <ipc/header.h>
+#include <ipc/topology.h>
+#include "image.h"
+
+#define IMAGE_ALIGN(x)	(((x) + sizeof(uint32_t) - 1) & \
+			 ~(sizeof(uint32_t) - 1))
+
+int image_add(struct image_section *section, const void *record,
+	      uint32_t size)
+{
+	struct sof_ipc_cmd_hdr *hdr;
+	uint32_t aligned = IMAGE_ALIGN(size);
+	char *data;
+
+	data = realloc(section->data, section->size + aligned);
+	if (!data) {
+		fprintf(stderr, "error: mem alloc\n");
+		return -ENOMEM;
+	}
+
+	memcpy(data + section->size, record, size);
+	memset(data + section->size + size, 0, aligned - size);
+
+	/* firmware walks records by their size */
+	hdr = (struct sof_ipc_cmd_hdr *)(data + section->size);
+	hdr->size = aligned;
+
+	section->data = data;
+	section->size += aligned;
+	section->count++;
+
+	return 0;
+}
+
+int image_write(struct tplg_image *image, FILE *out)
+{
+	/* pipelines need their scheduling component, completion the graph */
+	struct image_section *sections[] = {
+		&image->objects, &image->pipes, &image->connects,
+		&image->completes,
+	};
+	struct sof_tplg_image_hdr hdr;
+	int i;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = SOF_TPLG_IMAGE_MAGIC;
+	hdr.abi = SOF_ABI_VERSION;
+	hdr.size = sizeof(hdr);
+
+	for (i = 0; i < ARRAY_SIZE(sections); i++) {
+		hdr.size += sections[i]->size;
+		hdr.count += sections[i]->count;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, out) != 1)
+		return -EIO;
+
+	for (i = 0; i < ARRAY_SIZE(sections); i++) {
+		if (sections[i]->size &&
+		    fwrite(sections[i]->data, sections[i]->size, 1, out) != 1)
+			return -EIO;
+	}
+
+	return hdr.size;
+}
+
+void image_free(struct tplg_image *image)
+{
+	free(image->objects.data);
+	free(image->pipes.data);
+	free(image->connects.data);
+	free(image->completes.data);
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __TPLG_IMAGE_H__
+#define __TPLG_IMAGE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <ipc/topology.h>
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+/* records of one kind, kept apart to be laid out in instantiation order */
+struct image_section {
+	char *data;
+	size_t size;
+	uint32_t count;
+};
+
+struct tplg_image {
+	FILE *tplg_file;
+
+	struct image_section objects;	/* components and buffers */
+	struct image_section pipes;
+	struct image_section connects;
+	struct image_section completes;
+};
+
+/* appends a record padded to 4 bytes, hdr.size is updated */
+int image_add(struct image_section *section, const void *record,
+	      uint32_t size);
+
+/* writes header and sections to out, returns image size */
+int image_write(struct tplg_image *image, FILE *out);
+
+void image_free(struct tplg_image *image);
+
+int parse_tplg(struct tplg_image *image, const char *tplg_filename);
+
+#endif
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Converts a topology to an image instantiated by one IPC */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "image.h"
+
+static void usage(char *name)
+{
+	fprintf(stdout, "Usage: %s -o image.bin topology.tplg\n\n", name);
+	fprintf(stdout, "Options:\n");
+	fprintf(stdout, "  -o file      output topology image\n");
+	fprintf(stdout, "  -h           print this help\n\n");
+	fprintf(stdout, "The image is loaded with SOF_IPC_TPLG_IMAGE_LOAD by\n");
+	fprintf(stdout, "firmware built for the same ABI as this tool.\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct tplg_image image;
+	char *out_file = NULL;
+	FILE *out;
+	int option;
+	int ret;
+
+	while ((option = getopt(argc, argv, "ho:")) != -1) {
+		switch (option) {
+		case 'o':
+			out_file = optarg;
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (!out_file || optind != argc - 1) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	memset(&image, 0, sizeof(image));
+
+	ret = parse_tplg(&image, argv[optind]);
+	if (ret < 0) {
+		fprintf(stderr, "error: parsing topology %s\n", argv[optind]);
+		goto out;
+	}
+
+	out = fopen(out_file, "wb");
+	if (!out) {
+		fprintf(stderr, "error: opening image file %s\n", out_file);
+		ret = -1;
+		goto out;
+	}
+
+	ret = image_write(&image, out);
+	fclose(out);
+	if (ret < 0) {
+		fprintf(stderr, "error: writing image file %s\n", out_file);
+		goto out;
+	}
+
+	fprintf(stdout, "%s: %u records, %d bytes\n", out_file,
+		image.objects.count + image.pipes.count +
+		image.connects.count + image.completes.count, ret);
+
+out:
+	image_free(&image);
+	return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
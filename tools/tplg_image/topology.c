@@ -0,0 +1,402 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Topology loader converting widgets and routes to image records */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include "image.h"
+#include <kernel/header.h>
+#include <ipc/topology.h>
+#include <ipc/stream.h>
+#include <tplg_parser/topology.h>
+
+const struct sof_dai_types sof_dais[] = {
+	{"SSP", SOF_DAI_INTEL_SSP},
+	{"HDA", SOF_DAI_INTEL_HDA},
+	{"DMIC", SOF_DAI_INTEL_DMIC},
+};
+
+/* find dai type */
+enum sof_ipc_dai_type find_dai(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sof_dais); i++) {
+		if (strcmp(name, sof_dais[i].name) == 0)
+			return sof_dais[i].type;
+	}
+
+	return SOF_DAI_INTEL_NONE;
+}
+
+int find_widget(struct comp_info *temp_comp_list, int count, char *name)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (!strcmp(temp_comp_list[i].name, name))
+			return temp_comp_list[i].id;
+	}
+
+	return -EINVAL;
+}
+
+/* skips widget controls, their values are set at run time */
+static int skip_controls(struct tplg_image *image,
+			 struct snd_soc_tplg_dapm_widget *widget)
+{
+	if (tplg_load_controls(widget->num_kcontrols, image->tplg_file) < 0) {
+		fprintf(stderr, "error: loading controls\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* adds a component sized as its firmware structure */
+static int add_comp(struct tplg_image *image,
+		    struct snd_soc_tplg_dapm_widget *widget,
+		    struct sof_ipc_comp *comp, uint32_t size)
+{
+	int ret;
+
+	ret = skip_controls(image, widget);
+	if (ret < 0)
+		return ret;
+
+	comp->hdr.size = size;
+
+	return image_add(&image->objects, comp, size);
+}
+
+/* load buffer DAPM widget */
+int load_buffer(void *dev, int comp_id, int pipeline_id,
+		struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_buffer buffer = {0};
+	int ret;
+
+	ret = tplg_load_buffer(comp_id, pipeline_id, widget->priv.size,
+			       &buffer, image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	ret = skip_controls(image, widget);
+	if (ret < 0)
+		return ret;
+
+	return image_add(&image->objects, &buffer, sizeof(buffer));
+}
+
+int load_aif_in_out(void *dev, int comp_id, int pipeline_id,
+		    struct snd_soc_tplg_dapm_widget *widget, int dir, void *tp)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_comp_host host = {0};
+	int ret;
+
+	ret = tplg_load_pcm(comp_id, pipeline_id, widget->priv.size, dir,
+			    &host, image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(image, widget, &host.comp, sizeof(host));
+}
+
+int load_dai_in_out(void *dev, int comp_id, int pipeline_id,
+		    struct snd_soc_tplg_dapm_widget *widget, int dir, void *tp)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_comp_dai comp_dai = {0};
+	int ret;
+
+	ret = tplg_load_dai(comp_id, pipeline_id, widget->priv.size,
+			    &comp_dai, image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	comp_dai.direction = dir;
+
+	return add_comp(image, widget, &comp_dai.comp, sizeof(comp_dai));
+}
+
+/* load pga dapm widget */
+int load_pga(void *dev, int comp_id, int pipeline_id,
+	     struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_comp_volume volume = {0};
+	int ret;
+
+	ret = tplg_load_pga(comp_id, pipeline_id, widget->priv.size, &volume,
+			    image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(image, widget, &volume.comp, sizeof(volume));
+}
+
+/* load scheduler dapm widget, completed once its graph is connected */
+int load_pipeline(void *dev, int comp_id, int pipeline_id,
+		  struct snd_soc_tplg_dapm_widget *widget, int sched_id)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_pipe_new pipeline = {0};
+	struct sof_ipc_pipe_ready ready = {0};
+	int ret;
+
+	ret = tplg_load_pipeline(comp_id, pipeline_id, widget->priv.size,
+				 &pipeline, image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	ret = skip_controls(image, widget);
+	if (ret < 0)
+		return ret;
+
+	pipeline.sched_id = sched_id;
+
+	ret = image_add(&image->pipes, &pipeline, sizeof(pipeline));
+	if (ret < 0)
+		return ret;
+
+	ready.hdr.cmd = SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_PIPE_COMPLETE;
+	ready.comp_id = comp_id;
+
+	return image_add(&image->completes, &ready, sizeof(ready));
+}
+
+/* load src dapm widget */
+int load_src(void *dev, int comp_id, int pipeline_id,
+	     struct snd_soc_tplg_dapm_widget *widget, void *params)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_comp_src src = {0};
+	int ret;
+
+	ret = tplg_load_src(comp_id, pipeline_id, widget->priv.size, &src,
+			    image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(image, widget, &src.comp, sizeof(src));
+}
+
+/* load asrc dapm widget */
+int load_asrc(void *dev, int comp_id, int pipeline_id,
+	      struct snd_soc_tplg_dapm_widget *widget, void *params)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_comp_asrc asrc = {0};
+	int ret;
+
+	ret = tplg_load_asrc(comp_id, pipeline_id, widget->priv.size, &asrc,
+			     image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(image, widget, &asrc.comp, sizeof(asrc));
+}
+
+/* load mixer dapm widget */
+int load_mixer(void *dev, int comp_id, int pipeline_id,
+	       struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_comp_mixer mixer = {0};
+	int ret;
+
+	ret = tplg_load_mixer(comp_id, pipeline_id, widget->priv.size, &mixer,
+			      image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	return add_comp(image, widget, &mixer.comp, sizeof(mixer));
+}
+
+/* load effect dapm widget, its bytes control is the configuration */
+int load_process(void *dev, int comp_id, int pipeline_id,
+		 struct snd_soc_tplg_dapm_widget *widget)
+{
+	struct tplg_image *image = dev;
+	struct sof_ipc_comp_process process = {0};
+	struct sof_ipc_comp_process *process_ipc;
+	struct snd_soc_tplg_bytes_control *bytes_ctl;
+	struct snd_soc_tplg_ctl_hdr *ctl = NULL;
+	char *priv_data = NULL;
+	uint32_t size = 0;
+	int ret;
+
+	ret = tplg_load_process(comp_id, pipeline_id, widget->priv.size,
+				&process, image->tplg_file);
+	if (ret < 0)
+		return ret;
+
+	/* Only one control is supported*/
+	if (widget->num_kcontrols > 1) {
+		fprintf(stderr, "error: more than one kcontrol defined\n");
+		return -EINVAL;
+	}
+
+	if (widget->num_kcontrols) {
+		ret = tplg_load_one_control(&ctl, &priv_data,
+					    image->tplg_file);
+		if (ret < 0) {
+			fprintf(stderr, "error: failed control load\n");
+			return ret;
+		}
+
+		/* configuration is sent without its ABI header */
+		if (ctl->ops.info == SND_SOC_TPLG_CTL_BYTES) {
+			bytes_ctl = (struct snd_soc_tplg_bytes_control *)ctl;
+			if (bytes_ctl->priv.size > sizeof(struct sof_abi_hdr))
+				size = bytes_ctl->priv.size -
+					sizeof(struct sof_abi_hdr);
+		}
+	}
+
+	process_ipc = calloc(1, sizeof(*process_ipc) + size);
+	if (!process_ipc) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	memcpy(process_ipc, &process, sizeof(process));
+	if (size)
+		memcpy(process_ipc->data,
+		       priv_data + sizeof(struct sof_abi_hdr), size);
+	process_ipc->size = size;
+	process_ipc->comp.hdr.size = sizeof(*process_ipc) + size;
+
+	ret = image_add(&image->objects, process_ipc,
+			process_ipc->comp.hdr.size);
+	free(process_ipc);
+
+out:
+	free(ctl);
+	free(priv_data);
+	return ret;
+}
+
+/* converts the routes of one pipeline to connections */
+static int load_graph(struct tplg_image *image,
+		      struct comp_info *temp_comp_list, int count,
+		      int num_comps, int pipeline_id)
+{
+	struct sof_ipc_pipe_comp_connect connection;
+	char *pipeline_string;
+	int ret = 0;
+	int i;
+
+	/* route names are appended by the parser */
+	pipeline_string = calloc(count + 1, 2 * SNDRV_CTL_ELEM_ID_NAME_MAXLEN);
+	if (!pipeline_string)
+		return -ENOMEM;
+
+	for (i = 0; i < count; i++) {
+		ret = tplg_load_graph(num_comps, pipeline_id, temp_comp_list,
+				      pipeline_string, &connection,
+				      image->tplg_file, i, count);
+		if (ret < 0)
+			break;
+
+		ret = image_add(&image->connects, &connection,
+				sizeof(connection));
+		if (ret < 0)
+			break;
+	}
+
+	free(pipeline_string);
+	return ret;
+}
+
+/* parse topology file and lay out its pipelines */
+int parse_tplg(struct tplg_image *image, const char *tplg_filename)
+{
+	struct snd_soc_tplg_hdr hdr;
+	struct comp_info *temp_comp_list = NULL;
+	struct comp_info *comp_list;
+	int next_comp_id = 0, num_comps = 0;
+	int sched_id = 0;
+	size_t file_size;
+	int ret = 0;
+	int i;
+
+	image->tplg_file = fopen(tplg_filename, "rb");
+	if (!image->tplg_file) {
+		fprintf(stderr, "error: opening topology file %s\n",
+			tplg_filename);
+		return -errno;
+	}
+
+	fseek(image->tplg_file, 0, SEEK_END);
+	file_size = ftell(image->tplg_file);
+	fseek(image->tplg_file, 0, SEEK_SET);
+
+	while (ftell(image->tplg_file) < file_size) {
+		if (fread(&hdr, sizeof(hdr), 1, image->tplg_file) != 1) {
+			fprintf(stderr, "error: reading topology header\n");
+			ret = -EINVAL;
+			break;
+		}
+
+		switch (hdr.type) {
+		case SND_SOC_TPLG_TYPE_DAPM_WIDGET:
+			comp_list = realloc(temp_comp_list,
+					    sizeof(*comp_list) *
+					    (num_comps + hdr.count));
+			if (!comp_list) {
+				ret = -ENOMEM;
+				goto out;
+			}
+			temp_comp_list = comp_list;
+			memset(&comp_list[num_comps], 0,
+			       sizeof(*comp_list) * hdr.count);
+
+			for (i = num_comps; i < num_comps + hdr.count; i++) {
+				ret = load_widget(image, SOF_DEV,
+						  temp_comp_list,
+						  next_comp_id++, i, hdr.index,
+						  NULL, &sched_id,
+						  image->tplg_file);
+				if (ret < 0) {
+					fprintf(stderr,
+						"error: loading widget\n");
+					num_comps = i + 1;
+					goto out;
+				}
+			}
+			num_comps += hdr.count;
+			break;
+		case SND_SOC_TPLG_TYPE_DAPM_GRAPH:
+			ret = load_graph(image, temp_comp_list, hdr.count,
+					 num_comps, hdr.index);
+			if (ret < 0) {
+				fprintf(stderr, "error: pipeline graph\n");
+				goto out;
+			}
+			break;
+		default:
+			/* controls, PCMs and DAI links stay with the driver */
+			fseek(image->tplg_file, hdr.payload_size, SEEK_CUR);
+			break;
+		}
+	}
+
+out:
+	for (i = 0; i < num_comps; i++)
+		free(temp_comp_list[i].name);
+
+	free(temp_comp_list);
+	fclose(image->tplg_file);
+	image->tplg_file = NULL;
+
+	return ret;
+}
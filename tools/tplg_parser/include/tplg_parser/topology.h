@@ -40,6 +40,7 @@ static const struct frame_types sof_frames[] = {
 	{"S24_LE", SOF_IPC_FRAME_S24_4LE},
 	{"S32_LE", SOF_IPC_FRAME_S32_LE},
 	{"FLOAT_LE", SOF_IPC_FRAME_FLOAT},
+	{"S24_3LE", SOF_IPC_FRAME_S24_3LE},
 };
 
 /** \brief Types of processing components */
@@ -78,6 +79,10 @@ static const struct sof_topology_token buffer_tokens[] = {
 		offsetof(struct sof_ipc_buffer, size), 0},
 	{SOF_TKN_BUF_CAPS, SND_SOC_TPLG_TUPLE_TYPE_WORD, get_token_uint32_t,
 		offsetof(struct sof_ipc_buffer, caps), 0},
+	{SOF_TKN_BUF_FLAGS, SND_SOC_TPLG_TUPLE_TYPE_WORD, get_token_uint32_t,
+		offsetof(struct sof_ipc_buffer, flags), 0},
+	{SOF_TKN_BUF_GROUP, SND_SOC_TPLG_TUPLE_TYPE_WORD, get_token_uint32_t,
+		offsetof(struct sof_ipc_buffer, group), 0},
 };
 
 /* scheduling */
@@ -100,6 +105,9 @@ static const struct sof_topology_token sched_tokens[] = {
 	{SOF_TKN_SCHED_TIME_DOMAIN, SND_SOC_TPLG_TUPLE_TYPE_WORD,
 		get_token_uint32_t,
 		offsetof(struct sof_ipc_pipe_new, time_domain), 0},
+	{SOF_TKN_SCHED_BATCH_PERIODS, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+		get_token_uint32_t,
+		offsetof(struct sof_ipc_pipe_new, batch_periods), 0},
 };
 
 /* volume */
@@ -169,6 +177,9 @@ static const struct sof_topology_token pcm_tokens[] = {
 	{SOF_TKN_PCM_DMAC_CONFIG, SND_SOC_TPLG_TUPLE_TYPE_WORD,
 	 get_token_uint32_t,
 	 offsetof(struct sof_ipc_comp_host, dmac_config), 0},
+	{SOF_TKN_PCM_CH_MAP, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+	 get_token_uint32_t,
+	 offsetof(struct sof_ipc_comp_host, ch_map), 0},
 };
 
 /* DAI */
@@ -184,6 +195,12 @@ static const struct sof_topology_token dai_tokens[] = {
 	{SOF_TKN_DAI_DIRECTION, SND_SOC_TPLG_TUPLE_TYPE_WORD,
 	get_token_uint32_t,
 	offsetof(struct sof_ipc_comp_dai, direction), 0},
+	{SOF_TKN_DAI_SLOT_MASK, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+	get_token_uint32_t,
+	offsetof(struct sof_ipc_comp_dai, slot_mask), 0},
+	{SOF_TKN_DAI_CH_MAP, SND_SOC_TPLG_TUPLE_TYPE_WORD,
+	get_token_uint32_t,
+	offsetof(struct sof_ipc_comp_dai, ch_map), 0},
 };
 
 struct sof_dai_types {
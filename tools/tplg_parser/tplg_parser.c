@@ -853,10 +853,10 @@ int tplg_load_process(int comp_id, int pipeline_id, int size,
 
 	array = (void *)array - size;
 
-	/* configure asrc */
+	/* configure process */
 	process->comp.hdr.cmd = SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW;
 	process->comp.id = comp_id;
-	process->comp.hdr.size = sizeof(struct sof_ipc_comp_asrc);
+	process->comp.hdr.size = sizeof(struct sof_ipc_comp_process);
 	process->comp.type = find_process_comp_type(process->type);
 	process->comp.pipeline_id = pipeline_id;
 	process->config.hdr.size = sizeof(struct sof_ipc_comp_config);
@@ -911,10 +911,10 @@ int tplg_load_mixer(int comp_id, int pipeline_id, int size,
 	/* point to the start of array so it gets freed properly */
 	array = (void *)array - size;
 
-	/* configure src */
+	/* configure mixer */
 	mixer->comp.hdr.cmd = SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW;
 	mixer->comp.id = comp_id;
-	mixer->comp.hdr.size = sizeof(struct sof_ipc_comp_src);
+	mixer->comp.hdr.size = sizeof(struct sof_ipc_comp_mixer);
 	mixer->comp.type = SOF_COMP_MIXER;
 	mixer->comp.pipeline_id = pipeline_id;
 	mixer->config.hdr.size = sizeof(struct sof_ipc_comp_config);